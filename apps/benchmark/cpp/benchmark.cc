@@ -0,0 +1,531 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file benchmark.cc
+ * \brief A native benchmark of the models exported by TVM, run by the graph executor or the VM.
+ *
+ *  The latencies of the runs of each worker are recorded one by one, and reported as JSON with
+ *  their percentiles, the throughput of the concurrent workers and the peak memory of the
+ *  process. See the README for the options.
+ */
+#include <dlfcn.h>
+#include <dlpack/dlpack.h>
+#include <sys/resource.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tvm::runtime;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct InputSpec {
+  std::string name;
+  /*! \brief The shape and the type, taken from the graph when they are not given. */
+  std::vector<int64_t> shape;
+  std::string dtype = "float32";
+};
+
+struct Options {
+  std::string lib;
+  std::string code;
+  std::string executor = "graph";
+  std::string device = "cpu";
+  std::string output;
+  std::vector<InputSpec> inputs;
+  std::vector<std::string> preload;
+  int warmup = 10;
+  int repeat = 100;
+  int concurrency = 1;
+  int num_threads = 0;
+  bool pin = false;
+  bool per_op = false;
+  uint64_t seed = 0;
+};
+
+const char* kUsage =
+    "usage: benchmark --lib=<model.so> [options]\n"
+    "  --executor=graph|vm     The executor of the model (graph).\n"
+    "  --code=<model.ro>       The bytecode of the VM executable.\n"
+    "  --device=<name>[:<id>]  The device, e.g. cpu, cuda:1 or ext_dev (cpu).\n"
+    "  --input=<name>[:<shape>[:<dtype>]]\n"
+    "                          An input of the model, e.g. data:1x3x224x224:float32, filled\n"
+    "                          with random values. The shape is required for the VM.\n"
+    "  --warmup=<n>            The untimed runs of each worker (10).\n"
+    "  --repeat=<n>            The timed runs of each worker (100).\n"
+    "  --concurrency=<n>       The workers running the model at the same time (1).\n"
+    "  --num-threads=<n>       The threads of the thread pool of each worker (all the cores).\n"
+    "  --pin                   Pin the workers and their thread pools to disjoint cores.\n"
+    "  --per-op                Also report the latencies of the operators (graph executor).\n"
+    "  --seed=<n>              The seed of the inputs (0).\n"
+    "  --preload=<lib.so>      A library to load first, e.g. the VTA runtime.\n"
+    "  --output=<file.json>    Where to write the report (stdout).\n";
+
+std::vector<int64_t> ParseShape(const std::string& str) {
+  std::vector<int64_t> shape;
+  std::istringstream is(str);
+  std::string dim;
+  while (std::getline(is, dim, 'x')) {
+    shape.push_back(std::stoll(dim));
+  }
+  return shape;
+}
+
+InputSpec ParseInput(const std::string& str) {
+  InputSpec spec;
+  size_t shape_begin = str.find(':');
+  spec.name = str.substr(0, shape_begin);
+  if (shape_begin != std::string::npos) {
+    size_t dtype_begin = str.find(':', shape_begin + 1);
+    spec.shape = ParseShape(str.substr(shape_begin + 1, dtype_begin - shape_begin - 1));
+    if (dtype_begin != std::string::npos) spec.dtype = str.substr(dtype_begin + 1);
+  }
+  return spec;
+}
+
+Options ParseArgs(int argc, char** argv) {
+  Options opts;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    size_t eq = arg.find('=');
+    std::string key = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "--lib") {
+      opts.lib = value;
+    } else if (key == "--code") {
+      opts.code = value;
+    } else if (key == "--executor") {
+      opts.executor = value;
+    } else if (key == "--device") {
+      opts.device = value;
+    } else if (key == "--input") {
+      opts.inputs.push_back(ParseInput(value));
+    } else if (key == "--warmup") {
+      opts.warmup = std::stoi(value);
+    } else if (key == "--repeat") {
+      opts.repeat = std::stoi(value);
+    } else if (key == "--concurrency") {
+      opts.concurrency = std::stoi(value);
+    } else if (key == "--num-threads") {
+      opts.num_threads = std::stoi(value);
+    } else if (key == "--pin") {
+      opts.pin = true;
+    } else if (key == "--per-op") {
+      opts.per_op = true;
+    } else if (key == "--seed") {
+      opts.seed = std::stoull(value);
+    } else if (key == "--preload") {
+      opts.preload.push_back(value);
+    } else if (key == "--output") {
+      opts.output = value;
+    } else {
+      std::cerr << "Unknown option " << arg << "\n" << kUsage;
+      std::exit(1);
+    }
+  }
+  if (opts.lib.empty() || (opts.executor != "graph" && opts.executor != "vm")) {
+    std::cerr << kUsage;
+    std::exit(1);
+  }
+  ICHECK_GE(opts.warmup, 0);
+  ICHECK_GT(opts.repeat, 0);
+  ICHECK_GT(opts.concurrency, 0);
+  ICHECK_GE(opts.num_threads, 0);
+  if (opts.executor == "vm" && opts.code.empty()) {
+    opts.code = opts.lib.substr(0, opts.lib.rfind('.')) + ".ro";
+  }
+  return opts;
+}
+
+Device ParseDevice(const std::string& str) {
+  size_t colon = str.find(':');
+  std::string name = str.substr(0, colon);
+  int device_id = colon == std::string::npos ? 0 : std::stoi(str.substr(colon + 1));
+  const int types[] = {kDLCPU, kDLCUDA, kDLOpenCL, kDLVulkan, kDLMetal, kDLROCM, kDLExtDev,
+                       kDLHexagon};
+  for (int type : types) {
+    if (name == DeviceName(type)) return Device{static_cast<DLDeviceType>(type), device_id};
+  }
+  LOG(FATAL) << "Unknown device " << str;
+  return Device{kDLCPU, 0};
+}
+
+/*!
+ * \brief A host array of random values, uniform in [0, 1) for the floats and in [0, 10) for the
+ *  integers, zeros for the other types.
+ */
+NDArray RandomArray(const InputSpec& spec, std::mt19937_64* rng) {
+  DLDataType dtype = String2DLDataType(spec.dtype);
+  NDArray arr = NDArray::Empty(spec.shape, dtype, Device{kDLCPU, 0});
+  int64_t size = 1;
+  for (int64_t dim : spec.shape) size *= dim;
+  std::uniform_real_distribution<double> real(0, 1);
+  std::uniform_int_distribution<int> integer(0, 9);
+  auto fill = [&](auto* data, auto sample) {
+    for (int64_t i = 0; i < size; ++i) data[i] = sample();
+  };
+  void* data = arr->data;
+  if (dtype.code == kDLFloat && dtype.bits == 32) {
+    fill(static_cast<float*>(data), [&] { return real(*rng); });
+  } else if (dtype.code == kDLFloat && dtype.bits == 64) {
+    fill(static_cast<double*>(data), [&] { return real(*rng); });
+  } else if ((dtype.code == kDLInt || dtype.code == kDLUInt) && dtype.bits == 8) {
+    fill(static_cast<int8_t*>(data), [&] { return integer(*rng); });
+  } else if ((dtype.code == kDLInt || dtype.code == kDLUInt) && dtype.bits == 32) {
+    fill(static_cast<int32_t*>(data), [&] { return integer(*rng); });
+  } else if ((dtype.code == kDLInt || dtype.code == kDLUInt) && dtype.bits == 64) {
+    fill(static_cast<int64_t*>(data), [&] { return integer(*rng); });
+  } else {
+    std::fill_n(static_cast<char*>(data), size * ((dtype.bits * dtype.lanes + 7) / 8), 0);
+  }
+  return arr;
+}
+
+/*! \brief A model instance of a worker. */
+class Runner {
+ public:
+  virtual ~Runner() = default;
+  /*! \brief Run the model once, waiting for the device. */
+  virtual void Run() = 0;
+};
+
+class GraphRunner : public Runner {
+ public:
+  GraphRunner(Module factory, Device dev, const std::vector<InputSpec>& inputs,
+              const std::vector<NDArray>& data, bool shared)
+      : dev_(dev) {
+    // The workers share the parameters when the factory can.
+    PackedFunc create;
+    if (shared) create = factory.GetFunction("create_shared");
+    if (create == nullptr) create = factory.GetFunction("default");
+    ICHECK(create != nullptr) << "The library is not a graph executor factory";
+    Module exec = create(dev);
+    PackedFunc set_input = exec.GetFunction("set_input");
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      set_input(inputs[i].name, data[i]);
+    }
+    run_ = exec.GetFunction("run");
+  }
+
+  void Run() final {
+    run_();
+    if (dev_.device_type != kDLCPU) TVMSynchronize(dev_.device_type, dev_.device_id, nullptr);
+  }
+
+ private:
+  Device dev_;
+  PackedFunc run_;
+};
+
+class VMRunner : public Runner {
+ public:
+  VMRunner(Module exe, Device dev, const std::vector<NDArray>& data) : dev_(dev) {
+    vm_ = (*Registry::Get("runtime._VirtualMachine"))(exe);
+    // The pooled allocator, with the host as a second device.
+    constexpr int kPooled = 2;
+    if (dev.device_type == kDLCPU) {
+      vm_.GetFunction("init")(static_cast<int>(dev.device_type), dev.device_id, kPooled);
+    } else {
+      vm_.GetFunction("init")(static_cast<int>(dev.device_type), dev.device_id, kPooled,
+                              static_cast<int>(kDLCPU), 0, kPooled);
+    }
+    inputs_.reserve(data.size());
+    std::vector<TVMValue> values(data.size() + 1);
+    std::vector<int> codes(data.size() + 1);
+    TVMArgsSetter setter(values.data(), codes.data());
+    setter(0, "main");
+    for (size_t i = 0; i < data.size(); ++i) {
+      inputs_.push_back(data[i].CopyTo(dev));
+      setter(i + 1, inputs_.back());
+    }
+    TVMRetValue rv;
+    vm_.GetFunction("set_input").CallPacked(TVMArgs(values.data(), codes.data(), values.size()),
+                                            &rv);
+    invoke_ = vm_.GetFunction("invoke");
+  }
+
+  void Run() final {
+    invoke_("main");
+    if (dev_.device_type != kDLCPU) TVMSynchronize(dev_.device_type, dev_.device_id, nullptr);
+  }
+
+ private:
+  Device dev_;
+  Module vm_;
+  std::vector<NDArray> inputs_;
+  PackedFunc invoke_;
+};
+
+/*! \brief Restrict the calling thread to the cores [first_core, first_core + num_cores). */
+void PinThread(int first_core, int num_cores) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int core = first_core; core < first_core + num_cores; ++core) {
+    CPU_SET(core, &cpuset);
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+/*! \brief The percentile q of sorted values, by the nearest rank. */
+double Percentile(const std::vector<double>& sorted, double q) {
+  if (sorted.empty()) return 0;
+  int64_t rank = static_cast<int64_t>(std::ceil(q * sorted.size()));
+  return sorted[std::min<int64_t>(std::max<int64_t>(rank, 1), sorted.size()) - 1];
+}
+
+/*! \brief The JSON object of the statistics of latencies in ms. */
+std::string LatencyJSON(std::vector<double> ms) {
+  std::sort(ms.begin(), ms.end());
+  double sum = 0;
+  for (double t : ms) sum += t;
+  std::ostringstream os;
+  os.precision(6);
+  os << std::fixed << "{\"count\": " << ms.size()
+     << ", \"mean_ms\": " << (ms.empty() ? 0 : sum / ms.size())
+     << ", \"min_ms\": " << (ms.empty() ? 0 : ms.front()) << ", \"p50_ms\": " << Percentile(ms, 0.5)
+     << ", \"p90_ms\": " << Percentile(ms, 0.9) << ", \"p99_ms\": " << Percentile(ms, 0.99)
+     << ", \"p999_ms\": " << Percentile(ms, 0.999)
+     << ", \"max_ms\": " << (ms.empty() ? 0 : ms.back()) << "}";
+  return os.str();
+}
+
+std::string EscapeJSON(const std::string& str) {
+  std::string escaped;
+  for (char c : str) {
+    if (c == '"' || c == '\\') escaped += '\\';
+    escaped += c;
+  }
+  return escaped;
+}
+
+/*!
+ * \brief The latencies of the operators of the graph, by their call index, profiled by the debug
+ *  executor run after run.
+ */
+std::string PerOpJSON(Module factory, Device dev, const Options& opts,
+                      const std::vector<NDArray>& data) {
+  PackedFunc create = factory.GetFunction("debug_create");
+  ICHECK(create != nullptr) << "--per-op needs the graph executor factory";
+  Module exec = create("default", dev);
+  PackedFunc set_input = exec.GetFunction("set_input");
+  for (size_t i = 0; i < opts.inputs.size(); ++i) {
+    set_input(opts.inputs[i].name, data[i]);
+  }
+  PackedFunc profile = exec.GetFunction("profile");
+  ICHECK(profile != nullptr) << "--per-op needs the runtime built with the debug executor";
+  for (int i = 0; i < opts.warmup; ++i) profile();
+  std::vector<std::string> names;
+  std::vector<std::vector<double>> op_ms;
+  for (int i = 0; i < opts.repeat; ++i) {
+    profiling::Report report = profile();
+    const auto& calls = report->calls;
+    if (op_ms.empty()) op_ms.resize(calls.size());
+    for (size_t j = 0; j < calls.size(); ++j) {
+      if (i == 0) names.push_back(Downcast<String>(calls[j].at("Name")));
+      const auto* duration = calls[j].at("Duration (us)").as<profiling::DurationNode>();
+      op_ms[j].push_back(duration->microseconds / 1000);
+    }
+  }
+  std::ostringstream os;
+  os << "[";
+  for (size_t j = 0; j < op_ms.size(); ++j) {
+    os << (j ? ",\n    " : "\n    ") << "{\"index\": " << j << ", \"name\": \""
+       << EscapeJSON(names[j]) << "\", \"latency\": " << LatencyJSON(op_ms[j]) << "}";
+  }
+  os << (op_ms.empty() ? "]" : "\n  ]");
+  return os.str();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Options opts = ParseArgs(argc, argv);
+  for (const std::string& lib : opts.preload) {
+    ICHECK(dlopen(lib.c_str(), RTLD_NOW | RTLD_GLOBAL)) << "Cannot load " << lib << ": "
+                                                        << dlerror();
+  }
+  Device dev = ParseDevice(opts.device);
+  Module lib = Module::LoadFromFile(opts.lib);
+
+  Module exe;
+  if (opts.executor == "vm") {
+    std::ifstream code_file(opts.code, std::ios::binary);
+    ICHECK(code_file) << "Cannot read the bytecode " << opts.code;
+    std::string code((std::istreambuf_iterator<char>(code_file)),
+                     std::istreambuf_iterator<char>());
+    TVMByteArray code_bytes{code.data(), code.size()};
+    exe = (*Registry::Get("runtime.Load_Executable"))(code_bytes, lib);
+    // Order the inputs as the parameters of main.
+    int arity = exe.GetFunction("get_function_arity")("main");
+    ICHECK_EQ(arity, static_cast<int>(opts.inputs.size()))
+        << "main takes " << arity << " inputs, given " << opts.inputs.size();
+    PackedFunc param_name = exe.GetFunction("get_function_param_name");
+    std::vector<InputSpec> ordered;
+    for (int i = 0; i < arity; ++i) {
+      std::string name = param_name("main", i);
+      auto it = std::find_if(opts.inputs.begin(), opts.inputs.end(),
+                             [&](const InputSpec& spec) { return spec.name == name; });
+      ICHECK(it != opts.inputs.end()) << "Missing the input " << name << " of main";
+      ICHECK(!it->shape.empty()) << "The VM needs the shape of the input " << name;
+      ordered.push_back(*it);
+    }
+    opts.inputs = ordered;
+  } else {
+    // Take the missing shapes and types from the graph.
+    Module exec = lib.GetFunction("default")(dev);
+    PackedFunc get_input = exec.GetFunction("get_input");
+    for (InputSpec& spec : opts.inputs) {
+      if (!spec.shape.empty()) continue;
+      NDArray arr = get_input(spec.name);
+      ICHECK(arr.defined()) << "The graph has no input " << spec.name;
+      spec.shape = arr.Shape();
+      spec.dtype = DLDataType2String(arr.DataType());
+    }
+  }
+
+  std::mt19937_64 rng(opts.seed);
+  std::vector<NDArray> data;
+  for (const InputSpec& spec : opts.inputs) {
+    data.push_back(RandomArray(spec, &rng));
+  }
+
+  int num_cores = static_cast<int>(std::thread::hardware_concurrency());
+  int cores_per_worker =
+      opts.num_threads > 0 ? opts.num_threads : std::max(1, num_cores / opts.concurrency);
+  if (opts.pin) {
+    // One thread pool partition per worker, on its own cores.
+    const PackedFunc* config = Registry::Get("runtime.config_threadpool_partition");
+    ICHECK(config) << "--pin needs the thread pool partitions of the runtime";
+    for (int w = 0; w < opts.concurrency; ++w) {
+      (*config)(w, cores_per_worker, w * cores_per_worker);
+    }
+  }
+
+  // The workers build their model instance, warm up, then wait for the others to start timing.
+  std::mutex mutex;
+  std::condition_variable cv;
+  int num_ready = 0;
+  bool started = false;
+  Clock::time_point start;
+  std::vector<Clock::time_point> ends(opts.concurrency);
+  std::vector<std::vector<double>> latencies(opts.concurrency);
+  std::vector<std::thread> workers;
+  for (int w = 0; w < opts.concurrency; ++w) {
+    workers.emplace_back([&, w] {
+      if (opts.pin) {
+        PinThread(w * cores_per_worker, cores_per_worker);
+        (*Registry::Get("runtime.bind_threadpool_partition"))(w);
+      } else if (opts.num_threads > 0) {
+        constexpr int kBig = 1;
+        (*Registry::Get("runtime.config_threadpool"))(kBig, opts.num_threads);
+      }
+      std::unique_ptr<Runner> runner;
+      if (opts.executor == "vm") {
+        runner.reset(new VMRunner(exe, dev, data));
+      } else {
+        runner.reset(new GraphRunner(lib, dev, opts.inputs, data, opts.concurrency > 1));
+      }
+      for (int i = 0; i < opts.warmup; ++i) runner->Run();
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (++num_ready == opts.concurrency) {
+          started = true;
+          start = Clock::now();
+          cv.notify_all();
+        } else {
+          cv.wait(lock, [&] { return started; });
+        }
+      }
+      latencies[w].reserve(opts.repeat);
+      for (int i = 0; i < opts.repeat; ++i) {
+        auto begin = Clock::now();
+        runner->Run();
+        auto end = Clock::now();
+        latencies[w].push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+      }
+      ends[w] = Clock::now();
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  std::vector<double> all;
+  for (const auto& worker_latencies : latencies) {
+    all.insert(all.end(), worker_latencies.begin(), worker_latencies.end());
+  }
+  double wall_s =
+      std::chrono::duration<double>(*std::max_element(ends.begin(), ends.end()) - start).count();
+
+  std::string per_op;
+  if (opts.per_op) {
+    ICHECK(opts.executor == "graph") << "--per-op is only supported by the graph executor";
+    per_op = PerOpJSON(lib, dev, opts, data);
+  }
+
+  // The peak resident memory of the process, in KB on Linux.
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  std::ostringstream os;
+  os.precision(6);
+  os << std::fixed << "{\n  \"lib\": \"" << EscapeJSON(opts.lib) << "\",\n  \"executor\": \""
+     << opts.executor << "\",\n  \"device\": \"" << EscapeJSON(opts.device)
+     << "\",\n  \"concurrency\": " << opts.concurrency << ",\n  \"warmup\": " << opts.warmup
+     << ",\n  \"repeat\": " << opts.repeat << ",\n  \"latency\": " << LatencyJSON(all)
+     << ",\n  \"throughput_per_s\": " << all.size() / wall_s
+     << ",\n  \"peak_host_memory_kb\": " << usage.ru_maxrss;
+  if (opts.per_op) os << ",\n  \"per_op\": " << per_op;
+  os << "\n}\n";
+  if (opts.output.empty()) {
+    std::cout << os.str();
+  } else {
+    std::ofstream(opts.output) << os.str();
+  }
+  return 0;
+}
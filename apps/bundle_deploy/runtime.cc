@@ -32,6 +32,7 @@
 #include "../../src/runtime/module.cc"
 #include "../../src/runtime/ndarray.cc"
 #include "../../src/runtime/object.cc"
+#include "../../src/runtime/profiling.cc"
 #include "../../src/runtime/registry.cc"
 #include "../../src/runtime/system_library.cc"
 #include "../../src/runtime/thread_pool.cc"
@@ -19,6 +19,7 @@ import tvm
 import numpy as np
 from tvm import te
 from tvm import relay
+from tvm.contrib import runtime_pack
 import os
 
 
@@ -30,12 +31,13 @@ def prepare_test_libs(base_path):
     # Compile library as dynamic library
     fadd_dylib = tvm.build(s, [A, B], "llvm", name="addone")
     dylib_path = os.path.join(base_path, "test_addone_dll.so")
-    fadd_dylib.export_library(dylib_path)
+    fadd_dylib.export_library(dylib_path, runtime_manifest=dylib_path + ".manifest.json")
 
     # Compile library in system library mode
     fadd_syslib = tvm.build(s, [A, B], "llvm --system-lib", name="addonesys")
     syslib_path = os.path.join(base_path, "test_addone_sys.o")
     fadd_syslib.save(syslib_path)
+    runtime_pack.write_manifest(fadd_syslib, syslib_path + ".manifest.json")
 
 
 def prepare_graph_lib(base_path):
@@ -49,7 +51,7 @@ def prepare_graph_lib(base_path):
     # If you are running cross compilation, you can also consider export
     # to tar and invoke host compiler later.
     dylib_path = os.path.join(base_path, "test_relay_add.so")
-    compiled_lib.export_library(dylib_path)
+    compiled_lib.export_library(dylib_path, runtime_manifest=dylib_path + ".manifest.json")
 
 
 if __name__ == "__main__":
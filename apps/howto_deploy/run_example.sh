@@ -25,6 +25,9 @@ export DYLD_LIBRARY_PATH=../../build:${DYLD_LIBRARY_PATH}
 echo "Run the deployment with all in one packed library..."
 lib/cpp_deploy_pack
 
+echo "Run the deployment with the minimal runtime of the libraries..."
+lib/cpp_deploy_minimal
+
 echo "Run the cpp deployment with all in normal library..."
 lib/cpp_deploy_normal
 
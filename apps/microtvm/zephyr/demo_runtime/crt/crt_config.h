@@ -44,6 +44,10 @@
 /*! Maximum packet size, in bytes, including the length header. */
 #define TVM_CRT_MAX_PACKET_SIZE_BYTES 8192
 
+/*! Bytes of RPC messages buffered while the device processes one, half the UART ring buffer
+ * for their escapes. */
+#define TVM_CRT_RPC_RECEIVE_WINDOW_BYTES 2048
+
 /*! Maximum supported string length in dltype, e.g. "int8", "int16", "float32" */
 #define TVM_CRT_MAX_STRLEN_DLTYPE 10
 
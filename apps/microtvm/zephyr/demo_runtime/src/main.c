@@ -177,15 +177,14 @@ tvm_crt_error_t TVMPlatformTimerStop(double* elapsed_time_seconds) {
   gpio_pin_set(led0_pin, LED0_PIN, 0);
 #endif
 
-  // compute how long the work took
+  // compute how long the work took. the unsigned difference is right across
+  // one rollover of the cycle counter, the coarse-grained timer covers longer
+  // runs below.
   uint32_t cycles_spent = stop_time - g_utvm_start_time;
-  if (stop_time < g_utvm_start_time) {
-    // we rolled over *at least* once, so correct the rollover it was *only*
-    // once, because we might still use this result
-    cycles_spent = ~((uint32_t)0) - (g_utvm_start_time - stop_time);
-  }
 
-  uint32_t ns_spent = (uint32_t)k_cyc_to_ns_floor64(cycles_spent);
+  // 64 bits, as a uint32_t of nanoseconds wraps after ~4.3 s, well before the
+  // cycle counter does on most boards
+  uint64_t ns_spent = k_cyc_to_ns_floor64(cycles_spent);
   double hw_clock_res_us = ns_spent / 1000.0;
 
   // need to grab time remaining *before* stopping. when stopped, this function
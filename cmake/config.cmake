@@ -90,6 +90,9 @@ set(USE_MICRO OFF)
 # Whether enable RPC runtime
 set(USE_RPC ON)
 
+# Whether to compress the large messages of RPC sessions that ask for it with lz4
+set(USE_RPC_LZ4 OFF)
+
 # Whether to build the C++ RPC server binary
 set(USE_CPP_RPC OFF)
 
@@ -102,6 +105,10 @@ set(USE_GRAPH_EXECUTOR ON)
 # Whether enable tiny graph executor with CUDA Graph
 set(USE_GRAPH_EXECUTOR_CUDA_GRAPH OFF)
 
+# Whether enable the AOT executor, running the models compiled with --executor=aot
+# on the C++ runtime.
+set(USE_AOT_EXECUTOR ON)
+
 # Whether to enable the profiler for the graph executor and vm
 set(USE_PROFILER ON)
 
@@ -153,6 +160,9 @@ set(USE_OPENMP none)
 # Whether use contrib.random in runtime
 set(USE_RANDOM ON)
 
+# Whether to read the Linux perf hardware counters of the CPU in the profiler
+set(USE_PERF_COUNTERS OFF)
+
 # Whether use NNPack
 set(USE_NNPACK OFF)
 
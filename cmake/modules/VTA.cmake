@@ -109,9 +109,8 @@ elseif(PYTHON)
       file(GLOB DE10_FPGA_RUNTIME_SRCS ${VTA_HW_PATH}/src/de10pro/*.cc ${VTA_HW_PATH}/src/*.cc)
       list(APPEND FPGA_RUNTIME_SRCS ${DE10_FPGA_RUNTIME_SRCS})
     elseif(${VTA_TARGET} STREQUAL "intelfocl")  # Intel OpenCL for FPGA rules
-      file(GLOB FOCL_SRC ${VTA_HW_PATH}/src/oclfpga/*.cc)
+      file(GLOB FOCL_SRC vta/runtime/oclfpga/*.cc)
       list(APPEND FPGA_RUNTIME_SRCS ${FOCL_SRC})
-      list(APPEND FPGA_RUNTIME_SRCS ${VTA_HW_PATH}/src/vmem/virtual_memory.cc ${VTA_HW_PATH}/src/vmem/virtual_memory.h)
     endif()
     # Target lib: vta
     add_library(vta SHARED ${FPGA_RUNTIME_SRCS})
@@ -142,7 +141,30 @@ elseif(PYTHON)
     elseif(${VTA_TARGET} STREQUAL "intelfocl")  # Intel OpenCL for FPGA rules
       target_include_directories(vta PUBLIC 3rdparty)
       set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -std=c++17")
+      # The driver launches the instruction streams without waiting for them
+      target_compile_definitions(vta PUBLIC VTA_DEVICE_ASYNC=1)
       target_link_libraries(vta -lOpenCL)
+
+      # Host-side tests of the driver, the test defines a mock of the OpenCL API in place of
+      # libOpenCL. Create the `vtatest` target if we can find GTest.
+      find_path(GTEST_INCLUDE_DIR gtest/gtest.h)
+      find_library(GTEST_LIB gtest "$ENV{GTEST_LIB}")
+      if(GTEST_INCLUDE_DIR AND GTEST_LIB)
+        add_executable(oclfpga_device_test vta/tests/cpp/oclfpga_device_test.cc ${FOCL_SRC})
+        target_include_directories(oclfpga_device_test PUBLIC vta/runtime)
+        target_include_directories(oclfpga_device_test SYSTEM PUBLIC ${VTA_HW_PATH}/include)
+        target_include_directories(oclfpga_device_test SYSTEM PUBLIC ${GTEST_INCLUDE_DIR})
+        target_compile_definitions(oclfpga_device_test PUBLIC
+          DMLC_USE_LOGGING_LIBRARY=<tvm/runtime/logging.h> VTA_DEVICE_ASYNC=1)
+        foreach(__def ${VTA_DEFINITIONS})
+          string(SUBSTRING ${__def} 3 -1 __strip_def)
+          target_compile_definitions(oclfpga_device_test PUBLIC ${__strip_def})
+        endforeach()
+        target_link_libraries(oclfpga_device_test PRIVATE tvm_runtime ${GTEST_LIB} pthread dl)
+        set_target_properties(oclfpga_device_test PROPERTIES EXCLUDE_FROM_ALL 1)
+        set_target_properties(oclfpga_device_test PROPERTIES EXCLUDE_FROM_DEFAULT_BUILD 1)
+        add_custom_target(vtatest DEPENDS oclfpga_device_test)
+      endif()
     endif()
   endif()
 
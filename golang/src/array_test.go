@@ -612,3 +612,77 @@ func TestArrayCopySliceFloat64(t *testing.T) {
         }
     }
 }
+
+// Write through a slice view of an Array and read back through a copy.
+func TestArraySliceView(t *testing.T) {
+    arr, err := Empty([]int64{2, 8}, "float32")
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+
+    view, err := arr.AsSliceView()
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+
+    data := view.([]float32)
+    if len(data) != 16 {
+        t.Errorf("Data expected Len: 16 Got :%v\n", len(data))
+        return
+    }
+    for i := range data {
+        data[i] = float32(i)
+    }
+
+    ret, err := arr.AsSlice()
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+    dataRet := ret.([]float32)
+    for i := range dataRet {
+        if dataRet[i] != float32(i) {
+            t.Errorf("Data expected: %v Got :%v\n", data, dataRet)
+            return
+        }
+    }
+}
+
+// Export an Array through DLPack and wrap it back, sharing the data.
+func TestArrayDLPack(t *testing.T) {
+    arr, err := Empty([]int64{4}, "int32")
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+    arr.CopyFrom([]int32{1, 2, 3, 4})
+
+    managed, err := arr.ToDLPack()
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+    arr2, err := FromDLPack(managed)
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+
+    view, err := arr2.AsSliceView()
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+    view.([]int32)[0] = 10
+
+    ret, err := arr.AsSlice()
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+    if ret.([]int32)[0] != 10 {
+        t.Errorf("Expected shared data 10 got :%v\n", ret.([]int32)[0])
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \brief gotvm package source for asynchronous Function calls.
+ * \file async.go
+ */
+
+package gotvm
+
+import (
+    "runtime"
+    "sync"
+)
+
+// AsyncResult is the outcome of an asynchronous Function call.
+type AsyncResult struct {
+    // Value is the return value of the call, nil on error.
+    Value *Value
+    // Err is the error of the call if any.
+    Err error
+}
+
+// asyncCall is a call queued on an Executor.
+type asyncCall struct {
+    function *Function
+    args []interface{}
+    result chan AsyncResult
+}
+
+// Executor runs Function calls on a fixed number of OS threads.
+//
+// A native call blocks the OS thread of its goroutine until it returns, so a goroutine
+// per in-flight inference costs a thread each. The calls of an Executor queue instead,
+// without blocking the callers, and run on its workers. Each worker is locked to its
+// thread, which also keeps the thread local error of TVM with the call that set it.
+type Executor struct {
+    calls chan asyncCall
+    wait sync.WaitGroup
+}
+
+// NewExecutor starts an Executor.
+//
+// `numWorkers` is the number of calls run at the same time, runtime.NumCPU() if not positive.
+//
+// returns pointer to the Executor.
+func NewExecutor(numWorkers int) (executor *Executor) {
+    if numWorkers <= 0 {
+        numWorkers = runtime.NumCPU()
+    }
+    executor = &Executor{calls: make(chan asyncCall, numWorkers)}
+    executor.wait.Add(numWorkers)
+    for ii := 0; ii < numWorkers; ii++ {
+        go executor.work()
+    }
+    return
+}
+
+func (executor *Executor) work() {
+    defer executor.wait.Done()
+    runtime.LockOSThread()
+    defer runtime.UnlockOSThread()
+    for call := range executor.calls {
+        value, err := call.function.Invoke(call.args...)
+        call.result <- AsyncResult{value, err}
+    }
+}
+
+// InvokeAsync queues a call of the Function with given arguments.
+//
+// The arguments, e.g. the Arrays, have to stay alive until the call completes.
+//
+// returns the channel receiving the AsyncResult of the call once it completes.
+func (executor *Executor) InvokeAsync(function *Function,
+                                      args ...interface{}) (result <-chan AsyncResult) {
+    resultChan := make(chan AsyncResult, 1)
+    go func() {
+        executor.calls <- asyncCall{function, args, resultChan}
+    }()
+    result = resultChan
+    return
+}
+
+// Close stops the Executor once the queued calls complete.
+func (executor *Executor) Close() {
+    close(executor.calls)
+    executor.wait.Wait()
+}
+
+var defaultExecutor *Executor
+var defaultExecutorOnce sync.Once
+
+// InvokeAsync calls the TVM packed function referred by the handle with given arguments
+// on the default Executor, of runtime.NumCPU() workers.
+//
+// returns the channel receiving the AsyncResult of the call once it completes.
+func (tvmfunction *Function) InvokeAsync(args ...interface{}) (result <-chan AsyncResult) {
+    defaultExecutorOnce.Do(func() {
+        defaultExecutor = NewExecutor(0)
+    })
+    return defaultExecutor.InvokeAsync(tvmfunction, args...)
+}
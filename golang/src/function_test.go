@@ -133,6 +133,43 @@ func TestFunctionConvert(t *testing.T) {
     }
 }
 
+// Check InvokeAsync API
+func TestFunctionInvokeAsync(t *testing.T) {
+    sampleCb := func (args ...*Value) (retVal interface{}, err error) {
+        retVal = args[0].AsInt64() * 2
+        return
+    }
+
+    fhandle, err := ConvertFunction(sampleCb)
+    if err != nil {
+        t.Error(err.Error())
+        return
+    }
+
+    executor := NewExecutor(2)
+    defer executor.Close()
+    results := make([]<-chan AsyncResult, 8)
+    for ii := range results {
+        results[ii] = executor.InvokeAsync(fhandle, ii)
+    }
+    for ii := range results {
+        result := <-results[ii]
+        if result.Err != nil {
+            t.Error(result.Err.Error())
+            return
+        }
+        if result.Value.AsInt64() != int64(ii * 2) {
+            t.Errorf("Expected result :%v got:%v\n", ii * 2, result.Value.AsInt64())
+            return
+        }
+    }
+
+    result := <-fhandle.InvokeAsync(21)
+    if result.Err != nil || result.Value.AsInt64() != int64(42) {
+        t.Errorf("Expected result :42 got:%v %v\n", result.Value, result.Err)
+    }
+}
+
 func TestFunctionError(t *testing.T) {
     sampleCb := func (args ...*Value) (retVal interface{}, err error) {
         err = fmt.Errorf("Sample Error XYZABC");
@@ -219,6 +219,91 @@ func (parray Array) AsSlice() (retVal interface{}, err error) {
     return
 }
 
+// AsSliceView returns a slice sharing the data of a CPU Array, without copying it.
+//
+// Writes through the slice are writes to the Array, e.g. to fill the input of a module
+// in place. The slice is only valid while the Array is alive, hold the *Array returned by
+// Empty or FromDLPack (runtime.KeepAlive) for as long as the slice is used.
+//
+// returns the slice viewing the data inside Array and err of any.
+func (parray Array) AsSliceView() (retVal interface{}, err error) {
+    tensor := (*C.DLTensor)(unsafe.Pointer(parray))
+    if tensor.device.device_type != C.kDLCPU {
+        err = fmt.Errorf("Only the Arrays on CPU have slice views, got device type %v",
+                         tensor.device.device_type)
+        return
+    }
+    if tensor.strides != nil {
+        err = errors.New("Only the compact Arrays have slice views")
+        return
+    }
+    size := int64(1)
+    for _, dim := range parray.GetShape() {
+        size *= dim
+    }
+    if size == 0 {
+        return parray.AsSlice()
+    }
+    data := unsafe.Pointer(uintptr(tensor.data) + uintptr(tensor.byte_offset))
+
+    switch parray.GetDType() {
+        case "int8":
+            retVal = (*[1<<30]int8)(data)[:size:size]
+        case "int16":
+            retVal = (*[1<<30]int16)(data)[:size:size]
+        case "int32":
+            retVal = (*[1<<30]int32)(data)[:size:size]
+        case "int64":
+            retVal = (*[1<<30]int64)(data)[:size:size]
+        case "uint8":
+            retVal = (*[1<<30]uint8)(data)[:size:size]
+        case "uint16":
+            retVal = (*[1<<30]uint16)(data)[:size:size]
+        case "uint32":
+            retVal = (*[1<<30]uint32)(data)[:size:size]
+        case "uint64":
+            retVal = (*[1<<30]uint64)(data)[:size:size]
+        case "float32":
+            retVal = (*[1<<30]float32)(data)[:size:size]
+        case "float64":
+            retVal = (*[1<<30]float64)(data)[:size:size]
+        default:
+            err = fmt.Errorf("Given type not supported : %v", parray.GetDType())
+    }
+    return
+}
+
+// FromDLPack wraps a DLPack tensor of another framework into an Array, without copying.
+//
+// `managed` is the DLManagedTensor pointer the framework exported, the Array owns it and
+// calls its deleter once freed.
+//
+// returns pointer to Array on successful execution and error if any.
+func FromDLPack(managed unsafe.Pointer) (parray *Array, err error) {
+    var handle C.TVMArrayHandle
+    ret := C.TVMArrayFromDLPack((*C.DLManagedTensor)(managed), &handle)
+    if ret != 0 {
+        err = errors.New(getTVMLastError())
+        return
+    }
+    parray = newArrayHandle(uintptr(unsafe.Pointer(handle)))
+    return
+}
+
+// ToDLPack exports the Array as a DLPack tensor sharing its data, for another framework.
+//
+// returns the DLManagedTensor pointer, whose deleter the consumer calls, and error if any.
+func (parray Array) ToDLPack() (managed unsafe.Pointer, err error) {
+    var out *C.DLManagedTensor
+    ret := C.TVMArrayToDLPack((C.TVMArrayHandle)(unsafe.Pointer(parray.nativeCPtr())), &out)
+    if ret != 0 {
+        err = errors.New(getTVMLastError())
+        return
+    }
+    managed = unsafe.Pointer(out)
+    return
+}
+
 // GetNdim returns the number of dimentions in Array
 func (parray Array) GetNdim() (retVal int32) {
     retVal = int32(((*C.DLTensor)(unsafe.Pointer(parray))).ndim)
@@ -324,8 +409,14 @@ func Empty(shape []int64, args ...interface{}) (parray *Array, err error) {
     if err != nil {
         return
     }
+    parray = newArrayHandle(newArray)
+    return
+}
+
+// newArrayHandle wraps the native Array, freed by the finalizer of the returned handle.
+func newArrayHandle(nativeArray uintptr) (parray *Array) {
     handle := new(Array)
-    *handle = Array(newArray)
+    *handle = Array(nativeArray)
 
     finalizer := func (ahandle *Array) {
         nativeTVMArrayFree(*ahandle)
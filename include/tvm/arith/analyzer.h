@@ -489,8 +489,24 @@ class TVM_DLL Analyzer {
    * \return The result.
    *
    * \note Analyzer will call into sub-analyzers to get the result.
+   * \note When the PassContext enables arith.memoize_simplify, the results
+   *       are memoized in a cache shared by the analyzers of the process, keyed
+   *       by the structure of expr, the facts known on its vars and the
+   *       constraints of the context.
    */
   PrimExpr Simplify(const PrimExpr& expr, int steps = 2);
+
+ private:
+  friend class ConstraintContext;
+  /*!
+   * \brief The key of expr in the simplification cache.
+   * \param expr The expression.
+   * \param steps The steps of the simplification.
+   * \return The key.
+   */
+  ObjectRef SimplifyMemoKey(const PrimExpr& expr, int steps);
+  /*! \brief The constraints of the entered contexts, outermost first. */
+  std::vector<PrimExpr> constraints_;
 };
 
 }  // namespace arith
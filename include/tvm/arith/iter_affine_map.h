@@ -275,13 +275,17 @@ class IterSumExpr : public IterMapExpr {
  * \param predicate The predicate constraints on the input iterators
  * \param require_bijective A boolean flag that indicates whether the mapping should be bijective.
  * \param analyzer Analyzer used to get context information.
+ * \param allow_padding Whether the splits whose extent is not divisible may pad their
+ *        iterator, when the mapping need not be bijective. The padded iterator keeps its
+ *        source, below the original extent, and its splits cover the padded extent.
+ *        E.g. given x in [0, 10), [x / 4, x % 4] map to iterators of extents [3, 4].
  *
  * \return The detected pattern if a match exists,
  *         otherwise return an empty array.
  */
 Array<IterSumExpr> DetectIterMap(const Array<PrimExpr>& indices, const Map<Var, Range>& input_iters,
                                  const PrimExpr& predicate, bool require_bijective,
-                                 arith::Analyzer* analyzer);
+                                 arith::Analyzer* analyzer, bool allow_padding = false);
 
 /*!
  * \brief Detect if bindings can be written as
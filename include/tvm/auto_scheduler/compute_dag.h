@@ -38,6 +38,8 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/te/schedule.h>
 
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -165,6 +167,78 @@ class AccessAnalyzer : public ObjectRef {
   TVM_DEFINE_OBJECT_REF_METHODS(AccessAnalyzer, ObjectRef, AccessAnalyzerNode);
 };
 
+/*!
+ * \brief A cache of what is derived from the transform steps of the states, keyed by the
+ *  serialized steps (see ComputeDAG::SerializeSteps). The same steps give the same
+ *  schedule, so the states the search meets again, e.g. the best states of each round
+ *  or the unmutated copies of a population, skip the work on the schedule.
+ * \note The cache is locked, the states are processed in parallel. A copy of the object
+ *  holding it, e.g. of a ComputeDAG by a layout rewrite, starts with an empty cache.
+ * \tparam Value The type of the cached values.
+ * \tparam kMaxEntries The maximum number of entries.
+ */
+template <typename Value, size_t kMaxEntries = (1 << 14)>
+class TransformStepsCache {
+ public:
+  TransformStepsCache() = default;
+  TransformStepsCache(const TransformStepsCache&) {}
+  TransformStepsCache& operator=(const TransformStepsCache&) {
+    Clear();
+    return *this;
+  }
+
+  /*!
+   * \brief Look up the value of the serialized steps.
+   * \param key The serialized steps.
+   * \param value The value found.
+   * \return Whether the value is cached.
+   */
+  bool Lookup(const std::string& key, Value* value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    *value = it->second;
+    return true;
+  }
+
+  /*!
+   * \brief Cache the value of the serialized steps.
+   * \param key The serialized steps.
+   * \param value The value.
+   */
+  void Insert(const std::string& key, const Value& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Start over rather than track the recency of the entries
+    if (entries_.size() >= kMaxEntries) entries_.clear();
+    entries_[key] = value;
+  }
+
+  /*! \brief Drop all the cached values. */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+  }
+
+ private:
+  /*! \brief The values, by the serialized steps. */
+  std::unordered_map<std::string, Value> entries_;
+  /*! \brief The lock of the entries. */
+  std::mutex mutex_;
+};
+
+/*!
+ * \brief The TVM schedule replayed from a prefix of transform steps, with the stages and axes
+ *  the next steps apply to. See ComputeDAG::ApplySteps.
+ */
+struct ReplaySnapshot {
+  /*! \brief The schedule after the steps of the prefix. */
+  te::Schedule schedule;
+  /*! \brief The stages of the ops of the state, in the schedule. */
+  Array<te::Stage> stages;
+  /*! \brief The axes of the stages. */
+  StageToAxesMap stage_to_axes;
+};
+
 /*! \brief The auto-scheduler's computational graph and related program analyses. */
 class ComputeDAGNode : public Object {
  public:
@@ -181,6 +255,10 @@ class ComputeDAGNode : public Object {
   State init_state;
   /*! \brief The static read-write access analyzer. */
   AccessAnalyzer access_analyzer;
+  /*! \brief The ranges of the iterators of each stage inferred for the states. */
+  mutable TransformStepsCache<Array<Array<Range>>> bound_cache;
+  /*! \brief The schedules replayed from prefixes of the steps of the states. */
+  mutable TransformStepsCache<ReplaySnapshot, 1024> replay_cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("tensors", &tensors);
@@ -248,6 +326,8 @@ class ComputeDAG : public ObjectRef {
    * attr `layout_free_placeholders`.
    * \return A `te.schedule` and the an Array of `te.Tensor` to be used in `tvm.lower`
    * or `tvm.build`.
+   * \note Without layout rewrite, the replay resumes from the longest prefix of the steps
+   * whose schedule is in the replay cache, the states of a search sharing long prefixes.
    */
   std::pair<te::Schedule, Array<te::Tensor>> ApplySteps(
       const Array<Step>& transform_steps, Array<te::Stage>* stages = nullptr,
@@ -304,10 +384,26 @@ class ComputeDAG : public ObjectRef {
    */
   ComputeDAG ReplayAndGetDAG(const Array<Step>& steps) const;
 
+  /*!
+   * \brief Serialize the transform steps as in the measure records. The same serialized
+   *  steps give the same schedule, it keys what is derived from the steps of a state.
+   * \param transform_steps The transform steps.
+   * \return The serialized steps.
+   */
+  static std::string SerializeSteps(const Array<Step>& transform_steps);
+
   static constexpr const char* layout_free_placeholders_key = "layout_free_placeholders";
 
   TVM_DEFINE_OBJECT_REF_METHODS(ComputeDAG, ObjectRef, ComputeDAGNode);
   TVM_DEFINE_OBJECT_REF_COW_METHOD(ComputeDAGNode);
+
+ private:
+  /*!
+   * \brief Run the TE bound inference on the schedule of the transform steps of a state.
+   * \param pstate The state.
+   * \return The ranges of the iterators of each stage, empty for the inlined stages.
+   */
+  Array<Array<Range>> InferStageBounds(const StateNode* pstate) const;
 };
 
 /*!
@@ -28,8 +28,10 @@
 #include <tvm/auto_scheduler/compute_dag.h>
 #include <tvm/auto_scheduler/measure.h>
 #include <tvm/node/node.h>
+#include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <random>
 #include <vector>
 
 namespace tvm {
@@ -159,6 +161,95 @@ class PythonBasedModel : public CostModel {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PythonBasedModel, CostModel, PythonBasedModelNode);
 };
 
+/*!
+ * \brief A gradient boosted tree model whose inference runs natively.
+ *  The trees are trained in python, e.g. by XGBModel, and loaded into this model. The
+ *  predictions then extract the per-store features and walk the trees in c++, without
+ *  calling back into python. Like XGBModel, the score of a state is the sum of the
+ *  predictions of its stores (pack-sum).
+ */
+class TreeEnsembleModelNode : public CostModelNode {
+ public:
+  /*! \brief A node of the trees, a leaf when its feature is negative. */
+  struct TreeNode {
+    /*! \brief The index of the feature the node splits on. */
+    int feature;
+    /*! \brief The child the features below the threshold go to. */
+    int yes;
+    /*! \brief The child the other features go to. */
+    int no;
+    /*! \brief The child the missing (NaN) features go to. */
+    int missing;
+    /*! \brief The split threshold, or the value of a leaf. */
+    float value;
+  };
+
+  /*! \brief Pointer to the update function in python, which trains and loads the trees */
+  PackedFunc update_func;
+  /*! \brief The nodes of all trees */
+  std::vector<TreeNode> nodes;
+  /*! \brief The index of the root node of each tree */
+  std::vector<int> roots;
+  /*! \brief The bias added to the prediction of each store */
+  float base_score{0.0f};
+  /*! \brief The maximum number of extracted buffers of the features */
+  int max_n_bufs;
+  /*! \brief The random number generator of the predictions before the trees are loaded */
+  std::mt19937 rand_gen;
+
+  /*!
+   * \brief Load the trees, replacing the current ones.
+   * \param node_indices The int32 [n, 4] array of feature, yes, no and missing of the nodes,
+   *  the children index this array.
+   * \param node_values The float32 [n] array of the thresholds and the leaf values.
+   * \param tree_roots The int32 array of the root node of each tree.
+   * \param base_score The bias added to the prediction of each store.
+   */
+  void LoadTrees(const runtime::NDArray& node_indices, const runtime::NDArray& node_values,
+                 const runtime::NDArray& tree_roots, float base_score);
+
+  void Update(const Array<MeasureInput>& inputs, const Array<MeasureResult>& results) final;
+
+  void Predict(const SearchTask& task, const Array<State>& states,
+               std::vector<float>* scores) final;
+
+  void PredictStages(const SearchTask& task, const Array<State>& states,
+                     std::vector<float>* state_scores,
+                     std::vector<std::vector<float>>* stage_scores) final;
+
+  static constexpr const char* _type_key = "auto_scheduler.TreeEnsembleModel";
+  TVM_DECLARE_FINAL_OBJECT_INFO(TreeEnsembleModelNode, CostModelNode);
+
+ private:
+  /*!
+   * \brief Predict the score of each store of the states.
+   * \param task The search task of states
+   * \param states The input states
+   * \param state_scores The predicted scores for all states, -inf for the failed ones
+   * \param store_scores The predicted scores for all stores in all states
+   */
+  void PredictStores(const SearchTask& task, const Array<State>& states,
+                     std::vector<float>* state_scores,
+                     std::vector<std::vector<float>>* store_scores);
+};
+
+/*!
+ * \brief Managed reference to TreeEnsembleModelNode.
+ * \sa TreeEnsembleModelNode
+ */
+class TreeEnsembleModel : public CostModel {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param update_func The pointer to the update function defined in python
+   * \param max_n_bufs The maximum number of extracted buffers of the features
+   * \param seed The random seed of the predictions before the trees are loaded
+   */
+  TreeEnsembleModel(PackedFunc update_func, int max_n_bufs, int seed);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(TreeEnsembleModel, CostModel, TreeEnsembleModelNode);
+};
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
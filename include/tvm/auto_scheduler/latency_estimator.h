@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/latency_estimator.h
+ * \brief The latency estimates of the operators, for the decisions of the graph level passes.
+ *
+ * The estimator answers from the measured records of the tuning logs first. The
+ * functions without a record fall back to a cost model, a registered one or else
+ * an analytic roofline of their loop nests.
+ */
+
+#ifndef TVM_AUTO_SCHEDULER_LATENCY_ESTIMATOR_H_
+#define TVM_AUTO_SCHEDULER_LATENCY_ESTIMATOR_H_
+
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/target/target.h>
+#include <tvm/tir/function.h>
+
+#include <string>
+#include <unordered_map>
+
+namespace tvm {
+namespace auto_scheduler {
+
+/*! \brief The attribute of a PrimFunc holding the workload key of its tuning records. */
+constexpr const char* kWorkloadKeyAttr = "auto_scheduler.workload_key";
+
+/*! \brief The latency estimator of the operators. */
+class LatencyEstimatorNode : public Object {
+ public:
+  /*! \brief The best measured latencies in seconds, by workload key then target string. */
+  std::unordered_map<std::string, std::unordered_map<std::string, double>> measured;
+  /*! \brief The best measured latencies in seconds, by workload key then target kind. */
+  std::unordered_map<std::string, std::unordered_map<std::string, double>> measured_by_kind;
+  /*!
+   * \brief The cost model of the functions without a record, taking the PrimFunc and
+   * the Target and returning the latency in seconds. The analytic model when null.
+   */
+  runtime::PackedFunc cost_model;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {}
+
+  /*!
+   * \brief Load the measured records of an auto_scheduler log file.
+   * \param filename The log file.
+   */
+  void LoadRecords(const String& filename);
+
+  /*!
+   * \brief Record a measured latency, keeping the best one of each workload and target.
+   * \param workload_key The workload key.
+   * \param target The target measured on.
+   * \param latency The latency in seconds.
+   */
+  void AddRecord(const String& workload_key, const Target& target, double latency);
+
+  /*!
+   * \brief Look up the measured latency of a workload.
+   * \param workload_key The workload key.
+   * \param target The target.
+   * \param latency The latency in seconds, set when a record exists.
+   * \return Whether a record exists.
+   */
+  bool LookupRecord(const String& workload_key, const Target& target, double* latency) const;
+
+  /*!
+   * \brief Estimate the latency of a function, from the record of its workload key
+   * attribute if any, else from the cost model.
+   * \param func The function.
+   * \param target The target it runs on.
+   * \return The latency in seconds.
+   */
+  double EstimateLatency(const tir::PrimFunc& func, const Target& target) const;
+
+  /*!
+   * \brief The analytic roofline estimate of a function: the larger of its arithmetic
+   * time, on the parallel and vector lanes its loops use, and of the time to move its
+   * arguments from memory.
+   * \param func The function.
+   * \param target The target it runs on.
+   * \return The latency in seconds.
+   */
+  static double AnalyticLatency(const tir::PrimFunc& func, const Target& target);
+
+  static constexpr const char* _type_key = "auto_scheduler.LatencyEstimator";
+  TVM_DECLARE_FINAL_OBJECT_INFO(LatencyEstimatorNode, Object);
+};
+
+/*!
+ * \brief Managed reference to LatencyEstimatorNode.
+ * \sa LatencyEstimatorNode
+ */
+class LatencyEstimator : public ObjectRef {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param log_files The auto_scheduler log files to load the records of.
+   */
+  explicit LatencyEstimator(Array<String> log_files);
+
+  /*! \return The estimator shared by the passes and tools of the process. */
+  static LatencyEstimator Global();
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(LatencyEstimator, ObjectRef, LatencyEstimatorNode);
+};
+
+}  // namespace auto_scheduler
+}  // namespace tvm
+
+#endif  // TVM_AUTO_SCHEDULER_LATENCY_ESTIMATOR_H_
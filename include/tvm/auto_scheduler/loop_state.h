@@ -114,6 +114,7 @@ class StageNode : public Object {
     v->Visit("compute_at", &compute_at);
   }
 
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "auto_scheduler.Stage";
   TVM_DECLARE_FINAL_OBJECT_INFO(StageNode, Object);
 };
@@ -170,6 +171,7 @@ class AttachMapNode : public Object {
   /*! \brief A Map to store the mapping of iterator to the stages attached to it. */
   std::unordered_map<IterKey, std::vector<StageKey>, IterKeyHash> iter_to_attached_stages;
 
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "auto_scheduler.AttachMap";
   TVM_DECLARE_FINAL_OBJECT_INFO(AttachMapNode, Object);
 };
@@ -262,6 +264,7 @@ class StateNode : public Object {
     v->Visit("concrete", &concrete);
   }
 
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "auto_scheduler.State";
   TVM_DECLARE_FINAL_OBJECT_INFO(StateNode, Object);
 };
@@ -40,6 +40,7 @@
 
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/auto_scheduler/search_task.h>
+#include <tvm/runtime/packed_func.h>
 
 #include <string>
 #include <unordered_map>
@@ -320,6 +321,22 @@ class ProgramRunnerNode : public Object {
   virtual Array<MeasureResult> Run(const Array<MeasureInput>& inputs,
                                    const Array<BuildResult>& build_results, int verbose) = 0;
 
+  /*!
+   * \brief Build and run the programs in a pipeline, without a barrier between the builds and
+   * the runs. The results are reported as they finish, in any order.
+   * \param builder The ProgramBuilder to build the programs.
+   * \param inputs An Array of MeasureInput.
+   * \param on_result Called with the index of each input and its MeasureResult.
+   * \param verbose Verbosity level. 0 for silent, 1 to output information during program
+   * running.
+   * \return Whether the programs were measured, false if the runner cannot pipeline this builder.
+   */
+  virtual bool RunPipelined(const ProgramBuilder& builder, const Array<MeasureInput>& inputs,
+                            const TypedPackedFunc<void(int, MeasureResult)>& on_result,
+                            int verbose) {
+    return false;
+  }
+
   static constexpr const char* _type_key = "auto_scheduler.ProgramRunner";
   TVM_DECLARE_BASE_OBJECT_INFO(ProgramRunnerNode, Object);
 };
@@ -419,6 +436,10 @@ class RPCRunnerNode : public ProgramRunnerNode {
   Array<MeasureResult> Run(const Array<MeasureInput>& inputs,
                            const Array<BuildResult>& build_results, int verbose) final;
 
+  bool RunPipelined(const ProgramBuilder& builder, const Array<MeasureInput>& inputs,
+                    const TypedPackedFunc<void(int, MeasureResult)>& on_result,
+                    int verbose) final;
+
   static constexpr const char* _type_key = "auto_scheduler.RPCRunner";
   TVM_DECLARE_FINAL_OBJECT_INFO(RPCRunnerNode, ProgramRunnerNode);
 };
@@ -478,10 +499,31 @@ class ProgramMeasurerNode : public Object {
   int verbose;
   /*! \brief The number of allowed maximum continuous error before forcely stopping the tuning */
   int max_continuous_error;
+  /*!
+   * \brief The known results of the programs, keyed by MeasureCacheKey. The inputs found here are
+   * not built or run again. It keeps the successful results and the deterministic build failures,
+   * and is not cleared by Reset.
+   */
+  std::unordered_map<std::string, MeasureResult> measure_cache;
 
   /*! \brief Reset book keeping variables */
   void Reset();
 
+  /*!
+   * \brief Add the records of a log file or a record store to the measure cache.
+   * \param filename The name of the log file or the path of the record store.
+   * \return The number of records added.
+   */
+  int LoadCache(const String& filename);
+
+  /*!
+   * \brief The key of an input in the measure cache: its workload key, target and serialized
+   * transform steps.
+   * \param input The measure input.
+   * \return The key.
+   */
+  static std::string MeasureCacheKey(const MeasureInput& input);
+
   /*!
    * \brief Do measurement.
    * \param task The current SearchTask.
@@ -492,6 +534,13 @@ class ProgramMeasurerNode : public Object {
    */
   Array<MeasureResult> Measure(const SearchTask& task, const SearchPolicy& policy,
                                const Array<MeasureInput>& inputs, int batch_size = -1);
+  /*!
+   * \brief Update the book keeping with one measure result.
+   * \param task The current SearchTask.
+   * \param input The measured input.
+   * \param result The result of the input.
+   */
+  void UpdateBest(const SearchTask& task, const MeasureInput& input, const MeasureResult& result);
   /*!
    * \brief Do measurement silently.
    * This API will not print the measure results to screen.
@@ -29,6 +29,7 @@
 
 #include <fstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 namespace tvm {
@@ -113,6 +114,134 @@ class RecordReader : public ObjectRef {
   TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RecordReader, ObjectRef, RecordReaderNode);
 };
 
+/*!
+ * \brief An indexed, append-only binary store of measure records.
+ *
+ * The records are kept in the file at `path`, each one a header of a magic number and the
+ * length, followed by the record in the json format of the log files. The file at
+ * `path + ".idx"` indexes the best successful record of each workload key and target, so
+ * the best record of a workload is found without reading the others. Both files are only
+ * appended to, under a file lock, so many tuning processes can append to the same store.
+ * The index is rebuilt from the records when it is missing.
+ */
+class RecordStoreNode : public Object {
+ public:
+  /*! \brief The path of the record file. */
+  String path;
+
+  /*!
+   * \brief Append measure records to the store.
+   * \param inputs The MeasureInputs to be written.
+   * \param results The MeasureResults to be written.
+   */
+  void Append(const Array<MeasureInput>& inputs, const Array<MeasureResult>& results);
+
+  /*!
+   * \brief Read the best successful record of a workload.
+   * \param workload_key The workload key.
+   * \param target The target, the records of the same target string first,
+   *  then the ones of the same target kind.
+   * \param inp A pointer to a MeasureInputNode used to store the return value.
+   * \param res A pointer to a MeasureResultNode used to store the return value.
+   * \return Whether such a record exists.
+   */
+  bool BestRecord(const String& workload_key, const Target& target, MeasureInputNode* inp,
+                  MeasureResultNode* res);
+
+  /*!
+   * \brief Read the best successful record of every workload key and target.
+   * \return The MeasureInputs and MeasureResults of the best records.
+   */
+  std::pair<Array<MeasureInput>, Array<MeasureResult>> BestRecords();
+
+  /*!
+   * \brief Read all records of the store, in the order they were appended.
+   * \return The MeasureInputs and MeasureResults of the records.
+   */
+  std::pair<Array<MeasureInput>, Array<MeasureResult>> ReadAll();
+
+  /*! \brief Read the index entries appended since the last read, e.g. by other processes. */
+  void Reload();
+
+  static constexpr const char* _type_key = "auto_scheduler.RecordStore";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RecordStoreNode, Object);
+
+ private:
+  /*! \brief The cost and the file offset of the best record of an index key. */
+  struct IndexEntry {
+    double cost;
+    uint64_t offset;
+  };
+
+  /*! \brief Record an index entry, keeping the best one of each key. */
+  void AddIndexEntry(const std::string& key, IndexEntry entry);
+  /*! \brief Read the record at an offset of the record file. */
+  bool ReadRecordAt(uint64_t offset, MeasureInputNode* inp, MeasureResultNode* res);
+  /*! \brief Rebuild the index file from the records. */
+  void RebuildIndex();
+  /*! \brief Truncate the torn record and index entry left by a killed writer, under the lock. */
+  void RepairTail();
+
+  /*! \brief The best record of each workload key and target string. */
+  std::unordered_map<std::string, IndexEntry> best_by_target_;
+  /*! \brief The best record of each workload key and target kind. */
+  std::unordered_map<std::string, IndexEntry> best_by_kind_;
+  /*! \brief The size of the index file read so far. */
+  uint64_t index_read_size_{0};
+  /*! \brief The sizes of the record and index files known to hold whole entries only. */
+  uint64_t records_checked_size_{0};
+  uint64_t index_checked_size_{0};
+};
+
+/*!
+ * \brief Managed reference to RecordStoreNode.
+ * \sa RecordStoreNode
+ */
+class RecordStore : public ObjectRef {
+ public:
+  /*!
+   * \brief The constructor, creating the store when it does not exist.
+   * \param path The path of the record file
+   */
+  explicit RecordStore(String path);
+
+  /*!
+   * \brief Whether a file is a record store, rather than a json log file.
+   * \param path The path of the file
+   */
+  static bool IsRecordStore(const String& path);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RecordStore, ObjectRef, RecordStoreNode);
+};
+
+/*! \brief Callback for appending the input and results of measurements to a record store */
+class RecordToStoreNode : public MeasureCallbackNode {
+ public:
+  /*! \brief The record store. */
+  RecordStore store;
+
+  void Callback(const SearchPolicy& policy, const Array<MeasureInput>& inputs,
+                const Array<MeasureResult>& results) final;
+
+  static constexpr const char* _type_key = "auto_scheduler.RecordToStore";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RecordToStoreNode, MeasureCallbackNode);
+};
+
+/*!
+ * \brief Managed reference to RecordToStoreNode.
+ * \sa RecordToStoreNode
+ */
+class RecordToStore : public MeasureCallback {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param path The path of the record store
+   */
+  explicit RecordToStore(String path);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RecordToStore, MeasureCallback, RecordToStoreNode);
+};
+
 /*!
  * \brief Append measure records to an output stream.
  * \param os A pointer to a output stream.
@@ -134,6 +263,27 @@ void WriteMeasureRecords(std::ostream* os, const Array<MeasureInput>& inputs,
 void ReadMeasureRecord(const std::string& str, MeasureInputNode* inp, MeasureResultNode* res,
                        std::string* log_version);
 
+/*!
+ * \brief Read all records of a json log file or a record store.
+ * \param filename The name of the log file or the path of the record store.
+ * \return The MeasureInputs and MeasureResults of the records.
+ */
+std::pair<Array<MeasureInput>, Array<MeasureResult>> ReadRecordFile(const String& filename);
+
+/*!
+ * \brief Append the records of a json log file to a record store.
+ * \param log_file The name of the log file.
+ * \param store The record store.
+ */
+void ConvertRecordsToStore(const String& log_file, const RecordStore& store);
+
+/*!
+ * \brief Append the records of a record store to a json log file.
+ * \param store The record store.
+ * \param log_file The name of the log file.
+ */
+void ConvertStoreToRecords(const RecordStore& store, const String& log_file);
+
 }  // namespace auto_scheduler
 }  // namespace tvm
 
@@ -112,6 +112,39 @@ class PreloadMeasuredStates : public SearchCallback {
                                         PreloadMeasuredStatesNode);
 };
 
+/*! \brief Preload the best states of similar tasks from a log file to warm start the search.
+ * The records of the tasks with the same op type and the nearest shapes are adapted to the
+ * current task, and join the initial population of the first search round. */
+class PreloadSimilarTaskStatesNode : public SearchCallbackNode {
+ public:
+  /*! \brief The name of the record log file. */
+  String filename;
+  /*! \brief The maximum number of preloaded states. */
+  int max_states;
+
+  void Callback(SearchPolicyNode* policy) final;
+
+  static constexpr const char* _type_key = "auto_scheduler.PreloadSimilarTaskStates";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PreloadSimilarTaskStatesNode, SearchCallbackNode);
+};
+
+/*!
+ * \brief Managed reference to PreloadSimilarTaskStatesNode.
+ * \sa PreloadSimilarTaskStatesNode
+ */
+class PreloadSimilarTaskStates : public SearchCallback {
+ public:
+  /*!
+   * \brief The constructor.
+   * \param filename The name of the record log file.
+   * \param max_states The maximum number of preloaded states.
+   */
+  PreloadSimilarTaskStates(String filename, int max_states);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PreloadSimilarTaskStates, SearchCallback,
+                                        PreloadSimilarTaskStatesNode);
+};
+
 /*! \brief Attribute keys of ops used for SearchPolicy. */
 struct SearchPolicyKey {
   /*! \brief Always apply unroll to the inner most iterator of the specificed iterators. */
@@ -121,6 +154,11 @@ struct SearchPolicyKey {
   /*! \brief The specified iterators are indices of const tensors in "fake reduction". */
   static constexpr const char* simplify_const_tensor_indices =
       "auto_scheduler_simplify_const_tensor_indices";
+  /*!
+   * \brief The compute op is a VTA gemm, whose innermost axes are tensorized with the intrinsic
+   * registered as auto_scheduler.tensor_intrin.<value>.
+   */
+  static constexpr const char* vta_gemm = "auto_scheduler_vta_gemm";
 };
 
 /*!
@@ -168,6 +206,16 @@ class SearchPolicyNode : public Object {
    */
   void PreloadMeasuredStates(const String& log_file);
 
+  /*!
+   * \brief Preload the best states of similar tasks from a log file, adapted to the current
+   * task, to warm start the search.
+   * The similar tasks have the same op type, i.e. the same workload key but for the numbers,
+   * and the same target kind. The nearest shapes go first, then the fastest states.
+   * \param log_file The name of the record log file.
+   * \param max_states The maximum number of preloaded states.
+   */
+  void PreloadSimilarTaskStates(const String& log_file, int max_states);
+
   /*!
    * \brief Call SearchCallback with the current SearchPolicyNode
    * \param callbacks SearchCallback to be called.
@@ -189,6 +237,9 @@ class SearchPolicyNode : public Object {
   std::vector<State> measured_states_vector_;
   /*! \brief The throughputs of already measured states */
   std::vector<float> measured_states_throughputs_;
+  /*! \brief The states adapted from similar tasks, not measured yet.
+   *  They join the initial population of the next search round. */
+  std::vector<State> warm_start_states_;
 };
 
 /*!
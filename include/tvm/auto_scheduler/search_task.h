@@ -125,6 +125,8 @@ class SearchTaskNode : public Object {
   LayoutRewriteOption layout_rewrite_option;
   /*! \brief Names of some user defined input data used in program measuring. */
   Array<String> task_input_names;
+  /*! \brief The per-store features extracted for the states, see GetPerStoreFeaturesFromStates. */
+  mutable TransformStepsCache<std::vector<float>> feature_cache;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("compute_dag", &compute_dag);
@@ -101,7 +101,9 @@ enum class IteratorAnnotation : int {
   /*! \brief This iterator has been bind to threadIdx.y. */
   kThreadZ = 10,
   /*! \brief This iterator has been mapped with a tensorize intrinsic. */
-  kTensorize = 11
+  kTensorize = 11,
+  /*! \brief This iterator has been bind to cthread, a virtual thread with private buffers. */
+  kCThread = 12
 };
 
 extern const char* IteratorAnnotationString[];
@@ -133,6 +135,7 @@ class IteratorNode : public Object {
     v->Visit("annotation", &annotation);
   }
 
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "auto_scheduler.Iterator";
   TVM_DECLARE_FINAL_OBJECT_INFO(IteratorNode, Object);
 };
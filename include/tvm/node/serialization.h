@@ -47,5 +47,35 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief Save the node as well as all the node it depends on in a binary format.
+ *
+ *  Unlike SaveJSON, the tensors are stored raw, with their data aligned to kAllocAlignment
+ *  in the blob, so that LoadBinaryFile can map them.
+ *
+ * \param node The node to save.
+ * \return The binary representation of the node.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load tvm Node object saved by SaveBinary.
+ * \param blob The binary blob to load from.
+ *
+ * \return The loaded node, its tensors are copied from the blob.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& blob);
+
+/*!
+ * \brief Load tvm Node object from a file saved by SaveBinary.
+ *
+ *  The tensors alias a copy-on-write mapping of the file where possible, so that they are
+ *  neither copied nor read before their first use.
+ *
+ * \param file_name The file to load from.
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinaryFile(const std::string& file_name);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
@@ -26,9 +26,13 @@
 #include <tvm/node/functor.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/data_type.h>
+#include <tvm/support/with.h>
 
 #include <functional>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace tvm {
 
@@ -84,6 +88,73 @@ class StructuralHash : public BaseValueHash {
   TVM_DLL size_t operator()(const ObjectRef& key) const;
 };
 
+/*!
+ * \brief A scope in which the structural hashes are memoized across the hash calls.
+ *
+ *  The IR nodes are immutable, so within the scope the hash of an object hashed before is
+ *  reused instead of being computed again. Two kinds of hashes are memoized:
+ *
+ *  - The hash of an object hashed as the root of a call. Its free variables and graph nodes
+ *    are numbered from zero at the object, so the hash does not depend on where it is used.
+ *  - The hash of a closed subtree, which has no variables, graph nodes or maps keyed by
+ *    objects. Its hash is the same in any enclosing IR, and is reused inside other roots.
+ *
+ *  The subtrees that number variables or graph nodes depend on the numbering of the
+ *  enclosing IR, and are hashed again. The hashes are the same as outside of the scope.
+ *
+ *  The scope keeps the hashed objects alive, so that their addresses are not reused and
+ *  CopyOnWrite copies them instead of mutating them in place. The scope is thread local.
+ *
+ * \code
+ *  {
+ *    With<StructuralHashCache> scope;
+ *    size_t lhs = StructuralHash()(func);
+ *    // reuses the hash of func.
+ *    size_t rhs = StructuralHash()(func);
+ *  }
+ * \endcode
+ */
+class StructuralHashCache {
+ public:
+  /*! \return The innermost scope of the thread, nullptr outside of any scope. */
+  TVM_DLL static StructuralHashCache* Current();
+  /*!
+   * \brief Lookup the memoized hash of an object hashed as a root.
+   * \param object The object.
+   * \param map_free_vars Whether the free variables were mapped.
+   * \param hash The result hash.
+   * \return Whether the hash is memoized.
+   */
+  bool LookupRootHash(const ObjectRef& object, bool map_free_vars, size_t* hash) const {
+    auto it = root_hash_[map_free_vars].find(object);
+    if (it == root_hash_[map_free_vars].end()) return false;
+    *hash = it->second;
+    return true;
+  }
+
+ private:
+  friend class With<StructuralHashCache>;
+  friend class VarCountingSHashHandler;
+  /*! \brief The hash of a closed subtree, with the objects memoized while hashing it. */
+  struct ClosedHash {
+    size_t hash;
+    std::vector<std::pair<ObjectRef, size_t>> descendants;
+  };
+  using HashMap = std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual>;
+  using ClosedHashMap = std::unordered_map<ObjectRef, ClosedHash, ObjectPtrHash, ObjectPtrEqual>;
+
+  StructuralHashCache() = default;
+  TVM_DLL void EnterWithScope();
+  TVM_DLL void ExitWithScope();
+
+  /*! \brief The enclosing scope. */
+  StructuralHashCache* prev_{nullptr};
+  /*! \brief The hashes of the roots, indexed by map_free_vars. */
+  HashMap root_hash_[2];
+  /*! \brief The hashes of the closed subtrees, indexed by map_free_vars. */
+  ClosedHashMap closed_hash_[2];
+};
+
 /*!
  * \brief A Reducer class to reduce the structural hash value.
  *
@@ -279,6 +279,16 @@ TVM_DLL Map<GlobalVar, Array<Integer>> GetCalibrateOutputMap(const IRModule& mod
 TVM_DLL std::unordered_map<Expr, Device, runtime::ObjectPtrHash, runtime::ObjectPtrEqual>
 ContextAnalysis(const IRModule& mod, const Device& default_device);
 
+/*!
+ * \brief Count the multiply-accumulates of the conv2d, conv2d_transpose, dense and batch_matmul
+ *  calls of an expression, e.g. of a primitive function for the profiler.
+ *
+ * \param expr The expression, after type inference.
+ *
+ * \return The number of MACs, 0 without the counted calls.
+ */
+TVM_DLL int64_t CountMacs(const Expr& expr);
+
 }  // namespace relay
 }  // namespace tvm
 
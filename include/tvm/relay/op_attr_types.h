@@ -89,6 +89,13 @@ using TNonComputational = bool;
  */
 using TReshapeOp = bool;
 
+/*!
+ * \brief Mark the operator as able to write its output over an input of the
+ *        same type, as each output element only depends on the elements of
+ *        the inputs at the same position.
+ */
+using TOpInPlace = bool;
+
 /*!
  * \brief Mark the operator whether output shape is data dependent.
  */
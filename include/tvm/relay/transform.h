@@ -98,6 +98,14 @@ TVM_DLL Pass LazyGradientInit();
  */
 TVM_DLL Pass FoldConstant();
 
+/*!
+ * \brief Evaluate the layout transforms and other data movement calls over the constant
+ * weights, so that the weights are exported packed into the layouts of their kernels.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass PrepackWeights();
+
 /*!
  * \brief Fuse operations into expr into seperate functions.
  *
@@ -107,6 +115,27 @@ TVM_DLL Pass FoldConstant();
  */
 TVM_DLL Pass FuseOps(int fuse_opt_level = -1);
 
+/*!
+ * \brief Pack the calls to independent fused functions of injective ops into
+ *  calls to functions returning the tuple of their results.
+ *
+ * \param max_group The maximum number of calls packed together.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass HorizontalFuseOps(int max_group = 8);
+
+/*!
+ * \brief Recompute the cheap elementwise and broadcast values at their late uses instead of
+ * keeping them alive across the peak memory, until the peak meets a budget.
+ *
+ * \param memory_budget The budget of the peak memory in bytes. If it is -1 it will be read
+ * from the relay.backend.memory_budget pass config option, and 0 disables the pass.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass Rematerialize(int64_t memory_budget = -1);
+
 /*!
  * \brief The inverse operation of FuseOps. It transforms a fused program returned by
  * FuseOps into the program before FuseOps. (i.e. x == DefuseOps(FuseOps(x)))
@@ -218,6 +247,21 @@ TVM_DLL Pass SimplifyInference();
  */
 TVM_DLL Pass FastMath();
 
+/*!
+ * \brief Rewrite the float32 computations to float16 or bfloat16.
+ *
+ * The allowed ops run in the mixed precision type with a float32 accumulation, the following
+ * ops run in the mixed type when one of their inputs is, the other ops stay in float32.
+ *
+ * \param mixed_type The mixed precision type, float16 or bfloat16.
+ * \param allow_ops The names of the ops always converted.
+ * \param follow_ops The names of the ops converted when an input is converted.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass ToMixedPrecision(DataType mixed_type, Array<String> allow_ops,
+                              Array<String> follow_ops);
+
 /*!
  * \brief Find Dynamic ops and make them static
  *
@@ -229,6 +273,19 @@ TVM_DLL Pass FastMath();
  */
 TVM_DLL Pass DynamicToStatic();
 
+/*!
+ * \brief Specialize the main function for concrete shapes of its dynamically shaped inputs.
+ *
+ * Every specialization is a copy of the body with the inputs statically shaped, which the
+ * function dispatches to when the inputs have the shapes at runtime. Other shapes run the
+ * original, dynamic, body.
+ *
+ * \param shapes The shapes of the inputs, by input name, of each specialization.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass SpecializeShapes(Array<Map<String, Array<Integer>>> shapes);
+
 /*!
  * \brief Infer the type of an expression.
  *
@@ -431,6 +488,16 @@ TVM_DLL Pass SimplifyExpr();
  */
 TVM_DLL Pass ManifestAlloc(Target target_host, Map<tvm::Integer, tvm::Target> targets);
 
+/*!
+ * \brief Coalesce the storages of a static size allocated by ManifestAlloc into a few
+ * regions. The tensors whose lifetimes do not overlap share their offsets, and the
+ * storages of the iterations of the recursive functions are allocated once by their
+ * callers.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass CoalesceStorage();
+
 }  // namespace transform
 
 /*!
@@ -133,13 +133,20 @@ typedef struct {
  */
 typedef int (*FTVMParallelLambda)(int task_id, TVMParallelGroupEnv* penv, void* cdata);
 
+/*!
+ * \brief Flag of the num_task of TVMBackendParallelLaunch, set when the tasks synchronize with
+ *  TVMBackendParallelBarrier. Such tasks must all run at once on their own threads, so the
+ *  thread pool never schedules them dynamically.
+ */
+#define TVM_PARALLEL_LAUNCH_SYNC (1 << 30)
+
 /*!
  * \brief Backend function for running parallel jobs.
  *
  * \param flambda The parallel function to be launched.
  * \param cdata The closure data.
  * \param num_task Number of tasks to launch, can be 0, means launch
- *           with all available threads.
+ *           with all available threads. It may be or-ed with TVM_PARALLEL_LAUNCH_SYNC.
  *
  * \return 0 when no error is thrown, -1 when failure happens
  */
@@ -163,6 +163,8 @@ typedef struct {
 typedef void* TVMModuleHandle;
 /*! \brief Handle to packed function handle. */
 typedef void* TVMFunctionHandle;
+/*! \brief Handle to an interned name of a global function. */
+typedef void* TVMGlobalSymbolHandle;
 /*! \brief Handle to hold return value. */
 typedef void* TVMRetValueHandle;
 /*!
@@ -358,6 +360,27 @@ TVM_DLL int TVMFuncRegisterGlobal(const char* name, TVMFunctionHandle f, int ove
  */
 TVM_DLL int TVMFuncGetGlobal(const char* name, TVMFunctionHandle* out);
 
+/*!
+ * \brief Intern the name of a global function, registered or not, for bindings that get the
+ *  function on each call to look it up without hashing the name.
+ *
+ * \param name The name of the function.
+ * \param out The symbol of the name, valid for the lifetime of the program.
+ * \return 0 when success, nonzero when failure happens
+ */
+TVM_DLL int TVMFuncInternGlobal(const char* name, TVMGlobalSymbolHandle* out);
+
+/*!
+ * \brief Get the global function currently registered under an interned name.
+ *
+ * \param symbol The symbol from TVMFuncInternGlobal.
+ * \param out the result function pointer, NULL if it does not exist.
+ * \return 0 when success, nonzero when failure happens
+ *
+ * \note Like the handle of TVMFuncGetGlobal, the function handle is managed by TVM runtime.
+ */
+TVM_DLL int TVMFuncGetGlobalBySymbol(TVMGlobalSymbolHandle symbol, TVMFunctionHandle* out);
+
 /*!
  * \brief List all the globally registered function name
  * \param out_size The number of functions
@@ -414,6 +414,7 @@ class ArrayNode : public Object, public InplaceArrayBase<ArrayNode, ObjectRef> {
   }
 
   static constexpr const uint32_t _type_index = TypeIndex::kRuntimeArray;
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "Array";
   TVM_DECLARE_FINAL_OBJECT_INFO(ArrayNode, Object);
 
@@ -1035,6 +1036,7 @@ class ADTObj : public Object, public InplaceArrayBase<ADTObj, ObjectRef> {
   // The fields of the structure follows directly in memory.
 
   static constexpr const uint32_t _type_index = TypeIndex::kRuntimeADT;
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "runtime.ADT";
   TVM_DECLARE_FINAL_OBJECT_INFO(ADTObj, Object);
 
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_binary.h
+ * \brief The binary graph format, written by the graph executor codegen and read in place by
+ * the CRT graph executor instead of the graph JSON.
+ *
+ * The graph is little endian, and made of the following sections, each following the previous:
+ *
+ *  - TVMGraphBinaryHeader
+ *  - TVMGraphBinaryNode nodes[num_nodes]
+ *  - TVMGraphBinaryEntry inputs[num_node_inputs], the inputs of all the nodes
+ *  - uint32_t arg_nodes[num_arg_nodes]
+ *  - TVMGraphBinaryEntry heads[num_heads]
+ *  - uint32_t node_row_ptr[num_nodes + 1]
+ *  - uint32_t storage_id[num_entries]
+ *  - uint32_t device_index[num_entries], with TVM_GRAPH_BINARY_HAS_DEVICE_INDEX
+ *  - uint32_t ndim[num_entries]
+ *  - DLDataType dtype[num_entries]
+ *  - padding to 8 bytes
+ *  - int64_t shape[num_entries * shape_stride], the dims of each entry padded with zeros
+ *  - int64_t storage_offset[num_entries], with TVM_GRAPH_BINARY_HAS_STORAGE_OFFSET
+ *  - char strings[strings_size], the names as NUL terminated strings
+ *
+ * The int64_t sections are 8-byte aligned when the graph is.
+ */
+#ifndef TVM_RUNTIME_CRT_GRAPH_BINARY_H_
+#define TVM_RUNTIME_CRT_GRAPH_BINARY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief The first word of a binary graph, "TVMG". */
+#define TVM_GRAPH_BINARY_MAGIC 0x474D5654
+#define TVM_GRAPH_BINARY_VERSION 1
+
+/*! \brief The flags of the optional sections. */
+#define TVM_GRAPH_BINARY_HAS_DEVICE_INDEX 1
+#define TVM_GRAPH_BINARY_HAS_STORAGE_OFFSET 2
+
+/*! \brief The op of a node. */
+#define TVM_GRAPH_BINARY_OP_NULL 0
+#define TVM_GRAPH_BINARY_OP_TVM_OP 1
+
+typedef struct TVMGraphBinaryHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t num_nodes;
+  uint32_t num_node_inputs;
+  uint32_t num_arg_nodes;
+  uint32_t num_heads;
+  /*! \brief The number of node entries, node_row_ptr[num_nodes]. */
+  uint32_t num_entries;
+  /*! \brief The number of dims stored per entry, the largest ndim of the graph. */
+  uint32_t shape_stride;
+  uint32_t strings_size;
+} TVMGraphBinaryHeader;
+
+typedef struct TVMGraphBinaryNode {
+  uint32_t op;
+  /*! \brief The offsets of the names in the strings, func_name is "" for a null op. */
+  uint32_t name;
+  uint32_t func_name;
+  /*! \brief The index in the inputs of the first input of the node. */
+  uint32_t inputs_begin;
+  uint32_t num_inputs;
+  uint32_t num_outputs;
+  uint32_t flatten_data;
+} TVMGraphBinaryNode;
+
+typedef struct TVMGraphBinaryEntry {
+  uint32_t node_id;
+  uint32_t index;
+  uint32_t version;
+} TVMGraphBinaryEntry;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TVM_RUNTIME_CRT_GRAPH_BINARY_H_
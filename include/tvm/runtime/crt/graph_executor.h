@@ -52,6 +52,15 @@ typedef struct TVMGraphExecutorGraphAttr {
   int64_t* shape;
   uint32_t* ndim;
   uint32_t shape_count;
+  // Byte offset of each entry in the arena of the arena memory planner, -1 if
+  // the storage of the entry is allocated separately. NULL without the planner.
+  int64_t* storage_offset;
+  // Number of dims stored per entry in shape, TVM_CRT_MAX_NDIM for the JSON graph.
+  uint32_t shape_stride;
+  // Type of each entry, used instead of dltype by the binary graph.
+  const DLDataType* dtype;
+  // Whether the arrays point into the binary graph rather than being allocated.
+  uint8_t in_place;
 } TVMGraphExecutorGraphAttr;
 
 typedef struct TVMGraphExecutor TVMGraphExecutor;
@@ -60,7 +69,8 @@ typedef struct TVMGraphExecutor TVMGraphExecutor;
 /*!
  * \brief Allocate a new GraphExecutor with TVMPlatformMemoryAllocate and initialize it.
  *
- * \param sym_json JSON-encoded graph.
+ * \param sym_json JSON-encoded graph, or the binary graph of graph_binary.h. The binary graph is
+ * read in place, it must be 8-byte aligned and outlive the executor.
  * \param module_handle TVM Module that exposes the functions to call.
  * \param devices runtime execution device.
  * \param executor Pointer which receives a pointer to the newly-created instance.
@@ -69,6 +79,44 @@ typedef struct TVMGraphExecutor TVMGraphExecutor;
 int TVMGraphExecutor_Create(const char* sym_json, TVMModuleHandle module_handle,
                             const DLDevice* devices, TVMGraphExecutor** executor);
 
+/*!
+ * \brief Allocate a new GraphExecutor with TVMPlatformMemoryAllocate and initialize it, placing
+ * the storages planned by the arena memory planner (relay.backend.use_arena_planner) into a
+ * buffer given by the caller instead of allocating them.
+ *
+ * \param sym_json JSON-encoded graph, or the binary graph of graph_binary.h.
+ * \param module_handle TVM Module that exposes the functions to call.
+ * \param devices runtime execution device.
+ * \param arena The buffer holding the planned storages, 64-byte aligned. When NULL, one buffer
+ * is allocated with TVMPlatformMemoryAllocate.
+ * \param arena_size The size of the arena in bytes, at least the end of the last planned storage.
+ * \param executor Pointer which receives a pointer to the newly-created instance.
+ * \return 0 if successful.
+ */
+int TVMGraphExecutor_CreateWithArena(const char* sym_json, TVMModuleHandle module_handle,
+                                     const DLDevice* devices, void* arena, size_t arena_size,
+                                     TVMGraphExecutor** executor);
+
+/*!
+ * \brief Allocate a new GraphExecutor like TVMGraphExecutor_CreateWithArena and load its
+ * parameters in place, see TVMGraphExecutor_LoadParamsInPlace. The storage of the parameters
+ * is never allocated, so they may exceed the RAM.
+ *
+ * \param sym_json JSON-encoded graph, or the binary graph of graph_binary.h.
+ * \param module_handle TVM Module that exposes the functions to call.
+ * \param devices runtime execution device.
+ * \param arena The buffer holding the planned storages, or NULL.
+ * \param arena_size The size of the arena in bytes.
+ * \param param_blob A binary blob of parameter, saved aligned and placed at an aligned address.
+ * \param param_size The parameter size.
+ * \param executor Pointer which receives a pointer to the newly-created instance.
+ * \return 0 if successful.
+ */
+int TVMGraphExecutor_CreateWithParamsInPlace(const char* sym_json, TVMModuleHandle module_handle,
+                                             const DLDevice* devices, void* arena,
+                                             size_t arena_size, const char* param_blob,
+                                             uint32_t param_size, TVMGraphExecutor** executor);
+
 int TVMGraphExecutor_GetInputIndex(TVMGraphExecutor* executor, const char* name);
 
 /*!
@@ -110,6 +158,18 @@ int TVMGraphExecutor_GetOutput(TVMGraphExecutor* executor, const int32_t index,
 int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_blob,
                                 const uint32_t param_size);
 
+/*!
+ * \brief Load parameters from parameter blob without copying their data: the parameters point
+ * into the blob, which may stay in (memory-mapped) flash and must outlive the executor.
+ * \param executor The graph executor.
+ * \param param_blob A binary blob of parameter, saved with save_param_dict(params, alignment)
+ * and placed at an address aligned to the same alignment.
+ * \param param_size The parameter size.
+ * \return The result of this function execution.
+ */
+int TVMGraphExecutor_LoadParamsInPlace(TVMGraphExecutor* executor, const char* param_blob,
+                                       const uint32_t param_size);
+
 /*!
  * \brief Execute the graph.
  * \param executor The graph executor.
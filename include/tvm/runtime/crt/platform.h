@@ -116,6 +116,19 @@ tvm_crt_error_t TVMPlatformTimerStop(double* elapsed_time_seconds);
  */
 tvm_crt_error_t TVMPlatformGenerateRandom(uint8_t* buffer, size_t num_bytes);
 
+/*! \brief Update a CRC-16-CCITT (polynomial 0x1021) with data.
+ *
+ * Computes the CRC of the microTVM RPC frames. This function does not need to be implemented,
+ * an internal weak-linked table-driven implementation is provided. Platforms with a CRC unit may
+ * implement it to offload the CRC.
+ *
+ * \param data Pointer to the 0th byte of the data.
+ * \param data_size_bytes Number of bytes of data.
+ * \param crc The CRC of the previous data, 0xffff at the start of a frame.
+ * \return The CRC updated with data.
+ */
+uint16_t TVMPlatformCrc16(const uint8_t* data, size_t data_size_bytes, uint16_t crc);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -250,6 +250,16 @@ class Framer {
   tvm_crt_error_t WriteAndCrc(const uint8_t* data, size_t data_size_bytes, bool escape,
                               bool update_crc);
 
+  /*!
+   * \brief Write data to wire as is, and update crc_.
+   *
+   * \param data Data to write.
+   * \param data_size_bytes Number of valid bytes in data.
+   * \param update_crc true if the CRC should be updated.
+   * \return kTvmErrorNoError on success, negative value on error.
+   */
+  tvm_crt_error_t WriteRawAndCrc(const uint8_t* data, size_t data_size_bytes, bool update_crc);
+
   /*! \brief Called to write framed data to the transport. */
   WriteStream* stream_;
 
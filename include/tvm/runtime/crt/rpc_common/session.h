@@ -35,6 +35,8 @@ namespace tvm {
 namespace runtime {
 namespace micro_rpc {
 
+struct utvm_session_start_payload_t;
+
 enum class MessageType : uint8_t {
   kStartSessionInit = 0x00,
   kStartSessionReply = 0x01,
@@ -83,6 +85,8 @@ class Session {
       : local_nonce_{kInvalidNonce},
         session_id_{0},
         state_{State::kReset},
+        local_receive_window_bytes_{0},
+        remote_receive_window_bytes_{0},
         receiver_{this},
         framer_{framer},
         receive_buffer_{receive_buffer},
@@ -166,6 +170,22 @@ class Session {
    */
   tvm_crt_error_t FinishMessage();
 
+  /*!
+   * \brief Advertise the bytes of the messages this end can absorb while it processes one.
+   *
+   * The remote may then send the next messages without waiting for the replies, for instance
+   * when a UART receive ring buffer holds them. The window is sent when the session starts, call
+   * this function before StartSession(). Escaping may double the bytes on the wire.
+   *
+   * \param receive_window_bytes The bytes of message bodies, 0 to take one message at a time.
+   */
+  void SetReceiveWindow(uint32_t receive_window_bytes) {
+    local_receive_window_bytes_ = receive_window_bytes;
+  }
+
+  /*! \brief The receive window advertised by the remote, 0 when it takes one message at a time. */
+  uint32_t RemoteReceiveWindow() const { return remote_receive_window_bytes_; }
+
   /*! \brief Returns true if the session is in the established state. */
   bool IsEstablished() const { return state_ == State::kSessionEstablished; }
 
@@ -207,6 +227,10 @@ class Session {
   tvm_crt_error_t SendInternal(MessageType message_type, const uint8_t* message_data,
                                size_t message_size_bytes);
 
+  tvm_crt_error_t SendSessionStart(MessageType message_type);
+
+  bool ReadSessionStart(utvm_session_start_payload_t* payload);
+
   void SendSessionStartReply(const SessionHeader& header);
 
   void ProcessStartSessionInit(const SessionHeader& header);
@@ -228,6 +252,8 @@ class Session {
   uint8_t local_nonce_;
   uint16_t session_id_;
   State state_;
+  uint32_t local_receive_window_bytes_;
+  uint32_t remote_receive_window_bytes_;
   SessionReceiver receiver_;
   Framer* framer_;
   FrameBuffer* receive_buffer_;
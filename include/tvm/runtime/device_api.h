@@ -162,6 +162,59 @@ class TVM_DLL DeviceAPI {
    * \param event_dst The destination stream to synchronize.
    */
   virtual void SyncStreamFromTo(Device dev, TVMStreamHandle event_src, TVMStreamHandle event_dst);
+  /*!
+   * \brief Start capturing the work the calling thread submits to the device.
+   *
+   *  Captured work can be replayed without its host-side launch overhead, like
+   *  CUDA graphs or recorded command buffers. The work still executes while captured.
+   *
+   * \param dev The device.
+   * \return Whether the device supports capture.
+   */
+  virtual bool CaptureBegin(Device dev) { return false; }
+  /*!
+   * \brief Stop capturing the work of the calling thread.
+   *
+   * \param dev The device.
+   * \return The captured work, or nullptr if what was submitted cannot be replayed.
+   */
+  virtual void* CaptureEnd(Device dev) { return nullptr; }
+  /*!
+   * \brief Append captured work to another one, so that both are replayed as one.
+   *
+   * \param dev The device.
+   * \param graph The captured work to extend.
+   * \param other The captured work to append, freed when the call succeeds.
+   * \return Whether the work was appended.
+   */
+  virtual bool CaptureAppend(Device dev, void* graph, void* other) { return false; }
+  /*!
+   * \brief Redirect the accesses of captured work from one data space to another.
+   *
+   * \param dev The device.
+   * \param graph The captured work.
+   * \param old_data The data space accessed while capturing.
+   * \param new_data The data space to access on replay.
+   * \return Whether the work was redirected, it must be captured again otherwise.
+   */
+  virtual bool CaptureRebind(Device dev, void* graph, void* old_data, void* new_data) {
+    return false;
+  }
+  /*!
+   * \brief Replay captured work, StreamSync waits for it to finish.
+   *
+   * \param dev The device.
+   * \param graph The captured work.
+   * \param stream The stream to replay on.
+   */
+  virtual void CaptureReplay(Device dev, void* graph, TVMStreamHandle stream) {}
+  /*!
+   * \brief Free captured work.
+   *
+   * \param dev The device.
+   * \param graph The captured work.
+   */
+  virtual void CaptureFree(Device dev, void* graph) {}
   /*!
    * \brief Allocate temporal workspace for backend execution.
    *
@@ -25,10 +25,20 @@
 
 #include <tvm/runtime/object.h>
 
+#include <cstddef>
 #include <cstdlib>
 #include <type_traits>
 #include <utility>
 
+/*!
+ * \brief Whether make_object allocates the object types that declare _type_pooled_alloc
+ *  with PooledObjAllocator. Builds meant for memory checkers may set it to 0, so that every
+ *  object goes through the heap.
+ */
+#ifndef TVM_OBJECT_POOL
+#define TVM_OBJECT_POOL 1
+#endif
+
 namespace tvm {
 namespace runtime {
 /*!
@@ -47,8 +57,9 @@ inline ObjectPtr<T> make_object(Args&&... args);
 //
 // Possible future allocator optimizations:
 // - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
-// - Thread-local object pools: one pool per size and alignment requirement.
-// - Can specialize by type of object to give the specific allocator to each object.
+//
+// The object types that declare _type_pooled_alloc are allocated with
+// PooledObjAllocator, from thread-local free lists by size class.
 
 /*!
  * \brief Base class of object allocators that implements make.
@@ -191,15 +202,122 @@ class SimpleObjAllocator : public ObjAllocatorBase<SimpleObjAllocator> {
   };
 };
 
+/*!
+ * \brief The thread-local free lists of memory blocks behind PooledObjAllocator.
+ *
+ *  The blocks are made of units aligned for any object. Each thread keeps the blocks freed on
+ *  it, by number of units, up to kMaxCachedBytes per number, and hands them out again for the
+ *  next blocks of the same number of units allocated on it. A block may be freed on another
+ *  thread than the one that allocated it. Blocks over kMaxPooledUnits always go to the heap.
+ */
+class ObjectFreeLists {
+ public:
+  /*! \brief The unit of the blocks. */
+  using Unit = std::aligned_storage<16, alignof(std::max_align_t)>::type;
+  /*! \brief The largest number of units of the pooled blocks. */
+  static constexpr size_t kMaxPooledUnits = 32;
+  /*! \brief The largest number of bytes a thread keeps for each number of units. */
+  static constexpr size_t kMaxCachedBytes = 256 << 10;
+
+  /*!
+   * \param size A number of bytes.
+   * \return The number of units holding them.
+   */
+  static constexpr size_t NumUnits(size_t size) { return (size + sizeof(Unit) - 1) / sizeof(Unit); }
+  /*!
+   * \brief Allocate a block.
+   * \param num_units The number of units of the block.
+   * \return The block.
+   */
+  TVM_DLL static void* Alloc(size_t num_units);
+  /*!
+   * \brief Free a block allocated by Alloc.
+   * \param data The block.
+   * \param num_units The number of units of the block.
+   */
+  TVM_DLL static void Free(void* data, size_t num_units);
+};
+
+/*!
+ * \brief Allocator that recycles the memory of the freed objects of the same size, see
+ *  ObjectFreeLists. It suits the small objects created and dropped at high rates, e.g. the
+ *  containers of the VM, and is selected by _type_pooled_alloc.
+ */
+class PooledObjAllocator : public ObjAllocatorBase<PooledObjAllocator> {
+ public:
+  using Unit = ObjectFreeLists::Unit;
+
+  template <typename T>
+  class Handler {
+   public:
+    static constexpr size_t kNumUnits = ObjectFreeLists::NumUnits(sizeof(T));
+    static_assert(alignof(T) <= alignof(Unit), "over-aligned objects cannot be pooled");
+
+    template <typename... Args>
+    static T* New(PooledObjAllocator*, Args&&... args) {
+      void* data = ObjectFreeLists::Alloc(kNumUnits);
+      new (data) T(std::forward<Args>(args)...);
+      return static_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      T* tptr = static_cast<T*>(objptr);
+      tptr->T::~T();
+      ObjectFreeLists::Free(tptr, kNumUnits);
+    }
+  };
+
+  // The array handler keeps the number of units of the block in a unit before the array
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+    static_assert(alignof(ArrayType) <= alignof(Unit), "over-aligned objects cannot be pooled");
+
+    template <typename... Args>
+    static ArrayType* New(PooledObjAllocator*, size_t num_elems, Args&&... args) {
+      size_t num_units =
+          1 + ObjectFreeLists::NumUnits(num_elems * sizeof(ElemType) + sizeof(ArrayType));
+      Unit* data = static_cast<Unit*>(ObjectFreeLists::Alloc(num_units));
+      *reinterpret_cast<size_t*>(data) = num_units;
+      return new (data + 1) ArrayType(std::forward<Args>(args)...);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      tptr->ArrayType::~ArrayType();
+      Unit* data = reinterpret_cast<Unit*>(tptr) - 1;
+      ObjectFreeLists::Free(data, *reinterpret_cast<size_t*>(data));
+    }
+  };
+};
+
+/*!
+ * \brief The allocator of make_object for a type.
+ * \tparam T The type of the objects.
+ */
+template <typename T>
+using DefaultObjAllocator =
+    typename std::conditional<TVM_OBJECT_POOL && T::_type_pooled_alloc, PooledObjAllocator,
+                              SimpleObjAllocator>::type;
+
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args) {
-  return SimpleObjAllocator().make_object<T>(std::forward<Args>(args)...);
+  return DefaultObjAllocator<T>().template make_object<T>(std::forward<Args>(args)...);
 }
 
 template <typename ArrayType, typename ElemType, typename... Args>
 inline ObjectPtr<ArrayType> make_inplace_array_object(size_t num_elems, Args&&... args) {
-  return SimpleObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
-                                                                      std::forward<Args>(args)...);
+  return DefaultObjAllocator<ArrayType>().template make_inplace_array<ArrayType, ElemType>(
+      num_elems, std::forward<Args>(args)...);
 }
 
 }  // namespace runtime
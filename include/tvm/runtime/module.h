@@ -81,6 +81,14 @@ class Module : public ObjectRef {
    *  Re-create import relationship by calling Import.
    */
   TVM_DLL static Module LoadFromFile(const std::string& file_name, const std::string& format = "");
+  /*!
+   * \brief Load a module from the bytes of a file in memory, e.g. of an exported shared library,
+   *  without the file being on a filesystem.
+   * \param data The bytes of the file.
+   * \param format The format of the file.
+   * \note Like LoadFromFile, this function won't load the import relationship.
+   */
+  TVM_DLL static Module LoadFromBytes(const std::string& data, const std::string& format = "so");
   // refer to the corresponding container.
   using ContainerType = ModuleNode;
   friend class ModuleNode;
@@ -127,6 +127,26 @@ class NDArray : public ObjectRef {
    * \note The memory size of new array must be smaller than the current one.
    */
   TVM_DLL NDArray CreateView(std::vector<int64_t> shape, DLDataType dtype);
+  /*!
+   * \brief Create a NDArray that shares a strided part of the data memory of the current one,
+   *  e.g. a range of rows or of channels, without a copy.
+   * \param shape The shape of the view.
+   * \param strides The strides of the view, in elements.
+   * \param elem_offset The offset of the first element of the view from the first element of
+   *  the current array, in elements.
+   * \note The view must stay within the elements spanned by the current array. A compact
+   *  view has no strides.
+   */
+  TVM_DLL NDArray CreateStridedView(std::vector<int64_t> shape, std::vector<int64_t> strides,
+                                    int64_t elem_offset) const;
+  /*!
+   * \brief Create a view of a range of the current array along an axis.
+   * \param axis The axis.
+   * \param begin The first index of the range.
+   * \param end The index past the last one of the range.
+   * \return The view, see CreateStridedView.
+   */
+  TVM_DLL NDArray Slice(int axis, int64_t begin, int64_t end) const;
   /*!
    * \brief Create a reference view of NDArray that
    *  represents as DLManagedTensor.
@@ -206,8 +226,10 @@ class NDArray : public ObjectRef {
  * \brief Save a DLTensor to stream
  * \param strm The output stream
  * \param tensor The tensor to be saved.
+ * \param data_pad The number of zero bytes written before the data, recorded in the
+ *  reserved field of the header so that the data can be aligned in the stream.
  */
-inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor);
+inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor, uint64_t data_pad = 0);
 
 /*!
  * \brief The container base structure
@@ -240,6 +262,8 @@ class NDArray::ContainerBase {
    *  can be used used for shape data.
    */
   std::vector<int64_t> shape_;
+  /*! \brief The strides container of the strided views. */
+  std::vector<int64_t> strides_;
 };
 
 /*!
@@ -320,12 +344,33 @@ inline bool IsContiguous(const DLTensor& arr) {
   int64_t expected_stride = 1;
   for (int32_t i = arr.ndim; i != 0; --i) {
     int32_t k = i - 1;
-    if (arr.strides[k] != expected_stride) return false;
+    // The stride of an axis of extent 1 is never used
+    if (arr.shape[k] != 1 && arr.strides[k] != expected_stride) return false;
     expected_stride *= arr.shape[k];
   }
   return true;
 }
 
+/*!
+ * \brief check if the byte offset of a DLTensor can be folded into its data pointer, i.e. if the
+ *  data pointers of its device are addresses. The kernels take no byte offset.
+ * \param arr The input DLTensor.
+ * \return The check result.
+ */
+inline bool CanFoldByteOffset(const DLTensor& arr) {
+  switch (arr.device.device_type) {
+    case kDLCPU:
+    case kDLCUDA:
+    case kDLCUDAHost:
+    case kDLCUDAManaged:
+    case kDLROCM:
+    case kDLROCMHost:
+      return true;
+    default:
+      return false;
+  }
+}
+
 inline bool NDArray::IsContiguous() const {
   return ::tvm::runtime::IsContiguous(get_mutable()->dl_tensor);
 }
@@ -393,8 +438,8 @@ inline Object* TVMArrayHandleToObjectHandle(TVMArrayHandle handle) {
 /*! \brief Magic number for NDArray file */
 constexpr uint64_t kTVMNDArrayMagic = 0xDD5E40F096B4A13F;
 
-inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
-  uint64_t header = kTVMNDArrayMagic, reserved = 0;
+inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor, uint64_t data_pad) {
+  uint64_t header = kTVMNDArrayMagic, reserved = data_pad;
   strm->Write(header);
   strm->Write(reserved);
   // Always save data as CPU context
@@ -421,6 +466,10 @@ inline bool SaveDLTensor(dmlc::Stream* strm, const DLTensor* tensor) {
   }
   int64_t data_byte_size = type_bytes * num_elems;
   strm->Write(data_byte_size);
+  if (data_pad != 0) {
+    std::vector<uint8_t> pad(data_pad, 0);
+    strm->Write(dmlc::BeginPtr(pad), data_pad);
+  }
 
   if (DMLC_IO_NO_ENDIAN_SWAP && tensor->device.device_type == kDLCPU &&
       tensor->strides == nullptr && tensor->byte_offset == 0) {
@@ -467,6 +516,11 @@ inline bool NDArray::Load(dmlc::Stream* strm) {
   int64_t data_byte_size;
   ICHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
   ICHECK(data_byte_size == num_elems * elem_bytes) << "Invalid DLTensor file format";
+  // The reserved field is the padding before the data
+  if (reserved != 0) {
+    std::vector<uint8_t> pad(reserved);
+    ICHECK(strm->Read(dmlc::BeginPtr(pad), reserved)) << "Invalid DLTensor file format";
+  }
   auto read_ret = strm->Read(ret->data, data_byte_size);
   // Only check non-empty data
   if (ndim > 0 && shape[0] != 0) {
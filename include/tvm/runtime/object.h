@@ -108,6 +108,13 @@ struct TypeIndex {
  *       exceeds the _type_child_slots. A fallback mechanism to check global type table will be
  * used. Recommendation: set to false for optimal runtime speed if we know exact number of children.
  *
+ * The following field is optional.
+ *
+ * - _type_pooled_alloc:
+ *       Whether make_object allocates the objects with PooledObjAllocator, which recycles the
+ *       memory of the freed objects of the same size instead of going through the heap.
+ *       Recommendation: set to true for small objects created and dropped at high rates.
+ *
  * Two macros are used to declare helper functions in the object:
  * - Use TVM_DECLARE_BASE_OBJECT_INFO for object classes that can be sub-classed.
  * - Use TVM_DECLARE_FINAL_OBJECT_INFO for object classes that cannot be sub-classed.
@@ -224,6 +231,7 @@ class TVM_DLL Object {
   static constexpr bool _type_final = false;
   static constexpr uint32_t _type_child_slots = 0;
   static constexpr bool _type_child_slots_can_overflow = true;
+  static constexpr bool _type_pooled_alloc = false;
   // member information
   static constexpr bool _type_has_method_visit_attrs = true;
   static constexpr bool _type_has_method_sequal_reduce = false;
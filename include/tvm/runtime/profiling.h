@@ -200,6 +200,59 @@ class Report : public ObjectRef {
   TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(Report, ObjectRef, ReportNode);
 };
 
+/*!
+ * \brief Collects metrics of the calls of a Profiler, such as the bytes allocated or the
+ *  counters of a device.
+ *
+ * Backends add their own collectors by registering a function
+ * "runtime.profiling.metric_collector.my_collector" that returns one. A
+ * collector is started around each call and around the whole run on each
+ * device, and should be as lightweight as possible.
+ */
+class MetricCollectorNode : public Object {
+ public:
+  /*! \brief Prepare the collection on the devices of a run.
+   * \param devs The devices of the run.
+   */
+  virtual void Init(const std::vector<Device>& devs) {}
+  /*! \brief Start collecting on a device.
+   * \param dev The device of the call or of the run.
+   * \returns The state of the collection given to `Stop`, undefined if there is nothing to
+   *  collect on the device.
+   */
+  virtual ObjectRef Start(Device dev) = 0;
+  /*! \brief Stop collecting.
+   * \param state The state returned by the matching `Start`.
+   * \returns The metrics collected since `Start`.
+   */
+  virtual Map<String, ObjectRef> Stop(ObjectRef state) = 0;
+
+  virtual ~MetricCollectorNode() {}
+
+  static constexpr const char* _type_key = "runtime.profiling.MetricCollector";
+  TVM_DECLARE_BASE_OBJECT_INFO(MetricCollectorNode, Object);
+};
+
+class MetricCollector : public ObjectRef {
+ public:
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(MetricCollector, ObjectRef, MetricCollectorNode);
+};
+
+/*! \brief The collectors of every profiler: the device counters, the memory of the runtime, and
+ *  the ones registered as "runtime.profiling.metric_collector.*".
+ */
+std::vector<MetricCollector> DefaultMetricCollectors();
+
+/*! \brief Count the bytes of an allocation of the runtime, collected as "Bytes Allocated".
+ * \param bytes The size of the allocation.
+ */
+TVM_DLL void RecordAllocation(int64_t bytes);
+
+/*! \brief Count the bytes of a copy of the runtime, collected as "Bytes Copied".
+ * \param bytes The size of the copy.
+ */
+TVM_DLL void RecordCopy(int64_t bytes);
+
 /*! Information about a single function or operator call. */
 struct CallFrame {
   /*! Device on which the call was made */
@@ -210,6 +263,8 @@ struct CallFrame {
   Timer timer;
   /*! Extra performance metrics */
   std::unordered_map<std::string, ObjectRef> extra_metrics;
+  /*! The states of the metric collectors started with the call */
+  std::vector<ObjectRef> collector_states;
 };
 
 /*! Runtime profiler for function and/or operator calls. Used in the graph
@@ -229,9 +284,36 @@ struct CallFrame {
  * prof.Stop();
  * std::cout << prof.Report << std::endl; // print profiling report
  * \endcode
+ *
+ * Devices can report extra counters, such as busy cycles of their
+ * functional units, by registering a function "profiling.counters.my_device"
+ * (where `my_device` is the `DeviceName` of the device). It accepts a `Device`
+ * and returns a `Map<String, ObjectRef>` of monotonically increasing
+ * `CountNode` values. The profiler adds the increase of each counter over a
+ * call to the metrics of the call, and the increase over the whole run to
+ * the device metrics. Other metrics are gathered by `MetricCollector`s, e.g.
+ * the Linux perf hardware counters of the CPU calls built with
+ * `USE_PERF_COUNTERS`: cycles, instructions, cache, L1D, LLC and branch
+ * misses, with the "IPC" and the misses per thousand instructions.
+ *
+ * The executors add the "FLOPs" and the "Bytes Accessed" by the arguments of
+ * the calls they know, the report derives "GFLOP/s", "GB/s" and the
+ * "FLOP/Byte" arithmetic intensity of the roofline model from them.
+ *
+ * While a profiler runs, the backends running a call in several steps, e.g.
+ * the primitives of a BYOC subgraph, can report the steps as the nested
+ * calls of `Profiler::Current()`. They are given a "Parent" metric, and are
+ * left out of the sums of the report.
  */
 class Profiler {
  public:
+  /*! \brief A profiler with the default metric collectors. */
+  Profiler() : Profiler(DefaultMetricCollectors()) {}
+  /*! \brief A profiler with the given metric collectors.
+   * \param collectors The metric collectors.
+   */
+  explicit Profiler(std::vector<MetricCollector> collectors) : collectors_(collectors) {}
+  ~Profiler();
   /*! \brief Start the profiler.
    * \param devs The list of devices the profiler will be running on. Should
    *             include all devices used by profiled operators.
@@ -270,12 +352,23 @@ class Profiler {
   /*! \brief Check if the profiler is currently running.
    * \returns Whether or not the profiler is running.
    */
-  bool IsRunning() const { return !global_timers_.empty(); }
+  bool IsRunning() const { return !global_timers_.empty() && !stopped_; }
+  /*! \brief The profiler running on the calling thread.
+   * \returns The profiler between `Start` and `Stop`, or nullptr.
+   */
+  static Profiler* Current();
 
  private:
+  std::vector<MetricCollector> collectors_;
   std::vector<std::pair<Device, Timer>> global_timers_;
+  /*! \brief The collector states of each device while running, then its metrics. */
+  std::vector<std::vector<ObjectRef>> global_states_;
+  std::vector<std::unordered_map<std::string, ObjectRef>> global_metrics_;
   std::vector<CallFrame> calls_;
   std::stack<CallFrame> in_flight_;
+  /*! \brief The profiler that was current before `Start`. */
+  Profiler* prev_current_{nullptr};
+  bool stopped_{false};
 };
 
 /* \brief A duration in time. */
@@ -323,6 +416,21 @@ class CountNode : public Object {
   TVM_DECLARE_FINAL_OBJECT_INFO(CountNode, Object);
 };
 
+/* A ratio of two metrics, e.g. a throughput */
+class RatioNode : public Object {
+ public:
+  /* The ratio as a floating point value */
+  double ratio;
+
+  /* \brief Construct a new ratio.
+   * \param a The ratio.
+   */
+  explicit RatioNode(double a) : ratio(a) {}
+
+  static constexpr const char* _type_key = "runtime.profiling.Ratio";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RatioNode, Object);
+};
+
 /*! \brief String representation of an array or NDArray shapes
  *  \param shapes Array of NDArrays to get the shapes of.
  *  \return A textual representation of the shapes. For example: `float32[2], int64[1, 2]`.
@@ -303,6 +303,23 @@ class Registry {
    *   nullptr if it does not exist.
    */
   TVM_DLL static const PackedFunc* Get(const std::string& name);  // NOLINT(*)
+  /*! \brief An interned name of a global function. */
+  struct Symbol;
+  /*!
+   * \brief Intern the name of a global function, for the function to be looked up without
+   *  hashing the name, e.g. by a caller getting it on each call.
+   * \param name The name of the function, registered or not.
+   * \return The symbol of the name, valid for the lifetime of the program.
+   */
+  TVM_DLL static const Symbol* Intern(const std::string& name);
+  /*!
+   * \brief Get the global function currently registered under a symbol.
+   * \param symbol The symbol of the name of the function.
+   * \return pointer to the registered function,
+   *   nullptr if it does not exist.
+   * \note Like `Get` by name, the lookup takes no lock.
+   */
+  TVM_DLL static const PackedFunc* Get(const Symbol* symbol);  // NOLINT(*)
   /*!
    * \brief Get the names of currently registered global function.
    * \return The names
@@ -64,21 +64,25 @@ class ThreadGroup {
   enum AffinityMode : int {
     kBig = 1,
     kLittle = -1,
+    /*! \brief Use the big and the little cores, the thread pool weights their tasks. */
+    kMixed = 2,
   };
 
   /*!
    * \brief configure the CPU id affinity
    *
-   * \param mode The preferred CPU type (1 = big, -1 = little).
+   * \param mode The preferred CPU type (1 = big, -1 = little, 2 = both).
    * \param nthreads The number of threads to use (0 = use all).
    * \param exclude_worker0 Whether to use the main thread as a worker.
    *        If  `true`, worker0 will not be launched in a new thread and
    *        `worker_callback` will only be called for values >= 1. This
    *        allows use of the main thread as a worker.
+   * \param first_core The number of cores skipped before the first worker, so that
+   *        several thread groups run on disjoint cores.
    *
    * \return The number of workers to use.
    */
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0);
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0, int first_core = 0);
 
  private:
   Impl* impl_;
@@ -89,11 +93,65 @@ class ThreadGroup {
  */
 void Yield();
 
+/*!
+ * \brief Bind the parallel launches of the calling thread to a thread pool partition, a
+ *  thread pool created by "runtime.config_threadpool_partition" that the threads bound to it
+ *  share one launch at a time.
+ *
+ * \param partition The id of the partition, -1 for the thread pool of the calling thread.
+ *
+ * \return The partition the thread was bound to.
+ */
+int BindThreadPoolPartition(int partition);
+
+/*!
+ * \brief Bind the calling thread to a thread pool partition for the lifetime of the scope,
+ *  a negative partition keeps the current binding.
+ */
+class ThreadPoolPartitionScope {
+ public:
+  explicit ThreadPoolPartitionScope(int partition) : bound_(partition >= 0) {
+    if (bound_) prev_ = BindThreadPoolPartition(partition);
+  }
+  ~ThreadPoolPartitionScope() {
+    if (bound_) BindThreadPoolPartition(prev_);
+  }
+
+ private:
+  bool bound_;
+  int prev_{-1};
+};
+
 /*!
  * \return the maximum number of effective workers for this system.
  */
 int MaxConcurrency();
 
+/*!
+ * \return The number of NUMA nodes of the host, 1 if the topology is unknown.
+ */
+int NumNumaNodes();
+
+/*!
+ * \brief Get the NUMA node of a core.
+ * \param core The index of the core.
+ * \return The NUMA node, 0 if the topology is unknown.
+ */
+int NumaNodeOfCore(int core);
+
+/*!
+ * \brief Get the number of physical cores of a NUMA node, counting the first hardware thread
+ *  of each core.
+ * \param node The NUMA node.
+ * \return The number of cores.
+ */
+int NumaNodeCores(int node);
+
+/*!
+ * \return The NUMA node of the core the calling thread runs on.
+ */
+int CurrentNumaNode();
+
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
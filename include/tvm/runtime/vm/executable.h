@@ -31,7 +31,9 @@
 #include <tvm/runtime/vm/bytecode.h>
 
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -171,12 +173,34 @@ class Executable : public ModuleNode {
    */
   std::string GetFunctionParameterName(std::string func, uint32_t index) const;
 
-  virtual ~Executable() {}
+  /*!
+   * \brief Get a constant from the constant pool.
+   *
+   * The constants of a deserialized executable stay in the serialized blob until they are
+   * first used, this materializes the constant on the first call.
+   *
+   * \param index The index of the constant.
+   *
+   * \return The constant.
+   */
+  ObjectRef GetConstant(Index index) const;
+
+  /*!
+   * \brief Materialize the constants that are not loaded yet in a background thread.
+   */
+  void PrefetchConstants();
+
+  virtual ~Executable() {
+    if (prefetch_thread_.joinable()) prefetch_thread_.join();
+  }
 
   const char* type_key() const final { return "VMExecutable"; }
 
-  /*! \brief The global constant pool. */
-  std::vector<ObjectRef> constants;
+  /*!
+   * \brief The global constant pool, the constants that are not loaded yet are undefined.
+   *  Use GetConstant to read a constant.
+   */
+  mutable std::vector<ObjectRef> constants;
   /*! \brief A map from globals (as strings) to their index in the function map. */
   std::unordered_map<std::string, Index> global_map;
   /*! \brief A mapping from the packed function (as string) to the index that
@@ -247,8 +271,17 @@ class Executable : public ModuleNode {
    */
   void LoadCodeSection(dmlc::Stream* strm);
 
+  /*! \brief Materialize all the constants that are not loaded yet. */
+  void LoadAllConstants();
+
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The offset in code_ of each constant that is not loaded yet, 0 once loaded. */
+  mutable std::vector<size_t> const_offsets_;
+  /*! \brief Protect the lazy loading of the constants. */
+  mutable std::mutex const_mutex_;
+  /*! \brief The thread prefetching the constants. */
+  std::thread prefetch_thread_;
 };
 
 }  // namespace vm
@@ -34,6 +34,7 @@
 #include <tvm/runtime/vm/memory_manager.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -57,6 +58,7 @@ class VMClosureObj : public ClosureObj {
   std::vector<ObjectRef> free_vars;
 
   static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const bool _type_pooled_alloc = true;
   static constexpr const char* _type_key = "vm.Closure";
   TVM_DECLARE_FINAL_OBJECT_INFO(VMClosureObj, ClosureObj);
 };
@@ -198,7 +200,7 @@ class VirtualMachine : public runtime::ModuleNode {
    * \param reg The register to read from.
    * \return The read object.
    */
-  inline ObjectRef ReadRegister(RegName reg) const;
+  inline const ObjectRef& ReadRegister(RegName reg) const;
 
   /*!
    * \brief Read a VM register and cast it to int32_t
@@ -248,6 +250,60 @@ class VirtualMachine : public runtime::ModuleNode {
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
 
+  /*!
+   * \brief Convert packed arguments to the inputs of a function, on their devices.
+   * \param func_name The name of the function.
+   * \param args The packed arguments.
+   * \param offset The index of the first input in args.
+   * \return The inputs.
+   */
+  std::vector<ObjectRef> ConvertInputs(const std::string& func_name, TVMArgs args, int offset);
+
+  /*!
+   * \brief Invoke a VM function, concurrently with the other calls of this function.
+   *
+   *  Each call runs on a worker with its own frames and registers. The workers share the
+   *  executable, the kernels and the constants, which are loaded to their devices once.
+   * \param func_name The name of the function.
+   * \param args The inputs of the function.
+   * \return The object representing the result.
+   */
+  ObjectRef InvokeConcurrent(const std::string& func_name, const std::vector<ObjectRef>& args);
+
+  /*! \brief Create a worker for InvokeConcurrent, sharing the state of this VM. */
+  ObjectPtr<VirtualMachine> CreateWorker();
+
+  /*!
+   * \brief Set the sizes a dimension of a function parameter is padded to.
+   *
+   *  The parameter is padded with zeros along the axis up to the smallest bucket that
+   *  fits it, so that a dynamic dimension only takes a few sizes. The storage allocated
+   *  by the function then takes a few sizes too, which the pooled allocator recycles
+   *  across invocations. Arrays larger than every bucket are passed unpadded.
+   * \param func_name The name of the function.
+   * \param param_index The index of the parameter.
+   * \param axis The padded axis.
+   * \param buckets The sizes of the axis, empty to stop padding the parameter.
+   */
+  void SetShapeBuckets(const std::string& func_name, Index param_index, int axis,
+                       std::vector<int64_t> buckets);
+
+  /*!
+   * \brief Pad an input of a function to its bucket.
+   * \param func_name The name of the function.
+   * \param param_index The index of the parameter.
+   * \param arg The input.
+   * \return The padded input, or the input itself if it is not padded.
+   */
+  ObjectRef PadToBucket(const std::string& func_name, Index param_index, const ObjectRef& arg);
+
+  /*!
+   * \brief Run the parallel operators on a thread pool partition.
+   * \param partition The partition created by "runtime.config_threadpool_partition", or -1
+   *  for the thread pool of the invoking thread.
+   */
+  void SetThreadPoolPartition(int partition) { thread_pool_partition_ = partition; }
+
   /*! \brief Get device from the device list based on a given device type. */
   Device GetDevice(Index device_type) const;
 
@@ -263,6 +319,10 @@ class VirtualMachine : public runtime::ModuleNode {
   std::vector<PackedFunc> packed_funcs_;
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames_;
+  /*! \brief The register file of the current frame. */
+  ObjectRef* registers_{nullptr};
+  /*! \brief The register files of the returned frames, reused by the next calls. */
+  std::vector<std::vector<ObjectRef>> register_file_pool_;
   /*! \brief The fuction table index of the current function. */
   Index func_index_;
   /*! \brief The current pointer to the code section. */
@@ -275,6 +335,17 @@ class VirtualMachine : public runtime::ModuleNode {
   const Executable* exec_;
   /*! \brief The function name to inputs mapping. */
   std::unordered_map<std::string, std::vector<ObjectRef>> inputs_;
+  /*! \brief The sizes a dimension of a parameter is padded to. */
+  struct ShapeBuckets {
+    /*! \brief The padded axis. */
+    int axis;
+    /*! \brief The sizes of the axis, in increasing order. */
+    std::vector<int64_t> sizes;
+  };
+  /*! \brief The function name to the shape buckets of its parameters mapping. */
+  std::unordered_map<std::string, std::unordered_map<Index, ShapeBuckets>> shape_buckets_;
+  /*! \brief The thread pool partition of the invocations, -1 for the invoking thread's pool. */
+  int thread_pool_partition_{-1};
   /*! \brief The set of TVM devices the VM is currently executing on. */
   std::vector<Device> devices_;
   /*! \brief The cached memory allocators. */
@@ -284,6 +355,10 @@ class VirtualMachine : public runtime::ModuleNode {
    * object to avoid rellocation of constants during inference.
    */
   std::vector<ObjectRef> const_pool_;
+  /*! \brief The workers of InvokeConcurrent that are not running a call. */
+  std::vector<ObjectPtr<VirtualMachine>> idle_workers_;
+  /*! \brief Guards the workers and their creation. */
+  std::mutex workers_mutex_;
 };
 
 }  // namespace vm
@@ -248,9 +248,11 @@ class Stage : public ObjectRef {
   TVM_DLL Stage& storage_align(IterVar axis, int factor, int offset);  // NOLINT(*)
   /*!
    * \brief Compute current stage with double buffering.
+   * \param num_stages The number of buffers, the later iterations of the multi-stage
+   *  software pipeline prefetch into.
    * \return reference to self.
    */
-  TVM_DLL Stage& double_buffer();  // NOLINT(*)
+  TVM_DLL Stage& double_buffer(int num_stages = 2);  // NOLINT(*)
   /*!
    * \brief whether the stage has been scheduled.
    * \return whether the stage has been scheduled.
@@ -493,6 +495,8 @@ class StageNode : public Object {
   bool is_output{false};
   /*! \brief Whether apply double buffer optimization to this stage */
   bool double_buffer{false};
+  /*! \brief The number of buffers of the double buffer optimization */
+  int num_buffer_stages{2};
   /*!
    * \brief The parent group of the current stage.
    *  The stage cannot be assigned to stages outside the group.
@@ -515,6 +519,7 @@ class StageNode : public Object {
     v->Visit("scope", &scope);
     v->Visit("is_output", &is_output);
     v->Visit("double_buffer", &double_buffer);
+    v->Visit("num_buffer_stages", &num_buffer_stages);
     v->Visit("group", &group);
     v->Visit("num_child_stages", &num_child_stages);
   }
@@ -580,6 +580,65 @@ TVM_DLL const Op& tvm_fill_fragment();
  */
 TVM_DLL const Op& tvm_store_matrix_sync();
 
+/*!
+ * \brief tvm intrinsic for the asynchronous copy of global memory into shared memory.
+ *
+ *  void tvm_async_copy(Expr dst_ptr, Expr src_ptr, IntImm bytes) {
+ *    // bytes must be 4, 8 or 16, and the pointers aligned by it.
+ *    cp.async.shared.global [dst_ptr], [src_ptr], bytes;
+ *  }
+ */
+TVM_DLL const Op& tvm_async_copy();
+
+/*!
+ * \brief tvm intrinsic committing the asynchronous copies issued by the thread as a group.
+ *
+ *  void tvm_async_commit_group() {
+ *    cp.async.commit_group;
+ *  }
+ */
+TVM_DLL const Op& tvm_async_commit_group();
+
+/*!
+ * \brief tvm intrinsic waiting for the groups of asynchronous copies of the thread to land,
+ *  but the num_pending last ones.
+ *
+ *  void tvm_async_wait_group(IntImm num_pending) {
+ *    cp.async.wait_group num_pending;
+ *  }
+ */
+TVM_DLL const Op& tvm_async_wait_group();
+
+/*!
+ * \brief tvm intrinsic for the warp-level matrix multiply-accumulate of the tensor cores.
+ *
+ *  void ptx_mma(StringImm shape, StringImm a_layout, StringImm b_layout,
+ *               StringImm a_dtype, StringImm b_dtype, StringImm c_dtype,
+ *               Var multiplicand_a, Expr a_index,
+ *               Var multiplicand_b, Expr b_index,
+ *               Var accumulator, Expr c_index, bool saturate) {
+ *    // The fragments are the registers of each thread, in the layouts of the PTX ISA.
+ *    mma.sync.aligned.shape.a_layout.b_layout.c_dtype.a_dtype.b_dtype.c_dtype
+ *      accumulator[c_index:], multiplicand_a[a_index:], multiplicand_b[b_index:],
+ *      accumulator[c_index:];
+ *  }
+ */
+TVM_DLL const Op& ptx_mma();
+
+/*!
+ * \brief tvm intrinsic for the warp-level load of 8x8 matrices from shared memory into the
+ *  fragments of the threads.
+ *
+ *  void ptx_ldmatrix(Bool trans, IntImm num, StringImm type,
+ *                    Var local_ptr, Expr local_index,
+ *                    Var smem_ptr, Expr smem_index) {
+ *    // Each thread passes the address of one row of the matrices.
+ *    ldmatrix.sync.aligned.m8n8.num.trans.shared.type
+ *      local_ptr[local_index:], smem_ptr[smem_index];
+ *  }
+ */
+TVM_DLL const Op& ptx_ldmatrix();
+
 // TODO(tvm-team) replace the usage of the vector operations by Shuffle.
 /*!
  * \brief Get the high level half of the vector
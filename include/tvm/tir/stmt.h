@@ -1249,6 +1249,11 @@ constexpr const char* device_type = "device_type";
 constexpr const char* loop_scope = "loop_scope";
 /*! \brief Mark of reduce scope */
 constexpr const char* reduce_scope = "reduce_scope";
+/*!
+ * \brief Annotation of a serial loop left to the backend to vectorize
+ *  with the scalable vectors of the target, such as ARM SVE and RISC-V V.
+ */
+constexpr const char* scalable_vectorize = "scalable_vectorize";
 /*! \brief Mark region is guarded by the pragma extension */
 constexpr const char* pragma_scope_prefix = "pragma_";
 /*! \brief Import C source or file into the final code gen module */
@@ -1257,13 +1262,19 @@ constexpr const char* pragma_import_c = "pragma_import_c";
 constexpr const char* pragma_import_llvm = "pragma_import_llvm";
 /*! \brief Try to modify the AST to support Tensor Core */
 constexpr const char* pragma_tensor_core = "pragma_tensor_core";
+/*!
+ * \brief Mark the partition of a buffer into banks by the FPGA backends, in the scope of its
+ *  allocation. The value is the factor of a cyclic partition, 0 for a complete partition.
+ */
+constexpr const char* array_partition = "array_partition";
 /*!
  * \brief Mark of prefetch scope, value=offset,
  *  run prefetch of Tensor on the current loop scope
  */
 constexpr const char* prefetch_scope = "prefetch_scope";
 /*!
- * \brief Marks production of double buffer data
+ * \brief Marks production of double buffer data,
+ *  value is the number of buffers of the pipeline, 2 when smaller
  */
 constexpr const char* double_buffer_scope = "double_buffer_scope";
 /*!
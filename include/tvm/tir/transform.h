@@ -112,6 +112,14 @@ TVM_DLL Pass LiftAttrScope(String attr_key);
  */
 TVM_DLL Pass LoopPartition();
 
+/*!
+ * \brief Hoist the loop invariant part of the affine indices out of the loops,
+ *  and strength reduce the rest to an index register bumped at each iteration.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass ReduceIndexStrength();
+
 /*!
  * \brief Lower vectorization loops.
  *
@@ -135,6 +143,14 @@ TVM_DLL Pass InjectVirtualThread();
  */
 TVM_DLL Pass InjectDoubleBuffer();
 
+/*!
+ * \brief Replace the copies of global memory into shared buffers in the scope of an
+ *  async_copy pragma with asynchronous copies, which land at the end of the scope.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass InjectAsyncCopy();
+
 /*!
  * \brief Rewrite storage allocation pattern.
  *  Moves the allocation to outer most possible scope.
@@ -247,6 +263,14 @@ TVM_DLL Pass DecorateDeviceScope();
  */
 TVM_DLL Pass SplitHostDevice();
 
+/*!
+ * \brief Merge consecutive kernels over blockIdx.x and threadIdx.x that access
+ *  disjoint buffers into one launch dispatching on the block index.
+ *
+ * \return The pass.
+ */
+TVM_DLL Pass MergeIndependentKernels();
+
 /*!
  * \brief skip assert stmt.
  *
@@ -316,7 +340,8 @@ TVM_DLL Pass CombineContextCall();
  *
  * \param target_bits The target bits
  *
- * \note Run this pass after storage flatten.
+ * \note Run this pass after storage flatten. With the min_bits of the "tir.NarrowDataType"
+ *  config, the indices proven to fit into a narrower datatype are narrowed down to it.
  * \return The pass.
  */
 TVM_DLL Pass NarrowDataType(int target_bits);
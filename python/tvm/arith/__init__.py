@@ -18,6 +18,7 @@
 
 from .int_set import IntSet, IntervalSet, estimate_region_lower_bound
 from .analyzer import ModularSet, ConstIntBound, Analyzer
+from .analyzer import clear_simplify_memo, simplify_memo_size
 from .bound import deduce_bound
 from .pattern import detect_linear_equation, detect_clip_bound
 from .int_solver import solve_linear_equations, solve_linear_inequalities
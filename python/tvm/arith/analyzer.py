@@ -251,3 +251,19 @@ class Analyzer:
             self._const_int_bound_update(var, info, override)
         else:
             raise TypeError("Do not know how to handle type {}".format(type(info)))
+
+
+def clear_simplify_memo():
+    """Clear the simplification results memoized under the arith.memoize_simplify config."""
+    _ffi_api.ClearSimplifyMemo()
+
+
+def simplify_memo_size():
+    """The number of simplification results memoized under the arith.memoize_simplify config.
+
+    Returns
+    -------
+    size : int
+        The number of entries.
+    """
+    return _ffi_api.SimplifyMemoSize()
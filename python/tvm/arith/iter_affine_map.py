@@ -88,7 +88,9 @@ class IterSumExpr(IterMapExpr):
         self.__init_handle_by_constructor__(_ffi_api.IterSumExpr, args, base)
 
 
-def detect_iter_map(indices, input_iters, predicate=True, require_bijective=False):
+def detect_iter_map(
+    indices, input_iters, predicate=True, require_bijective=False, allow_padding=False
+):
     """Detect if indices can be written as mapped iters from input iters
 
     Parameters
@@ -105,13 +107,20 @@ def detect_iter_map(indices, input_iters, predicate=True, require_bijective=Fals
     require_bijective : bool
         A boolean flag that indicates whether the mapping should be bijective
 
+    allow_padding : bool
+        Whether the non-divisible splits may pad their iterators to a multiple of the
+        divisor, when the mapping need not be bijective. E.g. given x in [0, 10),
+        [x // 4, x % 4] map to iterators of extents [3, 4].
+
     Returns
     -------
     results : List[IterSumExpr]
         The iter map matching result.
         Empty array if no match can be found.
     """
-    return _ffi_api.DetectIterMap(indices, input_iters, predicate, require_bijective)
+    return _ffi_api.DetectIterMap(
+        indices, input_iters, predicate, require_bijective, allow_padding
+    )
 
 
 def normalize_iter_map_to_expr(expr):
@@ -20,20 +20,24 @@
 from . import compute_dag
 from . import dispatcher
 from . import feature
+from . import latency_estimator
 from . import loop_state
 from . import measure
 from . import measure_record
+from . import micro_kernels
 from . import relay_integration
 from . import search_policy
 from . import search_task
+from . import sparse_tuning
 from . import task_scheduler
 from . import utils
 from . import workload_registry
 
 # Shortcut
 from .compute_dag import ComputeDAG, LayoutRewriteOption, get_shape_from_rewritten_layout
-from .cost_model import RandomModel, XGBModel
+from .cost_model import RandomModel, TreeEnsembleModel, XGBModel
 from .dispatcher import DispatchContext, ApplyHistoryBest, ApplyHistoryBestOrSample
+from .latency_estimator import LatencyEstimator
 from .measure import (
     MeasureInput,
     MeasureResult,
@@ -43,7 +47,15 @@ from .measure import (
     LocalRPCMeasureContext,
     register_task_input_check_func,
 )
-from .measure_record import RecordToFile, RecordReader, load_best_record, load_records, save_records
+from .measure_record import (
+    RecordToFile,
+    RecordReader,
+    RecordStore,
+    RecordToStore,
+    load_best_record,
+    load_records,
+    save_records,
+)
 from .relay_integration import (
     extract_tasks,
     remove_index_check,
@@ -55,7 +67,8 @@ from .search_policy import (
     EmptyPolicy,
     SketchPolicy,
     PreloadMeasuredStates,
+    PreloadSimilarTaskStates,
     PreloadCustomSketchRule,
 )
-from .task_scheduler import TaskScheduler
+from .task_scheduler import ClusterTaskScheduler, TaskScheduler
 from .workload_registry import register_workload, make_workload_key
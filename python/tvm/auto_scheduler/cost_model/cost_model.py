@@ -20,8 +20,9 @@ import ctypes
 import numpy as np
 
 import tvm._ffi
-from tvm.runtime import Object
+from tvm.runtime import Object, ndarray
 from .. import _ffi_api
+from ..feature import DEFAULT_MAX_N_BUFS
 
 
 @tvm._ffi.register_object("auto_scheduler.CostModel")
@@ -172,3 +173,85 @@ class PythonBasedModel(CostModel):
         into a single float array.
         """
         raise NotImplementedError
+
+
+@tvm._ffi.register_object("auto_scheduler.TreeEnsembleModel")
+class TreeEnsembleModel(CostModel):
+    """A gradient boosted tree model whose inference runs in c++.
+
+    The trees are trained in python and loaded with `load_trees`. The predictions then
+    extract the features and walk the trees without calling back into python, so the
+    search policies predict without holding the GIL. The score of a state is the sum of
+    the predictions of its stores, as in XGBModel.
+
+    Parameters
+    ----------
+    update_func : Optional[Callable[[List[MeasureInput], List[MeasureResult]], None]]
+        The function training the trees on new measurement results and loading them.
+    max_n_bufs : Optional[int]
+        The maximum number of extracted buffers of the features.
+    seed : int
+        The random seed of the predictions before the trees are loaded.
+    """
+
+    def __init__(self, update_func=None, max_n_bufs=None, seed=0):
+        self.__init_handle_by_constructor__(
+            _ffi_api.TreeEnsembleModel, update_func, max_n_bufs or DEFAULT_MAX_N_BUFS, seed
+        )
+
+    def load_trees(self, node_indices, node_values, tree_roots, base_score=0.0):
+        """Load the trees, replacing the current ones.
+
+        Parameters
+        ----------
+        node_indices : numpy.ndarray
+            The int32 [n, 4] array of the feature, yes, no and missing child of the nodes.
+            The children index this array, the leaves have a negative feature.
+        node_values : numpy.ndarray
+            The float32 [n] array of the split thresholds and the leaf values.
+        tree_roots : numpy.ndarray
+            The int32 array of the root node of each tree.
+        base_score : float
+            The bias added to the prediction of each store.
+        """
+        _ffi_api.TreeEnsembleModelLoadTrees(
+            self,
+            ndarray.array(np.ascontiguousarray(node_indices, dtype="int32").reshape(-1, 4)),
+            ndarray.array(np.ascontiguousarray(node_values, dtype="float32")),
+            ndarray.array(np.ascontiguousarray(tree_roots, dtype="int32")),
+            float(base_score),
+        )
+
+    @property
+    def num_trees(self):
+        """The number of loaded trees."""
+        return _ffi_api.TreeEnsembleModelNumTrees(self)
+
+    def update(self, inputs, results):
+        """Update the cost model according to new measurement results (training data).
+
+        Parameters
+        ----------
+        inputs : List[auto_scheduler.measure.MeasureInput]
+            The measurement inputs
+        results : List[auto_scheduler.measure.MeasureResult]
+            The measurement results
+        """
+        _ffi_api.CostModelUpdate(self, inputs, results)
+
+    def predict(self, search_task, states):
+        """Predict the scores of states
+
+        Parameters
+        ----------
+        search_task : SearchTask
+            The search task of states
+        states : List[State]
+            The input states
+
+        Returns
+        -------
+        scores: List[float]
+            The predicted scores for all states
+        """
+        return [x.value for x in _ffi_api.CostModelPredict(self, search_task, states)]
@@ -17,6 +17,7 @@
 # pylint: disable=invalid-name
 
 """Cost model based on xgboost"""
+import json
 import multiprocessing
 import logging
 from collections import defaultdict
@@ -24,9 +25,11 @@ from collections import defaultdict
 import numpy as np
 
 from tvm.autotvm.tuner.metric import max_curve
-from .cost_model import PythonBasedModel
+from .cost_model import PythonBasedModel, TreeEnsembleModel
+from .. import _ffi_api
+from ..feature import DEFAULT_MAX_N_BUFS
 from ..feature import get_per_store_features_from_measure_pairs, get_per_store_features_from_states
-from ..measure_record import RecordReader
+from ..measure_record import RecordReader, RecordStore, is_record_store
 
 xgb = None
 
@@ -101,6 +104,9 @@ class XGBModel(PythonBasedModel):
     adapative_training: bool = False
         Whether to use adapatie training, which reduces the training frequency when there are
         too many logs.
+    native_inference: bool = False
+        Whether the search policies predict with the trees loaded into a c++ TreeEnsembleModel,
+        without calling back into python. The training still runs in python.
     """
 
     def __init__(
@@ -110,6 +116,7 @@ class XGBModel(PythonBasedModel):
         seed=None,
         model_file=None,
         adapative_training=False,
+        native_inference=False,
     ):
         global xgb
         try:
@@ -142,8 +149,18 @@ class XGBModel(PythonBasedModel):
         self.verbose_eval = verbose_eval
         self.model_file = model_file
         self.adapative_training = adapative_training
+        self.native_inference = native_inference
 
-        super().__init__()
+        if native_inference:
+
+            def update_func(inputs, results):
+                self.update(inputs, results)
+
+            self.__init_handle_by_constructor__(
+                _ffi_api.TreeEnsembleModel, update_func, DEFAULT_MAX_N_BUFS, seed or 43
+            )
+        else:
+            super().__init__()
 
         # cache measurement input/result pairs and extracted features
         self.inputs = []
@@ -215,6 +232,15 @@ class XGBModel(PythonBasedModel):
         # Update the model file if it has been set
         if self.model_file:
             self.save(self.model_file)
+        self._load_native_trees()
+
+    def _load_native_trees(self):
+        """Load the trained trees into the native model, once there are enough samples."""
+        if not self.native_inference or self.bst is None:
+            return
+        if len(self.inputs) <= self.num_warmup_sample:
+            return
+        TreeEnsembleModel.load_trees(self, *booster_to_tree_arrays(self.bst))
 
     def predict(self, task, states):
         """Predict the scores of states
@@ -314,11 +340,15 @@ class XGBModel(PythonBasedModel):
         Parameters
         ----------
         file_name: str
-            The filename
+            The filename of a log file or record store
         n_lines: Optional[int]
             Only load first n lines of the log file
         """
-        inputs, results = RecordReader(file_name).read_lines(n_lines)
+        if is_record_store(file_name):
+            inputs, results = RecordStore(file_name).read_records()
+            inputs, results = inputs[:n_lines], results[:n_lines]
+        else:
+            inputs, results = RecordReader(file_name).read_lines(n_lines)
         logger.info("XGBModel: Loaded %s measurement records from %s", len(inputs), file_name)
         self.update(inputs, results)
 
@@ -342,6 +372,64 @@ class XGBModel(PythonBasedModel):
             self.bst = xgb.Booster(self.xgb_params)
         self.bst.load_model(file_name)
         self.num_warmup_sample = -1
+        self._load_native_trees()
+
+
+def booster_to_tree_arrays(bst):
+    """Flatten the trees of a booster into the arrays of TreeEnsembleModel.load_trees
+
+    Parameters
+    ----------
+    bst: xgb.Booster
+        The booster
+    Returns
+    -------
+    node_indices: np.ndarray
+        The int32 [n, 4] array of the feature, yes, no and missing child of the nodes
+    node_values: np.ndarray
+        The float32 [n] array of the split thresholds and the leaf values
+    tree_roots: np.ndarray
+        The int32 array of the root node of each tree
+    base_score: float
+        The bias added to the prediction of each store
+    """
+    node_indices = []
+    node_values = []
+    tree_roots = []
+    for dump in bst.get_dump(dump_format="json"):
+        tree = json.loads(dump)
+        # Number the nodes in breadth-first order, after the nodes of the previous trees,
+        # so the children always follow their parent.
+        order = [tree]
+        index = {tree["nodeid"]: len(node_values)}
+        for node in order:
+            for child in node.get("children", []):
+                index[child["nodeid"]] = len(node_values) + len(order)
+                order.append(child)
+        tree_roots.append(len(node_values))
+        for node in order:
+            if "leaf" in node:
+                node_indices.append((-1, -1, -1, -1))
+                node_values.append(node["leaf"])
+            else:
+                feature = int(node["split"].lstrip("f"))
+                node_indices.append(
+                    (feature, index[node["yes"]], index[node["no"]], index[node["missing"]])
+                )
+                node_values.append(node["split_condition"])
+
+    try:
+        config = json.loads(bst.save_config())
+        base_score = float(config["learner"]["learner_model_param"]["base_score"])
+    except (AttributeError, KeyError, ValueError, xgb.core.XGBoostError):
+        base_score = 0.5
+
+    return (
+        np.array(node_indices, dtype="int32").reshape(-1, 4),
+        np.array(node_values, dtype="float32"),
+        np.array(tree_roots, dtype="int32"),
+        base_score,
+    )
 
 
 def feature_to_pack_sum_xgbmatrix(xs):
@@ -32,7 +32,7 @@ from tvm.contrib.utils import tempdir
 from tvm.tir.expr import FloatImm
 from .cost_model import RandomModel, XGBModel
 from .measure import LocalRPCMeasureContext
-from .measure_record import RecordToFile, load_records
+from .measure_record import RecordStore, RecordToFile, is_record_store, load_records
 from .search_policy import PreloadMeasuredStates, SketchPolicy
 from .search_task import SearchTask, TuningOptions
 from .utils import calc_workload_dis_factor, decode_workload_key
@@ -191,7 +191,7 @@ class ApplyHistoryBest(DispatchContext):
         records : str or iterator of (auto_scheduler.measure.MeasureInput,\
                                       auto_scheduler.measure.MeasureResult)
             Collection of tuning records.
-            If is str, then it should be the filename of a records log file.
+            If is str, then it should be the filename of a records log file or record store.
             Each row of this file is an encoded record pair. Otherwise, it is an iterator.
         n_lines: Optional[int]
             if it is not None, only load the first `n_lines` lines of log
@@ -200,7 +200,11 @@ class ApplyHistoryBest(DispatchContext):
             records = str(records)
 
         if isinstance(records, str):
-            records = load_records(records)
+            if n_lines is None and is_record_store(records):
+                # Only the best records of the store matter, read them from its index.
+                records = zip(*RecordStore(records).best_records())
+            else:
+                records = load_records(records)
 
         if not records:
             return
@@ -252,3 +252,15 @@ def get_per_store_feature_names(max_n_bufs: Optional[int] = None) -> List[str]:
         The names of elements in the flatten feature vector
     """
     return _ffi_api.GetPerStoreFeatureNames(max_n_bufs or DEFAULT_MAX_N_BUFS)
+
+
+def clear_per_store_feature_cache(task: "SearchTask"):
+    """Clear the per-store features cached for the states of a task. The features of a
+    state are cached by its transform steps, the states with the same steps reuse them.
+
+    Parameters
+    ----------
+    task: SearchTask
+        The search task.
+    """
+    _ffi_api.ClearPerStoreFeatureCache(task)
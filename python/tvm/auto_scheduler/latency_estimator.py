@@ -0,0 +1,184 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""The latency estimates of the operators, for the decisions of the graph level passes.
+
+The estimator answers from the measured records of the tuning logs first. The functions
+without a record fall back to a cost model, a registered one or else an analytic
+roofline of their loop nests.
+"""
+import json
+
+import numpy as np
+
+import tvm._ffi
+from tvm.runtime import Object
+from tvm.target import Target
+from . import _ffi_api
+
+# The attribute of a PrimFunc holding the workload key of its tuning records.
+WORKLOAD_KEY_ATTR = "auto_scheduler.workload_key"
+
+
+def make_autotvm_workload_key(workload):
+    """Make the workload key of the records of an autotvm workload.
+
+    Parameters
+    ----------
+    workload : tuple
+        The workload of an autotvm task.
+
+    Returns
+    -------
+    key : str
+        The workload key.
+    """
+    return json.dumps(workload)
+
+
+def with_workload_key(func, workload_key):
+    """Attach the workload key of its tuning records to a PrimFunc.
+
+    Parameters
+    ----------
+    func : tvm.tir.PrimFunc
+        The function.
+
+    workload_key : str
+        The workload key, of an auto_scheduler task or made by make_autotvm_workload_key.
+
+    Returns
+    -------
+    func : tvm.tir.PrimFunc
+        The function with the attribute.
+    """
+    return func.with_attr(WORKLOAD_KEY_ATTR, workload_key)
+
+
+@tvm._ffi.register_object("auto_scheduler.LatencyEstimator")
+class LatencyEstimator(Object):
+    """The latency estimator of the operators.
+
+    Parameters
+    ----------
+    log_files : Optional[List[str]]
+        The auto_scheduler log files to load the records of.
+    """
+
+    def __init__(self, log_files=None):
+        self.__init_handle_by_constructor__(_ffi_api.LatencyEstimator, list(log_files or []))
+
+    @staticmethod
+    def global_estimator():
+        """The estimator shared by the passes and tools of the process."""
+        return _ffi_api.LatencyEstimatorGlobal()
+
+    def load_records(self, filename):
+        """Load the measured records of an auto_scheduler log file.
+
+        Parameters
+        ----------
+        filename : str
+            The log file.
+        """
+        _ffi_api.LatencyEstimatorLoadRecords(self, filename)
+
+    def load_autotvm_records(self, filename):
+        """Load the measured records of an autotvm log file. The records are keyed by
+        make_autotvm_workload_key of their task workload.
+
+        Parameters
+        ----------
+        filename : str
+            The log file.
+        """
+        # pylint: disable=import-outside-toplevel
+        from tvm.autotvm.measure import MeasureErrorNo as AutotvmErrorNo
+        from tvm.autotvm.record import load_from_file
+
+        for inp, res in load_from_file(filename):
+            if res.error_no != AutotvmErrorNo.NO_ERROR or not res.costs:
+                continue
+            self.add_record(
+                make_autotvm_workload_key(inp.task.workload), inp.target, np.mean(res.costs)
+            )
+
+    def add_record(self, workload_key, target, latency):
+        """Record a measured latency, keeping the best one of each workload and target.
+
+        Parameters
+        ----------
+        workload_key : str
+            The workload key.
+
+        target : Union[str, tvm.target.Target]
+            The target measured on.
+
+        latency : float
+            The latency in seconds.
+        """
+        _ffi_api.LatencyEstimatorAddRecord(self, workload_key, Target(target), float(latency))
+
+    def set_cost_model(self, cost_model):
+        """Set the cost model of the functions without a record.
+
+        Parameters
+        ----------
+        cost_model : Optional[Callable[[tvm.tir.PrimFunc, tvm.target.Target], float]]
+            The model returning the latency in seconds, the analytic model when None.
+        """
+        _ffi_api.LatencyEstimatorSetCostModel(self, cost_model)
+
+    def estimate_latency(self, func, target):
+        """Estimate the latency of a function, from the record of its workload key
+        if any, else from the cost model.
+
+        Parameters
+        ----------
+        func : tvm.tir.PrimFunc
+            The function.
+
+        target : Union[str, tvm.target.Target]
+            The target it runs on.
+
+        Returns
+        -------
+        latency : float
+            The latency in seconds.
+        """
+        return _ffi_api.LatencyEstimatorEstimate(self, func, Target(target))
+
+
+def analytic_latency(func, target):
+    """The analytic roofline estimate of a function: the larger of its arithmetic time,
+    on the parallel and vector lanes its loops use, and of the time to move its arguments
+    from memory.
+
+    Parameters
+    ----------
+    func : tvm.tir.PrimFunc
+        The function.
+
+    target : Union[str, tvm.target.Target]
+        The target it runs on.
+
+    Returns
+    -------
+    latency : float
+        The latency in seconds.
+    """
+    return _ffi_api.LatencyEstimatorAnalytic(func, Target(target))
@@ -99,6 +99,7 @@ class State:
         "blockIdx.z": 9,
         "threadIdx.z": 10,
         "tensorize": 11,
+        "cthread": 12,
     }
 
     def __init__(self, state_object, dag):
@@ -154,6 +155,7 @@ class State:
             - threadIdx.y
             - blockIdx.z
             - threadIdx.z
+            - cthread
         Returns
         -------
         res_it : Iterator
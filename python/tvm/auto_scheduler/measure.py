@@ -32,6 +32,7 @@ We implement these in python to utilize python's multiprocessing and error handl
 """
 
 import os
+import queue
 import time
 import shutil
 import tempfile
@@ -304,13 +305,37 @@ class ProgramMeasurer(Object):
         The Verbosity level: 0 for silent, 1 to output information during program
     max_continuous_error : Optional[int]
         The number of allowed maximum continuous error before stop the tuning
+    cache_file : Optional[str]
+        The log file or record store of the programs measured before. The programs found in it
+        take their recorded result instead of being built and run again.
     """
 
-    def __init__(self, builder, runner, callbacks, verbose, max_continuous_error=None):
+    def __init__(
+        self, builder, runner, callbacks, verbose, max_continuous_error=None, cache_file=None
+    ):
         max_continuous_error = max_continuous_error or -1  # -1 means using the default value
         self.__init_handle_by_constructor__(
             _ffi_api.ProgramMeasurer, builder, runner, callbacks, verbose, max_continuous_error
         )
+        if cache_file:
+            self.load_cache(cache_file)
+
+    def load_cache(self, filename):
+        """Add the records of a log file or a record store to the measure cache.
+        The successful records and the build failures are kept, the programs of the
+        runtime errors are measured again.
+
+        Parameters
+        ----------
+        filename : str
+            The log file or the path of the record store.
+
+        Returns
+        -------
+        num : int
+            The number of records added.
+        """
+        return _ffi_api.ProgramMeasurerLoadCache(self, filename)
 
 
 @tvm._ffi.register_object("auto_scheduler.LocalBuilder")
@@ -625,8 +650,15 @@ def _timed_func(inp_serialized, build_func, verbose):
         filename = os.path.join(dirname, "tmp_func." + build_func.output_format)
 
         try:
-            with transform.PassContext():
-                func = build_module.build(sch, args, target=task.target)
+            # if target is vta, we need to use vta build
+            if task.target.device_name == "vta":
+                # pylint: disable=import-outside-toplevel
+                import vta
+
+                func = vta.build(sch, args, target=task.target, target_host=task.target_host)
+            else:
+                with transform.PassContext():
+                    func = build_module.build(sch, args, target=task.target)
             func.export_library(filename, build_func)
         # pylint: disable=broad-except
         except Exception:
@@ -1293,3 +1325,103 @@ def rpc_runner_run(
         print("")
 
     return results
+
+
+@tvm._ffi.register_func("auto_scheduler.rpc_runner.pipeline")
+def rpc_runner_pipeline(
+    inputs,
+    on_result,
+    build_timeout,
+    build_n_parallel,
+    build_func,
+    key,
+    host,
+    port,
+    priority=1,
+    n_parallel=1,
+    timeout=10,
+    number=3,
+    repeat=1,
+    min_repeat_ms=0,
+    cooldown_interval=0.0,
+    enable_cpu_cache_flush=False,
+    verbose=1,
+):
+    """Build the MeasureInputs with LocalBuilder and run them with RPCRunner in a pipeline.
+
+    Each program is sent to the runner as soon as it is built, so the builds and the runs on
+    the tracker devices stay in flight together instead of waiting for each other batch by
+    batch.
+
+    Parameters
+    ----------
+    inputs : List[MeasureInput]
+        The MeasureInputs to be measured.
+    on_result : Callable[[int, MeasureResult], None]
+        Called with the index of each input and its MeasureResult as soon as it finishes.
+        It is always called from the thread of this function.
+    build_timeout : int
+        The timeout limit (in second) for each build.
+    build_n_parallel : int
+        Number of threads used to build in parallel.
+    build_func : str
+        The name of build function to process the built module.
+    key, host, port, priority, n_parallel, timeout, number, repeat, min_repeat_ms,
+    cooldown_interval, enable_cpu_cache_flush, verbose :
+        See `rpc_runner_run`.
+    """
+    # These pools are not doing computationally intensive work, so we can use threads
+    build_pool = multiprocessing.pool.ThreadPool(build_n_parallel)
+    run_pool = multiprocessing.pool.ThreadPool(n_parallel)
+    finished = queue.Queue()
+
+    def on_error(index, cost):
+        return lambda err: finished.put(
+            (index, ((MAX_FLOAT,), MeasureErrorNo.UNKNOWN_ERROR, str(err), cost, time.time()))
+        )
+
+    def on_built(index, build_res):
+        build_res = BuildResult(*build_res)
+        run_pool.apply_async(
+            _rpc_run_worker,
+            (
+                (
+                    inputs[index].serialize(),
+                    build_res,
+                    key,
+                    host,
+                    port,
+                    priority,
+                    timeout,
+                    number,
+                    repeat,
+                    min_repeat_ms,
+                    cooldown_interval,
+                    enable_cpu_cache_flush,
+                    verbose,
+                ),
+            ),
+            callback=lambda res: finished.put((index, res)),
+            error_callback=on_error(index, build_res.time_cost),
+        )
+
+    for index, inp in enumerate(inputs):
+        build_pool.apply_async(
+            local_build_worker,
+            ((inp.serialize(), build_func, build_timeout, verbose),),
+            callback=lambda res, index=index: on_built(index, res),
+            error_callback=on_error(index, build_timeout),
+        )
+
+    try:
+        for _ in range(len(inputs)):
+            index, res = finished.get()
+            on_result(index, MeasureResult(*res))
+    finally:
+        build_pool.terminate()
+        run_pool.terminate()
+        build_pool.join()
+        run_pool.join()
+
+    if verbose >= 1:
+        print("")
@@ -134,6 +134,156 @@ class RecordReader(Object):
             yield ret[0], ret[1]  # (input, result)
 
 
+@tvm._ffi.register_object("auto_scheduler.RecordStore")
+class RecordStore(Object):
+    """
+    An indexed, append-only binary store of measurement records.
+
+    The store indexes the best successful record of each workload key and target, so the
+    best records are read without parsing the others. Many tuning processes can append to
+    the same store. Use :code:`convert_records_to_store` and :code:`convert_store_to_records`
+    to convert from and to the json log files.
+
+    Parameters
+    ----------
+    path : str
+        The path of the store, created when it does not exist.
+    """
+
+    def __init__(self, path):
+        dirname = os.path.dirname(os.path.abspath(path))
+        if not os.path.exists(dirname):
+            os.makedirs(dirname)
+        self.__init_handle_by_constructor__(_ffi_api.RecordStore, path)
+
+    def append(self, inputs, results):
+        """Append measurement records to the store.
+
+        Parameters
+        ----------
+        inputs: List[MeasureInputs]
+            The MeasureInputs to be written.
+        results: List[MeasureResults]
+            The MeasureResults to be written.
+        """
+        _ffi_api.RecordStoreAppend(self, inputs, results)
+
+    def best_record(self, workload_key, target):
+        """Read the best successful record of a workload, of the same target string if any,
+        else of the same target kind.
+
+        Parameters
+        ----------
+        workload_key : str
+            The workload key of the compute declaration.
+        target : Union[str, tvm.target.Target]
+            The target device.
+
+        Returns
+        -------
+        input : Optional[auto_scheduler.measure.MeasureInput]
+            The best MeasureInput, None when there is no record.
+        result : Optional[auto_scheduler.measure.MeasureResult]
+            The best MeasureResult, None when there is no record.
+        """
+        ret = _ffi_api.RecordStoreBestRecord(self, workload_key, tvm.target.Target(target))
+        return (ret[0], ret[1]) if ret else (None, None)
+
+    def best_records(self):
+        """Read the best successful record of every workload key and target.
+
+        Returns
+        -------
+        inputs : List[auto_scheduler.measure.MeasureInput]
+            The MeasureInputs of the best records.
+        results : List[auto_scheduler.measure.MeasureResult]
+            The MeasureResults of the best records.
+        """
+        inputs, results = _ffi_api.RecordStoreBestRecords(self)
+        return inputs, results
+
+    def read_records(self):
+        """Read all records, in the order they were appended.
+
+        Returns
+        -------
+        inputs : List[auto_scheduler.measure.MeasureInput]
+            The MeasureInputs of the records.
+        results : List[auto_scheduler.measure.MeasureResult]
+            The MeasureResults of the records.
+        """
+        inputs, results = _ffi_api.RecordStoreReadAll(self)
+        return inputs, results
+
+    def reload(self):
+        """Read the index entries appended since the store was opened, e.g. by other
+        processes."""
+        _ffi_api.RecordStoreReload(self)
+
+
+@tvm._ffi.register_object("auto_scheduler.RecordToStore")
+class RecordToStore(MeasureCallback):
+    """
+    A measurement callback that appends measurement records to a record store.
+
+    Parameters
+    ----------
+    path : str
+        The path of the record store.
+    """
+
+    def __init__(self, path):
+        dirname = os.path.dirname(os.path.abspath(path))
+        if not os.path.exists(dirname):
+            os.makedirs(dirname)
+        self.__init_handle_by_constructor__(_ffi_api.RecordToStore, path)
+
+
+def is_record_store(filename):
+    """
+    Whether a file is a record store, rather than a json log file.
+
+    Parameters
+    ----------
+    filename : str
+        The file name.
+
+    Returns
+    -------
+    ret : bool
+        Whether the file is a record store.
+    """
+    return os.path.isfile(filename) and _ffi_api.IsRecordStore(filename)
+
+
+def convert_records_to_store(log_file, store_path):
+    """
+    Append the records of a json log file to a record store.
+
+    Parameters
+    ----------
+    log_file : str
+        The json log file.
+    store_path : str
+        The path of the record store.
+    """
+    _ffi_api.ConvertRecordsToStore(log_file, RecordStore(store_path))
+
+
+def convert_store_to_records(store_path, log_file):
+    """
+    Append the records of a record store to a json log file.
+
+    Parameters
+    ----------
+    store_path : str
+        The path of the record store.
+    log_file : str
+        The json log file.
+    """
+    _ffi_api.ConvertStoreToRecords(RecordStore(store_path), log_file)
+
+
 def load_record_from_string(record):
     """
     Load the measure record from string.
@@ -191,6 +341,8 @@ def load_records(filename):
     If you want to use them, you can call the :code:`recover_measure_input` below
     to rebuild these fields.
     """
+    if is_record_store(filename):
+        return zip(*RecordStore(filename).read_records())
     return zip(*RecordReader(filename).read_lines())
 
 
@@ -237,7 +389,13 @@ def load_best_record(filename, workload_key=None, target=None, include_compatibl
     result : auto_scheduler.measure.MeasureResult
         The best State's MeasureResult from this log fine.
     """
-    log_reader = RecordReader(filename)
+    if is_record_store(filename):
+        if workload_key is not None and target is not None and not include_compatible:
+            # The index of the store answers without reading the other records.
+            return RecordStore(filename).best_record(workload_key, target)
+        log_reader = load_records(filename)
+    else:
+        log_reader = RecordReader(filename)
     best_cost = 1e30
     best_inp = None
     best_res = None
@@ -0,0 +1,211 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+"""The micro-kernels of the CPU tensor instructions, tensorized by the sketch rules.
+
+Each micro-kernel computes a block of lanes outputs from a reduction block of the data and a
+lanes x reduce block of the kernel:
+
+.. code-block:: c
+
+    for (int i = 0; i < lanes; i++)
+        for (int k = 0; k < reduce; k++)
+            out[i] += data[k] * kernel[i][k];  // kernel[k][i] for the transposed kernel
+
+They are registered as auto_scheduler.tensor_intrin.<name>, the names the CPU tensorize rule
+of the sketch policy matches the reductions of a task with. The rows of the kernel may be
+strided, a block of contiguous rows, e.g. after the layout rewrite of the weights, is loaded
+with one vector load.
+"""
+import tvm._ffi
+from tvm import te, tir
+
+
+def _placeholders(data_dtype, kernel_dtype, out_dtype, lanes, reduce, kernel_transposed):
+    """The compute of a micro-kernel and the buffers it binds."""
+    data = te.placeholder((reduce,), dtype=data_dtype, name="data")
+    kernel_shape = (reduce, lanes) if kernel_transposed else (lanes, reduce)
+    kernel = te.placeholder(kernel_shape, dtype=kernel_dtype, name="kernel")
+    k = te.reduce_axis((0, reduce), name="k")
+
+    def _cast(value):
+        return value if value.dtype == out_dtype else value.astype(out_dtype)
+
+    def _kernel(i):
+        return kernel[k, i] if kernel_transposed else kernel[i, k]
+
+    out = te.compute(
+        (lanes,), lambda i: te.sum(_cast(data[k]) * _cast(_kernel(i)), axis=k), name="out"
+    )
+    binds = {
+        data: tir.decl_buffer(data.shape, data_dtype, "data_buf", offset_factor=1, strides=[1]),
+        kernel: tir.decl_buffer(
+            kernel.shape,
+            kernel_dtype,
+            "kernel_buf",
+            offset_factor=reduce,
+            strides=[te.var("ldw"), 1],
+        ),
+        out: tir.decl_buffer(out.shape, out_dtype, "out_buf", offset_factor=1, strides=[1]),
+    }
+    return out, binds
+
+
+def _load_words(buf, dtype, rows):
+    """Load each row of a kernel block as one word of a vector of the rows."""
+    word_bits = tvm.runtime.DataType(dtype).bits
+    elems = word_bits // tvm.runtime.DataType(buf.dtype).bits
+    index = tir.Ramp(
+        tir.indexdiv(buf.elem_offset, elems), tir.indexdiv(buf.strides[0], elems), rows
+    )
+    return tir.Load("%sx%d" % (dtype, rows), buf.data, index)
+
+
+def _dot_int8_intrin(data_dtype, kernel_dtype, out_dtype, lanes, make_dot):
+    """The int8 dot products of 4 elements per lane, accumulated in 32 bits."""
+    out, binds = _placeholders(data_dtype, kernel_dtype, out_dtype, lanes, 4, False)
+    vec_out = "%sx%d" % (out_dtype, lanes)
+
+    def _intrin_func(ins, outs):
+        def _instr(index):
+            ib = tir.ir_builder.create()
+            if index == 1:
+                ib.emit(outs[0].vstore(0, tir.const(0, vec_out)))
+                return ib.get()
+            # Broadcast the 4 data elements to every lane, as one 32-bit word
+            vec_data = ins[0].vload([0], "%sx4" % data_dtype)
+            word = tir.call_intrin(out_dtype, "tir.reinterpret", vec_data)
+            vec_data = tir.Broadcast(word, lanes)
+            vec_kernel = _load_words(ins[1], out_dtype, lanes)
+            acc = tir.const(0, vec_out) if index == 0 else outs[0].vload([0], vec_out)
+            ib.emit(outs[0].vstore(0, make_dot(acc, vec_data, vec_kernel)))
+            return ib.get()
+
+        # body, reset, update
+        return _instr(0), _instr(1), _instr(2)
+
+    return te.decl_tensor_intrin(out.op, _intrin_func, binds=binds)
+
+
+def dot_vnni_u8s8s32_16x4():
+    """The uint8 x int8 dot products of AVX-512 VNNI vpdpbusd, 16 int32 lanes of 4 elements.
+
+    Returns
+    -------
+    intrin : TensorIntrin
+        The tensor intrinsic.
+    """
+
+    def _make_dot(acc, vec_data, vec_kernel):
+        return tir.call_llvm_pure_intrin(
+            "int32x16",
+            "llvm.x86.avx512.vpdpbusd.512",
+            tir.const(0, "uint32"),
+            acc,
+            vec_data,
+            vec_kernel,
+        )
+
+    return _dot_int8_intrin("uint8", "int8", "int32", 16, _make_dot)
+
+
+def dot_arm_int8_4x4(dtype):
+    """The int8 dot products of the ARM dot-product extension sdot/udot, 4 32-bit lanes of 4
+    elements.
+
+    Parameters
+    ----------
+    dtype : str, {"int", "uint"}
+        Whether the elements are signed or unsigned.
+
+    Returns
+    -------
+    intrin : TensorIntrin
+        The tensor intrinsic.
+    """
+    inst = "llvm.aarch64.neon.%s.v4i32.v16i8" % ("sdot" if dtype == "int" else "udot")
+
+    def _make_dot(acc, vec_data, vec_kernel):
+        return tir.call_llvm_pure_intrin(
+            "%s32x4" % dtype,
+            inst,
+            tir.const(2, "uint32"),
+            acc,
+            tir.call_intrin("%s8x16" % dtype, "tir.reinterpret", vec_data),
+            tir.call_intrin("%s8x16" % dtype, "tir.reinterpret", vec_kernel),
+        )
+
+    return _dot_int8_intrin("%s8" % dtype, "%s8" % dtype, "%s32" % dtype, 4, _make_dot)
+
+
+def fmla_f16_8x1():
+    """The fp16 multiply-accumulate by element of ARM FMLA, 8 lanes of the transposed kernel.
+
+    Returns
+    -------
+    intrin : TensorIntrin
+        The tensor intrinsic.
+    """
+    out, binds = _placeholders("float16", "float16", "float16", 8, 1, True)
+
+    def _intrin_func(ins, outs):
+        def _instr(index):
+            ib = tir.ir_builder.create()
+            if index == 1:
+                ib.emit(outs[0].vstore(0, tir.const(0, "float16x8")))
+                return ib.get()
+            vec_data = tir.Broadcast(ins[0].vload([0], "float16"), 8)
+            vec_kernel = ins[1].vload([0, 0], "float16x8")
+            if index == 0:
+                ib.emit(outs[0].vstore(0, vec_data * vec_kernel))
+                return ib.get()
+            fma = tir.call_llvm_pure_intrin(
+                "float16x8",
+                "llvm.fmuladd",
+                tir.const(3, "uint32"),
+                vec_data,
+                vec_kernel,
+                outs[0].vload([0], "float16x8"),
+            )
+            ib.emit(outs[0].vstore(0, fma))
+            return ib.get()
+
+        # body, reset, update
+        return _instr(0), _instr(1), _instr(2)
+
+    return te.decl_tensor_intrin(out.op, _intrin_func, binds=binds)
+
+
+# The micro-kernels of the CPU tensorize rule, by the name of their sketch pragma
+@tvm._ffi.register_func("auto_scheduler.tensor_intrin.x86_vnni_u8s8s32_16x4")
+def _vnni_u8s8s32_16x4():
+    return dot_vnni_u8s8s32_16x4()
+
+
+@tvm._ffi.register_func("auto_scheduler.tensor_intrin.arm_sdot_s8s8s32_4x4")
+def _arm_sdot_s8s8s32_4x4():
+    return dot_arm_int8_4x4("int")
+
+
+@tvm._ffi.register_func("auto_scheduler.tensor_intrin.arm_udot_u8u8u32_4x4")
+def _arm_udot_u8u8u32_4x4():
+    return dot_arm_int8_4x4("uint")
+
+
+@tvm._ffi.register_func("auto_scheduler.tensor_intrin.arm_fmla_f16_8x1")
+def _arm_fmla_f16_8x1():
+    return fmla_f16_8x1()
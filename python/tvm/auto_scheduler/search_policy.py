@@ -61,6 +61,28 @@ class PreloadMeasuredStates(SearchCallback):
         self.__init_handle_by_constructor__(_ffi_api.PreloadMeasuredStates, filename)
 
 
+@tvm._ffi.register_object("auto_scheduler.PreloadSimilarTaskStates")
+class PreloadSimilarTaskStates(SearchCallback):
+    """A SearchCallback to warm start a search policy with the states of similar tasks.
+
+    The best records of the tasks with the same op type, i.e. the same workload key but for
+    its numbers such as the shapes, and the same target kind are loaded from the log file.
+    The nearest shapes go first, then the fastest states. Their split lengths are fitted to
+    the extents of the current task, and the adapted states join the initial population of
+    the first search round, which measures them first.
+
+    Parameters
+    ----------
+    filename : str
+        The name of the record file.
+    max_states : int = 16
+        The maximum number of loaded states.
+    """
+
+    def __init__(self, filename, max_states=16):
+        self.__init_handle_by_constructor__(_ffi_api.PreloadSimilarTaskStates, filename, max_states)
+
+
 @tvm._ffi.register_object("auto_scheduler.PreloadCustomSketchRule")
 class PreloadCustomSketchRule(SearchCallback):
     """
@@ -0,0 +1,191 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""
+Tuning of the block sparse dense operators converted from pruned dense layers.
+
+The sparse_dense tasks are keyed by the block size and the number of blocks of
+their weight, so every tuned schedule is specialized to the actual sparsity
+pattern. The block size of every weight is selected by the search: the
+network is converted with every candidate block size, the tasks of all the
+candidates are tuned together by the task scheduler, and every weight keeps
+the block size of its fastest task.
+"""
+import logging
+
+import numpy as np
+
+from . import _ffi_api
+from .cost_model import XGBModel
+from .loop_state import State
+from .relay_integration import extract_tasks
+from .search_policy import PreloadCustomSketchRule, SketchPolicy
+from .task_scheduler import TaskScheduler
+
+logger = logging.getLogger("auto_scheduler")
+
+
+def _meet_condition_func(search_policy, state, stage_id):
+    state = State(state, search_policy.search_task.compute_dag)
+    if state.stages[stage_id].op.tag in [
+        "sparse_dense_sp_rhs_bsrmm",
+        "sparse_dense_sp_rhs_bsrmm_block",
+    ]:
+        return PreloadCustomSketchRule.APPLY_AND_SKIP_REST
+    return PreloadCustomSketchRule.PASS
+
+
+def _apply_func(search_policy, state, stage_id):
+    s0 = State(state, search_policy.search_task.compute_dag)
+    if s0.stages[stage_id].op.tag == "sparse_dense_sp_rhs_bsrmm_block":
+        return [s0.state_object, stage_id - 1]
+
+    sparse_dense = s0.stages[stage_id].op
+    sparse_dense_block = s0.stages[stage_id - 1].op
+    assert sparse_dense.tag == "sparse_dense_sp_rhs_bsrmm"
+    assert sparse_dense_block.tag == "sparse_dense_sp_rhs_bsrmm_block"
+
+    # The block stage is computed at the output, or at its single elementwise consumer.
+    consumer = sparse_dense
+    consumers = _ffi_api.SearchPolicyUtilsGetConsumers(
+        search_policy.search_task, s0.state_object, stage_id
+    )
+    if len(consumers) == 1:
+        consumer_id = int(consumers.items()[0][0])
+        if _ffi_api.SearchPolicyUtilsIsElementwiseMatch(
+            search_policy.search_task, s0.state_object, stage_id, consumer_id
+        ):
+            consumer = s0.stages[consumer_id].op
+            s0.compute_inline(sparse_dense)
+
+    i, nb_j, j, row_offset, c = s0[sparse_dense_block].iters
+    m, n = s0[consumer].iters
+    i0, i1, i2 = s0.split(sparse_dense_block, i, [None, None])
+    m0, m1 = s0.follow_split(consumer, m, len(s0.transform_steps) - 1, 1)
+    j0, j1 = s0.split(sparse_dense_block, nb_j, [None])
+    n0, n1 = s0.follow_split(consumer, n, len(s0.transform_steps) - 1, 1)
+    s0.reorder(sparse_dense_block, [i0, j0, i1, j1, row_offset, i2, j, c])
+    s0.reorder(consumer, [m0, n0, m1, n1])
+    s0.compute_at(sparse_dense_block, consumer, n0)
+    return [[s0.state_object, stage_id - 2]]
+
+
+def sparse_dense_sketch_rule():
+    """The sketch rule tiling the block sparse dense operators.
+
+    The rows of the data and the blocks of the weight are tiled, while the
+    elements of a block row, whose number depends on the sparsity pattern, stay
+    an inner reduction.
+
+    Returns
+    -------
+    rule : PreloadCustomSketchRule
+        The sketch rule, to be given to the init_search_callbacks of a SketchPolicy.
+    """
+    return PreloadCustomSketchRule(_meet_condition_func, _apply_func, "SparseDense")
+
+
+def tune_block_sizes(
+    mod, params, target, block_sizes, tuning_options, sparsity_threshold=0.75, verbose=1
+):
+    """Tune a network with pruned dense layers, selecting the block size of every one.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The network, with the pruned weights of its dense ops in the params.
+    params : Dict[str, tvm.nd.NDArray]
+        The parameters of the network.
+    target : Union[tvm.target.Target, str]
+        The compilation target.
+    block_sizes : List[Tuple[int, int]]
+        The candidate block sizes.
+    tuning_options : TuningOptions
+        The tuning options of all the tasks of all the candidates. The best schedules
+        are recorded by its measure callbacks.
+    sparsity_threshold : float
+        The minimal sparsity of the dense weights to convert.
+    verbose : int
+        The verbosity level of the search policies.
+
+    Returns
+    -------
+    block_sizes : Dict[str, Tuple[int, int]]
+        The selected block size of every converted weight, to be given to
+        relay.data_dep_optimization.bsr_dense.convert.
+    """
+    # pylint: disable=import-outside-toplevel
+    import scipy.sparse as sp
+    import tvm
+    from tvm.relay.analysis import sparse_dense
+    from tvm.relay.data_dep_optimization import bsr_dense
+
+    weight_names = [str(name) for name in sparse_dense._search_dense_op_weight(mod["main"])]
+    weight_names = [
+        name
+        for name in weight_names
+        if 1.0 - np.count_nonzero(params[name].numpy()) / params[name].numpy().size
+        >= sparsity_threshold
+    ]
+
+    tasks, task_weights, index = [], [], {}
+    for block_size in block_sizes:
+        func, new_params = bsr_dense.convert(
+            mod["main"], dict(params), block_size, sparsity_threshold
+        )
+        for task, weight in zip(*extract_tasks(tvm.IRModule.from_expr(func), new_params, target)):
+            if task.workload_key not in index:
+                index[task.workload_key] = len(tasks)
+                tasks.append(task)
+                task_weights.append(weight)
+
+    # The task of every weight with every block size, found by the names of its inputs.
+    candidates = {name: [] for name in weight_names}
+    for name in weight_names:
+        w_np = params[name].numpy()
+        for block_size in block_sizes:
+            prefix = sparse_dense.sparse_dense_task_input_prefix(
+                w_np.shape, sp.bsr_matrix(w_np, blocksize=block_size)
+            )
+            for task_idx, task in enumerate(tasks):
+                if any(str(x).startswith(prefix) for x in task.task_input_names):
+                    candidates[name].append((block_size, task_idx))
+                    break
+
+    cost_model = XGBModel(num_warmup_sample=len(tasks) * tuning_options.num_measures_per_round)
+    policies = [
+        SketchPolicy(
+            task, cost_model, verbose=verbose, init_search_callbacks=[sparse_dense_sketch_rule()]
+        )
+        for task in tasks
+    ]
+    tuner = TaskScheduler(tasks, task_weights)
+    tuner.tune(tuning_options, search_policy=policies)
+
+    selected = {}
+    for name in weight_names:
+        if not candidates[name]:
+            selected[name] = tuple(block_sizes[0])
+            continue
+        block_size, task_idx = min(candidates[name], key=lambda c: tuner.best_costs[c[1]])
+        selected[name] = tuple(block_size)
+        logger.info(
+            "Block size %s for %s: %.3f ms",
+            block_size,
+            name,
+            tuner.best_costs[task_idx] * 1e3,
+        )
+    return selected
@@ -33,7 +33,7 @@ from .search_policy import SearchPolicy, SketchPolicy, PreloadMeasuredStates
 from .cost_model import RandomModel, XGBModel
 from .utils import array_mean
 from .measure import ProgramMeasurer
-from .measure_record import RecordReader
+from .measure_record import RecordReader, is_record_store, load_records
 from . import _ffi_api
 
 logger = logging.getLogger("auto_scheduler")
@@ -320,6 +320,7 @@ class TaskScheduler:
             tune_option.runner,
             tune_option.measure_callbacks,
             tune_option.verbose,
+            cache_file=self.load_log_file,
         )
         self.ct = self.best_ct = 0
         self.tic = time.time()
@@ -450,7 +451,7 @@ class TaskScheduler:
             callback.pre_tune(self, task_idx)
 
         measure_inputs, measure_results = self.search_policies[task_idx].continue_search_one_round(
-            self.num_measures_per_round, self.measurer
+            self.num_measures_per_round, self._task_measurer(task_idx)
         )
 
         self.task_cts[task_idx] += 1
@@ -478,6 +479,10 @@ class TaskScheduler:
         for callback in self.callbacks:
             callback.post_tune(self, task_idx)
 
+    def _task_measurer(self, task_idx):  # pylint: disable=unused-argument
+        """The measurer of the next round of a task"""
+        return self.measurer
+
     def _compute_score(self, costs):
         """compute the objective function"""
         return self.objective_func(costs)
@@ -508,7 +513,8 @@ class TaskScheduler:
         workload_key_to_task_id = {t.workload_key: i for i, t in enumerate(self.tasks)}
         total_ct = -1
 
-        for total_ct, (inp, res) in enumerate(RecordReader(log_file)):
+        records = load_records(log_file) if is_record_store(log_file) else RecordReader(log_file)
+        for total_ct, (inp, res) in enumerate(records):
             if str(inp.task.target) != str_target:
                 continue
             task_idx = workload_key_to_task_id.get(inp.task.workload_key, None)
@@ -539,6 +545,160 @@ class TaskScheduler:
         logger.info("TaskScheduler: Loaded %d measurement records from %s", total_ct + 1, log_file)
 
 
+class ClusterTaskScheduler(TaskScheduler):
+    """
+    Tune the tasks of several models together, over the devices of an RPC tracker.
+
+    The identical workloads of the models, i.e. the tasks of the same workload key and target,
+    are tuned once, with the sum of their weights in all models. The objective is the
+    weighted sum of the latencies of the models. The measurements are shared with the other
+    tuning processes through a record store: the scheduler, the search policies and the
+    cost model are restored from it, and the new measurements are appended to it.
+
+    Each round of a task is measured on the devices of one of the tracker keys of its target,
+    in turn when it has several keys.
+
+    Parameters
+    ----------
+    models: List[Tuple[List[SearchTask], List[float]]]
+        The tasks and the task weights of each model, e.g. by `extract_tasks`.
+    model_weights: Optional[List[float]]
+        The weights of the models, all 1 if not provided.
+    record_store: Optional[str]
+        The path of the record store shared by the tuning processes.
+    device_keys: Optional[Dict[str, Union[str, List[str]]]]
+        The tracker keys of the targets, by target string or target kind name.
+        If not provided, all keys of the tracker are used for all targets.
+    host: Optional[str]
+        The host address of the RPC tracker, TVM_TRACKER_HOST if not provided.
+    port: Optional[int]
+        The port of the RPC tracker, TVM_TRACKER_PORT if not provided.
+    rpc_runner_params: Optional[Dict[str, Any]]
+        The parameters of the RPCRunner of each key. The `n_parallel` defaults to the
+        number of servers of the key.
+    kwargs:
+        The other parameters of the TaskScheduler, e.g. strategy or callbacks.
+    """
+
+    def __init__(
+        self,
+        models,
+        model_weights=None,
+        record_store=None,
+        device_keys=None,
+        host=None,
+        port=None,
+        rpc_runner_params=None,
+        **kwargs,
+    ):
+        model_weights = model_weights or [1.0] * len(models)
+        assert len(model_weights) == len(models)
+
+        # Deduplicate the identical workloads of the models.
+        tasks, task_weights, task_ids = [], [], {}
+        self.model_task_ids = []  # model_id -> the (task id, task weight) of its tasks
+        for (model_tasks, weights), model_weight in zip(models, model_weights):
+            weights = weights if weights is not None else [1.0] * len(model_tasks)
+            model_task_ids = []
+            for task, weight in zip(model_tasks, weights):
+                key = (task.workload_key, str(task.target))
+                if key not in task_ids:
+                    task_ids[key] = len(tasks)
+                    tasks.append(task)
+                    task_weights.append(0.0)
+                task_weights[task_ids[key]] += model_weight * weight
+                model_task_ids.append((task_ids[key], weight))
+            self.model_task_ids.append(model_task_ids)
+        logger.info(
+            "ClusterTaskScheduler: %d unique tasks of %d tasks in %d models",
+            len(tasks),
+            sum(len(ids) for ids in self.model_task_ids),
+            len(models),
+        )
+
+        self.record_store = record_store
+        if record_store and os.path.isfile(record_store):
+            kwargs.setdefault("load_log_file", record_store)
+        super().__init__(tasks, task_weights=task_weights, **kwargs)
+
+        self.host = host or os.environ.get("TVM_TRACKER_HOST", "127.0.0.1")
+        self.port = int(port or os.environ.get("TVM_TRACKER_PORT", 9190))
+        self.device_keys = device_keys
+        self.rpc_runner_params = rpc_runner_params or {}
+        self.task_keys = self.measurers = None
+
+    def model_latencies(self):
+        """The estimated latency of each model, the weighted sum of its best task latencies.
+
+        Returns
+        -------
+        latencies: List[float]
+            The latency in seconds of each model.
+        """
+        return [
+            sum(weight * self.best_costs[i] for i, weight in model_task_ids)
+            for model_task_ids in self.model_task_ids
+        ]
+
+    def tune(self, tune_option, *args, **kwargs):
+        """Tune the tasks of all models together.
+
+        Parameters
+        ----------
+        tune_option: TuningOptions
+            The tuning options applied to all tasks. The runner is replaced by the RPCRunners
+            of the tracker keys.
+        args, kwargs:
+            The other parameters of TaskScheduler.tune.
+        """
+        # pylint: disable=import-outside-toplevel
+        from tvm import rpc
+        from .measure import RPCRunner
+        from .measure_record import RecordToStore
+
+        summary = rpc.connect_tracker(self.host, self.port).summary()
+        servers = {}
+        for server in summary.get("server_info", []):
+            key = server["key"].split(":", 1)[-1]
+            servers[key] = servers.get(key, 0) + 1
+        all_keys = sorted(set(summary.get("queue_info", {}).keys()) | set(servers.keys()))
+
+        self.task_keys = []
+        for task in self.tasks:
+            if self.device_keys is None:
+                keys = all_keys
+            else:
+                keys = self.device_keys.get(str(task.target), None)
+                if keys is None:
+                    keys = self.device_keys.get(task.target.kind.name, [])
+                keys = [keys] if isinstance(keys, str) else list(keys)
+            if not keys:
+                raise ValueError("No tracker key for the target %s" % task.target)
+            self.task_keys.append(keys)
+
+        measure_callbacks = list(tune_option.measure_callbacks)
+        if self.record_store:
+            measure_callbacks.append(RecordToStore(self.record_store))
+        self.measurers = {}
+        for key in sorted(set(k for keys in self.task_keys for k in keys)):
+            params = dict(self.rpc_runner_params)
+            params.setdefault("n_parallel", max(1, servers.get(key, 1)))
+            runner = RPCRunner(key, self.host, self.port, **params)
+            self.measurers[key] = ProgramMeasurer(
+                tune_option.builder,
+                runner,
+                measure_callbacks,
+                tune_option.verbose,
+                cache_file=self.record_store,
+            )
+
+        super().tune(tune_option, *args, **kwargs)
+
+    def _task_measurer(self, task_idx):
+        keys = self.task_keys[task_idx]
+        return self.measurers[keys[self.task_cts[task_idx] % len(keys)]]
+
+
 class TaskSchedulerCallback:
     """The base class of task scheduler callback functions. """
 
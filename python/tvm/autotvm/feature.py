@@ -60,6 +60,9 @@ try:
     _get_itervar_feature_flatten = tvm._ffi.get_global_func(
         "autotvm.feature.GetItervarFeatureFlatten"
     )
+    _get_itervar_feature_flatten_batch = tvm._ffi.get_global_func(
+        "autotvm.feature.GetItervarFeatureFlattenBatch"
+    )
 except ValueError as e:
 
     def raise_error(*args, **kwargs):  # pylint: disable=unused-argument
@@ -67,7 +70,7 @@ except ValueError as e:
 
     _get_buffer_curve_sample_flatten = (
         _get_itervar_feature
-    ) = _get_itervar_feature_flatten = raise_error
+    ) = _get_itervar_feature_flatten = _get_itervar_feature_flatten_batch = raise_error
 
 
 def get_itervar_feature(sch, args, take_log=False):
@@ -142,6 +145,40 @@ def get_itervar_feature_flatten(sch, args, take_log=True):
     return feas
 
 
+def get_itervar_feature_flatten_batch(schedules, take_log=True):
+    """get flatten features of iter vars of many schedules,
+    lowering them in parallel threads of the c++ runtime.
+    this is equivalent to get_itervar_feature_flatten on each schedule.
+
+    Parameters
+    ----------
+    schedules: List[Tuple[tvm.te.schedule.Schedule, Array of te.tensor.Tensor]]
+        the schedules and their buffer args for lower
+    take_log: bool
+        whether take log of numerical statics
+
+    Returns
+    -------
+    flatten_features: List[Optional[np.ndarray]]
+        one-dimensional vector of each schedule, None when its lowering failed
+    """
+    if not schedules:
+        return []
+    buf = _get_itervar_feature_flatten_batch(
+        [sch for sch, _ in schedules], [args for _, args in schedules], take_log
+    )
+    words = np.frombuffer(buf, dtype=np.int32)
+    n = words[0]
+    sizes = words[1 : n + 1]
+    data = np.frombuffer(buf, dtype=np.float32, offset=4 * (n + 1))
+    ret = []
+    offset = 0
+    for size in sizes:
+        ret.append(np.array(data[offset : offset + size]) if size else None)
+        offset += size
+    return ret
+
+
 def get_flatten_name(fea):
     """Get names of feature after flatten.
 
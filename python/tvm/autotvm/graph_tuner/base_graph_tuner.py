@@ -49,6 +49,10 @@ def get_infer_layout(task_name):
         return topi.nn.conv2d_infer_layout
     if task_name.startswith("depthwise_conv2d"):
         return topi.nn.depthwise_conv2d_infer_layout
+    if task_name.startswith("dense"):
+        return topi.nn.dense_infer_layout
+    if task_name.startswith("batch_matmul"):
+        return topi.nn.batch_matmul_infer_layout
     raise ValueError("Cannot find infer layout for task %s" % task_name)
 
 
@@ -582,6 +586,53 @@ class BaseGraphTuner(object):
         msg = "Writing optimal schedules to %s successfully." % record_file
         self._logger.info(msg)
 
+    def _run_native_layout_plan(self):
+        """Select the schedules of all the nodes with the native solver of
+        relay.analysis.solve_layout_plan."""
+        input_names = self._input_shapes.keys()
+        nodes = []
+        for idx in sorted(self._in_nodes_dict):
+            node_entry = self._node_list[idx]
+            if "record_candidates" in node_entry and not is_boundary_node(node_entry, input_names):
+                nodes.append(idx)
+        index = {idx: i for i, idx in enumerate(nodes)}
+
+        node_costs = []
+        for idx in nodes:
+            node_entry = self._node_list[idx]
+            costs = [record[1].costs[0] for record in node_entry["record_candidates"]]
+            if node_entry["op"] not in self._target_ops:
+                # Multi-input nodes have no kernel of their own to select
+                costs = [0.0] * len(costs)
+            node_costs.append(costs)
+
+        edges = []
+        edge_costs = []
+        for (from_idx, to_idx), ltf_matrix in self._layout_transform_interlayer_cost.items():
+            if from_idx in index and to_idx in index and from_idx != to_idx:
+                edges.append((index[from_idx], index[to_idx]))
+                edge_costs.append(ltf_matrix)
+
+        # Multi-input nodes take the layout of their first input, the layout
+        # transformations of the other inputs are edges to the first input.
+        for idx in nodes:
+            if not has_multiple_inputs(self._node_list, idx, input_names, self._opt_out_op):
+                continue
+            for input_idx in self._in_nodes_dict[idx]:
+                if is_boundary_node(self._node_list[input_idx], input_names):
+                    continue
+                if input_idx in index:
+                    num_candidates = len(node_costs[index[idx]])
+                    ltf_matrix = np.full((num_candidates, num_candidates), INVALID_LAYOUT_TIME)
+                    np.fill_diagonal(ltf_matrix, 0)
+                    edges.append((index[input_idx], index[idx]))
+                    edge_costs.append(ltf_matrix)
+                break
+
+        choices = relay.analysis.solve_layout_plan(node_costs, edges, edge_costs)
+        for idx, choice in zip(nodes, choices):
+            self._optimal_record_dict[idx] = choice
+
     @abstractmethod
     def run(self, **kwargs):
         """Run graph tuning."""
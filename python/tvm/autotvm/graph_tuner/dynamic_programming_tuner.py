@@ -198,7 +198,24 @@ class DPTuner(BaseGraphTuner):
         self._logger.info("Finished backward pass...")
 
     def run(self, **kwargs):
-        """Run dynamic programming solver."""
+        """Run dynamic programming solver.
+
+        Parameters
+        ----------
+        max_num_states : int, optional
+            The maximum number of states of the dynamic programming.
+
+        use_native : bool, optional
+            Whether to select the schedules with the native solver of
+            relay.analysis.solve_layout_plan instead, False by default. It is exact
+            where the graph reduces to a chain or a tree, and decides the nodes
+            with more than two neighbors greedily, in seconds on large graphs.
+        """
+        if kwargs.get("use_native", False):
+            self._logger.info("Start to run the native layout planner...")
+            self._run_native_layout_plan()
+            self._logger.info("Finished the native layout planner.")
+            return
         max_num_states = None if "max_num_states" not in kwargs else kwargs["max_num_states"]
         self._num_states = 0
         self._max_num_states = max_num_states
@@ -0,0 +1,34 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Tuner using the native global layout planner"""
+from .base_graph_tuner import BaseGraphTuner
+
+
+class LayoutPlanTuner(BaseGraphTuner):
+    """Tuner selecting the schedules of all the nodes at once, minimizing the
+    kernel plus layout transformation time of the whole graph with the native
+    solver of relay.analysis.solve_layout_plan.
+
+    Besides conv2d, dense and batch_matmul can be target operators: their
+    layouts are fixed, so that only their schedules are selected.
+    """
+
+    def run(self, **kwargs):
+        """Run the native layout planner."""
+        self._logger.info("Start to run the native layout planner...")
+        self._run_native_layout_plan()
+        self._logger.info("Finished the native layout planner.")
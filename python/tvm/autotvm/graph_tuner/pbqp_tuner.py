@@ -230,7 +230,20 @@ class PBQPTuner(BaseGraphTuner):
                 self._optimal_record_dict[node_idx] = record_costs.index(min_cost)
 
     def run(self, **kwargs):
-        """Run partitioned boolean quadratic programming tuner."""
+        """Run partitioned boolean quadratic programming tuner.
+
+        Parameters
+        ----------
+        use_native : bool, optional
+            Whether to run the reductions with the native solver of
+            relay.analysis.solve_layout_plan, True by default. The python
+            reductions run the same algorithm, much slower on large graphs.
+        """
+        if kwargs.get("use_native", True):
+            self._logger.info("Start to run the native PBQP solver...")
+            self._run_native_layout_plan()
+            self._logger.info("Finished the native PBQP solver.")
+            return
         self._logger.info("Start to run PBQP algorithm...")
         # Define virtual record lists and layout transformaton matrices
         # for multi-input nodes.
@@ -23,6 +23,7 @@ remote devices, recording the running time costs, and checking the correctness o
 """
 
 import contextlib
+import hashlib
 import logging
 import shutil
 import os
@@ -33,11 +34,13 @@ from random import getrandbits
 from collections import namedtuple
 import tempfile
 
+import numpy as np
+
 import tvm._ffi
 import tvm.ir.transform
 from tvm import nd, rpc as _rpc
 from tvm.error import TVMError
-from tvm.driver import build
+from tvm.driver import build, lower
 from tvm.contrib import nvcc, ndk, tar, stackvm
 from tvm.target import Target
 
@@ -82,9 +85,13 @@ class LocalBuilder(Builder):
         If is 'ndk', use function for android ndk
         If id 'stackvm', use function for stackvm
         If is callable, use it as custom build function, expect lib_format field.
+    cache_dir: str, optional
+        The directory of the built libraries, keyed by the hash of their lowered IR.
+        A config lowering to the same IR as one built before, by this or another
+        tuner or session, takes its library instead of being compiled again.
     """
 
-    def __init__(self, timeout=10, n_parallel=None, build_func="default"):
+    def __init__(self, timeout=10, n_parallel=None, build_func="default", cache_dir=None):
         super(LocalBuilder, self).__init__(timeout, n_parallel)
 
         if isinstance(build_func, str):
@@ -96,7 +103,9 @@ class LocalBuilder(Builder):
                 build_func = stackvm.build
             else:
                 raise ValueError("Invalid build_func" + build_func)
-        self.build_func = _WrappedBuildFunc(build_func)
+        if cache_dir is not None:
+            os.makedirs(cache_dir, exist_ok=True)
+        self.build_func = _WrappedBuildFunc(build_func, cache_dir)
         self.executor = LocalExecutor(timeout=timeout)
         self.tmp_dir = tempfile.mkdtemp()
 
@@ -207,6 +216,16 @@ class RPCRunner(Runner):
     module_loader : ModuleLoader
         If given, a context manager that loads the module to be timed into the remote runtime.
         If not given, default_module_loader is used.
+    early_stop_ratio: float, optional
+        If set, each candidate is first timed with one `repeat`. When it is slower than
+        early_stop_ratio times the reference cost of the task, its other repeats are skipped
+        and the first timing is its result.
+    early_stop_percentile: float, optional
+        The percentile of the mean costs measured so far on the task taken as the
+        reference cost of early_stop_ratio.
+    max_repeat: int, optional
+        If set, the number of repeats of the close contenders, whose first timing is within
+        10% of the best cost measured so far on the task.
     """
 
     def __init__(
@@ -223,6 +242,9 @@ class RPCRunner(Runner):
         cooldown_interval=0.1,
         enable_cpu_cache_flush=False,
         module_loader=None,
+        early_stop_ratio=None,
+        early_stop_percentile=10,
+        max_repeat=None,
     ):
         super(RPCRunner, self).__init__(timeout, n_parallel)
 
@@ -240,10 +262,17 @@ class RPCRunner(Runner):
         self.cooldown_interval = cooldown_interval
         self.module_loader = module_loader
 
+        self.early_stop_ratio = early_stop_ratio
+        self.early_stop_percentile = early_stop_percentile
+        self.max_repeat = max_repeat
+        # The mean costs of the candidates measured so far on the task
+        self.measured_costs = []
+
         self.executor = LocalExecutor(timeout=timeout * (self.n_parallel + 1))
 
     def set_task(self, task):
         self.task = task
+        self.measured_costs = []
 
         if check_remote(task.target, self.key, self.host, self.port):
             logger.info("Get devices for measurement successfully!")
@@ -281,6 +310,24 @@ class RPCRunner(Runner):
 
         return kwargs
 
+    def get_adaptive_repeat(self):
+        """The adaptive measurement of the next candidates, from the costs measured so far.
+
+        Returns
+        -------
+        adaptive_repeat: Optional[AdaptiveRepeat]
+            The argument of run_through_rpc, None for the fixed number of repeats.
+        """
+        if self.early_stop_ratio is None and self.max_repeat is None:
+            return None
+        if not self.measured_costs:
+            return None
+        stop_cost = None
+        if self.early_stop_ratio is not None:
+            reference = np.percentile(self.measured_costs, self.early_stop_percentile)
+            stop_cost = float(reference * self.early_stop_ratio)
+        return AdaptiveRepeat(stop_cost, float(min(self.measured_costs)), self.max_repeat)
+
     def run(self, measure_inputs, build_results):
         results = []
         remote_kwargs = dict(
@@ -293,6 +340,7 @@ class RPCRunner(Runner):
 
         for i in range(0, len(measure_inputs), self.n_parallel):
             futures = []
+            adaptive_repeat = self.get_adaptive_repeat()
             for measure_inp, build_res in zip(
                 measure_inputs[i : i + self.n_parallel], build_results[i : i + self.n_parallel]
             ):
@@ -312,6 +360,7 @@ class RPCRunner(Runner):
                     remote_kwargs,
                     self.enable_cpu_cache_flush,
                     module_loader,
+                    adaptive_repeat,
                 )
                 futures.append(ret)
 
@@ -325,6 +374,8 @@ class RPCRunner(Runner):
                     )
                 else:
                     results.append(res)
+                    if res.error_no == MeasureErrorNo.NO_ERROR:
+                        self.measured_costs.append(np.mean(res.costs))
 
         return results
 
@@ -360,6 +411,13 @@ class LocalRunner(RPCRunner):
         its actual latency during end-to-end inference.
         To make this option effective, the argument `number` should also be set to 1.
         This is only has effect on CPU task.
+    early_stop_ratio: float, optional
+        Skip the other repeats of the candidates whose first timing is slower than
+        early_stop_ratio times the reference cost of the task. See RPCRunner.
+    early_stop_percentile: float, optional
+        The percentile of the costs measured so far taken as the reference cost.
+    max_repeat: int, optional
+        The number of repeats of the close contenders of the best cost. See RPCRunner.
     Note
     ----
     This is a "fake" local mode. We start a silent rpc tracker and rpc server
@@ -375,6 +433,9 @@ class LocalRunner(RPCRunner):
         cooldown_interval=0.1,
         enable_cpu_cache_flush=False,
         module_loader=None,
+        early_stop_ratio=None,
+        early_stop_percentile=10,
+        max_repeat=None,
     ):
         super(LocalRunner, self).__init__(
             "",
@@ -389,6 +450,9 @@ class LocalRunner(RPCRunner):
             cooldown_interval=cooldown_interval,
             enable_cpu_cache_flush=enable_cpu_cache_flush,
             module_loader=module_loader,
+            early_stop_ratio=early_stop_ratio,
+            early_stop_percentile=early_stop_percentile,
+            max_repeat=max_repeat,
         )
         self.tracker = None
         self.server = None
@@ -449,6 +513,44 @@ def _build_func_common(measure_input, check_gpu=None, cuda_arch=None, build_opti
     return func, tuple((get_const_tuple(x.shape), x.dtype) for x in args)
 
 
+def _build_func_cached(
+    measure_input, cache_dir, build_func, check_gpu=None, cuda_arch=None, build_option=None
+):
+    """Build a configuration, or take the library of the same lowered IR from the cache"""
+    target, task, config = measure_input
+    target, task.target_host = Target.check_and_update_host_consist(target, task.target_host)
+
+    with target:
+        s, args = task.instantiate(config)
+
+        # check invalidity of template and code hash consistency
+        if not config.valid():
+            raise InstantiationError(config.errors)
+
+        opts = build_option or {}
+        if check_gpu:  # Add verify pass to filter out invalid configs in advance.
+            opts["tir.add_lower_pass"] = [(2, gpu_verify_pass(**check_gpu))]
+        if cuda_arch:
+            set_cuda_target_arch(cuda_arch)
+
+        with tvm.ir.transform.PassContext(config=opts):
+            mod = lower(s, args)
+            key = "%d %s %s %s" % (tvm.ir.structural_hash(mod), target, task.target_host, cuda_arch)
+            filename = os.path.join(
+                cache_dir,
+                "%s.%s" % (hashlib.sha1(key.encode()).hexdigest(), build_func.output_format),
+            )
+            if not os.path.isfile(filename):
+                func = build(mod, target_host=task.target_host)
+                # Export aside first, the other builders only see complete libraries
+                tmp_filename = os.path.join(
+                    cache_dir, "tmp_func_%0x.%s" % (getrandbits(64), build_func.output_format)
+                )
+                func.export_library(tmp_filename, build_func)
+                os.replace(tmp_filename, filename)
+    return filename, tuple((get_const_tuple(x.shape), x.dtype) for x in args)
+
+
 class _WrappedBuildFunc:
     """
     Wrap build_func to a function that can be used in measure.
@@ -461,16 +563,20 @@ class _WrappedBuildFunc:
     build_func : The compilation function
         We expect fcompile to contain an attr "output_format".
 
+    cache_dir : Optional[str]
+        The directory of the built libraries, keyed by the hash of their lowered IR.
+
     Returns
     -------
     wrapped_build_func : callable
         The wrapped build function
     """
 
-    def __init__(self, build_func):
+    def __init__(self, build_func, cache_dir=None):
         if not hasattr(build_func, "output_format"):
             raise AttributeError("Expect build_func to have the attribute output_format.")
         self.build_func = build_func
+        self.cache_dir = cache_dir
 
     def __call__(self, measure_input, tmp_dir, **kwargs):
         """
@@ -486,6 +592,15 @@ class _WrappedBuildFunc:
         """
         tic = time.time()
         try:
+            # vta.build lowers the schedule by itself, its builds are not cached
+            if (
+                self.cache_dir is not None
+                and getattr(measure_input.target, "device_name", None) != "vta"
+            ):
+                filename, arg_info = _build_func_cached(
+                    measure_input, self.cache_dir, self.build_func, **kwargs
+                )
+                return BuildResult(filename, arg_info, None, time.time() - tic)
             filename = os.path.join(
                 tmp_dir, "tmp_func_%0x.%s" % (getrandbits(64), self.build_func.output_format)
             )
@@ -512,6 +627,7 @@ def run_through_rpc(
     remote_kwargs,
     enable_cpu_cache_flush=False,
     module_loader=None,
+    adaptive_repeat=None,
 ):
     """Run a generated library through rpc
 
@@ -549,6 +665,9 @@ def run_through_rpc(
         This is only has effect on CPU task.
     module_loader: ModuleLoader
         A function that returns a ContextManager used to establish and teardown the remote session.
+    adaptive_repeat: Optional[AdaptiveRepeat]
+        If given, time one `repeat` first, then skip the other repeats when it is slower than
+        its stop_cost, or run max_repeat repeats when it is a close contender of its best_cost.
     """
     if isinstance(build_result, MeasureResult):
         return build_result
@@ -566,14 +685,16 @@ def run_through_rpc(
             # the PackedFunc as an object. Currently, we pass function name to work
             # around it.
             f_prepare = "cache_flush_cpu_non_first_arg" if enable_cpu_cache_flush else ""
-            time_f = mod.time_evaluator(
-                mod.entry_name,
-                dev,
-                number=number,
-                repeat=repeat,
-                min_repeat_ms=min_repeat_ms,
-                f_preproc=f_prepare,
-            )
+
+            def make_time_f(n_repeat):
+                return mod.time_evaluator(
+                    mod.entry_name,
+                    dev,
+                    number=number,
+                    repeat=n_repeat,
+                    min_repeat_ms=min_repeat_ms,
+                    f_preproc=f_prepare,
+                )
 
             try:
                 random_fill = remote.get_function("tvm.contrib.random.random_fill")
@@ -588,7 +709,10 @@ def run_through_rpc(
                     random_fill(arg)
             dev.sync()
 
-            costs = time_f(*args).results
+            if adaptive_repeat is None:
+                costs = make_time_f(repeat)(*args).results
+            else:
+                costs = _run_adaptive_repeat(adaptive_repeat, args, repeat, make_time_f)
 
         if len(costs) > 2:  # remove largest and smallest value to reduce variance
             costs = list(costs)
@@ -607,6 +731,37 @@ def run_through_rpc(
     return MeasureResult(costs, errno, tstamp - tic + build_result.time_cost, tstamp)
 
 
+class AdaptiveRepeat(namedtuple("AdaptiveRepeat", ("stop_cost", "best_cost", "max_repeat"))):
+    """
+    The adaptive measurement of a candidate.
+
+    Parameters
+    ----------
+    stop_cost : Optional[float]
+        Skip the other repeats when the first one is slower than this cost.
+    best_cost : float
+        The best cost measured so far on the task.
+    max_repeat : Optional[int]
+        The number of repeats of a candidate whose first repeat is within 10% of best_cost.
+    """
+
+
+# The first timing of a close contender is within this ratio of the best cost
+CONTENDER_RATIO = 1.1
+
+
+def _run_adaptive_repeat(adaptive_repeat, args, repeat, make_time_f):
+    """Time one repeat, then the rest of the repeats the candidate deserves"""
+    costs = list(make_time_f(1)(*args).results)
+    if adaptive_repeat.stop_cost is not None and costs[0] > adaptive_repeat.stop_cost:
+        return tuple(costs)
+    if adaptive_repeat.max_repeat and costs[0] <= adaptive_repeat.best_cost * CONTENDER_RATIO:
+        repeat = max(repeat, adaptive_repeat.max_repeat)
+    if repeat > 1:
+        costs += list(make_time_f(repeat - 1)(*args).results)
+    return tuple(costs)
+
+
 def default_module_loader(pre_load_function=None):
     """Returns a default function that can be passed as module_loader to run_through_rpc.
 
@@ -327,8 +327,11 @@ class XGBoostCostModel(CostModel):
 
         if need_extract:
             pool = self._get_pool()
+            if self.fea_type == "itervar":
+                # The lowering and the extraction run in the parallel threads of the c++ runtime
+                feas = self._extract_itervar_features(need_extract)
             # If we are forking, we can pass arguments in globals for better performance
-            if multiprocessing.get_start_method(False) == "fork":
+            elif multiprocessing.get_start_method(False) == "fork":
                 feas = pool.map(self.feature_extract_func, need_extract)
             else:
                 args = [(self.space.get(x), self.target, self.task) for x in need_extract]
@@ -348,6 +351,26 @@ class XGBoostCostModel(CostModel):
             ret[i, :] = t if t is not None else 0
         return ret
 
+    def _extract_itervar_features(self, indexes):
+        """extract iteration var features for many indexes in one native batch"""
+        configs, schedules, positions = [], [], []
+        for i, idx in enumerate(indexes):
+            config = self.space.get(idx)
+            try:
+                with self.target:
+                    schedules.append(self.task.instantiate(config))
+            except Exception:  # pylint: disable=broad-except
+                continue
+            configs.append(config)
+            positions.append(i)
+
+        feas = [None] * len(indexes)
+        batch = feature.get_itervar_feature_flatten_batch(schedules, take_log=True)
+        for i, config, fea in zip(positions, configs, batch):
+            if fea is not None:
+                feas[i] = np.concatenate((fea, list(config.get_other_option().values())))
+        return feas
+
     def __del__(self):
         self._close_pool()
 
@@ -0,0 +1,168 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Executor of the models compiled ahead of time on the C++ runtime."""
+from tvm.runtime import ndarray
+
+
+def _as_ndarray(value):
+    if isinstance(value, ndarray.NDArray):
+        return value
+    return ndarray.array(value)
+
+
+class AotModule(object):
+    """Wrapper of the AOT executor module.
+
+    The model is compiled with ``--executor=aot`` on a target of the C++
+    runtime, the generated entry function calls the kernels directly on a
+    statically planned arena, without a graph to interpret.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The executor module, created by the factory module of the build.
+
+    Examples
+    --------
+
+    .. code-block:: python
+
+        lib = relay.build(mod, target="llvm --executor=aot", params=params)
+        dev = tvm.cpu()
+        module = aot_executor.AotModule(lib["default"](dev))
+        module.set_input("x", data)
+        module.run()
+        out = module.get_output(0)
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._set_input = module["set_input"]
+        self._set_input_zero_copy = module["set_input_zero_copy"]
+        self._run = module["run"]
+        self._get_output = module["get_output"]
+        self._get_input = module["get_input"]
+        self._get_num_outputs = module["get_num_outputs"]
+        self._get_num_inputs = module["get_num_inputs"]
+
+    def set_input(self, key=None, value=None, **params):
+        """Set inputs to the module via kwargs
+
+        Parameters
+        ----------
+        key : int or str
+           The input key
+
+        value : the input value.
+           The input value
+
+        params : dict of str to NDArray
+           Additional arguments
+        """
+        if key is not None:
+            self._set_input(key, _as_ndarray(value))
+        for k, v in params.items():
+            self._set_input(k, _as_ndarray(v))
+
+    def set_input_zero_copy(self, key, value):
+        """Make the module read an input from an array without copying it, the array is
+        kept alive by the caller.
+
+        Parameters
+        ----------
+        key : int or str
+           The input key
+
+        value : NDArray
+           The input array, aligned and of the shape of the input
+        """
+        self._set_input_zero_copy(key, value)
+
+    def run(self, **input_dict):
+        """Run forward execution of the model
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        self._run()
+
+    def get_num_outputs(self):
+        """Get the number of outputs from the model
+
+        Returns
+        -------
+        count : int
+            The number of outputs.
+        """
+        return self._get_num_outputs()
+
+    def get_num_inputs(self):
+        """Get the number of inputs to the model
+
+        Returns
+        -------
+        count : int
+            The number of inputs.
+        """
+        return self._get_num_inputs()
+
+    def get_input(self, index, out=None):
+        """Get index-th input to out
+
+        Parameters
+        ----------
+        index : int or str
+            The input index or name
+
+        out : NDArray
+            The output array container
+        """
+        if out:
+            self._get_input(index).copyto(out)
+            return out
+        return self._get_input(index)
+
+    def get_output(self, index, out=None):
+        """Get index-th output to out
+
+        Parameters
+        ----------
+        index : int
+            The output index
+
+        out : NDArray
+            The output array container
+        """
+        if out:
+            self._get_output(index, out)
+            return out
+        return self._get_output(index)
+
+    def __getitem__(self, key):
+        """Get internal module function
+
+        Parameters
+        ----------
+        key : str
+            The key to the module.
+        """
+        return self.module[key]
+
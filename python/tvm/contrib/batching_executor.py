@@ -0,0 +1,90 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Dynamic batching of independent requests on graph executors built for several batch sizes."""
+import tvm._ffi
+from tvm.runtime import ndarray
+
+
+class BatchingExecutor(object):
+    """Collect independent requests of batch 1 within a deadline, and run them together on
+    the graph executor of the smallest built batch size holding them.
+
+    The batch is dimension 0 of every input and output of the graphs. The inputs of the
+    requests are copied into the rows of the batch, the rows past the last request are
+    padding, and the rows of the outputs are copied out to the requests. The scheduler runs
+    in the runtime, on a thread per instance, so it serves the requests of any frontend.
+
+    Parameters
+    ----------
+    libs : Dict[int, Union[GraphExecutorFactoryModule, tvm.runtime.Module]]
+        The graph executor factories, e.g. built by ``relay.build`` or loaded from exported
+        libraries, by batch size.
+
+    device : Device
+        The device of the executors.
+
+    deadline_ms : float
+        The longest time a request waits for its batch to fill, in milliseconds.
+
+    num_instances : int
+        The number of batches run at the same time. The instances of a batch size share
+        their params, see the ``create_shared`` function of the factories.
+    """
+
+    def __init__(self, libs, device, deadline_ms=1.0, num_instances=1):
+        args = [device, int(deadline_ms * 1000), num_instances]
+        for batch_size, lib in sorted(libs.items()):
+            args += [batch_size, getattr(lib, "module", lib)]
+        self.batch_sizes = sorted(libs)
+        self.module = tvm._ffi.get_global_func("tvm.batching_executor.create")(*args)
+        self._submit = self.module["submit"]
+        self._run = self.module["run"]
+
+    @staticmethod
+    def _inputs(inputs):
+        return {
+            k: v if isinstance(v, ndarray.NDArray) else ndarray.array(v) for k, v in inputs.items()
+        }
+
+    def submit(self, callback, **inputs):
+        """Queue a request.
+
+        Parameters
+        ----------
+        callback : Callable[[List[NDArray], str], None]
+            Called on a thread of the executor with the outputs of the request and "", or no
+            outputs and the error of its batch.
+
+        inputs : Dict[str, Union[NDArray, numpy.ndarray]]
+            The inputs of the request by name, of batch 1.
+        """
+        self._submit(self._inputs(inputs), lambda outputs, error: callback(list(outputs), error))
+
+    def run(self, **inputs):
+        """Run a request and wait for its outputs.
+
+        Parameters
+        ----------
+        inputs : Dict[str, Union[NDArray, numpy.ndarray]]
+            The inputs of the request by name, of batch 1.
+
+        Returns
+        -------
+        outputs : List[NDArray]
+            The outputs of the request, of batch 1.
+        """
+        return list(self._run(self._inputs(inputs)))
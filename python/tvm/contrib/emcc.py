@@ -21,7 +21,7 @@ from tvm._ffi.base import py_str
 from tvm._ffi.libinfo import find_lib_path
 
 
-def create_tvmjs_wasm(output, objects, options=None, cc="emcc"):
+def create_tvmjs_wasm(output, objects, options=None, cc="emcc", threads=False):
     """Create wasm that is supposed to run with the tvmjs.
 
     Parameters
@@ -37,6 +37,10 @@ def create_tvmjs_wasm(output, objects, options=None, cc="emcc"):
 
     cc : str, optional
         The compile string.
+
+    threads : bool, optional
+        Whether to link on a shared memory, for the worker pool of tvmjs. The runtime has to be
+        built with ``make WASM_THREADS=1``, and the kernels with ``-mattr=+atomics,+bulk-memory``.
     """
     cmd = [cc]
     cmd += ["-O3"]
@@ -46,6 +50,10 @@ def create_tvmjs_wasm(output, objects, options=None, cc="emcc"):
     cmd += ["-s", "ERROR_ON_UNDEFINED_SYMBOLS=0"]
     cmd += ["-s", "STANDALONE_WASM=1"]
     cmd += ["-s", "ALLOW_MEMORY_GROWTH=1"]
+    if threads:
+        cmd += ["-s", "SHARED_MEMORY=1", "-s", "MAXIMUM_MEMORY=2GB"]
+        cmd += ["-Wl,--export=__wasm_init_tls", "-Wl,--export=__tls_size"]
+        cmd += ["-Wl,--export=__tls_align"]
 
     objects = [objects] if isinstance(objects, str) else objects
 
@@ -193,6 +193,35 @@ class GraphModule(object):
                 if val:
                     self._get_input(k).copyfrom(params[k])
 
+    def set_inputs(self, inputs):
+        """Set several inputs in one call to the module
+
+        Parameters
+        ----------
+        inputs : dict of int or str to NDArray or numpy.ndarray
+           The input data of each input key
+        """
+        args = []
+        for key, value in inputs.items():
+            if not isinstance(value, tvm.runtime.NDArray):
+                value = tvm.nd.array(value)
+            args += [key, value]
+        self.module["set_inputs"](*args)
+
+    def set_input_staging(self, num_slots):
+        """Stage the inputs on other devices than the CPU in a ring of host buffers.
+
+        Setting such an input then only copies it to a host buffer, and the
+        next run copies the buffers to the devices asynchronously. The inputs
+        of the next frame can thus be set during :py:meth:`run_async`.
+
+        Parameters
+        ----------
+        num_slots : int
+            The number of host buffers of each input, 0 disables staging.
+        """
+        self.module["set_input_staging"](num_slots)
+
     def run(self, **input_dict):
         """Run forward execution of the graph
 
@@ -205,6 +234,128 @@ class GraphModule(object):
             self.set_input(**input_dict)
         self._run()
 
+    def run_async(self, **input_dict):
+        """Start the forward execution of the graph on a background thread.
+
+        The inputs and outputs must not be accessed until :py:meth:`wait` returns.
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        self.module["run_async"]()
+
+    def wait(self):
+        """Wait for the execution started by :py:meth:`run_async`."""
+        self.module["wait"]()
+
+    def set_num_workers(self, num_workers, num_intra_threads=0):
+        """Set the number of threads running the operators of the graph.
+
+        With more than one worker, the independent branches of the graph run
+        concurrently, while the operators of each accelerator run in order.
+        Each worker runs the parallel loops of its operators on its own
+        runtime thread pool; with more than one intra-op thread, set
+        TVM_BIND_THREADS=0 so that the pools are not pinned to the same cores.
+
+        Parameters
+        ----------
+        num_workers : int
+            The number of threads, 1 runs the operators one by one.
+
+        num_intra_threads : int, optional
+            The number of threads of each operator, 0 shares the cores
+            evenly between the workers.
+        """
+        self.module["set_num_workers"](num_workers, num_intra_threads)
+
+    def set_num_streams(self, num_streams):
+        """Set the number of streams the operators of each accelerator are issued on.
+
+        With more than one stream, the operators are assigned to the streams of
+        their device by their dependencies, and wait on the streams of the
+        operators they depend on, so that the independent branches of the graph
+        run concurrently on a CUDA GPU. The streams join the current stream at
+        the end of each run, which also works inside a CUDA graph capture.
+
+        Parameters
+        ----------
+        num_streams : int
+            The number of streams of each device, 1 issues the operators on
+            the current stream.
+        """
+        self.module["set_num_streams"](num_streams)
+
+    def capture(self):
+        """Run the graph once while capturing the work of its operators.
+
+        Later runs replay the captured work of the devices that support
+        capture, such as VTA, and run the other operators normally.
+        Calling it again discards the previous capture.
+        """
+        self.module["capture"]()
+
+    def set_capture_mode(self, enabled):
+        """Set whether the runs replay the captured work.
+
+        The first run in capture mode captures the work of the operators.
+        In capture mode the operators run one by one, whatever the number
+        of workers.
+
+        Parameters
+        ----------
+        enabled : bool
+            Whether to enable capture mode.
+        """
+        self.module["set_capture_mode"](enabled)
+
+    def set_thread_pool_partition(self, partition):
+        """Run the parallel operators on a thread pool partition.
+
+        A partition is a thread pool on its own cores, created by the global
+        function runtime.config_threadpool_partition(partition, num_threads,
+        first_core). The executors bound to it share its workers one run at a
+        time instead of each spinning up a pool on every core.
+
+        Parameters
+        ----------
+        partition : int
+            The partition, -1 for the thread pool of the running thread.
+        """
+        self.module["set_thread_pool_partition"](partition)
+
+    def set_profile_sampling(self, interval, capacity=1024):
+        """Time the operators of every interval-th run.
+
+        The sampled runs time each operator with the timer of its device,
+        running the operators one by one, while the other runs are left
+        untouched. The latencies of the last sampled runs are kept.
+
+        Parameters
+        ----------
+        interval : int
+            The number of runs between two sampled runs, 0 disables sampling.
+
+        capacity : int, optional
+            The number of sampled runs kept.
+        """
+        self.module["set_profile_sampling"](interval, capacity)
+
+    def get_profile_samples(self):
+        """Get the latencies of the operators in the kept sampled runs.
+
+        Returns
+        -------
+        samples : dict of str to numpy.ndarray
+            The latencies in nanoseconds of each operator by node name,
+            oldest first.
+        """
+        samples = self.module["get_profile_samples"]()
+        return {str(name): latencies.numpy() for name, latencies in samples.items()}
+
     def get_num_outputs(self):
         """Get the number of outputs from the graph
 
@@ -259,6 +410,24 @@ class GraphModule(object):
 
         return self._get_output(index)
 
+    def get_outputs(self, outs=None):
+        """Get all the outputs in one call to the module
+
+        Parameters
+        ----------
+        outs : list of NDArray, optional
+            The arrays to copy the outputs to.
+
+        Returns
+        -------
+        outs : list of NDArray
+            The outputs.
+        """
+        if outs is not None:
+            self.module["get_outputs"](*outs)
+            return outs
+        return list(self.module["get_outputs"]())
+
     def debug_get_output(self, node, out):
         """Run graph up to node and get the output to out
 
@@ -282,6 +451,20 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_from_file(self, file_name):
+        """Load parameters from a file, mapping it in memory.
+
+        The parameters saved by :py:func:`tvm.runtime.save_param_dict` with an
+        alignment of 128 bytes alias the mapped file when they live on the
+        CPU, the others are copied from the mapping.
+
+        Parameters
+        ----------
+        file_name : str
+            The path of the parameter file.
+        """
+        self.module["load_params_from_file"](file_name)
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphExecutor instance.
 
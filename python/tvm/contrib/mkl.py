@@ -105,7 +105,8 @@ def batch_matmul(lhs, rhs, transa=False, transb=False, iterative=False, **kwargs
     C: Tensor
         The result tensor.
     """
-    b = lhs.shape[0]
+    # A batch of 1 is broadcast
+    b = te.max(lhs.shape[0], rhs.shape[0])
     n = lhs.shape[2] if transa else lhs.shape[1]
     m = rhs.shape[1] if transb else rhs.shape[2]
     return te.extern(
@@ -124,3 +125,37 @@ def batch_matmul(lhs, rhs, transa=False, transb=False, iterative=False, **kwargs
         name="C",
         **kwargs,
     )
+
+
+def batch_matmul_u8s8s32(lhs, rhs, transa=False, transb=False, **kwargs):
+    """Create an extern op that compute batched integer matrix mult of A and rhs with mkl
+
+    Parameters
+    ----------
+    lhs: Tensor
+        The left uint8 matrix operand
+    rhs: Tensor
+        The right int8 matrix operand
+    transa: bool
+        Whether transpose lhs
+    transb: bool
+        Whether transpose rhs
+
+    Returns
+    -------
+    C: Tensor
+        The int32 result tensor.
+    """
+    # A batch of 1 is broadcast
+    b = te.max(lhs.shape[0], rhs.shape[0])
+    n = lhs.shape[2] if transa else lhs.shape[1]
+    m = rhs.shape[1] if transb else rhs.shape[2]
+    return te.extern(
+        (b, n, m),
+        [lhs, rhs],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.mkl.batch_matmul_u8s8s32", ins[0], ins[1], outs[0], transa, transb
+        ),
+        name="C",
+        **kwargs,
+    )
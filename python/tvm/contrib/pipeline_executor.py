@@ -0,0 +1,143 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Pipeline executor streaming micro-batches through stages on several devices."""
+import queue
+import threading
+
+import tvm
+from tvm import relay
+from tvm.contrib import graph_executor
+
+
+def build(mod, targets, params=None):
+    """Cut a module into stages of balanced cost and build every stage for its target.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module, whose main function is a statically shaped dataflow graph.
+
+    targets : List[Union[str, tvm.target.Target]]
+        The target of every stage, the number of targets is the number of stages.
+
+    params : Optional[Dict[str, NDArray]]
+        The parameters of the module, bound as constants of the stages using them.
+
+    Returns
+    -------
+    libs : List[tvm.runtime.Module]
+        The built stages, to be run by :py:class:`PipelineModule`.
+    """
+    if params:
+        mod = tvm.IRModule.from_expr(relay.build_module.bind_params_by_name(mod["main"], params))
+    stages = relay.transform.partition_pipeline(mod, len(targets))
+    return [relay.build(stage, target=target) for stage, target in zip(stages, targets)]
+
+
+class PipelineModule(object):
+    """Run the stages of a pipeline on their devices, each on its own thread, so that the
+    stages process consecutive micro-batches at the same time.
+
+    The outputs of every stage are copied to the device of the next stage. The stages on
+    CPU cores can be given their own thread pool partitions, see
+    :py:meth:`tvm.contrib.graph_executor.GraphModule.set_thread_pool_partition`.
+
+    Parameters
+    ----------
+    libs : List[tvm.runtime.Module]
+        The stages built by :py:func:`build`.
+
+    devices : List[Device]
+        The device of every stage.
+
+    thread_pool_partitions : Optional[List[int]]
+        The thread pool partition of every stage, -1 for the pool of its thread.
+    """
+
+    def __init__(self, libs, devices, thread_pool_partitions=None):
+        assert len(libs) == len(devices), "Every stage needs a device"
+        self.devices = devices
+        self.stages = [
+            graph_executor.GraphModule(lib["default"](dev)) for lib, dev in zip(libs, devices)
+        ]
+        if thread_pool_partitions is not None:
+            for stage, partition in zip(self.stages, thread_pool_partitions):
+                stage.set_thread_pool_partition(partition)
+        # The input names of every stage, in the order of the outputs of the previous stage.
+        self.input_names = [
+            [param.name_hint for param in lib.ir_mod["main"].params] for lib in libs
+        ]
+
+    def _run_stage(self, index, inputs, outputs, errors):
+        stage = self.stages[index]
+        last = index == len(self.stages) - 1
+        dev = tvm.cpu(0) if last else self.devices[index + 1]
+        while True:
+            item = inputs.get()
+            if item is None:
+                outputs.put(None)
+                return
+            batch, values = item
+            try:
+                stage.set_input(**values)
+                stage.run()
+                num_outputs = stage.get_num_outputs()
+                results = [stage.get_output(i).copyto(dev) for i in range(num_outputs)]
+            except Exception as err:  # pylint: disable=broad-except
+                errors.append(err)
+                results = []
+            if last:
+                outputs.put((batch, results))
+            else:
+                outputs.put((batch, dict(zip(self.input_names[index + 1], results))))
+
+    def run(self, batches):
+        """Stream micro-batches through the pipeline.
+
+        Parameters
+        ----------
+        batches : Iterable[Dict[str, Union[NDArray, numpy.ndarray]]]
+            The inputs of every micro-batch, by input name.
+
+        Returns
+        -------
+        outputs : List[List[NDArray]]
+            The outputs of every micro-batch on the CPU, in the order of the batches.
+        """
+        queues = [queue.Queue() for _ in range(len(self.stages) + 1)]
+        errors = []
+        threads = [
+            threading.Thread(target=self._run_stage, args=(i, queues[i], queues[i + 1], errors))
+            for i in range(len(self.stages))
+        ]
+        for thread in threads:
+            thread.start()
+        count = 0
+        for count, batch in enumerate(batches, 1):
+            queues[0].put((count - 1, batch))
+        queues[0].put(None)
+        results = [None] * count
+        while True:
+            item = queues[-1].get()
+            if item is None:
+                break
+            results[item[0]] = item[1]
+        for thread in threads:
+            thread.join()
+        if errors:
+            raise errors[0]
+        return results
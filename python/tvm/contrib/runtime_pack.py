@@ -0,0 +1,249 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Minimal all in one runtimes for the deployment of exported modules.
+
+A manifest records what an exported module needs from the runtime: the types of the
+modules of its import tree, which select the executors and the device APIs, the packed
+functions its host code calls by name, and whether it is a system library. ``generate``
+turns the manifests of the modules of an application into a runtime source like
+``apps/howto_deploy/tvm_runtime_pack.cc`` that only includes those parts of the runtime.
+
+The parts register themselves statically when their sources are included, so the parts
+left out are not in the binary. Compile the pack with ``-ffunction-sections
+-fdata-sections`` and link with ``-Wl,--gc-sections`` to drop the unused code of the
+included sources too.
+
+.. code-block:: bash
+
+    python3 -m tvm.contrib.runtime_pack -o tvm_runtime_pack.cc lib/*.manifest.json
+"""
+import argparse
+import json
+import os
+import re
+
+MANIFEST_VERSION = 1
+
+# The sources every runtime needs.
+CORE_SOURCES = [
+    "c_runtime_api.cc",
+    "container.cc",
+    "cpu_device_api.cc",
+    "file_utils.cc",
+    "library_module.cc",
+    "logging.cc",
+    "module.cc",
+    "ndarray.cc",
+    "object.cc",
+    "profiling.cc",
+    "registry.cc",
+    "thread_pool.cc",
+    "threading_backend.cc",
+    "workspace_pool.cc",
+]
+
+# The sources and the macros of the module types, the executors and the device modules.
+MODULE_SOURCES = {
+    "GraphExecutorFactory": (
+        ["graph_executor/graph_executor.cc", "graph_executor/graph_executor_factory.cc"],
+        [],
+    ),
+    "AotExecutorFactory": (
+        ["aot_executor/aot_executor.cc", "aot_executor/aot_executor_factory.cc"],
+        [],
+    ),
+    "VMExecutable": (
+        ["vm/bytecode.cc", "vm/executable.cc", "vm/memory_manager.cc", "vm/vm.cc"],
+        [],
+    ),
+    "metadata": (["metadata_module.cc"], []),
+    "stackvm": (["stackvm/stackvm.cc", "stackvm/stackvm_module.cc"], []),
+    "cuda": (["cuda/cuda_device_api.cc", "cuda/cuda_module.cc"], ["TVM_CUDA_RUNTIME"]),
+    "opencl": (["opencl/opencl_device_api.cc", "opencl/opencl_module.cc"], ["TVM_OPENCL_RUNTIME"]),
+    "metal": (["metal/metal_device_api.mm", "metal/metal_module.mm"], ["TVM_METAL_RUNTIME"]),
+    "vulkan": (["vulkan/vulkan.cc"], []),
+}
+
+# The host code modules, linked into the library rather than loaded by the runtime.
+HOST_MODULES = ("llvm", "c")
+
+# The sources of the packed functions outside of the core, by prefix of their names.
+PACKED_FUNC_SOURCES = {
+    "tvm.contrib.sort.": ["contrib/sort/sort.cc"],
+    "tvm.contrib.random.": ["contrib/random/random.cc"],
+}
+
+# The packed functions of the core, always available.
+CORE_PACKED_FUNC_PREFIXES = ("runtime.", "device_api.cpu", "__tvm_")
+
+
+def _referenced_packed_funcs(module, names):
+    """The registered packed functions the source of a host module mentions by name."""
+    try:
+        source = module.get_source("ll" if module.type_key == "llvm" else "")
+    except Exception:  # pylint: disable=broad-except
+        return set()
+    # Strings of the LLVM IR end with \00, the ones of the C sources are plain literals.
+    literals = set(re.findall(r'"([A-Za-z_][\w.]*?)(?:\\00)?"', source))
+    return literals & names
+
+
+def make_manifest(module):
+    """Make the manifest of the runtime an exported module needs.
+
+    Parameters
+    ----------
+    module : runtime.Module
+        The module to export.
+
+    Returns
+    -------
+    manifest : dict
+        The manifest, see ``write_manifest``.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm._ffi.registry import list_global_func_names
+
+    names = set(list_global_func_names())
+    modules = module._collect_from_import_tree(lambda _: True)
+    module_types = sorted({m.type_key for m in modules})
+    is_system_lib = False
+    packed_funcs = set()
+    for m in modules:
+        if m.type_key in HOST_MODULES:
+            if m.type_key == "llvm" and m.get_function("__tvm_is_system_module")():
+                is_system_lib = True
+            packed_funcs |= _referenced_packed_funcs(m, names)
+    return {
+        "version": MANIFEST_VERSION,
+        "system_lib": is_system_lib,
+        "modules": module_types,
+        "packed_funcs": sorted(packed_funcs),
+    }
+
+
+def write_manifest(module, path):
+    """Write the manifest of the runtime an exported module needs.
+
+    The manifest is a JSON object with the "modules" types of the import tree of the
+    module, the "packed_funcs" its host code references, and whether it is a
+    "system_lib".
+
+    Parameters
+    ----------
+    module : runtime.Module
+        The module to export.
+
+    path : str
+        The path of the manifest.
+    """
+    with open(path, "w") as f:
+        json.dump(make_manifest(module), f, indent=2)
+
+
+def _merge_manifests(manifests):
+    merged = {"system_lib": False, "dso": False, "modules": set(), "packed_funcs": set()}
+    for manifest in manifests:
+        if manifest.get("version") != MANIFEST_VERSION:
+            raise ValueError("Unsupported runtime manifest version %s" % manifest.get("version"))
+        if manifest["system_lib"]:
+            merged["system_lib"] = True
+        else:
+            merged["dso"] = True
+        merged["modules"] |= set(manifest["modules"])
+        merged["packed_funcs"] |= set(manifest["packed_funcs"])
+    return merged
+
+
+def generate(manifests, src_root=None):
+    """Generate the all in one runtime source of the manifests of an application.
+
+    Parameters
+    ----------
+    manifests : list of dict
+        The manifests of the modules the application deploys.
+
+    src_root : str, optional
+        The directory of the runtime sources the pack includes, src/runtime of the TVM
+        source tree of this package if not specified.
+
+    Returns
+    -------
+    source : str
+        The source of the runtime, only including the parts the modules need.
+    """
+    if src_root is None:
+        src_root = os.path.join(os.path.dirname(__file__), "..", "..", "..", "src", "runtime")
+    src_root = os.path.abspath(src_root)
+    merged = _merge_manifests(manifests)
+
+    sources = list(CORE_SOURCES)
+    sources += ["system_library.cc"] if merged["system_lib"] else []
+    sources += ["dso_library.cc"] if merged["dso"] else []
+    macros, unsupported = [], []
+    for module_type in sorted(merged["modules"]):
+        if module_type in HOST_MODULES:
+            continue
+        if module_type not in MODULE_SOURCES:
+            unsupported.append("module " + module_type)
+            continue
+        sources += MODULE_SOURCES[module_type][0]
+        macros += MODULE_SOURCES[module_type][1]
+    for name in sorted(merged["packed_funcs"]):
+        if name.startswith(CORE_PACKED_FUNC_PREFIXES):
+            continue
+        prefixes = [p for p in PACKED_FUNC_SOURCES if name.startswith(p)]
+        if not prefixes:
+            unsupported.append("packed function " + name)
+            continue
+        sources += PACKED_FUNC_SOURCES[prefixes[0]]
+
+    lines = [
+        "/*!",
+        " * \\brief The all in one TVM runtime of the deployed modules, generated by",
+        " *  tvm.contrib.runtime_pack from their manifests. Only includes the parts they use.",
+        " */",
+        "#define TVM_USE_LIBBACKTRACE 0",
+    ]
+    lines += ["#define %s 1" % macro for macro in sorted(set(macros))]
+    seen = set()
+    for source in sources:
+        if source not in seen:
+            seen.add(source)
+            lines.append('#include "%s"' % os.path.join(src_root, source))
+    for item in unsupported:
+        lines.append("// NOTE: the %s needs the full runtime, it is not in this pack" % item)
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    """Generate a runtime pack from the manifests of the command line."""
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("manifests", nargs="+", help="The manifests of the deployed modules.")
+    parser.add_argument("-o", "--output", required=True, help="The runtime source to write.")
+    parser.add_argument("--src-root", default=None, help="The runtime sources to include.")
+    args = parser.parse_args()
+    manifests = []
+    for path in args.manifests:
+        with open(path) as f:
+            manifests.append(json.load(f))
+    with open(args.output, "w") as f:
+        f.write(generate(manifests, args.src_root))
+
+
+if __name__ == "__main__":
+    main()
@@ -163,6 +163,7 @@ def lower(
     # config setup
     pass_ctx = PassContext.current()
     instrument_bound_checkers = bool(pass_ctx.config.get("tir.instrument_bound_checkers", False))
+    reduce_index_strength = bool(pass_ctx.config.get("tir.reduce_index_strength", False))
     disable_vectorize = bool(pass_ctx.config.get("tir.disable_vectorize", False))
     add_lower_pass = pass_ctx.config.get("tir.add_lower_pass", [])
 
@@ -222,6 +223,7 @@ def lower(
         tvm.tir.transform.VectorizeLoop(not disable_vectorize),
         tvm.tir.transform.InjectVirtualThread(),
         tvm.tir.transform.InjectDoubleBuffer(),
+        tvm.tir.transform.InjectAsyncCopy(),
         tvm.tir.transform.StorageRewrite(),
         tvm.tir.transform.UnrollLoop(),
     ]
@@ -235,6 +237,8 @@ def lower(
 
     pass_list += [tvm.tir.transform.RewriteUnsafeSelect()]
     pass_list += [tvm.tir.transform.HoistIfThenElse()]
+    if reduce_index_strength:
+        pass_list += [tvm.tir.transform.ReduceIndexStrength()]
     pass_list += lower_phase3
 
     # Instrument BoundCheckers
@@ -157,6 +157,60 @@ def save_json(node):
     return tvm.runtime._ffi_node_api.SaveJSON(node)
 
 
+def save_binary(node):
+    """Save tvm object in the binary format.
+
+    Unlike save_json, the tensors of the object are stored raw and aligned, so that
+    load_binary_file can map them from the file instead of decoding them.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    blob : bytearray
+        The saved blob.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
+def load_binary(blob):
+    """Load tvm object from a blob saved by save_binary.
+
+    Parameters
+    ----------
+    blob : bytearray
+        The blob.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(blob)
+
+
+def load_binary_file(path):
+    """Load tvm object from a file of a blob saved by save_binary.
+
+    The tensors alias a copy-on-write mapping of the file where possible, they are only
+    read on first use.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinaryFile(path)
+
+
 def structural_equal(lhs, rhs, map_free_vars=False):
     """Check structural equality of lhs and rhs.
 
@@ -277,3 +331,28 @@ def structural_hash(node, map_free_vars=False):
     structrual_equal
     """
     return tvm.runtime._ffi_node_api.StructuralHash(node, map_free_vars)
+
+
+class StructuralHashCache(object):
+    """A scope in which the structural hashes are memoized across the calls.
+
+    The IR nodes are immutable, so within the scope the hash of an object hashed
+    before, e.g. by the compile engine or the passes of a build, is reused instead of
+    being computed again. The hashes are the same as outside of the scope.
+
+    The hashed objects are kept alive until the scope exits.
+
+    Examples
+    --------
+    .. code-block:: python
+
+        with tvm.ir.StructuralHashCache():
+            lib = relay.build(mod, target)
+    """
+
+    def __enter__(self):
+        tvm.runtime._ffi_node_api.StructuralHashCacheEnter()
+        return self
+
+    def __exit__(self, ptype, value, trace):
+        tvm.runtime._ffi_node_api.StructuralHashCacheExit()
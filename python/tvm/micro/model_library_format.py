@@ -256,6 +256,9 @@ def export_model_library_format(mod: executor_factory.ExecutorFactoryModule, fil
         os.makedirs(graph_config_dir_path)
         with open(os.path.join(graph_config_dir_path, "graph.json"), "w") as f:
             f.write(mod.get_executor_config())
+        if mod.graph_binary is not None:
+            with open(os.path.join(graph_config_dir_path, "graph.bin"), "wb") as f:
+                f.write(mod.graph_binary)
 
     with tarfile.open(file_name, "w") as tar_f:
 
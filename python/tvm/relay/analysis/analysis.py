@@ -20,8 +20,11 @@
 This file contains the set of passes for Relay, which exposes an interface for
 configuring the passes and scripting them in Python.
 """
+import numpy as np
+
 from ...ir import IRModule
 from ...relay import transform, build_module
+from ...runtime import ndarray as _nd
 from ...runtime.ndarray import cpu
 
 from . import _ffi_api
@@ -402,6 +405,37 @@ def search_fc_transpose(expr):
     return ret
 
 
+def solve_layout_plan(node_costs, edges, edge_costs):
+    """Choose a candidate for every node of a graph, minimizing the total cost
+    of the chosen candidates plus the cost of the edges between them.
+
+    This is the global layout selection of the layout-sensitive operators: the
+    candidates of a node are its schedules, which decide its layouts, and the
+    cost of an edge is the layout transformation between its ends.
+
+    Parameters
+    ----------
+    node_costs : List[numpy.ndarray]
+        The cost of each candidate of each node.
+
+    edges : List[Tuple[int, int]]
+        The source and destination nodes of each edge.
+
+    edge_costs : List[numpy.ndarray]
+        The cost of each edge, indexed by the candidates of its source then of
+        its destination.
+
+    Returns
+    -------
+    choices : List[int]
+        The chosen candidate of each node.
+    """
+    node_costs = [_nd.array(np.asarray(cost, dtype="float64")) for cost in node_costs]
+    edge_costs = [_nd.array(np.asarray(cost, dtype="float64")) for cost in edge_costs]
+    edges = [[int(src), int(dst)] for src, dst in edges]
+    return [int(choice) for choice in _ffi_api.SolveLayoutPlan(node_costs, edges, edge_costs)]
+
+
 def get_calibration_data(mod, data):
     """Get the calibration data of a given relay graph
 
@@ -54,6 +54,32 @@ def _search_dense_op_weight(expr):
     return _ffi_api.search_dense_op_weight(expr)
 
 
+def sparse_dense_task_input_prefix(shape, sparse_weight):
+    """The prefix of the names of the auto-scheduler task inputs of a BSR weight
+
+    Parameters
+    ----------
+    shape : Tuple[int, int]
+        The dense shape of the weight
+    sparse_weight : scipy.sparse.bsr_matrix
+        The weight in BSR format
+
+    Returns
+    -------
+    ret : str
+        The prefix, to which W_data, W_indices and W_indptr are appended
+    """
+    block_size = sparse_weight.data.shape[1:]
+    return "sparse_dense_bsr_%d_%d_%d_%d_%d_%d_" % (
+        shape[0],
+        shape[1],
+        block_size[0],
+        block_size[1],
+        sparse_weight.indices.shape[0],
+        sparse_weight.indptr.shape[0],
+    )
+
+
 def process_params(expr, params, block_size, sparsity_threshold):
     """[summary]
 
@@ -63,8 +89,8 @@ def process_params(expr, params, block_size, sparsity_threshold):
         Expr of the network
     params : Dict[String, tvm.nd.array]
         parameters of the network
-    block_size : Tuple(int, int)
-        Blocksize in BSR matrix
+    block_size : Union[Tuple(int, int), Dict[String, Tuple(int, int)]]
+        Blocksize in BSR matrix, or the blocksize of every weight to convert by weight name
     sparsity_threshold : float
         Minimal sparsity requirement for converting to sparse operation
 
@@ -83,10 +109,16 @@ def process_params(expr, params, block_size, sparsity_threshold):
     weight_names = _search_dense_op_weight(expr)
     for name in weight_names:
         name = str(name)
+        if isinstance(block_size, dict):
+            if name not in block_size:
+                continue
+            weight_block_size = tuple(block_size[name])
+        else:
+            weight_block_size = block_size
         w_np = params[name].numpy()
         sparsity = 1.0 - (np.count_nonzero(w_np) / w_np.size)
         if sparsity >= sparsity_threshold:
-            sparse_weight = sp.bsr_matrix(w_np, blocksize=block_size)
+            sparse_weight = sp.bsr_matrix(w_np, blocksize=weight_block_size)
             # remove dense weight
             del params[name]
             memo.weight_name.append(name)
@@ -99,14 +131,7 @@ def process_params(expr, params, block_size, sparsity_threshold):
             params[name + ".indices"] = tvm.nd.array(sparse_weight.indices)
             params[name + ".indptr"] = tvm.nd.array(sparse_weight.indptr)
 
-            prefix = "sparse_dense_bsr_%d_%d_%d_%d_%d_%d_" % (
-                w_np.shape[0],
-                w_np.shape[1],
-                block_size[0],
-                block_size[1],
-                sparse_weight.indices.shape[0],
-                sparse_weight.indptr.shape[0],
-            )
+            prefix = sparse_dense_task_input_prefix(w_np.shape, sparse_weight)
             register_task_input_buffer(
                 "default",
                 prefix + "W_data",
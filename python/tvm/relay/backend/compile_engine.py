@@ -358,6 +358,26 @@ class CompileEngine(Object):
             msg += "--------------------------\n"
             raise RuntimeError(msg)
 
+    def lower_all(self, source_funcs, target=None):
+        """Lower several source_funcs at once, in parallel when the
+        relay.backend.parallel_lowering option of the current PassContext is set.
+
+        Parameters
+        ----------
+        source_funcs : List[Union[tvm.relay.Function, CCacheKey]]
+            The source relay functions.
+
+        target : tvm.Target
+            The target platform.
+
+        Returns
+        -------
+        cached_funcs: List[CachedFunc]
+            The results of lowering, in the order of the source functions.
+        """
+        keys = [_get_cache_key(source_func, target) for source_func in source_funcs]
+        return _backend._CompileEngineLowerAll(self, keys)
+
     def lower_shape_func(self, source_func, target=None):
         key = _get_cache_key(source_func, target)
         return _backend._CompileEngineLowerShapeFunc(self, key)
@@ -83,9 +83,14 @@ class AOTExecutorFactoryModule(ExecutorFactoryModule):
         The parameters of module
     function_metadata : Map of String to FunctionInfo
         This holds a map function names to their information
+    executor_info : Map of String to Object
+        The description of the entry function for the executor of the C++ runtime,
+        empty when the model runs on the CRT
     """
 
-    def __init__(self, ir_mod, target, libmod, libmod_name, params, function_metadata):
+    def __init__(
+        self, ir_mod, target, libmod, libmod_name, params, function_metadata, executor_info=None
+    ):
         self.ir_mod = ir_mod
         self.target = target
         self.lib = libmod
@@ -93,6 +98,26 @@ class AOTExecutorFactoryModule(ExecutorFactoryModule):
         self.params = params
         self.iter_cnt = 0
         self.function_metadata = function_metadata
+        self.module = None
+        if executor_info:
+            fcreate = get_global_func("tvm.aot_executor_factory.create")
+            param_names = [str(name) for name in executor_info["param_names"]]
+            args = [
+                int(executor_info["arena_size"]),
+                executor_info["input_names"],
+                param_names,
+                len(executor_info["outputs"]),
+            ]
+            # The inputs and outputs are described by arrays of their shapes and types.
+            for tensor_type in list(executor_info["inputs"]) + list(executor_info["outputs"]):
+                shape = [int(dim) for dim in tensor_type.shape]
+                args.append(ndarray.empty(shape, tensor_type.dtype))
+            args.extend(ndarray.array(params[name]) for name in param_names)
+            self.module = fcreate(libmod, libmod_name, *args)
+
+    def export_library(self, file_name, fcompile=None, addons=None, **kwargs):
+        assert self.module is not None, "Only the models of the C++ runtime can be exported"
+        return self.module.export_library(file_name, fcompile, addons, **kwargs)
 
     def get_params(self):
         return self.params
@@ -123,10 +148,20 @@ class GraphExecutorFactoryModule(ExecutorFactoryModule):
         The parameters of module
     function_metadata : Map of String to FunctionInfo
         This holds a map function names to their information
+    graph_binary : bytes, optional
+        The graph in the binary format of the CRT graph executor.
     """
 
     def __init__(
-        self, ir_mod, target, graph_json_str, libmod, libmod_name, params, function_metadata
+        self,
+        ir_mod,
+        target,
+        graph_json_str,
+        libmod,
+        libmod_name,
+        params,
+        function_metadata,
+        graph_binary=None,
     ):
         assert isinstance(graph_json_str, string_types)
         fcreate = get_global_func("tvm.graph_executor_factory.create")
@@ -139,6 +174,7 @@ class GraphExecutorFactoryModule(ExecutorFactoryModule):
         self.target = target
         self.module = fcreate(graph_json_str, libmod, libmod_name, *args)
         self.graph_json = graph_json_str
+        self.graph_binary = graph_binary
         self.lib = libmod
         self.libmod_name = libmod_name
         self.params = params
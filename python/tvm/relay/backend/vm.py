@@ -27,12 +27,13 @@ import tvm.runtime.ndarray as _nd
 import tvm.runtime.vm as vm_rt
 from tvm import autotvm
 from tvm.relay import expr as _expr
+from tvm.relay import transform
 from tvm.relay.backend.interpreter import Executor
 from tvm.target import Target
 from . import _vm
 
 
-def compile(mod, target=None, target_host=None, params=None):
+def compile(mod, target=None, target_host=None, params=None, specialized_shapes=None):
     """Compile the module to VM executable. A helper function for VMCompiler.
 
     Parameters
@@ -58,6 +59,11 @@ def compile(mod, target=None, target_host=None, params=None):
         Input parameters to the graph that do not change
         during inference time. Used for constant folding.
 
+    specialized_shapes : list of dict of str to tuple of int, optional
+        Hot shapes of the dynamically shaped inputs, by input name. The VM
+        dispatches to a statically compiled version of main when the inputs
+        have one of these shapes, and to the dynamic version otherwise.
+
     Returns
     -------
     exec : tvm.runtime.vm.Executable
@@ -66,6 +72,8 @@ def compile(mod, target=None, target_host=None, params=None):
     target, target_host = Target.check_and_update_host_consist(
         target, target_host, target_is_dict_key=False
     )
+    if specialized_shapes:
+        mod = transform.SpecializeShapes(specialized_shapes)(mod)
     compiler = VMCompiler()
     if params:
         compiler.set_params(params)
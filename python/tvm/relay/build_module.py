@@ -78,12 +78,14 @@ class BuildModule(object):
     def __init__(self):
         self.mod = _build_module._BuildModule()
         self._get_graph_json = self.mod["get_graph_json"]
+        self._get_graph_binary = self.mod["get_graph_binary"]
         self._get_module = self.mod["get_module"]
         self._build = self.mod["build"]
         self._optimize = self.mod["optimize"]
         self._set_params_func = self.mod["set_params"]
         self._get_params_func = self.mod["get_params"]
         self._get_function_metadata = self.mod["get_function_metadata"]
+        self._get_executor_info = self.mod["get_executor_info"]
 
     def build(self, mod, target=None, target_host=None, params=None, executor="graph"):
         """
@@ -197,6 +199,11 @@ class BuildModule(object):
         """Return the json file of the built program."""
         return self._get_graph_json()
 
+    def get_graph_binary(self):
+        """Return the binary graph of the built program, which the CRT graph executor reads in
+        place of the json."""
+        return bytes(self._get_graph_binary())
+
     def get_module(self):
         """Return the built module."""
         return self._get_module()
@@ -207,6 +214,12 @@ class BuildModule(object):
         each PrimFunc"""
         return self._get_function_metadata()
 
+    def get_executor_info(self):
+        """Return the description of the AOT entry function for the C++ runtime: the names
+        and types of its inputs, the types of its outputs, the names of its params in
+        argument order and the size of its arena. It is empty for the CRT."""
+        return self._get_executor_info()
+
     def get_params(self):
         """Return the updated weights."""
         params = self._get_params_func()
@@ -336,11 +349,24 @@ def build(ir_mod, target=None, target_host=None, params=None, mod_name="default"
 
         if executor == "aot":
             executor_factory = _executor_factory.AOTExecutorFactoryModule(
-                ir_mod, target, runtime_mod, mod_name, params, func_metadata
+                ir_mod,
+                target,
+                runtime_mod,
+                mod_name,
+                params,
+                func_metadata,
+                bld_mod.get_executor_info(),
             )
         elif executor == "graph":
             executor_factory = _executor_factory.GraphExecutorFactoryModule(
-                ir_mod, target, executor_config, runtime_mod, mod_name, params, func_metadata
+                ir_mod,
+                target,
+                executor_config,
+                runtime_mod,
+                mod_name,
+                params,
+                func_metadata,
+                graph_binary=bld_mod.get_graph_binary(),
             )
         else:
             assert False, "Executor " + executor + " not supported"
@@ -32,8 +32,9 @@ def convert(func, params, blocksize, sparsity_threshold):
         Expr will be optimized to sparse operation
     params : Dict[Srting, tvm.nd.array]
         Parameters of the Expr
-    blocksize : Tuple(int, int)
-        Blocksize for BSR matrix
+    blocksize : Union[Tuple(int, int), Dict[String, Tuple(int, int)]]
+        Blocksize for BSR matrix, or the blocksize of every weight to convert by weight name,
+        as selected by tvm.auto_scheduler.sparse.tune_block_sizes
     sparsity_threshold : float
         Minimal sparsity requirement for converting.
         If weight sparsity is lower than this threshold,
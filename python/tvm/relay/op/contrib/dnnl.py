@@ -32,8 +32,11 @@ it is supported. For example:
 - The other way is to implement the function by themselves to
 check the attributes of the op and decide if it should be offloaded to DNNL.
 """
+import numpy as np
+
 import tvm.ir
 from ...dataflow_pattern import wildcard, is_op
+from ...expr import Call
 from .register import register_pattern_table
 
 
@@ -80,9 +83,89 @@ def make_pattern(with_bias=True):
     return is_op("nn.relu")(conv_out)
 
 
+def make_post_op_pattern(op_name, with_bias=True, with_sum=False, with_relu=True):
+    """Create the pattern of a conv2d or dense with the post-ops DNNL fuses into it.
+
+    Parameters
+    ----------
+    op_name : str
+        The name of the op, "nn.conv2d" or "nn.dense".
+
+    with_bias : bool
+        Whether the op is followed by the add of a bias.
+
+    with_sum : bool
+        Whether the op is followed by the add of a tensor of its output shape, e.g. the shortcut
+        of a residual block.
+
+    with_relu : bool
+        Whether the output is followed by a relu.
+
+    Returns
+    -------
+    pattern : tuple(str, DFPattern, callable)
+        The name of the composite, its pattern, and the check of its match.
+    """
+    out = is_op(op_name)(wildcard(), wildcard())
+    # The ops the runtime walks down to the root op through the first arguments.
+    expected_ops = [op_name]
+    name = "dnnl." + op_name.split(".")[-1]
+    if with_bias:
+        out = is_op("add")(out, wildcard())
+        expected_ops.append("add")
+        name += "_bias"
+    if with_sum:
+        out = is_op("add")(out, wildcard())
+        expected_ops.append("add")
+        name += "_sum"
+    if with_relu:
+        out = is_op("nn.relu")(out)
+        expected_ops.append("nn.relu")
+        name += "_relu"
+
+    def _check(expr):
+        # Each op is the first argument of the next one, the add of a bias has a value per output
+        # channel, and the added tensor has the output shape.
+        calls = [expr]
+        for _ in expected_ops[1:]:
+            if not isinstance(calls[-1].args[0], Call):
+                return False
+            calls.append(calls[-1].args[0])
+        calls.reverse()
+        for call, expected in zip(calls, expected_ops):
+            if call.op.name != expected:
+                return False
+        out_shape = [int(dim) for dim in calls[0].checked_type.shape]
+        index = 1
+        if with_bias:
+            bias_shape = [int(dim) for dim in calls[index].args[1].checked_type.shape]
+            if int(np.prod(bias_shape)) != out_shape[1] or len(bias_shape) > len(out_shape):
+                return False
+            index += 1
+        if with_sum:
+            if [int(dim) for dim in calls[index].args[1].checked_type.shape] != out_shape:
+                return False
+        return True
+
+    return name, out, _check
+
+
 @register_pattern_table("dnnl")
 def pattern_table():
     conv2d_bias_relu_pat = ("dnnl.conv2d_bias_relu", make_pattern(with_bias=True))
     conv2d_relu_pat = ("dnnl.conv2d_relu", make_pattern(with_bias=False))
-    dnnl_patterns = [conv2d_bias_relu_pat, conv2d_relu_pat]
+    if not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True):
+        # The C source codegen only has the kernels of these fused ops
+        return [conv2d_bias_relu_pat, conv2d_relu_pat]
+    # The patterns with more post-ops first, so that they are preferred
+    dnnl_patterns = [
+        make_post_op_pattern("nn.conv2d", with_sum=True, with_relu=True),
+        make_post_op_pattern("nn.conv2d", with_sum=True, with_relu=False),
+        conv2d_bias_relu_pat,
+        conv2d_relu_pat,
+        make_post_op_pattern("nn.conv2d", with_relu=False),
+        make_post_op_pattern("nn.dense", with_relu=True),
+        make_post_op_pattern("nn.dense", with_bias=False, with_relu=True),
+        make_post_op_pattern("nn.dense", with_relu=False),
+    ]
     return dnnl_patterns
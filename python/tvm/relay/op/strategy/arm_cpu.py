@@ -19,9 +19,10 @@
 import re
 import logging
 
-from tvm import topi
+from tvm import tir, topi
 from ....target import arm_isa
 from .generic import *
+from .x86 import dense_strategy_cpu
 from .. import op as _op
 
 logger = logging.getLogger("strategy")
@@ -48,6 +49,17 @@ def schedule_concatenate_arm_cpu(_, outs, target):
         return topi.arm_cpu.schedule_concatenate(outs)
 
 
+@schedule_pool.register(["arm_cpu", "micro_dev"])
+def schedule_pool_arm_cpu(attrs, outs, target):
+    """schedule pooling ops arm cpu"""
+    isa = arm_isa.IsaAnalyzer(target)
+    if "SMLAD" in isa and attrs.layout == "NHWC":
+        with target:
+            return topi.arm_cpu.schedule_pool_direct_simd(outs, attrs.layout)
+    with target:
+        return topi.x86.schedule_pool(outs, attrs.layout)
+
+
 @conv2d_strategy.register(["arm_cpu", "micro_dev"])
 def conv2d_strategy_arm_cpu(attrs, inputs, out_type, target):
     """conv2d arm cpu strategy"""
@@ -397,6 +409,29 @@ def bitserial_conv2d_strategy_arm_cpu(attrs, inputs, out_type, target):
     return strategy
 
 
+@dense_strategy.register(["arm_cpu", "micro_dev"])
+def dense_strategy_arm_cpu(attrs, inputs, out_type, target):
+    """dense arm cpu strategy"""
+    strategy = dense_strategy_cpu(attrs, inputs, out_type, target)
+    data, weight = inputs
+    isa = arm_isa.IsaAnalyzer(target)
+    in_dim = data.shape[1]
+    if (
+        "SMLAD" in isa
+        and data.dtype == weight.dtype == "int8"
+        and out_type.dtype == "int32"
+        and all(isinstance(dim, tir.IntImm) for dim in list(data.shape) + list(weight.shape))
+        and in_dim.value % 4 == 0
+    ):
+        strategy.add_implementation(
+            wrap_compute_dense(topi.arm_cpu.dense_direct_simd),
+            wrap_topi_schedule(topi.arm_cpu.schedule_dense_direct_simd),
+            name="dense_direct_simd.arm_cpu",
+            plevel=20,
+        )
+    return strategy
+
+
 @bitserial_dense_strategy.register("arm_cpu")
 def schedule_bitserial_dense_arm_cpu(attrs, inputs, out_type, target):
     """bitserial_dense arm cpu strategy"""
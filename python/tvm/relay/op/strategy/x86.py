@@ -444,20 +444,25 @@ def batch_matmul_strategy_cpu(attrs, inputs, out_type, target):
             name="batch_matmul.x86",
             plevel=10,
         )
+    same_type = inputs[0].dtype == inputs[1].dtype == out_type.dtype
+    dtype = inputs[0].dtype
+    u8s8s32 = dtype == "uint8" and inputs[1].dtype == "int8" and out_type.dtype == "int32"
     if "cblas" in target.libs:
-        strategy.add_implementation(
-            wrap_compute_batch_matmul(topi.x86.batch_matmul_cblas),
-            wrap_topi_schedule(topi.x86.schedule_batch_matmul_cblas),
-            name="batch_matmul_cblas.x86",
-            plevel=15,
-        )
+        with SpecializedCondition(same_type and dtype in ["float32", "float64"]):
+            strategy.add_implementation(
+                wrap_compute_batch_matmul(topi.x86.batch_matmul_cblas),
+                wrap_topi_schedule(topi.x86.schedule_batch_matmul_cblas),
+                name="batch_matmul_cblas.x86",
+                plevel=15,
+            )
     if "mkl" in target.libs:
-        strategy.add_implementation(
-            wrap_compute_batch_matmul(topi.x86.batch_matmul_mkl),
-            wrap_topi_schedule(topi.x86.schedule_batch_matmul_mkl),
-            name="batch_matmul_mkl.x86",
-            plevel=15,
-        )
+        with SpecializedCondition(same_type and dtype in ["float32", "float64"] or u8s8s32):
+            strategy.add_implementation(
+                wrap_compute_batch_matmul(topi.x86.batch_matmul_mkl),
+                wrap_topi_schedule(topi.x86.schedule_batch_matmul_mkl),
+                name="batch_matmul_mkl.x86",
+                plevel=15,
+            )
     return strategy
 
 
@@ -135,10 +135,35 @@ def _percentile_scale(mod, dataset):
     return func
 
 
+def _channel_axes(func):
+    """Map the simulated quantize calls of conv and dense weights to their output channel axis"""
+    quantize_op = _op.get("relay.op.annotation.simulated_quantize")
+    conv_ops = [_op.get("nn.conv1d"), _op.get("nn.conv2d")]
+    dense_op = _op.get("nn.dense")
+    axes = {}
+
+    def visit_func(expr):
+        if not isinstance(expr, _expr.Call) or len(expr.args) < 2:
+            return
+        weight = expr.args[1]
+        if not isinstance(weight, _expr.Call) or weight.op != quantize_op:
+            return
+        if weight.attrs.kind != quantize.QAnnotateKind.WEIGHT:
+            return
+        if expr.op in conv_ops:
+            axes[weight] = expr.attrs.kernel_layout.index("O")
+        elif expr.op == dense_op:
+            axes[weight] = 0
+
+    _analysis.post_order_visit(func, visit_func)
+    return axes
+
+
 def _set_params(mod, input_scale_func, weight_scale_func):
     quantize_op = _op.get("relay.op.annotation.simulated_quantize")
     cfg = quantize.current_qconfig()
     const_params = {}
+    channel_axes = _channel_axes(mod["main"])
 
     def visit_func(expr):
         """visitor function for traverse"""
@@ -152,9 +177,15 @@ def _set_params(mod, input_scale_func, weight_scale_func):
             # set scale
             if kind == quantize.QAnnotateKind.WEIGHT:
                 assert isinstance(expr.args[0], _expr.Constant)
-                scale = weight_scale_func(expr)
+                if cfg.weight_scale.startswith("channel_") and expr in channel_axes:
+                    scale = _channel_scale(expr, channel_axes[expr], cfg.weight_scale)
+                else:
+                    scale = weight_scale_func(expr)
             else:
                 scale = input_scale_func(expr)
+                if cfg.calibrate_power2 and scale > 0:
+                    # keep the requantizations between activations as shifts
+                    scale = 2 ** np.math.ceil(np.math.log(scale, 2))
 
             def _make_const(val):
                 return _expr.const(val, "float32")
@@ -191,6 +222,20 @@ def _max_scale(sq_call):
     return val
 
 
+def _channel_scale(sq_call, axis, mode):
+    """calculate the weight scales of the output channels, broadcast to the weight"""
+    var = sq_call.args[0]
+    assert isinstance(var, _expr.Constant)
+    data = np.abs(var.data.numpy())
+    reduce_axes = tuple(i for i in range(data.ndim) if i != axis)
+    val = np.amax(data, axis=reduce_axes, keepdims=True)
+    if mode == "channel_power2":
+        val = np.where(val > 0, 2 ** np.ceil(np.log2(np.maximum(val, 1e-30))), 1.0)
+    else:
+        val = np.where(val > 0, val, 1.0)
+    return val.astype("float32")
+
+
 # input scale functions
 def _global_scale(sq_call):  # pylint: disable=unused-argument
     cfg = quantize.current_qconfig()
@@ -226,9 +271,10 @@ def calibrate(dataset=None):
         else:
             raise ValueError("Unknown calibrate mode {}".format(cfg.calibrate_mode))
 
-        if cfg.weight_scale == "max":
+        # the weights not used by a conv or dense fall back to per-tensor scales
+        if cfg.weight_scale in ("max", "channel_max"):
             weight_scale_func = _max_scale
-        elif cfg.weight_scale == "power2":
+        elif cfg.weight_scale in ("power2", "channel_power2"):
             weight_scale_func = _power2_scale
         else:
             raise ValueError("Unknown weight scale mode {}".format(cfg.weight_scale))
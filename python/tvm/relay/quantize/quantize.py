@@ -86,6 +86,7 @@ class QConfig(Object):
         "debug_enabled_ops": None,
         "rounding": "UPWARD",
         "calibrate_chunk_by": -1,
+        "calibrate_power2": False,
         "partition_conversions": "disabled",
     }
 
@@ -158,6 +159,10 @@ def qconfig(**kwargs):
         power2: Find the maximum of the absolute value of the tensor, and then round up to power
         of two.
         max: Find the maximum of the absolute value of the tensor
+        channel_power2: Like power2, for every output channel of the conv and dense weights.
+        The channel scales are unified with shifts after the conv or dense.
+        channel_max: Like max, for every output channel of the conv and dense weights.
+        The channel scales are unified with a fixed point multiplication per channel.
 
     skip_dense_layer: boolean
         Whether to skip all nn.dense layer type. By default are skipped.
@@ -180,6 +185,10 @@ def qconfig(**kwargs):
     rounding: "UPWARD" or "TONEAREST"
         Rounding direction for fixed point multiplications.
 
+    calibrate_power2: boolean
+        Whether to round the calibrated activation scales up to powers of two, so that
+        together with power2 weight scales all the requantizations are shifts, as VTA requires.
+
     partition_conversions: 'disabled', 'enabled', or 'fully_integral'
         If set to 'enabled' or 'fully_integral', partitions a quantized
         result into a module containing
@@ -196,6 +196,90 @@ def FastMath():
     return _ffi_api.FastMath()
 
 
+MIXED_PRECISION_ALLOW_OPS = [
+    "nn.conv1d",
+    "nn.conv2d",
+    "nn.conv3d",
+    "nn.conv1d_transpose",
+    "nn.conv2d_transpose",
+    "nn.conv3d_transpose",
+    "nn.dense",
+    "nn.batch_matmul",
+]
+
+MIXED_PRECISION_FOLLOW_OPS = [
+    "add",
+    "subtract",
+    "multiply",
+    "divide",
+    "maximum",
+    "minimum",
+    "negative",
+    "abs",
+    "clip",
+    "sigmoid",
+    "tanh",
+    "where",
+    "zeros_like",
+    "ones_like",
+    "copy",
+    "nn.relu",
+    "nn.leaky_relu",
+    "nn.prelu",
+    "nn.bias_add",
+    "nn.max_pool1d",
+    "nn.max_pool2d",
+    "nn.max_pool3d",
+    "nn.pad",
+    "nn.batch_flatten",
+    "reshape",
+    "squeeze",
+    "expand_dims",
+    "transpose",
+    "concatenate",
+    "strided_slice",
+    "take",
+    "tile",
+    "broadcast_to",
+    "layout_transform",
+]
+
+
+def ToMixedPrecision(mixed_precision_type="float16", allow_ops=None, follow_ops=None):
+    """Rewrite the float32 computations to float16 or bfloat16.
+
+    The allowed ops, by default the convolutions and the matrix products, run
+    in the mixed precision type and accumulate in float32. The following ops,
+    by default the elementwise and data movement ops, run in the mixed type
+    when one of their inputs is in the mixed type. The other ops, such as the
+    reductions and the normalizations, stay in float32. The casts between the
+    types are folded and shared, the casts of the constant weights are folded
+    by a later FoldConstant. The bfloat16 computations are lowered by
+    tir.transform.BF16Legalize.
+
+    Parameters
+    ----------
+    mixed_precision_type : str
+        The mixed precision type, "float16" or "bfloat16".
+
+    allow_ops : Optional[List[str]]
+        The names of the ops always converted.
+
+    follow_ops : Optional[List[str]]
+        The names of the ops converted when one of their inputs is converted.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass for the mixed precision rewrite.
+    """
+    if allow_ops is None:
+        allow_ops = MIXED_PRECISION_ALLOW_OPS
+    if follow_ops is None:
+        follow_ops = MIXED_PRECISION_FOLLOW_OPS
+    return _ffi_api.ToMixedPrecision(mixed_precision_type, allow_ops, follow_ops)
+
+
 def CanonicalizeOps():
     """Canonicalize special operators to basic operators.
     This can simplify followed analysis, e.g. expanding bias_add to
@@ -268,9 +352,31 @@ def FoldConstant():
     return _ffi_api.FoldConstant()
 
 
+def PrepackWeights():
+    """Evaluate the layout transforms and the other data movement calls, such as
+    reshape, transpose, pad or cast, over the constant weights. These are
+    inserted by AlterOpLayout for the blocked layouts of the selected schedules,
+    or by the graph packing of VTA. The weights are then exported packed in the
+    params of the built module, instead of being packed by the executor at every
+    run. It runs in relay.build at any opt_level, and warns when some weights are
+    not bound to constants. Arithmetic and broadcasts are left to FoldConstant.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass for weight prepacking.
+    """
+    return _ffi_api.PrepackWeights()
+
+
 def FuseOps(fuse_opt_level=-1):
     """Fuse operators in an expr to a larger operator according to some rules.
 
+    The fusions the operator patterns allow can be vetoed by a cost model:
+    the ``relay.FuseOps.cost_model`` pass config option names a global function
+    called with the producer and consumer calls and the number of nodes of the
+    fused group, which refuses the fusion by returning False.
+
     Parameters
     ----------
     fuse_opt_level : int
@@ -285,6 +391,47 @@ def FuseOps(fuse_opt_level=-1):
     return _ffi_api.FuseOps(fuse_opt_level)
 
 
+def Rematerialize(memory_budget=-1):
+    """Recompute the cheap elementwise and broadcast values at their late uses,
+    instead of keeping them alive across the peak memory of the graph executor,
+    until the peak memory meets a budget.
+
+    Parameters
+    ----------
+    memory_budget : int
+        The budget of the peak memory in bytes. -1 indicates that it will be read
+        from the ``relay.backend.memory_budget`` pass config option, 0 disables
+        the pass.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass for rematerialization.
+    """
+    return _ffi_api.Rematerialize(memory_budget)
+
+
+def HorizontalFuseOps(max_group=8):
+    """Pack the calls to independent fused functions of injective ops, such as
+    the elementwise ops of parallel branches, into calls to functions returning
+    the tuple of their results. It runs after FuseOps in relay.build when
+    enabled by opt_level 4 or as a required pass. On GPU, building with the
+    ``tir.merge_independent_kernels`` pass config option launches the kernels of
+    a packed function as a single kernel.
+
+    Parameters
+    ----------
+    max_group : int
+        The maximum number of calls packed together.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass for horizontal fusion.
+    """
+    return _ffi_api.HorizontalFuseOps(max_group)
+
+
 def DefuseOps():
     """The inverse operation of FuseOps. It transforms a fused program returned by FuseOps into the
     program before FuseOps. (i.e., x == DefuseOps(FuseOps(x)))
@@ -658,10 +805,13 @@ def ToGraphNormalForm():
 def EliminateCommonSubexpr(fskip=None):
     """Eliminate common subexpressions.
 
+    The tensor constants with equal data are merged too, across all the functions of the
+    module, as are the equal subexpressions of the constants.
+
     Parameters
     ----------
     fskip: Callable
-        The callback function that decides whether an expression should be
+        The callback function that decides whether a call or a tuple projection should be
         skipped.
 
     Returns
@@ -762,6 +912,28 @@ def DynamicToStatic():
     return _ffi_api.DynamicToStatic()
 
 
+def SpecializeShapes(shapes):
+    """Specialize the main function for concrete shapes of its dynamically
+    shaped inputs.
+
+    Every specialization is a copy of the body of main on statically shaped
+    inputs, which is selected when the inputs have these shapes at runtime. The
+    other shapes run the original, dynamic, body.
+
+    Parameters
+    ----------
+    shapes : List[Dict[str, Tuple[int]]]
+        The shapes of the inputs, by input name, of each specialization.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered pass that specializes the shapes.
+    """
+    shapes = [{name: list(shape) for name, shape in spec.items()} for spec in shapes]
+    return _ffi_api.SpecializeShapes(shapes)
+
+
 def Inline():
     """Perform inlining on the given Relay IR module. The global functions that
     are marked as `inline` should be always inlined. A cost model will be
@@ -858,6 +1030,31 @@ def Defunctionalization(func, mod):
     return _ffi_api.Defunctionalization(func, mod)
 
 
+def partition_pipeline(mod, num_stages):
+    """Cut the main function of a module into a chain of stages of balanced cost.
+
+    The calls are cut in topological order, the cost of a call being its number
+    of MACs, or the size of its output for the ops without MACs. Every stage takes
+    the tensors computed by the previous stages, or the inputs of main, that it or
+    the next stages use, and returns the ones the next stages use. The last stage
+    returns the result of main. See :py:mod:`tvm.contrib.pipeline_executor`.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The module, whose main function is a statically shaped dataflow graph of ops.
+
+    num_stages : int
+        The number of stages.
+
+    Returns
+    -------
+    stages : List[tvm.IRModule]
+        The stages, in order.
+    """
+    return list(_ffi_api.PartitionPipeline(mod, num_stages))
+
+
 def to_cps(func, mod=None):
     """
     Turn expression into CPS expression.
@@ -1171,3 +1368,18 @@ def AnnotateSpans():
         The regsistered AnnotateSpans pass.
     """
     return _ffi_api.AnnotateSpans()
+
+
+def CoalesceStorage():
+    """
+    Coalesce the storages of a static size allocated by ManifestAlloc into a few
+    regions. The tensors whose lifetimes do not overlap share their offsets, and
+    the storages of the iterations of the recursive functions are allocated once
+    by their callers.
+
+    Returns
+    -------
+    ret : tvm.transform.Pass
+        The registered CoalesceStorage pass.
+    """
+    return _ffi_api.CoalesceStorage()
@@ -243,7 +243,7 @@ class LocalSession(RPCSession):
 
 
 @tvm._ffi.register_func("rpc.PopenSession")
-def _popen_session(binary):
+def _popen_session(binary, shared_memory=False):
     temp = utils.tempdir()
 
     if isinstance(binary, (bytes, bytearray)):
@@ -259,8 +259,9 @@ def _popen_session(binary):
         if not os.access(path_exec, os.X_OK):
             raise RuntimeError(f"{path_exec} is not executable.")
 
-    sess = _ffi_api.CreatePipeClient(path_exec)
-    return sess
+    if shared_memory:
+        return _ffi_api.CreateShmClient(path_exec)
+    return _ffi_api.CreatePipeClient(path_exec)
 
 
 class PopenSession(RPCSession):
@@ -270,10 +271,14 @@ class PopenSession(RPCSession):
     ----------
     binary : List[Union[str, bytes]]
         The binary to be executed.
+
+    shared_memory : bool, optional
+        Exchange the messages through shared memory rings instead of pipes,
+        which avoids a system call per message and per 64KB of payload.
     """
 
-    def __init__(self, binary):
-        RPCSession.__init__(self, _popen_session(binary))
+    def __init__(self, binary, shared_memory=False):
+        RPCSession.__init__(self, _popen_session(binary, shared_memory))
 
 
 class TrackerSession(object):
@@ -443,7 +448,7 @@ class TrackerSession(object):
         )
 
 
-def connect(url, port, key="", session_timeout=0, session_constructor_args=None):
+def connect(url, port, key="", session_timeout=0, session_constructor_args=None, compress=None):
     """Connect to RPC Server
 
     Parameters
@@ -467,6 +472,11 @@ def connect(url, port, key="", session_timeout=0, session_constructor_args=None)
         The first element of the list is always a string specifying the name of
         the session constructor, the following args are the positional args to that function.
 
+    compress : str, optional
+        The codec used to compress the messages of the session, such as "lz4".
+        The session stays uncompressed when the server does not support it.
+        Defaults to the TVM_RPC_COMPRESSION environment variable.
+
     Returns
     -------
     sess : RPCSession
@@ -495,6 +505,8 @@ def connect(url, port, key="", session_timeout=0, session_constructor_args=None)
     try:
         if session_timeout:
             key += " -timeout=%s" % str(session_timeout)
+        if compress:
+            key += " -compress=%s" % compress
         session_constructor_args = session_constructor_args if session_constructor_args else []
         if not isinstance(session_constructor_args, (list, tuple)):
             raise TypeError("Expect the session constructor to be a list or tuple")
@@ -113,11 +113,14 @@ def _server_env(load_library, work_path=None):
     return temp
 
 
-def _serve_loop(sock, addr, load_library, work_path=None):
+def _serve_loop(sock, addr, load_library, work_path=None, compress=None):
     """Server loop"""
     sockfd = sock.fileno()
     temp = _server_env(load_library, work_path)
-    _ffi_api.ServerLoop(sockfd)
+    if compress:
+        _ffi_api.ServerLoop(sockfd, compress)
+    else:
+        _ffi_api.ServerLoop(sockfd)
     if not work_path:
         temp.remove()
     logger.info("Finish serving %s", addr)
@@ -129,9 +132,17 @@ def _parse_server_opt(opts):
     for kv in opts:
         if kv.startswith("-timeout="):
             ret["timeout"] = float(kv[9:])
+        elif kv.startswith("-compress="):
+            ret["compress"] = kv[10:]
     return ret
 
 
+def _compression_codecs():
+    """The compression codecs the RPC channels of this build support"""
+    codecs = tvm._ffi.get_global_func("rpc.CompressionCodecs", allow_missing=True)
+    return codecs().split(",") if codecs is not None and codecs() else []
+
+
 def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
     """Listening loop of the server."""
 
@@ -199,10 +210,16 @@ def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
                 conn.close()
                 logger.warning("mismatch key from %s", addr)
                 continue
+            opts = _parse_server_opt(arr[1:])
+            # agree to compress by echoing the option back
+            if opts.get("compress") in _compression_codecs():
+                server_key += " -compress=" + opts["compress"]
+            else:
+                opts.pop("compress", None)
             conn.sendall(struct.pack("<i", base.RPC_CODE_SUCCESS))
             conn.sendall(struct.pack("<i", len(server_key)))
             conn.sendall(server_key.encode("utf-8"))
-            return conn, addr, _parse_server_opt(arr[1:])
+            return conn, addr, opts
 
     # Server logic
     tracker_conn = None
@@ -235,7 +252,8 @@ def _listen_loop(sock, port, rpc_key, tracker_addr, load_library, custom_addr):
         work_path = utils.tempdir()
         logger.info("connection from %s", addr)
         server_proc = multiprocessing.Process(
-            target=_serve_loop, args=(conn, addr, load_library, work_path)
+            target=_serve_loop,
+            args=(conn, addr, load_library, work_path, opts.get("compress")),
         )
 
         server_proc.start()
@@ -365,9 +383,13 @@ def _popen_start_rpc_server(
     custom_addr=None,
     silent=False,
     no_fork=False,
+    server_init_callback=None,
 ):
     if no_fork:
         multiprocessing.set_start_method("spawn")
+
+    if server_init_callback:
+        server_init_callback()
     # This is a function that will be sent to the
     # Popen worker to run on a separate process.
     # Create and start the server in a different thread
@@ -420,6 +442,12 @@ class Server(object):
 
     no_fork: bool, optional
         Whether forbid fork in multiprocessing.
+
+    server_init_callback: Callable, optional
+        Additional initialization function run in the server process before it
+        accepts connections, e.g. to register the functions of the sessions.
+        Unless no_fork is set, the sessions are forked from the server process
+        and inherit its state.
     """
 
     def __init__(
@@ -434,6 +462,7 @@ class Server(object):
         custom_addr=None,
         silent=False,
         no_fork=False,
+        server_init_callback=None,
     ):
         try:
             if _ffi_api.ServerLoop is None:
@@ -455,6 +484,7 @@ class Server(object):
                 custom_addr,
                 silent,
                 no_fork,
+                server_init_callback,
             ],
         )
         # receive the port
@@ -19,6 +19,7 @@
 """Runtime Module namespace."""
 import os
 import ctypes
+import math
 import struct
 from collections import namedtuple
 
@@ -30,8 +31,84 @@ from .packed_func import PackedFunc, PackedFuncHandle, _set_class_module
 from . import _ffi_api
 
 
-# profile result of time evaluator
-ProfileResult = namedtuple("ProfileResult", ["mean", "results"])
+class ProfileResult(namedtuple("ProfileResult", ["mean", "results"])):
+    """The profile result of a time evaluator.
+
+    Parameters
+    ----------
+    mean : float
+        The mean cost in seconds, of the results that are not outliers when they are rejected.
+
+    results : Tuple[float]
+        The cost in seconds of each repeat.
+    """
+
+    __slots__ = ()
+
+    @property
+    def median(self):
+        """The median of the results."""
+        return self.percentile(50)
+
+    @property
+    def std(self):
+        """The sample standard deviation of the results."""
+        n = len(self.results)
+        if n < 2:
+            return 0.0
+        mean = sum(self.results) / n
+        return math.sqrt(sum((x - mean) ** 2 for x in self.results) / (n - 1))
+
+    def percentile(self, q):
+        """The q-th percentile of the results, interpolated between the closest ranks.
+
+        Parameters
+        ----------
+        q : float
+            The percentile, in [0, 100].
+
+        Returns
+        -------
+        cost : float
+            The percentile of the results in seconds.
+        """
+        ordered = sorted(self.results)
+        rank = (len(ordered) - 1) * q / 100.0
+        low = int(math.floor(rank))
+        high = min(low + 1, len(ordered) - 1)
+        return ordered[low] + (ordered[high] - ordered[low]) * (rank - low)
+
+    def confidence_interval(self, confidence=0.95):
+        """The confidence interval of the mean of the results, in the normal approximation.
+
+        Parameters
+        ----------
+        confidence : float
+            The confidence level, 0.9, 0.95 or 0.99.
+
+        Returns
+        -------
+        interval : Tuple[float, float]
+            The bounds of the interval in seconds.
+        """
+        z_scores = {0.9: 1.6449, 0.95: 1.9600, 0.99: 2.5758}
+        if confidence not in z_scores:
+            raise ValueError("Unsupported confidence level %s" % confidence)
+        n = len(self.results)
+        mean = sum(self.results) / n
+        half_width = z_scores[confidence] * self.std / math.sqrt(n)
+        return (mean - half_width, mean + half_width)
+
+
+def _reject_outliers(results, threshold=3.0):
+    """The results within threshold robust standard deviations of the median, its median
+    absolute deviation scaled to the standard deviation of a normal distribution."""
+    ordered = sorted(results)
+    median = ProfileResult(0, ordered).median
+    mad = ProfileResult(0, [abs(x - median) for x in ordered]).median * 1.4826
+    if mad == 0:
+        return list(results)
+    return [x for x in results if abs(x - median) <= threshold * mad]
 
 
 class Module(object):
@@ -169,7 +246,20 @@ class Module(object):
         """
         _ffi_api.ModuleSaveToFile(self, file_name, fmt)
 
-    def time_evaluator(self, func_name, dev, number=10, repeat=1, min_repeat_ms=0, f_preproc=""):
+    def time_evaluator(
+        self,
+        func_name,
+        dev,
+        number=10,
+        repeat=1,
+        min_repeat_ms=0,
+        f_preproc="",
+        max_repeat=0,
+        cv_threshold=0.05,
+        cache_flush_bytes=0,
+        check_cpu_frequency=False,
+        reject_outliers=False,
+    ):
         """Get an evaluator that measures time cost of running function.
 
         Parameters
@@ -201,6 +291,27 @@ class Module(object):
         f_preproc: str, optional
             The preprocess function name we want to execute before executing the time evaluator.
 
+        max_repeat: int, optional
+            The most repeats to wait for the steady state, e.g. of a board that heats up. When it
+            is larger than `repeat`, the measurement goes on until the coefficient of variation
+            of the last `repeat` costs is at most `cv_threshold`, and only those are returned.
+
+        cv_threshold: float, optional
+            The coefficient of variation, the standard deviation relative to the mean, of the
+            costs of the steady state.
+
+        cache_flush_bytes: int, optional
+            The size of a buffer swept before each repeat to flush the caches of any CPU, e.g.
+            a few times the size of the last level cache. 0 does not flush.
+
+        check_cpu_frequency: bool, optional
+            Whether to warn when the speed of the CPU changed during the measurement, e.g.
+            from frequency scaling or thermal throttling.
+
+        reject_outliers: bool, optional
+            Whether the mean leaves out the costs more than 3 robust standard deviations away
+            from the median, e.g. the repeats preempted by other processes.
+
         Note
         ----
         The function will be invoked  (1 + number x repeat) times,
@@ -213,6 +324,10 @@ class Module(object):
             The ProfileResult reports `repeat` time costs in seconds.
         """
         try:
+            options = []
+            # Only pass the options when they are set, for the remotes of the previous versions.
+            if max_repeat > repeat or cache_flush_bytes > 0 or check_cpu_frequency:
+                options = [max_repeat, cv_threshold, cache_flush_bytes, int(check_cpu_frequency)]
             feval = _ffi_api.RPCTimeEvaluator(
                 self,
                 func_name,
@@ -222,6 +337,7 @@ class Module(object):
                 repeat,
                 min_repeat_ms,
                 f_preproc,
+                *options,
             )
 
             def evaluator(*args):
@@ -230,7 +346,8 @@ class Module(object):
                 blob = feval(*args)
                 fmt = "@" + ("d" * repeat)
                 results = struct.unpack(fmt, blob)
-                mean = sum(results) / float(repeat)
+                kept = _reject_outliers(results) if reject_outliers else results
+                mean = sum(kept) / float(len(kept))
                 return ProfileResult(mean=mean, results=results)
 
             return evaluator
@@ -269,7 +386,15 @@ class Module(object):
         is_dso_exportable = lambda m: (m.type_key == "llvm" or m.type_key == "c")
         return self._collect_from_import_tree(is_dso_exportable)
 
-    def export_library(self, file_name, fcompile=None, addons=None, workspace_dir=None, **kwargs):
+    def export_library(
+        self,
+        file_name,
+        fcompile=None,
+        addons=None,
+        workspace_dir=None,
+        runtime_manifest=None,
+        **kwargs,
+    ):
         """
         Export the module and all imported modules into a single device library.
 
@@ -301,6 +426,10 @@ class Module(object):
             artifacts when exporting the module.
             If this is not provided a temporary dir will be created.
 
+        runtime_manifest : str, optional
+            The path of a manifest of the parts of the runtime the module needs, from which
+            tvm.contrib.runtime_pack generates a minimal runtime for its deployment.
+
         kwargs : dict, optional
             Additional arguments passed to fcompile
 
@@ -321,6 +450,11 @@ class Module(object):
         if isinstance(file_name, Path):
             file_name = str(file_name)
 
+        if runtime_manifest is not None:
+            from tvm.contrib import runtime_pack as _runtime_pack
+
+            _runtime_pack.write_manifest(self, str(runtime_manifest))
+
         if self.type_key == "stackvm":
             if not file_name.endswith(".stackvm"):
                 raise ValueError(
@@ -477,6 +611,31 @@ def load_module(path, fmt=""):
     return _ffi_api.ModuleLoadFromFile(path, fmt)
 
 
+def load_module_from_bytes(data, fmt="so"):
+    """Load module from the bytes of a file in memory.
+
+    Parameters
+    ----------
+    data : bytes or bytearray
+        The content of the file, e.g. of a shared library made by export_library.
+
+    fmt : str, optional
+        The format of the file.
+
+    Returns
+    -------
+    module : runtime.Module
+        The loaded module
+
+    Note
+    ----
+    Shared libraries are loaded without writing them to the filesystem where the
+    platform supports it, and each load is a fresh copy of the library, so that a
+    new version of a module can be loaded while the old one is in use.
+    """
+    return _ffi_api.ModuleLoadFromBytes(bytearray(data), fmt)
+
+
 def enabled(target):
     """Whether module runtime is enabled for target
 
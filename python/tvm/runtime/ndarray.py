@@ -225,6 +225,31 @@ class NDArray(NDArrayBase):
             return np_arr_ret.reshape(shape)
         return np_arr
 
+    def slice(self, axis, begin, end):
+        """Create a view of a range of the array along an axis, without a copy.
+
+        The view has strides unless it is compact, e.g. a range of rows. Copies
+        to and from it, :py:func:`numpy` included, handle the strides, and graph
+        and AOT executors take compact views as zero copy inputs.
+
+        Parameters
+        ----------
+        axis : int
+            The axis.
+
+        begin : int
+            The first index of the range.
+
+        end : int
+            The index past the last one of the range.
+
+        Returns
+        -------
+        view : NDArray
+            The view, which keeps the array alive.
+        """
+        return _ffi_api.NDArraySlice(self, axis, begin, end)
+
     def copyto(self, target):
         """Copy array to target
 
@@ -331,6 +356,26 @@ def empty(shape, dtype="float32", device=device(1, 0), mem_scope=None):
     return arr
 
 
+def set_pool(dev, enable=True):
+    """Cache the memory of the arrays allocated on a device for later arrays.
+
+    The arrays of the device, including the temporaries of the graph executor
+    and of the python code, are then allocated from the pooled allocator of the
+    device, which the VM shares. See :py:func:`tvm.runtime.vm.set_memory_pool_limit`
+    to limit the cached memory and :py:func:`tvm.runtime.profiling.memory_pool_stats`
+    for its statistics.
+
+    Parameters
+    ----------
+    dev : Device
+        The device.
+
+    enable : bool
+        Whether to pool the allocations of the device.
+    """
+    _ffi_api.SetNDArrayPool(dev, enable)
+
+
 def from_dlpack(dltensor):
     """Produces an array from an object with __dlpack__ method or a DLPack tensor w/o memory copy.
     Retreives the underlying DLPack tensor's pointer to create an array from the
@@ -19,7 +19,7 @@
 from . import _ffi_api, ndarray
 
 
-def save_param_dict(params):
+def save_param_dict(params, alignment=0):
     """Save parameter dictionary to binary bytes.
 
     The result binary bytes can be loaded by the
@@ -30,6 +30,13 @@ def save_param_dict(params):
     params : dict of str to NDArray
         The parameter dictionary.
 
+    alignment : int, optional
+        If not 0, the data of each parameter is aligned to this many bytes
+        from the beginning of the result, so that a file holding the bytes can
+        be loaded without copies by the GraphModule with API
+        "load_params_from_file". Runtimes predating the alignment support
+        cannot load aligned parameters.
+
     Returns
     -------
     param_bytes: bytearray
@@ -48,7 +55,7 @@ def save_param_dict(params):
        tvm.runtime.load_param_dict(param_bytes)
     """
     transformed = {k: ndarray.array(v) for (k, v) in params.items()}
-    return _ffi_api.SaveParams(transformed)
+    return _ffi_api.SaveParams(transformed, alignment)
 
 
 def load_param_dict(param_bytes):
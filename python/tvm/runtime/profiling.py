@@ -46,3 +46,41 @@ class Report(Object):
             `calls` in CSV format.
         """
         return AsCSV(self)
+
+
+@_ffi.register_object("runtime.profiling.Count")
+class Count(Object):
+    """A count of something, such as a number of bytes or calls."""
+
+    @property
+    def value(self):
+        """The count as an integer."""
+        return CountValue(self)
+
+
+@_ffi.register_object("runtime.profiling.Ratio")
+class Ratio(Object):
+    """A derived rate of a call, such as its GFLOP/s or GB/s."""
+
+    @property
+    def value(self):
+        """The ratio as a float."""
+        return RatioValue(self)
+
+
+def memory_pool_stats(dev):
+    """Get the statistics of the pooled memory allocator of a device.
+
+    Parameters
+    ----------
+    dev : Device
+        The device, whose allocator must have been created by a VM or by
+        :py:func:`tvm.runtime.ndarray.set_pool`.
+
+    Returns
+    -------
+    stats : dict of str to int
+        The memory used, cached and at peak by the allocator, its limit, and
+        the numbers of cache hits and misses and of trimmed buffers.
+    """
+    return {str(k): v.value for k, v in MemoryPoolStats(dev).items()}
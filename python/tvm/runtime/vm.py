@@ -72,6 +72,7 @@ class Executable(object):
         self._get_stats = self.mod["get_stats"]
         self._get_function_arity = self.mod["get_function_arity"]
         self._get_function_param_name = self.mod["get_function_param_name"]
+        self._prefetch_constants = self.mod["prefetch_constants"]
 
     def save(self):
         """Save the Relay VM Executable.
@@ -172,6 +173,14 @@ class Executable(object):
 
         return Executable(_ffi_api.Load_Executable(bytecode, lib))
 
+    def prefetch_constants(self):
+        """Load the constants of a deserialized executable in a background thread.
+
+        The constants of an executable constructed by load_exec are otherwise
+        loaded on their first use.
+        """
+        self._prefetch_constants()
+
     @property
     def lib(self):
         """Get the library that contains hardware dependent code.
@@ -277,6 +286,24 @@ class Executable(object):
         return params
 
 
+def set_memory_pool_limit(dev, limit_bytes):
+    """Limit the memory held by the pooled allocator of a device.
+
+    Above the limit, the allocator releases the cached buffers that were
+    freed least recently.
+
+    Parameters
+    ----------
+    dev : Device
+        The device, whose allocator must have been created by a VM or by
+        :py:func:`tvm.runtime.ndarray.set_pool`.
+
+    limit_bytes : int
+        The limit in bytes, 0 for no limit.
+    """
+    _ffi_api.SetMemoryPoolLimit(dev, limit_bytes)
+
+
 class VirtualMachine(object):
     """Relay VM runtime.
 
@@ -398,6 +425,9 @@ class VirtualMachine(object):
         kwargs: dict of str to tvm.runtime.NDArray or np.ndarray
             Named arguments to the function.
         """
+        self._set_input(func_name, *self._convert_args(func_name, args, kwargs))
+
+    def _convert_args(self, func_name, args, kwargs):
         if kwargs:
             # kwargs is a super set of the required function parameters. We
             # only find the ones that are needed.
@@ -416,8 +446,53 @@ class VirtualMachine(object):
                     new_args[i] = args[idx]
                     idx += 1
             args = new_args
-        cargs = convert(args)
-        self._set_input(func_name, *cargs)
+        return convert(args)
+
+    def set_shape_buckets(self, func_name, buckets, inputs=None, axis=1):
+        """Pad a dimension of the inputs of a function to a fixed set of sizes.
+
+        Each input is padded with zeros along the axis up to the smallest
+        bucket that fits it, so that a dynamic dimension such as the
+        sequence length only takes a few sizes. The storage of every bucket
+        is then recycled by the pooled allocator across invocations. The
+        outputs keep the padded sizes, inputs larger than every bucket are
+        not padded.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        buckets : list of int
+            The sizes of the axis, empty to stop padding the inputs.
+
+        inputs : list of str or int, optional
+            The names or indices of the padded inputs, all of them by default.
+
+        axis : int, optional
+            The padded axis.
+        """
+        func_params = self._exec.get_function_params(func_name)
+        if inputs is None:
+            inputs = range(len(func_params))
+        for inp in inputs:
+            index = func_params.index(inp) if isinstance(inp, str) else inp
+            self.module["set_shape_buckets"](func_name, index, axis, *buckets)
+
+    def set_thread_pool_partition(self, partition):
+        """Run the parallel operators on a thread pool partition.
+
+        A partition is a thread pool on its own cores, created by the global
+        function runtime.config_threadpool_partition(partition, num_threads,
+        first_core). The virtual machines bound to it share its workers one
+        invocation at a time.
+
+        Parameters
+        ----------
+        partition : int
+            The partition, -1 for the thread pool of the invoking thread.
+        """
+        self.module["set_thread_pool_partition"](partition)
 
     def invoke(self, func_name, *args, **kwargs):
         """Invoke a function.
@@ -442,6 +517,34 @@ class VirtualMachine(object):
             self.set_input(func_name, *args, **kwargs)
         return self._invoke(func_name)
 
+    def invoke_concurrent(self, func_name, *args, **kwargs):
+        """Invoke a function, concurrently with the other calls of this method.
+
+        Unlike :py:meth:`invoke`, the inputs are passed to the call only,
+        and each call runs with its own frames and registers, so that one
+        VM serves the calls of many threads. The calls share the constants
+        of the executable, loaded to their devices once.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        args : list[tvm.runtime.NDArray] or list[np.ndarray]
+            The arguments to the function.
+
+        kwargs: dict of str to tvm.runtime.NDArray or np.ndarray
+            Named arguments to the function.
+
+        Returns
+        -------
+        result : Object
+            The output.
+        """
+        return self.module["invoke_concurrent"](
+            func_name, *self._convert_args(func_name, args, kwargs)
+        )
+
     def run(self, *args, **kwargs):
         """Run the main function.
 
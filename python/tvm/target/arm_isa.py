@@ -19,15 +19,37 @@
 
 ARM_ISA_MAP = {
     "armv7e-m": ["SMLAD"],
+    "armv8-m.main": ["SMLAD"],
+    "armv8.1-m.main": ["SMLAD"],
+}
+
+# The architecture of the cores with the DSP extension, for targets giving only -mcpu
+ARM_MCPU_ARCH = {
+    "cortex-m4": "armv7e-m",
+    "cortex-m7": "armv7e-m",
+    "cortex-m33": "armv8-m.main",
+    "cortex-m35p": "armv8-m.main",
+    "cortex-m55": "armv8.1-m.main",
 }
 
 
 class IsaAnalyzer(object):
+    """Checks the instructions available on the target, from its -march or -mcpu.
+
+    Parameters
+    ----------
+    target : tvm.target.Target
+        The target to analyze.
+    """
+
     def __init__(self, target):
         self.target = target
-        # TODO: actually parse -mcpu
-        arch = "armv7e-m"
-        self._isa_map = ARM_ISA_MAP[arch]
+        arch = str(target.attrs["march"]) if "march" in target.attrs else ""
+        if arch not in ARM_ISA_MAP:
+            mcpu = str(target.attrs["mcpu"]) if "mcpu" in target.attrs else ""
+            # -mcpu=cortex-m7+nofp and friends only drop the floating point unit
+            arch = ARM_MCPU_ARCH.get(mcpu.split("+")[0], arch)
+        self._isa_map = ARM_ISA_MAP.get(arch, [])
 
     def __contains__(self, instruction):
         return instruction in self._isa_map
@@ -502,14 +502,21 @@ class Stage(Object):
         """
         _ffi_api.StageStorageAlign(self, axis, factor, offset)
 
-    def double_buffer(self):
+    def double_buffer(self, num_stages=2):
         """Compute the current stage via double buffering.
 
         This can only be applied to intermediate stage.
         This will double the storage cost of the current stage.
         Can be useful to hide load latency.
+
+        Parameters
+        ----------
+        num_stages : int
+            The number of buffers. With more than 2, the loop runs as a software
+            pipeline prefetching num_stages - 1 iterations ahead, at num_stages times
+            the storage cost.
         """
-        _ffi_api.StageDoubleBuffer(self)
+        _ffi_api.StageDoubleBuffer(self, num_stages)
 
 
 @tvm._ffi.register_object
@@ -151,6 +151,18 @@ def LoopPartition():
     return _ffi_api.LoopPartition()
 
 
+def ReduceIndexStrength():
+    """Hoist the loop invariant part of the affine indices out of the loops,
+    and strength reduce the rest to an index register bumped at each iteration.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.ReduceIndexStrength()
+
+
 def VectorizeLoop(enable_vectorize=True):
     """Lower vectorization loops.
 
@@ -190,6 +202,18 @@ def InjectDoubleBuffer():
     return _ffi_api.InjectDoubleBuffer()
 
 
+def InjectAsyncCopy():
+    """Replace the copies of global memory into shared buffers in the scope of an
+    async_copy pragma with asynchronous copies, which land at the end of the scope.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.InjectAsyncCopy()
+
+
 def StorageRewrite():
     """Rewrite storage allocation pattern.
 
@@ -358,6 +382,18 @@ def SplitHostDevice():
     return _ffi_api.SplitHostDevice()
 
 
+def MergeIndependentKernels():
+    """Merge consecutive kernels over blockIdx.x and threadIdx.x that access
+    disjoint buffers into one launch dispatching on the block index.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.MergeIndependentKernels()
+
+
 def DecorateDeviceScope():
     """Decorate all the function's body as device function.
 
@@ -492,7 +528,9 @@ def NarrowDataType(target_bits):
 
     Note
     ----
-    Run this pass after StorageFlatten.
+    Run this pass after StorageFlatten. With the ``min_bits`` of the
+    ``"tir.NarrowDataType"`` pass config, e.g. 8, the indices proven to fit
+    into a narrower datatype are narrowed down to it.
     """
     return _ffi_api.NarrowDataType(target_bits)
 
@@ -24,6 +24,8 @@ from .conv2d_int8 import *
 from . import conv2d_alter_op
 from .bitserial_conv2d import *
 from .bitserial_dense import *
+from .dense import *
+from .pooling import *
 from .injective import *
 from . import cortex_m7
 from .group_conv2d import *
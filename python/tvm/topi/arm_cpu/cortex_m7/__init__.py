@@ -18,3 +18,5 @@
 
 
 from . import conv2d
+from . import dense
+from . import pool
@@ -0,0 +1,112 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, no-value-for-parameter
+"""Direct implementation of dense."""
+
+from tvm import te
+from tvm.autotvm.task.space import SplitEntity
+from tvm.topi.utils import get_const_tuple, traverse_inline
+
+from ..micro_kernel.gemm import (
+    intrin_gemm_MxKxN,
+    gemm_MxKxN_impl,
+)
+
+
+def dense_direct_simd_compute(cfg, data, weight, bias=None, out_dtype=None):
+    """Compute function for Cortex-M7 SIMD implementation of dense."""
+    assert len(data.shape) == 2 and len(weight.shape) == 2, "only support 2-dim dense"
+    if out_dtype is None:
+        out_dtype = data.dtype
+    M, K = get_const_tuple(data.shape)
+    N, _ = get_const_tuple(weight.shape)
+
+    k = te.reduce_axis((0, K), name="k")
+    dense = te.compute(
+        (M, N),
+        lambda i, j: te.sum(data[i, k].astype(out_dtype) * weight[j, k].astype(out_dtype), axis=k),
+        name="T_dense",
+        tag="dense",
+    )
+    if bias is not None:
+        dense = te.compute(
+            (M, N), lambda i, j: dense[i, j] + bias[j].astype(out_dtype), tag="broadcast"
+        )
+
+    ###########################
+    # Config Space Definition #
+    ###########################
+    # the micro kernel widens both operand tiles to int16 on the stack, so the tiles of N and
+    # K bound its stack usage to 2 * (M + tile_n) * tile_k bytes
+    assert K % 4 == 0
+    cfg.define_split(
+        "tile_n", cfg.axis(N), policy="factors", num_outputs=2, filter=lambda x: x.size[-1] <= 16
+    )
+    cfg.define_split(
+        "tile_k",
+        cfg.reduce_axis(K),
+        policy="factors",
+        num_outputs=2,
+        filter=lambda x: x.size[-1] % 4 == 0 and x.size[-1] <= 256,
+    )
+    cfg.define_knob("auto_unroll_max_step", [0, 2, 4, 8, 16, 32])
+    cfg.define_knob("unroll_explicit", [0, 1])
+
+    if cfg.is_fallback:
+        tile_n = max(f for f in range(1, min(N, 4) + 1) if N % f == 0)
+        tile_k = max(f for f in range(4, min(K, 64) + 1, 4) if K % f == 0)
+        cfg["tile_n"] = SplitEntity([-1, tile_n])
+        cfg["tile_k"] = SplitEntity([-1, tile_k])
+
+    return dense
+
+
+def dense_direct_simd_schedule(cfg, outs):
+    """Schedule function for Cortex-M7 SIMD implementation of dense."""
+    sched = te.create_schedule([x.op for x in outs])
+
+    def _callback(op):
+        if "dense" not in op.tag:
+            return
+
+        # extract tensors
+        output = op.output(0)
+        dense = op
+        data = dense.input_tensors[0]
+
+        M = get_const_tuple(data.shape)[0]
+        K = cfg["tile_k"].size[-1]
+        N = cfg["tile_n"].size[-1]
+
+        # the whole batch goes through each call of the micro kernel, which reads a tile of
+        # the weights once for every row of data
+        i, j = sched[dense].op.axis
+        (k,) = sched[dense].op.reduce_axis
+        jo, ji = cfg["tile_n"].apply(sched, dense, j)
+        ko, ki = cfg["tile_k"].apply(sched, dense, k)
+        sched[dense].reorder(jo, ko, i, ji, ki)
+
+        gemm, uniq_id = intrin_gemm_MxKxN(M, K, N, data.dtype, output.dtype)
+        sched[dense].tensorize(i, gemm)
+        sched[dense].pragma(jo, "import_c", gemm_MxKxN_impl(M, K, N, uniq_id))
+
+        # tune unroll
+        sched[dense].pragma(jo, "auto_unroll_max_step", cfg["auto_unroll_max_step"].val)
+        sched[dense].pragma(jo, "unroll_explicit", cfg["unroll_explicit"].val)
+
+    traverse_inline(sched, outs[-1].op, _callback)
+    return sched
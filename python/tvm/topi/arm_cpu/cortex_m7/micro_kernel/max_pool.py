@@ -0,0 +1,127 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, no-value-for-parameter
+"""Defines max intrinsics for SIMD max pooling."""
+
+import random
+import string
+
+import tvm
+from tvm import te
+
+###########################
+# N-channel Max Intrinsic #
+###########################
+
+# NOTE this folds one element of the pooling window into the running maximum of N channels
+def intrin_max_N(N, in_dtype, out_dtype):
+    """Defines a SIMD-accelerated running maximum."""
+    # see intrin_gemm_MxKxN for the unique ID
+    UNIQ_ID_LEN = 8
+    uniq_id = "".join(random.choices(string.ascii_uppercase, k=UNIQ_ID_LEN))
+
+    if isinstance(N, tvm.tir.IntImm):
+        N = N.value
+    # TODO(weberlo, areusch): support more dtypes?
+    assert in_dtype == "int8"
+    assert out_dtype == "int8"
+    X = te.placeholder((N,), name="x", dtype=in_dtype)
+    k = te.reduce_axis((0, 1), name="k")
+    Z = te.compute((N,), lambda i: te.max(X[i], axis=k), name="z")
+    X_buf = tvm.tir.decl_buffer(X.shape, X.dtype, name="X", offset_factor=1)
+    Z_buf = tvm.tir.decl_buffer(Z.shape, Z.dtype, name="Z", offset_factor=1)
+
+    def intrin_func(ins, outs):
+        xx = ins[0]
+        zz = outs[0]
+
+        def _reduce_update():
+            ib = tvm.tir.ir_builder.create()
+            ib.emit(
+                tvm.tir.call_extern(
+                    "int32", f"max8_{N}_update_{uniq_id}", xx.access_ptr("r"), zz.access_ptr("w")
+                )
+            )
+            return ib.get()
+
+        def _reduce_reset():
+            ib = tvm.tir.ir_builder.create()
+            ib.emit(tvm.tir.call_extern("int32", f"max8_{N}_reset_{uniq_id}", zz.access_ptr("w")))
+            return ib.get()
+
+        def _body():
+            ib = tvm.tir.ir_builder.create()
+            ib.emit(
+                tvm.tir.call_extern(
+                    "int32", f"max8_{N}_body_{uniq_id}", xx.access_ptr("r"), zz.access_ptr("w")
+                )
+            )
+            return ib.get()
+
+        return _body(), _reduce_reset(), _reduce_update()
+
+    intrin_decl = te.decl_tensor_intrin(Z.op, intrin_func, binds={X: X_buf, Z: Z_buf})
+    return intrin_decl, uniq_id
+
+
+def max_N_impl(N, uniq_id):
+    """Emit C code for max impl."""
+    # code reference: arm_max_pool_s8 of CMSIS-NN
+    cc_code = f"""
+#ifdef __cplusplus
+extern "C"
+#endif
+#include <string.h>
+#include <arm_math.h>
+
+__STATIC_FORCEINLINE int32_t max8_{N}_body_{uniq_id}(int8_t *xx, int8_t *zz) {{
+  memcpy(zz, xx, {N});
+  return 0;
+}}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+__STATIC_FORCEINLINE int32_t max8_{N}_update_{uniq_id}(int8_t *xx, int8_t *zz) {{
+  int i = 0;
+  for (; i + 4 <= {N}; i += 4) {{
+    int32_t xx32, zz32;
+    memcpy(&xx32, &xx[i], 4);
+    memcpy(&zz32, &zz[i], 4);
+    // __SSUB8 sets the GE flag of each byte lane where xx >= zz, and __SEL picks the
+    // lanes of xx by these flags
+    __SSUB8(xx32, zz32);
+    zz32 = __SEL(xx32, zz32);
+    memcpy(&zz[i], &zz32, 4);
+  }}
+  for (; i < {N}; i++) {{
+    if (xx[i] > zz[i]) {{
+      zz[i] = xx[i];
+    }}
+  }}
+  return 0;
+}}
+
+#ifdef __cplusplus
+extern "C"
+#endif
+__STATIC_FORCEINLINE int32_t max8_{N}_reset_{uniq_id}(int8_t *zz) {{
+  memset(zz, -128, {N});
+  return 0;
+}}
+    """
+    return cc_code
@@ -0,0 +1,62 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Direct implementation of pooling."""
+
+from tvm import te
+from tvm.topi.utils import get_const_int, traverse_inline
+
+from ..micro_kernel.max_pool import (
+    intrin_max_N,
+    max_N_impl,
+)
+
+
+def pool_direct_simd_nhwc_schedule(outs):
+    """Schedule function for Cortex-M7 SIMD implementation of NHWC pooling.
+
+    The int8 max pools fold each element of the window into the maximum of all the channels
+    at once, the other pools keep the default schedule.
+    """
+    outs = [outs] if isinstance(outs, te.tensor.Tensor) else outs
+    sched = te.create_schedule([x.op for x in outs])
+
+    def _callback(op):
+        if op.tag != "pool_max" or op.output(0).dtype != "int8":
+            return
+
+        # extract tensors
+        output = op.output(0)
+        padded_data = op.input_tensors[0]
+        if len(op.axis) != 4 or padded_data.dtype != "int8":
+            return
+
+        n, oh, ow, c = sched[op].op.axis
+        rh, rw = sched[op].op.reduce_axis
+        sched[op].reorder(n, oh, ow, rh, rw, c)
+
+        # only pad the window of each output
+        if isinstance(padded_data.op, te.ComputeOp) and padded_data.op.name == "pad_temp":
+            sched[padded_data].compute_at(sched[op], ow)
+
+        N = get_const_int(output.shape[3])
+        max_intrin, uniq_id = intrin_max_N(N, padded_data.dtype, output.dtype)
+        sched[op].tensorize(c, max_intrin)
+        sched[op].pragma(n, "import_c", max_N_impl(N, uniq_id))
+
+    traverse_inline(sched, outs[-1].op, _callback)
+    return sched
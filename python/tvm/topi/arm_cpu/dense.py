@@ -0,0 +1,34 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, unused-variable
+"""Dense schedule for ARM CPU"""
+
+from tvm import autotvm
+
+from .cortex_m7.dense import direct_simd
+
+
+@autotvm.register_topi_compute("dense_direct_simd.arm_cpu")
+def dense_direct_simd(cfg, data, weight, bias=None, out_dtype=None):
+    """Compute dense with SIMD (v7e-m)."""
+    return direct_simd.dense_direct_simd_compute(cfg, data, weight, bias, out_dtype)
+
+
+@autotvm.register_topi_schedule("dense_direct_simd.arm_cpu")
+def schedule_dense_direct_simd(cfg, outs):
+    """Create schedule for dense_direct_simd"""
+    return direct_simd.dense_direct_simd_schedule(cfg, outs)
@@ -80,6 +80,32 @@ def batch_matmul(x, y, oshape=None, auto_scheduler_rewritten_layout=""):
     return output
 
 
+def batch_matmul_infer_layout(workload, cfg):
+    """Infer input/output shapes and layouts from a workload and cfg.
+
+    The operands of batch_matmul are not laid out by its schedules, the layouts
+    only let the graph tuner select the schedules of batch_matmul with the other
+    operators.
+
+    Parameters
+    ----------
+    workload : tuple
+        batch_matmul workload
+
+    cfg : tuple
+        tvm.autotvm config
+
+    Returns
+    -------
+    Output : [tuple of tuple and str, tuple of tuple and str]
+        Input shapes and layouts, and output shapes and layouts
+    """
+    # pylint: disable=unused-argument
+    x_shape, y_shape = workload[1][1], workload[2][1]
+    out_shape = (max(x_shape[0], y_shape[0]), x_shape[1], y_shape[1])
+    return ((x_shape, "NCW"),), ((out_shape, "NCW"),)
+
+
 @tvm.target.generic_func
 def batch_matmul_legalize(attrs, inputs, types):
     """Legalizes batch_matmul op.
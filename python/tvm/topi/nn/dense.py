@@ -153,6 +153,33 @@ def dense_pack(data, weight, bias=None, out_dtype=None):
     return C
 
 
+def dense_infer_layout(workload, cfg):
+    """Infer input/output shapes and layouts from a workload and cfg.
+
+    The operands of dense are not laid out by its schedules, the layouts only
+    let the graph tuner select the schedules of dense with the other operators.
+
+    Parameters
+    ----------
+    workload : tuple
+        dense workload
+
+    cfg : tuple
+        tvm.autotvm config
+
+    Returns
+    -------
+    Output : [tuple of tuple and str, tuple of tuple and str]
+        Input shapes and layouts, and output shapes and layouts
+    """
+    # pylint: disable=unused-argument
+    data, weight = workload[1], workload[2]
+    batch = data[1][0]
+    wshape = weight[1]
+    out_dim = wshape[0] * wshape[2] if len(wshape) == 3 else wshape[0]
+    return ((data[1], "NC"),), (((batch, out_dim), "NC"),)
+
+
 @tvm.target.generic_func
 def dense_alter_layout(attrs, inputs, tinfos, out_type):
     """Change dense layout.
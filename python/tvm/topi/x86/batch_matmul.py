@@ -162,13 +162,21 @@ def batch_matmul_blas_common(cfg, x, y, out_shape, lib):
     assert len(x.shape) == 3 and len(y.shape) == 3, "only support 3-dim batch_matmul"
     XB, M, XK = get_const_tuple(x.shape)
     YB, N, YK = get_const_tuple(y.shape)
-    assert XB == YB, "batch dimension doesn't match"
+    assert XB == YB or XB == 1 or YB == 1, "batch dimension doesn't match"
     assert XK == YK, "shapes of x and y is inconsistent"
+    batch = max(XB, YB)
     if out_shape is not None:
-        assert out_shape[0] == XB, "got invalid output shape"
+        assert out_shape[0] == batch, "got invalid output shape"
         assert out_shape[1] == M, "got invalid output shape"
         assert out_shape[2] == N, "got invalid output shape"
-    cfg.add_flop(XB * M * N * XK * 2)
+    cfg.add_flop(batch * M * N * XK * 2)
+    if x.dtype == "uint8" and y.dtype == "int8":
+        if not hasattr(lib, "batch_matmul_u8s8s32"):
+            raise NotImplementedError(
+                f"Batch matmul with {lib.__name__} for {x.dtype} is not supported "
+                "(batch_matmul_u8s8s32 not implemented)"
+            )
+        return lib.batch_matmul_u8s8s32(x, y, False, True, dtype="int32")
     return lib.batch_matmul(x, y, False, True)
 
 
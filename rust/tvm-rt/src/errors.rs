@@ -44,6 +44,12 @@ pub enum NDArrayError {
         expected: DataType,
         actual: DataType,
     },
+    #[error("Cannot view the elements of type `{0}` as the requested type.")]
+    ViewTypeMismatch(DataType),
+    #[error("Only the contiguous arrays in cpu have views.")]
+    NotViewable,
+    #[error("The shape {0:?} does not have the {1} elements of the data.")]
+    ShapeMismatch(Vec<i64>, usize),
 }
 
 #[derive(Debug, Error)]
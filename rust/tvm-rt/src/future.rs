@@ -0,0 +1,178 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+//! Asynchronous calls into the runtime.
+//!
+//! A call into TVM blocks its thread until it returns, which stalls the executor of async
+//! code (e.g. tokio) running it. [`spawn_call`] runs the call on a fixed pool of call
+//! threads instead, and returns a [`CallFuture`] completing with its result, so that async
+//! code awaits inference without blocking, and without a thread per in-flight call.
+
+use std::future::Future;
+use std::panic::{self, AssertUnwindSafe};
+use std::pin::Pin;
+use std::sync::mpsc::{channel, Receiver, Sender};
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Waker};
+use std::thread;
+
+use once_cell::sync::Lazy;
+
+type Job = Box<dyn FnOnce() + Send + 'static>;
+
+/// The queue of the call threads, one per available processor.
+static CALL_QUEUE: Lazy<Mutex<Sender<Job>>> = Lazy::new(|| {
+    let (sender, receiver) = channel::<Job>();
+    let receiver = Arc::new(Mutex::new(receiver));
+    let num_threads = thread::available_parallelism().map_or(1, |n| n.get());
+    for i in 0..num_threads {
+        let receiver = receiver.clone();
+        thread::Builder::new()
+            .name(format!("tvm-call-{}", i))
+            .spawn(move || run_calls(receiver))
+            .expect("failed to spawn a call thread");
+    }
+    Mutex::new(sender)
+});
+
+fn run_calls(receiver: Arc<Mutex<Receiver<Job>>>) {
+    loop {
+        let job = match receiver.lock().unwrap().recv() {
+            Ok(job) => job,
+            Err(_) => return,
+        };
+        job();
+    }
+}
+
+struct CallState<T> {
+    result: Option<thread::Result<T>>,
+    waker: Option<Waker>,
+}
+
+/// The future of the result of a call run by [`spawn_call`].
+///
+/// A panic of the call resumes when the future is polled.
+pub struct CallFuture<T> {
+    state: Arc<Mutex<CallState<T>>>,
+}
+
+impl<T> Future for CallFuture<T> {
+    type Output = T;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<T> {
+        let mut state = self.state.lock().unwrap();
+        match state.result.take() {
+            Some(Ok(result)) => Poll::Ready(result),
+            Some(Err(payload)) => panic::resume_unwind(payload),
+            None => {
+                state.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+/// Moves the TVM handles of a call to the call thread running it.
+struct AssertSend<T>(T);
+
+unsafe impl<T> Send for AssertSend<T> {}
+
+/// Runs `f` on a call thread, returning the future of its result.
+pub fn spawn_call<F, T>(f: F) -> CallFuture<T>
+where
+    F: FnOnce() -> T + Send + 'static,
+    T: Send + 'static,
+{
+    unsafe { spawn_call_unchecked(f) }
+}
+
+/// Runs `f` on a call thread like [`spawn_call`], for a call capturing or returning TVM
+/// objects, e.g. `NDArray`s or `Module`s, which are not `Send`.
+///
+/// # Safety
+///
+/// The objects `f` captures must not be used by other threads until the call returns, and the
+/// ones it returns must only be used by one thread at a time. The reference counts of the
+/// objects are atomic, so moving them across threads is otherwise safe.
+pub unsafe fn spawn_call_unchecked<F, T>(f: F) -> CallFuture<T>
+where
+    F: FnOnce() -> T + 'static,
+    T: 'static,
+{
+    let state = Arc::new(Mutex::new(CallState {
+        result: None,
+        waker: None,
+    }));
+    let call = AssertSend((f, AssertSend(state.clone())));
+    let job: Job = Box::new(move || {
+        let AssertSend((f, AssertSend(state))) = call;
+        let result = panic::catch_unwind(AssertUnwindSafe(f));
+        let mut state = state.lock().unwrap();
+        state.result = Some(result);
+        if let Some(waker) = state.waker.take() {
+            waker.wake();
+        }
+    });
+    CALL_QUEUE
+        .lock()
+        .unwrap()
+        .send(job)
+        .expect("the call threads have stopped");
+    CallFuture { state }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::task::Wake;
+
+    struct ThreadWaker(thread::Thread);
+
+    impl Wake for ThreadWaker {
+        fn wake(self: Arc<Self>) {
+            self.0.unpark();
+        }
+    }
+
+    fn block_on<T>(mut future: CallFuture<T>) -> T {
+        let waker = Arc::new(ThreadWaker(thread::current())).into();
+        let mut cx = Context::from_waker(&waker);
+        loop {
+            if let Poll::Ready(result) = Pin::new(&mut future).poll(&mut cx) {
+                return result;
+            }
+            thread::park();
+        }
+    }
+
+    #[test]
+    fn spawn_calls() {
+        let futures: Vec<_> = (0..16).map(|i| spawn_call(move || i * 2)).collect();
+        for (i, future) in futures.into_iter().enumerate() {
+            assert_eq!(block_on(future), i * 2);
+        }
+    }
+
+    #[test]
+    #[should_panic(expected = "call failed")]
+    fn spawn_call_panic() {
+        block_on(spawn_call(|| panic!("call failed")));
+    }
+}
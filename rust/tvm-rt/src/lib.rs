@@ -95,6 +95,7 @@ pub mod array;
 pub mod device;
 pub mod errors;
 pub mod function;
+pub mod future;
 pub mod map;
 pub mod module;
 pub mod ndarray;
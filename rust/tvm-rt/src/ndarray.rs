@@ -54,7 +54,7 @@ use std::{convert::TryFrom, mem, os::raw::c_int, ptr, slice, str::FromStr};
 use mem::size_of;
 use tvm_macros::Object;
 use tvm_sys::ffi::DLTensor;
-use tvm_sys::{ffi, ByteArray, DataType, Device};
+use tvm_sys::{ffi, ByteArray, DataType, Device, DeviceType};
 
 use ndarray::{Array, ArrayD};
 use num_traits::Num;
@@ -261,6 +261,39 @@ impl NDArray {
         Ok(vec)
     }
 
+    /// Views the elements of a contiguous NDArray in cpu as a slice, without copying them.
+    ///
+    /// ## Example
+    ///
+    /// ```
+    /// # use tvm_rt::{Device, DataType, NDArray};
+    /// let mut ndarray = NDArray::empty(&[4], Device::cpu(0), DataType::float(32, 1));
+    /// ndarray.as_mut_slice::<f32>().unwrap().copy_from_slice(&[1., 2., 3., 4.]);
+    /// assert_eq!(ndarray.as_slice::<f32>().unwrap(), &[1., 2., 3., 4.]);
+    /// ```
+    pub fn as_slice<T: 'static>(&self) -> Result<&[T], NDArrayError> {
+        let data = self.view_data::<T>()?;
+        Ok(unsafe { slice::from_raw_parts(data, self.len()) })
+    }
+
+    /// Views the elements of a contiguous NDArray in cpu as a mutable slice, e.g. to write the
+    /// input of a model in place.
+    pub fn as_mut_slice<T: 'static>(&mut self) -> Result<&mut [T], NDArrayError> {
+        let data = self.view_data::<T>()?;
+        Ok(unsafe { slice::from_raw_parts_mut(data, self.len()) })
+    }
+
+    fn view_data<T: 'static>(&self) -> Result<*mut T, NDArrayError> {
+        if self.device().device_type != DeviceType::CPU || !self.is_contiguous() {
+            return Err(NDArrayError::NotViewable);
+        }
+        if !self.dtype().is_type::<T>() {
+            return Err(NDArrayError::ViewTypeMismatch(self.dtype()));
+        }
+        let dltensor = self.as_dltensor();
+        Ok(unsafe { dltensor.data.cast::<u8>().offset(self.byte_offset()).cast() })
+    }
+
     /// Converts the NDArray to [`ByteArray`].
     pub fn to_bytearray(&self) -> Result<ByteArray, NDArrayError> {
         let v = self.to_vec::<u8>()?;
@@ -351,6 +384,68 @@ impl NDArray {
         Ok(nd)
     }
 
+    /// Creates an NDArray in cpu owning the elements of a `Vec`, without copying them.
+    ///
+    /// The `Vec` is dropped with the NDArray.
+    pub fn from_vec<T: Num32 + 'static>(
+        data: Vec<T>,
+        shape: &[i64],
+        dtype: DataType,
+    ) -> Result<Self, NDArrayError> {
+        if !dtype.is_type::<T>() {
+            return Err(NDArrayError::ViewTypeMismatch(dtype));
+        }
+        if shape.iter().product::<i64>() != data.len() as i64 {
+            return Err(NDArrayError::ShapeMismatch(shape.to_vec(), data.len()));
+        }
+        let ctx = Box::into_raw(Box::new(VecManagerCtx {
+            managed: unsafe { mem::zeroed() },
+            data,
+            shape: shape.to_vec(),
+        }));
+        unsafe {
+            let managed = &mut (*ctx).managed;
+            managed.dl_tensor = DLTensor {
+                data: (*ctx).data.as_mut_ptr() as *mut c_void,
+                device: (&Device::cpu(0)).into(),
+                ndim: shape.len() as c_int,
+                dtype: dtype.into(),
+                shape: (*ctx).shape.as_mut_ptr(),
+                strides: ptr::null_mut(),
+                byte_offset: 0,
+            };
+            managed.manager_ctx = ctx as *mut c_void;
+            managed.deleter = Some(delete_vec_manager_ctx::<T>);
+            Ok(NDArray::from_dlpack(managed))
+        }
+    }
+
+    /// Wraps a DLPack tensor, e.g. of another framework, into an NDArray without copying it.
+    ///
+    /// # Safety
+    ///
+    /// `managed` must point to a valid `DLManagedTensor`. The NDArray owns it, and calls its
+    /// deleter once dropped.
+    pub unsafe fn from_dlpack(managed: *mut ffi::DLManagedTensor) -> NDArray {
+        let mut handle = ptr::null_mut() as ffi::TVMArrayHandle;
+        check_call!(ffi::TVMArrayFromDLPack(managed, &mut handle as *mut _));
+        let ptr = NDArrayContainer::from_raw(handle)
+            .map(|o| o.downcast().expect("this should never fail"));
+        NDArray(ptr)
+    }
+
+    /// Exports the NDArray as a DLPack tensor sharing its data, e.g. for another framework.
+    ///
+    /// The consumer owns the returned `DLManagedTensor`, and calls its deleter once done.
+    pub fn to_dlpack(&self) -> *mut ffi::DLManagedTensor {
+        let mut managed = ptr::null_mut() as *mut ffi::DLManagedTensor;
+        check_call!(ffi::TVMArrayToDLPack(
+            self.as_raw_dltensor(),
+            &mut managed as *mut _
+        ));
+        managed
+    }
+
     /// Allocates and creates an empty NDArray given the shape, device and dtype.
     pub fn empty(shape: &[i64], dev: Device, dtype: DataType) -> NDArray {
         let mut handle = ptr::null_mut() as ffi::TVMArrayHandle;
@@ -381,6 +476,19 @@ impl NDArray {
     }
 }
 
+/// The manager of the DLPack tensor of an NDArray owning a `Vec`.
+struct VecManagerCtx<T> {
+    managed: ffi::DLManagedTensor,
+    data: Vec<T>,
+    shape: Vec<i64>,
+}
+
+unsafe extern "C" fn delete_vec_manager_ctx<T>(managed: *mut ffi::DLManagedTensor) {
+    drop(Box::from_raw(
+        (*managed).manager_ctx as *mut VecManagerCtx<T>,
+    ));
+}
+
 macro_rules! impl_from_ndarray_rustndarray {
     ($type:ty, $type_name:tt) => {
         impl<'a> TryFrom<&'a NDArray> for ArrayD<$type> {
@@ -485,6 +593,41 @@ mod tests {
         nd_float.copy_to_ndarray(empty_int).unwrap();
     }
 
+    #[test]
+    fn slice_view() {
+        let mut ndarray = NDArray::empty(&[2, 2], Device::cpu(0), DataType::int(32, 1));
+        ndarray
+            .as_mut_slice::<i32>()
+            .unwrap()
+            .copy_from_slice(&[1, 2, 3, 4]);
+        assert_eq!(ndarray.to_vec::<i32>().unwrap(), vec![1, 2, 3, 4]);
+        assert_eq!(ndarray.as_slice::<i32>().unwrap(), &[1, 2, 3, 4]);
+        assert!(ndarray.as_slice::<f32>().is_err());
+    }
+
+    #[test]
+    fn from_vec() {
+        let data = vec![1f32, 2., 3., 4., 5., 6.];
+        let ptr = data.as_ptr();
+        let ndarray = NDArray::from_vec(data, &[2, 3], DataType::float(32, 1)).unwrap();
+        assert_eq!(ndarray.shape(), &[2, 3]);
+        assert_eq!(ndarray.as_slice::<f32>().unwrap().as_ptr(), ptr);
+        assert_eq!(
+            ndarray.to_vec::<f32>().unwrap(),
+            vec![1., 2., 3., 4., 5., 6.]
+        );
+        assert!(NDArray::from_vec(vec![1f32, 2.], &[3], DataType::float(32, 1)).is_err());
+    }
+
+    #[test]
+    fn dlpack() {
+        let mut ndarray = NDArray::empty(&[4], Device::cpu(0), DataType::int(32, 1));
+        ndarray.copy_from_buffer(&[1i32, 2, 3, 4]);
+        let mut shared = unsafe { NDArray::from_dlpack(ndarray.to_dlpack()) };
+        shared.as_mut_slice::<i32>().unwrap()[0] = 10;
+        assert_eq!(ndarray.to_vec::<i32>().unwrap(), vec![10, 2, 3, 4]);
+    }
+
     #[test]
     fn rust_ndarray() {
         let a = Array::from_shape_vec((2, 2), vec![1f32, 2., 3., 4.])
@@ -19,6 +19,7 @@
 
 use std::convert::TryInto;
 
+use crate::runtime::future::{spawn_call_unchecked, CallFuture};
 use crate::runtime::Function;
 use crate::{runtime::function::Result, runtime::ByteArray, Device, Module, NDArray};
 
@@ -92,6 +93,26 @@ impl GraphRt {
         Ok(())
     }
 
+    /// Run the graph module on a call thread, without blocking the calling thread.
+    ///
+    /// The future completes with the runtime, moved to the call thread while it runs, and the
+    /// result of the run, e.g. in async code:
+    ///
+    /// ```ignore
+    /// let (mut rt, result) = rt.run_async().await;
+    /// result?;
+    /// let output = rt.get_output(0)?;
+    /// ```
+    pub fn run_async(mut self) -> CallFuture<(GraphRt, Result<()>)> {
+        // The runtime and its inputs are owned by the call until it returns.
+        unsafe {
+            spawn_call_unchecked(move || {
+                let result = self.run();
+                (self, result)
+            })
+        }
+    }
+
     /// Extract the ith output from the graph executor and returns it.
     pub fn get_output(&mut self, i: i64) -> Result<NDArray> {
         let get_output_fn = self.module.get_function("get_output", false)?;
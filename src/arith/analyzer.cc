@@ -21,10 +21,18 @@
  * \file tvm/arith/analyzer.cc
  */
 #include <tvm/arith/analyzer.h>
+#include <tvm/ir/transform.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
+#include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/op.h>
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace tvm {
 namespace arith {
 
@@ -69,8 +77,11 @@ void ConstraintContext::EnterWithScope() {
   auto f0 = analyzer_->const_int_bound.EnterConstraint(constraint_);
   auto f1 = analyzer_->modular_set.EnterConstraint(constraint_);
   auto f2 = analyzer_->rewrite_simplify.EnterConstraint(constraint_);
+  analyzer_->constraints_.push_back(constraint_);
   // recovery function.
-  exit_ = [f0, f1, f2]() {
+  Analyzer* analyzer = analyzer_;
+  exit_ = [f0, f1, f2, analyzer]() {
+    analyzer->constraints_.pop_back();
     if (f2 != nullptr) f2();
     if (f1 != nullptr) f1();
     if (f0 != nullptr) f0();
@@ -122,18 +133,115 @@ bool Analyzer::CanProve(const PrimExpr& expr) {
   return false;
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("arith.memoize_simplify", Bool);
+
+/*!
+ * \brief The simplification results shared by the analyzers of the process,
+ *  so that the passes of a pipeline don't simplify the same indices again.
+ */
+class SimplifyMemo {
+ public:
+  static SimplifyMemo* Global() {
+    static SimplifyMemo* inst = new SimplifyMemo();
+    return inst;
+  }
+
+  bool Lookup(const ObjectRef& key, PrimExpr* result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = memo_.find(key);
+    if (it == memo_.end()) return false;
+    *result = it->second;
+    return true;
+  }
+
+  void Insert(const ObjectRef& key, const PrimExpr& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Start over rather than track the recency of the entries.
+    if (memo_.size() >= kMaxEntries) memo_.clear();
+    memo_[key] = result;
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memo_.clear();
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memo_.size();
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 1 << 16;
+  std::mutex mutex_;
+  std::unordered_map<ObjectRef, PrimExpr, StructuralHash, StructuralEqual> memo_;
+};
+
+ObjectRef Analyzer::SimplifyMemoKey(const PrimExpr& expr, int steps) {
+  // The result only depends on what the sub-analyzers know of the vars expr
+  // reaches, through their bindings, and of the constraints on them.
+  std::vector<Var> vars;
+  std::unordered_set<const VarNode*> visited;
+  auto collect = [&](const PrimExpr& e) {
+    tir::PostOrderVisit(e, [&](const ObjectRef& node) {
+      if (const auto* var = node.as<VarNode>()) {
+        if (visited.insert(var).second) vars.push_back(GetRef<Var>(var));
+      }
+    });
+  };
+  collect(expr);
+  Array<ObjectRef> key{expr, Integer(steps)};
+  for (size_t i = 0; i < vars.size(); ++i) {
+    Var var = vars[i];
+    PrimExpr value = this->rewrite_simplify(var);
+    if (!value.same_as(var)) collect(value);
+    key.push_back(var);
+    key.push_back(value);
+    ConstIntBound bound = this->const_int_bound(var);
+    ModularSet mod = this->modular_set(var);
+    for (int64_t v : {bound->min_value, bound->max_value, mod->coeff, mod->base}) {
+      key.push_back(IntImm(DataType::Int(64), v));
+    }
+  }
+  for (const PrimExpr& constraint : constraints_) {
+    bool relevant = false;
+    tir::PostOrderVisit(constraint, [&](const ObjectRef& node) {
+      if (const auto* var = node.as<VarNode>()) relevant = relevant || visited.count(var);
+    });
+    if (relevant) key.push_back(constraint);
+  }
+  return std::move(key);
+}
+
 PrimExpr Analyzer::Simplify(const PrimExpr& expr, int steps) {
   if (tir::is_const_int(expr)) return expr;
+  bool memoize = transform::PassContext::Current()
+                     ->GetConfig<Bool>("arith.memoize_simplify", Bool(false))
+                     .value();
+  ObjectRef key;
   PrimExpr res = expr;
+  if (memoize) {
+    key = SimplifyMemoKey(expr, steps);
+    if (SimplifyMemo::Global()->Lookup(key, &res)) return res;
+  }
   for (int i = 0; i < steps; ++i) {
     res = this->rewrite_simplify(res);
-    if (tir::is_const_int(res) || ++i == steps) return res;
+    if (tir::is_const_int(res) || ++i == steps) break;
     res = this->canonical_simplify(res);
-    if (tir::is_const_int(res)) return res;
+    if (tir::is_const_int(res)) break;
   }
+  if (memoize) SimplifyMemo::Global()->Insert(key, res);
   return res;
 }
 
+TVM_REGISTER_GLOBAL("arith.ClearSimplifyMemo").set_body_typed([]() {
+  SimplifyMemo::Global()->Clear();
+});
+
+TVM_REGISTER_GLOBAL("arith.SimplifyMemoSize").set_body_typed([]() {
+  return static_cast<int64_t>(SimplifyMemo::Global()->Size());
+});
+
 TVM_REGISTER_GLOBAL("arith.CreateAnalyzer").set_body([](TVMArgs args, TVMRetValue* ret) {
   using runtime::PackedFunc;
   using runtime::TypedPackedFunc;
@@ -165,8 +165,9 @@ class IterMapRewriter : public ExprMutator {
  public:
   using Parent = ExprMutator;
 
-  explicit IterMapRewriter(Analyzer* analyzer, const Map<Var, Range>& input_iters)
-      : analyzer_(analyzer) {
+  explicit IterMapRewriter(Analyzer* analyzer, const Map<Var, Range>& input_iters,
+                           bool allow_padding = false)
+      : analyzer_(analyzer), allow_padding_(allow_padding) {
     for (auto kv : input_iters) {
       const Var& var = kv.first;
       const Range& vrng = kv.second;
@@ -192,6 +193,30 @@ class IterMapRewriter : public ExprMutator {
     return NormalizeToIterWithOffset(ToIterSumExpr(DirectMutate(expr)));
   }
 
+  /*!
+   * \brief Move the splits of the marks padded after their rewrite to the padded marks,
+   *  when they lie below the padding.
+   *  Example: given x in [0, 10), bindings = [x % 2, x / 2 / 3]
+   *  - x / 2 / 3 pads x to [0, 12), its split x / 2 to [0, 6)
+   *  - x % 2 was a split of x before, it is one of the padded x.
+   * \param expr The rewritten binding.
+   * \return The binding on the padded marks.
+   */
+  IterSumExpr MovePaddedSplits(IterSumExpr expr) {
+    if (padded_marks_.empty()) return expr;
+    Array<IterSplitExpr> args;
+    for (IterSplitExpr split : expr->args) {
+      auto it = padded_marks_.find(split->source);
+      if (it != padded_marks_.end() &&
+          CanProveDivisible(it->second.lower_factor, split->lower_factor * split->extent)) {
+        split.CopyOnWrite()->source = it->second.mark;
+      }
+      args.push_back(split);
+    }
+    expr.CopyOnWrite()->args = args;
+    return expr;
+  }
+
   IterSumExpr RewriteIterConstraint(const PrimExpr& expr,
                                     const PrimExpr& predicate_induced_extent) {
     return NormalizeToIterOnBoundExpr(ToIterSumExpr(DirectMutate(expr)), predicate_induced_extent);
@@ -224,6 +249,8 @@ class IterMapRewriter : public ExprMutator {
     // The splits do not overlap with each other.
     collector.Collect(bindings);
     for (const IterMark& mark : collector.visited_) {
+      // the splits of the mark a padding replaced cannot tell apart the padded values.
+      if (padded_marks_.count(mark)) return false;
       if (TryNormalizeSplits(mark, collector.mark2splits_[mark], require_bijective).empty())
         return false;
     }
@@ -328,10 +355,24 @@ class IterMapRewriter : public ExprMutator {
     }
   };
 
+  // The padding of a mark, to a multiple of the factor of a non-divisible split.
+  struct PaddedMark {
+    // The mark over the padded extent, of the same source.
+    IterMark mark;
+    // The lower factor of the split padded.
+    PrimExpr lower_factor;
+  };
+
   // Internal analyzer
   Analyzer* analyzer_;
+  // Whether the non-divisible splits may pad their marks.
+  bool allow_padding_;
   // Counter to keep track of unresolved cases.
   int unresolved_count_{0};
+  // The padding of the marks of the non-divisible splits, by the original mark.
+  std::unordered_map<IterMark, PaddedMark, ObjectPtrHash, ObjectPtrEqual> padded_marks_;
+  // The marks created by a padding.
+  std::unordered_set<IterMark, ObjectPtrHash, ObjectPtrEqual> padding_marks_;
   // The var map
   std::unordered_map<Var, PrimExpr, ObjectPtrHash, ObjectPtrEqual> var_map_;
   // input iter marks
@@ -617,6 +658,47 @@ class IterMapRewriter : public ExprMutator {
     return analyzer_->CanProveEqual(lhs, rhs) || analyzer_->CanProve(floormod(lhs, rhs) == 0);
   }
 
+  /*!
+   * \brief Pad the mark of the outermost split lhs, so that a division of lhs by rhs
+   *  becomes divisible. The padded values, at and above the original extent of the
+   *  mark, are never reached: the source of the padded mark is below the original
+   *  extent, the predicate the rewrite of the division relies on.
+   *  Example: given x in [0, 10), x / 4 and x % 4 pad x to [0, 12)
+   * \param lhs The split to be divided.
+   * \param rhs The divisor.
+   * \return The split over the padded mark, NullOpt when it cannot be padded.
+   */
+  Optional<IterSplitExpr> PadSplit(const IterSplitExpr& lhs, const PrimExpr& rhs) {
+    if (!allow_padding_) return NullOpt;
+    const IterMark& mark = lhs->source;
+    const auto* lower_factor = lhs->lower_factor.as<IntImmNode>();
+    const auto* extent = lhs->extent.as<IntImmNode>();
+    const auto* mark_extent = mark->extent.as<IntImmNode>();
+    const auto* divisor = rhs.as<IntImmNode>();
+    if (!lower_factor || !extent || !mark_extent || !divisor || divisor->value <= 0) {
+      return NullOpt;
+    }
+    // the values above the original extent of a padded mark are no longer unreachable
+    // in a split of it, don't pad it again.
+    if (padding_marks_.count(mark)) return NullOpt;
+    // only the outermost split reaches the padded values.
+    if (lower_factor->value * extent->value != mark_extent->value) return NullOpt;
+    int64_t padded_extent = (extent->value + divisor->value - 1) / divisor->value * divisor->value;
+    PrimExpr padded_mark_extent =
+        make_const(mark->extent.dtype(), lower_factor->value * padded_extent);
+    auto it = padded_marks_.find(mark);
+    if (it == padded_marks_.end()) {
+      PaddedMark padded{IterMark(mark->source, padded_mark_extent), lhs->lower_factor};
+      padding_marks_.insert(padded.mark);
+      it = padded_marks_.emplace(mark, padded).first;
+    } else if (!analyzer_->CanProveEqual(it->second.mark->extent, padded_mark_extent)) {
+      // the divisions of a mark must agree on its padding.
+      return NullOpt;
+    }
+    return IterSplitExpr(it->second.mark, lhs->lower_factor,
+                         make_const(lhs->extent.dtype(), padded_extent), lhs->scale);
+  }
+
   PrimExpr SplitFloorDivConst(IterSplitExpr lhs, PrimExpr rhs, const PrimExpr& orig);
   PrimExpr SplitFloorModConst(IterSplitExpr lhs, PrimExpr rhs, const PrimExpr& orig);
 
@@ -702,7 +784,7 @@ std::vector<IterConstraint> MatchUpperBoundConstraints(PrimExpr pred) {
 
 Array<IterSumExpr> DetectIterMap(const Array<PrimExpr>& indices, const Map<Var, Range>& input_iters,
                                  const PrimExpr& predicate, bool require_bijective,
-                                 arith::Analyzer* analyzer) {
+                                 arith::Analyzer* analyzer, bool allow_padding) {
   // Overall detection algorithm is divided into two steps:
   // - Step0: IterMapRewriter rewrites the expression to use IterMapExpr patterns.
   // - Step1: IterIndependenceChecker checks if the iterator are independent.
@@ -721,7 +803,8 @@ Array<IterSumExpr> DetectIterMap(const Array<PrimExpr>& indices, const Map<Var,
       constraints.begin(), constraints.end(),
       [](const IterConstraint& a, const IterConstraint& b) { return a.expr_size < b.expr_size; });
 
-  IterMapRewriter rewriter(analyzer, input_iters);
+  // A padding adds values the bindings never reach, they are no longer bijective.
+  IterMapRewriter rewriter(analyzer, input_iters, allow_padding && !require_bijective);
   // Step0.0: rewrite constraints in the order from size-small ones to size-big ones
   for (const IterConstraint& constraint : constraints) {
     PrimExpr res = rewriter.RewriteIterConstraint(constraint.iter, constraint.upper_bound);
@@ -734,6 +817,9 @@ Array<IterSumExpr> DetectIterMap(const Array<PrimExpr>& indices, const Map<Var,
     results.push_back(rewriter.Rewrite(value));
     if (rewriter.unresolved_count() != 0) return Array<IterSumExpr>();
   }
+  for (size_t i = 0; i < results.size(); ++i) {
+    results.Set(i, rewriter.MovePaddedSplits(results[i]));
+  }
   // Step1: IterIndependenceChecker checks if the iterator are independent.
   if (!rewriter.CheckMapping(results, require_bijective)) return Array<IterSumExpr>();
 
@@ -742,9 +828,9 @@ Array<IterSumExpr> DetectIterMap(const Array<PrimExpr>& indices, const Map<Var,
 
 TVM_REGISTER_GLOBAL("arith.DetectIterMap")
     .set_body_typed([](const Array<PrimExpr>& indices, const Map<Var, Range>& input_iters,
-                       const PrimExpr& input_pred, bool is_bijective) {
+                       const PrimExpr& input_pred, bool is_bijective, bool allow_padding) {
       arith::Analyzer ana;
-      return DetectIterMap(indices, input_iters, input_pred, is_bijective, &ana);
+      return DetectIterMap(indices, input_iters, input_pred, is_bijective, &ana, allow_padding);
     });
 
 PrimExpr IterMapRewriter::VisitExpr_(const VarNode* op) {
@@ -892,6 +978,10 @@ PrimExpr IterMapRewriter::SplitFloorDivConst(IterSplitExpr lhs, PrimExpr rhs,
 
   // We handle scale!=1 in above code, hence we only consider floordiv(x, rhs) below
   // where x=floormod(floordiv(iter, lower_factor), extent)
+  if (!CanProveDivisible(lhs->extent, rhs)) {
+    // floordiv(x, c) where extent % c != 0, pad the mark of x, see PadSplit
+    if (Optional<IterSplitExpr> padded = PadSplit(lhs, rhs)) lhs = padded.value();
+  }
   if (CanProveDivisible(lhs->extent, rhs)) {
     // floordiv(floormod(floordiv(iter, lower_factor), c1c2), c1)
     // = floordiv(floormod(y, c1c2), c1), where y=floordiv(iter, lower_factor)
@@ -974,6 +1064,10 @@ PrimExpr IterMapRewriter::SplitFloorModConst(IterSplitExpr lhs, PrimExpr rhs,
   }
 
   // floormod(x, rhs) where x=floormod(floordiv(iter, lower_factor), extent)
+  if (!CanProveDivisible(lhs->extent, rhs)) {
+    // floormod(x, c) where extent % c != 0, pad the mark of x, see PadSplit
+    if (Optional<IterSplitExpr> padded = PadSplit(lhs, rhs)) lhs = padded.value();
+  }
   if (CanProveDivisible(lhs->extent, rhs)) {
     // floormod(floormod(floordiv(iter, lower_factor), c1c2), c1)
     // = floormod(floordiv(iter, lower_factor), c1), where c1=rhs
@@ -71,6 +71,9 @@
 
 #include <cmath>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "const_fold.h"
 
@@ -745,6 +748,261 @@ inline PCallExpr<PIfThenElseOp, TCond, TA, TB> if_then_else(const Pattern<TCond>
                                                  false_value.derived());
 }
 
+/*!
+ * \brief The kinds of nodes the kind filter of the patterns tells apart, one bit each.
+ *
+ *  The kinds of a pattern, of its root and of the roots of its operands, are known
+ *  at compile time. Comparing them with the kinds of an expression and of its
+ *  operands skips the patterns that cannot match without running their match.
+ */
+enum PKind : uint32_t {
+  kPKindAdd = 1U << 0,
+  kPKindSub = 1U << 1,
+  kPKindMul = 1U << 2,
+  kPKindDiv = 1U << 3,
+  kPKindMod = 1U << 4,
+  kPKindFloorDiv = 1U << 5,
+  kPKindFloorMod = 1U << 6,
+  kPKindMin = 1U << 7,
+  kPKindMax = 1U << 8,
+  kPKindEQ = 1U << 9,
+  kPKindNE = 1U << 10,
+  kPKindLT = 1U << 11,
+  kPKindLE = 1U << 12,
+  kPKindGT = 1U << 13,
+  kPKindGE = 1U << 14,
+  kPKindAnd = 1U << 15,
+  kPKindOr = 1U << 16,
+  kPKindNot = 1U << 17,
+  kPKindSelect = 1U << 18,
+  kPKindCast = 1U << 19,
+  kPKindRamp = 1U << 20,
+  kPKindBroadcast = 1U << 21,
+  kPKindCall = 1U << 22,
+  kPKindIntImm = 1U << 23,
+  kPKindFloatImm = 1U << 24,
+  kPKindVar = 1U << 25,
+  kPKindOther = 1U << 26,
+  kPKindAny = ~0U
+};
+
+/*! \brief The kind of an expression node type. */
+template <typename NodeType>
+struct PNodeKind {
+  static constexpr uint32_t value = kPKindOther;
+};
+
+#define TVM_PATTERN_NODE_KIND(NodeName, Kind) \
+  template <>                                 \
+  struct PNodeKind<NodeName> {                \
+    static constexpr uint32_t value = Kind;   \
+  };
+
+TVM_PATTERN_NODE_KIND(tir::AddNode, kPKindAdd);
+TVM_PATTERN_NODE_KIND(tir::SubNode, kPKindSub);
+TVM_PATTERN_NODE_KIND(tir::MulNode, kPKindMul);
+TVM_PATTERN_NODE_KIND(tir::DivNode, kPKindDiv);
+TVM_PATTERN_NODE_KIND(tir::ModNode, kPKindMod);
+TVM_PATTERN_NODE_KIND(tir::FloorDivNode, kPKindFloorDiv);
+TVM_PATTERN_NODE_KIND(tir::FloorModNode, kPKindFloorMod);
+TVM_PATTERN_NODE_KIND(tir::MinNode, kPKindMin);
+TVM_PATTERN_NODE_KIND(tir::MaxNode, kPKindMax);
+TVM_PATTERN_NODE_KIND(tir::EQNode, kPKindEQ);
+TVM_PATTERN_NODE_KIND(tir::NENode, kPKindNE);
+TVM_PATTERN_NODE_KIND(tir::LTNode, kPKindLT);
+TVM_PATTERN_NODE_KIND(tir::LENode, kPKindLE);
+TVM_PATTERN_NODE_KIND(tir::GTNode, kPKindGT);
+TVM_PATTERN_NODE_KIND(tir::GENode, kPKindGE);
+TVM_PATTERN_NODE_KIND(tir::AndNode, kPKindAnd);
+TVM_PATTERN_NODE_KIND(tir::OrNode, kPKindOr);
+TVM_PATTERN_NODE_KIND(tir::NotNode, kPKindNot);
+TVM_PATTERN_NODE_KIND(tir::SelectNode, kPKindSelect);
+TVM_PATTERN_NODE_KIND(tir::CastNode, kPKindCast);
+TVM_PATTERN_NODE_KIND(tir::RampNode, kPKindRamp);
+TVM_PATTERN_NODE_KIND(tir::BroadcastNode, kPKindBroadcast);
+TVM_PATTERN_NODE_KIND(tir::CallNode, kPKindCall);
+TVM_PATTERN_NODE_KIND(IntImmNode, kPKindIntImm);
+TVM_PATTERN_NODE_KIND(FloatImmNode, kPKindFloatImm);
+TVM_PATTERN_NODE_KIND(tir::VarNode, kPKindVar);
+// SizeVar is matched as a Var.
+TVM_PATTERN_NODE_KIND(tir::SizeVarNode, kPKindVar);
+
+/*!
+ * \brief The kinds a pattern matches, of its root and of the two operands of a binary root.
+ * \tparam T The pattern type.
+ */
+template <typename T>
+struct PPatternKind {
+  static constexpr uint32_t value = kPKindAny;
+  static constexpr uint32_t a = kPKindAny;
+  static constexpr uint32_t b = kPKindAny;
+};
+
+template <typename T>
+struct PPatternKind<PVar<T>> {
+  static constexpr uint32_t value =
+      std::is_base_of<PrimExpr, T>::value && !std::is_same<PrimExpr, T>::value
+          ? PNodeKind<typename T::ContainerType>::value
+          : kPKindAny;
+  static constexpr uint32_t a = kPKindAny;
+  static constexpr uint32_t b = kPKindAny;
+};
+
+template <typename TA>
+struct PPatternKind<PConstWithTypeLike<TA>> {
+  static constexpr uint32_t value = kPKindIntImm;
+  static constexpr uint32_t a = kPKindAny;
+  static constexpr uint32_t b = kPKindAny;
+};
+
+template <typename OpType, typename TA, typename TB>
+struct PPatternKind<PBinaryExpr<OpType, TA, TB>> {
+  static constexpr uint32_t value = PNodeKind<typename OpType::ContainerType>::value;
+  static constexpr uint32_t a = PPatternKind<TA>::value;
+  static constexpr uint32_t b = PPatternKind<TB>::value;
+};
+
+#define TVM_PATTERN_EXPR_KIND(PatternName, Kind)        \
+  template <typename... TArgs>                          \
+  struct PPatternKind<PatternName<TArgs...>> {          \
+    static constexpr uint32_t value = Kind;             \
+    static constexpr uint32_t a = kPKindAny;            \
+    static constexpr uint32_t b = kPKindAny;            \
+  };
+
+TVM_PATTERN_EXPR_KIND(PNotExpr, kPKindNot);
+TVM_PATTERN_EXPR_KIND(PSelectExpr, kPKindSelect);
+TVM_PATTERN_EXPR_KIND(PCastExpr, kPKindCast);
+TVM_PATTERN_EXPR_KIND(PRampExpr, kPKindRamp);
+TVM_PATTERN_EXPR_KIND(PBroadcastExpr, kPKindBroadcast);
+
+template <typename Op, typename... TArgs>
+struct PPatternKind<PCallExpr<Op, TArgs...>> {
+  static constexpr uint32_t value = kPKindCall;
+  static constexpr uint32_t a = kPKindAny;
+  static constexpr uint32_t b = kPKindAny;
+};
+
+namespace detail {
+/*! \brief The kind of a node type, and the operands of the binary nodes. */
+struct PKindEntry {
+  uint32_t kind{kPKindOther};
+  std::pair<const Object*, const Object*> (*operands)(const Object* node){nullptr};
+};
+
+template <typename NodeType>
+std::pair<const Object*, const Object*> PBinaryOperands(const Object* node) {
+  const auto* op = static_cast<const NodeType*>(node);
+  return {op->a.get(), op->b.get()};
+}
+
+template <typename NodeType>
+void PSetKindEntry(std::vector<PKindEntry>* table) {
+  uint32_t index = NodeType::RuntimeTypeIndex();
+  if (table->size() <= index) table->resize(index + 1);
+  (*table)[index].kind = PNodeKind<NodeType>::value;
+}
+
+template <typename NodeType>
+void PSetBinaryKindEntry(std::vector<PKindEntry>* table) {
+  PSetKindEntry<NodeType>(table);
+  (*table)[NodeType::RuntimeTypeIndex()].operands = PBinaryOperands<NodeType>;
+}
+
+/*! \return The kind entries, indexed by the runtime type index of the nodes. */
+inline const std::vector<PKindEntry>& PKindTable() {
+  static const std::vector<PKindEntry> table = []() {
+    std::vector<PKindEntry> table;
+    PSetBinaryKindEntry<tir::AddNode>(&table);
+    PSetBinaryKindEntry<tir::SubNode>(&table);
+    PSetBinaryKindEntry<tir::MulNode>(&table);
+    PSetBinaryKindEntry<tir::DivNode>(&table);
+    PSetBinaryKindEntry<tir::ModNode>(&table);
+    PSetBinaryKindEntry<tir::FloorDivNode>(&table);
+    PSetBinaryKindEntry<tir::FloorModNode>(&table);
+    PSetBinaryKindEntry<tir::MinNode>(&table);
+    PSetBinaryKindEntry<tir::MaxNode>(&table);
+    PSetBinaryKindEntry<tir::EQNode>(&table);
+    PSetBinaryKindEntry<tir::NENode>(&table);
+    PSetBinaryKindEntry<tir::LTNode>(&table);
+    PSetBinaryKindEntry<tir::LENode>(&table);
+    PSetBinaryKindEntry<tir::GTNode>(&table);
+    PSetBinaryKindEntry<tir::GENode>(&table);
+    PSetBinaryKindEntry<tir::AndNode>(&table);
+    PSetBinaryKindEntry<tir::OrNode>(&table);
+    PSetKindEntry<tir::NotNode>(&table);
+    PSetKindEntry<tir::SelectNode>(&table);
+    PSetKindEntry<tir::CastNode>(&table);
+    PSetKindEntry<tir::RampNode>(&table);
+    PSetKindEntry<tir::BroadcastNode>(&table);
+    PSetKindEntry<tir::CallNode>(&table);
+    PSetKindEntry<IntImmNode>(&table);
+    PSetKindEntry<FloatImmNode>(&table);
+    PSetKindEntry<tir::VarNode>(&table);
+    PSetKindEntry<tir::SizeVarNode>(&table);
+    return table;
+  }();
+  return table;
+}
+
+inline const PKindEntry& PKindEntryOf(const Object* node) {
+  static const PKindEntry other;
+  const std::vector<PKindEntry>& table = PKindTable();
+  uint32_t index = node->type_index();
+  return index < table.size() ? table[index] : other;
+}
+
+/*! \brief The kinds of an expression and of the operands of a binary one. */
+struct PKindSignature {
+  ObjectRef node;
+  uint32_t value{kPKindAny};
+  uint32_t a{kPKindAny};
+  uint32_t b{kPKindAny};
+};
+}  // namespace detail
+
+/*!
+ * \brief The kinds of an expression and of its operands.
+ *
+ *  The rules of a rewrite all match the same expression in turn, the signature
+ *  of the last expression is kept so that it is only computed once for them.
+ *
+ * \param node The expression.
+ * \return The signature.
+ */
+inline const detail::PKindSignature& PKindSignatureOf(const ObjectRef& node) {
+  thread_local detail::PKindSignature sig;
+  if (sig.node.same_as(node)) return sig;
+  sig.node = node;
+  sig.value = sig.a = sig.b = kPKindAny;
+  if (!node.defined()) return sig;
+  const detail::PKindEntry& entry = detail::PKindEntryOf(node.get());
+  sig.value = entry.kind;
+  if (entry.operands != nullptr) {
+    auto operands = entry.operands(node.get());
+    sig.a = detail::PKindEntryOf(operands.first).kind;
+    sig.b = detail::PKindEntryOf(operands.second).kind;
+  }
+  return sig;
+}
+
+/*!
+ * \brief Whether the kinds of an expression and of its operands allow a pattern to match.
+ *
+ *  A false result means the pattern cannot match, true that it may.
+ *
+ * \param node The expression.
+ * \tparam T The pattern type.
+ * \return Whether the pattern may match.
+ */
+template <typename T>
+inline bool PKindMayMatch(const ObjectRef& node) {
+  using Kind = PPatternKind<typename std::decay<T>::type>;
+  if (Kind::value == kPKindAny) return true;
+  const detail::PKindSignature& sig = PKindSignatureOf(node);
+  return (sig.value & Kind::value) && (sig.a & Kind::a) && (sig.b & Kind::b);
+}
+
 }  // namespace arith
 }  // namespace tvm
 #endif  // TVM_ARITH_PATTERN_MATCH_H_
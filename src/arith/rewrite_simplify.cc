@@ -40,26 +40,30 @@ namespace arith {
 using namespace tir;
 
 // macro for doing simple rewrite
+// The kind filter of the pattern skips the patterns whose root or
+// operands cannot be of the kinds of those of ret.
+#define TVM_TRY_MATCH(SrcExpr) (PKindMayMatch<decltype(SrcExpr)>(ret) && (SrcExpr).Match(ret))
+
 #define TVM_TRY_REWRITE(SrcExpr, ResExpr) \
-  if ((SrcExpr).Match(ret)) {             \
+  if (TVM_TRY_MATCH(SrcExpr)) {           \
     return (ResExpr).Eval();              \
   }
 
 // macro for rewrite + recursively rewrite ResExpr
 #define TVM_TRY_RECURSIVE_REWRITE(SrcExpr, ResExpr) \
-  if ((SrcExpr).Match(ret)) {                       \
+  if (TVM_TRY_MATCH(SrcExpr)) {                     \
     return RecursiveRewrite((ResExpr).Eval());      \
   }
 
 // macro rewrite only if CondExor is true after match.
 #define TVM_TRY_REWRITE_IF(SrcExpr, ResExpr, CondExpr) \
-  if ((SrcExpr).Match(ret) && (CondExpr)) {            \
+  if (TVM_TRY_MATCH(SrcExpr) && (CondExpr)) {          \
     return (ResExpr).Eval();                           \
   }
 
 // macro rewrite + recursive_rewrite only if CondExor is true after match.
 #define TVM_TRY_RECURSIVE_REWRITE_IF(SrcExpr, ResExpr, CondExpr) \
-  if ((SrcExpr).Match(ret) && (CondExpr)) {                      \
+  if (TVM_TRY_MATCH(SrcExpr) && (CondExpr)) {                    \
     return RecursiveRewrite((ResExpr).Eval());                   \
   }
 
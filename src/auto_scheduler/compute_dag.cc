@@ -22,6 +22,7 @@
  * \brief Compute declaration graph and its related analysis tools.
  */
 
+#include <dmlc/json.h>
 #include <tvm/auto_scheduler/compute_dag.h>
 #include <tvm/auto_scheduler/loop_state.h>
 #include <tvm/auto_scheduler/search_policy.h>
@@ -38,6 +39,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <queue>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -1154,6 +1157,40 @@ bool HasLayoutFreeTensors(const ComputeDAG& dag) {
   return false;
 }
 
+/*! \brief The number of steps between the snapshots of a replay kept in the replay cache. */
+constexpr size_t kReplaySnapshotInterval = 4;
+
+/*!
+ * \brief Copy the schedule of a replay snapshot, so that applying steps to either leaves the
+ *  other as is.
+ * \param snapshot The snapshot.
+ * \return The copy, with the stages of the copied schedule.
+ */
+ReplaySnapshot CopyReplaySnapshot(const ReplaySnapshot& snapshot) {
+  ReplaySnapshot ret;
+  ret.schedule = snapshot.schedule.copy();
+  // Schedule::copy keeps the order of the stages and the groups
+  std::unordered_map<te::Stage, te::Stage, ObjectPtrHash, ObjectPtrEqual> stage_map;
+  for (size_t i = 0; i < ret.schedule->stages.size(); ++i) {
+    stage_map[snapshot.schedule->stages[i]] = ret.schedule->stages[i];
+  }
+  for (size_t i = 0; i < ret.schedule->groups.size(); ++i) {
+    stage_map[snapshot.schedule->groups[i]] = ret.schedule->groups[i];
+  }
+  auto get_stage = [&stage_map](const te::Stage& stage) {
+    auto it = stage_map.find(stage);
+    ICHECK(it != stage_map.end()) << "Cannot find the stage of " << stage->op << " in the schedule";
+    return it->second;
+  };
+  for (const auto& stage : snapshot.stages) {
+    ret.stages.push_back(get_stage(stage));
+  }
+  for (const auto& kv : snapshot.stage_to_axes) {
+    ret.stage_to_axes.Set(get_stage(kv.first), kv.second);
+  }
+  return ret;
+}
+
 std::pair<te::Schedule, Array<te::Tensor>> ComputeDAG::ApplySteps(
     const Array<Step>& transform_steps, Array<te::Stage>* stages, StageToAxesMap* stage_to_axes,
     LayoutRewriteOption layout_rewrite) const {
@@ -1173,27 +1210,63 @@ std::pair<te::Schedule, Array<te::Tensor>> ComputeDAG::ApplySteps(
   if (stage_to_axes == nullptr) {
     stage_to_axes = &temp_stage_to_axes;
   }
-  Array<te::Operation> out_ops;
-  for (const auto& op : operator->()->ops) {
-    if (operator->()->access_analyzer.IsOutput(op)) {
-      out_ops.push_back(op);
+
+  // The keys of the prefixes of the steps that end at a snapshot
+  std::vector<std::string> prefix_keys;
+  std::string key;
+  for (size_t i = 0; i < transform_steps.size(); ++i) {
+    key += SerializeSteps({transform_steps[i]});
+    if ((i + 1) % kReplaySnapshotInterval == 0) {
+      prefix_keys.push_back(key);
     }
   }
 
-  // Create the initial schedule
-  te::Schedule schedule = te::create_schedule(out_ops);
+  // Resume from the longest prefix replayed before
+  te::Schedule schedule;
+  size_t num_replayed = 0;
+  ReplaySnapshot snapshot;
+  for (size_t i = prefix_keys.size(); i > 0; --i) {
+    if (operator->()->replay_cache.Lookup(prefix_keys[i - 1], &snapshot)) {
+      snapshot = CopyReplaySnapshot(snapshot);
+      schedule = snapshot.schedule;
+      *stages = snapshot.stages;
+      *stage_to_axes = snapshot.stage_to_axes;
+      num_replayed = i * kReplaySnapshotInterval;
+      break;
+    }
+  }
 
-  // init axes
-  for (const auto& x : operator->()->ops) {
-    const te::Stage& stage = schedule[x];
-    stages->push_back(stage);
-    UpdateStageToAxesMap(stage, stage_to_axes);
+  if (!schedule.defined()) {
+    Array<te::Operation> out_ops;
+    for (const auto& op : operator->()->ops) {
+      if (operator->()->access_analyzer.IsOutput(op)) {
+        out_ops.push_back(op);
+      }
+    }
+
+    // Create the initial schedule
+    schedule = te::create_schedule(out_ops);
+
+    // init axes
+    for (const auto& x : operator->()->ops) {
+      const te::Stage& stage = schedule[x];
+      stages->push_back(stage);
+      UpdateStageToAxesMap(stage, stage_to_axes);
+    }
   }
 
   // Apply the history steps to TVM schedule
   // Call each step's ApplyToSchedule method
-  for (const auto& step : transform_steps) {
-    StepApplyToSchedule(step, stages, stage_to_axes, &schedule, transform_steps);
+  for (size_t i = num_replayed; i < transform_steps.size(); ++i) {
+    StepApplyToSchedule(transform_steps[i], stages, stage_to_axes, &schedule, transform_steps);
+    if ((i + 1) % kReplaySnapshotInterval == 0) {
+      // Keep a copy, the next steps change the schedule in place
+      snapshot.schedule = schedule;
+      snapshot.stages = *stages;
+      snapshot.stage_to_axes = *stage_to_axes;
+      operator->()->replay_cache.Insert(prefix_keys[i / kReplaySnapshotInterval],
+                                        CopyReplaySnapshot(snapshot));
+    }
   }
 
   return std::make_pair(schedule, operator->()->tensors);
@@ -1319,15 +1392,14 @@ State ComputeDAG::InferBound(const State& state) const {
     pstate = ret_state.CopyOnWrite();
   }
 
-  Array<te::Stage> stages;
-  StageToAxesMap stage_to_axes;
-  te::Schedule sch;
-  Array<te::Tensor> tensors;
-  // Replay steps to tvm::Schedule
-  std::tie(sch, tensors) = ApplySteps(pstate->transform_steps, &stages, &stage_to_axes);
-  sch = sch.normalize_for_feature_extraction();
-  // Get bound information from TVM schedule
-  Map<IterVar, Range> bounds = te::InferBound(sch);
+  // The bounds of the same steps are inferred once
+  std::string key = SerializeSteps(pstate->transform_steps);
+  Array<Array<Range>> stage_bounds;
+  if (!operator->()->bound_cache.Lookup(key, &stage_bounds)) {
+    stage_bounds = InferStageBounds(pstate);
+    operator->()->bound_cache.Insert(key, stage_bounds);
+  }
+  ICHECK_EQ(stage_bounds.size(), pstate->stages.size());
 
   // Update the state bound information
   for (size_t i = 0; i < pstate->stages.size(); ++i) {
@@ -1337,21 +1409,14 @@ State ComputeDAG::InferBound(const State& state) const {
       continue;
     }
 
+    const Array<Range>& ranges = stage_bounds[i];
+    ICHECK_EQ(ranges.size(), stage->iters.size());
     Array<Iterator> new_iters;
     new_iters.reserve(stage->iters.size());
-    // Get bound information from schedule
-    // the StageToAxesMap is used to find the corresponding IterVar in TVM schedule result
     for (size_t j = 0; j < stage->iters.size(); ++j) {
       const Iterator& iter = stage->iters[j];
-      const IterVar& axis = stage_to_axes.at(stages[i])[j];
-
-      auto find_res = bounds.find(axis);
-      if (find_res != bounds.end()) {
-        new_iters.push_back(Iterator(iter->name, (*find_res).second, iter->iter_kind,
-                                     iter->annotation, &iter->orig_iters));
-      } else {
-        LOG(FATAL) << "Infer bound fails";
-      }
+      new_iters.push_back(
+          Iterator(iter->name, ranges[j], iter->iter_kind, iter->annotation, &iter->orig_iters));
     }
 
     pstate->stages.Set(
@@ -1361,6 +1426,54 @@ State ComputeDAG::InferBound(const State& state) const {
   return ret_state;
 }
 
+std::string ComputeDAG::SerializeSteps(const Array<Step>& transform_steps) {
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginArray(false);
+  for (const auto& step : transform_steps) {
+    writer.WriteArraySeperator();
+    writer.BeginArray(false);
+    step->WriteToRecord(&writer);
+    writer.EndArray();
+  }
+  writer.EndArray();
+  return os.str();
+}
+
+Array<Array<Range>> ComputeDAG::InferStageBounds(const StateNode* pstate) const {
+  Array<te::Stage> stages;
+  StageToAxesMap stage_to_axes;
+  te::Schedule sch;
+  Array<te::Tensor> tensors;
+  // Replay steps to tvm::Schedule
+  std::tie(sch, tensors) = ApplySteps(pstate->transform_steps, &stages, &stage_to_axes);
+  sch = sch.normalize_for_feature_extraction();
+  // Get bound information from TVM schedule
+  Map<IterVar, Range> bounds = te::InferBound(sch);
+
+  Array<Array<Range>> stage_bounds;
+  stage_bounds.reserve(pstate->stages.size());
+  for (size_t i = 0; i < pstate->stages.size(); ++i) {
+    const Stage& stage = pstate->stages[i];
+    Array<Range> ranges;
+    if (stage->compute_at != ComputeAtKind::kInlined) {
+      // Get bound information from schedule
+      // the StageToAxesMap is used to find the corresponding IterVar in TVM schedule result
+      for (size_t j = 0; j < stage->iters.size(); ++j) {
+        const IterVar& axis = stage_to_axes.at(stages[i])[j];
+        auto find_res = bounds.find(axis);
+        if (find_res != bounds.end()) {
+          ranges.push_back((*find_res).second);
+        } else {
+          LOG(FATAL) << "Infer bound fails";
+        }
+      }
+    }
+    stage_bounds.push_back(ranges);
+  }
+  return stage_bounds;
+}
+
 Array<State> ComputeDAG::InferBound(const Array<State>& states) const {
   Array<State> out_states(states.size(), State());
 
@@ -23,6 +23,11 @@
  */
 
 #include <tvm/auto_scheduler/cost_model.h>
+#include <tvm/auto_scheduler/feature.h>
+#include <tvm/support/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
 
 namespace tvm {
 namespace auto_scheduler {
@@ -30,6 +35,7 @@ namespace auto_scheduler {
 TVM_REGISTER_OBJECT_TYPE(CostModelNode);
 TVM_REGISTER_OBJECT_TYPE(RandomModelNode);
 TVM_REGISTER_OBJECT_TYPE(PythonBasedModelNode);
+TVM_REGISTER_OBJECT_TYPE(TreeEnsembleModelNode);
 
 RandomModel::RandomModel() {
   ObjectPtr<RandomModelNode> node = make_object<RandomModelNode>();
@@ -145,6 +151,157 @@ void PythonBasedModelNode::PredictStages(const SearchTask& task, const Array<Sta
   }
 }
 
+TreeEnsembleModel::TreeEnsembleModel(PackedFunc update_func, int max_n_bufs, int seed) {
+  auto node = make_object<TreeEnsembleModelNode>();
+  node->update_func = std::move(update_func);
+  node->max_n_bufs = max_n_bufs;
+  node->rand_gen = std::mt19937(seed);
+  data_ = std::move(node);
+}
+
+void TreeEnsembleModelNode::LoadTrees(const runtime::NDArray& node_indices,
+                                      const runtime::NDArray& node_values,
+                                      const runtime::NDArray& tree_roots, float base_score) {
+  ICHECK_EQ(node_indices->ndim, 2);
+  ICHECK_EQ(node_indices->shape[1], 4);
+  ICHECK(node_indices.DataType() == DataType::Int(32));
+  ICHECK(node_values.DataType() == DataType::Float(32));
+  ICHECK(tree_roots.DataType() == DataType::Int(32));
+  int64_t n_nodes = node_indices->shape[0];
+  ICHECK_EQ(node_values->ndim, 1);
+  ICHECK_EQ(node_values->shape[0], n_nodes);
+
+  std::vector<int> indices(n_nodes * 4);
+  std::vector<float> values(n_nodes);
+  std::vector<int> new_roots(tree_roots->ndim == 0 ? 1 : tree_roots->shape[0]);
+  node_indices.CopyToBytes(indices.data(), indices.size() * sizeof(int));
+  node_values.CopyToBytes(values.data(), values.size() * sizeof(float));
+  tree_roots.CopyToBytes(new_roots.data(), new_roots.size() * sizeof(int));
+
+  std::vector<TreeNode> new_nodes(n_nodes);
+  for (int64_t i = 0; i < n_nodes; ++i) {
+    TreeNode& node = new_nodes[i];
+    node.feature = indices[i * 4];
+    node.yes = indices[i * 4 + 1];
+    node.no = indices[i * 4 + 2];
+    node.missing = indices[i * 4 + 3];
+    node.value = values[i];
+    if (node.feature >= 0) {
+      ICHECK(node.yes > i && node.yes < n_nodes && node.no > i && node.no < n_nodes &&
+             node.missing > i && node.missing < n_nodes)
+          << "Invalid children of tree node " << i;
+    }
+  }
+  for (int root : new_roots) {
+    ICHECK(root >= 0 && root < n_nodes) << "Invalid tree root " << root;
+  }
+
+  nodes = std::move(new_nodes);
+  roots = std::move(new_roots);
+  this->base_score = base_score;
+}
+
+void TreeEnsembleModelNode::Update(const Array<MeasureInput>& inputs,
+                                   const Array<MeasureResult>& results) {
+  if (update_func != nullptr) {
+    update_func(inputs, results);
+  }
+}
+
+void TreeEnsembleModelNode::PredictStores(const SearchTask& task, const Array<State>& states,
+                                          std::vector<float>* state_scores,
+                                          std::vector<std::vector<float>>* store_scores) {
+  size_t n_states = states.size();
+  std::vector<std::vector<float>> features;
+  GetPerStoreFeaturesFromStates(states, task, 0, max_n_bufs, &features);
+
+  state_scores->assign(n_states, 0.0f);
+  store_scores->assign(n_states, {});
+  if (roots.empty()) {
+    // The trees are not trained yet, make random predictions like XGBModel does.
+    std::uniform_real_distribution<float> dis(0.0f, 1.0f);
+    for (size_t i = 0; i < n_states; ++i) {
+      (*state_scores)[i] = features[i].empty() ? -INFINITY : dis(rand_gen);
+    }
+    return;
+  }
+
+  int max_feature = -1;
+  for (const TreeNode& node : nodes) {
+    max_feature = std::max(max_feature, node.feature);
+  }
+  support::parallel_for(0, n_states, [&](int i) {
+    const std::vector<float>& feature = features[i];
+    if (feature.empty()) {
+      // Predict -inf for invalid states that failed to be lowered.
+      (*state_scores)[i] = -INFINITY;
+      return;
+    }
+    // The features of a state are {n_stores, feature_vecs[n_stores][vec_len]}.
+    int n_stores = static_cast<int>(feature[0] + 0.5);
+    size_t vec_len = (feature.size() - 1) / n_stores;
+    ICHECK_LT(max_feature, static_cast<int>(vec_len))
+        << "The trees split on more features than extracted";
+    std::vector<float>& scores = (*store_scores)[i];
+    scores.resize(n_stores);
+    float sum = 0.0f;
+    for (int j = 0; j < n_stores; ++j) {
+      const float* x = feature.data() + 1 + j * vec_len;
+      float pred = base_score;
+      for (int root : roots) {
+        int nid = root;
+        while (nodes[nid].feature >= 0) {
+          const TreeNode& node = nodes[nid];
+          float v = x[node.feature];
+          nid = std::isnan(v) ? node.missing : (v < node.value ? node.yes : node.no);
+        }
+        pred += nodes[nid].value;
+      }
+      scores[j] = pred;
+      sum += pred;
+    }
+    (*state_scores)[i] = sum;
+  });
+}
+
+void TreeEnsembleModelNode::Predict(const SearchTask& task, const Array<State>& states,
+                                    std::vector<float>* scores) {
+  std::vector<std::vector<float>> store_scores;
+  PredictStores(task, states, scores, &store_scores);
+}
+
+void TreeEnsembleModelNode::PredictStages(const SearchTask& task, const Array<State>& states,
+                                          std::vector<float>* state_scores,
+                                          std::vector<std::vector<float>>* stage_scores) {
+  std::vector<std::vector<float>> store_scores;
+  PredictStores(task, states, state_scores, &store_scores);
+
+  // The stores follow the stages that are neither placeholders nor inlined,
+  // the same unpacking as PythonBasedModelNode::PredictStages.
+  stage_scores->clear();
+  for (size_t i = 0; i < states.size(); ++i) {
+    const std::vector<float>& stores = store_scores[i];
+    if (stores.empty()) {
+      // The state failed to be lowered or the trees are not trained yet.
+      stage_scores->push_back({});
+      continue;
+    }
+    std::vector<float> scores;
+    size_t offset = 0;
+    for (const Stage& stage : states[i]->stages) {
+      if (stage->op_type == StageKind::kPlaceholder ||
+          stage->compute_at == ComputeAtKind::kInlined) {
+        scores.push_back(0);
+        continue;
+      }
+      scores.push_back(stores[offset]);
+      offset++;
+    }
+    ICHECK_EQ(offset, stores.size());
+    stage_scores->push_back(std::move(scores));
+  }
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.RandomModel").set_body_typed([]() { return RandomModel(); });
 
 TVM_REGISTER_GLOBAL("auto_scheduler.PythonBasedModel")
@@ -153,6 +310,23 @@ TVM_REGISTER_GLOBAL("auto_scheduler.PythonBasedModel")
       return PythonBasedModel(update_func, predict_func, predict_stage_func);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.TreeEnsembleModel")
+    .set_body_typed([](PackedFunc update_func, int max_n_bufs, int seed) {
+      return TreeEnsembleModel(update_func, max_n_bufs, seed);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TreeEnsembleModelLoadTrees")
+    .set_body_typed([](TreeEnsembleModel model, runtime::NDArray node_indices,
+                       runtime::NDArray node_values, runtime::NDArray tree_roots,
+                       double base_score) {
+      model->LoadTrees(node_indices, node_values, tree_roots, base_score);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.TreeEnsembleModelNumTrees")
+    .set_body_typed([](TreeEnsembleModel model) {
+      return static_cast<int64_t>(model->roots.size());
+    });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.CostModelUpdate")
     .set_body_typed([](CostModel model, Array<MeasureInput> inputs, Array<MeasureResult> results) {
       model->Update(inputs, results);
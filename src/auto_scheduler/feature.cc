@@ -38,6 +38,8 @@
 #include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <sstream>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -1262,8 +1264,23 @@ void GetPerStoreFeatureName(int max_n_bufs, std::vector<std::string>* ret) {
   // section total : 3
 }
 
+// The key of the features of a state in the feature cache of its task. Besides the steps,
+// the features depend on the configs of the lowering.
+std::string PerStoreFeatureKey(const State& state, int max_n_bufs) {
+  auto pass_ctx = tvm::transform::PassContext::Current();
+  std::ostringstream os;
+  os << max_n_bufs << "|" << pass_ctx->GetConfig<Bool>("tir.noalias", Bool(true)).value()
+     << pass_ctx->GetConfig<Bool>("tir.disable_vectorize", Bool(false)).value()
+     << pass_ctx->GetConfig<Bool>("tir.instrument_bound_checkers", Bool(false)).value() << "|"
+     << ComputeDAG::SerializeSteps(state->transform_steps);
+  return os.str();
+}
+
 void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, int max_n_bufs,
                                    std::vector<float>* feature, std::atomic<int>* error_ct) {
+  std::string key = PerStoreFeatureKey(state, max_n_bufs);
+  if (task->feature_cache.Lookup(key, feature)) return;
+
   te::Schedule sch;
   Array<te::Tensor> tensors;
 
@@ -1328,6 +1345,7 @@ void GetPerStoreFeaturesWorkerFunc(const SearchTask& task, const State& state, i
     const auto& prim_func = (*it).second.as<PrimFuncNode>();
     GetPerStoreFeature(prim_func->body, task->hardware_params->cache_line_bytes, max_n_bufs,
                        feature);
+    task->feature_cache.Insert(key, *feature);
   } catch (Error& e) {
     (*error_ct)++;
   }
@@ -1640,6 +1658,9 @@ TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeaturesFromStates")
                                std::move(task_ids), &byte_data);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.ClearPerStoreFeatureCache")
+    .set_body_typed([](const SearchTask& task) { task->feature_cache.Clear(); });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.GetPerStoreFeatureNames")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
       int max_n_bufs = args[0];
@@ -0,0 +1,259 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file auto_scheduler/latency_estimator.cc
+ * \brief The latency estimates of the operators, for the decisions of the graph level passes.
+ */
+
+#include <tvm/auto_scheduler/latency_estimator.h>
+#include <tvm/auto_scheduler/measure_record.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <algorithm>
+#include <string>
+
+#include "utils.h"
+
+namespace tvm {
+namespace auto_scheduler {
+
+TVM_REGISTER_NODE_TYPE(LatencyEstimatorNode);
+
+LatencyEstimator::LatencyEstimator(Array<String> log_files) {
+  auto node = make_object<LatencyEstimatorNode>();
+  for (const String& filename : log_files) {
+    node->LoadRecords(filename);
+  }
+  data_ = std::move(node);
+}
+
+LatencyEstimator LatencyEstimator::Global() {
+  static LatencyEstimator inst{Array<String>()};
+  return inst;
+}
+
+void LatencyEstimatorNode::LoadRecords(const String& filename) {
+  RecordReader reader(filename);
+  ICHECK(reader->infile.is_open()) << "Cannot open the log file " << filename;
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  while (reader->ReadNext(inp.get(), res.get())) {
+    if (res->error_no != static_cast<int>(MeasureErrorNO::kNoError) || res->costs.empty()) {
+      continue;
+    }
+    AddRecord(inp->task->workload_key, inp->task->target, FloatArrayMean(res->costs));
+  }
+}
+
+void LatencyEstimatorNode::AddRecord(const String& workload_key, const Target& target,
+                                     double latency) {
+  auto update = [latency](std::unordered_map<std::string, double>* records,
+                          const std::string& key) {
+    auto it = records->find(key);
+    if (it == records->end() || latency < it->second) (*records)[key] = latency;
+  };
+  update(&measured[workload_key], target->str());
+  update(&measured_by_kind[workload_key], target->kind->name);
+}
+
+bool LatencyEstimatorNode::LookupRecord(const String& workload_key, const Target& target,
+                                        double* latency) const {
+  // Prefer the records of the same target, then of the same target kind.
+  auto lookup = [latency](const std::unordered_map<std::string,
+                                                   std::unordered_map<std::string, double>>& map,
+                          const std::string& workload, const std::string& key) {
+    auto it = map.find(workload);
+    if (it == map.end()) return false;
+    auto jt = it->second.find(key);
+    if (jt == it->second.end()) return false;
+    *latency = jt->second;
+    return true;
+  };
+  return lookup(measured, workload_key, target->str()) ||
+         lookup(measured_by_kind, workload_key, target->kind->name);
+}
+
+double LatencyEstimatorNode::EstimateLatency(const tir::PrimFunc& func,
+                                             const Target& target) const {
+  if (Optional<String> workload_key = func->GetAttr<String>(kWorkloadKeyAttr)) {
+    double latency;
+    if (LookupRecord(workload_key.value(), target, &latency)) return latency;
+  }
+  if (cost_model != nullptr) {
+    return cost_model(func, target);
+  }
+  return AnalyticLatency(func, target);
+}
+
+/*! \brief Count the instructions of a loop nest, per lane of the parallelism they run on. */
+class LoopNestCounter : public tir::StmtExprVisitor {
+ public:
+  LoopNestCounter(double max_parallel, int64_t vector_lanes)
+      : max_parallel_(max_parallel), vector_lanes_(vector_lanes) {}
+
+  /*! \brief The instructions run by each lane. */
+  double cycles{0};
+
+  void VisitStmt_(const tir::ForNode* op) final {
+    int64_t extent = 1;
+    if (const auto* imm = op->extent.as<IntImmNode>()) extent = std::max<int64_t>(imm->value, 1);
+    double multiplicity = multiplicity_;
+    double parallel = parallel_;
+    if (op->kind == tir::ForKind::kParallel) {
+      parallel_ *= extent;
+      multiplicity_ *= extent;
+    } else if (op->kind == tir::ForKind::kVectorized) {
+      multiplicity_ *= (extent + vector_lanes_ - 1) / vector_lanes_;
+    } else {
+      multiplicity_ *= extent;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+    multiplicity_ = multiplicity;
+    parallel_ = parallel;
+  }
+
+  void VisitStmt_(const tir::AttrStmtNode* op) final {
+    if (op->attr_key != tir::attr::thread_extent && op->attr_key != tir::attr::virtual_thread) {
+      return StmtExprVisitor::VisitStmt_(op);
+    }
+    int64_t extent = 1;
+    if (const auto* imm = op->value.as<IntImmNode>()) extent = std::max<int64_t>(imm->value, 1);
+    double multiplicity = multiplicity_;
+    double parallel = parallel_;
+    multiplicity_ *= extent;
+    parallel_ *= extent;
+    StmtExprVisitor::VisitStmt_(op);
+    multiplicity_ = multiplicity;
+    parallel_ = parallel;
+  }
+
+  void VisitStmt_(const tir::StoreNode* op) final {
+    Count();
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const tir::BufferStoreNode* op) final {
+    Count();
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const tir::LoadNode* op) final {
+    Count();
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const tir::BufferLoadNode* op) final {
+    Count();
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+#define TVM_COUNT_FLOAT_OP(Node)                         \
+  void VisitExpr_(const Node* op) final {                \
+    if (op->dtype.is_float()) Count();                   \
+    StmtExprVisitor::VisitExpr_(op);                     \
+  }
+
+  TVM_COUNT_FLOAT_OP(tir::AddNode);
+  TVM_COUNT_FLOAT_OP(tir::SubNode);
+  TVM_COUNT_FLOAT_OP(tir::MulNode);
+  TVM_COUNT_FLOAT_OP(tir::DivNode);
+  TVM_COUNT_FLOAT_OP(tir::MinNode);
+  TVM_COUNT_FLOAT_OP(tir::MaxNode);
+  TVM_COUNT_FLOAT_OP(tir::CallNode);
+
+#undef TVM_COUNT_FLOAT_OP
+
+ private:
+  void Count() { cycles += multiplicity_ / std::min(parallel_, max_parallel_); }
+
+  double max_parallel_;
+  int64_t vector_lanes_;
+  double multiplicity_{1};
+  double parallel_{1};
+};
+
+double LatencyEstimatorNode::AnalyticLatency(const tir::PrimFunc& func, const Target& target) {
+  // The nominal hardware of the model: the clock of a lane, the number of parallel
+  // lanes, the lanes of a vector instruction and the memory bandwidth in bytes/s.
+  double clock, bandwidth, max_parallel;
+  int64_t vector_lanes;
+  if (target->kind->device_type == kDLCPU) {
+    clock = 2e9;
+    max_parallel = std::max(tvm::runtime::threading::MaxConcurrency(), 1);
+    vector_lanes = 8;
+    bandwidth = 2e10;
+  } else {
+    clock = 1.5e9;
+    max_parallel = 2560;
+    vector_lanes = 1;
+    bandwidth = 3e11;
+  }
+
+  LoopNestCounter counter(max_parallel, vector_lanes);
+  counter(func->body);
+
+  double bytes = 0;
+  for (const auto& it : func->buffer_map) {
+    double elems = 1;
+    for (const PrimExpr& dim : it.second->shape) {
+      if (const auto* imm = dim.as<IntImmNode>()) elems *= imm->value;
+    }
+    bytes += elems * it.second->dtype.bytes() * it.second->dtype.lanes();
+  }
+  return std::max(counter.cycles / clock, bytes / bandwidth);
+}
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimator").set_body_typed([](Array<String> log_files) {
+  return LatencyEstimator(log_files);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorGlobal").set_body_typed([]() {
+  return LatencyEstimator::Global();
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorLoadRecords")
+    .set_body_typed([](LatencyEstimator estimator, String filename) {
+      estimator->LoadRecords(filename);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorAddRecord")
+    .set_body_typed([](LatencyEstimator estimator, String workload_key, Target target,
+                       double latency) { estimator->AddRecord(workload_key, target, latency); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorSetCostModel")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      LatencyEstimator estimator = args[0];
+      estimator->cost_model = args[1].type_code() == kTVMNullptr ? PackedFunc() : args[1];
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorEstimate")
+    .set_body_typed([](LatencyEstimator estimator, tir::PrimFunc func, Target target) {
+      return estimator->EstimateLatency(func, target);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.LatencyEstimatorAnalytic")
+    .set_body_typed([](tir::PrimFunc func, Target target) {
+      return LatencyEstimatorNode::AnalyticLatency(func, target);
+    });
+
+}  // namespace auto_scheduler
+}  // namespace tvm
@@ -29,6 +29,7 @@
 #include <tvm/runtime/registry.h>
 #include <tvm/te/operation.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "utils.h"
@@ -107,6 +108,10 @@ void AttachMap::SetComputeAtIter(int stage_id, int target_stage_id, int target_i
 }
 
 void AttachMap::DeleteStage(int stage_id) {
+  // Keep sharing the map with the other states if the stage is not attached
+  if (!operator->()->stage_to_attach_iter.count(stage_id)) {
+    return;
+  }
   AttachMapNode* pnode = CopyOnWrite();
   // Delete the original stage entry
   DeleteStageEntry(pnode, stage_id);
@@ -115,6 +120,12 @@ void AttachMap::DeleteStage(int stage_id) {
 void AttachMap::UpdateIters(const std::vector<IterKey>& original_iters,
                             const std::vector<IterKey>& new_iters) {
   ICHECK_EQ(original_iters.size(), new_iters.size());
+  // Most iterators have no stage attached, keep sharing the map with the other states then
+  const auto& attached = operator->()->iter_to_attached_stages;
+  if (std::none_of(original_iters.begin(), original_iters.end(),
+                   [&attached](const IterKey& iter) { return attached.count(iter); })) {
+    return;
+  }
   AttachMapNode* pnode = CopyOnWrite();
   std::unordered_map<IterKey, std::vector<StageKey>> new_iter_to_attached_stages;
   for (size_t i = 0; i < original_iters.size(); ++i) {
@@ -204,9 +215,10 @@ State::State(const Array<te::Operation>& ops) {
 /********** Schedule primitives apis for state **********/
 Iterator State::bind(int stage_id, const Iterator& it, IteratorAnnotation thread_type) {
   const Stage& stage = operator->()->stages[stage_id];
-  if (thread_type < IteratorAnnotation::kVThread || thread_type > IteratorAnnotation::kThreadZ) {
+  if ((thread_type < IteratorAnnotation::kVThread || thread_type > IteratorAnnotation::kThreadZ) &&
+      thread_type != IteratorAnnotation::kCThread) {
     LOG(FATAL) << "thread_type error, valid: kVThread, kBlockX, kBlockY, "
-               << "kThreadX, kThreadY, kBlockZ, kThreadZ";
+               << "kThreadX, kThreadY, kBlockZ, kThreadZ, kCThread";
   }
   AnnotationStep step = AnnotationStep(stage_id, GetIndex(stage->iters, it), thread_type);
   CopyOnWrite()->transform_steps.push_back(step);
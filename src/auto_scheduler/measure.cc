@@ -23,9 +23,14 @@
  */
 
 #include <tvm/auto_scheduler/measure.h>
+#include <tvm/auto_scheduler/measure_record.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "search_policy/empty_policy.h"
 #include "search_policy/sketch_policy.h"
@@ -186,6 +191,21 @@ Array<MeasureResult> RPCRunnerNode::Run(const Array<MeasureInput>& inputs,
   return Array<MeasureResult>();
 }
 
+bool RPCRunnerNode::RunPipelined(const ProgramBuilder& builder, const Array<MeasureInput>& inputs,
+                                 const TypedPackedFunc<void(int, MeasureResult)>& on_result,
+                                 int verbose) {
+  // The builds are only pipelined with the runs when both are done by the python workers
+  const auto* local_builder = builder.as<LocalBuilderNode>();
+  const auto* f = runtime::Registry::Get("auto_scheduler.rpc_runner.pipeline");
+  if (local_builder == nullptr || f == nullptr) {
+    return false;
+  }
+  (*f)(inputs, on_result, local_builder->timeout, local_builder->n_parallel,
+       local_builder->build_func, key, host, port, priority, n_parallel, timeout, number, repeat,
+       min_repeat_ms, cooldown_interval, enable_cpu_cache_flush, verbose);
+  return true;
+}
+
 /********** MeasureCallback **********/
 PythonBasedMeasureCallback::PythonBasedMeasureCallback(PackedFunc callback_func) {
   auto node = make_object<PythonBasedMeasureCallbackNode>();
@@ -228,15 +248,60 @@ void ProgramMeasurerNode::Reset() {
   has_valid.clear();
 }
 
+// Whether a result stays the same when the program is measured again: the successes, and the
+// failures of the build. The runtime errors and timeouts may come from a busy device.
+static bool IsCacheable(const MeasureResult& result) {
+  switch (static_cast<MeasureErrorNO>(result->error_no)) {
+    case MeasureErrorNO::kNoError:
+    case MeasureErrorNO::kInstantiationError:
+    case MeasureErrorNO::kCompileHostError:
+    case MeasureErrorNO::kCompileDeviceError:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Add a result to the cache, a success replacing a known failure of the same program.
+static void AddToCache(std::unordered_map<std::string, MeasureResult>* cache,
+                       const std::string& key, const MeasureResult& result) {
+  if (!IsCacheable(result)) return;
+  auto it = cache->find(key);
+  if (it == cache->end()) {
+    cache->emplace(key, result);
+  } else if (it->second->error_no != 0 && result->error_no == 0) {
+    it->second = result;
+  }
+}
+
+std::string ProgramMeasurerNode::MeasureCacheKey(const MeasureInput& input) {
+  std::ostringstream os;
+  os << input->task->workload_key << "\n" << input->task->target->str() << "\n";
+  if (input->task->target_host.defined()) {
+    os << input->task->target_host->str();
+  }
+  os << "\n" << ComputeDAG::SerializeSteps(input->state->transform_steps);
+  return os.str();
+}
+
+int ProgramMeasurerNode::LoadCache(const String& filename) {
+  auto records = ReadRecordFile(filename);
+  int added = 0;
+  for (size_t i = 0; i < records.first.size(); ++i) {
+    if (IsCacheable(records.second[i])) {
+      AddToCache(&measure_cache, MeasureCacheKey(records.first[i]), records.second[i]);
+      added++;
+    }
+  }
+  return added;
+}
+
 Array<MeasureResult> ProgramMeasurerNode::Measure(const SearchTask& task,
                                                   const SearchPolicy& policy,
                                                   const Array<MeasureInput>& inputs,
                                                   int batch_size) {
   auto t_begin = std::chrono::high_resolution_clock::now();
 
-  Array<MeasureResult> results;
-  results.reserve(inputs.size());
-
   if (batch_size == -1) {
     // set default batch size
     batch_size = builder->n_parallel * 2;
@@ -246,43 +311,36 @@ Array<MeasureResult> ProgramMeasurerNode::Measure(const SearchTask& task,
 
   StdCout(verbose) << "Get " << inputs.size() << " programs to measure:" << std::endl;
 
-  for (size_t i = 0; i < inputs.size(); i += batch_size) {
-    Array<MeasureInput> input_batch(inputs.begin() + i,
-                                    inputs.begin() + std::min(i + batch_size, inputs.size()));
-    Array<MeasureResult> result_batch;
-
-    // build and run
-    SilentMeasure(task, input_batch, &result_batch);
-
-    // update current best state according to the new measure result
-    for (size_t j = 0; j < input_batch.size(); ++j) {
-      const String& workload_key = input_batch[j]->task->workload_key;
-      double flops;
-
-      if (result_batch[j]->error_no == 0) {
-        flops = task->compute_dag->flop_ct / FloatArrayMean(result_batch[j]->costs);
-        error_ct = 0;
-        has_valid.insert(workload_key);
-      } else {
-        flops = 0.0;
-        error_ct++;
-      }
-
-      if (flops > best_flops[workload_key]) {
-        best_flops[workload_key] = flops;
-        best_state[workload_key] = input_batch[j]->state;
-        best_ct[workload_key] = ct;
-      }
-
-      ct++;
-      StdCout(verbose, 2) << std::fixed << std::setprecision(2) << Chars('=', 50) << "\n"
-                          << "No: " << ct << "\tGFLOPS: " << flops / 1e9 << " / "
-                          << best_flops[workload_key] / 1e9 << "\tresults: " << result_batch[j]
-                          << "\n"
-                          << Chars('=', 50) << "\n"
-                          << input_batch[j]->state << "\n";
+  // The programs measured before take their known result, the duplicates of this call are
+  // measured once
+  std::vector<MeasureResult> ordered_results(inputs.size());
+  std::vector<std::string> keys(inputs.size());
+  std::unordered_map<std::string, int> first_index;
+  std::vector<int> duplicates;
+  Array<MeasureInput> new_inputs;
+  std::vector<int> new_indices;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    keys[i] = MeasureCacheKey(inputs[i]);
+    auto it = measure_cache.find(keys[i]);
+    if (it != measure_cache.end()) {
+      ordered_results[i] = it->second;
+      UpdateBest(task, inputs[i], it->second);
+    } else if (!first_index.emplace(keys[i], i).second) {
+      duplicates.push_back(i);
+    } else {
+      new_inputs.push_back(inputs[i]);
+      new_indices.push_back(i);
     }
+  }
+  if (new_inputs.size() < inputs.size()) {
+    StdCout(verbose) << "Skip " << inputs.size() - new_inputs.size()
+                     << " programs measured before." << std::endl;
+  }
 
+  // The results go to the callbacks in batches, in the order they finish
+  Array<MeasureInput> input_batch;
+  Array<MeasureResult> result_batch;
+  auto flush_batch = [&]() {
     // Call callback functions
     if (callbacks) {
       for (const auto& callback : callbacks.value()) {
@@ -290,11 +348,6 @@ Array<MeasureResult> ProgramMeasurerNode::Measure(const SearchTask& task,
       }
     }
 
-    // Store result batch
-    for (auto& res : result_batch) {
-      results.push_back(res);
-    }
-
     if (error_ct > max_continuous_error) {
       LOG(WARNING) << "Too many errors happened during tuning. Switching to debug mode."
                    << std::endl;
@@ -302,6 +355,56 @@ Array<MeasureResult> ProgramMeasurerNode::Measure(const SearchTask& task,
     } else {
       verbose = old_verbosity;
     }
+    input_batch.clear();
+    result_batch.clear();
+  };
+
+  auto on_result = [&](int new_index, MeasureResult result) {
+    ICHECK(new_index >= 0 && new_index < static_cast<int>(new_inputs.size()) &&
+           !ordered_results[new_indices[new_index]].defined())
+        << "Unexpected result of input " << new_index;
+    int index = new_indices[new_index];
+    // update current best state according to the new measure result
+    UpdateBest(task, inputs[index], result);
+    AddToCache(&measure_cache, keys[index], result);
+    ordered_results[index] = result;
+    input_batch.push_back(inputs[index]);
+    result_batch.push_back(result);
+    if (static_cast<int>(input_batch.size()) >= batch_size) {
+      flush_batch();
+    }
+  };
+
+  // Keep the builds and runs in flight together when the runner can, otherwise build and run
+  // one batch at a time
+  if (!new_inputs.empty() &&
+      !runner->RunPipelined(builder, new_inputs,
+                            TypedPackedFunc<void(int, MeasureResult)>(on_result), verbose)) {
+    for (size_t i = 0; i < new_inputs.size(); i += batch_size) {
+      Array<MeasureInput> inputs_slice(
+          new_inputs.begin() + i, new_inputs.begin() + std::min(i + batch_size, new_inputs.size()));
+      Array<MeasureResult> results_slice;
+
+      // build and run
+      SilentMeasure(task, inputs_slice, &results_slice);
+
+      for (size_t j = 0; j < inputs_slice.size(); ++j) {
+        on_result(i + j, results_slice[j]);
+      }
+    }
+  }
+  if (!input_batch.empty()) {
+    flush_batch();
+  }
+  for (int i : duplicates) {
+    ordered_results[i] = ordered_results[first_index.at(keys[i])];
+  }
+
+  Array<MeasureResult> results;
+  results.reserve(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    ICHECK(ordered_results[i].defined()) << "Input " << i << " was not measured";
+    results.push_back(ordered_results[i]);
   }
 
   PrintTimeElapsed(t_begin, "measurement", verbose);
@@ -309,6 +412,34 @@ Array<MeasureResult> ProgramMeasurerNode::Measure(const SearchTask& task,
   return results;
 }
 
+void ProgramMeasurerNode::UpdateBest(const SearchTask& task, const MeasureInput& input,
+                                     const MeasureResult& result) {
+  const String& workload_key = input->task->workload_key;
+  double flops;
+
+  if (result->error_no == 0) {
+    flops = task->compute_dag->flop_ct / FloatArrayMean(result->costs);
+    error_ct = 0;
+    has_valid.insert(workload_key);
+  } else {
+    flops = 0.0;
+    error_ct++;
+  }
+
+  if (flops > best_flops[workload_key]) {
+    best_flops[workload_key] = flops;
+    best_state[workload_key] = input->state;
+    best_ct[workload_key] = ct;
+  }
+
+  ct++;
+  StdCout(verbose, 2) << std::fixed << std::setprecision(2) << Chars('=', 50) << "\n"
+                      << "No: " << ct << "\tGFLOPS: " << flops / 1e9 << " / "
+                      << best_flops[workload_key] / 1e9 << "\tresults: " << result << "\n"
+                      << Chars('=', 50) << "\n"
+                      << input->state << "\n";
+}
+
 void ProgramMeasurerNode::SilentMeasure(const SearchTask& task, const Array<MeasureInput>& inputs,
                                         Array<MeasureResult>* results) {
   results->clear();
@@ -393,6 +524,17 @@ TVM_REGISTER_GLOBAL("auto_scheduler.ProgramMeasurer")
       return ProgramMeasurer(builder, runner, callbacks, verbose, max_continuous_error);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.ProgramMeasurerLoadCache")
+    .set_body_typed([](ProgramMeasurer measurer, String filename) {
+      return measurer->LoadCache(filename);
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ProgramMeasurerMeasure")
+    .set_body_typed([](ProgramMeasurer measurer, SearchTask task, SearchPolicy policy,
+                       Array<MeasureInput> inputs, int batch_size) {
+      return measurer->Measure(task, policy, inputs, batch_size);
+    });
+
 TVM_REGISTER_GLOBAL("auto_scheduler.ProgramBuilderBuild")
     .set_body_typed([](const ProgramBuilder& builder, const Array<MeasureInput>& inputs,
                        int verbose) { return builder->Build(inputs, verbose); });
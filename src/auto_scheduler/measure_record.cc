@@ -28,6 +28,14 @@
 #include <tvm/auto_scheduler/transform_step.h>
 #include <tvm/runtime/registry.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -309,6 +317,8 @@ namespace auto_scheduler {
 
 TVM_REGISTER_OBJECT_TYPE(RecordToFileNode);
 TVM_REGISTER_OBJECT_TYPE(RecordReaderNode);
+TVM_REGISTER_OBJECT_TYPE(RecordStoreNode);
+TVM_REGISTER_OBJECT_TYPE(RecordToStoreNode);
 
 RecordToFile::RecordToFile(String filename) {
   auto node = make_object<RecordToFileNode>();
@@ -403,6 +413,361 @@ std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordReaderNode::ReadLines
   return std::make_pair(inputs, results);
 }
 
+/********** RecordStore **********/
+
+/*
+ * The record file is the header below, then a sequence of
+ *   { uint32 kRecordMagic; uint32 length; char record[length]; }
+ * where the record is a line of the json log format. The index file is a sequence of
+ *   { uint32 kRecordMagic; uint32 key_length; char key[key_length]; double cost; uint64 offset; }
+ * where the key is "workload_key\ntarget" and the offset is the one of a record. Both are in
+ * the byte order of the host.
+ */
+static const char kStoreHeader[8] = {'T', 'V', 'M', 'R', 'S', 'T', '0', '1'};
+static constexpr uint32_t kRecordMagic = 0x54565252;
+
+/*! \brief An exclusive lock of a file across processes, held in its scope. */
+class StoreFileLock {
+ public:
+  explicit StoreFileLock(const std::string& path) {
+#ifndef _WIN32
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ >= 0) flock(fd_, LOCK_EX);
+#endif
+  }
+  ~StoreFileLock() {
+#ifndef _WIN32
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif
+  }
+
+ private:
+  int fd_{-1};
+};
+
+static uint64_t FileSize(const std::string& path) {
+  std::ifstream ifs(path, std::ifstream::binary | std::ifstream::ate);
+  return ifs.good() ? static_cast<uint64_t>(ifs.tellg()) : 0;
+}
+
+template <typename T>
+static bool ReadPod(std::istream* is, T* value) {
+  return static_cast<bool>(is->read(reinterpret_cast<char*>(value), sizeof(T)));
+}
+
+template <typename T>
+static void WritePod(std::ostream* os, T value) {
+  os->write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/*! \brief Read the next record of a record file, false at its end or at a torn record. */
+static bool ReadStoreRecord(std::istream* is, std::string* record) {
+  uint32_t magic, length;
+  if (!ReadPod(is, &magic) || !ReadPod(is, &length) || magic != kRecordMagic) return false;
+  record->resize(length);
+  return static_cast<bool>(is->read(&(*record)[0], length));
+}
+
+/*! \brief Read the next entry of an index file, false at its end or at a torn entry. */
+static bool ReadIndexEntry(std::istream* is, std::string* key, double* cost, uint64_t* offset) {
+  uint32_t magic, length;
+  if (!ReadPod(is, &magic) || magic != kRecordMagic || !ReadPod(is, &length)) return false;
+  key->resize(length);
+  return is->read(&(*key)[0], length) && ReadPod(is, cost) && ReadPod(is, offset);
+}
+
+/*! \brief The end of the whole records of a record file, reading from a record at begin. */
+static uint64_t WholeRecordsEnd(const std::string& path, uint64_t begin) {
+  std::ifstream ifs(path, std::ifstream::binary);
+  ifs.seekg(begin);
+  std::string record;
+  uint64_t end = begin;
+  while (ReadStoreRecord(&ifs, &record)) {
+    end += 2 * sizeof(uint32_t) + record.size();
+  }
+  return end;
+}
+
+/*! \brief The end of the whole entries of an index file, reading from an entry at begin. */
+static uint64_t WholeIndexEnd(const std::string& path, uint64_t begin) {
+  std::ifstream ifs(path, std::ifstream::binary);
+  ifs.seekg(begin);
+  std::string key;
+  double cost;
+  uint64_t offset, end = begin;
+  while (ReadIndexEntry(&ifs, &key, &cost, &offset)) {
+    end += 2 * sizeof(uint32_t) + key.size() + sizeof(double) + sizeof(uint64_t);
+  }
+  return end;
+}
+
+/*! \brief Cut the bytes of a file after size. */
+static void TruncateFile(const std::string& path, uint64_t size) {
+#ifndef _WIN32
+  ICHECK_EQ(truncate(path.c_str(), static_cast<off_t>(size)), 0) << "Cannot truncate " << path;
+#endif
+}
+
+/*! \brief The index key of a record, and whether it is a successful one with a cost. */
+static bool RecordIndexKey(const MeasureInputNode* inp, const MeasureResultNode* res,
+                           std::string* key, double* cost) {
+  if (res->error_no != 0 || res->costs.empty()) return false;
+  *key = std::string(inp->task->workload_key) + "\n" + std::string(inp->task->target->str());
+  *cost = FloatArrayMean(res->costs);
+  return true;
+}
+
+/*! \brief The index key of the target kind of an index key. */
+static std::string KindIndexKey(const std::string& key) {
+  size_t target_begin = key.find('\n') + 1;
+  size_t kind_end = key.find(' ', target_begin);
+  return key.substr(0, kind_end == std::string::npos ? key.size() : kind_end);
+}
+
+RecordStore::RecordStore(String path) {
+  auto node = make_object<RecordStoreNode>();
+  node->path = path;
+  {
+    StoreFileLock lock(path);
+    if (FileSize(path) == 0) {
+      std::ofstream ofs(path, std::ofstream::binary | std::ofstream::app);
+      ofs.write(kStoreHeader, sizeof(kStoreHeader));
+    }
+  }
+  ICHECK(IsRecordStore(path)) << path << " is not a record store";
+  node->Reload();
+  data_ = std::move(node);
+}
+
+bool RecordStore::IsRecordStore(const String& path) {
+  std::ifstream ifs(path, std::ifstream::binary);
+  char header[sizeof(kStoreHeader)];
+  return ifs.read(header, sizeof(header)) && memcmp(header, kStoreHeader, sizeof(header)) == 0;
+}
+
+void RecordStoreNode::AddIndexEntry(const std::string& key, IndexEntry entry) {
+  auto it = best_by_target_.find(key);
+  if (it == best_by_target_.end() || entry.cost < it->second.cost) {
+    best_by_target_[key] = entry;
+  }
+  std::string kind_key = KindIndexKey(key);
+  it = best_by_kind_.find(kind_key);
+  if (it == best_by_kind_.end() || entry.cost < it->second.cost) {
+    best_by_kind_[kind_key] = entry;
+  }
+}
+
+void RecordStoreNode::RepairTail() {
+  std::string index_path = std::string(path) + ".idx";
+  uint64_t size = FileSize(path);
+  ICHECK_GE(size, sizeof(kStoreHeader));
+  // The files hold whole records up to the checked sizes, the other writers only append to them.
+  // A file smaller than its checked size was replaced, e.g. an index removed and rebuilt.
+  if (records_checked_size_ > size) records_checked_size_ = 0;
+  records_checked_size_ =
+      WholeRecordsEnd(path, std::max<uint64_t>(records_checked_size_, sizeof(kStoreHeader)));
+  if (records_checked_size_ < size) {
+    LOG(WARNING) << "Removing " << size - records_checked_size_ << " bytes of a torn record at "
+                 << "the end of " << path;
+    TruncateFile(path, records_checked_size_);
+  }
+  uint64_t index_size = FileSize(index_path);
+  if (index_checked_size_ > index_size) index_checked_size_ = 0;
+  index_checked_size_ = WholeIndexEnd(index_path, index_checked_size_);
+  if (index_checked_size_ < index_size) {
+    LOG(WARNING) << "Removing " << index_size - index_checked_size_ << " bytes of a torn entry "
+                 << "at the end of " << index_path;
+    TruncateFile(index_path, index_checked_size_);
+  }
+}
+
+void RecordStoreNode::Append(const Array<MeasureInput>& inputs,
+                             const Array<MeasureResult>& results) {
+  ICHECK_EQ(inputs.size(), results.size());
+  StoreFileLock lock(path);
+  // A writer killed while appending leaves a torn tail, which would hide the following records.
+  RepairTail();
+  uint64_t offset = FileSize(path);
+
+  std::ostringstream index;
+  {
+    std::ofstream ofs(path, std::ofstream::binary | std::ofstream::app);
+    std::string key;
+    double cost;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      std::ostringstream os;
+      WriteMeasureRecords(&os, {inputs[i]}, {results[i]});
+      std::string record = os.str();
+      record.pop_back();  // the newline
+      WritePod(&ofs, kRecordMagic);
+      WritePod(&ofs, static_cast<uint32_t>(record.size()));
+      ofs.write(record.data(), record.size());
+
+      if (RecordIndexKey(inputs[i].get(), results[i].get(), &key, &cost)) {
+        auto it = best_by_target_.find(key);
+        if (it == best_by_target_.end() || cost < it->second.cost) {
+          WritePod(&index, kRecordMagic);
+          WritePod(&index, static_cast<uint32_t>(key.size()));
+          index.write(key.data(), key.size());
+          WritePod(&index, cost);
+          WritePod(&index, offset);
+          AddIndexEntry(key, {cost, offset});
+        }
+      }
+      offset += 2 * sizeof(uint32_t) + record.size();
+    }
+  }
+  records_checked_size_ = offset;
+  // The index entries only point at the records written before them.
+  std::ofstream idx(std::string(path) + ".idx", std::ofstream::binary | std::ofstream::app);
+  idx << index.str();
+  index_checked_size_ += index.str().size();
+}
+
+void RecordStoreNode::RebuildIndex() {
+  StoreFileLock lock(path);
+  std::string index_path = std::string(path) + ".idx";
+  if (FileSize(index_path) != 0) return;
+
+  std::ifstream ifs(path, std::ifstream::binary);
+  ifs.seekg(sizeof(kStoreHeader));
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  std::unordered_map<std::string, IndexEntry> best;
+  std::string record, key, log_version;
+  double cost;
+  uint64_t offset = sizeof(kStoreHeader);
+  while (ReadStoreRecord(&ifs, &record)) {
+    ReadMeasureRecord(record, inp.get(), res.get(), &log_version);
+    if (RecordIndexKey(inp.get(), res.get(), &key, &cost)) {
+      auto it = best.find(key);
+      if (it == best.end() || cost < it->second.cost) {
+        best[key] = {cost, offset};
+      }
+    }
+    offset += 2 * sizeof(uint32_t) + record.size();
+  }
+
+  std::ofstream idx(index_path, std::ofstream::binary | std::ofstream::trunc);
+  for (const auto& kv : best) {
+    WritePod(&idx, kRecordMagic);
+    WritePod(&idx, static_cast<uint32_t>(kv.first.size()));
+    idx.write(kv.first.data(), kv.first.size());
+    WritePod(&idx, kv.second.cost);
+    WritePod(&idx, kv.second.offset);
+  }
+}
+
+void RecordStoreNode::Reload() {
+  std::string index_path = std::string(path) + ".idx";
+  uint64_t data_size = FileSize(path);
+  if (index_read_size_ == 0 && FileSize(index_path) == 0 && data_size > sizeof(kStoreHeader)) {
+    RebuildIndex();
+  }
+
+  std::ifstream ifs(index_path, std::ifstream::binary);
+  ifs.seekg(index_read_size_);
+  std::string key;
+  IndexEntry entry;
+  while (ReadIndexEntry(&ifs, &key, &entry.cost, &entry.offset)) {
+    // Stop at the entries of the records being written, they are read by the next reload.
+    if (entry.offset >= data_size) break;
+    index_read_size_ += 2 * sizeof(uint32_t) + key.size() + sizeof(double) + sizeof(uint64_t);
+    AddIndexEntry(key, entry);
+  }
+}
+
+bool RecordStoreNode::ReadRecordAt(uint64_t offset, MeasureInputNode* inp,
+                                   MeasureResultNode* res) {
+  std::ifstream ifs(path, std::ifstream::binary);
+  ifs.seekg(offset);
+  std::string record, log_version;
+  if (!ReadStoreRecord(&ifs, &record)) return false;
+  ReadMeasureRecord(record, inp, res, &log_version);
+  return true;
+}
+
+bool RecordStoreNode::BestRecord(const String& workload_key, const Target& target,
+                                 MeasureInputNode* inp, MeasureResultNode* res) {
+  std::string key = std::string(workload_key) + "\n" + std::string(target->str());
+  auto it = best_by_target_.find(key);
+  if (it == best_by_target_.end()) {
+    it = best_by_kind_.find(std::string(workload_key) + "\n" + std::string(target->kind->name));
+    if (it == best_by_kind_.end()) return false;
+  }
+  return ReadRecordAt(it->second.offset, inp, res);
+}
+
+std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordStoreNode::BestRecords() {
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  for (const auto& kv : best_by_target_) {
+    if (ReadRecordAt(kv.second.offset, inp.get(), res.get())) {
+      inputs.push_back(inp->copy());
+      results.push_back(res->copy());
+    }
+  }
+  return std::make_pair(inputs, results);
+}
+
+std::pair<Array<MeasureInput>, Array<MeasureResult>> RecordStoreNode::ReadAll() {
+  Array<MeasureInput> inputs;
+  Array<MeasureResult> results;
+  auto inp = make_object<MeasureInputNode>();
+  auto res = make_object<MeasureResultNode>();
+  std::ifstream ifs(path, std::ifstream::binary);
+  ifs.seekg(sizeof(kStoreHeader));
+  std::string record, log_version;
+  while (ReadStoreRecord(&ifs, &record)) {
+    ReadMeasureRecord(record, inp.get(), res.get(), &log_version);
+    inputs.push_back(inp->copy());
+    results.push_back(res->copy());
+  }
+  return std::make_pair(inputs, results);
+}
+
+RecordToStore::RecordToStore(String path) {
+  auto node = make_object<RecordToStoreNode>();
+  node->store = RecordStore(path);
+  data_ = std::move(node);
+}
+
+void RecordToStoreNode::Callback(const SearchPolicy& policy, const Array<MeasureInput>& inputs,
+                                 const Array<MeasureResult>& results) {
+  store->Append(inputs, results);
+}
+
+std::pair<Array<MeasureInput>, Array<MeasureResult>> ReadRecordFile(const String& filename) {
+  if (RecordStore::IsRecordStore(filename)) {
+    return RecordStore(filename)->ReadAll();
+  }
+  return RecordReader(filename)->ReadLines(-1);
+}
+
+void ConvertRecordsToStore(const String& log_file, const RecordStore& store) {
+  RecordReader reader(log_file);
+  while (true) {
+    const auto& res = reader->ReadLines(4096);
+    if (res.first.empty()) break;
+    store->Append(res.first, res.second);
+  }
+}
+
+void ConvertStoreToRecords(const RecordStore& store, const String& log_file) {
+  std::ifstream ifs(store->path, std::ifstream::binary);
+  ifs.seekg(sizeof(kStoreHeader));
+  std::ofstream ofs(log_file, std::ofstream::app);
+  std::string record;
+  while (ReadStoreRecord(&ifs, &record)) {
+    ofs << record << "\n";
+  }
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.RecordToFile").set_body_typed([](const String& filename) {
   return RecordToFile(filename);
 });
@@ -450,6 +815,50 @@ TVM_REGISTER_GLOBAL("auto_scheduler.SaveRecords")
       WriteMeasureRecords(&ofs, in, res);
     });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStore").set_body_typed([](const String& path) {
+  return RecordStore(path);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.IsRecordStore").set_body_typed(RecordStore::IsRecordStore);
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStoreAppend")
+    .set_body_typed([](RecordStore store, Array<MeasureInput> inputs,
+                       Array<MeasureResult> results) { store->Append(inputs, results); });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStoreBestRecord")
+    .set_body_typed([](RecordStore store, String workload_key, Target target) {
+      auto inp = make_object<MeasureInputNode>();
+      auto res = make_object<MeasureResultNode>();
+      if (store->BestRecord(workload_key, target, inp.get(), res.get())) {
+        return Array<ObjectRef>{ObjectRef(inp), ObjectRef(res)};
+      }
+      return Array<ObjectRef>();
+    });
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStoreBestRecords").set_body_typed([](RecordStore store) {
+  const auto& res = store->BestRecords();
+  return Array<ObjectRef>{res.first, res.second};
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStoreReadAll").set_body_typed([](RecordStore store) {
+  const auto& res = store->ReadAll();
+  return Array<ObjectRef>{res.first, res.second};
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordStoreReload").set_body_typed([](RecordStore store) {
+  store->Reload();
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.RecordToStore").set_body_typed([](const String& path) {
+  return RecordToStore(path);
+});
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ConvertRecordsToStore")
+    .set_body_typed(ConvertRecordsToStore);
+
+TVM_REGISTER_GLOBAL("auto_scheduler.ConvertStoreToRecords")
+    .set_body_typed(ConvertStoreToRecords);
+
 TVM_REGISTER_GLOBAL("auto_scheduler.SerializeMeasureInput")
     .set_body_typed([](const MeasureInput& input) {
       std::ostringstream os;
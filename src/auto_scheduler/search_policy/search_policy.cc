@@ -26,6 +26,14 @@
 #include <tvm/auto_scheduler/search_policy.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <tuple>
+#include <vector>
+
 #include "utils.h"
 
 namespace tvm {
@@ -34,10 +42,10 @@ namespace auto_scheduler {
 TVM_REGISTER_OBJECT_TYPE(SearchCallbackNode);
 TVM_REGISTER_OBJECT_TYPE(SearchPolicyNode);
 TVM_REGISTER_OBJECT_TYPE(PreloadMeasuredStatesNode);
+TVM_REGISTER_OBJECT_TYPE(PreloadSimilarTaskStatesNode);
 
 void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
-  RecordReader reader = RecordReader(log_file);
-  const auto& res = reader->ReadLines(-1);
+  const auto& res = ReadRecordFile(log_file);
   size_t log_size = res.first.size();
   ICHECK_EQ(log_size, res.second.size());
   if (log_size) {
@@ -81,6 +89,145 @@ void SearchPolicyNode::PreloadMeasuredStates(const String& log_file) {
   }
 }
 
+/*!
+ * \brief Split a workload key into its op type, i.e. the key with the numbers left out,
+ * and its numbers, e.g. the shapes.
+ */
+static void SplitWorkloadKey(const std::string& key, std::string* op_type,
+                             std::vector<double>* numbers) {
+  op_type->clear();
+  numbers->clear();
+  size_t i = 0;
+  while (i < key.size()) {
+    char c = key[i];
+    if (c == '"') {
+      // The strings, e.g. the function name, the hash of the compute DAG or the dtypes.
+      size_t end = key.find('"', i + 1);
+      end = end == std::string::npos ? key.size() : end + 1;
+      op_type->append(key, i, end - i);
+      i = end;
+    } else if (std::isdigit(static_cast<unsigned char>(c)) || c == '-' || c == '.') {
+      size_t end = i + 1;
+      while (end < key.size() && (std::isdigit(static_cast<unsigned char>(key[end])) ||
+                                  key[end] == '.' || key[end] == 'e' || key[end] == '-')) {
+        end++;
+      }
+      numbers->push_back(std::strtod(key.c_str() + i, nullptr));
+      op_type->push_back('#');
+      i = end;
+    } else {
+      if (!std::isspace(static_cast<unsigned char>(c))) op_type->push_back(c);
+      i++;
+    }
+  }
+}
+
+/*! \brief The distance between the shapes of two workloads of the same op type. */
+static double WorkloadDistance(const std::vector<double>& a, const std::vector<double>& b) {
+  double dist = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    dist += std::abs(std::log1p(std::abs(a[i])) - std::log1p(std::abs(b[i])));
+  }
+  return dist;
+}
+
+/*!
+ * \brief The largest split lengths fitting an extent, each no longer than the lengths of
+ * the other shape, so the adapted tiles divide the new extent.
+ */
+static Array<Optional<Integer>> FitSplitLengths(const Array<Optional<Integer>>& lengths,
+                                                int64_t extent, bool inner_to_outer) {
+  std::vector<Optional<Integer>> ret(lengths.begin(), lengths.end());
+  int64_t remain = extent;
+  for (size_t k = 0; k < ret.size(); ++k) {
+    // Fit the tiles next to the split iterator first, they matter most, e.g. the vector lanes.
+    size_t i = inner_to_outer ? ret.size() - 1 - k : k;
+    int64_t len = std::max<int64_t>(1, std::min<int64_t>(ret[i].value()->value, remain));
+    while (remain % len != 0) len--;
+    ret[i] = Integer(static_cast<int>(len));
+    remain /= len;
+  }
+  return Array<Optional<Integer>>(ret.begin(), ret.end());
+}
+
+/*!
+ * \brief Replay the steps of a state of a similar task on a compute DAG, fitting the split
+ * lengths to the extents of the DAG.
+ */
+static State AdaptStateToDAG(const Array<Step>& steps, const ComputeDAG& dag) {
+  State state = dag->init_state;
+  for (Step step : steps) {
+    if (auto ps = step.as<SplitStepNode>()) {
+      const Iterator& it = state->stages[ps->stage_id]->iters[ps->iter_id];
+      bool known_lengths = std::all_of(ps->lengths.begin(), ps->lengths.end(),
+                                       [](const Optional<Integer>& l) { return l.defined(); });
+      if (it->range.defined() && it->range->extent->IsInstance<IntImmNode>() && known_lengths) {
+        int64_t extent = GetIntImm(it->range->extent);
+        step = SplitStep(ps->stage_id, ps->iter_id, it->range->extent,
+                         FitSplitLengths(ps->lengths, extent, ps->inner_to_outer),
+                         ps->inner_to_outer);
+      }
+    }
+    state.CopyOnWrite()->transform_steps.push_back(step);
+    StepApplyToState(step, &state, dag);
+  }
+  return state;
+}
+
+void SearchPolicyNode::PreloadSimilarTaskStates(const String& log_file, int max_states) {
+  const auto& res = ReadRecordFile(log_file);
+  ICHECK_EQ(res.first.size(), res.second.size());
+
+  std::string op_type, other_op_type;
+  std::vector<double> shape, other_shape;
+  SplitWorkloadKey(search_task->workload_key, &op_type, &shape);
+
+  // (distance, -throughput, record index) of the successful records of the similar tasks
+  std::vector<std::tuple<double, double, size_t>> candidates;
+  for (size_t i = 0; i < res.first.size(); i++) {
+    const auto& inp = res.first[i];
+    const auto& result = res.second[i];
+    if (inp->task->workload_key == search_task->workload_key || result->error_no != 0 ||
+        inp->task->target->kind->name.compare(search_task->target->kind->name) != 0) {
+      continue;
+    }
+    SplitWorkloadKey(inp->task->workload_key, &other_op_type, &other_shape);
+    if (other_op_type != op_type || other_shape.size() != shape.size()) {
+      continue;
+    }
+    candidates.emplace_back(WorkloadDistance(shape, other_shape),
+                            -1.0 / FloatArrayMean(result->costs), i);
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  Array<State> adapted;
+  for (const auto& candidate : candidates) {
+    if (static_cast<int>(adapted.size()) >= max_states * 2) break;
+    try {
+      adapted.push_back(AdaptStateToDAG(res.first[std::get<2>(candidate)]->state->transform_steps,
+                                        search_task->compute_dag));
+    } catch (Error& e) {
+      // The steps do not fit the current task.
+    }
+  }
+  adapted = search_task->compute_dag.InferBound(adapted);
+
+  std::unordered_set<std::string> added;
+  size_t n_loaded = 0;
+  for (const State& state : adapted) {
+    if (static_cast<int>(n_loaded) >= max_states) break;
+    if (!state.defined()) continue;
+    std::string state_str = state.ToStr();
+    if (measured_states_set_.count(state_str) || !added.insert(state_str).second) continue;
+    warm_start_states_.push_back(state);
+    n_loaded++;
+  }
+
+  StdCout(verbose) << "SearchPolicy: Loaded " << n_loaded << " states of " << candidates.size()
+                   << " measurement records of similar tasks from " << log_file << " for "
+                   << search_task->workload_key << std::endl;
+}
+
 void SearchPolicyNode::RunCallbacks(const Array<SearchCallback>& callbacks) {
   for (const auto& callback : callbacks) {
     callback->Callback(this);
@@ -97,6 +244,17 @@ void PreloadMeasuredStatesNode::Callback(SearchPolicyNode* policy) {
   policy->PreloadMeasuredStates(filename);
 }
 
+PreloadSimilarTaskStates::PreloadSimilarTaskStates(String filename, int max_states) {
+  auto node = make_object<PreloadSimilarTaskStatesNode>();
+  node->filename = std::move(filename);
+  node->max_states = max_states;
+  data_ = std::move(node);
+}
+
+void PreloadSimilarTaskStatesNode::Callback(SearchPolicyNode* policy) {
+  policy->PreloadSimilarTaskStates(filename, max_states);
+}
+
 TVM_REGISTER_GLOBAL("auto_scheduler.SearchPolicyRunCallbacks")
     .set_body_typed([](SearchPolicy policy, Optional<Array<SearchCallback>> callbacks) {
       if (callbacks) {
@@ -119,5 +277,10 @@ TVM_REGISTER_GLOBAL("auto_scheduler.PreloadMeasuredStates").set_body_typed([](St
   return PreloadMeasuredStates(filename);
 });
 
+TVM_REGISTER_GLOBAL("auto_scheduler.PreloadSimilarTaskStates")
+    .set_body_typed([](String filename, int max_states) {
+      return PreloadSimilarTaskStates(filename, max_states);
+    });
+
 }  // namespace auto_scheduler
 }  // namespace tvm
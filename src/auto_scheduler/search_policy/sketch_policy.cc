@@ -57,6 +57,8 @@ static RuleAddRfactor rule_add_rfactor;
 static RuleCrossThreadReduction rule_cross_thread_reduction;
 static RuleSimplifyComputeWithConstTensor rule_simplify_compute_with_const_tensor;
 static RuleSpecialComputeLocationGPU rule_special_compute_location_gpu;
+static RuleVTAGemm rule_vta_gemm;
+static RuleCPUTensorize rule_cpu_tensorize;
 
 /********** Init population rules **********/
 static InitFillTileSize init_fill_tile_size;
@@ -86,6 +88,8 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel program_cost_model,
     // Candidates:
     // - auto_scheduler.PreloadMeasuredStates: Load already measured states to
     //   `measured_states_set_`, `measured_states_vector_` and `measured_states_throughputs_`.
+    // - auto_scheduler.PreloadSimilarTaskStates: Load the states of similar tasks, adapted to
+    //   this task, to `warm_start_states_`.
     // - auto_scheduler.PreloadCustomSketchRule: Add user custom sketch rules to `sketch_rules`,
     //   these rules will be processed prior to the default rules.
     node->RunCallbacks(init_search_callbacks.value());
@@ -97,6 +101,7 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel program_cost_model,
     // Sketch Generation Rules
     node->sketch_rules.push_back(&rule_always_inline);
     node->sketch_rules.push_back(&rule_simplify_compute_with_const_tensor);
+    node->sketch_rules.push_back(&rule_cpu_tensorize);
     node->sketch_rules.push_back(&rule_add_rfactor);
     node->sketch_rules.push_back(&rule_add_cache_write_stage);
     node->sketch_rules.push_back(&rule_multi_level_tiling_with_fusion);
@@ -149,6 +154,16 @@ SketchPolicy::SketchPolicy(SearchTask task, CostModel program_cost_model,
     // Mutation Rules for Evolutionary Search
     node->mutation_rules.push_back(std::make_shared<MutateTileSize>(0.90));
     node->mutation_rules.push_back(std::make_shared<MutateAutoUnroll>(0.10));
+  } else if (IsVTATask(node->search_task)) {
+    // Sketch Generation Rules
+    node->sketch_rules.push_back(&rule_vta_gemm);
+    node->sketch_rules.push_back(&rule_skip_stage);
+
+    // Initial Population Generation Rules
+    node->init_rules.push_back(&init_fill_tile_size);
+
+    // Mutation Rules for Evolutionary Search
+    node->mutation_rules.push_back(std::make_shared<MutateTileSize>(1.0));
   } else {
     LOG(FATAL) << "No default sketch rules for target: " << task->target;
   }
@@ -304,11 +319,24 @@ Array<State> SketchPolicyNode::SearchOneRound(int num_random_states, Array<State
   for (int i = 0; i < num_use_measured; i++) {
     init_population.push_back(measured_states_vector_[indices[i]]);
   }
+  // Also insert the states adapted from similar tasks, they are measured first
+  for (const State& state : warm_start_states_) {
+    init_population.push_back(state);
+  }
   // Sample some random states for eps-greedy
   if (num_random_states > 0 && random_states != nullptr) {
     *random_states = RandomSampleStates(init_population, &rand_gen, num_random_states);
   }
-  return EvolutionarySearch(init_population, num_measure_per_iter_ * 2);
+  Array<State> best_states = EvolutionarySearch(init_population, num_measure_per_iter_ * 2);
+  if (!warm_start_states_.empty()) {
+    Array<State> warm_start(warm_start_states_.begin(), warm_start_states_.end());
+    warm_start_states_.clear();
+    for (const State& state : best_states) {
+      warm_start.push_back(state);
+    }
+    best_states = std::move(warm_start);
+  }
+  return best_states;
 }
 
 Array<State> SketchPolicyNode::GenerateSketches() {
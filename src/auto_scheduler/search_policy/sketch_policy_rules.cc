@@ -25,6 +25,9 @@
 
 #include "sketch_policy_rules.h"
 
+#include <tvm/tir/analysis.h>
+
+#include <map>
 #include <set>
 #include <string>
 #include <utility>
@@ -462,6 +465,404 @@ std::vector<std::pair<State, int>> RuleSpecialComputeLocationGPU::Apply(
   return {std::make_pair(std::move(tmp_s), stage_id - 1)};
 }
 
+/********** RuleVTAGemm **********/
+
+// The on-chip buffers of VTA
+static const char* kVTAInpScope = "local.inp_buffer";
+static const char* kVTAWgtScope = "local.wgt_buffer";
+static const char* kVTAAccScope = "local.acc_buffer";
+
+/*! \brief The stages an output of a VTA gemm is computed from. */
+struct VTAGemmChain {
+  /*! \brief The gemm stage. */
+  std::string gemm;
+  /*! \brief The elementwise stages between the gemm and the output. */
+  std::vector<std::string> ewise;
+  /*! \brief The scalar constant stages. */
+  std::vector<std::string> consts;
+  /*! \brief The placeholders read by the elementwise stages and the output, with their readers. */
+  std::map<std::string, std::vector<std::string>> ewise_inputs;
+};
+
+// Find the stage with the given op name
+static int FindStageByName(const State& state, const std::string& name) {
+  for (size_t i = 0; i < state->stages.size(); ++i) {
+    if (state->stages[i]->op->name == name) return static_cast<int>(i);
+  }
+  LOG(FATAL) << "Cannot find stage " << name;
+  return -1;
+}
+
+// Walk from the output to the gemm stage tagged for VTA, return false if there is none
+static bool GetVTAGemmChain(const SearchTask& task, const State& state, int stage_id,
+                            VTAGemmChain* chain) {
+  std::vector<int> stack{stage_id};
+  std::set<int> visited{stage_id};
+  while (!stack.empty()) {
+    int id = stack.back();
+    stack.pop_back();
+    for (int producer : GetDirectProducers(task, state, id)) {
+      const Stage& stage = state->stages[producer];
+      if (stage->op_type == StageKind::kPlaceholder) {
+        chain->ewise_inputs[stage->op->name].push_back(state->stages[id]->op->name);
+        continue;
+      }
+      if (!visited.insert(producer).second) continue;
+      if (stage->op->attrs.count(SearchPolicyKey::vta_gemm)) {
+        if (!chain->gemm.empty() && chain->gemm != stage->op->name) return false;
+        chain->gemm = stage->op->name;
+      } else if (stage->iters.empty()) {
+        chain->consts.push_back(stage->op->name);
+      } else {
+        chain->ewise.push_back(stage->op->name);
+        stack.push_back(producer);
+      }
+    }
+  }
+  if (chain->gemm.empty()) return false;
+  // The innermost (batch, channel) and reduction axes are tensorized
+  const Stage& gemm = state->stages[FindStageByName(state, chain->gemm)];
+  const Stage& output = state->stages[stage_id];
+  size_t num_spatial = 0;
+  for (const auto& it : gemm->iters) {
+    if (it->iter_kind == IteratorKind::kSpatial) ++num_spatial;
+  }
+  return num_spatial >= 4 && gemm->iters.size() >= num_spatial + 2 &&
+         output->iters.size() == num_spatial;
+}
+
+SketchGenerationRule::ConditionKind RuleVTAGemm::MeetCondition(const SketchPolicyNode& policy,
+                                                               const State& state,
+                                                               int stage_id) const {
+  VTAGemmChain chain;
+  if (!IsOutputOp(policy.search_task, state, stage_id) ||
+      state->stages[stage_id]->op->attrs.count(SearchPolicyKey::vta_gemm) ||
+      !GetVTAGemmChain(policy.search_task, state, stage_id, &chain)) {
+    return ConditionKind::kSkip;
+  }
+  return ConditionKind::kApplyAndSkipRest;
+}
+
+std::vector<std::pair<State, int>> RuleVTAGemm::Apply(const SketchPolicyNode& policy,
+                                                      const State& state, int stage_id) const {
+  const SearchTask& task = policy.search_task;
+  VTAGemmChain chain;
+  ICHECK(GetVTAGemmChain(task, state, stage_id, &chain));
+  State tmp_s = state;
+  // Stage ids move as cache stages are added, the op names do not
+  const std::string out_name = state->stages[stage_id]->op->name;
+  const std::string gemm_acc = chain.gemm + "." + kVTAAccScope;
+  Array<te::Tensor> gemm_inputs =
+      state->stages[FindStageByName(state, chain.gemm)]->op->InputTensors();
+  ICHECK_EQ(gemm_inputs.size(), 2) << "A VTA gemm reads an input and a weight";
+  const std::string data_name = gemm_inputs[0]->op->name;
+  const std::string kernel_name = gemm_inputs[1]->op->name;
+
+  for (const std::string& name : chain.consts) {
+    tmp_s.compute_inline(FindStageByName(tmp_s, name));
+  }
+  // The gemm and the elementwise stages live in the accumulator: compute each one in a cache
+  // stage of the accumulator scope, then inline the copy back into the original stage
+  std::vector<std::string> acc_stages{chain.gemm};
+  acc_stages.insert(acc_stages.end(), chain.ewise.begin(), chain.ewise.end());
+  for (const std::string& name : acc_stages) {
+    tmp_s.cache_write(FindStageByName(tmp_s, name), kVTAAccScope, task->compute_dag);
+    tmp_s.compute_inline(FindStageByName(tmp_s, name));
+  }
+  // The input is loaded into the input buffer, padding included
+  std::string data_cache = data_name + "." + kVTAInpScope;
+  int data_id = FindStageByName(tmp_s, data_name);
+  if (tmp_s->stages[data_id]->op_type == StageKind::kCompute) {
+    tmp_s.cache_write(data_id, kVTAInpScope, task->compute_dag);
+    tmp_s.compute_inline(FindStageByName(tmp_s, data_name));
+  } else {
+    tmp_s.cache_read(data_id, kVTAInpScope, {FindStageByName(tmp_s, gemm_acc)}, task->compute_dag);
+  }
+  std::string kernel_cache = kernel_name + "." + kVTAWgtScope;
+  tmp_s.cache_read(FindStageByName(tmp_s, kernel_name), kVTAWgtScope,
+                   {FindStageByName(tmp_s, gemm_acc)}, task->compute_dag);
+  std::vector<std::string> ewise_caches;
+  for (const auto& kv : chain.ewise_inputs) {
+    if (kv.first == data_name || kv.first == kernel_name) continue;
+    Array<Integer> readers;
+    for (const std::string& reader : kv.second) {
+      readers.push_back(
+          FindStageByName(tmp_s, reader == out_name ? reader : reader + "." + kVTAAccScope));
+    }
+    tmp_s.cache_read(FindStageByName(tmp_s, kv.first), kVTAAccScope, readers, task->compute_dag);
+    ewise_caches.push_back(kv.first + "." + kVTAAccScope);
+  }
+
+  // Tile the outer axes of the output, the innermost (batch, channel) block is one VTA tensor
+  int out_id = FindStageByName(tmp_s, out_name);
+  Array<Iterator> out_iters = tmp_s->stages[out_id]->iters;
+  size_t num_outer = out_iters.size() - 2;
+  std::vector<Iterator> outer, inner;
+  for (size_t i = 0; i < num_outer; ++i) {
+    Array<Iterator> tiles = tmp_s.split(out_id, out_iters[i], Array<Optional<Integer>>{NullOpt});
+    outer.push_back(tiles[0]);
+    inner.push_back(tiles[1]);
+  }
+  // Virtual threads over the output channels and rows, with their own buffers, let the loads
+  // of one thread overlap the computation of the other
+  std::vector<size_t> vthread_axes{1};
+  if (num_outer >= 4) vthread_axes.push_back(2);
+  Array<Iterator> vthreads;
+  for (size_t i : vthread_axes) {
+    Array<Iterator> tiles = tmp_s.split(out_id, outer[i], Array<Optional<Integer>>{NullOpt});
+    outer[i] = tiles[0];
+    vthreads.push_back(tiles[1]);
+  }
+  // Same order as the VTA TOPI schedules: channels inside the batch and rows for weight reuse
+  Array<Iterator> order = vthreads;
+  order.push_back(outer[0]);
+  for (size_t i = 2; i + 1 < num_outer; ++i) order.push_back(outer[i]);
+  order.push_back(outer[1]);
+  if (num_outer >= 3) order.push_back(outer[num_outer - 1]);
+  const Iterator store_at = order.back();
+  order.push_back(inner[1]);
+  order.push_back(inner[0]);
+  for (size_t i = 2; i < num_outer; ++i) order.push_back(inner[i]);
+  order.push_back(out_iters[num_outer]);
+  order.push_back(out_iters[num_outer + 1]);
+  tmp_s.reorder(out_id, order);
+  for (const Iterator& it : vthreads) {
+    tmp_s.bind(out_id, it, IteratorAnnotation::kCThread);
+  }
+  tmp_s.pragma(out_id, inner[1], "dma_copy");
+
+  // Compute the accumulator stages for each output tile
+  for (const std::string& name : chain.ewise) {
+    int id = FindStageByName(tmp_s, name + "." + kVTAAccScope);
+    tmp_s.compute_at(id, out_id, store_at);
+    tmp_s.pragma(id, tmp_s->stages[id]->iters[0], "alu");
+  }
+  for (const std::string& name : ewise_caches) {
+    int id = FindStageByName(tmp_s, name);
+    tmp_s.compute_at(id, out_id, store_at);
+    tmp_s.pragma(id, tmp_s->stages[id]->iters[0], "dma_copy");
+  }
+  int gemm_id = FindStageByName(tmp_s, gemm_acc);
+  tmp_s.compute_at(gemm_id, out_id, store_at);
+
+  // Tile the outer reduction of the gemm, the input and weight tiles are loaded for each step
+  Array<Iterator> spatial, reduce;
+  for (const auto& it : tmp_s->stages[gemm_id]->iters) {
+    (it->iter_kind == IteratorKind::kSpatial ? spatial : reduce).push_back(it);
+  }
+  size_t num_reduce = reduce.size();
+  Array<Iterator> k_tiles = tmp_s.split(gemm_id, reduce[0], Array<Optional<Integer>>{NullOpt});
+  Array<Iterator> gemm_order{spatial[0], k_tiles[0], k_tiles[1]};
+  if (num_outer >= 3) gemm_order.push_back(spatial[num_outer - 1]);
+  for (size_t i = num_reduce - 2; i >= 1; --i) gemm_order.push_back(reduce[i]);
+  for (size_t i = 1; i < (num_outer >= 3 ? num_outer - 1 : num_outer); ++i) {
+    gemm_order.push_back(spatial[i]);
+  }
+  gemm_order.push_back(spatial[num_outer]);
+  gemm_order.push_back(spatial[num_outer + 1]);
+  gemm_order.push_back(reduce[num_reduce - 1]);
+  tmp_s.reorder(gemm_id, gemm_order);
+  for (const std::string& name : {data_cache, kernel_cache}) {
+    int id = FindStageByName(tmp_s, name);
+    tmp_s.compute_at(id, gemm_id, k_tiles[0]);
+    tmp_s.pragma(id, tmp_s->stages[id]->iters[0], "dma_copy");
+  }
+  std::string intrin =
+      GetStringParam(tmp_s->stages[gemm_id]->op->attrs, SearchPolicyKey::vta_gemm);
+  tmp_s.pragma(gemm_id, spatial[num_outer], "tensorize$" + intrin);
+
+  return {std::make_pair(std::move(tmp_s), -1)};
+}
+
+/********** RuleCPUTensorize **********/
+
+/*!
+ * \brief A micro-kernel of the CPU tensor intrinsics, registered as
+ * auto_scheduler.tensor_intrin.<name>. It computes out[i] += sum_k data[k] * kernel[i, k], or
+ * kernel[k, i] when the kernel is transposed, over a block of lanes x reduce elements.
+ */
+struct CPUMicroKernel {
+  std::string name;
+  DataType data_dtype;
+  DataType kernel_dtype;
+  DataType out_dtype;
+  int lanes;
+  int reduce;
+  bool kernel_transposed;
+  bool (*available)(const Target& target);
+};
+
+static bool HasMAttr(const Target& target, const std::string& attr) {
+  for (const String& it : target->GetAttr<Array<String>>("mattr").value_or(Array<String>())) {
+    if (it == attr) return true;
+  }
+  return false;
+}
+
+static bool IsAArch64(const Target& target) {
+  std::string mtriple = target->GetAttr<String>("mtriple", "").value();
+  return mtriple.find("aarch64") != std::string::npos;
+}
+
+static bool HasVNNI(const Target& target) {
+  static const std::set<std::string> mcpus{"cascadelake",    "cooperlake", "icelake-client",
+                                           "icelake-server", "tigerlake",  "sapphirerapids"};
+  return mcpus.count(target->GetAttr<String>("mcpu", "").value()) ||
+         HasMAttr(target, "+avx512vnni");
+}
+
+static bool HasDotProd(const Target& target) {
+  return IsAArch64(target) && HasMAttr(target, "+dotprod");
+}
+
+static bool HasFullFP16(const Target& target) {
+  return IsAArch64(target) && HasMAttr(target, "+fullfp16");
+}
+
+static const std::vector<CPUMicroKernel>& CPUMicroKernels() {
+  static const std::vector<CPUMicroKernel> kernels{
+      {"x86_vnni_u8s8s32_16x4", DataType::UInt(8), DataType::Int(8), DataType::Int(32), 16, 4,
+       false, HasVNNI},
+      {"arm_sdot_s8s8s32_4x4", DataType::Int(8), DataType::Int(8), DataType::Int(32), 4, 4, false,
+       HasDotProd},
+      {"arm_udot_u8u8u32_4x4", DataType::UInt(8), DataType::UInt(8), DataType::UInt(32), 4, 4,
+       false, HasDotProd},
+      {"arm_fmla_f16_8x1", DataType::Float(16), DataType::Float(16), DataType::Float(16), 8, 1,
+       true, HasFullFP16},
+  };
+  return kernels;
+}
+
+// Return the micro-kernel the stage can be tensorized with, or nullptr. The stage sums over its
+// innermost reduction axis k the product of the data, whose last index is k, and of the kernel,
+// whose last two indices are the innermost spatial axis i and k. Neither uses i or k elsewhere.
+static const CPUMicroKernel* MatchCPUMicroKernel(const SearchTask& task, const Stage& stage) {
+  if (stage->op_type != StageKind::kCompute) return nullptr;
+  const auto* op = stage->op.as<te::ComputeOpNode>();
+  if (op == nullptr || op->body.size() != 1 || op->axis.empty() || op->reduce_axis.empty()) {
+    return nullptr;
+  }
+  const auto* reduce = op->body[0].as<ReduceNode>();
+  if (reduce == nullptr || reduce->source.size() != 1 || !is_one(reduce->condition) ||
+      !reduce->combiner->result[0].as<AddNode>() ||
+      !is_zero(reduce->combiner->identity_element[0])) {
+    return nullptr;
+  }
+  const auto* mul = reduce->source[0].as<MulNode>();
+  if (mul == nullptr) return nullptr;
+  // The operands, with their cast to the accumulator if any
+  auto operand = [](const PrimExpr& e, bool* cast) {
+    const auto* c = e.as<CastNode>();
+    *cast = c != nullptr;
+    return (c ? c->value : e).as<ProducerLoadNode>();
+  };
+  bool data_cast, kernel_cast;
+  const ProducerLoadNode* data = operand(mul->a, &data_cast);
+  const ProducerLoadNode* kernel = operand(mul->b, &kernel_cast);
+  if (data == nullptr || kernel == nullptr || kernel->indices.size() < 2) return nullptr;
+
+  const IterVar& i = op->axis.back();
+  const IterVar& k = op->reduce_axis.back();
+  const auto* i_extent = i->dom->extent.as<IntImmNode>();
+  const auto* k_extent = k->dom->extent.as<IntImmNode>();
+  if (i_extent == nullptr || k_extent == nullptr) return nullptr;
+  auto uses_block = [&](const PrimExpr& e) {
+    return ExprUseVar(e, [&](const VarNode* v) { return v == i->var.get() || v == k->var.get(); });
+  };
+  auto is_var = [](const PrimExpr& e, const IterVar& iv) { return e.same_as(iv->var); };
+  if (!is_var(data->indices.back(), k)) return nullptr;
+  for (size_t j = 0; j + 1 < data->indices.size(); ++j) {
+    if (uses_block(data->indices[j])) return nullptr;
+  }
+  for (size_t j = 0; j + 2 < kernel->indices.size(); ++j) {
+    if (uses_block(kernel->indices[j])) return nullptr;
+  }
+  const PrimExpr& kernel_outer = kernel->indices[kernel->indices.size() - 2];
+  const PrimExpr& kernel_inner = kernel->indices.back();
+
+  for (const CPUMicroKernel& kernel_info : CPUMicroKernels()) {
+    bool cast = kernel_info.out_dtype != kernel_info.data_dtype;
+    bool transposed = is_var(kernel_outer, k) && is_var(kernel_inner, i);
+    bool normal = is_var(kernel_outer, i) && is_var(kernel_inner, k);
+    if (data->dtype == kernel_info.data_dtype && kernel->dtype == kernel_info.kernel_dtype &&
+        op->body[0].dtype() == kernel_info.out_dtype && data_cast == cast &&
+        kernel_cast == cast && (kernel_info.kernel_transposed ? transposed : normal) &&
+        i_extent->value % kernel_info.lanes == 0 && k_extent->value % kernel_info.reduce == 0 &&
+        kernel_info.available(task->target) &&
+        runtime::Registry::Get("auto_scheduler.tensor_intrin." + kernel_info.name)) {
+      return &kernel_info;
+    }
+  }
+  return nullptr;
+}
+
+// Whether the split step fixes the block of a micro-kernel. RuleCPUTensorize ends with the two
+// splits of the block, then a reorder and the tensorize pragma of the same stage.
+static bool IsMicroKernelSplit(const State& state, size_t step_id) {
+  int stage_id = state->transform_steps[step_id].as<SplitStepNode>()->stage_id;
+  int num_splits = 0;
+  for (size_t i = step_id + 1; i < state->transform_steps.size(); ++i) {
+    const Step& step = state->transform_steps[i];
+    if (const auto* ps = step.as<PragmaStepNode>()) {
+      return ps->stage_id == stage_id && StrStartsWith(ps->pragma_type, "tensorize$");
+    }
+    if (const auto* ps = step.as<SplitStepNode>()) {
+      if (ps->stage_id != stage_id || ++num_splits > 1) return false;
+    } else if (const auto* ps = step.as<ReorderStepNode>()) {
+      if (ps->stage_id != stage_id) return false;
+    } else {
+      return false;
+    }
+  }
+  return false;
+}
+
+SketchGenerationRule::ConditionKind RuleCPUTensorize::MeetCondition(const SketchPolicyNode& policy,
+                                                                    const State& state,
+                                                                    int stage_id) const {
+  if (!MatchCPUMicroKernel(policy.search_task, state->stages[stage_id])) {
+    return ConditionKind::kSkip;
+  }
+  // The other rules still give the sketches without the micro-kernel
+  return ConditionKind::kApply;
+}
+
+std::vector<std::pair<State, int>> RuleCPUTensorize::Apply(const SketchPolicyNode& policy,
+                                                           const State& state,
+                                                           int stage_id) const {
+  const CPUMicroKernel* kernel = MatchCPUMicroKernel(policy.search_task, state->stages[stage_id]);
+  ICHECK(kernel != nullptr);
+  State tmp_s = state;
+  Array<Iterator> spatial, reduce;
+  for (const auto& it : tmp_s->stages[stage_id]->iters) {
+    (it->iter_kind == IteratorKind::kSpatial ? spatial : reduce).push_back(it);
+  }
+  // Tile the other axes, the block of the micro-kernel is swept over the inner tiles
+  std::vector<Iterator> outer, inner;
+  auto tile = [&](const Iterator& it) {
+    Array<Iterator> tiles = tmp_s.split(stage_id, it, Array<Optional<Integer>>{NullOpt});
+    outer.push_back(tiles[0]);
+    inner.push_back(tiles[1]);
+  };
+  for (size_t i = 0; i + 1 < spatial.size(); ++i) tile(spatial[i]);
+  for (size_t i = 0; i + 1 < reduce.size(); ++i) tile(reduce[i]);
+  Array<Iterator> s_block =
+      tmp_s.split(stage_id, spatial.back(), Array<Optional<Integer>>{Integer(kernel->lanes)});
+  Array<Iterator> k_block =
+      tmp_s.split(stage_id, reduce.back(), Array<Optional<Integer>>{Integer(kernel->reduce)});
+
+  Array<Iterator> order(outer.begin(), outer.end());
+  order.push_back(s_block[0]);
+  order.push_back(k_block[0]);
+  for (const Iterator& it : inner) order.push_back(it);
+  order.push_back(s_block[1]);
+  order.push_back(k_block[1]);
+  tmp_s.reorder(stage_id, order);
+  tmp_s.pragma(stage_id, s_block[1], "tensorize$" + kernel->name);
+
+  return {std::make_pair(std::move(tmp_s), stage_id - 1)};
+}
+
 /********** RuleCustomSketch **********/
 
 SketchGenerationRule::ConditionKind RuleCustomSketch::MeetCondition(const SketchPolicyNode& policy,
@@ -922,6 +1323,10 @@ PopulationGenerationRule::ResultKind MutateTileSize::Apply(SketchPolicyNode* pol
       if (!ps->extent.defined() || !ps->extent.value()->IsInstance<IntImmNode>()) {
         continue;
       }
+      // The block of a micro-kernel is fixed by its intrinsic
+      if (IsMicroKernelSplit(*state, i)) {
+        continue;
+      }
       auto innermost_factor = ps->lengths.back().value_or(max_innermost_split_factor + 1);
       if (GetIntImm(innermost_factor) <= max_innermost_split_factor) {
         split_step_ids.push_back(i);
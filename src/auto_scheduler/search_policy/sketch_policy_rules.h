@@ -131,6 +131,18 @@ DEFINE_SKETCH_GENERATION_RULE(RuleCrossThreadReduction);
  * location of the producers of compute ops that perform "fake reduction" with const tensors. */
 DEFINE_SKETCH_GENERATION_RULE(RuleSpecialComputeLocationGPU);
 
+/*! \brief The rule that schedules an output computed from a VTA gemm for the accelerator. The
+ * gemm and the elementwise stages after it are computed in the accumulator buffer for each output
+ * tile, with the input and weight tiles loaded into their buffers for each outer reduction step.
+ * The tile sizes and the number of virtual threads are left to the search. */
+DEFINE_SKETCH_GENERATION_RULE(RuleVTAGemm);
+
+/*! \brief The rule that tensorizes a CPU reduction with a micro-kernel of the target, the int8
+ * dot products of AVX-512 VNNI and of the ARM dot-product extension or the fp16 FMLA. The
+ * innermost spatial and reduction axes are split to the block of the micro-kernel, the outer
+ * tiles are left to the search. */
+DEFINE_SKETCH_GENERATION_RULE(RuleCPUTensorize);
+
 /*! \brief The rule that allows users to generate custom sketches. */
 class RuleCustomSketch : public SketchGenerationRule {
  public:
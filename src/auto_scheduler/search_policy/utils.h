@@ -71,6 +71,12 @@ inline bool IsOpenCLTask(const SearchTask& task) {
   return (task)->target->kind->device_type == kDLOpenCL;
 }
 
+/*! \brief Return whether the search task is targeting the VTA accelerator. */
+inline bool IsVTATask(const SearchTask& task) {
+  return (task)->target->kind->device_type == kDLExtDev &&
+         (task)->target->GetAttr<String>("device", "") == "vta";
+}
+
 /*! \brief Argsort. Order: largest to smallest */
 template <typename T>
 inline std::vector<int> Argsort(const std::vector<T>& scores) {
@@ -119,7 +119,8 @@ const char* IteratorAnnotationString[] = {
     "threadIdx.y",  // kThreadY = 8
     "blockIdx.z",   // kBlockZ = 9
     "threadIdx.z",  // kThreadZ = 10
-    "tensorize"     // kTensorized = 11
+    "tensorize",    // kTensorized = 11
+    "cthread"       // kCThread = 12
 };
 
 StepNode* Step::CopyOnWrite() {
@@ -391,6 +392,7 @@ void AnnotationStepNode::ApplyToSchedule(Array<te::Stage>* stages,
     case IteratorAnnotation::kThreadX:
     case IteratorAnnotation::kThreadY:
     case IteratorAnnotation::kThreadZ:
+    case IteratorAnnotation::kCThread:
       stage.bind(axes[iter_id],
                  te::thread_axis(Range(), IteratorAnnotationString[static_cast<int>(annotation)]));
       break;
@@ -429,6 +431,7 @@ String AnnotationStepNode::PrintAsPythonAPI(Array<te::Stage>* stages,
     case IteratorAnnotation::kThreadX:
     case IteratorAnnotation::kThreadY:
     case IteratorAnnotation::kThreadZ:
+    case IteratorAnnotation::kCThread:
       ss << "bind(";
       break;
     case IteratorAnnotation::kNone:
@@ -446,6 +449,7 @@ String AnnotationStepNode::PrintAsPythonAPI(Array<te::Stage>* stages,
     case IteratorAnnotation::kThreadX:
     case IteratorAnnotation::kThreadY:
     case IteratorAnnotation::kThreadZ:
+    case IteratorAnnotation::kCThread:
       ss << ", te.thread_axis(\"" << IteratorAnnotationString[static_cast<int>(annotation)]
          << "\")";
       break;
@@ -679,11 +683,33 @@ void PragmaStepNode::ApplyToState(State* state) const {
     ICHECK_LT(pos, pragma_type.size()) << "max step value not found.";
     stage.CopyOnWrite()->attrs.auto_unroll_max_step = atoi(pragma_type.c_str() + pos + 1);
     pstate->stages.Set(stage_id, std::move(stage));
-  } else {
+  } else if (StrStartsWith(pragma_type, "tensorize$")) {
+    const Stage& stage = (*state)->stages[stage_id];
+    Iterator it = stage->iters[iter_id];
+    Iterator new_it = Iterator(it->name, it->range, it->iter_kind, IteratorAnnotation::kTensorize,
+                               &it->orig_iters);
+    Stage new_stage = stage;
+    new_stage.CopyOnWrite()->iters.Set(iter_id, new_it);
+    state->CopyOnWrite()->stages.Set(stage_id, std::move(new_stage));
+  } else if (pragma_type != "dma_copy" && pragma_type != "alu") {
+    // The VTA pragmas above only mark loops for the lowering passes of the accelerator
     LOG(FATAL) << "Unsupported pragma: " << pragma_type;
   }
 }
 
+/*!
+ * \brief Get the tensor intrinsic named by a "tensorize$<name>" pragma.
+ * \param pragma_type The pragma.
+ * \return The intrinsic, returned by the function registered as
+ *  auto_scheduler.tensor_intrin.<name>.
+ */
+static te::TensorIntrin GetPragmaTensorIntrin(const String& pragma_type) {
+  std::string name = std::string(pragma_type).substr(std::string("tensorize$").size());
+  const PackedFunc* f = runtime::Registry::Get("auto_scheduler.tensor_intrin." + name);
+  ICHECK(f != nullptr) << "Tensor intrinsic " << name << " is not registered";
+  return (*f)();
+}
+
 void PragmaStepNode::ApplyToSchedule(Array<te::Stage>* stages,
                                      StageToAxesMap* stage_to_axes) const {
   te::Stage stage = (*stages)[stage_id];
@@ -701,6 +727,9 @@ void PragmaStepNode::ApplyToSchedule(Array<te::Stage>* stages,
       stage.pragma(axes[iter_id], "auto_unroll_max_step", value);
       stage.pragma(axes[iter_id], "unroll_explicit", true);
     }
+  } else if (StrStartsWith(pragma_type, "tensorize$")) {
+    ICHECK_LT(iter_id, axes.size());
+    stage.tensorize(axes[iter_id], GetPragmaTensorIntrin(pragma_type));
   } else {
     ICHECK_LT(iter_id, axes.size());
     stage.pragma(axes[iter_id], pragma_type);
@@ -729,6 +758,11 @@ String PragmaStepNode::PrintAsPythonAPI(Array<te::Stage>* stages,
     ss << "s[" << op_name << "].pragma("
        << CleanName((*stage_to_axes)[stage][iter_id]->var->name_hint, op_name)
        << ", \"unroll_explicit\", True)\n";
+  } else if (StrStartsWith(pragma_type, "tensorize$")) {
+    std::string name = std::string(pragma_type).substr(std::string("tensorize$").size());
+    ss << "s[" << op_name << "].tensorize("
+       << CleanName((*stage_to_axes)[stage][iter_id]->var->name_hint, op_name)
+       << ", tvm.get_global_func(\"auto_scheduler.tensor_intrin." << name << "\")())\n";
   } else {
     ss << "s[" << op_name << "].pragma("
        << CleanName((*stage_to_axes)[stage][iter_id]->var->name_hint, op_name) << ", \""
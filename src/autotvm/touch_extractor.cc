@@ -24,11 +24,22 @@
 
 #include "touch_extractor.h"
 
+#include <tvm/support/parallel_for.h>
+#include <tvm/te/schedule_pass.h>
+#include <tvm/tir/transform.h>
+
 #include <algorithm>
 #include <cmath>
 #include <set>
 #include <unordered_map>
 
+namespace tvm {
+// import the function from driver_api.cc
+void GetBinds(const Array<te::Tensor>& args, bool compact,
+              const std::unordered_map<te::Tensor, tir::Buffer>& binds,
+              Map<te::Tensor, tir::Buffer>* out_binds, Array<ObjectRef>* out_arg_list);
+}  // namespace tvm
+
 namespace tvm {
 namespace autotvm {
 
@@ -480,6 +491,46 @@ void GetCurveSampleFeatureFlatten(Stmt stmt, int sample_n, std::vector<float>* r
   }
 }
 
+/*!
+ * \brief Lower a schedule for the feature extraction, keeping all the axes in the IR.
+ *  The same as ana_lower in python/tvm/autotvm/feature.py.
+ */
+Stmt AnaLower(te::Schedule sch, const Array<te::Tensor>& args) {
+  Map<te::Tensor, tir::Buffer> binds;
+  Array<ObjectRef> arg_list;
+  GetBinds(args, false, std::unordered_map<te::Tensor, tir::Buffer>(), &binds, &arg_list);
+  sch = sch.normalize();
+  auto bounds = te::InferBound(sch);
+  Stmt stmt = te::ScheduleOps(sch, bounds, true);
+  tir::PrimFunc func = te::SchedulePostProcToPrimFunc(arg_list, std::move(stmt), binds);
+  IRModule mod = IRModule::FromExpr(func);
+  mod = tir::transform::StorageFlatten(64)(std::move(mod));
+  mod = tir::transform::Simplify()(std::move(mod));
+  return Downcast<tir::PrimFunc>(mod->Lookup("main"))->body;
+}
+
+/*!
+ * \brief Lower the schedules of many configs in parallel and get their flatten itervar features.
+ * \param schedules The schedules.
+ * \param args The buffer args of each schedule.
+ * \param take_log Whether take log of numerical statics.
+ * \param ret_features The features of each schedule, empty when its lowering failed.
+ */
+void GetItervarFeatureFlattenBatch(const Array<te::Schedule>& schedules,
+                                   const Array<Array<te::Tensor>>& args, bool take_log,
+                                   std::vector<std::vector<float>>* ret_features) {
+  ICHECK_EQ(schedules.size(), args.size());
+  ret_features->assign(schedules.size(), std::vector<float>());
+  support::parallel_for(0, schedules.size(), [&](int i) {
+    try {
+      Stmt stmt = AnaLower(schedules[i], args[i]);
+      GetItervarFeatureFlatten(stmt, take_log, &(*ret_features)[i]);
+    } catch (Error& e) {
+      (*ret_features)[i].clear();
+    }
+  });
+}
+
 // register API for front end
 TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeature")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
@@ -520,5 +571,32 @@ TVM_REGISTER_GLOBAL("autotvm.feature.GetCurveSampleFeatureFlatten")
       *ret = arr;
     });
 
+TVM_REGISTER_GLOBAL("autotvm.feature.GetItervarFeatureFlattenBatch")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      Array<te::Schedule> schedules = args[0];
+      Array<Array<te::Tensor>> sch_args = args[1];
+      bool take_log = args[2];
+      std::vector<std::vector<float>> features;
+
+      GetItervarFeatureFlattenBatch(schedules, sch_args, take_log, &features);
+
+      // The byte array holds the number of configs, the length of each feature vector and
+      // then the features, all as 32-bit words
+      std::vector<int32_t> header{static_cast<int32_t>(features.size())};
+      for (const auto& fea : features) {
+        header.push_back(static_cast<int32_t>(fea.size()));
+      }
+      std::string bytes(reinterpret_cast<const char*>(header.data()),
+                        sizeof(int32_t) * header.size());
+      for (const auto& fea : features) {
+        bytes.append(reinterpret_cast<const char*>(fea.data()), sizeof(float) * fea.size());
+      }
+
+      TVMByteArray arr;
+      arr.size = bytes.size();
+      arr.data = bytes.data();
+      *ret = arr;
+    });
+
 }  // namespace autotvm
 }  // namespace tvm
@@ -21,6 +21,7 @@
 #include <cuda_runtime.h>
 #endif
 #include <dlpack/dlpack.h>
+#include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/packed_func.h>
@@ -47,8 +48,10 @@ class TVMDSOOpTrait;
 // Buffer information used for actual computation.
 // Each buffer is associated with one TensorFlow tensor
 // whose underlying buffer is record into "origin_buf".
-// For input tensor, we copy data from origin_buf to buf
-// and for output tensor, copy data from buf to origin_buf
+// The aligned tensors are passed to TVM without a copy, for the others
+// we copy data from origin_buf to buf for input tensor
+// and copy data from buf to origin_buf for output tensor.
+// The GPU copies are queued on the stream of TensorFlow.
 class TensorAsBuf {
  public:
   tensorflow::Tensor inline_tensor;
@@ -58,6 +61,7 @@ class TensorAsBuf {
   size_t offset;
 
   int device_type;
+  void* stream{nullptr};
 
   char* origin_buf;
   char* buf;
@@ -70,7 +74,8 @@ class TensorAsBuf {
       memcpy(origin_buf, buf + offset, size);
 #ifdef TF_TVMDSOOP_ENABLE_GPU
     } else if (device_type == kDLCUDA) {
-      cudaMemcpy(origin_buf, buf + offset, size, cudaMemcpyDeviceToDevice);
+      cudaMemcpyAsync(origin_buf, buf + offset, size, cudaMemcpyDeviceToDevice,
+                      static_cast<cudaStream_t>(stream));
 #endif
     } else {
       LOG(FATAL) << "Only support CPU and CUDA now. Device " << device_type
@@ -86,7 +91,8 @@ class TensorAsBuf {
       memcpy(buf + offset, origin_buf, size);
 #ifdef TF_TVMDSOOP_ENABLE_GPU
     } else if (device_type == kDLCUDA) {
-      cudaMemcpy(buf + offset, origin_buf, size, cudaMemcpyDeviceToDevice);
+      cudaMemcpyAsync(buf + offset, origin_buf, size, cudaMemcpyDeviceToDevice,
+                      static_cast<cudaStream_t>(stream));
 #endif
     } else {
       LOG(FATAL) << "Only support CPU and CUDA now. Device " << device_type
@@ -143,8 +149,9 @@ void EnsureAlignment(OpKernelContext* ctx, const tensorflow::Tensor& tensor, Ten
     tensorflow::int64 dims[1] = {(tensorflow::int64)(tensor.TotalBytes() + alignment)};
     tensorflow::TensorShapeUtils::MakeShape(dims, 1, &buf_shape);
 
+    // the size of the temporary buffer is in bytes
     out->tensor = &out->inline_tensor;
-    ctx->allocate_temp(tensor.dtype(), buf_shape, out->tensor);
+    ctx->allocate_temp(tensorflow::DT_INT8, buf_shape, out->tensor);
 
     buf = const_cast<char*>(out->tensor->tensor_data().data());
     char* buf_aligned = reinterpret_cast<char*>(((uint64_t)buf + alignment) & (~(alignment - 1)));
@@ -180,6 +187,8 @@ class TVMDSOOpTrait<CPUDevice> {
 
   static int device_id(OpKernelContext* context) { return 0; }
 
+  static void* stream(OpKernelContext* context) { return nullptr; }
+
   static void make_shape_from_tensor(const tensorflow::Tensor& shape_tensor,
                                      tensorflow::TensorShape* output_shape) {
     tensorflow::int64 num_dims = shape_tensor.NumElements();
@@ -200,18 +209,39 @@ class TVMDSOOpTrait<GPUDevice> {
     return gpu_device_info->gpu_id;
   }
 
+  // The CUDA stream TensorFlow runs the kernel on.
+  static void* stream(OpKernelContext* context) {
+    return context->eigen_device<GPUDevice>().stream();
+  }
+
+  // The shape tensor is in host memory, see the registration of the kernel.
   static void make_shape_from_tensor(const tensorflow::Tensor& shape_tensor,
                                      tensorflow::TensorShape* output_shape) {
     tensorflow::int64 num_dims = shape_tensor.NumElements();
-    const tensorflow::int64* flat = shape_tensor.flat<tensorflow::int64>().data();
-    tensorflow::int64* dims = new tensorflow::int64[num_dims];
-    cudaMemcpy(dims, flat, sizeof(tensorflow::int64) * num_dims, cudaMemcpyDeviceToHost);
+    const tensorflow::int64* dims = shape_tensor.flat<tensorflow::int64>().data();
     tensorflow::TensorShapeUtils::MakeShape(dims, num_dims, output_shape);
-    delete dims;
   }
 };
 #endif
 
+// Run the TVM kernels of a scope on a stream, the default stream of TVM
+// is restored at the end of the scope.
+class TVMStreamScope {
+ public:
+  TVMStreamScope(int device_type, int device_id, void* stream)
+      : device_type_(device_type), device_id_(device_id), stream_(stream) {
+    if (stream_ != nullptr) TVMSetStream(device_type_, device_id_, stream_);
+  }
+  ~TVMStreamScope() {
+    if (stream_ != nullptr) TVMSetStream(device_type_, device_id_, nullptr);
+  }
+
+ private:
+  int device_type_;
+  int device_id_;
+  void* stream_;
+};
+
 template <typename DEVICE_TYPE>
 class TVMDSOOp : public OpKernel {
  private:
@@ -255,6 +285,7 @@ class TVMDSOOp : public OpKernel {
     tensorflow::Status status;
     int device_id = TVMDSOOpTrait<DEVICE_TYPE>::device_id(context);
     int device_type = TVMDSOOpTrait<DEVICE_TYPE>::device_type;
+    void* stream = TVMDSOOpTrait<DEVICE_TYPE>::stream(context);
 
     DLDevice dl_dev = {DLDeviceType(device_type), device_id};
 
@@ -283,6 +314,7 @@ class TVMDSOOp : public OpKernel {
 
       TensorAsBuf& input = buf_info[i];
       input.device_type = device_type;
+      input.stream = stream;
 
       EnsureAlignment(context, input_tensor, &input);
       input.CopyFromOrigin();
@@ -300,6 +332,7 @@ class TVMDSOOp : public OpKernel {
 
     TensorAsBuf output;
     output.device_type = device_type;
+    output.stream = stream;
     EnsureAlignment(context, *output_tensor, &output);
 
     status = MakeDLTensor(output, dl_dev, output_shape_ptr, &args[num_inputs]);
@@ -313,7 +346,12 @@ class TVMDSOOp : public OpKernel {
       setter(k, &args[k]);
     }
     TVMRetValue rv;
-    tvm_func.CallPacked(TVMArgs(tvm_values.data(), tvm_type_codes.data(), num_total_args), &rv);
+    {
+      // Order the kernels after the producers of the inputs and before the consumers of the
+      // output without synchronizing the device.
+      TVMStreamScope stream_scope(device_type, device_id, stream);
+      tvm_func.CallPacked(TVMArgs(tvm_values.data(), tvm_type_codes.data(), num_total_args), &rv);
+    }
 
     output.CopyToOrigin();
   }
@@ -321,7 +359,9 @@ class TVMDSOOp : public OpKernel {
 
 #ifdef TF_TVMDSOOP_ENABLE_GPU
 REGISTER_KERNEL_BUILDER(Name("TvmDsoOp").Device(tensorflow::DEVICE_CPU), TVMDSOOp<CPUDevice>);
-REGISTER_KERNEL_BUILDER(Name("TvmDsoOp").Device(tensorflow::DEVICE_GPU), TVMDSOOp<GPUDevice>);
+REGISTER_KERNEL_BUILDER(
+    Name("TvmDsoOp").Device(tensorflow::DEVICE_GPU).HostMemory("dynamic_output_shape"),
+    TVMDSOOp<GPUDevice>);
 #else
 REGISTER_KERNEL_BUILDER(Name("TvmDsoOp").Device(tensorflow::DEVICE_CPU), TVMDSOOp<CPUDevice>);
 #endif
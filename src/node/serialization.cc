@@ -27,14 +27,18 @@
 #include <tvm/node/reflection.h>
 #include <tvm/node/serialization.h>
 #include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 
 #include <cctype>
+#include <cstring>
+#include <fstream>
 #include <map>
 #include <string>
 
+#include "../runtime/file_utils.h"
 #include "../runtime/object_internal.h"
 #include "../support/base64.h"
 
@@ -71,6 +75,7 @@ class NodeIndexer : public AttrVisitor {
   std::vector<Object*> node_list_{nullptr};
   std::unordered_map<DLTensor*, size_t> tensor_index_;
   std::vector<DLTensor*> tensor_list_;
+  std::vector<runtime::NDArray> ndarray_list_;
   ReflectionVTable* reflection_ = ReflectionVTable::Global();
 
   void Visit(const char* key, double* value) final {}
@@ -88,6 +93,7 @@ class NodeIndexer : public AttrVisitor {
     ICHECK_EQ(tensor_index_.size(), tensor_list_.size());
     tensor_index_[ptr] = tensor_list_.size();
     tensor_list_.push_back(ptr);
+    ndarray_list_.push_back(*value);
   }
 
   void Visit(const char* key, ObjectRef* value) final {
@@ -136,6 +142,29 @@ class NodeIndexer : public AttrVisitor {
 // use map so attributes are ordered.
 using AttrMap = std::map<std::string, std::string>;
 
+/*! \brief Magic number of the binary format. */
+constexpr uint64_t kTVMBinaryIRMagic = 0x9E3D5A2C71B4F80D;
+
+inline void WriteAttrMap(dmlc::Stream* strm, const AttrMap& attrs) {
+  uint64_t size = attrs.size();
+  strm->Write(size);
+  for (const auto& kv : attrs) {
+    strm->Write(kv.first);
+    strm->Write(kv.second);
+  }
+}
+
+inline void ReadAttrMap(dmlc::Stream* strm, AttrMap* attrs) {
+  uint64_t size;
+  ICHECK(strm->Read(&size)) << "Invalid binary IR format";
+  attrs->clear();
+  for (uint64_t i = 0; i < size; ++i) {
+    std::string key, value;
+    ICHECK(strm->Read(&key) && strm->Read(&value)) << "Invalid binary IR format";
+    attrs->emplace(std::move(key), std::move(value));
+  }
+}
+
 /*! \brief Node structure for json format. */
 struct JSONNode {
   /*! \brief The type of key of the object. */
@@ -201,6 +230,23 @@ struct JSONNode {
       repr_bytes = Base64Decode(repr_b64);
     }
   }
+
+  void SaveBinary(dmlc::Stream* strm) const {
+    strm->Write(type_key);
+    strm->Write(repr_bytes);
+    WriteAttrMap(strm, attrs);
+    strm->Write(keys);
+    std::vector<uint64_t> data64(data.begin(), data.end());
+    strm->Write(data64);
+  }
+
+  void LoadBinary(dmlc::Stream* strm) {
+    ICHECK(strm->Read(&type_key) && strm->Read(&repr_bytes)) << "Invalid binary IR format";
+    ReadAttrMap(strm, &attrs);
+    std::vector<uint64_t> data64;
+    ICHECK(strm->Read(&keys) && strm->Read(&data64)) << "Invalid binary IR format";
+    data.assign(data64.begin(), data64.end());
+  }
 };
 
 // Helper class to populate the json node
@@ -473,7 +519,36 @@ struct JSONGraph {
     helper.ReadAllFields(reader);
   }
 
-  static JSONGraph Create(const ObjectRef& root) {
+  // The nodes and attributes, the tensors are stored separately.
+  void SaveBinary(dmlc::Stream* strm) const {
+    uint64_t root64 = root, num_nodes = nodes.size();
+    strm->Write(root64);
+    WriteAttrMap(strm, attrs);
+    strm->Write(num_nodes);
+    for (const JSONNode& jnode : nodes) {
+      jnode.SaveBinary(strm);
+    }
+  }
+
+  void LoadBinary(dmlc::Stream* strm) {
+    uint64_t root64, num_nodes;
+    ICHECK(strm->Read(&root64)) << "Invalid binary IR format";
+    root = root64;
+    ReadAttrMap(strm, &attrs);
+    ICHECK(strm->Read(&num_nodes)) << "Invalid binary IR format";
+    nodes.resize(num_nodes);
+    for (JSONNode& jnode : nodes) {
+      jnode.LoadBinary(strm);
+    }
+  }
+
+  /*!
+   * \brief Create the graph of root.
+   * \param root The root object.
+   * \param tensors If not nullptr, receives the tensors instead of b64ndarrays.
+   */
+  static JSONGraph Create(const ObjectRef& root,
+                          std::vector<runtime::NDArray>* tensors = nullptr) {
     JSONGraph g;
     NodeIndexer indexer;
     indexer.MakeIndex(const_cast<Object*>(root.get()));
@@ -488,6 +563,10 @@ struct JSONGraph {
     }
     g.attrs["tvm_version"] = TVM_VERSION;
     g.root = indexer.node_index_.at(const_cast<Object*>(root.get()));
+    if (tensors != nullptr) {
+      *tensors = std::move(indexer.ndarray_list_);
+      return g;
+    }
     // serialize tensor
     for (DLTensor* tensor : indexer.tensor_list_) {
       std::string blob;
@@ -534,6 +613,39 @@ struct JSONGraph {
     std::reverse(std::begin(topo_order), std::end(topo_order));
     return topo_order;
   }
+
+  // Create the objects of the graph, from its tensors.
+  ObjectRef Instantiate(const std::vector<runtime::NDArray>& tensors) {
+    ReflectionVTable* reflection = ReflectionVTable::Global();
+    size_t n_nodes = nodes.size();
+    // Pass 1: create all non-container objects
+    std::vector<ObjectPtr<Object>> objects(n_nodes, nullptr);
+    for (size_t i = 0; i < n_nodes; ++i) {
+      const JSONNode& jnode = nodes[i];
+      if (jnode.type_key.length() != 0) {
+        objects[i] = reflection->CreateInitObject(jnode.type_key, jnode.repr_bytes);
+      }
+    }
+    // Pass 2: figure out all field dependency
+    {
+      FieldDependencyFinder dep_finder;
+      for (size_t i = 0; i < n_nodes; ++i) {
+        dep_finder.Find(objects[i].get(), &nodes[i]);
+      }
+    }
+    // Pass 3: topo sort
+    std::vector<size_t> topo_order = TopoSort();
+    // Pass 4: set all values
+    {
+      JSONAttrSetter setter;
+      setter.node_list_ = &objects;
+      setter.tensor_list_ = &tensors;
+      for (size_t i : topo_order) {
+        setter.Set(&objects[i], &nodes[i]);
+      }
+    }
+    return ObjectRef(objects.at(root));
+  }
 };
 
 std::string SaveJSON(const ObjectRef& n) {
@@ -545,7 +657,6 @@ std::string SaveJSON(const ObjectRef& n) {
 }
 
 ObjectRef LoadJSON(std::string json_str) {
-  ReflectionVTable* reflection = ReflectionVTable::Global();
   JSONGraph jgraph;
   {
     // load in json graph.
@@ -553,7 +664,6 @@ ObjectRef LoadJSON(std::string json_str) {
     dmlc::JSONReader reader(&is);
     jgraph.Load(&reader);
   }
-  size_t n_nodes = jgraph.nodes.size();
   std::vector<runtime::NDArray> tensors;
   {
     // load in tensors
@@ -566,36 +676,103 @@ ObjectRef LoadJSON(std::string json_str) {
       tensors.emplace_back(std::move(temp));
     }
   }
-  // Pass 1: create all non-container objects
-  std::vector<ObjectPtr<Object>> nodes(n_nodes, nullptr);
-  for (size_t i = 0; i < n_nodes; ++i) {
-    const JSONNode& jnode = jgraph.nodes[i];
-    if (jnode.type_key.length() != 0) {
-      nodes[i] = reflection->CreateInitObject(jnode.type_key, jnode.repr_bytes);
-    }
-  }
-  // Pass 2: figure out all field dependency
+  return jgraph.Instantiate(tensors);
+}
+
+// The binary format: magic, reserved, the offset of the tensors, the graph, then the tensors at
+// that offset, saved as parameters named by their index with their data aligned in the blob.
+std::string SaveBinary(const ObjectRef& n) {
+  std::vector<runtime::NDArray> tensors;
+  auto jgraph = JSONGraph::Create(n, &tensors);
+  std::string graph;
   {
-    FieldDependencyFinder dep_finder;
-    for (size_t i = 0; i < n_nodes; ++i) {
-      dep_finder.Find(nodes[i].get(), &jgraph.nodes[i]);
-    }
+    dmlc::MemoryStringStream strm(&graph);
+    jgraph.SaveBinary(&strm);
   }
-  // Pass 3: topo sort
-  std::vector<size_t> topo_order = jgraph.TopoSort();
-  // Pass 4: set all values
-  {
-    JSONAttrSetter setter;
-    setter.node_list_ = &nodes;
-    setter.tensor_list_ = &tensors;
-    for (size_t i : topo_order) {
-      setter.Set(&nodes[i], &jgraph.nodes[i]);
-    }
+  Map<String, runtime::NDArray> arrays;
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    arrays.Set(std::to_string(i), tensors[i]);
+  }
+  uint64_t header = kTVMBinaryIRMagic, reserved = 0;
+  uint64_t graph_offset = 3 * sizeof(uint64_t);
+  uint64_t tensors_offset = (graph_offset + graph.size() + runtime::kAllocAlignment - 1) /
+                            runtime::kAllocAlignment * runtime::kAllocAlignment;
+  std::string blob;
+  dmlc::MemoryStringStream strm(&blob);
+  dmlc::Stream* fo = &strm;
+  fo->Write(header);
+  fo->Write(reserved);
+  fo->Write(tensors_offset);
+  fo->Write(graph.data(), graph.size());
+  blob.resize(tensors_offset, 0);
+  blob += runtime::SaveParams(arrays, runtime::kAllocAlignment);
+  return blob;
+}
+
+namespace {
+// Read the graph of a binary blob, returning the offset of its tensors.
+uint64_t LoadBinaryGraph(const char* data, size_t size, JSONGraph* jgraph) {
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(data), size);
+  dmlc::Stream* fi = &strm;
+  uint64_t header, reserved, tensors_offset;
+  ICHECK(fi->Read(&header) && fi->Read(&reserved) && fi->Read(&tensors_offset))
+      << "Invalid binary IR format";
+  ICHECK_EQ(header, kTVMBinaryIRMagic) << "Invalid binary IR format";
+  jgraph->LoadBinary(fi);
+  return tensors_offset;
+}
+
+std::vector<runtime::NDArray> UnpackTensors(const Map<String, runtime::NDArray>& arrays) {
+  std::vector<runtime::NDArray> tensors(arrays.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto it = arrays.find(std::to_string(i));
+    ICHECK(it != arrays.end()) << "Invalid binary IR format";
+    tensors[i] = (*it).second;
   }
-  return ObjectRef(nodes.at(jgraph.root));
+  return tensors;
+}
+}  // namespace
+
+ObjectRef LoadBinary(const std::string& blob) {
+  JSONGraph jgraph;
+  uint64_t tensors_offset = LoadBinaryGraph(blob.data(), blob.size(), &jgraph);
+  ICHECK_LE(tensors_offset, blob.size()) << "Invalid binary IR format";
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(blob.data()) + tensors_offset,
+                                   blob.size() - tensors_offset);
+  return jgraph.Instantiate(UnpackTensors(runtime::LoadParams(&strm)));
+}
+
+ObjectRef LoadBinaryFile(const std::string& file_name) {
+  std::ifstream fs(file_name, std::ios::in | std::ios::binary);
+  ICHECK(!fs.fail()) << "Cannot open file " << file_name;
+  uint64_t prefix[3];
+  ICHECK(fs.read(reinterpret_cast<char*>(prefix), sizeof(prefix))) << "Invalid binary IR format";
+  ICHECK_EQ(prefix[0], kTVMBinaryIRMagic) << "Invalid binary IR format";
+  ICHECK_GE(prefix[2], sizeof(prefix)) << "Invalid binary IR format";
+  // Only the graph is read, the tensors alias the mapping of the file.
+  std::string graph(prefix[2], '\0');
+  std::memcpy(&graph[0], prefix, sizeof(prefix));
+  ICHECK(fs.read(&graph[sizeof(prefix)], graph.size() - sizeof(prefix)))
+      << "Invalid binary IR format";
+  JSONGraph jgraph;
+  uint64_t tensors_offset = LoadBinaryGraph(graph.data(), graph.size(), &jgraph);
+  return jgraph.Instantiate(UnpackTensors(runtime::LoadParamsMapped(file_name, tensors_offset)));
 }
 
 TVM_REGISTER_GLOBAL("node.SaveJSON").set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON").set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string blob = SaveBinary(args[0]);
+  // copy return array so it is owned by the ret value
+  *rv = TVMByteArray{blob.data(), blob.size()};
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string blob = args[0];
+  *rv = LoadBinary(blob);
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinaryFile").set_body_typed(LoadBinaryFile);
 }  // namespace tvm
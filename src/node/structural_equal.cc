@@ -23,6 +23,7 @@
 #include <tvm/node/node.h>
 #include <tvm/node/reflection.h>
 #include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/registry.h>
 
 #include <unordered_map>
@@ -107,6 +108,7 @@ class RemapVarSEqualHandler : public SEqualReducer::Handler {
     pending_tasks_.clear();
     equal_map_lhs_.clear();
     equal_map_rhs_.clear();
+    if (!assert_mode_ && RejectByHash(lhs, rhs, map_free_vars)) return false;
     if (!SEqualReduce(lhs, rhs, map_free_vars)) return false;
     ICHECK_EQ(pending_tasks_.size(), 1U);
     ICHECK(allow_push_to_stack_);
@@ -116,6 +118,17 @@ class RemapVarSEqualHandler : public SEqualReducer::Handler {
   }
 
  protected:
+  /*!
+   * \brief Check whether the memoized hashes of the objects differ, equal objects have
+   *  equal hashes. Both objects need to be hashed before in a StructuralHashCache scope.
+   */
+  bool RejectByHash(const ObjectRef& lhs, const ObjectRef& rhs, bool map_free_vars) {
+    const StructuralHashCache* cache = StructuralHashCache::Current();
+    if (cache == nullptr || !lhs.defined() || !rhs.defined()) return false;
+    size_t lhs_hash, rhs_hash;
+    return cache->LookupRootHash(lhs, map_free_vars, &lhs_hash) &&
+           cache->LookupRootHash(rhs, map_free_vars, &rhs_hash) && lhs_hash != rhs_hash;
+  }
   // Check the result.
   bool CheckResult(bool result, const ObjectRef& lhs, const ObjectRef& rhs) {
     if (assert_mode_ && !result) {
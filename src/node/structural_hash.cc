@@ -27,7 +27,10 @@
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "../support/str_escape.h"
 #include "../support/utils.h"
@@ -71,13 +74,17 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     bool graph_node_hash{false};
     /*! \brief whether to map the free variables. */
     bool map_free_vars;
+    /*! \brief Whether the hash does not depend on the enclosing IR. */
+    bool closed{true};
+    /*! \brief The location in the memo log when the children were expanded. */
+    size_t memo_log_index{0};
 
     Task() = default;
     explicit Task(ObjectRef object, size_t reduced_hash, bool map_free_vars)
         : object(object), reduced_hash(reduced_hash), map_free_vars(map_free_vars) {}
   };
 
-  VarCountingSHashHandler() {}
+  VarCountingSHashHandler() : cache_(StructuralHashCache::Current()) {}
 
   void MarkGraphNode() final {
     // need to push to pending tasks in this case
@@ -86,9 +93,11 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
   }
 
   bool LookupHashedValue(const ObjectRef& key, size_t* hash_value) final {
+    // The result depends on what was hashed before.
+    if (!task_stack_.empty()) task_stack_.back().closed = false;
     auto it = hash_memo_.find(key);
     if (it != hash_memo_.end()) {
-      hash_value[0] = it->second;
+      hash_value[0] = it->second.first;
       return true;
     }
     return false;
@@ -109,6 +118,8 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
       size_t value = std::hash<const runtime::Object*>()(var);
       pending_tasks_.emplace_back(Task(ObjectRef(nullptr), value, false));
     }
+    // The same var is counted where it is defined.
+    pending_tasks_.back().closed = false;
   }
 
   void SHashReduce(const ObjectRef& object, bool map_free_vars) final {
@@ -121,7 +132,8 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     }
     auto it = hash_memo_.find(object);
     if (it != hash_memo_.end()) {
-      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), it->second, false));
+      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), it->second.first, false));
+      pending_tasks_.back().closed = it->second.second;
     } else {
       // Push a pending task with initial value.
       pending_tasks_.emplace_back(Task(object, object->GetTypeKeyHash(), map_free_vars));
@@ -133,6 +145,10 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     ICHECK_EQ(pending_tasks_.size(), 0U);
     ICHECK_EQ(result_stack_.size(), 0U);
 
+    if (cache_ != nullptr && object.defined()) {
+      auto it = cache_->root_hash_[map_free_vars].find(object);
+      if (it != cache_->root_hash_[map_free_vars].end()) return it->second;
+    }
     this->SHashReduce(object, map_free_vars);
     ICHECK_EQ(pending_tasks_.size(), 1U);
     ICHECK(allow_push_to_stack_);
@@ -144,6 +160,10 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     ICHECK_EQ(result_stack_.size(), 1U);
     size_t ret = result_stack_.back();
     result_stack_.pop_back();
+    result_closed_.pop_back();
+    if (cache_ != nullptr && object.defined()) {
+      cache_->root_hash_[map_free_vars][object] = ret;
+    }
     return ret;
   }
 
@@ -154,24 +174,56 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
   void PopTaskStack() {
     const auto& entry = task_stack_.back();
     result_stack_.push_back(entry.reduced_hash);
+    result_closed_.push_back(entry.closed);
     task_stack_.pop_back();
   }
   /*!
    * \brief Compute the reduced hash value for the task.
-   * \param task The indicated task.
+   * \param task The indicated task, closed unless one of its children is not.
    */
-  size_t ReduceHash(const Task& task) {
-    size_t stack_begin = task.result_stack_index;
+  size_t ReduceHash(Task* task) {
+    size_t stack_begin = task->result_stack_index;
     ICHECK_LE(stack_begin, result_stack_.size());
 
     // combine in the reverse order of the stack.
-    size_t reduced_hash = task.reduced_hash;
+    size_t reduced_hash = task->reduced_hash;
     for (size_t i = result_stack_.size(); i != stack_begin; --i) {
       reduced_hash = support::HashCombine(reduced_hash, result_stack_[i - 1]);
+      task->closed = task->closed && result_closed_[i - 1];
     }
     result_stack_.resize(stack_begin);
+    result_closed_.resize(stack_begin);
     return reduced_hash;
   }
+  /*!
+   * \brief Memoize the hash of an object.
+   * \param object The object.
+   * \param hash The hash.
+   * \param closed Whether the hash does not depend on the enclosing IR.
+   */
+  void Memoize(const ObjectRef& object, size_t hash, bool closed) {
+    hash_memo_[object] = std::make_pair(hash, closed);
+    if (cache_ != nullptr) memo_log_.emplace_back(object, hash);
+  }
+  /*!
+   * \brief Reuse the cached hash of a closed subtree.
+   * \param task The task of the subtree.
+   * \return Whether the subtree was cached.
+   */
+  bool LookupClosedHash(Task* task) {
+    auto& closed_hash = cache_->closed_hash_[task->map_free_vars];
+    auto it = closed_hash.find(task->object);
+    if (it == closed_hash.end()) return false;
+    // Memoize the objects of the subtree, as hashing it would,
+    // the hashes of the maps keyed by objects depend on them.
+    for (const auto& kv : it->second.descendants) {
+      if (!hash_memo_.count(kv.first)) this->Memoize(kv.first, kv.second, true);
+    }
+    task->reduced_hash = it->second.hash;
+    task->closed = true;
+    this->Memoize(task->object, task->reduced_hash, true);
+    return true;
+  }
   // run the tasks.
   void RunTasks() {
     while (task_stack_.size() != 0) {
@@ -179,21 +231,30 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
       auto& entry = task_stack_.back();
       if (entry.children_expanded) {
         // reduce hash
-        entry.reduced_hash = ReduceHash(entry);
+        entry.reduced_hash = ReduceHash(&entry);
         // When all the children has expanded and visited.
         // entry.reduced_hash contains the reduced hash result.
         auto it = hash_memo_.find(entry.object);
         if (it != hash_memo_.end()) {
           // use the pre-computed hash for the object.
-          entry.reduced_hash = it->second;
+          entry.reduced_hash = it->second.first;
+          entry.closed = it->second.second;
         } else {
           // Append the graph node counter to the hash
           // so that we can distinguish DAG from trees.
           if (entry.graph_node_hash) {
             entry.reduced_hash = support::HashCombine(entry.reduced_hash,
                                                       std::hash<size_t>()(graph_node_counter_++));
+            entry.closed = false;
+          }
+          if (cache_ != nullptr && entry.closed) {
+            StructuralHashCache::ClosedHash closed_hash;
+            closed_hash.hash = entry.reduced_hash;
+            closed_hash.descendants.assign(memo_log_.begin() + entry.memo_log_index,
+                                           memo_log_.end());
+            cache_->closed_hash_[entry.map_free_vars][entry.object] = std::move(closed_hash);
           }
-          hash_memo_[entry.object] = entry.reduced_hash;
+          this->Memoize(entry.object, entry.reduced_hash, entry.closed);
         }
         // send value to parent.
         this->PopTaskStack();
@@ -204,13 +265,17 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
         // check if there are already hash for object.
         auto it = hash_memo_.find(entry.object);
         if (it != hash_memo_.end()) {
-          entry.reduced_hash = it->second;
+          entry.reduced_hash = it->second.first;
+          entry.closed = it->second.second;
+          this->PopTaskStack();
+        } else if (cache_ != nullptr && this->LookupClosedHash(&entry)) {
           this->PopTaskStack();
         } else {
           // NOTE: important to modify entry before visit.
           // as entry becomes invalid after we change the stack.
           entry.children_expanded = true;
           entry.result_stack_index = result_stack_.size();
+          entry.memo_log_index = memo_log_.size();
 
           ICHECK_EQ(pending_tasks_.size(), 0U);
           allow_push_to_stack_ = false;
@@ -246,10 +311,17 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
   std::vector<Task> task_stack_;
   // Internal stack to store the result poped from the task stack.
   std::vector<size_t> result_stack_;
+  // Whether each result of the result stack is closed.
+  std::vector<bool> result_closed_;
   // reflection vtable
   ReflectionVTable* vtable_ = ReflectionVTable::Global();
-  // map from lhs to rhs
-  std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual> hash_memo_;
+  // map from the objects to their hash, and whether it is closed.
+  std::unordered_map<ObjectRef, std::pair<size_t, bool>, ObjectPtrHash, ObjectPtrEqual>
+      hash_memo_;
+  // The innermost cache scope, or nullptr.
+  StructuralHashCache* cache_;
+  // The objects in the order they were memoized, with a cache scope.
+  std::vector<std::pair<ObjectRef, size_t>> memo_log_;
 };
 
 TVM_REGISTER_GLOBAL("node.StructuralHash")
@@ -262,6 +334,40 @@ size_t StructuralHash::operator()(const ObjectRef& object) const {
   return VarCountingSHashHandler().Hash(object, false);
 }
 
+namespace {
+StructuralHashCache*& CurrentStructuralHashCache() {
+  static thread_local StructuralHashCache* current = nullptr;
+  return current;
+}
+
+// The scopes entered from the frontends.
+std::vector<std::unique_ptr<With<StructuralHashCache>>>& FrontendStructuralHashCaches() {
+  static thread_local std::vector<std::unique_ptr<With<StructuralHashCache>>> scopes;
+  return scopes;
+}
+}  // namespace
+
+StructuralHashCache* StructuralHashCache::Current() { return CurrentStructuralHashCache(); }
+
+void StructuralHashCache::EnterWithScope() {
+  prev_ = CurrentStructuralHashCache();
+  CurrentStructuralHashCache() = this;
+}
+
+void StructuralHashCache::ExitWithScope() {
+  ICHECK(CurrentStructuralHashCache() == this);
+  CurrentStructuralHashCache() = prev_;
+}
+
+TVM_REGISTER_GLOBAL("node.StructuralHashCacheEnter").set_body_typed([]() {
+  FrontendStructuralHashCaches().emplace_back(new With<StructuralHashCache>());
+});
+
+TVM_REGISTER_GLOBAL("node.StructuralHashCacheExit").set_body_typed([]() {
+  ICHECK(!FrontendStructuralHashCaches().empty()) << "No structural hash cache scope to exit";
+  FrontendStructuralHashCaches().pop_back();
+});
+
 // SEQualReduce traits for runtime containers.
 struct StringObjTrait {
   static constexpr const std::nullptr_t VisitAttrs = nullptr;
@@ -31,8 +31,11 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 
+#include <algorithm>
 #include <fstream>
+#include <thread>
 
 #include "./meta_ref.h"
 #include "./op_table.h"
@@ -328,6 +331,27 @@ class Parser {
     InitializeTypeDefs();
   }
 
+  /*!
+   * \brief A parser of a part of the tokens, starting from the state of the parent parser.
+   * \param parent The parent parser.
+   * \param ctx The diagnostic context of the parser.
+   * \param tokens The tokens, ending with kEndOfFile.
+   */
+  Parser(const Parser& parent, DiagnosticContext ctx, std::vector<Token> tokens)
+      : version(parent.version),
+        module(parent.module),
+        diag_ctx(ctx),
+        source(parent.source),
+        pos(0),
+        tokens(std::move(tokens)),
+        op_table(parent.op_table),
+        ignore_whitespace(true),
+        global_names(parent.global_names),
+        type_names(parent.type_names),
+        ctors(parent.ctors),
+        graph_ctx(parent.graph_ctx),
+        meta_table(parent.meta_table) {}
+
   /*! If we are parsing into a module with previously loaded data types we need to
    * map constructor names and variable names in the global tables.
    */
@@ -719,7 +743,10 @@ class Parser {
     // Parse the semver header at the top of the module.
     this->version = ParseSemVer();
     // Parse the definitions.
-    auto defs = ParseDefinitions();
+    Definitions defs;
+    if (!ParseDefinitionsInParallel(&defs)) {
+      defs = ParseDefinitions();
+    }
     // Parse the metadata section at the end.
     auto metadata = ParseMetadata();
 
@@ -792,6 +819,144 @@ class Parser {
     }
   }
 
+  /*!
+   * \brief Parse the definitions of a large module with one parser per thread.
+   *
+   *  The type definitions are parsed first and the names of the functions are interned in
+   *  order, then each thread parses a contiguous chunk of the functions, with a copy of the
+   *  parser on the tokens of the chunk. The result is only used when no chunk emitted a
+   *  diagnostic or interned a name of its own, so that it is the result of the sequential
+   *  parse. Otherwise the state of the parser is restored and the caller parses in order.
+   *
+   * \param defs The parsed definitions.
+   * \return Whether the definitions were parsed.
+   */
+  bool ParseDefinitionsInParallel(Definitions* defs) {
+    // The tokens of a module large enough to parse in parallel.
+    constexpr size_t kMinParallelTokens = 1 << 14;
+    int num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    Peek();
+    size_t begin = pos;
+    if (num_threads < 2 || tokens.size() - begin < kMinParallelTokens) return false;
+
+    // Split the definitions at their keywords outside of any braces, the types first.
+    std::vector<size_t> type_begins, func_begins;
+    size_t end = begin;
+    for (int depth = 0; end < tokens.size(); ++end) {
+      TokenType token_type = tokens[end]->token_type;
+      if (token_type == TokenType::kLCurly) {
+        ++depth;
+      } else if (token_type == TokenType::kRCurly) {
+        --depth;
+      } else if (depth == 0 && token_type == TokenType::kEndOfFile) {
+        break;
+      } else if (depth == 0 && token_type == TokenType::kDefn) {
+        func_begins.push_back(end);
+      } else if (depth == 0 && token_type == TokenType::kTypeDef) {
+        if (!func_begins.empty()) return false;
+        type_begins.push_back(end);
+      } else if (depth == 0 && token_type == TokenType::kExtern) {
+        return false;
+      }
+    }
+    int num_chunks = std::min(num_threads, static_cast<int>(func_begins.size()));
+    if (num_chunks < 2 || type_begins.size() + func_begins.size() == 0 ||
+        (type_begins.empty() ? func_begins[0] : type_begins[0]) != begin) {
+      return false;
+    }
+    func_begins.push_back(end);
+
+    auto saved_global_names = global_names;
+    auto saved_type_names = type_names;
+    auto saved_ctors = ctors;
+    auto saved_diagnostics = diag_ctx->diagnostics;
+    auto restore = [&]() {
+      pos = begin;
+      global_names = saved_global_names;
+      type_names = saved_type_names;
+      ctors = saved_ctors;
+      diag_ctx->diagnostics = saved_diagnostics;
+      return false;
+    };
+
+    Definitions parsed;
+    try {
+      for (size_t i = 0; i < type_begins.size(); ++i) {
+        pos = type_begins[i];
+        parsed.types.push_back(ParseTypeDef());
+        size_t next = i + 1 < type_begins.size() ? type_begins[i + 1] : func_begins[0];
+        if (static_cast<size_t>(pos) != next) return restore();
+      }
+    } catch (const std::exception& e) {
+      return restore();
+    }
+    if (diag_ctx->diagnostics.size() != saved_diagnostics.size()) return restore();
+    for (size_t i = 0; i + 1 < func_begins.size(); ++i) {
+      const Token& global_tok = tokens[func_begins[i] + 1];
+      if (global_tok->token_type != TokenType::kGlobal) return restore();
+      AddOrGet(&global_names, global_tok.ToString());
+    }
+
+    // Balance the chunks by their number of tokens.
+    size_t num_funcs = func_begins.size() - 1;
+    std::vector<size_t> chunk_begins{0};
+    for (int chunk = 1; chunk < num_chunks; ++chunk) {
+      size_t target = func_begins[0] + (end - func_begins[0]) * chunk / num_chunks;
+      size_t func = chunk_begins.back() + 1;
+      while (func < num_funcs && func_begins[func] < target) ++func;
+      if (func < num_funcs) chunk_begins.push_back(func);
+    }
+    chunk_begins.push_back(num_funcs);
+    num_chunks = static_cast<int>(chunk_begins.size()) - 1;
+
+    std::vector<std::vector<GlobalFunc>> chunk_funcs(num_chunks);
+    std::vector<std::unordered_map<int, Expr>> chunk_graph_ctx(num_chunks);
+    std::vector<char> chunk_ok(num_chunks, 0);
+    auto renderer = DiagnosticRenderer([](DiagnosticContext ctx) {});
+    support::parallel_for(0, num_chunks, [&](int chunk) {
+      size_t first = func_begins[chunk_begins[chunk]];
+      size_t last = func_begins[chunk_begins[chunk + 1]];
+      std::vector<Token> chunk_tokens(tokens.begin() + first, tokens.begin() + last);
+      chunk_tokens.push_back(Token(tokens[last]->span, TokenType::kEndOfFile));
+      Parser parser(*this, DiagnosticContext(module, renderer), std::move(chunk_tokens));
+      try {
+        while (parser.Peek()->token_type == TokenType::kDefn) {
+          parser.Consume(TokenType::kDefn);
+          auto global = parser.global_names.Get(parser.Match(TokenType::kGlobal).ToString());
+          auto func = parser.WithSpan<relay::Function>([&]() { return parser.ParseFunctionDef(); });
+          chunk_funcs[chunk].push_back(GlobalFunc(global.value(), func));
+        }
+        chunk_ok[chunk] = parser.Peek()->token_type == TokenType::kEndOfFile &&
+                          parser.diag_ctx->diagnostics.empty() &&
+                          parser.global_names.table.size() == global_names.table.size() &&
+                          parser.type_names.table.size() == type_names.table.size();
+        chunk_graph_ctx[chunk] = std::move(parser.graph_ctx);
+      } catch (const std::exception& e) {
+        // A chunk that does not parse on its own, e.g. that uses the graph bindings of
+        // another chunk, is parsed again in order.
+      }
+    });
+
+    // The graph bindings are not scoped, a number bound in two chunks would bind the
+    // expression of the first one.
+    std::unordered_map<int, Expr> merged_graph_ctx = graph_ctx;
+    for (int chunk = 0; chunk < num_chunks; ++chunk) {
+      if (!chunk_ok[chunk]) return restore();
+      for (auto& kv : chunk_graph_ctx[chunk]) {
+        auto it = merged_graph_ctx.find(kv.first);
+        if (it != merged_graph_ctx.end() && !it->second.same_as(kv.second)) return restore();
+        merged_graph_ctx.insert(kv);
+      }
+      for (auto& func : chunk_funcs[chunk]) {
+        parsed.funcs.push_back(std::move(func));
+      }
+    }
+    graph_ctx = std::move(merged_graph_ctx);
+    pos = end;
+    *defs = std::move(parsed);
+    return true;
+  }
+
   /*! \brief Parse zero or more Relay type definitions. */
   TypeData ParseTypeDef() {
     // Match the `type` keyword.
@@ -858,10 +1023,18 @@ class Parser {
     return TypeData(type_global, generics, ctors);
   }
 
+  /*! \brief Whether a token starts where the previous token ends. */
+  static bool Adjacent(const Token& prev, const Token& next) {
+    return prev->span->end_line == next->span->line &&
+           prev->span->end_column == next->span->column;
+  }
+
   std::string HackTokensAsString(int n) {
     std::stringstream key;
     n = std::min(static_cast<int>(tokens.size() - pos), n);
     for (int i = 0; i < n; i++) {
+      // The tokens of an operator are not separated by whitespace, which is not tokenized.
+      if (i > 0 && !Adjacent(tokens.at(pos + i - 1), tokens.at(pos + i))) return "";
       key << ToString(tokens.at(pos + i)->token_type);
     }
     return key.str();
@@ -84,6 +84,10 @@ struct Tokenizer {
   char next_char;
   String source;
   std::vector<Token> tokens;
+  /*! \brief The metadata section, kUnknown when there is none. */
+  Token meta_table;
+  /*! \brief A `%` or `@` waiting for the token it prefixes. */
+  Token prefix;
 
   char Next() {
     char c = this->source.at(this->pos);
@@ -497,18 +501,18 @@ struct Tokenizer {
         return NewToken(TokenType::kDivision);
       }
     } else if (IsIdentLetter(next)) {
-      std::stringstream ss;
       // Due the below code we need to patch
       // the line/col info to the start of
       // token.
       int line = this->line;
       int col = this->col;
 
+      size_t start = this->pos;
       while (More() && IsIdent(Peek())) {
-        ss << Next();
+        Next();
       }
 
-      std::string keyword = ss.str();
+      std::string keyword(this->source.data() + start, this->pos - start);
       auto it = KEYWORD_TABLE.find(keyword);
 
       TokenType token_type;
@@ -526,7 +530,7 @@ struct Tokenizer {
       }
 
       auto span = SpanFrom(line, col);
-      return Token(span, token_type, tvm::String(ss.str()));
+      return Token(span, token_type, tvm::String(keyword));
     } else {
       std::stringstream ss;
       while (More() && !IsWhitespace(Peek())) {
@@ -538,114 +542,96 @@ struct Tokenizer {
     }
   }
 
-  void Tokenize() {
-    DLOG(INFO) << "tvm::parser::Tokenize";
-    while (this->More()) {
-      auto token = TokenizeOnce();
-      ICHECK(token.defined());
-      this->tokens.push_back(token);
+  /*!
+   * \brief Condense a token into the token stream as it is produced: drop the whitespace and
+   *  the comments the parser skips, and merge the `%` and `@` prefixes with the token after.
+   */
+  void Push(const Token& token) {
+    ICHECK(token.defined());
+    if (this->prefix.defined()) {
+      Token current = this->prefix;
+      this->prefix = Token();
+      // TODO(@jroesch): merge spans
+      if (token->token_type == TokenType::kIdentifier && current->token_type == TokenType::kAt) {
+        this->tokens.push_back(Token(current->span, TokenType::kGlobal, token->data));
+        return;
+      }
+      if (current->token_type == TokenType::kPercent &&
+          (token->token_type == TokenType::kIdentifier ||
+           token->token_type == TokenType::kInteger)) {
+        auto token_type = token->token_type == TokenType::kIdentifier ? TokenType::kLocal
+                                                                      : TokenType::kGraph;
+        this->tokens.push_back(Token(current->span, token_type, token->data));
+        return;
+      }
+      this->tokens.push_back(current);
     }
-    this->tokens.push_back(NewToken(TokenType::kEndOfFile));
-  }
 
-  explicit Tokenizer(const DiagnosticContext& ctx, const Source& source)
-      : diag_ctx(ctx),
-        source_name(source->source_name),
-        pos(0),
-        col(1),
-        line(1),
-        source(source->source),
-        tokens() {}
-};
-
-std::vector<Token> Condense(const std::vector<Token>& tokens, Token* table) {
-  std::vector<Token> out;
-  bool found_metadata = false;
-
-  for (size_t i = 0; i < tokens.size(); i++) {
-    auto current = tokens.at(i);
-    switch (current->token_type) {
+    switch (token->token_type) {
+      case TokenType::kWhitespace:
+      case TokenType::kNewline:
+      case TokenType::kLineComment:
+      case TokenType::kComment:
+        return;
+      case TokenType::kPercent:
+      case TokenType::kAt:
+        this->prefix = token;
+        return;
       case TokenType::kMetadata: {
-        if (!found_metadata) {
-          found_metadata = true;
-          *table = current;
-        } else {
+        if (this->meta_table->token_type != TokenType::kUnknown) {
           LOG(FATAL) << "duplicate metadata section";
         }
-        continue;
-      }
-      case TokenType::kPercent: {
-        auto next = tokens.at(i + 1);
-        if (next->token_type == TokenType::kIdentifier) {
-          // Match this token.
-          i += 1;
-          // TODO(@jroesch): merge spans
-          auto tok = Token(current->span, TokenType::kLocal, next->data);
-          ICHECK(tok.defined());
-          out.push_back(tok);
-        } else if (next->token_type == TokenType::kInteger) {
-          i += 1;
-          auto tok = Token(current->span, TokenType::kGraph, next->data);
-          ICHECK(tok.defined());
-          out.push_back(tok);
-        } else {
-          ICHECK(current.defined());
-          out.push_back(current);
-        }
-        continue;
-      }
-      case TokenType::kAt: {
-        auto next = tokens.at(i + 1);
-        if (next->token_type == TokenType::kIdentifier) {
-          // Match this token.
-          i += 1;
-          // TODO(@jroesch): merge spans
-          auto tok = Token(current->span, TokenType::kGlobal, next->data);
-          ICHECK(tok.defined());
-          out.push_back(tok);
-        } else {
-          ICHECK(current.defined());
-          out.push_back(current);
-        }
-        continue;
+        this->meta_table = token;
+        return;
       }
       case TokenType::kIdentifier: {
-        std::string str = Downcast<tvm::String>(current->data);
-        Token tok;
+        std::string str = Downcast<tvm::String>(token->data);
         // TODO(@jroesch): merge spans
         if (str == "True") {
-          auto data = tvm::Integer(1);
-          tok = Token(current->span, TokenType::kBoolean, data);
+          this->tokens.push_back(Token(token->span, TokenType::kBoolean, tvm::Integer(1)));
         } else if (str == "False") {
-          auto data = tvm::Integer(0);
-          tok = Token(current->span, TokenType::kBoolean, data);
+          this->tokens.push_back(Token(token->span, TokenType::kBoolean, tvm::Integer(0)));
         } else if (str == "_") {
-          tok = Token(current->span, TokenType::kUnderscore);
+          this->tokens.push_back(Token(token->span, TokenType::kUnderscore));
         } else {
-          tok = current;
+          this->tokens.push_back(token);
         }
-        out.push_back(tok);
-        continue;
+        return;
       }
-      default: {
-        out.push_back(current);
+      default:
+        this->tokens.push_back(token);
+        return;
+    }
+  }
+
+  void Tokenize() {
+    DLOG(INFO) << "tvm::parser::Tokenize";
+    while (this->More()) {
+      // Skip the whitespace without making tokens of it, unless it ends a `%` or `@`.
+      if (IsWhitespace(Peek()) && !this->prefix.defined()) {
+        Next();
         continue;
       }
+      Push(TokenizeOnce());
     }
+    Push(NewToken(TokenType::kEndOfFile));
   }
 
-  return out;
-}
+  explicit Tokenizer(const DiagnosticContext& ctx, const Source& source)
+      : diag_ctx(ctx),
+        source_name(source->source_name),
+        pos(0),
+        col(1),
+        line(1),
+        source(source->source),
+        tokens(),
+        meta_table(Span(), TokenType::kUnknown, ObjectRef()) {}
+};
 
 std::pair<std::vector<Token>, Token> Tokenize(const DiagnosticContext& ctx, const Source& source) {
   auto tokenizer = Tokenizer(ctx, source);
   tokenizer.Tokenize();
-  Token meta_table(Span(), TokenType::kUnknown, ObjectRef());
-  auto tokens = Condense(tokenizer.tokens, &meta_table);
-  for (auto token : tokens) {
-    ICHECK(token.defined());
-  }
-  return {tokens, meta_table};
+  return {std::move(tokenizer.tokens), tokenizer.meta_table};
 }
 
 }  // namespace parser
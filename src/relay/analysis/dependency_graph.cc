@@ -25,8 +25,8 @@
 
 #include <tvm/relay/expr_functor.h>
 
-#include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace tvm {
 namespace relay {
@@ -50,9 +50,10 @@ class DependencyGraph::Creator : private MixedModeVisitor {
   void Depend(DependencyGraph::Node* parent, const Expr& child) {
     VisitExpr(child);
 
-    ICHECK_NE(graph_.expr_node.count(child), 0);
+    auto it = graph_.expr_node.find(child);
+    ICHECK(it != graph_.expr_node.end());
 
-    Depend(parent, graph_.expr_node[child]);
+    Depend(parent, it->second);
   }
 
   void Depend(DependencyGraph::Node* parent, DependencyGraph::Node* child) {
@@ -65,22 +66,30 @@ class DependencyGraph::Creator : private MixedModeVisitor {
     parent->children.Push(child_link);
   }
 
-  std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual> visited_;
-
   DependencyGraph::Node* NewNode(bool new_scope) {
     auto* ret = arena_->make<DependencyGraph::Node>();
     ret->new_scope = new_scope;
     return ret;
   }
 
+  // Get the node of an expression, created on first use.
+  DependencyGraph::Node* GetNode(const Expr& e) {
+    DependencyGraph::Node*& n = graph_.expr_node[e];
+    if (n == nullptr) n = NewNode(false);
+    return n;
+  }
+
+  void AddToOrder(DependencyGraph::Node* n) {
+    n->index = graph_.post_dfs_order.size();
+    graph_.post_dfs_order.push_back(n);
+  }
+
   void VisitLeaf(const Expr& e) override {
-    if (visited_.count(e) == 0) {
-      if (graph_.expr_node.count(e) == 0) {
-        graph_.expr_node[e] = NewNode(false);
-      }
-      visited_.insert(e);
+    // The nodes of the inner lets of a chain exist before their visit, and have been visited.
+    if (graph_.expr_node.count(e) == 0) {
+      DependencyGraph::Node* n = GetNode(e);
       MixedModeVisitor::VisitLeaf(e);
-      graph_.post_dfs_order.push_back(graph_.expr_node[e]);
+      AddToOrder(n);
     }
   }
 
@@ -129,8 +138,8 @@ class DependencyGraph::Creator : private MixedModeVisitor {
     Depend(n, f);
     Depend(t, i->true_branch);
     Depend(f, i->false_branch);
-    graph_.post_dfs_order.push_back(f);
-    graph_.post_dfs_order.push_back(t);
+    AddToOrder(f);
+    AddToOrder(t);
   }
 
   void VisitExpr_(const FunctionNode* f) final {
@@ -141,17 +150,32 @@ class DependencyGraph::Creator : private MixedModeVisitor {
       Depend(b, p);
     }
     Depend(b, f->body);
-    graph_.post_dfs_order.push_back(b);
+    AddToOrder(b);
   }
 
   void VisitExpr_(const LetNode* l) final {
-    DependencyGraph::Node* n = graph_.expr_node[GetRef<Expr>(l)];
-    DependencyGraph::Node* b = NewNode(true);
-    Depend(n, b);
-    Depend(b, l->var);
-    Depend(b, l->value);
-    Depend(b, l->body);
-    graph_.post_dfs_order.push_back(b);
+    // The chains of lets are walked without recursion, in the order of the recursive visit.
+    std::vector<DependencyGraph::Node*> scopes;
+    auto pre_visit = [this, &scopes](const LetNode* op) {
+      DependencyGraph::Node* n = GetNode(GetRef<Expr>(op));
+      DependencyGraph::Node* b = NewNode(true);
+      Depend(n, b);
+      Depend(b, op->var);
+      Depend(b, op->value);
+      if (op->body.as<LetNode>()) {
+        Depend(b, GetNode(op->body));
+      } else {
+        Depend(b, op->body);
+      }
+      scopes.push_back(b);
+    };
+    auto post_visit = [this, l, &scopes](const LetNode* op) {
+      AddToOrder(scopes.back());
+      scopes.pop_back();
+      // The node of the outermost let is added by VisitLeaf.
+      if (op != l) AddToOrder(graph_.expr_node[GetRef<Expr>(op)]);
+    };
+    ExpandANormalForm(l, pre_visit, post_visit);
   }
 
   void VisitExpr_(const MatchNode* m) final {
@@ -165,7 +189,7 @@ class DependencyGraph::Creator : private MixedModeVisitor {
       v.push_back(b);
     }
     for (auto it = v.rbegin(); it != v.rend(); ++it) {
-      graph_.post_dfs_order.push_back(*it);
+      AddToOrder(*it);
     }
   }
 
@@ -41,6 +41,10 @@ using support::LinkNode;
 /* DependencyGraph track input and output of an Expr.
  * Additionally, dummy scope is created to model scope.
  * It allow us to traverse the graph in reverse order.
+ *
+ * The graph is built without recursion on dataflow nodes and chains of lets,
+ * and the nodes are numbered in post DFS order, so that the analyses over the
+ * graph keep their per node data in vectors rather than maps.
  */
 class DependencyGraph {
  public:
@@ -49,6 +53,8 @@ class DependencyGraph {
     // Determine scope boundaries. Used for calculating scopes, not for
     // constructing dependency graph.
     bool new_scope = false;
+    // The position of the node in the post DFS order, to index per node data by.
+    size_t index = 0;
     // incoming edges
     LinkedList<Node*> children;
     // outgoing edges
@@ -0,0 +1,266 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file layout_plan.cc
+ * \brief Global selection of the schedules, hence the layouts, of the
+ *  layout-sensitive operators of a graph.
+ *
+ * Every node of the graph chooses one of its candidates, with the cost of
+ * its kernel. Every edge has the cost of the layout transformation between
+ * the choices of its ends. The total cost is minimized as a partitioned
+ * boolean quadratic problem (Hames and Scholz, Nearly optimal register
+ * allocation with PBQP, JMLC 2006): nodes of degree up to two are reduced
+ * exactly, larger degrees are decided greedily.
+ */
+#include <tvm/ir/expr.h>
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+// A dense row-major cost table.
+struct CostMatrix {
+  CostMatrix(size_t rows, size_t cols) : rows(rows), cols(cols), data(rows * cols, 0) {}
+
+  double& operator()(size_t i, size_t j) { return data[i * cols + j]; }
+  double operator()(size_t i, size_t j) const { return data[i * cols + j]; }
+
+  size_t rows;
+  size_t cols;
+  std::vector<double> data;
+};
+
+// An edge as seen from one of its ends. The two ends share one cost table, indexed by the
+// choices of the end that stores it first.
+struct EdgeRef {
+  double operator()(size_t mine, size_t theirs) const {
+    return transposed ? (*cost)(theirs, mine) : (*cost)(mine, theirs);
+  }
+
+  std::shared_ptr<CostMatrix> cost;
+  bool transposed;
+};
+
+class LayoutPlanSolver {
+ public:
+  explicit LayoutPlanSolver(std::vector<std::vector<double>> costs)
+      : costs_(std::move(costs)),
+        adj_(costs_.size()),
+        reduced_(costs_.size(), false),
+        choice_(costs_.size(), -1) {
+    for (size_t i = 0; i < costs_.size(); ++i) by_degree_.emplace(0, i);
+  }
+
+  // Add the cost table, indexed by the choices of u then v, of an edge.
+  void AddEdge(int u, int v, const CostMatrix& cost) {
+    ICHECK_NE(u, v) << "Self edges are not supported";
+    ICHECK_EQ(cost.rows, costs_[u].size());
+    ICHECK_EQ(cost.cols, costs_[v].size());
+    auto it = adj_[u].find(v);
+    if (it == adj_[u].end()) {
+      SetDegree(u, adj_[u].size() + 1);
+      SetDegree(v, adj_[v].size() + 1);
+      auto shared = std::make_shared<CostMatrix>(cost);
+      adj_[u][v] = EdgeRef{shared, false};
+      adj_[v][u] = EdgeRef{shared, true};
+      return;
+    }
+    const EdgeRef& edge = it->second;
+    for (size_t i = 0; i < cost.rows; ++i) {
+      for (size_t j = 0; j < cost.cols; ++j) {
+        if (edge.transposed) {
+          (*edge.cost)(j, i) += cost(i, j);
+        } else {
+          (*edge.cost)(i, j) += cost(i, j);
+        }
+      }
+    }
+  }
+
+  std::vector<int> Solve() {
+    while (!by_degree_.empty()) {
+      int node = by_degree_.begin()->second;
+      size_t degree = adj_[node].size();
+      if (degree == 1) {
+        ReduceI(node);
+      } else if (degree == 2) {
+        ReduceII(node);
+      } else if (degree > 2) {
+        // All the nodes have a degree larger than two, decide the most connected one.
+        node = by_degree_.rbegin()->second;
+        ReduceN(node);
+      }
+      Remove(node);
+    }
+    // Choose the best candidate of the reduced nodes given their neighbors, in reverse order.
+    for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+      int node = it->first;
+      if (choice_[node] >= 0) continue;
+      std::vector<double> cost = costs_[node];
+      for (const auto& kv : it->second) {
+        ICHECK_GE(choice_[kv.first], 0);
+        for (size_t i = 0; i < cost.size(); ++i) cost[i] += kv.second(i, choice_[kv.first]);
+      }
+      choice_[node] = ArgMin(cost);
+    }
+    return choice_;
+  }
+
+ private:
+  static int ArgMin(const std::vector<double>& values) {
+    ICHECK(!values.empty()) << "A node of the layout plan has no candidate";
+    return std::min_element(values.begin(), values.end()) - values.begin();
+  }
+
+  void SetDegree(int u, size_t degree) {
+    by_degree_.erase({adj_[u].size(), u});
+    by_degree_.emplace(degree, u);
+  }
+
+  // Fold a node of degree one into its neighbor.
+  void ReduceI(int u) {
+    const auto& edge = *adj_[u].begin();
+    int v = edge.first;
+    for (size_t j = 0; j < costs_[v].size(); ++j) {
+      double best = std::numeric_limits<double>::infinity();
+      for (size_t i = 0; i < costs_[u].size(); ++i) {
+        best = std::min(best, costs_[u][i] + edge.second(i, j));
+      }
+      costs_[v][j] += best;
+    }
+  }
+
+  // Replace a node of degree two by an edge between its neighbors.
+  void ReduceII(int u) {
+    auto it = adj_[u].begin();
+    int v = it->first;
+    const EdgeRef& uv = it->second;
+    ++it;
+    int w = it->first;
+    const EdgeRef& uw = it->second;
+    CostMatrix delta(costs_[v].size(), costs_[w].size());
+    for (size_t j = 0; j < delta.rows; ++j) {
+      for (size_t k = 0; k < delta.cols; ++k) {
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < costs_[u].size(); ++i) {
+          best = std::min(best, costs_[u][i] + uv(i, j) + uw(i, k));
+        }
+        delta(j, k) = best;
+      }
+    }
+    AddEdge(v, w, delta);
+  }
+
+  // Decide the choice of a node from the best choices of its neighbors.
+  void ReduceN(int u) {
+    std::vector<double> cost = costs_[u];
+    for (const auto& kv : adj_[u]) {
+      const std::vector<double>& neighbor = costs_[kv.first];
+      for (size_t i = 0; i < cost.size(); ++i) {
+        double best = std::numeric_limits<double>::infinity();
+        for (size_t j = 0; j < neighbor.size(); ++j) {
+          best = std::min(best, kv.second(i, j) + neighbor[j]);
+        }
+        cost[i] += best;
+      }
+    }
+    int choice = ArgMin(cost);
+    choice_[u] = choice;
+    for (const auto& kv : adj_[u]) {
+      std::vector<double>& neighbor = costs_[kv.first];
+      for (size_t j = 0; j < neighbor.size(); ++j) neighbor[j] += kv.second(choice, j);
+    }
+  }
+
+  void Remove(int u) {
+    for (const auto& kv : adj_[u]) {
+      SetDegree(kv.first, adj_[kv.first].size() - 1);
+      adj_[kv.first].erase(u);
+    }
+    by_degree_.erase({adj_[u].size(), u});
+    stack_.emplace_back(u, std::move(adj_[u]));
+    adj_[u].clear();
+    reduced_[u] = true;
+  }
+
+  /*! \brief The cost of the candidates of each node. */
+  std::vector<std::vector<double>> costs_;
+  /*! \brief The edges of the remaining graph. */
+  std::vector<std::map<int, EdgeRef>> adj_;
+  /*! \brief The remaining nodes ordered by their degree. */
+  std::set<std::pair<size_t, int>> by_degree_;
+  /*! \brief The reduced nodes with their edges at the time of the reduction. */
+  std::vector<std::pair<int, std::map<int, EdgeRef>>> stack_;
+  /*! \brief Whether each node is reduced. */
+  std::vector<bool> reduced_;
+  /*! \brief The chosen candidate of each node. */
+  std::vector<int> choice_;
+};
+
+// Read a float64 NDArray of rank one or two.
+static CostMatrix ToMatrix(const runtime::NDArray& array) {
+  ICHECK(array.DataType() == DataType::Float(64)) << "Layout plan costs must be float64";
+  std::vector<int64_t> shape = array.Shape();
+  ICHECK(shape.size() == 1 || shape.size() == 2);
+  int64_t rows = shape.size() == 1 ? 1 : shape[0];
+  int64_t cols = shape.back();
+  runtime::NDArray cpu_array = array.CopyTo({kDLCPU, 0});
+  const double* data = static_cast<const double*>(cpu_array->data);
+  CostMatrix ret(rows, cols);
+  std::copy(data, data + rows * cols, ret.data.begin());
+  return ret;
+}
+
+Array<Integer> SolveLayoutPlan(Array<runtime::NDArray> node_costs, Array<Array<Integer>> edges,
+                               Array<runtime::NDArray> edge_costs) {
+  ICHECK_EQ(edges.size(), edge_costs.size());
+  std::vector<std::vector<double>> costs;
+  for (const runtime::NDArray& cost : node_costs) {
+    costs.push_back(ToMatrix(cost).data);
+  }
+  LayoutPlanSolver solver(std::move(costs));
+  for (size_t i = 0; i < edges.size(); ++i) {
+    ICHECK_EQ(edges[i].size(), 2U);
+    int u = edges[i][0], v = edges[i][1];
+    ICHECK(u >= 0 && v >= 0 && u < static_cast<int>(node_costs.size()) &&
+           v < static_cast<int>(node_costs.size()))
+        << "Edge " << u << " -> " << v << " is out of the graph";
+    solver.AddEdge(u, v, ToMatrix(edge_costs[i]));
+  }
+  Array<Integer> ret;
+  for (int choice : solver.Solve()) ret.push_back(choice);
+  return ret;
+}
+
+TVM_REGISTER_GLOBAL("relay.analysis.SolveLayoutPlan").set_body_typed(SolveLayoutPlan);
+
+}  // namespace relay
+}  // namespace tvm
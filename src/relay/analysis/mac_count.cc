@@ -171,6 +171,10 @@ class MacCounter : private ExprVisitor {
   static int64_t GetTotalMacNumber(const Expr& expr) {
     LOG(INFO) << "This pass only counts MACs in direct conv2d, "
               << "conv2d_transpose, dense, and batch_matmul ops";
+    return Count(expr);
+  }
+
+  static int64_t Count(const Expr& expr) {
     MacCounter counter;
     counter(expr);
     return counter.count_;
@@ -192,5 +196,7 @@ int64_t GetTotalMacNumber(const Expr& expr) { return MacCounter::GetTotalMacNumb
 TVM_REGISTER_GLOBAL("relay.analysis.GetTotalMacNumber").set_body_typed(GetTotalMacNumber);
 
 }  // namespace mac_count
+
+int64_t CountMacs(const Expr& expr) { return mac_count::MacCounter::Count(expr); }
 }  // namespace relay
 }  // namespace tvm
@@ -23,6 +23,7 @@
  */
 
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/object.h>
@@ -34,9 +35,11 @@
 
 #include <algorithm>
 #include <list>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "../op/memory/memory.h"
 #include "compile_engine.h"
 #include "utils.h"
 
@@ -117,26 +120,55 @@ class AOTExecutorCodegen : public ExprVisitor {
   }
 
   /*!
-   * \brief Return a vector of variables that represents the sids for the given Relay Expr
+   * \brief Utility function to describe a tensor of the planned storage as a DLTensor on the
+   *  stack, so that the kernels can check its shape and type
+   * \param data the pointer to the storage of the tensor
+   * \param type the type of the tensor
+   * \return PrimExpr representing the DLTensor
    */
-  std::vector<tir::Var> PackSid(Expr expr) {
+  PrimExpr MakeDLTensor(PrimExpr data, const TensorType& type) {
+    Array<PrimExpr> shape;
+    for (const PrimExpr& dim : type->shape) {
+      shape.push_back(cast(DataType::Int(64), dim));
+    }
+    PrimExpr shape_array =
+        tir::Call(DataType::Handle(), tir::builtin::tvm_stack_make_shape(), shape);
+    return tir::Call(DataType::Handle(), tir::builtin::tvm_stack_make_array(),
+                     {data, shape_array, ConstInt32(0), ConstInt32(shape.size()),
+                      tir::make_zero(type->dtype), ConstInt32(0)});
+  }
+
+  /*!
+   * \brief Return a vector of expressions that represents the sids for the given Relay Expr
+   */
+  std::vector<PrimExpr> PackSid(Expr expr) {
     Array<IntegerArray> sids = storage_device_map_[expr];
-    std::vector<tir::Var> sid_vars;
+    std::vector<PrimExpr> sid_vars;
+    std::vector<TensorType> types;
+    if (host_runtime_) {
+      types = FlattenTupleType(expr->checked_type());
+      ICHECK_EQ(types.size(), sids[0].size());
+    }
 
     // Note that an expression can have multiple sids associated with it
     // e.g., returning multiple values from a function
-    for (const auto& sid : sids[0]) {
+    for (size_t i = 0; i < sids[0].size(); ++i) {
       // Determine if an sid is an output buffer
-      int sid_int = static_cast<int>((sid.as<IntImmNode>())->value);
+      int sid_int = static_cast<int>((sids[0][i].as<IntImmNode>())->value);
       auto output_iter = std::find(return_sid_.begin(), return_sid_.end(), sid_int);
       if (output_iter != return_sid_.end()) {
         int output_index = std::distance(return_sid_.begin(), output_iter);
         sid_vars.push_back(main_signature_[input_vars_.size() + output_index]);
         continue;
       }
+      if (host_runtime_) {
+        // The kernels check their arguments on the host runtime
+        sid_vars.push_back(MakeDLTensor(sids_table_[sid_int], types[i]));
+        continue;
+      }
       // Pack the sid inside the TVMValue
-      auto sid_array = te::Var(MakeString("sid_", sid, "_value"), DataType::Handle());
-      auto sid_value = sids_table_[sid];
+      auto sid_array = te::Var(MakeString("sid_", sid_int, "_value"), DataType::Handle());
+      auto sid_value = sids_table_[sid_int];
       tvm::PrimExpr set_tensor =
           tvm::tir::Call(DataType::Handle(), tvm::tir::builtin::tvm_struct_set(),
                          {sid_array, 0, tir::builtin::kArrData, sid_value});
@@ -153,6 +185,16 @@ class AOTExecutorCodegen : public ExprVisitor {
    */
   tir::Var PackParam(Expr expr) {
     int param_sid = param_storage_ids_[params_by_expr_[expr]];
+    if (host_runtime_) {
+      // The parameters are arguments of the main function, set once by the executor
+      std::string name = params_by_expr_[expr];
+      auto it = param_vars_.find(name);
+      if (it == param_vars_.end()) {
+        it = param_vars_.emplace(name, tir::Var(MakeString("param_", name), DataType::Handle()))
+                 .first;
+      }
+      return it->second;
+    }
     auto param_array = te::Var(MakeString("param_", param_sid, "_array"), DataType::Handle());
 
     // Compose the lookup_call using a local stack
@@ -177,7 +219,7 @@ class AOTExecutorCodegen : public ExprVisitor {
   /*!
    * brief Given an expression return the variable(s) associated with that expression
    */
-  std::vector<te::Var> FindExpr(Expr arg) {
+  std::vector<PrimExpr> FindExpr(Expr arg) {
     auto input_iter = std::find(input_vars_.begin(), input_vars_.end(), arg);
     if (input_iter != input_vars_.end()) {
       // Input variable
@@ -225,7 +267,7 @@ class AOTExecutorCodegen : public ExprVisitor {
    * TODO(giuseros): we should try to avoid unnecessary copy to the output, e.g., in a
    * copy-on-write fashion.
    */
-  void CopyToOutput(te::Var out, te::Var in, size_t size) {
+  void CopyToOutput(te::Var out, PrimExpr in, size_t size) {
     auto retval_get = tvm::tir::Call(DataType::Handle(), tvm::tir::builtin::tvm_struct_get(),
                                      {in, 0, tir::builtin::kArrData});
 
@@ -402,8 +444,16 @@ class AOTExecutorCodegen : public ExprVisitor {
     // Update function metadata via looking at all primfuncs
     UpdateFunctionMetadata(lowered_func, func, target);
 
-    // Generate the TIR function call
-    CreateFuncCall(GetRef<Call>(op), lowered_func->func_name);
+    // Generate the TIR function call. The shapes of the calls of the AOT main are static, so
+    // the CPU ops are called through their unchecked entries when they are emitted.
+    std::string func_name = lowered_func->func_name;
+    bool unchecked_entry = transform::PassContext::Current()
+                               ->GetConfig<Bool>("tir.unchecked_entry", Bool(false))
+                               .value();
+    if (unchecked_entry && target->kind->device_type == kDLCPU) {
+      func_name += "_unchecked";
+    }
+    CreateFuncCall(GetRef<Call>(op), func_name);
   }
 
   void VisitExpr_(const VarNode* op) override {
@@ -484,6 +534,11 @@ class AOTExecutorCodegen : public ExprVisitor {
 
     // Allocate the sids
     std::unordered_map<int, bool> allocated;
+    // The sids planned into the arena, bound to their offset in it
+    std::unordered_map<int, int64_t> arena_offsets;
+    int64_t arena_size = 0;
+    // The sids of the host runtime without a planned offset, ordered by sid
+    std::map<int, int64_t> sid_sizes;
 
     for (auto kv : storage_device_map_) {
       // Only allocate sids that are needed
@@ -504,12 +559,53 @@ class AOTExecutorCodegen : public ExprVisitor {
 
         // TODO(giuseros): we should allocate this once outside the PrimFunc
         // so we don't pay the price of allocation for every inference
+        if (kv.second.size() == 4 && kv.second[3][i]->value >= 0) {
+          int64_t offset = kv.second[3][i]->value;
+          arena_offsets[sid] = offset;
+          arena_size = std::max(arena_size, offset + size);
+          continue;
+        }
+        if (host_runtime_) {
+          // The storages are laid out one after the other in the arena of the executor
+          sid_sizes[sid] = std::max<int64_t>(sid_sizes[sid], size);
+          continue;
+        }
         if (!allocated[sid]) {
           body = tir::Allocate(sids_table_[sid], DataType::Int(8), {size}, tir::const_true(), body);
         }
         allocated[sid] = true;
       }
     }
+    for (const auto& kv : sid_sizes) {
+      arena_offsets[kv.first] = arena_size;
+      arena_size += (kv.second + runtime::kAllocAlignment - 1) / runtime::kAllocAlignment *
+                    runtime::kAllocAlignment;
+    }
+    if (host_runtime_) {
+      // The parameters and the arena come after the inputs and the outputs
+      for (const auto& kv : param_vars_) {
+        main_signature_.push_back(kv.second);
+      }
+      main_signature_.push_back(arena_var_);
+      arena_size_ = arena_size;
+    }
+    if (!arena_offsets.empty()) {
+      te::Var arena("sid_arena", PointerType(PrimType(DataType::Int(8))));
+      for (const auto& kv : arena_offsets) {
+        PrimExpr addr = tir::Call(
+            DataType::Handle(), tir::builtin::address_of(),
+            {tir::Load(DataType::Int(8), arena, static_cast<int>(kv.second), tir::const_true())});
+        body = tir::LetStmt(sids_table_[kv.first], addr, body);
+      }
+      if (host_runtime_) {
+        PrimExpr arena_data = tir::Call(DataType::Handle(), tir::builtin::tvm_struct_get(),
+                                        {arena_var_, 0, tir::builtin::kArrData});
+        body = tir::LetStmt(arena, arena_data, body);
+      } else {
+        body = tir::Allocate(arena, DataType::Int(8), {static_cast<int>(arena_size)},
+                             tir::const_true(), body);
+      }
+    }
 
     // Define the attributes
     body = tir::AttrStmt(PrimExpr(), tvm::tir::attr::device_type, 1, body);
@@ -524,6 +620,35 @@ class AOTExecutorCodegen : public ExprVisitor {
                          DictAttrs(dict_attrs));
   }
 
+  /*!
+   * \brief The description of the main function for the executor of the C++ runtime: its
+   *  inputs, outputs, parameters in argument order and the size of its arena.
+   */
+  Map<String, ObjectRef> MakeExecutorInfo(const Function& func) {
+    Map<String, ObjectRef> info;
+    if (!host_runtime_) return info;
+    Array<String> input_names;
+    Array<TensorType> inputs;
+    for (const Var& param : func->params) {
+      input_names.push_back(param->name_hint());
+      inputs.push_back(Downcast<TensorType>(param->checked_type()));
+    }
+    Array<TensorType> outputs;
+    for (const TensorType& type : FlattenTupleType(func->body->checked_type())) {
+      outputs.push_back(type);
+    }
+    Array<String> param_names;
+    for (const auto& kv : param_vars_) {
+      param_names.push_back(kv.first);
+    }
+    info.Set("input_names", input_names);
+    info.Set("inputs", inputs);
+    info.Set("outputs", outputs);
+    info.Set("param_names", param_names);
+    info.Set("arena_size", Integer(static_cast<int>(arena_size_)));
+    return info;
+  }
+
  protected:
   /*! \brief mod */
   runtime::Module* mod_;
@@ -561,13 +686,27 @@ class AOTExecutorCodegen : public ExprVisitor {
   std::vector<tir::Stmt> stmts_;
   /*! \brief the list of return sids (note that the function might return more then one output */
   IntegerArray return_sid_;
+  /*!
+   * \brief whether the main function runs on the C++ runtime rather than the CRT, the
+   *  parameters and the arena are then arguments set once by the executor
+   */
+  bool host_runtime_;
+  /*! \brief the arguments of the parameters on the host runtime, by parameter name */
+  std::map<std::string, tir::Var> param_vars_;
+  /*! \brief the argument of the arena on the host runtime */
+  tir::Var arena_var_;
+  /*! \brief the size in bytes of the arena on the host runtime */
+  int64_t arena_size_{0};
+  /*! \brief the description of the main function for the executor of the C++ runtime */
+  Map<String, ObjectRef> executor_info_;
 
  public:
   AOTExecutorCodegen(runtime::Module* mod, const TargetsMap& targets, Target target_host)
-      : mod_(mod), return_sid_() {
+      : mod_(mod), return_sid_(), arena_var_("arena", DataType::Handle()) {
     compile_engine_ = CompileEngine::Global();
     targets_ = targets;
     target_host_ = target_host;
+    host_runtime_ = target_host_->GetAttr<String>("runtime").value_or("") != kTvmRuntimeCrt;
   }
 
   LoweredOutput Codegen(relay::Function func) {
@@ -630,8 +769,11 @@ class AOTExecutorCodegen : public ExprVisitor {
     ret.function_metadata = std::move(function_metadata_);
     ret.metadata =
         runtime::Metadata(input_vars_.size(), return_sid_.size(), runtime::kTvmExecutorAot);
+    executor_info_ = MakeExecutorInfo(func);
     return ret;
   }
+
+  Map<String, ObjectRef> GetExecutorInfo() const { return executor_info_; }
 };
 
 class AOTExecutorCodegenModule : public runtime::ModuleNode {
@@ -677,6 +819,10 @@ class AOTExecutorCodegenModule : public runtime::ModuleNode {
     } else if (name == "get_metadata") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = output_.metadata; });
+    } else if (name == "get_executor_info") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = this->codegen_->GetExecutorInfo();
+      });
     } else {
       return PackedFunc([](TVMArgs args, TVMRetValue* rv) {});
     }
@@ -21,6 +21,7 @@
  * \file relay/backend/build_module.cc
  * \brief Code generation for TVM's graph executor.
  */
+#include <dmlc/json.h>
 #include <tvm/driver/driver_api.h>
 #include <tvm/ir/expr.h>
 #include <tvm/relay/analysis.h>
@@ -28,8 +29,17 @@
 #include <tvm/relay/qnn/transform.h>
 #include <tvm/relay/transform.h>
 #include <tvm/runtime/device_api.h>
+#include <tvm/tir/function.h>
 
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "../../target/func_registry_generator.h"
 #include "../../target/source/codegen_source_base.h"
@@ -51,6 +61,7 @@ using namespace tvm::relay::transform;
  */
 struct BuildOutput {
   std::string graph_json;
+  std::string graph_binary;
   runtime::Module mod;
   std::unordered_map<std::string, tvm::runtime::NDArray> params;
 };
@@ -97,6 +108,10 @@ struct ExecutorCodegen {
   }
 
   runtime::Metadata GetMetadata() { return CallFunc<runtime::Metadata>("get_metadata"); }
+
+  Map<String, ObjectRef> GetExecutorInfo() {
+    return CallFunc<Map<String, ObjectRef>>("get_executor_info", nullptr);
+  }
   virtual ~ExecutorCodegen() {}
 
  protected:
@@ -134,10 +149,15 @@ struct GraphCodegen : ExecutorCodegen {
     auto pf = GetPackedFunc("relay.build_module._GraphExecutorCodegen");
     mod = (*pf)();
   }
-  void UpdateOutput(BuildOutput* ret) override { ret->graph_json = GetGraphJSON(); }
+  void UpdateOutput(BuildOutput* ret) override {
+    ret->graph_json = GetGraphJSON();
+    ret->graph_binary = GetGraphBinary();
+  }
 
   std::string GetGraphJSON() { return CallFunc<std::string>("get_graph_json", nullptr); }
 
+  std::string GetGraphBinary() { return CallFunc<std::string>("get_graph_binary", nullptr); }
+
   ~GraphCodegen() {}
 };
 
@@ -172,6 +192,10 @@ class RelayBuildModule : public runtime::ModuleNode {
     if (name == "get_graph_json") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetGraphJSON(); });
+    } else if (name == "get_graph_binary") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = TVMByteArray{ret_.graph_binary.data(), ret_.graph_binary.size()};
+      });
     } else if (name == "get_module") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetModule(); });
@@ -205,6 +229,10 @@ class RelayBuildModule : public runtime::ModuleNode {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         *rv = this->executor_codegen_->GetFunctionMetadata();
       });
+    } else if (name == "get_executor_info") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = this->executor_codegen_->GetExecutorInfo();
+      });
     } else if (name == "optimize") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         ICHECK_EQ(args.num_args, 2);
@@ -365,6 +393,10 @@ class RelayBuildModule : public runtime::ModuleNode {
     pass_seqs.push_back(transform::FastMath());
     pass_seqs.push_back(transform::FoldConstant());
 
+    // Pack the constant weights into the layouts of their kernels once, here, instead of
+    // at every run.
+    pass_seqs.push_back(transform::PrepackWeights());
+
     // Create a sequential pass and perform optimizations.
     transform::Pass seq = transform::Sequential(pass_seqs);
     if (targets.size() == 1) {
@@ -385,6 +417,9 @@ class RelayBuildModule : public runtime::ModuleNode {
       relay_module = RunDeviceAnnotationPass(relay_module, fallback_dev->value);
     }
 
+    // Recompute the cheap values to meet the memory budget, if any.
+    relay_module = transform::Rematerialize()(relay_module);
+
     // Fuse the operations if it is needed.
     relay_module = transform::FuseOps()(relay_module);
 
@@ -404,6 +439,12 @@ class RelayBuildModule : public runtime::ModuleNode {
       }
     }
 
+    // Pack the independent fused functions.
+    Pass horizontal_fuse_pass = transform::HorizontalFuseOps();
+    if (targets.size() == 1 && pass_ctx.PassEnabled(horizontal_fuse_pass->Info())) {
+      relay_module = horizontal_fuse_pass(relay_module);
+    }
+
     relay_module = transform::InferType()(relay_module);
 
     // Inline the functions that have been lifted by the module scope.
@@ -566,6 +607,9 @@ class RelayBuildModule : public runtime::ModuleNode {
         // from CSourceModuleNode::SaveToFile.
         ret_.mod = tvm::codegen::CSourceModuleCreate(";", "", Array<String>{});
       }
+    } else if (backend::GetKernelCacheDir().defined()) {
+      ret_.mod = BuildWithKernelCache(lowered_funcs, target_host,
+                                      backend::GetKernelCacheDir().value());
     } else {
       ret_.mod = tvm::build(lowered_funcs, target_host_);
     }
@@ -589,6 +633,109 @@ class RelayBuildModule : public runtime::ModuleNode {
   }
 
  private:
+  /*!
+   * \brief Build the lowered functions, reusing the kernels of the CPU targets
+   *  found in the kernel cache and adding the missing ones to it.
+   *
+   *  Every kernel for an LLVM target is built alone and stored as the optimized LLVM IR of its
+   *  module, by the structural hash of its lowered function. The compile engine names the
+   *  kernels by the hash of their source function when the cache is enabled, so the kernels of
+   *  related models have the same symbols. The kernel modules are imported into the module of
+   *  the other functions, and linked with it by export_library.
+   *
+   * \param lowered_funcs The lowered functions by target.
+   * \param target_host The host target.
+   * \param cache_dir The directory of the kernel cache.
+   * \return The runtime module.
+   */
+  runtime::Module BuildWithKernelCache(const Map<String, IRModule>& lowered_funcs,
+                                       const Target& target_host, const std::string& cache_dir) {
+    static const runtime::PackedFunc* fllvm_version =
+        runtime::Registry::Get("target.llvm_version_major");
+    int llvm_version = fllvm_version != nullptr ? static_cast<int>((*fllvm_version)()) : 0;
+    Map<String, IRModule> rest;
+    std::vector<runtime::Module> kernels;
+    for (const auto& kv : lowered_funcs) {
+      Target target(kv.first);
+      if (target->kind->name != "llvm") {
+        rest.Set(kv.first, kv.second);
+        continue;
+      }
+      IRModule rest_mod = IRModule(Map<GlobalVar, BaseFunc>({}));
+      for (const auto& func : kv.second->functions) {
+        if (func.first->name_hint == ::tvm::runtime::symbol::tvm_lookup_linked_param ||
+            !func.second->IsInstance<tir::PrimFuncNode>()) {
+          rest_mod->Add(func.first, func.second);
+          continue;
+        }
+        size_t hash = StructuralHash()(func.second);
+        hash = dmlc::HashCombine(hash, std::hash<std::string>()(target->str()));
+        hash = dmlc::HashCombine(hash, std::hash<std::string>()(target_host->str()));
+        hash = dmlc::HashCombine(hash, std::hash<std::string>()(TVM_VERSION));
+        hash = dmlc::HashCombine(hash, llvm_version);
+        std::ostringstream os;
+        os << cache_dir << "/" << std::hex << std::setw(16) << std::setfill('0') << hash;
+        std::string path = os.str();
+        if (CachedKernelMatches(path, func.first->name_hint, target)) {
+          kernels.push_back(runtime::Module::LoadFromFile(path + ".ll", "ll"));
+          continue;
+        }
+        IRModule kernel_mod = IRModule(Map<GlobalVar, BaseFunc>({{func.first, func.second}}));
+        runtime::Module kernel = tvm::build(kernel_mod, target, target_host);
+        if (kernel->type_key() != std::string("llvm") || !kernel->imports().empty()) {
+          // Only the kernels built into a single LLVM module can be reloaded.
+          rest_mod->Add(func.first, func.second);
+          continue;
+        }
+        StoreKernel(path, kernel, func.first->name_hint, target);
+        kernels.push_back(kernel);
+      }
+      if (!rest_mod->functions.empty()) rest.Set(kv.first, rest_mod);
+    }
+    runtime::Module mod;
+    if (rest.empty()) {
+      const auto* pf = runtime::Registry::Get("codegen.LLVMModuleCreate");
+      ICHECK(pf != nullptr) << "The kernel cache needs LLVM";
+      mod = (*pf)(target_host->str(), "empty_module");
+    } else {
+      mod = tvm::build(rest, target_host_);
+    }
+    for (const runtime::Module& kernel : kernels) mod.Import(kernel);
+    return mod;
+  }
+
+  // Whether the description of the cached kernel at the path matches, guarding against
+  // the collisions of the hash.
+  static bool CachedKernelMatches(const std::string& path, const std::string& func_name,
+                                  const Target& target) {
+    std::ifstream meta(path + ".json");
+    if (!meta.good() || !std::ifstream(path + ".ll").good()) return false;
+    std::map<std::string, std::string> info;
+    dmlc::JSONReader reader(&meta);
+    reader.Read(&info);
+    return info["func_name"] == func_name && info["target"] == target->str() &&
+           info["tvm_version"] == TVM_VERSION;
+  }
+
+  // Store a kernel in the cache. The files are written under temporary names and renamed, so
+  // the concurrent builds sharing the cache never read a partial kernel.
+  static void StoreKernel(const std::string& path, runtime::Module kernel,
+                          const std::string& func_name, const Target& target) {
+    std::ostringstream suffix;
+    suffix << ".tmp" << std::this_thread::get_id();
+    std::string tmp = path + suffix.str();
+    kernel->SaveToFile(tmp + ".ll", "ll");
+    {
+      std::ofstream meta(tmp + ".json");
+      dmlc::JSONWriter writer(&meta);
+      std::map<std::string, std::string> info = {
+          {"func_name", func_name}, {"target", target->str()}, {"tvm_version", TVM_VERSION}};
+      writer.Write(info);
+    }
+    std::rename((tmp + ".ll").c_str(), (path + ".ll").c_str());
+    std::rename((tmp + ".json").c_str(), (path + ".json").c_str());
+  }
+
   Target GetTargetHost() {
     Target target_host = target_host_;
     if (!target_host_.defined()) {
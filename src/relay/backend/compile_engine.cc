@@ -33,6 +33,7 @@
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule.h>
 #include <tvm/te/schedule_pass.h>
@@ -42,6 +43,7 @@
 #include <limits>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -633,6 +635,42 @@ class CompileEngineImpl : public CompileEngineNode {
     return LowerShapeFuncInternal(key)->cached_func;
   }
 
+  Array<CachedFunc> LowerAll(const Array<CCacheKey>& keys) final {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Schedule and name the new functions in the order of the keys, as calls to Lower would.
+    std::vector<CCacheValue> values;
+    std::vector<CCacheKey> todo_keys;
+    std::vector<ObjectPtr<CachedFuncNode>> todo_nodes;
+    std::vector<CCacheValue> todo_values;
+    std::unordered_set<const Object*> scheduled;
+    for (const CCacheKey& key : keys) {
+      CCacheValue value = FindOrInsert(key, false);
+      values.push_back(value);
+      if (value->cached_func.defined() || scheduled.count(value.get())) continue;
+      ObjectPtr<CachedFuncNode> cache_node = ScheduleInternal(key, value);
+      if (cache_node == nullptr) continue;
+      scheduled.insert(value.get());
+      todo_keys.push_back(key);
+      todo_nodes.push_back(cache_node);
+      todo_values.push_back(value);
+    }
+    // The TIR lowering of every function only touches its own entry. The lowering hook is
+    // written in Python and needs the interpreter lock, the worker threads lower in C++.
+    if (todo_keys.size() > 1 && backend::IsParallelLoweringEnabled()) {
+      transform::PassContext pass_ctx = transform::PassContext::Current();
+      support::parallel_for(0, todo_keys.size(), [&](int i) {
+        LowerSchedule(todo_keys[i], todo_nodes[i], pass_ctx, todo_values[i]);
+      });
+    } else {
+      for (size_t i = 0; i < todo_keys.size(); ++i) {
+        LowerScheduled(todo_keys[i], todo_nodes[i], todo_values[i]);
+      }
+    }
+    Array<CachedFunc> ret;
+    for (const CCacheValue& value : values) ret.push_back(value->cached_func);
+    return ret;
+  }
+
   Array<tvm::runtime::Module> LowerExternalFunctions() {
     Array<tvm::runtime::Module> ret;
     std::unordered_map<std::string, std::string> cached_symbol;
@@ -713,19 +751,33 @@ class CompileEngineImpl : public CompileEngineNode {
   // implement lowered func
   CCacheValue LowerInternal(const CCacheKey& key) {
     std::lock_guard<std::mutex> lock(mutex_);
-    CCacheValue value;
+    CCacheValue value = FindOrInsert(key, true);
+    if (value->cached_func.defined()) return value;
+    ObjectPtr<CachedFuncNode> cache_node = ScheduleInternal(key, value);
+    if (cache_node != nullptr) LowerScheduled(key, cache_node, value);
+    return value;
+  }
+  // look up the cache entry of a function, or add one
+  CCacheValue FindOrInsert(const CCacheKey& key, bool count_use) {
     auto it = cache_.find(key);
     if (it != cache_.end()) {
-      it->second->use_count += 1;
-      if (it->second->cached_func.defined()) return it->second;
-      value = it->second;
-    } else {
-      value = CCacheValue(make_object<CCacheValueNode>());
-      value->use_count = 0;
-      if (!backend::IsCompileEngineCacheDisabled()) {
-        cache_[key] = value;
-      }
+      if (count_use) it->second->use_count += 1;
+      return it->second;
     }
+    CCacheValue value = CCacheValue(make_object<CCacheValueNode>());
+    value->use_count = 0;
+    if (!backend::IsCompileEngineCacheDisabled()) {
+      cache_[key] = value;
+    }
+    return value;
+  }
+  /*!
+   * \brief Create the schedule of a function and give it a unique name.
+   * \param key The function to schedule.
+   * \param value The cache entry of the function, set directly if no lowering is needed.
+   * \return The scheduled function to be lowered, or null if no lowering is needed.
+   */
+  ObjectPtr<CachedFuncNode> ScheduleInternal(const CCacheKey& key, CCacheValue value) {
     cur_ccache_key_ = key;
 
     // No need to lower external functions for now. We will invoke the external
@@ -738,7 +790,7 @@ class CompileEngineImpl : public CompileEngineNode {
       cache_node->target = Target("ext_dev");
       cache_node->funcs->Add(GlobalVar(cache_node->func_name), key->source_func);
       value->cached_func = CachedFunc(cache_node);
-      return value;
+      return nullptr;
     }
     // Enforce use the target.
     With<Target> target_scope(key->target);
@@ -752,28 +804,50 @@ class CompileEngineImpl : public CompileEngineNode {
     if (const CallNode* call_node = body.as<CallNode>()) {
       if (call_node->attrs.as<DeviceCopyAttrs>()) {
         value->cached_func = CachedFunc(cache_node);
-        return value;
+        return nullptr;
       }
     }
 
+    if (backend::GetKernelCacheDir().defined()) {
+      // The kernels are named by their source, so that related models share the cached kernels.
+      std::ostringstream os;
+      os << cache_node->func_name << "_" << std::hex << key->Hash();
+      cache_node->func_name = os.str();
+    }
     cache_node->func_name = GetUniqueName(cache_node->func_name);
+    return cache_node;
+  }
+  // lower a scheduled function through the lowering hook
+  void LowerScheduled(const CCacheKey& key, const ObjectPtr<CachedFuncNode>& cache_node,
+                      CCacheValue value) {
+    if (const auto* f = runtime::Registry::Get("relay.backend.lower")) {
+      // Enforce use the target.
+      With<Target> target_scope(key->target);
+      cache_node->funcs =
+          (*f)(cache_node->schedule, AllArgs(cache_node), cache_node->func_name, key->source_func);
+      value->cached_func = CachedFunc(cache_node);
+    } else {
+      LowerSchedule(key, cache_node, transform::PassContext::Create(), value);
+    }
+  }
+  // the inputs then the outputs of a scheduled function
+  static Array<te::Tensor> AllArgs(const ObjectPtr<CachedFuncNode>& cache_node) {
     // NOTE: array will copy on write.
     Array<te::Tensor> all_args = cache_node->inputs;
     for (te::Tensor arg : cache_node->outputs) {
       all_args.push_back(arg);
     }
-    // lower the function
-    if (const auto* f = runtime::Registry::Get("relay.backend.lower")) {
-      cache_node->funcs = (*f)(cfunc->schedule, all_args, cache_node->func_name, key->source_func);
-    } else {
-      using tvm::transform::PassContext;
-      With<PassContext> fresh_pass_ctx_scope(PassContext::Create());
-
-      std::unordered_map<te::Tensor, tir::Buffer> binds;
-      cache_node->funcs = tvm::lower(cfunc->schedule, all_args, cache_node->func_name, binds);
-    }
+    return all_args;
+  }
+  // lower a scheduled function in C++, only touching its own cache entry
+  static void LowerSchedule(const CCacheKey& key, const ObjectPtr<CachedFuncNode>& cache_node,
+                            const transform::PassContext& pass_ctx, CCacheValue value) {
+    With<Target> target_scope(key->target);
+    With<transform::PassContext> pass_ctx_scope(pass_ctx);
+    std::unordered_map<te::Tensor, tir::Buffer> binds;
+    cache_node->funcs =
+        tvm::lower(cache_node->schedule, AllArgs(cache_node), cache_node->func_name, binds);
     value->cached_func = CachedFunc(cache_node);
-    return value;
   }
   // implement lowered shape func
   CCacheValue LowerShapeFuncInternal(const CCacheKey& key) {
@@ -856,6 +930,8 @@ CompileEngine& CompileEngine::Global() {
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.use_auto_scheduler", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.disable_compile_engine_cache", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.parallel_lowering", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.kernel_cache_dir", String);
 
 TVM_REGISTER_GLOBAL("relay.backend._make_LoweredOutput")
     .set_body_typed([](tvm::Array<te::Tensor> outputs, OpImplementation impl) {
@@ -881,6 +957,9 @@ TVM_REGISTER_GLOBAL("relay.backend._CompileEngineLower")
 TVM_REGISTER_GLOBAL("relay.backend._CompileEngineLowerShapeFunc")
     .set_body_typed([](CompileEngine self, CCacheKey key) { return self->LowerShapeFunc(key); });
 
+TVM_REGISTER_GLOBAL("relay.backend._CompileEngineLowerAll")
+    .set_body_typed([](CompileEngine self, Array<CCacheKey> keys) { return self->LowerAll(keys); });
+
 TVM_REGISTER_GLOBAL("relay.backend._CompileLowerExternalFunctions")
     .set_body_typed([](CompileEngine self) { return self->LowerExternalFunctions(); });
 
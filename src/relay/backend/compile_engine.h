@@ -214,6 +214,14 @@ class CompileEngineNode : public Object {
    * \return The result.
    */
   virtual CachedFunc LowerShapeFunc(const CCacheKey& key) = 0;
+  /*!
+   * \brief Lower several functions at once, in parallel when enabled by the
+   *  relay.backend.parallel_lowering option. The results are cached, so that
+   *  the later calls to Lower find them.
+   * \param keys The keys to the cached functions.
+   * \return The results, in the order of the keys.
+   */
+  virtual Array<CachedFunc> LowerAll(const Array<CCacheKey>& keys) = 0;
   /*!
    * \brief Lower the external function using external codegen tools.
    * \return The runtime moduels for each needed external codegen tool.
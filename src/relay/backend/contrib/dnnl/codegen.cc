@@ -445,11 +445,23 @@ class DNNLJSONSerializer : public backend::contrib::JSONSerializer {
       ICHECK(comp.defined()) << "DNNL JSON runtime only supports composite functions.";
       name = comp.value();
 
-      if (name == "dnnl.conv2d_bias_relu") {
+      if (name == "dnnl.conv2d_bias_sum_relu") {
+        call = GetRootCall(fn->body.as<CallNode>(), 3, {"nn.conv2d", "add", "add", "nn.relu"});
+      } else if (name == "dnnl.conv2d_bias_sum") {
+        call = GetRootCall(fn->body.as<CallNode>(), 2, {"nn.conv2d", "add", "add"});
+      } else if (name == "dnnl.conv2d_bias_relu") {
         call = GetRootCall(fn->body.as<CallNode>(), 2, {"nn.conv2d", "add", "nn.relu"});
       } else if (name == "dnnl.conv2d_relu") {
         call = GetRootCall(fn->body.as<CallNode>(), 1, {"nn.conv2d", "nn.relu"});
         ICHECK(call->op.as<OpNode>()) << "Not op node";
+      } else if (name == "dnnl.conv2d_bias") {
+        call = GetRootCall(fn->body.as<CallNode>(), 1, {"nn.conv2d", "add"});
+      } else if (name == "dnnl.dense_bias_relu") {
+        call = GetRootCall(fn->body.as<CallNode>(), 2, {"nn.dense", "add", "nn.relu"});
+      } else if (name == "dnnl.dense_relu") {
+        call = GetRootCall(fn->body.as<CallNode>(), 1, {"nn.dense", "nn.relu"});
+      } else if (name == "dnnl.dense_bias") {
+        call = GetRootCall(fn->body.as<CallNode>(), 1, {"nn.dense", "add"});
       } else {
         LOG(FATAL) << "Unrecognized DNNL pattern: " << name;
       }
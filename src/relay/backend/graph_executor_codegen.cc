@@ -25,14 +25,18 @@
 #include <dmlc/any.h>
 #include <dmlc/json.h>
 #include <tvm/ir/module.h>
+#include <tvm/relay/analysis.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/crt/graph_binary.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/object.h>
 #include <tvm/tir/analysis.h>
 #include <tvm/tir/function.h>
 
+#include <algorithm>
 #include <list>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "compile_engine.h"
@@ -77,6 +81,11 @@ class GraphNodeRef {
 
   inline void Load(dmlc::JSONReader* reader) { LOG(FATAL) << "Not implemented."; }
 
+  inline TVMGraphBinaryEntry ToBinary() const {
+    return {static_cast<uint32_t>(ident_), static_cast<uint32_t>(index_),
+            static_cast<uint32_t>(version_)};
+  }
+
  protected:
   int ident_;
   int index_{0};
@@ -274,6 +283,9 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     auto pf = GetPackedFunc("relay.backend.GraphPlanMemory");
     storage_device_map_ = (*pf)(func);
     UpdateMainWorkspaceSize(func);
+    if (backend::IsParallelLoweringEnabled()) {
+      LowerPrimitiveFunctions(func->body);
+    }
     // First we convert all the parameters into input nodes.
     for (auto param : func->params) {
       auto node_ptr = GraphInputNode::make_node_ptr(param->name_hint(), GraphAttrs());
@@ -285,6 +297,7 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     GetJSON(&writer);
     LoweredOutput ret;
     ret.graph_json = os.str();
+    ret.graph_binary = GetBinary();
     ret.params = std::unordered_map<std::string, std::pair<int, const tvm::runtime::NDArray>>();
     for (auto param : params_) {
       ret.params.emplace(std::make_pair(
@@ -333,13 +346,21 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     size_t count = storage_device_map_.count(expr);
     ICHECK_GT(count, 0) << "Expr is not existing in storage plan";
     auto storage_device_info = storage_device_map_[expr];
-    ICHECK_EQ(storage_device_info.size(), 3);
+    ICHECK(storage_device_info.size() == 3 || storage_device_info.size() == 4);
     // storage
     std::vector<int64_t> storage_info;
     for (auto& v : storage_device_info[0]) {
       storage_info.push_back(v->value);
     }
     node->attrs_["storage_id"] = std::move(storage_info);
+    // arena offsets, present under the arena memory planner
+    if (storage_device_info.size() == 4) {
+      std::vector<int64_t> storage_offsets;
+      for (auto& v : storage_device_info[3]) {
+        storage_offsets.push_back(v->value);
+      }
+      node->attrs_["storage_offset"] = std::move(storage_offsets);
+    }
     // type
     std::vector<int64_t> device_types;
     for (auto& v : storage_device_info[1]) {
@@ -432,6 +453,43 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     return AddNode(node, GetRef<Expr>(op));
   }
 
+  /*!
+   * \brief Lower the primitive functions called by the graph as one batch, for the compile
+   *  engine to lower them in parallel. They are listed in the order of the visit, which finds
+   *  them in the cache of the engine with the same names.
+   * \param body The body of the main function.
+   */
+  void LowerPrimitiveFunctions(const Expr& body) {
+    Array<CCacheKey> keys;
+    std::unordered_set<const Object*> visited;
+    std::vector<Expr> stack{body};
+    while (!stack.empty()) {
+      Expr expr = stack.back();
+      stack.pop_back();
+      if (!visited.insert(expr.get()).second) continue;
+      std::vector<Expr> children;
+      if (const auto* call = expr.as<CallNode>()) {
+        const auto* func = call->op.as<FunctionNode>();
+        if (func != nullptr && func->HasNonzeroAttr(attr::kPrimitive) &&
+            !func->GetAttr<String>(attr::kCompiler).defined() &&
+            !(func->HasNonzeroAttr(attr::kReshapeOnly) && ShareSameStorage(expr, call->args[0])) &&
+            storage_device_map_.count(expr)) {
+          auto call_dev_type = storage_device_map_[expr][1][0]->value;
+          keys.push_back(CCacheKey(GetRef<Function>(func), GetTargetFromInteger(call_dev_type)));
+        }
+        for (const Expr& arg : call->args) children.push_back(arg);
+      } else if (const auto* tuple = expr.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) children.push_back(field);
+      } else if (const auto* get = expr.as<TupleGetItemNode>()) {
+        children.push_back(get->tuple);
+      } else if (const auto* let = expr.as<LetNode>()) {
+        children = {let->value, let->body};
+      }
+      stack.insert(stack.end(), children.rbegin(), children.rend());
+    }
+    compile_engine_->LowerAll(keys);
+  }
+
   bool ShareSameStorage(const Expr& lhs, const Expr& rhs) {
     auto lit = storage_device_map_.find(lhs);
     auto rit = storage_device_map_.find(rhs);
@@ -581,6 +639,11 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
 
     // Update function metadata via looking at all primfuncs
     UpdateFunctionMetadata(lowered_func, func, target);
+    // The FLOPs of the op for the profiler, a MAC being two
+    int64_t macs = CountMacs(func);
+    if (macs > 0) {
+      attrs["flops"] = std::to_string(2 * macs);
+    }
     return GraphAddCallNode(op, _GetUniqueName(lowered_func->func_name), lowered_func->func_name,
                             attrs);
   }
@@ -647,6 +710,7 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     size_t num_entry = 0;
     ShapeVector shapes;
     std::vector<size_t> storage_ids;
+    std::vector<int64_t> storage_offsets;
     std::vector<size_t> device_types;
     std::vector<std::string> dltypes;
     std::vector<size_t> node_row_ptr{0};
@@ -661,6 +725,10 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
       shapes.insert(shapes.end(), shape_vec.begin(), shape_vec.end());
       dltypes.insert(dltypes.end(), dtype_vec.begin(), dtype_vec.end());
       storage_ids.insert(storage_ids.end(), storage_id.begin(), storage_id.end());
+      if (node->attrs_.count("storage_offset")) {
+        const auto& offsets = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_offset"]);
+        storage_offsets.insert(storage_offsets.end(), offsets.begin(), offsets.end());
+      }
       if (node->attrs_.count("device_index")) {
         const auto& dev_types = dmlc::get<std::vector<int64_t>>(node->attrs_["device_index"]);
         device_types.insert(device_types.end(), dev_types.begin(), dev_types.end());
@@ -676,6 +744,11 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     attrs["shape"].emplace_back(shapes);
     attrs["storage_id"].emplace_back(std::string("list_int"));
     attrs["storage_id"].emplace_back(storage_ids);
+    if (storage_offsets.size()) {
+      ICHECK_EQ(storage_offsets.size(), storage_ids.size());
+      attrs["storage_offset"].emplace_back(std::string("list_int"));
+      attrs["storage_offset"].emplace_back(storage_offsets);
+    }
     if (device_types.size()) {
       attrs["device_index"].emplace_back(std::string("list_int"));
       attrs["device_index"].emplace_back(device_types);
@@ -687,6 +760,116 @@ class GraphExecutorCodegen : public backend::MemoizedExprTranslator<std::vector<
     writer->EndObject();
   }
 
+  /*!
+   * \brief Generate the binary graph of the CRT graph executor, see graph_binary.h.
+   *
+   * \return The graph.
+   */
+  std::string GetBinary() {
+    std::vector<TVMGraphBinaryNode> nodes;
+    std::vector<TVMGraphBinaryEntry> inputs;
+    std::vector<uint32_t> arg_nodes;
+    std::vector<TVMGraphBinaryEntry> heads;
+    std::vector<uint32_t> node_row_ptr{0};
+    std::vector<uint32_t> storage_ids, device_types, ndims;
+    std::vector<DLDataType> dtypes;
+    ShapeVector shapes;
+    std::vector<int64_t> storage_offsets;
+    // The string table starts with the empty string of the null ops.
+    std::string strings(1, '\0');
+    auto add_string = [&strings](const std::string& str) {
+      uint32_t offset = strings.size();
+      strings.append(str.c_str(), str.size() + 1);
+      return offset;
+    };
+
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+      const GraphObjectPtr& node = nodes_[i];
+      TVMGraphBinaryNode bnode{};
+      bnode.name = add_string(node->name_);
+      bnode.num_outputs = node->num_outputs_;
+      bnode.inputs_begin = inputs.size();
+      if (node->Type() == kGraphOpNode) {
+        const auto* op_node = static_cast<const GraphOpNode*>(node.get());
+        bnode.op = TVM_GRAPH_BINARY_OP_TVM_OP;
+        bnode.func_name = add_string(op_node->op_name_);
+        bnode.num_inputs = op_node->inputs_.size();
+        for (const GraphNodeRef& input : op_node->inputs_) inputs.push_back(input.ToBinary());
+      } else {
+        bnode.op = TVM_GRAPH_BINARY_OP_NULL;
+        arg_nodes.push_back(i);
+      }
+      nodes.push_back(bnode);
+
+      const auto& shape_vec = dmlc::get<ShapeVector>(node->attrs_["shape"]);
+      const auto& storage_id = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_id"]);
+      const auto& dtype_vec = dmlc::get<std::vector<std::string>>(node->attrs_["dtype"]);
+      ICHECK_EQ(node->num_outputs_, shape_vec.size());
+      shapes.insert(shapes.end(), shape_vec.begin(), shape_vec.end());
+      storage_ids.insert(storage_ids.end(), storage_id.begin(), storage_id.end());
+      for (const auto& dtype : dtype_vec) dtypes.push_back(runtime::String2DLDataType(dtype));
+      if (node->attrs_.count("storage_offset")) {
+        const auto& offsets = dmlc::get<std::vector<int64_t>>(node->attrs_["storage_offset"]);
+        storage_offsets.insert(storage_offsets.end(), offsets.begin(), offsets.end());
+      }
+      if (node->attrs_.count("device_index")) {
+        const auto& dev_types = dmlc::get<std::vector<int64_t>>(node->attrs_["device_index"]);
+        device_types.insert(device_types.end(), dev_types.begin(), dev_types.end());
+      }
+      node_row_ptr.push_back(node_row_ptr.back() + node->num_outputs_);
+    }
+    for (const GraphNodeRef& head : heads_) heads.push_back(head.ToBinary());
+
+    size_t num_entries = node_row_ptr.back();
+    size_t shape_stride = 1;
+    for (const auto& shape : shapes) {
+      ndims.push_back(shape.size());
+      shape_stride = std::max(shape_stride, shape.size());
+    }
+    std::vector<int64_t> padded_shapes(num_entries * shape_stride, 0);
+    for (size_t i = 0; i < num_entries; ++i) {
+      std::copy(shapes[i].begin(), shapes[i].end(), padded_shapes.begin() + i * shape_stride);
+    }
+    ICHECK(storage_offsets.empty() || storage_offsets.size() == num_entries);
+    ICHECK(device_types.empty() || device_types.size() == num_entries);
+
+    TVMGraphBinaryHeader header{};
+    header.magic = TVM_GRAPH_BINARY_MAGIC;
+    header.version = TVM_GRAPH_BINARY_VERSION;
+    header.flags = (device_types.empty() ? 0 : TVM_GRAPH_BINARY_HAS_DEVICE_INDEX) |
+                   (storage_offsets.empty() ? 0 : TVM_GRAPH_BINARY_HAS_STORAGE_OFFSET);
+    header.num_nodes = nodes.size();
+    header.num_node_inputs = inputs.size();
+    header.num_arg_nodes = arg_nodes.size();
+    header.num_heads = heads.size();
+    header.num_entries = num_entries;
+    header.shape_stride = shape_stride;
+    header.strings_size = strings.size();
+
+    std::string graph;
+    auto write = [&graph](const void* data, size_t size) {
+      graph.append(static_cast<const char*>(data), size);
+    };
+    auto write_vector = [&write](const auto& vec) {
+      write(vec.data(), vec.size() * sizeof(vec[0]));
+    };
+    write(&header, sizeof(header));
+    write_vector(nodes);
+    write_vector(inputs);
+    write_vector(arg_nodes);
+    write_vector(heads);
+    write_vector(node_row_ptr);
+    write_vector(storage_ids);
+    write_vector(device_types);
+    write_vector(ndims);
+    write_vector(dtypes);
+    graph.resize((graph.size() + 7) / 8 * 8, '\0');
+    write_vector(padded_shapes);
+    write_vector(storage_offsets);
+    write(strings.data(), strings.size());
+    return graph;
+  }
+
   /*!
    * \brief Get unique name for func
    *
@@ -761,6 +944,11 @@ class GraphExecutorCodegenModule : public runtime::ModuleNode {
     } else if (name == "get_graph_json") {
       return PackedFunc(
           [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->output_.graph_json; });
+    } else if (name == "get_graph_binary") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        const std::string& graph = this->output_.graph_binary;
+        *rv = TVMByteArray{graph.data(), graph.size()};
+      });
     } else if (name == "list_params_name") {
       return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
         Array<runtime::String> ret;
@@ -884,6 +1072,8 @@ struct Handler<std::vector<dmlc::any>> {
         writer->WriteArrayItem(dmlc::get<int>(v));
       } else if (SameType<std::vector<size_t>>(v)) {
         writer->WriteArrayItem(dmlc::get<std::vector<size_t>>(v));
+      } else if (SameType<std::vector<int64_t>>(v)) {
+        writer->WriteArrayItem(dmlc::get<std::vector<int64_t>>(v));
       } else if (SameType<std::vector<std::vector<int64_t>>>(v)) {
         writer->WriteArrayItem(dmlc::get<std::vector<std::vector<int64_t>>>(v));
       } else if (SameType<std::vector<std::string>>(v)) {
@@ -25,8 +25,14 @@
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include "../../support/arena.h"
 
 namespace tvm {
@@ -46,8 +52,17 @@ struct StorageToken {
   int device_type{0};
   /*! \brief The storage id */
   int64_t storage_id{-1};
+  /*! \brief The index of the call that produces the storage */
+  int64_t live_begin{-1};
+  /*! \brief The index of the last call that uses the storage, -1 if it is never released */
+  int64_t live_end{-1};
+  /*! \brief The byte offset in the arena of the device, -1 if allocated separately */
+  int64_t offset{-1};
 };
 
+/*! \brief Alignment in bytes of the storage packed into an arena. */
+constexpr size_t kArenaAlignment = 64;
+
 class StorageAllocaBaseVisitor : public ExprVisitor {
  public:
   // run the visitor on a function.
@@ -195,13 +210,54 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     return total;
   }
 
+  /*!
+   * \param use_arena Whether to give each intermediate tensor its own storage id and pack
+   *  the storages whose lifetimes do not overlap into one arena per device.
+   * \param in_place Whether the calls to the functions made of in place ops write their
+   *  output over an input that is last used by the call.
+   */
+  explicit StorageAllocator(bool use_arena, bool in_place)
+      : use_arena_(use_arena), in_place_(in_place) {}
+
+  /*!
+   * \return total number of bytes of the plan, with the arenas of the devices
+   *  counted by their sizes.
+   */
+  size_t PlannedBytes() const {
+    if (!use_arena_) return TotalAllocBytes();
+    size_t total = 0;
+    std::map<int, size_t> arena_bytes;
+    for (const auto* p : data_) {
+      if (p->offset < 0) {
+        total += p->max_bytes;
+      } else {
+        size_t end = static_cast<size_t>(p->offset) + p->max_bytes;
+        arena_bytes[p->device_type] = std::max(arena_bytes[p->device_type], end);
+      }
+    }
+    for (const auto& kv : arena_bytes) total += kv.second;
+    return total;
+  }
+
   // Run storage allocation for a function.
   Map<Expr, Array<IntegerArray> > Plan(const Function& func) {
     prototype_ = StorageAllocaInit(&arena_).GetInitTokenMap(func);
     this->Run(func);
+    if (use_arena_) {
+      PackArena();
+    }
+    int64_t memory_budget = transform::PassContext::Current()
+                                ->GetConfig("relay.backend.memory_budget", Integer(0))
+                                .value()
+                                ->value;
+    if (memory_budget > 0 && PlannedBytes() > static_cast<size_t>(memory_budget)) {
+      LOG(WARNING) << "The planned memory of " << PlannedBytes()
+                   << " bytes exceeds the memory budget of " << memory_budget << " bytes";
+    }
 
-    // The value of smap contains two integer arrays where the first array
-    // contains the planned storage ids and the second holds the device types.
+    // The value of smap contains three integer arrays: the planned storage ids,
+    // the device types and the sizes in bytes. Under the arena planner a fourth
+    // array holds the byte offset of each storage in the arena of its device.
     Map<Expr, Array<IntegerArray> > smap;
     int num_annotated_nodes = 0;
     int num_nodes = 0;
@@ -210,6 +266,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
       std::vector<Integer> storage_ids;
       std::vector<Integer> device_types;
       std::vector<Integer> sid_sizes_byte;
+      std::vector<Integer> offsets;
       for (StorageToken* tok : kv.second) {
         if (tok->device_type) {
           num_annotated_nodes++;
@@ -218,9 +275,15 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
         storage_ids.push_back(tok->storage_id);
         device_types.push_back(tok->device_type);
         sid_sizes_byte.push_back(GetMemorySize(tok));
+        offsets.push_back(tok->offset);
+      }
+      if (use_arena_) {
+        smap.Set(GetRef<Expr>(kv.first),
+                 Array<IntegerArray>({storage_ids, device_types, sid_sizes_byte, offsets}));
+      } else {
+        smap.Set(GetRef<Expr>(kv.first),
+                 Array<IntegerArray>({storage_ids, device_types, sid_sizes_byte}));
       }
-      smap.Set(GetRef<Expr>(kv.first),
-               Array<IntegerArray>({storage_ids, device_types, sid_sizes_byte}));
     }
     // Either all or none of the nodes should be annotated.
     if (num_annotated_nodes != 0 && num_annotated_nodes != num_nodes) {
@@ -279,6 +342,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
         args.push_back(tok);
       }
     }
+    ++now_;
     // Under the flat-memory setting.
     // we can force aliasing the input and output of reshape
     // to make it an nop. Note that this is not true
@@ -287,9 +351,12 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     //
     // TODO(tvm-team) Update checks of flat memory enablement when we support
     // opaque-nd memory planning to skip this path.
+    StorageToken* in_place_token = nullptr;
     if (IsReshape(op)) {
       ICHECK_EQ(args.size(), 1U);
       ReuseInputToken(op, args[0]);
+    } else if (in_place_ && (in_place_token = FindInPlaceToken(op)) != nullptr) {
+      ReuseInputToken(op, in_place_token);
     } else {
       // create token for the call node.
       CreateToken(op, true);
@@ -322,6 +389,56 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     }
     return false;
   }
+  /*!
+   * \brief The call only consists of ops that can write their output over their inputs.
+   * \param call The call to be checked.
+   * \return the check result.
+   */
+  static bool IsInPlace(const CallNode* call) {
+    class InPlaceChecker : public ExprVisitor {
+     public:
+      void VisitExpr_(const CallNode* cn) final {
+        static auto fin_place = Op::GetAttrMap<TOpInPlace>("TOpInPlace");
+        static auto freshape = Op::GetAttrMap<TReshapeOp>("TReshapeOp");
+        if (!fin_place.get(cn->op, false) && !freshape.get(cn->op, false)) {
+          in_place = false;
+        }
+        if (in_place) ExprVisitor::VisitExpr_(cn);
+      }
+      void VisitExpr_(const TupleNode* op) final { in_place = false; }
+      void VisitExpr_(const TupleGetItemNode* op) final { in_place = false; }
+
+      bool in_place = true;
+    };
+    const auto* fn = call->op.as<FunctionNode>();
+    if (fn == nullptr || !fn->HasNonzeroAttr(attr::kPrimitive)) return false;
+    InPlaceChecker checker;
+    checker(fn->body);
+    return checker.in_place;
+  }
+  /*!
+   * \brief Find an input token the output of an in place call can reuse, one of a tensor
+   *  of the same type as the output that is not used after the call.
+   * \param call The call.
+   * \return The token, nullptr if there is none.
+   */
+  StorageToken* FindInPlaceToken(const CallNode* call) {
+    if (!IsInPlace(call)) return nullptr;
+    auto it = prototype_.find(call);
+    ICHECK(it != prototype_.end());
+    if (it->second.size() != 1U) return nullptr;
+    StorageToken* prototype = it->second[0];
+    for (Expr arg : call->args) {
+      const auto& tokens = token_map_.at(arg.operator->());
+      if (tokens.size() != 1U) continue;
+      StorageToken* tok = tokens[0];
+      if (tok->ref_counter == 1 && tok->device_type == prototype->device_type &&
+          StructuralEqual()(arg->checked_type(), call->checked_type())) {
+        return tok;
+      }
+    }
+    return nullptr;
+  }
   /*!
    * \brief Get the memory requirement.
    * \param prototype The prototype token.
@@ -349,7 +466,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     // calculate the size;
     size_t size = GetMemorySize(prototype);
     // search memory block in [size / match_range_, size * match_range_)
-    if (match_range_ == 0) {
+    if (match_range_ == 0 || use_arena_) {
       return this->Alloc(prototype, size);
     }
     auto begin = free_.lower_bound(size / match_range_);
@@ -391,6 +508,7 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   StorageToken* Alloc(StorageToken* prototype, size_t size) {
     prototype->max_bytes = size;
     prototype->storage_id = static_cast<int64_t>(data_.size());
+    prototype->live_begin = now_;
     data_.push_back(prototype);
     return prototype;
   }
@@ -402,13 +520,71 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     ICHECK_GE(tok->storage_id, 0);
     ICHECK_GE(tok->ref_counter, 0);
     if (tok->ref_counter == 0) {
-      free_.insert({tok->max_bytes, tok});
+      tok->live_end = now_;
+      if (!use_arena_) {
+        free_.insert({tok->max_bytes, tok});
+      }
+    }
+  }
+  /*!
+   * \brief Assign arena offsets to the released storages, largest first, each at the
+   *  lowest aligned offset that fits between the storages of the same device whose
+   *  lifetimes overlap with it. Storages that are never released, such as the inputs,
+   *  the constants and the outputs, keep a separate allocation.
+   */
+  void PackArena() {
+    std::map<int, std::vector<StorageToken*> > by_device;
+    for (StorageToken* tok : data_) {
+      if (tok->live_end >= 0) by_device[tok->device_type].push_back(tok);
+    }
+    for (auto& kv : by_device) {
+      std::vector<StorageToken*>& toks = kv.second;
+      std::stable_sort(toks.begin(), toks.end(), [](StorageToken* lhs, StorageToken* rhs) {
+        return lhs->max_bytes > rhs->max_bytes;
+      });
+      std::vector<StorageToken*> placed;
+      for (StorageToken* tok : toks) {
+        size_t size = DivRoundUp(tok->max_bytes, kArenaAlignment) * kArenaAlignment;
+        // The storages live at the same time, ordered by offset.
+        std::vector<StorageToken*> live;
+        for (StorageToken* other : placed) {
+          if (other->live_begin <= tok->live_end && tok->live_begin <= other->live_end) {
+            live.push_back(other);
+          }
+        }
+        std::sort(live.begin(), live.end(), [](StorageToken* lhs, StorageToken* rhs) {
+          return lhs->offset < rhs->offset;
+        });
+        // Best fit: the smallest gap that holds the storage, else the end of the arena.
+        size_t offset = 0, best_gap = 0, cursor = 0;
+        bool found = false;
+        for (StorageToken* other : live) {
+          size_t other_begin = static_cast<size_t>(other->offset);
+          if (other_begin >= cursor + size && (!found || other_begin - cursor < best_gap)) {
+            offset = cursor;
+            best_gap = other_begin - cursor;
+            found = true;
+          }
+          size_t other_end =
+              other_begin + DivRoundUp(other->max_bytes, kArenaAlignment) * kArenaAlignment;
+          cursor = std::max(cursor, other_end);
+        }
+        if (!found) offset = cursor;
+        tok->offset = static_cast<int64_t>(offset);
+        placed.push_back(tok);
+      }
     }
   }
 
  private:
   // allocator
   support::Arena arena_;
+  // whether to pack the storages into an arena instead of reusing them
+  bool use_arena_;
+  // whether the output of in place calls can reuse a dead input
+  bool in_place_;
+  // index of the call being visited, orders the lifetimes of the storages
+  int64_t now_{0};
   // scale used for rough match
   size_t match_range_{16};
   // free list of storage entry
@@ -420,9 +596,19 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
 };
 
 Map<Expr, Array<IntegerArray> > GraphPlanMemory(const Function& func) {
-  return StorageAllocator().Plan(func);
+  bool use_arena = transform::PassContext::Current()
+                       ->GetConfig<Bool>("relay.backend.use_arena_planner", Bool(false))
+                       .value();
+  bool in_place = transform::PassContext::Current()
+                      ->GetConfig<Bool>("relay.backend.use_in_place_memory", Bool(false))
+                      .value();
+  return StorageAllocator(use_arena, in_place).Plan(func);
 }
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.use_arena_planner", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.use_in_place_memory", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.memory_budget", Integer);
+
 TVM_REGISTER_GLOBAL("relay.backend.GraphPlanMemory").set_body_typed(GraphPlanMemory);
 
 }  // namespace relay
@@ -32,6 +32,8 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/object.h>
 
+#include <unordered_map>
+
 #include "compile_engine.h"
 
 namespace tvm {
@@ -283,9 +285,44 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
     return MakeClosure(func);
   }
 
+  // The lowered shape function of a primitive function, and the built one.
+  struct ShapeFunc {
+    CachedFunc cfunc;
+    PackedFunc func;
+  };
+
+  // Get the shape function of a primitive function, lowered and built once per interpreter.
+  const ShapeFunc& GetShapeFunc(const Function& func) {
+    auto it = shape_funcs_.find(func);
+    if (it != shape_funcs_.end()) return it->second;
+    CachedFunc cfunc = engine_->LowerShapeFunc(CCacheKey(func, Target("llvm")));
+    // the compile engine returns the same lowering for equal functions
+    PackedFunc& built = built_shape_funcs_[cfunc];
+    if (built == nullptr) {
+      Module m;
+      if (const auto* f = runtime::Registry::Get("relay.backend.build")) {
+        m = (*f)(cfunc->funcs, cfunc->target);
+      } else {
+        m = build(cfunc->funcs, cfunc->target, Target(nullptr));
+      }
+      built = m.GetFunction(cfunc->func_name);
+    }
+    return shape_funcs_[func] = ShapeFunc{cfunc, built};
+  }
+
+  // Compile a primitive function, once per interpreter, so that the calls in loops and
+  // recursions skip the structural hash of the compile engine cache.
+  PackedFunc CompilePrimitive(const Function& func) {
+    auto it = compiled_funcs_.find(func);
+    if (it != compiled_funcs_.end()) return it->second;
+    PackedFunc packed_func = CompilePrimitive(func);
+    compiled_funcs_[func] = packed_func;
+    return packed_func;
+  }
+
   Array<Shape> ComputeDynamicShape(const Function& func, const Array<ObjectRef>& args) {
-    CCacheKey key(func, Target("llvm"));
-    auto cfunc = engine_->LowerShapeFunc(key);
+    const ShapeFunc& shape_func = GetShapeFunc(func);
+    const CachedFunc& cfunc = shape_func.cfunc;
     size_t arity = cfunc->inputs.size() + cfunc->outputs.size();
 
     std::vector<TVMValue> values(arity);
@@ -373,16 +410,8 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
     }
     ICHECK_EQ(cfunc->outputs.size(), out_cnt) << "Shape function output sizes mismatch";
 
-    PackedFunc shape_func;
-    Module m;
     TVMRetValue rv;
-    if (const auto* f = runtime::Registry::Get("relay.backend.build")) {
-      m = (*f)(cfunc->funcs, cfunc->target);
-    } else {
-      m = build(cfunc->funcs, cfunc->target, Target(nullptr));
-    }
-    shape_func = m.GetFunction(cfunc->func_name);
-    shape_func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+    shape_func.func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
 
     // Get output shapes
     Array<Shape> out_shapes;
@@ -711,6 +740,11 @@ class Interpreter : public ExprFunctor<ObjectRef(const Expr& n)>,
   Stack stack_;
   // Backend compile engine.
   CompileEngine engine_;
+  // The compiled primitive functions and their shape functions, by function.
+  std::unordered_map<Function, PackedFunc, ObjectPtrHash, ObjectPtrEqual> compiled_funcs_;
+  std::unordered_map<Function, ShapeFunc, ObjectPtrHash, ObjectPtrEqual> shape_funcs_;
+  // The built shape functions, by lowered shape function.
+  std::unordered_map<CachedFunc, PackedFunc, ObjectPtrHash, ObjectPtrEqual> built_shape_funcs_;
   // Cache ops that need to be frequently used later to reduce lookup overhead.
   const Op& debug_op_;
 };
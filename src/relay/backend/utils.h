@@ -83,6 +83,7 @@ int64_t CalculateRelayExprSizeBytes(const Type& expr_type);
  */
 struct LoweredOutput {
   std::string graph_json;
+  std::string graph_binary;
   Map<String, IRModule> lowered_funcs;
   Array<tvm::runtime::Module> external_mods;
   Map<String, FunctionInfo> function_metadata;
@@ -359,6 +360,28 @@ inline bool IsCompileEngineCacheDisabled() {
       .value();
 }
 
+/*!
+ * \brief Return the directory of the persistent kernel cache set in the pass context, if any.
+ */
+inline Optional<String> GetKernelCacheDir() {
+  return transform::PassContext::Current()->GetConfig<String>("relay.backend.kernel_cache_dir");
+}
+
+/*!
+ * \brief Whether the compile engine may lower the functions of a batch in parallel.
+ *
+ * The worker threads cannot run Python, so the option has no effect with
+ * lowering passes added by tir.add_lower_pass, or with a pass trace function.
+ * \return Whether parallel lowering is enabled.
+ */
+inline bool IsParallelLoweringEnabled() {
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  if (pass_ctx->config.count("tir.add_lower_pass") || pass_ctx->trace_func != nullptr) {
+    return false;
+  }
+  return pass_ctx->GetConfig<Bool>("relay.backend.parallel_lowering", Bool(false)).value();
+}
+
 }  // namespace backend
 }  // namespace relay
 }  // namespace tvm
@@ -566,6 +566,13 @@ class VMFunctionCompiler : ExprFunctor<void(const Expr& expr)> {
 
     // Extract functions attrs
     op_attrs[op_index] = func->attrs->dict;
+    // The FLOPs of the op for the profiler, a MAC being two
+    if (!func->GetAttr<String>(attr::kCompiler).defined()) {
+      int64_t macs = CountMacs(func);
+      if (macs > 0) {
+        op_attrs[op_index].Set("flops", String(std::to_string(2 * macs)));
+      }
+    }
 
     Emit(Instruction::InvokePacked(op_index, argument_registers.size(), output_tuple->fields.size(),
                                    argument_registers));
@@ -996,11 +1003,8 @@ transform::Sequential MemoryOpt(tvm::Target host_target, TargetsMap targets) {
   // Fuse the shape functions.
   pass_seqs.push_back(transform::FuseOps());
 
-  // TODO(mbrookhart, jroesch, masahi): this pass is very slow, and is
-  // incomplete to provide memory resuse optimizations. Disable it until we can
-  // rewrite it in C++ and complete it.
-  // // Perform memory planning in order to coalesce/reduce allocations.
-  // pass_seqs.push_back(transform::MemoryPlan());
+  // Coalesce the static allocations into regions and hoist them out of the loops.
+  pass_seqs.push_back(transform::CoalesceStorage());
 
   // Compute away constant computation introduced by coalescing allocations.
   pass_seqs.push_back(transform::FoldConstant());
@@ -140,6 +140,8 @@ Let::Let(Var var, Expr value, Expr body, Span span) {
   n->value = std::move(value);
   n->body = std::move(body);
   n->span = std::move(span);
+  n->saved_deleter_ = n->deleter_;
+  n->deleter_ = LetNode::Deleter_;
   data_ = std::move(n);
 }
 
@@ -336,5 +338,32 @@ void CallNode::Deleter_(Object* ptr) {
   auto c = GetRef<Call>(p);
 }
 
+/*
+ * Non-recursive destructor, a let chain is released binding by binding
+ */
+Let::~Let() {
+  if (this->use_count() < 2) {
+    if (auto* op = const_cast<LetNode*>(this->as<LetNode>())) {
+      Expr body = std::move(op->body);
+      // detach the body of each let only referenced by the chain before releasing it
+      while (body.use_count() < 2 && body.as<LetNode>()) {
+        Expr next = std::move(const_cast<LetNode*>(body.as<LetNode>())->body);
+        body = std::move(next);
+      }
+    }
+  }
+}
+
+/*
+ * LetNode's deleter
+ */
+void LetNode::Deleter_(Object* ptr) {
+  auto p = reinterpret_cast<LetNode*>(ptr);
+  // resore original deleter
+  p->deleter_ = p->saved_deleter_;
+  // create Let reference in order to invoke ~Let
+  auto l = GetRef<Let>(p);
+}
+
 }  // namespace relay
 }  // namespace tvm
@@ -286,6 +286,7 @@ This function takes a tensor, a minimum value `a_min`, and a maximum value `a_ma
     .add_type_rel("Identity", IdentityRel)
     .set_attr<TOpPattern>("TOpPattern", kElemWise)
     .set_attr<TOpIsStateful>("TOpIsStateful", false)
+    .set_attr<TOpInPlace>("TOpInPlace", true)
     .set_attr<FInferCorrectLayout>("FInferCorrectLayout", ElemwiseArbitraryLayout)
     .set_attrs_type<ClipAttrs>()
     .set_support_level(3);
@@ -51,7 +51,14 @@ bool SimulatedQuantizeRel(const Array<Type>& types, int num_inputs, const Attrs&
 
   ICHECK_NE(data->shape.size(), 0) << "Input shape cannot be empty";
 
-  reporter->Assign(types[1], TensorType({}, DataType::Float(32)));  // dom_scale
+  // dom_scale, a scalar or the per-channel scales of a weight broadcast to its shape
+  const auto* dom_scale = types[1].as<TensorTypeNode>();
+  if (dom_scale == nullptr || dom_scale->shape.size() == 0) {
+    reporter->Assign(types[1], TensorType({}, DataType::Float(32)));
+  } else {
+    ICHECK(param->kind == kQWeight) << "Only weights can have per-channel scales";
+    ICHECK(dom_scale->dtype == DataType::Float(32));
+  }
   reporter->Assign(types[2], TensorType({}, DataType::Float(32)));  // clip_min
   reporter->Assign(types[3], TensorType({}, DataType::Float(32)));  // clip_max
   reporter->Assign(types[4], types[0]);                             // output
@@ -62,7 +69,9 @@ RELAY_REGISTER_OP("relay.op.annotation.simulated_quantize")
     .describe(R"code(simulated quantize op)code" TVM_ADD_FILELINE)
     .set_num_inputs(4)
     .add_argument("data", "Tensor", "The input data.")
-    .add_argument("dom_scale", "Tensor", "The domain scale of input data. It should be a scalar")
+    .add_argument("dom_scale", "Tensor",
+                  "The domain scale of input data. It should be a scalar, or the per-channel "
+                  "scales of a weight")
     .add_argument("clip_min", "Tensor", "lower bound. It should be a scalar")
     .add_argument("clip_max", "Tensor", "upper bound. It should be a scalar")
     .set_attrs_type<SimulatedQuantizeAttrs>()
@@ -131,6 +140,7 @@ TVM_STATIC_IR_FUNCTOR(ReprPrinter, vtable)
       p->stream << "round_for_shift==" << op->round_for_shift << ", ";
       p->stream << "debug_enabled_ops==" << op->debug_enabled_ops << ", ";
       p->stream << "rounding==" << op->rounding << ", ";
+      p->stream << "calibrate_power2==" << op->calibrate_power2 << ", ";
       p->stream << "partition_conversions==" << op->partition_conversions;
       p->stream << ")";
     });
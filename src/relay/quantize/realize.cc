@@ -28,6 +28,12 @@
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/annotation.h>
 #include <tvm/relay/transform.h>
+#include <tvm/tir/data_layout.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
 
 #include "../qnn/utils.h"
 #include "../transforms/pattern_utils.h"
@@ -125,6 +131,58 @@ inline Expr MulAndDiv(Expr data, float s1, float s2, DataType dtype,
   }
 }
 
+// Whether the domain scale is per-channel, a tensor broadcast to the weight.
+inline bool IsPerChannelScale(const Expr& dom_scale) {
+  const auto* n = dom_scale.as<ConstantNode>();
+  return n != nullptr && !n->is_scalar();
+}
+
+/*
+ * Requantize the per-channel accumulators of a conv or dense, whose channel c has the scale
+ * `in_scale * weight_scale[c]`, to the scale `in_scale * max(weight_scale)`. When the ratios of
+ * the weight scales are powers of two, as with the channel_power2 weight scales, this is a
+ * right shift per channel.
+ */
+Expr UnifyChannelScale(const Expr& data, const Expr& in_scale, const Expr& weight_scale,
+                       const Array<IndexExpr>& out_shape, int channel_axis, Expr* dom_scale) {
+  const QConfig& cfg = QConfig::Current();
+  const auto* n = weight_scale.as<ConstantNode>();
+  ICHECK(n != nullptr && n->data->dtype.code == kDLFloat && n->data->dtype.bits == 32);
+  runtime::NDArray scales = n->data.CopyTo({kDLCPU, 0});
+  const float* values = static_cast<const float*>(scales->data);
+  int64_t num_channels = 1;
+  for (int64_t dim : scales.Shape()) num_channels *= dim;
+  float max_scale = *std::max_element(values, values + num_channels);
+  ICHECK_GT(max_scale, 0);
+
+  std::vector<double> multipliers;
+  std::vector<int32_t> shifts, round_biases;
+  bool shift_only = true;
+  for (int64_t i = 0; i < num_channels; ++i) {
+    double multiplier = values[i] / max_scale;
+    float shift = -std::log2(multiplier);
+    shift_only = shift_only && static_cast<int>(shift) == shift;
+    multipliers.push_back(multiplier);
+    shifts.push_back(static_cast<int>(shift));
+    round_biases.push_back(shifts.back() > 0 && cfg->round_for_shift ? 1 << (shifts.back() - 1)
+                                                                     : 0);
+  }
+  float in_scale_imm = GetScalarFromConstant<float>(in_scale);
+  *dom_scale = MakeConstantScalar(DataType::Float(32), in_scale_imm * max_scale);
+
+  int ndim = out_shape.size();
+  if (shift_only) {
+    DataType dtype = cfg->dtype_activation;
+    Expr bias = MakeConstantTensor(dtype, {num_channels}, round_biases);
+    Expr shift = MakeConstantTensor(dtype, {num_channels}, shifts);
+    Expr ret = Add(data, ExpandBiasToMatchAxis(bias, ndim, {channel_axis}));
+    return RightShift(ret, ExpandBiasToMatchAxis(shift, ndim, {channel_axis}));
+  }
+  return Cast(qnn::FixedPointMultiplyPerChannel(data, multipliers, out_shape, channel_axis,
+                                                cfg->rounding),
+              cfg->dtype_activation);
+}
+
 Expr QuantizeRealize(const Call& ref_call, const Array<Expr>& new_args, const ObjectRef& ctx) {
   const QConfig& cfg = QConfig::Current();
   // do not handle data type cast
@@ -135,7 +193,6 @@ Expr QuantizeRealize(const Call& ref_call, const Array<Expr>& new_args, const Ob
   Expr clip_min = new_args[2];
   Expr clip_max = new_args[3];
 
-  float dom_scale_imm = GetScalarFromConstant<float>(dom_scale);
   float clip_min_imm = GetScalarFromConstant<float>(clip_min);
   float clip_max_imm = GetScalarFromConstant<float>(clip_max);
 
@@ -188,7 +245,14 @@ Expr QuantizeRealize(const Call& ref_call, const Array<Expr>& new_args, const Ob
   // quantize from real
   ICHECK(!new_args[0]->IsInstance<TempExprNode>());
   Expr data = new_args[0];
-  Expr scaled_data = Multiply(data, MakeConstantScalar(DataType::Float(32), 1 / dom_scale_imm));
+  Expr scaled_data;
+  if (IsPerChannelScale(dom_scale)) {
+    // per-channel weights, folded into constants afterwards
+    scaled_data = Divide(data, dom_scale);
+  } else {
+    float dom_scale_imm = GetScalarFromConstant<float>(dom_scale);
+    scaled_data = Multiply(data, MakeConstantScalar(DataType::Float(32), 1 / dom_scale_imm));
+  }
   Expr round_data = Clip(Round(scaled_data), clip_min_imm, clip_max_imm);
   return QRealizeIntExpr(round_data, dom_scale, DataType::Float(32));
 }
@@ -203,6 +267,22 @@ Expr FoldConstantOpt(const Expr& expr) {
 RELAY_REGISTER_OP("relay.op.annotation.simulated_quantize")
     .set_attr<FForwardRewrite>("FQRealizeRewrite", QuantizeRealize);
 
+// The result of a conv or dense, unifying the per-channel scales of its weight.
+Expr RealizeMatmulResult(const Call& ref_call, const Expr& ret, const QRealizeIntExprNode* lhs,
+                         const QRealizeIntExprNode* rhs, int channel_axis) {
+  const QConfig& cfg = QConfig::Current();
+  if (IsPerChannelScale(rhs->dom_scale)) {
+    Expr dom_scale;
+    Expr data = UnifyChannelScale(ret, lhs->dom_scale, rhs->dom_scale,
+                                  ref_call->type_as<TensorTypeNode>()->shape, channel_axis,
+                                  &dom_scale);
+    return QRealizeIntExpr(data, dom_scale, cfg->dtype_activation);
+  }
+  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
+  Expr dom_scale = FoldConstantOpt(mul);
+  return QRealizeIntExpr(ret, dom_scale, cfg->dtype_activation);
+}
+
 Expr Conv2dRealize(const Call& ref_call, const Array<Expr>& new_args, const ObjectRef& ctx) {
   const QConfig& cfg = QConfig::Current();
   ICHECK_EQ(new_args.size(), 2);
@@ -227,9 +307,10 @@ Expr Conv2dRealize(const Call& ref_call, const Array<Expr>& new_args, const Obje
   attrs->out_dtype = out_dtype;
 
   Expr ret = Call(ref_call->op, {ldata, rdata}, Attrs(attrs), ref_call->type_args);
-  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
-  Expr dom_scale = FoldConstantOpt(mul);
-  return QRealizeIntExpr(ret, dom_scale, out_dtype);
+  const std::string& out_layout =
+      ref_attrs->out_layout.empty() ? ref_attrs->data_layout : ref_attrs->out_layout;
+  int channel_axis = tir::Layout(out_layout).IndexOf(tir::LayoutAxis::Get('C'));
+  return RealizeMatmulResult(ref_call, ret, lhs, rhs, channel_axis);
 }
 
 RELAY_REGISTER_OP("nn.conv2d").set_attr<FForwardRewrite>("FQRealizeRewrite", Conv2dRealize);
@@ -258,9 +339,10 @@ Expr Conv1dRealize(const Call& ref_call, const Array<Expr>& new_args, const Obje
   attrs->out_dtype = out_dtype;
 
   Expr ret = Call(ref_call->op, {ldata, rdata}, Attrs(attrs), ref_call->type_args);
-  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
-  Expr dom_scale = FoldConstantOpt(mul);
-  return QRealizeIntExpr(ret, dom_scale, out_dtype);
+  const std::string& out_layout =
+      ref_attrs->out_layout.empty() ? ref_attrs->data_layout : ref_attrs->out_layout;
+  int channel_axis = tir::Layout(out_layout).IndexOf(tir::LayoutAxis::Get('C'));
+  return RealizeMatmulResult(ref_call, ret, lhs, rhs, channel_axis);
 }
 
 RELAY_REGISTER_OP("nn.conv1d").set_attr<FForwardRewrite>("FQRealizeRewrite", Conv1dRealize);
@@ -287,9 +369,8 @@ Expr DenseRealize(const Call& ref_call, const Array<Expr>& new_args, const Objec
   attrs->out_dtype = out_dtype;
 
   Expr ret = Call(ref_call->op, {ldata, rdata}, Attrs(attrs), ref_call->type_args);
-  Expr mul = Multiply(lhs->dom_scale, rhs->dom_scale);
-  Expr dom_scale = FoldConstantOpt(mul);
-  return QRealizeIntExpr(ret, dom_scale, out_dtype);
+  int channel_axis = ref_call->type_as<TensorTypeNode>()->shape.size() - 1;
+  return RealizeMatmulResult(ref_call, ret, lhs, rhs, channel_axis);
 }
 
 RELAY_REGISTER_OP("nn.dense").set_attr<FForwardRewrite>("FQRealizeRewrite", DenseRealize);
@@ -0,0 +1,609 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/coalesce_storage.cc
+ * \brief A pass coalescing the storages allocated by ManifestAlloc.
+ *
+ * ManifestAlloc emits one alloc_storage per tensor. Within each let scope this
+ * pass groups the storages of a static size on the same device into a single
+ * region, the tensors are allocated at offsets of the region, and the tensors
+ * whose lifetimes do not overlap share their offsets.
+ *
+ * The recursive functions, which are the loops once lambda lifted, also take
+ * the storages of their iterations as extra region parameters. The callers
+ * allocate the regions once per loop and the recursive calls pass them on, so
+ * the iterations do not allocate. This is legal only for the tensors which do
+ * not escape the iteration nor are live across a call.
+ */
+#include <tvm/relay/attrs/memory.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op.h>
+#include <tvm/relay/transform.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/logging.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../op/memory/memory.h"
+#include "pattern_utils.h"
+
+namespace tvm {
+namespace relay {
+
+namespace {
+
+/*! \brief The device and dtype hint a region is allocated with. */
+using RegionKey = std::tuple<int, int, std::string>;
+
+/*! \brief A storage of a static size allocated in a let scope. */
+struct StorageInfo {
+  /*! \brief The binding index of the alloc_storage. */
+  size_t def;
+  /*! \brief The binding index of the last use of its tensors. */
+  size_t end;
+  /*! \brief The size in bytes. */
+  int64_t size;
+  /*! \brief The alignment in bytes. */
+  int64_t alignment;
+  /*! \brief The attributes of the alloc_storage. */
+  const AllocStorageAttrs* attrs;
+  /*! \brief Whether the storage is used other than to allocate tensors. */
+  bool invalid{false};
+  /*! \brief Whether one of its tensors escapes the scope. */
+  bool escaped{false};
+  /*! \brief The binding indices of its alloc_tensor. */
+  std::vector<size_t> tensors;
+  /*! \brief The offset assigned in the region. */
+  int64_t offset{0};
+};
+
+/*! \brief A region hoisted out of the iterations of a recursive function. */
+struct HoistedRegion {
+  /*! \brief The region parameter of the function. */
+  Var param;
+  /*! \brief The size in bytes. */
+  int64_t size{0};
+  /*! \brief The alignment in bytes. */
+  int64_t alignment{1};
+  /*! \brief The device of the region. */
+  Device device;
+  /*! \brief The dtype hint of the region. */
+  DataType dtype;
+};
+
+int64_t RoundUp(int64_t value, int64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+bool GetScalar(const Expr& expr, int64_t* value) {
+  const auto* konst = expr.as<ConstantNode>();
+  if (konst == nullptr || !konst->is_scalar()) return false;
+  auto scalar = TryToScalar(konst->data);
+  if (!scalar) return false;
+  *value = static_cast<int64_t>(scalar.value());
+  return true;
+}
+
+/*! \brief Collect the variables an expression references, iterating on the let chains. */
+class VarCollector : public ExprVisitor {
+ public:
+  std::vector<const VarNode*> Collect(const Expr& expr) {
+    vars_.clear();
+    VisitExpr(expr);
+    return std::move(vars_);
+  }
+
+  void VisitExpr_(const VarNode* op) final { vars_.push_back(op); }
+
+  void VisitExpr_(const LetNode* op) final {
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+ private:
+  std::vector<const VarNode*> vars_;
+};
+
+/*!
+ * \brief Find the global functions whose storages may be hoisted: the self recursive
+ * functions other than main and the closures, whose global var is only ever called.
+ */
+class RecursionFinder : public ExprVisitor {
+ public:
+  std::unordered_set<const GlobalVarNode*> Find(const IRModule& mod) {
+    for (const auto& it : mod->functions) {
+      if (const auto* func = it.second.as<FunctionNode>()) {
+        if (func->HasNonzeroAttr(attr::kPrimitive)) continue;
+        current_ = it.first.get();
+        VisitExpr(GetRef<Function>(func));
+      }
+    }
+    std::unordered_set<const GlobalVarNode*> result;
+    for (const GlobalVarNode* gv : recursive_) {
+      auto func = Downcast<Function>(mod->Lookup(GetRef<GlobalVar>(gv)));
+      if (gv->name_hint != "main" && !escaped_.count(gv) &&
+          !func->HasNonzeroAttr(attr::kClosure)) {
+        result.insert(gv);
+      }
+    }
+    return result;
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (const auto* gv = op->op.as<GlobalVarNode>()) {
+      if (gv == current_) recursive_.insert(gv);
+    } else {
+      VisitExpr(op->op);
+    }
+    for (const Expr& arg : op->args) VisitExpr(arg);
+  }
+
+  void VisitExpr_(const GlobalVarNode* op) final { escaped_.insert(op); }
+
+  void VisitExpr_(const FunctionNode* op) final {
+    if (!op->HasNonzeroAttr(attr::kPrimitive)) ExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      VisitExpr(let->value);
+      expr = let->body;
+    }
+    VisitExpr(expr);
+  }
+
+ private:
+  const GlobalVarNode* current_{nullptr};
+  std::unordered_set<const GlobalVarNode*> recursive_;
+  std::unordered_set<const GlobalVarNode*> escaped_;
+};
+
+class StorageCoalescer : public ExprMutator {
+ public:
+  explicit StorageCoalescer(Type storage_type) : storage_type_(storage_type) {}
+
+  /*!
+   * \brief Coalesce the storages of a global function.
+   * \param func The function.
+   * \param hoist Whether the storages of the iterations of the function may be hoisted.
+   * \return The function, with the region parameters of the hoisted storages appended.
+   */
+  Function Rewrite(const Function& func, bool hoist) {
+    hoist_ = hoist;
+    Expr body = VisitExpr(func->body);
+    hoist_ = false;
+    Array<Var> params = func->params;
+    for (const auto& it : hoisted_) params.push_back(it.second.param);
+    return Function(params, body, func->ret_type, func->type_params, func->attrs, func->span);
+  }
+
+  /*! \return The regions hoisted out of the function, in parameter order. */
+  std::vector<HoistedRegion> Hoisted() const {
+    std::vector<HoistedRegion> regions;
+    for (const auto& it : hoisted_) regions.push_back(it.second);
+    return regions;
+  }
+
+  Expr VisitExpr_(const FunctionNode* op) final {
+    if (op->HasNonzeroAttr(attr::kPrimitive)) return GetRef<Expr>(op);
+    // The storages of a local function belong to its calls, never hoist them.
+    bool hoist = hoist_;
+    hoist_ = false;
+    Expr ret = ExprMutator::VisitExpr_(op);
+    hoist_ = hoist;
+    return ret;
+  }
+
+  Expr VisitExpr_(const LetNode* op) final {
+    std::vector<std::pair<Var, Expr>> bindings;
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      bindings.emplace_back(let->var, VisitExpr(let->value));
+      expr = let->body;
+    }
+    Expr body = VisitExpr(expr);
+    return Coalesce(&bindings, body);
+  }
+
+ private:
+  /*! \brief Plan and rewrite the storages of the bindings of one let scope. */
+  Expr Coalesce(std::vector<std::pair<Var, Expr>>* bindings, const Expr& body) {
+    static const Op& alloc_storage_op = Op::Get("memory.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("memory.alloc_tensor");
+    static const Op& invoke_tvm_op = Op::Get("vm.invoke_tvm_op");
+    static const Op& shape_func_op = Op::Get("vm.shape_func");
+    static const Op& shape_of_op = Op::Get("vm.shape_of");
+    static const Op& reshape_tensor_op = Op::Get("vm.reshape_tensor");
+    static const Op& device_copy_op = Op::Get("device_copy");
+
+    std::vector<StorageInfo> infos;
+    // The storage var of each storage.
+    std::unordered_map<const VarNode*, size_t> storage_of;
+    // The storages the tensor bound to a var may live in.
+    std::unordered_map<const VarNode*, std::vector<size_t>> roots;
+    // The bindings which may call a function.
+    std::vector<size_t> barriers;
+
+    auto escape = [&](const Expr& expr) {
+      for (const VarNode* var : collector_.Collect(expr)) {
+        auto sit = storage_of.find(var);
+        if (sit != storage_of.end()) infos[sit->second].invalid = true;
+        auto rit = roots.find(var);
+        if (rit == roots.end()) continue;
+        for (size_t id : rit->second) infos[id].escaped = true;
+      }
+    };
+    // A use which only reads or writes the tensor during the binding.
+    auto use = [&](const Expr& expr, size_t index) {
+      const auto* var = expr.as<VarNode>();
+      if (var == nullptr) return escape(expr);
+      auto sit = storage_of.find(var);
+      if (sit != storage_of.end()) infos[sit->second].invalid = true;
+      auto rit = roots.find(var);
+      if (rit == roots.end()) return;
+      for (size_t id : rit->second) infos[id].end = std::max(infos[id].end, index);
+    };
+    auto use_fields = [&](const Expr& expr, size_t index) {
+      if (const auto* tuple = expr.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) use(field, index);
+      } else {
+        escape(expr);
+      }
+    };
+    auto alias = [&](const VarNode* var, const Expr& expr, size_t index) {
+      use(expr, index);
+      if (const auto* src = expr.as<VarNode>()) {
+        auto rit = roots.find(src);
+        if (rit != roots.end()) {
+          std::vector<size_t>& ids = roots[var];
+          ids.insert(ids.end(), rit->second.begin(), rit->second.end());
+        }
+      }
+    };
+
+    for (size_t i = 0; i < bindings->size(); ++i) {
+      const VarNode* var = (*bindings)[i].first.get();
+      const Expr& value = (*bindings)[i].second;
+      const auto* call = value.as<CallNode>();
+      if (call && call->op == alloc_storage_op) {
+        StorageInfo info;
+        info.def = info.end = i;
+        info.attrs = call->attrs.as<AllocStorageAttrs>();
+        if (info.attrs && GetScalar(call->args[0], &info.size) &&
+            GetScalar(call->args[1], &info.alignment) && info.alignment > 0) {
+          storage_of[var] = infos.size();
+          infos.push_back(info);
+        } else {
+          escape(value);
+        }
+      } else if (call && call->op == alloc_tensor_op) {
+        const auto* storage = call->args[0].as<VarNode>();
+        int64_t offset = -1;
+        auto sit = storage ? storage_of.find(storage) : storage_of.end();
+        if (sit != storage_of.end() && GetScalar(call->args[1], &offset) && offset == 0) {
+          StorageInfo& info = infos[sit->second];
+          info.tensors.push_back(i);
+          info.end = i;
+          roots[var] = {sit->second};
+          use(call->args[2], i);
+        } else {
+          escape(value);
+        }
+      } else if (call && call->op == invoke_tvm_op) {
+        use_fields(call->args[1], i);
+        use_fields(call->args[2], i);
+      } else if (call && call->op == shape_func_op) {
+        use_fields(call->args[1], i);
+        use_fields(call->args[2], i);
+      } else if (call && (call->op == shape_of_op || call->op == device_copy_op)) {
+        use(call->args[0], i);
+      } else if (call && call->op == reshape_tensor_op) {
+        alias(var, call->args[0], i);
+        use(call->args[1], i);
+      } else if (value.as<VarNode>()) {
+        alias(var, value, i);
+      } else if (const auto* tuple = value.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) alias(var, field, i);
+      } else if (const auto* get = value.as<TupleGetItemNode>()) {
+        alias(var, get->tuple, i);
+      } else if (const auto* ite = value.as<IfNode>()) {
+        // The condition is read before the branches run.
+        barriers.push_back(i);
+        use(ite->cond, i);
+        escape(ite->true_branch);
+        escape(ite->false_branch);
+      } else {
+        if (!value.as<ConstantNode>() && !value.as<FunctionNode>() && !value.as<GlobalVarNode>()) {
+          barriers.push_back(i);
+        }
+        escape(value);
+      }
+    }
+    escape(body);
+
+    // Group the storages by device and dtype, and whether they may be hoisted.
+    std::map<std::tuple<bool, RegionKey>, std::vector<size_t>> groups;
+    for (size_t id = 0; id < infos.size(); ++id) {
+      StorageInfo& info = infos[id];
+      if (info.invalid || info.tensors.empty()) continue;
+      if (info.escaped) info.end = std::numeric_limits<size_t>::max();
+      bool hoist = hoist_ && !info.escaped;
+      for (size_t barrier : barriers) {
+        if (barrier > info.def && barrier < info.end) hoist = false;
+      }
+      RegionKey key(info.attrs->device_type, info.attrs->device_id,
+                    runtime::DLDataType2String(info.attrs->dtype));
+      groups[std::make_tuple(hoist, key)].push_back(id);
+    }
+
+    // The region var and offset each storage is rewritten to.
+    std::unordered_map<size_t, Var> region_of;
+    // The bindings of the non hoisted regions, at the index of their first storage.
+    std::unordered_map<size_t, std::pair<Var, Expr>> region_bindings;
+    for (const auto& it : groups) {
+      bool hoist = std::get<0>(it.first);
+      const std::vector<size_t>& members = it.second;
+      if (!hoist && members.size() < 2) continue;
+      int64_t alignment = 1;
+      for (size_t id : members) alignment = std::max(alignment, infos[id].alignment);
+      int64_t size = PlanOffsets(&infos, members, alignment);
+      const AllocStorageAttrs* attrs = infos[members[0]].attrs;
+      Device device{static_cast<DLDeviceType>(attrs->device_type), attrs->device_id};
+      Var region;
+      if (hoist) {
+        HoistedRegion& hoisted = HoistedFor(std::get<1>(it.first), device, attrs->dtype);
+        int64_t base = RoundUp(hoisted.size, alignment);
+        for (size_t id : members) infos[id].offset += base;
+        hoisted.size = base + size;
+        hoisted.alignment = std::max(hoisted.alignment, alignment);
+        region = hoisted.param;
+      } else {
+        region = Var("region", Type(nullptr));
+        region_bindings[infos[members[0]].def] = {
+            region,
+            AllocStorage(MakeConstantScalar(DataType::Int(64), size),
+                         MakeConstantScalar(DataType::Int(64), alignment), device, attrs->dtype)};
+      }
+      for (size_t id : members) region_of[id] = region;
+    }
+    if (region_of.empty()) return MakeLets(*bindings, body);
+
+    std::vector<std::pair<Var, Expr>> rewritten;
+    for (size_t id = 0; id < infos.size(); ++id) {
+      auto rit = region_of.find(id);
+      if (rit == region_of.end()) continue;
+      for (size_t index : infos[id].tensors) {
+        auto call = Downcast<Call>((*bindings)[index].second);
+        (*bindings)[index].second =
+            Call(call->op,
+                 {rit->second, MakeConstantScalar(DataType::Int(64), infos[id].offset),
+                  call->args[2]},
+                 call->attrs, call->type_args, call->span);
+      }
+    }
+    std::unordered_set<size_t> dropped;
+    for (const auto& it : region_of) dropped.insert(infos[it.first].def);
+    for (size_t i = 0; i < bindings->size(); ++i) {
+      auto bit = region_bindings.find(i);
+      if (bit != region_bindings.end()) rewritten.push_back(bit->second);
+      if (dropped.count(i)) continue;
+      rewritten.push_back((*bindings)[i]);
+    }
+    return MakeLets(rewritten, body);
+  }
+
+  /*!
+   * \brief Assign the offsets of the storages in their region, the storages whose
+   * lifetimes do not overlap share their offsets.
+   * \return The size of the region.
+   */
+  static int64_t PlanOffsets(std::vector<StorageInfo>* infos, const std::vector<size_t>& members,
+                             int64_t alignment) {
+    struct Block {
+      int64_t offset;
+      int64_t size;
+      size_t end;
+    };
+    std::vector<Block> blocks;
+    int64_t total = 0;
+    for (size_t id : members) {
+      StorageInfo& info = (*infos)[id];
+      int64_t size = RoundUp(info.size, alignment);
+      Block* best = nullptr;
+      for (Block& block : blocks) {
+        if (block.end < info.def && block.size >= size && (!best || block.size < best->size)) {
+          best = &block;
+        }
+      }
+      if (best) {
+        best->end = info.end;
+        info.offset = best->offset;
+      } else {
+        blocks.push_back({total, size, info.end});
+        info.offset = total;
+        total += size;
+      }
+    }
+    return total;
+  }
+
+  HoistedRegion& HoistedFor(const RegionKey& key, Device device, DataType dtype) {
+    auto it = hoisted_.find(key);
+    if (it == hoisted_.end()) {
+      HoistedRegion region;
+      region.param = Var("region", storage_type_);
+      region.device = device;
+      region.dtype = dtype;
+      it = hoisted_.emplace(key, region).first;
+    }
+    return it->second;
+  }
+
+  static Expr MakeLets(const std::vector<std::pair<Var, Expr>>& bindings, Expr body) {
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return body;
+  }
+
+  /*! \brief The type of the region parameters. */
+  Type storage_type_;
+  /*! \brief Whether the current scope belongs to the iterations of the function. */
+  bool hoist_{false};
+  /*! \brief The regions hoisted out of the function. */
+  std::map<RegionKey, HoistedRegion> hoisted_;
+  VarCollector collector_;
+};
+
+/*! \brief Pass the hoisted regions to the calls of the functions they were hoisted from. */
+class RegionArgumentAdder : public ExprMutator {
+ public:
+  RegionArgumentAdder(
+      const std::unordered_map<const GlobalVarNode*, std::vector<HoistedRegion>>& hoisted,
+      const GlobalVarNode* current)
+      : hoisted_(hoisted), current_(current) {}
+
+  Expr VisitExpr_(const LetNode* op) final {
+    std::vector<std::pair<Var, Expr>> bindings;
+    Expr expr = GetRef<Expr>(op);
+    while (const auto* let = expr.as<LetNode>()) {
+      const auto* call = let->value.as<CallNode>();
+      if (call && IsHoisted(call) && call->op.get() != current_) {
+        // Keep the allocations of the regions in the let chain.
+        Array<Expr> args;
+        for (const Expr& arg : call->args) args.push_back(VisitExpr(arg));
+        for (const HoistedRegion& region : hoisted_.at(call->op.as<GlobalVarNode>())) {
+          Var var("region", Type(nullptr));
+          bindings.emplace_back(var, Allocate(region));
+          args.push_back(var);
+        }
+        bindings.emplace_back(let->var,
+                              Call(call->op, args, call->attrs, call->type_args, call->span));
+      } else {
+        bindings.emplace_back(let->var, VisitExpr(let->value));
+      }
+      expr = let->body;
+    }
+    Expr body = VisitExpr(expr);
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return body;
+  }
+
+  Expr VisitExpr_(const CallNode* op) final {
+    auto call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    if (!IsHoisted(op)) return std::move(call);
+    const auto* gv = op->op.as<GlobalVarNode>();
+    const std::vector<HoistedRegion>& regions = hoisted_.at(gv);
+    Array<Expr> args = call->args;
+    if (gv == current_) {
+      // The iterations of a loop share its regions.
+      for (const HoistedRegion& region : regions) args.push_back(region.param);
+      return Call(call->op, args, call->attrs, call->type_args, call->span);
+    }
+    std::vector<std::pair<Var, Expr>> bindings;
+    for (const HoistedRegion& region : regions) {
+      Var var("region", Type(nullptr));
+      bindings.emplace_back(var, Allocate(region));
+      args.push_back(var);
+    }
+    Expr body = Call(call->op, args, call->attrs, call->type_args, call->span);
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return body;
+  }
+
+  Expr VisitExpr_(const FunctionNode* op) final {
+    if (op->HasNonzeroAttr(attr::kPrimitive)) return GetRef<Expr>(op);
+    return ExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  bool IsHoisted(const CallNode* call) const {
+    const auto* gv = call->op.as<GlobalVarNode>();
+    return gv && hoisted_.count(gv);
+  }
+
+  static Expr Allocate(const HoistedRegion& region) {
+    return AllocStorage(MakeConstantScalar(DataType::Int(64), std::max<int64_t>(region.size, 1)),
+                        MakeConstantScalar(DataType::Int(64), region.alignment), region.device,
+                        region.dtype);
+  }
+
+  const std::unordered_map<const GlobalVarNode*, std::vector<HoistedRegion>>& hoisted_;
+  const GlobalVarNode* current_;
+};
+
+}  // namespace
+
+namespace transform {
+
+Pass CoalesceStorage() {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule mod,
+                                                                            PassContext ctx) {
+    mod.CopyOnWrite();
+    mod->ImportFromStd("core.rly");
+    Type storage_type = TypeCall(mod->GetGlobalTypeVar("Storage"), {});
+    std::unordered_set<const GlobalVarNode*> loops = RecursionFinder().Find(mod);
+
+    std::unordered_map<const GlobalVarNode*, std::vector<HoistedRegion>> hoisted;
+    std::vector<std::pair<GlobalVar, Function>> updates;
+    for (const auto& it : mod->functions) {
+      const auto* func = it.second.as<FunctionNode>();
+      if (func == nullptr || func->HasNonzeroAttr(attr::kPrimitive)) continue;
+      StorageCoalescer coalescer(storage_type);
+      Function updated = coalescer.Rewrite(GetRef<Function>(func), loops.count(it.first.get()));
+      std::vector<HoistedRegion> regions = coalescer.Hoisted();
+      if (!regions.empty()) hoisted[it.first.get()] = regions;
+      updates.emplace_back(it.first, updated);
+    }
+    for (auto& it : updates) {
+      if (!hoisted.empty()) {
+        it.second = Downcast<Function>(RegionArgumentAdder(hoisted, it.first.get())(it.second));
+      }
+      mod->Update(it.first, it.second);
+    }
+    return InferType()(mod);
+  };
+  return tvm::transform::CreateModulePass(pass_func, 0, "CoalesceStorage", {});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.CoalesceStorage").set_body_typed(CoalesceStorage);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -26,99 +26,169 @@
  * to replace an expression with a previously appeared expression with the same input and
  * attributes. The fskip callback argument allows us to skip specific expressions.
  */
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/transform.h>
 
+#include <cstring>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "pattern_utils.h"
 
 namespace tvm {
 namespace relay {
 
+/*!
+ * \brief Hash-conses the calls and the tuple projections, bottom up, so that each is
+ *  replaced by the first equal one. Two calls are equal when their operators and attributes
+ *  are, and their arguments are the same expressions or equal scalar constants. The tensor
+ *  constants with the same data are merged first, so that the calls on them are merged too.
+ *
+ *  An eliminator can visit several functions, which share their equal constants and the
+ *  equal subexpressions that only use constants.
+ */
 class CommonSubexprEliminator : public MixedModeMutator {
  public:
   explicit CommonSubexprEliminator(runtime::TypedPackedFunc<bool(Expr)> fskip) : fskip_(fskip) {}
 
+  using MixedModeMutator::VisitExpr_;
+
+  Expr VisitExpr_(const ConstantNode* op) final {
+    Constant constant = GetRef<Constant>(op);
+    const DLTensor* data = op->data.operator->();
+    // fskip only sees the calls and the tuple projections, merging constants is always safe
+    if (op->is_scalar() || data->device.device_type != kDLCPU || !op->data.IsContiguous()) {
+      return std::move(constant);
+    }
+    std::vector<int64_t> key = {data->dtype.code, data->dtype.bits, data->dtype.lanes};
+    key.insert(key.end(), data->shape, data->shape + data->ndim);
+    std::vector<Constant>& candidates = constants_[key];
+    size_t size = runtime::GetDataSize(*data);
+    for (const Constant& candidate : candidates) {
+      const DLTensor* other = candidate->data.operator->();
+      if (std::memcmp(static_cast<const char*>(data->data) + data->byte_offset,
+                      static_cast<const char*>(other->data) + other->byte_offset, size) == 0) {
+        return candidate;
+      }
+    }
+    candidates.push_back(constant);
+    return std::move(constant);
+  }
+
   Expr Rewrite_(const CallNode* call, const Expr& post) final {
     static auto op_stateful = Op::GetAttrMap<TOpIsStateful>("TOpIsStateful");
-    Expr new_expr = post;
-    const CallNode* new_call = new_expr.as<CallNode>();
+    const CallNode* new_call = post.as<CallNode>();
     ICHECK(new_call);
     const OpNode* op = new_call->op.as<OpNode>();
-    StructuralEqual attrs_equal;
 
     if (new_call->args.size() == 0 || op == nullptr || op_stateful.get(GetRef<Op>(op), false)) {
-      return new_expr;
+      return post;
     }
-    if (fskip_ != nullptr && fskip_(new_expr)) {
-      return new_expr;
+    if (fskip_ != nullptr && fskip_(post)) {
+      return post;
     }
-
-    auto it = expr_map_.find(new_call->op);
-    if (it != expr_map_.end()) {
-      for (const Expr& candidate_expr : it->second) {
-        if (const CallNode* candidate = candidate_expr.as<CallNode>()) {
-          bool is_equivalent = true;
-          if (!attrs_equal(new_call->attrs, candidate->attrs)) {
-            continue;
-          }
-          for (size_t i = 0; i < new_call->args.size(); i++) {
-            if (!new_call->args[i].same_as(candidate->args[i]) &&
-                !IsEqualScalar(new_call->args[i], candidate->args[i])) {
-              is_equivalent = false;
-              break;
-            }
-          }
-          if (!is_equivalent) continue;
-          return GetRef<Call>(candidate);
-        }
-      }
-    }
-    expr_map_[new_call->op].push_back(new_expr);
-    return new_expr;
+    return *calls_.insert(GetRef<Call>(new_call)).first;
   }
 
   Expr Rewrite_(const TupleGetItemNode* op, const Expr& post) final {
-    Expr new_expr = post;
-    const TupleGetItemNode* new_tuple_item = new_expr.as<TupleGetItemNode>();
+    const TupleGetItemNode* new_tuple_item = post.as<TupleGetItemNode>();
     ICHECK(new_tuple_item);
 
-    if (fskip_ != nullptr && fskip_(new_expr)) {
-      return new_expr;
+    if (fskip_ != nullptr && fskip_(post)) {
+      return post;
     }
+    return *tuple_items_.insert(GetRef<TupleGetItem>(new_tuple_item)).first;
+  }
 
-    auto it = expr_map_.find(new_tuple_item->tuple);
-    if (it != expr_map_.end()) {
-      for (const Expr& candidate_expr : it->second) {
-        if (const TupleGetItemNode* candidate = candidate_expr.as<TupleGetItemNode>()) {
-          if (new_tuple_item->index == candidate->index) {
-            return GetRef<Expr>(candidate);
-          }
+ private:
+  // The scalar constants are compared by value, the other arguments by identity.
+  static size_t ArgHash(const Expr& arg) {
+    const auto* constant = arg.as<ConstantNode>();
+    if (constant && constant->is_scalar()) return StructuralHash()(arg);
+    return ObjectPtrHash()(arg);
+  }
+
+  struct CallHash {
+    size_t operator()(const Call& call) const {
+      size_t hash = ObjectPtrHash()(call->op);
+      if (call->attrs.defined()) hash = dmlc::HashCombine(hash, StructuralHash()(call->attrs));
+      for (const Expr& arg : call->args) hash = dmlc::HashCombine(hash, ArgHash(arg));
+      return hash;
+    }
+  };
+
+  struct CallEqual {
+    bool operator()(const Call& lhs, const Call& rhs) const {
+      if (!lhs->op.same_as(rhs->op) || lhs->args.size() != rhs->args.size() ||
+          !StructuralEqual()(lhs->attrs, rhs->attrs)) {
+        return false;
+      }
+      for (size_t i = 0; i < lhs->args.size(); ++i) {
+        if (!lhs->args[i].same_as(rhs->args[i]) && !IsEqualScalar(lhs->args[i], rhs->args[i])) {
+          return false;
         }
       }
+      return true;
     }
-    expr_map_[new_tuple_item->tuple].push_back(new_expr);
-    return new_expr;
-  }
+  };
+
+  struct TupleGetItemHash {
+    size_t operator()(const TupleGetItem& item) const {
+      return dmlc::HashCombine(ObjectPtrHash()(item->tuple), std::hash<int>()(item->index));
+    }
+  };
+
+  struct TupleGetItemEqual {
+    bool operator()(const TupleGetItem& lhs, const TupleGetItem& rhs) const {
+      return lhs->tuple.same_as(rhs->tuple) && lhs->index == rhs->index;
+    }
+  };
 
-  std::unordered_map<Expr, std::vector<Expr>, ObjectPtrHash, ObjectPtrEqual> expr_map_;
   runtime::TypedPackedFunc<bool(Expr)> fskip_;
+  // The first call and tuple projection of each class of equal ones.
+  std::unordered_set<Call, CallHash, CallEqual> calls_;
+  std::unordered_set<TupleGetItem, TupleGetItemHash, TupleGetItemEqual> tuple_items_;
+  // The merged tensor constants, by data type and shape.
+  std::map<std::vector<int64_t>, std::vector<Constant>> constants_;
 };
 
 Expr EliminateCommonSubexpr(const Expr& expr, PackedFunc callback) {
+  With<StructuralHashCache> hash_cache;
   return CommonSubexprEliminator(callback)(expr);
 }
 
 namespace transform {
 
 Pass EliminateCommonSubexpr(PackedFunc fskip) {
-  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
-      [=](Function f, IRModule m, PassContext pc) {
-        return Downcast<Function>(EliminateCommonSubexpr(f, fskip));
-      };
-  return CreateFunctionPass(pass_func, 3, "EliminateCommonSubexpr", {"InferType"});
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule mod,
+                                                                            PassContext pc) {
+    // The functions share one eliminator, like the function passes they skip the external
+    // functions and the ones not to optimize.
+    With<StructuralHashCache> hash_cache;
+    CommonSubexprEliminator eliminator(fskip);
+    std::vector<std::pair<GlobalVar, Function>> updates;
+    for (const auto& it : mod->functions) {
+      const auto* func = it.second.as<FunctionNode>();
+      if (func == nullptr || func->GetAttr<String>(attr::kCompiler).defined() ||
+          func->GetAttr<Integer>(attr::kSkipOptimization, 0) != 0) {
+        continue;
+      }
+      Function updated = Downcast<Function>(eliminator(GetRef<Function>(func)));
+      if (!updated.same_as(it.second)) updates.emplace_back(it.first, updated);
+    }
+    if (updates.empty()) return mod;
+    for (const auto& it : updates) {
+      mod->Update(it.first, it.second);
+    }
+    return InferType()(mod);
+  };
+  return CreateModulePass(pass_func, 3, "EliminateCommonSubexpr", {"InferType"});
 }
 
 TVM_REGISTER_GLOBAL("relay._transform.EliminateCommonSubexpr")
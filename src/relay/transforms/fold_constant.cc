@@ -20,6 +20,8 @@
 /*!
  * \file constant_folding.cc
  */
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/attrs/transform.h>
 #include <tvm/relay/expr_functor.h>
@@ -31,6 +33,10 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/object.h>
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "pattern_utils.h"
 
 namespace tvm {
@@ -73,6 +79,123 @@ bool ConstantCheck(const Expr& e) { return ConstantChecker().Check(e); }
 
 TVM_REGISTER_GLOBAL("relay.analysis.check_constant").set_body_typed(ConstantCheck);
 
+// Whether the constant folder evaluates the calls to the op.
+bool IsFoldableOp(const Expr& op_expr) {
+  static auto op_stateful = Op::GetAttrMap<TOpIsStateful>("TOpIsStateful");
+  static auto fnoncomputational = Op::GetAttrMap<TNonComputational>("TNonComputational");
+  static const Op& device_copy_op = Op::Get("device_copy");
+  static const Op& shape_of_op = Op::Get("shape_of");
+  static const Op& vm_shape_of_op = Op::Get("vm.shape_of");
+  static const Op& ndarray_size_op = Op::Get("ndarray_size");
+  const auto* op_node = op_expr.as<OpNode>();
+  if (op_node == nullptr) return false;
+  Op op = GetRef<Op>(op_node);
+  if (op_stateful.get(op, false)) return false;
+  if (fnoncomputational.get(op, false)) return false;
+  return op != device_copy_op && op != shape_of_op && op != vm_shape_of_op && op != ndarray_size_op;
+}
+
+/*
+  Find the maximal subgraphs of a dataflow graph that the constant folder
+  evaluates. The roots are the foldable expressions used outside of another
+  foldable expression. They can all be evaluated at once, and the nodes inside
+  of the subgraphs need not be evaluated on their own.
+*/
+class ConstantSubgraphCollector : private MixedModeVisitor {
+ public:
+  // Collect the subgraphs, return false if the expression is not a dataflow graph.
+  bool Collect(const Expr& expr) {
+    VisitExpr(expr);
+    if (!dataflow_) return false;
+    for (const Expr& e : foldable_order_) {
+      int uses = uses_[e.get()];
+      if (uses == 0 || uses > folded_uses_[e.get()]) {
+        roots.push_back(e);
+      } else {
+        inner.insert(e.get());
+      }
+    }
+    return true;
+  }
+
+  /*! \brief The roots of the subgraphs, in post order. */
+  std::vector<Expr> roots;
+  /*! \brief The foldable nodes that are not roots. */
+  std::unordered_set<const Object*> inner;
+
+ private:
+  using MixedModeVisitor::VisitExpr_;
+
+  void VisitExpr_(const CallNode* op) final {
+    MixedModeVisitor::VisitExpr_(op);
+    // Calls without arguments are not folded, see ConstantFolder.
+    bool foldable = !op->args.empty() && IsFoldableOp(op->op);
+    for (const Expr& arg : op->args) {
+      foldable = foldable && IsConstant(arg);
+    }
+    Use(op->args, foldable);
+    if (foldable) Mark(op);
+  }
+
+  void VisitExpr_(const TupleNode* op) final {
+    MixedModeVisitor::VisitExpr_(op);
+    bool constant = true;
+    for (const Expr& field : op->fields) {
+      constant = constant && IsConstant(field);
+    }
+    // Tuples are not evaluated on their own, their fields are roots.
+    Use(op->fields, false);
+    if (constant) constant_.insert(op);
+  }
+
+  void VisitExpr_(const TupleGetItemNode* op) final {
+    MixedModeVisitor::VisitExpr_(op);
+    bool foldable = foldable_.count(op->tuple.get());
+    Use({op->tuple}, foldable);
+    if (foldable) {
+      Mark(op);
+    } else if (constant_.count(op->tuple.get())) {
+      constant_.insert(op);
+    }
+  }
+
+  void VisitExpr_(const FunctionNode* op) final {
+    // Primitive functions are not folded, and closures are not dataflow.
+    if (!op->HasNonzeroAttr(attr::kPrimitive)) dataflow_ = false;
+  }
+
+  void VisitExpr_(const LetNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const IfNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const MatchNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefCreateNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefReadNode* op) final { dataflow_ = false; }
+  void VisitExpr_(const RefWriteNode* op) final { dataflow_ = false; }
+
+  bool IsConstant(const Expr& e) const {
+    return e.as<ConstantNode>() || foldable_.count(e.get()) || constant_.count(e.get());
+  }
+
+  void Use(const Array<Expr>& args, bool folded) {
+    for (const Expr& arg : args) {
+      ++uses_[arg.get()];
+      if (folded) ++folded_uses_[arg.get()];
+    }
+  }
+
+  void Mark(const Object* node) {
+    foldable_.insert(node);
+    foldable_order_.push_back(GetRef<Expr>(static_cast<const ExprNode*>(node)));
+  }
+
+  bool dataflow_{true};
+  std::vector<Expr> foldable_order_;
+  std::unordered_set<const Object*> foldable_;
+  // Tuples of constants which are not evaluated but can be arguments of folded calls.
+  std::unordered_set<const Object*> constant_;
+  std::unordered_map<const Object*, int> uses_;
+  std::unordered_map<const Object*, int> folded_uses_;
+};
+
 // TODO(tvm-team) consider combine dead-code with constant folder.
 // or make a more powerful partial evaluator.
 class ConstantFolder : public MixedModeMutator {
@@ -87,6 +210,45 @@ class ConstantFolder : public MixedModeMutator {
 
   using MixedModeMutator::VisitExpr_;
 
+  /*!
+   * \brief Evaluate the constant subgraphs of a dataflow graph in one batch.
+   *
+   *  The subgraphs are deduplicated by structural equality and evaluated by a single
+   *  interpreter, instead of building an executor for every foldable call.
+   */
+  void Precompute(const Expr& expr) {
+    Expr body = expr;
+    if (const auto* func = expr.as<FunctionNode>()) {
+      if (func->HasNonzeroAttr(attr::kPrimitive)) return;
+      body = func->body;
+    }
+    ConstantSubgraphCollector collector;
+    if (!collector.Collect(body)) return;
+    std::vector<Expr> unique;
+    std::vector<size_t> index;
+    std::unordered_map<Expr, size_t, StructuralHash, StructuralEqual> seen;
+    for (const Expr& root : collector.roots) {
+      auto it = seen.emplace(root, unique.size()).first;
+      if (it->second == unique.size()) unique.push_back(root);
+      index.push_back(it->second);
+    }
+    if (unique.empty()) return;
+    Array<Expr> values;
+    if (unique.size() == 1) {
+      values.push_back(ConstEvaluate(unique[0]));
+    } else {
+      values = Downcast<Tuple>(ConstEvaluate(Tuple(Array<Expr>(unique.begin(), unique.end()))))
+                   ->fields;
+    }
+    for (size_t i = 0; i < unique.size(); ++i) {
+      evaluated_[unique[i]] = values[i];
+    }
+    for (size_t i = 0; i < collector.roots.size(); ++i) {
+      precomputed_[collector.roots[i].get()] = values[index[i]];
+    }
+    inner_ = std::move(collector.inner);
+  }
+
   Expr VisitExpr_(const LetNode* op) final {
     auto pre_visit = [this](const LetNode* op) {
       // Rely on the Memoizer to cache pre-visit values
@@ -146,6 +308,10 @@ class ConstantFolder : public MixedModeMutator {
     if (inside_primitive) {
       return GetRef<Expr>(call);
     }
+    auto it = precomputed_.find(call);
+    if (it != precomputed_.end()) return it->second;
+    // Evaluated as part of the subgraph of its root.
+    if (inner_.count(call)) return post;
     static auto op_stateful = Op::GetAttrMap<TOpIsStateful>("TOpIsStateful");
 
     auto origin_args = call->args;
@@ -183,13 +349,15 @@ class ConstantFolder : public MixedModeMutator {
       }
     }
     if (all_const_args) {
-      return ConstEvaluate(post);
+      return Evaluate(post);
     } else {
       return post;
     }
   }
 
   Expr Rewrite_(const TupleGetItemNode* op, const Expr& post) final {
+    auto it = precomputed_.find(op);
+    if (it != precomputed_.end()) return it->second;
     op = post.as<TupleGetItemNode>();
     if (const auto* tuple = op->tuple.as<TupleNode>()) {
       return tuple->fields[op->index];
@@ -203,6 +371,12 @@ class ConstantFolder : public MixedModeMutator {
   ConstantChecker checker_;
   // Module
   IRModule module_;
+  // The values of the roots of the constant subgraphs.
+  std::unordered_map<const Object*, Expr> precomputed_;
+  // The nodes of the constant subgraphs which are not roots.
+  std::unordered_set<const Object*> inner_;
+  // Memoized evaluations, shared by the structurally equal expressions.
+  std::unordered_map<Expr, Expr, StructuralHash, StructuralEqual> evaluated_;
 
   // Cache the following ops for equivalence checking in this pass.
   const Op& device_copy_op_;
@@ -210,6 +384,8 @@ class ConstantFolder : public MixedModeMutator {
   const Op& vm_shape_of_op_;
   const Op& cast_op_;
   const Op& ndarray_size_op_;
+  // The interpreter of the constant expressions.
+  FInterpreter executor_;
 
   // Convert value to expression.
   Expr ObjectToExpr(const ObjectRef& value) {
@@ -257,8 +433,22 @@ class ConstantFolder : public MixedModeMutator {
     // needed for both execution and creation(due to JIT)
     With<PassContext> fresh_build_ctx(PassContext::Create());
 
-    FInterpreter executor = CreateInterpreter(mod, dev, target);
-    return ObjectToExpr(executor(expr));
+    // The expressions do not refer to the globals of their module, so a single interpreter
+    // evaluates all of them and compiles each primitive function once.
+    if (executor_ == nullptr) {
+      IRModule session({}, module_->type_definitions, module_->Imports());
+      executor_ = CreateInterpreter(session, dev, target);
+    }
+    return ObjectToExpr(executor_(expr));
+  }
+
+  // Constant evaluate an expression, unless an equal one was already evaluated.
+  Expr Evaluate(const Expr& expr) {
+    auto it = evaluated_.find(expr);
+    if (it != evaluated_.end()) return it->second;
+    Expr value = ConstEvaluate(expr);
+    evaluated_[expr] = value;
+    return value;
   }
 
   // Evaluate a call to the shape_of operator for tensors with constant
@@ -353,7 +543,7 @@ class ConstantFolder : public MixedModeMutator {
     auto cast_attrs = make_object<CastAttrs>();
     cast_attrs->dtype = dtype;
     Expr ret = Call(cast_op_, {value}, Attrs(cast_attrs), {});
-    return ConstEvaluate(ret);
+    return Evaluate(ret);
   }
 
   Optional<tvm::Array<IndexExpr>> GetConstantShape(const Expr& input) {
@@ -371,7 +561,9 @@ class ConstantFolder : public MixedModeMutator {
 };
 
 Expr FoldConstant(const Expr& expr, const IRModule& mod) {
-  return ConstantFolder(mod).Mutate(expr);
+  ConstantFolder folder(mod);
+  folder.Precompute(expr);
+  return folder.Mutate(expr);
 }
 
 TVM_REGISTER_GLOBAL("relay._transform.FoldConstantExpr").set_body_typed(FoldConstant);
@@ -28,6 +28,7 @@
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/op_attr_types.h>
 #include <tvm/relay/transform.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/tir/op.h>
 
 #include "../../support/arena.h"
@@ -84,6 +85,11 @@ constexpr uint32_t kMaxFusedOps = 256;
 static const Op& stop_fusion_op = Op::Get("annotation.stop_fusion");
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.max_depth", Integer);
+/*!
+ * \brief Name of a global function (Expr producer, Expr consumer, int num_nodes) -> bool
+ *  consulted before each fusion the op patterns allow, which is refused when it returns false.
+ */
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.FuseOps.cost_model", String);
 
 /*!
  * \brief Indexed data flow graph in forward direction.
@@ -507,8 +513,9 @@ DominatorTree DominatorTree::PostDom(support::Arena* arena, const IndexedForward
  */
 class GraphPartitioner {
  public:
-  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth)
-      : arena_(arena), opt_level_(opt_level), max_fuse_depth_(max_fuse_depth) {}
+  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth,
+                            const runtime::PackedFunc* fcost = nullptr)
+      : arena_(arena), opt_level_(opt_level), max_fuse_depth_(max_fuse_depth), fcost_(fcost) {}
   /*!
    * \brief Group as a union find data structure.
    */
@@ -562,6 +569,8 @@ class GraphPartitioner {
   int opt_level_;
   /*! \brief The maximum number of operations in one fused function */
   size_t max_fuse_depth_;
+  /*! \brief The cost model deciding the fusions the patterns allow, nullptr to fuse all. */
+  const runtime::PackedFunc* fcost_;
   /*! \brief The internal groups. */
   std::vector<Group*> groups_;
   /*! \brief internal field used for deduplication */
@@ -682,6 +691,14 @@ class GraphPartitioner {
     return target->FindRoot()->num_nodes + CountNodesUptoSink_(child, dom_parent);
   }
 
+  // Ask the cost model whether to fuse src into the group of its post-dominator sink.
+  bool AllowFuse(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
+    if (fcost_ == nullptr) return true;
+    int num_nodes = static_cast<int>(CountFusedNodesWithNewChild(src, sink));
+    bool allow = (*fcost_)(GetRef<ObjectRef>(src->ref), GetRef<ObjectRef>(sink->ref), num_nodes);
+    return allow;
+  }
+
   // Initialize the groups.
   void InitGroups(const IndexedForwardGraph& graph) {
     groups_.resize(graph.post_dfs_order.size());
@@ -729,7 +746,8 @@ class GraphPartitioner {
           auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
           // dom_root_group can also be tuple, as in inception layers
           // CheckPath is needed to avoid fusing two intermediate tuples
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              AllowFuse(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -752,7 +770,8 @@ class GraphPartitioner {
           ICHECK(dom_node->parent->gnode != nullptr);
           // The fuse can be executed if all the intermediate ops are still broadcast.
           auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              AllowFuse(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -772,7 +791,8 @@ class GraphPartitioner {
                       kind == kOutEWiseFusable);
             }
           };
-          if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+          if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+              AllowFuse(graph_node, dom_node->parent->gnode)) {
             CommitFuse(graph_node, dom_node->parent->gnode);
           }
         }
@@ -782,7 +802,8 @@ class GraphPartitioner {
         if (phase != 1) continue;
         // Check if all path are injective.
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (CheckPath(graph_node, dom_node->parent->gnode, fcond) &&
+            AllowFuse(graph_node, dom_node->parent->gnode)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       } else {
@@ -809,10 +830,12 @@ std::vector<GraphPartitioner::Group*> GraphPartitioner::Partition(
 class FuseMutator : private MixedModeMutator {
  public:
   // Run the transform
-  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth) {
+  Expr Transform(const Expr& body, int fuse_opt_level, size_t max_fuse_depth,
+                 const runtime::PackedFunc* fcost = nullptr) {
     // setup the group map.
     auto graph = IndexedForwardGraph::Create(&arena_, body);
-    auto groups = GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth).Partition(graph);
+    auto groups =
+        GraphPartitioner(&arena_, fuse_opt_level, max_fuse_depth, fcost).Partition(graph);
     for (size_t nid = 0; nid < graph.post_dfs_order.size(); ++nid) {
       ICHECK(graph.post_dfs_order[nid]->ref != nullptr);
       gmap_[graph.post_dfs_order[nid]->ref] = groups[nid];
@@ -1015,8 +1038,9 @@ class FuseMutator : private MixedModeMutator {
   }
 };
 
-Expr FuseOps(const Expr& expr, int fuse_opt_level, size_t max_fuse_depth, const IRModule& module) {
-  return FuseMutator().Transform(expr, fuse_opt_level, max_fuse_depth);
+Expr FuseOps(const Expr& expr, int fuse_opt_level, size_t max_fuse_depth, const IRModule& module,
+             const runtime::PackedFunc* fcost = nullptr) {
+  return FuseMutator().Transform(expr, fuse_opt_level, max_fuse_depth, fcost);
 }
 
 namespace transform {
@@ -1026,7 +1050,12 @@ Pass FuseOps(int fuse_opt_level) {
       [=](Function f, IRModule m, PassContext pc) {
         int opt_level = fuse_opt_level == -1 ? pc->opt_level : fuse_opt_level;
         auto max_fuse_depth = pc->GetConfig("relay.FuseOps.max_depth", Integer(kMaxFusedOps));
-        return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m));
+        const runtime::PackedFunc* fcost = nullptr;
+        if (auto cost_model = pc->GetConfig<String>("relay.FuseOps.cost_model")) {
+          fcost = runtime::Registry::Get(cost_model.value());
+          ICHECK(fcost != nullptr) << "Cannot find the fusion cost model " << cost_model.value();
+        }
+        return Downcast<Function>(FuseOps(f, opt_level, max_fuse_depth.value(), m, fcost));
       };
   return CreateFunctionPass(pass_func, 1, "FuseOps", {"InferType"});
 }
@@ -0,0 +1,182 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/horizontal_fuse_ops.cc
+ *
+ * \brief Pack independent injective fused functions into one function
+ *   returning a tuple, so that their kernels are launched together.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+/*
+  Two calls at the same depth, the length of the longest path from the
+  inputs of the function, cannot depend on each other. The calls to the
+  fused functions made of injective ops are grouped by depth and each group
+  is replaced by one call to a function returning the tuple of their results.
+  The packed function is scheduled as a whole, its kernels can be merged into
+  a single launch by tir.transform.MergeIndependentKernels.
+*/
+class HorizontalFuser : public MixedModeMutator {
+ public:
+  explicit HorizontalFuser(int max_group) : max_group_(max_group) {}
+
+  Function Fuse(const Function& func) {
+    std::unordered_map<const Object*, int> depth;
+    std::map<int, std::vector<const CallNode*>> levels;
+    bool supported = true;
+    auto get_depth = [&depth](const Expr& e) {
+      auto it = depth.find(e.get());
+      return it == depth.end() ? 0 : it->second;
+    };
+    PostOrderVisit(func->body, [&](const Expr& e) {
+      if (const auto* call = e.as<CallNode>()) {
+        int d = 0;
+        for (const Expr& arg : call->args) d = std::max(d, get_depth(arg));
+        depth[call] = d + 1;
+        if (IsPackable(call)) levels[d + 1].push_back(call);
+      } else if (const auto* tuple = e.as<TupleNode>()) {
+        int d = 0;
+        for (const Expr& field : tuple->fields) d = std::max(d, get_depth(field));
+        depth[tuple] = d;
+      } else if (const auto* get = e.as<TupleGetItemNode>()) {
+        depth[get] = get_depth(get->tuple);
+      } else if (e.as<LetNode>() || e.as<IfNode>()) {
+        // Only dataflow graphs are supported.
+        supported = false;
+      }
+    });
+    if (!supported) return func;
+    for (const auto& kv : levels) {
+      const std::vector<const CallNode*>& calls = kv.second;
+      for (size_t begin = 0; begin + 1 < calls.size(); begin += max_group_) {
+        size_t end = std::min(calls.size(), begin + max_group_);
+        groups_.emplace_back(calls.begin() + begin, calls.begin() + end);
+        for (size_t i = begin; i < end; ++i) {
+          member_[calls[i]] = {groups_.size() - 1, i - begin};
+        }
+      }
+    }
+    if (groups_.empty()) return func;
+    packed_.resize(groups_.size());
+    return Function(func->params, this->Mutate(func->body), func->ret_type, func->type_params,
+                    func->attrs);
+  }
+
+ private:
+  using MixedModeMutator::VisitExpr_;
+
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    auto it = member_.find(pre);
+    if (it == member_.end()) return post;
+    size_t group = it->second.first;
+    if (!packed_[group].defined()) {
+      packed_[group] = Pack(groups_[group]);
+    }
+    return TupleGetItem(packed_[group], it->second.second);
+  }
+
+  // Whether the call is to a fused function of injective ops returning a tensor.
+  static bool IsPackable(const CallNode* call) {
+    const auto* fn = call->op.as<FunctionNode>();
+    if (fn == nullptr || !fn->HasNonzeroAttr(attr::kPrimitive) ||
+        fn->HasNonzeroAttr(attr::kReshapeOnly) || fn->GetAttr<String>(attr::kCompiler).defined()) {
+      return false;
+    }
+    if (!call->checked_type()->IsInstance<TensorTypeNode>()) return false;
+    for (const Var& param : fn->params) {
+      if (!param->checked_type()->IsInstance<TensorTypeNode>()) return false;
+    }
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    bool injective = true;
+    PostOrderVisit(fn->body, [&injective](const Expr& e) {
+      if (const auto* call = e.as<CallNode>()) {
+        const auto* op = call->op.as<OpNode>();
+        if (op == nullptr || fpattern.get(GetRef<Op>(op), kOpaque) > kInjective) {
+          injective = false;
+        }
+      }
+    });
+    return injective;
+  }
+
+  // Create the call to the function packing the calls of the group.
+  Expr Pack(const std::vector<const CallNode*>& calls) {
+    Array<Var> params;
+    Array<Expr> fields;
+    Array<Type> types;
+    Array<Expr> args;
+    for (const CallNode* call : calls) {
+      const auto* fn = call->op.as<FunctionNode>();
+      Map<Var, Expr> binds;
+      for (const Var& param : fn->params) {
+        Var new_param(param->name_hint(), param->checked_type());
+        binds.Set(param, new_param);
+        params.push_back(new_param);
+      }
+      fields.push_back(Bind(fn->body, binds));
+      types.push_back(call->checked_type());
+      for (const Expr& arg : call->args) {
+        args.push_back(this->Mutate(arg));
+      }
+    }
+    Function packed(params, Tuple(fields), TupleType(types), {});
+    packed = WithAttr(std::move(packed), attr::kPrimitive, tvm::Integer(1));
+    return Call(packed, args, Attrs());
+  }
+
+  /*! \brief The maximum number of calls packed together. */
+  size_t max_group_;
+  /*! \brief The groups of calls to pack. */
+  std::vector<std::vector<const CallNode*>> groups_;
+  /*! \brief The group and the position in it of each packed call. */
+  std::unordered_map<const CallNode*, std::pair<size_t, size_t>> member_;
+  /*! \brief The call to the packed function of each group. */
+  std::vector<Expr> packed_;
+};
+
+namespace transform {
+
+Pass HorizontalFuseOps(int max_group) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        ICHECK_GE(max_group, 2) << "At least two functions must be packed together";
+        return HorizontalFuser(max_group).Fuse(f);
+      };
+  return CreateFunctionPass(pass_func, 4, "HorizontalFuseOps", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.HorizontalFuseOps").set_body_typed(HorizontalFuseOps);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
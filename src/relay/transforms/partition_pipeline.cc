@@ -0,0 +1,246 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/partition_pipeline.cc
+ *
+ * \brief Cut the main function of a module into a chain of stage functions
+ *   of balanced cost, to be run as a pipeline over several devices.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+/*! \brief The number of MACs of a call, registered by the MAC count analysis. */
+using FMacCount = runtime::TypedPackedFunc<int64_t(const Call& call_node)>;
+
+/*
+  The calls of the dataflow graph are taken in topological order and cut
+  where the cumulative cost crosses a multiple of the total cost divided by
+  the number of stages. The cost of a call is its number of MACs when known,
+  the size of its output otherwise.
+
+  Every stage takes the tensors defined by the previous stages, or the inputs
+  of the function, which are used by itself or the next stages, and returns
+  the ones used by the next stages. The last stage returns the result of the
+  function. Tuples crossing the stages are passed as their fields.
+*/
+class PipelinePartitioner {
+ public:
+  explicit PipelinePartitioner(int num_stages) : num_stages_(num_stages) {}
+
+  Array<Function> Partition(const Function& func) {
+    for (const Var& param : func->params) stage_[param.get()] = -1;
+    PostOrderVisit(func->body, [this](const Expr& e) {
+      if (e.as<CallNode>() || e.as<TupleNode>() || e.as<TupleGetItemNode>()) {
+        order_.push_back(e);
+      } else {
+        ICHECK(e.as<VarNode>() || e.as<ConstantNode>() || e.as<OpNode>())
+            << "Only dataflow graphs of ops can be partitioned into a pipeline, got "
+            << e->GetTypeKey();
+      }
+    });
+    AssignStages();
+
+    // The last stage using every value, the result being used by the last stage.
+    std::unordered_map<const Object*, int> last_use;
+    auto use = [&](const Expr& e, int stage) { MarkUse(e, stage, &last_use); };
+    for (const Expr& e : order_) {
+      int stage = stage_[e.get()];
+      if (const auto* call = e.as<CallNode>()) {
+        for (const Expr& arg : call->args) use(arg, stage);
+      } else if (const auto* tuple = e.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) use(field, stage);
+      } else if (const auto* get = e.as<TupleGetItemNode>()) {
+        use(get->tuple, stage);
+      }
+    }
+    use(func->body, num_stages_ - 1);
+
+    // The values live at the beginning of every stage, in order of definition.
+    std::vector<Expr> values(func->params.begin(), func->params.end());
+    values.insert(values.end(), order_.begin(), order_.end());
+    std::vector<std::vector<Expr>> live(num_stages_ + 1);
+    for (const Expr& value : values) {
+      auto it = last_use.find(value.get());
+      if (it == last_use.end()) continue;
+      for (int stage = stage_[value.get()] + 1; stage <= it->second; ++stage) {
+        live[stage].push_back(value);
+      }
+    }
+
+    Array<Function> stages;
+    for (int stage = 0; stage < num_stages_; ++stage) {
+      stages.push_back(MakeStage(func, stage, live[stage], live[stage + 1]));
+    }
+    return stages;
+  }
+
+ private:
+  void AssignStages() {
+    static auto fmac = Op::GetAttrMap<FMacCount>("FMacCount");
+    std::vector<double> costs;
+    double total = 0;
+    for (const Expr& e : order_) {
+      double cost = 0;
+      if (const auto* call = e.as<CallNode>()) {
+        const auto* op = call->op.as<OpNode>();
+        ICHECK(op != nullptr) << "Only calls to ops can be partitioned into a pipeline";
+        if (fmac.count(GetRef<Op>(op))) {
+          cost = fmac[GetRef<Op>(op)](GetRef<Call>(call));
+        } else if (const auto* tensor_type = call->checked_type().as<TensorTypeNode>()) {
+          cost = 1;
+          for (const PrimExpr& dim : tensor_type->shape) {
+            const auto* imm = dim.as<IntImmNode>();
+            ICHECK(imm != nullptr) << "A pipeline can only be cut in statically shaped graphs";
+            cost *= imm->value;
+          }
+        }
+      }
+      costs.push_back(cost);
+      total += cost;
+    }
+    double prefix = 0;
+    for (size_t i = 0; i < order_.size(); ++i) {
+      const Expr& e = order_[i];
+      int stage = 0;
+      if (const auto* get = e.as<TupleGetItemNode>()) {
+        // The fields of a tuple stay with the tuple, the tensors cross the stages.
+        stage = std::max(stage_[get->tuple.get()], 0);
+      } else if (const auto* tuple = e.as<TupleNode>()) {
+        for (const Expr& field : tuple->fields) stage = std::max(stage, StageOf(field));
+      } else {
+        // The middle of the call in the cumulative cost decides its stage.
+        double middle = prefix + costs[i] / 2;
+        stage = total > 0 ? static_cast<int>(middle * num_stages_ / total) : 0;
+        stage = std::min(stage, num_stages_ - 1);
+      }
+      prefix += costs[i];
+      stage_[e.get()] = stage;
+    }
+  }
+
+  int StageOf(const Expr& e) const {
+    auto it = stage_.find(e.get());
+    return it == stage_.end() ? 0 : std::max(it->second, 0);
+  }
+
+  // Record the use of a value by a stage, the tuples are used through their fields.
+  void MarkUse(const Expr& e, int stage, std::unordered_map<const Object*, int>* last_use) {
+    if (e.as<ConstantNode>() || e.as<OpNode>()) return;
+    auto it = stage_.find(e.get());
+    ICHECK(it != stage_.end());
+    if (it->second == stage) return;
+    if (const auto* tuple = e.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) MarkUse(field, stage, last_use);
+      return;
+    }
+    ICHECK(e->checked_type()->IsInstance<TensorTypeNode>())
+        << "Only tensors and tuples of tensors can cross the stages of a pipeline";
+    int& last = (*last_use)[e.get()];
+    last = std::max(last, stage);
+  }
+
+  Function MakeStage(const Function& func, int stage, const std::vector<Expr>& inputs,
+                     const std::vector<Expr>& outputs) {
+    std::unordered_map<const Object*, Expr> memo;
+    Array<Var> params;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      const Expr& input = inputs[i];
+      std::string name;
+      if (const auto* var = input.as<VarNode>()) {
+        name = var->name_hint();
+      } else {
+        name = "stage" + std::to_string(stage) + "_input" + std::to_string(i);
+      }
+      Var param(name, input->checked_type());
+      params.push_back(param);
+      memo[input.get()] = param;
+    }
+    auto rewrite = [&](const Expr& e) { return Rewrite(e, stage, &memo); };
+    Expr body;
+    if (stage == num_stages_ - 1) {
+      body = rewrite(func->body);
+    } else {
+      Array<Expr> fields;
+      for (const Expr& output : outputs) fields.push_back(rewrite(output));
+      body = Tuple(fields);
+    }
+    return Function(params, body, Type(), {});
+  }
+
+  // Rebuild a value in a stage from the inputs of the stage.
+  Expr Rewrite(const Expr& e, int stage, std::unordered_map<const Object*, Expr>* memo) {
+    auto it = memo->find(e.get());
+    if (it != memo->end()) return it->second;
+    if (e.as<ConstantNode>() || e.as<OpNode>()) return e;
+    Expr ret;
+    if (const auto* call = e.as<CallNode>()) {
+      ICHECK_EQ(stage_[e.get()], stage) << "A call of an earlier stage is not an input";
+      Array<Expr> args;
+      for (const Expr& arg : call->args) args.push_back(Rewrite(arg, stage, memo));
+      ret = Call(call->op, args, call->attrs, call->type_args, call->span);
+    } else if (const auto* tuple = e.as<TupleNode>()) {
+      Array<Expr> fields;
+      for (const Expr& field : tuple->fields) fields.push_back(Rewrite(field, stage, memo));
+      ret = Tuple(fields, tuple->span);
+    } else if (const auto* get = e.as<TupleGetItemNode>()) {
+      ret = TupleGetItem(Rewrite(get->tuple, stage, memo), get->index, get->span);
+    } else {
+      LOG(FATAL) << "The input " << e << " of stage " << stage << " is not passed to it";
+    }
+    (*memo)[e.get()] = ret;
+    return ret;
+  }
+
+  /*! \brief The number of stages. */
+  int num_stages_;
+  /*! \brief The calls and tuples of the function in topological order. */
+  std::vector<Expr> order_;
+  /*! \brief The stage of every value, -1 for the inputs of the function. */
+  std::unordered_map<const Object*, int> stage_;
+};
+
+namespace transform {
+
+Array<IRModule> PartitionPipeline(const IRModule& mod, int num_stages) {
+  ICHECK_GE(num_stages, 1) << "A pipeline has at least one stage";
+  IRModule typed = InferType()(mod);
+  auto func = Downcast<Function>(typed->Lookup("main"));
+  Array<IRModule> ret;
+  for (const Function& stage : PipelinePartitioner(num_stages).Partition(func)) {
+    ret.push_back(InferType()(IRModule::FromExpr(stage)));
+  }
+  return ret;
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.PartitionPipeline").set_body_typed(PartitionPipeline);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
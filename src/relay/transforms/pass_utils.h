@@ -34,6 +34,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "../analysis/dependency_graph.h"
 #include "let_list.h"
@@ -96,6 +97,14 @@ bool IsDynamic(const Type& ty);
  */
 bool IsDataDependent(const CallNode* call);
 
+/*!
+ * \brief Fold the constant expressions of an expression.
+ * \param expr The expression to fold.
+ * \param mod The module the expression lives in, for global calls.
+ * \return The folded expression.
+ */
+Expr FoldConstant(const Expr& expr, const IRModule& mod);
+
 /*!
  * \brief Make arbitrary transformation preserve the out most function.
  * \param func The transformation.
@@ -193,7 +202,8 @@ struct TreeBranchNode : TreeNode<ConditionObjectPtr> {
 
 struct ScopeNode;
 using Scope = std::shared_ptr<ScopeNode>;
-using NodeScopeMap = std::unordered_map<DependencyGraph::Node*, Scope>;
+/*! \brief The scope of every node of a dependency graph, by DependencyGraph::Node::index. */
+using NodeScopeMap = std::vector<Scope>;
 using ExprSet = std::unordered_set<Expr, ObjectPtrHash, ObjectPtrEqual>;
 
 /* Invariant: when parent is null level is 0
@@ -208,6 +218,14 @@ struct ScopeNode {
   std::shared_ptr<LetList> let_list = std::make_shared<LetList>();
   explicit ScopeNode(const Scope& parent) : level(1 + parent->level), parent(parent) {}
   ScopeNode() : level(0) {}
+  // The scopes of long let chains are deeply nested, release the parents without recursion.
+  ~ScopeNode() {
+    Scope p = std::move(parent);
+    while (p != nullptr && p.use_count() == 1) {
+      Scope next = std::move(p->parent);
+      p = std::move(next);
+    }
+  }
 };
 
 /*! \brief Calculate the scope of nodes in the dependency graph by least common ancestor.
@@ -0,0 +1,213 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/prepack_weights.cc
+ * \brief A pass packing the constant weights into the layouts of their kernels at build time.
+ *
+ * AlterOpLayout rewrites the convolutions and dense ops to the blocked layouts of the
+ * schedules selected for them, such as OIHW[x]i[y]o or NK[x]n, behind layout_transform
+ * calls on their weights, and graph_pack of VTA does the same with reshape and transpose
+ * calls. When the weights are constants, these calls have to be evaluated when building,
+ * so that the packed weights are exported as the params of the module, or the executor
+ * repacks the weights at every run.
+ *
+ * The pass evaluates the maximal subgraphs of data movement calls over constants in one
+ * batch, independently of the opt_level of FoldConstant, and reports the weights left to be
+ * packed at run time because they are not bound to constants while others are. The
+ * arithmetic and broadcasts are not evaluated, they are only folded by FoldConstant.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+#include <tvm/runtime/logging.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pass_utils.h"
+
+namespace tvm {
+namespace relay {
+
+namespace {
+
+/*!
+ * \brief Whether the calls to an op only move, pad or cast the data of their inputs, as the
+ *  weight packing does. The other calls over constants are left to FoldConstant.
+ */
+bool IsPackingOp(const Expr& op_expr) {
+  static const std::unordered_set<Op, ObjectPtrHash, ObjectPtrEqual> packing_ops = {
+      Op::Get("layout_transform"), Op::Get("reshape"), Op::Get("contrib_reverse_reshape"),
+      Op::Get("transpose"), Op::Get("expand_dims"), Op::Get("squeeze"),
+      Op::Get("nn.batch_flatten"), Op::Get("concatenate"), Op::Get("strided_slice"),
+      Op::Get("reverse"), Op::Get("nn.pad"), Op::Get("cast"), Op::Get("nn.bitpack")};
+  const auto* op_node = op_expr.as<OpNode>();
+  return op_node != nullptr && packing_ops.count(GetRef<Op>(op_node));
+}
+
+/*!
+ * \brief Find the maximal subgraphs of packing calls over constants, and the kernels
+ *  whose weights are packed from the parameters of the function.
+ */
+class PackingCollector : private MixedModeVisitor {
+ public:
+  explicit PackingCollector(const Function& func) {
+    for (const Var& param : func->params) params_.insert(param.get());
+    VisitExpr(func->body);
+    for (const Expr& e : packed_order_) {
+      int uses = uses_[e.get()];
+      if (uses == 0 || uses > packed_uses_[e.get()]) roots.push_back(e);
+    }
+  }
+
+  /*! \brief The roots of the subgraphs, in post order. */
+  std::vector<Expr> roots;
+  /*! \brief The number of kernels whose weights are constants. */
+  int constant_weights{0};
+  /*! \brief The number of kernels whose weights are packed from the parameters. */
+  int unbound_weights{0};
+
+ private:
+  using MixedModeVisitor::VisitExpr_;
+
+  void VisitExpr_(const CallNode* op) final {
+    MixedModeVisitor::VisitExpr_(op);
+    static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+    bool packing = !op->args.empty() && IsPackingOp(op->op);
+    // The calls returning tuples, such as split, are evaluated through their consumers.
+    bool packed = packing && op->checked_type_.as<TensorTypeNode>();
+    bool from_param = false;
+    for (const Expr& arg : op->args) {
+      packed = packed && IsConstant(arg);
+      from_param = from_param || params_.count(arg.get()) || from_param_.count(arg.get());
+    }
+    for (const Expr& arg : op->args) {
+      ++uses_[arg.get()];
+      if (packed) ++packed_uses_[arg.get()];
+    }
+    if (packed) {
+      packed_.insert(op);
+      packed_order_.push_back(GetRef<Expr>(op));
+    } else if (packing && from_param) {
+      from_param_.insert(op);
+    }
+    // The kernels read their data first and their weights after.
+    const auto* kernel_op = op->op.as<OpNode>();
+    if (kernel_op == nullptr || fpattern.get(GetRef<Op>(kernel_op), kOpaque) < kOutEWiseFusable) {
+      return;
+    }
+    for (size_t i = 1; i < op->args.size(); ++i) {
+      const Expr& weight = op->args[i];
+      if (weight.as<ConstantNode>() || packed_.count(weight.get())) {
+        ++constant_weights;
+      } else if (from_param_.count(weight.get())) {
+        ++unbound_weights;
+      }
+    }
+  }
+
+  void VisitExpr_(const TupleNode* op) final {
+    MixedModeVisitor::VisitExpr_(op);
+    bool constant = true;
+    for (const Expr& field : op->fields) {
+      constant = constant && IsConstant(field);
+      // Tuples are not evaluated on their own, their fields are roots.
+      ++uses_[field.get()];
+    }
+    if (constant) constant_.insert(op);
+  }
+
+  // The nested functions are packed when their own passes run.
+  void VisitExpr_(const FunctionNode* op) final {}
+
+  bool IsConstant(const Expr& e) const {
+    return e.as<ConstantNode>() || packed_.count(e.get()) || constant_.count(e.get());
+  }
+
+  std::unordered_set<const Object*> params_;
+  std::vector<Expr> packed_order_;
+  std::unordered_set<const Object*> packed_;
+  // Tuples of constants which are not evaluated but can be arguments of packing calls.
+  std::unordered_set<const Object*> constant_;
+  // Packing calls over the parameters of the function, evaluated at every run.
+  std::unordered_set<const Object*> from_param_;
+  std::unordered_map<const Object*, int> uses_;
+  std::unordered_map<const Object*, int> packed_uses_;
+};
+
+/*! \brief Replace the roots of the packing subgraphs by their values. */
+class PackedWeightSubstitutor : public MixedModeMutator {
+ public:
+  using ExprMap = std::unordered_map<Expr, Expr, ObjectPtrHash, ObjectPtrEqual>;
+
+  explicit PackedWeightSubstitutor(ExprMap values) { memo_ = std::move(values); }
+};
+
+}  // namespace
+
+Function PrepackWeights(const Function& func, const IRModule& mod) {
+  PackingCollector collector(func);
+  if (collector.unbound_weights > 0 && collector.constant_weights > 0) {
+    LOG(WARNING) << "PrepackWeights: " << collector.unbound_weights
+                 << " weights are packed into the layouts of their kernels at every run, since "
+                 << "they are not bound to constants like the " << collector.constant_weights
+                 << " others. Pass them in the params of relay.build to pack them once.";
+  }
+  if (collector.roots.empty()) return func;
+  // Evaluate all the subgraphs by a single interpreter.
+  Array<Expr> roots(collector.roots.begin(), collector.roots.end());
+  Expr folded = FoldConstant(roots.size() == 1 ? roots[0] : Tuple(roots), mod);
+  Array<Expr> values;
+  if (roots.size() == 1) {
+    values.push_back(folded);
+  } else {
+    values = Downcast<Tuple>(folded)->fields;
+  }
+  PackedWeightSubstitutor::ExprMap memo;
+  for (size_t i = 0; i < roots.size(); ++i) {
+    ICHECK(values[i].as<ConstantNode>()) << "PrepackWeights: cannot evaluate " << roots[i];
+    memo[roots[i]] = values[i];
+  }
+  Expr body = PackedWeightSubstitutor(std::move(memo)).Mutate(func->body);
+  return Function(func->params, body, func->ret_type, func->type_params, func->attrs, func->span);
+}
+
+namespace transform {
+
+Pass PrepackWeights() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        if (f->HasNonzeroAttr(attr::kPrimitive) || f->GetAttr<String>(attr::kCompiler).defined()) {
+          return f;
+        }
+        return relay::PrepackWeights(f, m);
+      };
+  return CreateFunctionPass(pass_func, 0, "PrepackWeights", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.PrepackWeights").set_body_typed(PrepackWeights);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
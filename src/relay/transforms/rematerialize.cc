@@ -0,0 +1,344 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/rematerialize.cc
+ * \brief A pass trading compute for memory by recomputing the cheap values.
+ *
+ * The graph executor runs the calls of a dataflow graph in post-DFS order and
+ * releases a tensor after its last use, as graph_plan_memory plans it. A value
+ * used both before and after the point of the peak memory is alive across the
+ * peak. When the value is computed by an elementwise or broadcast op whose
+ * inputs are alive at its later uses anyway, the later uses can recompute it
+ * instead, and the value is released after its early uses.
+ *
+ * The pass repeats this for the largest such value alive across the peak, as
+ * long as the peak decreases and exceeds the budget. The recomputations are
+ * usually fused into their consumers by FuseOps, so they cost little.
+ */
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/relay/transform.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/tir/op.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+
+namespace {
+
+/*! \brief The lifetimes of the tensors of a dataflow graph, in the order the calls run. */
+class LivenessAnalysis : private ExprVisitor {
+ public:
+  /*! \brief The lifetime of the output of a call. */
+  struct CallInfo {
+    /*! \brief The index of the call in the running order. */
+    int64_t pos{0};
+    /*! \brief The index of its last use, the number of calls for the outputs. */
+    int64_t end{0};
+    /*! \brief The size of its output in bytes. */
+    int64_t bytes{0};
+    /*! \brief The calls using its output. */
+    std::vector<const CallNode*> users;
+  };
+
+  explicit LivenessAnalysis(const Function& func) {
+    for (const Var& param : func->params) {
+      baseline_ += TypeBytes(param->checked_type());
+    }
+    VisitExpr(func->body);
+    if (!supported) return;
+    for (const CallNode* call : Producers(func->body)) {
+      info[call].end = now_;
+    }
+    // The inputs and the constants stay alive, the other tensors from their call to their
+    // last use included.
+    std::vector<int64_t> delta(now_ + 2, 0);
+    for (const auto& kv : info) {
+      delta[kv.second.pos] += kv.second.bytes;
+      delta[kv.second.end + 1] -= kv.second.bytes;
+    }
+    int64_t live = 0;
+    peak = baseline_;
+    for (int64_t i = 0; i <= now_; ++i) {
+      live += delta[i];
+      if (baseline_ + live > peak) {
+        peak = baseline_ + live;
+        peak_pos = i;
+      }
+    }
+  }
+
+  /*!
+   * \brief The calls producing the tensors of an expression.
+   * \param expr The expression.
+   * \param producers The calls, appended to.
+   * \return Whether the expression is made of calls, tuples, variables and constants.
+   */
+  static bool Producers(const Expr& expr, std::vector<const CallNode*>* producers) {
+    if (const auto* call = expr.as<CallNode>()) {
+      producers->push_back(call);
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const Expr& field : tuple->fields) {
+        if (!Producers(field, producers)) return false;
+      }
+    } else if (const auto* get = expr.as<TupleGetItemNode>()) {
+      return Producers(get->tuple, producers);
+    } else if (!expr.as<VarNode>() && !expr.as<ConstantNode>()) {
+      return false;
+    }
+    return true;
+  }
+
+  /*! \brief Whether the graph is a dataflow graph of tensors of a static shape. */
+  bool supported{true};
+  /*! \brief The peak memory in bytes. */
+  int64_t peak{0};
+  /*! \brief The index of the call at the peak. */
+  int64_t peak_pos{-1};
+  /*! \brief The lifetimes of the outputs of the calls. */
+  std::unordered_map<const CallNode*, CallInfo> info;
+
+ private:
+  std::vector<const CallNode*> Producers(const Expr& expr) {
+    std::vector<const CallNode*> producers;
+    if (!Producers(expr, &producers)) supported = false;
+    return producers;
+  }
+
+  int64_t TypeBytes(const Type& type) {
+    if (const auto* tensor = type.as<TensorTypeNode>()) {
+      int64_t bytes = (tensor->dtype.bits() * tensor->dtype.lanes() + 7) / 8;
+      for (const PrimExpr& dim : tensor->shape) {
+        const int64_t* pval = tir::as_const_int(dim);
+        if (pval == nullptr) {
+          supported = false;
+          return 0;
+        }
+        bytes *= *pval;
+      }
+      return bytes;
+    }
+    if (const auto* tuple = type.as<TupleTypeNode>()) {
+      int64_t bytes = 0;
+      for (const Type& field : tuple->fields) bytes += TypeBytes(field);
+      return bytes;
+    }
+    supported = false;
+    return 0;
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    if (!op->op.as<OpNode>()) {
+      supported = false;
+      return;
+    }
+    for (const Expr& arg : op->args) VisitExpr(arg);
+    CallInfo& call_info = info[op];
+    call_info.pos = now_++;
+    call_info.end = call_info.pos;
+    call_info.bytes = TypeBytes(op->checked_type());
+    for (const Expr& arg : op->args) {
+      for (const CallNode* producer : Producers(arg)) {
+        CallInfo& producer_info = info[producer];
+        producer_info.end = std::max(producer_info.end, call_info.pos);
+        producer_info.users.push_back(op);
+      }
+    }
+  }
+
+  void VisitExpr_(const ConstantNode* op) final { baseline_ += TypeBytes(op->checked_type()); }
+  void VisitExpr_(const LetNode* op) final { supported = false; }
+  void VisitExpr_(const IfNode* op) final { supported = false; }
+  void VisitExpr_(const FunctionNode* op) final { supported = false; }
+  void VisitExpr_(const RefCreateNode* op) final { supported = false; }
+  void VisitExpr_(const RefReadNode* op) final { supported = false; }
+  void VisitExpr_(const RefWriteNode* op) final { supported = false; }
+  void VisitExpr_(const MatchNode* op) final { supported = false; }
+
+  /*! \brief The bytes of the inputs and the constants. */
+  int64_t baseline_{0};
+  /*! \brief The index of the next call. */
+  int64_t now_{0};
+};
+
+/*! \brief Replace a value by a recomputation of it in some of its users. */
+class RecomputeMutator : public ExprMutator {
+ public:
+  RecomputeMutator(const CallNode* value, std::unordered_set<const CallNode*> late_users)
+      : value_(value), late_users_(std::move(late_users)) {}
+
+  Expr VisitExpr(const Expr& expr) final {
+    Expr new_expr = ExprMutator::VisitExpr(expr);
+    // The rewrite keeps the types, the analysis of the next round needs them.
+    if (!new_expr->checked_type_.defined()) new_expr->checked_type_ = expr->checked_type_;
+    return new_expr;
+  }
+
+  Expr VisitExpr_(const CallNode* op) final {
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    if (!late_users_.count(op)) return std::move(call);
+    Expr value = VisitExpr(GetRef<Call>(value_));
+    Array<Expr> args;
+    for (const Expr& arg : call->args) args.push_back(Replace(arg, value));
+    return Call(call->op, args, call->attrs, call->type_args, call->span);
+  }
+
+ private:
+  Expr Replace(const Expr& arg, const Expr& value) {
+    if (arg.same_as(value)) return Recompute(value);
+    if (const auto* tuple = arg.as<TupleNode>()) {
+      Array<Expr> fields;
+      bool changed = false;
+      for (const Expr& field : tuple->fields) {
+        fields.push_back(Replace(field, value));
+        changed |= !fields.back().same_as(field);
+      }
+      if (!changed) return arg;
+      Tuple new_tuple(fields, tuple->span);
+      new_tuple->checked_type_ = arg->checked_type_;
+      return std::move(new_tuple);
+    }
+    return arg;
+  }
+
+  Expr Recompute(const Expr& value) {
+    // All the late users share one recomputation, which runs before the first of them.
+    if (!recomputed_.defined()) {
+      const auto* call = value.as<CallNode>();
+      recomputed_ = Call(call->op, call->args, call->attrs, call->type_args, call->span);
+      recomputed_->checked_type_ = value->checked_type_;
+    }
+    return recomputed_;
+  }
+
+  const CallNode* value_;
+  std::unordered_set<const CallNode*> late_users_;
+  Expr recomputed_;
+};
+
+/*! \brief Whether a call is cheap enough to recompute. */
+bool IsCheap(const CallNode* call) {
+  static auto fpattern = Op::GetAttrMap<TOpPattern>("TOpPattern");
+  const auto* op = call->op.as<OpNode>();
+  if (op == nullptr || !call->checked_type().as<TensorTypeNode>()) return false;
+  return fpattern.get(GetRef<Op>(op), kOpaque) <= kBroadcast;
+}
+
+Function Rematerialize(Function func, int64_t memory_budget) {
+  LivenessAnalysis liveness(func);
+  if (!liveness.supported) return func;
+  int64_t initial_peak = liveness.peak;
+  int64_t num_calls = static_cast<int64_t>(liveness.info.size());
+  for (int64_t iter = 0; iter < num_calls && liveness.peak > memory_budget; ++iter) {
+    // The cheap values alive across the peak, which are not used at the peak nor are outputs.
+    std::vector<const CallNode*> candidates;
+    for (const auto& kv : liveness.info) {
+      const LivenessAnalysis::CallInfo& call_info = kv.second;
+      if (call_info.pos >= liveness.peak_pos || call_info.end <= liveness.peak_pos ||
+          call_info.end == num_calls || !IsCheap(kv.first)) {
+        continue;
+      }
+      bool used_at_peak = std::any_of(
+          call_info.users.begin(), call_info.users.end(),
+          [&](const CallNode* user) { return liveness.info.at(user).pos == liveness.peak_pos; });
+      if (!used_at_peak) candidates.push_back(kv.first);
+    }
+    std::sort(candidates.begin(), candidates.end(), [&](const CallNode* lhs, const CallNode* rhs) {
+      const auto& lhs_info = liveness.info.at(lhs);
+      const auto& rhs_info = liveness.info.at(rhs);
+      return lhs_info.bytes != rhs_info.bytes ? lhs_info.bytes > rhs_info.bytes
+                                              : lhs_info.pos < rhs_info.pos;
+    });
+
+    bool improved = false;
+    for (const CallNode* candidate : candidates) {
+      const LivenessAnalysis::CallInfo& call_info = liveness.info.at(candidate);
+      std::unordered_set<const CallNode*> late_users;
+      int64_t first_late = num_calls;
+      for (const CallNode* user : call_info.users) {
+        int64_t pos = liveness.info.at(user).pos;
+        if (pos > liveness.peak_pos) {
+          late_users.insert(user);
+          first_late = std::min(first_late, pos);
+        }
+      }
+      // The recomputation must not extend the lifetimes of its inputs.
+      bool available = true;
+      for (const Expr& arg : candidate->args) {
+        std::vector<const CallNode*> producers;
+        if (!LivenessAnalysis::Producers(arg, &producers)) available = false;
+        for (const CallNode* producer : producers) {
+          if (liveness.info.at(producer).end < first_late) available = false;
+        }
+      }
+      if (!available) continue;
+
+      Function rewritten =
+          Downcast<Function>(RecomputeMutator(candidate, std::move(late_users)).Mutate(func));
+      LivenessAnalysis new_liveness(rewritten);
+      if (new_liveness.supported && new_liveness.peak < liveness.peak) {
+        func = rewritten;
+        liveness = std::move(new_liveness);
+        improved = true;
+        break;
+      }
+    }
+    if (!improved) break;
+  }
+  if (liveness.peak > memory_budget) {
+    LOG(WARNING) << "Rematerialize reduced the peak memory from " << initial_peak << " to "
+                 << liveness.peak << " bytes, which exceeds the memory budget of "
+                 << memory_budget << " bytes";
+  }
+  return func;
+}
+
+}  // namespace
+
+namespace transform {
+
+Pass Rematerialize(int64_t memory_budget) {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        int64_t budget = memory_budget;
+        if (budget < 0) {
+          budget = pc->GetConfig("relay.backend.memory_budget", Integer(0)).value()->value;
+        }
+        if (budget <= 0 || f->HasNonzeroAttr(attr::kPrimitive) ||
+            f->GetAttr<String>(attr::kCompiler).defined()) {
+          return f;
+        }
+        return relay::Rematerialize(f, budget);
+      };
+  return CreateFunctionPass(pass_func, 1, "Rematerialize", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.Rematerialize").set_body_typed(Rematerialize);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -77,6 +77,94 @@ class SimplifyReshape : public DFPatternRewrite {
   DFPattern x_;
 };
 
+/*!
+ * \brief SimplifyIdentityReshape matches the pattern of a reshape or reverse_reshape op whose
+ *   output shape is the shape of its input, and removes it.
+ */
+class SimplifyIdentityReshape : public DFPatternRewrite {
+ public:
+  SimplifyIdentityReshape() {
+    x_ = IsWildcard();
+    pattern_ = IsOp("reshape")({x_}) || IsOp("contrib_reverse_reshape")({x_});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    const CallNode* call = pre.as<CallNode>();
+    ICHECK(call);
+    if (StructuralEqual()(call->args[0]->checked_type(), pre->checked_type())) {
+      return node_map[x_][0];
+    }
+    return post;
+  }
+
+ private:
+  /*! \brief Pattern input */
+  DFPattern x_;
+};
+
+/*!
+ * \brief Get the transpose axes of a layout transformation which only permutes the axes.
+ * \return The axes, or NullOpt when the transformation changes the rank or the split factors.
+ */
+Optional<Array<Integer>> GetLayoutPermutation(const Layout& src_layout, const Layout& dst_layout) {
+  if (!src_layout.defined() || !dst_layout.defined() || src_layout.ndim() != dst_layout.ndim()) {
+    return NullOpt;
+  }
+  Array<Integer> axes;
+  for (size_t i = 0; i < dst_layout.ndim(); ++i) {
+    const LayoutAxis& axis = dst_layout[i];
+    int32_t index = src_layout.IndexOf(axis);
+    if (index < 0 || (!axis.IsPrimal() && src_layout.FactorOf(axis) != dst_layout.FactorOf(axis))) {
+      return NullOpt;
+    }
+    axes.push_back(index);
+  }
+  return axes;
+}
+
+/*!
+ * \brief SimplifyLayoutTransform matches the pattern of consecutive layout_transform ops, e.g.
+ *   NCHW -> NCHW16c -> NCHW4c, and composes them into one layout_transform, a transpose when
+ *   the composition only permutes the axes, or cancels them.
+ */
+class SimplifyLayoutTransform : public DFPatternRewrite {
+ public:
+  SimplifyLayoutTransform() {
+    x_ = IsWildcard();
+    pattern_ = IsOp("layout_transform")({IsOp("layout_transform")({x_})});
+  }
+
+  Expr Callback(const Expr& pre, const Expr& post,
+                const Map<DFPattern, Array<Expr>>& node_map) const override {
+    auto x = node_map[x_][0];
+    const CallNode* outer = post.as<CallNode>();
+    const CallNode* inner = outer->args[0].as<CallNode>();
+    const auto* outer_attrs = outer->attrs.as<LayoutTransformAttrs>();
+    const auto* inner_attrs = inner->attrs.as<LayoutTransformAttrs>();
+    ICHECK(outer_attrs && inner_attrs);
+    if (!Layout(inner_attrs->dst_layout).Equals(Layout(outer_attrs->src_layout))) {
+      return post;
+    }
+    Layout src_layout(inner_attrs->src_layout);
+    Layout dst_layout(outer_attrs->dst_layout);
+    if (src_layout.Equals(dst_layout)) {
+      return x;
+    }
+    if (!tir::BijectiveLayout(src_layout, dst_layout).defined()) {
+      return post;
+    }
+    if (auto axes = GetLayoutPermutation(src_layout, dst_layout)) {
+      return MakeTranspose(x, axes.value());
+    }
+    return MakeLayoutTransform(x, src_layout.name(), dst_layout.name());
+  }
+
+ private:
+  /*! \brief Pattern input */
+  DFPattern x_;
+};
+
 /*!
  * \brief SimplifyCast matches the pattern of cast data to the same dtype.
  */
@@ -123,6 +211,19 @@ class SimplifyTranspose : public DFPatternRewrite {
 
     Call trans_call = Downcast<Call>(post);
 
+    // A layout transform which splits an axis by another factor without changing the rank,
+    // e.g. NCHW4c -> NCHW8c, is not a transpose; SimplifyLayoutTransform folds those.
+    for (const Call& call : {trans_call, Downcast<Call>(trans_call->args[0])}) {
+      if (auto attr = call->attrs.as<LayoutTransformAttrs>()) {
+        Layout src_layout(attr->src_layout);
+        Layout dst_layout(attr->dst_layout);
+        if (src_layout.ndim() == dst_layout.ndim() &&
+            !GetLayoutPermutation(src_layout, dst_layout)) {
+          return post;
+        }
+      }
+    }
+
     // Try to fuse any rank changing layout transformations
     if (auto layout_trans = FoldRankChangingLayoutTrans(x, trans_call)) {
       if (auto attr = layout_trans.value()->attrs.as<LayoutTransformAttrs>()) {
@@ -596,6 +697,8 @@ Expr SimplifyExpr(const Expr& expr, const IRModule& mod) {
   composer.AddRewrite<ConcretizeBroadcastToLikeRewrite>();
   composer.AddRewrite<EliminateIdentityRewrite>();
   composer.AddRewrite<SimplifyReshape>();
+  composer.AddRewrite<SimplifyIdentityReshape>();
+  composer.AddRewrite<SimplifyLayoutTransform>();
   composer.AddRewrite<SimplifyTranspose>();
   composer.AddRewrite<SimplifyCast>();
   composer.AddRewrite<FullElementwise>();
@@ -0,0 +1,151 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/specialize_shapes.cc
+ *
+ * \brief Specialize the main function for some concrete shapes of its
+ *   dynamically shaped inputs, behind guards on the input shapes.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/transform.h>
+
+#include <utility>
+#include <vector>
+
+#include "../op/make_op.h"
+#include "pattern_utils.h"
+
+namespace tvm {
+namespace relay {
+
+/*
+  For every set of shapes, the body of the function is copied with the
+  dynamic inputs bound to statically shaped variables, so that the copy
+  is fused and lowered with static kernels:
+
+    fn (%x: Tensor[(?, 768)]) {
+      if (all(equal(shape_of(%x), [128, 768]))) {
+        let %x_s: Tensor[(128, 768)] = %x;
+        <body on %x_s>
+      } else {
+        <body on %x>
+      }
+    }
+*/
+class ShapeSpecializer {
+ public:
+  explicit ShapeSpecializer(Array<Map<String, Array<Integer>>> shapes)
+      : shapes_(std::move(shapes)) {}
+
+  Function Specialize(const Function& func) {
+    std::vector<std::pair<Expr, Expr>> branches;
+    for (const Map<String, Array<Integer>>& shapes : shapes_) {
+      Map<Var, Expr> binds;
+      std::vector<std::pair<Var, Expr>> lets;
+      Expr guard;
+      for (const Var& param : func->params) {
+        auto it = shapes.find(param->name_hint());
+        if (it == shapes.end()) continue;
+        Optional<Var> static_param = StaticParam(param, (*it).second);
+        if (!static_param) continue;
+        binds.Set(param, static_param.value());
+        lets.emplace_back(static_param.value(), param);
+        Expr check = Guard(param, (*it).second);
+        guard = guard.defined() ? Call(Op::Get("logical_and"), {guard, check}) : check;
+      }
+      if (!guard.defined()) continue;
+      Expr body = Bind(func->body, binds);
+      for (auto it = lets.rbegin(); it != lets.rend(); ++it) {
+        body = Let(it->first, it->second, body);
+      }
+      branches.emplace_back(guard, body);
+    }
+    if (branches.empty()) return func;
+    Expr body = func->body;
+    for (auto it = branches.rbegin(); it != branches.rend(); ++it) {
+      body = If(it->first, it->second, body);
+    }
+    return Function(func->params, body, func->ret_type, func->type_params, func->attrs,
+                    func->span);
+  }
+
+ private:
+  // The statically shaped version of a parameter, or none if it is static already.
+  static Optional<Var> StaticParam(const Var& param, const Array<Integer>& shape) {
+    Type type = param->checked_type_.defined() ? param->checked_type() : param->type_annotation;
+    const auto* tensor_type = type.as<TensorTypeNode>();
+    ICHECK(tensor_type != nullptr) << "Only tensor inputs can be specialized, "
+                                   << param->name_hint() << " has type " << type;
+    ICHECK_EQ(tensor_type->shape.size(), shape.size())
+        << "The rank of the specialized shape of " << param->name_hint() << " does not match";
+    Array<PrimExpr> static_shape;
+    bool dynamic = false;
+    for (size_t i = 0; i < shape.size(); ++i) {
+      if (const auto* dim = tensor_type->shape[i].as<IntImmNode>()) {
+        ICHECK_EQ(dim->value, shape[i]->value)
+            << "The specialized shape of " << param->name_hint() << " conflicts with its type";
+        static_shape.push_back(tensor_type->shape[i]);
+      } else {
+        dynamic = true;
+        static_shape.push_back(IntImm(DataType::Int(32), shape[i]->value));
+      }
+    }
+    if (!dynamic) return NullOpt;
+    return Var(param->name_hint(), TensorType(static_shape, tensor_type->dtype));
+  }
+
+  // Whether the parameter has the shape at runtime.
+  static Expr Guard(const Var& param, const Array<Integer>& shape) {
+    std::vector<int64_t> dims;
+    for (const Integer& dim : shape) dims.push_back(dim->value);
+    int64_t rank = dims.size();
+    Expr expected = MakeConstantTensor(DataType::Int(64), {rank}, dims);
+    Expr equal = Call(Op::Get("equal"), {MakeShapeOf(param, DataType::Int(64)), expected});
+    return MakeReduce(equal, Array<Integer>(ObjectPtr<Object>(nullptr)), false, false, "all");
+  }
+
+  /*! \brief The concrete shapes of the inputs, by input name, of each specialization. */
+  Array<Map<String, Array<Integer>>> shapes_;
+};
+
+namespace transform {
+
+Pass SpecializeShapes(Array<Map<String, Array<Integer>>> shapes) {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule mod,
+                                                                            PassContext ctx) {
+    GlobalVar main = mod->GetGlobalVar("main");
+    auto func = Downcast<Function>(mod->Lookup(main));
+    Function specialized = ShapeSpecializer(shapes).Specialize(func);
+    if (specialized.same_as(func)) return mod;
+    mod->Update(main, specialized);
+    // Convert the dynamic ops of the specialized bodies, whose shapes are now known.
+    return Sequential({InferType(), DynamicToStatic()})(mod);
+  };
+  return CreateModulePass(pass_func, 0, "SpecializeShapes", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.SpecializeShapes").set_body_typed(SpecializeShapes);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
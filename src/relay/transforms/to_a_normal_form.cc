@@ -51,11 +51,12 @@ Scope LCA(Scope lhs, Scope rhs) {
 }
 
 std::pair<NodeScopeMap, ExprSet> CalcScope(const DependencyGraph& dg) {
-  NodeScopeMap expr_scope;
+  NodeScopeMap expr_scope(dg.post_dfs_order.size());
   ExprSet lifted_exprs;
-  std::unordered_map<DependencyGraph::Node*, Expr> node_to_expr;
-  for (auto expr_node : dg.expr_node) {
-    node_to_expr[expr_node.second] = expr_node.first;
+  // The expression of every node, null for the scope nodes.
+  std::vector<const ExprNode*> node_to_expr(dg.post_dfs_order.size(), nullptr);
+  for (const auto& expr_node : dg.expr_node) {
+    node_to_expr[expr_node.second->index] = expr_node.first.get();
   }
   bool global_scope_used = false;
   Scope global_scope = std::make_shared<ScopeNode>();
@@ -69,29 +70,28 @@ std::pair<NodeScopeMap, ExprSet> CalcScope(const DependencyGraph& dg) {
       s = global_scope;
       global_scope_used = true;
     } else {
-      s = expr_scope.at(iit->value);
+      s = expr_scope[iit->value->index];
       const auto original_s = s;
       iit = iit->next;
       for (; iit != nullptr; iit = iit->next) {
-        s = LCA(s, expr_scope.at(iit->value));
+        s = LCA(s, expr_scope[iit->value->index]);
       }
-      if (s != original_s && node_to_expr.find(n) != node_to_expr.end()) {
+      const ExprNode* expr = node_to_expr[n->index];
+      if (s != original_s && expr != nullptr) {
         // filter out exprs whose scope do not matter
-        Expr expr = node_to_expr[n];
-        if (!expr.as<OpNode>()) {
-          lifted_exprs.insert(expr);
+        if (!expr->IsInstance<OpNode>()) {
+          lifted_exprs.insert(GetRef<Expr>(expr));
         }
       }
     }
     if (n->new_scope) {
-      auto child_scope = std::make_shared<ScopeNode>(s);
-      expr_scope.insert({n, child_scope});
+      expr_scope[n->index] = std::make_shared<ScopeNode>(s);
     } else {
-      expr_scope.insert({n, s});
+      expr_scope[n->index] = s;
     }
   }
   ICHECK(global_scope_used);
-  return std::make_pair(expr_scope, lifted_exprs);
+  return std::make_pair(std::move(expr_scope), std::move(lifted_exprs));
 }
 
 Expr Fill::ToANormalForm(const Expr& e, const DependencyGraph& dg, NodeScopeMap* node_scope) {
@@ -108,7 +108,7 @@ Expr Fill::ToBasicBlockNormalForm(const Expr& e, const DependencyGraph& dg,
   return fi.GetScope(e)->let_list->Get(var);
 }
 
-Scope Fill::GetScope(const Expr& e) { return node_scope_->at(dg_.expr_node.at(e)); }
+Scope Fill::GetScope(const Expr& e) { return node_scope_->at(dg_.expr_node.at(e)->index); }
 
 Scope Fill::GetSubScope(const Expr& e, size_t i) {
   DependencyGraph::Node* n = dg_.expr_node.at(e);
@@ -119,10 +119,19 @@ Scope Fill::GetSubScope(const Expr& e, size_t i) {
     h = h->next;
   }
   ICHECK(h);
-  return node_scope_->at(h->value);
+  return node_scope_->at(h->value->index);
 }
 
 Expr Fill::VisitExpr(const Expr& e, const Var& v) {
+  if (memo.count(e) == 0 && (e.as<CallNode>() || e.as<TupleNode>() || e.as<TupleGetItemNode>())) {
+    // Fill the inputs of deep dataflow graphs without recursion, in the order of the recursive
+    // visit, every input then only looks its own inputs up.
+    ExpandDataflow(
+        e, [this](const Expr& x) { return memo.count(x) != 0; },
+        [this, &e](const Expr& x) {
+          if (!x.same_as(e)) VisitExpr(x);
+        });
+  }
   if (memo.count(e) == 0) {
     memo.insert({e, ExprFunctor<Expr(const Expr&, const Var&)>::VisitExpr(e, v)});
   } else if (v.defined()) {
@@ -210,10 +219,18 @@ Expr Fill::VisitExpr_(const FunctionNode* f, const Var& v) {
 }
 
 Expr Fill::VisitExpr_(const LetNode* l, const Var& v) {
-  Expr e = GetRef<Expr>(l);
-  VisitExpr(l->value, l->var);
-  Expr ret = GetSubScope(e, 0)->let_list->Get(VisitExpr(l->body));
-  return Compound(e, ret, v);
+  // The chains of lets are filled without recursion, the body of a let is bound in its
+  // sub scope on the way back.
+  Expr ret;
+  auto pre_visit = [this](const LetNode* op) { VisitExpr(op->value, op->var); };
+  auto post_visit = [this, l, &v, &ret](const LetNode* op) {
+    Expr e = GetRef<Expr>(op);
+    Expr body = op->body.as<LetNode>() ? ret : VisitExpr(op->body);
+    ret = Compound(e, GetSubScope(e, 0)->let_list->Get(body), op == l ? v : Var());
+    if (op != l) memo.insert({e, ret});
+  };
+  ExpandANormalForm(l, pre_visit, post_visit);
+  return ret;
 }
 
 Expr Fill::VisitExpr_(const ConstantNode* c, const Var& v) {
@@ -0,0 +1,285 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/transforms/to_mixed_precision.cc
+ *
+ * \brief Rewrite the float32 computations of a graph to float16 or
+ *   bfloat16, where the ops allow it.
+ */
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/nn.h>
+#include <tvm/relay/attrs/transform.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../op/make_op.h"
+#include "pattern_utils.h"
+
+namespace tvm {
+namespace relay {
+
+/*
+  The ops are in three categories:
+  - the allowed ops, such as convolutions and matrix products, always run in
+    the mixed precision type. Their accumulation stays in float32 through
+    their out_dtype attribute, the result is cast to the mixed type.
+  - the following ops, such as elementwise and data movement ops, run in the
+    mixed type when one of their inputs is in the mixed type.
+  - the other ops, such as reductions, softmax or normalizations, run in
+    float32, their mixed type inputs are cast back.
+
+  A cast of a cast is folded into one cast, or nothing when it goes back to
+  the type of the original value, and the casts of a value are shared by
+  its consumers.
+*/
+class MixedPrecisionMutator : public MixedModeMutator {
+ public:
+  MixedPrecisionMutator(DataType mixed_type, const Array<String>& allow_ops,
+                        const Array<String>& follow_ops)
+      : mixed_type_(mixed_type) {
+    for (const String& name : allow_ops) allow_.insert(name);
+    for (const String& name : follow_ops) follow_.insert(name);
+  }
+
+  Function Convert(const Function& func) {
+    Expr body = Restore(this->Mutate(func->body));
+    return Function(func->params, body, func->ret_type, func->type_params, func->attrs);
+  }
+
+ private:
+  using MixedModeMutator::VisitExpr_;
+
+  Expr VisitExpr_(const FunctionNode* op) final {
+    // Fused functions are converted as a whole by the ops calling them.
+    if (op->HasNonzeroAttr(attr::kPrimitive)) return GetRef<Expr>(op);
+    return Convert(GetRef<Function>(op));
+  }
+
+  // The values crossing bindings and control flow are restored to float32.
+  Expr VisitExpr_(const LetNode* op) final {
+    Var var = Downcast<Var>(this->Mutate(op->var));
+    Expr value = Restore(this->Mutate(op->value));
+    Expr body = Restore(this->Mutate(op->body));
+    return Let(var, value, body, op->span);
+  }
+
+  Expr VisitExpr_(const IfNode* op) final {
+    Expr cond = Restore(this->Mutate(op->cond));
+    Expr true_branch = Restore(this->Mutate(op->true_branch));
+    Expr false_branch = Restore(this->Mutate(op->false_branch));
+    return If(cond, true_branch, false_branch, op->span);
+  }
+
+  Expr Rewrite_(const TupleNode* pre, const Expr& post) final {
+    for (const Expr& field : post.as<TupleNode>()->fields) {
+      if (IsMixed(field)) {
+        MarkMixed(post);
+        break;
+      }
+    }
+    return post;
+  }
+
+  Expr Rewrite_(const TupleGetItemNode* pre, const Expr& post) final {
+    const auto* get = post.as<TupleGetItemNode>();
+    // Only the results of tuples are in the mixed type, the converted ops return tensors.
+    if (const auto* tuple = get->tuple.as<TupleNode>()) {
+      if (IsMixed(tuple->fields[get->index])) MarkMixed(post);
+    }
+    return post;
+  }
+
+  Expr Rewrite_(const CallNode* pre, const Expr& post) final {
+    const auto* call = post.as<CallNode>();
+    const auto* op = call->op.as<OpNode>();
+    if (op == nullptr) {
+      return Call(call->op, RestoreAll(call->args), call->attrs, call->type_args, call->span);
+    }
+    std::string name = op->name;
+    if (name == "cast") return post;
+    bool float32 = AllFloat32(pre->args) && IsFloat32Tensor(pre->checked_type());
+    if (allow_.count(name) && float32) {
+      Array<Expr> args;
+      for (const Expr& arg : call->args) args.push_back(CastTo(arg, mixed_type_));
+      Attrs attrs = call->attrs;
+      Attrs accumulate = WithOutDType(attrs, DataType::Float(32));
+      Expr ret = Call(call->op, args, accumulate.defined() ? accumulate : attrs, call->type_args,
+                      call->span);
+      if (accumulate.defined()) {
+        ret = CastTo(ret, mixed_type_);
+      }
+      MarkMixed(ret);
+      return ret;
+    }
+    if (follow_.count(name) && float32) {
+      bool mixed = false;
+      for (const Expr& arg : call->args) {
+        mixed = mixed || IsMixed(arg);
+      }
+      if (mixed) {
+        Array<Expr> args;
+        for (const Expr& arg : call->args) args.push_back(CastTo(arg, mixed_type_));
+        Expr ret = Call(call->op, args, call->attrs, call->type_args, call->span);
+        MarkMixed(ret);
+        return ret;
+      }
+    }
+    return Call(call->op, RestoreAll(call->args), call->attrs, call->type_args, call->span);
+  }
+
+  static bool IsFloat32Tensor(const Type& type) {
+    const auto* tensor_type = type.as<TensorTypeNode>();
+    return tensor_type != nullptr && tensor_type->dtype == DataType::Float(32);
+  }
+
+  // Whether the arguments are float32 tensors or tuples of them, before the rewrite.
+  static bool AllFloat32(const Array<Expr>& args) {
+    for (const Expr& arg : args) {
+      if (!arg->checked_type_.defined()) return false;
+      if (const auto* tuple_type = arg->checked_type().as<TupleTypeNode>()) {
+        if (!arg.as<TupleNode>()) return false;
+        for (const Type& field : tuple_type->fields) {
+          if (!IsFloat32Tensor(field)) return false;
+        }
+      } else if (!IsFloat32Tensor(arg->checked_type())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool IsMixed(const Expr& expr) const { return mixed_.count(expr.get()); }
+
+  void MarkMixed(const Expr& expr) {
+    mixed_.insert(expr.get());
+    // The set is keyed by address, keep the node alive.
+    keep_alive_.push_back(expr);
+  }
+
+  // Cast a value, or the fields of a tuple, between float32 and the mixed type.
+  Expr CastTo(const Expr& expr, DataType dtype) {
+    static const Op& cast_op = Op::Get("cast");
+    bool to_mixed = dtype == mixed_type_;
+    if (const auto* tuple = expr.as<TupleNode>()) {
+      Array<Expr> fields;
+      bool unchanged = true;
+      for (const Expr& field : tuple->fields) {
+        fields.push_back(CastTo(field, dtype));
+        unchanged = unchanged && fields.back().same_as(field);
+      }
+      if (unchanged) return expr;
+      Expr ret = Tuple(fields);
+      if (to_mixed) MarkMixed(ret);
+      return ret;
+    }
+    if (IsMixed(expr) == to_mixed) return expr;
+    auto key = std::make_pair(expr.get(), to_mixed);
+    auto it = casts_.find(key);
+    if (it != casts_.end()) return it->second;
+    Expr ret;
+    const auto* call = expr.as<CallNode>();
+    if (call != nullptr && call->op == cast_op && IsMixed(call->args[0]) == to_mixed) {
+      // The cast of a cast back to the type of the original value.
+      ret = call->args[0];
+    } else {
+      ret = MakeCast(expr, dtype);
+      if (to_mixed) MarkMixed(ret);
+    }
+    casts_[key] = ret;
+    keep_alive_.push_back(expr);
+    return ret;
+  }
+
+  Expr Restore(const Expr& expr) { return CastTo(expr, DataType::Float(32)); }
+
+  Array<Expr> RestoreAll(const Array<Expr>& args) {
+    Array<Expr> ret;
+    for (const Expr& arg : args) ret.push_back(Restore(arg));
+    return ret;
+  }
+
+  template <typename T>
+  static Attrs CopyWithOutDType(const Attrs& attrs, DataType dtype) {
+    if (const auto* node = attrs.as<T>()) {
+      auto copy = make_object<T>(*node);
+      copy->out_dtype = dtype;
+      return Attrs(copy);
+    }
+    return Attrs();
+  }
+
+  // The attributes with the output type changed, if the op has an output type.
+  static Attrs WithOutDType(const Attrs& attrs, DataType dtype) {
+    Attrs ret;
+    if (!ret.defined()) ret = CopyWithOutDType<Conv1DAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<Conv2DAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<Conv3DAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<Conv1DTransposeAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<Conv2DTransposeAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<Conv3DTransposeAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<DenseAttrs>(attrs, dtype);
+    if (!ret.defined()) ret = CopyWithOutDType<BatchMatmulAttrs>(attrs, dtype);
+    return ret;
+  }
+
+  struct PairHash {
+    size_t operator()(const std::pair<const Object*, bool>& key) const {
+      return std::hash<const Object*>()(key.first) ^ static_cast<size_t>(key.second);
+    }
+  };
+
+  /*! \brief The mixed precision type. */
+  DataType mixed_type_;
+  /*! \brief The ops always converted. */
+  std::unordered_set<std::string> allow_;
+  /*! \brief The ops converted when an input is converted. */
+  std::unordered_set<std::string> follow_;
+  /*! \brief The rewritten expressions whose values are in the mixed type. */
+  std::unordered_set<const Object*> mixed_;
+  /*! \brief The casts of the values, by value and whether to the mixed type. */
+  std::unordered_map<std::pair<const Object*, bool>, Expr, PairHash> casts_;
+  /*! \brief The nodes referenced by address. */
+  std::vector<Expr> keep_alive_;
+};
+
+namespace transform {
+
+Pass ToMixedPrecision(DataType mixed_type, Array<String> allow_ops, Array<String> follow_ops) {
+  ICHECK(mixed_type == DataType::Float(16) || mixed_type == DataType::BFloat(16))
+      << "The mixed precision type must be float16 or bfloat16, got " << mixed_type;
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return MixedPrecisionMutator(mixed_type, allow_ops, follow_ops).Convert(f);
+      };
+  return CreateFunctionPass(pass_func, 0, "ToMixedPrecision", {"InferType"});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.ToMixedPrecision").set_body_typed(ToMixedPrecision);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -40,11 +40,16 @@
 
 #include <tvm/ir/transform.h>
 #include <tvm/ir/type_functor.h>
+#include <tvm/node/structural_equal.h>
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr_functor.h>
 #include <tvm/relay/pattern_functor.h>
 #include <tvm/relay/transform.h>
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "../analysis/type_solver.h"
 #include "pass_utils.h"
 
@@ -789,6 +794,46 @@ struct AllCheckTypePopulated : MixedModeVisitor {
 
 void EnsureCheckedType(const Expr& e) { AllCheckTypePopulated().VisitExpr(e); }
 
+// Check whether all the sub-expressions of a function carry their checked types,
+// which the nodes rewritten since the last type inference lack.
+class TypePopulatedChecker : public MixedModeVisitor {
+ public:
+  bool Check(const Function& func) {
+    if (!func->checked_type_.defined()) return false;
+    VisitExpr(func);
+    return populated_;
+  }
+
+  /*! \brief The global vars referenced by the function. */
+  std::unordered_set<const GlobalVarNode*> global_vars;
+
+ private:
+  using MixedModeVisitor::VisitExpr_;
+
+  void VisitLeaf(const Expr& e) final {
+    if (const auto* var = e.as<GlobalVarNode>()) {
+      global_vars.insert(var);
+    } else if (!e.as<OpNode>() && !e.as<ConstructorNode>() && !e->checked_type_.defined()) {
+      populated_ = false;
+    }
+    MixedModeVisitor::VisitLeaf(e);
+  }
+
+  void VisitExpr_(const LetNode* op) final {
+    auto pre_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->var);
+      this->VisitExpr(op->value);
+    };
+    auto post_visit = [this](const LetNode* op) {
+      this->VisitExpr(op->body);
+      this->visit_counter_[op] += 1;
+    };
+    ExpandANormalForm(op, pre_visit, post_visit);
+  }
+
+  bool populated_{true};
+};
+
 // TODO(@jroesch): Can we optimize this?
 void AddGlobalTypes(IRModule mod) {
   std::vector<std::pair<GlobalVar, Function> > updates;
@@ -811,6 +856,8 @@ void AddGlobalTypes(IRModule mod) {
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.InferType.incremental", Bool);
+
 Pass InferType() {
   auto pass_info = PassInfo(0, "InferType", {});
   return tvm::transform::CreateModulePass(
@@ -825,7 +872,14 @@ Pass InferType() {
         // Add all the type annotations to the functions in the model.
         AddGlobalTypes(mod);
 
-        std::vector<std::pair<GlobalVar, Function> > updates;
+        // With incremental inference, the functions which kept the types of their
+        // last inference are skipped, unless they reference a global var whose type
+        // has changed.
+        bool incremental =
+            pass_ctx->GetConfig<Bool>("relay.InferType.incremental", Bool(true)).value();
+        std::unordered_map<const GlobalVarNode*, std::unordered_set<const GlobalVarNode*> >
+            unchanged;
+        std::vector<GlobalVar> worklist;
         for (const auto& it : updated_mod->functions) {
           // Currently we don't type check TIR.
           //
@@ -834,23 +888,36 @@ Pass InferType() {
           // In the future we plan a unified type checker
           // that works on TIR and Relay at the same time.
           if (auto* func_node = it.second.as<FunctionNode>()) {
-            auto func = GetRef<Function>(func_node);
+            TypePopulatedChecker checker;
+            if (incremental && it.first->checked_type_.same_as(func_node->checked_type_) &&
+                checker.Check(GetRef<Function>(func_node))) {
+              unchanged[it.first.get()] = std::move(checker.global_vars);
+            } else {
+              worklist.push_back(it.first);
+            }
+          }
+        }
 
-            // // If a function already has type information we can skip checking it.
-            // if (func->checked_type_.defined()) {
-            //   continue;
-            // }
+        std::vector<std::pair<GlobalVar, Function> > updates;
+        while (!worklist.empty()) {
+          std::unordered_set<const GlobalVarNode*> changed;
+          for (const GlobalVar& var : worklist) {
+            auto func = Downcast<Function>(updated_mod->Lookup(var));
 
             // TODO(@jroesch): we should be able to move the type inferencer outside
             // of this function but it seems to be more stateful then I expect.
             auto inferencer = TypeInferencer(mod, pass_ctx->diag_ctx.value());
-            auto updated_func = inferencer.Infer(it.first, func);
+            auto updated_func = inferencer.Infer(var, func);
 
             pass_ctx->diag_ctx.value().Render();
 
+            if (!var->checked_type_.defined() ||
+                !StructuralEqual()(var->checked_type_, updated_func->checked_type())) {
+              changed.insert(var.get());
+            }
             // After we are done checking write the global type back
             // into the global var.
-            it.first->checked_type_ = updated_func->checked_type();
+            var->checked_type_ = updated_func->checked_type();
 
             if (!WellFormed(updated_func, pass_ctx->diag_ctx)) {
               LOG(FATAL) << "The type checked intermediate representation is malformed";
@@ -860,7 +927,21 @@ Pass InferType() {
             ICHECK(free_tvars.size() == 0)
                 << "Found unbound type variables in " << updated_func << ": " << free_tvars;
             EnsureCheckedType(updated_func);
-            updates.push_back({it.first, Downcast<Function>(updated_func)});
+            updates.push_back({var, Downcast<Function>(updated_func)});
+          }
+          // The functions referencing a global var whose type changed are checked again.
+          worklist.clear();
+          for (auto it = unchanged.begin(); it != unchanged.end();) {
+            bool stale = false;
+            for (const GlobalVarNode* var : it->second) {
+              stale = stale || changed.count(var);
+            }
+            if (stale) {
+              worklist.push_back(GetRef<GlobalVar>(it->first));
+              it = unchanged.erase(it);
+            } else {
+              ++it;
+            }
           }
         }
 
@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file aot_executor.cc
+ * \brief Executor of the models compiled ahead of time on the C++ runtime.
+ */
+#include "aot_executor.h"
+
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+void AotExecutor::Init(Module module, const std::vector<std::string>& input_names,
+                       std::vector<NDArray> inputs, std::vector<NDArray> outputs,
+                       std::vector<NDArray> params, NDArray arena) {
+  run_func_ = module.GetFunction(symbol::tvm_run_func_prefix, true);
+  ICHECK(run_func_ != nullptr) << "The module has no AOT entry function "
+                               << symbol::tvm_run_func_prefix;
+  ICHECK_EQ(input_names.size(), inputs.size());
+  input_names_ = input_names;
+  inputs_ = std::move(inputs);
+  outputs_ = std::move(outputs);
+  params_ = std::move(params);
+  arena_ = std::move(arena);
+
+  size_t num_args = inputs_.size() + outputs_.size() + params_.size() + 1;
+  arg_values_.resize(num_args);
+  arg_tcodes_.resize(num_args);
+  input_tensors_.clear();
+  for (const NDArray& input : inputs_) {
+    input_tensors_.push_back(*input.operator->());
+  }
+  size_t index = 0;
+  for (const DLTensor& input : input_tensors_) {
+    SetArg(index++, &input);
+  }
+  for (const NDArray& output : outputs_) {
+    SetArg(index++, output.operator->());
+  }
+  for (const NDArray& param : params_) {
+    SetArg(index++, param.operator->());
+  }
+  SetArg(index, arena_.operator->());
+}
+
+void AotExecutor::SetArg(size_t index, const DLTensor* tensor) {
+  arg_values_[index].v_handle = const_cast<DLTensor*>(tensor);
+  arg_tcodes_[index] = kTVMDLTensorHandle;
+}
+
+int AotExecutor::GetInputIndex(const std::string& name) const {
+  for (size_t i = 0; i < input_names_.size(); ++i) {
+    if (input_names_[i] == name) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+void AotExecutor::SetInput(int index, DLTensor* data_in) {
+  ICHECK_LT(static_cast<size_t>(index), inputs_.size());
+  inputs_[index].CopyFrom(data_in);
+  input_tensors_[index].data = inputs_[index]->data;
+}
+
+void AotExecutor::SetInputZeroCopy(int index, DLTensor* data_ref) {
+  ICHECK_LT(static_cast<size_t>(index), inputs_.size());
+  const DLTensor* old_t = inputs_[index].operator->();
+  // check the consistency of input
+  void* data = data_ref->data;
+  ICHECK(IsContiguous(*data_ref)) << "The zero copy inputs must be compact, a strided view needs "
+                                  << "set_input to copy it";
+  if (data_ref->byte_offset != 0) {
+    // Views of compact memory pass their offset in the data pointer, the kernels take none
+    ICHECK(CanFoldByteOffset(*data_ref)) << "The zero copy inputs on "
+                                         << DeviceName(data_ref->device.device_type)
+                                         << " must have no byte offset";
+    data = static_cast<char*>(data) + data_ref->byte_offset;
+  }
+  ICHECK_EQ(reinterpret_cast<size_t>(data) % kAllocAlignment, 0);
+  ICHECK_EQ(old_t->ndim, data_ref->ndim);
+  ICHECK_EQ(old_t->device.device_type, data_ref->device.device_type);
+  ICHECK_EQ(old_t->device.device_id, data_ref->device.device_id);
+  for (auto i = 0; i < data_ref->ndim; ++i) {
+    ICHECK_EQ(old_t->shape[i], data_ref->shape[i]);
+  }
+  input_tensors_[index].data = data;
+}
+
+NDArray AotExecutor::GetInput(int index) const {
+  ICHECK_LT(static_cast<size_t>(index), inputs_.size());
+  return inputs_[index];
+}
+
+NDArray AotExecutor::GetOutput(int index) const {
+  ICHECK_LT(static_cast<size_t>(index), outputs_.size());
+  return outputs_[index];
+}
+
+void AotExecutor::Run() {
+  TVMRetValue rv;
+  run_func_.CallPacked(
+      TVMArgs(arg_values_.data(), arg_tcodes_.data(), static_cast<int>(arg_values_.size())), &rv);
+}
+
+PackedFunc AotExecutor::GetFunction(const std::string& name,
+                                    const ObjectPtr<Object>& sptr_to_self) {
+  // Return member functions during query.
+  if (name == "set_input") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (String::CanConvertFrom(args[0])) {
+        int in_idx = this->GetInputIndex(args[0].operator String());
+        if (in_idx >= 0) this->SetInput(in_idx, args[1]);
+      } else {
+        this->SetInput(args[0], args[1]);
+      }
+    });
+  } else if (name == "set_input_zero_copy") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (String::CanConvertFrom(args[0])) {
+        int in_idx = this->GetInputIndex(args[0].operator String());
+        if (in_idx >= 0) this->SetInputZeroCopy(in_idx, args[1]);
+      } else {
+        this->SetInputZeroCopy(args[0], args[1]);
+      }
+    });
+  } else if (name == "get_output") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args.num_args == 2) {
+        this->GetOutput(args[0]).CopyTo(args[1].operator DLTensor*());
+      } else {
+        *rv = this->GetOutput(args[0]);
+      }
+    });
+  } else if (name == "get_input") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int in_idx = 0;
+      if (String::CanConvertFrom(args[0])) {
+        in_idx = this->GetInputIndex(args[0].operator String());
+      } else {
+        in_idx = args[0];
+      }
+      if (in_idx >= 0) {
+        *rv = this->GetInput(in_idx);
+      }
+    });
+  } else if (name == "get_input_index") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->GetInputIndex(args[0].operator String());
+    });
+  } else if (name == "get_num_outputs") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumOutputs(); });
+  } else if (name == "get_num_inputs") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumInputs(); });
+  } else if (name == "run") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+  } else {
+    return PackedFunc();
+  }
+}
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \brief Executor of the models compiled ahead of time on the C++ runtime.
+ * \file aot_executor.h
+ */
+#ifndef TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_H_
+#define TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_H_
+
+#include <dlpack/dlpack.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief AOT executor.
+ *
+ *  The model is a single entry function generated by the AOT codegen, which
+ *  calls the kernels directly with the tensors of the planned arena. The
+ *  executor only holds the tensors of the arguments of the entry function,
+ *  the inputs, the outputs, the parameters and the arena, and calls it with
+ *  an argument array built once.
+ */
+class TVM_DLL AotExecutor : public ModuleNode {
+ public:
+  /*!
+   * \brief Get member function to front-end
+   * \param name The name of the function.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The corresponding member function.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \return The type key of the executor.
+   */
+  const char* type_key() const final { return "AotExecutor"; }
+
+  /*!
+   * \brief Initialize the executor.
+   * \param module The module containing the entry function and the kernels.
+   * \param input_names The names of the inputs.
+   * \param inputs The arrays of the inputs.
+   * \param outputs The arrays of the outputs.
+   * \param params The arrays of the parameters, in argument order.
+   * \param arena The array of the arena.
+   */
+  void Init(Module module, const std::vector<std::string>& input_names,
+            std::vector<NDArray> inputs, std::vector<NDArray> outputs,
+            std::vector<NDArray> params, NDArray arena);
+
+  /*!
+   * \brief Get the input index given the name of input.
+   * \param name The name of the input.
+   * \return The index of input, -1 if there is no such input.
+   */
+  int GetInputIndex(const std::string& name) const;
+
+  /*!
+   * \brief Set index-th input to the model.
+   * \param index The input index.
+   * \param data_in The input data.
+   */
+  void SetInput(int index, DLTensor* data_in);
+
+  /*!
+   * \brief Set index-th input to the model without copying the data.
+   * \param index The input index.
+   * \param data_ref The input data that is referred, kept alive by the caller.
+   */
+  void SetInputZeroCopy(int index, DLTensor* data_ref);
+
+  /*!
+   * \brief Get index-th input.
+   * \param index The input index.
+   * \return The input array.
+   */
+  NDArray GetInput(int index) const;
+
+  /*!
+   * \brief Get index-th output.
+   * \param index The output index.
+   * \return The output array.
+   */
+  NDArray GetOutput(int index) const;
+
+  /*! \return The number of inputs to the model. */
+  int NumInputs() const { return static_cast<int>(inputs_.size()); }
+
+  /*! \return The number of outputs of the model. */
+  int NumOutputs() const { return static_cast<int>(outputs_.size()); }
+
+  /*!
+   * \brief Execute the model.
+   */
+  void Run();
+
+ private:
+  /*! \brief Make a tensor the index-th argument of the entry function. */
+  void SetArg(size_t index, const DLTensor* tensor);
+
+  /*! \brief The entry function. */
+  PackedFunc run_func_;
+  /*! \brief The names of the inputs. */
+  std::vector<std::string> input_names_;
+  /*! \brief The arrays of the inputs. */
+  std::vector<NDArray> inputs_;
+  /*! \brief The tensors given to the entry function for the inputs, set without copy. */
+  std::vector<DLTensor> input_tensors_;
+  /*! \brief The arrays of the outputs. */
+  std::vector<NDArray> outputs_;
+  /*! \brief The arrays of the parameters. */
+  std::vector<NDArray> params_;
+  /*! \brief The arena of the intermediate tensors. */
+  NDArray arena_;
+  /*! \brief The arguments of the entry function: inputs, outputs, parameters and arena. */
+  std::vector<TVMValue> arg_values_;
+  std::vector<int> arg_tcodes_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_H_
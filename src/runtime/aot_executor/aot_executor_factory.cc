@@ -0,0 +1,193 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file aot_executor_factory.cc
+ * \brief AOT executor factory implementations
+ */
+
+#include "./aot_executor_factory.h"
+
+#include <dmlc/io.h>
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+AotExecutorFactory::AotExecutorFactory(
+    const std::vector<std::string>& input_names, const std::vector<AotTensorInfo>& inputs,
+    const std::vector<AotTensorInfo>& outputs, const std::vector<std::string>& param_names,
+    const std::unordered_map<std::string, tvm::runtime::NDArray>& params, int64_t arena_size,
+    const std::string& module_name) {
+  input_names_ = input_names;
+  inputs_ = inputs;
+  outputs_ = outputs;
+  param_names_ = param_names;
+  params_ = params;
+  arena_size_ = arena_size;
+  module_name_ = module_name;
+}
+
+PackedFunc AotExecutorFactory::GetFunction(
+    const std::string& name, const tvm::runtime::ObjectPtr<tvm::runtime::Object>& sptr_to_self) {
+  if (name == module_name_) {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::vector<Device> devices;
+      for (int i = 0; i < args.num_args; ++i) {
+        devices.emplace_back(args[i].operator Device());
+      }
+      *rv = this->ExecutorCreate(devices);
+    });
+  } else {
+    return PackedFunc();
+  }
+}
+
+static void SaveTensorInfo(dmlc::Stream* stream, const std::vector<AotTensorInfo>& infos) {
+  std::vector<std::vector<int64_t>> shapes;
+  std::vector<std::string> dtypes;
+  for (const AotTensorInfo& info : infos) {
+    shapes.push_back(info.shape);
+    dtypes.push_back(DLDataType2String(info.dtype));
+  }
+  stream->Write(shapes);
+  stream->Write(dtypes);
+}
+
+static std::vector<AotTensorInfo> LoadTensorInfo(dmlc::Stream* stream) {
+  std::vector<std::vector<int64_t>> shapes;
+  std::vector<std::string> dtypes;
+  ICHECK(stream->Read(&shapes));
+  ICHECK(stream->Read(&dtypes));
+  ICHECK_EQ(shapes.size(), dtypes.size());
+  std::vector<AotTensorInfo> infos;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    infos.push_back({shapes[i], String2DLDataType(dtypes[i])});
+  }
+  return infos;
+}
+
+void AotExecutorFactory::SaveToBinary(dmlc::Stream* stream) {
+  stream->Write(input_names_);
+  SaveTensorInfo(stream, inputs_);
+  SaveTensorInfo(stream, outputs_);
+  stream->Write(param_names_);
+  for (const std::string& name : param_names_) {
+    tvm::runtime::SaveDLTensor(stream, params_.at(name).operator->());
+  }
+  stream->Write(arena_size_);
+  stream->Write(module_name_);
+}
+
+Module AotExecutorFactory::ExecutorCreate(const std::vector<Device>& devs) {
+  ICHECK_EQ(devs.size(), 1U) << "The AOT executor runs on a single device";
+  Device dev = devs[0];
+  ICHECK_EQ(dev.device_type, kDLCPU) << "The AOT executor runs on the CPU";
+  std::vector<NDArray> inputs, outputs, params;
+  for (const AotTensorInfo& info : inputs_) {
+    inputs.push_back(NDArray::Empty(info.shape, info.dtype, dev));
+  }
+  for (const AotTensorInfo& info : outputs_) {
+    outputs.push_back(NDArray::Empty(info.shape, info.dtype, dev));
+  }
+  // The params are read only, the executors on the CPU share them.
+  for (const std::string& name : param_names_) {
+    const NDArray& param = params_.at(name);
+    if (param->device.device_type == dev.device_type && param->device.device_id == dev.device_id) {
+      params.push_back(param);
+    } else {
+      params.push_back(param.CopyTo(dev));
+    }
+  }
+  NDArray arena =
+      NDArray::Empty({std::max<int64_t>(arena_size_, 1)}, DLDataType{kDLInt, 8, 1}, dev);
+  auto exec = make_object<AotExecutor>();
+  exec->Init(this->imports_[0], input_names_, inputs, outputs, params, arena);
+  return Module(exec);
+}
+
+Module AotExecutorFactoryModuleLoadBinary(void* strm) {
+  dmlc::Stream* stream = static_cast<dmlc::Stream*>(strm);
+  std::vector<std::string> input_names;
+  ICHECK(stream->Read(&input_names));
+  std::vector<AotTensorInfo> inputs = LoadTensorInfo(stream);
+  std::vector<AotTensorInfo> outputs = LoadTensorInfo(stream);
+  std::vector<std::string> param_names;
+  ICHECK(stream->Read(&param_names));
+  std::unordered_map<std::string, tvm::runtime::NDArray> params;
+  for (const std::string& name : param_names) {
+    tvm::runtime::NDArray temp;
+    temp.Load(stream);
+    params[name] = temp;
+  }
+  int64_t arena_size;
+  std::string module_name;
+  ICHECK(stream->Read(&arena_size));
+  ICHECK(stream->Read(&module_name));
+  auto exec = make_object<AotExecutorFactory>(input_names, inputs, outputs, param_names, params,
+                                              arena_size, module_name);
+  return Module(exec);
+}
+
+TVM_REGISTER_GLOBAL("tvm.aot_executor_factory.create").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // The argument order is module, module_name, arena_size, input_names, param_names,
+  // num_outputs, then arrays of the shapes and types of the inputs and of the outputs,
+  // then the params in the order of their names.
+  ICHECK_GE(args.num_args, 6) << "The expected number of arguments for "
+                                 "aot_executor_factory.create needs at least 6, "
+                                 "but it has "
+                              << args.num_args;
+  std::vector<std::string> input_names, param_names;
+  for (const String& name : args[3].operator Array<String>()) input_names.push_back(name);
+  for (const String& name : args[4].operator Array<String>()) param_names.push_back(name);
+  int num_outputs = args[5];
+  ICHECK_EQ(static_cast<size_t>(args.num_args),
+            6 + input_names.size() + num_outputs + param_names.size());
+  auto info = [](const NDArray& array) {
+    return AotTensorInfo{array.Shape(), array->dtype};
+  };
+  int index = 6;
+  std::vector<AotTensorInfo> inputs, outputs;
+  for (size_t i = 0; i < input_names.size(); ++i) {
+    inputs.push_back(info(args[index++].operator NDArray()));
+  }
+  for (int i = 0; i < num_outputs; ++i) {
+    outputs.push_back(info(args[index++].operator NDArray()));
+  }
+  std::unordered_map<std::string, tvm::runtime::NDArray> params;
+  for (const std::string& name : param_names) {
+    params[name] = args[index++].operator NDArray();
+  }
+  int64_t arena_size = args[2];
+  auto exec = make_object<AotExecutorFactory>(input_names, inputs, outputs, param_names, params,
+                                              arena_size, args[1]);
+  exec->Import(args[0]);
+  *rv = Module(exec);
+});
+
+TVM_REGISTER_GLOBAL("runtime.module.loadbinary_AotExecutorFactory")
+    .set_body_typed(AotExecutorFactoryModuleLoadBinary);
+
+}  // namespace runtime
+}  // namespace tvm
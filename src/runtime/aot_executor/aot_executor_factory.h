@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/aot_executor/aot_executor_factory.h
+ * \brief AOT executor factory creating the AOT executor.
+ */
+
+#ifndef TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_FACTORY_H_
+#define TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_FACTORY_H_
+
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "./aot_executor.h"
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief The shape and type of a tensor argument of the AOT entry function. */
+struct AotTensorInfo {
+  std::vector<int64_t> shape;
+  DLDataType dtype;
+};
+
+class TVM_DLL AotExecutorFactory : public runtime::ModuleNode {
+ public:
+  /*!
+   * \brief Construct the AotExecutorFactory.
+   * \param input_names The names of the inputs.
+   * \param inputs The shapes and types of the inputs.
+   * \param outputs The shapes and types of the outputs.
+   * \param param_names The names of the params, in argument order.
+   * \param params The params of the model.
+   * \param arena_size The size in bytes of the arena.
+   * \param module_name The module name of the model.
+   */
+  AotExecutorFactory(const std::vector<std::string>& input_names,
+                     const std::vector<AotTensorInfo>& inputs,
+                     const std::vector<AotTensorInfo>& outputs,
+                     const std::vector<std::string>& param_names,
+                     const std::unordered_map<std::string, tvm::runtime::NDArray>& params,
+                     int64_t arena_size, const std::string& module_name = "default");
+
+  /*!
+   * \brief Get member function to front-end
+   * \param name The name of the function.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The corresponding member function.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \return The type key of the executor.
+   */
+  const char* type_key() const override { return "AotExecutorFactory"; }
+
+  /*!
+   * \brief Save the module to binary stream.
+   * \param stream The binary stream to save to.
+   */
+  void SaveToBinary(dmlc::Stream* stream) override;
+
+  /*!
+   * \brief Create an executor module. The executors share the params of the factory.
+   * \param devs The device the model is executed on, it must be the CPU.
+   * \return created executor module
+   */
+  Module ExecutorCreate(const std::vector<Device>& devs);
+
+ protected:
+  /*! \brief The names of the inputs. */
+  std::vector<std::string> input_names_;
+  /*! \brief The shapes and types of the inputs. */
+  std::vector<AotTensorInfo> inputs_;
+  /*! \brief The shapes and types of the outputs. */
+  std::vector<AotTensorInfo> outputs_;
+  /*! \brief The names of the params, in argument order. */
+  std::vector<std::string> param_names_;
+  /*! \brief The params. */
+  std::unordered_map<std::string, tvm::runtime::NDArray> params_;
+  /*! \brief The size in bytes of the arena. */
+  int64_t arena_size_;
+  /*! \brief module name */
+  std::string module_name_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_AOT_EXECUTOR_AOT_EXECUTOR_FACTORY_H_
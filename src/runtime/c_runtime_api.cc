@@ -27,6 +27,7 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
@@ -35,6 +36,7 @@
 #include <cstdlib>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include "object_internal.h"
 #include "runtime_base.h"
@@ -176,10 +178,50 @@ void DeviceAPI::CopyDataFromTo(DLTensor* from, DLTensor* to, TVMStreamHandle str
   size_t nbytes = GetDataSize(*from);
   ICHECK_EQ(nbytes, GetDataSize(*to));
 
-  ICHECK(IsContiguous(*from) && IsContiguous(*to))
-      << "CopyDataFromTo only support contiguous array for now";
-  CopyDataFromTo(from->data, from->byte_offset, to->data, to->byte_offset, nbytes, from->device,
-                 to->device, from->dtype, stream);
+  if (IsContiguous(*from) && IsContiguous(*to)) {
+    CopyDataFromTo(from->data, from->byte_offset, to->data, to->byte_offset, nbytes, from->device,
+                   to->device, from->dtype, stream);
+    return;
+  }
+  // Strided arrays are copied as the runs of elements that both store contiguously
+  ICHECK(from->ndim == to->ndim && std::equal(from->shape, from->shape + from->ndim, to->shape))
+      << "CopyDataFromTo of strided arrays requires the same shapes";
+  ICHECK_EQ(from->dtype.bits * from->dtype.lanes % 8, 0)
+      << "CopyDataFromTo of strided arrays requires byte-sized elements";
+  if (nbytes == 0) return;
+  int64_t elem_bytes = from->dtype.bits * from->dtype.lanes / 8;
+  auto get_strides = [](const DLTensor* tensor) {
+    std::vector<int64_t> strides(tensor->ndim);
+    int64_t stride = 1;
+    for (int i = tensor->ndim; i != 0; --i) {
+      strides[i - 1] = tensor->strides != nullptr ? tensor->strides[i - 1] : stride;
+      stride *= tensor->shape[i - 1];
+    }
+    return strides;
+  };
+  std::vector<int64_t> from_strides = get_strides(from);
+  std::vector<int64_t> to_strides = get_strides(to);
+  // The innermost axes merged into a run
+  int outer_ndim = from->ndim;
+  int64_t run = 1;
+  while (outer_ndim > 0 && from_strides[outer_ndim - 1] == run &&
+         to_strides[outer_ndim - 1] == run) {
+    run *= from->shape[--outer_ndim];
+  }
+  std::vector<int64_t> index(outer_ndim, 0);
+  for (size_t copied = 0; copied < nbytes; copied += run * elem_bytes) {
+    int64_t from_offset = 0, to_offset = 0;
+    for (int i = 0; i < outer_ndim; ++i) {
+      from_offset += index[i] * from_strides[i];
+      to_offset += index[i] * to_strides[i];
+    }
+    CopyDataFromTo(from->data, from->byte_offset + from_offset * elem_bytes, to->data,
+                   to->byte_offset + to_offset * elem_bytes, run * elem_bytes, from->device,
+                   to->device, from->dtype, stream);
+    for (int i = outer_ndim; i != 0 && ++index[i - 1] == from->shape[i - 1]; --i) {
+      index[i - 1] = 0;
+    }
+  }
 }
 
 void DeviceAPI::CopyDataFromTo(const void* from, size_t from_offset, void* to, size_t to_offset,
@@ -432,6 +474,7 @@ void* TVMBackendAllocWorkspace(int device_type, int device_id, uint64_t size, in
   type_hint.bits = static_cast<decltype(type_hint.bits)>(dtype_bits_hint);
   type_hint.lanes = 1;
 
+  tvm::runtime::profiling::RecordAllocation(static_cast<int64_t>(size));
   return DeviceAPIManager::Get(dev)->AllocWorkspace(dev, static_cast<size_t>(size), type_hint);
 }
 
@@ -91,10 +91,11 @@ class ACLRuntime : public JSONRuntimeBase {
    * \return Status of inference.
    */
   void Run() override {
+    // The tensors keep the imported buffers, only the moved ones are imported again.
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
       auto nid = input_nodes_[i];
       uint32_t eid = EntryID(nid, 0);
-      if (nodes_[nid].GetOpType() == "input") {
+      if (nodes_[nid].GetOpType() == "input" && EntryRebound(eid)) {
         void* data = data_entry_[eid]->data;
         CheckACLError(layer_.inputs[i].allocator()->import_memory(data));
       }
@@ -102,6 +103,7 @@ class ACLRuntime : public JSONRuntimeBase {
 
     for (size_t i = 0; i < outputs_.size(); ++i) {
       uint32_t eid = EntryID(outputs_[i]);
+      if (!EntryRebound(eid)) continue;
       void* data = data_entry_[eid]->data;
       CheckACLError(layer_.outputs[i].allocator()->import_memory(data));
     }
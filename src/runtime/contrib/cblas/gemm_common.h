@@ -171,6 +171,11 @@ inline bool IsInPlaceTransposed3D(DLTensor* tensor) {
   return tensor->strides && (tensor->strides[2] > tensor->strides[1]);
 }
 inline int BatchCount3D(DLTensor* tensor) { return tensor->shape[0]; }
+// The distance between the matrices of a batch, 0 when a single matrix is broadcast.
+inline int BatchStride3D(DLTensor* tensor, int batch_size) {
+  if (tensor->shape[0] == 1 && batch_size != 1) return 0;
+  return tensor->strides ? tensor->strides[0] : tensor->shape[1] * tensor->shape[2];
+}
 inline int RowCount3D(DLTensor* tensor, bool trans) { return tensor->shape[trans ? 2 : 1]; }
 inline int ColumnCount3D(DLTensor* tensor, bool trans) { return tensor->shape[trans ? 1 : 2]; }
 template <typename TBatchGemmOp>
@@ -185,9 +190,10 @@ inline void CallBatchGemm(TVMArgs args, TVMRetValue* ret, TBatchGemmOp op) {
   ICHECK_EQ(A->ndim, 3);
   ICHECK_EQ(B->ndim, 3);
   ICHECK_EQ(C->ndim, 3);
-  int batch_size = BatchCount3D(A);
-  ICHECK_EQ(BatchCount3D(B), batch_size);
-  ICHECK_EQ(BatchCount3D(C), batch_size);
+  int batch_size = BatchCount3D(C);
+  // A batch of 1 is broadcast.
+  ICHECK(BatchCount3D(A) == batch_size || BatchCount3D(A) == 1);
+  ICHECK(BatchCount3D(B) == batch_size || BatchCount3D(B) == 1);
   ICHECK_EQ(ElementStride(A), 1);
   ICHECK_EQ(ElementStride(B), 1);
   ICHECK_EQ(ElementStride(C), 1);
@@ -200,8 +206,8 @@ inline void CallBatchGemm(TVMArgs args, TVMRetValue* ret, TBatchGemmOp op) {
   ICHECK(TypeMatch(C->dtype, kDLFloat, bit_depth));
   double alpha = args.size() > 5 ? args[5] : 1.0;
   double beta = args.size() > 6 ? args[6] : 0.0;
-  const int A_size = A->shape[1] * A->shape[2];
-  const int B_size = B->shape[1] * B->shape[2];
+  const int A_size = BatchStride3D(A, batch_size);
+  const int B_size = BatchStride3D(B, batch_size);
   const int C_size = C->shape[1] * C->shape[2];
   DType* A_data = reinterpret_cast<typename TBatchGemmOp::TDatatype*>(static_cast<char*>(A->data) +
                                                                       A->byte_offset);
@@ -215,6 +221,52 @@ inline void CallBatchGemm(TVMArgs args, TVMRetValue* ret, TBatchGemmOp op) {
      static_cast<typename TBatchGemmOp::TDatatype>(beta), C_data, C_size, ColumnStride3D(C));
 }
 
+
+// Call a column major batch of the integer blas, like CallU8S8S32Gemm.
+template <typename TBatchGemmOp>
+inline void CallBatchU8S8S32Gemm(TVMArgs args, TVMRetValue* ret, TBatchGemmOp op) {
+  DLTensor* A = args[0];
+  DLTensor* B = args[1];
+  DLTensor* C = args[2];
+  bool transa = args[3];
+  bool transb = args[4];
+
+  // The offsets are all 0, as in CallU8S8S32Gemm.
+  std::string offset_ctype = "CblasFixOffset";
+  int16_t offset_a = 0;
+  int16_t offset_b = 0;
+  int offset_c[1];
+  offset_c[0] = 0;
+
+  ICHECK_EQ(A->ndim, 3);
+  ICHECK_EQ(B->ndim, 3);
+  ICHECK_EQ(C->ndim, 3);
+  int batch_size = BatchCount3D(C);
+  // A batch of 1 is broadcast.
+  ICHECK(BatchCount3D(A) == batch_size || BatchCount3D(A) == 1);
+  ICHECK(BatchCount3D(B) == batch_size || BatchCount3D(B) == 1);
+  ICHECK_EQ(ElementStride3D(A), 1);
+  ICHECK_EQ(ElementStride3D(B), 1);
+  ICHECK_EQ(ElementStride3D(C), 1);
+  // C can never be transposed.
+  ICHECK(!IsInPlaceTransposed3D(C));
+  // Reversed strides indicates an in-place transpose operation.
+  transa = IsInPlaceTransposed3D(A) ? !transa : transa;
+  transb = IsInPlaceTransposed3D(B) ? !transb : transb;
+  ICHECK(TypeMatch(A->dtype, kDLUInt, 8));
+  ICHECK(TypeMatch(B->dtype, kDLInt, 8));
+  ICHECK(TypeMatch(C->dtype, kDLInt, 32));
+  double alpha = args.size() > 5 ? args[5] : 1.0;
+  double beta = args.size() > 6 ? args[6] : 0.0;
+  op(batch_size, transb, transa, ColumnCount3D(B, transb), RowCount3D(A, transa),
+     ColumnCount3D(A, transa), static_cast<float>(alpha),
+     static_cast<const int8_t*>(B->data) + B->byte_offset, BatchStride3D(B, batch_size),
+     ColumnStride3D(B), offset_b, static_cast<const uint8_t*>(A->data) + A->byte_offset,
+     BatchStride3D(A, batch_size), ColumnStride3D(A), offset_a, static_cast<float>(beta),
+     reinterpret_cast<int*>(static_cast<char*>(C->data) + C->byte_offset),
+     C->shape[1] * C->shape[2], ColumnStride3D(C), offset_ctype, offset_c);
+}
+
 }  // namespace contrib
 }  // namespace tvm
 #endif  // TVM_RUNTIME_CONTRIB_CBLAS_GEMM_COMMON_H_
@@ -26,8 +26,11 @@
 
 extern "C" {
 #include <mkl_cblas.h>
+#include <mkl_version.h>
 }
 
+#include <vector>
+
 #include "gemm_common.h"
 
 namespace tvm {
@@ -53,6 +56,11 @@ inline CBLAS_OFFSET MKLStringToOffset(const std::string offset_type) {
 
 inline char MKLBooleanToTransposeChar(bool trans) { return trans ? 'T' : 'N'; }
 
+// The batches of matrices at regular strides are multiplied in one call since oneMKL 2021.
+#if INTEL_MKL_VERSION >= 20210000
+#define TVM_MKL_GEMM_BATCH_STRIDED 1
+#endif
+
 struct MKLGemmU8S8S32Op {
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, const void* A, int lda,
                   int offset_a, const void* B, int ldb, int offset_b, float beta, int* C, int ldc,
@@ -63,6 +71,24 @@ struct MKLGemmU8S8S32Op {
   }
 };
 
+// MKL has no batch of the integer gemm, the matrices are multiplied one after the other.
+struct MKLGemmU8S8S32BatchOp {
+  void operator()(int batch_size, bool ta, bool tb, int M, int N, int K, float alpha,
+                  const int8_t* A, int a_stride, int lda, int offset_a, const uint8_t* B,
+                  int b_stride, int ldb, int offset_b, float beta, int* C, int c_stride, int ldc,
+                  const std::string offset_ctype, int* offset_c) {
+    CBLAS_OFFSET offset = MKLStringToOffset(offset_ctype);
+    for (int i = 0; i < batch_size; ++i) {
+      cblas_gemm_s8u8s32(CblasColMajor, MKLBooleanToTranspose(ta), MKLBooleanToTranspose(tb),
+                         offset, M, N, K, alpha, A, lda, offset_a, B, ldb, offset_b, beta, C, ldc,
+                         offset_c);
+      A += a_stride;
+      B += b_stride;
+      C += c_stride;
+    }
+  }
+};
+
 struct MKLSgemmOp {
   typedef float TDatatype;
   void operator()(bool ta, bool tb, int M, int N, int K, float alpha, float* A, int lda, float* B,
@@ -88,6 +114,14 @@ struct MKLSgemmBatchOp {
                   int c_stride, int ldc) {
     CBLAS_TRANSPOSE trans_a = MKLBooleanToTranspose(ta);
     CBLAS_TRANSPOSE trans_b = MKLBooleanToTranspose(tb);
+#ifdef TVM_MKL_GEMM_BATCH_STRIDED
+    // A broadcast matrix has a stride of 0, which goes through the arrays of pointers.
+    if (a_stride != 0 && b_stride != 0) {
+      cblas_sgemm_batch_strided(CblasColMajor, trans_a, trans_b, M, N, K, alpha, A, lda, a_stride,
+                                B, ldb, b_stride, beta, C, ldc, c_stride, batch_size);
+      return;
+    }
+#endif
     std::vector<const float*> A_array(batch_size);
     std::vector<const float*> B_array(batch_size);
     std::vector<float*> C_array(batch_size);
@@ -124,6 +158,14 @@ struct MKLDgemmBatchOp {
                   int c_stride, int ldc) {
     CBLAS_TRANSPOSE trans_a = MKLBooleanToTranspose(ta);
     CBLAS_TRANSPOSE trans_b = MKLBooleanToTranspose(tb);
+#ifdef TVM_MKL_GEMM_BATCH_STRIDED
+    // A broadcast matrix has a stride of 0, which goes through the arrays of pointers.
+    if (a_stride != 0 && b_stride != 0) {
+      cblas_dgemm_batch_strided(CblasColMajor, trans_a, trans_b, M, N, K, alpha, A, lda, a_stride,
+                                B, ldb, b_stride, beta, C, ldc, c_stride, batch_size);
+      return;
+    }
+#endif
     std::vector<const double*> A_array(batch_size);
     std::vector<const double*> B_array(batch_size);
     std::vector<double*> C_array(batch_size);
@@ -185,6 +227,18 @@ TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul").set_body([](TVMArgs args, TV
   }
 });
 
+// integer batch matrix multiplication for row major
+TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul_u8s8s32")
+    .set_body([](TVMArgs args, TVMRetValue* ret) {
+      DLTensor* A = args[0];
+      DLTensor* B = args[1];
+      DLTensor* C = args[2];
+      ICHECK(TypeMatch(A->dtype, kDLUInt, 8) && TypeMatch(B->dtype, kDLInt, 8) &&
+             TypeMatch(C->dtype, kDLInt, 32));
+
+      CallBatchU8S8S32Gemm(args, ret, MKLGemmU8S8S32BatchOp());
+    });
+
 TVM_REGISTER_GLOBAL("tvm.contrib.mkl.batch_matmul_iterative")
     .set_body([](TVMArgs args, TVMRetValue* ret) {
       DLTensor* A = args[0];
@@ -23,10 +23,12 @@
  */
 
 #include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
 #include <cstddef>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "../json/json_node.h"
@@ -62,25 +64,52 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
   }
 
   void Run() override {
-    // Fill in the input buffers.
+    // Bind the input buffers, the constants only once. The plain memories of the entries use
+    // the buffers in place, the others are copied.
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
+      bool is_const = nodes_[input_nodes_[i]].GetOpType() == "const";
+      if (consts_ready_ && is_const) continue;
       auto eid = EntryID(input_nodes_[i], 0);
+      if (zero_copy_eids_.count(eid)) {
+        if (is_const || EntryRebound(eid)) BindDataHandle(eid);
+        continue;
+      }
       // TODO(@comaniac): Support other data lengths.
       size_t offset_in_bytes = entry_out_mem_[eid].second * 4;
       size_t buffer_size = GetDataSize(*data_entry_[eid]);
       write_to_dnnl_memory(data_entry_[eid]->data, entry_out_mem_[eid].first, buffer_size,
                            offset_in_bytes);
     }
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      auto eid = EntryID(outputs_[i]);
+      if (zero_copy_eids_.count(eid) && EntryRebound(eid)) BindDataHandle(eid);
+    }
 
-    // Invoke the engine through intepreting the stream.
+    // Reorder the constants to the layouts of their primitives once.
+    if (!consts_ready_) {
+      for (size_t i = 0; i < const_net_.size(); ++i) {
+        const_net_.at(i).execute(stream_, const_net_args_.at(i));
+      }
+      consts_ready_ = true;
+    }
+
+    // Invoke the engine through intepreting the stream. Under a profiler each primitive is
+    // timed as a call nested in the call of the subgraph.
+    profiling::Profiler* prof = profiling::Profiler::Current();
     for (size_t i = 0; i < net_.size(); ++i) {
+      if (prof) prof->StartCall(net_names_.at(i), Device{kDLCPU, 0});
       net_.at(i).execute(stream_, net_args_.at(i));
+      if (prof) {
+        stream_.wait();
+        prof->StopCall();
+      }
     }
     stream_.wait();
 
     // Read output buffers.
     for (size_t i = 0; i < outputs_.size(); ++i) {
       auto eid = EntryID(outputs_[i]);
+      if (zero_copy_eids_.count(eid)) continue;
       size_t offset_in_bytes = entry_out_mem_[eid].second * 4;
       size_t buffer_size = GetDataSize(*data_entry_[eid]);
       read_from_dnnl_memory(data_entry_[eid]->data, entry_out_mem_[eid].first, buffer_size,
@@ -106,8 +135,20 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
           Conv2d(nid, true, false);
         } else if ("dnnl.conv2d_bias_relu" == op_name) {
           Conv2d(nid, true, true);
+        } else if ("dnnl.conv2d_bias" == op_name) {
+          Conv2d(nid, false, true);
+        } else if ("dnnl.conv2d_bias_sum" == op_name) {
+          Conv2d(nid, false, true, true);
+        } else if ("dnnl.conv2d_bias_sum_relu" == op_name) {
+          Conv2d(nid, true, true, true);
         } else if ("nn.dense" == op_name) {
           Dense(nid);
+        } else if ("dnnl.dense_relu" == op_name) {
+          Dense(nid, true, false);
+        } else if ("dnnl.dense_bias" == op_name) {
+          Dense(nid, false, true);
+        } else if ("dnnl.dense_bias_relu" == op_name) {
+          Dense(nid, true, true);
         } else if ("nn.batch_norm" == op_name) {
           BatchNorm(nid);
         } else if ("nn.relu" == op_name) {
@@ -117,8 +158,66 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
         } else {
           LOG(FATAL) << "Unsupported op: " << op_name;
         }
+        net_names_.resize(net_.size(), op_name);
       }
     }
+
+    // The primitives may leave the outputs in blocked layouts, reorder them to the plain ones
+    // the outputs are read in.
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      auto eid = EntryID(outputs_[i]);
+      auto shape = nodes_[outputs_[i].id_].GetOpShape()[outputs_[i].index_];
+      auto plain_md = GenDNNLMemDescByShape(shape, dt::f32);
+      auto& mem = entry_out_mem_[eid];
+      if (mem.first.get_desc() != plain_md) {
+        ICHECK_EQ(mem.second, 0U);
+        auto plain_memory = dnnl::memory(plain_md, engine_);
+        net_.push_back(dnnl::reorder(mem.first, plain_memory));
+        net_args_.push_back({{DNNL_ARG_FROM, mem.first}, {DNNL_ARG_TO, plain_memory}});
+        net_names_.push_back("reorder");
+        mem.first = plain_memory;
+      }
+    }
+
+    // The inputs, constants and outputs whose memory is a whole plain one of their own are bound
+    // to the buffers of the entries without a copy.
+    std::unordered_map<dnnl_memory_t, int> mem_uses;
+    for (const auto& it : entry_out_mem_) {
+      ++mem_uses[it.second.first.get()];
+    }
+    auto zero_copy = [&](uint32_t eid, const std::vector<int64_t>& shape) {
+      auto it = entry_out_mem_.find(eid);
+      if (it == entry_out_mem_.end() || it->second.second != 0) return;
+      const auto& mem = it->second.first;
+      auto md = mem.get_desc();
+      int64_t size = 4;
+      for (auto dim : shape) size *= dim;
+      if (mem_uses[mem.get()] == 1 && IsPlainF32(md) && md.get_size() == size) {
+        zero_copy_eids_.insert(eid);
+      }
+    };
+    for (auto nid : input_nodes_) {
+      zero_copy(EntryID(nid, 0), nodes_[nid].GetOpShape()[0]);
+    }
+    for (const auto& out : outputs_) {
+      zero_copy(EntryID(out), nodes_[out.id_].GetOpShape()[out.index_]);
+    }
+  }
+
+  // Whether a memory desc is the plain f32 layout of its dims.
+  bool IsPlainF32(const dnnl::memory::desc& md) {
+    static const tag plain_tags[] = {tag::a, tag::ab, tag::abc, tag::abcd, tag::abcde};
+    int ndims = md.data.ndims;
+    if (ndims < 1 || ndims > 5) return false;
+    dnnl::memory::dims dims(md.data.dims, md.data.dims + ndims);
+    return md == dnnl::memory::desc(dims, dt::f32, plain_tags[ndims - 1]);
+  }
+
+  // Point the memory of an entry to the buffer of the entry.
+  void BindDataHandle(uint32_t eid) {
+    const DLTensor* tensor = data_entry_[eid];
+    entry_out_mem_[eid].first.set_data_handle(static_cast<char*>(tensor->data) +
+                                              tensor->byte_offset);
   }
 
   // Bind a JSON graph node entry to a DNNL memory.
@@ -148,7 +247,58 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     return entry_out_mem_[eid].first;
   }
 
-  void Conv2d(const size_t& nid, const bool has_relu = false, const bool has_bias = false) {
+  // The description of the memory of an entry, the plain one of its shape when it is not bound.
+  dnnl::memory::desc GetDNNLMemDesc(const JSONGraphNodeEntry& entry) {
+    auto eid = EntryID(entry);
+    if (entry_out_mem_.count(eid)) {
+      return entry_out_mem_[eid].first.get_desc();
+    }
+    return GenDNNLMemDescByShape(nodes_[entry.id_].GetOpShape()[entry.index_], dt::f32);
+  }
+
+  // Get the memory of an entry in the layout a primitive expects. The entry is bound to the given
+  // plain layout when it is not bound yet, and reordered when its layout is not the expected one,
+  // e.g. the blocked layout a conv picks. The reorders of a constant are only run once.
+  dnnl::memory GetDNNLMemory(const JSONGraphNodeEntry& entry, dnnl::memory::desc plain_desc,
+                             dnnl::memory::desc mem_desc) {
+    auto mem = BindDNNLMemory(entry, plain_desc);
+    if (mem.get_desc() == mem_desc) {
+      return mem;
+    }
+    auto eid = EntryID(entry);
+    ICHECK_EQ(entry_out_mem_[eid].second, 0U) << "Cannot reorder a part of a memory";
+    // Share the reorders of an entry between its consumers.
+    for (const auto& reordered : reordered_mem_[eid]) {
+      if (reordered.get_desc() == mem_desc) return reordered;
+    }
+    auto reordered = dnnl::memory(mem_desc, engine_);
+    bool is_const = nodes_[entry.id_].GetOpType() == "const";
+    (is_const ? const_net_ : net_).push_back(dnnl::reorder(mem, reordered));
+    (is_const ? const_net_args_ : net_args_)
+        .push_back({{DNNL_ARG_FROM, mem}, {DNNL_ARG_TO, reordered}});
+    reordered_mem_[eid].push_back(reordered);
+    return reordered;
+  }
+
+  /*!
+   * \brief The post-ops of a conv or dense, in the order DNNL applies them: the sum of the
+   *  tensor already in the destination, then the relu.
+   */
+  dnnl::primitive_attr GetPostOpsAttr(bool has_relu, bool has_sum) {
+    dnnl::primitive_attr attr;
+    dnnl::post_ops ops;
+    if (has_sum) {
+      ops.append_sum(1.f);
+    }
+    if (has_relu) {
+      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
+    }
+    attr.set_post_ops(ops);
+    return attr;
+  }
+
+  void Conv2d(const size_t& nid, const bool has_relu = false, const bool has_bias = false,
+              const bool has_sum = false) {
     auto node = nodes_[nid];
 
     // Setup attributes.
@@ -160,19 +310,20 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     std::vector<std::string> str_padding = node.GetAttr<std::vector<std::string>>("padding");
     dnnl::memory::dim groups = std::stoi(node.GetAttr<std::vector<std::string>>("groups")[0]);
 
+    // The padding is (top, left, bottom, right).
     dnnl::memory::dim N = input_shape[0],       // batch size
         IC = input_shape[1],                    // input channels
         IH = input_shape[2],                    // input height
-        IW = input_shape[2],                    // input width
+        IW = input_shape[3],                    // input width
         OC = weight_shape[0],                   // output channels
         KH = weight_shape[2],                   // weight height
         KW = weight_shape[3],                   // weight width
-        PH_L = std::stoi(str_padding[1]),       // height padding: left
-        PH_R = std::stoi(str_padding[3]),       // height padding: right
-        PW_L = std::stoi(str_padding[0]),       // width padding: left
-        PW_R = std::stoi(str_padding[2]),       // width padding: right
+        PH_L = std::stoi(str_padding[0]),       // height padding: top
+        PH_R = std::stoi(str_padding[2]),       // height padding: bottom
+        PW_L = std::stoi(str_padding[1]),       // width padding: left
+        PW_R = std::stoi(str_padding[3]),       // width padding: right
         SH = std::stoi(str_strides[0]),         // height-wise stride
-        SW = std::stoi(str_strides[0]),         // weight-wise stride
+        SW = std::stoi(str_strides[1]),         // weight-wise stride
         OH = (IH - KH + PH_L + PH_R) / SH + 1,  // output height
         OW = (IW - KW + PW_L + PW_R) / SW + 1;  // output width
 
@@ -188,39 +339,32 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dims padding_dims_l = {PH_L, PW_L};
     dnnl::memory::dims padding_dims_r = {PH_R, PW_R};
 
-    // Memory descriptions.
+    // Memory descriptions, DNNL picks the layouts of the data, weights and output, e.g. blocked
+    // ones the consecutive convs pass along without reorders.
     auto conv_src_md = dnnl::memory::desc(src_dims, dt::f32, tag::any);
     auto conv_weights_md = dnnl::memory::desc(weights_dims, dt::f32, tag::any);
     auto conv_bias_md = dnnl::memory::desc(bias_dims, dt::f32, tag::any);
-    auto conv_dst_md = dnnl::memory::desc(dst_dims, dt::f32, tag::nchw);
+    auto conv_dst_md = dnnl::memory::desc(dst_dims, dt::f32, tag::any);
 
     // Covn2d description.
     auto conv_desc = dnnl::convolution_forward::desc(
         dnnl::prop_kind::forward_inference, dnnl::algorithm::convolution_direct, conv_src_md,
         conv_weights_md, conv_bias_md, conv_dst_md, strides_dims, padding_dims_l, padding_dims_r);
 
-    // Enable ReLU
-    dnnl::primitive_attr attr;
-    if (has_relu) {
-      dnnl::post_ops ops;
-      ops.append_eltwise(1.f, dnnl::algorithm::eltwise_relu, 0.f, 0.f);
-      attr.set_post_ops(ops);
-    }
-
+    // Fuse the sum and ReLU.
+    dnnl::primitive_attr attr = GetPostOpsAttr(has_relu, has_sum);
     auto conv2d_prim_desc = dnnl::convolution_forward::primitive_desc(conv_desc, attr, engine_);
 
-    // Push to the network.
-    auto conv = dnnl::convolution_forward(conv2d_prim_desc);
-    net_.push_back(conv);
-
     // Data memory.
     ICHECK_EQ(node.GetAttr<std::vector<std::string>>("data_layout")[0], "NCHW");
-    auto conv2d_src_memory = BindDNNLMemory(data_entry, {src_dims, dt::f32, tag::nchw});
+    auto conv2d_src_memory =
+        GetDNNLMemory(data_entry, {src_dims, dt::f32, tag::nchw}, conv2d_prim_desc.src_desc());
 
     // Weight memory.
     ICHECK_EQ(node.GetAttr<std::vector<std::string>>("kernel_layout")[0], "OIHW");
-    auto conv2d_weights_memory = BindDNNLMemory(
-        weight_entry, {weights_dims, dt::f32, (groups > 1) ? tag::goihw : tag::oihw});
+    auto conv2d_weights_memory =
+        GetDNNLMemory(weight_entry, {weights_dims, dt::f32, (groups > 1) ? tag::goihw : tag::oihw},
+                      conv2d_prim_desc.weights_desc());
 
     // Bias memory.
     auto conv2d_bias_memory = dnnl::memory({bias_dims, dt::f32, tag::x}, engine_);
@@ -228,14 +372,26 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
       auto bias_entry = node.GetInputs()[2];
       BindDNNLMemory(bias_entry, conv2d_bias_memory);
     } else {
-      float bias[OC] = {0};
-      write_to_dnnl_memory(bias, conv2d_bias_memory, OC * sizeof(float));
+      std::vector<float> bias(OC, 0);
+      write_to_dnnl_memory(bias.data(), conv2d_bias_memory, OC * sizeof(float));
     }
 
     // Output memory.
     JSONGraphNodeEntry out_entry(nid, 0);
     auto conv2d_dst_memory = BindDNNLMemory(out_entry, conv2d_prim_desc.dst_desc());
 
+    // The sum post-op adds the tensor in the output, copy it there first.
+    if (has_sum) {
+      auto sum_entry = node.GetInputs()[3];
+      auto sum_memory = BindDNNLMemory(sum_entry, GetDNNLMemDesc(sum_entry));
+      net_.push_back(dnnl::reorder(sum_memory, conv2d_dst_memory));
+      net_args_.push_back({{DNNL_ARG_FROM, sum_memory}, {DNNL_ARG_TO, conv2d_dst_memory}});
+    }
+
+    // Push to the network.
+    auto conv = dnnl::convolution_forward(conv2d_prim_desc);
+    net_.push_back(conv);
+
     // Bind memory buffers.
     net_args_.push_back({{DNNL_ARG_SRC, conv2d_src_memory},
                          {DNNL_ARG_WEIGHTS, conv2d_weights_memory},
@@ -243,7 +399,7 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
                          {DNNL_ARG_DST, conv2d_dst_memory}});
   }
 
-  void Dense(const size_t& nid) {
+  void Dense(const size_t& nid, const bool has_relu = false, const bool has_bias = false) {
     auto node = nodes_[nid];
 
     // Setup attributes.
@@ -262,29 +418,36 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dims bias_dims = {OC};
     dnnl::memory::dims out_dims = {B, OC};
 
-    // Memory descriptions.
+    // Memory descriptions, DNNL picks the layout of the weights.
     auto data_md = dnnl::memory::desc({data_dims, dt::f32, tag::nc});
-    auto weight_md = dnnl::memory::desc({weight_dims, dt::f32, tag::nc});
+    auto weight_md = dnnl::memory::desc({weight_dims, dt::f32, tag::any});
     auto bias_md = dnnl::memory::desc({bias_dims, dt::f32, tag::x});
     auto dst_md = dnnl::memory::desc({out_dims, dt::f32, tag::nc});
 
     // Dense description.
     auto dense_desc = dnnl::inner_product_forward::desc(dnnl::prop_kind::forward_inference, data_md,
                                                         weight_md, bias_md, dst_md);
-    auto dense_prim_desc = dnnl::inner_product_forward::primitive_desc(dense_desc, engine_);
+    dnnl::primitive_attr attr = GetPostOpsAttr(has_relu, false);
+    auto dense_prim_desc = dnnl::inner_product_forward::primitive_desc(dense_desc, attr, engine_);
 
     auto dense = dnnl::inner_product_forward(dense_prim_desc);
-    net_.push_back(dense);
 
     // Memories.
-    auto data_memory = BindDNNLMemory(data_entry, data_md);
-    auto weight_memory = BindDNNLMemory(weight_entry, weight_md);
+    auto data_memory = GetDNNLMemory(data_entry, data_md, data_md);
+    auto weight_memory = GetDNNLMemory(weight_entry, {weight_dims, dt::f32, tag::nc},
+                                       dense_prim_desc.weights_desc());
     auto bias_memory = dnnl::memory(bias_md, engine_);
-    float bias[OC] = {0};
-    write_to_dnnl_memory(bias, bias_memory, OC * sizeof(float));
+    if (has_bias) {
+      auto bias_entry = node.GetInputs()[2];
+      BindDNNLMemory(bias_entry, bias_memory);
+    } else {
+      std::vector<float> bias(OC, 0);
+      write_to_dnnl_memory(bias.data(), bias_memory, OC * sizeof(float));
+    }
     JSONGraphNodeEntry out_entry(nid, 0);
     auto dst_memory = BindDNNLMemory(out_entry, dense_prim_desc.dst_desc());
 
+    net_.push_back(dense);
     net_args_.push_back({{DNNL_ARG_SRC, data_memory},
                          {DNNL_ARG_WEIGHTS, weight_memory},
                          {DNNL_ARG_BIAS, bias_memory},
@@ -303,8 +466,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     dnnl::memory::dim IC = data_shape[1];
     float epsilon = std::stof(node.GetAttr<std::vector<std::string>>("epsilon")[0]);
 
-    // Memory description.
-    dnnl::memory::desc data_md = GenDNNLMemDescByShape(data_shape, dt::f32);
+    // Memory description, the layout of the data, e.g. the blocked one of a conv.
+    dnnl::memory::desc data_md = GetDNNLMemDesc(data_entry);
 
     // BN description.
     auto bn_desc = dnnl::batch_normalization_forward::desc(
@@ -337,8 +500,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     auto node = nodes_[nid];
 
     auto data_entry = node.GetInputs()[0];
-    dnnl::memory::dims shape = nodes_[data_entry.id_].GetOpShape()[data_entry.index_];
-    auto data_md = dnnl::memory::desc{{shape}, dt::f32, tag::abcd};
+    // The layout of the data, e.g. the blocked one of a conv.
+    auto data_md = GetDNNLMemDesc(data_entry);
 
     auto relu_desc = dnnl::eltwise_forward::desc(dnnl::prop_kind::forward_inference,
                                                  dnnl::algorithm::eltwise_relu, data_md, 0);
@@ -349,9 +512,8 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     net_.push_back(relu);
 
     auto data_memory = BindDNNLMemory(data_entry, data_md);
-    auto out_md = dnnl::memory::desc(shape, dt::f32, tag::abcd);
     JSONGraphNodeEntry out_entry(nid, 0);
-    auto out_memory = BindDNNLMemory(out_entry, out_md);
+    auto out_memory = BindDNNLMemory(out_entry, data_md);
 
     net_args_.push_back({{DNNL_ARG_SRC, data_memory}, {DNNL_ARG_DST, out_memory}});
   }
@@ -367,11 +529,13 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
     ICHECK_EQ(node.GetInputs().size(), 2U);
     for (auto entry : node.GetInputs()) {
       auto data_shape = nodes_[entry.id_].GetOpShape()[entry.index_];
-      dnnl::memory::desc data_md = GenDNNLMemDescByShape(data_shape, dt::f32);
+      // Both the data in the layout of the first one, e.g. the blocked one of a conv.
+      dnnl::memory::desc data_md = data_mds.empty() ? GetDNNLMemDesc(entry) : data_mds[0];
 
       data_dims.push_back(data_shape);
       data_mds.push_back(data_md);
-      data_memories.push_back(BindDNNLMemory(entry, data_md));
+      data_memories.push_back(
+          GetDNNLMemory(entry, GenDNNLMemDescByShape(data_shape, dt::f32), data_md));
     }
     ICHECK(data_dims[0] == data_dims[1]);
     auto out_md = data_mds[0];
@@ -435,8 +599,20 @@ class DNNLJSONRuntime : public JSONRuntimeBase {
   std::vector<dnnl::primitive> net_;
   /* The memory that is consumed by arguments. */
   std::vector<std::unordered_map<int, dnnl::memory>> net_args_;
+  /* The names of the primitives for the profiler, the op of the node building each one. */
+  std::vector<std::string> net_names_;
   /* The entry ID to its corresponding output memory. */
   std::unordered_map<uint32_t, std::pair<dnnl::memory, size_t>> entry_out_mem_;
+  /* The entry ID to its memories reordered to the layouts of its consumers. */
+  std::unordered_map<uint32_t, std::vector<dnnl::memory>> reordered_mem_;
+  /* The reorders of the constants, run once. */
+  std::vector<dnnl::primitive> const_net_;
+  /* The memory that is consumed by the reorders of the constants. */
+  std::vector<std::unordered_map<int, dnnl::memory>> const_net_args_;
+  /* Whether the constants are written and reordered. */
+  bool consts_ready_{false};
+  /* The entries whose memory uses the buffer of the entry in place. */
+  std::unordered_set<uint32_t> zero_copy_eids_;
 };
 
 runtime::Module DNNLJSONRuntimeCreate(String symbol_name, String graph_json,
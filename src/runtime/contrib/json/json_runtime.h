@@ -141,7 +141,8 @@ class JSONRuntimeBase : public ModuleNode {
  protected:
   /*!
    * \brief Set up the input and output buffers by binding their DLTensor pointers to the
-   * corresponding data entry.
+   * corresponding data entry. The buffers are not copied, and whether the data of each entry
+   * moved since the previous run is recorded, see EntryRebound.
    *
    * \param args The packed args.
    */
@@ -166,9 +167,29 @@ class JSONRuntimeBase : public ModuleNode {
       // Assign input/output the NDArray pointers to data entry so that we can directly
       // read/write host buffers.
       data_entry_[eid] = arg;
+
+      // The storage of the graph executor is usually the same from a run to the next.
+      const void* data = static_cast<const char*>(arg->data) + arg->byte_offset;
+      if (entry_rebound_.size() != data_entry_.size()) {
+        entry_rebound_.assign(data_entry_.size(), true);
+        entry_bound_data_.assign(data_entry_.size(), nullptr);
+      }
+      entry_rebound_[eid] = data != entry_bound_data_[eid];
+      entry_bound_data_[eid] = data;
     }
   }
 
+  /*!
+   * \brief Whether the data of an input or output entry moved since the previous run, so that
+   * the backends binding the buffers themselves, e.g. into their tensors, only do it once.
+   *
+   * \param eid The entry.
+   * \return Whether the entry is bound to another buffer than in the previous run.
+   */
+  bool EntryRebound(uint32_t eid) const {
+    return eid >= entry_rebound_.size() || entry_rebound_[eid];
+  }
+
   /*!
    * \brief Load the graph and record the entries for inputs and constants.
    *
@@ -264,6 +285,10 @@ class JSONRuntimeBase : public ModuleNode {
   std::vector<JSONGraphNodeEntry> outputs_;
   /*! \brief Data of that entry. */
   std::vector<const DLTensor*> data_entry_;
+  /*! \brief The data bound to the input and output entries in the previous run. */
+  std::vector<const void*> entry_bound_data_;
+  /*! \brief Whether the data of an input or output entry moved since the previous run. */
+  std::vector<bool> entry_rebound_;
   /*! \brief Map the input name to entry id. */
   std::vector<uint32_t> input_var_eid_;
   /*! \brief input const node index. */
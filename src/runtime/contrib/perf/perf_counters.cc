@@ -0,0 +1,187 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file perf_counters.cc
+ * \brief The metric collector of the Linux perf hardware counters of the CPU for the profiler.
+ */
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace profiling {
+
+/*!
+ * \brief The hardware counters of the calling thread, opened on first use.
+ *
+ *  The counters only count the thread that reads them, so operators that run on
+ *  the thread pool count the part of their work done by the calling thread.
+ */
+class PerfCounters {
+ public:
+  /*! \brief A reading of a counter, with the times it was enabled and counting. */
+  struct Reading {
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+  };
+
+  PerfCounters() {
+    auto cache_event = [](uint64_t cache) {
+      return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    const std::vector<std::tuple<const char*, uint32_t, uint64_t>> events = {
+        {"CPU Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"CPU Instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"CPU Cache Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {"CPU Branch Misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"L1D Read Misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_L1D)},
+        {"LLC Read Misses", PERF_TYPE_HW_CACHE, cache_event(PERF_COUNT_HW_CACHE_LL)}};
+    for (const auto& event : events) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.type = std::get<1>(event);
+      attr.size = sizeof(attr);
+      attr.config = std::get<2>(event);
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // More events than hardware counters are multiplexed, and scaled by the times.
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+      if (fd < 0) {
+        LOG(WARNING) << "Cannot open the perf counter " << std::get<0>(event) << ": "
+                     << std::strerror(errno);
+        continue;
+      }
+      counters_.emplace_back(std::get<0>(event), fd);
+    }
+  }
+
+  ~PerfCounters() {
+    for (const auto& counter : counters_) {
+      close(counter.second);
+    }
+  }
+
+  /*! \brief Read the counters, in the order of `Names`. A failed read is all zeros. */
+  std::vector<Reading> Read() const {
+    std::vector<Reading> readings(counters_.size(), Reading{0, 0, 0});
+    for (size_t i = 0; i < counters_.size(); ++i) {
+      Reading r;
+      if (read(counters_[i].second, &r, sizeof(r)) == sizeof(r)) readings[i] = r;
+    }
+    return readings;
+  }
+
+  /*! \brief The name of each counter that could be opened. */
+  std::vector<std::string> Names() const {
+    std::vector<std::string> names;
+    for (const auto& counter : counters_) names.push_back(counter.first);
+    return names;
+  }
+
+  static PerfCounters* ThreadLocal() {
+    static thread_local PerfCounters inst;
+    return &inst;
+  }
+
+ private:
+  /*! \brief The name and file descriptor of each counter that could be opened. */
+  std::vector<std::pair<std::string, int>> counters_;
+};
+
+/*!
+ * \brief The perf hardware counters of the CPU over each call and run on the CPU, with the
+ *  instructions per cycle and the misses per thousand instructions derived from them.
+ */
+class PerfEventCollectorNode : public MetricCollectorNode {
+ public:
+  ObjectRef Start(Device dev) final {
+    if (dev.device_type != kDLCPU) return ObjectRef();
+    auto state = make_object<StateNode>();
+    state->counters = PerfCounters::ThreadLocal();
+    state->begin = state->counters->Read();
+    return ObjectRef(state);
+  }
+
+  Map<String, ObjectRef> Stop(ObjectRef obj) final {
+    const auto* state = obj.as<StateNode>();
+    auto end = state->counters->Read();
+    auto names = state->counters->Names();
+    std::unordered_map<std::string, int64_t> counts;
+    Map<String, ObjectRef> metrics;
+    for (size_t i = 0; i < end.size(); ++i) {
+      const auto& b = state->begin[i];
+      const auto& e = end[i];
+      uint64_t running = e.time_running - b.time_running;
+      uint64_t enabled = e.time_enabled - b.time_enabled;
+      if (running == 0) continue;
+      double value = static_cast<double>(e.value - b.value);
+      if (running < enabled) value *= static_cast<double>(enabled) / running;
+      counts[names[i]] = static_cast<int64_t>(value);
+      metrics.Set(names[i], ObjectRef(make_object<CountNode>(counts[names[i]])));
+    }
+    auto per = [&](const char* num, const char* den, double scale, const char* name) {
+      auto n = counts.find(num), d = counts.find(den);
+      if (n == counts.end() || d == counts.end() || d->second == 0) return;
+      metrics.Set(name, ObjectRef(make_object<RatioNode>(scale * n->second / d->second)));
+    };
+    // Low IPC with many misses per kilo-instruction points at a memory bound kernel.
+    per("CPU Instructions", "CPU Cycles", 1, "IPC");
+    per("L1D Read Misses", "CPU Instructions", 1000, "L1D MPKI");
+    per("LLC Read Misses", "CPU Instructions", 1000, "LLC MPKI");
+    return metrics;
+  }
+
+  static constexpr const char* _type_key = "runtime.profiling.PerfEventCollector";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PerfEventCollectorNode, MetricCollectorNode);
+
+ private:
+  struct StateNode : public Object {
+    /*! \brief The counters of the thread the collection started on. */
+    PerfCounters* counters;
+    std::vector<PerfCounters::Reading> begin;
+    static constexpr const char* _type_key = "runtime.profiling.PerfEventState";
+    TVM_DECLARE_FINAL_OBJECT_INFO(StateNode, Object);
+  };
+};
+
+TVM_REGISTER_OBJECT_TYPE(PerfEventCollectorNode);
+
+TVM_REGISTER_GLOBAL("runtime.profiling.metric_collector.perf_event").set_body_typed([]() {
+  return MetricCollector(make_object<PerfEventCollectorNode>());
+});
+
+}  // namespace profiling
+}  // namespace runtime
+}  // namespace tvm
@@ -19,23 +19,29 @@
 
 /*!
  * \file random/mt_random_engine.cc
- * \brief mt19937 random engine
+ * \brief mt19937 random engine, filling the tensors with the Philox generator
  */
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/ndarray.h>
 
 #include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <random>
 
 #include "../3rdparty/compiler-rt/builtin_fp16.h"
+#include "philox.h"
 
 namespace tvm {
 namespace contrib {
 
 /*!
  * \brief An interface for generating [tensors of] random numbers.
+ *
+ *  The tensors are filled with the counter-based Philox generator, keyed by the seed, in
+ *  parallel. Each fill draws from a stream of its own, the fills following a seed are
+ *  reproducible, whatever the number of threads.
  */
 class RandomEngine {
  public:
@@ -55,6 +61,9 @@ class RandomEngine {
   inline void Seed(unsigned seed) {
     rnd_engine_.seed(seed);
     this->rseed_ = static_cast<unsigned>(seed);
+    this->key_[0] = static_cast<uint32_t>(seed);
+    this->key_[1] = 0;
+    this->stream_ = 0;
   }
 
   /*!
@@ -67,6 +76,24 @@ class RandomEngine {
    */
   inline unsigned GetRandInt() { return rnd_engine_(); }
 
+  /*!
+   * \brief Fills a tensor with integers drawn from [low, high)
+   */
+  template <typename DType>
+  void SampleInt(DLTensor* data, int64_t low, int64_t high) {
+    ICHECK_GT(high, low) << "high must be bigger than low";
+    ICHECK(data->strides == nullptr);
+    uint64_t range = static_cast<uint64_t>(high - low);
+    FillOnHost(data, [&](DLTensor* tensor, int64_t size) {
+      DType* ptr = static_cast<DType*>(tensor->data);
+      FillBlocks(size, [&](int64_t index, const uint32_t* words, int count) {
+        for (int i = 0; i < count; ++i) {
+          ptr[index + i] = static_cast<DType>(low + static_cast<int64_t>(words[i] % range));
+        }
+      });
+    });
+  }
+
   /*!
    * \brief Fills a tensor with values drawn from Unif(low, high)
    */
@@ -75,20 +102,16 @@ class RandomEngine {
     ICHECK(data->strides == nullptr);
 
     DLDataType dtype = data->dtype;
-    int64_t size = 1;
-    for (int i = 0; i < data->ndim; ++i) {
-      size *= data->shape[i];
-    }
-
     ICHECK(dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1);
 
-    if (data->device.device_type == kDLCPU) {
-      std::uniform_real_distribution<float> uniform_dist(low, high);
-      std::generate_n(static_cast<float*>(data->data), size,
-                      [&]() { return uniform_dist(rnd_engine_); });
-    } else {
-      LOG(FATAL) << "Do not support random.uniform on this device yet";
-    }
+    FillOnHost(data, [&](DLTensor* tensor, int64_t size) {
+      float* ptr = static_cast<float*>(tensor->data);
+      FillBlocks(size, [&](int64_t index, const uint32_t* words, int count) {
+        for (int i = 0; i < count; ++i) {
+          ptr[index + i] = low + (high - low) * PhiloxUniform(words[i]);
+        }
+      });
+    });
   }
 
   /*!
@@ -99,66 +122,104 @@ class RandomEngine {
     ICHECK(data->strides == nullptr);
 
     DLDataType dtype = data->dtype;
-    int64_t size = 1;
-    for (int i = 0; i < data->ndim; ++i) {
-      size *= data->shape[i];
-    }
-
     ICHECK(dtype.code == kDLFloat && dtype.bits == 32 && dtype.lanes == 1);
 
-    if (data->device.device_type == kDLCPU) {
-      std::normal_distribution<float> normal_dist(loc, scale);
-      std::generate_n(static_cast<float*>(data->data), size,
-                      [&]() { return normal_dist(rnd_engine_); });
-    } else {
-      LOG(FATAL) << "Do not support random.normal on this device yet";
-    }
+    FillOnHost(data, [&](DLTensor* tensor, int64_t size) {
+      float* ptr = static_cast<float*>(tensor->data);
+      FillBlocks(size, [&](int64_t index, const uint32_t* words, int count) {
+        // Box-Muller, a pair of normals from a pair of words.
+        float normals[kPhiloxBlockWords];
+        for (int i = 0; i < kPhiloxBlockWords; i += 2) {
+          // u1 in (0, 1] for the log
+          float u1 = ((words[i] >> 8) + 1) * (1.0f / (1 << 24));
+          float u2 = PhiloxUniform(words[i + 1]);
+          float r = std::sqrt(-2.0f * std::log(u1));
+          normals[i] = r * std::cos(6.2831853f * u2);
+          normals[i + 1] = r * std::sin(6.2831853f * u2);
+        }
+        for (int i = 0; i < count; ++i) {
+          ptr[index + i] = loc + scale * normals[i];
+        }
+      });
+    });
   }
 
   void RandomFill(DLTensor* data) {
+    FillOnHost(data, [&](DLTensor* tensor, int64_t size) { FillData(tensor, size); });
+  }
+
+ private:
+  /*!
+   * \brief Fill a tensor, or a host tensor copied to it when it is on another device.
+   * \param data The tensor.
+   * \param fill The function filling a host tensor of a size.
+   */
+  template <typename F>
+  void FillOnHost(DLTensor* data, F fill) {
     int64_t size = 1;
     for (int i = 0; i < data->ndim; ++i) {
       size *= data->shape[i];
     }
 
     if (data->device.device_type == kDLCPU) {
-      FillData(data, size);
+      fill(data, size);
     } else {
       runtime::NDArray local = runtime::NDArray::Empty(
           std::vector<int64_t>{data->shape, data->shape + data->ndim}, data->dtype, {kDLCPU, 0});
       DLTensor* tensor = const_cast<DLTensor*>(local.operator->());
-      FillData(tensor, size);
+      fill(tensor, size);
       runtime::NDArray::CopyFromTo(tensor, data);
     }
   }
 
- private:
+  /*!
+   * \brief Run f(index, words, count) for the elements [0, size), each block of words
+   *  filling the count elements from index, from a stream of its own.
+   */
+  template <typename F>
+  void FillBlocks(int64_t size, F f) {
+    int64_t num_blocks = (size + kPhiloxBlockWords - 1) / kPhiloxBlockWords;
+    PhiloxForEachBlock(num_blocks, stream_++, key_, [&](int64_t block, const uint32_t* words) {
+      int64_t index = block * kPhiloxBlockWords;
+      f(index, words, static_cast<int>(std::min<int64_t>(kPhiloxBlockWords, size - index)));
+    });
+  }
+
+  /*!
+   * \brief Fill the elements of a tensor, converted from a uniform value of [low, high).
+   */
+  template <typename DType, typename Convert>
+  void FillUniform(DLTensor* tensor, int64_t size, double low, double high, Convert convert) {
+    DType* ptr = static_cast<DType*>(tensor->data);
+    FillBlocks(size, [&](int64_t index, const uint32_t* words, int count) {
+      for (int i = 0; i < count; ++i) {
+        ptr[index + i] = convert(low + (high - low) * PhiloxUniform(words[i]));
+      }
+    });
+  }
+
   void FillData(DLTensor* tensor, int64_t size) {
     // Make the value be 1.0 - 10.0, not (0.0 - 1.0) so that we could satisfy
     // quantized dtype (uint8 / int8) data non-empty requirement
-    std::uniform_real_distribution<> dist(1.0, 10.0);
     // Use float representation could make us work well on float / int type too.
     if (tensor->dtype.bits == 1) {
-      std::generate_n(static_cast<bool*>(tensor->data), size, [&]() { return dist(rnd_engine_); });
+      FillUniform<bool>(tensor, size, 1.0, 10.0, [](double v) { return v != 0; });
     } else if (tensor->dtype.bits == 4) {
       // For uint4/int4 we pack two values into a single byte.
       // Thus, to ensure both values are non-zero, we use a distribution of 17 - 30.
-      std::uniform_real_distribution<> packed_dist(17.0, 30.0);
-      std::generate_n(reinterpret_cast<uint8_t*>(tensor->data), size,
-                      [&]() { return packed_dist(rnd_engine_); });
+      FillUniform<uint8_t>(tensor, size, 17.0, 30.0,
+                           [](double v) { return static_cast<uint8_t>(v); });
     } else if (tensor->dtype.bits == 8) {
-      std::generate_n(static_cast<uint8_t*>(tensor->data), size,
-                      [&]() { return dist(rnd_engine_); });
+      FillUniform<uint8_t>(tensor, size, 1.0, 10.0,
+                           [](double v) { return static_cast<uint8_t>(v); });
     } else if (tensor->dtype.bits == 16) {
-      std::generate_n(static_cast<uint16_t*>(tensor->data), size, [&]() {
-        return __truncXfYf2__<float, uint32_t, 23, uint16_t, uint16_t, 10>(
-            static_cast<float>(dist(rnd_engine_)));
+      FillUniform<uint16_t>(tensor, size, 1.0, 10.0, [](double v) {
+        return __truncXfYf2__<float, uint32_t, 23, uint16_t, uint16_t, 10>(static_cast<float>(v));
       });
     } else if (tensor->dtype.bits == 32) {
-      std::generate_n(static_cast<float*>(tensor->data), size, [&]() { return dist(rnd_engine_); });
+      FillUniform<float>(tensor, size, 1.0, 10.0, [](double v) { return static_cast<float>(v); });
     } else if (tensor->dtype.bits == 64) {
-      std::generate_n(static_cast<double*>(tensor->data), size,
-                      [&]() { return dist(rnd_engine_); });
+      FillUniform<double>(tensor, size, 1.0, 10.0, [](double v) { return v; });
     } else {
       LOG(FATAL) << "Doesn't support dtype code " << tensor->dtype.code << " dtype bits "
                  << tensor->dtype.bits;
@@ -168,6 +229,10 @@ class RandomEngine {
  private:
   std::mt19937 rnd_engine_;
   unsigned rseed_;
+  /*! \brief The Philox key of the seed. */
+  uint32_t key_[2];
+  /*! \brief The stream of the next fill. */
+  uint64_t stream_;
 };
 
 }  // namespace contrib
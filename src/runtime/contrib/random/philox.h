@@ -0,0 +1,118 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file random/philox.h
+ * \brief The counter-based Philox4x32-10 generator, filling tensors in parallel.
+ *
+ *  The words of a block are a function of the key and the counter of the block only, so
+ *  the blocks are generated in any order, on any number of threads, with the same result.
+ */
+#ifndef TVM_RUNTIME_CONTRIB_RANDOM_PHILOX_H_
+#define TVM_RUNTIME_CONTRIB_RANDOM_PHILOX_H_
+
+#include <tvm/runtime/c_backend_api.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace tvm {
+namespace contrib {
+
+/*! \brief The number of words of a Philox block. */
+constexpr int kPhiloxBlockWords = 4;
+
+/*!
+ * \brief Generate the block of a counter, Random123's Philox4x32 with 10 rounds.
+ * \param counter The counter of the block.
+ * \param key The key, e.g. the seed.
+ * \param out The words of the block.
+ */
+inline void Philox4x32(const uint32_t counter[4], const uint32_t key[2], uint32_t out[4]) {
+  constexpr uint32_t kMul0 = 0xD2511F53U, kMul1 = 0xCD9E8D57U;
+  constexpr uint32_t kWeyl0 = 0x9E3779B9U, kWeyl1 = 0xBB67AE85U;
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (int round = 0; round < 10; ++round) {
+    uint64_t p0 = static_cast<uint64_t>(kMul0) * c0;
+    uint64_t p1 = static_cast<uint64_t>(kMul1) * c2;
+    uint32_t hi0 = static_cast<uint32_t>(p0 >> 32), lo0 = static_cast<uint32_t>(p0);
+    uint32_t hi1 = static_cast<uint32_t>(p1 >> 32), lo1 = static_cast<uint32_t>(p1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += kWeyl0;
+    k1 += kWeyl1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+/*! \brief A uniform float in [0, 1) of the 24 high bits of a word. */
+inline float PhiloxUniform(uint32_t word) { return (word >> 8) * (1.0f / (1 << 24)); }
+
+/*!
+ * \brief Run f(block, words) for the blocks [0, num_blocks), where the counter of a block is
+ *  (block, stream), on the threads of the runtime when there are enough blocks.
+ * \param num_blocks The number of blocks.
+ * \param stream The stream of the counters, distinct for each fill of a key.
+ * \param key The key.
+ * \param f The function writing the elements of a block.
+ */
+template <typename F>
+void PhiloxForEachBlock(int64_t num_blocks, uint64_t stream, const uint32_t key[2], F f) {
+  // The number of blocks worth a parallel launch.
+  constexpr int64_t kMinParallelBlocks = 1 << 14;
+  struct Closure {
+    int64_t num_blocks;
+    uint64_t stream;
+    const uint32_t* key;
+    F* f;
+  } closure{num_blocks, stream, key, &f};
+  auto flambda = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    auto* closure = static_cast<Closure*>(cdata);
+    int64_t chunk = (closure->num_blocks + penv->num_task - 1) / penv->num_task;
+    int64_t begin = std::min(closure->num_blocks, task_id * chunk);
+    int64_t end = std::min(closure->num_blocks, begin + chunk);
+    uint32_t counter[4] = {0, 0, static_cast<uint32_t>(closure->stream),
+                           static_cast<uint32_t>(closure->stream >> 32)};
+    uint32_t words[kPhiloxBlockWords];
+    for (int64_t block = begin; block < end; ++block) {
+      counter[0] = static_cast<uint32_t>(block);
+      counter[1] = static_cast<uint32_t>(static_cast<uint64_t>(block) >> 32);
+      Philox4x32(counter, closure->key, words);
+      (*closure->f)(block, words);
+    }
+    return 0;
+  };
+  if (num_blocks < kMinParallelBlocks) {
+    TVMParallelGroupEnv env;
+    env.num_task = 1;
+    flambda(0, &env, &closure);
+  } else {
+    TVMBackendParallelLaunch(flambda, &closure, 0);
+  }
+}
+
+}  // namespace contrib
+}  // namespace tvm
+#endif  // TVM_RUNTIME_CONTRIB_RANDOM_PHILOX_H_
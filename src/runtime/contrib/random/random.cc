@@ -77,11 +77,6 @@ TVM_REGISTER_GLOBAL("tvm.contrib.random.randint").set_body([](TVMArgs args, TVMR
   ICHECK(out->strides == nullptr);
 
   DLDataType dtype = out->dtype;
-  int64_t size = 1;
-  for (int i = 0; i < out->ndim; ++i) {
-    size *= out->shape[i];
-  }
-
   DLPACK_INTEGER_TYPE_SWITCH(dtype, DType, {
     int64_t numeric_low = std::numeric_limits<DType>::min();
     int64_t numeric_high = std::numeric_limits<DType>::max();
@@ -89,15 +84,7 @@ TVM_REGISTER_GLOBAL("tvm.contrib.random.randint").set_body([](TVMArgs args, TVMR
     low = std::max(low, numeric_low);
     high = std::min(high, numeric_high);
 
-    if (out->device.device_type == kDLCPU) {
-      // file the data with random byte
-      std::generate_n(static_cast<DType*>(out->data), size, [&]() {
-        unsigned rint = entry->random_engine.GetRandInt();
-        return low + rint % (high - low);
-      });
-    } else {
-      LOG(FATAL) << "Do not support random.randint on this device yet";
-    }
+    entry->random_engine.SampleInt<DType>(out, low, high);
   })
 });
 
@@ -117,6 +104,12 @@ TVM_REGISTER_GLOBAL("tvm.contrib.random.normal").set_body([](TVMArgs args, TVMRe
   entry->random_engine.SampleNormal(out, loc, scale);
 });
 
+TVM_REGISTER_GLOBAL("tvm.contrib.random.seed").set_body([](TVMArgs args, TVMRetValue* ret) {
+  RandomThreadLocalEntry* entry = RandomThreadLocalEntry::ThreadLocal();
+  int64_t seed = args[0];
+  entry->random_engine.Seed(static_cast<unsigned>(seed));
+});
+
 TVM_REGISTER_GLOBAL("tvm.contrib.random.random_fill").set_body([](TVMArgs args, TVMRetValue* ret) {
   RandomThreadLocalEntry* entry = RandomThreadLocalEntry::ThreadLocal();
   DLTensor* out = args[0];
@@ -22,9 +22,12 @@
  */
 
 #include <dlpack/dlpack.h>
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/registry.h>
 
 #include <algorithm>
+#include <cstring>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -42,6 +45,174 @@ bool CompareDescend(const std::pair<int64_t, DType>& lhs, const std::pair<int64_
   return lhs.second > rhs.second;
 }
 
+// The number of elements of a tensor worth sorting its rows in parallel.
+constexpr int64_t kMinParallelSortSize = 1 << 14;
+// The number of elements of a row worth a radix sort.
+constexpr size_t kMinRadixSortSize = 256;
+
+/*!
+ * \brief Run f(i, j) for each row of a tensor along an axis, for i in [0, axis_mul_before)
+ *  and j in [0, axis_mul_after), in parallel on the threads of the runtime when the tensor
+ *  is large enough.
+ */
+template <typename F>
+void ParallelForRows(int64_t axis_mul_before, int64_t axis_mul_after, int64_t row_size, F f) {
+  int64_t num_rows = axis_mul_before * axis_mul_after;
+  if (num_rows < 2 || num_rows * row_size < kMinParallelSortSize) {
+    for (int64_t row = 0; row < num_rows; ++row) {
+      f(row / axis_mul_after, row % axis_mul_after);
+    }
+    return;
+  }
+  struct Closure {
+    int64_t num_rows;
+    int64_t axis_mul_after;
+    F* f;
+  } closure{num_rows, axis_mul_after, &f};
+  auto flambda = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    auto* closure = static_cast<Closure*>(cdata);
+    int64_t chunk = (closure->num_rows + penv->num_task - 1) / penv->num_task;
+    int64_t begin = std::min(closure->num_rows, task_id * chunk);
+    int64_t end = std::min(closure->num_rows, begin + chunk);
+    for (int64_t row = begin; row < end; ++row) {
+      (*closure->f)(row / closure->axis_mul_after, row % closure->axis_mul_after);
+    }
+    return 0;
+  };
+  TVMBackendParallelLaunch(flambda, &closure, 0);
+}
+
+/*!
+ * \brief The unsigned radix sort key of a value, ordered as the values.
+ *  Get returns false for a value without a key, e.g. a NaN.
+ */
+template <typename DataType>
+struct RadixKey {
+  using Type = uint32_t;
+  static bool Get(DataType value, Type* key) { return false; }
+};
+
+template <>
+struct RadixKey<int32_t> {
+  using Type = uint32_t;
+  static bool Get(int32_t value, Type* key) {
+    *key = static_cast<uint32_t>(value) ^ 0x80000000U;
+    return true;
+  }
+};
+
+template <>
+struct RadixKey<int64_t> {
+  using Type = uint64_t;
+  static bool Get(int64_t value, Type* key) {
+    *key = static_cast<uint64_t>(value) ^ 0x8000000000000000ULL;
+    return true;
+  }
+};
+
+template <typename FloatType, typename BitsType>
+bool GetFloatRadixKey(FloatType value, BitsType* key) {
+  if (value != value) return false;
+  // -0.0 compares equal to 0.0, and keeps its place among the zeros.
+  if (value == 0) value = 0;
+  BitsType bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const BitsType sign = BitsType(1) << (sizeof(bits) * 8 - 1);
+  *key = (bits & sign) ? ~bits : bits | sign;
+  return true;
+}
+
+template <>
+struct RadixKey<float> {
+  using Type = uint32_t;
+  static bool Get(float value, Type* key) { return GetFloatRadixKey(value, key); }
+};
+
+template <>
+struct RadixKey<double> {
+  using Type = uint64_t;
+  static bool Get(double value, Type* key) { return GetFloatRadixKey(value, key); }
+};
+
+/*!
+ * \brief Stable LSD radix sort of a row by value, a byte per pass, skipping the bytes all the
+ *  keys share.
+ * \return Whether the row was sorted, false when a value has no radix key.
+ */
+template <typename DataType>
+bool RadixSortRow(std::vector<std::pair<int64_t, DataType>>* sorter, bool is_ascend) {
+  using Key = typename RadixKey<DataType>::Type;
+  size_t n = sorter->size();
+  std::vector<Key> keys(n), tmp_keys(n);
+  std::vector<int64_t> perm(n), tmp_perm(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (!RadixKey<DataType>::Get((*sorter)[i].second, &keys[i])) return false;
+    // The descending order keeps the equal values in order, as the ascending order of ~key.
+    if (!is_ascend) keys[i] = ~keys[i];
+    perm[i] = static_cast<int64_t>(i);
+  }
+  for (size_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+    size_t count[257] = {0};
+    for (size_t i = 0; i < n; ++i) {
+      ++count[((keys[i] >> shift) & 0xFF) + 1];
+    }
+    if (count[((keys[0] >> shift) & 0xFF) + 1] == n) continue;
+    for (size_t d = 1; d < 257; ++d) {
+      count[d] += count[d - 1];
+    }
+    for (size_t i = 0; i < n; ++i) {
+      size_t dst = count[(keys[i] >> shift) & 0xFF]++;
+      tmp_keys[dst] = keys[i];
+      tmp_perm[dst] = perm[i];
+    }
+    keys.swap(tmp_keys);
+    perm.swap(tmp_perm);
+  }
+  std::vector<std::pair<int64_t, DataType>> sorted(n);
+  for (size_t i = 0; i < n; ++i) {
+    sorted[i] = (*sorter)[perm[i]];
+  }
+  sorter->swap(sorted);
+  return true;
+}
+
+// Sort a row stably by value.
+template <typename DataType>
+void SortRow(std::vector<std::pair<int64_t, DataType>>* sorter, bool is_ascend) {
+  if (sorter->size() >= kMinRadixSortSize && RadixSortRow(sorter, is_ascend)) return;
+  if (is_ascend) {
+    std::stable_sort(sorter->begin(), sorter->end(), CompareAscend<DataType>);
+  } else {
+    std::stable_sort(sorter->begin(), sorter->end(), CompareDescend<DataType>);
+  }
+}
+
+// Select the first k elements of the stable sort of a row, in order.
+template <typename DataType>
+void TopKRow(std::vector<std::pair<int64_t, DataType>>* sorter, int64_t k, bool is_ascend) {
+  if (k * 8 > static_cast<int64_t>(sorter->size())) {
+    SortRow(sorter, is_ascend);
+    return;
+  }
+  // The equal values are ordered by index, as in the stable sort.
+  auto middle = sorter->begin() + k;
+  if (is_ascend) {
+    std::partial_sort(sorter->begin(), middle, sorter->end(),
+                      [](const std::pair<int64_t, DataType>& lhs,
+                         const std::pair<int64_t, DataType>& rhs) {
+                        return lhs.second < rhs.second ||
+                               (!(rhs.second < lhs.second) && lhs.first < rhs.first);
+                      });
+  } else {
+    std::partial_sort(sorter->begin(), middle, sorter->end(),
+                      [](const std::pair<int64_t, DataType>& lhs,
+                         const std::pair<int64_t, DataType>& rhs) {
+                        return lhs.second > rhs.second ||
+                               (!(rhs.second > lhs.second) && lhs.first < rhs.first);
+                      });
+  }
+}
+
 // Argsort implemented C library sort for nms.
 // Return indices of sorted tensor.
 // By default, the last axis will be used to sort.
@@ -59,7 +230,6 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.argsort_nms").set_body([](TVMArgs args, TV
   auto dtype = input->dtype;
   auto data_ptr = static_cast<float*>(input->data);
   auto sort_num_ptr = static_cast<int32_t*>(sort_num->data);
-  std::vector<std::pair<int32_t, float>> sorter;
   int64_t axis_mul_before = 1;
   int64_t axis_mul_after = 1;
 
@@ -86,52 +256,41 @@ TVM_REGISTER_GLOBAL("tvm.contrib.sort.argsort_nms").set_body([](TVMArgs args, TV
     }
   }
 
-  for (int64_t i = 0; i < axis_mul_before; ++i) {
-    for (int64_t j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int32_t current_sort_num = *(sort_num_ptr + i * axis_mul_after + j);
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
-      for (int64_t k = 0; k < current_sort_num; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, *(data_ptr + full_idx)));
-      }
-      if (is_ascend) {
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        if (dtype.bits == 16) {
-          std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<__fp16>);
-        } else {
-#endif
-          std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<float>);
+  ParallelForRows(axis_mul_before, axis_mul_after, input->shape[axis], [&](int64_t i, int64_t j) {
+    std::vector<std::pair<int64_t, float>> sorter;
+    int32_t current_sort_num = *(sort_num_ptr + i * axis_mul_after + j);
+    int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
+    for (int64_t k = 0; k < current_sort_num; ++k) {
+      int64_t full_idx = base_idx + k * axis_mul_after;
+      sorter.emplace_back(std::make_pair(k, *(data_ptr + full_idx)));
+    }
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        }
-#endif
+    if (dtype.bits == 16) {
+      if (is_ascend) {
+        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<__fp16>);
       } else {
-#if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        if (dtype.bits == 16) {
-          std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<__fp16>);
-        } else {
+        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<__fp16>);
+      }
+    } else {
 #endif
-          std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<float>);
+      SortRow(&sorter, is_ascend);
 #if (__ARM_FEATURE_FP16_SCALAR_ARITHMETIC == 1)
-        }
+    }
 #endif
-      }
-      for (int32_t k = 0; k < input->shape[axis]; ++k) {
-        *(static_cast<int32_t*>(output->data) + base_idx + k * axis_mul_after) =
-            k < static_cast<int32_t>(sorter.size()) ? sorter[k].first : k;
-      }
+    for (int32_t k = 0; k < input->shape[axis]; ++k) {
+      *(static_cast<int32_t*>(output->data) + base_idx + k * axis_mul_after) =
+          k < static_cast<int32_t>(sorter.size()) ? sorter[k].first : k;
     }
-  }
+  });
 });
 
 template <typename DataType, typename OutType>
 void sort_impl(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend, bool is_argsort) {
   auto data_ptr = static_cast<DataType*>(input->data);
   auto out_ptr = static_cast<OutType*>(output->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -140,30 +299,25 @@ void sort_impl(DLTensor* input, DLTensor* output, int32_t axis, bool is_ascend,
     }
   }
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
+  ParallelForRows(axis_mul_before, axis_mul_after, input->shape[axis], [&](int64_t i, int64_t j) {
+    std::vector<std::pair<int64_t, DataType>> sorter;
+    sorter.reserve(input->shape[axis]);
+    int64_t base_idx = i * input->shape[axis] * axis_mul_after + j;
+    for (int64_t k = 0; k < input->shape[axis]; ++k) {
+      int64_t full_idx = base_idx + k * axis_mul_after;
+      sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
+    }
+    SortRow(&sorter, is_ascend);
+    if (is_argsort) {
       for (int64_t k = 0; k < input->shape[axis]; ++k) {
-        int64_t full_idx = base_idx + k * axis_mul_after;
-        sorter.emplace_back(std::make_pair(k, data_ptr[full_idx]));
+        out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].first);
       }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
-      }
-      if (is_argsort) {
-        for (int64_t k = 0; k < input->shape[axis]; ++k) {
-          out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].first);
-        }
-      } else {
-        for (int64_t k = 0; k < input->shape[axis]; ++k) {
-          out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].second);
-        }
+    } else {
+      for (int64_t k = 0; k < input->shape[axis]; ++k) {
+        out_ptr[base_idx + k * axis_mul_after] = static_cast<OutType>(sorter[k].second);
       }
     }
-  }
+  });
 }
 
 template <typename DataType, typename OutType>
@@ -308,10 +462,9 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
       (out_values == nullptr) ? nullptr : static_cast<DataType*>(out_values->data);
   IndicesType* indices_ptr =
       (out_indices == nullptr) ? nullptr : static_cast<IndicesType*>(out_indices->data);
-  std::vector<std::pair<int64_t, DataType>> sorter;
 
-  int axis_mul_before = 1;
-  int axis_mul_after = 1;
+  int64_t axis_mul_before = 1;
+  int64_t axis_mul_after = 1;
   for (int i = 0; i < input->ndim; ++i) {
     if (i < axis) {
       axis_mul_before *= input->shape[i];
@@ -323,32 +476,27 @@ void topk(DLTensor* input, DLTensor* out_values, DLTensor* out_indices, int k, i
     k = input->shape[axis];
   }
 
-  for (int i = 0; i < axis_mul_before; ++i) {
-    for (int j = 0; j < axis_mul_after; ++j) {
-      sorter.clear();
-      int64_t src_base_idx = i * input->shape[axis] * axis_mul_after + j;
-      int64_t dst_base_idx = i * k * axis_mul_after + j;
-      for (int64_t kk = 0; kk < input->shape[axis]; ++kk) {
-        int64_t full_idx = src_base_idx + kk * axis_mul_after;
-        sorter.emplace_back(std::make_pair(kk, data_ptr[full_idx]));
-      }
-      if (is_ascend) {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareAscend<DataType>);
-      } else {
-        std::stable_sort(sorter.begin(), sorter.end(), CompareDescend<DataType>);
+  ParallelForRows(axis_mul_before, axis_mul_after, input->shape[axis], [&](int64_t i, int64_t j) {
+    std::vector<std::pair<int64_t, DataType>> sorter;
+    sorter.reserve(input->shape[axis]);
+    int64_t src_base_idx = i * input->shape[axis] * axis_mul_after + j;
+    int64_t dst_base_idx = i * k * axis_mul_after + j;
+    for (int64_t kk = 0; kk < input->shape[axis]; ++kk) {
+      int64_t full_idx = src_base_idx + kk * axis_mul_after;
+      sorter.emplace_back(std::make_pair(kk, data_ptr[full_idx]));
+    }
+    int64_t cnt = k > 0 ? k : input->shape[axis];
+    TopKRow(&sorter, cnt, is_ascend);
+    for (int64_t kk = 0; kk < cnt; ++kk) {
+      if (indices_ptr != nullptr) {
+        indices_ptr[dst_base_idx + kk * axis_mul_after] =
+            static_cast<IndicesType>(sorter[kk].first);
       }
-      int64_t cnt = k > 0 ? k : input->shape[axis];
-      for (int64_t kk = 0; kk < cnt; ++kk) {
-        if (indices_ptr != nullptr) {
-          indices_ptr[dst_base_idx + kk * axis_mul_after] =
-              static_cast<IndicesType>(sorter[kk].first);
-        }
-        if (values_ptr != nullptr) {
-          values_ptr[dst_base_idx + kk * axis_mul_after] = static_cast<DataType>(sorter[kk].second);
-        }
+      if (values_ptr != nullptr) {
+        values_ptr[dst_base_idx + kk * axis_mul_after] = static_cast<DataType>(sorter[kk].second);
       }
     }
-  }
+  });
 }
 
 // Argsort implemented C library sort.
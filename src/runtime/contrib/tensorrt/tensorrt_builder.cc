@@ -26,6 +26,7 @@
 
 #include <tvm/runtime/ndarray.h>
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -253,6 +254,10 @@ void TensorRTBuilder::AllocateDeviceBuffer(nvinfer1::ICudaEngine* engine, const
     ICHECK_NE(binding_index, -1);
     std::vector<int64_t> shape(data_entry_[entry_id]->shape,
                                data_entry_[entry_id]->shape + data_entry_[entry_id]->ndim);
+    // An implicit batch engine runs any batch up to the one it is built for.
+    if (use_implicit_batch_ && !shape.empty()) {
+      shape[0] = std::max<int64_t>(shape[0], batch_size_);
+    }
     device_buffers->at(binding_index) =
         runtime::NDArray::Empty(shape, data_entry_[entry_id]->dtype, {kDLCUDA, 0});
   }
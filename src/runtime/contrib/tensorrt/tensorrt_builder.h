@@ -71,7 +71,8 @@ class TensorRTBuilder {
    * \param max_workspace_size Workspace size parameter for TensorRT engine build phase.
    * \param use_implicit_batch Whether to use implicit batch mode (default)
    * \param use_fp16 Whether to use implicit batch mode (default)
-   * \param batch_size If use_implicit_batch,
+   * \param batch_size If use_implicit_batch, the largest batch size the engine runs, the I/O
+   * buffers on the GPU are allocated for it.
    */
   TensorRTBuilder(TensorRTLogger* logger, const std::vector<const DLTensor*>& data_entry,
                   size_t max_workspace_size, bool use_implicit_batch, bool use_fp16,
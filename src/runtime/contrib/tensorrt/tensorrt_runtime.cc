@@ -26,7 +26,13 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #include "../../file_utils.h"
 #include "../json/json_node.h"
@@ -64,6 +70,7 @@ class TensorRTRuntime : public JSONRuntimeBase {
                            const Array<String>& const_names)
       : JSONRuntimeBase(symbol_name, graph_json, const_names),
         use_implicit_batch_(true),
+        max_batch_size_(0),
         max_workspace_size_(size_t(1) << 30) {}
 
   /*!
@@ -83,7 +90,8 @@ class TensorRTRuntime : public JSONRuntimeBase {
     ICHECK_EQ(consts.size(), const_idx_.size())
         << "The number of input constants must match the number of required.";
     LoadGlobalAttributes();
-    if (GetCachedEnginesFromDisk()) return;
+    // The constants are only read when an engine is built, the engines of the batch sizes are
+    // loaded from the disk cache as they are needed.
     SetupConstants(consts);
   }
 
@@ -103,9 +111,10 @@ class TensorRTRuntime : public JSONRuntimeBase {
           max_workspace_size_ =
               std::stoul(nodes_[i].GetAttr<std::vector<std::string>>("max_workspace_size")[0]);
         }
-        return;
+        break;
       }
     }
+    max_batch_size_ = dmlc::GetEnv("TVM_TENSORRT_MAX_BATCH_SIZE", 0);
   }
 
 #ifdef TVM_GRAPH_EXECUTOR_TENSORRT
@@ -120,9 +129,8 @@ class TensorRTRuntime : public JSONRuntimeBase {
   /*! \brief Run inference using built engine. */
   void Run() override {
     BuildEngine();
-    batch_size_ = data_entry_[input_var_eid_[0]]->shape[0];
     if (batch_size_ == 0) return;
-    auto& engine_and_context = trt_engine_cache_.at(std::make_pair(symbol_name_, batch_size_));
+    auto& engine_and_context = FindEngine(batch_size_)->second;
     auto engine = engine_and_context.engine;
     auto context = engine_and_context.context;
     auto& device_buffers = engine_and_context.device_buffers;
@@ -138,7 +146,8 @@ class TensorRTRuntime : public JSONRuntimeBase {
           if (data_entry_[eid]->device.device_type == kDLCUDA) {
             bindings[binding_index] = data_entry_[eid]->data;
           } else {
-            device_buffers[binding_index].CopyFrom(data_entry_[eid]);
+            GetBufferView(device_buffers[binding_index], data_entry_[eid])
+                .CopyFrom(data_entry_[eid]);
             bindings[binding_index] = device_buffers[binding_index]->data;
           }
         }
@@ -174,130 +183,261 @@ class TensorRTRuntime : public JSONRuntimeBase {
       int binding_index = engine->getBindingIndex(name.c_str());
       ICHECK_NE(binding_index, -1);
       if (data_entry_[eid]->device.device_type != kDLCUDA) {
-        device_buffers[binding_index].CopyTo(const_cast<DLTensor*>(data_entry_[eid]));
+        GetBufferView(device_buffers[binding_index], data_entry_[eid])
+            .CopyTo(const_cast<DLTensor*>(data_entry_[eid]));
       }
     }
   }
 
  private:
+  using EngineCache =
+      std::unordered_map<std::pair<std::string, int>, TensorRTEngineAndContext, PairHash>;
+
   /*!
-   * \brief Build TensorRT engine from JSON representation and cache it. If engine is already built,
-   * do nothing.
+   * \brief Whether an engine built for a batch size also runs the smaller ones. This is the case
+   * of an implicit batch engine, as long as the batch is the first dim of every input.
    */
-  void BuildEngine() {
-    batch_size_ =
-        data_entry_[input_var_eid_[0]]->ndim == 0 ? 1 : data_entry_[input_var_eid_[0]]->shape[0];
-    if (trt_engine_cache_.count(std::make_pair(symbol_name_, batch_size_))) return;
-    DLOG(INFO) << "Building new TensorRT engine for subgraph " << symbol_name_
-               << " with batch size " << batch_size_;
-    const bool use_fp16 = dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false);
-    TensorRTBuilder builder(&logger_, data_entry_, max_workspace_size_, use_implicit_batch_,
-                            use_fp16, batch_size_);
-
-    // Add inputs and constants.
+  bool RunsSmallerBatches() {
+    if (!use_implicit_batch_) return false;
     for (size_t i = 0; i < input_nodes_.size(); ++i) {
       auto nid = input_nodes_[i];
-      const auto& node = nodes_[nid];
-      std::string name = node.GetOpName();
-      if (node.GetOpType() == "input") {
-        builder.AddInput(nid, EntryID(nid, 0), node);
-      } else {
-        ICHECK_EQ(node.GetOpType(), "const");
-        uint32_t eid = EntryID(nid, 0);
-        builder.AddConstant(nid, data_entry_[eid]);
+      if (nodes_[nid].GetOpType() != "input") continue;
+      for (const auto& shape : nodes_[nid].GetOpShape()) {
+        if (shape.size() <= 1) return false;
       }
     }
+    return true;
+  }
 
-    // Add layers.
-    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
-      const auto& node = nodes_[nid];
-      if (node.GetOpType() != "kernel") continue;
-      builder.AddLayer(nid, node);
+  /*! \brief Find the engine running a batch size, or the end of the cache if none is built. */
+  EngineCache::iterator FindEngine(int batch_size) {
+    auto it = trt_engine_cache_.find(std::make_pair(symbol_name_, batch_size));
+    if (it != trt_engine_cache_.end() || !RunsSmallerBatches()) return it;
+    // The engine of the smallest batch size at least as large.
+    for (auto jt = trt_engine_cache_.begin(); jt != trt_engine_cache_.end(); ++jt) {
+      if (jt->first.first == symbol_name_ && jt->first.second >= batch_size &&
+          (it == trt_engine_cache_.end() || jt->first.second < it->first.second)) {
+        it = jt;
+      }
     }
+    return it;
+  }
 
-    // Add outputs.
-    for (size_t i = 0; i < outputs_.size(); ++i) {
-      builder.AddOutput(outputs_[i], EntryID(outputs_[i]));
+  /*! \brief The view of the GPU buffer of an engine with the shape of a TVM input or output. */
+  NDArray GetBufferView(NDArray buffer, const DLTensor* tensor) {
+    if (buffer->ndim == tensor->ndim &&
+        std::equal(tensor->shape, tensor->shape + tensor->ndim, buffer->shape)) {
+      return buffer;
     }
+    std::vector<int64_t> shape(tensor->shape, tensor->shape + tensor->ndim);
+    return buffer.CreateView(shape, tensor->dtype);
+  }
 
-    // Build engine.
-    trt_engine_cache_[std::make_pair(symbol_name_, batch_size_)] = builder.BuildEngine();
-    DLOG(INFO) << "Finished building TensorRT engine for subgraph " << symbol_name_
-               << " with batch size " << batch_size_;
-    CacheEngineToDisk();
+  /*!
+   * \brief Build TensorRT engine from JSON representation and cache it. If an engine running the
+   * batch size is already built, or cached on disk, do nothing else.
+   *
+   * With TVM_TENSORRT_MAX_BATCH_SIZE, an implicit batch engine is built for the given size and
+   * runs all the batch sizes up to it. Without it, an engine is built for the batch size when
+   * no engine runs it, and replaces the engines of the smaller batch sizes it also runs.
+   */
+  void BuildEngine() {
+    batch_size_ =
+        data_entry_[input_var_eid_[0]]->ndim == 0 ? 1 : data_entry_[input_var_eid_[0]]->shape[0];
+    if (batch_size_ == 0 || FindEngine(batch_size_) != trt_engine_cache_.end()) return;
+    const bool runs_smaller_batches = RunsSmallerBatches();
+    const int engine_batch_size =
+        runs_smaller_batches ? std::max(batch_size_, max_batch_size_) : batch_size_;
+    if (!GetCachedEngineFromDisk(engine_batch_size)) {
+      DLOG(INFO) << "Building new TensorRT engine for subgraph " << symbol_name_
+                 << " with batch size " << engine_batch_size;
+      const bool use_fp16 = dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false);
+      TensorRTBuilder builder(&logger_, data_entry_, max_workspace_size_, use_implicit_batch_,
+                              use_fp16, engine_batch_size);
+
+      // Add inputs and constants.
+      for (size_t i = 0; i < input_nodes_.size(); ++i) {
+        auto nid = input_nodes_[i];
+        const auto& node = nodes_[nid];
+        std::string name = node.GetOpName();
+        if (node.GetOpType() == "input") {
+          builder.AddInput(nid, EntryID(nid, 0), node);
+        } else {
+          ICHECK_EQ(node.GetOpType(), "const");
+          uint32_t eid = EntryID(nid, 0);
+          builder.AddConstant(nid, data_entry_[eid]);
+        }
+      }
+
+      // Add layers.
+      for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+        const auto& node = nodes_[nid];
+        if (node.GetOpType() != "kernel") continue;
+        builder.AddLayer(nid, node);
+      }
+
+      // Add outputs.
+      for (size_t i = 0; i < outputs_.size(); ++i) {
+        builder.AddOutput(outputs_[i], EntryID(outputs_[i]));
+      }
+
+      // Build engine.
+      trt_engine_cache_[std::make_pair(symbol_name_, engine_batch_size)] = builder.BuildEngine();
+      DLOG(INFO) << "Finished building TensorRT engine for subgraph " << symbol_name_
+                 << " with batch size " << engine_batch_size;
+      CacheEngineToDisk(engine_batch_size);
+    }
+    // Drop the engines the new one replaces.
+    if (runs_smaller_batches) {
+      for (auto it = trt_engine_cache_.begin(); it != trt_engine_cache_.end();) {
+        if (it->first.first == symbol_name_ && it->first.second < engine_batch_size) {
+          it->second.context->destroy();
+          it->second.engine->destroy();
+          it = trt_engine_cache_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
   }
 
   /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will check that directory for
-   * already built TRT engines and load into trt_engine_cache_ so they don't
+   * an already built TRT engine of a batch size and load it into trt_engine_cache_ so it doesn't
    * have to be built at first inference.
+   * \return Whether the engine is loaded.
    */
-  bool GetCachedEnginesFromDisk() {
+  bool GetCachedEngineFromDisk(int batch_size) {
     std::string cache_dir = dmlc::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
     if (cache_dir.empty()) return false;
-    std::string key = GetSubgraphKey();
+    std::string key = GetSubgraphKey(batch_size);
     std::string path = cache_dir + "/" + key + ".plan";
+    std::string meta_path = cache_dir + "/" + key + ".meta";
     // Check if engine is in the cache.
-    std::ifstream infile(path, std::ios::binary);
-    if (!infile.good()) return false;
+    std::ifstream infile(path, std::ios::binary), meta_infile(meta_path, std::ios::binary);
+    if (!infile.good() || !meta_infile.good()) return false;
     DLOG(INFO) << "Loading cached TensorRT engine from " << path;
     infile.close();
+    meta_infile.close();
+    // Load metadata, the engine must be of the same subgraph and TensorRT.
+    TensorRTEngineAndContext engine_and_context;
+    std::string cached_key;
+    std::string serialized_meta;
+    LoadBinaryFromFile(meta_path, &serialized_meta);
+    try {
+      std::istringstream is(serialized_meta);
+      dmlc::JSONReader reader(&is);
+      dmlc::JSONObjectReadHelper helper;
+      helper.DeclareField("key", &cached_key);
+      helper.DeclareField("inputs", &engine_and_context.inputs);
+      helper.DeclareField("outputs", &engine_and_context.outputs);
+      helper.ReadAllFields(&reader);
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Ignoring the invalid TensorRT engine metadata " << meta_path;
+      return false;
+    }
+    if (cached_key != key) return false;
     std::string serialized_engine;
     LoadBinaryFromFile(path, &serialized_engine);
     // Deserialize engine
     nvinfer1::IRuntime* runtime = nvinfer1::createInferRuntime(logger_);
-    TensorRTEngineAndContext engine_and_context;
     engine_and_context.engine =
         runtime->deserializeCudaEngine(&serialized_engine[0], serialized_engine.size(), nullptr);
+    runtime->destroy();
+    if (engine_and_context.engine == nullptr) {
+      LOG(WARNING) << "Ignoring the TensorRT engine " << path << " which failed to deserialize";
+      return false;
+    }
     engine_and_context.context = engine_and_context.engine->createExecutionContext();
-    // Load metadata
-    std::string meta_path = cache_dir + "/" + key + ".meta";
-    std::string serialized_meta;
-    LoadBinaryFromFile(meta_path, &serialized_meta);
-    std::istringstream is(serialized_meta);
-    dmlc::JSONReader reader(&is);
-    dmlc::JSONObjectReadHelper helper;
-    helper.DeclareField("inputs", &engine_and_context.inputs);
-    helper.DeclareField("outputs", &engine_and_context.outputs);
-    helper.ReadAllFields(&reader);
-    const int batch_size = 1;
+    // Allocate the GPU buffers of the TVM inputs and outputs which are on another device.
+    engine_and_context.device_buffers.resize(engine_and_context.engine->getNbBindings());
+    for (size_t i = 0; i < input_nodes_.size(); ++i) {
+      auto nid = input_nodes_[i];
+      if (nodes_[nid].GetOpType() != "input") continue;
+      for (size_t j = 0; j < nodes_[nid].GetOpShape().size(); ++j) {
+        AllocateDeviceBuffer(engine_and_context, nodes_[nid].GetOpName() + "_" + std::to_string(j),
+                             EntryID(nid, j), batch_size);
+      }
+    }
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      AllocateDeviceBuffer(engine_and_context, engine_and_context.outputs[i], EntryID(outputs_[i]),
+                           batch_size);
+    }
     trt_engine_cache_[std::make_pair(symbol_name_, batch_size)] = engine_and_context;
     return true;
   }
 
-  /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will save the engine to that
+  /*! \brief Allocate the GPU buffer of a binding of a loaded engine, as the builder does. */
+  void AllocateDeviceBuffer(TensorRTEngineAndContext& engine_and_context, const std::string& name,
+                            uint32_t eid, int batch_size) {
+    if (data_entry_[eid]->device.device_type == kDLCUDA) return;
+    int binding_index = engine_and_context.engine->getBindingIndex(name.c_str());
+    ICHECK_NE(binding_index, -1);
+    std::vector<int64_t> shape(data_entry_[eid]->shape,
+                               data_entry_[eid]->shape + data_entry_[eid]->ndim);
+    if (use_implicit_batch_ && !shape.empty()) {
+      shape[0] = std::max<int64_t>(shape[0], batch_size);
+    }
+    engine_and_context.device_buffers[binding_index] =
+        NDArray::Empty(shape, data_entry_[eid]->dtype, {kDLCUDA, 0});
+  }
+
+  /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will save the engine of a batch size to that
    * directory so it can be loaded later.
    */
-  void CacheEngineToDisk() {
-    batch_size_ = data_entry_[input_var_eid_[0]]->shape[0];
+  void CacheEngineToDisk(int batch_size) {
     std::string cache_dir = dmlc::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
     if (cache_dir.empty()) return;
-    std::string key = GetSubgraphKey();
+    std::string key = GetSubgraphKey(batch_size);
     std::string path = cache_dir + "/" + key + ".plan";
     DLOG(INFO) << "Caching TensorRT engine to " << path;
+    const auto& engine_and_context = trt_engine_cache_.at(std::make_pair(symbol_name_, batch_size));
     // Serialize engine to disk
-    nvinfer1::IHostMemory* serialized_engine =
-        trt_engine_cache_[std::make_pair(symbol_name_, batch_size_)].engine->serialize();
-    SaveBinaryToFile(path, std::string(static_cast<const char*>(serialized_engine->data()),
-                                       serialized_engine->size()));
+    nvinfer1::IHostMemory* serialized_engine = engine_and_context.engine->serialize();
+    SaveFileAtomically(path, std::string(static_cast<const char*>(serialized_engine->data()),
+                                         serialized_engine->size()));
     serialized_engine->destroy();
-    // Serialize metadata
+    // Serialize metadata, written last so that a complete engine is only found with it.
     std::ostringstream os;
     dmlc::JSONWriter writer(&os);
     writer.BeginObject();
-    writer.WriteObjectKeyValue("inputs",
-                               trt_engine_cache_[std::make_pair(symbol_name_, batch_size_)].inputs);
-    writer.WriteObjectKeyValue(
-        "outputs", trt_engine_cache_[std::make_pair(symbol_name_, batch_size_)].outputs);
+    writer.WriteObjectKeyValue("key", key);
+    writer.WriteObjectKeyValue("inputs", engine_and_context.inputs);
+    writer.WriteObjectKeyValue("outputs", engine_and_context.outputs);
     writer.EndObject();
     std::string meta_path = cache_dir + "/" + key + ".meta";
-    SaveBinaryToFile(meta_path, os.str());
+    SaveFileAtomically(meta_path, os.str());
+  }
+
+  /*! \brief Save a file through a temporary one, so that concurrent readers never see a part. */
+  void SaveFileAtomically(const std::string& path, const std::string& data) {
+    std::string tmp_path =
+        path + ".tmp" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count() ^
+                       reinterpret_cast<uintptr_t>(this));
+    SaveBinaryToFile(tmp_path, data);
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      LOG(WARNING) << "Failed to save the TensorRT engine cache file " << path;
+      std::remove(tmp_path.c_str());
+    }
   }
 
-  std::string GetSubgraphKey() {
-    // Using this key will only allow a single model per TVM_TENSORRT_CACHE_DIR directory. We could
-    // instead use a hash of graph_json and all weights to allow many models in the same directory,
-    // but the cost of computing the hash is high.
-    return symbol_name_ + (dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false) ? "_fp16" : "_fp32");
+  /*!
+   * \brief The key of the cached engine of a batch size. It identifies the subgraph by the hash
+   * of its JSON, and the TensorRT version the engine is only valid with. The weights are not
+   * hashed, the cost of hashing them is high: the cache of a model must be cleared when its
+   * weights change.
+   */
+  std::string GetSubgraphKey(int batch_size) {
+    // The 64-bit FNV-1a hash, stable across the builds unlike std::hash.
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : graph_json_) {
+      hash = (hash ^ c) * 1099511628211ULL;
+    }
+    std::ostringstream os;
+    os << symbol_name_ << "_" << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec
+       << "_trt" << NV_TENSORRT_MAJOR << "." << NV_TENSORRT_MINOR << "." << NV_TENSORRT_PATCH
+       << (dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false) ? "_fp16" : "_fp32") << "_b" << batch_size;
+    return os.str();
   }
 
   /*! \brief Get the batch size when in implicit_batch mode. */
@@ -313,14 +453,13 @@ class TensorRTRuntime : public JSONRuntimeBase {
     return -1;
   }
 
-  /*! \brief Map of function name to TRT engine if built already. */
-  std::unordered_map<std::pair<std::string, int>, TensorRTEngineAndContext, PairHash>
-      trt_engine_cache_;
+  /*! \brief Map of function name and batch size to TRT engine if built already. */
+  EngineCache trt_engine_cache_;
 
   /*! \brief TensorRT logger. */
   TensorRTLogger logger_;
 
-  /*! \brief Batch size that the engine is optimized for. */
+  /*! \brief Batch size of the current inference. */
   int batch_size_;
 
 #else
@@ -334,13 +473,13 @@ class TensorRTRuntime : public JSONRuntimeBase {
                  << "Please build with USE_TENSORRT_RUNTIME.";
   }
 
-  bool GetCachedEnginesFromDisk() { return false; }
-
-  void CacheEngineToDisk() {}
 #endif
 
   bool use_implicit_batch_;
 
+  /*! \brief The batch size of the implicit batch engines, TVM_TENSORRT_MAX_BATCH_SIZE. */
+  int max_batch_size_;
+
   size_t max_workspace_size_;
 };
 
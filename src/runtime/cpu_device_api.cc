@@ -24,18 +24,56 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include "workspace_pool.h"
 
 #ifdef __ANDROID__
 #include <android/api-level.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace tvm {
 namespace runtime {
+
+/*! \brief The allocations from this size on are placed on the NUMA node of their thread. */
+constexpr size_t kNumaLocalMinBytes = 1 << 20;
+
+/*!
+ * \brief Prefer the NUMA node of the calling thread for the pages of a large allocation,
+ *  which are otherwise placed on the node of the thread that first touches them. Set
+ *  TVM_NUMA_LOCAL_ALLOC=0 to disable it.
+ */
+static void PreferLocalNumaNode(void* ptr, size_t nbytes) {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+  static const bool enabled = [] {
+    const char* val = getenv("TVM_NUMA_LOCAL_ALLOC");
+    return threading::NumNumaNodes() > 1 && (val == nullptr || atoi(val) != 0);
+  }();
+  if (!enabled || nbytes < kNumaLocalMinBytes) return;
+  // Only the whole pages of the allocation are bound
+  uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) / page * page;
+  uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + nbytes) / page * page;
+  if (begin >= end) return;
+  constexpr int kBits = sizeof(unsigned long) * 8;  // NOLINT(*)
+  int node = threading::CurrentNumaNode();
+  std::vector<unsigned long> mask(node / kBits + 1, 0);  // NOLINT(*)
+  mask[node / kBits] |= 1UL << (node % kBits);
+  // A failure leaves the default policy, the allocation stays valid
+  syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, mask.data(), mask.size() * kBits + 1, 0);
+#endif
+}
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(Device dev) final {}
@@ -57,6 +95,7 @@ class CPUDeviceAPI final : public DeviceAPI {
     int ret = posix_memalign(&ptr, alignment, nbytes);
     if (ret != 0) throw std::bad_alloc();
 #endif
+    PreferLocalNumaNode(ptr, nbytes);
     return ptr;
   }
 
@@ -92,12 +131,18 @@ struct CPUWorkspacePool : public WorkspacePool {
   CPUWorkspacePool() : WorkspacePool(kDLCPU, CPUDeviceAPI::Global()) {}
 };
 
+// The pool of the calling thread, cached to skip the thread local store on every kernel call.
+static CPUWorkspacePool* ThreadWorkspacePool() {
+  static thread_local CPUWorkspacePool* pool = dmlc::ThreadLocalStore<CPUWorkspacePool>::Get();
+  return pool;
+}
+
 void* CPUDeviceAPI::AllocWorkspace(Device dev, size_t size, DLDataType type_hint) {
-  return dmlc::ThreadLocalStore<CPUWorkspacePool>::Get()->AllocWorkspace(dev, size);
+  return ThreadWorkspacePool()->AllocWorkspace(dev, size);
 }
 
 void CPUDeviceAPI::FreeWorkspace(Device dev, void* data) {
-  dmlc::ThreadLocalStore<CPUWorkspacePool>::Get()->FreeWorkspace(dev, data);
+  ThreadWorkspacePool()->FreeWorkspace(dev, data);
 }
 
 TVM_REGISTER_GLOBAL("device_api.cpu").set_body([](TVMArgs args, TVMRetValue* rv) {
@@ -454,6 +454,9 @@ typedef struct {
   int number;
   int repeat;
   int min_repeat_ms;
+  // The steady state options of the host time evaluator, max_repeat is 0 when not given.
+  int max_repeat;
+  double cv_threshold;
 } time_evaluator_state_t;
 
 static time_evaluator_state_t g_time_evaluator_state;
@@ -472,6 +475,14 @@ int RPCTimeEvaluator(TVMValue* args, int* type_codes, int num_args, TVMValue* re
     TVMAPIErrorf("one or more invalid arg types");
     return kTvmErrorFunctionCallWrongArgType;
   }
+  // The options after f_preproc: max_repeat, cv_threshold, cache_flush_bytes and
+  // check_cpu_frequency. The last two concern the caches and clocks of host CPUs, and are
+  // ignored.
+  if ((num_args > 8 && type_codes[8] != kTVMArgInt) ||
+      (num_args > 9 && type_codes[9] != kTVMArgFloat)) {
+    TVMAPIErrorf("one or more invalid option types");
+    return kTvmErrorFunctionCallWrongArgType;
+  }
 
   TVMModuleHandle mod = (TVMModuleHandle)args[0].v_handle;
   const char* name = args[1].v_str;
@@ -480,6 +491,8 @@ int RPCTimeEvaluator(TVMValue* args, int* type_codes, int num_args, TVMValue* re
   g_time_evaluator_state.number = args[4].v_int64;
   g_time_evaluator_state.repeat = args[5].v_int64;
   g_time_evaluator_state.min_repeat_ms = args[6].v_int64;
+  g_time_evaluator_state.max_repeat = num_args > 8 ? args[8].v_int64 : 0;
+  g_time_evaluator_state.cv_threshold = num_args > 9 ? args[9].v_float64 : 0.05;
 
   int ret_code =
       TVMModGetFunction(mod, name, /* query_imports */ 0, &g_time_evaluator_state.func_to_time);
@@ -494,6 +507,31 @@ int RPCTimeEvaluator(TVMValue* args, int* type_codes, int num_args, TVMValue* re
   return kTvmErrorNoError;
 }
 
+/*!
+ * \brief Check whether the last costs stopped drifting.
+ *
+ * \param costs The last `num_costs` costs, in any order.
+ * \param num_costs The number of costs.
+ * \param cv_threshold The largest coefficient of variation of a steady state, the standard
+ *  deviation relative to the mean.
+ */
+static bool IsSteadyState(const double* costs, int num_costs, double cv_threshold) {
+  double mean = 0;
+  for (int i = 0; i < num_costs; i++) {
+    mean += costs[i];
+  }
+  mean /= num_costs;
+  if (num_costs < 2 || mean <= 0) {
+    return true;
+  }
+  double sq_sum = 0;
+  for (int i = 0; i < num_costs; i++) {
+    sq_sum += (costs[i] - mean) * (costs[i] - mean);
+  }
+  // Compare the squares, which spares the square root.
+  return sq_sum / (num_costs - 1) <= cv_threshold * cv_threshold * mean * mean;
+}
+
 tvm_crt_error_t RunTimeEvaluator(tvm_function_index_t function_index, TVMValue* args,
                                  int* type_codes, int num_args, TVMValue* ret_val,
                                  int* ret_type_code) {
@@ -510,43 +548,86 @@ tvm_crt_error_t RunTimeEvaluator(tvm_function_index_t function_index, TVMValue*
     goto release_and_return;
   }
   result_byte_arr->data = NULL;
-  size_t data_size = sizeof(double) * g_time_evaluator_state.repeat;
+  int repeat = g_time_evaluator_state.repeat > 0 ? g_time_evaluator_state.repeat : 0;
+  size_t data_size = sizeof(double) * repeat;
   err = TVMPlatformMemoryAllocate(data_size, result_byte_dev, (void*)&result_byte_arr->data);
   if (err != kTvmErrorNoError) {
     goto release_and_return;
   }
   result_byte_arr->size = data_size;
+
+  // Without repeats there is nothing to time, and the ring buffer of the costs is empty.
+  if (repeat == 0) {
+    *ret_type_code = kTVMBytes;
+    ret_val->v_handle = result_byte_arr;
+    return err;
+  }
+
+  // Skip the first call, as the host time evaluator does, so that the costs leave out lazy
+  // initialization and cold caches.
+  err = TVMFuncCall(g_time_evaluator_state.func_to_time, args, type_codes, num_args, ret_val,
+                    ret_type_code);
+  if (err != kTvmErrorNoError) {
+    goto release_and_return;
+  }
+
+  // The costs of the last `repeat` repeats, from the repeat `num_repeats % repeat` on.
+  double* costs = (double*)result_byte_arr->data;
   double min_repeat_seconds = ((double)g_time_evaluator_state.min_repeat_ms) / 1000;
-  double* iter = (double*)result_byte_arr->data;
-  for (int i = 0; i < g_time_evaluator_state.repeat; i++) {
+  int max_repeat = g_time_evaluator_state.max_repeat > repeat ? g_time_evaluator_state.max_repeat
+                                                              : repeat;
+  int number = g_time_evaluator_state.number;
+  int num_repeats = 0;
+  while (num_repeats < max_repeat) {
     double repeat_res_seconds = 0.0;
-    int exec_count = 0;
+    int num_attempts = 0;
     // do-while structure ensures we run even when `min_repeat_ms` isn't set (i.e., is 0).
     do {
+      // Grow the runs of a repeat short of `min_repeat_ms` to about the time needed, as the
+      // host time evaluator does, so that a repeat is timed as one batch.
+      if (num_attempts > 0 && repeat_res_seconds > 0.0) {
+        double needed = min_repeat_seconds / (repeat_res_seconds / number) + 1;
+        double grown = needed > number * 1.618 ? needed : number * 1.618;
+        number = grown < INT32_MAX ? (int)grown : INT32_MAX;
+      } else if (num_attempts > 0) {
+        // The runs were too short for the resolution of the timer.
+        number *= 2;
+      }
+      num_attempts++;
+
       err = TVMPlatformTimerStart();
       if (err != kTvmErrorNoError) {
         goto release_and_return;
       }
 
-      for (int j = 0; j < g_time_evaluator_state.number; j++) {
+      for (int j = 0; j < number; j++) {
         err = TVMFuncCall(g_time_evaluator_state.func_to_time, args, type_codes, num_args, ret_val,
                           ret_type_code);
         if (err != kTvmErrorNoError) {
           goto release_and_return;
         }
       }
-      exec_count += g_time_evaluator_state.number;
 
-      double curr_res_seconds;
-      err = TVMPlatformTimerStop(&curr_res_seconds);
+      err = TVMPlatformTimerStop(&repeat_res_seconds);
       if (err != kTvmErrorNoError) {
         goto release_and_return;
       }
-      repeat_res_seconds += curr_res_seconds;
     } while (repeat_res_seconds < min_repeat_seconds);
-    double mean_exec_seconds = repeat_res_seconds / exec_count;
-    *iter = mean_exec_seconds;
-    iter++;
+    costs[num_repeats % repeat] = repeat_res_seconds / number;
+    num_repeats++;
+    // Stop at the steady state, when the last `repeat` costs stopped drifting.
+    if (max_repeat > repeat && num_repeats >= repeat &&
+        IsSteadyState(costs, repeat, g_time_evaluator_state.cv_threshold)) {
+      break;
+    }
+  }
+  // Rotate the costs back into the order of the repeats.
+  for (int shift = num_repeats % repeat; num_repeats > repeat && shift > 0; shift--) {
+    double first = costs[0];
+    for (int i = 0; i < repeat - 1; i++) {
+      costs[i] = costs[i + 1];
+    }
+    costs[repeat - 1] = first;
   }
 
   *ret_type_code = kTVMBytes;
@@ -554,10 +635,16 @@ tvm_crt_error_t RunTimeEvaluator(tvm_function_index_t function_index, TVMValue*
   return err;
 
 release_and_return : {
-  tvm_crt_error_t release_err =
-      TVMPlatformMemoryFree((void*)&result_byte_arr->data, result_byte_dev);
-  if (release_err != kTvmErrorNoError) {
-    release_err = TVMPlatformMemoryFree((void*)&result_byte_arr, result_byte_dev);
+  tvm_crt_error_t release_err = kTvmErrorNoError;
+  if (result_byte_arr != NULL) {
+    if (result_byte_arr->data != NULL) {
+      release_err = TVMPlatformMemoryFree((void*)result_byte_arr->data, result_byte_dev);
+    }
+    tvm_crt_error_t arr_release_err =
+        TVMPlatformMemoryFree((void*)result_byte_arr, result_byte_dev);
+    if (release_err == kTvmErrorNoError) {
+      release_err = arr_release_err;
+    }
   }
 
   if (err == kTvmErrorNoError && release_err != kTvmErrorNoError) {
@@ -65,7 +65,9 @@ int TVMNDArray_Empty(int32_t ndim, const tvm_index_t* shape, DLDataType dtype, D
   return 0;
 }
 
-int TVMNDArray_Load(TVMNDArray* ret, const char** strm) {
+// Read the header of an array, leaving the stream at its data.
+static int TVMNDArray_ReadHeader(const char** strm, int* ndim, int64_t* shape, DLDataType* dtype,
+                                 int64_t* data_byte_size) {
   int32_t status = 0;
   uint64_t header, reserved;
   memcpy(&header, *strm, sizeof(header));
@@ -77,53 +79,87 @@ int TVMNDArray_Load(TVMNDArray* ret, const char** strm) {
   memcpy(&reserved, *strm, sizeof(reserved));
   *strm += sizeof(reserved);
   DLDevice dev;
-  int ndim;  // sizeof ndim should match dlpack
-  DLDataType dtype;
   memcpy(&dev, *strm, sizeof(dev));
   *strm += sizeof(dev);
-  memcpy(&ndim, *strm, sizeof(ndim));
-  *strm += sizeof(ndim);
-  memcpy(&dtype, *strm, sizeof(dtype));
-  *strm += sizeof(dtype);
-  if ((ndim < 0) || (ndim > TVM_CRT_MAX_NDIM)) {
-    fprintf(stderr, "Invalid ndim=%d: expected to be 0 ~ %d.\n", ndim, TVM_CRT_MAX_NDIM);
-    status = -1;
+  memcpy(ndim, *strm, sizeof(*ndim));
+  *strm += sizeof(*ndim);
+  memcpy(dtype, *strm, sizeof(*dtype));
+  *strm += sizeof(*dtype);
+  if ((*ndim < 0) || (*ndim > TVM_CRT_MAX_NDIM)) {
+    fprintf(stderr, "Invalid ndim=%d: expected to be 0 ~ %d.\n", *ndim, TVM_CRT_MAX_NDIM);
+    return -1;
   }
   if (dev.device_type != kDLCPU) {
     fprintf(stderr, "Invalid DLTensor device: can only save as CPU tensor\n");
     status = -1;
   }
-  int64_t shape[TVM_CRT_MAX_NDIM] = {0};
   int32_t idx;
-  if (ndim != 0) {
-    for (idx = 0; idx < ndim; idx++) {
-      memcpy(&shape[idx], *strm, sizeof(int64_t));
-      *strm += sizeof(shape[idx]);
-    }
-  }
-  status = TVMNDArray_Empty(ndim, shape, dtype, dev, ret);
-  if (status != 0) {
-    return status;
-  }
   int64_t num_elems = 1;
-  int elem_bytes = (ret->dl_tensor.dtype.bits + 7) / 8;
-  for (idx = 0; idx < ret->dl_tensor.ndim; ++idx) {
-    num_elems *= ret->dl_tensor.shape[idx];
+  for (idx = 0; idx < *ndim; idx++) {
+    memcpy(&shape[idx], *strm, sizeof(int64_t));
+    *strm += sizeof(shape[idx]);
+    num_elems *= shape[idx];
   }
-  int64_t data_byte_size;
-  memcpy(&data_byte_size, *strm, sizeof(data_byte_size));
-  *strm += sizeof(data_byte_size);
-  if (!(data_byte_size == num_elems * elem_bytes)) {
+  int elem_bytes = (dtype->bits + 7) / 8;
+  memcpy(data_byte_size, *strm, sizeof(*data_byte_size));
+  *strm += sizeof(*data_byte_size);
+  if (!(*data_byte_size == num_elems * elem_bytes)) {
     fprintf(stderr,
             "invalid DLTensor file format: data_byte_size=%d, "
             "while num_elems*elem_bytes=%d\n",
-            (int)data_byte_size, (int)(num_elems * elem_bytes));  // NOLINT(*)
+            (int)*data_byte_size, (int)(num_elems * elem_bytes));  // NOLINT(*)
     status = -1;
   }
+  // The reserved field is the padding before the data
+  *strm += reserved;
+  return status;
+}
+
+int TVMNDArray_Load(TVMNDArray* ret, const char** strm) {
+  int ndim;
+  int64_t shape[TVM_CRT_MAX_NDIM] = {0};
+  DLDataType dtype;
+  int64_t data_byte_size;
+  int32_t status = TVMNDArray_ReadHeader(strm, &ndim, shape, &dtype, &data_byte_size);
+  if (status != 0) {
+    return status;
+  }
+  DLDevice dev = {kDLCPU, 0};
+  status = TVMNDArray_Empty(ndim, shape, dtype, dev, ret);
+  if (status != 0) {
+    return status;
+  }
   memcpy(ret->dl_tensor.data, *strm, data_byte_size);
   *strm += data_byte_size;
+  return 0;
+}
 
-  return status;
+int TVMNDArray_LoadInPlace(TVMNDArray* ret, const char** strm) {
+  int ndim;
+  int64_t shape[TVM_CRT_MAX_NDIM] = {0};
+  DLDataType dtype;
+  int64_t data_byte_size;
+  int32_t status = TVMNDArray_ReadHeader(strm, &ndim, shape, &dtype, &data_byte_size);
+  if (status != 0) {
+    return status;
+  }
+  uintptr_t align = (dtype.bits * dtype.lanes + 7) / 8;
+  if (align > 8) {
+    align = 8;
+  }
+  if (align > 1 && ((uintptr_t)*strm % align) != 0) {
+    fprintf(stderr, "DLTensor data at %p is not aligned to %d bytes, save the params aligned\n",
+            *strm, (int)align);
+    return -1;
+  }
+  DLDevice dev = {kDLCPU, 0};
+  status = TVMNDArray_Create(ndim, shape, dtype, dev, ret);
+  if (status != 0) {
+    return status;
+  }
+  ret->dl_tensor.data = (void*)*strm;
+  *strm += data_byte_size;
+  return 0;
 }
 
 int TVMNDArray_CreateView(TVMNDArray* arr, const tvm_index_t* shape, int32_t ndim, DLDataType dtype,
@@ -39,6 +39,10 @@
 /*! Maximum packet size, in bytes, including the length header. */
 #define TVM_CRT_MAX_PACKET_SIZE_BYTES 2048
 
+/*! Bytes of RPC messages the transport buffers while the device processes one, so the host
+ * sends them without waiting for each reply. Undefined to take one message at a time. */
+// #define TVM_CRT_RPC_RECEIVE_WINDOW_BYTES 1024
+
 /*! Maximum supported string length in dltype, e.g. "int8", "int16", "float32" */
 #define TVM_CRT_MAX_STRLEN_DLTYPE 10
 
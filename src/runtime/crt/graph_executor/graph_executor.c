@@ -25,6 +25,7 @@
  */
 
 #include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/crt/graph_binary.h>
 #include <tvm/runtime/crt/internal/graph_executor/graph_executor.h>
 #include <tvm/runtime/crt/logging.h>
 #include <tvm/runtime/crt/module.h>
@@ -233,6 +234,8 @@ int TVMGraphExecutorGraphAttr_Load(TVMGraphExecutorGraphAttr* attr, JSONReader*
   uint32_t dltype_count = 0;
   uint32_t shape_count = 0;
   uint32_t device_index_count = 0;
+  uint32_t storage_offset_count = 0;
+  attr->shape_stride = TVM_CRT_MAX_NDIM;
   reader->BeginObject(reader);
   while (reader->NextObjectItem(reader, key, sizeof(key))) {
     if (!strcmp(key, "dltype")) {
@@ -472,6 +475,58 @@ int TVMGraphExecutorGraphAttr_Load(TVMGraphExecutorGraphAttr* attr, JSONReader*
         status = -1;
         break;
       }
+    } else if (!strcmp(key, "storage_offset")) {
+      reader->BeginArray(reader);
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      status = reader->ReadString(reader, type, sizeof(type));
+      if (status != 0) {
+        fprintf(stderr, "error reading storage_offset array item");
+        break;
+      }
+      if (strcmp(type, "list_int")) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      if (!(reader->NextArrayItem(reader))) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
+      reader->BeginArray(reader);
+      size_t num_items = 0;
+      if (reader->ArrayLength(reader, &num_items) != 0) {
+        fprintf(stderr, "error determing list_int length\n");
+        status = -1;
+        break;
+      }
+      DLDevice dev = {kDLCPU, 0};
+      tvm_crt_error_t err = TVMPlatformMemoryAllocate(sizeof(int64_t) * num_items, dev,
+                                                      (void**)&attr->storage_offset);
+      if (err != kTvmErrorNoError) {
+        fprintf(stderr, "memory allocate error: %08x", err);
+        status = -1;
+        break;
+      }
+      storage_offset_count = 0;
+      while (reader->NextArrayItem(reader)) {
+        if (storage_offset_count == num_items) {
+          fprintf(stderr, "array too big\n");
+          status = -1;
+          return status;
+        }
+        reader->ReadInteger(reader, &(attr->storage_offset[storage_offset_count]));
+        storage_offset_count++;
+      }
+      if (reader->NextArrayItem(reader)) {
+        fprintf(stderr, "Invalid json format\n");
+        status = -1;
+        break;
+      }
     } else {
       reader->BeginArray(reader);
       if (!(reader->NextArrayItem(reader))) {
@@ -517,6 +572,13 @@ int TVMGraphExecutorGraphAttr_Load(TVMGraphExecutorGraphAttr* attr, JSONReader*
     fprintf(stderr, "invalid format\n");
     status = -1;
   }
+  // The storage offsets are read for every entry when the storage is allocated.
+  if (status == 0 && attr->storage_offset != NULL &&
+      (storage_offset_count != storage_id_count || storage_offset_count != shape_count)) {
+    fprintf(stderr, "storage_offset has %u items, expected %u\n", storage_offset_count,
+            storage_id_count);
+    status = -1;
+  }
   return status;
 }
 
@@ -524,6 +586,15 @@ int TVMGraphExecutorGraphAttr_Release(TVMGraphExecutorGraphAttr* attr) {
   if (!attr) {
     return 0;
   }
+  if (attr->in_place) {
+    attr->storage_id = 0;
+    attr->device_index = 0;
+    attr->storage_offset = 0;
+    attr->dtype = 0;
+    attr->shape = 0;
+    attr->ndim = 0;
+    return 0;
+  }
   if (attr->storage_id) {
     DLDevice dev = {kDLCPU, 0};
     tvm_crt_error_t err = TVMPlatformMemoryFree(attr->storage_id, dev);
@@ -540,6 +611,14 @@ int TVMGraphExecutorGraphAttr_Release(TVMGraphExecutorGraphAttr* attr) {
       return -1;
     }
   }
+  if (attr->storage_offset) {
+    DLDevice dev = {kDLCPU, 0};
+    tvm_crt_error_t err = TVMPlatformMemoryFree(attr->storage_offset, dev);
+    attr->storage_offset = 0;
+    if (err != kTvmErrorNoError) {
+      return -1;
+    }
+  }
   if (attr->dltype) {
     DLDevice dev = {kDLCPU, 0};
     tvm_crt_error_t err = TVMPlatformMemoryFree(attr->dltype, dev);
@@ -699,7 +778,7 @@ int TVMGraphExecutor_Load(TVMGraphExecutor* executor, JSONReader* reader) {
     } else if (!strcmp(key, "attrs")) {
       status = TVMGraphExecutorGraphAttr_Load(&(executor->attrs), reader);
       if (status != 0) {
-        fprintf(stderr, "Fail to load an element in `heads` field in graph executor node.\n");
+        fprintf(stderr, "Fail to load an element in `attrs` field in graph executor.\n");
         break;
       }
       bitmask |= 16;
@@ -720,6 +799,122 @@ int TVMGraphExecutor_Load(TVMGraphExecutor* executor, JSONReader* reader) {
   return status;
 }
 
+/*!
+ * \brief Load the binary graph of graph_binary.h. The arrays of the executor that have the
+ * layout of the graph point into it, only the nodes are copied.
+ * \param executor The graph executor.
+ * \param graph The binary graph, 8-byte aligned.
+ * \return 0 on success.
+ */
+int TVMGraphExecutor_LoadBinary(TVMGraphExecutor* executor, const uint8_t* graph) {
+  const TVMGraphBinaryHeader* header = (const TVMGraphBinaryHeader*)graph;
+  if (((uintptr_t)graph & 7) != 0) {
+    fprintf(stderr, "binary graph is not 8-byte aligned\n");
+    return -1;
+  }
+  if (header->magic != TVM_GRAPH_BINARY_MAGIC || header->version != TVM_GRAPH_BINARY_VERSION) {
+    fprintf(stderr, "unsupported binary graph version %u\n", header->version);
+    return -1;
+  }
+  if (header->shape_stride > TVM_CRT_MAX_NDIM) {
+    fprintf(stderr, "binary graph has %u dims, more than TVM_CRT_MAX_NDIM\n",
+            header->shape_stride);
+    return -1;
+  }
+  uint32_t num_entries = header->num_entries;
+  const uint8_t* ptr = graph + sizeof(TVMGraphBinaryHeader);
+  const TVMGraphBinaryNode* nodes = (const TVMGraphBinaryNode*)ptr;
+  ptr += sizeof(TVMGraphBinaryNode) * header->num_nodes;
+  const TVMGraphBinaryEntry* inputs = (const TVMGraphBinaryEntry*)ptr;
+  ptr += sizeof(TVMGraphBinaryEntry) * header->num_node_inputs;
+  executor->input_nodes = (uint32_t*)ptr;
+  executor->input_nodes_count = header->num_arg_nodes;
+  ptr += sizeof(uint32_t) * header->num_arg_nodes;
+  const TVMGraphBinaryEntry* heads = (const TVMGraphBinaryEntry*)ptr;
+  ptr += sizeof(TVMGraphBinaryEntry) * header->num_heads;
+  executor->node_row_ptr = (uint32_t*)ptr;
+  executor->node_row_ptr_count = header->num_nodes + 1;
+  ptr += sizeof(uint32_t) * (header->num_nodes + 1);
+
+  TVMGraphExecutorGraphAttr* attrs = &(executor->attrs);
+  attrs->in_place = 1;
+  attrs->storage_id = (uint32_t*)ptr;
+  ptr += sizeof(uint32_t) * num_entries;
+  if (header->flags & TVM_GRAPH_BINARY_HAS_DEVICE_INDEX) {
+    attrs->device_index = (uint32_t*)ptr;
+    ptr += sizeof(uint32_t) * num_entries;
+  }
+  attrs->ndim = (uint32_t*)ptr;
+  ptr += sizeof(uint32_t) * num_entries;
+  attrs->dtype = (const DLDataType*)ptr;
+  attrs->dltype_count = num_entries;
+  ptr += sizeof(DLDataType) * num_entries;
+  ptr = graph + (ptr - graph + 7) / 8 * 8;
+  attrs->shape = (int64_t*)ptr;
+  attrs->shape_stride = header->shape_stride;
+  attrs->shape_count = num_entries;
+  ptr += sizeof(int64_t) * num_entries * header->shape_stride;
+  if (header->flags & TVM_GRAPH_BINARY_HAS_STORAGE_OFFSET) {
+    attrs->storage_offset = (int64_t*)ptr;
+    ptr += sizeof(int64_t) * num_entries;
+  }
+  const char* strings = (const char*)ptr;
+
+  DLDevice dev = {kDLCPU, 0};
+  tvm_crt_error_t err = TVMPlatformMemoryAllocate(
+      sizeof(TVMGraphExecutorNodeEntry) * header->num_heads, dev, (void**)&executor->outputs);
+  if (err != kTvmErrorNoError) {
+    fprintf(stderr, "memory allocate error: %08x", err);
+    return -1;
+  }
+  uint32_t idx, input_idx;
+  for (idx = 0; idx < header->num_heads; idx++) {
+    TVMGraphExecutorNodeEntry* entry = executor->outputs + idx;
+    memset(entry, 0, sizeof(TVMGraphExecutorNodeEntry));
+    entry->node_id = heads[idx].node_id;
+    entry->index = heads[idx].index;
+    entry->version = heads[idx].version;
+  }
+  executor->outputs_count = header->num_heads;
+
+  err = TVMPlatformMemoryAllocate(sizeof(TVMGraphExecutorNode) * header->num_nodes, dev,
+                                  (void**)&executor->nodes);
+  if (err != kTvmErrorNoError) {
+    fprintf(stderr, "memory allocate error: %08x", err);
+    return -1;
+  }
+  for (idx = 0; idx < header->num_nodes; idx++) {
+    const TVMGraphBinaryNode* bnode = nodes + idx;
+    TVMGraphExecutorNode* node = executor->nodes + idx;
+    *node = TVMGraphExecutorNodeCreate();
+    snprintf(node->op_type, sizeof(node->op_type), "%s",
+             bnode->op == TVM_GRAPH_BINARY_OP_TVM_OP ? "tvm_op" : "null");
+    snprintf(node->name, sizeof(node->name), "%s", strings + bnode->name);
+    snprintf(node->param.func_name, sizeof(node->param.func_name), "%s",
+             strings + bnode->func_name);
+    node->param.num_inputs = bnode->num_inputs;
+    node->param.num_outputs = bnode->num_outputs;
+    node->param.flatten_data = bnode->flatten_data;
+    if (bnode->num_inputs > 0) {
+      err = TVMPlatformMemoryAllocate(sizeof(TVMGraphExecutorNodeEntry) * bnode->num_inputs, dev,
+                                      (void**)&node->inputs);
+      if (err != kTvmErrorNoError) {
+        fprintf(stderr, "memory allocate error: %08x", err);
+        return -1;
+      }
+    }
+    for (input_idx = 0; input_idx < bnode->num_inputs; input_idx++) {
+      const TVMGraphBinaryEntry* input = inputs + bnode->inputs_begin + input_idx;
+      node->inputs[input_idx].node_id = input->node_id;
+      node->inputs[input_idx].index = input->index;
+      node->inputs[input_idx].version = input->version;
+    }
+    node->inputs_count = bnode->num_inputs;
+    executor->nodes_count++;
+  }
+  return 0;
+}
+
 uint32_t TVMGraphExecutor_GetEntryId(TVMGraphExecutor* executor, uint32_t nid, uint32_t index) {
   return executor->node_row_ptr[nid] + index;
 }
@@ -775,8 +970,8 @@ void TVMGraphExecutor_SetInput(TVMGraphExecutor* executor, const char* name, DLT
  * \param param_size The parameter size.
  * \return The result of this function execution.
  */
-int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_blob,
-                                const uint32_t param_size) {
+static int TVMGraphExecutor_LoadParamsImpl(TVMGraphExecutor* executor, const char* param_blob,
+                                           const uint32_t param_size, uint8_t in_place) {
   int status = 0;
   const char* bptr = param_blob;
   uint64_t header, reserved;
@@ -844,14 +1039,26 @@ int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_bl
       }
       executor->data_entry[eid].dl_tensor.shape = 0;
     }
-    if (executor->data_entry[eid].dl_tensor.data) {
-      err = TVMPlatformMemoryFree(executor->data_entry[eid].dl_tensor.data, dev);
-      if (err != kTvmErrorNoError) {
-        status = -1;
+    if (in_place) {
+      // The storage of the param is released, the entry points into the blob instead.
+      TVMGraphExecutorStorageEntry* storage =
+          &(executor->storage_pool[executor->attrs.storage_id[eid]]);
+      if (!storage->is_linked_param && !storage->is_in_arena && !storage->is_param_in_place) {
+        status |= TVMNDArray_Release(&(storage->array));
+        storage->is_param_in_place = 1;
+      }
+      status |= TVMNDArray_LoadInPlace(&(executor->data_entry[eid]), &bptr);
+      storage->array.dl_tensor.data = executor->data_entry[eid].dl_tensor.data;
+    } else {
+      if (executor->data_entry[eid].dl_tensor.data) {
+        err = TVMPlatformMemoryFree(executor->data_entry[eid].dl_tensor.data, dev);
+        if (err != kTvmErrorNoError) {
+          status = -1;
+        }
+        executor->data_entry[eid].dl_tensor.data = 0;
       }
-      executor->data_entry[eid].dl_tensor.data = 0;
+      status |= TVMNDArray_Load(&(executor->data_entry[eid]), &bptr);
     }
-    status |= TVMNDArray_Load(&(executor->data_entry[eid]), &bptr);
 #if TVM_CRT_DEBUG
     TVMNDArray* entry = &(executor->data_entry[eid]);
     printf("loading: param %s loaded, in_idx=%d, eid=%d, ndim=%d, data[0]=%f\n",
@@ -870,6 +1077,16 @@ int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_bl
   return status;
 }
 
+int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_blob,
+                                const uint32_t param_size) {
+  return TVMGraphExecutor_LoadParamsImpl(executor, param_blob, param_size, 0);
+}
+
+int TVMGraphExecutor_LoadParamsInPlace(TVMGraphExecutor* executor, const char* param_blob,
+                                       const uint32_t param_size) {
+  return TVMGraphExecutor_LoadParamsImpl(executor, param_blob, param_size, 1);
+}
+
 /*!
  * \brief Run all the operations one by one.
  * \param executor The graph executor.
@@ -911,6 +1128,54 @@ int TVMGraphExecutor_GetOutput(TVMGraphExecutor* executor, const int32_t idx, DL
   return status;
 }
 
+/*!
+ * \brief Mark the storages of the params of the blob given at creation, which point into it
+ * rather than being allocated.
+ * \param executor The graph executor.
+ * \param pool_entry The storage pool entries.
+ * \param pool_entry_count The number of storage pool entries.
+ * \return 0 on success.
+ */
+static int TVMGraphExecutor_MarkParamsInPlace(TVMGraphExecutor* executor,
+                                              TVMGraphExecutorPoolEntry* pool_entry,
+                                              uint32_t pool_entry_count) {
+  const char* bptr = executor->param_blob;
+  uint64_t header, names_count;
+  memcpy(&header, bptr, sizeof(header));
+  if (header != kTVMNDArrayListMagic) {
+    fprintf(stderr, "Invalid parameters file format");
+    return -1;
+  }
+  bptr += sizeof(header) + sizeof(uint64_t);
+  memcpy(&names_count, bptr, sizeof(names_count));
+  bptr += sizeof(names_count);
+  char name[TVM_CRT_STRLEN_NAME];
+  uint64_t idx;
+  for (idx = 0; idx < names_count; idx++) {
+    uint64_t name_length;
+    memcpy(&name_length, bptr, sizeof(name_length));
+    bptr += sizeof(name_length);
+    if (name_length >= TVM_CRT_STRLEN_NAME) {
+      fprintf(stderr, "Error: function name longer than expected.\n");
+      return -1;
+    }
+    memcpy(name, bptr, name_length);
+    name[name_length] = '\0';
+    bptr += name_length;
+    int32_t in_idx = TVMGraphExecutor_GetInputIndex(executor, name);
+    if (in_idx < 0) {
+      fprintf(stderr, "Error: param %s not found.\n", name);
+      return -1;
+    }
+    uint32_t eid = TVMGraphExecutor_GetEntryId(executor, executor->input_nodes[in_idx], 0);
+    uint32_t sid = executor->attrs.storage_id[eid];
+    if (sid < pool_entry_count) {
+      pool_entry[sid].is_param = 1;
+    }
+  }
+  return 0;
+}
+
 int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
   TVMPackedFunc lookup_linked_param;
   int lookup_linked_param_valid;
@@ -937,7 +1202,8 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
     return -1;
   }
   for (idx = 0; idx < attrs->dltype_count; idx++) {
-    vtype[idx] = String2DLDataType(attrs->dltype + idx * TVM_CRT_STRLEN_DLTYPE);
+    vtype[idx] = attrs->dtype ? attrs->dtype[idx]
+                              : String2DLDataType(attrs->dltype + idx * TVM_CRT_STRLEN_DLTYPE);
   }
 
   // Size and device type of each storage pool entry.
@@ -955,7 +1221,7 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
     int storage_id = attrs->storage_id[idx];
     // Use the fallback device if no device index is available.
     int device_type = executor->devices[0].device_type;
-    uint32_t size = Shape_Accumulate(attrs->shape + idx * TVM_CRT_MAX_NDIM, attrs->ndim[idx]);
+    uint32_t size = Shape_Accumulate(attrs->shape + idx * attrs->shape_stride, attrs->ndim[idx]);
     DLDataType t = vtype[idx];
     uint32_t bits = t.bits * t.lanes;
     size_t bytes = ((bits + 7U) / 8U) * size;
@@ -967,6 +1233,36 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
     pool_entry[sid].entry_id = idx;
     pool_entry[sid].size = MAX(pool_entry[sid].size, bytes);
     pool_entry[sid].device_type = device_type;
+    pool_entry[sid].offset = attrs->storage_offset ? attrs->storage_offset[idx] : -1;
+  }
+
+  if (executor->param_blob != NULL &&
+      TVMGraphExecutor_MarkParamsInPlace(executor, pool_entry, pool_entry_count) != 0) {
+    return -1;
+  }
+
+  // The storages planned into an arena are carved out of one buffer, given by the caller or
+  // else allocated once here.
+  size_t arena_size = 0;
+  for (idx = 0; idx < pool_entry_count; idx++) {
+    if (pool_entry[idx].offset >= 0) {
+      arena_size = MAX(arena_size, (size_t)pool_entry[idx].offset + pool_entry[idx].size);
+    }
+  }
+  if (arena_size > 0) {
+    if (executor->arena == NULL) {
+      err = TVMPlatformMemoryAllocate(arena_size, alloc_dev, (void**)&executor->arena);
+      if (err != kTvmErrorNoError) {
+        fprintf(stderr, "memory allocate error: %08x", err);
+        return -1;
+      }
+      executor->arena_size = arena_size;
+      executor->owns_arena = 1;
+    } else if (executor->arena_size < arena_size) {
+      fprintf(stderr, "arena of %zu bytes is smaller than the %zu bytes planned\n",
+              executor->arena_size, arena_size);
+      return -1;
+    }
   }
 
   // Allocate the space.
@@ -976,6 +1272,7 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
     fprintf(stderr, "memory allocate error: %08x", err);
     return -1;
   }
+  memset(executor->storage_pool, 0, sizeof(TVMGraphExecutorStorageEntry) * pool_entry_count);
   for (idx = 0; idx < pool_entry_count; idx++) {
     TVMGraphExecutorPoolEntry pit = pool_entry[idx];
     DLDevice dev = executor->devices[0];
@@ -991,13 +1288,29 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
         tensor->data = linked_param_data;
         tensor->device = dev;
         tensor->ndim = attrs->ndim[pit.entry_id];
-        tensor->shape = attrs->shape + idx * TVM_CRT_MAX_NDIM;
+        tensor->shape = attrs->shape + idx * attrs->shape_stride;
         tensor->strides = NULL;
         tensor->byte_offset = 0;
         did_find_linked_param = 1;
       }
     }
-    if (did_find_linked_param == 0) {
+    if (did_find_linked_param == 0 && pit.is_param) {
+      // Loaded in place from the param blob after the storage is set up.
+      executor->storage_pool[executor->storage_pool_count].is_param_in_place = 1;
+      DLTensor* tensor = &executor->storage_pool[executor->storage_pool_count].array.dl_tensor;
+      tensor->device = dev;
+      tensor->ndim = attrs->ndim[pit.entry_id];
+      tensor->shape = attrs->shape + pit.entry_id * attrs->shape_stride;
+    } else if (did_find_linked_param == 0 && pit.offset >= 0) {
+      executor->storage_pool[executor->storage_pool_count].is_in_arena = 1;
+      DLTensor* tensor = &executor->storage_pool[executor->storage_pool_count].array.dl_tensor;
+      tensor->data = executor->arena + pit.offset;
+      tensor->device = dev;
+      tensor->ndim = attrs->ndim[pit.entry_id];
+      tensor->shape = attrs->shape + pit.entry_id * attrs->shape_stride;
+      tensor->strides = NULL;
+      tensor->byte_offset = 0;
+    } else if (did_find_linked_param == 0) {
       DLDataType dtype = {kDLFloat, 32, 1};
       int64_t shape[TVM_CRT_MAX_NDIM] = {
           0,
@@ -1024,7 +1337,7 @@ int TVMGraphExecutor_SetupStorage(TVMGraphExecutor* executor) {
     uint32_t storage_id = attrs->storage_id[idx];
     CHECK(storage_id < executor->storage_pool_count);
     int status = TVMNDArray_CreateView(&(executor->storage_pool[storage_id].array),
-                                       attrs->shape + idx * TVM_CRT_MAX_NDIM, attrs->ndim[idx],
+                                       attrs->shape + idx * attrs->shape_stride, attrs->ndim[idx],
                                        vtype[idx], &executor->data_entry[idx]);
     CHECK_EQ(status, 0, "fail to create for node with idx=%d, storage_id=%u\n", idx, storage_id);
   }
@@ -1156,16 +1469,23 @@ int32_t TVMGraphExecutor_CreateTVMOp(TVMGraphExecutor* executor, const TVMOpPara
  */
 int TVMGraphExecutor_Init(TVMGraphExecutor* executor, const char* graph_json,
                           TVMModuleHandle module_handle, const DLDevice* devs) {
-  JSONReader reader;
-  tvm_crt_error_t err = JSONReader_Create(graph_json, &reader);
-  if (err != kTvmErrorNoError) {
-    return -1;
-  }
+  uint32_t magic = TVM_GRAPH_BINARY_MAGIC;
+  if (!memcmp(graph_json, &magic, sizeof(magic))) {
+    if (TVMGraphExecutor_LoadBinary(executor, (const uint8_t*)graph_json) != 0) {
+      return -1;
+    }
+  } else {
+    JSONReader reader;
+    tvm_crt_error_t err = JSONReader_Create(graph_json, &reader);
+    if (err != kTvmErrorNoError) {
+      return -1;
+    }
 
-  TVMGraphExecutor_Load(executor, &reader);
-  err = JSONReader_Release(&reader);
-  if (err != kTvmErrorNoError) {
-    return -1;
+    int load_status = TVMGraphExecutor_Load(executor, &reader);
+    err = JSONReader_Release(&reader);
+    if (load_status != 0 || err != kTvmErrorNoError) {
+      return -1;
+    }
   }
   executor->module_handle = module_handle;
   executor->devices[0] = devs[0];
@@ -1175,6 +1495,13 @@ int TVMGraphExecutor_Init(TVMGraphExecutor* executor, const char* graph_json,
   if (status != 0) {
     return status;
   }
+  if (executor->param_blob != NULL) {
+    status = TVMGraphExecutor_LoadParamsImpl(executor, executor->param_blob,
+                                             executor->param_size, 1);
+    if (status != 0) {
+      return status;
+    }
+  }
   status = TVMGraphExecutor_SetupOpExecs(executor);
   if (status != 0) {
     if (status != 0) {
@@ -1189,6 +1516,20 @@ int TVMGraphExecutor_Init(TVMGraphExecutor* executor, const char* graph_json,
 
 int TVMGraphExecutor_Create(const char* sym_json, TVMModuleHandle module_handle,
                             const DLDevice* devs, TVMGraphExecutor** executor) {
+  return TVMGraphExecutor_CreateWithArena(sym_json, module_handle, devs, NULL, 0, executor);
+}
+
+int TVMGraphExecutor_CreateWithArena(const char* sym_json, TVMModuleHandle module_handle,
+                                     const DLDevice* devs, void* arena, size_t arena_size,
+                                     TVMGraphExecutor** executor) {
+  return TVMGraphExecutor_CreateWithParamsInPlace(sym_json, module_handle, devs, arena,
+                                                  arena_size, NULL, 0, executor);
+}
+
+int TVMGraphExecutor_CreateWithParamsInPlace(const char* sym_json, TVMModuleHandle module_handle,
+                                             const DLDevice* devs, void* arena, size_t arena_size,
+                                             const char* param_blob, uint32_t param_size,
+                                             TVMGraphExecutor** executor) {
   DLDevice dev = {kDLCPU, 0};
   tvm_crt_error_t err = TVMPlatformMemoryAllocate(sizeof(TVMGraphExecutor), dev, (void**)executor);
   if (err != kTvmErrorNoError) {
@@ -1197,6 +1538,10 @@ int TVMGraphExecutor_Create(const char* sym_json, TVMModuleHandle module_handle,
   }
 
   memset(*executor, 0, sizeof(TVMGraphExecutor));
+  (*executor)->arena = (uint8_t*)arena;
+  (*executor)->arena_size = arena_size;
+  (*executor)->param_blob = param_blob;
+  (*executor)->param_size = param_size;
   // init
   return TVMGraphExecutor_Init(*executor, sym_json, module_handle, devs);
 }
@@ -1221,7 +1566,9 @@ int TVMGraphExecutor_Release(TVMGraphExecutor** pptr) {
     return status;
   }
   for (idx = 0; idx < executor->storage_pool_count; ++idx) {
-    if (executor->storage_pool[idx].is_linked_param == 0) {
+    if (executor->storage_pool[idx].is_linked_param == 0 &&
+        executor->storage_pool[idx].is_in_arena == 0 &&
+        executor->storage_pool[idx].is_param_in_place == 0) {
       status = TVMNDArray_Release(&(executor->storage_pool[idx]).array);
       if (status != 0) {
         return status;
@@ -1234,13 +1581,15 @@ int TVMGraphExecutor_Release(TVMGraphExecutor** pptr) {
       return status;
     }
   }
-  status = TVMPlatformMemoryFree(executor->input_nodes, dev);
-  if (status != 0) {
-    return status;
-  }
-  status = TVMPlatformMemoryFree(executor->node_row_ptr, dev);
-  if (status != 0) {
-    return status;
+  if (!executor->attrs.in_place) {
+    status = TVMPlatformMemoryFree(executor->input_nodes, dev);
+    if (status != 0) {
+      return status;
+    }
+    status = TVMPlatformMemoryFree(executor->node_row_ptr, dev);
+    if (status != 0) {
+      return status;
+    }
   }
   status = TVMPlatformMemoryFree(executor->outputs, dev);
   if (status != 0) {
@@ -1250,6 +1599,12 @@ int TVMGraphExecutor_Release(TVMGraphExecutor** pptr) {
   if (status != 0) {
     return status;
   }
+  if (executor->owns_arena) {
+    status = TVMPlatformMemoryFree(executor->arena, dev);
+    if (status != 0) {
+      return status;
+    }
+  }
   status = TVMPlatformMemoryFree(executor->data_entry, dev);
   if (status != 0) {
     return status;
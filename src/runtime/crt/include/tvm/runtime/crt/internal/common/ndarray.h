@@ -49,6 +49,12 @@ int TVMNDArray_Empty(int32_t ndim, const tvm_index_t* shape, DLDataType dtype, D
 
 int TVMNDArray_Load(TVMNDArray* ret, const char** strm);
 
+/*!
+ * \brief Load an array whose data stays in the stream: the DLTensor points to it, which must be
+ *  aligned to the element size and outlive the array. Only the shape is allocated.
+ */
+int TVMNDArray_LoadInPlace(TVMNDArray* ret, const char** strm);
+
 int TVMNDArray_CreateView(TVMNDArray* arr, const tvm_index_t* shape, int32_t ndim, DLDataType dtype,
                           TVMNDArray* array_view);
 
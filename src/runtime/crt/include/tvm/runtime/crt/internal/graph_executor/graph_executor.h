@@ -34,6 +34,8 @@ typedef struct TVMGraphExecutorPoolEntry {
   size_t size;
   int device_type;
   int entry_id;
+  int64_t offset;
+  uint8_t is_param;
 } TVMGraphExecutorPoolEntry;
 
 // Node entry
@@ -48,6 +50,8 @@ typedef struct TVMGraphExecutorNodeEntry {
 // Storage entry.
 typedef struct TVMGraphExecutorStorageEntry {
   uint8_t is_linked_param;
+  uint8_t is_in_arena;
+  uint8_t is_param_in_place;
   TVMNDArray array;
 } TVMGraphExecutorStorageEntry;
 
@@ -96,6 +100,14 @@ typedef struct TVMGraphExecutor {
   /*! \brief Common storage pool for all devices. */
   TVMGraphExecutorStorageEntry* storage_pool;
   uint32_t storage_pool_count;
+  /*! \brief The buffer of the storages planned into an arena, NULL without the planner. */
+  uint8_t* arena;
+  size_t arena_size;
+  /*! \brief Whether the arena was allocated by the executor rather than given by the caller. */
+  uint8_t owns_arena;
+  /*! \brief The params loaded in place at creation, NULL to allocate their storage. */
+  const char* param_blob;
+  uint32_t param_size;
   /*! \brief Data entry of each node. */
   TVMNDArray* data_entry;
   uint32_t data_entry_count;
@@ -111,6 +123,8 @@ uint32_t TVMGraphExecutor_GetEntryId(TVMGraphExecutor* executor, uint32_t nid, u
 void TVMGraphExecutor_SetInput(TVMGraphExecutor* executor, const char* name, DLTensor* data_in);
 int TVMGraphExecutor_LoadParams(TVMGraphExecutor* executor, const char* param_blob,
                                 const uint32_t param_size);
+int TVMGraphExecutor_LoadParamsInPlace(TVMGraphExecutor* executor, const char* param_blob,
+                                       const uint32_t param_size);
 void TVMGraphExecutor_Run(TVMGraphExecutor* executor);
 int TVMGraphExecutor_GetOutput(TVMGraphExecutor* executor, const int32_t idx, DLTensor* out);
 
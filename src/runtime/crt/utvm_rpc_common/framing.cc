@@ -25,6 +25,7 @@
 #include <checksum.h>
 #include <string.h>
 #include <tvm/runtime/crt/logging.h>
+#include <tvm/runtime/crt/platform.h>
 #include <tvm/runtime/crt/rpc_common/framing.h>
 
 #include "crt_config.h"
@@ -41,17 +42,23 @@
 #define TVM_UNFRAMER_DEBUG_LOG(msg, ...)
 #endif
 
+// The table-driven software CRC, platforms with a CRC unit override it.
+extern "C" __attribute__((weak)) uint16_t TVMPlatformCrc16(const uint8_t* data,
+                                                          size_t data_size_bytes, uint16_t crc) {
+  for (size_t i = 0; i < data_size_bytes; ++i) {
+    crc = update_crc_ccitt(crc, data[i]);
+  }
+
+  return crc;
+}
+
 namespace tvm {
 namespace runtime {
 namespace micro_rpc {
 
 uint16_t crc16_compute(const uint8_t* data, size_t data_size_bytes, uint16_t* previous_crc) {
   uint16_t crc = (previous_crc != nullptr ? *previous_crc : 0xffff);
-  for (size_t i = 0; i < data_size_bytes; ++i) {
-    crc = update_crc_ccitt(crc, data[i]);
-  }
-
-  return crc;
+  return TVMPlatformCrc16(data, data_size_bytes, crc);
 }
 
 template <typename E>
@@ -71,7 +78,10 @@ tvm_crt_error_t Unframer::Write(const uint8_t* data, size_t data_size_bytes,
   input_ = data;
   input_size_bytes_ = data_size_bytes;
 
-  while (return_code == kTvmErrorNoError && input_size_bytes_ > 0) {
+  bool packet_done = false;
+  // Return after each packet once the next one starts, so the receiver can consume it first.
+  while (return_code == kTvmErrorNoError && input_size_bytes_ > 0 &&
+         !(packet_done && state_ != State::kFindPacketStart)) {
     TVM_UNFRAMER_DEBUG_LOG("state: %02x size 0x%02zx", to_integral(state_), input_size_bytes_);
     switch (state_) {
       case State::kFindPacketStart:
@@ -85,6 +95,9 @@ tvm_crt_error_t Unframer::Write(const uint8_t* data, size_t data_size_bytes,
         break;
       case State::kFindCrcEnd:
         return_code = FindCrcEnd();
+        if (state_ == State::kFindPacketStart) {
+          packet_done = true;
+        }
         break;
       default:
         return_code = kTvmErrorFramingInvalidState;
@@ -133,6 +146,27 @@ tvm_crt_error_t Unframer::ConsumeInput(uint8_t* buffer, size_t buffer_size_bytes
   tvm_crt_error_t to_return = kTvmErrorNoError;
   size_t i;
   for (i = 0; i < input_size_bytes_; ++i) {
+    if (!saw_escape_start_) {
+      // Copy the bytes up to the next escape at once.
+      size_t run_size_bytes = input_size_bytes_ - i;
+      if (run_size_bytes > buffer_size_bytes - *bytes_filled) {
+        run_size_bytes = buffer_size_bytes - *bytes_filled;
+      }
+      const void* next_escape =
+          memchr(&input_[i], to_integral(Escape::kEscapeStart), run_size_bytes);
+      if (next_escape != nullptr) {
+        run_size_bytes = static_cast<const uint8_t*>(next_escape) - &input_[i];
+      }
+      if (run_size_bytes > 0) {
+        memcpy(&buffer[*bytes_filled], &input_[i], run_size_bytes);
+        *bytes_filled += run_size_bytes;
+        i += run_size_bytes;
+        if (*bytes_filled == buffer_size_bytes || i == input_size_bytes_) {
+          break;
+        }
+      }
+    }
+
     uint8_t c = input_[i];
     if (saw_escape_start_) {
       saw_escape_start_ = false;
@@ -336,46 +370,82 @@ tvm_crt_error_t Framer::StartPacket(size_t payload_size_bytes) {
   return to_return;
 }
 
+tvm_crt_error_t Framer::WriteRawAndCrc(const uint8_t* data, size_t data_size_bytes,
+                                       bool update_crc) {
+  if (data_size_bytes == 0) {
+    return kTvmErrorNoError;
+  }
+
+  size_t bytes_consumed;
+  tvm_crt_error_t to_return =
+      stream_->WriteAll(const_cast<uint8_t*>(data), data_size_bytes, &bytes_consumed);
+  if (to_return != kTvmErrorNoError) {
+    return to_return;
+  }
+
+  if (update_crc) {
+    crc_ = crc16_compute(data, data_size_bytes, &crc_);
+  }
+
+  return kTvmErrorNoError;
+}
+
 tvm_crt_error_t Framer::WriteAndCrc(const uint8_t* data, size_t data_size_bytes, bool escape,
                                     bool update_crc) {
+  uint8_t buffer[kMaxStackBufferSizeBytes];
+  size_t buffer_ptr = 0;
   while (data_size_bytes > 0) {
-    uint8_t buffer[kMaxStackBufferSizeBytes];
-    size_t buffer_ptr = 0;
-    size_t i;
-    for (i = 0; i < data_size_bytes && buffer_ptr != kMaxStackBufferSizeBytes; ++i) {
-      uint8_t c = data[i];
-      if (!escape || c != to_integral(Escape::kEscapeStart)) {
-        buffer[buffer_ptr] = c;
-        buffer_ptr++;
-        continue;
+    size_t run_size_bytes = data_size_bytes;
+    if (escape) {
+      const void* next_escape = memchr(data, to_integral(Escape::kEscapeStart), data_size_bytes);
+      if (next_escape != nullptr) {
+        run_size_bytes = static_cast<const uint8_t*>(next_escape) - data;
       }
+    }
 
-      if (buffer_ptr == kMaxStackBufferSizeBytes - 1) {
-        break;
+    // Long runs without an escape go to the wire straight from data, the rest is batched.
+    if (run_size_bytes + 2 > kMaxStackBufferSizeBytes) {
+      tvm_crt_error_t to_return = WriteRawAndCrc(buffer, buffer_ptr, update_crc);
+      if (to_return != kTvmErrorNoError) {
+        return to_return;
       }
 
-      buffer[buffer_ptr] = to_integral(Escape::kEscapeStart);
-      buffer_ptr++;
+      buffer_ptr = 0;
+      to_return = WriteRawAndCrc(data, run_size_bytes, update_crc);
+      if (to_return != kTvmErrorNoError) {
+        return to_return;
+      }
 
-      buffer[buffer_ptr] = to_integral(Escape::kEscapeStart);
-      buffer_ptr++;
+      data += run_size_bytes;
+      data_size_bytes -= run_size_bytes;
+      continue;
     }
 
-    size_t bytes_consumed;
-    tvm_crt_error_t to_return = stream_->WriteAll(buffer, buffer_ptr, &bytes_consumed);
-    if (to_return != kTvmErrorNoError) {
-      return to_return;
-    }
+    if (buffer_ptr + run_size_bytes + 2 > kMaxStackBufferSizeBytes) {
+      tvm_crt_error_t to_return = WriteRawAndCrc(buffer, buffer_ptr, update_crc);
+      if (to_return != kTvmErrorNoError) {
+        return to_return;
+      }
 
-    if (update_crc) {
-      crc_ = crc16_compute(buffer, buffer_ptr, &crc_);
+      buffer_ptr = 0;
     }
 
-    data_size_bytes -= i;
-    data += i;
+    memcpy(&buffer[buffer_ptr], data, run_size_bytes);
+    buffer_ptr += run_size_bytes;
+    data += run_size_bytes;
+    data_size_bytes -= run_size_bytes;
+    if (data_size_bytes > 0) {
+      // data points at an escape byte, which is doubled on the wire.
+      buffer[buffer_ptr] = to_integral(Escape::kEscapeStart);
+      buffer_ptr++;
+      buffer[buffer_ptr] = to_integral(Escape::kEscapeStart);
+      buffer_ptr++;
+      data++;
+      data_size_bytes--;
+    }
   }
 
-  return kTvmErrorNoError;
+  return WriteRawAndCrc(buffer, buffer_ptr, update_crc);
 }
 
 tvm_crt_error_t Framer::WritePayloadChunk(const uint8_t* payload_chunk,
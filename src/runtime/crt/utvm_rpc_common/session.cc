@@ -33,7 +33,9 @@ namespace micro_rpc {
 
 struct utvm_session_start_payload_t {
   uint8_t version;
-};
+  /*! \brief Sent only when non-zero, see Session::SetReceiveWindow. */
+  uint32_t receive_window_bytes;
+} __attribute__((packed));
 
 void Session::RegenerateNonce() {
   local_nonce_ = (((local_nonce_ << 5) | (local_nonce_ >> 5)) + 1);
@@ -43,6 +45,20 @@ void Session::RegenerateNonce() {
   }
 }
 
+tvm_crt_error_t Session::SendSessionStart(MessageType message_type) {
+  utvm_session_start_payload_t payload = {Session::kVersion, local_receive_window_bytes_};
+  // Without a window the payload is the version alone, as sent by the sessions that predate it.
+  size_t payload_size_bytes =
+      local_receive_window_bytes_ != 0 ? sizeof(payload) : sizeof(payload.version);
+  return SendInternal(message_type, reinterpret_cast<uint8_t*>(&payload), payload_size_bytes);
+}
+
+bool Session::ReadSessionStart(utvm_session_start_payload_t* payload) {
+  payload->receive_window_bytes = 0;
+  int bytes_read = receive_buffer_->Read(reinterpret_cast<uint8_t*>(payload), sizeof(*payload));
+  return bytes_read == sizeof(payload->version) || bytes_read == sizeof(*payload);
+}
+
 tvm_crt_error_t Session::SendInternal(MessageType message_type, const uint8_t* message_data,
                                       size_t message_size_bytes) {
   tvm_crt_error_t to_return = StartMessage(message_type, message_size_bytes);
@@ -85,9 +101,7 @@ tvm_crt_error_t Session::StartSession() {
 
   RegenerateNonce();
   SetSessionId(local_nonce_, 0);
-  utvm_session_start_payload_t payload = {Session::kVersion};
-  tvm_crt_error_t to_return = SendInternal(MessageType::kStartSessionInit,
-                                           reinterpret_cast<uint8_t*>(&payload), sizeof(payload));
+  tvm_crt_error_t to_return = SendSessionStart(MessageType::kStartSessionInit);
   if (to_return == 0) {
     state_ = State::kStartSessionSent;
   }
@@ -103,6 +117,7 @@ tvm_crt_error_t Session::Initialize(uint8_t initial_session_nonce) {
 tvm_crt_error_t Session::TerminateSession() {
   SetSessionId(0, 0);
   state_ = State::kNoSessionEstablished;
+  remote_receive_window_bytes_ = 0;
   return SendInternal(MessageType::kTerminateSession, nullptr, 0);
 }
 
@@ -182,9 +197,7 @@ void Session::ClearReceiveBuffer() {
 void Session::SendSessionStartReply(const SessionHeader& header) {
   RegenerateNonce();
   SetSessionId(InitiatorNonce(header.session_id), local_nonce_);
-  utvm_session_start_payload_t payload = {Session::kVersion};
-  tvm_crt_error_t to_return = SendInternal(MessageType::kStartSessionReply,
-                                           reinterpret_cast<uint8_t*>(&payload), sizeof(payload));
+  tvm_crt_error_t to_return = SendSessionStart(MessageType::kStartSessionReply);
   state_ = State::kSessionEstablished;
   CHECK_EQ(to_return, kTvmErrorNoError, "SendSessionStartReply");
   OnSessionEstablishedMessage();
@@ -196,10 +209,10 @@ void Session::ProcessStartSessionInit(const SessionHeader& header) {
   }
 
   utvm_session_start_payload_t payload;
-  int bytes_read = receive_buffer_->Read(reinterpret_cast<uint8_t*>(&payload), sizeof(payload));
-  if (bytes_read != sizeof(payload)) {
+  if (!ReadSessionStart(&payload)) {
     return;
   }
+  remote_receive_window_bytes_ = payload.receive_window_bytes;
 
   switch (state_) {
     case State::kReset:
@@ -236,8 +249,7 @@ void Session::ProcessStartSessionReply(const SessionHeader& header) {
   }
 
   utvm_session_start_payload_t payload;
-  int bytes_read = receive_buffer_->Read(reinterpret_cast<uint8_t*>(&payload), sizeof(payload));
-  if (bytes_read != sizeof(payload)) {
+  if (!ReadSessionStart(&payload)) {
     return;
   }
 
@@ -249,6 +261,7 @@ void Session::ProcessStartSessionReply(const SessionHeader& header) {
       if (InitiatorNonce(header.session_id) == local_nonce_ &&
           payload.version == Session::kVersion) {
         SetSessionId(local_nonce_, ResponderNonce(header.session_id));
+        remote_receive_window_bytes_ = payload.receive_window_bytes;
         state_ = State::kSessionEstablished;
         OnSessionEstablishedMessage();
       }
@@ -125,6 +125,9 @@ class MicroRPCServer {
     tvm_crt_error_t error =
         TVMPlatformGenerateRandom(&initial_session_nonce, sizeof(initial_session_nonce));
     CHECK_EQ(kTvmErrorNoError, error, "generating random session id");
+#ifdef TVM_CRT_RPC_RECEIVE_WINDOW_BYTES
+    session_.SetReceiveWindow(TVM_CRT_RPC_RECEIVE_WINDOW_BYTES);
+#endif
     CHECK_EQ(kTvmErrorNoError, session_.Initialize(initial_session_nonce), "rpc server init");
   }
 
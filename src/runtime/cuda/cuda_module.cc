@@ -27,8 +27,11 @@
 #include <tvm/runtime/registry.h>
 
 #include <array>
+#include <atomic>
+#include <cstdlib>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -51,18 +54,45 @@ class CUDAModuleNode : public runtime::ModuleNode {
                           std::unordered_map<std::string, FunctionInfo> fmap,
                           std::string cuda_source)
       : data_(data), fmt_(fmt), fmap_(fmap), cuda_source_(cuda_source) {
-    std::fill(module_.begin(), module_.end(), nullptr);
+    for (auto& module : module_) {
+      module.store(nullptr, std::memory_order_relaxed);
+    }
   }
   // destructor
   ~CUDAModuleNode() {
+    if (preload_thread_.joinable()) {
+      preload_thread_.join();
+    }
     for (size_t i = 0; i < module_.size(); ++i) {
-      if (module_[i] != nullptr) {
+      CUmodule module = module_[i].load(std::memory_order_acquire);
+      if (module != nullptr) {
         CUDA_CALL(cudaSetDevice(static_cast<int>(i)));
-        CUDA_DRIVER_CALL(cuModuleUnload(module_[i]));
+        CUDA_DRIVER_CALL(cuModuleUnload(module));
       }
     }
   }
 
+  /*!
+   * \brief Load the module on the current device in the background, for the PTX the driver
+   *  JIT compiles, which takes long for the modules of many kernels. The first call of a
+   *  function waits for it, the rest of the initialization runs meanwhile.
+   */
+  void PreloadModule() {
+    if (fmt_ != "ptx") return;
+    int device_id;
+    if (cudaGetDevice(&device_id) != cudaSuccess) return;
+    preload_thread_ = std::thread([this, device_id]() {
+      if (cudaSetDevice(device_id) != cudaSuccess) return;
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (module_[device_id].load(std::memory_order_relaxed) != nullptr) return;
+      // The errors are reported by the load on the first call.
+      CUmodule module;
+      if (cuModuleLoadData(&module, data_.c_str()) == CUDA_SUCCESS) {
+        module_[device_id].store(module, std::memory_order_release);
+      }
+    });
+  }
+
   const char* type_key() const final { return "cuda"; }
 
   PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
@@ -97,15 +127,23 @@ class CUDAModuleNode : public runtime::ModuleNode {
     }
   }
 
-  // get a CUfunction from primary context in device_id
-  CUfunction GetFunc(int device_id, const std::string& func_name) {
+  // get the module of device_id, loading it the first time
+  CUmodule GetModule(int device_id) {
+    CUmodule module = module_[device_id].load(std::memory_order_acquire);
+    if (module != nullptr) return module;
     std::lock_guard<std::mutex> lock(mutex_);
     // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
+    module = module_[device_id].load(std::memory_order_relaxed);
+    if (module == nullptr) {
+      CUDA_DRIVER_CALL(cuModuleLoadData(&module, data_.c_str()));
+      module_[device_id].store(module, std::memory_order_release);
     }
+    return module;
+  }
+  // get a CUfunction from primary context in device_id
+  CUfunction GetFunc(int device_id, const std::string& func_name) {
     CUfunction func;
-    CUresult result = cuModuleGetFunction(&func, module_[device_id], func_name.c_str());
+    CUresult result = cuModuleGetFunction(&func, GetModule(device_id), func_name.c_str());
     if (result != CUDA_SUCCESS) {
       const char* msg;
       cuGetErrorName(result, &msg);
@@ -115,15 +153,11 @@ class CUDAModuleNode : public runtime::ModuleNode {
   }
   // get a global var from primary context in device_id
   CUdeviceptr GetGlobal(int device_id, const std::string& global_name, size_t expect_nbytes) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    // must recheck under the lock scope
-    if (module_[device_id] == nullptr) {
-      CUDA_DRIVER_CALL(cuModuleLoadData(&(module_[device_id]), data_.c_str()));
-    }
     CUdeviceptr global;
     size_t nbytes;
 
-    CUresult result = cuModuleGetGlobal(&global, &nbytes, module_[device_id], global_name.c_str());
+    CUresult result =
+        cuModuleGetGlobal(&global, &nbytes, GetModule(device_id), global_name.c_str());
     ICHECK_EQ(nbytes, expect_nbytes);
     if (result != CUDA_SUCCESS) {
       const char* msg;
@@ -143,35 +177,57 @@ class CUDAModuleNode : public runtime::ModuleNode {
   // The cuda source.
   std::string cuda_source_;
   // the internal modules per GPU, to be lazily initialized.
-  std::array<CUmodule, kMaxNumGPUs> module_;
+  // They are read without the lock once loaded.
+  std::array<std::atomic<CUmodule>, kMaxNumGPUs> module_;
   // internal mutex when updating the module
   std::mutex mutex_;
+  // the background load of the module, see PreloadModule.
+  std::thread preload_thread_;
 };
 
 // a wrapped function class to get packed func.
 class CUDAWrappedFunc {
  public:
+  // the cached handles are copied along, the atomics are not copyable.
+  CUDAWrappedFunc() = default;
+  CUDAWrappedFunc(const CUDAWrappedFunc& other) { *this = other; }
+  CUDAWrappedFunc& operator=(const CUDAWrappedFunc& other) {
+    m_ = other.m_;
+    sptr_ = other.sptr_;
+    func_name_ = other.func_name_;
+    for (size_t i = 0; i < fcache_.size(); ++i) {
+      fcache_[i].store(other.fcache_[i].load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    }
+    thread_axis_cfg_ = other.thread_axis_cfg_;
+    return *this;
+  }
   // initialize the CUDA function.
   void Init(CUDAModuleNode* m, ObjectPtr<Object> sptr, const std::string& func_name,
             size_t num_void_args, const std::vector<std::string>& thread_axis_tags) {
     m_ = m;
     sptr_ = sptr;
     func_name_ = func_name;
-    std::fill(fcache_.begin(), fcache_.end(), nullptr);
+    for (auto& func : fcache_) {
+      func.store(nullptr, std::memory_order_relaxed);
+    }
     thread_axis_cfg_.Init(num_void_args, thread_axis_tags);
   }
   // invoke the function with void arguments
   void operator()(TVMArgs args, TVMRetValue* rv, void** void_args) const {
     int device_id;
     CUDA_CALL(cudaGetDevice(&device_id));
-    if (fcache_[device_id] == nullptr) {
-      fcache_[device_id] = m_->GetFunc(device_id, func_name_);
+    // The handles of the function are looked up once per device, without a lock.
+    CUfunction func = fcache_[device_id].load(std::memory_order_relaxed);
+    if (func == nullptr) {
+      func = m_->GetFunc(device_id, func_name_);
+      fcache_[device_id].store(func, std::memory_order_relaxed);
     }
     CUstream strm = static_cast<CUstream>(CUDAThreadEntry::ThreadLocal()->stream);
     ThreadWorkLoad wl = thread_axis_cfg_.Extract(args);
-    CUresult result = cuLaunchKernel(fcache_[device_id], wl.grid_dim(0), wl.grid_dim(1),
-                                     wl.grid_dim(2), wl.block_dim(0), wl.block_dim(1),
-                                     wl.block_dim(2), 0, strm, void_args, nullptr);
+    CUresult result =
+        cuLaunchKernel(func, wl.grid_dim(0), wl.grid_dim(1), wl.grid_dim(2), wl.block_dim(0),
+                       wl.block_dim(1), wl.block_dim(2), 0, strm, void_args, nullptr);
     if (result != CUDA_SUCCESS && result != CUDA_ERROR_DEINITIALIZED) {
       const char* msg;
       cuGetErrorName(result, &msg);
@@ -200,7 +256,7 @@ class CUDAWrappedFunc {
   std::string func_name_;
   // Device function cache per device.
   // mark as mutable, to enable lazy initialization
-  mutable std::array<CUfunction, kMaxNumGPUs> fcache_;
+  mutable std::array<std::atomic<CUfunction>, kMaxNumGPUs> fcache_;
   // thread axis configuration
   ThreadAxisConfig thread_axis_cfg_;
 };
@@ -252,6 +308,16 @@ Module CUDAModuleCreate(std::string data, std::string fmt,
   return Module(n);
 }
 
+// Create a loaded module, preloading its PTX unless TVM_CUDA_DISABLE_PTX_PRELOAD is set.
+Module CUDAModuleLoad(std::string data, std::string fmt,
+                      std::unordered_map<std::string, FunctionInfo> fmap) {
+  auto n = make_object<CUDAModuleNode>(data, fmt, fmap, std::string());
+  if (!std::getenv("TVM_CUDA_DISABLE_PTX_PRELOAD")) {
+    n->PreloadModule();
+  }
+  return Module(n);
+}
+
 // Load module from module.
 Module CUDAModuleLoadFile(const std::string& file_name, const std::string& format) {
   std::string data;
@@ -260,7 +326,7 @@ Module CUDAModuleLoadFile(const std::string& file_name, const std::string& forma
   std::string meta_file = GetMetaFilePath(file_name);
   LoadBinaryFromFile(file_name, &data);
   LoadMetaDataFromFile(meta_file, &fmap);
-  return CUDAModuleCreate(data, fmt, fmap, std::string());
+  return CUDAModuleLoad(data, fmt, fmap);
 }
 
 Module CUDAModuleLoadBinary(void* strm) {
@@ -271,7 +337,7 @@ Module CUDAModuleLoadBinary(void* strm) {
   stream->Read(&fmt);
   stream->Read(&fmap);
   stream->Read(&data);
-  return CUDAModuleCreate(data, fmt, fmap, std::string());
+  return CUDAModuleLoad(data, fmt, fmap);
 }
 
 TVM_REGISTER_GLOBAL("runtime.module.loadfile_cubin").set_body_typed(CUDAModuleLoadFile);
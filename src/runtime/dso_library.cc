@@ -20,6 +20,10 @@
 /*!
  * \file dso_libary.cc
  * \brief Create library module to load from dynamic shared library.
+ *
+ *  The library is loaded from a file, or from its bytes in memory. On Linux the bytes are
+ *  loaded from an anonymous memory file, without a writable filesystem, and each load is a
+ *  distinct copy of the library, e.g. to swap a model for a new version of it.
  */
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/module.h>
@@ -32,6 +36,12 @@
 #include <windows.h>
 #else
 #include <dlfcn.h>
+#include <stdlib.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
 #endif
 
 namespace tvm {
@@ -46,6 +56,37 @@ class DSOLibrary final : public Library {
   }
   void Init(const std::string& name) { Load(name); }
 
+  void InitFromBytes(const std::string& data) {
+#if defined(_WIN32)
+    LOG(FATAL) << "Loading a dynamic shared library from memory is not supported on Windows";
+#else
+    int fd = -1;
+    std::string path;
+    bool is_temp = false;
+#if defined(SYS_memfd_create)
+    fd = static_cast<int>(syscall(SYS_memfd_create, "tvm_module", 0));
+    if (fd >= 0) path = "/proc/self/fd/" + std::to_string(fd);
+#endif
+    if (fd < 0) {
+      // Without memory files, e.g. not on Linux, go through a temporary file.
+      const char* tmpdir = getenv("TMPDIR");
+      path = std::string(tmpdir ? tmpdir : "/tmp") + "/tvm_module_XXXXXX";
+      fd = mkstemp(&path[0]);
+      ICHECK_GE(fd, 0) << "Cannot create a file for the library: " << std::strerror(errno);
+      is_temp = true;
+    }
+    for (size_t written = 0; written < data.size();) {
+      ssize_t n = write(fd, data.data() + written, data.size() - written);
+      ICHECK_GT(n, 0) << "Cannot write the library: " << std::strerror(errno);
+      written += static_cast<size_t>(n);
+    }
+    Load(path);
+    // The mapping of the library outlives the file.
+    close(fd);
+    if (is_temp) unlink(path.c_str());
+#endif
+  }
+
   void* GetSymbol(const char* name) final { return GetSymbol_(name); }
 
  private:
@@ -94,5 +135,11 @@ TVM_REGISTER_GLOBAL("runtime.module.loadfile_so").set_body([](TVMArgs args, TVMR
   n->Init(args[0]);
   *rv = CreateModuleFromLibrary(n);
 });
+
+TVM_REGISTER_GLOBAL("runtime.module.loadbytes_so").set_body([](TVMArgs args, TVMRetValue* rv) {
+  auto n = make_object<DSOLibrary>();
+  n->InitFromBytes(args[0]);
+  *rv = CreateModuleFromLibrary(n);
+});
 }  // namespace runtime
 }  // namespace tvm
@@ -26,9 +26,20 @@
 #include <dmlc/memory_io.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/serializer.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <unordered_map>
 #include <vector>
 
@@ -185,7 +196,144 @@ Map<String, NDArray> LoadParams(dmlc::Stream* strm) {
   return params;
 }
 
-void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params) {
+#ifndef _WIN32
+namespace {
+/*! \brief A private mapping of a file. */
+struct FileMapping {
+  void* data{nullptr};
+  size_t size{0};
+  ~FileMapping() {
+    if (data != nullptr) munmap(data, size);
+  }
+};
+
+/*! \brief The DLPack context of an array aliasing a file mapping. */
+struct MappedTensor {
+  std::shared_ptr<FileMapping> mapping;
+  std::vector<int64_t> shape;
+  DLManagedTensor tensor;
+};
+
+NDArray MappedArray(const std::shared_ptr<FileMapping>& mapping, void* data,
+                    std::vector<int64_t> shape, DLDataType dtype) {
+  MappedTensor* ctx = new MappedTensor{mapping, std::move(shape), {}};
+  DLTensor& t = ctx->tensor.dl_tensor;
+  t.data = data;
+  t.device = Device{kDLCPU, 0};
+  t.ndim = static_cast<int>(ctx->shape.size());
+  t.dtype = dtype;
+  t.shape = ctx->shape.data();
+  t.strides = nullptr;
+  t.byte_offset = 0;
+  ctx->tensor.manager_ctx = ctx;
+  ctx->tensor.deleter = [](DLManagedTensor* self) {
+    delete static_cast<MappedTensor*>(self->manager_ctx);
+  };
+  return NDArray::FromDLPack(&ctx->tensor);
+}
+}  // namespace
+#endif
+
+Map<String, NDArray> LoadParamsMapped(const std::string& file_name, size_t offset) {
+#ifdef _WIN32
+  std::ifstream fs(file_name, std::ios::in | std::ios::binary);
+  ICHECK(!fs.fail()) << "Cannot open file " << file_name;
+  std::stringstream blob;
+  blob << fs.rdbuf();
+  return LoadParams(blob.str().substr(offset));
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  ICHECK_GE(fd, 0) << "Cannot open file " << file_name;
+  struct stat st;
+  ICHECK_EQ(fstat(fd, &st), 0) << "Cannot stat file " << file_name;
+  auto mapping = std::make_shared<FileMapping>();
+  mapping->size = static_cast<size_t>(st.st_size);
+  // A private writable mapping, pages are only copied when the parameters are written
+  void* data = mmap(nullptr, mapping->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  ICHECK(data != MAP_FAILED) << "Cannot map file " << file_name;
+  mapping->data = data;
+
+  ICHECK_LE(offset, mapping->size) << "Invalid parameters file format";
+  char* base = static_cast<char*>(mapping->data) + offset;
+  size_t size = mapping->size - offset;
+  dmlc::MemoryFixedSizeStream fixed_strm(base, size);
+  dmlc::SeekStream* strm = &fixed_strm;
+  Map<String, NDArray> params;
+  uint64_t header, reserved;
+  ICHECK(strm->Read(&header)) << "Invalid parameters file format";
+  ICHECK(header == kTVMNDArrayListMagic) << "Invalid parameters file format";
+  ICHECK(strm->Read(&reserved)) << "Invalid parameters file format";
+  std::vector<std::string> names;
+  ICHECK(strm->Read(&names)) << "Invalid parameters file format";
+  uint64_t sz;
+  ICHECK(strm->Read(&sz)) << "Invalid parameters file format";
+  ICHECK(static_cast<size_t>(sz) == names.size()) << "Invalid parameters file format";
+  for (size_t i = 0; i < names.size(); ++i) {
+    uint64_t data_pad;
+    Device dev;
+    int ndim;
+    DLDataType dtype;
+    int64_t data_byte_size;
+    ICHECK(strm->Read(&header)) << "Invalid DLTensor file format";
+    ICHECK(header == kTVMNDArrayMagic) << "Invalid DLTensor file format";
+    ICHECK(strm->Read(&data_pad)) << "Invalid DLTensor file format";
+    ICHECK(strm->Read(&dev)) << "Invalid DLTensor file format";
+    ICHECK(strm->Read(&ndim)) << "Invalid DLTensor file format";
+    ICHECK(strm->Read(&dtype)) << "Invalid DLTensor file format";
+    ICHECK_EQ(dev.device_type, kDLCPU) << "Invalid DLTensor device: can only save as CPU tensor";
+    std::vector<int64_t> shape(ndim);
+    if (ndim != 0) {
+      ICHECK(strm->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+    }
+    ICHECK(strm->Read(&data_byte_size)) << "Invalid DLTensor file format";
+    size_t data_offset = strm->Tell() + data_pad;
+    ICHECK_LE(data_offset + data_byte_size, size) << "Invalid DLTensor file format";
+    char* ptr = base + data_offset;
+    NDArray arr;
+    if (DMLC_IO_NO_ENDIAN_SWAP && reinterpret_cast<uintptr_t>(ptr) % kAllocAlignment == 0) {
+      arr = MappedArray(mapping, ptr, std::move(shape), dtype);
+    } else {
+      arr = NDArray::Empty(shape, dtype, dev);
+      std::memcpy(arr->data, ptr, data_byte_size);
+      if (!DMLC_IO_NO_ENDIAN_SWAP) {
+        int elem_bytes = (dtype.bits + 7) / 8;
+        dmlc::ByteSwap(arr->data, elem_bytes, data_byte_size / elem_bytes);
+      }
+    }
+    ICHECK_EQ(GetDataSize(*arr.operator->()), static_cast<size_t>(data_byte_size))
+        << "Invalid DLTensor file format";
+    params.Set(names[i], arr);
+    strm->Seek(data_offset + data_byte_size);
+  }
+  return params;
+#endif
+}
+
+namespace {
+/*! \brief Forward the writes to a stream, counting the bytes written. */
+class CountingStream : public dmlc::Stream {
+ public:
+  explicit CountingStream(dmlc::Stream* strm) : strm_(strm) {}
+  using dmlc::Stream::Read;
+  using dmlc::Stream::Write;
+  size_t Read(void* ptr, size_t size) final {
+    LOG(FATAL) << "CountingStream is write only";
+    return 0;
+  }
+  void Write(const void* ptr, size_t size) final {
+    strm_->Write(ptr, size);
+    bytes_ += size;
+  }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  dmlc::Stream* strm_;
+  size_t bytes_{0};
+};
+}  // namespace
+
+void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params, size_t alignment) {
   std::vector<std::string> names;
   std::vector<const DLTensor*> arrays;
   for (auto& p : params) {
@@ -193,37 +341,49 @@ void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params) {
     arrays.push_back(p.second.operator->());
   }
 
+  CountingStream fo(strm);
   uint64_t header = kTVMNDArrayListMagic, reserved = 0;
-  strm->Write(header);
-  strm->Write(reserved);
-  strm->Write(names);
+  fo.Write(header);
+  fo.Write(reserved);
+  fo.Write(names);
   {
     uint64_t sz = static_cast<uint64_t>(arrays.size());
-    strm->Write(sz);
+    fo.Write(sz);
     for (size_t i = 0; i < sz; ++i) {
-      tvm::runtime::SaveDLTensor(strm, arrays[i]);
+      uint64_t data_pad = 0;
+      if (alignment != 0) {
+        // Header written by SaveDLTensor: magic, reserved, device, ndim, dtype, shape, size
+        size_t header_bytes = 2 * sizeof(uint64_t) + sizeof(Device) + sizeof(int) +
+                              sizeof(DLDataType) + (arrays[i]->ndim + 1) * sizeof(int64_t);
+        size_t data_offset = fo.bytes() + header_bytes;
+        data_pad = (alignment - data_offset % alignment) % alignment;
+      }
+      tvm::runtime::SaveDLTensor(&fo, arrays[i], data_pad);
     }
   }
 }
 
-std::string SaveParams(const Map<String, NDArray>& params) {
+std::string SaveParams(const Map<String, NDArray>& params, size_t alignment) {
   std::string bytes;
   dmlc::MemoryStringStream strm(&bytes);
   dmlc::Stream* fo = &strm;
-  SaveParams(fo, params);
+  SaveParams(fo, params, alignment);
   return bytes;
 }
 
-TVM_REGISTER_GLOBAL("runtime.SaveParams").set_body_typed([](const Map<String, NDArray>& params) {
-  std::string s = ::tvm::runtime::SaveParams(params);
+TVM_REGISTER_GLOBAL("runtime.SaveParams").set_body([](TVMArgs args, TVMRetValue* rv) {
+  Map<String, NDArray> params = args[0];
+  size_t alignment = args.num_args > 1 ? static_cast<int64_t>(args[1]) : 0;
+  std::string s = ::tvm::runtime::SaveParams(params, alignment);
   // copy return array so it is owned by the ret value
-  TVMRetValue rv;
-  rv = TVMByteArray{s.data(), s.size()};
-  return rv;
+  *rv = TVMByteArray{s.data(), s.size()};
 });
 TVM_REGISTER_GLOBAL("runtime.LoadParams").set_body_typed([](const String& s) {
   return ::tvm::runtime::LoadParams(s);
 });
+TVM_REGISTER_GLOBAL("runtime.LoadParamsMapped").set_body_typed([](const String& file_name) {
+  return ::tvm::runtime::LoadParamsMapped(file_name);
+});
 
 }  // namespace runtime
 }  // namespace tvm
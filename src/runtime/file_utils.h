@@ -108,18 +108,32 @@ Map<String, NDArray> LoadParams(const std::string& param_blob);
  * \return Map of parameter name to parameter value.
  */
 Map<String, NDArray> LoadParams(dmlc::Stream* strm);
+/*!
+ * \brief Load parameters from a file, mapping it in memory.
+ *
+ *  The parameters whose data is aligned to kAllocAlignment in the file alias the copy-on-write
+ *  mapping, so that no copy is made and pages are only read on first use. The others are copied.
+ * \param file_name The parameter file.
+ * \param offset The offset of the parameters in the file.
+ * \return Map of parameter name to parameter value.
+ */
+Map<String, NDArray> LoadParamsMapped(const std::string& file_name, size_t offset = 0);
 /*!
  * \brief Serialize parameters to a byte array.
  * \param params Parameters to save.
+ * \param alignment If not 0, the data of each parameter is padded to this alignment
+ *  from the beginning of the array, so that LoadParamsMapped can alias it. Runtimes
+ *  older than the padding support cannot read such arrays.
  * \return String containing binary parameter data.
  */
-std::string SaveParams(const Map<String, NDArray>& params);
+std::string SaveParams(const Map<String, NDArray>& params, size_t alignment = 0);
 /*!
  * \brief Serialize parameters to a stream.
  * \param strm Stream to write to.
  * \param params Parameters to save.
+ * \param alignment If not 0, the alignment of the data from the beginning of the stream.
  */
-void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params);
+void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params, size_t alignment = 0);
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_FILE_UTILS_H_
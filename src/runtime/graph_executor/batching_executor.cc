@@ -0,0 +1,303 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file batching_executor.cc
+ * \brief Dynamic batching of independent requests on graph executors built for a set of
+ *  batch sizes.
+ */
+#include <tvm/runtime/container.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Collects independent requests of batch 1 and runs them together on the graph
+ *  executor of the smallest built batch size holding them.
+ *
+ *  A batch is dispatched once it fills the largest batch size, or once its oldest request
+ *  waited for the deadline. The inputs of the requests are copied into the rows of the batch,
+ *  the rows past the last request are padding, and the rows of the outputs are copied out to
+ *  the requests. The batch is dimension 0 of every input and output.
+ *
+ *  Each instance has an executor per batch size, created by the create_shared function of the
+ *  factories so that the instances of a batch size share their params, and a thread running
+ *  its batches, so that several batches run at the same time.
+ */
+class BatchingExecutor : public ModuleNode {
+ public:
+  /*! \brief The callback of a request, called with its outputs and "" or with an error. */
+  using Callback = std::function<void(Array<NDArray>, std::string)>;
+
+  /*!
+   * \brief Create the executors and start the threads of the instances.
+   * \param factories The graph executor factories, by batch size.
+   * \param dev The device of the executors.
+   * \param deadline_us The longest time a request waits for a batch to fill, in microseconds.
+   * \param num_instances The number of instances.
+   */
+  BatchingExecutor(const std::map<int64_t, Module>& factories, Device dev, int64_t deadline_us,
+                   int num_instances)
+      : deadline_(deadline_us) {
+    ICHECK(!factories.empty()) << "The batching executor needs a factory per batch size";
+    ICHECK_GT(num_instances, 0);
+    for (const auto& kv : factories) {
+      ICHECK_GT(kv.first, 0) << "Invalid batch size " << kv.first;
+      batch_sizes_.push_back(kv.first);
+    }
+    for (int i = 0; i < num_instances; ++i) {
+      std::vector<Module> executors;
+      for (const auto& kv : factories) {
+        Module factory = kv.second;
+        executors.push_back(factory.GetFunction("create_shared")(dev));
+      }
+      instances_.push_back(std::move(executors));
+    }
+    for (int i = 0; i < num_instances; ++i) {
+      threads_.emplace_back([this, i]() { this->Serve(i); });
+    }
+  }
+
+  ~BatchingExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  const char* type_key() const final { return "BatchingExecutor"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "submit") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        PackedFunc callback = args[1];
+        this->Submit(args[0], [callback](Array<NDArray> outputs, std::string error) {
+          callback(outputs, error);
+        });
+      });
+    } else if (name == "run") {
+      return PackedFunc(
+          [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Run(args[0]); });
+    }
+    return PackedFunc();
+  }
+
+  /*!
+   * \brief Queue a request, the callback is called on the thread of an instance.
+   * \param inputs The inputs of the request by name, of batch 1.
+   * \param callback The callback of the request.
+   */
+  void Submit(Map<String, NDArray> inputs, Callback callback) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ICHECK(!stop_);
+      queue_.push_back({std::move(inputs), std::move(callback), Clock::now()});
+    }
+    cv_.notify_one();
+  }
+
+  /*!
+   * \brief Run a request and wait for its outputs.
+   * \param inputs The inputs of the request by name, of batch 1.
+   * \return The outputs of the request.
+   */
+  Array<NDArray> Run(Map<String, NDArray> inputs) {
+    std::promise<Array<NDArray>> promise;
+    std::string error;
+    this->Submit(std::move(inputs), [&promise, &error](Array<NDArray> outputs, std::string err) {
+      error = std::move(err);
+      promise.set_value(outputs);
+    });
+    Array<NDArray> outputs = promise.get_future().get();
+    ICHECK(error.empty()) << error;
+    return outputs;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    Map<String, NDArray> inputs;
+    Callback callback;
+    Clock::time_point arrival;
+  };
+
+  /*! \brief Form the batches of an instance and run them until stopped. */
+  void Serve(int instance) {
+    size_t max_batch = static_cast<size_t>(batch_sizes_.back());
+    while (true) {
+      std::vector<Request> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        Clock::time_point deadline = queue_.front().arrival + deadline_;
+        cv_.wait_until(lock, deadline,
+                       [this, max_batch]() { return stop_ || queue_.size() >= max_batch; });
+        // Another instance may have taken the requests meanwhile.
+        size_t size = std::min(queue_.size(), max_batch);
+        for (size_t i = 0; i < size; ++i) {
+          batch.push_back(std::move(queue_.front()));
+          queue_.pop_front();
+        }
+      }
+      if (!batch.empty()) {
+        this->RunBatch(instance, &batch);
+      }
+    }
+  }
+
+  /*! \brief Run a batch of requests on an executor of an instance and call them back. */
+  void RunBatch(int instance, std::vector<Request>* batch) {
+    size_t index = std::lower_bound(batch_sizes_.begin(), batch_sizes_.end(),
+                                    static_cast<int64_t>(batch->size())) -
+                   batch_sizes_.begin();
+    Module executor = instances_[instance][index];
+    std::vector<std::vector<NDArray>> outputs(batch->size());
+    std::string error;
+    try {
+      PackedFunc get_input = executor.GetFunction("get_input");
+      for (const auto& kv : (*batch)[0].inputs) {
+        NDArray entry = get_input(kv.first);
+        ICHECK(entry.defined()) << "Cannot find the input " << kv.first;
+        for (size_t row = 0; row < batch->size(); ++row) {
+          auto it = (*batch)[row].inputs.find(kv.first);
+          ICHECK(it != (*batch)[row].inputs.end())
+              << "The requests of a batch must have the same inputs, missing " << kv.first;
+          NDArray input = (*it).second;
+          DLTensor view = RowView(entry, row, &input);
+          NDArray::CopyFromTo(input.operator->(), &view);
+        }
+      }
+      executor.GetFunction("run")();
+      PackedFunc get_output = executor.GetFunction("get_output");
+      int num_outputs = executor.GetFunction("get_num_outputs")();
+      for (int i = 0; i < num_outputs; ++i) {
+        NDArray output = get_output(i);
+        std::vector<int64_t> shape = output.Shape();
+        shape[0] = 1;
+        for (size_t row = 0; row < batch->size(); ++row) {
+          NDArray result = NDArray::Empty(shape, output->dtype, output->device);
+          DLTensor view = RowView(output, row, &result);
+          NDArray::CopyFromTo(&view, const_cast<DLTensor*>(result.operator->()));
+          outputs[row].push_back(result);
+        }
+      }
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    for (size_t row = 0; row < batch->size(); ++row) {
+      try {
+        (*batch)[row].callback(error.empty() ? Array<NDArray>(outputs[row]) : Array<NDArray>(),
+                               error);
+      } catch (const std::exception& e) {
+        LOG(WARNING) << "The callback of a request failed: " << e.what();
+      }
+    }
+  }
+
+  /*!
+   * \brief The view of a row of a batched array, checking that it has the shape of an array
+   *  of batch 1.
+   * \param batched The batched array.
+   * \param row The row.
+   * \param single The array of batch 1.
+   */
+  static DLTensor RowView(const NDArray& batched, size_t row, const NDArray* single) {
+    const DLTensor* tensor = batched.operator->();
+    const DLTensor* other = single->operator->();
+    ICHECK(tensor->ndim > 0 && static_cast<int64_t>(row) < tensor->shape[0] &&
+           other->ndim == tensor->ndim && other->shape[0] == 1 &&
+           std::equal(tensor->shape + 1, tensor->shape + tensor->ndim, other->shape + 1) &&
+           TypeEqual(tensor->dtype, other->dtype))
+        << "Expected a row of batch 1 of the batched shape " << ShapeString(tensor) << " and type "
+        << DLDataType2String(tensor->dtype) << " but got " << ShapeString(other) << " and "
+        << DLDataType2String(other->dtype);
+    ICHECK(tensor->strides == nullptr) << "The batched arrays must be compact";
+    DLTensor view = *tensor;
+    view.shape = other->shape;
+    view.byte_offset += row * GetDataSize(*other);
+    return view;
+  }
+
+  static std::string ShapeString(const DLTensor* tensor) {
+    std::ostringstream os;
+    os << "(";
+    for (int i = 0; i < tensor->ndim; ++i) {
+      os << (i ? ", " : "") << tensor->shape[i];
+    }
+    os << ")";
+    return os.str();
+  }
+
+  /*! \brief The built batch sizes, ascending. */
+  std::vector<int64_t> batch_sizes_;
+  /*! \brief The executors of each instance, by batch size. */
+  std::vector<std::vector<Module>> instances_;
+  /*! \brief The deadline of the oldest request of a batch. */
+  std::chrono::microseconds deadline_;
+  /*! \brief The threads of the instances. */
+  std::vector<std::thread> threads_;
+  /*! \brief The queued requests, guarded by mutex_. */
+  std::deque<Request> queue_;
+  bool stop_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+TVM_REGISTER_GLOBAL("tvm.batching_executor.create").set_body([](TVMArgs args, TVMRetValue* rv) {
+  ICHECK(args.num_args >= 5 && (args.num_args - 3) % 2 == 0)
+      << "Expected the device, the deadline, the number of instances, then pairs of"
+         " batch size and graph executor factory";
+  Device dev = args[0];
+  int64_t deadline_us = args[1];
+  int num_instances = args[2];
+  std::map<int64_t, Module> factories;
+  for (int i = 3; i < args.num_args; i += 2) {
+    int64_t batch_size = args[i];
+    Module factory = args[i + 1];
+    factories[batch_size] = factory;
+  }
+  *rv = Module(make_object<BatchingExecutor>(factories, dev, deadline_us, num_instances));
+});
+
+}  // namespace runtime
+}  // namespace tvm
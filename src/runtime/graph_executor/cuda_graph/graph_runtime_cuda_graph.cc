@@ -49,6 +49,8 @@ class GraphExecutorCudaGraph : public GraphExecutor {
 
     TVMStreamCreate(dev.device_type, dev.device_id, &capture_stream_);
     TVMSetStream(dev.device_type, dev.device_id, capture_stream_);
+    // The streams of the operators, if more than one, fork from and join the capture stream.
+    SetOriginStream(dev, capture_stream_);
 
     CUDA_CALL(cudaStreamBeginCapture(static_cast<cudaStream_t>(capture_stream_),
                                      cudaStreamCaptureModeGlobal));
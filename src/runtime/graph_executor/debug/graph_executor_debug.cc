@@ -302,6 +302,11 @@ class GraphExecutorDebug : public GraphExecutor {
         uint32_t eid = entry_id(i, 0);
         const Device& dev = data_entry_[eid]->device;
 
+        int64_t bytes = 0;
+        for (const NDArray& ary : shapes) {
+          bytes += static_cast<int64_t>(GetDataSize(*ary.operator->()));
+        }
+
         std::unordered_map<std::string, ObjectRef> metrics;
         for (auto p : nodes_[i].param.attrs) {
           if (std::string(p.first).find("layout") != std::string::npos) {
@@ -312,6 +317,12 @@ class GraphExecutorDebug : public GraphExecutor {
           metrics["Hash"] = Downcast<String>(nodes_[i].param.attrs.at("hash"));
         }
         metrics["Argument Shapes"] = profiling::ShapeString(shapes);
+        metrics["Bytes Accessed"] = ObjectRef(make_object<profiling::CountNode>(bytes));
+        auto flops = nodes_[i].param.attrs.find("flops");
+        if (flops != nodes_[i].param.attrs.end()) {
+          metrics["FLOPs"] = ObjectRef(make_object<profiling::CountNode>(
+              std::stoll(std::string(Downcast<String>(flops->second)))));
+        }
         prof.StartCall(nodes_[i].param.func_name, dev, metrics);
         op_execs_[i]();
         prof.StopCall();
@@ -29,12 +29,14 @@
 #include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
 #include <functional>
 #include <memory>
 #include <numeric>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -51,16 +53,405 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
 }
 }  // namespace details
 
+GraphExecutor::~GraphExecutor() {
+  if (async_run_.valid()) async_run_.wait();
+  this->ReleaseCapture();
+  for (const auto& it : copy_streams_) {
+    DeviceAPI::Get(it.first)->FreeStream(it.first, it.second);
+  }
+  for (const auto& it : device_streams_) {
+    DeviceAPI* api = DeviceAPI::Get(it.first);
+    for (TVMStreamHandle stream : it.second) {
+      api->StreamSync(it.first, stream);
+      api->FreeStream(it.first, stream);
+    }
+  }
+}
+
 /*!
  * \brief Run all the operations one by one.
  */
 void GraphExecutor::Run() {
+  threading::ThreadPoolPartitionScope partition(thread_pool_partition_);
+  this->FlushStagedInputs();
+  this->RunOps();
+}
+
+void GraphExecutor::RunOps() {
+  if (profile_interval_ > 0 && ++profile_num_runs_ % profile_interval_ == 0) {
+    this->RunOpsSampled();
+    return;
+  }
+  if (capture_mode_) {
+    if (captured_) {
+      this->RunCaptured();
+    } else {
+      this->CaptureOps();
+    }
+    return;
+  }
+  if (num_streams_ > 1) {
+    this->RunOpsMultiStream();
+    return;
+  }
+  if (num_workers_ > 1) {
+    if (!scheduler_) {
+      std::vector<std::vector<uint32_t>> op_succ;
+      std::vector<uint32_t> op_num_deps;
+      this->SetupOpDeps(&op_succ, &op_num_deps);
+      scheduler_.reset(new OpScheduler(&op_execs_, std::move(op_succ), std::move(op_num_deps),
+                                       num_workers_, num_intra_threads_));
+    }
+    scheduler_->Run();
+    return;
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
   }
 }
 
+void GraphExecutor::RunOpsSampled() {
+  std::vector<Timer> timers;
+  timers.reserve(profile_nids_.size());
+  for (uint32_t nid : profile_nids_) {
+    timers.push_back(Timer::Start(this->OpDevice(nid)));
+    if (op_execs_[nid]) op_execs_[nid]();
+    timers.back()->Stop();
+  }
+  // All timers are stopped before synchronizing any of them
+  std::vector<int64_t> latencies;
+  latencies.reserve(timers.size());
+  for (Timer& timer : timers) latencies.push_back(timer->SyncAndGetElapsedNanos());
+  std::lock_guard<std::mutex> lock(profile_mutex_);
+  size_t row = profile_num_samples_ % profile_capacity_;
+  std::copy(latencies.begin(), latencies.end(),
+            profile_samples_.begin() + row * profile_nids_.size());
+  ++profile_num_samples_;
+}
+
+/*!
+ * \brief Start running the graph on a background thread.
+ */
+void GraphExecutor::RunAsync() {
+  ICHECK(!async_run_.valid()) << "Wait for the previous run before starting a new one";
+  // The staged inputs are flushed on the calling thread, which sets the next ones.
+  this->FlushStagedInputs();
+  async_run_ = std::async(std::launch::async, [this]() { this->RunOps(); });
+}
+
+/*!
+ * \brief Wait for the run started by RunAsync.
+ */
+void GraphExecutor::Wait() {
+  if (async_run_.valid()) async_run_.get();
+}
+
+/*!
+ * \brief Set the number of threads running the operators of the graph.
+ * \param num_workers The number of threads.
+ * \param num_intra_threads The number of threads of each operator.
+ */
+void GraphExecutor::SetNumWorkers(int num_workers, int num_intra_threads) {
+  ICHECK_GE(num_workers, 1);
+  ICHECK_GE(num_intra_threads, 0);
+  ICHECK(!async_run_.valid()) << "Cannot change the number of workers during a run";
+  num_workers_ = num_workers;
+  num_intra_threads_ = num_intra_threads;
+  scheduler_.reset();
+}
+
+/*!
+ * \brief Set the number of streams the operators of each device are issued on.
+ * \param num_streams The number of streams of each device.
+ */
+void GraphExecutor::SetNumStreams(int num_streams) {
+  ICHECK_GE(num_streams, 1);
+  ICHECK(!async_run_.valid()) << "Cannot change the number of streams during a run";
+  num_streams_ = num_streams;
+  op_streams_.clear();
+  // The streams of the previous number are kept, the first ones are reused
+  for (auto& it : device_streams_) {
+    DeviceAPI* api = DeviceAPI::Get(it.first);
+    while (it.second.size() > static_cast<size_t>(num_streams)) {
+      api->StreamSync(it.first, it.second.back());
+      api->FreeStream(it.first, it.second.back());
+      it.second.pop_back();
+    }
+  }
+}
+
+void GraphExecutor::SetupOpStreams() {
+  std::vector<std::vector<uint32_t>> op_succ;
+  std::vector<uint32_t> op_num_deps;
+  this->SetupOpDeps(&op_succ, &op_num_deps, false);
+  uint32_t num_nodes = this->GetNumOfNodes();
+  std::vector<std::vector<uint32_t>> deps(num_nodes);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    for (uint32_t succ : op_succ[nid]) deps[succ].push_back(nid);
+  }
+  // The last operator issued on each stream of a device, and the last operator of each other
+  // stream it waited for.
+  struct StreamState {
+    int64_t tail;
+    std::vector<int64_t> waited;
+  };
+  std::unordered_map<Device, std::vector<StreamState>> states;
+  op_streams_.assign(num_nodes, OpStream());
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (!op_execs_[nid]) continue;
+    Device dev = this->OpDevice(nid);
+    if (dev.device_type == kDLCPU) continue;
+    std::vector<StreamState>& st = states[dev];
+    if (st.empty()) {
+      st.assign(num_streams_, StreamState{-1, std::vector<int64_t>(num_streams_, -1)});
+    }
+    auto on_device = [&](uint32_t dep) {
+      return op_streams_[dep].stream >= 0 && std::equal_to<Device>()(this->OpDevice(dep), dev);
+    };
+    // Continue the stream of a dependency, or start on the least recently used one
+    int stream = -1;
+    for (uint32_t dep : deps[nid]) {
+      if (on_device(dep) && st[op_streams_[dep].stream].tail == dep) {
+        stream = op_streams_[dep].stream;
+        break;
+      }
+    }
+    if (stream < 0) {
+      stream = 0;
+      for (int k = 1; k < num_streams_; ++k) {
+        if (st[k].tail < st[stream].tail) stream = k;
+      }
+    }
+    for (uint32_t dep : deps[nid]) {
+      if (!on_device(dep) || op_streams_[dep].stream == stream) continue;
+      int src = op_streams_[dep].stream;
+      // A wait covers the operators issued on the other stream so far
+      if (st[stream].waited[src] >= static_cast<int64_t>(dep)) continue;
+      op_streams_[nid].waits.push_back(src);
+      st[stream].waited[src] = st[src].tail;
+    }
+    op_streams_[nid].stream = stream;
+    st[stream].tail = nid;
+  }
+}
+
+void GraphExecutor::RunOpsMultiStream() {
+  if (op_streams_.empty()) this->SetupOpStreams();
+  auto origin = [this](const Device& dev) {
+    auto it = origin_streams_.find(dev);
+    return it != origin_streams_.end() ? it->second : nullptr;
+  };
+  // The streams fork from the origin stream, which holds the work issued before the run
+  std::vector<Device> devs;
+  for (const Device& dev : devices_) {
+    if (dev.device_type == kDLCPU ||
+        std::any_of(devs.begin(), devs.end(),
+                    [&dev](const Device& d) { return std::equal_to<Device>()(d, dev); })) {
+      continue;
+    }
+    devs.push_back(dev);
+    DeviceAPI* api = DeviceAPI::Get(dev);
+    std::vector<TVMStreamHandle>& streams = device_streams_[dev];
+    while (streams.size() < static_cast<size_t>(num_streams_)) {
+      streams.push_back(api->CreateStream(dev));
+    }
+    for (TVMStreamHandle stream : streams) api->SyncStreamFromTo(dev, origin(dev), stream);
+  }
+  for (size_t nid = 0; nid < op_execs_.size(); ++nid) {
+    if (!op_execs_[nid]) continue;
+    const OpStream& op = op_streams_[nid];
+    if (op.stream < 0) {
+      op_execs_[nid]();
+      continue;
+    }
+    Device dev = this->OpDevice(nid);
+    DeviceAPI* api = DeviceAPI::Get(dev);
+    const std::vector<TVMStreamHandle>& streams = device_streams_[dev];
+    for (int src : op.waits) api->SyncStreamFromTo(dev, streams[src], streams[op.stream]);
+    api->SetStream(dev, streams[op.stream]);
+    op_execs_[nid]();
+  }
+  // The origin stream joins the streams, and is the current one again
+  for (const Device& dev : devs) {
+    DeviceAPI* api = DeviceAPI::Get(dev);
+    for (TVMStreamHandle stream : device_streams_[dev]) {
+      api->SyncStreamFromTo(dev, stream, origin(dev));
+    }
+    api->SetStream(dev, origin(dev));
+  }
+}
+
+/*!
+ * \brief Time the operators of every interval-th run.
+ * \param interval The number of runs between two sampled runs.
+ * \param capacity The number of sampled runs kept.
+ */
+void GraphExecutor::SetProfileSampling(int interval, int capacity) {
+  ICHECK_GE(interval, 0);
+  ICHECK_GT(capacity, 0);
+  ICHECK(!async_run_.valid()) << "Cannot change the profile sampling during a run";
+  std::lock_guard<std::mutex> lock(profile_mutex_);
+  profile_interval_ = interval;
+  profile_capacity_ = capacity;
+  profile_num_runs_ = 0;
+  profile_num_samples_ = 0;
+  profile_nids_.clear();
+  for (uint32_t nid = 0; nid < this->GetNumOfNodes(); ++nid) {
+    if (nodes_[nid].op_type != "null") profile_nids_.push_back(nid);
+  }
+  profile_samples_.assign(interval > 0 ? profile_nids_.size() * capacity : 0, 0);
+}
+
+/*!
+ * \brief Get the latencies of the operators in the kept sampled runs.
+ * \return The latencies of each operator by node name.
+ */
+Map<String, NDArray> GraphExecutor::GetProfileSamples() {
+  std::lock_guard<std::mutex> lock(profile_mutex_);
+  uint64_t capacity = static_cast<uint64_t>(profile_capacity_);
+  int64_t num_kept = static_cast<int64_t>(std::min(profile_num_samples_, capacity));
+  // The oldest kept sample is overwritten next
+  uint64_t first = profile_num_samples_ - num_kept;
+  Map<String, NDArray> samples;
+  std::vector<int64_t> latencies(num_kept);
+  for (size_t i = 0; i < profile_nids_.size(); ++i) {
+    for (int64_t k = 0; k < num_kept; ++k) {
+      size_t row = (first + k) % capacity;
+      latencies[k] = profile_samples_[row * profile_nids_.size() + i];
+    }
+    NDArray arr = NDArray::Empty({num_kept}, DLDataType{kDLInt, 64, 1}, {kDLCPU, 0});
+    if (num_kept > 0) arr.CopyFromBytes(latencies.data(), latencies.size() * sizeof(int64_t));
+    samples.Set(nodes_[profile_nids_[i]].name, arr);
+  }
+  return samples;
+}
+
+/*!
+ * \brief Run the graph once while capturing the work of its operators.
+ */
+void GraphExecutor::Capture() {
+  ICHECK(!async_run_.valid()) << "Cannot capture the graph during a run";
+  capture_mode_ = true;
+  this->FlushStagedInputs();
+  this->CaptureOps();
+}
+
+/*!
+ * \brief Set whether the runs replay the captured work.
+ * \param enabled Whether to enable capture mode.
+ */
+void GraphExecutor::SetCaptureMode(bool enabled) {
+  ICHECK(!async_run_.valid()) << "Cannot change the capture mode during a run";
+  capture_mode_ = enabled;
+}
+
+void GraphExecutor::CaptureOps() {
+  this->ReleaseCapture();
+  for (size_t i = 0; i < op_execs_.size(); ++i) {
+    if (!op_execs_[i]) continue;
+    Device dev = this->OpDevice(i);
+    DeviceAPI* api = dev.device_type != kDLCPU ? DeviceAPI::Get(dev) : nullptr;
+    void* graph = nullptr;
+    if (api != nullptr && api->CaptureBegin(dev)) {
+      op_execs_[i]();
+      graph = api->CaptureEnd(dev);
+    } else {
+      op_execs_[i]();
+    }
+    if (!captured_segments_.empty()) {
+      CapturedSegment& last = captured_segments_.back();
+      // Operators that were not captured run together, whatever their device
+      bool merge = graph == nullptr && last.graph == nullptr;
+      if (graph != nullptr && last.graph != nullptr && std::equal_to<Device>()(last.dev, dev)) {
+        merge = api->CaptureAppend(dev, last.graph, graph);
+      }
+      if (merge) {
+        last.end = i + 1;
+        continue;
+      }
+    }
+    captured_segments_.push_back(CapturedSegment{i, i + 1, dev, graph});
+  }
+  captured_data_.resize(data_entry_.size());
+  for (uint32_t eid = 0; eid < data_entry_.size(); ++eid) {
+    captured_data_[eid] = this->EntryData(eid);
+  }
+  captured_ = true;
+}
+
+void GraphExecutor::RunCaptured() {
+  // Redirect the captured work to the entries swapped in since, or capture it again
+  for (uint32_t eid = 0; eid < captured_data_.size(); ++eid) {
+    void* data = this->EntryData(eid);
+    if (captured_data_[eid] == data) continue;
+    for (const CapturedSegment& seg : captured_segments_) {
+      if (seg.graph == nullptr) continue;
+      if (!DeviceAPI::Get(seg.dev)->CaptureRebind(seg.dev, seg.graph, captured_data_[eid], data)) {
+        this->CaptureOps();
+        return;
+      }
+    }
+    captured_data_[eid] = data;
+  }
+  // The devices with replayed work that was not waited for yet
+  std::vector<Device> pending;
+  auto sync_pending = [&pending](const Device* keep) {
+    std::vector<Device> rest;
+    for (const Device& dev : pending) {
+      if (keep != nullptr && std::equal_to<Device>()(dev, *keep)) {
+        rest.push_back(dev);
+      } else {
+        DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+      }
+    }
+    pending.swap(rest);
+  };
+  for (const CapturedSegment& seg : captured_segments_) {
+    if (seg.graph != nullptr) {
+      // Work replayed on another device may be consumed by the segment
+      sync_pending(&seg.dev);
+      DeviceAPI::Get(seg.dev)->CaptureReplay(seg.dev, seg.graph, nullptr);
+      if (pending.empty()) pending.push_back(seg.dev);
+    } else {
+      sync_pending(nullptr);
+      for (size_t i = seg.begin; i < seg.end; ++i) {
+        if (op_execs_[i]) op_execs_[i]();
+      }
+    }
+  }
+  sync_pending(nullptr);
+}
+
+void GraphExecutor::ReleaseCapture() {
+  for (const CapturedSegment& seg : captured_segments_) {
+    if (seg.graph == nullptr) continue;
+    DeviceAPI* api = DeviceAPI::Get(seg.dev);
+    api->StreamSync(seg.dev, nullptr);
+    api->CaptureFree(seg.dev, seg.graph);
+  }
+  captured_segments_.clear();
+  captured_data_.clear();
+  captured_ = false;
+}
+
+Device GraphExecutor::OpDevice(uint32_t nid) const {
+  if (attrs_.device_index.empty() || nodes_[nid].param.num_outputs == 0) return devices_[0];
+  int device_type = attrs_.device_index[this->entry_id(nid, 0)];
+  for (const Device& dev : devices_) {
+    if (static_cast<int>(dev.device_type) == device_type) return dev;
+  }
+  return devices_[0];
+}
+
+void* GraphExecutor::EntryData(uint32_t eid) const {
+  // Inputs set by SetInputZeroCopy are only rebound in the arguments of the operators
+  if (eid < input_dltensors_.size() && !input_dltensors_[eid].empty()) {
+    return input_dltensors_[eid].front()->data;
+  }
+  return data_entry_[eid]->data;
+}
+
 /*!
  * \brief Initialize the graph executor with graph and device.
  * \param graph_json The execution graph.
@@ -91,6 +482,39 @@ void GraphExecutor::Init(const std::string& graph_json, tvm::runtime::Module mod
     input_map_[name] = i;
   }
 }
+/*!
+ * \brief Initialize the graph executor as another instance of an initialized one.
+ * \param other The executor to share the graph and params with.
+ * \param param_names The names of the inputs to share.
+ */
+void GraphExecutor::InitShared(const GraphExecutor& other,
+                               const std::vector<std::string>& param_names) {
+  nodes_ = other.nodes_;
+  input_nodes_ = other.input_nodes_;
+  input_map_ = other.input_map_;
+  node_row_ptr_ = other.node_row_ptr_;
+  outputs_ = other.outputs_;
+  attrs_ = other.attrs_;
+  module_ = other.module_;
+  devices_ = other.devices_;
+  lookup_linked_param_ = PackedFunc(
+      [this](TVMArgs args, TVMRetValue* rv) { this->DefaultLookupLinkedParam(args, rv); });
+  // Share the storage only holding params, the memory plan may reuse the others.
+  std::unordered_set<uint32_t> param_eids, shared_sids;
+  for (const std::string& name : param_names) {
+    int in_idx = GetInputIndex(name);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    param_eids.insert(eid);
+    shared_sids.insert(static_cast<uint32_t>(attrs_.storage_id[eid]));
+  }
+  for (uint32_t eid = 0; eid < num_node_entries(); ++eid) {
+    if (param_eids.count(eid) == 0) shared_sids.erase(attrs_.storage_id[eid]);
+  }
+  this->SetupStorage(&other.storage_pool_, shared_sids);
+  this->SetupOpExecs();
+}
+
 /*!
  * \brief Get the input index given the name of input.
  * \param name The name of the input.
@@ -111,8 +535,93 @@ int GraphExecutor::GetInputIndex(const std::string& name) {
 void GraphExecutor::SetInput(int index, DLTensor* data_in) {
   ICHECK_LT(static_cast<size_t>(index), input_nodes_.size());
   uint32_t eid = this->entry_id(input_nodes_[index], 0);
+  if (num_staging_slots_ > 0 && data_entry_[eid]->device.device_type != kDLCPU &&
+      data_in->device.device_type == kDLCPU) {
+    this->StageInput(index, data_in);
+    return;
+  }
+  if (!staged_slot_.empty()) staged_slot_[index] = -1;
   data_entry_[eid].CopyFrom(data_in);
 }
+/*!
+ * \brief set several inputs of the graph.
+ * \param indices The input indices.
+ * \param data_in The input data.
+ */
+void GraphExecutor::SetInputs(const std::vector<int>& indices,
+                              const std::vector<DLTensor*>& data_in) {
+  ICHECK_EQ(indices.size(), data_in.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    this->SetInput(indices[i], data_in[i]);
+  }
+}
+/*!
+ * \brief Stage the CPU data of the inputs on other devices.
+ * \param num_slots The number of host buffers of each input.
+ */
+void GraphExecutor::SetInputStaging(int num_slots) {
+  ICHECK_GE(num_slots, 0);
+  this->FlushStagedInputs();
+  for (const auto& it : copy_streams_) {
+    DeviceAPI::Get(it.first)->StreamSync(it.first, it.second);
+  }
+  num_staging_slots_ = num_slots;
+  staging_ring_.assign(num_slots > 0 ? input_nodes_.size() : 0, {});
+  staging_next_.assign(staging_ring_.size(), 0);
+  staged_slot_.assign(staging_ring_.size(), -1);
+}
+
+void GraphExecutor::StageInput(int index, DLTensor* data_in) {
+  uint32_t eid = this->entry_id(input_nodes_[index], 0);
+  const NDArray& entry = data_entry_[eid];
+  std::vector<StagingSlot>& ring = staging_ring_[index];
+  if (ring.empty()) {
+    // Page-locked host memory makes the copies to CUDA devices asynchronous.
+    Device host{entry->device.device_type == kDLCUDA ? kDLCUDAHost : kDLCPU, 0};
+    std::vector<int64_t> shape(entry->shape, entry->shape + entry->ndim);
+    ring.resize(num_staging_slots_);
+    for (StagingSlot& slot : ring) {
+      slot.data = NDArray::Empty(shape, entry->dtype, host);
+    }
+  }
+  uint32_t slot_id = staging_next_[index];
+  staging_next_[index] = (slot_id + 1) % ring.size();
+  StagingSlot& slot = ring[slot_id];
+  if (slot.in_flight) {
+    Device dev = entry->device;
+    DeviceAPI::Get(dev)->StreamSync(dev, this->CopyStream(dev));
+    slot.in_flight = false;
+  }
+  slot.data.CopyFrom(data_in);
+  staged_slot_[index] = static_cast<int>(slot_id);
+}
+
+void GraphExecutor::FlushStagedInputs() {
+  for (size_t index = 0; index < staged_slot_.size(); ++index) {
+    if (staged_slot_[index] < 0) continue;
+    StagingSlot& slot = staging_ring_[index][staged_slot_[index]];
+    staged_slot_[index] = -1;
+    uint32_t eid = this->entry_id(input_nodes_[index], 0);
+    DLTensor* to = const_cast<DLTensor*>(data_entry_[eid].operator->());
+    Device dev = to->device;
+    DeviceAPI* api = DeviceAPI::Get(dev);
+    TVMStreamHandle stream = this->CopyStream(dev);
+    // The copy waits for the previous run to be done with the input, the next run
+    // waits for the copy.
+    api->SyncStreamFromTo(dev, nullptr, stream);
+    api->CopyDataFromTo(const_cast<DLTensor*>(slot.data.operator->()), to, stream);
+    api->SyncStreamFromTo(dev, stream, nullptr);
+    slot.in_flight = true;
+  }
+}
+
+TVMStreamHandle GraphExecutor::CopyStream(Device dev) {
+  auto it = copy_streams_.find(dev);
+  if (it != copy_streams_.end()) return it->second;
+  TVMStreamHandle stream = DeviceAPI::Get(dev)->CreateStream(dev);
+  copy_streams_[dev] = stream;
+  return stream;
+}
 /*!
  * \brief set index-th input to the graph without copying the data.
  * \param index The input index.
@@ -120,12 +629,23 @@ void GraphExecutor::SetInput(int index, DLTensor* data_in) {
  */
 void GraphExecutor::SetInputZeroCopy(int index, DLTensor* data_ref) {
   ICHECK_LT(static_cast<size_t>(index), input_nodes_.size());
+  if (!staged_slot_.empty()) staged_slot_[index] = -1;
   uint32_t eid = this->entry_id(input_nodes_[index], 0);
   const DLTensor* old_t = data_entry_[eid].operator->();
 
   // check the consistency of input
+  void* data = data_ref->data;
+  ICHECK(IsContiguous(*data_ref)) << "The zero copy inputs must be compact, a strided view needs "
+                                  << "set_input to copy it";
+  if (data_ref->byte_offset != 0) {
+    // Views of compact memory pass their offset in the data pointer, the kernels take none
+    ICHECK(CanFoldByteOffset(*data_ref)) << "The zero copy inputs on "
+                                         << DeviceName(data_ref->device.device_type)
+                                         << " must have no byte offset";
+    data = static_cast<char*>(data) + data_ref->byte_offset;
+  }
   ICHECK_EQ(data_alignment_[eid], details::GetDataAlignment(*data_ref));
-  ICHECK_EQ(reinterpret_cast<size_t>(data_ref->data) % kAllocAlignment, 0);
+  ICHECK_EQ(reinterpret_cast<size_t>(data) % kAllocAlignment, 0);
   ICHECK_EQ(old_t->ndim, static_cast<size_t>(data_ref->ndim));
   ICHECK_EQ(old_t->device.device_type, data_ref->device.device_type);
   ICHECK_EQ(old_t->device.device_id, data_ref->device.device_id);
@@ -135,7 +655,7 @@ void GraphExecutor::SetInputZeroCopy(int index, DLTensor* data_ref) {
 
   // Update the data pointer for each argument of each op
   for (DLTensor* t : input_dltensors_[eid]) {
-    t->data = data_ref->data;
+    t->data = data;
   }
 }
 /*!
@@ -190,6 +710,16 @@ void GraphExecutor::CopyOutputTo(int index, DLTensor* data_out) {
 
   data_entry_[eid].CopyTo(data_out);
 }
+/*!
+ * \brief Copy all the outputs.
+ * \param data_out The output data, one per output.
+ */
+void GraphExecutor::CopyOutputsTo(const std::vector<DLTensor*>& data_out) {
+  ICHECK_EQ(data_out.size(), outputs_.size());
+  for (size_t i = 0; i < data_out.size(); ++i) {
+    this->CopyOutputTo(static_cast<int>(i), data_out[i]);
+  }
+}
 
 /*!
  * \brief Load parameters from parameter blob.
@@ -210,6 +740,39 @@ void GraphExecutor::LoadParams(dmlc::Stream* strm) {
   }
 }
 
+void GraphExecutor::LoadParamsFromFile(const std::string& file_name) {
+  Map<String, NDArray> params = ::tvm::runtime::LoadParamsMapped(file_name);
+  std::vector<uint32_t> sid_uses(storage_pool_.size(), 0);
+  for (int sid : attrs_.storage_id) {
+    ++sid_uses[sid];
+  }
+  bool rebind = false;
+  for (auto& p : params) {
+    int in_idx = GetInputIndex(p.first);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    int sid = attrs_.storage_id[eid];
+    const NDArray& arr = p.second;
+    const NDArray& entry = data_entry_[eid];
+    bool alias = entry->device.device_type == kDLCPU && sid_uses[sid] == 1 &&
+                 arr->ndim == entry->ndim && std::equal(arr->shape, arr->shape + arr->ndim,
+                                                        entry->shape) &&
+                 arr->dtype.code == entry->dtype.code && arr->dtype.bits == entry->dtype.bits &&
+                 arr->dtype.lanes == entry->dtype.lanes;
+    if (alias) {
+      // Release the allocated storage of the entry
+      storage_pool_[sid] = arr;
+      data_entry_[eid] = arr;
+      data_alignment_[eid] = details::GetDataAlignment(*arr.operator->());
+      rebind = true;
+    } else {
+      data_entry_[eid].CopyFrom(arr);
+    }
+  }
+  // The operators hold the data pointers of their arguments
+  if (rebind) this->SetupOpExecs();
+}
+
 void GraphExecutor::ShareParams(const GraphExecutor& other, dmlc::Stream* strm) {
   uint64_t header, reserved;
   ICHECK(strm->Read(&header)) << "Invalid parameters file format";
@@ -241,6 +804,12 @@ void GraphExecutor::LinkedNDArrayDeleter(Object* container) {
   delete static_cast<NDArray::Container*>(container);
 }
 
+void GraphExecutor::ArenaNDArrayDeleter(Object* container) {
+  NDArray::Container* ptr = static_cast<NDArray::Container*>(container);
+  static_cast<NDArray::Container*>(ptr->manager_ctx)->DecRef();
+  delete ptr;
+}
+
 void GraphExecutor::DefaultLookupLinkedParam(TVMArgs args, TVMRetValue* rv) {
   Module mod = args[0];
   int64_t storage_id = args[1];
@@ -272,7 +841,8 @@ void GraphExecutor::DefaultLookupLinkedParam(TVMArgs args, TVMRetValue* rv) {
   *rv = NDArray(GetObjectPtr<Object>(container.release()));
 }
 
-void GraphExecutor::SetupStorage() {
+void GraphExecutor::SetupStorage(const std::vector<NDArray>* shared_pool,
+                                 const std::unordered_set<uint32_t>& shared_sids) {
   // Grab saved optimization plan from graph.
   std::vector<DLDataType> vtype;
   for (const std::string& s_type : attrs_.dltype) {
@@ -320,17 +890,66 @@ void GraphExecutor::SetupStorage() {
     pool_entry[sid].param_data_entry = i;
     pool_entry[sid].size = std::max(pool_entry[sid].size, bytes);
     pool_entry[sid].device_type = device_type;
+    if (!attrs_.storage_offset.empty()) {
+      pool_entry[sid].offset = attrs_.storage_offset[i];
+    }
   }
 
-  // Allocate the space.
-  for (const auto& pit : pool_entry) {
-    // This for loop is very fast since there are usually only a couple of
-    // devices available on the same hardware.
+  // This for loop is very fast since there are usually only a couple of
+  // devices available on the same hardware.
+  auto storage_device = [this](const PoolEntry& pit) {
     const auto& cit = std::find_if(devices_.begin(), devices_.end(), [&pit](const Device& d) {
       return pit.device_type == static_cast<int>(d.device_type);
     });
-    Device dev = cit == devices_.end() ? devices_[0] : *cit;
-    if (pit.linked_param.defined()) {
+    return cit == devices_.end() ? devices_[0] : *cit;
+  };
+  // The storages planned into an arena of a device are carved out of a single
+  // allocation. Offsets are only meaningful on devices with flat addresses,
+  // the storages of the other devices are allocated separately.
+  auto in_arena = [&](size_t sid) {
+    const auto& pit = pool_entry[sid];
+    if (pit.offset < 0 || shared_sids.count(sid) || pit.linked_param.defined()) return false;
+    DLDeviceType device_type = storage_device(pit).device_type;
+    return device_type == kDLCPU || device_type == kDLCUDA || device_type == kDLCUDAHost ||
+           device_type == kDLROCM;
+  };
+  std::unordered_map<int, size_t> arena_bytes;
+  for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+    if (!in_arena(sid)) continue;
+    size_t end = static_cast<size_t>(pool_entry[sid].offset) + pool_entry[sid].size;
+    arena_bytes[pool_entry[sid].device_type] =
+        std::max(arena_bytes[pool_entry[sid].device_type], end);
+  }
+  std::unordered_map<int, NDArray> arenas;
+  for (const auto& kv : arena_bytes) {
+    PoolEntry pit;
+    pit.device_type = kv.first;
+    std::vector<int64_t> shape{static_cast<int64_t>(kv.second + 3) / 4};
+    arenas[kv.first] = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, storage_device(pit));
+  }
+
+  // Allocate the space.
+  for (size_t sid = 0; sid < pool_entry.size(); ++sid) {
+    const auto& pit = pool_entry[sid];
+    if (shared_sids.count(sid)) {
+      ICHECK(shared_pool != nullptr && sid < shared_pool->size());
+      storage_pool_.push_back((*shared_pool)[sid]);
+      continue;
+    }
+    Device dev = storage_device(pit);
+    if (in_arena(sid)) {
+      const NDArray& arena = arenas.at(pit.device_type);
+      std::vector<int64_t> shape{static_cast<int64_t>(pit.size + 3) / 4};
+      NDArray::Container* container =
+          new NDArray::Container(static_cast<char*>(arena->data) + pit.offset, shape,
+                                 DLDataType{kDLFloat, 32, 1}, dev);
+      NDArray::Container* arena_container =
+          static_cast<NDArray::Container*>(const_cast<Object*>(arena.get()));
+      arena_container->IncRef();
+      container->manager_ctx = arena_container;
+      container->SetDeleter(GraphExecutor::ArenaNDArrayDeleter);
+      storage_pool_.push_back(NDArray(GetObjectPtr<Object>(container)));
+    } else if (pit.linked_param.defined()) {
       storage_pool_.push_back(pit.linked_param);
     } else {
       std::vector<int64_t> shape;
@@ -355,8 +974,10 @@ void GraphExecutor::SetupStorage() {
 }
 
 void GraphExecutor::SetupOpExecs() {
+  // The captured work belongs to the previous operators
+  this->ReleaseCapture();
   op_execs_.resize(this->GetNumOfNodes());
-  input_dltensors_.resize(num_node_entries());
+  input_dltensors_.assign(num_node_entries(), {});
   std::unordered_set<uint32_t> input_node_eids;
   for (size_t i = 0; i < input_nodes_.size(); i++) {
     uint32_t nid = input_nodes_[i];
@@ -391,6 +1012,60 @@ void GraphExecutor::SetupOpExecs() {
   }
 }
 
+void GraphExecutor::SetupOpDeps(std::vector<std::vector<uint32_t>>* op_succ,
+                                std::vector<uint32_t>* op_num_deps, bool order_devices) {
+  uint32_t num_nodes = this->GetNumOfNodes();
+  std::vector<std::vector<uint32_t>> deps(num_nodes);
+  // The memory plan reuses storage, so the operators also wait on the last writer
+  // of the storage they read and on the readers of the storage they overwrite.
+  std::unordered_map<int, uint32_t> last_writer;
+  std::unordered_map<int, std::vector<uint32_t>> readers;
+  // The last operator on each device other than the CPU.
+  std::unordered_map<int, uint32_t> last_on_device;
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (!op_execs_[nid]) continue;
+    const auto& inode = nodes_[nid];
+    std::vector<uint32_t>& ndeps = deps[nid];
+    auto add_dep = [&](uint32_t dep) {
+      if (dep != nid && std::find(ndeps.begin(), ndeps.end(), dep) == ndeps.end()) {
+        ndeps.push_back(dep);
+      }
+    };
+    for (const auto& e : inode.inputs) {
+      int sid = attrs_.storage_id[this->entry_id(e)];
+      auto it = last_writer.find(sid);
+      if (it != last_writer.end()) add_dep(it->second);
+      readers[sid].push_back(nid);
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      int sid = attrs_.storage_id[this->entry_id(nid, index)];
+      auto it = last_writer.find(sid);
+      if (it != last_writer.end()) add_dep(it->second);
+      for (uint32_t reader : readers[sid]) add_dep(reader);
+      readers[sid].clear();
+      last_writer[sid] = nid;
+    }
+    if (inode.param.num_outputs == 0) continue;
+    int device_type = static_cast<int>(devices_[0].device_type);
+    if (!attrs_.device_index.empty()) {
+      device_type = attrs_.device_index[this->entry_id(nid, 0)];
+    }
+    if (device_type != kDLCPU && order_devices) {
+      auto it = last_on_device.find(device_type);
+      if (it != last_on_device.end()) add_dep(it->second);
+      last_on_device[device_type] = nid;
+    }
+  }
+  op_succ->assign(num_nodes, {});
+  op_num_deps->assign(num_nodes, 0);
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    for (uint32_t dep : deps[nid]) {
+      (*op_succ)[dep].push_back(nid);
+    }
+    (*op_num_deps)[nid] = static_cast<uint32_t>(deps[nid].size());
+  }
+}
+
 std::pair<std::function<void()>, std::shared_ptr<GraphExecutor::OpArgs> >
 GraphExecutor::CreateTVMOp(const TVMOpParam& param, const std::vector<DLTensor>& args,
                            size_t num_inputs) {
@@ -431,6 +1106,25 @@ GraphExecutor::CreateTVMOp(const TVMOpParam& param, const std::vector<DLTensor>&
   // code.
   tvm::runtime::PackedFunc pf = module_.GetFunction(param.func_name, true);
   ICHECK(pf != nullptr) << "no such function in module: " << param.func_name;
+  // The entry without the checks of the arguments, built with tir.unchecked_entry. The shapes
+  // and types of the arguments of an op are fixed, and the new inputs checked against them, so
+  // the op is only checked once, on its first run.
+  tvm::runtime::PackedFunc unchecked = module_.GetFunction(param.func_name + "_unchecked", true);
+  if (unchecked != nullptr) {
+    auto checked = std::make_shared<bool>(false);
+    auto fexec = [arg_ptr, pf, unchecked, checked]() {
+      TVMRetValue rv;
+      TVMArgs targs(arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
+                    static_cast<int>(arg_ptr->arg_values.size()));
+      if (*checked) {
+        unchecked.CallPacked(targs, &rv);
+      } else {
+        pf.CallPacked(targs, &rv);
+        *checked = true;
+      }
+    };
+    return {fexec, arg_ptr};
+  }
 
   auto fexec = [arg_ptr, pf]() {
     TVMRetValue rv;
@@ -453,6 +1147,40 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
         this->SetInput(args[0], args[1]);
       }
     });
+  } else if (name == "set_inputs") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_EQ(args.num_args % 2, 0) << "set_inputs takes pairs of input key and data";
+      std::vector<int> indices;
+      std::vector<DLTensor*> data_in;
+      for (int i = 0; i < args.num_args; i += 2) {
+        int in_idx = String::CanConvertFrom(args[i])
+                         ? this->GetInputIndex(args[i].operator String())
+                         : static_cast<int>(args[i]);
+        if (in_idx < 0) continue;
+        indices.push_back(in_idx);
+        data_in.push_back(args[i + 1]);
+      }
+      this->SetInputs(indices, data_in);
+    });
+  } else if (name == "set_input_staging") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetInputStaging(args[0]); });
+  } else if (name == "get_outputs") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args.num_args == 0) {
+        Array<NDArray> outputs;
+        for (int i = 0; i < this->NumOutputs(); ++i) {
+          outputs.push_back(this->GetOutput(i));
+        }
+        *rv = outputs;
+        return;
+      }
+      std::vector<DLTensor*> data_out;
+      for (int i = 0; i < args.num_args; ++i) {
+        data_out.push_back(args[i]);
+      }
+      this->CopyOutputsTo(data_out);
+    });
   } else if (name == "set_input_zero_copy") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       if (String::CanConvertFrom(args[0])) {
@@ -490,10 +1218,43 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumInputs(); });
   } else if (name == "run") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+  } else if (name == "run_async") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->RunAsync(); });
+  } else if (name == "wait") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Wait(); });
+  } else if (name == "capture") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Capture(); });
+  } else if (name == "set_capture_mode") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetCaptureMode(static_cast<bool>(args[0]));
+    });
+  } else if (name == "set_thread_pool_partition") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetThreadPoolPartition(args[0]);
+    });
+  } else if (name == "set_profile_sampling") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetProfileSampling(args[0], args[1]);
+    });
+  } else if (name == "get_profile_samples") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->GetProfileSamples();
+    });
+  } else if (name == "set_num_workers") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetNumWorkers(args[0], args.num_args > 1 ? static_cast<int>(args[1]) : 0);
+    });
+  } else if (name == "set_num_streams") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetNumStreams(args[0]); });
   } else if (name == "load_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       this->LoadParams(args[0].operator std::string());
     });
+  } else if (name == "load_params_from_file") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsFromFile(args[0].operator std::string());
+    });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       const auto& module = args[0].operator Module();
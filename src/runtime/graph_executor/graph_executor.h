@@ -31,12 +31,17 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "op_scheduler.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -83,8 +88,93 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \return The type key of the executor.
    */
   const char* type_key() const final { return "GraphExecutor"; }
+  /*! \brief Wait for the asynchronous run and release the copy streams. */
+  ~GraphExecutor();
   void Run();
 
+  /*!
+   * \brief Start running the graph on a background thread.
+   *
+   *  The inputs and outputs of the graph must not be accessed until Wait returns.
+   */
+  void RunAsync();
+
+  /*!
+   * \brief Wait for the run started by RunAsync, rethrowing its error if any.
+   */
+  void Wait();
+
+  /*!
+   * \brief Set the number of threads running the operators of the graph.
+   *
+   *  With more than one worker, an operator runs as soon as the operators it depends
+   *  on are done, so that the independent branches of the graph run concurrently.
+   *  The operators of each device other than the CPU run in order, as on a stream.
+   * \param num_workers The number of threads, 1 runs the operators one by one.
+   * \param num_intra_threads The number of threads running the parallel loops of each
+   *  operator, 0 shares the cores evenly between the workers.
+   */
+  void SetNumWorkers(int num_workers, int num_intra_threads = 0);
+
+  /*!
+   * \brief Set the number of streams the operators of each device other than the CPU are
+   *  issued on.
+   *
+   *  With more than one stream, an operator is issued on the stream of the operator it depends
+   *  on when it is the last one of the stream, and on the least recently used stream otherwise.
+   *  It then waits with events on the streams of the other operators it depends on, so that
+   *  the independent branches of the graph run concurrently on the device. The streams fork
+   *  from the origin stream of the device at the start of a run and join it at the end, so a
+   *  run captured on the origin stream, e.g. into a CUDA graph, captures all of them. The
+   *  operators are issued one by one by the calling thread, whatever the number of workers.
+   * \param num_streams The number of streams of each device, 1 issues the operators on the
+   *  current stream.
+   */
+  void SetNumStreams(int num_streams);
+
+  /*!
+   * \brief Run the graph once while capturing the work of its operators, and enable
+   *  capture mode.
+   *
+   *  Consecutive operators captured on the same device are replayed as one by the
+   *  later runs, those whose device cannot capture them run through their function.
+   */
+  void Capture();
+
+  /*!
+   * \brief Set whether the runs replay the captured work, capturing it on the first run.
+   *
+   *  The captured work is redirected to the data of the inputs set by SetInputZeroCopy.
+   *  In capture mode the operators run one by one, whatever the number of workers.
+   * \param enabled Whether to enable capture mode.
+   */
+  void SetCaptureMode(bool enabled);
+
+  /*!
+   * \brief Run the parallel operators on a thread pool partition.
+   * \param partition The partition created by "runtime.config_threadpool_partition", or -1
+   *  for the thread pool of the thread that runs the graph.
+   */
+  void SetThreadPoolPartition(int partition) { thread_pool_partition_ = partition; }
+
+  /*!
+   * \brief Time the operators of every interval-th run.
+   *
+   *  The sampled runs time each operator with the timer of its device, running the
+   *  operators one by one. The latencies of the last capacity sampled runs are kept.
+   * \param interval The number of runs between two sampled runs, 0 disables sampling.
+   * \param capacity The number of sampled runs kept.
+   */
+  void SetProfileSampling(int interval, int capacity);
+
+  /*!
+   * \brief Get the latencies of the operators in the kept sampled runs.
+   *
+   *  This can be called while the graph runs.
+   * \return The latencies in nanoseconds of each operator by node name, oldest first.
+   */
+  Map<String, NDArray> GetProfileSamples();
+
   /*!
    * \brief Initialize the graph executor with graph and device.
    * \param graph_json The execution graph.
@@ -100,6 +190,17 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   void Init(const std::string& graph_json, tvm::runtime::Module module,
             const std::vector<Device>& devs, const PackedFunc lookup_linked_param_func = nullptr);
 
+  /*!
+   * \brief Initialize the graph executor as another instance of an initialized one.
+   *
+   *  The instance runs the same graph and module on the same devices. The storage of the
+   *  given params is shared with the other executor, so only the activations are allocated.
+   *  Setting a shared param on either executor changes it for both.
+   * \param other The executor to share the graph and params with.
+   * \param param_names The names of the inputs to share.
+   */
+  void InitShared(const GraphExecutor& other, const std::vector<std::string>& param_names);
+
   /*!
    * \brief Get the input index given the name of input.
    * \param name The name of the input.
@@ -113,6 +214,23 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param data_in The input data.
    */
   void SetInput(int index, DLTensor* data_in);
+  /*!
+   * \brief set several inputs of the graph in one call.
+   * \param indices The input indices.
+   * \param data_in The input data.
+   */
+  void SetInputs(const std::vector<int>& indices, const std::vector<DLTensor*>& data_in);
+  /*!
+   * \brief Stage the CPU data of the inputs on other devices in a ring of host buffers.
+   *
+   *  SetInput then only copies the data to the next host buffer of the input, page-locked
+   *  for CUDA devices, and the next run issues the copies to the devices on a copy stream
+   *  that the operators wait on. The data of the next frame can thus be set while a run
+   *  started by RunAsync is in progress. GetInput returns the data of the last run until
+   *  the next one starts.
+   * \param num_slots The number of host buffers of each input, 0 disables staging.
+   */
+  void SetInputStaging(int num_slots);
   /*!
    * \brief set index-th input to the graph without copying the data
    * \param index The input index.
@@ -151,11 +269,24 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param data_out the output data.
    */
   void CopyOutputTo(int index, DLTensor* data_out);
+  /*!
+   * \brief Copy all the outputs in one call.
+   * \param data_out The output data, one per output.
+   */
+  void CopyOutputsTo(const std::vector<DLTensor*>& data_out);
   /*!
    * \brief Load parameters from binary stream
    * \param strm The input stream.
    */
   void LoadParams(dmlc::Stream* strm);
+  /*!
+   * \brief Load parameters from a file mapped in memory.
+   *
+   *  The aligned parameters of the file alias the mapping when their storage is on the CPU
+   *  and holds no other entry, the others are copied from the mapping to their storage.
+   * \param file_name The parameter file, saved with an alignment by SaveParams.
+   */
+  void LoadParamsFromFile(const std::string& file_name);
   /*!
    * \brief Load parameters from parameter blob.
    * \param param_blob A binary blob of parameter.
@@ -185,6 +316,8 @@ class TVM_DLL GraphExecutor : public ModuleNode {
     int device_type;
     int param_data_entry;
     NDArray linked_param;
+    // Byte offset in the arena of the device, -1 if allocated separately.
+    int64_t offset{-1};
     //    PoolEntry(int s, int dev_type, void* pre_linked_param) :
     //        size(s), device_type(dev_type), pre_linked_param(std::move(pre_linked_param)) {}
   };
@@ -275,6 +408,7 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   struct GraphAttr {
     size_t storage_num_not_alloctaed{0};
     std::vector<int> storage_id;
+    std::vector<int64_t> storage_offset;
     std::vector<int> device_index;
     std::vector<std::string> dltype;
     std::vector<std::vector<int64_t>> shape;
@@ -319,6 +453,14 @@ class TVM_DLL GraphExecutor : public ModuleNode {
           ICHECK(reader->NextArrayItem());
           reader->Read(&device_index);
           ICHECK(!reader->NextArrayItem());
+        } else if (key == "storage_offset") {
+          reader->BeginArray();
+          ICHECK(reader->NextArrayItem());
+          reader->Read(&type);
+          ICHECK_EQ(type, "list_int");
+          ICHECK(reader->NextArrayItem());
+          reader->Read(&storage_offset);
+          ICHECK(!reader->NextArrayItem());
         } else {
           reader->BeginArray();
           ICHECK(reader->NextArrayItem());
@@ -373,10 +515,69 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   void DefaultLookupLinkedParam(TVMArgs args, TVMRetValue* rv);
   /*! \brief Delete NDArray::Container with linked (i.e. static) data. */
   static void LinkedNDArrayDeleter(Object* container);
-  /*! \brief Setup the temporal storage */
-  void SetupStorage();
+  /*! \brief Delete NDArray::Container viewing an arena, held in its manager_ctx. */
+  static void ArenaNDArrayDeleter(Object* container);
+  /*!
+   * \brief Setup the temporal storage
+   * \param shared_pool If given, the storage pool of the executor whose params are shared.
+   * \param shared_sids The storage ids taken from shared_pool.
+   */
+  void SetupStorage(const std::vector<NDArray>* shared_pool = nullptr,
+                    const std::unordered_set<uint32_t>& shared_sids = {});
   /*! \brief Setup the executors. */
   void SetupOpExecs();
+  /*! \brief Run the operators of the graph. */
+  void RunOps();
+  /*! \brief Run the operators of the graph one by one, timing them. */
+  void RunOpsSampled();
+  /*! \brief Run the operators of the graph, capturing their work. */
+  void CaptureOps();
+  /*! \brief Replay the captured work and run the operators that were not captured. */
+  void RunCaptured();
+  /*! \brief Free the captured work, after the devices finished replaying it. */
+  void ReleaseCapture();
+  /*!
+   * \brief Get the device an operator runs on.
+   * \param nid The node id of the operator.
+   */
+  Device OpDevice(uint32_t nid) const;
+  /*!
+   * \brief Get the data of an entry, as passed to the operators.
+   * \param eid The entry id.
+   */
+  void* EntryData(uint32_t eid) const;
+  /*!
+   * \brief Copy the data of an input to its next staging buffer.
+   * \param index The input index.
+   * \param data_in The input data, on the CPU.
+   */
+  void StageInput(int index, DLTensor* data_in);
+  /*! \brief Issue the copies of the staged inputs to their devices. */
+  void FlushStagedInputs();
+  /*!
+   * \brief Get the stream of the input copies to a device, created on first use.
+   * \param dev The device.
+   */
+  TVMStreamHandle CopyStream(Device dev);
+  /*!
+   * \brief Setup the dependencies between the operators run in parallel.
+   * \param op_succ The operators waiting on each operator.
+   * \param op_num_deps The number of operators each operator waits on.
+   * \param order_devices Whether the operators of each device other than the CPU also wait on
+   *  the previous one of the device.
+   */
+  void SetupOpDeps(std::vector<std::vector<uint32_t>>* op_succ, std::vector<uint32_t>* op_num_deps,
+                   bool order_devices = true);
+  /*! \brief Assign the operators of the devices other than the CPU to their streams. */
+  void SetupOpStreams();
+  /*! \brief Issue the operators of the graph on the streams of their devices. */
+  void RunOpsMultiStream();
+  /*!
+   * \brief Set the stream the streams of the operators of a device fork from and join.
+   * \param dev The device.
+   * \param stream The origin stream, null for the default stream of the device.
+   */
+  void SetOriginStream(Device dev, TVMStreamHandle stream) { origin_streams_[dev] = stream; }
   /*!
    * \brief Create an execution function given input.
    * \param attrs The node attributes.
@@ -427,6 +628,75 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * When the module does not include linked parmeters, module_lookup_linked_param_ will be nullptr.
    */
   bool module_lookup_linked_param_valid_;
+  /*! \brief Number of threads running the operators. */
+  int num_workers_{1};
+  /*! \brief Number of threads running the parallel loops of each operator. */
+  int num_intra_threads_{0};
+  /*! \brief The scheduler of the parallel runs, created on the first one. */
+  std::unique_ptr<OpScheduler> scheduler_;
+  /*! \brief A host buffer of the staging ring of an input. */
+  struct StagingSlot {
+    NDArray data;
+    /*! \brief Whether a copy from the buffer may still be in progress. */
+    bool in_flight{false};
+  };
+  /*! \brief Number of host buffers of each staged input, 0 if staging is disabled. */
+  int num_staging_slots_{0};
+  /*! \brief The staging ring of each input, allocated on first use. */
+  std::vector<std::vector<StagingSlot>> staging_ring_;
+  /*! \brief The next buffer of the ring of each input. */
+  std::vector<uint32_t> staging_next_;
+  /*! \brief The buffer holding the data to copy to each input at the next run, or -1. */
+  std::vector<int> staged_slot_;
+  /*! \brief The stream of the input copies to each device. */
+  std::unordered_map<Device, TVMStreamHandle> copy_streams_;
+  /*! \brief Number of streams of each device the operators are issued on. */
+  int num_streams_{1};
+  /*! \brief The stream of an operator and the streams it waits on, indices on its device. */
+  struct OpStream {
+    /*! \brief The stream, -1 for the operators of the CPU. */
+    int stream{-1};
+    std::vector<int> waits;
+  };
+  /*! \brief The stream of each operator, set up on the first multi-stream run. */
+  std::vector<OpStream> op_streams_;
+  /*! \brief The streams of the operators of each device, created on the first one. */
+  std::unordered_map<Device, std::vector<TVMStreamHandle>> device_streams_;
+  /*! \brief The stream the streams of each device fork from and join, null if not set. */
+  std::unordered_map<Device, TVMStreamHandle> origin_streams_;
+  /*! \brief A range of operators, replayed from graph if it is not null. */
+  struct CapturedSegment {
+    size_t begin;
+    size_t end;
+    Device dev;
+    void* graph;
+  };
+  /*! \brief Whether the runs replay the captured work. */
+  bool capture_mode_{false};
+  /*! \brief The thread pool partition of the runs, -1 for the pool of the running thread. */
+  int thread_pool_partition_{-1};
+  /*! \brief Whether the work of the operators is captured. */
+  bool captured_{false};
+  /*! \brief The captured segments in execution order. */
+  std::vector<CapturedSegment> captured_segments_;
+  /*! \brief The data of each entry when captured. */
+  std::vector<void*> captured_data_;
+  /*! \brief The number of runs between two sampled runs, 0 if sampling is disabled. */
+  int profile_interval_{0};
+  /*! \brief The number of sampled runs kept. */
+  int profile_capacity_{0};
+  /*! \brief The number of runs since sampling was set. */
+  uint64_t profile_num_runs_{0};
+  /*! \brief The number of sampled runs since sampling was set. */
+  uint64_t profile_num_samples_{0};
+  /*! \brief The node ids of the timed operators. */
+  std::vector<uint32_t> profile_nids_;
+  /*! \brief Ring of the operator latencies, one row of profile_nids_ per sampled run. */
+  std::vector<int64_t> profile_samples_;
+  /*! \brief Guards the profile samples, which are read while the graph runs. */
+  std::mutex profile_mutex_;
+  /*! \brief The run started by RunAsync, last so that it is joined first on destruction. */
+  std::future<void> async_run_;
 };
 
 std::vector<Device> GetAllDevice(const TVMArgs& args, int dev_start_arg);
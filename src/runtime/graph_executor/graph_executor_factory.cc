@@ -53,6 +53,14 @@ PackedFunc GraphExecutorFactory::GetFunction(
       }
       *rv = this->ExecutorCreate(devices);
     });
+  } else if (name == "create_shared") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::vector<Device> devices;
+      for (int i = 0; i < args.num_args; ++i) {
+        devices.emplace_back(args[i].operator Device());
+      }
+      *rv = this->SharedExecutorCreate(devices);
+    });
   } else if (name == "debug_create") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       ICHECK_GE(args.size(), 2);
@@ -111,6 +119,28 @@ Module GraphExecutorFactory::ExecutorCreate(const std::vector<Device>& devs) {
   return Module(exec);
 }
 
+Module GraphExecutorFactory::SharedExecutorCreate(const std::vector<Device>& devs) {
+  std::lock_guard<std::mutex> lock(shared_mutex_);
+  bool same_devices = std::equal(devs.begin(), devs.end(), shared_devices_.begin(),
+                                 shared_devices_.end(), [](const Device& a, const Device& b) {
+                                   return a.device_type == b.device_type &&
+                                          a.device_id == b.device_id;
+                                 });
+  if (!shared_base_.defined() || !same_devices) {
+    shared_base_ = this->ExecutorCreate(devs);
+    shared_devices_ = devs;
+    return shared_base_;
+  }
+  const GraphExecutor* base = shared_base_.as<GraphExecutor>();
+  std::vector<std::string> param_names;
+  for (const auto& p : params_) {
+    param_names.push_back(p.first);
+  }
+  auto exec = make_object<GraphExecutor>();
+  exec->InitShared(*base, param_names);
+  return Module(exec);
+}
+
 Module GraphExecutorFactory::DebugExecutorCreate(const std::vector<Device>& devs) {
   const PackedFunc* pf = tvm::runtime::Registry::Get("tvm.graph_executor_debug.create");
   ICHECK(pf != nullptr) << "Cannot find function tvm.graph_executor_debug.create in registry. "
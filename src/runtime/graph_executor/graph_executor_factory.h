@@ -32,6 +32,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -81,6 +82,15 @@ class TVM_DLL GraphExecutorFactory : public runtime::ModuleNode {
    */
   Module ExecutorCreate(const std::vector<Device>& devs);
 
+  /*!
+   * \brief Create an executor module sharing the params with the other ones created on
+   *  the same devices, so that each instance only allocates its activations.
+   * \param devs The device of the host and devices where graph nodes will be
+   *  executed on.
+   * \return created executor module
+   */
+  Module SharedExecutorCreate(const std::vector<Device>& devs);
+
   /*!
    * \brief Create a specific debug executor module
    * \param devs The device of the host and devices where graph nodes will be
@@ -131,6 +141,12 @@ class TVM_DLL GraphExecutorFactory : public runtime::ModuleNode {
   std::unordered_map<std::string, tvm::runtime::NDArray> params_;
   /*! \brief module name */
   std::string module_name_;
+  /*! \brief The executor whose params the shared executors use. */
+  Module shared_base_;
+  /*! \brief The devices of shared_base_. */
+  std::vector<Device> shared_devices_;
+  /*! \brief Guards shared_base_. */
+  std::mutex shared_mutex_;
 };
 
 }  // namespace runtime
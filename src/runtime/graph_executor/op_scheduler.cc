@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file op_scheduler.cc
+ */
+#include "op_scheduler.h"
+
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+
+OpScheduler::OpScheduler(const std::vector<std::function<void()>>* op_execs,
+                         std::vector<std::vector<uint32_t>> op_succ,
+                         std::vector<uint32_t> op_num_deps, int num_workers,
+                         int num_intra_threads)
+    : op_execs_(op_execs),
+      op_succ_(std::move(op_succ)),
+      op_num_deps_(std::move(op_num_deps)),
+      num_intra_threads_(num_intra_threads) {
+  ICHECK_GE(num_workers, 1);
+  if (num_intra_threads_ == 0) {
+    num_intra_threads_ = std::max(threading::MaxConcurrency() / num_workers, 1);
+  }
+  for (const auto& fexec : *op_execs_) {
+    if (fexec) ++num_ops_;
+  }
+  // The calling thread only waits, so that its own thread pool is left as configured.
+  workers_.reset(new threading::ThreadGroup(
+      num_workers, [this](int worker_id) { this->RunWorker(worker_id); }, false));
+}
+
+OpScheduler::~OpScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  ready_cv_.notify_all();
+  workers_.reset();
+}
+
+void OpScheduler::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  num_deps_ = op_num_deps_;
+  num_done_ = 0;
+  error_.clear();
+  ready_.clear();
+  for (uint32_t nid = static_cast<uint32_t>(op_execs_->size()); nid-- > 0;) {
+    if ((*op_execs_)[nid] && num_deps_[nid] == 0) ready_.push_back(nid);
+  }
+  ready_cv_.notify_all();
+  done_cv_.wait(lock, [this]() {
+    return num_done_ == num_ops_ || (!error_.empty() && num_running_ == 0);
+  });
+  if (!error_.empty()) LOG(FATAL) << error_;
+}
+
+void OpScheduler::RunWorker(int worker_id) {
+  // Split the cores between the operators running at the same time.
+  const PackedFunc* fconfig = Registry::Get("runtime.config_threadpool");
+  if (fconfig != nullptr) {
+    (*fconfig)(static_cast<int>(threading::ThreadGroup::kBig), num_intra_threads_);
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    ready_cv_.wait(lock, [this]() { return shutdown_ || !ready_.empty(); });
+    if (shutdown_) return;
+    uint32_t nid = ready_.back();
+    ready_.pop_back();
+    ++num_running_;
+    lock.unlock();
+    std::string error;
+    try {
+      (*op_execs_)[nid]();
+    } catch (const std::exception& e) {
+      error = e.what();
+    }
+    lock.lock();
+    --num_running_;
+    if (!error.empty()) {
+      // Let the running operators finish and start no new one.
+      if (error_.empty()) error_ = error;
+      ready_.clear();
+    } else {
+      ++num_done_;
+      if (error_.empty()) {
+        for (uint32_t succ : op_succ_[nid]) {
+          if (--num_deps_[succ] == 0) ready_.push_back(succ);
+        }
+      }
+      if (!ready_.empty()) ready_cv_.notify_all();
+    }
+    if (num_done_ == num_ops_ || (!error_.empty() && num_running_ == 0)) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace runtime
+}  // namespace tvm
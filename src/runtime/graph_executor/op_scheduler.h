@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file op_scheduler.h
+ * \brief Run the operators of a graph concurrently in dependency order.
+ */
+#ifndef TVM_RUNTIME_GRAPH_EXECUTOR_OP_SCHEDULER_H_
+#define TVM_RUNTIME_GRAPH_EXECUTOR_OP_SCHEDULER_H_
+
+#include <tvm/runtime/threading_backend.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Inter-operator scheduler of the graph executor.
+ *
+ *  A persistent group of worker threads takes the operators whose dependencies are done
+ *  from a shared ready list. Each worker configures its own runtime thread pool to
+ *  num_intra_threads threads, which run the parallel loops of the operators.
+ */
+class OpScheduler {
+ public:
+  /*!
+   * \brief Start the workers.
+   * \param op_execs The operators of the graph, empty for the nodes without one.
+   * \param op_succ The operators waiting on each operator.
+   * \param op_num_deps The number of operators each operator waits on.
+   * \param num_workers The number of threads running operators.
+   * \param num_intra_threads The number of threads of each operator, 0 shares the cores
+   *  evenly between the workers.
+   */
+  OpScheduler(const std::vector<std::function<void()>>* op_execs,
+              std::vector<std::vector<uint32_t>> op_succ, std::vector<uint32_t> op_num_deps,
+              int num_workers, int num_intra_threads);
+  /*! \brief Stop and join the workers. */
+  ~OpScheduler();
+  /*! \brief Run all the operators and wait for them, rethrowing the first error. */
+  void Run();
+
+ private:
+  void RunWorker(int worker_id);
+
+  const std::vector<std::function<void()>>* op_execs_;
+  std::vector<std::vector<uint32_t>> op_succ_;
+  std::vector<uint32_t> op_num_deps_;
+  int num_intra_threads_;
+  size_t num_ops_{0};
+  // The state of the current run, guarded by mutex_
+  std::mutex mutex_;
+  std::condition_variable ready_cv_;
+  std::condition_variable done_cv_;
+  std::vector<uint32_t> num_deps_;
+  // The last ready operator is run first, to follow the branch just computed
+  std::vector<uint32_t> ready_;
+  size_t num_done_{0};
+  int num_running_{0};
+  std::string error_;
+  bool shutdown_{false};
+  std::unique_ptr<threading::ThreadGroup> workers_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_GRAPH_EXECUTOR_OP_SCHEDULER_H_
@@ -108,7 +108,10 @@ inline void HexagonDeviceAPI::CopyDataFromTo(const void* from, size_t from_offse
   }
 }
 
-inline void HexagonDeviceAPI::StreamSync(Device dev, TVMStreamHandle stream) {}
+inline void HexagonDeviceAPI::StreamSync(Device dev, TVMStreamHandle stream) {
+  ICHECK(hexagon::Device::ValidateDeviceId(dev.device_id));
+  hexagon::Device::Global()->Flush();
+}
 
 inline void* HexagonDeviceAPI::AllocWorkspace(Device dev, size_t nbytes, DLDataType type_hint) {
   ICHECK(hexagon::Device::ValidateDeviceId(dev.device_id));
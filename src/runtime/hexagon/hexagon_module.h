@@ -139,6 +139,11 @@ class Device {
    */
   virtual void Call(void* func, uint32_t* scalar, unsigned sc_num, uint32_t* stack,
                     unsigned st_num) = 0;
+  /*!
+   * \brief Issue the calls that Call deferred, the device may batch the
+   *        calls between the points the host observes their results.
+   */
+  virtual void Flush() {}
 
   virtual ~Device() = 0;
 
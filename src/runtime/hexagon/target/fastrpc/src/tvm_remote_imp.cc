@@ -175,6 +175,24 @@ int tvm_remote_kernel(remote_handle64 handle, tvm_remote_handle_t lib, tvm_remot
       time_usec);
 }
 
+/*!
+ *  \brief Call several functions one after the other, in one remote call.
+ *
+ *  \param handle       Domain channel handle.
+ *
+ *  See tvm_remote_nd_kernel_batch for the other parameters.
+ */
+int tvm_remote_kernel_batch(remote_handle64 handle, tvm_remote_handle_t lib, const int* calls,
+                            int calls_len, const int* args, int args_len,
+                            const tvm_remote_buffer* in_octet, int in_octet_len,
+                            tvm_remote_buffer* out_octet, int out_octet_len, uint64* pcycles,
+                            uint64* time_usec) {
+  return tvm_remote_nd_kernel_batch(
+      lib, calls, calls_len, args, args_len,
+      reinterpret_cast<const tvm_remote_nd_buffer*>(in_octet), in_octet_len,
+      reinterpret_cast<tvm_remote_nd_buffer*>(out_octet), out_octet_len, pcycles, time_usec);
+}
+
 /*!
  *  \brief Release previously loaded shared object.
  *
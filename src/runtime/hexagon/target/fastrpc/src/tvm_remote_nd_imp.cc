@@ -227,6 +227,59 @@ static void print_msg_call(const msg_call& mc) {
   }
 }
 
+// Lock the HVX units if any are available, return the result of the lock.
+static int acquire_hvx(hvx::config_t* hvx_info) {
+  hvx::prepare_mt_job(hvx_info);
+  int lock_result = 0;
+  // Check if HVX units are available
+  if (hvx_info->num_reserved > 0) {
+    lock_result = hvx::lock(hvx::MODE_128B);
+    if (lock_result < 0) {
+      FARF(ERROR, "%s: HVX locking failed lock_result=%d num_reserved=%d", __func__, lock_result,
+           hvx_info->num_reserved);
+    } else {
+      FARF(ALWAYS, "%s: HVX lock successful lock_result=%d", __func__, lock_result);
+    }
+  } else {
+    FARF(ERROR, "%s: there are no HVX units available", __func__);
+  }
+  return lock_result;
+}
+
+static void release_hvx(hvx::config_t* hvx_info, int lock_result) {
+  if (lock_result > 0) hvx::unlock();
+  hvx::cleanup_mt_job(hvx_info);
+}
+
+// Call the function at symbol with the values in registers and on stack.
+static int launch_kernel(tvm_remote_nd_handle_t symbol, const int* scalar, int scalar_len,
+                         const int* stack, int stack_len, uint64* pcycles) {
+  struct msg_call* mc = (struct msg_call*)malloc(sizeof(uint32_t) * (3 + scalar_len + stack_len));
+  if (mc == nullptr) {
+    FARF(ERROR, "%s: failed to allocate memory for mc", __func__);
+    return AEE_ENOMEMORY;
+  }
+
+  int32_t* mc_ptr = reinterpret_cast<int32_t*>(mc);
+  // Scalar buffers come first.
+  int k = 3;
+  for (int i = 0; i < scalar_len; i++, k++) {
+    *(mc_ptr + k) = static_cast<uint32_t>(scalar[i]);
+  }
+
+  for (int i = 0; i < stack_len; i++, k++) {
+    *(mc_ptr + k) = static_cast<uint32_t>(stack[i]);
+  }
+
+  mc->scalar_num = scalar_len;
+  mc->stack_num = stack_len;
+  mc->func_va = symbol;
+  print_msg_call(*mc);
+  int result = launcher(mc, pcycles);
+  free(mc);
+  return result;
+}
+
 /*!
  *  \brief Call the specified function.
  *
@@ -263,50 +316,74 @@ int tvm_remote_nd_kernel(tvm_remote_nd_handle_t lib, tvm_remote_nd_handle_t symb
                          tvm_remote_nd_buffer* stack_out_octet, int stack_out_octet_len,
                          uint64* pcycles, uint64* time_usec) {
   hvx::config_t hvx_info = {0};
-  hvx::prepare_mt_job(&hvx_info);
+  int lock_result = acquire_hvx(&hvx_info);
+  uint64_t start_time = HAP_perf_get_time_us();
+  int result = launch_kernel(symbol, scalar, scalar_len, stack, stack_len, pcycles);
+  *time_usec = HAP_perf_get_time_us() - start_time;
+  FARF(ALWAYS, "kernel execution: %llu pcycles  %llu usec", *pcycles, *time_usec);
+  release_hvx(&hvx_info, lock_result);
+  return result;
+}
 
-  int lock_result;
-  // Check if HVX units are available
-  if (hvx_info.num_reserved > 0) {
-    lock_result = hvx::lock(hvx::MODE_128B);
-    if (lock_result < 0) {
-      FARF(ERROR, "%s: HVX locking failed lock_result=%d num_reserved=%d", __func__, lock_result,
-           hvx_info.num_reserved);
-    } else {
-      FARF(ALWAYS, "%s: HVX lock successful lock_result=%d", __func__, lock_result);
+/*!
+ *  \brief Call several functions one after the other, in one remote call.
+ *
+ *  \param lib                    Handle of the library containing
+ *                                the functions to call.
+ *  \param calls                  The triples of the address of a function to
+ *                                call, its number of values to pass in
+ *                                registers and its number of values to pass
+ *                                on stack.
+ *  \param calls_len              Number of values in calls.
+ *  \param args                   The values of the calls, the values to pass
+ *                                in registers then on stack of each call.
+ *  \param args_len               Number of values in args.
+ *
+ *  \param in_octet               Address of the incoming buffers.
+ *  \param in_octet_len           Number of incoming buffers.
+ *  \param out_octet              Address of the outgoing buffers.
+ *  \param out_octet_len          Number of outgoing buffers.
+ *
+ *  \param pcycles                Pointer to where to store the total cycle
+ *                                count.
+ *  \param time_usec              Pointer to where to store the total time in
+ *                                usec.
+ *
+ *  \return 0 on success, the result of the first failing call otherwise, the
+ *          calls after it are not made.
+ *
+ * The "octet" arguments are the buffers used by any of the calls, each one
+ * once, for cache operations only.
+ */
+int tvm_remote_nd_kernel_batch(tvm_remote_nd_handle_t lib, const int* calls, int calls_len,
+                               const int* args, int args_len,
+                               const tvm_remote_nd_buffer* in_octet, int in_octet_len,
+                               tvm_remote_nd_buffer* out_octet, int out_octet_len,
+                               uint64* pcycles, uint64* time_usec) {
+  hvx::config_t hvx_info = {0};
+  int lock_result = acquire_hvx(&hvx_info);
+  uint64_t start_time = HAP_perf_get_time_us();
+  int result = AEE_SUCCESS;
+  int offset = 0;
+  *pcycles = 0;
+  for (int c = 0; c + 2 < calls_len && result == AEE_SUCCESS; c += 3) {
+    int scalar_len = calls[c + 1];
+    int stack_len = calls[c + 2];
+    if (offset + scalar_len + stack_len > args_len) {
+      FARF(ERROR, "%s: call %d reads past the values", __func__, c / 3);
+      result = AEE_EBADPARM;
+      break;
     }
-  } else {
-    FARF(ERROR, "%s: there are no HVX units available", __func__);
-  }
-
-  struct msg_call* mc = (struct msg_call*)malloc(sizeof(uint32_t) * (3 + scalar_len + stack_len));
-  if (mc == nullptr) {
-    FARF(ERROR, "%s: failed to allocate memory for mc", __func__);
-    return AEE_ENOMEMORY;
-  }
-
-  int32_t* mc_ptr = reinterpret_cast<int32_t*>(mc);
-  // Scalar buffers come first.
-  int k = 3;
-  for (int i = 0; i < scalar_len; i++, k++) {
-    *(mc_ptr + k) = static_cast<uint32_t>(scalar[i]);
-  }
-
-  for (int i = 0; i < stack_len; i++, k++) {
-    *(mc_ptr + k) = static_cast<uint32_t>(stack[i]);
+    uint64 cycles = 0;
+    result = launch_kernel(static_cast<tvm_remote_nd_handle_t>(calls[c]), args + offset,
+                           scalar_len, args + offset + scalar_len, stack_len, &cycles);
+    *pcycles += cycles;
+    offset += scalar_len + stack_len;
   }
-
-  mc->scalar_num = scalar_len;
-  mc->stack_num = stack_len;
-  mc->func_va = symbol;
-  print_msg_call(*mc);
-  uint64_t start_time = HAP_perf_get_time_us();
-  int result = launcher(mc, pcycles);
   *time_usec = HAP_perf_get_time_us() - start_time;
-  FARF(ALWAYS, "kernel execution: %llu pcycles  %llu usec", *pcycles, *time_usec);
-  if (lock_result > 0) hvx::unlock();
-  hvx::cleanup_mt_job(&hvx_info);
-  if (mc) free(mc);
+  FARF(ALWAYS, "batch of %d kernels: %llu pcycles  %llu usec", calls_len / 3, *pcycles,
+       *time_usec);
+  release_hvx(&hvx_info, lock_result);
   return result;
 }
 
@@ -22,10 +22,13 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "../hexagon_module.h"
 #include "AEEStdErr.h"
@@ -53,10 +56,12 @@ namespace runtime {
 namespace hexagon {
 
 static constexpr int kStackSize = 128 * 1024;  // 128kB stack
+// The number of kernels issued in one FastRPC call at most.
+static constexpr size_t kMaxBatchCalls = 256;
 
 class HexagonTarget : public tvm::runtime::hexagon::Device {
  public:
-  HexagonTarget() {}
+  HexagonTarget() : batch_enabled_(std::getenv("TVM_HEXAGON_DISABLE_KERNEL_BATCH") == nullptr) {}
   ~HexagonTarget() final {}
   void* Alloc(unsigned size, unsigned align) final;
   void Free(void* ptr) final;
@@ -70,6 +75,7 @@ class HexagonTarget : public tvm::runtime::hexagon::Device {
   void* Resolve(const std::string& sym) final;
   void Call(void* func, uint32_t* scalar, unsigned scalar_num, uint32_t* stack,
             unsigned stack_num) final;
+  void Flush() final;
 
  private:
   std::pair<void*, size_t> AddAddrMapping(const void* dsp_addr, void* apps_addr, size_t size);
@@ -79,6 +85,7 @@ class HexagonTarget : public tvm::runtime::hexagon::Device {
   int CloseDomainChannel();
   void ReleaseLibrary();
   void FreeMemoryBeforeChannelClose();
+  void FlushLocked();
 
   // Mapping from a DSP address to a pair <apps address, buffer size>.
   // Using void* pointers is ok, since DSP pointers will always fit
@@ -91,6 +98,17 @@ class HexagonTarget : public tvm::runtime::hexagon::Device {
   // in the future.
   mutable std::mutex crit_section_;
 
+  // The kernel calls deferred by Call, issued together by Flush: the
+  // {function, scalar_num, stack_num} of each call, their concatenated
+  // scalar and stack values, and the apps buffers the calls access, once
+  // each, for the cache maintenance of the FastRPC call.
+  bool batch_enabled_;
+  std::mutex batch_section_;
+  std::vector<int> batch_calls_;
+  std::vector<int> batch_args_;
+  std::vector<tvm_remote_buffer> batch_octets_;
+  std::unordered_set<void*> batch_buffers_;
+
   // Don't use unsigned PDs by default. Change this to "true" to enable.
   static constexpr bool unsigned_pd = false;
 
@@ -283,6 +301,7 @@ void* HexagonTarget::Alloc(unsigned size, unsigned align) {
 }
 
 void HexagonTarget::Free(void* ptr) {
+  Flush();
   const DspRpcAPI* dsp_api = DspRpcAPI::Global();
   const StubAPI* stub_api = StubAPI::Global();
   auto bb = GetAppsAddr(ptr, true);
@@ -321,6 +340,7 @@ void* HexagonTarget::AllocVtcm(unsigned size, unsigned align) {
 }
 
 void HexagonTarget::FreeVtcm(void* ptr) {
+  Flush();
   const StubAPI* stub_api = StubAPI::Global();
 
   TVM_LOGD_HT("%s:Calling vtcm free. ptr=%p", __func__, ptr);
@@ -333,6 +353,7 @@ void HexagonTarget::FreeVtcm(void* ptr) {
 }
 
 void HexagonTarget::CopyDeviceToDevice(void* dst, const void* src, unsigned len) {
+  Flush();
   auto aa_src = GetAppsAddr(src, false);
   auto aa_dst = GetAppsAddr(dst, false);
   if (aa_src.first == vtcm_mark_ || aa_dst.first == vtcm_mark_) {
@@ -362,6 +383,7 @@ void HexagonTarget::CopyDeviceToDevice(void* dst, const void* src, unsigned len)
 }
 
 void HexagonTarget::CopyDeviceToHost(void* host_dst, const void* src, unsigned len) {
+  Flush();
   auto aa = GetAppsAddr(src, false);
   if (aa.first == vtcm_mark_) {
     TVM_LOGE_HT("VTCM address. Copy operation not supported");
@@ -380,6 +402,7 @@ void HexagonTarget::CopyDeviceToHost(void* host_dst, const void* src, unsigned l
 }
 
 void HexagonTarget::CopyHostToDevice(void* dst, const void* host_src, unsigned len) {
+  Flush();
   auto aa = GetAppsAddr(dst, false);
   if (aa.first == vtcm_mark_) {
     TVM_LOGE_HT("VTCM address. Copy operation not supported");
@@ -398,6 +421,7 @@ void HexagonTarget::CopyHostToDevice(void* dst, const void* host_src, unsigned l
 }
 
 void* HexagonTarget::Load(const std::string& data, const std::string& fmt) {
+  Flush();
   crit_section_.lock();
   int rc_oc = OpenDomainChannel(/*use_unsigned_pd*/ unsigned_pd);
   crit_section_.unlock();
@@ -427,6 +451,7 @@ void* HexagonTarget::Load(const std::string& data, const std::string& fmt) {
 }
 
 void HexagonTarget::Unload(void* mod) {
+  Flush();
   crit_section_.lock();
   count_channel_open_--;
   crit_section_.unlock();
@@ -458,6 +483,32 @@ void* HexagonTarget::Resolve(const std::string& sym) {
 
 void HexagonTarget::Call(void* func, uint32_t* scalar, unsigned scalar_num, uint32_t* stack,
                          unsigned stack_num) {
+  if (batch_enabled_ && StubAPI::Global()->has_kernel_batch()) {
+    std::lock_guard<std::mutex> lock(batch_section_);
+    batch_calls_.push_back(static_cast<int>(reinterpret_cast<uintptr_t>(func)));
+    batch_calls_.push_back(scalar_num);
+    batch_calls_.push_back(stack_num);
+    batch_args_.insert(batch_args_.end(), scalar, scalar + scalar_num);
+    batch_args_.insert(batch_args_.end(), stack, stack + stack_num);
+    auto AddBuffers = [this](uint32_t* inputs, unsigned num) {
+      for (unsigned i = 0; i != num; ++i) {
+        void* ptr = reinterpret_cast<void*>(static_cast<uintptr_t>(inputs[i]));
+        auto aa = GetAppsAddr(ptr, false);
+        if (aa.first == nullptr || aa.first == vtcm_mark_) continue;
+        if (!batch_buffers_.insert(aa.first).second) continue;
+        tvm_remote_buffer buffer;
+        buffer.data = static_cast<unsigned char*>(aa.first);
+        buffer.dataLen = aa.second;
+        batch_octets_.push_back(buffer);
+      }
+    };
+    AddBuffers(scalar, scalar_num);
+    AddBuffers(stack, stack_num);
+    TVM_LOGD_HT("deferred kernel %p, %zu calls pending", func, batch_calls_.size() / 3);
+    if (batch_calls_.size() / 3 >= kMaxBatchCalls) FlushLocked();
+    return;
+  }
+
   uint64 pcycles = 0, execution_time_usec = 0;
   auto scalar_octet = std::unique_ptr<tvm_remote_buffer[]>(new tvm_remote_buffer[scalar_num]);
   auto stack_octet = std::unique_ptr<tvm_remote_buffer[]>(new tvm_remote_buffer[stack_num]);
@@ -514,6 +565,31 @@ void HexagonTarget::Call(void* func, uint32_t* scalar, unsigned scalar_num, uint
   }
 }
 
+void HexagonTarget::Flush() {
+  std::lock_guard<std::mutex> lock(batch_section_);
+  FlushLocked();
+}
+
+void HexagonTarget::FlushLocked() {
+  if (batch_calls_.empty()) return;
+  uint64 pcycles = 0, execution_time_usec = 0;
+  const StubAPI* stub_api = StubAPI::Global();
+  int rc = stub_api->tvm_remote_kernel_batch(
+      domain_channel_handle_, module_pointer_, batch_calls_.data(), batch_calls_.size(),
+      batch_args_.data(), batch_args_.size(), batch_octets_.data(), batch_octets_.size(),
+      batch_octets_.data(), batch_octets_.size(), &pcycles, &execution_time_usec);
+  if (rc != AEE_SUCCESS) {
+    TVM_LOGE_HT("failed to run kernel batch on CDSP rc=0x%x", rc);
+  } else {
+    TVM_LOGD_HT("batch of %zu kernels: %llu pcycles, %llu usec, buffers=%zu",
+                batch_calls_.size() / 3, pcycles, execution_time_usec, batch_octets_.size());
+  }
+  batch_calls_.clear();
+  batch_args_.clear();
+  batch_octets_.clear();
+  batch_buffers_.clear();
+}
+
 }  // namespace hexagon
 }  // namespace runtime
 }  // namespace tvm
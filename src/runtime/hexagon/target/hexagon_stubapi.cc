@@ -53,6 +53,7 @@ StubAPI::StubAPI() {
     RESOLVE(tvm_remote_release_library);
     RESOLVE(tvm_remote_get_symbol);
     RESOLVE(tvm_remote_kernel);
+    RESOLVE(tvm_remote_kernel_batch);
     RESOLVE(tvm_remote_open);
     RESOLVE(tvm_remote_close);
     RESOLVE(tvm_remote_alloc_vtcm);
@@ -63,6 +64,7 @@ StubAPI::StubAPI() {
     RESOLVE(tvm_remote_nd_release_library);
     RESOLVE(tvm_remote_nd_get_symbol);
     RESOLVE(tvm_remote_nd_kernel);
+    RESOLVE(tvm_remote_nd_kernel_batch);
     RESOLVE(tvm_remote_nd_open);
     RESOLVE(tvm_remote_nd_call_mmap64);
   }
@@ -66,6 +66,7 @@ namespace hexagon {
  *   tvm_remote_release_library
  *   tvm_remote_get_symbol
  *   tvm_remote_kernel
+ *   tvm_remote_kernel_batch
  *   tvm_remote_close
  *   tvm_remote_alloc_vtcm
  *   tvm_remote_free_vtcm
@@ -74,6 +75,7 @@ namespace hexagon {
  *   tvm_remote_nd_release_library
  *   tvm_remote_nd_get_symbol
  *   tvm_remote_nd_kernel
+ *   tvm_remote_nd_kernel_batch
  *   tvm_remote_nd_close
  *
  * The "open" functions differ in their parameters in different ways, and
@@ -167,6 +169,7 @@ class StubAPI {
   MAPTYPE(tvm_remote_release_library, tvm_remote_buffer)
   MAPTYPE(tvm_remote_get_symbol, tvm_remote_buffer)
   MAPTYPE(tvm_remote_kernel, tvm_remote_buffer)
+  MAPTYPE(tvm_remote_kernel_batch, tvm_remote_buffer)
   MAPTYPE(tvm_remote_close, tvm_remote_buffer)
   MAPTYPE(tvm_remote_alloc_vtcm, tvm_remote_buffer)
   MAPTYPE(tvm_remote_free_vtcm, tvm_remote_buffer)
@@ -176,6 +179,7 @@ class StubAPI {
   MAPTYPE(tvm_remote_nd_release_library, tvm_remote_nd_buffer)
   MAPTYPE(tvm_remote_nd_get_symbol, tvm_remote_nd_buffer)
   MAPTYPE(tvm_remote_nd_kernel, tvm_remote_nd_buffer)
+  MAPTYPE(tvm_remote_nd_kernel_batch, tvm_remote_nd_buffer)
   MAPTYPE(tvm_remote_nd_close, tvm_remote_buffer)
   MAPTYPE(tvm_remote_nd_call_mmap64, tvm_remote_buffer)
 #undef MAPTYPE
@@ -233,6 +237,7 @@ class StubAPI {
   DECLFUNC(release_library)
   DECLFUNC(get_symbol)
   DECLFUNC(kernel)
+  DECLFUNC(kernel_batch)
   DECLFUNC(close)
   DECLFUNC_D(alloc_vtcm)
   DECLFUNC_D(free_vtcm)
@@ -251,6 +256,12 @@ class StubAPI {
 #undef DECLSFUNC
 #undef DECLFUNC_D
 
+  // Whether the stub library has kernel_batch, older ones only have kernel.
+  bool has_kernel_batch() const {
+    return enable_domains_ ? ptvm_remote_kernel_batch_ != nullptr
+                           : ptvm_remote_nd_kernel_batch_ != nullptr;
+  }
+
   int tvm_remote_open(const char* uri, remote_handle64* handle) const {
     if (enable_domains_) {
       return PTRNAME(tvm_remote_open)(uri, handle);
@@ -269,6 +280,7 @@ class StubAPI {
   DECLPTR(tvm_remote_release_library);
   DECLPTR(tvm_remote_get_symbol);
   DECLPTR(tvm_remote_kernel);
+  DECLPTR(tvm_remote_kernel_batch);
   DECLPTR(tvm_remote_open);
   DECLPTR(tvm_remote_close);
   DECLPTR(tvm_remote_alloc_vtcm);
@@ -279,6 +291,7 @@ class StubAPI {
   DECLPTR(tvm_remote_nd_release_library);
   DECLPTR(tvm_remote_nd_get_symbol);
   DECLPTR(tvm_remote_nd_kernel);
+  DECLPTR(tvm_remote_nd_kernel_batch);
   DECLPTR(tvm_remote_nd_open);
   DECLPTR(tvm_remote_nd_close);
   DECLPTR(tvm_remote_nd_call_mmap64);
@@ -112,7 +112,7 @@ class MicroTransportChannel : public RPCChannel {
         message_buffer_{nullptr} {}
 
  private:
-  static constexpr const size_t kReceiveBufferSizeBytes = 128;
+  static constexpr const size_t kReceiveBufferSizeBytes = 4096;
 
   /*
    * \brief Receive data until either pf() returns true or a timeout occurs.
@@ -282,6 +282,11 @@ class MicroTransportChannel : public RPCChannel {
     return num_bytes_recv;
   }
 
+  // Without a receive window the device buffers a single message.
+  bool SupportsPipelining() const override { return session_.RemoteReceiveWindow() != 0; }
+
+  uint64_t MaxPendingRequestBytes() const override { return session_.RemoteReceiveWindow(); }
+
   FrameBuffer* GetReceivedMessage() {
     if (did_receive_message_) {
       did_receive_message_ = false;
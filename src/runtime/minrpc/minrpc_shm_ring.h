@@ -0,0 +1,270 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file minrpc_shm_ring.h
+ * \brief Shared memory ring buffers between an RPC client and a server on the same host.
+ *
+ *  The region holds one single producer, single consumer byte ring per direction.
+ *  Ring 0 carries the client to server messages and ring 1 the replies.
+ *  The peers spin shortly on the ring indices and then sleep on a process shared
+ *  condition, so a message costs one copy in each process and no system call while
+ *  the peers keep up with each other.
+ *
+ * \note Like minrpc_server.h, this file does not depend on the c++ std library.
+ */
+#ifndef TVM_RUNTIME_MINRPC_MINRPC_SHM_RING_H_
+#define TVM_RUNTIME_MINRPC_MINRPC_SHM_RING_H_
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+namespace tvm {
+namespace runtime {
+
+/*! \brief Magic number of an initialized region, "TVMR". */
+constexpr uint32_t kMinRPCShmMagic = 0x524D5654;
+/*! \brief Number of spins on the ring indices before sleeping. */
+constexpr int kMinRPCShmSpinCount = 4096;
+/*! \brief Period a sleeping peer wakes up at to check that the other peer is alive. */
+constexpr long kMinRPCShmPollNanos = 100 * 1000 * 1000;  // NOLINT(*)
+
+/*! \brief One direction of the region. */
+struct MinRPCShmRing {
+  /*! \brief Total number of bytes written, only advanced by the producer. */
+  uint64_t head;
+  /*! \brief Total number of bytes read, only advanced by the consumer. */
+  uint64_t tail;
+  /*! \brief Whether one of the peers is sleeping until the indices change. */
+  uint32_t waiting;
+  /*! \brief Set when the producer closes the ring. */
+  uint32_t closed;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+};
+
+/*! \brief Header at the start of the region, followed by the data of the two rings. */
+struct MinRPCShmHeader {
+  uint32_t magic;
+  uint32_t reserved;
+  /*! \brief Size of the data of each ring in bytes. */
+  uint64_t capacity;
+  MinRPCShmRing rings[2];
+};
+
+/*! \brief Offset of the data of the rings from the start of the region. */
+constexpr size_t kMinRPCShmDataOffset = (sizeof(MinRPCShmHeader) + 63) / 64 * 64;
+
+/*! \return The size of a region with the given ring capacity. */
+inline size_t MinRPCShmRegionBytes(uint64_t capacity) {
+  return kMinRPCShmDataOffset + 2 * capacity;
+}
+
+/*!
+ * \brief Initialize a region, before it is shared with the other process.
+ * \param base The start of the region.
+ * \param capacity Size of the data of each ring in bytes.
+ * \return Whether the process shared synchronization primitives could be created.
+ */
+inline bool MinRPCShmInit(void* base, uint64_t capacity) {
+  MinRPCShmHeader* header = static_cast<MinRPCShmHeader*>(base);
+  memset(header, 0, sizeof(MinRPCShmHeader));
+  header->capacity = capacity;
+  for (MinRPCShmRing& ring : header->rings) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    pthread_mutexattr_init(&mutex_attr);
+    pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED);
+    // A peer killed while holding the lock must not hang the other one
+    pthread_mutexattr_setrobust(&mutex_attr, PTHREAD_MUTEX_ROBUST);
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    int ret = pthread_mutex_init(&ring.mutex, &mutex_attr);
+    ret |= pthread_cond_init(&ring.cond, &cond_attr);
+    pthread_mutexattr_destroy(&mutex_attr);
+    pthread_condattr_destroy(&cond_attr);
+    if (ret != 0) return false;
+  }
+  __atomic_store_n(&header->magic, kMinRPCShmMagic, __ATOMIC_RELEASE);
+  return true;
+}
+
+/*!
+ * \brief Map a region shared by the other process.
+ * \param fd The file descriptor of the region.
+ * \return The header of the region, nullptr if it is not a valid region.
+ */
+inline MinRPCShmHeader* MinRPCShmMap(int fd) {
+  void* base = mmap(nullptr, sizeof(MinRPCShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) return nullptr;
+  const MinRPCShmHeader* header = static_cast<const MinRPCShmHeader*>(base);
+  bool valid = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) == kMinRPCShmMagic;
+  uint64_t capacity = header->capacity;
+  munmap(base, sizeof(MinRPCShmHeader));
+  if (!valid) return nullptr;
+  base = mmap(nullptr, MinRPCShmRegionBytes(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  return base == MAP_FAILED ? nullptr : static_cast<MinRPCShmHeader*>(base);
+}
+
+/*! \brief Unmap a region. */
+inline void MinRPCShmUnmap(MinRPCShmHeader* header) {
+  munmap(header, MinRPCShmRegionBytes(header->capacity));
+}
+
+/*! \return The data of the ring at index. */
+inline uint8_t* MinRPCShmData(MinRPCShmHeader* header, int index) {
+  return reinterpret_cast<uint8_t*>(header) + kMinRPCShmDataOffset + index * header->capacity;
+}
+
+/*!
+ * \brief Wake the peer sleeping on the ring, if any.
+ * \param ring The ring whose indices changed.
+ */
+inline void MinRPCShmNotify(MinRPCShmRing* ring) {
+  if (__atomic_load_n(&ring->waiting, __ATOMIC_SEQ_CST) == 0) return;
+  if (pthread_mutex_lock(&ring->mutex) == EOWNERDEAD) pthread_mutex_consistent(&ring->mutex);
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+}
+
+/*!
+ * \brief Wait until the predicate holds.
+ * \param ring The ring whose indices the predicate reads.
+ * \param ready The predicate.
+ * \param alive Returns whether the other peer is still alive.
+ * \return Whether the predicate holds, false if the peer died first.
+ */
+template <typename FReady, typename FAlive>
+inline bool MinRPCShmWait(MinRPCShmRing* ring, FReady ready, FAlive alive) {
+  for (int i = 0; i < kMinRPCShmSpinCount; ++i) {
+    if (ready()) return true;
+    if (i % 64 == 63) sched_yield();
+  }
+  if (pthread_mutex_lock(&ring->mutex) == EOWNERDEAD) pthread_mutex_consistent(&ring->mutex);
+  // The store is ordered before the predicate is read, and the notifier changes the indices
+  // before it reads the flag, so one side always sees the other.
+  __atomic_store_n(&ring->waiting, 1, __ATOMIC_SEQ_CST);
+  bool ok = true;
+  while (!ready()) {
+    if (!alive()) {
+      ok = false;
+      break;
+    }
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_nsec += kMinRPCShmPollNanos;
+    if (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec += 1;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    if (pthread_cond_timedwait(&ring->cond, &ring->mutex, &deadline) == EOWNERDEAD) {
+      pthread_mutex_consistent(&ring->mutex);
+    }
+  }
+  __atomic_store_n(&ring->waiting, 0, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&ring->mutex);
+  return ok;
+}
+
+/*!
+ * \brief Write up to size bytes into a ring, waiting until it has space.
+ * \param header The region.
+ * \param index The index of the ring.
+ * \param data The data to write.
+ * \param size The size of the data.
+ * \param alive Returns whether the other peer is still alive.
+ * \return The number of bytes written, -1 if the peer died.
+ */
+template <typename FAlive>
+inline ssize_t MinRPCShmWrite(MinRPCShmHeader* header, int index, const void* data, size_t size,
+                              FAlive alive) {
+  MinRPCShmRing* ring = &header->rings[index];
+  uint64_t capacity = header->capacity;
+  uint64_t head = ring->head;
+  auto has_space = [&]() {
+    return head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) < capacity;
+  };
+  if (!MinRPCShmWait(ring, has_space, alive)) return -1;
+  uint64_t space = capacity - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+  size_t nbytes = size < space ? size : static_cast<size_t>(space);
+  uint8_t* buf = MinRPCShmData(header, index);
+  size_t offset = static_cast<size_t>(head % capacity);
+  size_t first = nbytes < capacity - offset ? nbytes : static_cast<size_t>(capacity - offset);
+  memcpy(buf + offset, data, first);
+  memcpy(buf, static_cast<const uint8_t*>(data) + first, nbytes - first);
+  __atomic_store_n(&ring->head, head + nbytes, __ATOMIC_SEQ_CST);
+  MinRPCShmNotify(ring);
+  return static_cast<ssize_t>(nbytes);
+}
+
+/*!
+ * \brief Read up to size bytes from a ring, waiting until it has data.
+ * \param header The region.
+ * \param index The index of the ring.
+ * \param data The buffer to read into.
+ * \param size The size of the buffer.
+ * \param alive Returns whether the other peer is still alive.
+ * \return The number of bytes read, 0 if the ring is closed or the peer died.
+ */
+template <typename FAlive>
+inline ssize_t MinRPCShmRead(MinRPCShmHeader* header, int index, void* data, size_t size,
+                             FAlive alive) {
+  MinRPCShmRing* ring = &header->rings[index];
+  uint64_t capacity = header->capacity;
+  uint64_t tail = ring->tail;
+  auto has_data = [&]() {
+    return __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != tail ||
+           __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) != 0;
+  };
+  if (!MinRPCShmWait(ring, has_data, alive)) return 0;
+  uint64_t avail = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+  if (avail == 0) return 0;
+  size_t nbytes = size < avail ? size : static_cast<size_t>(avail);
+  const uint8_t* buf = MinRPCShmData(header, index);
+  size_t offset = static_cast<size_t>(tail % capacity);
+  size_t first = nbytes < capacity - offset ? nbytes : static_cast<size_t>(capacity - offset);
+  memcpy(data, buf + offset, first);
+  memcpy(static_cast<uint8_t*>(data) + first, buf, nbytes - first);
+  __atomic_store_n(&ring->tail, tail + nbytes, __ATOMIC_SEQ_CST);
+  MinRPCShmNotify(ring);
+  return static_cast<ssize_t>(nbytes);
+}
+
+/*!
+ * \brief Close a ring, the reader sees the end of the stream once it drained the ring.
+ * \param header The region.
+ * \param index The index of the ring.
+ */
+inline void MinRPCShmClose(MinRPCShmHeader* header, int index) {
+  MinRPCShmRing* ring = &header->rings[index];
+  __atomic_store_n(&ring->closed, 1, __ATOMIC_SEQ_CST);
+  if (pthread_mutex_lock(&ring->mutex) == EOWNERDEAD) pthread_mutex_consistent(&ring->mutex);
+  pthread_cond_broadcast(&ring->cond);
+  pthread_mutex_unlock(&ring->mutex);
+}
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_MINRPC_MINRPC_SHM_RING_H_
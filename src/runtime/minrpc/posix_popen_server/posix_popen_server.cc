@@ -20,11 +20,13 @@
 // Disable constructor to bring minimum dep on c++ABI.
 #define TVM_ARENA_HAS_DESTRUCTOR 0
 
+#include <string.h>
 #include <unistd.h>
 
 #include <cstdlib>
 
 #include "minrpc_server.h"
+#include "minrpc_shm_ring.h"
 
 namespace tvm {
 namespace runtime {
@@ -57,14 +59,54 @@ class PosixIOHandler {
   int write_fd_{1};
 };
 
+/*!
+ * \brief IOHandler based on the shared memory rings set up by the client.
+ */
+class ShmIOHandler {
+ public:
+  explicit ShmIOHandler(MinRPCShmHeader* header) : header_(header), parent_(getppid()) {}
+
+  void MessageStart(uint64_t packet_nbytes) {}
+
+  void MessageDone() {}
+
+  ssize_t PosixRead(void* data, size_t size) {
+    return MinRPCShmRead(header_, 0, data, size, [this]() { return getppid() == parent_; });
+  }
+
+  ssize_t PosixWrite(const void* data, size_t size) {
+    return MinRPCShmWrite(header_, 1, data, size, [this]() { return getppid() == parent_; });
+  }
+
+  void Exit(int code) { exit(code); }
+
+  void Close() { MinRPCShmClose(header_, 1); }
+
+ private:
+  MinRPCShmHeader* header_;
+  pid_t parent_;
+};
+
 /*! \brief Type for the posix version of min rpc server. */
 using PosixMinRPCServer = MinRPCServer<PosixIOHandler>;
+/*! \brief Type for the shared memory version of min rpc server. */
+using ShmMinRPCServer = MinRPCServer<ShmIOHandler>;
 
 }  // namespace runtime
 }  // namespace tvm
 
 int main(int argc, char* argv[]) {
   if (argc != 3) return -1;
+  if (strcmp(argv[1], "shm") == 0) {
+    // the descriptor of the shared memory region follows.
+    tvm::runtime::MinRPCShmHeader* header = tvm::runtime::MinRPCShmMap(atoi(argv[2]));
+    if (header == nullptr) return -1;
+    tvm::runtime::ShmIOHandler handler(header);
+    tvm::runtime::ShmMinRPCServer server(&handler);
+    while (server.ProcessOnePacket()) {
+    }
+    return 0;
+  }
   // pass the descriptor via arguments.
   tvm::runtime::PosixIOHandler handler(atoi(argv[1]), atoi(argv[2]));
   tvm::runtime::PosixMinRPCServer server(&handler);
@@ -89,6 +89,21 @@ Module Module::LoadFromFile(const std::string& file_name, const std::string& for
   return m;
 }
 
+Module Module::LoadFromBytes(const std::string& data, const std::string& format) {
+  std::string fmt = format;
+  if (fmt == "dll" || fmt == "dylib" || fmt == "dso") {
+    fmt = "so";
+  }
+  std::string load_f_name = "runtime.module.loadbytes_" + fmt;
+  const PackedFunc* f = Registry::Get(load_f_name);
+  ICHECK(f != nullptr) << "Loader of " << format << "(" << load_f_name << ") is not presented.";
+  TVMByteArray arr;
+  arr.data = data.data();
+  arr.size = data.size();
+  Module m = (*f)(arr);
+  return m;
+}
+
 void ModuleNode::SaveToFile(const std::string& file_name, const std::string& format) {
   LOG(FATAL) << "Module[" << type_key() << "] does not support SaveToFile";
 }
@@ -177,6 +192,11 @@ TVM_REGISTER_GLOBAL("runtime.ModuleGetTypeKey").set_body_typed([](Module mod) {
 
 TVM_REGISTER_GLOBAL("runtime.ModuleLoadFromFile").set_body_typed(Module::LoadFromFile);
 
+TVM_REGISTER_GLOBAL("runtime.ModuleLoadFromBytes")
+    .set_body_typed([](std::string data, std::string format) {
+      return Module::LoadFromBytes(data, format);
+    });
+
 TVM_REGISTER_GLOBAL("runtime.ModuleSaveToFile")
     .set_body_typed([](Module mod, tvm::String name, tvm::String fmt) {
       mod->SaveToFile(name, fmt);
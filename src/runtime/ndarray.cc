@@ -25,7 +25,13 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/vm/memory_manager.h>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
 
 #include "runtime_base.h"
 
@@ -62,7 +68,6 @@ inline void VerifyDataType(DLDataType dtype) {
 void ArrayCopyFromBytes(DLTensor* handle, const void* data, size_t nbytes) {
   size_t arr_size = GetDataSize(*handle);
   ICHECK_EQ(arr_size, nbytes) << "ArrayCopyFromBytes: size mismatch";
-  ICHECK(IsContiguous(*handle)) << "ArrayCopyFromBytes only support contiguous array for now";
 
   DLTensor from;
   from.data = const_cast<void*>(data);
@@ -72,6 +77,7 @@ void ArrayCopyFromBytes(DLTensor* handle, const void* data, size_t nbytes) {
   from.shape = handle->shape;
   from.strides = nullptr;
   from.byte_offset = 0;
+  profiling::RecordCopy(nbytes);
   DeviceAPI::Get(handle->device)->CopyDataFromTo(&from, handle, nullptr);
   // Synchronize in case data become unavailable later.
   DeviceAPI::Get(handle->device)->StreamSync(handle->device, nullptr);
@@ -80,7 +86,6 @@ void ArrayCopyFromBytes(DLTensor* handle, const void* data, size_t nbytes) {
 void ArrayCopyToBytes(const DLTensor* handle, void* data, size_t nbytes) {
   size_t arr_size = GetDataSize(*handle);
   ICHECK_EQ(arr_size, nbytes) << "ArrayCopyToBytes: size mismatch";
-  ICHECK(IsContiguous(*handle)) << "ArrayCopyToBytes only support contiguous array for now";
 
   DLTensor to;
   to.data = const_cast<void*>(data);
@@ -91,6 +96,7 @@ void ArrayCopyToBytes(const DLTensor* handle, void* data, size_t nbytes) {
   to.strides = nullptr;
   to.byte_offset = 0;
 
+  profiling::RecordCopy(nbytes);
   DeviceAPI::Get(handle->device)->CopyDataFromTo(const_cast<DLTensor*>(handle), &to, nullptr);
   // Synchronize in case data become unavailable later.
   DeviceAPI::Get(handle->device)->StreamSync(handle->device, nullptr);
@@ -174,7 +180,7 @@ struct NDArray::Internal {
 
 NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype) {
   ICHECK(data_ != nullptr);
-  ICHECK(get_mutable()->dl_tensor.strides == nullptr) << "Can only create view for compact tensor";
+  ICHECK(IsContiguous()) << "Can only create view for compact tensor";
   NDArray ret = Internal::Create(shape, dtype, get_mutable()->dl_tensor.device);
   ret.get_mutable()->dl_tensor.byte_offset = this->get_mutable()->dl_tensor.byte_offset;
   size_t curr_size = GetDataSize(this->get_mutable()->dl_tensor);
@@ -188,10 +194,125 @@ NDArray NDArray::CreateView(std::vector<int64_t> shape, DLDataType dtype) {
   return ret;
 }
 
+NDArray NDArray::CreateStridedView(std::vector<int64_t> shape, std::vector<int64_t> strides,
+                                   int64_t elem_offset) const {
+  ICHECK(data_ != nullptr);
+  const DLTensor& tensor = get_mutable()->dl_tensor;
+  ICHECK_EQ(shape.size(), strides.size()) << "The view needs a stride for each axis";
+  ICHECK_EQ(tensor.dtype.bits * tensor.dtype.lanes % 8, 0)
+      << "Can only create strided views of byte-sized elements";
+  // The last element spanned by the current array and by the view, from the first one
+  auto last_element = [](int ndim, const int64_t* shape, const int64_t* strides) {
+    int64_t last = 0;
+    int64_t stride = 1;
+    for (int i = ndim; i != 0; --i) {
+      if (shape[i - 1] == 0) return int64_t(-1);
+      last += (shape[i - 1] - 1) * (strides != nullptr ? strides[i - 1] : stride);
+      stride *= shape[i - 1];
+    }
+    return last;
+  };
+  for (size_t i = 0; i < shape.size(); ++i) {
+    ICHECK(shape[i] >= 0 && strides[i] >= 0)
+        << "The shape and strides of a view must not be negative";
+  }
+  int64_t view_last = last_element(shape.size(), shape.data(), strides.data());
+  ICHECK(elem_offset >= 0 &&
+         (view_last < 0 ||
+          elem_offset + view_last <= last_element(tensor.ndim, tensor.shape, tensor.strides)))
+      << "Tries to create a view out of the memory of the current array";
+
+  NDArray ret = Internal::Create(shape, tensor.dtype, tensor.device);
+  Container* view = ret.get_mutable();
+  view->dl_tensor.byte_offset =
+      tensor.byte_offset + elem_offset * (tensor.dtype.bits * tensor.dtype.lanes / 8);
+  view->strides_ = std::move(strides);
+  view->dl_tensor.strides = dmlc::BeginPtr(view->strides_);
+  // Compact views keep no strides, which most kernels and copies expect
+  if (::tvm::runtime::IsContiguous(view->dl_tensor)) {
+    view->strides_.clear();
+    view->dl_tensor.strides = nullptr;
+  }
+  // increase ref count
+  get_mutable()->IncRef();
+  view->manager_ctx = get_mutable();
+  view->dl_tensor.data = tensor.data;
+  return ret;
+}
+
+NDArray NDArray::Slice(int axis, int64_t begin, int64_t end) const {
+  ICHECK(data_ != nullptr);
+  const DLTensor& tensor = get_mutable()->dl_tensor;
+  ICHECK(axis >= 0 && axis < tensor.ndim) << "Cannot slice axis " << axis << " of an array of "
+                                          << tensor.ndim << " axes";
+  ICHECK(0 <= begin && begin <= end && end <= tensor.shape[axis])
+      << "Cannot slice [" << begin << ", " << end << ") of an axis of extent "
+      << tensor.shape[axis];
+  std::vector<int64_t> strides(tensor.ndim);
+  int64_t stride = 1;
+  for (int i = tensor.ndim; i != 0; --i) {
+    strides[i - 1] = tensor.strides != nullptr ? tensor.strides[i - 1] : stride;
+    stride *= tensor.shape[i - 1];
+  }
+  std::vector<int64_t> shape = Shape();
+  shape[axis] = end - begin;
+  return CreateStridedView(std::move(shape), strides, begin * strides[axis]);
+}
+
 DLManagedTensor* NDArray::ToDLPack() const { return Internal::ToDLPack(get_mutable()); }
 
+/*!
+ * \brief The devices whose NDArray::Empty allocations are cached by their pooled allocator.
+ *
+ *  The freed buffers are reused by later allocations on the same device without a
+ *  synchronization. Like the device allocations they replace, this is ordered with the
+ *  kernels and copies still in flight on the default stream of the device.
+ */
+class NDArrayPoolDevices {
+ public:
+  static NDArrayPoolDevices* Global() {
+    // NOTE: explicitly use new to avoid exit-time destruction of global state
+    static auto* inst = new NDArrayPoolDevices();
+    return inst;
+  }
+
+  bool Enabled(const Device& dev) {
+    if (num_enabled_.load(std::memory_order_relaxed) == 0) return false;
+    std::lock_guard<std::mutex> lock(mu_);
+    return devices_.count(dev) != 0;
+  }
+
+  void Set(const Device& dev, bool enable) {
+    ICHECK_LT(static_cast<int>(dev.device_type), kRPCSessMask)
+        << "Cannot pool the memory of a remote device";
+    std::lock_guard<std::mutex> lock(mu_);
+    if (enable) {
+      vm::Allocator* alloc = vm::MemoryManager::GetOrCreateAllocator(dev, vm::kPooled);
+      ICHECK_EQ(alloc->type(), vm::kPooled)
+          << DeviceName(dev.device_type) << "(" << dev.device_id
+          << ") already has an allocator that is not pooled";
+      devices_.insert(dev);
+    } else {
+      devices_.erase(dev);
+    }
+    num_enabled_.store(devices_.size(), std::memory_order_relaxed);
+  }
+
+ private:
+  std::mutex mu_;
+  std::unordered_set<Device> devices_;
+  std::atomic<size_t> num_enabled_{0};
+};
+
 NDArray NDArray::Empty(std::vector<int64_t> shape, DLDataType dtype, Device dev,
                        Optional<String> mem_scope) {
+  int64_t size = (dtype.bits * dtype.lanes + 7) / 8;
+  for (int64_t dim : shape) size *= dim;
+  profiling::RecordAllocation(size);
+  if ((!mem_scope.defined() || mem_scope.value() == "global") &&
+      NDArrayPoolDevices::Global()->Enabled(dev)) {
+    return vm::MemoryManager::GetAllocator(dev)->Empty(std::move(shape), dtype, dev);
+  }
   NDArray ret = Internal::Create(shape, dtype, dev);
   ret.get_mutable()->dl_tensor.data =
       DeviceAPI::Get(ret->device)
@@ -239,6 +360,7 @@ void NDArray::CopyFromTo(const DLTensor* from, DLTensor* to, TVMStreamHandle str
   // api manager.
   Device dev = from->device.device_type != kDLCPU ? from->device : to->device;
 
+  profiling::RecordCopy(from_size);
   DeviceAPI::Get(dev)->CopyDataFromTo(const_cast<DLTensor*>(from), to, stream);
 }
 
@@ -291,6 +413,15 @@ TVM_REGISTER_GLOBAL("runtime.TVMArrayAllocWithScope").set_body([](TVMArgs args,
   *ret = ndarray;
 });
 
+TVM_REGISTER_GLOBAL("runtime.NDArraySlice")
+    .set_body_typed([](NDArray array, int axis, int64_t begin, int64_t end) {
+      return array.Slice(axis, begin, end);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.SetNDArrayPool").set_body_typed([](Device dev, bool enable) {
+  NDArrayPoolDevices::Global()->Set(dev, enable);
+});
+
 int TVMArrayFree(TVMArrayHandle handle) {
   API_BEGIN();
   NDArray::Internal::FFIDecRef(handle);
@@ -21,6 +21,7 @@
  * \brief Object type management system.
  */
 #include <tvm/runtime/logging.h>
+#include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/registry.h>
 
@@ -217,6 +218,75 @@ uint32_t Object::TypeKey2Index(const std::string& key) {
   return TypeContext::Global()->TypeKey2Index(key);
 }
 
+namespace {
+
+/*!
+ * \brief The free lists of a thread. It is trivially destructible, so that the objects freed by
+ *  the destructors run at thread exit still find it.
+ */
+struct ThreadFreeLists {
+  struct Block {
+    Block* next;
+  };
+  /*! \brief The free blocks, by number of units. */
+  Block* heads[ObjectFreeLists::kMaxPooledUnits + 1];
+  /*! \brief The number of free blocks, by number of units. */
+  size_t sizes[ObjectFreeLists::kMaxPooledUnits + 1];
+  /*! \brief Whether the thread exited, the later frees go to the heap. */
+  bool drained;
+};
+
+static_assert(sizeof(ObjectFreeLists::Unit) >= sizeof(ThreadFreeLists::Block),
+              "the units must hold a free list link");
+
+thread_local ThreadFreeLists thread_free_lists;
+
+/*! \brief Return the blocks of a thread to the heap when it exits. */
+struct ThreadFreeListsDrainer {
+  ~ThreadFreeListsDrainer() {
+    ThreadFreeLists& lists = thread_free_lists;
+    for (size_t i = 0; i <= ObjectFreeLists::kMaxPooledUnits; ++i) {
+      while (lists.heads[i] != nullptr) {
+        ThreadFreeLists::Block* block = lists.heads[i];
+        lists.heads[i] = block->next;
+        delete[] reinterpret_cast<ObjectFreeLists::Unit*>(block);
+      }
+      lists.sizes[i] = 0;
+    }
+    lists.drained = true;
+  }
+};
+
+}  // namespace
+
+void* ObjectFreeLists::Alloc(size_t num_units) {
+  if (num_units <= kMaxPooledUnits) {
+    ThreadFreeLists& lists = thread_free_lists;
+    ThreadFreeLists::Block* block = lists.heads[num_units];
+    if (block != nullptr) {
+      lists.heads[num_units] = block->next;
+      --lists.sizes[num_units];
+      return block;
+    }
+  }
+  return new Unit[num_units];
+}
+
+void ObjectFreeLists::Free(void* data, size_t num_units) {
+  ThreadFreeLists& lists = thread_free_lists;
+  if (num_units > kMaxPooledUnits || lists.drained ||
+      (lists.sizes[num_units] + 1) * num_units * sizeof(Unit) > kMaxCachedBytes) {
+    delete[] static_cast<Unit*>(data);
+    return;
+  }
+  // Register the drain at thread exit, once a block is kept
+  static thread_local ThreadFreeListsDrainer drainer;
+  ThreadFreeLists::Block* block = static_cast<ThreadFreeLists::Block*>(data);
+  block->next = lists.heads[num_units];
+  lists.heads[num_units] = block;
+  ++lists.sizes[num_units];
+}
+
 TVM_REGISTER_GLOBAL("runtime.ObjectPtrHash").set_body_typed([](ObjectRef obj) {
   return static_cast<int64_t>(ObjectPtrHash()(obj));
 });
@@ -231,8 +231,14 @@ class OpenCLWorkspace : public DeviceAPI {
   virtual void Init() { Init("opencl", "gpu"); }
   // Check whether the context is OpenCL or not.
   virtual bool IsOpenCLDevice(Device dev) { return dev.device_type == kDLOpenCL; }
-  // get the queue of the device
-  cl_command_queue GetQueue(Device dev) {
+  // get the queue of the device, the stream of the thread if one is set
+  cl_command_queue GetQueue(Device dev);
+  // get the queue of a stream of the device, the current one for the null stream
+  cl_command_queue GetQueue(Device dev, TVMStreamHandle stream) {
+    return stream != nullptr ? static_cast<cl_command_queue>(stream) : GetQueue(dev);
+  }
+  // get the default queue of the device
+  cl_command_queue GetDefaultQueue(Device dev) {
     ICHECK(IsOpenCLDevice(dev));
     this->Init();
     ICHECK(dev.device_id >= 0 && static_cast<size_t>(dev.device_id) < queues.size())
@@ -243,7 +249,22 @@ class OpenCLWorkspace : public DeviceAPI {
   void SetDevice(Device dev) final;
   void GetAttr(Device dev, DeviceAttrKind kind, TVMRetValue* rv) final;
   void* AllocDataSpace(Device dev, size_t size, size_t alignment, DLDataType type_hint) final;
+  /*!
+   * \brief Allocate a data space, the memory scope "global.texture" as an image2d of RGBA
+   *  pixels: the last axis of extent 4 are the channels, the one before the width and the
+   *  others the height.
+   */
+  void* AllocDataSpace(Device dev, int ndim, const int64_t* shape, DLDataType dtype,
+                       Optional<String> mem_scope = NullOpt) final;
   void FreeDataSpace(Device dev, void* ptr) final;
+  /*!
+   * \brief Create a stream, an in-order command queue of the device. The kernels and copies
+   *  of different streams may run concurrently.
+   */
+  TVMStreamHandle CreateStream(Device dev) final;
+  void FreeStream(Device dev, TVMStreamHandle stream) final;
+  void SetStream(Device dev, TVMStreamHandle stream) final;
+  void SyncStreamFromTo(Device dev, TVMStreamHandle event_src, TVMStreamHandle event_dst) final;
   void StreamSync(Device dev, TVMStreamHandle stream) final;
   void* AllocWorkspace(Device dev, size_t size, DLDataType type_hint) final;
   void FreeWorkspace(Device dev, void* data) final;
@@ -274,6 +295,8 @@ class OpenCLThreadEntry {
   };
   /*! \brief The current device */
   Device device;
+  /*! \brief The current stream of the device, the default queue if null */
+  TVMStreamHandle stream{nullptr};
   /*! \brief The thread-local kernel table */
   std::vector<KTEntry> kernel_table;
   /*! \brief workspace pool */
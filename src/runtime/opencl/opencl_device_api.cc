@@ -23,6 +23,8 @@
 #include <dmlc/thread_local.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstring>
+
 #include "opencl_common.h"
 
 namespace tvm {
@@ -143,6 +145,46 @@ void* OpenCLWorkspace::AllocDataSpace(Device dev, size_t size, size_t alignment,
   return mptr;
 }
 
+void* OpenCLWorkspace::AllocDataSpace(Device dev, int ndim, const int64_t* shape,
+                                      DLDataType dtype, Optional<String> mem_scope) {
+  if (!mem_scope.defined() || mem_scope.value() != "global.texture") {
+    return DeviceAPI::AllocDataSpace(dev, ndim, shape, dtype, mem_scope);
+  }
+  this->Init();
+  ICHECK(context != nullptr) << "No OpenCL device";
+  ICHECK(ndim >= 2 && shape[ndim - 1] == 4 && dtype.lanes == 1)
+      << "A texture holds the pixels of a last axis of extent 4";
+  ICHECK(dtype.code == kDLFloat && (dtype.bits == 32 || dtype.bits == 16))
+      << "A texture holds float32 or float16 pixels";
+  cl_image_format format;
+  format.image_channel_order = CL_RGBA;
+  format.image_channel_data_type = dtype.bits == 32 ? CL_FLOAT : CL_HALF_FLOAT;
+  cl_image_desc desc;
+  memset(&desc, 0, sizeof(desc));
+  desc.image_type = CL_MEM_OBJECT_IMAGE2D;
+  desc.image_width = shape[ndim - 2];
+  desc.image_height = 1;
+  for (int i = 0; i < ndim - 2; ++i) {
+    desc.image_height *= shape[i];
+  }
+  cl_int err_code;
+  cl_mem mptr = clCreateImage(this->context, CL_MEM_READ_WRITE, &format, &desc, nullptr, &err_code);
+  OPENCL_CHECK_ERROR(err_code);
+  return mptr;
+}
+
+// Whether the memory object is an image, and its region when it is.
+static bool GetImageRegion(const void* ptr, size_t region[3]) {
+  cl_mem mptr = static_cast<cl_mem>(const_cast<void*>(ptr));
+  cl_mem_object_type type;
+  OPENCL_CALL(clGetMemObjectInfo(mptr, CL_MEM_TYPE, sizeof(type), &type, nullptr));
+  if (type != CL_MEM_OBJECT_IMAGE2D) return false;
+  OPENCL_CALL(clGetImageInfo(mptr, CL_IMAGE_WIDTH, sizeof(size_t), &region[0], nullptr));
+  OPENCL_CALL(clGetImageInfo(mptr, CL_IMAGE_HEIGHT, sizeof(size_t), &region[1], nullptr));
+  region[2] = 1;
+  return true;
+}
+
 void OpenCLWorkspace::FreeDataSpace(Device dev, void* ptr) {
   // We have to make sure that the memory object is not in the command queue
   // for some OpenCL platforms.
@@ -156,31 +198,106 @@ void OpenCLWorkspace::CopyDataFromTo(const void* from, size_t from_offset, void*
                                      size_t to_offset, size_t size, Device dev_from, Device dev_to,
                                      DLDataType type_hint, TVMStreamHandle stream) {
   this->Init();
-  ICHECK(stream == nullptr);
+  // The copies are asynchronous on an explicit stream, synchronous on the current one.
+  bool sync = stream == nullptr;
+  // The textures are copied whole, from or into a buffer at an offset.
+  const size_t origin[3] = {0, 0, 0};
+  size_t from_region[3], to_region[3];
+  bool from_image = IsOpenCLDevice(dev_from) && GetImageRegion(from, from_region);
+  bool to_image = IsOpenCLDevice(dev_to) && GetImageRegion(to, to_region);
+  ICHECK(!(from_image && from_offset) && !(to_image && to_offset))
+      << "Textures are copied whole, without offset";
+  if (from_image || to_image) {
+    const size_t* region = from_image ? from_region : to_region;
+    if (from_image && to_image) {
+      OPENCL_CALL(clEnqueueCopyImage(this->GetQueue(dev_to, stream),
+                                     static_cast<cl_mem>((void*)from),  // NOLINT(*)
+                                     static_cast<cl_mem>(to), origin, origin, region, 0, nullptr,
+                                     nullptr));
+    } else if (from_image && IsOpenCLDevice(dev_to)) {
+      OPENCL_CALL(clEnqueueCopyImageToBuffer(
+          this->GetQueue(dev_to, stream), static_cast<cl_mem>((void*)from),  // NOLINT(*)
+          static_cast<cl_mem>(to), origin, region, to_offset, 0, nullptr, nullptr));
+    } else if (to_image && IsOpenCLDevice(dev_from)) {
+      OPENCL_CALL(clEnqueueCopyBufferToImage(
+          this->GetQueue(dev_to, stream), static_cast<cl_mem>((void*)from),  // NOLINT(*)
+          static_cast<cl_mem>(to), from_offset, origin, region, 0, nullptr, nullptr));
+    } else if (from_image) {
+      OPENCL_CALL(clEnqueueReadImage(this->GetQueue(dev_from, stream),
+                                     static_cast<cl_mem>((void*)from),  // NOLINT(*)
+                                     CL_FALSE, origin, region, 0, 0,
+                                     static_cast<char*>(to) + to_offset, 0, nullptr, nullptr));
+      if (sync) OPENCL_CALL(clFinish(this->GetQueue(dev_from, stream)));
+    } else {
+      OPENCL_CALL(clEnqueueWriteImage(this->GetQueue(dev_to, stream), static_cast<cl_mem>(to),
+                                      CL_FALSE, origin, region, 0, 0,
+                                      static_cast<const char*>(from) + from_offset, 0, nullptr,
+                                      nullptr));
+      if (sync) OPENCL_CALL(clFinish(this->GetQueue(dev_to, stream)));
+    }
+    return;
+  }
   if (IsOpenCLDevice(dev_from) && IsOpenCLDevice(dev_to)) {
-    OPENCL_CALL(clEnqueueCopyBuffer(this->GetQueue(dev_to),
+    OPENCL_CALL(clEnqueueCopyBuffer(this->GetQueue(dev_to, stream),
                                     static_cast<cl_mem>((void*)from),  // NOLINT(*)
                                     static_cast<cl_mem>(to), from_offset, to_offset, size, 0,
                                     nullptr, nullptr));
   } else if (IsOpenCLDevice(dev_from) && dev_to.device_type == kDLCPU) {
-    OPENCL_CALL(clEnqueueReadBuffer(this->GetQueue(dev_from),
+    OPENCL_CALL(clEnqueueReadBuffer(this->GetQueue(dev_from, stream),
                                     static_cast<cl_mem>((void*)from),  // NOLINT(*)
                                     CL_FALSE, from_offset, size, static_cast<char*>(to) + to_offset,
                                     0, nullptr, nullptr));
-    OPENCL_CALL(clFinish(this->GetQueue(dev_from)));
+    if (sync) OPENCL_CALL(clFinish(this->GetQueue(dev_from, stream)));
   } else if (dev_from.device_type == kDLCPU && IsOpenCLDevice(dev_to)) {
-    OPENCL_CALL(clEnqueueWriteBuffer(this->GetQueue(dev_to), static_cast<cl_mem>(to), CL_FALSE,
-                                     to_offset, size, static_cast<const char*>(from) + from_offset,
-                                     0, nullptr, nullptr));
-    OPENCL_CALL(clFinish(this->GetQueue(dev_to)));
+    OPENCL_CALL(clEnqueueWriteBuffer(this->GetQueue(dev_to, stream), static_cast<cl_mem>(to),
+                                     CL_FALSE, to_offset, size,
+                                     static_cast<const char*>(from) + from_offset, 0, nullptr,
+                                     nullptr));
+    if (sync) OPENCL_CALL(clFinish(this->GetQueue(dev_to, stream)));
   } else {
     LOG(FATAL) << "Expect copy from/to OpenCL or between OpenCL";
   }
 }
 
+cl_command_queue OpenCLWorkspace::GetQueue(Device dev) {
+  TVMStreamHandle stream = GetThreadEntry()->stream;
+  return stream != nullptr ? static_cast<cl_command_queue>(stream) : GetDefaultQueue(dev);
+}
+
+TVMStreamHandle OpenCLWorkspace::CreateStream(Device dev) {
+  this->Init();
+  ICHECK(IsOpenCLDevice(dev));
+  ICHECK(dev.device_id >= 0 && static_cast<size_t>(dev.device_id) < devices.size())
+      << "Invalid OpenCL device_id=" << dev.device_id;
+  cl_int err_code;
+  cl_command_queue queue =
+      clCreateCommandQueue(this->context, this->devices[dev.device_id], 0, &err_code);
+  OPENCL_CHECK_ERROR(err_code);
+  return static_cast<TVMStreamHandle>(queue);
+}
+
+void OpenCLWorkspace::FreeStream(Device dev, TVMStreamHandle stream) {
+  ICHECK(stream != nullptr) << "The default queue of the device is not freed";
+  cl_command_queue queue = static_cast<cl_command_queue>(stream);
+  OPENCL_CALL(clFinish(queue));
+  OPENCL_CALL(clReleaseCommandQueue(queue));
+}
+
+void OpenCLWorkspace::SetStream(Device dev, TVMStreamHandle stream) {
+  GetThreadEntry()->stream = stream;
+}
+
+void OpenCLWorkspace::SyncStreamFromTo(Device dev, TVMStreamHandle event_src,
+                                       TVMStreamHandle event_dst) {
+  // The commands of the destination wait for the ones enqueued so far in the source.
+  cl_event evt;
+  OPENCL_CALL(clEnqueueMarkerWithWaitList(this->GetQueue(dev, event_src), 0, nullptr, &evt));
+  OPENCL_CALL(clEnqueueBarrierWithWaitList(this->GetQueue(dev, event_dst), 1, &evt, nullptr));
+  OPENCL_CALL(clReleaseEvent(evt));
+}
+
 void OpenCLWorkspace::StreamSync(Device dev, TVMStreamHandle stream) {
-  ICHECK(stream == nullptr);
-  OPENCL_CALL(clFinish(this->GetQueue(dev)));
+  OPENCL_CALL(clFinish(this->GetQueue(dev, stream)));
 }
 
 void* OpenCLWorkspace::AllocWorkspace(Device dev, size_t size, DLDataType type_hint) {
@@ -26,11 +26,13 @@
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/profiling.h>
 
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <numeric>
+#include <unordered_set>
 
 namespace tvm {
 namespace runtime {
@@ -100,16 +102,169 @@ TVM_REGISTER_GLOBAL("profiling.start_timer").set_body_typed(Timer::Start);
 
 namespace profiling {
 
+/*! \brief Read the counters a device exposes through "profiling.counters.<device>". */
+std::unordered_map<std::string, int64_t> ReadDeviceCounters(Device dev) {
+  std::unordered_map<std::string, int64_t> counters;
+  auto f = Registry::Get(std::string("profiling.counters.") + DeviceName(dev.device_type));
+  if (f == nullptr) return counters;
+  Map<String, ObjectRef> values = (*f)(dev);
+  for (auto p : values) {
+    const CountNode* count = p.second.as<CountNode>();
+    ICHECK(count) << "Device counter " << p.first << " must be a CountNode";
+    counters[p.first] = count->value;
+  }
+  return counters;
+}
+
+/*! \brief The increase of the monotonic counters of a device over a call or a run. */
+class DeviceCounterCollectorNode : public MetricCollectorNode {
+ public:
+  ObjectRef Start(Device dev) final {
+    auto counters = ReadDeviceCounters(dev);
+    if (counters.empty()) return ObjectRef();
+    auto state = make_object<StateNode>();
+    state->dev = dev;
+    state->begin = std::move(counters);
+    return ObjectRef(state);
+  }
+
+  Map<String, ObjectRef> Stop(ObjectRef obj) final {
+    const auto* state = obj.as<StateNode>();
+    Map<String, ObjectRef> metrics;
+    for (auto& p : ReadDeviceCounters(state->dev)) {
+      auto it = state->begin.find(p.first);
+      int64_t base = it == state->begin.end() ? 0 : it->second;
+      metrics.Set(p.first, ObjectRef(make_object<CountNode>(p.second - base)));
+    }
+    return metrics;
+  }
+
+  static constexpr const char* _type_key = "runtime.profiling.DeviceCounterCollector";
+  TVM_DECLARE_FINAL_OBJECT_INFO(DeviceCounterCollectorNode, MetricCollectorNode);
+
+ private:
+  struct StateNode : public Object {
+    Device dev;
+    std::unordered_map<std::string, int64_t> begin;
+    static constexpr const char* _type_key = "runtime.profiling.DeviceCounterState";
+    TVM_DECLARE_FINAL_OBJECT_INFO(StateNode, Object);
+  };
+};
+
+/*! \brief The bytes the runtime allocated and copied, on all the devices. */
+static std::atomic<int64_t> bytes_allocated{0};
+static std::atomic<int64_t> bytes_copied{0};
+
+void RecordAllocation(int64_t bytes) {
+  bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void RecordCopy(int64_t bytes) { bytes_copied.fetch_add(bytes, std::memory_order_relaxed); }
+
+/*! \brief The bytes allocated and copied by the runtime over a call or a run. */
+class MemoryCollectorNode : public MetricCollectorNode {
+ public:
+  ObjectRef Start(Device dev) final {
+    auto state = make_object<StateNode>();
+    state->allocated = bytes_allocated.load(std::memory_order_relaxed);
+    state->copied = bytes_copied.load(std::memory_order_relaxed);
+    return ObjectRef(state);
+  }
+
+  Map<String, ObjectRef> Stop(ObjectRef obj) final {
+    const auto* state = obj.as<StateNode>();
+    int64_t allocated = bytes_allocated.load(std::memory_order_relaxed) - state->allocated;
+    int64_t copied = bytes_copied.load(std::memory_order_relaxed) - state->copied;
+    Map<String, ObjectRef> metrics;
+    if (allocated) metrics.Set("Bytes Allocated", ObjectRef(make_object<CountNode>(allocated)));
+    if (copied) metrics.Set("Bytes Copied", ObjectRef(make_object<CountNode>(copied)));
+    return metrics;
+  }
+
+  static constexpr const char* _type_key = "runtime.profiling.MemoryCollector";
+  TVM_DECLARE_FINAL_OBJECT_INFO(MemoryCollectorNode, MetricCollectorNode);
+
+ private:
+  struct StateNode : public Object {
+    int64_t allocated;
+    int64_t copied;
+    static constexpr const char* _type_key = "runtime.profiling.MemoryCollectorState";
+    TVM_DECLARE_FINAL_OBJECT_INFO(StateNode, Object);
+  };
+};
+
+TVM_REGISTER_OBJECT_TYPE(MetricCollectorNode);
+TVM_REGISTER_OBJECT_TYPE(DeviceCounterCollectorNode);
+TVM_REGISTER_OBJECT_TYPE(MemoryCollectorNode);
+
+std::vector<MetricCollector> DefaultMetricCollectors() {
+  std::vector<MetricCollector> collectors = {
+      MetricCollector(make_object<DeviceCounterCollectorNode>()),
+      MetricCollector(make_object<MemoryCollectorNode>())};
+  const std::string prefix = "runtime.profiling.metric_collector.";
+  for (const auto& name : Registry::ListNames()) {
+    if (name.compare(0, prefix.size(), prefix) == 0) {
+      MetricCollector collector = (*Registry::Get(name))();
+      collectors.push_back(collector);
+    }
+  }
+  return collectors;
+}
+
+/*! \brief Start the collectors on a device. */
+static std::vector<ObjectRef> StartCollectors(const std::vector<MetricCollector>& collectors,
+                                              Device dev) {
+  std::vector<ObjectRef> states;
+  for (const auto& collector : collectors) {
+    states.push_back(collector->Start(dev));
+  }
+  return states;
+}
+
+/*! \brief Stop the collectors, adding their metrics. */
+static void StopCollectors(const std::vector<MetricCollector>& collectors,
+                           const std::vector<ObjectRef>& states,
+                           std::unordered_map<std::string, ObjectRef>* metrics) {
+  for (size_t i = 0; i < collectors.size(); ++i) {
+    if (!states[i].defined()) continue;
+    for (auto p : collectors[i]->Stop(states[i])) {
+      (*metrics)[p.first] = p.second;
+    }
+  }
+}
+
+static Profiler** CurrentProfiler() {
+  static thread_local Profiler* current = nullptr;
+  return &current;
+}
+
+Profiler* Profiler::Current() { return *CurrentProfiler(); }
+
+Profiler::~Profiler() {
+  if (Current() == this) *CurrentProfiler() = prev_current_;
+}
+
 void Profiler::Start(const std::vector<Device>& devs) {
   CHECK(global_timers_.empty()) << "You can only call Start once per Profiler.";
+  for (const auto& collector : collectors_) {
+    collector->Init(devs);
+  }
   for (auto dev : devs) {
     global_timers_.emplace_back(dev, Timer::Start(dev));
+    global_states_.push_back(StartCollectors(collectors_, dev));
   }
+  prev_current_ = Current();
+  *CurrentProfiler() = this;
 }
 
 void Profiler::StartCall(String name, Device dev,
                          std::unordered_map<std::string, ObjectRef> extra_metrics) {
-  in_flight_.push(CallFrame{dev, name, Timer::Start(dev), extra_metrics});
+  if (!in_flight_.empty()) {
+    extra_metrics["Parent"] = in_flight_.top().name;
+  }
+  // Start the collectors first, so that the timer does not include them.
+  std::vector<ObjectRef> states = StartCollectors(collectors_, dev);
+  in_flight_.push(CallFrame{dev, name, Timer::Start(dev), extra_metrics, std::move(states)});
 }
 
 void Profiler::StopCall(std::unordered_map<std::string, ObjectRef> extra_metrics) {
@@ -118,6 +273,8 @@ void Profiler::StopCall(std::unordered_map<std::string, ObjectRef> extra_metrics
   for (auto& p : extra_metrics) {
     cf.extra_metrics[p.first] = p.second;
   }
+  StopCollectors(collectors_, cf.collector_states, &cf.extra_metrics);
+  cf.collector_states.clear();
   in_flight_.pop();
   calls_.push_back(cf);
 }
@@ -127,6 +284,38 @@ void Profiler::Stop() {
   for (auto p : global_timers_) {
     p.second->Stop();
   }
+  // Keep the metrics of the collectors over the run
+  for (size_t i = 0; i < global_timers_.size(); ++i) {
+    std::unordered_map<std::string, ObjectRef> metrics;
+    StopCollectors(collectors_, global_states_[i], &metrics);
+    global_metrics_.push_back(metrics);
+  }
+  global_states_.clear();
+  stopped_ = true;
+  if (Current() == this) *CurrentProfiler() = prev_current_;
+}
+
+/*!
+ * \brief Derive the throughputs and the arithmetic intensity of a row from its duration, FLOPs
+ *  and bytes accessed, the axes of the roofline model.
+ */
+static Map<String, ObjectRef> WithThroughputMetrics(Map<String, ObjectRef> row) {
+  auto count = [&](const char* key) -> int64_t {
+    auto it = row.find(key);
+    if (it == row.end() || !(*it).second.as<CountNode>()) return 0;
+    return (*it).second.as<CountNode>()->value;
+  };
+  auto it = row.find("Duration (us)");
+  if (it == row.end() || !(*it).second.as<DurationNode>()) return row;
+  double ns = (*it).second.as<DurationNode>()->microseconds * 1e3;
+  int64_t flops = count("FLOPs");
+  int64_t bytes = count("Bytes Accessed");
+  if (flops > 0 && ns > 0) row.Set("GFLOP/s", ObjectRef(make_object<RatioNode>(flops / ns)));
+  if (bytes > 0 && ns > 0) row.Set("GB/s", ObjectRef(make_object<RatioNode>(bytes / ns)));
+  if (flops > 0 && bytes > 0) {
+    row.Set("FLOP/Byte", ObjectRef(make_object<RatioNode>(static_cast<double>(flops) / bytes)));
+  }
+  return row;
 }
 
 String ShapeString(const std::vector<NDArray>& shapes) {
@@ -185,6 +374,8 @@ String ReportNode::AsCSV() const {
           s << (*it).second.as<DurationNode>()->microseconds;
         } else if ((*it).second.as<PercentNode>()) {
           s << (*it).second.as<PercentNode>()->percent;
+        } else if ((*it).second.as<RatioNode>()) {
+          s << (*it).second.as<RatioNode>()->ratio;
         } else if ((*it).second.as<StringObj>()) {
           s << "\"" << Downcast<String>((*it).second) << "\"";
         }
@@ -239,11 +430,12 @@ String ReportNode::AsTable(bool sort, bool aggregate) const {
               aggregated[metric.first] =
                   ObjectRef(make_object<PercentNode>(it->second.as<PercentNode>()->percent +
                                                      metric.second.as<PercentNode>()->percent));
-            } else if (metric.second.as<StringObj>()) {
-              // Don't do anything. Assume the two strings are the same.
+            } else if (metric.second.as<StringObj>() || metric.second.as<RatioNode>()) {
+              // Don't do anything. Assume the two strings are the same, the ratios are derived
+              // again from the aggregated metrics.
             } else {
               LOG(FATAL) << "Can only aggregate metrics with types DurationNode, CountNode, "
-                            "PercentNode, and StringObj, but got "
+                            "PercentNode, RatioNode and StringObj, but got "
                          << metric.second->GetTypeKey();
             }
           }
@@ -266,9 +458,10 @@ String ReportNode::AsTable(bool sort, bool aggregate) const {
               });
   }
 
-  // compute columnwise sums
+  // compute columnwise sums, of the top level calls as the nested ones are part of their parent
   std::unordered_map<String, ObjectRef> col_sums;
   for (auto call : aggregated_calls) {
+    if (call.find("Parent") != call.end()) continue;
     for (auto p : call) {
       if (p.second.as<CountNode>()) {
         int64_t val = p.second.as<CountNode>()->value;
@@ -295,8 +488,11 @@ String ReportNode::AsTable(bool sort, bool aggregate) const {
     }
   }
   col_sums["Name"] = String("Sum");
+  for (auto& call : aggregated_calls) {
+    call = WithThroughputMetrics(call);
+  }
   aggregated_calls.push_back({{String("Name"), String("----------")}});  // separator
-  aggregated_calls.push_back(col_sums);
+  aggregated_calls.push_back(WithThroughputMetrics(col_sums));
 
   // per-device metrics
   for (auto p : device_metrics) {
@@ -349,6 +545,10 @@ String ReportNode::AsTable(bool sort, bool aggregate) const {
           std::stringstream s;
           s << std::fixed << std::setprecision(2) << (*it).second.as<PercentNode>()->percent;
           val = s.str();
+        } else if ((*it).second.as<RatioNode>()) {
+          std::stringstream s;
+          s << std::fixed << std::setprecision(2) << (*it).second.as<RatioNode>()->ratio;
+          val = s.str();
         } else if ((*it).second.as<StringObj>()) {
           val = Downcast<String>((*it).second);
         }
@@ -407,12 +607,16 @@ Report Profiler::Report(bool aggregate, bool sort) {
   }
 
   std::unordered_map<String, Map<String, ObjectRef>> device_metrics;
-  for (auto p : global_times) {
+  for (size_t i = 0; i < global_times.size(); ++i) {
+    const auto& p = global_times[i];
     std::unordered_map<String, ObjectRef> row;
     row["Name"] = String("Total");
     row["Duration (us)"] = ObjectRef(make_object<DurationNode>(p.second));
     row["Percent"] = ObjectRef(make_object<PercentNode>(p.second / overall_time * 100));
     row["Device"] = String(DeviceString(p.first));
+    for (auto& c : global_metrics_[i]) {
+      row[c.first] = c.second;
+    }
     device_metrics[DeviceString(p.first)] = row;
   }
 
@@ -428,7 +632,7 @@ Report Profiler::Report(bool aggregate, bool sort) {
     for (auto p : cf.extra_metrics) {
       row[p.first] = p.second;
     }
-    rows.push_back(row);
+    rows.push_back(WithThroughputMetrics(row));
   }
 
   return profiling::Report(rows, device_metrics);
@@ -445,9 +649,22 @@ Report::Report(Array<Map<String, ObjectRef>> calls,
 TVM_REGISTER_OBJECT_TYPE(DurationNode);
 TVM_REGISTER_OBJECT_TYPE(PercentNode);
 TVM_REGISTER_OBJECT_TYPE(CountNode);
+TVM_REGISTER_OBJECT_TYPE(RatioNode);
 TVM_REGISTER_OBJECT_TYPE(ReportNode);
 
 TVM_REGISTER_GLOBAL("runtime.profiling.AsCSV").set_body_typed([](Report n) { return n->AsCSV(); });
+
+TVM_REGISTER_GLOBAL("runtime.profiling.CountValue").set_body_typed([](ObjectRef count) {
+  const CountNode* node = count.as<CountNode>();
+  ICHECK(node != nullptr) << "Expected a count, got " << count->GetTypeKey();
+  return node->value;
+});
+
+TVM_REGISTER_GLOBAL("runtime.profiling.RatioValue").set_body_typed([](ObjectRef ratio) {
+  const RatioNode* node = ratio.as<RatioNode>();
+  ICHECK(node != nullptr) << "Expected a ratio, got " << ratio->GetTypeKey();
+  return node->ratio;
+});
 }  // namespace profiling
 }  // namespace runtime
 }  // namespace tvm
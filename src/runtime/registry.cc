@@ -27,30 +27,82 @@
 #include <tvm/runtime/registry.h>
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
-#include <unordered_map>
+#include <vector>
 
 #include "runtime_base.h"
 
 namespace tvm {
 namespace runtime {
 
+// An interned name, never freed, with the function currently registered under it.
+struct Registry::Symbol {
+  std::string name;
+  std::atomic<Registry*> registry{nullptr};
+};
+
 struct Registry::Manager {
-  // map storing the functions.
-  // We deliberately used raw pointer.
+  // An open addressing hash table of the symbols. Slots are only ever filled, so that readers
+  // probe it without a lock while a writer holding the mutex adds a symbol.
+  struct Table {
+    explicit Table(size_t size) : mask(size - 1), slots(new std::atomic<Symbol*>[size]) {
+      for (size_t i = 0; i < size; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    size_t mask;
+    std::unique_ptr<std::atomic<Symbol*>[]> slots;
+  };
+  // The table of the symbols, replaced by one twice as large when half full.
+  // We deliberately used raw pointers, and never free the symbols, the registries, nor the
+  // replaced tables, which readers may still probe.
   // This is because PackedFunc can contain callbacks into the host language (Python) and the
   // resource can become invalid because of indeterministic order of destruction and forking.
   // The resources will only be recycled during program exit.
-  std::unordered_map<std::string, Registry*> fmap;
-  // mutex
+  std::atomic<Table*> table{new Table(1024)};
+  // The symbols in the order they were interned.
+  std::vector<Symbol*> symbols;
+  // mutex of the writers
   std::mutex mutex;
 
   Manager() {}
 
+  // Find the symbol of a name, without a lock.
+  Symbol* Find(const std::string& name) const {
+    const Table* t = table.load(std::memory_order_acquire);
+    for (size_t i = std::hash<std::string>()(name) & t->mask;; i = (i + 1) & t->mask) {
+      Symbol* sym = t->slots[i].load(std::memory_order_acquire);
+      if (sym == nullptr) return nullptr;
+      if (sym->name == name) return sym;
+    }
+  }
+
+  // Find or add the symbol of a name, with the mutex held.
+  Symbol* Intern(const std::string& name) {
+    if (Symbol* sym = Find(name)) return sym;
+    Table* t = table.load(std::memory_order_relaxed);
+    if ((symbols.size() + 1) * 2 > t->mask + 1) {
+      Table* grown = new Table((t->mask + 1) * 2);
+      for (Symbol* sym : symbols) Insert(grown, sym);
+      table.store(grown, std::memory_order_release);
+      t = grown;
+    }
+    Symbol* sym = new Symbol();
+    sym->name = name;
+    Insert(t, sym);
+    symbols.push_back(sym);
+    return sym;
+  }
+
+  static void Insert(Table* t, Symbol* sym) {
+    size_t i = std::hash<std::string>()(sym->name) & t->mask;
+    while (t->slots[i].load(std::memory_order_relaxed) != nullptr) i = (i + 1) & t->mask;
+    t->slots[i].store(sym, std::memory_order_release);
+  }
+
   static Manager* Global() {
     // We deliberately leak the Manager instance, to avoid leak sanitizers
-    // complaining about the entries in Manager::fmap being leaked at program
+    // complaining about the symbols of Manager being leaked at program
     // exit.
     static Manager* inst = new Manager();
     return inst;
@@ -65,40 +117,51 @@ Registry& Registry::set_body(PackedFunc f) {  // NOLINT(*)
 Registry& Registry::Register(const std::string& name, bool can_override) {  // NOLINT(*)
   Manager* m = Manager::Global();
   std::lock_guard<std::mutex> lock(m->mutex);
-  if (m->fmap.count(name)) {
+  Symbol* sym = m->Intern(name);
+  if (sym->registry.load(std::memory_order_relaxed) != nullptr) {
     ICHECK(can_override) << "Global PackedFunc " << name << " is already registered";
   }
 
   Registry* r = new Registry();
   r->name_ = name;
-  m->fmap[name] = r;
+  sym->registry.store(r, std::memory_order_release);
   return *r;
 }
 
 bool Registry::Remove(const std::string& name) {
   Manager* m = Manager::Global();
   std::lock_guard<std::mutex> lock(m->mutex);
-  auto it = m->fmap.find(name);
-  if (it == m->fmap.end()) return false;
-  m->fmap.erase(it);
-  return true;
+  Symbol* sym = m->Find(name);
+  if (sym == nullptr) return false;
+  return sym->registry.exchange(nullptr, std::memory_order_acq_rel) != nullptr;
 }
 
 const PackedFunc* Registry::Get(const std::string& name) {
+  return Get(Manager::Global()->Find(name));
+}
+
+const Registry::Symbol* Registry::Intern(const std::string& name) {
   Manager* m = Manager::Global();
+  if (Symbol* sym = m->Find(name)) return sym;
   std::lock_guard<std::mutex> lock(m->mutex);
-  auto it = m->fmap.find(name);
-  if (it == m->fmap.end()) return nullptr;
-  return &(it->second->func_);
+  return m->Intern(name);
+}
+
+const PackedFunc* Registry::Get(const Symbol* symbol) {
+  if (symbol == nullptr) return nullptr;
+  Registry* r = symbol->registry.load(std::memory_order_acquire);
+  return r == nullptr ? nullptr : &(r->func_);
 }
 
 std::vector<std::string> Registry::ListNames() {
   Manager* m = Manager::Global();
   std::lock_guard<std::mutex> lock(m->mutex);
   std::vector<std::string> keys;
-  keys.reserve(m->fmap.size());
-  for (const auto& kv : m->fmap) {
-    keys.push_back(kv.first);
+  keys.reserve(m->symbols.size());
+  for (const Symbol* sym : m->symbols) {
+    if (sym->registry.load(std::memory_order_relaxed) != nullptr) {
+      keys.push_back(sym->name);
+    }
   }
   return keys;
 }
@@ -205,6 +268,24 @@ int TVMFuncGetGlobal(const char* name, TVMFunctionHandle* out) {
   API_END();
 }
 
+int TVMFuncInternGlobal(const char* name, TVMGlobalSymbolHandle* out) {
+  API_BEGIN();
+  *out = const_cast<tvm::runtime::Registry::Symbol*>(tvm::runtime::Registry::Intern(name));
+  API_END();
+}
+
+int TVMFuncGetGlobalBySymbol(TVMGlobalSymbolHandle symbol, TVMFunctionHandle* out) {
+  API_BEGIN();
+  const tvm::runtime::PackedFunc* fp = tvm::runtime::Registry::Get(
+      static_cast<const tvm::runtime::Registry::Symbol*>(symbol));
+  if (fp != nullptr) {
+    *out = new tvm::runtime::PackedFunc(*fp);  // NOLINT(*)
+  } else {
+    *out = nullptr;
+  }
+  API_END();
+}
+
 int TVMFuncListGlobalNames(int* out_size, const char*** out_array) {
   API_BEGIN();
   TVMFuncThreadLocalEntry* ret = TVMFuncThreadLocalStore::Get();
@@ -53,6 +53,16 @@ class RPCChannel {
    * \return The actual bytes received.
    */
   virtual size_t Recv(void* data, size_t size) = 0;
+  /*!
+   * \brief Whether requests can be sent before the responses of the previous ones arrive.
+   * \return false when the remote cannot buffer more than one request.
+   */
+  virtual bool SupportsPipelining() const { return true; }
+  /*!
+   * \brief The bytes of the requests in flight the remote can buffer.
+   * \return 0 when only the default buffering of the channel limits them.
+   */
+  virtual uint64_t MaxPendingRequestBytes() const { return 0; }
 };
 
 /*!
@@ -0,0 +1,221 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rpc_compression.cc
+ * \brief Compression of the data sent through an RPC channel.
+ */
+#include "rpc_compression.h"
+
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if TVM_RPC_USE_LZ4
+#include <lz4.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+
+// Messages smaller than this are sent as they are
+constexpr size_t kRPCCompressMinBytes = 4 << 10;
+// Large messages are compressed in blocks of this size
+constexpr size_t kRPCCompressBlockBytes = 256 << 10;
+// Flag of the frame header marking compressed frames
+constexpr uint32_t kRPCCompressedFrame = 1U << 31;
+
+/*!
+ * \brief Channel that compresses the large messages sent through another channel.
+ *
+ *  The data is sent in frames, each starting with a 32-bit little endian header holding
+ *  the size of the frame. Compressed frames have the top bit of the header set and are
+ *  followed by the 32-bit size of the data once decompressed.
+ */
+class CompressedChannel final : public RPCChannel {
+ public:
+  CompressedChannel(std::unique_ptr<RPCChannel> channel, std::string codec)
+      : channel_(std::move(channel)), codec_(std::move(codec)) {}
+
+  size_t Send(const void* data, size_t size) final {
+    const char* ptr = static_cast<const char*>(data);
+    if (size < kRPCCompressMinBytes) {
+      SendFrame(ptr, size, false, size);
+      return size;
+    }
+    for (size_t offset = 0; offset < size; offset += kRPCCompressBlockBytes) {
+      size_t nbytes = std::min(kRPCCompressBlockBytes, size - offset);
+      size_t ncompressed = Compress(ptr + offset, nbytes);
+      if (ncompressed != 0 && ncompressed < nbytes) {
+        SendFrame(send_buffer_.data(), ncompressed, true, nbytes);
+      } else {
+        // Not worth it, the data does not compress
+        SendFrame(ptr + offset, nbytes, false, nbytes);
+      }
+    }
+    return size;
+  }
+
+  size_t Recv(void* data, size_t size) final {
+    if (recv_offset_ == recv_buffer_.size()) {
+      recv_buffer_.clear();
+      recv_offset_ = 0;
+      if (!RecvFrame()) return 0;
+    }
+    size_t nbytes = std::min(size, recv_buffer_.size() - recv_offset_);
+    memcpy(data, recv_buffer_.data() + recv_offset_, nbytes);
+    recv_offset_ += nbytes;
+    return nbytes;
+  }
+
+  bool SupportsPipelining() const final { return channel_->SupportsPipelining(); }
+  uint64_t MaxPendingRequestBytes() const final { return channel_->MaxPendingRequestBytes(); }
+
+ private:
+  // Compress the data into send_buffer_, returns the compressed size or 0 on failure.
+  size_t Compress(const char* data, size_t size) {
+#if TVM_RPC_USE_LZ4
+    if (codec_ == "lz4") {
+      send_buffer_.resize(LZ4_compressBound(static_cast<int>(size)));
+      int n = LZ4_compress_default(data, send_buffer_.data(), static_cast<int>(size),
+                                   static_cast<int>(send_buffer_.size()));
+      return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+#endif
+    LOG(FATAL) << "RPC compression codec " << codec_ << " is not enabled";
+    return 0;
+  }
+
+  void Decompress(const char* data, size_t size, char* out, size_t out_size) {
+#if TVM_RPC_USE_LZ4
+    if (codec_ == "lz4") {
+      int n = LZ4_decompress_safe(data, out, static_cast<int>(size), static_cast<int>(out_size));
+      ICHECK_EQ(n, static_cast<int>(out_size)) << "RPC channel received a corrupted lz4 frame";
+      return;
+    }
+#endif
+    LOG(FATAL) << "RPC compression codec " << codec_ << " is not enabled";
+  }
+
+  void SendFrame(const char* data, size_t size, bool compressed, size_t raw_size) {
+    uint8_t header[8];
+    size_t header_size = 4;
+    PutUInt32(header, static_cast<uint32_t>(size) | (compressed ? kRPCCompressedFrame : 0));
+    if (compressed) {
+      PutUInt32(header + 4, static_cast<uint32_t>(raw_size));
+      header_size = 8;
+    }
+    SendAll(header, header_size);
+    SendAll(data, size);
+  }
+
+  // Receive the next frame into recv_buffer_, returns false when the channel is closed.
+  bool RecvFrame() {
+    uint8_t header[4];
+    size_t n = channel_->Recv(header, sizeof(header));
+    if (n == 0) return false;
+    RecvAll(header + n, sizeof(header) - n);
+    uint32_t size = GetUInt32(header);
+    if ((size & kRPCCompressedFrame) == 0) {
+      recv_buffer_.resize(size);
+      RecvAll(recv_buffer_.data(), size);
+      return true;
+    }
+    size &= ~kRPCCompressedFrame;
+    RecvAll(header, sizeof(header));
+    uint32_t raw_size = GetUInt32(header);
+    compressed_buffer_.resize(size);
+    RecvAll(compressed_buffer_.data(), size);
+    recv_buffer_.resize(raw_size);
+    Decompress(compressed_buffer_.data(), size, recv_buffer_.data(), raw_size);
+    return true;
+  }
+
+  void SendAll(const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    for (size_t nsent = 0; nsent < size;) {
+      size_t n = channel_->Send(ptr + nsent, size - nsent);
+      ICHECK_NE(n, 0U) << "RPC channel closed while sending";
+      nsent += n;
+    }
+  }
+
+  void RecvAll(void* data, size_t size) {
+    char* ptr = static_cast<char*>(data);
+    for (size_t nrecv = 0; nrecv < size;) {
+      size_t n = channel_->Recv(ptr + nrecv, size - nrecv);
+      ICHECK_NE(n, 0U) << "RPC channel closed in the middle of a frame";
+      nrecv += n;
+    }
+  }
+
+  static void PutUInt32(uint8_t* ptr, uint32_t value) {
+    for (int i = 0; i < 4; ++i) ptr[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+
+  static uint32_t GetUInt32(const uint8_t* ptr) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(ptr[i]) << (8 * i);
+    return value;
+  }
+
+  std::unique_ptr<RPCChannel> channel_;
+  std::string codec_;
+  // Compressed data of the block being sent
+  std::vector<char> send_buffer_;
+  // Data of the compressed frame being received
+  std::vector<char> compressed_buffer_;
+  // Decompressed data not returned by Recv yet, from recv_offset_ on
+  std::vector<char> recv_buffer_;
+  size_t recv_offset_{0};
+};
+
+std::string RPCCompressionCodecs() {
+#if TVM_RPC_USE_LZ4
+  return "lz4";
+#else
+  return "";
+#endif
+}
+
+std::string GetRPCKeyCompression(const std::string& key) {
+  const std::string option = "-compress=";
+  size_t pos = key.find(option);
+  if (pos == std::string::npos) return "";
+  pos += option.length();
+  return key.substr(pos, key.find(' ', pos) - pos);
+}
+
+std::unique_ptr<RPCChannel> CreateCompressedChannel(std::unique_ptr<RPCChannel> channel,
+                                                    const std::string& codec) {
+  std::string codecs = "," + RPCCompressionCodecs() + ",";
+  ICHECK(!codec.empty() && codecs.find("," + codec + ",") != std::string::npos)
+      << "RPC compression codec " << codec << " is not enabled, supported: "
+      << RPCCompressionCodecs();
+  return std::unique_ptr<RPCChannel>(new CompressedChannel(std::move(channel), codec));
+}
+
+TVM_REGISTER_GLOBAL("rpc.CompressionCodecs").set_body_typed(RPCCompressionCodecs);
+
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file rpc_compression.h
+ * \brief Compression of the data sent through an RPC channel.
+ */
+#ifndef TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
+#define TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
+
+#include <memory>
+#include <string>
+
+#include "rpc_channel.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief The compression codecs supported by this build.
+ * \return The codec names separated by commas, empty when there is none.
+ */
+std::string RPCCompressionCodecs();
+
+/*!
+ * \brief Get the codec requested by the "-compress=<codec>" option of a handshake key.
+ * \param key The key exchanged in the RPC handshake.
+ * \return The codec, or an empty string when the key has no such option.
+ */
+std::string GetRPCKeyCompression(const std::string& key);
+
+/*!
+ * \brief Create a channel that compresses the large messages sent through another one.
+ *  Both ends of the connection need to use the same codec.
+ * \param channel The channel that carries the compressed data.
+ * \param codec The codec, one of RPCCompressionCodecs().
+ * \return The compressing channel.
+ */
+std::unique_ptr<RPCChannel> CreateCompressedChannel(std::unique_ptr<RPCChannel> channel,
+                                                    const std::string& codec);
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_RPC_RPC_COMPRESSION_H_
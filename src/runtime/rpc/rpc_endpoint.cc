@@ -33,6 +33,8 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,6 +48,21 @@
 namespace tvm {
 namespace runtime {
 
+// Default number of requests in flight on a client endpoint
+constexpr size_t kRPCPipelineDepth = 32;
+// Bytes the channel is assumed to buffer in each direction
+constexpr uint64_t kRPCPipelineBufferBytes = 32 << 10;
+// Expected size of a return packet
+constexpr uint64_t kRPCReturnPacketBytes = 256;
+// Packets from this size on are not buffered whole, their payload moves directly
+// between the channel and its source or destination.
+constexpr uint64_t kRPCDirectTransferBytes = 64 << 10;
+// Bytes of a large packet buffered before it is processed, enough for its header
+constexpr size_t kRPCPacketPeekBytes = 4 << 10;
+// Copies to non-CPU remote devices are split in blocks of this size, so that the
+// remote uploads a block to the device while the next one is in transit.
+constexpr uint64_t kRPCDeviceCopyBlockBytes = 4 << 20;
+
 /*!
  * Event-driven state-machine based handlers for RPCEndpoint.
  *
@@ -57,12 +74,16 @@ namespace runtime {
 class RPCEndpoint::EventHandler : public dmlc::Stream {
  public:
   EventHandler(support::RingBuffer* reader, support::RingBuffer* writer, std::string name,
-               std::string* remote_key, std::function<void()> flush_writer)
+               std::string* remote_key, std::function<void()> flush_writer,
+               std::function<size_t(void*, size_t)> frecv,
+               std::function<size_t(const void*, size_t)> fsend)
       : reader_(reader),
         writer_(writer),
         name_(name),
         remote_key_(remote_key),
-        flush_writer_(flush_writer) {
+        flush_writer_(flush_writer),
+        frecv_(frecv),
+        fsend_(fsend) {
     this->Clear();
 
     if (*remote_key == "%toinit") {
@@ -76,8 +97,9 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
    * \brief Bytes needed to fulfill current request
    */
   size_t BytesNeeded() const {
-    if (reader_->bytes_available() < pending_request_bytes_) {
-      return pending_request_bytes_ - reader_->bytes_available();
+    size_t nbytes = std::min(pending_request_bytes_, ready_limit_);
+    if (reader_->bytes_available() < nbytes) {
+      return nbytes - reader_->bytes_available();
     } else {
       return 0;
     }
@@ -89,11 +111,13 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
    */
   void RequestBytes(size_t nbytes) {
     pending_request_bytes_ += nbytes;
-    reader_->Reserve(pending_request_bytes_);
+    reader_->Reserve(std::min(pending_request_bytes_, ready_limit_));
   }
 
   /*! \return Whether we are ready to handle next request. */
-  bool Ready() const { return reader_->bytes_available() >= pending_request_bytes_; }
+  bool Ready() const {
+    return reader_->bytes_available() >= std::min(pending_request_bytes_, ready_limit_);
+  }
 
   /*! \return Whether we can perform a clean shutdown */
   bool CanCleanShutdown() const { return state_ == kRecvPacketNumBytes; }
@@ -101,6 +125,23 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   /*! \brief Finish the copy ack stage. */
   void FinishCopyAck() { this->SwitchToState(kRecvPacketNumBytes); }
 
+  /*!
+   * \brief Send data to the channel without going through the writer.
+   * \param data The data pointer.
+   * \param size The size of the data.
+   * \note The writer must be flushed first.
+   */
+  void SendDirect(const char* data, size_t size) {
+    ICHECK_EQ(writer_->bytes_available(), 0U);
+    for (size_t nsent = 0; nsent < size;) {
+      size_t n = fsend_(data + nsent, size - nsent);
+      if (n == 0) {
+        LOG(FATAL) << "Channel closes before we send the data";
+      }
+      nsent += n;
+    }
+  }
+
   /*!
    * \brief Enter the io loop until the next event.
    * \param client_mode Whether we are in the client.
@@ -125,6 +166,11 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
           ICHECK(this->Read(&packet_nbytes));
           if (packet_nbytes != 0) {
             this->SwitchToState(kProcessPacket);
+            // Only the header of a large packet is buffered when blocking IO is available,
+            // the rest is read from the channel into its destination.
+            if (!async_server_mode_ && packet_nbytes >= kRPCDirectTransferBytes) {
+              ready_limit_ = kRPCPacketPeekBytes;
+            }
             this->RequestBytes(packet_nbytes);
           } else {
             this->SwitchToState(kRecvPacketNumBytes);
@@ -240,6 +286,8 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   };
   // Current state;
   State state_;
+  // Bytes of the pending request that need to be buffered before processing it
+  size_t ready_limit_{std::numeric_limits<size_t>::max()};
   // Initialize remote header
   int init_header_step_{0};
   // Whether current handler is client or server mode.
@@ -262,7 +310,12 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
     }
     state_ = state;
     ICHECK(state != kInitHeader) << "cannot switch to init header";
+    if (state == kCopyAckReceived) {
+      // The client reads the copied data itself.
+      ready_limit_ = 0;
+    }
     if (state == kRecvPacketNumBytes) {
+      ready_limit_ = std::numeric_limits<size_t>::max();
       this->RequestBytes(sizeof(uint64_t));
       // recycle arena for the next session.
       arena_.RecycleAll();
@@ -400,12 +453,27 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
       this->WriteArray(dptr, num_bytes);
       this->SwitchToState(kRecvPacketNumBytes);
     };
+    // Send large data straight from the tensor when the writer can be flushed here.
+    auto fcopyack_direct = [this, fcopyack](char* dptr, size_t num_bytes) {
+      if (async_server_mode_ || num_bytes < kRPCDirectTransferBytes) {
+        fcopyack(dptr, num_bytes);
+        return;
+      }
+      RPCCode code = RPCCode::kCopyAck;
+      uint64_t packet_nbytes = sizeof(code) + num_bytes;
+
+      this->Write(packet_nbytes);
+      this->Write(code);
+      flush_writer_();
+      SendDirect(dptr, num_bytes);
+      this->SwitchToState(kRecvPacketNumBytes);
+    };
 
     // When session is local, we can directly treat handle
     // as the cpu pointer without allocating a temp space.
     if (arr->device.device_type == kDLCPU && sess->IsLocalSession() && DMLC_IO_NO_ENDIAN_SWAP) {
       char* data_ptr = reinterpret_cast<char*>(arr->data) + arr->byte_offset;
-      fcopyack(data_ptr, data_bytes);
+      fcopyack_direct(data_ptr, data_bytes);
     } else {
       char* temp_data = this->ArenaAlloc<char>(data_bytes);
       auto on_copy_complete = [this, elem_bytes, data_bytes, temp_data, fcopyack](RPCCode status,
@@ -599,7 +667,20 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   // Internal read function, update pending_request_bytes_
   size_t Read(void* data, size_t size) final {
     ICHECK_LE(size, pending_request_bytes_);
-    reader_->Read(data, size);
+    size_t nbuffered = std::min(size, reader_->bytes_available());
+    reader_->Read(data, nbuffered);
+    if (nbuffered < size) {
+      // The rest of a large packet is still in the channel.
+      ICHECK(!async_server_mode_) << "Packet is not fully buffered";
+      char* ptr = static_cast<char*>(data);
+      for (size_t nread = nbuffered; nread < size;) {
+        size_t n = frecv_(ptr + nread, size - nread);
+        if (n == 0) {
+          LOG(FATAL) << "Channel closes before we get needed bytes";
+        }
+        nread += n;
+      }
+    }
     pending_request_bytes_ -= size;
     return size;
   }
@@ -619,6 +700,9 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   std::string* remote_key_;
   // function to flush the writer.
   std::function<void()> flush_writer_;
+  // functions to receive from and send to the channel directly.
+  std::function<size_t(void*, size_t)> frecv_;
+  std::function<size_t(const void*, size_t)> fsend_;
 };
 
 RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn) {
@@ -646,6 +730,137 @@ RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncod
   return code;
 }
 
+void RPCEndpoint::FlushWriter() {
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [this](const void* data, size_t size) { return channel_->Send(data, size); },
+        writer_.bytes_available());
+  }
+}
+
+bool RPCEndpoint::CanPipeline(const PendingRequest& request) const {
+  if (pending_.size() >= max_pending_) return false;
+  if (max_pending_request_bytes_ != 0 &&
+      pending_request_bytes_ + request.request_bytes > max_pending_request_bytes_) {
+    return false;
+  }
+  // The remote stops reading while it cannot write its responses, only send more when
+  // either the responses or the requests in flight fit in the channel buffers.
+  return pending_response_bytes_ <= kRPCPipelineBufferBytes ||
+         pending_request_bytes_ + request.request_bytes <= kRPCPipelineBufferBytes;
+}
+
+uint64_t RPCEndpoint::SendRequest(PendingRequest request, const std::function<void()>& fwrite) {
+  std::lock_guard<std::mutex> send_lock(send_mutex_);
+  uint64_t id;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!pending_.empty() && channel_error_.empty() && !CanPipeline(request)) {
+      HandleResponsesUntil(&lock, num_completed_);
+    }
+    if (!channel_error_.empty()) {
+      LOG(FATAL) << "RPCError: Channel is broken by an earlier error:\n" << channel_error_;
+    }
+    id = next_request_id_++;
+    pending_request_bytes_ += request.request_bytes;
+    pending_response_bytes_ += request.response_bytes;
+    pending_.push_back(std::move(request));
+  }
+  fwrite();
+  FlushWriter();
+  return id;
+}
+
+void RPCEndpoint::SendDeferredRequest(PendingRequest request,
+                                      const std::function<void()>& fwrite) {
+  request.deferred = true;
+  uint64_t id = SendRequest(std::move(request), fwrite);
+  if (max_pending_ <= 1) WaitRequest(id);
+}
+
+void RPCEndpoint::WaitRequest(uint64_t id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  HandleResponsesUntil(&lock, id);
+  std::string error;
+  auto it = request_errors_.find(id);
+  if (it != request_errors_.end()) {
+    error = std::move(it->second);
+    request_errors_.erase(it);
+  } else {
+    error.swap(deferred_error_);
+  }
+  lock.unlock();
+  if (!error.empty()) throw Error(error);
+}
+
+void RPCEndpoint::HandleResponsesUntil(std::unique_lock<std::mutex>* lock, uint64_t id) {
+  while (num_completed_ <= id) {
+    if (reading_) {
+      response_cv_.wait(*lock);
+    } else {
+      HandleNextResponse(lock);
+    }
+  }
+}
+
+void RPCEndpoint::HandleNextResponse(std::unique_lock<std::mutex>* lock) {
+  ICHECK(!pending_.empty());
+  // Other threads keep sending requests while this one reads,
+  // the references to the elements of a deque survive push_back.
+  PendingRequest& request = pending_.front();
+  reading_ = true;
+  lock->unlock();
+  std::string error;
+  bool broken = false;
+  try {
+    RPCCode code = RPCCode::kNone;
+    while (code != RPCCode::kReturn && code != RPCCode::kCopyAck) {
+      size_t bytes_needed = handler_->BytesNeeded();
+      if (bytes_needed != 0) {
+        size_t n = reader_.WriteWithCallback(
+            [this](void* data, size_t size) { return channel_->Recv(data, size); }, bytes_needed);
+        if (n == 0) {
+          LOG(FATAL) << "Channel closes before we get needed bytes";
+        }
+      }
+      code = handler_->HandleNextEvent(true, false, request.encode_return);
+      ICHECK(code != RPCCode::kShutdown) << "Remote shuts down with requests in flight";
+    }
+    if (code == RPCCode::kCopyAck) {
+      ICHECK(request.to_bytes != nullptr) << "Received a copy ack without a pending copy";
+      handler_->ReadArray(reinterpret_cast<char*>(request.to_bytes), request.nbytes);
+      handler_->FinishCopyAck();
+    }
+  } catch (const std::exception& e) {
+    error = e.what();
+    // An error returned by the remote leaves the handler ready for the next response.
+    broken = !handler_->CanCleanShutdown();
+  }
+  lock->lock();
+  reading_ = false;
+  CompleteRequest(error);
+  if (broken) {
+    channel_error_ = error;
+    while (!pending_.empty()) CompleteRequest(error);
+  }
+  response_cv_.notify_all();
+}
+
+void RPCEndpoint::CompleteRequest(const std::string& error) {
+  const PendingRequest& request = pending_.front();
+  if (!error.empty()) {
+    if (!request.deferred) {
+      request_errors_[num_completed_] = error;
+    } else if (deferred_error_.empty()) {
+      deferred_error_ = error;
+    }
+  }
+  pending_request_bytes_ -= request.request_bytes;
+  pending_response_bytes_ -= request.response_bytes;
+  pending_.pop_front();
+  ++num_completed_;
+}
+
 void RPCEndpoint::Init() {
   // callback to flush the writer.
   auto flush_writer = [this]() {
@@ -658,27 +873,47 @@ void RPCEndpoint::Init() {
   };
 
   // Event handler
-  handler_ = std::make_shared<EventHandler>(&reader_, &writer_, name_, &remote_key_, flush_writer);
+  handler_ = std::make_shared<EventHandler>(
+      &reader_, &writer_, name_, &remote_key_, flush_writer,
+      [this](void* data, size_t size) { return channel_->Recv(data, size); },
+      [this](const void* data, size_t size) { return channel_->Send(data, size); });
+
+  if (!channel_->SupportsPipelining()) {
+    max_pending_ = 1;
+  } else if (const char* val = getenv("TVM_RPC_PIPELINE_DEPTH")) {
+    max_pending_ = static_cast<size_t>(std::max(atoi(val), 1));
+  } else {
+    max_pending_ = kRPCPipelineDepth;
+  }
+  max_pending_request_bytes_ = channel_->MaxPendingRequestBytes();
 
   // Quick function to for syscall remote.
   syscall_remote_ = PackedFunc([this](TVMArgs all_args, TVMRetValue* rv) {
-    std::lock_guard<std::mutex> lock(mutex_);
     RPCCode code = static_cast<RPCCode>(all_args[0].operator int());
     TVMArgs args(all_args.values + 1, all_args.type_codes + 1, all_args.num_args - 1);
 
     uint64_t packet_nbytes = sizeof(code) + handler_->PackedSeqGetNumBytes(
                                                 args.values, args.type_codes, args.num_args, true);
-
-    // All packet begins with packet nbytes
-    handler_->Write(packet_nbytes);
-    handler_->Write(code);
-    handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
-
-    code = HandleUntilReturnEvent(true, [rv](TVMArgs args) {
-      ICHECK_EQ(args.size(), 1);
-      *rv = args[0];
-    });
-    ICHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+    PendingRequest request;
+    request.request_bytes = packet_nbytes;
+    request.response_bytes = kRPCReturnPacketBytes;
+    auto fwrite = [&]() {
+      // All packet begins with packet nbytes
+      handler_->Write(packet_nbytes);
+      handler_->Write(code);
+      handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
+    };
+    // Frees return nothing, nobody needs to wait for them.
+    if (code == RPCCode::kFreeHandle || code == RPCCode::kDevFreeData) {
+      request.encode_return = [](TVMArgs) {};
+      SendDeferredRequest(request, fwrite);
+    } else {
+      request.encode_return = [rv](TVMArgs args) {
+        ICHECK_EQ(args.size(), 1);
+        *rv = args[0];
+      };
+      WaitRequest(SendRequest(request, fwrite));
+    }
   });
 }
 
@@ -703,6 +938,7 @@ std::shared_ptr<RPCEndpoint> RPCEndpoint::Create(std::unique_ptr<RPCChannel> cha
 RPCEndpoint::~RPCEndpoint() { this->Shutdown(); }
 
 void RPCEndpoint::Shutdown() {
+  std::lock_guard<std::mutex> send_lock(send_mutex_);
   if (channel_ != nullptr) {
     RPCCode code = RPCCode::kShutdown;
     uint64_t packet_nbytes = sizeof(code);
@@ -754,7 +990,6 @@ int RPCEndpoint::ServerAsyncIOEventHandler(const std::string& in_bytes, int even
 }
 
 void RPCEndpoint::InitRemoteSession(TVMArgs args) {
-  std::lock_guard<std::mutex> lock(mutex_);
   RPCCode code = RPCCode::kInitServer;
   std::string protocol_ver = kRPCProtocolVer;
   uint64_t length = protocol_ver.length();
@@ -763,23 +998,24 @@ void RPCEndpoint::InitRemoteSession(TVMArgs args) {
       sizeof(code) + sizeof(length) + length +
       handler_->PackedSeqGetNumBytes(args.values, args.type_codes, args.num_args, true);
 
-  // All packet begins with packet nbytes
-  handler_->Write(packet_nbytes);
-  handler_->Write(code);
-  handler_->Write(length);
-  handler_->WriteArray(protocol_ver.data(), length);
-  handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
-
-  code = HandleUntilReturnEvent(true, [](TVMArgs args) {});
-  ICHECK(code == RPCCode::kReturn) << "code=" << static_cast<int>(code);
+  PendingRequest request;
+  request.encode_return = [](TVMArgs args) {};
+  request.request_bytes = packet_nbytes;
+  request.response_bytes = kRPCReturnPacketBytes;
+  WaitRequest(SendRequest(request, [&]() {
+    // All packet begins with packet nbytes
+    handler_->Write(packet_nbytes);
+    handler_->Write(code);
+    handler_->Write(length);
+    handler_->WriteArray(protocol_ver.data(), length);
+    handler_->SendPackedSeq(args.values, args.type_codes, args.num_args, true);
+  }));
 }
 
 // Get remote function with name
 void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_values,
                            const int* arg_type_codes, int num_args,
                            RPCSession::FEncodeReturn encode_return) {
-  std::lock_guard<std::mutex> lock(mutex_);
-
   handler_->ValidateArguments(arg_values, arg_type_codes, num_args);
   RPCCode code = RPCCode::kCallFunc;
   uint64_t handle = reinterpret_cast<uint64_t>(h);
@@ -788,17 +1024,19 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_v
       sizeof(code) + sizeof(handle) +
       handler_->PackedSeqGetNumBytes(arg_values, arg_type_codes, num_args, true);
 
-  handler_->Write(packet_nbytes);
-  handler_->Write(code);
-  handler_->Write(handle);
-  handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
-
-  code = HandleUntilReturnEvent(true, encode_return);
-  ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
+  PendingRequest request;
+  request.encode_return = encode_return;
+  request.request_bytes = packet_nbytes;
+  request.response_bytes = kRPCReturnPacketBytes;
+  WaitRequest(SendRequest(request, [&]() {
+    handler_->Write(packet_nbytes);
+    handler_->Write(code);
+    handler_->Write(handle);
+    handler_->SendPackedSeq(arg_values, arg_type_codes, num_args, true);
+  }));
 }
 
 void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
   RPCCode code = RPCCode::kCopyToRemote;
 
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*to));
@@ -809,34 +1047,67 @@ void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes)
   uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(to, code, nbytes);
   uint64_t packet_nbytes = overhead + nbytes;
 
-  handler_->Write(packet_nbytes);
-  handler_->Write(code);
-  RPCReference::SendDLTensor(handler_, to);
-  handler_->Write(nbytes);
-  handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
+  // The data is sent to the channel before SendRequest returns.
+  PendingRequest request;
+  request.encode_return = [](TVMArgs) {};
+  request.request_bytes = packet_nbytes;
+  request.response_bytes = kRPCReturnPacketBytes;
+  SendDeferredRequest(request, [&]() {
+    handler_->Write(packet_nbytes);
+    handler_->Write(code);
+    RPCReference::SendDLTensor(handler_, to);
+    handler_->Write(nbytes);
+    if (nbytes >= kRPCDirectTransferBytes) {
+      FlushWriter();
+      handler_->SendDirect(reinterpret_cast<char*>(from_bytes), nbytes);
+    } else {
+      handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
+    }
+  });
 }
 
-void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
+void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes,
+                                 uint64_t block_size) {
   RPCCode code = RPCCode::kCopyFromRemote;
-
+  ICHECK_GT(block_size, 0U);
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*from));
-  ICHECK_LE(from->byte_offset + nbytes, tensor_total_size_bytes)
-      << "CopyFromRemote: overflow in tensor size: (byte_offset=" << from->byte_offset
-      << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
-
-  uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(from, code, nbytes);
-  uint64_t packet_nbytes = overhead;
-
-  handler_->Write(packet_nbytes);
-  handler_->Write(code);
-  RPCReference::SendDLTensor(handler_, from);
-  handler_->Write(nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
-
-  handler_->ReadArray(reinterpret_cast<char*>(to_bytes), nbytes);
-  handler_->FinishCopyAck();
+  std::vector<uint64_t> ids;
+
+  // The blocks are requested back to back and their data is read in order.
+  for (uint64_t offset = 0; offset < nbytes; offset += block_size) {
+    uint64_t block_nbytes = std::min(block_size, nbytes - offset);
+    from->byte_offset = offset;
+    ICHECK_LE(from->byte_offset + block_nbytes, tensor_total_size_bytes)
+        << "CopyFromRemote: overflow in tensor size: (byte_offset=" << from->byte_offset
+        << ", nbytes=" << block_nbytes << ", tensor_total_size=" << tensor_total_size_bytes
+        << ")";
+
+    uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(from, code, block_nbytes);
+    uint64_t packet_nbytes = overhead;
+
+    PendingRequest request;
+    request.encode_return = [](TVMArgs) {};
+    request.to_bytes = static_cast<char*>(to_bytes) + offset;
+    request.nbytes = block_nbytes;
+    request.request_bytes = packet_nbytes;
+    request.response_bytes = sizeof(uint64_t) + sizeof(code) + block_nbytes;
+    ids.push_back(SendRequest(request, [&]() {
+      handler_->Write(packet_nbytes);
+      handler_->Write(code);
+      RPCReference::SendDLTensor(handler_, from);
+      handler_->Write(block_nbytes);
+    }));
+  }
+  // Wait for all the blocks before raising an error, their data is written to to_bytes.
+  std::string error;
+  for (uint64_t id : ids) {
+    try {
+      WaitRequest(id);
+    } catch (const std::exception& e) {
+      if (error.empty()) error = e.what();
+    }
+  }
+  if (!error.empty()) throw Error(error);
 }
 
 // SysCallEventHandler functions
@@ -1008,9 +1279,7 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   void CopyToRemote(void* local_from_bytes, DLTensor* remote_to, uint64_t nbytes) final {
     RPCCode code = RPCCode::kCopyToRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_to, code, nbytes);
-    uint64_t rpc_max_size = GetRPCMaxTransferSize();
-    ICHECK_GT(rpc_max_size, overhead) << "CopyToRemote: Invalid block size!";
-    const uint64_t block_size = rpc_max_size - overhead;
+    uint64_t block_size = GetBlockSize(remote_to->device, overhead);
     uint64_t block_count = 0;
     const uint64_t num_blocks = nbytes / block_size;
     void* from_bytes;
@@ -1034,27 +1303,8 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   void CopyFromRemote(DLTensor* remote_from, void* local_to_bytes, uint64_t nbytes) final {
     RPCCode code = RPCCode::kCopyFromRemote;
     uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_from, code, nbytes);
-    uint64_t rpc_max_size = GetRPCMaxTransferSize();
-    ICHECK_GT(rpc_max_size, overhead) << "CopyFromRemote: Invalid block size!";
-    const uint64_t block_size = rpc_max_size - overhead;
-    uint64_t block_count = 0;
-    const uint64_t num_blocks = nbytes / block_size;
-    void* to_bytes;
-
-    for (block_count = 0; block_count < num_blocks; block_count++) {
-      remote_from->byte_offset = block_count * block_size;
-      to_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_to_bytes) + block_count * block_size));
-      endpoint_->CopyFromRemote(remote_from, to_bytes, block_size);
-    }
-
-    const uint64_t remainder_bytes = nbytes % block_size;
-    if (remainder_bytes != 0) {
-      remote_from->byte_offset = block_count * block_size;
-      to_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_to_bytes) + block_count * block_size));
-      endpoint_->CopyFromRemote(remote_from, to_bytes, remainder_bytes);
-    }
+    uint64_t block_size = GetBlockSize(remote_from->device, overhead);
+    endpoint_->CopyFromRemote(remote_from, local_to_bytes, nbytes, block_size);
   }
 
   void FreeHandle(void* handle, int type_code) final {
@@ -1123,6 +1373,17 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   bool IsLocalSession() const final { return false; }
 
  private:
+  // The size of the blocks a copy is split into.
+  uint64_t GetBlockSize(Device remote_dev, uint64_t overhead) {
+    uint64_t rpc_max_size = GetRPCMaxTransferSize();
+    ICHECK_GT(rpc_max_size, overhead) << "RPC copy: Invalid block size!";
+    uint64_t block_size = rpc_max_size - overhead;
+    if (remote_dev.device_type != kDLCPU) {
+      block_size = std::min(block_size, kRPCDeviceCopyBlockBytes);
+    }
+    return block_size;
+  }
+
   uint64_t GetRPCMaxTransferSize() {
     if (rpc_chunk_max_size_bytes_ > 0) {
       return (uint64_t)rpc_chunk_max_size_bytes_;
@@ -26,9 +26,13 @@
 
 #include <tvm/runtime/packed_func.h>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "../../support/ring_buffer.h"
@@ -64,6 +68,16 @@ enum class TrackerCode : int {
 /*!
  * \brief Communication endpoints to connect local and remote RPC sessions.
  *        An endpoint can either be a client or a server.
+ *
+ *  The client pipelines its requests: the remote handles them in the order they are sent,
+ *  so a request does not wait for the response of the previous one. Each request gets an
+ *  id on sending, and responses complete the requests in flight in order. Requests whose
+ *  result nobody waits for (copies to the remote and frees) return once sent and report
+ *  their errors through the next call that waits. Several threads can share one endpoint
+ *  and keep requests in flight at the same time.
+ *
+ *  TVM_RPC_PIPELINE_DEPTH bounds the number of requests in flight, 1 makes every request
+ *  wait for its response.
  */
 class RPCEndpoint {
  public:
@@ -127,6 +141,8 @@ class RPCEndpoint {
                 const int* arg_type_codes, int num_args, RPCSession::FEncodeReturn encode_return);
   /*!
    * \brief Copy bytes into remote array content.
+   *  Returns once the data is sent, an error of the copy is raised by the next call that
+   *  waits for the remote.
    * \param from The source host data.
    * \param from_offset The byte offeset in the from.
    * \param to The target array.
@@ -138,15 +154,13 @@ class RPCEndpoint {
   void CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes);
   /*!
    * \brief Copy bytes from remote array content.
-   * \param from The source host data.
-   * \param from_offset The byte offeset in the from.
-   * \param to The target array.
-   * \param to_offset The byte offset in the to.
+   *  The blocks are requested without waiting for each other.
+   * \param from The source array, its byte_offset is set to the offset of each block.
+   * \param to_bytes The target host data.
    * \param nbytes The size of the memory in bytes.
-   * \param dev_from The source device.
-   * \param type_hint Hint of content data type.
+   * \param block_size The maximum number of bytes copied by one request.
    */
-  void CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes);
+  void CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes, uint64_t block_size);
 
   /*!
    * \brief Call a remote defined system function with arguments.
@@ -169,17 +183,73 @@ class RPCEndpoint {
 
  private:
   class EventHandler;
+  /*! \brief A request sent to the remote whose response has not been handled yet. */
+  struct PendingRequest {
+    /*! \brief Receives the values returned by the remote. */
+    RPCSession::FEncodeReturn encode_return;
+    /*! \brief Destination of the data of a copy from the remote. */
+    void* to_bytes{nullptr};
+    /*! \brief Number of bytes copied to to_bytes. */
+    uint64_t nbytes{0};
+    /*! \brief Size of the request packet. */
+    uint64_t request_bytes{0};
+    /*! \brief Expected size of the response packet. */
+    uint64_t response_bytes{0};
+    /*! \brief Whether nobody waits for the request, its error goes to the next wait. */
+    bool deferred{false};
+  };
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
+  // Send a request after the ones in flight, fwrite writes its packet. Returns its id.
+  uint64_t SendRequest(PendingRequest request, const std::function<void()>& fwrite);
+  // Send a request nobody waits for.
+  void SendDeferredRequest(PendingRequest request, const std::function<void()>& fwrite);
+  // Wait for the response of a request, raising its error or the one of an earlier
+  // deferred request.
+  void WaitRequest(uint64_t id);
+  // Handle the responses until the request completes, lock holds mutex_.
+  void HandleResponsesUntil(std::unique_lock<std::mutex>* lock, uint64_t id);
+  // Handle the response of the oldest request in flight, lock holds mutex_.
+  void HandleNextResponse(std::unique_lock<std::mutex>* lock);
+  // Pop the oldest request in flight, recording its error.
+  void CompleteRequest(const std::string& error);
+  // Whether a request can be sent without waiting for the ones in flight.
+  bool CanPipeline(const PendingRequest& request) const;
+  // Send all the buffered data to the channel.
+  void FlushWriter();
   // Initalization
   void Init();
   // Shutdown
   void Shutdown();
   // Internal channel.
   std::unique_ptr<RPCChannel> channel_;
-  // Internal mutex
+  // Serializes the requests written to the channel
+  std::mutex send_mutex_;
+  // Protects the requests in flight
   std::mutex mutex_;
+  // Signaled when a response is handled
+  std::condition_variable response_cv_;
+  // Requests in flight, oldest first
+  std::deque<PendingRequest> pending_;
+  // Id of the next request, ids of completed requests are below num_completed_
+  uint64_t next_request_id_{0};
+  uint64_t num_completed_{0};
+  // Total request and expected response bytes of the requests in flight
+  uint64_t pending_request_bytes_{0};
+  uint64_t pending_response_bytes_{0};
+  // Whether a thread is reading a response from the channel
+  bool reading_{false};
+  // Errors of the completed requests a caller waits for
+  std::unordered_map<uint64_t, std::string> request_errors_;
+  // The first error of a deferred request not reported yet
+  std::string deferred_error_;
+  // Set when the channel can no longer be used
+  std::string channel_error_;
+  // Maximum number of requests in flight
+  size_t max_pending_{1};
+  // Maximum bytes of the requests in flight the remote buffers, 0 when unlimited
+  uint64_t max_pending_request_bytes_{0};
   // Internal ring buffer.
   support::RingBuffer reader_, writer_;
   // Event handler.
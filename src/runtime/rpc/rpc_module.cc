@@ -26,8 +26,13 @@
 #include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
 #include <memory>
+#include <numeric>
+#include <vector>
 #if defined(_M_X64) || defined(__x86_64__)
 #include <immintrin.h>
 #endif
@@ -189,22 +194,30 @@ class RPCModuleNode final : public ModuleNode {
   }
 
   PackedFunc GetTimeEvaluator(const std::string& name, Device dev, int number, int repeat,
-                              int min_repeat_ms, const std::string& f_preproc_name) {
+                              int min_repeat_ms, const std::string& f_preproc_name,
+                              const TimeEvaluatorOptions& options) {
     InitRemoteFunc(&remote_get_time_evaluator_, "runtime.RPCTimeEvaluator");
     // Remove session mask because we pass dev by parts.
     ICHECK_EQ(GetRPCSessionIndex(dev), sess_->table_index())
         << "ValueError: Need to pass the matched remote device to RPCModule.GetTimeEvaluator";
     dev = RemoveRPCSessionMask(dev);
 
-    if (module_handle_ != nullptr) {
-      return remote_get_time_evaluator_(GetRef<Module>(this), name,
-                                        static_cast<int>(dev.device_type), dev.device_id, number,
-                                        repeat, min_repeat_ms, f_preproc_name);
-    } else {
-      return remote_get_time_evaluator_(Optional<Module>(nullptr), name,
-                                        static_cast<int>(dev.device_type), dev.device_id, number,
-                                        repeat, min_repeat_ms, f_preproc_name);
+    Optional<Module> mod =
+        module_handle_ != nullptr ? GetRef<Module>(this) : Optional<Module>(nullptr);
+    // The servers of the previous versions take no options, only pass them when they are set.
+    TimeEvaluatorOptions defaults;
+    if (options.max_repeat == defaults.max_repeat &&
+        options.cache_flush_bytes == defaults.cache_flush_bytes &&
+        options.check_cpu_frequency == defaults.check_cpu_frequency) {
+      return remote_get_time_evaluator_(mod, name, static_cast<int>(dev.device_type),
+                                        dev.device_id, number, repeat, min_repeat_ms,
+                                        f_preproc_name);
     }
+    return remote_get_time_evaluator_(mod, name, static_cast<int>(dev.device_type), dev.device_id,
+                                      number, repeat, min_repeat_ms, f_preproc_name,
+                                      options.max_repeat, options.cv_threshold,
+                                      options.cache_flush_bytes,
+                                      static_cast<int>(options.check_cpu_frequency));
   }
 
   Module LoadModule(std::string name) {
@@ -240,9 +253,8 @@ class RPCModuleNode final : public ModuleNode {
   void* module_handle_{nullptr};
   // The local channel
   std::shared_ptr<RPCSession> sess_;
-  // remote function to get time evaluator
-  TypedPackedFunc<PackedFunc(Optional<Module>, std::string, int, int, int, int, int, std::string)>
-      remote_get_time_evaluator_;
+  // remote function to get time evaluator, taking the options after the f_preproc name
+  PackedFunc remote_get_time_evaluator_;
   // remote function getter for modules.
   TypedPackedFunc<PackedFunc(Module, std::string, bool)> remote_mod_get_function_;
   // remote function getter for load module
@@ -342,8 +354,54 @@ inline void CPUCacheFlush(int begin_index, const TVMArgs& args) {
   }
 }
 
+/*!
+ * \brief Sweep a buffer larger than the caches before a repeat, evicting the data of the previous
+ *  runs from all the cache levels, on the CPUs without a flush instruction too.
+ */
+static void SweepCacheFlushBuffer(std::vector<char>* buffer) {
+  constexpr size_t kCacheLine = 64;
+  volatile char* data = buffer->data();
+  for (size_t i = 0; i < buffer->size(); i += kCacheLine) {
+    data[i] = data[i] + 1;
+  }
+}
+
+/*!
+ * \brief The time of a fixed chain of dependent integer multiplies, the best of a few runs. It
+ *  scales with the clock of the core, frequency scaling and thermal throttling included.
+ */
+static double CPUSpeedProbeSeconds() {
+  double best = 0;
+  for (int run = 0; run < 3; ++run) {
+    auto begin = std::chrono::steady_clock::now();
+    volatile uint64_t seed = 1;
+    uint64_t x = seed;
+    for (int i = 0; i < (1 << 22); ++i) {
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    seed = x;
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    best = run == 0 ? elapsed : std::min(best, elapsed);
+  }
+  return best;
+}
+
+/*! \brief The coefficient of variation of costs, the standard deviation relative to the mean. */
+static double CoefficientOfVariation(std::vector<double>::const_iterator begin,
+                                     std::vector<double>::const_iterator end) {
+  double n = end - begin;
+  double mean = std::accumulate(begin, end, 0.0) / n;
+  if (n < 2 || mean <= 0) return 0;
+  double sq_sum = 0;
+  for (auto it = begin; it != end; ++it) {
+    sq_sum += (*it - mean) * (*it - mean);
+  }
+  return std::sqrt(sq_sum / (n - 1)) / mean;
+}
+
 PackedFunc WrapTimeEvaluator(PackedFunc pf, Device dev, int number, int repeat, int min_repeat_ms,
-                             PackedFunc f_preproc) {
+                             PackedFunc f_preproc, TimeEvaluatorOptions options) {
   ICHECK(pf != nullptr);
 
   if (static_cast<int>(dev.device_type) == static_cast<int>(kDLMicroDev)) {
@@ -352,8 +410,8 @@ PackedFunc WrapTimeEvaluator(PackedFunc pf, Device dev, int number, int repeat,
     return (*get_micro_time_evaluator)(pf, dev, number, repeat);
   }
 
-  auto ftimer = [pf, dev, number, repeat, min_repeat_ms, f_preproc](TVMArgs args,
-                                                                    TVMRetValue* rv) mutable {
+  auto ftimer = [pf, dev, number, repeat, min_repeat_ms, f_preproc, options](
+                    TVMArgs args, TVMRetValue* rv) mutable {
     TVMRetValue temp;
     std::ostringstream os;
     // skip first time call, to activate lazy compilation components.
@@ -361,10 +419,18 @@ PackedFunc WrapTimeEvaluator(PackedFunc pf, Device dev, int number, int repeat,
 
     DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
 
-    for (int i = 0; i < repeat; ++i) {
+    std::vector<char> flush_buffer(std::max<int64_t>(options.cache_flush_bytes, 0));
+    bool check_cpu = options.check_cpu_frequency && dev.device_type == kDLCPU;
+    double probe_begin = check_cpu ? CPUSpeedProbeSeconds() : 0;
+    int max_repeat = std::max(repeat, options.max_repeat);
+    std::vector<double> costs;
+    for (int i = 0; i < max_repeat; ++i) {
       if (f_preproc != nullptr) {
         f_preproc.CallPacked(args, &temp);
       }
+      if (!flush_buffer.empty()) {
+        SweepCacheFlushBuffer(&flush_buffer);
+      }
       double duration_ms = 0.0;
 
       do {
@@ -383,7 +449,30 @@ PackedFunc WrapTimeEvaluator(PackedFunc pf, Device dev, int number, int repeat,
         duration_ms = t_nanos / 1e6;
       } while (duration_ms < min_repeat_ms);
 
-      double speed = duration_ms / 1e3 / number;
+      costs.push_back(duration_ms / 1e3 / number);
+      // Stop at the steady state, when the last `repeat` costs stopped drifting.
+      if (max_repeat > repeat && static_cast<int>(costs.size()) >= repeat &&
+          CoefficientOfVariation(costs.end() - repeat, costs.end()) <= options.cv_threshold) {
+        break;
+      }
+    }
+    if (max_repeat > repeat && static_cast<int>(costs.size()) == max_repeat) {
+      LOG(WARNING) << "The costs did not reach a steady state in " << max_repeat
+                   << " repeats, the coefficient of variation of the last " << repeat
+                   << " ones is " << CoefficientOfVariation(costs.end() - repeat, costs.end());
+    }
+    if (check_cpu) {
+      double change = CPUSpeedProbeSeconds() / probe_begin - 1;
+      if (std::abs(change) > 0.1) {
+        LOG(WARNING) << "The CPU got " << std::abs(change) * 100 << "% "
+                     << (change > 0 ? "slower" : "faster")
+                     << " during the measurement, e.g. from frequency scaling or thermal "
+                     << "throttling, the costs may not be comparable";
+      }
+    }
+
+    for (auto it = costs.end() - repeat; it != costs.end(); ++it) {
+      double speed = *it;
       os.write(reinterpret_cast<char*>(&speed), sizeof(speed));
     }
 
@@ -397,42 +486,60 @@ PackedFunc WrapTimeEvaluator(PackedFunc pf, Device dev, int number, int repeat,
   return PackedFunc(ftimer);
 }
 
-TVM_REGISTER_GLOBAL("runtime.RPCTimeEvaluator")
-    .set_body_typed([](Optional<Module> opt_mod, std::string name, int device_type, int device_id,
-                       int number, int repeat, int min_repeat_ms, std::string f_preproc_name) {
-      Device dev;
-      dev.device_type = static_cast<DLDeviceType>(device_type);
-      dev.device_id = device_id;
-      if (opt_mod.defined()) {
-        Module m = opt_mod.value();
-        std::string tkey = m->type_key();
-        if (tkey == "rpc") {
-          return static_cast<RPCModuleNode*>(m.operator->())
-              ->GetTimeEvaluator(name, dev, number, repeat, min_repeat_ms, f_preproc_name);
-        } else {
-          PackedFunc f_preproc;
-          if (!f_preproc_name.empty()) {
-            auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
-            ICHECK(pf_preproc != nullptr)
-                << "Cannot find " << f_preproc_name << " in the global function";
-            f_preproc = *pf_preproc;
-          }
-          return WrapTimeEvaluator(m.GetFunction(name, false), dev, number, repeat, min_repeat_ms,
-                                   f_preproc);
-        }
-      } else {
-        auto* pf = runtime::Registry::Get(name);
-        ICHECK(pf != nullptr) << "Cannot find " << name << " in the global function";
-        PackedFunc f_preproc;
-        if (!f_preproc_name.empty()) {
-          auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
-          ICHECK(pf_preproc != nullptr)
-              << "Cannot find " << f_preproc_name << " in the global function";
-          f_preproc = *pf_preproc;
-        }
-        return WrapTimeEvaluator(*pf, dev, number, repeat, min_repeat_ms, f_preproc);
-      }
-    });
+// The optional options of the time evaluator after its f_preproc name: max_repeat,
+// cv_threshold, cache_flush_bytes and check_cpu_frequency.
+static TimeEvaluatorOptions GetTimeEvaluatorOptions(const TVMArgs& args, int begin) {
+  TimeEvaluatorOptions options;
+  if (args.size() > begin) options.max_repeat = args[begin];
+  if (args.size() > begin + 1) options.cv_threshold = args[begin + 1];
+  if (args.size() > begin + 2) options.cache_flush_bytes = args[begin + 2];
+  if (args.size() > begin + 3) options.check_cpu_frequency = static_cast<int>(args[begin + 3]);
+  return options;
+}
+
+TVM_REGISTER_GLOBAL("runtime.RPCTimeEvaluator").set_body([](TVMArgs args, TVMRetValue* rv) {
+  ICHECK_GE(args.size(), 8) << "RPCTimeEvaluator takes at least 8 arguments";
+  Optional<Module> opt_mod = args[0];
+  std::string name = args[1];
+  Device dev;
+  dev.device_type = static_cast<DLDeviceType>(static_cast<int>(args[2]));
+  dev.device_id = args[3];
+  int number = args[4];
+  int repeat = args[5];
+  int min_repeat_ms = args[6];
+  std::string f_preproc_name = args[7];
+  TimeEvaluatorOptions options = GetTimeEvaluatorOptions(args, 8);
+  if (opt_mod.defined()) {
+    Module m = opt_mod.value();
+    std::string tkey = m->type_key();
+    if (tkey == "rpc") {
+      *rv = static_cast<RPCModuleNode*>(m.operator->())
+                ->GetTimeEvaluator(name, dev, number, repeat, min_repeat_ms, f_preproc_name,
+                                   options);
+      return;
+    }
+    PackedFunc f_preproc;
+    if (!f_preproc_name.empty()) {
+      auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
+      ICHECK(pf_preproc != nullptr)
+          << "Cannot find " << f_preproc_name << " in the global function";
+      f_preproc = *pf_preproc;
+    }
+    *rv = WrapTimeEvaluator(m.GetFunction(name, false), dev, number, repeat, min_repeat_ms,
+                            f_preproc, options);
+  } else {
+    auto* pf = runtime::Registry::Get(name);
+    ICHECK(pf != nullptr) << "Cannot find " << name << " in the global function";
+    PackedFunc f_preproc;
+    if (!f_preproc_name.empty()) {
+      auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
+      ICHECK(pf_preproc != nullptr)
+          << "Cannot find " << f_preproc_name << " in the global function";
+      f_preproc = *pf_preproc;
+    }
+    *rv = WrapTimeEvaluator(*pf, dev, number, repeat, min_repeat_ms, f_preproc, options);
+  }
+});
 
 TVM_REGISTER_GLOBAL("cache_flush_cpu_non_first_arg").set_body([](TVMArgs args, TVMRetValue* rv) {
   CPUCacheFlush(1, args);
@@ -19,21 +19,27 @@
 
 /*!
  * \file rpc_pipe_impl.cc
- * \brief Pipe-based RPC channel.
+ * \brief Pipe-based and shared memory based RPC channels to a child process.
  */
 // Linux only for now, as linux is the most common usecase.
 #if defined(__linux__) || defined(__ANDROID__)
 
 #include <errno.h>
 #include <signal.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <tvm/runtime/registry.h>
 #include <unistd.h>
 
 #include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "../../support/pipe.h"
+#include "../minrpc/minrpc_shm_ring.h"
 #include "rpc_endpoint.h"
 #include "rpc_local_session.h"
 
@@ -75,33 +81,121 @@ class PipeChannel final : public RPCChannel {
   pid_t child_pid_;
 };
 
-Module CreatePipeClient(std::vector<std::string> cmd) {
-  int parent2child[2];
-  int child2parent[2];
-  ICHECK_EQ(pipe(parent2child), 0);
-  ICHECK_EQ(pipe(child2parent), 0);
+/*! \brief Default size of each shared memory ring, TVM_RPC_SHM_RING_BYTES overrides it. */
+constexpr uint64_t kRPCShmRingBytes = 4 << 20;
 
-  int parent_read = child2parent[0];
-  int parent_write = parent2child[1];
-  int child_read = parent2child[0];
-  int child_write = child2parent[1];
+/*!
+ * \brief Channel over the shared memory rings of minrpc_shm_ring.h.
+ *  Ring 0 carries the requests to the child and ring 1 its replies.
+ */
+class ShmChannel final : public RPCChannel {
+ public:
+  explicit ShmChannel(MinRPCShmHeader* header, pid_t child_pid)
+      : header_(header), child_pid_(child_pid) {}
+
+  ~ShmChannel() { Close(); }
+
+  size_t Send(const void* data, size_t size) final {
+    ssize_t n = MinRPCShmWrite(header_, 0, data, size, [this]() { return ChildAlive(); });
+    if (n == -1) {
+      LOG(FATAL) << "Shared memory write error, the server exited";
+    }
+    return static_cast<size_t>(n);
+  }
+
+  size_t Recv(void* data, size_t size) final {
+    return static_cast<size_t>(
+        MinRPCShmRead(header_, 1, data, size, [this]() { return ChildAlive(); }));
+  }
+
+  void Close() {
+    if (header_ == nullptr) return;
+    MinRPCShmClose(header_, 0);
+    kill(child_pid_, SIGKILL);
+    if (!exited_) waitpid(child_pid_, nullptr, 0);
+    MinRPCShmUnmap(header_);
+    header_ = nullptr;
+  }
+
+ private:
+  bool ChildAlive() {
+    if (!exited_ && waitpid(child_pid_, nullptr, WNOHANG) == child_pid_) exited_ = true;
+    return !exited_;
+  }
+
+  MinRPCShmHeader* header_;
+  pid_t child_pid_;
+  bool exited_{false};
+};
 
+/*!
+ * \brief Start the server command in a child process.
+ * \param cmd The command.
+ * \param args The arguments appended to the command.
+ * \param close_fds The descriptors the child closes before it starts.
+ * \return The pid of the child.
+ */
+static pid_t StartServer(std::vector<std::string> cmd, std::vector<std::string> args,
+                         const std::vector<int>& close_fds) {
   pid_t pid = fork();
+  ICHECK_NE(pid, -1) << "fork failed: " << strerror(errno);
   if (pid == 0) {
     // child process
-    close(parent_read);
-    close(parent_write);
-    std::string sread_pipe = std::to_string(child_read);
-    std::string swrite_pipe = std::to_string(child_write);
+    for (int fd : close_fds) {
+      close(fd);
+    }
     std::vector<char*> argv;
     for (auto& str : cmd) {
       argv.push_back(dmlc::BeginPtr(str));
     }
-    argv.push_back(dmlc::BeginPtr(sread_pipe));
-    argv.push_back(dmlc::BeginPtr(swrite_pipe));
+    for (auto& str : args) {
+      argv.push_back(dmlc::BeginPtr(str));
+    }
     argv.push_back(nullptr);
     execvp(argv[0], &argv[0]);
+    _exit(127);
+  }
+  return pid;
+}
+
+Module CreateShmClient(std::vector<std::string> cmd) {
+  uint64_t capacity = kRPCShmRingBytes;
+  if (const char* env = std::getenv("TVM_RPC_SHM_RING_BYTES")) {
+    capacity = std::strtoull(env, nullptr, 10);
+    ICHECK_GT(capacity, 0) << "Invalid TVM_RPC_SHM_RING_BYTES=" << env;
   }
+  // The anonymous file is inherited by the child, which maps it again after exec.
+  int fd = static_cast<int>(syscall(SYS_memfd_create, "tvm_rpc_shm", 0));
+  ICHECK_NE(fd, -1) << "memfd_create failed: " << strerror(errno);
+  size_t region_bytes = MinRPCShmRegionBytes(capacity);
+  ICHECK_EQ(ftruncate(fd, region_bytes), 0) << "ftruncate failed: " << strerror(errno);
+  void* base = mmap(nullptr, region_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ICHECK(base != MAP_FAILED) << "mmap failed: " << strerror(errno);
+  ICHECK(MinRPCShmInit(base, capacity)) << "Cannot create process shared locks";
+
+  pid_t pid = StartServer(cmd, {"shm", std::to_string(fd)}, {});
+  close(fd);
+
+  auto endpt = RPCEndpoint::Create(
+      std::unique_ptr<ShmChannel>(new ShmChannel(static_cast<MinRPCShmHeader*>(base), pid)),
+      "shm", "shm");
+  endpt->InitRemoteSession(TVMArgs(nullptr, nullptr, 0));
+  return CreateRPCSessionModule(CreateClientSession(endpt));
+}
+
+Module CreatePipeClient(std::vector<std::string> cmd) {
+  int parent2child[2];
+  int child2parent[2];
+  ICHECK_EQ(pipe(parent2child), 0);
+  ICHECK_EQ(pipe(child2parent), 0);
+
+  int parent_read = child2parent[0];
+  int parent_write = parent2child[1];
+  int child_read = parent2child[0];
+  int child_write = child2parent[1];
+
+  pid_t pid = StartServer(cmd, {std::to_string(child_read), std::to_string(child_write)},
+                          {parent_read, parent_write});
   // parent process
   close(child_read);
   close(child_write);
@@ -121,6 +215,14 @@ TVM_REGISTER_GLOBAL("rpc.CreatePipeClient").set_body([](TVMArgs args, TVMRetValu
   *rv = CreatePipeClient(cmd);
 });
 
+TVM_REGISTER_GLOBAL("rpc.CreateShmClient").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::vector<std::string> cmd;
+  for (int i = 0; i < args.size(); ++i) {
+    cmd.push_back(args[i].operator std::string());
+  }
+  *rv = CreateShmClient(cmd);
+});
+
 }  // namespace runtime
 }  // namespace tvm
 #endif
@@ -282,6 +282,22 @@ struct RemoteSpace {
   std::shared_ptr<RPCSession> sess;
 };
 
+/*! \brief The statistical options of the time evaluator, off by default. */
+struct TimeEvaluatorOptions {
+  /*!
+   * \brief The most repeats, to wait for the steady state. When it is larger than `repeat`, the
+   *  repeats go on until the coefficient of variation of the last `repeat` ones is at most
+   *  cv_threshold, and only those are returned.
+   */
+  int max_repeat{0};
+  /*! \brief The coefficient of variation of the steady state. */
+  double cv_threshold{0.05};
+  /*! \brief The bytes of a buffer swept before each repeat to flush the caches, 0 for none. */
+  int64_t cache_flush_bytes{0};
+  /*! \brief Whether to warn when the speed of the CPU changed during the measurement. */
+  bool check_cpu_frequency{false};
+};
+
 /*!
  * \brief Wrap a timer function to measure the time cost of a given packed function.
  * \param f The function argument.
@@ -300,10 +316,12 @@ struct RemoteSpace {
  *        i.e., When the run time of one `repeat` falls below this time,
  *        the `number` parameter will be automatically increased.
  * \param f_preproc The function to be executed before we excetute time evaluator.
+ * \param options The steady state detection, cache flush and CPU frequency check.
  * \return f_timer A timer function.
  */
 PackedFunc WrapTimeEvaluator(PackedFunc f, Device dev, int number, int repeat, int min_repeat_ms,
-                             PackedFunc f_preproc = nullptr);
+                             PackedFunc f_preproc = nullptr,
+                             TimeEvaluatorOptions options = TimeEvaluatorOptions());
 
 /*!
  * \brief Create a Global RPC module that refers to the session.
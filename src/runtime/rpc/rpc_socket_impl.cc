@@ -24,9 +24,12 @@
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstdlib>
 #include <memory>
+#include <string>
 
 #include "../../support/socket.h"
+#include "rpc_compression.h"
 #include "rpc_endpoint.h"
 #include "rpc_local_session.h"
 #include "rpc_session.h"
@@ -97,24 +100,48 @@ std::shared_ptr<RPCEndpoint> RPCConnect(std::string url, int port, std::string k
     remote_key.resize(keylen);
     ICHECK_EQ(sock.RecvAll(&remote_key[0], keylen), keylen);
   }
-  auto endpt =
-      RPCEndpoint::Create(std::unique_ptr<SockChannel>(new SockChannel(sock)), key, remote_key);
+  std::unique_ptr<RPCChannel> channel(new SockChannel(sock));
+  // The server agrees to compress by echoing the option in its key.
+  std::string codec = GetRPCKeyCompression(key);
+  if (!codec.empty() && GetRPCKeyCompression(remote_key) == codec) {
+    channel = CreateCompressedChannel(std::move(channel), codec);
+  }
+  auto endpt = RPCEndpoint::Create(std::move(channel), key, remote_key);
   endpt->InitRemoteSession(init_seq);
   return endpt;
 }
 
 Module RPCClientConnect(std::string url, int port, std::string key, TVMArgs init_seq) {
+  std::string codec = GetRPCKeyCompression(key);
+  std::string codecs = "," + RPCCompressionCodecs() + ",";
+  if (!codec.empty()) {
+    ICHECK(codecs.find("," + codec + ",") != std::string::npos)
+        << "RPC compression codec " << codec << " is not enabled, supported: "
+        << RPCCompressionCodecs();
+  } else if (const char* env = getenv("TVM_RPC_COMPRESSION")) {
+    if (codecs.find("," + std::string(env) + ",") != std::string::npos) {
+      key += " -compress=" + std::string(env);
+    } else if (env[0] != '\0') {
+      LOG(WARNING) << "Ignore TVM_RPC_COMPRESSION=" << env << ", supported codecs: "
+                   << RPCCompressionCodecs();
+    }
+  }
   auto endpt = RPCConnect(url, port, "client:" + key, init_seq);
   return CreateRPCSessionModule(CreateClientSession(endpt));
 }
 
-// TVM_DLL needed for MSVC
-TVM_DLL void RPCServerLoop(int sockfd) {
+void RPCServerLoop(int sockfd, const std::string& codec) {
   support::TCPSocket sock(static_cast<support::TCPSocket::SockType>(sockfd));
-  RPCEndpoint::Create(std::unique_ptr<SockChannel>(new SockChannel(sock)), "SockServerLoop", "")
-      ->ServerLoop();
+  std::unique_ptr<RPCChannel> channel(new SockChannel(sock));
+  if (!codec.empty()) {
+    channel = CreateCompressedChannel(std::move(channel), codec);
+  }
+  RPCEndpoint::Create(std::move(channel), "SockServerLoop", "")->ServerLoop();
 }
 
+// TVM_DLL needed for MSVC
+TVM_DLL void RPCServerLoop(int sockfd) { RPCServerLoop(sockfd, ""); }
+
 void RPCServerLoop(PackedFunc fsend, PackedFunc frecv) {
   RPCEndpoint::Create(std::unique_ptr<CallbackChannel>(new CallbackChannel(fsend, frecv)),
                       "SockServerLoop", "")
@@ -131,7 +158,8 @@ TVM_REGISTER_GLOBAL("rpc.Connect").set_body([](TVMArgs args, TVMRetValue* rv) {
 
 TVM_REGISTER_GLOBAL("rpc.ServerLoop").set_body([](TVMArgs args, TVMRetValue* rv) {
   if (args[0].type_code() == kDLInt) {
-    RPCServerLoop(args[0]);
+    // The optional second argument is the compression codec agreed in the handshake.
+    RPCServerLoop(args[0], args.size() > 1 ? args[1].operator std::string() : "");
   } else {
     RPCServerLoop(args[0].operator tvm::runtime::PackedFunc(),
                   args[1].operator tvm::runtime::PackedFunc());
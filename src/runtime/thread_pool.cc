@@ -31,15 +31,23 @@
 #if TVM_THREADPOOL_USE_OPENMP
 #include <omp.h>
 #endif
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 const constexpr int kL1CacheBytes = 64;
@@ -58,11 +66,157 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+constexpr int kDefaultStealChunks = 4;
+// number of tasks per worker of the weighted schedule without work stealing
+constexpr int kWeightedChunks = 8;
+// the share of the last launch in the weight of a worker
+constexpr double kWeightSmoothing = 0.25;
+// a worker keeps about a task, so that its throughput is still measured
+constexpr double kMinWeight = 1.0 / kWeightedChunks;
+
+/*!
+ * \brief Get the number of tasks per worker of the work-stealing schedule, 0 for the static
+ *  schedule. TVM_THREAD_POOL_SCHEDULE=steal splits the parallel loops into
+ *  TVM_THREAD_POOL_STEAL_CHUNKS tasks per worker that idle workers steal.
+ */
+int GetStealChunks() {
+  const char* schedule = getenv("TVM_THREAD_POOL_SCHEDULE");
+  if (!schedule || std::strcmp(schedule, "static") == 0) {
+    return 0;
+  }
+  ICHECK_EQ(std::strcmp(schedule, "steal"), 0)
+      << "TVM_THREAD_POOL_SCHEDULE must be static or steal, got " << schedule;
+  const char* val = getenv("TVM_THREAD_POOL_STEAL_CHUNKS");
+  int chunks = val ? atoi(val) : kDefaultStealChunks;
+  ICHECK_GT(chunks, 0) << "TVM_THREAD_POOL_STEAL_CHUNKS must be positive";
+  return chunks;
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
 
+namespace {
+
+/*!
+ * \brief The barrier of the parallel tasks, given by TVM_THREAD_POOL_BARRIER.
+ *
+ *  - flat: every task waits on the counter of every other task, O(n^2) cache line transfers.
+ *  - dissemination: in round k every task signals the task 2^k after it and waits for the
+ *    signal of the task 2^k before it, O(n log n) transfers in log n rounds. A task that
+ *    waits longer than TVM_THREAD_POOL_SPIN_COUNT polls sleeps on a futex.
+ *  - auto, the default: flat up to kMaxFlatBarrierTasks tasks, dissemination above.
+ */
+enum class BarrierKind { kFlat, kDissemination, kAuto };
+
+constexpr int kMaxFlatBarrierTasks = 8;
+
+/*
+ * The slots of the cache line of a task in the counter page. The episode counts the barriers
+ * the task entered. Round k of the dissemination barrier counts the signals the task received
+ * in that round, at most one per barrier, so the task passes the round once it reaches the
+ * episode. The sleeping slot is set while the task sleeps on the counter of a round.
+ */
+constexpr int kEpisodeSlot = 0;
+constexpr int kFirstRoundSlot = 1;
+constexpr int kSleepingSlot = kSyncStride - 1;
+constexpr int kMaxBarrierRounds = kSleepingSlot - kFirstRoundSlot;
+
+BarrierKind GetBarrierKind() {
+  const char* val = getenv("TVM_THREAD_POOL_BARRIER");
+  if (!val || std::strcmp(val, "auto") == 0) {
+    return BarrierKind::kAuto;
+  }
+  if (std::strcmp(val, "flat") == 0) {
+    return BarrierKind::kFlat;
+  }
+  ICHECK_EQ(std::strcmp(val, "dissemination"), 0)
+      << "TVM_THREAD_POOL_BARRIER must be auto, flat or dissemination, got " << val;
+  return BarrierKind::kDissemination;
+}
+
+// Whether a counter reached a value, the counters wrap around.
+inline bool CounterReached(int counter, int value) {
+  return static_cast<int32_t>(static_cast<uint32_t>(counter) - static_cast<uint32_t>(value)) >= 0;
+}
+
+void FlatBarrier(int task_id, int num_task, std::atomic<int>* sync_counter) {
+  int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
+  for (int i = 0; i < num_task; ++i) {
+    if (i != task_id) {
+      while (sync_counter[i * kSyncStride].load(std::memory_order_relaxed) <= old_counter) {
+        threading::Yield();
+      }
+    }
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+// Wait for the counter of a round of a task to reach the episode, sleeping after the spin count.
+void WaitBarrierRound(std::atomic<int>* round, std::atomic<int>* sleeping, int episode) {
+  static uint32_t spin_count = GetSpinCount();
+  for (uint32_t i = 0; i < spin_count; ++i) {
+    if (CounterReached(round->load(std::memory_order_acquire), episode)) return;
+    threading::Yield();
+  }
+#if defined(__linux__)
+  // Pairs with the signal, which increments the round before it reads the sleeping slot, so
+  // either the signal is seen here or the signaling task wakes this one.
+  sleeping->store(1, std::memory_order_seq_cst);
+  int value;
+  while (!CounterReached(value = round->load(std::memory_order_seq_cst), episode)) {
+    syscall(SYS_futex, reinterpret_cast<int*>(round), FUTEX_WAIT_PRIVATE, value, nullptr,
+            nullptr, 0);
+  }
+  sleeping->store(0, std::memory_order_relaxed);
+#else
+  while (!CounterReached(round->load(std::memory_order_acquire), episode)) {
+    threading::Yield();
+  }
+#endif
+}
+
+void DisseminationBarrier(int task_id, int num_task, std::atomic<int>* sync_counter) {
+  std::atomic<int>* self = sync_counter + task_id * kSyncStride;
+  // only this task writes its episode
+  int episode = self[kEpisodeSlot].load(std::memory_order_relaxed) + 1;
+  self[kEpisodeSlot].store(episode, std::memory_order_relaxed);
+  for (int k = 0, dist = 1; dist < num_task; ++k, dist <<= 1) {
+    std::atomic<int>* peer = sync_counter + (task_id + dist) % num_task * kSyncStride;
+    // releases the writes of this task and of the tasks it heard from in the earlier rounds
+    peer[kFirstRoundSlot + k].fetch_add(1, std::memory_order_seq_cst);
+#if defined(__linux__)
+    if (peer[kSleepingSlot].load(std::memory_order_seq_cst) != 0) {
+      syscall(SYS_futex, reinterpret_cast<int*>(peer + kFirstRoundSlot + k), FUTEX_WAKE_PRIVATE,
+              1, nullptr, nullptr, 0);
+    }
+#endif
+    WaitBarrierRound(self + kFirstRoundSlot + k, self + kSleepingSlot, episode);
+  }
+}
+
+}  // namespace
+
+/*!
+ * \brief Wait for all the tasks of a launch to reach the barrier.
+ * \param task_id The task.
+ * \param num_task The number of tasks of the launch.
+ * \param sync_counter The counter page of the launch, a cache line per task.
+ */
+static void ParallelBarrier(int task_id, int num_task, std::atomic<int>* sync_counter) {
+  static BarrierKind kind = GetBarrierKind();
+  if (num_task == 1) return;
+  bool flat = kind == BarrierKind::kFlat ||
+              (kind == BarrierKind::kAuto && num_task <= kMaxFlatBarrierTasks) ||
+              num_task > (1 << kMaxBarrierRounds);
+  if (flat) {
+    FlatBarrier(task_id, num_task, sync_counter);
+  } else {
+    DisseminationBarrier(task_id, num_task, sync_counter);
+  }
+}
+
 /*!
  * \brief Thread local main environment.
  */
@@ -78,20 +232,76 @@ class ParallelLauncher {
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    if (need_sync && num_task > sync_capacity_) {
+      delete[] sync_counter_;
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
+      sync_capacity_ = num_task;
     }
     if (need_sync) {
-      for (int i = 0; i < num_task; ++i) {
-        sync_counter_[i * kSyncStride].store(0, std::memory_order_relaxed);
+      // the barriers use all the slots of the cache line of a task
+      for (int i = 0; i < num_task * kSyncStride; ++i) {
+        sync_counter_[i].store(0, std::memory_order_relaxed);
       }
       this->env.sync_handle = sync_counter_;
     } else {
       this->env.sync_handle = nullptr;
     }
   }
+  /*!
+   * \brief Split the tasks in contiguous ranges, one per worker, in proportion to the weights
+   *  of the workers. Each worker also counts as one pending job that finishes when it runs out
+   *  of tasks, so that no worker still looks for tasks when the next launch reuses the ranges.
+   * \param weights The relative throughput of each worker that runs the tasks.
+   * \param steal Whether the workers steal the tasks of the others once their range is done.
+   */
+  void InitRanges(const std::vector<double>& weights, bool steal) {
+    int num_workers = static_cast<int>(weights.size());
+    num_pending_.fetch_add(num_workers);
+    if (num_workers > num_ranges_) {
+      ranges_.reset(new TaskRange[num_workers]);
+      num_ranges_ = num_workers;
+    }
+    num_range_workers_ = num_workers;
+    steal_ = steal;
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double sum = 0;
+    uint64_t begin = 0;
+    for (int i = 0; i < num_workers; ++i) {
+      sum += weights[i];
+      uint64_t end = i + 1 == num_workers ? env.num_task
+                                          : static_cast<uint64_t>(env.num_task * sum / total + 0.5);
+      end = std::max(begin, end);
+      ranges_[i].range.store(begin | (end << 32), std::memory_order_relaxed);
+      ranges_[i].num_done = 0;
+      ranges_[i].busy_seconds = 0;
+      begin = end;
+    }
+  }
+  /*!
+   * \brief Get the next task of a worker: the front of its own range, or else with stealing
+   *  the back of the range of another worker.
+   * \param worker_id The worker.
+   * \param task_id The task to run.
+   * \return Whether there is a task left.
+   */
+  bool NextTask(int worker_id, int* task_id) {
+    if (PopFront(&ranges_[worker_id], task_id)) return true;
+    for (int i = 1; steal_ && i < num_range_workers_; ++i) {
+      if (PopBack(&ranges_[(worker_id + i) % num_range_workers_], task_id)) return true;
+    }
+    return false;
+  }
+  // Record that a worker ran a task in the given time.
+  void RecordTask(int worker_id, double seconds) {
+    ranges_[worker_id].num_done += 1;
+    ranges_[worker_id].busy_seconds += seconds;
+  }
+  // The tasks per second of a worker in the last launch, 0 if it ran none.
+  double Throughput(int worker_id) const {
+    const TaskRange& r = ranges_[worker_id];
+    return r.busy_seconds > 0 ? r.num_done / r.busy_seconds : 0;
+  }
   ~ParallelLauncher() { delete[] sync_counter_; }
   // Wait n jobs to finish
   int WaitForJobs() {
@@ -128,14 +338,53 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // Whether the queued tasks are workers that run the tasks of the ranges.
+  bool ranged{false};
 
  private:
+  /*! \brief The tasks [begin, end) left to a worker, packed as begin | end << 32. */
+  struct TaskRange {
+    std::atomic<uint64_t> range;
+    // The tasks the worker ran, and the time they took, only written by the worker
+    int64_t num_done;
+    double busy_seconds;
+    // avoid false sharing between the workers
+    char pad[kL1CacheBytes - sizeof(std::atomic<uint64_t>) - sizeof(int64_t) - sizeof(double)];
+  };
+  static bool PopFront(TaskRange* r, int* task_id) {
+    uint64_t range = r->range.load(std::memory_order_acquire);
+    while (true) {
+      uint64_t begin = range & 0xFFFFFFFFU, end = range >> 32;
+      if (begin >= end) return false;
+      if (r->range.compare_exchange_weak(range, (begin + 1) | (end << 32))) {
+        *task_id = static_cast<int>(begin);
+        return true;
+      }
+    }
+  }
+  static bool PopBack(TaskRange* r, int* task_id) {
+    uint64_t range = r->range.load(std::memory_order_acquire);
+    while (true) {
+      uint64_t begin = range & 0xFFFFFFFFU, end = range >> 32;
+      if (begin >= end) return false;
+      if (r->range.compare_exchange_weak(range, begin | ((end - 1) << 32))) {
+        *task_id = static_cast<int>(end - 1);
+        return true;
+      }
+    }
+  }
+  // The task ranges of the workers.
+  std::unique_ptr<TaskRange[]> ranges_;
+  int num_ranges_{0};
+  int num_range_workers_{0};
+  bool steal_{false};
   // The pending jobs.
   std::atomic<int32_t> num_pending_;
   // Whether error has been countered.
   std::atomic<bool> has_error_;
-  // The counter page.
+  // The counter page, and the number of tasks it holds.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  int sync_capacity_{0};
   // The error message
   std::vector<std::string> par_errors_;
 };
@@ -257,20 +506,31 @@ class SpscTaskQueue {
 // The thread pool
 class ThreadPool {
  public:
-  ThreadPool() : num_workers_(tvm::runtime::threading::MaxConcurrency()) {
+  ThreadPool() : ThreadPool(tvm::runtime::threading::MaxConcurrency(), 0, true) {}
+  /*!
+   * \brief Create a thread pool.
+   * \param num_workers The number of workers.
+   * \param first_core The index of the first core the workers are bound to, from the fastest.
+   * \param use_main_thread Whether the launching thread runs the tasks of worker 0, the
+   *  partitions shared by several threads only use their own workers.
+   */
+  ThreadPool(int num_workers, int first_core, bool use_main_thread)
+      : num_workers_(num_workers), first_core_(first_core) {
     for (int i = 0; i < num_workers_; ++i) {
       // The SpscTaskQueue only hosts ONE item at a time
       queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
     }
+    steal_chunks_ = GetStealChunks();
     const char* exclude_worker0 = getenv("TVM_EXCLUDE_WORKER0");
-    if (exclude_worker0 && atoi(exclude_worker0) == 0) {
+    if (!use_main_thread || (exclude_worker0 && atoi(exclude_worker0) == 0)) {
       exclude_worker0_ = false;
     }
     threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
         new tvm::runtime::threading::ThreadGroup(
             num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
             exclude_worker0_ /* include_main_thread */));
-    num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
+    num_workers_used_ =
+        threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_, first_core_);
   }
   ~ThreadPool() {
     for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
@@ -282,15 +542,22 @@ class ThreadPool {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
     ICHECK(!launcher->is_worker)
         << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    // Only the loops split by the pool are scheduled dynamically. The tasks of an explicit
+    // task count or of a launch with TVM_PARALLEL_LAUNCH_SYNC may synchronize with a barrier,
+    // which needs every task to run at once.
+    if (num_task == 0 && need_sync == 0 && (steal_chunks_ > 0 || weighted_)) {
+      return LaunchRanges(launcher, flambda, cdata);
+    }
     if (num_task == 0) {
       num_task = num_workers_used_;
     }
-    if (need_sync != 0) {
-      ICHECK_LE(num_task, num_workers_used_)
-          << "Request parallel sync task larger than number of threads used "
-          << " workers=" << num_workers_used_ << " request=" << num_task;
-    }
-    launcher->Init(flambda, cdata, num_task, need_sync != 0);
+    // The static tasks can always synchronize, also those of the modules built before
+    // TVM_PARALLEL_LAUNCH_SYNC, which launch their barriers without it.
+    ICHECK_LE(num_task, num_workers_used_)
+        << "Request parallel sync task larger than number of threads used "
+        << " workers=" << num_workers_used_ << " request=" << num_task;
+    launcher->Init(flambda, cdata, num_task, true);
+    launcher->ranged = false;
     SpscTaskQueue::Task tsk;
     tsk.launcher = launcher;
     // if worker0 is taken by the main, queues_[0] is abandoned
@@ -301,11 +568,14 @@ class ThreadPool {
     // use the main thread to run task 0
     if (exclude_worker0_) {
       TVMParallelGroupEnv* penv = &(tsk.launcher->env);
+      // the launches of the task run on the main thread, like those of the workers
+      launcher->is_worker = true;
       if ((*tsk.launcher->flambda)(0, penv, cdata) == 0) {
         tsk.launcher->SignalJobFinish();
       } else {
         tsk.launcher->SignalJobError(tsk.task_id);
       }
+      launcher->is_worker = false;
     }
     int res = launcher->WaitForJobs();
     return res;
@@ -313,13 +583,48 @@ class ThreadPool {
 
   static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
 
+  /*!
+   * \brief Launch several tasks per worker, split in ranges by the weights of the workers for
+   *  the weighted schedule or evenly otherwise, and stolen by idle workers for the work-stealing
+   *  schedule. The main thread takes part as worker 0 unless it is excluded. The tasks cannot
+   *  synchronize, so sync_handle is null.
+   */
+  int LaunchRanges(ParallelLauncher* launcher, FTVMParallelLambda flambda, void* cdata) {
+    int num_workers = num_workers_used_;
+    int chunks = steal_chunks_ > 0 ? steal_chunks_ : kWeightedChunks;
+    launcher->Init(flambda, cdata, num_workers * chunks, false);
+    launcher->ranged = true;
+    if (!weighted_ || static_cast<int>(worker_weights_.size()) != num_workers) {
+      worker_weights_.assign(num_workers, 1.0);
+    }
+    launcher->InitRanges(worker_weights_, steal_chunks_ > 0);
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    // The task id of the queued task is the id of the worker
+    for (int i = exclude_worker0_; i < num_workers; ++i) {
+      tsk.task_id = i;
+      queues_[i]->Push(tsk);
+    }
+    if (exclude_worker0_) {
+      launcher->is_worker = true;
+      RunRange(launcher, 0);
+      launcher->is_worker = false;
+    }
+    int res = launcher->WaitForJobs();
+    if (weighted_) UpdateWeights(launcher);
+    return res;
+  }
+
   void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads) {
     // this will also reset the affinity of the ThreadGroup
     // may use less than the MaxConcurrency number of workers
-    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_);
+    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_, first_core_);
     // if MaxConcurrency restricted the number of workers (e.g., due to
     // hyperthreading), respect the restriction
     num_workers_used_ = std::min(num_workers_, num_workers_used_);
+    // the mixed mode weights the tasks of the cores by their measured throughput
+    weighted_ = mode == threading::ThreadGroup::kMixed;
+    worker_weights_.clear();
   }
 
  private:
@@ -334,6 +639,10 @@ class ThreadPool {
     static size_t spin_count = GetSpinCount();
     while (queue->Pop(&task, spin_count)) {
       ICHECK(task.launcher != nullptr);
+      if (task.launcher->ranged) {
+        RunRange(task.launcher, task.task_id);
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
       if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
@@ -343,15 +652,148 @@ class ThreadPool {
       }
     }
   }
+  // Run the tasks of a worker from the ranges until none is left.
+  static void RunRange(ParallelLauncher* launcher, int worker_id) {
+    int task_id;
+    while (launcher->NextTask(worker_id, &task_id)) {
+      auto start = std::chrono::steady_clock::now();
+      int ret = (*launcher->flambda)(task_id, &(launcher->env), launcher->cdata);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      launcher->RecordTask(worker_id, elapsed.count());
+      if (ret == 0) {
+        launcher->SignalJobFinish();
+      } else {
+        launcher->SignalJobError(task_id);
+      }
+    }
+    launcher->SignalJobFinish();
+  }
+  // Move the weight of each worker towards its throughput in the last launch, relative to the
+  // mean throughput. The weights are smoothed over the launches, as the operators differ.
+  void UpdateWeights(const ParallelLauncher* launcher) {
+    int num_workers = static_cast<int>(worker_weights_.size());
+    std::vector<double> throughput(num_workers);
+    double total = 0;
+    int num_measured = 0;
+    for (int i = 0; i < num_workers; ++i) {
+      throughput[i] = launcher->Throughput(i);
+      if (throughput[i] > 0) {
+        total += throughput[i];
+        ++num_measured;
+      }
+    }
+    if (num_measured == 0) return;
+    double mean = total / num_measured;
+    for (int i = 0; i < num_workers; ++i) {
+      if (throughput[i] <= 0) continue;
+      worker_weights_[i] += kWeightSmoothing * (throughput[i] / mean - worker_weights_[i]);
+      worker_weights_[i] = std::max(worker_weights_[i], kMinWeight);
+    }
+  }
+
   int num_workers_;
+  // index of the first core of the workers
+  int first_core_;
   // number of workers used (can be restricted with affinity pref)
   int num_workers_used_;
   // if or not to exclude worker 0 and use main to run task 0
   bool exclude_worker0_{true};
+  // number of tasks per worker of the work-stealing schedule, 0 for the static schedule
+  int steal_chunks_{0};
+  // whether the tasks are split by the measured throughput of the workers (mixed mode)
+  bool weighted_{false};
+  // the relative throughput of each worker
+  std::vector<double> worker_weights_;
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
+/*! \brief A thread pool shared by the threads bound to it, one launch at a time. */
+struct ThreadPoolPartition {
+  std::unique_ptr<ThreadPool> pool;
+  std::mutex mutex;
+};
+
+/*! \brief The thread pool partitions and the partition each thread is bound to. */
+class ThreadPoolPartitions {
+ public:
+  static ThreadPoolPartitions* Global() {
+    static ThreadPoolPartitions* inst = new ThreadPoolPartitions();
+    return inst;
+  }
+
+  void Create(int id, int num_workers, int first_core) {
+    ICHECK_GE(id, 0) << "Invalid thread pool partition " << id;
+    ICHECK_GT(num_workers, 0) << "A thread pool partition needs a worker";
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<ThreadPoolPartition>& partition = partitions_[id];
+    ICHECK(partition == nullptr) << "Thread pool partition " << id << " already exists";
+    partition.reset(new ThreadPoolPartition());
+    partition->pool.reset(new ThreadPool(num_workers, first_core, false));
+  }
+
+  ThreadPoolPartition* Get(int id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = partitions_.find(id);
+    ICHECK(it != partitions_.end()) << "Thread pool partition " << id << " does not exist";
+    return it->second.get();
+  }
+
+  /*! \brief The partition of the calling thread, -1 for its own thread pool. */
+  static int* Bound() {
+    static thread_local int partition = -1;
+    return &partition;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<int, std::unique_ptr<ThreadPoolPartition>> partitions_;
+};
+
+namespace threading {
+
+int BindThreadPoolPartition(int partition) {
+  if (partition >= 0) ThreadPoolPartitions::Global()->Get(partition);
+  int* bound = ThreadPoolPartitions::Bound();
+  int prev = *bound;
+  *bound = partition;
+  return prev;
+}
+
+}  // namespace threading
+
+static int ParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
+  int partition = *ThreadPoolPartitions::Bound();
+  if (partition < 0) {
+    return ThreadPool::ThreadLocal()->Launch(flambda, cdata, num_task, need_sync);
+  }
+  ThreadPoolPartition* p = ThreadPoolPartitions::Global()->Get(partition);
+  std::lock_guard<std::mutex> lock(p->mutex);
+  return p->pool->Launch(flambda, cdata, num_task, need_sync);
+}
+
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_partition")
+    .set_body_typed([](int id, int num_workers, int first_core) {
+      ThreadPoolPartitions::Global()->Create(id, num_workers, first_core);
+    });
+
+// Create one partition per NUMA node on the physical cores of the node, with the ids first_id,
+// first_id + 1, ... The cores of a node are contiguous in the order of the thread groups when
+// all the cores run at the same frequency.
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_numa_partitions").set_body_typed([](int first_id) {
+  int num_nodes = threading::NumNumaNodes();
+  int first_core = 0;
+  for (int node = 0; node < num_nodes; ++node) {
+    int num_cores = threading::NumaNodeCores(node);
+    ThreadPoolPartitions::Global()->Create(first_id + node, std::max(num_cores, 1), first_core);
+    first_core += num_cores;
+  }
+  return num_nodes;
+});
+
+TVM_REGISTER_GLOBAL("runtime.bind_threadpool_partition")
+    .set_body_typed(threading::BindThreadPoolPartition);
+
 TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRetValue* rv) {
   threading::ThreadGroup::AffinityMode mode =
       static_cast<threading::ThreadGroup::AffinityMode>(static_cast<int>(args[0]));
@@ -363,19 +805,23 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
 }  // namespace tvm
 
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
+  int flags = num_task & TVM_PARALLEL_LAUNCH_SYNC;
+  num_task &= ~TVM_PARALLEL_LAUNCH_SYNC;
   int num_workers = tvm::runtime::threading::MaxConcurrency();
-  if (num_workers == 1) {
+  // A launch from the task of a worker runs on the worker, as the pool is busy
+  bool nested = tvm::runtime::ParallelLauncher::ThreadLocal()->is_worker;
+  if (num_workers == 1 || nested) {
     std::atomic<int32_t> sync_counter{0};
     TVMParallelGroupEnv env;
     env.num_task = 1;
     env.sync_handle = &sync_counter;
-    (*flambda)(0, &env, cdata);
-    return 0;
+    return (*flambda)(0, &env, cdata) == 0 ? 0 : -1;
   } else {
 #if !TVM_THREADPOOL_USE_OPENMP
-    int res = tvm::runtime::ThreadPool::ThreadLocal()->Launch(flambda, cdata, num_task, 1);
-    return res;
+    return tvm::runtime::ParallelLaunch(flambda, cdata, num_task, flags != 0);
 #else
+    // OpenMP runs every task on its own thread, so their barriers need no flag
+    (void)flags;
     if (num_task == 0) num_task = num_workers;
     omp_set_num_threads(num_task);
 #pragma omp parallel num_threads(num_task)
@@ -393,18 +839,12 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
 #if TVM_THREADPOOL_USE_OPENMP
 #pragma omp barrier
 #else
-  using tvm::runtime::kSyncStride;
-  int num_task = penv->num_task;
-  std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
-  int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
-  for (int i = 0; i < num_task; ++i) {
-    if (i != task_id) {
-      while (sync_counter[i * kSyncStride].load(std::memory_order_relaxed) <= old_counter) {
-        tvm::runtime::threading::Yield();
-      }
-    }
-  }
-  std::atomic_thread_fence(std::memory_order_acquire);
+  ICHECK(penv->sync_handle != nullptr)
+      << "Parallel barrier in a task scheduled dynamically, the module was built without "
+      << "TVM_PARALLEL_LAUNCH_SYNC: rebuild it, or set TVM_THREAD_POOL_SCHEDULE=static and do "
+      << "not use the mixed affinity";
+  tvm::runtime::ParallelBarrier(task_id, penv->num_task,
+                                reinterpret_cast<std::atomic<int>*>(penv->sync_handle));
 #endif
   return 0;
 }
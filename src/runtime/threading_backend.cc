@@ -25,7 +25,9 @@
 #include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <string>
 #include <thread>
+#include <vector>
 #if defined(__linux__) || defined(__ANDROID__)
 #include <fstream>
 #include <sstream>
@@ -42,6 +44,77 @@ namespace tvm {
 namespace runtime {
 namespace threading {
 
+/*! \brief The NUMA node and the hyper-thread rank of each core, read from sysfs. */
+class CPUTopology {
+ public:
+  static const CPUTopology& Global() {
+    static CPUTopology* inst = new CPUTopology();
+    return *inst;
+  }
+
+  int num_nodes() const { return num_nodes_; }
+
+  int node(int core) const {
+    return core >= 0 && core < static_cast<int>(node_.size()) ? node_[core] : 0;
+  }
+
+  // The index of the core among the hardware threads of its physical core
+  int smt_rank(int core) const {
+    return core >= 0 && core < static_cast<int>(smt_rank_.size()) ? smt_rank_[core] : 0;
+  }
+
+ private:
+  CPUTopology() {
+    unsigned int threads = std::thread::hardware_concurrency();
+    node_.assign(threads, 0);
+    smt_rank_.assign(threads, 0);
+#if defined(__linux__) || defined(__ANDROID__)
+    for (int node : ParseList(ReadLine("/sys/devices/system/node/online"))) {
+      std::ostringstream path;
+      path << "/sys/devices/system/node/node" << node << "/cpulist";
+      for (int core : ParseList(ReadLine(path.str()))) {
+        if (core < static_cast<int>(threads)) node_[core] = node;
+      }
+      num_nodes_ = std::max(num_nodes_, node + 1);
+    }
+    for (unsigned int core = 0; core < threads; ++core) {
+      std::ostringstream path;
+      path << "/sys/devices/system/cpu/cpu" << core << "/topology/thread_siblings_list";
+      std::vector<int> siblings = ParseList(ReadLine(path.str()));
+      auto it = std::find(siblings.begin(), siblings.end(), static_cast<int>(core));
+      if (it != siblings.end()) smt_rank_[core] = static_cast<int>(it - siblings.begin());
+    }
+#endif
+  }
+
+#if defined(__linux__) || defined(__ANDROID__)
+  static std::string ReadLine(const std::string& path) {
+    std::ifstream ifs(path);
+    std::string line;
+    if (!ifs.fail()) std::getline(ifs, line);
+    return line;
+  }
+
+  // Parse a sysfs list such as "0-3,8-11"
+  static std::vector<int> ParseList(const std::string& list) {
+    std::vector<int> items;
+    std::istringstream is(list);
+    std::string range;
+    while (std::getline(is, range, ',')) {
+      size_t dash = range.find('-');
+      int begin = atoi(range.substr(0, dash).c_str());
+      int end = dash == std::string::npos ? begin : atoi(range.substr(dash + 1).c_str());
+      for (int i = begin; i <= end; ++i) items.push_back(i);
+    }
+    return items;
+  }
+#endif
+
+  int num_nodes_ = 1;
+  std::vector<int> node_;
+  std::vector<int> smt_rank_;
+};
+
 class ThreadGroup::Impl {
  public:
   Impl(int num_workers, std::function<void(int)> worker_callback, bool exclude_worker0)
@@ -60,12 +133,14 @@ class ThreadGroup::Impl {
     }
   }
 
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0, int first_core) {
     int num_workers_used = 0;
     if (mode == kLittle) {
       num_workers_used = little_count_;
     } else if (mode == kBig) {
       num_workers_used = big_count_;
+    } else if (mode == kMixed) {
+      num_workers_used = static_cast<int>(sorted_order_.size());
     } else {
       // use default
       num_workers_used = threading::MaxConcurrency();
@@ -83,8 +158,8 @@ class ThreadGroup::Impl {
     const char* val = getenv("TVM_BIND_THREADS");
     if (val == nullptr || atoi(val) == 1) {
       // Do not set affinity if there are more workers than found cores
-      if (sorted_order_.size() >= static_cast<unsigned int>(num_workers_)) {
-        SetAffinity(exclude_worker0, mode == kLittle);
+      if (sorted_order_.size() >= static_cast<unsigned int>(num_workers_ + first_core)) {
+        SetAffinity(exclude_worker0, mode, first_core);
       } else {
         LOG(WARNING) << "The thread affinity cannot be set when the number of workers"
                      << "is larger than the number of available cores in the system.";
@@ -97,7 +172,7 @@ class ThreadGroup::Impl {
   // bind worker threads to disjoint cores
   // if worker 0 is offloaded to main, i.e. exclude_worker0 is true,
   // the main thread is bound to core 0.
-  void SetAffinity(bool exclude_worker0, bool reverse = false) {
+  void SetAffinity(bool exclude_worker0, AffinityMode mode, int first_core) {
 #if defined(__ANDROID__)
 #ifndef CPU_SET
 #define CPU_SETSIZE 1024
@@ -113,13 +188,15 @@ class ThreadGroup::Impl {
 #endif
 #if defined(__linux__) || defined(__ANDROID__)
     ICHECK_GE(sorted_order_.size(), num_workers_);
+    // the workers of the little mode take the slowest cores first
+    bool reverse = mode == kLittle;
 
     for (unsigned i = 0; i < threads_.size(); ++i) {
       unsigned core_id;
       if (reverse) {
-        core_id = sorted_order_[sorted_order_.size() - (i + exclude_worker0) - 1];
+        core_id = sorted_order_[sorted_order_.size() - (i + exclude_worker0 + first_core) - 1];
       } else {
-        core_id = sorted_order_[i + exclude_worker0];
+        core_id = sorted_order_[i + exclude_worker0 + first_core];
       }
       cpu_set_t cpuset;
       CPU_ZERO(&cpuset);
@@ -135,12 +212,12 @@ class ThreadGroup::Impl {
       // Typically, the OS will schedule the main thread to run at core 0,
       // which is idle, when other workers are running.
       // See the comment inside SetMasterThreadFullCpuAffinity function to get more detail.
-      SetMasterThreadFullCpuAffinity(reverse);
+      SetMasterThreadFullCpuAffinity(mode);
     }
 #endif
   }
 
-  void SetMasterThreadFullCpuAffinity(bool reverse) {
+  void SetMasterThreadFullCpuAffinity(AffinityMode mode) {
 #if defined(__linux__) || defined(__ANDROID__)
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
@@ -154,10 +231,15 @@ class ThreadGroup::Impl {
     // Note: this works well on x86 too. Because x86 doesn't have BIG.LITTLE,
     // our implementation will use kBig mode by default and will let main thread
     // run on intended cores.
-    if (reverse) {
+    if (mode == kLittle) {
       for (int i = 0; i < little_count_; ++i) {
         CPU_SET(sorted_order_[sorted_order_.size() - i - 1], &cpuset);
       }
+    } else if (mode == kMixed) {
+      // The workers run on both clusters, so does the main thread
+      for (unsigned core_id : sorted_order_) {
+        CPU_SET(core_id, &cpuset);
+      }
     } else {
       int num_cpu_workers = std::min(MaxConcurrency(), big_count_);
       for (int i = 0; i < num_cpu_workers; ++i) {
@@ -197,9 +279,17 @@ class ThreadGroup::Impl {
       max_freqs.push_back(std::make_pair(i, cur_freq));
     }
 
-    auto fcmpbyfreq = [](const std::pair<unsigned int, int64_t>& a,
-                         const std::pair<unsigned int, int64_t>& b) {
-      return a.second == b.second ? a.first < b.first : a.second > b.second;
+    // Among the cores of a frequency, the first hardware thread of each physical core comes
+    // first, and the cores of a NUMA node are contiguous, so that the workers fill the
+    // physical cores of one node before the next.
+    const CPUTopology& topo = CPUTopology::Global();
+    auto fcmpbyfreq = [&topo](const std::pair<unsigned int, int64_t>& a,
+                              const std::pair<unsigned int, int64_t>& b) {
+      if (a.second != b.second) return a.second > b.second;
+      int a_rank = topo.smt_rank(a.first), b_rank = topo.smt_rank(b.first);
+      if (a_rank != b_rank) return a_rank < b_rank;
+      int a_node = topo.node(a.first), b_node = topo.node(b.first);
+      return a_node == b_node ? a.first < b.first : a_node < b_node;
     };
     std::sort(max_freqs.begin(), max_freqs.end(), fcmpbyfreq);
     int64_t big_freq = max_freqs.begin()->second;
@@ -231,8 +321,9 @@ ThreadGroup::ThreadGroup(int num_workers, std::function<void(int)> worker_callba
 ThreadGroup::~ThreadGroup() { delete impl_; }
 void ThreadGroup::Join() { impl_->Join(); }
 
-int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
-  return impl_->Configure(mode, nthreads, exclude_worker0);
+int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
+                           int first_core) {
+  return impl_->Configure(mode, nthreads, exclude_worker0, first_core);
 }
 
 void Yield() { std::this_thread::yield(); }
@@ -265,6 +356,27 @@ int MaxConcurrency() {
   return std::max(max_concurrency, 1);
 }
 
+int NumNumaNodes() { return CPUTopology::Global().num_nodes(); }
+
+int NumaNodeOfCore(int core) { return CPUTopology::Global().node(core); }
+
+int NumaNodeCores(int node) {
+  const CPUTopology& topo = CPUTopology::Global();
+  int cores = 0;
+  for (unsigned int i = 0; i < std::thread::hardware_concurrency(); ++i) {
+    if (topo.node(i) == node && topo.smt_rank(i) == 0) ++cores;
+  }
+  return cores;
+}
+
+int CurrentNumaNode() {
+#if defined(__linux__) && !defined(__ANDROID__)
+  return NumaNodeOfCore(sched_getcpu());
+#else
+  return 0;
+#endif
+}
+
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
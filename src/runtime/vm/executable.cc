@@ -76,6 +76,9 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
       int index = args[1];
       *rv = this->GetFunctionParameterName(func_name, index);
     });
+  } else if (name == "prefetch_constants") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->PrefetchConstants(); });
   } else if (name == "vm_load_executable") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       auto vm = make_object<VirtualMachine>();
@@ -152,8 +155,9 @@ std::string Executable::Stats() const {
 
   // Get the number of constants and the shape of each of them.
   oss << "  Constant shapes (# " << constants.size() << "): [";
-  for (const auto& it : constants) {
-    const auto constant = Downcast<NDArray>(it);
+  for (size_t i = 0; i < constants.size(); ++i) {
+    // Reading the shape materializes the constants that are not loaded yet.
+    const auto constant = Downcast<NDArray>(GetConstant(i));
     const auto& shape = constant.Shape();
 
     // Scalar
@@ -208,6 +212,9 @@ void SaveHeader(dmlc::Stream* strm) {
 }
 
 TVMByteArray Executable::Save() {
+  // The constants that are not loaded yet point into the blob that is overwritten.
+  LoadAllConstants();
+
   // Initialize the stream object.
   code_.clear();
   dmlc::MemoryStringStream strm(&code_);
@@ -543,14 +550,43 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
+// Skip a serialized NDArray, see NDArray::Load for the format.
+static void SkipNDArray(dmlc::SeekStream* strm) {
+  uint64_t header, reserved;
+  STREAM_CHECK(strm->Read(&header), "constant");
+  STREAM_CHECK(strm->Read(&reserved), "constant");
+  STREAM_CHECK(header == kTVMNDArrayMagic, "constant");
+  Device dev;
+  int ndim;
+  DLDataType dtype;
+  STREAM_CHECK(strm->Read(&dev), "constant");
+  STREAM_CHECK(strm->Read(&ndim), "constant");
+  STREAM_CHECK(strm->Read(&dtype), "constant");
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    STREAM_CHECK(strm->ReadArray(&shape[0], ndim), "constant");
+  }
+  int64_t data_byte_size;
+  STREAM_CHECK(strm->Read(&data_byte_size), "constant");
+  strm->Seek(strm->Tell() + reserved + static_cast<size_t>(data_byte_size));
+}
+
 void Executable::LoadConstantSection(dmlc::Stream* strm) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
 
   size_t size = static_cast<size_t>(sz);
-  // Load each of the constants.
+  // The constants of a seekable stream are loaded on first use, the others right away.
+  auto* seek_strm = dynamic_cast<dmlc::SeekStream*>(strm);
   for (size_t i = 0; i < size; i++) {
+    if (seek_strm != nullptr) {
+      if (const_offsets_.empty()) const_offsets_.resize(size, 0);
+      const_offsets_[i] = seek_strm->Tell();
+      SkipNDArray(seek_strm);
+      this->constants.push_back(ObjectRef());
+      continue;
+    }
     runtime::NDArray constant;
     STREAM_CHECK(constant.Load(strm), "constant");
     this->constants.push_back(constant);
@@ -563,6 +599,39 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
   this->const_device_type = const_device_type;
 }
 
+ObjectRef Executable::GetConstant(Index index) const {
+  ICHECK_LT(static_cast<size_t>(index), constants.size()) << "Invalid constant index " << index;
+  std::lock_guard<std::mutex> lock(const_mutex_);
+  if (!constants[index].defined()) {
+    ICHECK_LT(static_cast<size_t>(index), const_offsets_.size());
+    ICHECK_NE(const_offsets_[index], 0U) << "Constant " << index << " is not loaded";
+    // The stream only reads the blob.
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(code_.data()), code_.size());
+    strm.Seek(const_offsets_[index]);
+    runtime::NDArray constant;
+    STREAM_CHECK(constant.Load(&strm), "constant");
+    constants[index] = constant;
+    const_offsets_[index] = 0;
+  }
+  return constants[index];
+}
+
+void Executable::LoadAllConstants() {
+  if (prefetch_thread_.joinable()) prefetch_thread_.join();
+  for (size_t i = 0; i < constants.size(); ++i) {
+    GetConstant(i);
+  }
+}
+
+void Executable::PrefetchConstants() {
+  if (prefetch_thread_.joinable()) return;
+  prefetch_thread_ = std::thread([this]() {
+    for (size_t i = 0; i < constants.size(); ++i) {
+      GetConstant(i);
+    }
+  });
+}
+
 void Executable::LoadPrimitiveOpNames(dmlc::Stream* strm) {
   std::vector<std::string> primitive_names;
   STREAM_CHECK(strm->Read(&primitive_names), "primitive name");
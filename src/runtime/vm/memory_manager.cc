@@ -21,6 +21,8 @@
  * \file tvm/runtime/vm/memory_manager.cc
  * \brief Allocate and manage memory for the runtime.
  */
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
 #include <memory>
@@ -170,6 +172,34 @@ NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLDevice
   return NDArray(GetObjectPtr<Object>(container));
 }
 
+static PooledAllocator* GetPooledAllocator(Device dev) {
+  Allocator* alloc = MemoryManager::GetAllocator(dev);
+  ICHECK_EQ(alloc->type(), kPooled) << "The allocator of " << DeviceName(dev.device_type) << "("
+                                    << dev.device_id << ") is not pooled";
+  return static_cast<PooledAllocator*>(alloc);
+}
+
+TVM_REGISTER_GLOBAL("runtime.SetMemoryPoolLimit").set_body_typed([](Device dev, int64_t limit) {
+  ICHECK_GE(limit, 0);
+  GetPooledAllocator(dev)->SetLimit(static_cast<size_t>(limit));
+});
+
+TVM_REGISTER_GLOBAL("runtime.profiling.MemoryPoolStats").set_body_typed([](Device dev) {
+  PooledAllocator::Stats stats = GetPooledAllocator(dev)->GetStats();
+  auto count = [](uint64_t value) {
+    return ObjectRef(make_object<profiling::CountNode>(static_cast<int64_t>(value)));
+  };
+  Map<String, ObjectRef> metrics;
+  metrics.Set("Used Bytes", count(stats.used_bytes));
+  metrics.Set("Cached Bytes", count(stats.cached_bytes));
+  metrics.Set("Peak Bytes", count(stats.peak_bytes));
+  metrics.Set("Limit Bytes", count(stats.limit_bytes));
+  metrics.Set("Hits", count(stats.num_hits));
+  metrics.Set("Misses", count(stats.num_misses));
+  metrics.Set("Trimmed", count(stats.num_trimmed));
+  return metrics;
+});
+
 }  // namespace vm
 }  // namespace runtime
 }  // namespace tvm
@@ -26,19 +26,49 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/vm/memory_manager.h>
 
+#include <algorithm>
 #include <atomic>
+#include <iterator>
+#include <list>
+#include <map>
 #include <mutex>
-#include <unordered_map>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
 namespace vm {
 
+/*!
+ * \brief Allocator that caches the freed buffers for later allocations.
+ *
+ *  Sizes are rounded up to size classes, four per power of two above four pages, so that
+ *  buffers are reused across slightly different sizes while wasting at most a quarter of
+ *  them. An allocation takes the smallest cached buffer of its class or the next one.
+ *  When a limit is set, the least recently freed buffers are released to keep the memory
+ *  held by the allocator below it.
+ */
 class PooledAllocator final : public Allocator {
  public:
   static constexpr size_t kDefaultPageSize = 4096;
 
+  /*! \brief Statistics of the allocator. */
+  struct Stats {
+    /*! \brief The memory allocated from the device, in use or cached. */
+    size_t used_bytes;
+    /*! \brief The memory of the cached buffers. */
+    size_t cached_bytes;
+    /*! \brief The maximum of used_bytes. */
+    size_t peak_bytes;
+    /*! \brief The limit of used_bytes, 0 if there is none. */
+    size_t limit_bytes;
+    /*! \brief The number of allocations served from the cache. */
+    uint64_t num_hits;
+    /*! \brief The number of allocations from the device. */
+    uint64_t num_misses;
+    /*! \brief The number of cached buffers released to the device. */
+    uint64_t num_trimmed;
+  };
+
   explicit PooledAllocator(Device dev, size_t page_size = kDefaultPageSize)
       : Allocator(kPooled), page_size_(page_size), used_memory_(0), device_(dev) {}
 
@@ -46,44 +76,103 @@ class PooledAllocator final : public Allocator {
 
   Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
     std::lock_guard<std::mutex> lock(mu_);
-    size_t size = ((nbytes + page_size_ - 1) / page_size_) * page_size_;
-    auto&& it = memory_pool_.find(size);
-    if (it != memory_pool_.end() && !it->second.empty()) {
-      auto&& pool = it->second;
-      auto ret = pool.back();
-      pool.pop_back();
+    size_t size = SizeClass(nbytes);
+    auto it = free_buffers_.lower_bound(size);
+    if (it != free_buffers_.end() && it->first <= SizeClass(size + 1)) {
+      Buffer ret = *it->second;
+      lru_.erase(it->second);
+      free_buffers_.erase(it);
+      cached_bytes_ -= ret.size;
+      ++num_hits_;
       return ret;
     }
+    ++num_misses_;
+    if (limit_bytes_ != 0) {
+      Trim(limit_bytes_ > size ? limit_bytes_ - size : 0);
+    }
     Buffer buf;
     buf.device = device_;
     buf.size = size;
-    buf.data = DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
-    used_memory_.fetch_add(size, std::memory_order_relaxed);
-    DLOG(INFO) << "allocate " << size << " B, used memory " << used_memory_ << " B";
+    try {
+      buf.data = DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    } catch (const InternalError& err) {
+      if (cached_bytes_ == 0) throw;
+      // The device may be out of memory, retry without the cached buffers
+      LOG(WARNING) << "Allocation of " << size << " B failed, releasing " << cached_bytes_
+                   << " B of cached buffers";
+      Trim(0);
+      buf.data = DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    }
+    size_t used = used_memory_.fetch_add(size, std::memory_order_relaxed) + size;
+    peak_bytes_ = std::max(peak_bytes_, used);
+    DLOG(INFO) << "allocate " << size << " B, used memory " << used << " B";
     return buf;
   }
 
   void Free(const Buffer& buffer) override {
     std::lock_guard<std::mutex> lock(mu_);
-    if (memory_pool_.find(buffer.size) == memory_pool_.end()) {
-      memory_pool_.emplace(buffer.size, std::vector<Buffer>{});
-    }
-    memory_pool_.at(buffer.size).push_back(buffer);
+    lru_.push_back(buffer);
+    free_buffers_.emplace(buffer.size, std::prev(lru_.end()));
+    cached_bytes_ += buffer.size;
     DLOG(INFO) << "reclaim buffer " << buffer.size;
+    if (limit_bytes_ != 0) Trim(limit_bytes_);
   }
 
   size_t UsedMemory() const override { return used_memory_.load(std::memory_order_relaxed); }
 
+  /*!
+   * \brief Set the limit of the memory held by the allocator.
+   * \param limit_bytes The limit, 0 for no limit.
+   */
+  void SetLimit(size_t limit_bytes) {
+    std::lock_guard<std::mutex> lock(mu_);
+    limit_bytes_ = limit_bytes;
+    if (limit_bytes_ != 0) Trim(limit_bytes_);
+  }
+
+  /*! \brief Get the statistics of the allocator. */
+  Stats GetStats() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return Stats{UsedMemory(), cached_bytes_, peak_bytes_, limit_bytes_,
+                 num_hits_,    num_misses_,  num_trimmed_};
+  }
+
  private:
+  // Round a size up to its size class
+  size_t SizeClass(size_t nbytes) const {
+    size_t pages = (nbytes + page_size_ - 1) / page_size_;
+    size_t step = 1;
+    while ((step << 3) <= pages) step <<= 1;
+    return (pages + step - 1) / step * step * page_size_;
+  }
+
+  // Release the least recently freed buffers until the used memory is at most target_bytes
+  void Trim(size_t target_bytes) {
+    while (!lru_.empty() && UsedMemory() > target_bytes) {
+      const Buffer& buf = lru_.front();
+      auto range = free_buffers_.equal_range(buf.size);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == lru_.begin()) {
+          free_buffers_.erase(it);
+          break;
+        }
+      }
+      DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
+      used_memory_.fetch_sub(buf.size, std::memory_order_relaxed);
+      cached_bytes_ -= buf.size;
+      ++num_trimmed_;
+      lru_.pop_front();
+    }
+  }
+
   void ReleaseAll() {
     std::lock_guard<std::mutex> lock(mu_);
-    for (auto const& it : memory_pool_) {
-      auto const& pool = it.second;
-      for (auto const& buf : pool) {
-        DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
-      }
+    for (auto const& buf : lru_) {
+      DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
     }
-    memory_pool_.clear();
+    lru_.clear();
+    free_buffers_.clear();
+    cached_bytes_ = 0;
     used_memory_ = 0;
     DLOG(INFO) << "release all buffers";
   }
@@ -91,7 +180,16 @@ class PooledAllocator final : public Allocator {
  private:
   size_t page_size_;
   std::atomic<size_t> used_memory_;
-  std::unordered_map<size_t, std::vector<Buffer> > memory_pool_;
+  /*! \brief The cached buffers, least recently freed first. */
+  std::list<Buffer> lru_;
+  /*! \brief The cached buffers by size. */
+  std::multimap<size_t, std::list<Buffer>::iterator> free_buffers_;
+  size_t cached_bytes_{0};
+  size_t peak_bytes_{0};
+  size_t limit_bytes_{0};
+  uint64_t num_hits_{0};
+  uint64_t num_misses_{0};
+  uint64_t num_trimmed_{0};
   std::mutex mu_;
   Device device_;
 };
@@ -91,9 +91,11 @@ void VirtualMachineDebug::InvokePacked(Index packed_index, const PackedFunc& fun
     auto nd_array = Downcast<NDArray>(arg);
     auto dev = nd_array->device;
 
-    // get argument sizes
+    // get argument sizes, the last output_size arguments are the outputs
     std::vector<NDArray> shapes;
+    int64_t input_bytes = 0, output_bytes = 0;
     for (Index i = 0; i < arg_count; i++) {
+      size_t first = shapes.size();
       if (const auto* obj = args[i].as<ADTObj>()) {
         for (size_t fi = 0; fi < obj->size; ++fi) {
           auto o = (*obj)[fi];
@@ -102,6 +104,15 @@ void VirtualMachineDebug::InvokePacked(Index packed_index, const PackedFunc& fun
       } else {
         shapes.push_back(Downcast<NDArray>(args[i]));
       }
+      int64_t bytes = 0;
+      for (size_t j = first; j < shapes.size(); ++j) {
+        bytes += static_cast<int64_t>(GetDataSize(*shapes[j].operator->()));
+      }
+      if (i < arg_count - output_size) {
+        input_bytes += bytes;
+      } else {
+        output_bytes += bytes;
+      }
     }
 
     std::unordered_map<std::string, ObjectRef> metrics;
@@ -116,6 +127,17 @@ void VirtualMachineDebug::InvokePacked(Index packed_index, const PackedFunc& fun
       metrics["Hash"] = Downcast<String>((*it).second);
     }
     metrics["Argument Shapes"] = profiling::ShapeString(shapes);
+    // Calls are aggregated by argument shapes, so the counts histogram the shapes of each kernel
+    metrics["Count"] = ObjectRef(make_object<profiling::CountNode>(1));
+    metrics["Input Bytes"] = ObjectRef(make_object<profiling::CountNode>(input_bytes));
+    metrics["Output Bytes"] = ObjectRef(make_object<profiling::CountNode>(output_bytes));
+    metrics["Bytes Accessed"] =
+        ObjectRef(make_object<profiling::CountNode>(input_bytes + output_bytes));
+    auto flops = op_attrs.find("flops");
+    if (flops != op_attrs.end()) {
+      metrics["FLOPs"] = ObjectRef(make_object<profiling::CountNode>(
+          std::stoll(std::string(Downcast<String>((*flops).second)))));
+    }
 
     prof_.StartCall(packed_index_map_[packed_index], dev, metrics);
   }
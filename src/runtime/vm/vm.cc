@@ -27,10 +27,13 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/threading_backend.h>
 #include <tvm/runtime/vm/vm.h>
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -39,6 +42,15 @@
 
 using namespace tvm::runtime;
 
+#ifndef TVM_VM_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+/*! \brief Whether RunLoop dispatches through a table of labels instead of a switch. */
+#define TVM_VM_COMPUTED_GOTO 1
+#else
+#define TVM_VM_COMPUTED_GOTO 0
+#endif
+#endif
+
 namespace tvm {
 namespace runtime {
 namespace vm {
@@ -177,46 +189,165 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
     });
   } else if (name == "set_input") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-      ICHECK(exec_) << "The executable is not created yet.";
       std::string func_name = args[0];
-      auto gvit = exec_->global_map.find(func_name);
-      ICHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
-      auto func_index = gvit->second;
-      const auto& vm_func = exec_->functions[func_index];
-      const auto& param_names = vm_func.params;
-      ICHECK_EQ(args.size() - 1, param_names.size())
-          << "The number of provided parameters doesn't match the number of arguments";
-      ICHECK_EQ(param_names.size(), vm_func.params_device_type.size())
-          << "The number of provided parameters doesn't match the number of assigned devices";
-      std::vector<ObjectRef> func_args(param_names.size());
-      for (int i = 1; i < args.size(); ++i) {
-        Index device_type = vm_func.params_device_type[i - 1];
-        Device dev = GetDevice(device_type);
-
-        if (args[i].type_code() == kTVMDLTensorHandle) {
-          // Automatically convert input DLTensors to NDArray
-          DLTensor* tensor = args[i];
-          std::vector<int64_t> shape;
-          for (int64_t i = 0; i < tensor->ndim; i++) {
-            shape.push_back(tensor->shape[i]);
-          }
-          NDArray ary = NDArray::Empty(shape, tensor->dtype, dev);
-          ary.CopyFrom(tensor);
-          func_args[i - 1] = ary;
-        } else {
-          ObjectRef obj = CopyTo(args[i], dev);
-          func_args[i - 1] = obj;
-        }
-      }
+      std::vector<ObjectRef> func_args = this->ConvertInputs(func_name, args, 1);
       inputs_.erase(func_name);
       inputs_.emplace(func_name, func_args);
     });
+  } else if (name == "invoke_concurrent") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      *rv = this->InvokeConcurrent(func_name, this->ConvertInputs(func_name, args, 1));
+    });
+  } else if (name == "set_thread_pool_partition") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetThreadPoolPartition(args[0]);
+    });
+  } else if (name == "set_shape_buckets") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_GE(args.size(), 3);
+      std::vector<int64_t> buckets;
+      for (int i = 3; i < args.size(); ++i) {
+        buckets.push_back(args[i]);
+      }
+      this->SetShapeBuckets(args[0], args[1], args[2], std::move(buckets));
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc([sptr_to_self, name](TVMArgs args, TVMRetValue* rv) {});
   }
 }
 
+std::vector<ObjectRef> VirtualMachine::ConvertInputs(const std::string& func_name, TVMArgs args,
+                                                     int offset) {
+  ICHECK(exec_) << "The executable is not created yet.";
+  auto gvit = exec_->global_map.find(func_name);
+  ICHECK(gvit != exec_->global_map.end()) << "Cannot find function " << func_name;
+  auto func_index = gvit->second;
+  const auto& vm_func = exec_->functions[func_index];
+  const auto& param_names = vm_func.params;
+  ICHECK_EQ(args.size() - offset, param_names.size())
+      << "The number of provided parameters doesn't match the number of arguments";
+  ICHECK_EQ(param_names.size(), vm_func.params_device_type.size())
+      << "The number of provided parameters doesn't match the number of assigned devices";
+  std::vector<ObjectRef> func_args(param_names.size());
+  for (int i = offset; i < args.size(); ++i) {
+    Index device_type = vm_func.params_device_type[i - offset];
+    Device dev = GetDevice(device_type);
+
+    if (args[i].type_code() == kTVMDLTensorHandle) {
+      // Automatically convert input DLTensors to NDArray
+      DLTensor* tensor = args[i];
+      std::vector<int64_t> shape;
+      for (int64_t i = 0; i < tensor->ndim; i++) {
+        shape.push_back(tensor->shape[i]);
+      }
+      NDArray ary = NDArray::Empty(shape, tensor->dtype, dev);
+      ary.CopyFrom(tensor);
+      func_args[i - offset] = ary;
+    } else {
+      ObjectRef obj = CopyTo(args[i], dev);
+      func_args[i - offset] = obj;
+    }
+    func_args[i - offset] = PadToBucket(func_name, i - offset, func_args[i - offset]);
+  }
+  return func_args;
+}
+
+ObjectRef VirtualMachine::InvokeConcurrent(const std::string& func_name,
+                                           const std::vector<ObjectRef>& args) {
+  ObjectPtr<VirtualMachine> worker;
+  {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    if (!idle_workers_.empty()) {
+      worker = std::move(idle_workers_.back());
+      idle_workers_.pop_back();
+    } else {
+      worker = this->CreateWorker();
+    }
+  }
+  ObjectRef result = worker->Invoke(func_name, args);
+  // The worker keeps the result in its return register, it goes with the returned value
+  worker->return_register_ = ObjectRef();
+  std::lock_guard<std::mutex> lock(workers_mutex_);
+  idle_workers_.push_back(std::move(worker));
+  return result;
+}
+
+ObjectPtr<VirtualMachine> VirtualMachine::CreateWorker() {
+  ICHECK(exec_) << "The executable is not created yet.";
+  // Load every constant once, so that the workers share them and never write the pool
+  const_pool_.resize(exec_->constants.size());
+  for (size_t i = 0; i < exec_->constants.size(); ++i) {
+    if (!const_pool_[i].defined()) {
+      Device dev = GetDevice(exec_->const_device_type[i]);
+      const_pool_[i] = CopyTo(exec_->GetConstant(i), dev);
+    }
+  }
+  auto worker = make_object<VirtualMachine>();
+  worker->exec_ = exec_;
+  worker->packed_funcs_ = packed_funcs_;
+  worker->devices_ = devices_;
+  worker->allocators_ = allocators_;
+  worker->thread_pool_partition_ = thread_pool_partition_;
+  worker->const_pool_ = const_pool_;
+  return worker;
+}
+
+void VirtualMachine::SetShapeBuckets(const std::string& func_name, Index param_index, int axis,
+                                     std::vector<int64_t> buckets) {
+  ICHECK(exec_) << "The executable is not created yet.";
+  auto git = exec_->global_map.find(func_name);
+  ICHECK(git != exec_->global_map.end()) << "Cannot find function " << func_name;
+  ICHECK_LT(param_index, exec_->functions[git->second].params.size())
+      << "Function " << func_name << " has no parameter " << param_index;
+  ICHECK_GE(axis, 0);
+  if (buckets.empty()) {
+    shape_buckets_[func_name].erase(param_index);
+    return;
+  }
+  std::sort(buckets.begin(), buckets.end());
+  ICHECK_GT(buckets.front(), 0) << "Shape buckets must be positive";
+  shape_buckets_[func_name][param_index] = ShapeBuckets{axis, std::move(buckets)};
+}
+
+ObjectRef VirtualMachine::PadToBucket(const std::string& func_name, Index param_index,
+                                      const ObjectRef& arg) {
+  auto fit = shape_buckets_.find(func_name);
+  if (fit == shape_buckets_.end()) return arg;
+  auto bit = fit->second.find(param_index);
+  if (bit == fit->second.end()) return arg;
+  const ShapeBuckets& buckets = bit->second;
+  const auto* arr_node = arg.as<NDArray::ContainerType>();
+  ICHECK(arr_node != nullptr) << "Only tensor parameters can be padded to shape buckets";
+  NDArray arr = GetRef<NDArray>(arr_node);
+  ICHECK_LT(buckets.axis, arr->ndim) << "Cannot pad axis " << buckets.axis << " of a tensor of "
+                                     << arr->ndim << " dimensions";
+  int64_t dim = arr->shape[buckets.axis];
+  auto it = std::lower_bound(buckets.sizes.begin(), buckets.sizes.end(), dim);
+  if (it == buckets.sizes.end() || *it == dim) return arr;
+  std::vector<int64_t> shape(arr->shape, arr->shape + arr->ndim);
+  shape[buckets.axis] = *it;
+  // Pad on the host, the parameter is copied to its device afterwards
+  Device cpu_dev{kDLCPU, 0};
+  NDArray src = arr->device.device_type == kDLCPU ? arr : arr.CopyTo(cpu_dev);
+  ICHECK(src.IsContiguous()) << "Only contiguous tensors can be padded to shape buckets";
+  NDArray padded = NDArray::Empty(shape, arr->dtype, cpu_dev);
+  size_t row_bytes = (arr->dtype.bits * arr->dtype.lanes + 7) / 8;
+  int64_t num_rows = 1;
+  for (int i = 0; i < arr->ndim; ++i) {
+    if (i < buckets.axis) num_rows *= shape[i];
+    if (i > buckets.axis) row_bytes *= shape[i];
+  }
+  const char* src_data = static_cast<const char*>(src->data) + src->byte_offset;
+  char* dst_data = static_cast<char*>(padded->data);
+  std::memset(dst_data, 0, GetDataSize(*padded.operator->()));
+  for (int64_t r = 0; r < num_rows; ++r) {
+    std::memcpy(dst_data + r * *it * row_bytes, src_data + r * dim * row_bytes, dim * row_bytes);
+  }
+  return arr->device.device_type == kDLCPU ? padded : padded.CopyTo(arr->device);
+}
+
 inline Device VirtualMachine::GetDevice(Index device_type) const {
   ICHECK_GE(devices_.size(), device_type) << "devices_ doesn't contain device:" << device_type;
 
@@ -227,8 +358,15 @@ inline Device VirtualMachine::GetDevice(Index device_type) const {
 }
 
 void VirtualMachine::PushFrame(Index arg_count, Index ret_pc, const VMFunction& vm_func) {
-  auto frame = VMFrame(ret_pc, func_index_, arg_count, code_, vm_func.register_file_size);
-  frames_.push_back(frame);
+  frames_.emplace_back(ret_pc, func_index_, arg_count, code_, 0);
+  std::vector<ObjectRef>& register_file = frames_.back().register_file;
+  // Reuse the register file of a returned frame, its capacity is kept
+  if (!register_file_pool_.empty()) {
+    register_file.swap(register_file_pool_.back());
+    register_file_pool_.pop_back();
+  }
+  register_file.resize(vm_func.register_file_size);
+  registers_ = register_file.data();
 }
 
 Index VirtualMachine::PopFrame() {
@@ -238,7 +376,12 @@ Index VirtualMachine::PopFrame() {
   code_ = fr.code;
   pc_ = fr.pc;
   auto call_stack_size = frames_.size();
+  // Release the objects of the registers and keep their storage for the next frames
+  register_file_pool_.emplace_back();
+  register_file_pool_.back().swap(frames_.back().register_file);
+  register_file_pool_.back().clear();
   frames_.pop_back();
+  registers_ = frames_.empty() ? nullptr : frames_.back().register_file.data();
   return call_stack_size;
 }
 
@@ -257,6 +400,7 @@ void VirtualMachine::InvokeGlobal(const VMFunction& func, const std::vector<Obje
 
 ObjectRef VirtualMachine::Invoke(const VMFunction& func, const std::vector<ObjectRef>& args) {
   DLOG(INFO) << "Executing Function: " << std::endl << func;
+  threading::ThreadPoolPartitionScope partition(thread_pool_partition_);
 
   InvokeGlobal(func, args);
   RunLoop();
@@ -358,13 +502,9 @@ void VirtualMachine::Init(const std::vector<Device>& devs,
   }
 }
 
-inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) {
-  frames_.back().register_file[r] = val;
-}
+inline void VirtualMachine::WriteRegister(Index r, const ObjectRef& val) { registers_[r] = val; }
 
-inline ObjectRef VirtualMachine::ReadRegister(Index r) const {
-  return frames_.back().register_file[r];
-}
+inline const ObjectRef& VirtualMachine::ReadRegister(Index r) const { return registers_[r]; }
 
 inline int64_t VirtualMachine::LoadScalarInt(Index r) const {
   int64_t result = 0;
@@ -403,210 +543,238 @@ void VirtualMachine::RunLoop() {
   ICHECK(this->code_);
   pc_ = 0;
   Index frame_start = frames_.size();
+  const Instruction* instr;
+#if TVM_VM_COMPUTED_GOTO
+  // Each handler jumps to the next one, so that every handler has its own indirect branch.
+  // The table follows the order of Opcode.
+  static const void* const kDispatchTable[] = {
+      &&op_Move,         &&op_Ret,          &&op_Invoke,         &&op_InvokeClosure,
+      &&op_InvokePacked, &&op_AllocTensor,  &&op_AllocTensorReg, &&op_AllocADT,
+      &&op_AllocClosure, &&op_GetField,     &&op_If,             &&op_LoadConst,
+      &&op_Goto,         &&op_GetTag,       &&op_LoadConsti,     &&op_Fatal,
+      &&op_AllocStorage, &&op_ShapeOf,      &&op_ReshapeTensor,  &&op_DeviceCopy};
+  static constexpr size_t kNumOpcodes = sizeof(kDispatchTable) / sizeof(kDispatchTable[0]);
+  static_assert(kNumOpcodes == static_cast<size_t>(Opcode::DeviceCopy) + 1,
+                "The dispatch table must cover every opcode");
+#define VM_CASE(name) \
+  op_##name:          \
+  case Opcode::name
+#define VM_DISPATCH()                               \
+  do {                                              \
+    instr = &code_[pc_];                            \
+    size_t opcode = static_cast<size_t>(instr->op); \
+    if (opcode >= kNumOpcodes) goto main_loop;      \
+    goto* kDispatchTable[opcode];                   \
+  } while (0)
+#else
+#define VM_CASE(name) case Opcode::name
+#define VM_DISPATCH() goto main_loop
+#endif
   while (true) {
   main_loop:
-    auto const& instr = code_[this->pc_];
-    DLOG(INFO) << "Executing(" << pc_ << "): " << instr;
+    instr = &code_[this->pc_];
+    DLOG(INFO) << "Executing(" << pc_ << "): " << *instr;
 
-    switch (instr.op) {
-      case Opcode::Move: {
+    switch (instr->op) {
+      VM_CASE(Move): {
         ObjectRef from_obj;
-        from_obj = ReadRegister(instr.from);
-        WriteRegister(instr.dst, from_obj);
+        from_obj = ReadRegister(instr->from);
+        WriteRegister(instr->dst, from_obj);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::Fatal: {
+      VM_CASE(Fatal): {
         throw std::runtime_error("VM encountered fatal error");
       }
-      case Opcode::LoadConst: {
-        auto constant_obj = exec_->constants[instr.const_index];
+      VM_CASE(LoadConst): {
+        auto constant_obj = exec_->GetConstant(instr->const_index);
         // We cache the allocated object in the constant pool. To measure, the
         // first iteration will set the pool up. The other iterations will
         // directly reuse the allocated objects.
-        if (const_pool_.size() <= static_cast<size_t>(instr.const_index)) {
-          const_pool_.resize(instr.const_index + 1);
+        if (const_pool_.size() <= static_cast<size_t>(instr->const_index)) {
+          const_pool_.resize(instr->const_index + 1);
         }
 
-        if (!const_pool_[instr.const_index].defined()) {
-          Device dev = GetDevice(exec_->const_device_type[instr.const_index]);
-          const_pool_[instr.const_index] = CopyTo(constant_obj, dev);
+        if (!const_pool_[instr->const_index].defined()) {
+          Device dev = GetDevice(exec_->const_device_type[instr->const_index]);
+          const_pool_[instr->const_index] = CopyTo(constant_obj, dev);
         }
-        WriteRegister(instr.dst, const_pool_[instr.const_index]);
+        WriteRegister(instr->dst, const_pool_[instr->const_index]);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::LoadConsti: {
+      VM_CASE(LoadConsti): {
         auto tensor = NDArray::Empty({1}, {kDLInt, 64, 1}, {kDLCPU, 0});
-        reinterpret_cast<int64_t*>(tensor->data)[0] = instr.load_consti.val;
-        WriteRegister(instr.dst, tensor);
+        reinterpret_cast<int64_t*>(tensor->data)[0] = instr->load_consti.val;
+        WriteRegister(instr->dst, tensor);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::Invoke: {
+      VM_CASE(Invoke): {
         std::vector<ObjectRef> args;
-        for (Index i = 0; i < instr.num_args; ++i) {
-          args.push_back(ReadRegister(instr.invoke_args_registers[i]));
+        for (Index i = 0; i < instr->num_args; ++i) {
+          args.push_back(ReadRegister(instr->invoke_args_registers[i]));
         }
-        InvokeGlobal(exec_->functions[instr.func_index], args);
-        frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+        InvokeGlobal(exec_->functions[instr->func_index], args);
+        frames_.back().caller_return_register = instr->dst;
+        VM_DISPATCH();
       }
-      case Opcode::InvokePacked: {
-        DLOG(INFO) << "InvokedPacked " << instr.packed_index << " arity=" << instr.arity;
-        ICHECK_LE(instr.packed_index, packed_funcs_.size());
-        const auto& func = packed_funcs_[instr.packed_index];
-        const auto& arity = instr.arity;
+      VM_CASE(InvokePacked): {
+        DLOG(INFO) << "InvokedPacked " << instr->packed_index << " arity=" << instr->arity;
+        ICHECK_LE(instr->packed_index, packed_funcs_.size());
+        const auto& func = packed_funcs_[instr->packed_index];
+        const auto& arity = instr->arity;
         std::vector<ObjectRef> args;
         for (Index i = 0; i < arity; ++i) {
-          DLOG(INFO) << "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
+          DLOG(INFO) << "arg" << i << " $" << instr->packed_args[i];
+          auto arg = ReadRegister(instr->packed_args[i]);
           args.push_back(arg);
         }
 
         // We no longer need to write the registers back, we write directly
         // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        InvokePacked(instr->packed_index, func, arity, instr->output_size, args);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::InvokeClosure: {
-        auto object = ReadRegister(instr.closure);
+      VM_CASE(InvokeClosure): {
+        auto object = ReadRegister(instr->closure);
         const auto* closure = object.as<VMClosureObj>();
 
         std::vector<ObjectRef> args;
         for (auto free_var : closure->free_vars) {
           args.push_back(free_var);
         }
-        for (Index i = 0; i < instr.num_closure_args; ++i) {
-          args.push_back(ReadRegister(instr.closure_args[i]));
+        for (Index i = 0; i < instr->num_closure_args; ++i) {
+          args.push_back(ReadRegister(instr->closure_args[i]));
         }
         InvokeGlobal(exec_->functions[closure->func_index], args);
-        frames_.back().caller_return_register = instr.dst;
-        goto main_loop;
+        frames_.back().caller_return_register = instr->dst;
+        VM_DISPATCH();
       }
-      case Opcode::GetField: {
-        auto object = ReadRegister(instr.object);
+      VM_CASE(GetField): {
+        auto object = ReadRegister(instr->object);
         const auto& tuple = Downcast<ADT>(object);
-        auto field = tuple[instr.field_index];
-        WriteRegister(instr.dst, field);
+        auto field = tuple[instr->field_index];
+        WriteRegister(instr->dst, field);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::GetTag: {
-        auto object = ReadRegister(instr.get_tag.object);
+      VM_CASE(GetTag): {
+        auto object = ReadRegister(instr->get_tag.object);
         const auto& adt = Downcast<ADT>(object);
         auto tag = adt.tag();
         auto tag_tensor = NDArray::Empty({1}, {kDLInt, 32, 1}, {kDLCPU, 0});
         reinterpret_cast<int32_t*>(tag_tensor->data)[0] = tag;
-        WriteRegister(instr.dst, tag_tensor);
+        WriteRegister(instr->dst, tag_tensor);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::Goto: {
-        pc_ += instr.pc_offset;
-        goto main_loop;
+      VM_CASE(Goto): {
+        pc_ += instr->pc_offset;
+        VM_DISPATCH();
       }
-      case Opcode::If: {
-        int32_t test_val = LoadScalarInt(instr.if_op.test);
-        int32_t target_val = LoadScalarInt(instr.if_op.target);
+      VM_CASE(If): {
+        int32_t test_val = LoadScalarInt(instr->if_op.test);
+        int32_t target_val = LoadScalarInt(instr->if_op.target);
 
         if (test_val == target_val) {
-          ICHECK_NE(instr.if_op.true_offset, 0);
-          pc_ += instr.if_op.true_offset;
+          ICHECK_NE(instr->if_op.true_offset, 0);
+          pc_ += instr->if_op.true_offset;
         } else {
-          ICHECK_NE(instr.if_op.false_offset, 0);
-          pc_ += instr.if_op.false_offset;
+          ICHECK_NE(instr->if_op.false_offset, 0);
+          pc_ += instr->if_op.false_offset;
         }
 
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::AllocTensor: {
-        auto shape = std::vector<int64_t>(instr.alloc_tensor.ndim);
+      VM_CASE(AllocTensor): {
+        auto shape = std::vector<int64_t>(instr->alloc_tensor.ndim);
 
-        for (uint32_t i = 0; i < instr.alloc_tensor.ndim; ++i) {
-          shape[i] = instr.alloc_tensor.shape[i];
+        for (uint32_t i = 0; i < instr->alloc_tensor.ndim; ++i) {
+          shape[i] = instr->alloc_tensor.shape[i];
         }
 
-        auto storage_obj = ReadRegister(instr.alloc_tensor.storage);
-        auto offset = LoadScalarInt(instr.alloc_tensor.offset);
+        auto storage_obj = ReadRegister(instr->alloc_tensor.storage);
+        auto offset = LoadScalarInt(instr->alloc_tensor.offset);
         auto storage = Downcast<Storage>(storage_obj);
-        auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor.dtype);
+        auto obj = storage->AllocNDArray(offset, shape, instr->alloc_tensor.dtype);
 
-        WriteRegister(instr.dst, obj);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::AllocTensorReg: {
+      VM_CASE(AllocTensorReg): {
         Device cpu_dev = GetDevice(static_cast<Index>(kDLCPU));
-        auto shape_obj = ReadRegister(instr.alloc_tensor_reg.shape_register);
+        auto shape_obj = ReadRegister(instr->alloc_tensor_reg.shape_register);
         NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_dev));
         auto shape = ToShape(shape_tensor);
-        auto storage_obj = ReadRegister(instr.alloc_tensor_reg.storage);
+        auto storage_obj = ReadRegister(instr->alloc_tensor_reg.storage);
         auto storage = Downcast<Storage>(storage_obj);
-        auto offset = LoadScalarInt(instr.alloc_tensor.offset);
-        auto obj = storage->AllocNDArray(offset, shape, instr.alloc_tensor_reg.dtype);
+        auto offset = LoadScalarInt(instr->alloc_tensor.offset);
+        auto obj = storage->AllocNDArray(offset, shape, instr->alloc_tensor_reg.dtype);
 
-        WriteRegister(instr.dst, obj);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::AllocADT: {
+      VM_CASE(AllocADT): {
         std::vector<ObjectRef> fields;
-        for (Index i = 0; i < instr.num_fields; ++i) {
-          fields.push_back(ReadRegister(instr.datatype_fields[i]));
+        for (Index i = 0; i < instr->num_fields; ++i) {
+          fields.push_back(ReadRegister(instr->datatype_fields[i]));
         }
-        ObjectRef obj = ADT(instr.constructor_tag, fields);
-        WriteRegister(instr.dst, obj);
+        ObjectRef obj = ADT(instr->constructor_tag, fields);
+        WriteRegister(instr->dst, obj);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::AllocClosure: {
+      VM_CASE(AllocClosure): {
         std::vector<ObjectRef> free_vars;
-        for (Index i = 0; i < instr.num_freevar; i++) {
-          free_vars.push_back(ReadRegister(instr.free_vars[i]));
+        for (Index i = 0; i < instr->num_freevar; i++) {
+          free_vars.push_back(ReadRegister(instr->free_vars[i]));
         }
-        WriteRegister(instr.dst, VMClosure(instr.func_index, free_vars));
+        WriteRegister(instr->dst, VMClosure(instr->func_index, free_vars));
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::AllocStorage: {
-        auto size = LoadScalarInt(instr.alloc_storage.allocation_size);
-        auto alignment = instr.alloc_storage.alignment;
+      VM_CASE(AllocStorage): {
+        auto size = LoadScalarInt(instr->alloc_storage.allocation_size);
+        auto alignment = instr->alloc_storage.alignment;
 
         DLOG(INFO) << "AllocStorage: allocation_size=" << size << ", alignment=" << alignment
-                   << ", dtype_hint=" << DLDataType2String(instr.alloc_storage.dtype_hint)
-                   << ", device_type=" << instr.alloc_storage.device_type;
+                   << ", dtype_hint=" << DLDataType2String(instr->alloc_storage.dtype_hint)
+                   << ", device_type=" << instr->alloc_storage.device_type;
 
         auto storage_obj = SimpleObjAllocator().make_object<StorageObj>();
-        auto dev_type = instr.alloc_storage.device_type;
+        auto dev_type = instr->alloc_storage.device_type;
         ICHECK_LT(static_cast<size_t>(dev_type), allocators_.size())
             << "Memory allocator for device " << dev_type << " has not been initialized";
         auto* alloc = allocators_[dev_type];
         ICHECK(alloc) << "Did you forget to init the VirtualMachine with devices?";
-        storage_obj->buffer = alloc->Alloc(size, alignment, instr.alloc_storage.dtype_hint);
+        profiling::RecordAllocation(size);
+        storage_obj->buffer = alloc->Alloc(size, alignment, instr->alloc_storage.dtype_hint);
         Storage storage(storage_obj);
-        WriteRegister(instr.dst, storage);
+        WriteRegister(instr->dst, storage);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::ShapeOf: {
-        auto input = ReadRegister(instr.shape_of.tensor);
+      VM_CASE(ShapeOf): {
+        auto input = ReadRegister(instr->shape_of.tensor);
         NDArray input_array = Downcast<NDArray>(input);
         int ndim = input_array->ndim;
         auto out_tensor = NDArray::Empty({ndim}, {kDLInt, 64, 1}, {kDLCPU, 0});
         for (int i = 0; i < ndim; ++i) {
           reinterpret_cast<int64_t*>(out_tensor->data)[i] = input_array->shape[i];
         }
-        WriteRegister(instr.dst, out_tensor);
+        WriteRegister(instr->dst, out_tensor);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::Ret: {
+      VM_CASE(Ret): {
         // If we have hit the point from which we started
         // running, we should return to the caller breaking
         // the dispatch loop.
-        return_register_ = ReadRegister(instr.result);
+        return_register_ = ReadRegister(instr->result);
         auto caller_return_register = frames_.back().caller_return_register;
 
         if (PopFrame() == frame_start) {
@@ -614,15 +782,15 @@ void VirtualMachine::RunLoop() {
           // Otherwise we are just returning from a local call.
         } else {
           WriteRegister(caller_return_register, return_register_);
-          goto main_loop;
+          VM_DISPATCH();
         }
       }
-      case Opcode::ReshapeTensor: {
+      VM_CASE(ReshapeTensor): {
         Device cpu_dev = GetDevice(static_cast<Index>(kDLCPU));
-        auto tensor_obj = ReadRegister(instr.reshape_tensor.tensor);
+        auto tensor_obj = ReadRegister(instr->reshape_tensor.tensor);
         NDArray tensor_arr = Downcast<NDArray>(tensor_obj);
         // Read the shape from shape tensor
-        auto shape_obj = ReadRegister(instr.reshape_tensor.newshape);
+        auto shape_obj = ReadRegister(instr->reshape_tensor.newshape);
         NDArray shape_tensor = Downcast<NDArray>(CopyTo(shape_obj, cpu_dev));
         const DLTensor* dl_tensor = shape_tensor.operator->();
         ICHECK_EQ(dl_tensor->dtype.code, 0u);
@@ -632,29 +800,31 @@ void VirtualMachine::RunLoop() {
         std::vector<int64_t> shape(dims, dims + ndim);
         // Reshape the input tensor
         auto out_tensor = tensor_arr.CreateView(shape, tensor_arr->dtype);
-        WriteRegister(instr.dst, out_tensor);
+        WriteRegister(instr->dst, out_tensor);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
-      case Opcode::DeviceCopy: {
-        auto tensor_src = ReadRegister(instr.src);
+      VM_CASE(DeviceCopy): {
+        auto tensor_src = ReadRegister(instr->src);
         NDArray src_data = Downcast<NDArray>(tensor_src);
         Device src_dev = src_data->device;
-        ICHECK_EQ(static_cast<Index>(src_dev.device_type), instr.src_device_type);
+        ICHECK_EQ(static_cast<Index>(src_dev.device_type), instr->src_device_type);
 
         Device dst_dev;
-        dst_dev.device_type = static_cast<DLDeviceType>(instr.dst_device_type);
+        dst_dev.device_type = static_cast<DLDeviceType>(instr->dst_device_type);
         dst_dev.device_id = 0;
 
         NDArray dst_data = src_data.CopyTo(dst_dev);
-        WriteRegister(instr.dst, dst_data);
+        WriteRegister(instr->dst, dst_data);
         pc_++;
-        goto main_loop;
+        VM_DISPATCH();
       }
       default:
-        LOG(FATAL) << "Unknown instruction opcode: " << int(instr.op);
+        LOG(FATAL) << "Unknown instruction opcode: " << int(instr->op);
     }
   }
+#undef VM_CASE
+#undef VM_DISPATCH
 }
 
 runtime::Module CreateVirtualMachine(const Executable* exec) {
@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 
@@ -46,6 +47,12 @@ namespace vulkan {
 /*! \brief Maximum number of GPU supported in VulkanModule. */
 static constexpr const int kVulkanMaxNumDevice = 8;
 
+/*! \brief Maximum number of staging buffers of a device on a thread. */
+static constexpr const size_t kVulkanMaxNumStagingBuffers = 4;
+
+/*! \brief Maximum number of cached descriptor sets of a pipeline, in the deferred path. */
+static constexpr const uint32_t kVulkanMaxNumDescriptorSets = 64;
+
 /*! \brief TVM Vulkan binary pack magic number */
 static constexpr const int kVulkanModuleMagic = 0x02700027;
 
@@ -99,30 +106,60 @@ class VulkanThreadEntry {
 
     pool.reset();
     streams_.clear();
+    transfer_streams_.clear();
     for (const auto& kv : staging_buffers_) {
-      DeleteHostVisibleBuffer(kv.second.get());
+      for (const auto& entry : kv.second) {
+        DeleteHostVisibleBuffer(entry.buf.get());
+      }
     }
   }
 
   Device device;
   std::unique_ptr<WorkspacePool> pool;
   VulkanStream* Stream(size_t device_id);
+  VulkanTransferStream* TransferStream(size_t device_id);
+  // Get a staging buffer of at least size bytes, in use until the next synchronization
+  // of the stream of the device.
   VulkanStagingBuffer* StagingBuffer(int device_id, size_t size);
   void AllocateUniformBuffer(int device_id, size_t size);
   VulkanUniformBuffer* GetUniformBuffer(int device_id, size_t size);
 
  private:
+  // A staging buffer of the pool of a device.
+  struct StagingBufferEntry {
+    std::unique_ptr<VulkanStagingBuffer> buf;
+    // Whether the buffer was handed out, and the sync count of the stream at that time.
+    bool used{false};
+    uint64_t sync_count{0};
+  };
+
   std::unordered_map<size_t, std::unique_ptr<VulkanStream>> streams_;
-  std::unordered_map<size_t, std::unique_ptr<VulkanStagingBuffer>> staging_buffers_;
+  std::unordered_map<size_t, std::unique_ptr<VulkanTransferStream>> transfer_streams_;
+  std::unordered_map<size_t, std::vector<StagingBufferEntry>> staging_buffers_;
   std::unordered_map<size_t, std::unique_ptr<VulkanUniformBuffer>> uniform_buffers_;
 };
 
+// Hash of the buffers bound by a descriptor set.
+struct VulkanBufferListHash {
+  size_t operator()(const std::vector<VkBuffer>& buffers) const {
+    size_t hash = 0;
+    for (VkBuffer buffer : buffers) {
+      hash = hash * 31 + std::hash<VkBuffer>()(buffer);
+    }
+    return hash;
+  }
+};
+
 struct VulkanPipeline {
   VulkanContext* vctx_{nullptr};
   VkShaderModule shader{VK_NULL_HANDLE};
   VkDescriptorSetLayout descriptor_set_layout{VK_NULL_HANDLE};
   VkDescriptorPool descriptor_pool{VK_NULL_HANDLE};
-  VkDescriptorSet descriptor_set{VK_NULL_HANDLE};
+  // The descriptor sets of the deferred path allocated from the pool, by the buffers they bind.
+  std::unordered_map<std::vector<VkBuffer>, VkDescriptorSet, VulkanBufferListHash> descriptor_sets;
+  // The number of buffers freed on the device API when the descriptor sets were written.
+  uint64_t descriptor_sets_epoch{0};
+  std::mutex descriptor_sets_mutex;
   VkPipelineLayout pipeline_layout{VK_NULL_HANDLE};
   VkPipeline pipeline{VK_NULL_HANDLE};
   VkDescriptorUpdateTemplateKHR descriptor_update_template{VK_NULL_HANDLE};
@@ -159,9 +196,16 @@ VkBufferCreateInfo MakeBufferCreateInfo(const VulkanContext& vctx, size_t nbytes
   info.pNext = nullptr;
   info.flags = 0;
   info.size = nbytes;
-  info.queueFamilyIndexCount = 1;
-  info.pQueueFamilyIndices = &(vctx.queue_family_index);
-  info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  if (vctx.shared_queue_family_indices.empty()) {
+    info.queueFamilyIndexCount = 1;
+    info.pQueueFamilyIndices = &(vctx.queue_family_index);
+    info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+  } else {
+    // Shared by the compute and the transfer queue families, without ownership transfers.
+    info.queueFamilyIndexCount = static_cast<uint32_t>(vctx.shared_queue_family_indices.size());
+    info.pQueueFamilyIndices = vctx.shared_queue_family_indices.data();
+    info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+  }
   info.usage = usage;
   return info;
 }
@@ -241,6 +285,7 @@ class VulkanDeviceAPI final : public DeviceAPI {
   void SetDevice(Device dev) final { VulkanThreadEntry::ThreadLocal()->device = dev; }
   void GetAttr(Device dev, DeviceAttrKind kind, TVMRetValue* rv) final;
   std::vector<uint32_t> GetComputeQueueFamilies(VkPhysicalDevice phy_dev);
+  int GetTransferQueueFamily(VkPhysicalDevice phy_dev, uint32_t compute_queue_family);
   void* AllocDataSpace(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) final {
     if (nbytes == 0) {
       // Vulkan seems to have issues if we return nullptr on zero size alloc
@@ -262,8 +307,13 @@ class VulkanDeviceAPI final : public DeviceAPI {
     vkDestroyBuffer(vctx.device, pbuf->buffer, nullptr);
     vkFreeMemory(vctx.device, pbuf->memory, nullptr);
     delete pbuf;
+    // The handle may be reused by a new buffer, invalidating the cached descriptor sets.
+    num_freed_buffers_++;
   }
 
+  // The number of buffers freed so far.
+  uint64_t NumFreedBuffers() const { return num_freed_buffers_.load(); }
+
   Target GetDeviceDescription(VkInstance instance, VkPhysicalDevice dev,
                               const std::vector<const char*>& instance_extensions,
                               const std::vector<const char*>& device_extensions);
@@ -313,7 +363,7 @@ class VulkanDeviceAPI final : public DeviceAPI {
       auto* temp = VulkanThreadEntry::ThreadLocal()->StagingBuffer(dev_from.device_id, size);
       VulkanThreadEntry::ThreadLocal()
           ->Stream(dev_from.device_id)
-          ->Launch([&](VulkanStreamState* state) {
+          ->Launch([=](VulkanStreamState* state) {
             VkBufferCopy copy_info;
             copy_info.srcOffset = from_offset;
             copy_info.dstOffset = 0;
@@ -350,29 +400,48 @@ class VulkanDeviceAPI final : public DeviceAPI {
         VULKAN_CALL(vkFlushMappedMemoryRanges(vctx.device, 1, &mrange));
       }
 
-      VulkanThreadEntry::ThreadLocal()
-          ->Stream(dev_to.device_id)
-          ->Launch([&](VulkanStreamState* state) {
-            // 0: barrier(host->transfer)
-            VkMemoryBarrier barrier_info;
-            barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-            barrier_info.pNext = nullptr;
-            barrier_info.srcAccessMask = 0;
-            barrier_info.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_HOST_BIT,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
-                                 nullptr);
-            // 1: copy
-            VkBufferCopy copy_info;
-            copy_info.srcOffset = 0;
-            copy_info.dstOffset = to_offset;
-            copy_info.size = size;
-            vkCmdCopyBuffer(state->cmd_buffer_, temp->vk_buf->buffer, to_buf->buffer, 1,
-                            &copy_info);
-          });
-      // TODO(tulloch): should we instead make the staging buffer a property of the
-      // Stream? This would allow us to elide synchronizations here.
-      VulkanThreadEntry::ThreadLocal()->Stream(dev_to.device_id)->Synchronize();
+      VkBuffer staging_buffer = temp->vk_buf->buffer;
+      VkBuffer to_buffer = to_buf->buffer;
+      auto record_copy = [=](VkCommandBuffer cmd_buffer) {
+        VkBufferCopy copy_info;
+        copy_info.srcOffset = 0;
+        copy_info.dstOffset = to_offset;
+        copy_info.size = size;
+        vkCmdCopyBuffer(cmd_buffer, staging_buffer, to_buffer, 1, &copy_info);
+      };
+      // The staging buffer stays in use until the stream synchronizes, the copy needs no
+      // synchronization of its own.
+      VulkanStream* stream = VulkanThreadEntry::ThreadLocal()->Stream(dev_to.device_id);
+      if (vctx.UseTransferQueue() && !stream->HasPendingCommands()) {
+        // No recorded command may still access the buffer, the copy runs on the transfer queue
+        // while the kernels using it are recorded.
+        VulkanThreadEntry::ThreadLocal()
+            ->TransferStream(dev_to.device_id)
+            ->Submit(record_copy, stream);
+      } else {
+        stream->Launch([=](VulkanStreamState* state) {
+          // 0: barrier(host->transfer)
+          VkMemoryBarrier barrier_info;
+          barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+          barrier_info.pNext = nullptr;
+          barrier_info.srcAccessMask = 0;
+          barrier_info.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+          vkCmdPipelineBarrier(state->cmd_buffer_, VK_PIPELINE_STAGE_HOST_BIT,
+                               VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
+                               nullptr);
+          // 1: copy
+          record_copy(state->cmd_buffer_);
+          // 2: barrier(transfer-> compute|transfer)
+          barrier_info.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+          barrier_info.dstAccessMask =
+              (VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+               VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+          vkCmdPipelineBarrier(
+              state->cmd_buffer_, VK_PIPELINE_STAGE_TRANSFER_BIT,
+              VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+              &barrier_info, 0, nullptr, 0, nullptr);
+        });
+      }
     } else {
       LOG(FATAL) << "Expect copy from/to Vulkan or between Vulkan"
                  << ", from=" << from_dev_type << ", to=" << to_dev_type;
@@ -465,6 +534,7 @@ class VulkanDeviceAPI final : public DeviceAPI {
   VkInstance instance_{nullptr};
   // The physical devices, have 1 to 1 mapping to devices
   std::vector<VulkanContext> context_;
+  std::atomic<uint64_t> num_freed_buffers_{0};
 };
 
 Target VulkanDeviceAPI::GetDeviceDescription(VkInstance instance, VkPhysicalDevice dev,
@@ -507,6 +577,8 @@ Target VulkanDeviceAPI::GetDeviceDescription(VkInstance instance, VkPhysicalDevi
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES};
   VkPhysicalDeviceShaderFloat16Int8Features float16_int8 = {
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES};
+  VkPhysicalDeviceCooperativeMatrixFeaturesNV cooperative_matrix = {
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_COOPERATIVE_MATRIX_FEATURES_NV};
 
   // Set up linked list for feature query
   {
@@ -523,6 +595,10 @@ Target VulkanDeviceAPI::GetDeviceDescription(VkInstance instance, VkPhysicalDevi
       *pp_next = &float16_int8;
       pp_next = &float16_int8.pNext;
     }
+    if (has_extension("VK_NV_cooperative_matrix")) {
+      *pp_next = &cooperative_matrix;
+      pp_next = &cooperative_matrix.pNext;
+    }
   }
 
   if (has_extension("VK_KHR_get_physical_device_properties2")) {
@@ -617,6 +693,7 @@ Target VulkanDeviceAPI::GetDeviceDescription(VkInstance instance, VkPhysicalDevi
        Bool(has_extension("VK_KHR_storage_buffer_storage_class"))},
       {"supports_push_descriptor", Bool(supports_push_descriptor)},
       {"supports_dedicated_allocation", Bool(supports_dedicated_allocation)},
+      {"supports_cooperative_matrix", Bool(cooperative_matrix.cooperativeMatrix)},
       {"supported_subgroup_operations", Integer(supported_subgroup_operations)},
       // Physical device limits
       {"max_num_threads", Integer(properties.properties.limits.maxComputeWorkGroupInvocations)},
@@ -808,7 +885,7 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
     std::vector<uint32_t> queue_family_indexes = GetComputeQueueFamilies(phy_dev);
     if (queue_family_indexes.empty()) continue;
     uint32_t queue_family_index = queue_family_indexes[0];
-    float priority = 1.0f;
+    float priorities[2] = {1.0f, 1.0f};
 
     struct VkDeviceQueueCreateInfo queue_create_info;
     queue_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -816,7 +893,24 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
     queue_create_info.flags = 0;
     queue_create_info.queueFamilyIndex = queue_family_index;
     queue_create_info.queueCount = 1;
-    queue_create_info.pQueuePriorities = &priority;
+    queue_create_info.pQueuePriorities = priorities;
+
+    // The queue of the host to device copies, a second queue of the compute family
+    // if there is no transfer-only family.
+    int transfer_queue_family = GetTransferQueueFamily(phy_dev, queue_family_index);
+    {
+      const char* disable = std::getenv("TVM_VULKAN_DISABLE_TRANSFER_QUEUE");
+      if (disable && *disable) {
+        transfer_queue_family = -1;
+      }
+    }
+    std::vector<VkDeviceQueueCreateInfo> queue_create_infos = {queue_create_info};
+    if (transfer_queue_family == static_cast<int>(queue_family_index)) {
+      queue_create_infos[0].queueCount = 2;
+    } else if (transfer_queue_family >= 0) {
+      queue_create_infos.push_back(queue_create_info);
+      queue_create_infos[1].queueFamilyIndex = transfer_queue_family;
+    }
 
     VulkanContext ctx;
     // setup context
@@ -836,6 +930,7 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
           "VK_KHR_get_memory_requirements2",
           "VK_KHR_dedicated_allocation",
           "VK_KHR_spirv_1_4",
+          "VK_NV_cooperative_matrix",
       };
 
       uint32_t device_extension_prop_count;
@@ -860,6 +955,8 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
           VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES};
       VkPhysicalDeviceShaderFloat16Int8Features float16_int8 = {
           VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_FLOAT16_INT8_FEATURES};
+      VkPhysicalDeviceCooperativeMatrixFeaturesNV cooperative_matrix = {
+          VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_COOPERATIVE_MATRIX_FEATURES_NV};
 
       void** pp_next = &enabled_features.pNext;
       bool needs_float16_int8 = false;
@@ -892,6 +989,11 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
         *pp_next = &storage_16bit;
         pp_next = &storage_16bit.pNext;
       }
+      if (has_support("supports_cooperative_matrix")) {
+        cooperative_matrix.cooperativeMatrix = true;
+        *pp_next = &cooperative_matrix;
+        pp_next = &cooperative_matrix.pNext;
+      }
 
       if (needs_float16_int8) {
         *pp_next = &float16_int8;
@@ -902,8 +1004,8 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
       device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
       device_create_info.pNext = nullptr;
       device_create_info.flags = 0;
-      device_create_info.queueCreateInfoCount = 1;
-      device_create_info.pQueueCreateInfos = &queue_create_info;
+      device_create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
+      device_create_info.pQueueCreateInfos = queue_create_infos.data();
       device_create_info.enabledLayerCount = 0;
       device_create_info.ppEnabledLayerNames = nullptr;
       device_create_info.enabledExtensionCount = device_extensions.size();
@@ -922,6 +1024,18 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
     ctx.queue_mutex.reset(new std::mutex());
     vkGetDeviceQueue(ctx.device, queue_family_index, 0, &(ctx.queue));
     ctx.queue_family_index = queue_family_index;
+    if (transfer_queue_family >= 0) {
+      // The second queue of the family, if shared with the compute queue.
+      uint32_t transfer_queue_index =
+          transfer_queue_family == static_cast<int>(queue_family_index) ? 1 : 0;
+      ctx.transfer_queue_mutex.reset(new std::mutex());
+      vkGetDeviceQueue(ctx.device, transfer_queue_family, transfer_queue_index,
+                       &(ctx.transfer_queue));
+      ctx.transfer_queue_family_index = transfer_queue_family;
+      if (transfer_queue_family != static_cast<int>(queue_family_index)) {
+        ctx.shared_queue_family_indices = {queue_family_index, ctx.transfer_queue_family_index};
+      }
+    }
     // Find suitable memory type for staging and compute
     // Find suitable compute index.
     VkBuffer buffer;
@@ -1007,7 +1121,8 @@ VulkanDeviceAPI::VulkanDeviceAPI() {
   for (size_t i = 0; i < context_.size(); ++i) {
     LOG(INFO) << "vulkan(" << i << ")=\'" << context_[i].phy_device_prop.deviceName
               << "\' phy_dev_id=" << context_[i].phy_device
-              << " use_immediate=" << context_[i].UseImmediate();
+              << " use_immediate=" << context_[i].UseImmediate()
+              << " use_transfer_queue=" << context_[i].UseTransferQueue();
   }
 }
 
@@ -1036,6 +1151,28 @@ std::vector<uint32_t> VulkanDeviceAPI::GetComputeQueueFamilies(VkPhysicalDevice
   return result;
 }
 
+int VulkanDeviceAPI::GetTransferQueueFamily(VkPhysicalDevice phy_dev,
+                                            uint32_t compute_queue_family) {
+  uint32_t queue_prop_count = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(phy_dev, &queue_prop_count, nullptr);
+  std::vector<VkQueueFamilyProperties> queue_props(queue_prop_count);
+  vkGetPhysicalDeviceQueueFamilyProperties(phy_dev, &queue_prop_count, dmlc::BeginPtr(queue_props));
+
+  // Prefer the transfer-only queues, usually backed by a dedicated copy engine.
+  for (uint32_t i = 0; i != queue_prop_count; ++i) {
+    if ((VK_QUEUE_TRANSFER_BIT & queue_props[i].queueFlags) != 0 &&
+        (VK_QUEUE_COMPUTE_BIT & queue_props[i].queueFlags) == 0 &&
+        (VK_QUEUE_GRAPHICS_BIT & queue_props[i].queueFlags) == 0 && queue_props[i].queueCount > 0) {
+      return static_cast<int>(i);
+    }
+  }
+  // Otherwise, a second queue of the compute family.
+  if (queue_props[compute_queue_family].queueCount > 1) {
+    return static_cast<int>(compute_queue_family);
+  }
+  return -1;
+}
+
 // namespace vulkan
 class VulkanModuleNode;
 
@@ -1221,20 +1358,17 @@ class VulkanModuleNode final : public runtime::ModuleNode {
       VkDescriptorPoolCreateInfo descrip_pool_cinfo;
       descrip_pool_cinfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
       descrip_pool_cinfo.pNext = nullptr;
-      descrip_pool_cinfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
-      descrip_pool_cinfo.maxSets = 1;
+      // The pool holds the cached descriptor sets, it is reset as a whole once full.
+      descrip_pool_cinfo.flags = 0;
+      descrip_pool_cinfo.maxSets = kVulkanMaxNumDescriptorSets;
+      for (auto& psize : descriptor_set_pool_sizes) {
+        psize.descriptorCount *= kVulkanMaxNumDescriptorSets;
+      }
       descrip_pool_cinfo.poolSizeCount = descriptor_set_pool_sizes.size();
       descrip_pool_cinfo.pPoolSizes = descriptor_set_pool_sizes.data();
       VULKAN_CALL(vkCreateDescriptorPool(vctx.device, &descrip_pool_cinfo, nullptr,
                                          &(pe->descriptor_pool)));
-
-      VkDescriptorSetAllocateInfo alloc_info;
-      alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-      alloc_info.pNext = nullptr;
-      alloc_info.descriptorPool = pe->descriptor_pool;
-      alloc_info.descriptorSetCount = 1;
-      alloc_info.pSetLayouts = &(pe->descriptor_set_layout);
-      VULKAN_CALL(vkAllocateDescriptorSets(vctx.device, &alloc_info, &(pe->descriptor_set)));
+      pe->descriptor_sets_epoch = VulkanDeviceAPI::Global()->NumFreedBuffers();
     }
 
     VkPushConstantRange crange;
@@ -1345,6 +1479,14 @@ Module VulkanModuleCreate(std::unordered_map<std::string, VulkanShader> smap,
 
 VulkanThreadEntry* VulkanThreadEntry::ThreadLocal() { return VulkanThreadStore::Get(); }
 
+void AllocateHostVisibleBuffer(const VulkanContext& vctx, size_t size, VkBufferUsageFlags usage,
+                               uint32_t mem_type_index, VulkanHostVisibleBuffer* buf) {
+  buf->device = vctx.device;
+  buf->vk_buf = CreateBuffer(vctx, size, usage, mem_type_index);
+  VULKAN_CALL(vkMapMemory(vctx.device, buf->vk_buf->memory, 0, size, 0, &(buf->host_addr)));
+  buf->size = size;
+}
+
 VulkanHostVisibleBuffer* GetOrAllocate(
     int device_id, size_t size, VkBufferUsageFlags usage, uint32_t mem_type_index,
     std::unordered_map<size_t, std::unique_ptr<VulkanHostVisibleBuffer>>* buffers_ptr,
@@ -1370,13 +1512,8 @@ VulkanHostVisibleBuffer* GetOrAllocate(
 
   const auto& vctx = VulkanDeviceAPI::Global()->context(device_id);
 
-  if (buf.device == nullptr) {
-    buf.device = vctx.device;
-  }
   if (buf.host_addr == nullptr) {
-    buf.vk_buf = CreateBuffer(vctx, size, usage, mem_type_index);
-    VULKAN_CALL(vkMapMemory(vctx.device, buf.vk_buf->memory, 0, size, 0, &(buf.host_addr)));
-    buf.size = size;
+    AllocateHostVisibleBuffer(vctx, size, usage, mem_type_index, &buf);
   }
   return &buf;
 }
@@ -1384,7 +1521,43 @@ VulkanHostVisibleBuffer* GetOrAllocate(
 VulkanStagingBuffer* VulkanThreadEntry::StagingBuffer(int device_id, size_t size) {
   const auto& vctx = VulkanDeviceAPI::Global()->context(device_id);
   auto usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-  return GetOrAllocate(device_id, size, usage, vctx.staging_mtype_index, &staging_buffers_);
+  VulkanStream* stream = Stream(device_id);
+  auto& buffers = staging_buffers_[device_id];
+  auto is_free = [&](const StagingBufferEntry& entry) {
+    return !entry.used || entry.sync_count < stream->SyncCount();
+  };
+  if (buffers.size() == kVulkanMaxNumStagingBuffers &&
+      std::none_of(buffers.begin(), buffers.end(), is_free)) {
+    // All the buffers are used by the commands not yet submitted.
+    stream->Synchronize();
+  }
+
+  // The smallest free buffer large enough, else a new buffer, else the largest free buffer
+  // grows.
+  StagingBufferEntry* entry = nullptr;
+  for (auto& e : buffers) {
+    if (!is_free(e)) continue;
+    if (entry == nullptr) {
+      entry = &e;
+    } else if (e.buf->size >= size) {
+      if (entry->buf->size < size || e.buf->size < entry->buf->size) entry = &e;
+    } else if (entry->buf->size < size && e.buf->size > entry->buf->size) {
+      entry = &e;
+    }
+  }
+  if (entry == nullptr ||
+      (entry->buf->size < size && buffers.size() < kVulkanMaxNumStagingBuffers)) {
+    buffers.emplace_back();
+    entry = &buffers.back();
+    entry->buf = std::make_unique<VulkanStagingBuffer>();
+  }
+  if (entry->buf->size < size) {
+    DeleteHostVisibleBuffer(entry->buf.get());
+    AllocateHostVisibleBuffer(vctx, size, usage, vctx.staging_mtype_index, entry->buf.get());
+  }
+  entry->used = true;
+  entry->sync_count = stream->SyncCount();
+  return entry->buf.get();
 }
 
 void VulkanThreadEntry::AllocateUniformBuffer(int device_id, size_t size) {
@@ -1418,6 +1591,14 @@ VulkanStream* VulkanThreadEntry::Stream(size_t device_id) {
   return streams_[device_id].get();
 }
 
+VulkanTransferStream* VulkanThreadEntry::TransferStream(size_t device_id) {
+  if (!transfer_streams_[device_id]) {
+    transfer_streams_[device_id] = std::make_unique<VulkanTransferStream>(
+        &VulkanDeviceAPI::Global()->context(device_id));
+  }
+  return transfer_streams_[device_id].get();
+}
+
 void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
                                    const ArgUnion64* pack_args) const {
   int device_id = VulkanThreadEntry::ThreadLocal()->device.device_id;
@@ -1481,14 +1662,54 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
   }
 
   // Otherwise, the more expensive deferred path.
+  // Each set of bound buffers has its own descriptor set, written once, so that the kernels of a
+  // whole graph are recorded into a single submission whatever buffers they bind.
+  VulkanStream* stream = VulkanThreadEntry::ThreadLocal()->Stream(device_id);
+  std::vector<VkBuffer> buffers(descriptor_buffers.size());
+  for (size_t i = 0; i < descriptor_buffers.size(); ++i) {
+    buffers[i] = descriptor_buffers[i].buffer;
+  }
+  VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+  bool write_descriptor_set = false;
+  {
+    std::lock_guard<std::mutex> lock(pipeline->descriptor_sets_mutex);
+    uint64_t num_freed_buffers = VulkanDeviceAPI::Global()->NumFreedBuffers();
+    auto it = pipeline->descriptor_sets.find(buffers);
+    if (pipeline->descriptor_sets_epoch != num_freed_buffers ||
+        (it == pipeline->descriptor_sets.end() &&
+         pipeline->descriptor_sets.size() == kVulkanMaxNumDescriptorSets)) {
+      // Recycle the pool once the pending kernels binding its sets are done.
+      stream->Synchronize();
+      VULKAN_CALL(vkResetDescriptorPool(vctx.device, pipeline->descriptor_pool, 0));
+      pipeline->descriptor_sets.clear();
+      pipeline->descriptor_sets_epoch = num_freed_buffers;
+      it = pipeline->descriptor_sets.end();
+    }
+    if (it != pipeline->descriptor_sets.end()) {
+      descriptor_set = it->second;
+    } else {
+      VkDescriptorSetAllocateInfo alloc_info;
+      alloc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+      alloc_info.pNext = nullptr;
+      alloc_info.descriptorPool = pipeline->descriptor_pool;
+      alloc_info.descriptorSetCount = 1;
+      alloc_info.pSetLayouts = &(pipeline->descriptor_set_layout);
+      VULKAN_CALL(vkAllocateDescriptorSets(vctx.device, &alloc_info, &descriptor_set));
+      pipeline->descriptor_sets[buffers] = descriptor_set;
+      write_descriptor_set = true;
+    }
+  }
+
   std::vector<ArgUnion64> pack_args_storage(pack_args, pack_args + num_pack_args_);
-  const auto& deferred_initializer = [&vctx, pipeline, descriptor_buffers]() {
+  const auto& deferred_initializer = [&vctx, pipeline, descriptor_buffers, descriptor_set,
+                                      write_descriptor_set]() {
+    if (!write_descriptor_set) return;
     std::vector<VkWriteDescriptorSet> write_descriptor_sets;
     write_descriptor_sets.resize(descriptor_buffers.size());
     for (size_t i = 0; i < write_descriptor_sets.size(); i++) {
       write_descriptor_sets[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
       write_descriptor_sets[i].pNext = 0;
-      write_descriptor_sets[i].dstSet = pipeline->descriptor_set;
+      write_descriptor_sets[i].dstSet = descriptor_set;
       write_descriptor_sets[i].dstBinding = i;
       write_descriptor_sets[i].dstArrayElement = 0;
       write_descriptor_sets[i].descriptorCount = 1;
@@ -1506,12 +1727,11 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
     vkUpdateDescriptorSets(vctx.device, write_descriptor_sets.size(), write_descriptor_sets.data(),
                            0, 0);
   };
-  const auto& deferred_kernel = [this, pipeline, wl, pack_args_storage, nbytes_scalars,
-                                 device_id](VulkanStreamState* state) {
+  const auto& deferred_kernel = [this, pipeline, wl, pack_args_storage, nbytes_scalars, device_id,
+                                 descriptor_set](VulkanStreamState* state) {
     vkCmdBindPipeline(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->pipeline);
     vkCmdBindDescriptorSets(state->cmd_buffer_, VK_PIPELINE_BIND_POINT_COMPUTE,
-                            pipeline->pipeline_layout, 0, 1, &(pipeline->descriptor_set), 0,
-                            nullptr);
+                            pipeline->pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
 
     if (pipeline->use_ubo) {
       auto ubo = VulkanThreadEntry::ThreadLocal()->GetUniformBuffer(device_id, nbytes_scalars);
@@ -1534,13 +1754,9 @@ void VulkanWrappedFunc::operator()(TVMArgs args, TVMRetValue* rv,
                          1, &barrier_info, 0, nullptr, 0, nullptr);
   };
   VulkanStreamToken deferred_token;
-  deferred_token.descriptor_set_ = pipeline->descriptor_set;
-  deferred_token.buffers_.resize(descriptor_buffers.size());
-  for (size_t i = 0; i < descriptor_buffers.size(); ++i) {
-    deferred_token.buffers_[i] = descriptor_buffers[i].buffer;
-  }
-  VulkanThreadEntry::ThreadLocal()->Stream(device_id)->LaunchDeferred(
-      deferred_initializer, deferred_kernel, deferred_token);
+  deferred_token.descriptor_set_ = descriptor_set;
+  deferred_token.buffers_ = std::move(buffers);
+  stream->LaunchDeferred(deferred_initializer, deferred_kernel, deferred_token);
 }
 
 Module VulkanModuleLoadFile(const std::string& file_name, const std::string& format) {
@@ -157,7 +157,16 @@ struct VulkanContext {
   // Queue family index.
   VkQueueFamilyProperties queue_prop;
 
+  // The queue of the host to device copies, which run while the kernels are recorded.
+  // Null if the copies are recorded on the compute queue.
+  std::unique_ptr<std::mutex> transfer_queue_mutex;
+  VkQueue transfer_queue{nullptr};
+  uint32_t transfer_queue_family_index{0};
+  // The queue families sharing the buffers, if the transfer queue is of another family.
+  std::vector<uint32_t> shared_queue_family_indices;
+
   bool UseImmediate() const { return descriptor_template_khr_functions != nullptr; }
+  bool UseTransferQueue() const { return transfer_queue != nullptr; }
 };
 
 }  // namespace vulkan
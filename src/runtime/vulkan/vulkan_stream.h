@@ -84,6 +84,7 @@ class VulkanStream {
 
   // Launch the kernel on the current stream.
   void Launch(const std::function<void(VulkanStreamState*)>& kernel) {
+    has_pending_commands_ = true;
     if (vctx_->UseImmediate()) {
       kernel(state_.get());
     } else {
@@ -96,6 +97,7 @@ class VulkanStream {
                       const std::function<void(VulkanStreamState*)>& deferred_kernel,
                       const VulkanStreamToken& deferred_token) {
     ICHECK(!vctx_->UseImmediate());
+    has_pending_commands_ = true;
 
     // It is invalid to schedule this instance on the current stream if we already
     // have a matching descriptor set and a non-matching buffer set.
@@ -138,12 +140,16 @@ class VulkanStream {
     }
 
     VULKAN_CALL(vkEndCommandBuffer(state_->cmd_buffer_));
+    // The copies of the transfer queue complete before the commands read or overwrite them.
+    std::vector<VkPipelineStageFlags> wait_stages(
+        wait_semaphores_.size(),
+        VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
     VkSubmitInfo cb_submit;
     cb_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     cb_submit.pNext = nullptr;
-    cb_submit.waitSemaphoreCount = 0;
-    cb_submit.pWaitSemaphores = nullptr;
-    cb_submit.pWaitDstStageMask = 0;
+    cb_submit.waitSemaphoreCount = static_cast<uint32_t>(wait_semaphores_.size());
+    cb_submit.pWaitSemaphores = wait_semaphores_.data();
+    cb_submit.pWaitDstStageMask = wait_stages.data();
     cb_submit.commandBufferCount = 1;
     cb_submit.pCommandBuffers = &(state_->cmd_buffer_);
     cb_submit.signalSemaphoreCount = 0;
@@ -163,6 +169,9 @@ class VulkanStream {
     VULKAN_CHECK_ERROR(res);
     VULKAN_CALL(vkResetCommandBuffer(state_->cmd_buffer_, 0));
     VULKAN_CALL(vkResetFences(vctx_->device, 1, &(state_->fence_)));
+    wait_semaphores_.clear();
+    has_pending_commands_ = false;
+    ++sync_count_;
 
     // Re-initialize the command buffer
     VkCommandBufferBeginInfo cb_begin;
@@ -173,9 +182,23 @@ class VulkanStream {
     VULKAN_CALL(vkBeginCommandBuffer(state_->cmd_buffer_, &cb_begin));
   }
 
+  // Make the next submission of the stream wait on a semaphore of the transfer queue.
+  void WaitSemaphore(VkSemaphore semaphore) { wait_semaphores_.push_back(semaphore); }
+
+  // The number of synchronizations of the stream.  The commands recorded before the
+  // n-th synchronization have completed once the count is above n.
+  uint64_t SyncCount() const { return sync_count_; }
+
+  // Whether commands are recorded and not yet submitted.
+  bool HasPendingCommands() const { return has_pending_commands_; }
+
  private:
   const VulkanContext* vctx_;
   std::unique_ptr<VulkanStreamState> state_;
+  // The semaphores the next submission waits on.
+  std::vector<VkSemaphore> wait_semaphores_;
+  uint64_t sync_count_{0};
+  bool has_pending_commands_{false};
   // An index of deferred tokens, allowing us to efficiently detect duplicated
   // deferred_initializer blocks.
   std::unordered_map<VkDescriptorSet, std::vector<VulkanStreamToken>> deferred_tokens_;
@@ -183,6 +206,135 @@ class VulkanStream {
   VkCommandPool cmd_pool_;
 };
 
+/*!
+ * \brief The host to device copies on the transfer queue of a device.
+ *
+ * Each submission is a batch of copies, submitted as soon as it is recorded, which signals a
+ * semaphore the next submission of the compute stream waits on.  The copies then run while
+ * the kernels using them are recorded, rather than ahead of them in the compute queue.
+ */
+class VulkanTransferStream {
+ public:
+  explicit VulkanTransferStream(const VulkanContext* vctx) : vctx_(vctx) {
+    ICHECK(vctx_->UseTransferQueue());
+    VkCommandPoolCreateInfo cmd_pool_cinfo;
+    cmd_pool_cinfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    cmd_pool_cinfo.pNext = nullptr;
+    cmd_pool_cinfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    cmd_pool_cinfo.queueFamilyIndex = vctx_->transfer_queue_family_index;
+    VULKAN_CALL(vkCreateCommandPool(vctx_->device, &cmd_pool_cinfo, nullptr, &cmd_pool_));
+
+    VkCommandBufferAllocateInfo buffer_alloc_info;
+    buffer_alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    buffer_alloc_info.pNext = nullptr;
+    buffer_alloc_info.commandPool = cmd_pool_;
+    buffer_alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    buffer_alloc_info.commandBufferCount = 1;
+
+    VkFenceCreateInfo fence_cinfo;
+    fence_cinfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fence_cinfo.pNext = nullptr;
+    fence_cinfo.flags = 0;
+
+    VkSemaphoreCreateInfo semaphore_cinfo;
+    semaphore_cinfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_cinfo.pNext = nullptr;
+    semaphore_cinfo.flags = 0;
+
+    for (Slot& slot : slots_) {
+      VULKAN_CALL(vkAllocateCommandBuffers(vctx_->device, &buffer_alloc_info, &slot.cmd_buffer));
+      VULKAN_CALL(vkCreateFence(vctx_->device, &fence_cinfo, nullptr, &slot.fence));
+      VULKAN_CALL(vkCreateSemaphore(vctx_->device, &semaphore_cinfo, nullptr, &slot.semaphore));
+    }
+  }
+
+  ~VulkanTransferStream() {
+    for (Slot& slot : slots_) {
+      if (slot.pending) {
+        vkWaitForFences(vctx_->device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+      }
+      vkDestroySemaphore(vctx_->device, slot.semaphore, nullptr);
+      vkDestroyFence(vctx_->device, slot.fence, nullptr);
+    }
+    vkDestroyCommandPool(vctx_->device, cmd_pool_, nullptr);
+  }
+
+  /*!
+   * \brief Record and submit a batch of copies.
+   * \param record The function recording the copies into the command buffer.
+   * \param compute The compute stream, whose next submission waits on the copies.
+   */
+  void Submit(const std::function<void(VkCommandBuffer)>& record, VulkanStream* compute) {
+    Slot& slot = slots_[next_slot_];
+    next_slot_ = (next_slot_ + 1) % kNumSlots;
+    if (slot.pending) {
+      // The semaphore is signaled again only once the submission waiting on it completed.
+      if (compute->SyncCount() <= slot.wait_sync_count) {
+        compute->Synchronize();
+      }
+      VULKAN_CALL(vkWaitForFences(vctx_->device, 1, &slot.fence, VK_TRUE, UINT64_MAX));
+      VULKAN_CALL(vkResetFences(vctx_->device, 1, &slot.fence));
+      slot.pending = false;
+    }
+
+    VULKAN_CALL(vkResetCommandBuffer(slot.cmd_buffer, 0));
+    VkCommandBufferBeginInfo cb_begin;
+    cb_begin.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    cb_begin.pNext = nullptr;
+    cb_begin.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    cb_begin.pInheritanceInfo = 0;
+    VULKAN_CALL(vkBeginCommandBuffer(slot.cmd_buffer, &cb_begin));
+    // barrier(host|transfer->transfer), ordering the batch after the ones submitted before.
+    VkMemoryBarrier barrier_info;
+    barrier_info.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier_info.pNext = nullptr;
+    barrier_info.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier_info.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(slot.cmd_buffer,
+                         VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier_info, 0, nullptr, 0,
+                         nullptr);
+    record(slot.cmd_buffer);
+    VULKAN_CALL(vkEndCommandBuffer(slot.cmd_buffer));
+
+    VkSubmitInfo cb_submit;
+    cb_submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    cb_submit.pNext = nullptr;
+    cb_submit.waitSemaphoreCount = 0;
+    cb_submit.pWaitSemaphores = nullptr;
+    cb_submit.pWaitDstStageMask = 0;
+    cb_submit.commandBufferCount = 1;
+    cb_submit.pCommandBuffers = &slot.cmd_buffer;
+    cb_submit.signalSemaphoreCount = 1;
+    cb_submit.pSignalSemaphores = &slot.semaphore;
+    {
+      std::lock_guard<std::mutex> g(*(vctx_->transfer_queue_mutex));
+      VULKAN_CALL(vkQueueSubmit(vctx_->transfer_queue, 1, &cb_submit, slot.fence));
+    }
+    slot.pending = true;
+    compute->WaitSemaphore(slot.semaphore);
+    slot.wait_sync_count = compute->SyncCount();
+  }
+
+ private:
+  /*! \brief The number of batches in flight before the oldest one is waited on. */
+  static constexpr int kNumSlots = 4;
+  struct Slot {
+    VkCommandBuffer cmd_buffer{VK_NULL_HANDLE};
+    VkFence fence{VK_NULL_HANDLE};
+    VkSemaphore semaphore{VK_NULL_HANDLE};
+    // Whether the batch is submitted and its fence not yet waited on.
+    bool pending{false};
+    // The sync count of the compute stream whose submission waits on the semaphore.
+    uint64_t wait_sync_count{0};
+  };
+
+  const VulkanContext* vctx_;
+  VkCommandPool cmd_pool_;
+  Slot slots_[kNumSlots];
+  int next_slot_{0};
+};
+
 }  // namespace vulkan
 }  // namespace runtime
 }  // namespace tvm
@@ -23,114 +23,111 @@
  */
 #include "workspace_pool.h"
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace tvm {
 namespace runtime {
 
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
+// number of size classes per power of two pages.
+constexpr int kSizeClassSubBits = 2;
+// number of size classes, enough for any size_t.
+constexpr int kNumSizeClasses = 256;
 
 class WorkspacePool::Pool {
  public:
   // constructor
-  Pool() {
-    // safe guard header on each list.
-    Entry e;
-    e.data = nullptr;
-    e.size = 0;
-    free_list_.push_back(e);
-    allocated_.push_back(e);
-  }
+  Pool() {}
   // allocate from pool
   void* Alloc(Device dev, DeviceAPI* device, size_t nbytes) {
-    // Allocate align to page.
-    nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
-    if (nbytes == 0) nbytes = kWorkspacePageSize;
-    Entry e;
-    DLDataType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
-    if (free_list_.size() == 2) {
-      e = free_list_.back();
-      free_list_.pop_back();
-      if (e.size < nbytes) {
-        // resize the page
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
-      }
-    } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+    size_t pages = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize;
+    if (pages == 0) pages = 1;
+    int cls = SizeClass(pages);
+    void* data;
+    if (!free_list_[cls].empty()) {
+      // quick path, the most recently freed block of the class.
+      data = Pop(cls);
     } else {
-      if (free_list_.back().size >= nbytes) {
-        // find smallest fit
-        auto it = free_list_.end() - 2;
-        for (; it->size >= nbytes; --it) {
-        }
-        e = *(it + 1);
-        free_list_.erase(it + 1);
+      int larger = cls + 1;
+      int max_larger = std::min(cls + (1 << kSizeClassSubBits), kNumSizeClasses - 1);
+      while (larger <= max_larger && free_list_[larger].empty()) ++larger;
+      if (larger <= max_larger) {
+        // reuse a block at most twice as large.
+        data = Pop(larger);
+        cls = larger;
       } else {
-        // resize the page
-        e = free_list_.back();
-        free_list_.pop_back();
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+        // give back a cached block, the largest smaller one or else the
+        // smallest larger one, so that the pool never holds more blocks
+        // than were live at its peak.
+        int victim = cls - 1;
+        while (victim >= 0 && free_list_[victim].empty()) --victim;
+        if (victim < 0) {
+          victim = max_larger + 1;
+          while (victim < kNumSizeClasses && free_list_[victim].empty()) ++victim;
+        }
+        if (victim >= 0 && victim < kNumSizeClasses) device->FreeDataSpace(dev, Pop(victim));
+        DLDataType type;
+        type.code = kDLUInt;
+        type.bits = 8;
+        type.lanes = 1;
+        data = device->AllocDataSpace(dev, ClassPages(cls) * kWorkspacePageSize,
+                                      kTempAllocaAlignment, type);
       }
     }
-    allocated_.push_back(e);
-    return e.data;
+    allocated_[data] = cls;
+    return data;
   }
   // free resource back to pool
   void Free(void* data) {
-    Entry e;
-    if (allocated_.back().data == data) {
-      // quick path, last allocated.
-      e = allocated_.back();
-      allocated_.pop_back();
-    } else {
-      int index = static_cast<int>(allocated_.size()) - 2;
-      for (; index > 0 && allocated_[index].data != data; --index) {
-      }
-      ICHECK_GT(index, 0) << "trying to free things that has not been allocated";
-      e = allocated_[index];
-      allocated_.erase(allocated_.begin() + index);
-    }
-    if (free_list_.back().size < e.size) {
-      free_list_.push_back(e);
-    } else if (free_list_.size() == 2) {
-      free_list_.push_back(free_list_.back());
-      free_list_[1] = e;
-    } else {
-      size_t i = free_list_.size() - 1;
-      free_list_.resize(free_list_.size() + 1);
-      for (; e.size < free_list_[i].size; --i) {
-        free_list_[i + 1] = free_list_[i];
-      }
-      free_list_[i + 1] = e;
-    }
+    auto it = allocated_.find(data);
+    ICHECK(it != allocated_.end()) << "trying to free things that has not been allocated";
+    int cls = it->second;
+    allocated_.erase(it);
+    free_list_[cls].push_back(data);
   }
   // Release all resources
   void Release(Device dev, DeviceAPI* device) {
-    for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(dev, free_list_[i].data);
+    for (std::vector<void*>& blocks : free_list_) {
+      for (void* data : blocks) device->FreeDataSpace(dev, data);
+      blocks.clear();
     }
-    free_list_.clear();
   }
 
  private:
-  /*! \brief a single entry in the pool */
-  struct Entry {
-    void* data;
-    size_t size;
-  };
-  /*! \brief List of free items, sorted from small to big size */
-  std::vector<Entry> free_list_;
-  /*! \brief List of allocated items */
-  std::vector<Entry> allocated_;
+  /*!
+   * \brief The size class of an allocation of the given number of pages.
+   *  The first classes are 1 to 4 pages, after which every power of two is
+   *  split into 4 classes, so that rounding wastes at most 25% of a block.
+   */
+  static int SizeClass(size_t pages) {
+    if (pages <= (1 << kSizeClassSubBits)) return static_cast<int>(pages) - 1;
+    int shift = 0;
+    while ((pages - 1) >> (shift + kSizeClassSubBits + 1)) ++shift;
+    int sub = static_cast<int>((pages - 1) >> shift) - (1 << kSizeClassSubBits);
+    return (1 << kSizeClassSubBits) * (shift + 1) + sub;
+  }
+  /*! \brief The number of pages of the blocks of a size class. */
+  static size_t ClassPages(int cls) {
+    if (cls < (1 << kSizeClassSubBits)) return cls + 1;
+    int shift = cls / (1 << kSizeClassSubBits) - 1;
+    size_t sub = cls % (1 << kSizeClassSubBits) + (1 << kSizeClassSubBits);
+    return (sub + 1) << shift;
+  }
+  void* Pop(int cls) {
+    std::vector<void*>& blocks = free_list_[cls];
+    void* data = blocks.back();
+    blocks.pop_back();
+    return data;
+  }
+  /*! \brief Free blocks of each size class, most recently freed last */
+  std::array<std::vector<void*>, kNumSizeClasses> free_list_;
+  /*! \brief The size class of each allocated block */
+  std::unordered_map<void*, int> allocated_;
 };
 
 WorkspacePool::WorkspacePool(DLDeviceType device_type, DeviceAPI* device)
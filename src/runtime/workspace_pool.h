@@ -41,6 +41,10 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  Blocks are rounded up to size classes and cached in a free list per
+ *  class, so that allocation and free take constant time. A pool is not
+ *  thread safe, each thread uses its own.
  */
 class TVM_DLL WorkspacePool {
  public:
@@ -24,8 +24,10 @@
 
 #include "codegen_cpu.h"
 
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/tir/analysis.h>
+#include <tvm/tir/stmt_functor.h>
 
 #include <algorithm>
 #include <memory>
@@ -526,6 +528,13 @@ void CodeGenCPU::CreateParallelLaunch(const Stmt& body, int num_task) {
   Array<Var> vfields = tir::UndefinedVars(body, {});
   uint64_t nbytes;
   llvm::Value* cdata = PackClosureData(vfields, &nbytes);
+  // The tasks of a launch with a barrier must not be scheduled dynamically.
+  bool has_barrier = false;
+  tir::PostOrderVisit(body, [&has_barrier](const ObjectRef& node) {
+    const auto* attr = node.as<AttrStmtNode>();
+    if (attr && attr->attr_key == "pragma_parallel_barrier_when_finish") has_barrier = true;
+  });
+  if (has_barrier) num_task |= TVM_PARALLEL_LAUNCH_SYNC;
 #if TVM_LLVM_VERSION >= 90
   auto launch_callee = llvm::FunctionCallee(ftype_tvm_parallel_launch_, RuntimeTVMParallelLaunch());
 #else
@@ -731,6 +740,44 @@ llvm::Value* CodeGenCPU::CreateCallPacked(const CallNode* op) {
   return rvalue;
 }
 
+llvm::Value* CodeGenCPU::CreateCallCPacked(const CallNode* op) {
+  ICHECK_EQ(op->args.size(), 5U);
+  std::string func_name = op->args[0].as<StringImmNode>()->value;
+  int64_t begin = op->args[3].as<IntImmNode>()->value;
+  int64_t end = op->args[4].as<IntImmNode>()->value;
+  // The callee is called by its symbol, declared when it is defined in another module.
+  llvm::Function* callee = module_->getFunction(func_name);
+  if (callee == nullptr) {
+    llvm::FunctionType* ftype = llvm::FunctionType::get(
+        t_int_, {t_void_p_, t_void_p_, t_int_, t_void_p_, t_void_p_, t_void_p_}, false);
+    callee = llvm::Function::Create(ftype, llvm::Function::ExternalLinkage, func_name,
+                                    module_.get());
+  }
+  llvm::FunctionType* ftype = callee->getFunctionType();
+  ICHECK_EQ(ftype->getNumParams(), 6U) << func_name << " does not have a packed signature";
+  llvm::Value* stack_value = MakeValue(op->args[1]);
+  llvm::Value* stack_tcode = MakeValue(op->args[2]);
+  llvm::Value* arg_value = builder_->CreateInBoundsGEP(
+      builder_->CreatePointerCast(stack_value, t_tvm_value_->getPointerTo()), ConstInt32(begin));
+  llvm::Value* arg_tcode = CreateBufferPtr(DataType::Int(32), stack_tcode, ConstInt32(begin));
+  llvm::Value* ret_value = builder_->CreateInBoundsGEP(
+      builder_->CreatePointerCast(stack_value, t_tvm_value_->getPointerTo()), ConstInt32(end));
+  llvm::Value* ret_tcode = CreateBufferPtr(DataType::Int(32), stack_tcode, ConstInt32(end));
+  std::vector<llvm::Value*> call_args = {arg_value,
+                                         arg_tcode,
+                                         ConstInt32(end - begin),
+                                         ret_value,
+                                         ret_tcode,
+                                         llvm::Constant::getNullValue(t_void_p_)};
+  for (size_t i = 0; i < call_args.size(); ++i) {
+    llvm::Type* type = ftype->getParamType(i);
+    if (type->isPointerTy()) call_args[i] = builder_->CreatePointerCast(call_args[i], type);
+  }
+  llvm::Value* retcode = builder_->CreateCall(callee, call_args);
+  CheckCallSuccess(retcode);
+  return retcode;
+}
+
 llvm::Value* CodeGenCPU::CreateCallTracePacked(const CallNode* op) {
   using llvm::BasicBlock;
   ICHECK_EQ(op->args.size(), 6U);
@@ -855,6 +902,8 @@ void CodeGenCPU::AddStartupFunction() {
 llvm::Value* CodeGenCPU::CreateIntrinsic(const CallNode* op) {
   if (op->op.same_as(builtin::tvm_call_packed_lowered())) {
     return CreateCallPacked(op);
+  } else if (op->op.same_as(builtin::tvm_call_cpacked_lowered())) {
+    return CreateCallCPacked(op);
   } else if (op->op.same_as(builtin::tvm_call_trace_packed_lowered())) {
     return CreateCallTracePacked(op);
   } else if (op->op.same_as(builtin::tvm_static_handle())) {
@@ -115,6 +115,8 @@ class CodeGenCPU : public CodeGenLLVM {
                                    const int64_t begin, const int64_t end);
   // create call into tvm packed function.
   llvm::Value* CreateCallPacked(const CallNode* op);
+  // create direct call into a packed function of the module.
+  llvm::Value* CreateCallCPacked(const CallNode* op);
   // Create trace call into tvm packed function.
   llvm::Value* CreateCallTracePacked(const CallNode* op);
   // Create static initialization
@@ -77,6 +77,18 @@ void CodeGenLLVM::Init(const std::string& module_name, llvm::TargetMachine* tm,
   this->InitTarget(tm);
 }
 
+void CodeGenLLVM::SetOptimizeOptions(const Target& target) {
+  opt_level_ = target->GetAttr<Integer>("opt-level").value_or(Integer(3))->value;
+  ICHECK(opt_level_ >= 0 && opt_level_ <= 3) << "opt-level must be in [0, 3], got " << opt_level_;
+  loop_vectorize_ = target->GetAttr<Bool>("loop-vectorize").value_or(Bool(true));
+  slp_vectorize_ = target->GetAttr<Bool>("slp-vectorize").value_or(Bool(true));
+  unroll_loops_ = target->GetAttr<Bool>("unroll-loops").value_or(Bool(true));
+  profile_generate_ = target->GetAttr<String>("profile-generate").value_or("");
+  profile_use_ = target->GetAttr<String>("profile-use").value_or("");
+  ICHECK(profile_generate_.empty() || profile_use_.empty())
+      << "profile-generate and profile-use are exclusive";
+}
+
 void CodeGenLLVM::InitTarget(llvm::TargetMachine* tm) {
   module_->setTargetTriple(tm->getTargetTriple().str());
   module_->setDataLayout(tm->createDataLayout());
@@ -91,6 +103,9 @@ void CodeGenLLVM::InitTarget(llvm::TargetMachine* tm) {
       native_vector_bits_ = 256;
     } else if (arch == llvm::Triple::arm || arch == llvm::Triple::aarch64) {
       native_vector_bits_ = 128;
+    } else if (arch == llvm::Triple::wasm32 || arch == llvm::Triple::wasm64) {
+      // for simd128
+      native_vector_bits_ = 128;
     } else {
       native_vector_bits_ = 128;
       std::string arch_name = std::string(tm->getTargetTriple().getArchName());
@@ -252,12 +267,27 @@ void CodeGenLLVM::LinkParameters(const Map<String, LinkedParam> params) {
                         builder_->CreateInBoundsGEP(ret_types_array, zero_array_index_list));
   builder_->CreateRet(ConstInt32(kTvmErrorNoError));
 
-  // Add data to the global section.
+  // Add data to the global section. When the byte order of the target is the one of the host,
+  // the params are copied as raw bytes into a section of their own, the generation of their
+  // constants element by element is slow for large models.
+  bool raw_params = data_layout_->isLittleEndian() == llvm::sys::IsLittleEndianHost;
+  const llvm::Triple& triple = target_machine_->getTargetTriple();
   for (auto kv : params) {
-    auto array = NDArrayToLLVMArray(ctx_, kv.second->param);
+    llvm::Constant* array = raw_params ? NDArrayToLLVMRawArray(ctx_, kv.second->param)
+                                       : NDArrayToLLVMArray(ctx_, kv.second->param);
     std::string symbol_name = std::string(::tvm::runtime::symbol::tvm_param_prefix) + kv.first;
     llvm::GlobalVariable* param_symbol = new llvm::GlobalVariable(
         *module_, array->getType(), true, llvm::GlobalValue::InternalLinkage, array, symbol_name);
+    if (raw_params) {
+#if TVM_LLVM_VERSION >= 100
+      param_symbol->setAlignment(llvm::Align(::tvm::runtime::kAllocAlignment));
+#else
+      param_symbol->setAlignment(::tvm::runtime::kAllocAlignment);
+#endif
+      if (triple.isOSBinFormatELF()) {
+        param_symbol->setSection(".rodata.tvm_params");
+      }
+    }
 
     llvm::BasicBlock* case_block = llvm::BasicBlock::Create(*ctx_, "case_" + symbol_name, function);
     switch_inst->addCase(
@@ -361,15 +391,30 @@ void CodeGenLLVM::Optimize() {
 
   // place optimization pass
   llvm::PassManagerBuilder builder;
-  builder.OptLevel = 3;
+  builder.OptLevel = opt_level_;
 
 #if TVM_LLVM_VERSION >= 50
   builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0, false);
 #else
   builder.Inliner = llvm::createFunctionInliningPass(builder.OptLevel, 0);
 #endif
-  builder.LoopVectorize = true;
-  builder.SLPVectorize = true;
+  builder.LoopVectorize = loop_vectorize_;
+  builder.SLPVectorize = slp_vectorize_;
+  builder.DisableUnrollLoops = !unroll_loops_;
+#if TVM_LLVM_VERSION >= 40
+  // The instrumented code writes the profile at exit, merged by llvm-profdata for profile-use.
+  // The library then links the profile runtime, e.g. by -fprofile-generate to clang.
+  if (!profile_generate_.empty()) {
+    builder.EnablePGOInstrGen = true;
+    builder.PGOInstrGen = profile_generate_;
+  }
+  if (!profile_use_.empty()) {
+    builder.PGOInstrUse = profile_use_;
+  }
+#else
+  ICHECK(profile_generate_.empty() && profile_use_.empty())
+      << "Profile guided optimization requires LLVM 4.0 or later";
+#endif
   this->InitPassManagerBuilder(&builder);
 
 #if TVM_LLVM_VERSION >= 50
@@ -661,7 +706,7 @@ llvm::Value* CodeGenLLVM::CreateVecConcat(std::vector<llvm::Value*> vecs) {
 }
 
 void CodeGenLLVM::CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                                  const Var& loop_var, const Stmt& body) {
+                                  const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md) {
   using llvm::BasicBlock;
   BasicBlock* pre_block = builder_->GetInsertBlock();
   BasicBlock* for_begin = BasicBlock::Create(*ctx_, "for_begin", function_);
@@ -680,10 +725,29 @@ void CodeGenLLVM::CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Va
   var_map_.erase(loop_var.get());
   llvm::Value* loop_next = CreateAdd(loop_var.dtype(), loop_value, stride);
   loop_value->addIncoming(loop_next, builder_->GetInsertBlock());
-  builder_->CreateBr(for_begin);
+  llvm::BranchInst* latch = builder_->CreateBr(for_begin);
+  if (loop_md != nullptr) {
+    latch->setMetadata(llvm::LLVMContext::MD_loop, loop_md);
+  }
   builder_->SetInsertPoint(for_end);
 }
 
+llvm::MDNode* CodeGenLLVM::GetScalableVectorizeLoopMD() {
+  // The loop metadata is distinct, with itself as its first operand.
+  std::vector<llvm::Metadata*> ops{nullptr};
+  ops.push_back(llvm::MDNode::get(
+      *ctx_, {llvm::MDString::get(*ctx_, "llvm.loop.vectorize.enable"),
+              llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(*ctx_))}));
+#if TVM_LLVM_VERSION >= 120
+  ops.push_back(llvm::MDNode::get(
+      *ctx_, {llvm::MDString::get(*ctx_, "llvm.loop.vectorize.scalable.enable"),
+              llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(*ctx_))}));
+#endif
+  llvm::MDNode* loop_md = llvm::MDNode::getDistinct(*ctx_, ops);
+  loop_md->replaceOperandWith(0, loop_md);
+  return loop_md;
+}
+
 // cast operatpr
 llvm::Value* CodeGenLLVM::CreateCast(DataType from, DataType to, llvm::Value* value) {
   llvm::Type* target = DTypeToLLVMType(to);
@@ -1146,6 +1210,9 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
   DataType t = op->dtype;
   bool is_volatile = volatile_buf_.count(op->buffer_var.get());
   llvm::Value* buffer = MakeValue(op->buffer_var);
+  if (!is_one(op->predicate)) {
+    return CreatePredicatedLoad(op, buffer);
+  }
   llvm::Value* index = MakeValue(op->index);
 
   if (t.lanes() == 1) {
@@ -1197,6 +1264,107 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const LoadNode* op) {
   return ret;
 }
 
+llvm::Value* CodeGenLLVM::CreatePredicatedLoad(const LoadNode* op, llvm::Value* buffer) {
+  DataType t = op->dtype;
+  llvm::Type* type = DTypeToLLVMType(t);
+  llvm::Value* mask = MakeValue(op->predicate);
+  ICHECK_EQ(op->predicate.dtype().lanes(), t.lanes());
+  // The disabled lanes are undefined.
+  llvm::Value* ret = llvm::UndefValue::get(type);
+  const RampNode* ramp = op->index.as<RampNode>();
+  if (t.lanes() != 1 && ramp && is_one(ramp->stride)) {
+    int alignment, native_bits;
+    GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
+    unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
+    llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, MakeValue(ramp->base));
+    ptr = builder_->CreatePointerCast(ptr, type->getPointerTo(addrspace));
+#if TVM_LLVM_VERSION >= 110
+    llvm::CallInst* load = builder_->CreateMaskedLoad(ptr, llvm::Align(alignment), mask, ret);
+#else
+    llvm::CallInst* load = builder_->CreateMaskedLoad(ptr, alignment, mask, ret);
+#endif
+    AddAliasInfo(load, op->buffer_var.get(), op->index);
+    return load;
+  }
+  // Load the enabled lanes one by one.
+  int basic_align = t.bits() / 8;
+  auto f = [&](int i, llvm::Value* index) {
+    llvm::Value* enabled = t.lanes() == 1 ? mask : builder_->CreateExtractElement(mask, i);
+    llvm::BasicBlock* entry_block = builder_->GetInsertBlock();
+    llvm::BasicBlock* then_block = llvm::BasicBlock::Create(*ctx_, "load_lane", function_);
+    llvm::BasicBlock* end_block = llvm::BasicBlock::Create(*ctx_, "load_lane_end", function_);
+    builder_->CreateCondBr(enabled, then_block, end_block);
+    builder_->SetInsertPoint(then_block);
+    llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, index);
+#if TVM_LLVM_VERSION >= 110
+    llvm::LoadInst* load = builder_->CreateAlignedLoad(ptr, llvm::Align(basic_align));
+#else
+    llvm::LoadInst* load = builder_->CreateAlignedLoad(ptr, basic_align);
+#endif
+    AddAliasInfo(load, op->buffer_var.get(), PrimExpr());
+    llvm::Value* loaded =
+        t.lanes() == 1 ? load : builder_->CreateInsertElement(ret, load, ConstInt32(i));
+    builder_->CreateBr(end_block);
+    builder_->SetInsertPoint(end_block);
+    llvm::PHINode* phi = builder_->CreatePHI(type, 2);
+    phi->addIncoming(ret, entry_block);
+    phi->addIncoming(loaded, then_block);
+    ret = phi;
+  };
+  if (t.lanes() == 1) {
+    f(0, MakeValue(op->index));
+  } else {
+    this->Scalarize(op->index, f);
+  }
+  return ret;
+}
+
+void CodeGenLLVM::CreatePredicatedStore(const StoreNode* op, llvm::Value* buffer,
+                                        llvm::Value* value) {
+  DataType t = op->value.dtype();
+  llvm::Value* mask = MakeValue(op->predicate);
+  ICHECK_EQ(op->predicate.dtype().lanes(), t.lanes());
+  const RampNode* ramp = op->index.as<RampNode>();
+  if (t.lanes() != 1 && ramp && is_one(ramp->stride)) {
+    int alignment, native_bits;
+    GetAlignment(t, op->buffer_var.get(), ramp->base, &alignment, &native_bits);
+    unsigned addrspace = llvm::dyn_cast<llvm::PointerType>(buffer->getType())->getAddressSpace();
+    llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, MakeValue(ramp->base));
+    ptr = builder_->CreatePointerCast(ptr, DTypeToLLVMType(t)->getPointerTo(addrspace));
+#if TVM_LLVM_VERSION >= 110
+    llvm::CallInst* store = builder_->CreateMaskedStore(value, ptr, llvm::Align(alignment), mask);
+#else
+    llvm::CallInst* store = builder_->CreateMaskedStore(value, ptr, alignment, mask);
+#endif
+    AddAliasInfo(store, op->buffer_var.get(), op->index);
+    return;
+  }
+  // Store the enabled lanes one by one.
+  int basic_align = t.bits() / 8;
+  auto f = [&](int i, llvm::Value* index) {
+    llvm::Value* enabled = t.lanes() == 1 ? mask : builder_->CreateExtractElement(mask, i);
+    llvm::BasicBlock* then_block = llvm::BasicBlock::Create(*ctx_, "store_lane", function_);
+    llvm::BasicBlock* end_block = llvm::BasicBlock::Create(*ctx_, "store_lane_end", function_);
+    builder_->CreateCondBr(enabled, then_block, end_block);
+    builder_->SetInsertPoint(then_block);
+    llvm::Value* ptr = CreateBufferPtr(t.element_of(), buffer, index);
+    llvm::Value* lane = t.lanes() == 1 ? value : builder_->CreateExtractElement(value, i);
+#if TVM_LLVM_VERSION >= 110
+    llvm::StoreInst* store = builder_->CreateAlignedStore(lane, ptr, llvm::Align(basic_align));
+#else
+    llvm::StoreInst* store = builder_->CreateAlignedStore(lane, ptr, basic_align);
+#endif
+    AddAliasInfo(store, op->buffer_var.get(), PrimExpr());
+    builder_->CreateBr(end_block);
+    builder_->SetInsertPoint(end_block);
+  };
+  if (t.lanes() == 1) {
+    f(0, MakeValue(op->index));
+  } else {
+    this->Scalarize(op->index, f);
+  }
+}
+
 llvm::Value* CodeGenLLVM::VisitExpr_(const CallNode* op) {
   if (auto* ptr_op = op->op.as<OpNode>()) {
     auto call_op = GetRef<Op>(ptr_op);
@@ -1258,10 +1426,13 @@ llvm::Value* CodeGenLLVM::VisitExpr_(const BroadcastNode* op) {
 }
 
 void CodeGenLLVM::VisitStmt_(const StoreNode* op) {
-  ICHECK(is_one(op->predicate)) << op->predicate;
   DataType t = op->value.dtype();
   bool is_volatile = volatile_buf_.count(op->buffer_var.get());
   llvm::Value* buffer = MakeValue(op->buffer_var);
+  if (!is_one(op->predicate)) {
+    CreatePredicatedStore(op, buffer, MakeValue(op->value));
+    return;
+  }
   llvm::Value* index = MakeValue(op->index);
   llvm::Value* value = MakeValue(op->value);
 
@@ -1324,8 +1495,13 @@ void CodeGenLLVM::VisitStmt_(const ForNode* op) {
   } else {
     ICHECK(op->kind == ForKind::kSerial);
   }
+  llvm::MDNode* loop_md = nullptr;
+  if (op->annotations.count(tir::attr::scalable_vectorize)) {
+    loop_md = GetScalableVectorizeLoopMD();
+  }
   CreateSerialFor(MakeValue(op->min), MakeValue(op->extent),
-                  llvm::ConstantInt::getSigned(GetLLVMType(op->extent), 1), op->loop_var, op->body);
+                  llvm::ConstantInt::getSigned(GetLLVMType(op->extent), 1), op->loop_var, op->body,
+                  loop_md);
 }
 
 void CodeGenLLVM::VisitStmt_(const WhileNode* op) {
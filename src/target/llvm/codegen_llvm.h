@@ -78,6 +78,14 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
    */
   virtual void Init(const std::string& module_name, llvm::TargetMachine* tm, llvm::LLVMContext* ctx,
                     bool system_lib, bool dynamic_lookup, bool target_c_runtime);
+  /*!
+   * \brief Set the optimization pipeline of Finish from the attributes of the target:
+   *  opt-level, loop-vectorize, slp-vectorize, unroll-loops, and the profile guided
+   *  optimization by profile-generate, the profile the instrumented code writes, and
+   *  profile-use, the merged profile data to optimize with.
+   * \param target The target.
+   */
+  void SetOptimizeOptions(const Target& target);
   /*!
    * \brief Compile and add function f to the current module.
    * \param f The function to be added.
@@ -285,6 +293,10 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   llvm::Value* CreateMul(DataType t, llvm::Value* a, llvm::Value* b);
   llvm::Value* CreateBroadcast(llvm::Value* value, int lanes);
   llvm::Value* CreateBufferPtr(DataType t, llvm::Value* buffer, llvm::Value* index);
+  // Load and store the lanes enabled by the predicate, with the masked intrinsics
+  // for the contiguous vectors and a branch per lane otherwise.
+  llvm::Value* CreatePredicatedLoad(const LoadNode* op, llvm::Value* buffer);
+  void CreatePredicatedStore(const StoreNode* op, llvm::Value* buffer, llvm::Value* value);
   // Vector concatenation.
   llvm::Value* CreateVecSlice(llvm::Value* vec, int begin, int extent);
   llvm::Value* CreateVecFlip(llvm::Value* vec);
@@ -292,7 +304,9 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   llvm::Value* CreateVecPad(llvm::Value* vec, int target_lanes);
   // Create serial for
   void CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                       const Var& loop_var, const Stmt& body);
+                       const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md = nullptr);
+  // The loop metadata asking the loop vectorizer for the scalable vectors.
+  llvm::MDNode* GetScalableVectorizeLoopMD();
   // add alias information.
   void AddAliasInfo(llvm::Instruction* load, const VarNode* buffer, PrimExpr index);
   // The IRBuilder.
@@ -308,6 +322,13 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   std::unique_ptr<llvm::MDBuilder> md_builder_;
   // llvm target machine
   llvm::TargetMachine* target_machine_{nullptr};
+  // The options of the optimization pipeline
+  int opt_level_{3};
+  bool loop_vectorize_{true};
+  bool slp_vectorize_{true};
+  bool unroll_loops_{true};
+  std::string profile_generate_;
+  std::string profile_use_;
   // llvm context
   llvm::LLVMContext* ctx_{nullptr};
   // helpful data types
@@ -170,6 +170,14 @@ llvm::ConstantArray* NDArrayToLLVMArray(llvm::LLVMContext* ctx, ::tvm::runtime::
       llvm::ArrayType::get(element_type, num_elements), llvm::ArrayRef<llvm::Constant*>(elements)));
 }
 
+llvm::Constant* NDArrayToLLVMRawArray(llvm::LLVMContext* ctx, ::tvm::runtime::NDArray arr) {
+  CHECK(arr.IsContiguous()) << "CodegenParams: only support contiguous arrays";
+  CHECK_EQ(arr->device.device_type, kDLCPU) << "CodegenParams: only support contiguous arrays";
+  const char* data = static_cast<const char*>(arr->data) + arr->byte_offset;
+  size_t num_bytes = ::tvm::runtime::GetDataSize(*arr.operator->());
+  return llvm::ConstantDataArray::getString(*ctx, llvm::StringRef(data, num_bytes), false);
+}
+
 }  // namespace codegen
 }  // namespace tvm
 
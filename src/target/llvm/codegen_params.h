@@ -43,6 +43,18 @@ namespace codegen {
  */
 llvm::ConstantArray* NDArrayToLLVMArray(llvm::LLVMContext* ctx, ::tvm::runtime::NDArray arr);
 
+/*!
+ * \brief Convert an NDArray to an LLVM array of its raw bytes.
+ *
+ * The bytes are copied as one block rather than element by element, which keeps the code
+ * generation of large params fast. They are in the byte order of the host.
+ *
+ * \param ctx LLVM context used to create the array.
+ * \param arr NDArray to convert.
+ * \return LLVM array of i8 containing the array data.
+ */
+llvm::Constant* NDArrayToLLVMRawArray(llvm::LLVMContext* ctx, ::tvm::runtime::NDArray arr);
+
 }  // namespace codegen
 }  // namespace tvm
 
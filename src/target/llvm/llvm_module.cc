@@ -24,11 +24,14 @@
 #ifdef TVM_LLVM_VERSION
 
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/target/codegen.h>
 
+#include <algorithm>
 #include <mutex>
+#include <thread>
 
 #include "../../runtime/file_utils.h"
 #include "../../runtime/library_module.h"
@@ -45,6 +48,43 @@ using runtime::PackedFunc;
 using runtime::TVMArgs;
 using runtime::TVMRetValue;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("target.llvm.num_threads", Integer);
+
+// The fewest functions worth a partition of their own.
+constexpr size_t kMinFunctionsPerPartition = 16;
+
+/*!
+ * \brief Generate and optimize the LLVM IR of some functions of a module, in a context of
+ *  their own so that the partitions of a module run on several threads.
+ * \return The bitcode of the partition, the way the modules cross the contexts.
+ */
+std::string CodegenPartition(const std::vector<PrimFunc>& funcs, const std::string& entry_func,
+                             const Target& target) {
+  std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
+  llvm::LLVMContext ctx;
+  std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm.get());
+  cg->SetOptimizeOptions(target);
+  cg->Init("TVMMod", tm.get(), &ctx, false, false, false);
+  bool has_entry = false;
+  for (const auto& f : funcs) {
+    cg->AddFunction(f);
+    has_entry |= f->GetAttr<String>(tvm::attr::kGlobalSymbol).value() == entry_func;
+  }
+  if (has_entry) {
+    cg->AddMainFunction(entry_func);
+  }
+  std::unique_ptr<llvm::Module> module = cg->Finish();
+  std::string bitcode;
+  llvm::raw_string_ostream os(bitcode);
+#if TVM_LLVM_VERSION <= 60
+  llvm::WriteBitcodeToFile(module.get(), os);
+#else
+  llvm::WriteBitcodeToFile(*module, os);
+#endif
+  os.flush();
+  return bitcode;
+}
+
 class LLVMModuleNode final : public runtime::ModuleNode {
  public:
   ~LLVMModuleNode() {
@@ -205,6 +245,7 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     bool target_c_runtime = (target->GetAttr<String>("runtime").value_or("") == kTvmRuntimeCrt);
     ctx_ = std::make_shared<llvm::LLVMContext>();
     std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
+    cg->SetOptimizeOptions(target);
 
     std::vector<PrimFunc> funcs;
     std::string entry_func;
@@ -235,10 +276,29 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       funcs.push_back(f);
     }
     ICHECK(funcs.size() > 0 || (could_have_linked_params && found_linked_params));
+    size_t num_partitions = NumPartitions(funcs.size());
+    bool has_aot_executor = std::any_of(funcs.begin(), funcs.end(), [](const PrimFunc& f) {
+      std::string name = f->GetAttr<String>(tvm::attr::kGlobalSymbol).value();
+      return name.rfind(::tvm::runtime::symbol::tvm_run_func_prefix, 0) == 0;
+    });
+    // The system library and the C runtime register all the functions of the module in one
+    // startup function, the linked params and the AOT executor refer to the other functions:
+    // these modules are generated in one piece.
+    if (num_partitions > 1 && !system_lib && !target_c_runtime && !found_linked_params &&
+        !has_aot_executor) {
+      InitPartitioned(funcs, entry_func, target, num_partitions);
+      return;
+    }
     // TODO(tqchen): remove the entry function behavior as it does not
     // makes sense when we start to use multiple modules.
     cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
 
+    // The AOT executor function calls the kernels by their symbols, it is added last so that
+    // they are defined.
+    std::stable_partition(funcs.begin(), funcs.end(), [](const PrimFunc& f) {
+      std::string name = f->GetAttr<String>(tvm::attr::kGlobalSymbol).value();
+      return name.rfind(::tvm::runtime::symbol::tvm_run_func_prefix, 0) != 0;
+    });
     for (const auto& f : funcs) {
       cg->AddFunction(f);
     }
@@ -251,6 +311,70 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       cg->LinkParameters(linked_params);
     }
     module_ = cg->Finish();
+    FinishInit(target);
+  }
+
+  // Generate the partitions of the functions on one thread each, then link them in ctx_.
+  void InitPartitioned(const std::vector<PrimFunc>& funcs, const std::string& entry_func,
+                       const Target& target, size_t num_partitions) {
+    std::vector<std::vector<PrimFunc>> partitions(num_partitions);
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      partitions[i % num_partitions].push_back(funcs[i]);
+    }
+    std::vector<std::string> bitcodes(num_partitions);
+    std::vector<std::string> errors(num_partitions);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_partitions; ++i) {
+      threads.emplace_back([&, i]() {
+        try {
+          bitcodes[i] = CodegenPartition(partitions[i], entry_func, target);
+        } catch (const std::exception& e) {
+          errors[i] = e.what();
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (const std::string& error : errors) {
+      if (!error.empty()) {
+        LOG(FATAL) << error;
+      }
+    }
+
+    for (const std::string& bitcode : bitcodes) {
+      llvm::SMDiagnostic err;
+      std::unique_ptr<llvm::MemoryBuffer> buf =
+          llvm::MemoryBuffer::getMemBuffer(bitcode, "TVMMod", false);
+      std::unique_ptr<llvm::Module> partition = llvm::parseIR(*buf, err, *ctx_);
+      ICHECK(partition != nullptr) << "Fail to load the partition of the module: "
+                                   << std::string(err.getMessage());
+      if (module_ == nullptr) {
+        module_ = std::move(partition);
+      } else {
+        ICHECK(!llvm::Linker::linkModules(*module_, std::move(partition)))
+            << "Fail to link the partitions of the module";
+      }
+    }
+    FinishInit(target);
+  }
+
+  // The partitions a module of num_funcs functions is generated in, by the option
+  // target.llvm.num_threads of the pass context, 0 for the threads of the host.
+  static size_t NumPartitions(size_t num_funcs) {
+    int64_t num_threads = transform::PassContext::Current()
+                              ->GetConfig<Integer>("target.llvm.num_threads", Integer(0))
+                              .value()
+                              ->value;
+    if (num_threads <= 0) {
+      num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(
+        1, std::min<size_t>(num_threads, num_funcs / kMinFunctionsPerPartition));
+  }
+
+  // Add the module flags and verify the module.
+  void FinishInit(const Target& target) {
     module_->addModuleFlag(llvm::Module::Warning, "tvm_target",
                            llvm::MDString::get(*ctx_, LLVMTargetToString(target)));
     module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
@@ -293,7 +417,9 @@ class LLVMModuleNode final : public runtime::ModuleNode {
       target_metadata = os.str();
     }
     mptr_ = module_.get();
-    tm_ = GetLLVMTargetMachine(Target(target_metadata));
+    // The JIT of a loaded module uses the target it was compiled for.
+    target_ = Target(target_metadata);
+    tm_ = GetLLVMTargetMachine(target_);
   }
 
   void LoadIR(const std::string& file_name) {
@@ -38,6 +38,7 @@ runtime::Module BuildAOCL(IRModule mod, Target target, bool emulation) {
   using tvm::runtime::Registry;
   bool output_ssa = false;
   CodeGenOpenCL cg;
+  cg.SetIntelFPGA(true);
   cg.Init(output_ssa);
 
   for (auto kv : mod->functions) {
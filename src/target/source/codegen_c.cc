@@ -23,6 +23,7 @@
 #include "codegen_c.h"
 
 #include <cctype>
+#include <cstring>
 #include <iomanip>
 
 #include "../../arith/pattern_match.h"
@@ -37,6 +38,7 @@ void CodeGenC::Init(bool output_ssa) { print_ssa_form_ = output_ssa; }
 void CodeGenC::InitFuncState(const PrimFunc& f) {
   alloc_storage_scope_.clear();
   handle_data_type_.clear();
+  loop_pragmas_.clear();
   CodeGenSourceBase::ClearFuncState();
 }
 
@@ -105,8 +107,8 @@ void CodeGenC::AddFunction(const PrimFunc& f) {
         }
       }
 
-      if (no_alias && restrict_keyword_.length() != 0) {
-        stream << ' ' << restrict_keyword_;
+      if (no_alias) {
+        PrintRestrict(v, stream);
       }
     } else {
       PrintType(GetType(v), stream);
@@ -394,6 +396,12 @@ void CodeGenC::PrintType(DataType t, std::ostream& os) {  // NOLINT(*)
   LOG(FATAL) << "Cannot convert type " << t << " to C type";
 }
 
+void CodeGenC::PrintRestrict(const Var& v, std::ostream& os) {  // NOLINT(*)
+  if (restrict_keyword_.length() != 0) {
+    os << ' ' << restrict_keyword_;
+  }
+}
+
 void CodeGenC::PrintType(const Type& type, std::ostream& os) {  // NOLINT(*)
   if (auto* ptr = type.as<PrimTypeNode>()) {
     return PrintType(ptr->dtype, os);
@@ -889,6 +897,12 @@ void CodeGenC::VisitStmt_(const AttrStmtNode* op) {
     const StringImmNode* value = op->value.as<StringImmNode>();
     ICHECK(value != nullptr);
     decl_stream << value->value;
+  } else if (tir::attr::IsPragmaKey(op->attr_key)) {
+    if (const auto* iv = op->node.as<IterVarNode>()) {
+      std::string key = op->attr_key;
+      loop_pragmas_[iv->var.get()][key.substr(std::strlen(tir::attr::pragma_scope_prefix))] =
+          op->value;
+    }
   }
   this->PrintStmt(op->body);
 }
@@ -905,6 +919,22 @@ void CodeGenC::VisitStmt_(const AssertStmtNode* op) {
   this->PrintStmt(op->body);
 }
 
+std::unordered_map<std::string, PrimExpr> CodeGenC::GetLoopPragmas(const ForNode* op) const {
+  std::unordered_map<std::string, PrimExpr> pragmas;
+  auto it = loop_pragmas_.find(op->loop_var.get());
+  if (it != loop_pragmas_.end()) {
+    pragmas = it->second;
+  }
+  for (const auto& kv : op->annotations) {
+    if (tir::attr::IsPragmaKey(kv.first) && kv.second->IsInstance<PrimExprNode>()) {
+      std::string key = kv.first;
+      pragmas[key.substr(std::strlen(tir::attr::pragma_scope_prefix))] =
+          Downcast<PrimExpr>(kv.second);
+    }
+  }
+  return pragmas;
+}
+
 void CodeGenC::VisitStmt_(const ForNode* op) {
   std::string extent = PrintExpr(op->extent);
   PrintIndent();
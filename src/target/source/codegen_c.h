@@ -175,6 +175,8 @@ class CodeGenC : public ExprFunctor<void(const PrimExpr&, std::ostream&)>,
    */
   virtual void BindThreadIndex(const IterVar& iv);                             // NOLINT(*)
   virtual void PrintStorageScope(const std::string& scope, std::ostream& os);  // NOLINT(*)
+  // Print the restrict qualifier of a pointer param of a no_alias function
+  virtual void PrintRestrict(const Var& v, std::ostream& os);  // NOLINT(*)
   virtual void PrintStorageSync(const CallNode* op);                           // NOLINT(*)
   // Binary vector op.
   virtual void PrintVecBinaryOp(const std::string& op, DataType op_type, PrimExpr lhs, PrimExpr rhs,
@@ -253,6 +255,13 @@ class CodeGenC : public ExprFunctor<void(const PrimExpr&, std::ostream&)>,
 
   /*! \brief Check if buf_var is volatile or not. */
   bool IsVolatile(const VarNode* buf_var) const { return volatile_buf_.count(buf_var) != 0; }
+  /*!
+   * \brief Get the pragmas of a loop, the pragma attributes of its iteration variable and the
+   *  annotations of the loop with the pragma prefix.
+   * \param op The loop.
+   * \return The values of the pragmas by key, without the prefix.
+   */
+  std::unordered_map<std::string, PrimExpr> GetLoopPragmas(const ForNode* op) const;
 
   /*! \brief restrict keyword */
   std::string restrict_keyword_{""};
@@ -271,6 +280,8 @@ class CodeGenC : public ExprFunctor<void(const PrimExpr&, std::ostream&)>,
   bool print_ssa_form_{false};
   /*! \brief set of volatile buf access */
   std::unordered_set<const VarNode*> volatile_buf_;
+  /*! \brief the pragma attributes of the iteration variables, by loop variable */
+  std::unordered_map<const VarNode*, std::unordered_map<std::string, PrimExpr>> loop_pragmas_;
   // deep comparison of PrimExpr
   ExprDeepEqual deep_equal_;
   // binding of let variables. Enables duplicate var defs that map to same value
@@ -24,6 +24,7 @@
 
 #include <tvm/runtime/container.h>
 #include <tvm/runtime/crt/error_codes.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/module.h>
 #include <tvm/target/codegen.h>
 
@@ -61,13 +62,26 @@ void CodeGenCHost::AddFunction(const PrimFunc& f) {
   CodeGenC::AddFunction(f);
 }
 
-void CodeGenCHost::DeclareParameters(Map<String, LinkedParam> params) {
+void CodeGenCHost::DeclareParameters(Map<String, LinkedParam> params, bool raw) {
   for (auto kv : params) {
     decl_stream << "\n"
                 << "#ifdef __cplusplus\n"
                 << "extern \"C\" {\n"
                 << "#endif\n"
                 << "static const ";
+    if (raw) {
+      // One more byte for the terminating null of the literal.
+      size_t num_bytes = runtime::GetDataSize(*kv.second->param.operator->());
+      decl_stream << "uint8_t " << ::tvm::runtime::symbol::tvm_param_prefix << kv.first << "["
+                  << num_bytes + 1 << "] __attribute__((aligned(" << runtime::kAllocAlignment
+                  << "))) =\n";
+      NDArrayDataToCString(kv.second->param, 4, decl_stream);
+      decl_stream << ";\n"
+                  << "#ifdef __cplusplus\n"
+                  << "}  // extern \"C\"\n"
+                  << "#endif\n";
+      continue;
+    }
     int64_t num_elements = 1;
     for (int64_t dim : kv.second->param.Shape()) {
       num_elements *= dim;
@@ -403,14 +417,15 @@ runtime::Module BuildCHost(IRModule mod, Target target) {
     cg.AddFunction(f);
   }
 
+  bool raw_params = target->GetAttr<Bool>("link-params-raw").value_or(Bool(false));
   if (could_have_linked_params && !aot_executor_fn.defined()) {
     ICHECK(found_linked_params) << "-link-params given but none found";
-    cg.DeclareParameters(linked_params);
+    cg.DeclareParameters(linked_params, raw_params);
     cg.LinkParameters(linked_params);
   }
 
   if (could_have_linked_params && aot_executor_fn.defined()) {
-    cg.DeclareParameters(linked_params);
+    cg.DeclareParameters(linked_params, raw_params);
     cg.AddFunction(aot_executor_fn);
   }
 
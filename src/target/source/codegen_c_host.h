@@ -42,8 +42,13 @@ class CodeGenCHost final : public CodeGenC {
 
   void AddFunction(const PrimFunc& f);
 
-  /*! \brief Add linked parameters, if they are present. */
-  void DeclareParameters(Map<String, LinkedParam> params);
+  /*!
+   * \brief Add linked parameters, if they are present.
+   * \param params The parameters.
+   * \param raw Whether to define them as string literals of their raw bytes, which compile
+   *  much faster than the initializers of their elements.
+   */
+  void DeclareParameters(Map<String, LinkedParam> params, bool raw = false);
   void LinkParameters(Map<String, LinkedParam> params);
 
   void PrintType(DataType t, std::ostream& os) final;  // NOLINT(*)
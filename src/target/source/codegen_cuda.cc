@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "literal/cuda_half_t.h"
+#include "ptx_mma.h"
 
 namespace tvm {
 namespace codegen {
@@ -91,6 +92,10 @@ std::string CodeGenCUDA::Finish() {
     decl_stream << "#include <mma.h>\n";
   }
 
+  if (enable_async_copy_) {
+    decl_stream << _cuda_async_copy_util;
+  }
+
   decl_stream << "\n#ifdef _WIN32\n";
   decl_stream << "  using uint = unsigned int;\n";
   decl_stream << "  using uchar = unsigned char;\n";
@@ -631,6 +636,50 @@ void CodeGenCUDA::VisitExpr_(const CallNode* op, std::ostream& os) {
     os << "], ";
     this->PrintExpr(op->args[5], os);
     os << ")";
+  } else if (op->op.same_as(builtin::tvm_async_copy())) {
+    enable_async_copy_ = true;
+    ICHECK_EQ(op->args.size(), 3U);
+    const auto* bytes = op->args[2].as<IntImmNode>();
+    ICHECK(bytes) << "The bytes of tvm_async_copy must be a constant";
+    os << "__tvm_cp_async<" << bytes->value << ">(";
+    this->PrintExpr(op->args[0], os);
+    os << ", ";
+    this->PrintExpr(op->args[1], os);
+    os << ")";
+  } else if (op->op.same_as(builtin::tvm_async_commit_group())) {
+    enable_async_copy_ = true;
+    os << "__tvm_cp_async_commit_group()";
+  } else if (op->op.same_as(builtin::tvm_async_wait_group())) {
+    enable_async_copy_ = true;
+    ICHECK_EQ(op->args.size(), 1U);
+    const auto* num_pending = op->args[0].as<IntImmNode>();
+    ICHECK(num_pending) << "The pending groups of tvm_async_wait_group must be a constant";
+    os << "__tvm_cp_async_wait_group<" << num_pending->value << ">()";
+  } else if (op->op.same_as(builtin::ptx_mma())) {
+    ICHECK_EQ(op->args.size(), 13U);
+    auto str_arg = [&](int i) {
+      const auto* str = op->args[i].as<StringImmNode>();
+      ICHECK(str) << "The argument " << i << " of ptx_mma must be a string";
+      return std::string(str->value);
+    };
+    auto ref = [&](int i) {
+      return "(" + this->PrintExpr(op->args[i]) + " + " + this->PrintExpr(op->args[i + 1]) + ")";
+    };
+    const auto* saturate = op->args[12].as<IntImmNode>();
+    ICHECK(saturate) << "The saturate of ptx_mma must be a constant";
+    os << PrintMMAAssembly(str_arg(0), str_arg(1), str_arg(2), str_arg(3), str_arg(4), str_arg(5),
+                           ref(6), ref(8), ref(10), saturate->value);
+  } else if (op->op.same_as(builtin::ptx_ldmatrix())) {
+    ICHECK_EQ(op->args.size(), 7U);
+    const auto* trans = op->args[0].as<IntImmNode>();
+    const auto* num = op->args[1].as<IntImmNode>();
+    const auto* type = op->args[2].as<StringImmNode>();
+    ICHECK(trans && num && type) << "The trans, num and type of ptx_ldmatrix must be constants";
+    std::string local_ref =
+        "(" + this->PrintExpr(op->args[3]) + " + " + this->PrintExpr(op->args[4]) + ")";
+    std::string smem_ref =
+        "(" + this->PrintExpr(op->args[5]) + " + " + this->PrintExpr(op->args[6]) + ")";
+    os << PrintLoadMatrixAssembly(trans->value, num->value, type->value, local_ref, smem_ref);
   } else if (op->op.same_as(builtin::tvm_load_matrix_sync())) {
     need_mma_h_ = true;
     ICHECK_EQ(op->args.size(), 8U);
@@ -92,6 +92,8 @@ class CodeGenCUDA final : public CodeGenC {
   bool enable_bf16_{false};
   // whether enable int8
   bool enable_int8_{false};
+  // whether enable the asynchronous copy intrinsics
+  bool enable_async_copy_{false};
   // whether enable warp shuffle intrinsics
   bool enable_warp_shuffle_{false};
   // whether need math_constants.h
@@ -26,6 +26,7 @@
 #include <string>
 #include <vector>
 
+#include "../../arith/pattern_match.h"
 #include "../../runtime/opencl/opencl_module.h"
 #include "../../runtime/thread_storage_scope.h"
 #include "../build_common.h"
@@ -37,14 +38,40 @@ CodeGenOpenCL::CodeGenOpenCL() { restrict_keyword_ = "restrict"; }
 
 void CodeGenOpenCL::InitFuncState(const PrimFunc& f) {
   CodeGenC::InitFuncState(f);
+  texture_vars_.clear();
   for (Var arg : f->params) {
     if (arg.dtype().is_handle()) {
-      alloc_storage_scope_[arg.get()] = "global";
+      auto* ptr = arg->type_annotation.as<PointerTypeNode>();
+      if (ptr && ptr->storage_scope == "global.texture") {
+        texture_vars_.insert(arg.get());
+        alloc_storage_scope_[arg.get()] = "global.texture";
+      } else {
+        alloc_storage_scope_[arg.get()] = "global";
+      }
     }
   }
+  // The subgroup shuffles of the kernel rely on the subgroups being the warps of the target.
+  reqd_sub_group_size_ = 0;
+  tir::PostOrderVisit(f->body, [this](const ObjectRef& node) {
+    const auto* call = node.as<CallNode>();
+    if (call && (call->op.same_as(builtin_call_extern_) ||
+                 call->op.same_as(builtin_call_pure_extern_))) {
+      const auto* name = call->args[0].as<StringImmNode>();
+      if (name && warp_size_ > 1 &&
+          std::string(name->value).rfind("intel_sub_group_shuffle", 0) == 0) {
+        reqd_sub_group_size_ = warp_size_;
+      }
+    }
+  });
 }
 
-void CodeGenOpenCL::PrintFuncPrefix() { stream << "__kernel void"; }
+void CodeGenOpenCL::PrintFuncPrefix() {
+  stream << "__kernel";
+  if (reqd_sub_group_size_ != 0) {
+    stream << " __attribute__((intel_reqd_sub_group_size(" << reqd_sub_group_size_ << ")))";
+  }
+  stream << " void";
+}
 
 std::string CodeGenOpenCL::Finish() {
   // inject extension enable pragma for fp16 and fp64
@@ -70,6 +97,40 @@ std::string CodeGenOpenCL::Finish() {
                    "#endif\n\n";
   }
 
+  if (enable_intel_subgroups_) {
+    decl_stream << "#pragma OPENCL EXTENSION cl_intel_subgroups : enable\n\n";
+  }
+  if (enable_khr_subgroups_) {
+    decl_stream << "#pragma OPENCL EXTENSION cl_khr_subgroups : enable\n\n";
+  }
+
+  // The sampler and the pixel reads of the textures, each function of the program is generated
+  // on its own so the helpers are guarded.
+  if (enable_texture_) {
+    decl_stream << "#ifndef __TVM_TEXTURE_HELPERS\n"
+                   "#define __TVM_TEXTURE_HELPERS\n"
+                   "__constant sampler_t __tvm_texture_sampler =\n"
+                   "    CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP | CLK_FILTER_NEAREST;\n"
+                   "#define __TVM_TEXTURE_COORD(img, p) \\\n"
+                   "    ((int2)((p) % get_image_width(img), (p) / get_image_width(img)))\n"
+                   "float __tvm_read_texture_f(__read_only image2d_t img, int i) {\n"
+                   "  float4 v = read_imagef(img, __tvm_texture_sampler, "
+                   "__TVM_TEXTURE_COORD(img, i / 4));\n"
+                   "  return ((float*)&v)[i % 4];\n"
+                   "}\n"
+                   "#endif\n\n";
+  }
+  if (enable_texture_half_) {
+    decl_stream << "#ifndef __TVM_TEXTURE_HELPERS_HALF\n"
+                   "#define __TVM_TEXTURE_HELPERS_HALF\n"
+                   "half __tvm_read_texture_h(__read_only image2d_t img, int i) {\n"
+                   "  half4 v = read_imageh(img, __tvm_texture_sampler, "
+                   "__TVM_TEXTURE_COORD(img, i / 4));\n"
+                   "  return ((half*)&v)[i % 4];\n"
+                   "}\n"
+                   "#endif\n\n";
+  }
+
   // Enable atomic_add used by get_valid_counts. Only needed for OpenCL < 1.1.
   if (enable_atomics_) {
     decl_stream << "#pragma OPENCL EXTENSION cl_khr_global_int32_base_atomics : enable\n"
@@ -162,6 +223,21 @@ void CodeGenOpenCL::PrintType(DataType t, std::ostream& os) {  // NOLINT(*)
   LOG(FATAL) << "Cannot convert type " << t << " to OpenCL type";
 }
 
+void CodeGenOpenCL::PrintType(const Type& type, std::ostream& os) {  // NOLINT(*)
+  auto* ptr = type.as<PointerTypeNode>();
+  if (ptr && ptr->storage_scope == "global.texture") {
+    os << "image2d_t";
+    return;
+  }
+  CodeGenC::PrintType(type, os);
+}
+
+void CodeGenOpenCL::PrintRestrict(const Var& v, std::ostream& os) {  // NOLINT(*)
+  if (!texture_vars_.count(v.get())) {
+    CodeGenC::PrintRestrict(v, os);
+  }
+}
+
 void CodeGenOpenCL::PrintVecAddr(const VarNode* buffer, DataType t, PrimExpr base,
                                  std::ostream& os) {  // NOLINT(*)
   if (!HandleTypeMatch(buffer, t.element_of())) {
@@ -208,6 +284,8 @@ void CodeGenOpenCL::PrintStorageSync(const CallNode* op) {
 void CodeGenOpenCL::PrintStorageScope(const std::string& scope, std::ostream& os) {  // NOLINT(*)
   if (scope == "global") {
     os << "__global ";
+  } else if (scope == "global.texture") {
+    os << "__read_only ";
   } else if (scope == "shared") {
     os << "__local ";
   }
@@ -243,18 +321,93 @@ void CodeGenOpenCL::VisitExpr_(const CallNode* op, std::ostream& os) {
     os << " *)" << this->GetVarID(load->buffer_var.get()) << " + ";
     this->PrintExpr(load->index, os);
     os << ')';
-  } else if (op->op.same_as(builtin_call_extern_)) {
+  } else if (op->op.same_as(builtin_call_extern_) || op->op.same_as(builtin_call_pure_extern_)) {
     auto func = Downcast<StringImm>(op->args[0]);
     // Enable atomics extension if used.
     if (func->value == "atomic_add") {
       enable_atomics_ = true;
     }
+    // Enable the subgroup extensions of the shuffles and block reads.
+    std::string name = func->value;
+    if (name.rfind("intel_sub_group", 0) == 0) {
+      enable_intel_subgroups_ = true;
+    } else if (name.rfind("sub_group_", 0) == 0) {
+      enable_khr_subgroups_ = true;
+    }
     CodeGenC::VisitExpr_(op, os);
   } else {
     CodeGenC::VisitExpr_(op, os);
   }
 }
 
+void CodeGenOpenCL::VisitExpr_(const LoadNode* op, std::ostream& os) {  // NOLINT(*)
+  if (!texture_vars_.count(op->buffer_var.get())) {
+    CodeGenC::VisitExpr_(op, os);
+    return;
+  }
+  // The texture holds the elements as the channels of its pixels, 4 per pixel.
+  DataType elem_type = op->dtype.element_of();
+  ICHECK(elem_type == DataType::Float(32) || elem_type == DataType::Float(16))
+      << "Textures hold float32 or float16 elements, got " << elem_type;
+  ICHECK(is_one(op->predicate)) << "predicated load is not supported";
+  enable_texture_ = true;
+  std::string suffix = elem_type.bits() == 32 ? "f" : "h";
+  if (elem_type.bits() == 16) {
+    enable_fp16_ = true;
+    enable_texture_half_ = true;
+  }
+  std::string vid = GetVarID(op->buffer_var.get());
+  if (op->dtype.lanes() == 1) {
+    os << "__tvm_read_texture_" << suffix << "(" << vid << ", " << PrintExpr(op->index) << ")";
+    return;
+  }
+  arith::PVar<PrimExpr> base;
+  ICHECK(op->dtype.lanes() == 4 && arith::ramp(base, 1, 4).Match(op->index))
+      << "A texture is read by its elements or by the 4 elements of its pixels";
+  os << "read_image" << suffix << "(" << vid << ", __tvm_texture_sampler, __TVM_TEXTURE_COORD("
+     << vid << ", (" << PrintExpr(base.Eval()) << ") / 4))";
+}
+
+void CodeGenOpenCL::VisitStmt_(const StoreNode* op) {
+  ICHECK(!texture_vars_.count(op->buffer_var.get()))
+      << "The textures are read only in the kernels: " << op->buffer_var;
+  CodeGenC::VisitStmt_(op);
+}
+
+void CodeGenOpenCL::VisitStmt_(const ForNode* op) {
+  // The pipeline pragma gives the initiation interval of the loop, the ivdep pragma the safe
+  // length of its dependences, 1 for none, and the unroll pragma the factor of a partial unroll.
+  if (intel_fpga_) {
+    auto pragmas = GetLoopPragmas(op);
+    auto pragma_int = [&](const char* key) -> int64_t {
+      const auto* value = pragmas.at(key).as<IntImmNode>();
+      ICHECK(value && value->value > 0)
+          << "The " << key << " pragma of " << op->loop_var << " must be a positive integer";
+      return value->value;
+    };
+    if (pragmas.count("pipeline")) {
+      PrintIndent();
+      stream << "#pragma ii " << pragma_int("pipeline") << "\n";
+    }
+    if (pragmas.count("ivdep")) {
+      int64_t safelen = pragma_int("ivdep");
+      PrintIndent();
+      stream << "#pragma ivdep";
+      if (safelen > 1) stream << " safelen(" << safelen << ")";
+      stream << "\n";
+    }
+    if (pragmas.count("unroll") || op->kind == ForKind::kUnrolled ||
+        op->kind == ForKind::kVectorized) {
+      int64_t factor = pragmas.count("unroll") ? pragma_int("unroll") : 1;
+      PrintIndent();
+      stream << "#pragma unroll";
+      if (factor > 1) stream << " " << factor;
+      stream << "\n";
+    }
+  }
+  CodeGenC::VisitStmt_(op);
+}
+
 void CodeGenOpenCL::VisitExpr_(const BroadcastNode* op, std::ostream& os) {  // NOLINT(*)
   std::string v = PrintExpr(op->value);
   os << "((";
@@ -291,6 +444,7 @@ runtime::Module BuildOpenCL(IRModule mod, Target target) {
     code << "// Function: " << kv.first->name_hint << std::endl;
     CodeGenOpenCL cg;
     cg.Init(output_ssa);
+    cg.SetWarpSize(target->GetAttr<Integer>("thread_warp_size", 1).value());
     auto f = Downcast<PrimFunc>(kv.second);
     auto calling_conv = f->GetAttr<Integer>(tvm::attr::kCallingConv);
     ICHECK(calling_conv == CallingConv::kDeviceKernelLaunch)
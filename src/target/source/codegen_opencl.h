@@ -27,6 +27,7 @@
 #include <tvm/target/codegen.h>
 
 #include <string>
+#include <unordered_set>
 
 #include "codegen_c.h"
 
@@ -37,6 +38,10 @@ class CodeGenOpenCL final : public CodeGenC {
  public:
   CodeGenOpenCL();
   std::string Finish();
+  // Set the warp size of the target, the subgroup size of the shuffles.
+  void SetWarpSize(int warp_size) { warp_size_ = warp_size; }
+  // Print the loop pragmas of the Intel FPGA SDK for OpenCL.
+  void SetIntelFPGA(bool intel_fpga) { intel_fpga_ = intel_fpga; }
 
   // override print thread tag.
   void InitFuncState(const PrimFunc& f) final;
@@ -45,6 +50,8 @@ class CodeGenOpenCL final : public CodeGenC {
   void PrintStorageScope(const std::string& scope, std::ostream& os) final;  // NOLINT(*)
   void PrintStorageSync(const CallNode* op) final;                           // NOLINT(*)
   void PrintType(DataType t, std::ostream& os) final;                        // NOLINT(*)
+  void PrintType(const Type& type, std::ostream& os) final;                  // NOLINT(*)
+  void PrintRestrict(const Var& v, std::ostream& os) final;                  // NOLINT(*)
   std::string GetVecLoad(DataType t, const VarNode* buffer, PrimExpr base) final;
   void PrintVecStore(const VarNode* buffer, DataType t, PrimExpr base,
                      const std::string& value) final;  // NOLINT(*)
@@ -55,6 +62,9 @@ class CodeGenOpenCL final : public CodeGenC {
 
   // overload visitor
   void VisitExpr_(const CallNode* op, std::ostream& os) final;       // NOLINT(*)
+  void VisitExpr_(const LoadNode* op, std::ostream& os) final;       // NOLINT(*)
+  void VisitStmt_(const StoreNode* op) final;                        // NOLINT(*)
+  void VisitStmt_(const ForNode* op) final;                          // NOLINT(*)
   void VisitExpr_(const BroadcastNode* op, std::ostream& os) final;  // NOLINT(*)
   void VisitExpr_(const FloatImmNode* op, std::ostream& os) final;   // NOLINT(*)
 
@@ -64,6 +74,19 @@ class CodeGenOpenCL final : public CodeGenC {
   bool enable_fp64_{false};
   // Whether to enable atomics extension.
   bool enable_atomics_{false};
+  // Whether to enable the Intel and Khronos subgroup extensions.
+  bool enable_intel_subgroups_{false};
+  bool enable_khr_subgroups_{false};
+  // Whether the kernels read textures, of float32 and float16.
+  bool enable_texture_{false};
+  bool enable_texture_half_{false};
+  // The warp size of the target, and the subgroup size the kernel requires.
+  int warp_size_{1};
+  // Whether the kernels target an Intel FPGA.
+  bool intel_fpga_{false};
+  int reqd_sub_group_size_{0};
+  // The params of the kernel in the global.texture scope, read as image2d_t.
+  std::unordered_set<const VarNode*> texture_vars_;
 };
 
 }  // namespace codegen
@@ -25,6 +25,7 @@
 
 #include <dlpack/dlpack.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <memory>
@@ -244,5 +245,28 @@ void NDArrayDataToC(::tvm::runtime::NDArray arr, int indent_chars, std::ostream&
   os.flags(old_fmtflags);
 }
 
+void NDArrayDataToCString(::tvm::runtime::NDArray arr, int indent_chars, std::ostream& os) {
+  CHECK(arr.IsContiguous()) << "CodegenParams: only support contiguous arrays";
+  const uint8_t* data = static_cast<const uint8_t*>(arr->data) + arr->byte_offset;
+  size_t num_bytes = ::tvm::runtime::GetDataSize(*arr.operator->());
+  // Each byte takes the 4 chars of its escape, within the quotes of the line.
+  size_t bytes_per_row = std::max(1, (kMaxLineLength - indent_chars - 2) / 4);
+  std::string indent_str(indent_chars, ' ');
+  static const char* hex_digits = "0123456789abcdef";
+  std::string row;
+  for (size_t i = 0; i < num_bytes; i += bytes_per_row) {
+    row.clear();
+    for (size_t j = i; j < std::min(num_bytes, i + bytes_per_row); ++j) {
+      row += "\\x";
+      row += hex_digits[data[j] >> 4];
+      row += hex_digits[data[j] & 0xf];
+    }
+    os << indent_str << '"' << row << '"' << (i + bytes_per_row < num_bytes ? "\n" : "");
+  }
+  if (num_bytes == 0) {
+    os << indent_str << "\"\"";
+  }
+}
+
 }  // namespace codegen
 }  // namespace tvm
@@ -46,6 +46,20 @@ namespace codegen {
  */
 void NDArrayDataToC(::tvm::runtime::NDArray arr, int indent_chars, std::ostream& os);
 
+/*!
+ * \brief Write the raw bytes of arr to os, as adjacent C string literals of hex escapes.
+ *
+ * The literals initialize a character array of the size of the data plus the terminating null.
+ * For the int16_t NDArray [1, 2] on a little-endian host, and indent_chars = 4, the following
+ * output is produced:
+ *     "\x01\x00\x02\x00"
+ *
+ * \param arr The array to generate
+ * \param indent_chars Number of chars to indent
+ * \param os Output stream where the array data should be written.
+ */
+void NDArrayDataToCString(::tvm::runtime::NDArray arr, int indent_chars, std::ostream& os);
+
 }  // namespace codegen
 }  // namespace tvm
 
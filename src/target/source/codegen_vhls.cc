@@ -137,6 +137,67 @@ void CodeGenVivadoHLS::VisitExpr_(const MaxNode* op, std::ostream& os) {  // NOL
   PrintBinaryExpr(op, opstr, os, this);
 }
 
+/*
+ * The pipeline pragma gives the initiation interval of the loop, the unroll pragma the factor
+ * of a partial unroll, or 1 for a full unroll like the unrolled and vectorized loops.
+ */
+void CodeGenVivadoHLS::VisitStmt_(const ForNode* op) {
+  std::string extent = PrintExpr(op->extent);
+  PrintIndent();
+  std::string vid = AllocVarID(op->loop_var.get());
+  ICHECK(is_zero(op->min));
+  stream << "for (";
+  PrintType(op->loop_var.dtype(), stream);
+  stream << ' ' << vid << " = 0; " << vid << " < " << extent << "; ++" << vid << ") {\n";
+  int for_scope = BeginScope();
+  auto pragmas = GetLoopPragmas(op);
+  auto pipeline = pragmas.find("pipeline");
+  if (pipeline != pragmas.end()) {
+    const auto* ii = pipeline->second.as<IntImmNode>();
+    ICHECK(ii && ii->value > 0) << "The pipeline pragma of " << vid
+                                << " must be a positive initiation interval";
+    PrintIndent();
+    stream << "#pragma HLS PIPELINE II=" << ii->value << "\n";
+  }
+  auto unroll = pragmas.find("unroll");
+  if (unroll != pragmas.end() || op->kind == ForKind::kUnrolled ||
+      op->kind == ForKind::kVectorized) {
+    PrintIndent();
+    stream << "#pragma HLS UNROLL";
+    if (unroll != pragmas.end()) {
+      const auto* factor = unroll->second.as<IntImmNode>();
+      ICHECK(factor && factor->value > 0)
+          << "The unroll pragma of " << vid << " must be a positive factor";
+      if (factor->value > 1) stream << " factor=" << factor->value;
+    }
+    stream << "\n";
+  }
+  PrintStmt(op->body);
+  this->EndScope(for_scope);
+  PrintIndent();
+  stream << "}\n";
+}
+
+void CodeGenVivadoHLS::VisitStmt_(const AttrStmtNode* op) {
+  if (op->attr_key == tir::attr::array_partition) {
+    const VarNode* buffer = op->node.as<VarNode>();
+    ICHECK(buffer && var_idmap_.count(buffer))
+        << "The array_partition attribute must be in the scope of the allocation of its buffer";
+    const auto* factor = op->value.as<IntImmNode>();
+    ICHECK(factor && factor->value >= 0)
+        << "The array_partition attribute must be a cyclic factor, or 0 for complete";
+    PrintIndent();
+    stream << "#pragma HLS ARRAY_PARTITION variable=" << GetVarID(buffer);
+    if (factor->value == 0) {
+      stream << " complete";
+    } else {
+      stream << " cyclic factor=" << factor->value;
+    }
+    stream << " dim=1\n";
+  }
+  CodeGenC::VisitStmt_(op);
+}
+
 runtime::Module BuildSDAccel(IRModule mod, Target target) {
   using tvm::runtime::Registry;
   bool output_ssa = false;
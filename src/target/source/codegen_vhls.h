@@ -44,6 +44,9 @@ class CodeGenVivadoHLS final : public CodeGenC {
   void PreFunctionBody(const PrimFunc& f) final;
   void VisitExpr_(const MinNode* op, std::ostream& os) final;
   void VisitExpr_(const MaxNode* op, std::ostream& os) final;
+  // Print the pipeline and unroll pragmas of the loop, and the partitions of the buffers.
+  void VisitStmt_(const ForNode* op) final;
+  void VisitStmt_(const AttrStmtNode* op) final;
 };
 
 }  // namespace codegen
@@ -22,6 +22,7 @@
  * \brief OpenCL intrinsic rules.
  */
 #include <tvm/arith/analyzer.h>
+#include <tvm/tir/op.h>
 #include <tvm/tir/op_attr_types.h>
 
 #include "../intrin_rule.h"
@@ -104,9 +105,37 @@ static PrimExpr DispatchIntelShuffle(const PrimExpr& e) {
   return Call(call->dtype, builtin::call_pure_extern(), opencl_args);
 }
 
+// The shuffles of the lanes of the subgroup at a distance, the lanes past the end of the subgroup
+// read the value again as the next value of intel_sub_group_shuffle_up/down.
+static PrimExpr DispatchIntelShuffleUpDown(const PrimExpr& e) {
+  const CallNode* call = e.as<CallNode>();
+  ICHECK(call != nullptr);
+  ICHECK_EQ(call->args.size(), 5);  // mask, value, delta, width, warp_size
+  arith::Analyzer analyzer;
+  ICHECK(analyzer.CanProve(call->args[3] == call->args[4]))
+      << "Intel warp shuffle dose not support width != warp_size";
+  bool up = call->op.same_as(builtin::tvm_warp_shuffle_up());
+  StringImm name(up ? "intel_sub_group_shuffle_up" : "intel_sub_group_shuffle_down");
+  Array<PrimExpr> opencl_args{
+      {name, call->args[1], call->args[1], tir::Cast(DataType::UInt(32), call->args[2])}};
+  return Call(call->dtype, builtin::call_pure_extern(), opencl_args);
+}
+
 TVM_REGISTER_OP("tir.tvm_warp_shuffle")
     .set_attr<FLowerIntrinsic>("opencl.FLowerIntrinsic", DispatchIntelShuffle);
 
+TVM_REGISTER_OP("tir.tvm_warp_shuffle_up")
+    .set_attr<FLowerIntrinsic>("opencl.FLowerIntrinsic", DispatchIntelShuffleUpDown);
+
+TVM_REGISTER_OP("tir.tvm_warp_shuffle_down")
+    .set_attr<FLowerIntrinsic>("opencl.FLowerIntrinsic", DispatchIntelShuffleUpDown);
+
+// The subgroup shuffles do not take a mask
+TVM_REGISTER_OP("tir.tvm_warp_activemask")
+    .set_attr<FLowerIntrinsic>("opencl.FLowerIntrinsic", [](const PrimExpr& e) -> PrimExpr {
+      return tir::make_zero(DataType::UInt(32));
+    });
+
 }  // namespace intrin
 }  // namespace codegen
 }  // namespace tvm
@@ -347,6 +347,38 @@ static constexpr const char* _cuda_warp_intrinsic_util = R"(
         __shfl_up((var), (offset), (width))
 #endif
 
+)";
+static constexpr const char* _cuda_async_copy_util = R"(
+// The asynchronous copies of global memory into shared memory, synchronous before sm_80.
+template <int bytes>
+__device__ __forceinline__ void __tvm_cp_async(void* dst, const void* src) {
+#if defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800)
+  unsigned int addr = static_cast<unsigned int>(__cvta_generic_to_shared(dst));
+  if (bytes == 16) {
+    asm volatile("cp.async.cg.shared.global [%0], [%1], %2;\n" :: "r"(addr), "l"(src), "n"(bytes));
+  } else {
+    asm volatile("cp.async.ca.shared.global [%0], [%1], %2;\n" :: "r"(addr), "l"(src), "n"(bytes));
+  }
+#else
+  for (int i = 0; i < bytes / 4; ++i) {
+    static_cast<int*>(dst)[i] = static_cast<const int*>(src)[i];
+  }
+#endif
+}
+
+__device__ __forceinline__ void __tvm_cp_async_commit_group() {
+#if defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800)
+  asm volatile("cp.async.commit_group;\n" ::);
+#endif
+}
+
+template <int num_pending>
+__device__ __forceinline__ void __tvm_cp_async_wait_group() {
+#if defined(__CUDA_ARCH__) && (__CUDA_ARCH__ >= 800)
+  asm volatile("cp.async.wait_group %0;\n" :: "n"(num_pending));
+#endif
+}
+
 )";
 
 #endif  // TVM_TARGET_SOURCE_LITERAL_CUDA_HALF_T_H_
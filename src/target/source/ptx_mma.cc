@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ptx_mma.cc
+ */
+#include "ptx_mma.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace codegen {
+
+namespace {
+
+// An mma.sync configuration, with the 32-bit registers of the fragments of each thread.
+struct MMAConfig {
+  std::string shape;
+  std::string a_dtype;
+  std::string c_dtype;
+  int num_a;
+  int num_b;
+  int num_c;
+};
+
+// The configurations of sm_75 and sm_80. B has the element type of A, but for the integers
+// whose signedness may differ.
+const std::vector<MMAConfig>& MMAConfigs() {
+  static const std::vector<MMAConfig> configs = {
+      {"m16n8k8", "fp16", "fp16", 2, 1, 2},   {"m16n8k8", "fp16", "fp32", 2, 1, 4},
+      {"m16n8k16", "fp16", "fp16", 4, 2, 2},  {"m16n8k16", "fp16", "fp32", 4, 2, 4},
+      {"m16n8k16", "bf16", "fp32", 4, 2, 4},  {"m16n8k8", "tf32", "fp32", 4, 2, 4},
+      {"m16n8k16", "int8", "int32", 2, 1, 4}, {"m16n8k32", "int8", "int32", 4, 2, 4},
+  };
+  return configs;
+}
+
+std::string PTXType(const std::string& dtype) {
+  if (dtype == "fp16") return "f16";
+  if (dtype == "bf16") return "bf16";
+  if (dtype == "tf32") return "tf32";
+  if (dtype == "fp32") return "f32";
+  if (dtype == "int8") return "s8";
+  if (dtype == "uint8") return "u8";
+  if (dtype == "int32") return "s32";
+  LOG(FATAL) << "Unsupported mma.sync data type " << dtype;
+  return "";
+}
+
+// The elements of A and B in the configuration table, the integers of either signedness.
+std::string MMAElemType(const std::string& dtype) { return dtype == "uint8" ? "int8" : dtype; }
+
+// Print the list of the registers numbered first to first + num.
+std::string PrintRegisters(int first, int num) {
+  std::ostringstream os;
+  os << "{";
+  for (int i = 0; i < num; ++i) {
+    os << (i ? ", " : "") << "%" << first + i;
+  }
+  os << "}";
+  return os.str();
+}
+
+// Print the operands of the registers of a fragment.
+void PrintOperands(const std::string& constraint, const std::string& type, const std::string& ref,
+                   int num, bool last, std::ostream& os) {
+  for (int i = 0; i < num; ++i) {
+    os << "\"" << constraint << "\"(((" << type << " *)(" << ref << "))[" << i << "])"
+       << (i + 1 < num || !last ? ", " : "");
+  }
+}
+
+}  // namespace
+
+std::string PrintMMAAssembly(const std::string& shape, const std::string& a_layout,
+                             const std::string& b_layout, const std::string& a_dtype,
+                             const std::string& b_dtype, const std::string& c_dtype,
+                             const std::string& a_ref, const std::string& b_ref,
+                             const std::string& c_ref, bool saturate) {
+  ICHECK(a_layout == "row" && b_layout == "col")
+      << "mma.sync only supports a row major A and a column major B, got " << a_layout << " and "
+      << b_layout;
+  ICHECK_EQ(MMAElemType(a_dtype), MMAElemType(b_dtype))
+      << "A and B of mma.sync must have the same element type";
+  const MMAConfig* config = nullptr;
+  for (const MMAConfig& c : MMAConfigs()) {
+    if (c.shape == shape && c.a_dtype == MMAElemType(a_dtype) && c.c_dtype == c_dtype) {
+      config = &c;
+      break;
+    }
+  }
+  ICHECK(config != nullptr) << "Unsupported mma.sync " << shape << " of " << a_dtype << " into "
+                            << c_dtype;
+  bool is_int = c_dtype == "int32";
+  ICHECK(!saturate || is_int) << "Only the integer mma.sync saturates";
+
+  std::ostringstream os;
+  std::string c_regs = PrintRegisters(0, config->num_c);
+  os << "asm volatile(\n"
+     << "    \"mma.sync.aligned." << shape << "." << a_layout << "." << b_layout
+     << (saturate ? ".satfinite" : "") << "." << PTXType(c_dtype) << "." << PTXType(a_dtype) << "."
+     << PTXType(b_dtype) << "." << PTXType(c_dtype) << " \"\n"
+     << "    \"" << c_regs << ", " << PrintRegisters(config->num_c, config->num_a) << ", "
+     << PrintRegisters(config->num_c + config->num_a, config->num_b) << ", " << c_regs
+     << ";\\n\"\n"
+     << "    : ";
+  // The accumulator is both read and written, D is C.
+  if (c_dtype == "fp32") {
+    PrintOperands("+f", "float", c_ref, config->num_c, true, os);
+  } else {
+    PrintOperands("+r", is_int ? "int" : "unsigned", c_ref, config->num_c, true, os);
+  }
+  os << "\n    : ";
+  PrintOperands("r", "unsigned", a_ref, config->num_a, false, os);
+  PrintOperands("r", "unsigned", b_ref, config->num_b, true, os);
+  os << ")";
+  return os.str();
+}
+
+std::string PrintLoadMatrixAssembly(bool trans, int num, const std::string& type,
+                                    const std::string& local_ref, const std::string& smem_ref) {
+  ICHECK(num == 1 || num == 2 || num == 4) << "ldmatrix loads 1, 2 or 4 matrices, got " << num;
+  ICHECK_EQ(type, ".b16") << "ldmatrix only loads 16-bit elements";
+  std::ostringstream os;
+  os << "asm volatile(\n"
+     << "    \"ldmatrix.sync.aligned.m8n8.x" << num << (trans ? ".trans" : "") << ".shared" << type
+     << " " << PrintRegisters(0, num) << ", [%" << num << "];\\n\"\n"
+     << "    : ";
+  PrintOperands("=r", "unsigned", local_ref, num, true, os);
+  os << "\n    : \"r\"((unsigned)__cvta_generic_to_shared(" << smem_ref << ")))";
+  return os.str();
+}
+
+}  // namespace codegen
+}  // namespace tvm
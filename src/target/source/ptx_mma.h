@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file ptx_mma.h
+ * \brief The inline PTX assembly of the warp-level matrix instructions mma.sync and ldmatrix.
+ */
+#ifndef TVM_TARGET_SOURCE_PTX_MMA_H_
+#define TVM_TARGET_SOURCE_PTX_MMA_H_
+
+#include <string>
+
+namespace tvm {
+namespace codegen {
+
+/*!
+ * \brief Print the inline assembly of mma.sync, accumulating A * B into the fragment C.
+ * \param shape The shape of the instruction, e.g. "m16n8k16".
+ * \param a_layout The layout of A, "row".
+ * \param b_layout The layout of B, "col".
+ * \param a_dtype The PTX type of the elements of A, e.g. "fp16".
+ * \param b_dtype The PTX type of the elements of B.
+ * \param c_dtype The PTX type of the accumulator, e.g. "fp32".
+ * \param a_ref The expression of the address of the fragment of A of the thread.
+ * \param b_ref The expression of the address of the fragment of B of the thread.
+ * \param c_ref The expression of the address of the fragment of C of the thread.
+ * \param saturate Whether to saturate the integer accumulator.
+ * \return The asm statement, without the trailing semicolon.
+ */
+std::string PrintMMAAssembly(const std::string& shape, const std::string& a_layout,
+                             const std::string& b_layout, const std::string& a_dtype,
+                             const std::string& b_dtype, const std::string& c_dtype,
+                             const std::string& a_ref, const std::string& b_ref,
+                             const std::string& c_ref, bool saturate);
+
+/*!
+ * \brief Print the inline assembly of ldmatrix, loading num 8x8 matrices of 16-bit elements
+ *  from shared memory into the fragment of the thread.
+ * \param trans Whether to transpose the matrices.
+ * \param num The number of matrices, 1, 2 or 4.
+ * \param type The PTX type of the elements, ".b16".
+ * \param local_ref The expression of the address of the fragment of the thread.
+ * \param smem_ref The expression of the shared memory address of the row of the thread.
+ * \return The asm statement, without the trailing semicolon.
+ */
+std::string PrintLoadMatrixAssembly(bool trans, int num, const std::string& type,
+                                    const std::string& local_ref, const std::string& smem_ref);
+
+}  // namespace codegen
+}  // namespace tvm
+
+#endif  // TVM_TARGET_SOURCE_PTX_MMA_H_
@@ -28,6 +28,8 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <sstream>
 #include <string>
 
 #include "../../runtime/pack_args.h"
@@ -84,7 +86,11 @@ runtime::VulkanShader CodeGenSPIRV::BuildFunction(const PrimFunc& f, const std::
     for (size_t i = 0; i < pod_args.size(); ++i) {
       value_types.push_back(builder_->GetSType(pod_args[i].dtype()));
     }
-    if (pod_args.size() * sizeof(runtime::ArgUnion64) <= runtime::vulkan::kMaxPushConstantsBytes) {
+    // Pass the arguments as push constants up to the limit of the device, which is
+    // at least the kMaxPushConstantsBytes guaranteed by the spec.
+    if (pod_args.size() * sizeof(runtime::ArgUnion64) <=
+        std::max<size_t>(spirv_support_.max_push_constants_size,
+                         runtime::vulkan::kMaxPushConstantsBytes)) {
       spirv::Value ptr = builder_->DeclarePushConstant(value_types);
       for (size_t i = 0; i < pod_args.size(); ++i) {
         spirv::Value value =
@@ -116,6 +122,8 @@ void CodeGenSPIRV::InitFuncState() {
   std::fill(workgroup_size_, workgroup_size_ + 3, 1);
   var_map_.clear();
   storage_info_.clear();
+  fragment_shapes_.clear();
+  fragment_types_.clear();
   analyzer_.reset(new arith::Analyzer());
   builder_.reset(new spirv::IRBuilder(spirv_support_));
   builder_->InitHeader();
@@ -351,6 +359,53 @@ spirv::Value CodeGenSPIRV::VisitExpr_(const CallNode* op) {
   } else if (op->op.same_as(builtin::popcount())) {
     return builder_->MakeValue(spv::OpBitCount, builder_->GetSType(op->dtype),
                                MakeValue(op->args[0]));
+  } else if (op->op.same_as(builtin::tvm_fill_fragment())) {
+    ICHECK_EQ(op->args.size(), 6U);
+    spirv::Value ptr = GetFragmentPointer(op->args[0], op->args[4]);
+    spirv::SType matrix_type = fragment_types_.at(op->args[0].as<VarNode>());
+    spirv::SType elem_type = builder_->GetSType(matrix_type.type);
+    spirv::Value value = MakeValue(op->args[5]);
+    if (op->args[5].dtype() != matrix_type.type) {
+      value = builder_->Cast(elem_type, value);
+    }
+    // A composite of one scalar fills all the elements of a cooperative matrix.
+    spirv::Value filled = builder_->MakeValue(spv::OpCompositeConstruct, matrix_type, value);
+    builder_->MakeInst(spv::OpStore, ptr, filled);
+    return spirv::Value();
+  } else if (op->op.same_as(builtin::tvm_load_matrix_sync()) ||
+             op->op.same_as(builtin::tvm_store_matrix_sync())) {
+    ICHECK_EQ(op->args.size(), 8U);
+    spirv::Value ptr = GetFragmentPointer(op->args[0], op->args[4]);
+    spirv::SType matrix_type = fragment_types_.at(op->args[0].as<VarNode>());
+    spirv::Value mem_ptr = GetFragmentMemoryPointer(op->args[5], matrix_type.type);
+    spirv::Value stride = MakeValue(op->args[6]);
+    const StringImmNode* layout = op->args[7].as<StringImmNode>();
+    ICHECK(layout) << "The layout of " << op->op << " must be a string";
+    spirv::Value col_major =
+        builder_->UIntImm(builder_->GetSType(DataType::UInt(1)), layout->value == "col_major");
+    if (op->op.same_as(builtin::tvm_load_matrix_sync())) {
+      spirv::Value loaded = builder_->MakeValue(spv::OpCooperativeMatrixLoadNV, matrix_type,
+                                                mem_ptr, stride, col_major);
+      builder_->MakeInst(spv::OpStore, ptr, loaded);
+    } else {
+      spirv::Value value = builder_->MakeValue(spv::OpLoad, matrix_type, ptr);
+      builder_->MakeInst(spv::OpCooperativeMatrixStoreNV, mem_ptr, value, stride, col_major);
+    }
+    return spirv::Value();
+  } else if (op->op.same_as(builtin::tvm_mma_sync())) {
+    ICHECK_EQ(op->args.size(), 8U);
+    std::vector<spirv::Value> values;
+    for (size_t i = 2; i < 8; i += 2) {
+      spirv::Value ptr = GetFragmentPointer(op->args[i], op->args[i + 1]);
+      spirv::SType matrix_type = fragment_types_.at(op->args[i].as<VarNode>());
+      values.push_back(builder_->MakeValue(spv::OpLoad, matrix_type, ptr));
+    }
+    spirv::Value d_ptr = GetFragmentPointer(op->args[0], op->args[1]);
+    spirv::SType d_type = fragment_types_.at(op->args[0].as<VarNode>());
+    spirv::Value d = builder_->MakeValue(spv::OpCooperativeMatrixMulAddNV, d_type, values[0],
+                                         values[1], values[2]);
+    builder_->MakeInst(spv::OpStore, d_ptr, d);
+    return spirv::Value();
   } else {
     LOG(FATAL) << "Unresolved call  " << op->op;
     return spirv::Value();
@@ -455,6 +510,38 @@ void CodeGenSPIRV::Scalarize(const PrimExpr& e, std::function<void(int i, spirv:
   }
 }
 
+spirv::Value CodeGenSPIRV::GetFragmentPointer(const PrimExpr& fragment, const PrimExpr& index) {
+  const VarNode* buffer = fragment.as<VarNode>();
+  ICHECK(buffer && fragment_types_.count(buffer))
+      << "Expected a fragment in the wmma scopes, got " << fragment;
+  return builder_->CooperativeMatrixAccess(fragment_types_.at(buffer), MakeValue(fragment),
+                                           MakeValue(index));
+}
+
+spirv::Value CodeGenSPIRV::GetFragmentMemoryPointer(const PrimExpr& buffer_ptr,
+                                                    DataType elem_type) {
+  const CallNode* call = buffer_ptr.as<CallNode>();
+  ICHECK(call && call->op.same_as(builtin::tvm_access_ptr()))
+      << "The fragments are loaded and stored through a tvm_access_ptr, got " << buffer_ptr;
+  const VarNode* buffer = call->args[1].as<VarNode>();
+  auto it = storage_info_.find(buffer);
+  ICHECK(it != storage_info_.end());
+  StorageInfo& info = it->second;
+  if (!info.content_fixed) {
+    info.UpdateContentType(elem_type);
+  }
+  ICHECK_EQ(info.content_type, elem_type)
+      << "The fragments are loaded and stored through buffers of their element type";
+
+  spirv::Value data = MakeValue(call->args[1]);
+  ICHECK_NE(data.stype.storage_class, spv::StorageClassUniform)
+      << "Cooperative matrices cannot access the buffer blocks, "
+      << "requires -supports_storage_buffer_storage_class=1";
+  spirv::SType ptr_type =
+      builder_->GetPointerType(builder_->GetSType(elem_type), data.stype.storage_class);
+  return builder_->StructArrayAccess(ptr_type, data, MakeValue(call->args[2]));
+}
+
 void CodeGenSPIRV::VisitStmt_(const StoreNode* op) {
   ICHECK(is_one(op->predicate));
   auto it = storage_info_.find(op->buffer_var.get());
@@ -622,7 +709,29 @@ void CodeGenSPIRV::VisitStmt_(const AllocateNode* op) {
   spirv::Value buf;
   StorageInfo& info = storage_info_[op->buffer_var.get()];
   spirv::SType etype = builder_->GetSType(op->dtype);
-  if (info.scope.rank == runtime::StorageRank::kLocal) {
+  runtime::StorageRank rank = info.scope.rank;
+  if (rank == runtime::StorageRank::kWMMAMatrixA || rank == runtime::StorageRank::kWMMAMatrixB ||
+      rank == runtime::StorageRank::kWMMAAccumulator) {
+    // The fragments are arrays of cooperative matrices, A is m x k, B is k x n and
+    // the accumulator is m x n.
+    auto it = fragment_shapes_.find(op->buffer_var.get());
+    ICHECK(it != fragment_shapes_.end()) << "The fragment " << op->buffer_var << " has no shape";
+    std::vector<uint32_t> shape;
+    std::istringstream is(it->second);
+    for (std::string dim; std::getline(is, dim, ',');) {
+      shape.push_back(static_cast<uint32_t>(std::stoi(dim)));
+    }
+    ICHECK_EQ(shape.size(), 3U) << "Invalid fragment shape " << it->second;
+    uint32_t rows = rank == runtime::StorageRank::kWMMAMatrixB ? shape[2] : shape[0];
+    uint32_t cols = rank == runtime::StorageRank::kWMMAMatrixA ? shape[2] : shape[1];
+    ICHECK_EQ(constant_size % (rows * cols), 0)
+        << "The fragment " << op->buffer_var << " is not a whole number of " << rows << "x"
+        << cols << " matrices";
+    spirv::SType matrix_type = builder_->GetCooperativeMatrixType(etype, rows, cols);
+    buf = builder_->AllocateCooperativeMatrices(
+        matrix_type, static_cast<uint32_t>(constant_size) / (rows * cols));
+    fragment_types_[op->buffer_var.get()] = matrix_type;
+  } else if (rank == runtime::StorageRank::kLocal) {
     buf =
         builder_->Allocate(etype, static_cast<uint32_t>(constant_size), spv::StorageClassFunction);
   } else {
@@ -657,6 +766,10 @@ void CodeGenSPIRV::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* v = op->node.as<VarNode>();
     ICHECK(v);
     storage_info_[v].is_volatile = true;
+  } else if (op->attr_key == tir::attr::fragment_shape) {
+    const VarNode* v = op->node.as<VarNode>();
+    ICHECK(v);
+    fragment_shapes_[v] = op->value.as<StringImmNode>()->value;
   }
   this->VisitStmt(op->body);
 }
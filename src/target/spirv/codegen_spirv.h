@@ -141,6 +141,10 @@ class CodeGenSPIRV : public ExprFunctor<spirv::Value(const PrimExpr&)>,
   spirv::Value GetThreadIndex(const IterVar& iv, const PrimExpr& extent);
   spirv::Value CreateStorageSync(const CallNode* op);
   void Scalarize(const PrimExpr& e, std::function<void(int i, spirv::Value v)> f);
+  // Get the pointer to a cooperative matrix, the fragment[index] of the wmma intrinsics.
+  spirv::Value GetFragmentPointer(const PrimExpr& fragment, const PrimExpr& index);
+  // Get the element pointer of a tvm_access_ptr a fragment is loaded from or stored to.
+  spirv::Value GetFragmentMemoryPointer(const PrimExpr& buffer_ptr, DataType elem_type);
   // SPIRV-related capabilities of the target
   SPIRVSupport spirv_support_;
   // The builder
@@ -151,6 +155,10 @@ class CodeGenSPIRV : public ExprFunctor<spirv::Value(const PrimExpr&)>,
   uint32_t weight_likely_branch_{128};
   // the storage scope of allocation
   std::unordered_map<const VarNode*, StorageInfo> storage_info_;
+  // The shapes "m, n, k" of the fragments of the wmma intrinsics.
+  std::unordered_map<const VarNode*, std::string> fragment_shapes_;
+  // The cooperative matrix types of the fragments.
+  std::unordered_map<const VarNode*, spirv::SType> fragment_types_;
   // The definition of local variable.
   std::unordered_map<const VarNode*, spirv::Value> var_map_;
   // The analyzer.
@@ -196,6 +196,57 @@ Value IRBuilder::StructArrayAccess(const SType& res_type, Value buffer, Value in
   return MakeValue(spv::OpInBoundsAccessChain, res_type, buffer, const_i32_zero_, index);
 }
 
+SType IRBuilder::GetCooperativeMatrixType(const SType& elem_type, uint32_t rows, uint32_t cols) {
+  auto key = std::make_tuple(elem_type.id, rows, cols);
+  auto it = cooperative_matrix_type_tbl_.find(key);
+  if (it != cooperative_matrix_type_tbl_.end()) {
+    return it->second;
+  }
+  ICHECK(spirv_support_.supports_cooperative_matrix)
+      << "Vulkan target does not support cooperative matrices.  "
+      << "Try enabling with -supports_cooperative_matrix=1, "
+      << "requires VK_NV_cooperative_matrix";
+  capabilities_used_.insert(spv::CapabilityCooperativeMatrixNV);
+  extensions_used_.insert("SPV_NV_cooperative_matrix");
+
+  Value scope = UIntImm(t_uint32_, spv::ScopeSubgroup);
+  Value num_rows = UIntImm(t_uint32_, rows);
+  Value num_cols = UIntImm(t_uint32_, cols);
+  SType t;
+  t.id = id_counter_++;
+  t.type = elem_type.type;
+  t.element_type_id = elem_type.id;
+  ib_.Begin(spv::OpTypeCooperativeMatrixNV)
+      .AddSeq(t, elem_type, scope, num_rows, num_cols)
+      .Commit(&global_);
+  cooperative_matrix_type_tbl_[key] = t;
+  return t;
+}
+
+Value IRBuilder::AllocateCooperativeMatrices(const SType& matrix_type, uint32_t num_elems) {
+  ICHECK_NE(num_elems, 0U);
+  // The matrices are opaque, the array has no explicit layout.
+  SType arr_type;
+  arr_type.id = id_counter_++;
+  arr_type.type = DataType::Handle();
+  arr_type.element_type_id = matrix_type.id;
+  Value length = UIntImm(t_uint32_, num_elems);
+  ib_.Begin(spv::OpTypeArray).AddSeq(arr_type, matrix_type, length).Commit(&global_);
+
+  SType ptr_type = GetPointerType(arr_type, spv::StorageClassFunction);
+  Value val = NewValue(ptr_type, kCooperativeMatrixArrayPtr);
+  ib_.Begin(spv::OpVariable)
+      .AddSeq(ptr_type, val, spv::StorageClassFunction)
+      .Commit(&func_header_);
+  return val;
+}
+
+Value IRBuilder::CooperativeMatrixAccess(const SType& matrix_type, Value matrices, Value index) {
+  ICHECK(matrices.flag == kCooperativeMatrixArrayPtr);
+  SType ptr_type = GetPointerType(matrix_type, spv::StorageClassFunction);
+  return MakeValue(spv::OpInBoundsAccessChain, ptr_type, matrices, index);
+}
+
 Value IRBuilder::IntImm(const SType& dtype, int64_t value) {
   return GetConst_(dtype, reinterpret_cast<uint64_t*>(&value));
 }
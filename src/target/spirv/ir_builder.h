@@ -65,7 +65,8 @@ enum ValueKind {
   kPushConstantPtr,
   kFunction,
   kExtInst,
-  kUniformPtr
+  kUniformPtr,
+  kCooperativeMatrixArrayPtr
 };
 
 /*! \brief Represent the SPIRV Value */
@@ -446,6 +447,28 @@ class IRBuilder {
    * \param index The array index.
    */
   Value StructArrayAccess(const SType& ptr_type, Value buffer, Value index);
+  /*!
+   * \brief Get the type of a cooperative matrix, distributed over the invocations of a subgroup.
+   * \param elem_type The element type.
+   * \param rows The number of rows.
+   * \param cols The number of columns.
+   * \return The corresponding spirv type.
+   */
+  SType GetCooperativeMatrixType(const SType& elem_type, uint32_t rows, uint32_t cols);
+  /*!
+   * \brief Allocate an array of cooperative matrices in the function storage.
+   * \param matrix_type The cooperative matrix type.
+   * \param num_elems The number of matrices.
+   * \return The pointer to the array.
+   */
+  Value AllocateCooperativeMatrices(const SType& matrix_type, uint32_t num_elems);
+  /*!
+   * \brief Get the pointer to a matrix of an array of cooperative matrices.
+   * \param matrix_type The cooperative matrix type.
+   * \param matrices The pointer to the array.
+   * \param index The index of the matrix.
+   */
+  Value CooperativeMatrixAccess(const SType& matrix_type, Value matrices, Value index);
   /*!
    * \brief Create a cast that cast value to dst_type
    * \param dst_type The target type.
@@ -638,6 +661,8 @@ class IRBuilder {
   std::unordered_map<uint32_t, SType> pod_type_tbl_;
   /*! \brief map from value to array type */
   std::map<std::tuple<uint32_t, uint32_t, bool>, SType> struct_array_type_tbl_;
+  /*! \brief map from element type and shape to the cooperative matrix type */
+  std::map<std::tuple<uint32_t, uint32_t, uint32_t>, SType> cooperative_matrix_type_tbl_;
   /*! \brief map from value to its pointer type */
   std::map<std::pair<uint32_t, spv::StorageClass>, SType> pointer_type_tbl_;
   /*! \brief map from constant int to its value */
@@ -232,6 +232,22 @@ struct SPIRVSupport {
    * attempting to create a 64-bit int.
    */
   bool supports_int64{false};
+
+  /*!
+   * \brief Whether the driver supports the subgroup cooperative matrices
+   *
+   * Vulkan extension: VK_NV_cooperative_matrix
+   * Vulkan struct: VkPhysicalDeviceCooperativeMatrixFeaturesNV
+   * Device Property: cooperativeMatrix
+   * SPV Extension name: SPV_NV_cooperative_matrix
+   * SPV Capability: CooperativeMatrixNV
+   *
+   * If support is present, the fragments of the wmma intrinsics are
+   * generated as cooperative matrices.  If support is not present,
+   * codegen will throw exception on attempting to allocate a
+   * fragment.
+   */
+  bool supports_cooperative_matrix{false};
 };
 
 }  // namespace codegen
@@ -258,11 +258,19 @@ TVM_REGISTER_TARGET_KIND("llvm", kDLCPU)
     .add_attr_option<Bool>("system-lib")
     .add_attr_option<String>("runtime")
     .add_attr_option<Bool>("link-params", Bool(false))
+    .add_attr_option<String>("executor")
+    .add_attr_option<Integer>("opt-level")
+    .add_attr_option<Bool>("loop-vectorize")
+    .add_attr_option<Bool>("slp-vectorize")
+    .add_attr_option<Bool>("unroll-loops")
+    .add_attr_option<String>("profile-generate")
+    .add_attr_option<String>("profile-use")
     .set_default_keys({"cpu"});
 
 TVM_REGISTER_TARGET_KIND("c", kDLCPU)
     .add_attr_option<Bool>("system-lib")
     .add_attr_option<Bool>("link-params", Bool(false))
+    .add_attr_option<Bool>("link-params-raw")
     .add_attr_option<String>("runtime")
     .add_attr_option<String>("mcpu")
     .add_attr_option<String>("march")
@@ -326,6 +334,7 @@ TVM_REGISTER_TARGET_KIND("vulkan", kDLVulkan)
     .add_attr_option<Bool>("supports_storage_buffer_storage_class")
     .add_attr_option<Bool>("supports_push_descriptor")
     .add_attr_option<Bool>("supports_dedicated_allocation")
+    .add_attr_option<Bool>("supports_cooperative_matrix")
     .add_attr_option<Integer>("supported_subgroup_operations")
     // Physical device limits
     .add_attr_option<Integer>("max_num_threads")
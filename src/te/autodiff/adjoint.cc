@@ -29,7 +29,12 @@
  *        (2) multiply the Jacobian (PartialAdjoint),
  *        (3) and sum them together to get the adjoint of the input itself.
  *        The three steps are computed recursively.
+ *        When the consumer reads the input at plain iteration variables, e.g. elementwise ops,
+ *        broadcasts, transposes and sum reductions like dense, step (2) is done directly without
+ *        building the Jacobian (DirectVectorJacobianProduct).
  */
+#include <tvm/arith/analyzer.h>
+#include <tvm/node/structural_equal.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/te/autodiff.h>
 #include <tvm/tir/stmt_functor.h>
@@ -37,6 +42,8 @@
 #include <tvm/topi/transform.h>
 
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "ad_utils.h"
@@ -61,7 +68,154 @@ Tensor Identity(const Tensor& output) {
   return te::compute(shape, func, "identity");
 }
 
+/*! \brief Replace the loads of a tensor by a variable. */
+class TensorToVarMutator : public ExprMutator {
+ public:
+  TensorToVarMutator(const Tensor& tensor, const Var& var) : tensor_(tensor), var_(var) {}
+
+  PrimExpr VisitExpr_(const ProducerLoadNode* op) final {
+    if (Downcast<Tensor>(op->producer) == tensor_) {
+      return var_;
+    }
+    return ExprMutator::VisitExpr_(op);
+  }
+
+ private:
+  Tensor tensor_;
+  Var var_;
+};
+
+/*! \brief Check whether the reduction is a plain sum, which is linear in its source. */
+bool IsSumReduction(const ReduceNode* red) {
+  const CommReducerNode* combiner = red->combiner.get();
+  if (red->source.size() != 1 || !red->init.empty() || !is_one(red->condition) ||
+      combiner->result.size() != 1 || !is_zero(combiner->identity_element[0])) {
+    return false;
+  }
+  const AddNode* add = combiner->result[0].as<AddNode>();
+  if (add == nullptr) {
+    return false;
+  }
+  const VarNode* a = add->a.as<VarNode>();
+  const VarNode* b = add->b.as<VarNode>();
+  const VarNode* lhs = combiner->lhs[0].get();
+  const VarNode* rhs = combiner->rhs[0].get();
+  return (a == lhs && b == rhs) || (a == rhs && b == lhs);
+}
+
+/*!
+ * \brief Compute the product of head and the Jacobian of output wrt input without the Jacobian.
+ *
+ *  When output(o) = f(input(v)) or output(o) = sum_r f(input(v)), where the indices v of the
+ *  only access to input are distinct variables of o and r, the adjoint of input(v) is
+ *  head(o) * df/dinput(v) summed over the variables of o and r missing from v. This covers the
+ *  elementwise ops, broadcasts, transposes, dense and the weights of conv2d, which would otherwise
+ *  go through a Jacobian of shape output.shape + input.shape and the elimination of its zeros.
+ *
+ * \return The adjoint, or an undefined tensor if output does not have this form.
+ */
+Tensor DirectVectorJacobianProduct(const Tensor& output, const Tensor& input,
+                                   const Tensor& head) {
+  const ComputeOpNode* op = output->op.as<ComputeOpNode>();
+  if (op == nullptr || op->body.size() != 1) {
+    return Tensor();
+  }
+  PrimExpr body = op->body[0];
+  Array<IterVar> axes = op->axis;
+  if (const ReduceNode* red = body.as<ReduceNode>()) {
+    if (!IsSumReduction(red)) {
+      return Tensor();
+    }
+    body = red->source[0];
+    for (const IterVar& iv : red->axis) {
+      axes.push_back(iv);
+    }
+  }
+
+  // Find the only access to input, nested reductions are left to the Jacobian.
+  Optional<Array<PrimExpr>> indices;
+  bool is_direct = true;
+  PostOrderVisit(body, [&](const ObjectRef& node) {
+    if (const auto* load = node.as<ProducerLoadNode>()) {
+      if (Downcast<Tensor>(load->producer) == input) {
+        if (!indices.defined()) {
+          indices = load->indices;
+        } else if (!StructuralEqual()(indices.value(), load->indices)) {
+          is_direct = false;
+        }
+      }
+    } else if (node.as<ReduceNode>()) {
+      is_direct = false;
+    }
+  });
+  if (!is_direct || !indices.defined()) {
+    return Tensor();
+  }
+  std::unordered_map<const VarNode*, size_t> axis_index;
+  for (size_t i = 0; i < axes.size(); ++i) {
+    axis_index[axes[i]->var.get()] = i;
+  }
+  std::vector<size_t> index_axes;
+  std::unordered_set<size_t> used_axes;
+  for (const PrimExpr& index : indices.value()) {
+    const VarNode* var = index.as<VarNode>();
+    if (var == nullptr || !axis_index.count(var) || used_axes.count(axis_index[var])) {
+      return Tensor();
+    }
+    index_axes.push_back(axis_index[var]);
+    used_axes.insert(axis_index[var]);
+  }
+
+  // Differentiate the body wrt a variable standing for input(v).
+  arith::Analyzer analyzer;
+  Var input_var("input_value", input->dtype);
+  PrimExpr derivative =
+      analyzer.Simplify(Derivative(TensorToVarMutator(input, input_var)(body), input_var));
+  derivative = Substitute(derivative, {{input_var, ProducerLoad(input, indices.value())}});
+
+  size_t prefix = head->shape.size() - output->shape.size();
+  Array<PrimExpr> shape(head->shape.begin(), head->shape.begin() + prefix);
+  for (const PrimExpr& e : input->shape) {
+    shape.push_back(e);
+  }
+  auto fcompute = [&](const Array<Var>& vars) {
+    Map<Var, PrimExpr> vmap;
+    PrimExpr cond = const_true();
+    for (size_t i = 0; i < index_axes.size(); ++i) {
+      const IterVar& iv = axes[index_axes[i]];
+      PrimExpr var = vars[prefix + i];
+      vmap.Set(iv->var, var);
+      // The input may be larger than the range it is read in, e.g. when output is a slice.
+      if (!is_zero(iv->dom->min) || !analyzer.CanProveEqual(iv->dom->extent, input->shape[i])) {
+        cond = cond && var >= iv->dom->min && var < iv->dom->min + iv->dom->extent;
+      }
+    }
+    Array<IterVar> sum_axes;
+    for (size_t i = 0; i < axes.size(); ++i) {
+      if (!used_axes.count(i)) {
+        IterVar iv = reduce_axis(axes[i]->dom, axes[i]->var->name_hint + ".adj");
+        vmap.Set(axes[i]->var, iv->var);
+        sum_axes.push_back(iv);
+      }
+    }
+    Array<PrimExpr> head_indices(vars.begin(), vars.begin() + prefix);
+    for (const IterVar& iv : op->axis) {
+      head_indices.push_back(vmap.at(iv->var));
+    }
+    PrimExpr value = Mul(head(head_indices), Substitute(derivative, vmap));
+    if (!is_one(cond)) {
+      value = Select(cond, value, make_zero(value.dtype()));
+    }
+    return sum_axes.empty() ? value : sum(value, sum_axes);
+  };
+  return te::compute(shape, fcompute, output->op->name + "." + input->op->name + ".grad");
+}
+
 Tensor VectorJacobianProduct(const Tensor& output, const Tensor& input, const Tensor& head) {
+  Tensor direct = DirectVectorJacobianProduct(output, input, head);
+  if (direct.defined()) {
+    return direct;
+  }
   Tensor jac = Jacobian(output, input);
   Tensor result = topi::tensordot(head, jac, /*axes=*/output->shape.size(),
                                   output->op->name + "." + input->op->name + ".grad");
@@ -25,6 +25,7 @@
 #include <tvm/te/operation.h>
 #include <tvm/te/schedule_pass.h>
 
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -49,6 +50,14 @@ struct GraphContext {
   std::unordered_map<IterVar, IterVar> bind_map;
   /*! \brief map from op to stage */
   std::unordered_map<const Object*, Stage> op2stage_;
+  /*!
+   * \brief The domains of the iter vars of the consumers passed up from their leaf iter vars,
+   *  by consumer op and by how its leaf iter vars are relaxed. A consumer passes up the same
+   *  domains for each of its producers that relaxes its loops the same way.
+   */
+  mutable std::unordered_map<const Object*,
+                             std::unordered_map<std::string, std::unordered_map<IterVar, IntSet>>>
+      up_domain_cache;
 };
 
 bool NeedRelax(const IterVar& iv, bool found_attach,
@@ -131,6 +140,8 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
   for (const Operation& op : consumers) {
     Map<Var, IntSet> relax_set;
     std::unordered_map<IterVar, IntSet> up_state;
+    // How each leaf iter var of the consumer is relaxed, keys the domains passed up
+    std::string relax_key;
     bool found_attach = false;
     ICHECK(ctx.op2stage_.count(op.get()));
     const Stage& op_stage = ctx.op2stage_.at(op.get());
@@ -145,6 +156,7 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
       const Range& vrange = it->second;
       if (is_one(vrange->extent)) {
         up_state[iv] = IntSet::SinglePoint(vrange->min);
+        relax_key.push_back('p');
       } else if (!NeedRelax(iv, found_attach, ctx.bind_map, scope)) {
         ICHECK(is_zero(vrange->min)) << "InferBound requires every leaf iter var's min equals 0, "
                                      << " call schedule.normalize to achieve this. ";
@@ -153,8 +165,10 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
         } else {
           up_state[iv] = IntSet::SinglePoint(iv->var);
         }
+        relax_key.push_back('v');
       } else {
         up_state[iv] = IntSet::FromRange(vrange);
+        relax_key.push_back('r');
       }
     }
     // Consumer's attach nest
@@ -175,12 +189,19 @@ void InferRootBound(const Stage& stage, const GraphContext& ctx,
     ICHECK(found_attach || stage_attach.size() == 0)
         << "Invalid Schedule, cannot find the producer " << stage->op
         << " along the loop nest specified by compute_at of consumer " << op;
-    // Get the domain of the consumer
-    PassUpDomain(op_stage, *rmap, &up_state);
+    // Get the domain of the consumer, the bounds of its iter vars are final by now
+    auto& up_domains = ctx.up_domain_cache[op.get()];
+    auto cached = up_domains.find(relax_key);
+    if (cached != up_domains.end()) {
+      up_state = cached->second;
+    } else {
+      PassUpDomain(op_stage, *rmap, &up_state);
+      up_domains.emplace(relax_key, up_state);
+    }
     // Relax if needed.
     std::unordered_map<const VarNode*, IntSet> dom_map;
     arith::Analyzer analyzer;
-    for (auto entry : *rmap) {
+    for (const auto& entry : *rmap) {
       analyzer.Bind(entry.first->var, entry.second);
     }
     for (auto iv : op->root_iter_vars()) {
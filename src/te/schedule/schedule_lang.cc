@@ -416,10 +416,12 @@ Stage& Stage::storage_align(IterVar axis, int factor, int offset) {
   return *this;
 }
 
-Stage& Stage::double_buffer() {
+Stage& Stage::double_buffer(int num_stages) {
   StageNode* self = operator->();
   ICHECK(!self->is_output) << "Cannot apply double buffer on output";
+  ICHECK_GE(num_stages, 2) << "Double buffer needs at least 2 stages";
   self->double_buffer = true;
+  self->num_buffer_stages = num_stages;
   return *this;
 }
 
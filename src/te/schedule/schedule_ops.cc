@@ -44,7 +44,7 @@ Stmt MakePipeline(const Stage& s, const std::unordered_map<IterVar, Range>& dom_
                   bool debug_keep_trivial_loop) {
   Stmt producer = s->op->BuildProvide(s, dom_map, debug_keep_trivial_loop);
   if (s->double_buffer) {
-    producer = AttrStmt(s->op, tir::attr::double_buffer_scope, 1, producer);
+    producer = AttrStmt(s->op, tir::attr::double_buffer_scope, s->num_buffer_stages, producer);
   }
   Stmt pipeline = producer;
 
@@ -70,6 +70,8 @@ class InjectAttach : public StmtMutator {
 
   Stmt VisitStmt(const Stmt& input_stmt) final {
     ICHECK(input_stmt.defined());
+    // The loops of a stage are made once, so the rest of the body holds no other attach point
+    if (found_attach) return input_stmt;
     auto stmt = StmtMutator::VisitStmt(input_stmt);
     const AttrStmtNode* op = stmt.as<AttrStmtNode>();
     if (op != nullptr && op->attr_key == tir::attr::loop_scope) {
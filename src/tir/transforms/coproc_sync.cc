@@ -21,13 +21,17 @@
  * \file coproc_sync.cc
  */
 #include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
 #include <tvm/tir/builtin.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "ir_utils.h"
 #include "storage_access.h"
@@ -574,6 +578,142 @@ class CoProcInstDepDetector : public StmtVisitor {
   Op sync_push_op_, sync_pop_op_;
 };
 
+// Remove the synchronization proven redundant by a dataflow pass over each sequence:
+// - a push/pop pair of an (a, b) dependency is redundant when context a issued no instruction
+//   since the same pair or since a coproc_sync, the instructions of b already wait for its last
+//   one. The pair is removed as a whole, so the tokens stay balanced.
+// - a coproc_sync is redundant when no context issued an instruction since the last one, which
+//   may end the previous statement.
+// - a barrier is redundant when the same barrier precedes it with only synchronization between.
+class CoProcSyncEliminator : public StmtMutator {
+ public:
+  // The ops are matched by name, a co-processor may not register all of them
+  explicit CoProcSyncEliminator(const std::string& coproc_name)
+      : prefix_("tir." + coproc_name + ".coproc_") {}
+
+  Stmt VisitStmt_(const SeqStmtNode* op) final {
+    Stmt stmt = StmtMutator::VisitStmt_(op);
+    op = stmt.as<SeqStmtNode>();
+    if (op == nullptr) return stmt;
+    // The dependencies holding for the next instruction of their destination context
+    std::set<std::pair<int, int> > established;
+    // The contexts which issued an instruction since the last coproc_sync, all of them if none
+    std::set<int> issued;
+    bool synced = false;
+    // The barriers since the last statement touching the memory
+    std::vector<const CallNode*> barriers;
+    Array<Stmt> seq;
+    for (size_t i = 0; i < op->seq.size(); ++i) {
+      const CallNode* call = AsCall(op->seq[i]);
+      if (call != nullptr && IsOp(call, "dep_push") && i + 1 < op->seq.size()) {
+        const CallNode* next = AsCall(op->seq[i + 1]);
+        if (next != nullptr && IsOp(next, "dep_pop")) {
+          std::pair<int, int> dep = GetDep(call);
+          if (dep == GetDep(next)) {
+            if (!established.count(dep) && !(synced && !issued.count(dep.first))) {
+              established.insert(dep);
+              seq.push_back(op->seq[i]);
+              seq.push_back(op->seq[i + 1]);
+            }
+            ++i;
+            continue;
+          }
+        }
+      }
+      if (call != nullptr && IsOp(call, "sync")) {
+        if (!synced || !issued.empty()) seq.push_back(op->seq[i]);
+        synced = true;
+        issued.clear();
+        continue;
+      }
+      if (call != nullptr && (IsOp(call, "dep_push") || IsOp(call, "dep_pop"))) {
+        seq.push_back(op->seq[i]);
+        continue;
+      }
+      if (call != nullptr && (IsOp(call, "read_barrier") || IsOp(call, "write_barrier"))) {
+        bool repeated = false;
+        for (const CallNode* prev : barriers) {
+          repeated = repeated || deep_equal_(GetRef<PrimExpr>(prev), GetRef<PrimExpr>(call));
+        }
+        if (!repeated) {
+          barriers.push_back(call);
+          seq.push_back(op->seq[i]);
+        }
+        continue;
+      }
+      // Any other statement may touch the memory and issue instructions in its contexts
+      barriers.clear();
+      for (int ctx : IssuedContexts(op->seq[i])) {
+        issued.insert(ctx);
+        for (auto it = established.begin(); it != established.end();) {
+          it = it->first == ctx ? established.erase(it) : std::next(it);
+        }
+      }
+      if (EndsWithSync(op->seq[i])) {
+        synced = true;
+        issued.clear();
+      }
+      seq.push_back(op->seq[i]);
+    }
+    if (seq.size() == op->seq.size()) return stmt;
+    return SeqStmt::Flatten(seq);
+  }
+
+ private:
+  static const CallNode* AsCall(const Stmt& stmt) {
+    const auto* eval = stmt.as<EvaluateNode>();
+    return eval != nullptr ? eval->value.as<CallNode>() : nullptr;
+  }
+
+  static std::pair<int, int> GetDep(const CallNode* call) {
+    const auto* from = call->args[0].as<IntImmNode>();
+    const auto* to = call->args[1].as<IntImmNode>();
+    if (from == nullptr || to == nullptr) return {-1, -1};
+    return {static_cast<int>(from->value), static_cast<int>(to->value)};
+  }
+
+  bool IsOp(const CallNode* call, const char* name) const {
+    const auto* op = call->op.as<OpNode>();
+    return op != nullptr && op->name == prefix_ + name;
+  }
+
+  // Whether the last statement run by the scope is a coproc_sync
+  bool EndsWithSync(Stmt stmt) const {
+    while (true) {
+      if (const auto* op = stmt.as<SeqStmtNode>()) {
+        stmt = op->seq.back();
+      } else if (const auto* op = stmt.as<AttrStmtNode>()) {
+        if (op->attr_key == attr::coproc_scope) return false;
+        stmt = op->body;
+      } else if (const auto* op = stmt.as<AllocateNode>()) {
+        stmt = op->body;
+      } else if (const auto* op = stmt.as<LetStmtNode>()) {
+        stmt = op->body;
+      } else {
+        const CallNode* call = AsCall(stmt);
+        return call != nullptr && IsOp(call, "sync");
+      }
+    }
+  }
+
+  static std::unordered_set<int> IssuedContexts(const Stmt& stmt) {
+    std::unordered_set<int> contexts;
+    PostOrderVisit(stmt, [&contexts](const ObjectRef& node) {
+      if (const auto* op = node.as<AttrStmtNode>()) {
+        if (op->attr_key == attr::coproc_scope) {
+          const auto* ctx_id = op->value.as<IntImmNode>();
+          ICHECK(ctx_id != nullptr);
+          contexts.insert(static_cast<int>(ctx_id->value));
+        }
+      }
+    });
+    return contexts;
+  }
+
+  std::string prefix_;
+  ExprDeepEqual deep_equal_;
+};
+
 class CoProcSyncInserter : public StmtMutator {
  public:
   Stmt Insert(Stmt stmt) {
@@ -619,7 +759,7 @@ class CoProcSyncInserter : public StmtMutator {
       auto& vec = insert_after_[kv.first];
       vec.insert(vec.end(), kv.second.begin(), kv.second.end());
     }
-    return operator()(std::move(stmt));
+    return CoProcSyncEliminator(coproc_name)(operator()(std::move(stmt)));
   }
 
   Stmt VisitStmt(const Stmt& stmt) final {
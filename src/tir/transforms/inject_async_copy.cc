@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \brief Replace the copies of global memory into shared buffers marked by the
+ *  async_copy pragma with asynchronous copies.
+ * \file inject_async_copy.cc
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "ir_utils.h"
+
+namespace tvm {
+namespace tir {
+
+class AsyncCopyInjector : public StmtMutator {
+ public:
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::storage_scope) {
+      storage_scope_[op->node.as<VarNode>()] = op->value.as<StringImmNode>()->value;
+    } else if (op->attr_key == pragma_key_) {
+      // The copies of the scope land before its end, so the copies of the threads overlap
+      // each other and do not go through the registers.
+      std::string scope;
+      bool in_scope = in_async_scope_;
+      in_async_scope_ = true;
+      std::swap(scope, async_scope_);
+      Stmt body = this->VisitStmt(op->body);
+      std::swap(scope, async_scope_);
+      in_async_scope_ = in_scope;
+      if (scope.empty()) return body;
+      Stmt commit = Evaluate(Call(DataType::Int(32), builtin::tvm_async_commit_group(), {}));
+      Stmt wait = Evaluate(Call(DataType::Int(32), builtin::tvm_async_wait_group(),
+                                {make_const(DataType::Int(32), 0)}));
+      Stmt sync =
+          Evaluate(Call(DataType::Int(32), builtin::tvm_storage_sync(), {StringImm(scope)}));
+      return SeqStmt({body, commit, wait, sync});
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const AllocateNode* op) final {
+    allocated_.insert(op->buffer_var.get());
+    return StmtMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const StoreNode* op) final {
+    if (!in_async_scope_) return StmtMutator::VisitStmt_(op);
+    auto it = storage_scope_.find(op->buffer_var.get());
+    if (it == storage_scope_.end() || it->second.rfind("shared", 0) != 0) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    if (Optional<Stmt> copy = MakeAsyncCopy(op, allocated_)) {
+      async_scope_ = it->second;
+      return copy.value();
+    }
+    return StmtMutator::VisitStmt_(op);
+  }
+
+ private:
+  // The pragma marking the copies
+  const std::string pragma_key_ = std::string(attr::pragma_scope_prefix) + "async_copy";
+  // Whether we are inside the pragma scope.
+  bool in_async_scope_{false};
+  // The storage scope of the asynchronous copies of the pragma scope, empty when there are none.
+  std::string async_scope_;
+  // The storage scopes of the buffers
+  std::unordered_map<const VarNode*, std::string> storage_scope_;
+  // The buffers allocated by the function
+  std::unordered_set<const VarNode*> allocated_;
+};
+
+namespace transform {
+
+Pass InjectAsyncCopy() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = AsyncCopyInjector()(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.InjectAsyncCopy", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.InjectAsyncCopy").set_body_typed(InjectAsyncCopy);
+
+}  // namespace transform
+
+}  // namespace tir
+}  // namespace tvm
@@ -19,6 +19,12 @@
 
 /*!
  * \brief Inject double buffering optimization for data fetch.
+ *
+ *  With N buffers the loop runs as a software pipeline: the prologue fetches the
+ *  first N - 1 iterations, and each iteration fetches the data of N - 1 iterations
+ *  later into the buffer consumed by the previous one. The copies of global memory
+ *  into shared buffers can be issued as asynchronous copies, whose group of each
+ *  iteration lands once at most N - 1 later groups are in flight.
  * \file inject_double_buffer.cc
  */
 #include <tvm/runtime/registry.h>
@@ -26,6 +32,12 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "ir_utils.h"
 
 namespace tvm {
@@ -33,9 +45,13 @@ namespace tir {
 
 struct InjectDoubleBufferConfigNode : public tvm::AttrsNode<InjectDoubleBufferConfigNode> {
   int split_loop;
+  bool use_async_copy;
 
   TVM_DECLARE_ATTRS(InjectDoubleBufferConfigNode, "tir.transform.InjectDoubleBufferConfig") {
     TVM_ATTR_FIELD(split_loop).describe("Split loop factors").set_default(1);
+    TVM_ATTR_FIELD(use_async_copy)
+        .describe("Fetch the shared buffers with the asynchronous copies of the device")
+        .set_default(false);
   }
 };
 
@@ -82,7 +98,8 @@ class StripDoubleBufferWrite : public StmtMutator {
 
 class DoubleBufferInjector : public StmtExprMutator {
  public:
-  explicit DoubleBufferInjector(int split_loop) : split_loop_(split_loop) {}
+  DoubleBufferInjector(int split_loop, bool use_async_copy)
+      : split_loop_(split_loop), use_async_copy_(use_async_copy) {}
 
   Stmt Inject(Stmt stmt) {
     DoubleBufferDetector detector;
@@ -112,6 +129,7 @@ class DoubleBufferInjector : public StmtExprMutator {
   }
 
   Stmt VisitStmt_(const AllocateNode* op) final {
+    allocated_.insert(op->buffer_var.get());
     auto it = dbuffer_info_.find(op->buffer_var.get());
     if (it != dbuffer_info_.end()) {
       it->second.stride = foldl([](PrimExpr a, PrimExpr b, Span span) { return mul(a, b, span); },
@@ -119,7 +137,7 @@ class DoubleBufferInjector : public StmtExprMutator {
                           op->dtype.lanes();
       Stmt stmt = StmtExprMutator::VisitStmt_(op);
       op = stmt.as<AllocateNode>();
-      Array<PrimExpr> new_extents{make_const(op->extents[0].dtype(), 2)};
+      Array<PrimExpr> new_extents{make_const(op->extents[0].dtype(), it->second.num_stages)};
       for (PrimExpr e : op->extents) {
         new_extents.push_back(e);
       }
@@ -187,8 +205,12 @@ class DoubleBufferInjector : public StmtExprMutator {
       const StorageEntry& e = it->second;
       ICHECK(in_double_buffer_scope_);
       ICHECK(e.stride.defined());
-      return Store(op->buffer_var, op->value, e.switch_write_var * e.stride + op->index,
-                   op->predicate);
+      Store store(op->buffer_var, op->value, e.switch_write_var * e.stride + op->index,
+                  op->predicate);
+      if (e.async) {
+        if (auto copy = MakeAsyncCopy(store.as<StoreNode>(), allocated_)) return copy.value();
+      }
+      return std::move(store);
     } else {
       return stmt;
     }
@@ -225,26 +247,49 @@ class DoubleBufferInjector : public StmtExprMutator {
     }
     StorageEntry& e = it->second;
     e.loop = loop_nest_.back();
-    PrimExpr zero = make_const(e.loop->loop_var.dtype(), 0);
-    PrimExpr one = make_const(e.loop->loop_var.dtype(), 1);
-    PrimExpr two = make_const(e.loop->loop_var.dtype(), 2);
-    PrimExpr loop_shift = e.loop->loop_var + one;
-    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", e.loop->loop_var.dtype());
-    e.switch_read_var = indexmod(e.loop->loop_var, two);
+    if (const auto* num_stages = op->value.as<IntImmNode>()) {
+      e.num_stages = std::max<int>(num_stages->value, 2);
+    }
+    e.async = use_async_copy_ && e.scope.rfind("shared", 0) == 0;
+    DataType dtype = e.loop->loop_var.dtype();
+    PrimExpr num_stages = make_const(dtype, e.num_stages);
+    PrimExpr loop_shift = e.loop->loop_var + make_const(dtype, e.num_stages - 1);
+    e.switch_write_var = Var(e.loop->loop_var->name_hint + ".db", dtype);
+    e.switch_read_var = indexmod(e.loop->loop_var, num_stages);
     in_double_buffer_scope_ = true;
     Stmt body = this->VisitStmt(op->body);
     in_double_buffer_scope_ = false;
     std::unordered_map<const VarNode*, PrimExpr> vmap;
-    vmap[e.switch_write_var.get()] = zero;
-    vmap[e.loop->loop_var.get()] = zero;
-    loop_pre_[e.loop].emplace_back(Substitute(body, vmap));
+    // The prologue fetches the first num_stages - 1 iterations.
+    for (int i = 0; i < e.num_stages - 1; ++i) {
+      PrimExpr iter = make_const(dtype, i);
+      vmap[e.switch_write_var.get()] = iter;
+      vmap[e.loop->loop_var.get()] = iter;
+      Stmt fetch = Substitute(body, vmap);
+      if (i != 0) fetch = IfThenElse(iter < e.loop->extent, fetch);
+      loop_pre_[e.loop].emplace_back(fetch);
+      if (e.async) loop_pre_[e.loop].emplace_back(AsyncCommitGroup());
+    }
     vmap[e.loop->loop_var.get()] = loop_shift;
-    vmap[e.switch_write_var.get()] = indexmod(loop_shift, two);
+    vmap[e.switch_write_var.get()] = indexmod(loop_shift, num_stages);
     body = Substitute(body, vmap);
     body = AttrStmt(buffer, attr::double_buffer_write, 1, body);
     body = IfThenElse(loop_shift < e.loop->extent, body);
+    if (e.async) {
+      // Every iteration commits a group, even an empty one, so that the group of the current
+      // iteration has landed once at most the num_stages - 1 later ones are in flight.
+      Stmt wait = Evaluate(Call(DataType::Int(32), builtin::tvm_async_wait_group(),
+                                {make_const(DataType::Int(32), e.num_stages - 1)}));
+      Stmt sync = Evaluate(
+          Call(DataType::Int(32), builtin::tvm_storage_sync(), {StringImm(e.scope)}));
+      body = SeqStmt({body, AsyncCommitGroup(), wait, sync});
+    }
     return body;
   }
+
+  Stmt AsyncCommitGroup() const {
+    return Evaluate(Call(DataType::Int(32), builtin::tvm_async_commit_group(), {}));
+  }
   // Storage entry for those who need double buffering.
   struct StorageEntry {
     // The size of the buffer
@@ -257,9 +302,15 @@ class DoubleBufferInjector : public StmtExprMutator {
     PrimExpr switch_read_var;
     // The storage scope.
     std::string scope;
+    // The number of buffers.
+    int num_stages{2};
+    // Whether the stores are issued as asynchronous copies.
+    bool async{false};
   };
   // Whether split loop
   int32_t split_loop_;
+  // Whether to fetch the shared buffers with asynchronous copies
+  bool use_async_copy_;
   // Whether we are inside double buffer scope.
   bool in_double_buffer_scope_{false};
   // The current loop next
@@ -270,6 +321,8 @@ class DoubleBufferInjector : public StmtExprMutator {
   std::unordered_map<const ForNode*, std::vector<Stmt> > loop_pre_;
   // The allocation size of the buffer
   std::unordered_map<const VarNode*, StorageEntry> dbuffer_info_;
+  // The buffers allocated by the function
+  std::unordered_set<const VarNode*> allocated_;
 };
 
 namespace transform {
@@ -281,7 +334,8 @@ Pass InjectDoubleBuffer() {
     if (!cfg.defined()) {
       cfg = AttrsWithDefaultValues<InjectDoubleBufferConfig>();
     }
-    n->body = DoubleBufferInjector(cfg.value()->split_loop).Inject(std::move(n->body));
+    n->body = DoubleBufferInjector(cfg.value()->split_loop, cfg.value()->use_async_copy)
+                  .Inject(std::move(n->body));
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.InjectDoubleBuffer", {});
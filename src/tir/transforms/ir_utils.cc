@@ -201,5 +201,34 @@ class IRConvertSSA final : public StmtExprMutator {
 
 Stmt ConvertSSA(Stmt stmt) { return IRConvertSSA()(std::move(stmt)); }
 
+Optional<Stmt> MakeAsyncCopy(const StoreNode* store,
+                             const std::unordered_set<const VarNode*>& local_buffers) {
+  const auto* load = store->value.as<LoadNode>();
+  DataType dtype = store->value.dtype();
+  int bytes = dtype.bytes() * dtype.lanes();
+  if (load == nullptr || local_buffers.count(load->buffer_var.get()) ||
+      !is_one(store->predicate) || !is_one(load->predicate) ||
+      (bytes != 4 && bytes != 8 && bytes != 16)) {
+    return NullOpt;
+  }
+  auto base_index = [&](const PrimExpr& index) -> PrimExpr {
+    if (dtype.lanes() == 1) return index;
+    const auto* ramp = index.as<RampNode>();
+    if (ramp != nullptr && is_one(ramp->stride)) return ramp->base;
+    return PrimExpr();
+  };
+  PrimExpr dst_index = base_index(store->index);
+  PrimExpr src_index = base_index(load->index);
+  if (!dst_index.defined() || !src_index.defined()) return NullOpt;
+  auto access_ptr = [&](const Var& buffer_var, const PrimExpr& offset, int rw_mask) {
+    return Call(DataType::Handle(), builtin::tvm_access_ptr(),
+                {TypeAnnotation(dtype.element_of()), buffer_var, offset,
+                 make_const(offset.dtype(), dtype.lanes()), rw_mask});
+  };
+  return Evaluate(Call(DataType::Int(32), builtin::tvm_async_copy(),
+                       {access_ptr(store->buffer_var, dst_index, 2),
+                        access_ptr(load->buffer_var, src_index, 1), bytes}));
+}
+
 }  // namespace tir
 }  // namespace tvm
@@ -29,6 +29,7 @@
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
 
+#include <unordered_set>
 #include <vector>
 
 namespace tvm {
@@ -168,6 +169,16 @@ inline int GetTempAllocaAlignment(DataType type, int32_t const_size) {
  */
 Stmt ConvertSSA(Stmt stmt);
 
+/*!
+ * \brief Issue the store of a load of global memory into a shared buffer as an
+ *  asynchronous copy.
+ * \param store The store.
+ * \param local_buffers The buffers allocated by the function, which are not global memory.
+ * \return The tvm_async_copy, NullOpt when the store is not a copy of 4, 8 or 16 bytes.
+ */
+Optional<Stmt> MakeAsyncCopy(const StoreNode* store,
+                             const std::unordered_set<const VarNode*>& local_buffers);
+
 }  // namespace tir
 }  // namespace tvm
 #endif  // TVM_TIR_TRANSFORMS_IR_UTILS_H_
@@ -28,8 +28,11 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <limits>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "../../arith/interval_set.h"
 #include "../../runtime/thread_storage_scope.h"
@@ -41,12 +44,18 @@ namespace tir {
 struct LoopPartitionConfigNode : public tvm::AttrsNode<LoopPartitionConfigNode> {
   bool partition_const_loop;
   bool no_unroll_loop_with_extent_one;
+  double code_size_budget;
 
   TVM_DECLARE_ATTRS(LoopPartitionConfigNode, "tir.transform.LoopPartitionConfig") {
     TVM_ATTR_FIELD(partition_const_loop).describe("Split constant loop").set_default(false);
     TVM_ATTR_FIELD(no_unroll_loop_with_extent_one)
         .describe("Don't unroll loops with extent 1")
         .set_default(false);
+    TVM_ATTR_FIELD(code_size_budget)
+        .describe(
+            "The largest code size after the partitioning, as a ratio of the size before, "
+            "the interior subranges get the budget before the edges. No limit when 0")
+        .set_default(0);
   }
 };
 
@@ -229,24 +238,12 @@ class PartitionFinder : public StmtExprVisitor {
 
   void VisitExpr_(const CallNode* op) final {
     if (op->op.same_as(builtin::likely())) {
-      PrimExpr cond = op->args[0];
-      if (ExprUseVars(cond, std::unordered_set<const VarNode*>({current_var_.get()}))) {
-        // For cond, find out the interval, if exists, in which we can prove that cond is
-        // true. Also find the interval, if exists, in which we can prove that cond is
-        // false.
-        IntSet interval = DeduceBound(current_var_, cond, hint_map_, relax_map_);
-        if (!interval.IsNothing()) {
-          // cond is true within interval
-          partitions[{cond, true}] = interval;
-        }
-        PrimExpr inverse_cond = InverseCond(cond);
-        if (inverse_cond.defined()) {
-          IntSet interval = DeduceBound(current_var_, inverse_cond, hint_map_, relax_map_);
-          if (!interval.IsNothing()) {
-            // cond is false within interval
-            partitions[{cond, false}] = interval;
-          }
-        }
+      // Each conjunct on the var bounds its own partition, so the conditions
+      // on several loops, such as the padding of a window, partition each of them.
+      std::vector<PrimExpr> conds;
+      SplitConjuncts(op->args[0], &conds);
+      for (const PrimExpr& cond : conds) {
+        AddPartitions(cond);
       }
     } else {
       StmtExprVisitor::VisitExpr_(op);
@@ -256,6 +253,35 @@ class PartitionFinder : public StmtExprVisitor {
   Partition partitions;
 
  private:
+  static void SplitConjuncts(const PrimExpr& cond, std::vector<PrimExpr>* conds) {
+    if (const AndNode* op = cond.as<AndNode>()) {
+      SplitConjuncts(op->a, conds);
+      SplitConjuncts(op->b, conds);
+    } else {
+      conds->push_back(cond);
+    }
+  }
+
+  void AddPartitions(const PrimExpr& cond) {
+    if (!ExprUseVars(cond, std::unordered_set<const VarNode*>({current_var_.get()}))) return;
+    // For cond, find out the interval, if exists, in which we can prove that cond is
+    // true. Also find the interval, if exists, in which we can prove that cond is
+    // false.
+    IntSet interval = DeduceBound(current_var_, cond, hint_map_, relax_map_);
+    if (!interval.IsNothing()) {
+      // cond is true within interval
+      partitions[{cond, true}] = interval;
+    }
+    PrimExpr inverse_cond = InverseCond(cond);
+    if (inverse_cond.defined()) {
+      IntSet interval = DeduceBound(current_var_, inverse_cond, hint_map_, relax_map_);
+      if (!interval.IsNothing()) {
+        // cond is false within interval
+        partitions[{cond, false}] = interval;
+      }
+    }
+  }
+
   PrimExpr InverseCond(const PrimExpr& cond) {
     PrimExpr inverse_cond;
     if (const LTNode* op = cond.as<LTNode>()) {
@@ -336,11 +362,24 @@ class ThreadPartitionInserter : public StmtMutator {
 
 // Try to partition range of iteration variables in order to remove (some)
 // likely conditions
+// The number of statements, the measure of the code size.
+size_t CountStmts(const Stmt& stmt) {
+  size_t count = 0;
+  PostOrderVisit(stmt, [&count](const ObjectRef& node) {
+    if (node->IsInstance<StmtNode>()) ++count;
+  });
+  return count;
+}
+
 class LoopPartitioner : public StmtMutator {
  public:
-  explicit LoopPartitioner(bool partition_const_loop, bool no_unroll_loop_with_extent_one)
+  explicit LoopPartitioner(bool partition_const_loop, bool no_unroll_loop_with_extent_one,
+                           size_t code_size = 0,
+                           size_t max_code_size = std::numeric_limits<size_t>::max())
       : selector(CandidateSelector(partition_const_loop)),
-        no_unroll_loop_with_extent_one_(no_unroll_loop_with_extent_one) {}
+        no_unroll_loop_with_extent_one_(no_unroll_loop_with_extent_one),
+        code_size_(code_size),
+        max_code_size_(max_code_size) {}
 
   Stmt VisitAndMutate(Stmt stmt) {
     selector(stmt);
@@ -408,6 +447,9 @@ class LoopPartitioner : public StmtMutator {
   arith::Analyzer analyzer_;
   CandidateSelector selector;
   bool no_unroll_loop_with_extent_one_;
+  // The estimated code size so far, and its budget.
+  size_t code_size_;
+  size_t max_code_size_;
 };
 
 // Returns an interval (in the first component) in which all the conditions
@@ -576,6 +618,19 @@ Stmt LoopPartitioner::TryPartition(const Stmt& stmt, Var var, PrimExpr min, Prim
       Stmt new_body = Substitute(simplified_body, {{Var{var}, var + body_begin}});
       mid_stmt = MakeFor(stmt.get(), post_doubt_begin - body_begin, new_body);
 
+      // Keep the loop whole when its copies exceed the budget. The middle
+      // subrange recurses first, so the interior gets the budget before the edges.
+      if (max_code_size_ != std::numeric_limits<size_t>::max()) {
+        size_t old_size = CountStmts(stmt);
+        size_t new_size = CountStmts(mid_stmt);
+        if (pre_stmt.defined()) new_size += CountStmts(pre_stmt);
+        if (post_stmt.defined()) new_size += CountStmts(post_stmt);
+        if (new_size > old_size && code_size_ + new_size - old_size > max_code_size_) {
+          return Stmt();
+        }
+        code_size_ = code_size_ + new_size - old_size;
+      }
+
       // Recurse for each non-empty subrange only if there are at least
       // two non-empty subranges
       if (pre_stmt.defined() || post_stmt.defined()) {
@@ -624,8 +679,15 @@ class RemoveLikelyTags : public StmtExprMutator {
   }
 };
 
-Stmt LoopPartition(Stmt stmt, bool partition_const_loop, bool no_unroll_loop_with_extent_one) {
-  stmt = LoopPartitioner(partition_const_loop, no_unroll_loop_with_extent_one)
+Stmt LoopPartition(Stmt stmt, bool partition_const_loop, bool no_unroll_loop_with_extent_one,
+                   double code_size_budget) {
+  size_t code_size = CountStmts(stmt);
+  size_t max_code_size = std::numeric_limits<size_t>::max();
+  if (code_size_budget > 0) {
+    max_code_size = static_cast<size_t>(code_size_budget * code_size);
+  }
+  stmt = LoopPartitioner(partition_const_loop, no_unroll_loop_with_extent_one, code_size,
+                         max_code_size)
              .VisitAndMutate(std::move(stmt));
   stmt = RemoveLikelyTags()(std::move(stmt));
   return stmt;
@@ -641,7 +703,8 @@ Pass LoopPartition() {
       cfg = AttrsWithDefaultValues<LoopPartitionConfig>();
     }
     n->body = LoopPartition(std::move(n->body), cfg.value()->partition_const_loop,
-                            cfg.value()->no_unroll_loop_with_extent_one);
+                            cfg.value()->no_unroll_loop_with_extent_one,
+                            cfg.value()->code_size_budget);
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.LoopPartition", {});
@@ -196,7 +196,9 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     PrimExpr group_index = FlattenThread(vpar, &group_extent);
     std::vector<Stmt> seq;
     std::vector<Var> shared_bufs(size);
+    std::vector<Var> staging_bufs(size);
     std::vector<Stmt> local_vars;
+    std::vector<Stmt> shared_vars;
     //
     // This is an optimization. For small reduction sizes, it may be beneficial
     // for a single warp to performance the entire reduction. No trips to shared
@@ -211,18 +213,27 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     //   b    <- shuffle_down(load(v[i], offset))
     //   v[i] <- reduction(a, b)
     //
+    // A reduction over several warps then exchanges the results of lane 0 of
+    // each warp through shared memory, and each warp reduces these partials
+    // with a second round of shuffles:
+    //
+    // if lane == 0
+    //   staging[i][warp] <- load(v[i])
+    // v[i] <- lane < NUM_WARPS ? staging[i][lane] : identity
+    // for offset from NUM_WARPS to 1 by 2
+    //   ...
+    //
     // broadcast results from lane 0 to all other lanes and store
     // the final reduction result to the proper location.
     //
-    if (is_warp_reduction(types)) {
-      // TODO(tvm-team) sub-warp reduction support.
-      ICHECK_EQ(reduce_extent, warp_size_) << "not a warp reduction";
+    if (is_warp_reduction(types, vred, reduce_extent)) {
       //
       // This is the index to the reduction variable, one reduction
       // variable per warp. Local scope seems easier to reason without
       // relying on a pattern match pass to fix it later.
       PrimExpr index(0);
 
+      std::vector<Var> shuffle_bufs(size);
       for (size_t idx = 0; idx < size; ++idx) {
         Type ptr_type = PointerType(PrimType(types[idx]));
         shared_bufs[idx] = Var("red_buf" + std::to_string(idx), ptr_type);
@@ -231,8 +242,8 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
 
         // Uses a local variable to store the shuffled data.
         // Later on, this allocation will be properly attached to this statement.
-        Var var("t" + std::to_string(idx), ptr_type);
-        Stmt s = Allocate(var, types[idx], {PrimExpr(1)}, pred, Evaluate(0));
+        shuffle_bufs[idx] = Var("t" + std::to_string(idx), ptr_type);
+        Stmt s = Allocate(shuffle_bufs[idx], types[idx], {PrimExpr(1)}, pred, Evaluate(0));
         local_vars.push_back(s);
       }
 
@@ -253,48 +264,50 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
       }
 
       // Emit reductions within a warp.
-      for (int offset = warp_size_ / 2; offset > 0; offset /= 2) {
-        // Load reduction values, no synchronization needed.
-        Array<PrimExpr> a, b;
+      seq.emplace_back(
+          MakeWarpReduce(combiner, types, shared_bufs, shuffle_bufs, mask_var, warp_size_));
+
+      // Emit the reduction of the results of the warps.
+      if (reduce_extent > warp_size_) {
+        int num_warps = reduce_extent / warp_size_;
+        PrimExpr warp_index = indexdiv(reduce_index, warp_size_);
+        PrimExpr lane_index = indexmod(reduce_index, warp_size_);
+        // This sync is necessary because there might be incomplete read of
+        // previous iteration on the same buffer.
+        seq.emplace_back(SyncThread("shared"));
+        std::vector<Stmt> stores(size);
         for (size_t i = 0; i < size; ++i) {
-          Var var = shared_bufs[i];
+          staging_bufs[i] =
+              Var("red_staging" + std::to_string(i), PointerType(PrimType(types[i])));
           PrimExpr pred = const_true(types[i].lanes());
-          PrimExpr val = Load(types[i], var, index, pred);
-          a.push_back(val);
-
-          // __shfl_*sync calls shall not appear in if_then_else expressions
-          // as this is causing extra divergency. E.g.
-          //
-          // v1 = (v2 < v3) ? v3 : __shfl_sync(mask, v1, 0);
-          //
-          // behaves differently from
-          //
-          // int t = __shfl_sync(mask, v1, 0);
-          // v1 = (v2 < v3) ? v3 : t;
-          //
-          // The former may cause dead lock as there is a divergent
-          // branch with a warp sync call inside.
-          //
-          PrimExpr other = WarpShuffle(builtin::tvm_warp_shuffle_down(), mask_var, val, offset);
-          const AllocateNode* repl = local_vars[i].as<AllocateNode>();
-          Stmt s = Store(repl->buffer_var, other, index, pred);
-          seq.push_back(s);
-
-          PrimExpr load = Load(types[i], repl->buffer_var, index, pred);
-          b.push_back(load);
+          PrimExpr val = Load(types[i], shared_bufs[i], index, pred);
+          stores[i] =
+              Store(staging_bufs[i], val, BufIndex(warp_index, group_index, num_warps), pred);
         }
-
-        // Do reductions.
-        Array<PrimExpr> ret = (*combiner)(a, b);
-
-        // Store the reduction result to itself.
-        std::vector<Stmt> stores(size);
+        seq.emplace_back(IfThenElse(lane_index == 0, SeqStmt::Flatten(stores)));
+        seq.emplace_back(SyncThread("shared"));
+        // Every warp reduces the partials, which spares broadcasting the
+        // result through shared memory with one more synchronization.
+        for (size_t i = 0; i < size; ++i) {
+          PrimExpr pred = const_true(types[i].lanes());
+          PrimExpr val = Load(types[i], staging_bufs[i],
+                              BufIndex(lane_index, group_index, num_warps), pred);
+          seq.emplace_back(Store(shared_bufs[i], inits[i], index, pred));
+          seq.emplace_back(
+              IfThenElse(lane_index < num_warps, Store(shared_bufs[i], val, index, pred)));
+        }
+        int reduce_align = 1;
+        while (num_warps > reduce_align) {
+          reduce_align = reduce_align << 1;
+        }
+        seq.emplace_back(
+            MakeWarpReduce(combiner, types, shared_bufs, shuffle_bufs, mask_var, reduce_align));
         for (size_t i = 0; i < size; ++i) {
-          Var var = shared_bufs[i];
           PrimExpr pred = const_true(types[i].lanes());
-          stores[i] = Store(var, ret[i], index, pred);
+          Stmt alloc = Allocate(staging_bufs[i], types[i],
+                                {PrimExpr(group_extent), PrimExpr(num_warps)}, pred, Evaluate(0));
+          shared_vars.push_back(alloc);
         }
-        seq.push_back(SeqStmt::Flatten(stores));
       }
 
       // Broadcast the reduction result from lane 0 to all other lanes.
@@ -362,6 +375,11 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
 
     // Fix all local allocations as all statements are built.
     Stmt body = SeqStmt::Flatten(seq);
+    for (auto var : shared_vars) {
+      const AllocateNode* repl = var.as<AllocateNode>();
+      body = Allocate(repl->buffer_var, repl->dtype, repl->extents, repl->condition, body);
+      body = AttrStmt(repl->buffer_var, attr::storage_scope, StringImm("shared"), body);
+    }
     for (auto var : local_vars) {
       const AllocateNode* repl = var.as<AllocateNode>();
       if (repl) {
@@ -373,6 +391,58 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     return body;
   }
 
+  // Emit the shuffles folding the values of the lanes [0, 2 * start_offset) of
+  // each warp into lane 0.
+  Stmt MakeWarpReduce(const CommReducerNode* combiner, const std::vector<DataType>& types,
+                      const std::vector<Var>& red_bufs, const std::vector<Var>& shuffle_bufs,
+                      Var mask_var, int start_offset) {
+    std::vector<Stmt> seq;
+    size_t size = red_bufs.size();
+    PrimExpr index(0);
+    for (int offset = start_offset / 2; offset > 0; offset /= 2) {
+      // Load reduction values, no synchronization needed.
+      Array<PrimExpr> a, b;
+      for (size_t i = 0; i < size; ++i) {
+        Var var = red_bufs[i];
+        PrimExpr pred = const_true(types[i].lanes());
+        PrimExpr val = Load(types[i], var, index, pred);
+        a.push_back(val);
+
+        // __shfl_*sync calls shall not appear in if_then_else expressions
+        // as this is causing extra divergency. E.g.
+        //
+        // v1 = (v2 < v3) ? v3 : __shfl_sync(mask, v1, 0);
+        //
+        // behaves differently from
+        //
+        // int t = __shfl_sync(mask, v1, 0);
+        // v1 = (v2 < v3) ? v3 : t;
+        //
+        // The former may cause dead lock as there is a divergent
+        // branch with a warp sync call inside.
+        //
+        PrimExpr other = WarpShuffle(builtin::tvm_warp_shuffle_down(), mask_var, val, offset);
+        seq.push_back(Store(shuffle_bufs[i], other, index, pred));
+
+        PrimExpr load = Load(types[i], shuffle_bufs[i], index, pred);
+        b.push_back(load);
+      }
+
+      // Do reductions.
+      Array<PrimExpr> ret = (*combiner)(a, b);
+
+      // Store the reduction result to itself.
+      std::vector<Stmt> stores(size);
+      for (size_t i = 0; i < size; ++i) {
+        Var var = red_bufs[i];
+        PrimExpr pred = const_true(types[i].lanes());
+        stores[i] = Store(var, ret[i], index, pred);
+      }
+      seq.push_back(SeqStmt::Flatten(stores));
+    }
+    return SeqStmt::Flatten(seq);
+  }
+
   // make allreduce.
   Stmt MakeBufAllreduce(const CommReducerNode* combiner, const std::vector<DataType>& types,
                         const Array<Var>& shared_bufs, PrimExpr reduce_index, PrimExpr group_index,
@@ -478,18 +548,22 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
     return Call(val.dtype(), op, args);
   }
 
-  // Check if this is a reduction on threadIdx.x and its extent matches
-  // the warp size.
+  // Check if this is a reduction on threadIdx.x only, and its extent is a
+  // multiple of the warp size that one warp can reduce the partials of.
   //
   // TODO(tvm-team) reduction with a sub-warp of 8 or 16 threads.
   // Note: The ROCm backend will only have warp reductions for now.
   // Also, the warp/wavefront size differs (64 on rocm, 32 on cuda).
-  bool is_warp_reduction(const std::vector<DataType>& types) const {
-    // Only cuda target supports warp reductions.
-    if ((target_->kind->name != "cuda") && (target_->kind->name != "rocm")) return false;
+  bool is_warp_reduction(const std::vector<DataType>& types, const std::vector<ThreadEntry>& vred,
+                         int reduce_extent) const {
+    // The cuda and rocm targets, and the opencl targets of subgroups, support warp reductions.
+    if ((target_->kind->name != "cuda") && (target_->kind->name != "rocm") &&
+        (target_->kind->name != "opencl" || warp_size_ <= 1)) {
+      return false;
+    }
 
-    // rocm only supports 32 bit operands for shuffling at the moment
-    if ((target_->kind->name == "rocm") &&
+    // rocm and the subgroups only support 32 bit operands for shuffling at the moment
+    if ((target_->kind->name == "rocm" || target_->kind->name == "opencl") &&
         (std::any_of(types.begin(), types.end(), [](DataType ty) {
           if (ty.is_vector()) return true;
           return ty.bits() != 32;
@@ -506,22 +580,10 @@ class ThreadAllreduceBuilder final : public StmtExprMutator {
         })) {
       return false;
     }
-    if (thread_extents_.empty()) {
+    if (vred.size() != 1 || vred[0].scope.dim_index != 0) {
       return false;
     }
-
-    const AttrStmtNode* op = thread_extents_.back();
-    DCHECK_EQ(op->attr_key, attr::thread_extent);
-
-    IterVar iv = Downcast<IterVar>(op->node);
-    ThreadEntry e;
-    e.scope = runtime::ThreadScope::Create(iv->thread_tag);
-    e.extent = 0;
-    if (auto ptr = op->value.as<IntImmNode>()) {
-      e.extent = static_cast<int>(ptr->value);
-    }
-
-    return e.extent == warp_size_ && e.scope.dim_index == 0 && e.scope.rank == 1;
+    return reduce_extent % warp_size_ == 0 && reduce_extent / warp_size_ <= warp_size_;
   }
 
   // The target.
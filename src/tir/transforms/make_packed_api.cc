@@ -106,7 +106,34 @@ inline Stmt MakeAssertEQ(PrimExpr lhs, PrimExpr rhs, std::string msg) {
   return AssertStmt(lhs == rhs, tvm::tir::StringImm(msg), Evaluate(0));
 }
 
-PrimFunc MakePackedAPI(PrimFunc&& func, int num_unpacked_args) {
+// Whether a statement is a check of the arguments, left out of the unchecked entry.
+inline bool IsArgCheck(const Stmt& stmt) {
+  if (stmt.as<AssertStmtNode>()) return true;
+  // The compactness check of the strides is guarded by their nullness.
+  if (const auto* seq = stmt.as<SeqStmtNode>()) {
+    return seq->size() != 0 && seq->seq[0].as<IfThenElseNode>() &&
+           seq->seq[0].as<IfThenElseNode>()->then_case.as<AssertStmtNode>();
+  }
+  return false;
+}
+
+inline std::vector<Stmt> WithoutArgChecks(const std::vector<Stmt>& nest) {
+  std::vector<Stmt> result;
+  for (const Stmt& stmt : nest) {
+    if (!IsArgCheck(stmt)) result.push_back(stmt);
+  }
+  return result;
+}
+
+/*!
+ * \brief Lower a PrimFunc to the packed function API.
+ * \param func The function.
+ * \param num_unpacked_args The number of leading arguments kept unpacked.
+ * \param unchecked If not null, set to the unchecked entry of the function: the same packed
+ *  function named "<global_symbol>_unchecked", without the checks of its arguments, for the
+ *  callers that verified them once, e.g. the executors of graphs of static shapes.
+ */
+PrimFunc MakePackedAPI(PrimFunc&& func, int num_unpacked_args, PrimFunc* unchecked = nullptr) {
   auto global_symbol = func->GetAttr<String>(tvm::attr::kGlobalSymbol);
   ICHECK(global_symbol) << "MakePackedAPI: Expect PrimFunc to have the global_symbol attribute";
 
@@ -243,9 +270,11 @@ PrimFunc MakePackedAPI(PrimFunc&& func, int num_unpacked_args) {
     func = WithAttr(std::move(func), tvm::attr::kCallingConv, Integer(CallingConv::kCPackedFunc));
   }
 
-  Stmt body = RewriteReturn(func_ptr->body, v_out_ret_value, v_out_ret_tcode);
-  body = AttrStmt(make_zero(DataType::Int(32)), attr::compute_scope,
-                  StringImm(name_hint + "_compute_"), body);
+  Stmt ret_body = RewriteReturn(func_ptr->body, v_out_ret_value, v_out_ret_tcode);
+  Stmt body = AttrStmt(make_zero(DataType::Int(32)), attr::compute_scope,
+                       StringImm(name_hint + "_compute_"), ret_body);
+  Stmt unchecked_body = AttrStmt(make_zero(DataType::Int(32)), attr::compute_scope,
+                                 StringImm(name_hint + "_unchecked_compute_"), ret_body);
   // Set device context
   if (vmap.count(device_id.get())) {
     PrimExpr node = StringImm("default");
@@ -257,10 +286,16 @@ PrimFunc MakePackedAPI(PrimFunc&& func, int num_unpacked_args) {
           Evaluate(Call(DataType::Int(32), builtin::tvm_call_packed(),
                         {StringImm(runtime::symbol::tvm_set_device), device_type, device_id}));
       body = SeqStmt({set_device, body});
+      unchecked_body = SeqStmt({set_device, unchecked_body});
     }
   }
   func_ptr->body = MergeNest({seq_init, binder.init_nest(), seq_check, binder.asserts()}, body);
   func_ptr->params = args;
+  if (unchecked != nullptr) {
+    unchecked_body = MergeNest(
+        {WithoutArgChecks(seq_init), binder.init_nest(), WithoutArgChecks(seq_check)},
+        unchecked_body);
+  }
 
   Array<Var> undefined = UndefinedVars(func_ptr->body, func_ptr->params);
   if (undefined.size() != 0) {
@@ -276,6 +311,13 @@ PrimFunc MakePackedAPI(PrimFunc&& func, int num_unpacked_args) {
   func_ptr->checked_type_ = func_ptr->func_type_annotation();
   func_ptr->ret_type = PrimType(DataType::Int(32));
 
+  if (unchecked != nullptr) {
+    PrimFunc entry = func;
+    entry.CopyOnWrite()->body = unchecked_body;
+    *unchecked = WithAttr(std::move(entry), tvm::attr::kGlobalSymbol,
+                          String(name_hint + "_unchecked"));
+  }
+
   // return the function.
   return std::move(func);
 }
@@ -286,14 +328,25 @@ Pass MakePackedAPI(int num_unpacked_args) {
   auto pass_func = [num_unpacked_args](IRModule m, PassContext ctx) {
     IRModuleNode* mptr = m.CopyOnWrite();
     std::vector<std::pair<GlobalVar, PrimFunc> > updates;
+    // Emit the unchecked entries of the CPU functions of the packed API.
+    bool unchecked_entry =
+        num_unpacked_args == 0 && ctx->GetConfig<Bool>("tir.unchecked_entry", Bool(false)).value();
 
     for (const auto& kv : mptr->functions) {
       if (auto* n = kv.second.as<PrimFuncNode>()) {
         PrimFunc func = GetRef<PrimFunc>(n);
         if (func->GetAttr<Integer>(tvm::attr::kCallingConv, Integer(CallingConv::kDefault)) ==
             CallingConv::kDefault) {
-          auto updated_func = MakePackedAPI(std::move(func), num_unpacked_args);
+          auto target = func->GetAttr<Target>(tvm::attr::kTarget);
+          bool with_unchecked =
+              unchecked_entry && target && target.value()->kind->device_type == kDLCPU;
+          PrimFunc unchecked;
+          auto updated_func = MakePackedAPI(std::move(func), num_unpacked_args,
+                                            with_unchecked ? &unchecked : nullptr);
           updates.push_back({kv.first, updated_func});
+          if (with_unchecked) {
+            updates.push_back({GlobalVar(kv.first->name_hint + "_unchecked"), unchecked});
+          }
         }
       }
     }
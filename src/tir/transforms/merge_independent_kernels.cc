@@ -0,0 +1,219 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file merge_independent_kernels.cc
+ * \brief Merge consecutive independent kernels into one launch
+ *  that dispatches on the block index.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+/*! \brief A kernel launched over blockIdx.x and threadIdx.x. */
+struct KernelLaunch {
+  Stmt stmt;
+  IterVar block;
+  IterVar thread;
+  Stmt body;
+  int64_t num_blocks{0};
+  int64_t num_threads{0};
+  std::unordered_set<const VarNode*> reads;
+  std::unordered_set<const VarNode*> writes;
+};
+
+// Collect the buffers a kernel accesses, and whether it can share a launch.
+class KernelAccessCollector : public StmtExprVisitor {
+ public:
+  void VisitExpr_(const LoadNode* op) final {
+    reads.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  void VisitStmt_(const StoreNode* op) final {
+    writes.insert(op->buffer_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread) {
+      mergeable = false;
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const AllocateNode* op) final {
+    // The storage of the kernels would be shared among all the blocks of the launch
+    mergeable = false;
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const CallNode* op) final {
+    // Synchronizations and opaque accesses of the buffers
+    if (op->op.same_as(builtin::tvm_storage_sync()) ||
+        op->op.same_as(builtin::tvm_thread_allreduce()) ||
+        op->op.same_as(builtin::tvm_access_ptr()) || op->op.same_as(builtin::address_of())) {
+      mergeable = false;
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  std::unordered_set<const VarNode*> reads;
+  std::unordered_set<const VarNode*> writes;
+  bool mergeable{true};
+};
+
+class KernelMerger : public StmtMutator {
+ public:
+  Stmt VisitStmt_(const SeqStmtNode* op) final {
+    Stmt ret = StmtMutator::VisitStmt_(op);
+    op = ret.as<SeqStmtNode>();
+    if (op == nullptr) return ret;
+    Array<Stmt> seq;
+    std::vector<KernelLaunch> run;
+    for (const Stmt& stmt : op->seq) {
+      KernelLaunch kernel;
+      if (!AsKernel(stmt, &kernel)) {
+        Flush(&run, &seq);
+        seq.push_back(stmt);
+        continue;
+      }
+      if (!run.empty() && !Compatible(run, kernel)) {
+        Flush(&run, &seq);
+      }
+      run.push_back(std::move(kernel));
+    }
+    Flush(&run, &seq);
+    return SeqStmt::Flatten(seq);
+  }
+
+ private:
+  static bool AsKernel(const Stmt& stmt, KernelLaunch* kernel) {
+    const auto* block = stmt.as<AttrStmtNode>();
+    if (block == nullptr || block->attr_key != attr::thread_extent) return false;
+    const auto* thread = block->body.as<AttrStmtNode>();
+    if (thread == nullptr || thread->attr_key != attr::thread_extent) return false;
+    kernel->block = Downcast<IterVar>(block->node);
+    kernel->thread = Downcast<IterVar>(thread->node);
+    if (kernel->block->thread_tag != "blockIdx.x" || kernel->thread->thread_tag != "threadIdx.x") {
+      return false;
+    }
+    const auto* num_blocks = block->value.as<IntImmNode>();
+    const auto* num_threads = thread->value.as<IntImmNode>();
+    if (num_blocks == nullptr || num_threads == nullptr) return false;
+    KernelAccessCollector collector;
+    collector(thread->body);
+    if (!collector.mergeable) return false;
+    kernel->stmt = stmt;
+    kernel->body = thread->body;
+    kernel->num_blocks = num_blocks->value;
+    kernel->num_threads = num_threads->value;
+    kernel->reads = std::move(collector.reads);
+    kernel->writes = std::move(collector.writes);
+    return true;
+  }
+
+  static bool Intersect(const std::unordered_set<const VarNode*>& lhs,
+                        const std::unordered_set<const VarNode*>& rhs) {
+    for (const VarNode* v : lhs) {
+      if (rhs.count(v)) return true;
+    }
+    return false;
+  }
+
+  // The kernel can run concurrently with all the kernels of the run.
+  static bool Compatible(const std::vector<KernelLaunch>& run, const KernelLaunch& kernel) {
+    for (const KernelLaunch& other : run) {
+      if (other.num_threads != kernel.num_threads) return false;
+      if (Intersect(other.writes, kernel.reads) || Intersect(other.writes, kernel.writes) ||
+          Intersect(kernel.writes, other.reads)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void Flush(std::vector<KernelLaunch>* run, Array<Stmt>* seq) {
+    if (run->size() == 1) {
+      seq->push_back(run->front().stmt);
+    } else if (run->size() > 1) {
+      seq->push_back(Merge(*run));
+    }
+    run->clear();
+  }
+
+  // Launch the kernels of the run on consecutive ranges of blocks.
+  static Stmt Merge(const std::vector<KernelLaunch>& run) {
+    const KernelLaunch& first = run.front();
+    Var block_var = first.block->var;
+    DataType dtype = block_var.dtype();
+    std::vector<Stmt> bodies;
+    std::vector<int64_t> ends;
+    int64_t num_blocks = 0;
+    for (const KernelLaunch& kernel : run) {
+      Map<Var, PrimExpr> vmap;
+      if (num_blocks != 0) {
+        vmap.Set(kernel.block->var, block_var - make_const(dtype, num_blocks));
+      }
+      if (!kernel.thread->var.same_as(first.thread->var)) {
+        vmap.Set(kernel.thread->var, first.thread->var);
+      }
+      bodies.push_back(vmap.empty() ? kernel.body : Substitute(kernel.body, vmap));
+      num_blocks += kernel.num_blocks;
+      ends.push_back(num_blocks);
+    }
+    Stmt body = bodies.back();
+    for (size_t i = bodies.size() - 1; i-- > 0;) {
+      body = IfThenElse(block_var < make_const(dtype, ends[i]), bodies[i], body);
+    }
+    IterVar block(Range::FromMinExtent(make_zero(dtype), make_const(dtype, num_blocks)),
+                  block_var, IterVarType::kThreadIndex, first.block->thread_tag);
+    body = AttrStmt(first.thread, attr::thread_extent,
+                    make_const(first.thread->var.dtype(), first.num_threads), body);
+    return AttrStmt(block, attr::thread_extent, make_const(dtype, num_blocks), body);
+  }
+};
+
+namespace transform {
+
+Pass MergeIndependentKernels() {
+  auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = KernelMerger()(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.MergeIndependentKernels", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.MergeIndependentKernels")
+    .set_body_typed(MergeIndependentKernels);
+
+}  // namespace transform
+
+}  // namespace tir
+}  // namespace tvm
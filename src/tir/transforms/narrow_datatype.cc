@@ -55,6 +55,33 @@ namespace tir {
 // Algorithm:
 // - Use DataTypeVisitor to determine whether a Var can be narrowed or not.
 // - Use DataTypeRewritter to rewrite the components of an indexing expression.
+//
+// With the min_bits option of the pass config, the expressions proven to fit
+// into a narrower dtype, down to min_bits (e.g. i16/i8), are narrowed to the
+// narrowest one, instead of all of them to `target_bits_`. A loop var must also
+// hold the end of its loop. The stored values, the let values and the arguments
+// of the opaque calls keep their dtype.
+
+struct NarrowDataTypeConfigNode : public tvm::AttrsNode<NarrowDataTypeConfigNode> {
+  int min_bits;
+
+  TVM_DECLARE_ATTRS(NarrowDataTypeConfigNode, "tir.transform.NarrowDataTypeConfig") {
+    TVM_ATTR_FIELD(min_bits)
+        .describe(
+            "The narrowest bits of the indices proven to fit, below the target bits. "
+            "0 to narrow all of them to the target bits")
+        .set_default(0);
+  }
+};
+
+class NarrowDataTypeConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(NarrowDataTypeConfig, Attrs,
+                                            NarrowDataTypeConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(NarrowDataTypeConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.NarrowDataType", NarrowDataTypeConfig);
 
 using arith::Analyzer;
 using arith::ConstIntBound;
@@ -72,7 +99,10 @@ using arith::IRMutatorWithAnalyzer;
 // Otherwise, `var` is not narrowed, that is, `vmap[var] = var.dtype.bits()`
 class DataTypeVisitor final : public StmtExprVisitor {
  public:
-  explicit DataTypeVisitor(int target_bits) : bits_(target_bits), target_bits_(target_bits) {}
+  DataTypeVisitor(int target_bits, int min_bits)
+      : bits_(min_bits > 0 && min_bits < target_bits ? min_bits : target_bits),
+        target_bits_(target_bits),
+        min_bits_(bits_) {}
 
   void VisitExpr(const PrimExpr& e) {
     if (e.dtype().is_int()) {
@@ -80,11 +110,10 @@ class DataTypeVisitor final : public StmtExprVisitor {
       if (bound_.find(e) == bound_.end()) {
         analyzer_.const_int_bound(e, &bound_);
       }
-      ConstIntBound bound = bound_[e];
-      int64_t ubound = Downcast<IntImm>(max_value(DataType::Int(target_bits_)))->value;
-      int64_t lbound = Downcast<IntImm>(min_value(DataType::Int(target_bits_)))->value;
-      if (e.dtype().bits() <= target_bits_ ||
-          (bound->max_value <= ubound && bound->min_value >= lbound)) {
+      int fit_bits = FitBits(bound_[e]);
+      if (fit_bits != 0) {
+        bits = fit_bits;
+      } else if (e.dtype().bits() <= target_bits_) {
         bits = target_bits_;
       }
       int tmp = bits > bits_ ? bits : bits_;
@@ -99,6 +128,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
   void VisitStmt_(const ForNode* op) {
     analyzer_.Bind(op->loop_var, Range::FromMinExtent(op->min, op->extent));
     vextent_[op->loop_var.as<VarNode>()] = op->extent.dtype();
+    BindLoopEnd(op->loop_var.get(), op->min + op->extent);
     return StmtExprVisitor::VisitStmt_(op);
   }
 
@@ -108,6 +138,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
       ICHECK_NE(iv->thread_tag.length(), 0U);
       analyzer_.Bind(iv->var, Range::FromMinExtent(0, op->value));
       vextent_[iv->var.as<VarNode>()] = op->value.dtype();
+      BindLoopEnd(iv->var.get(), op->value);
       StmtExprVisitor::VisitStmt_(op);
     } else {
       StmtExprVisitor::VisitStmt_(op);
@@ -119,6 +150,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
     for (const IterVar& iv : op->axis) {
       analyzer_.Bind(iv->var, iv->dom);
       vextent_[iv->var.as<VarNode>()] = iv->dom->extent.dtype();
+      BindLoopEnd(iv->var.get(), iv->dom->min + iv->dom->extent);
     }
     // Recursively call simplification when necessary.
     StmtExprVisitor::VisitExpr_(op);
@@ -128,7 +160,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
     if (vextent_.find(op) != vextent_.end()) {
       // We only narrow and never promote, so the result dtype
       // is upperbounded by its original dtype before rewrite.
-      int bits = std::min(vextent_[op].bits(), bits_);
+      int bits = std::min(vextent_[op].bits(), std::max(bits_, vend_bits_[op]));
       if (vmap.find(op) == vmap.end()) {
         vmap[op] = op->dtype.with_bits(bits);
       } else {
@@ -169,18 +201,40 @@ class DataTypeVisitor final : public StmtExprVisitor {
 
   // the narrowed datatype of Var and IntImm
   std::unordered_map<const PrimExprNode*, DataType> vmap;
+  // whether the indices are narrowed below the target bits
+  bool narrow_below_target() const { return min_bits_ < target_bits_; }
 
  protected:
   // internal analyzer
   arith::Analyzer analyzer_;
 
  private:
+  // The narrowest bits from min_bits_ to target_bits_ the bound fits into, 0 if none
+  int FitBits(const ConstIntBound& bound) const {
+    for (int bits = min_bits_; bits <= target_bits_; bits *= 2) {
+      int64_t ubound = Downcast<IntImm>(max_value(DataType::Int(bits)))->value;
+      int64_t lbound = Downcast<IntImm>(min_value(DataType::Int(bits)))->value;
+      if (bound->max_value <= ubound && bound->min_value >= lbound) return bits;
+    }
+    return 0;
+  }
+
+  // The var of a loop must hold the end of the loop, for its exit test
+  void BindLoopEnd(const VarNode* var, const PrimExpr& end) {
+    int bits = FitBits(analyzer_.const_int_bound(end));
+    vend_bits_[var] = bits != 0 ? bits : target_bits_;
+  }
+
   // the maximum possible bits, which serves as an init value
   static constexpr const int max_bits_ = 64;
   // the maximum possible bit of the current expression's return dtype
   int bits_;
   // the target bits
   int target_bits_;
+  // the narrowest bits, the target bits unless narrowing below them
+  int min_bits_;
+  // the bits holding the end of the loop of a var
+  std::unordered_map<const VarNode*, int> vend_bits_;
   // the extent of vars to be rewritten
   std::unordered_map<const VarNode*, DataType> vextent_;
   // the memorized bound generated by ConstIntBoundAnalyzer
@@ -189,7 +243,7 @@ class DataTypeVisitor final : public StmtExprVisitor {
 
 class DataTypeRewriter : public StmtExprMutator {
  public:
-  explicit DataTypeRewriter(int target_bits) : visitor_(target_bits) {}
+  DataTypeRewriter(int target_bits, int min_bits = 0) : visitor_(target_bits, min_bits) {}
 
   Stmt operator()(Stmt s) {
     visitor_(s);
@@ -205,12 +259,34 @@ class DataTypeRewriter : public StmtExprMutator {
   }
 
   Stmt VisitStmt_(const StoreNode* op) final {
-    PrimExpr value = this->VisitExpr(op->value);
+    PrimExpr value = cast(op->value.dtype(), this->VisitExpr(op->value));
     is_index_ = true;
     PrimExpr index = this->VisitExpr(op->index);
     is_index_ = false;
-    Stmt s = Store(op->buffer_var, op->value, index, op->predicate);
-    return StmtExprMutator::VisitStmt_(s.as<StoreNode>());
+    PrimExpr predicate = this->VisitExpr(op->predicate);
+    if (value.same_as(op->value) && index.same_as(op->index) &&
+        predicate.same_as(op->predicate)) {
+      return GetRef<Stmt>(op);
+    }
+    return Store(op->buffer_var, value, index, predicate);
+  }
+
+  Stmt VisitStmt_(const LetStmtNode* op) final {
+    PrimExpr value = cast(op->value.dtype(), this->VisitExpr(op->value));
+    Stmt body = this->VisitStmt(op->body);
+    if (value.same_as(op->value) && body.same_as(op->body)) {
+      return GetRef<Stmt>(op);
+    }
+    return LetStmt(op->var, value, body);
+  }
+
+  PrimExpr VisitExpr_(const LetNode* op) final {
+    PrimExpr value = cast(op->value.dtype(), this->VisitExpr(op->value));
+    PrimExpr body = this->VisitExpr(op->body);
+    if (value.same_as(op->value) && body.same_as(op->body)) {
+      return GetRef<PrimExpr>(op);
+    }
+    return Let(op->var, value, body);
   }
 
   Stmt VisitStmt_(const ForNode* op) final {
@@ -351,6 +427,7 @@ DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(GTNode, operator>);  // NOLINT(*)
 DEFINE_BIOP_EXPR_MUTATE_WITH_TYPE_MATCH(GENode, operator>=);
 
 PrimExpr DataTypeRewriter::VisitExpr_(const CallNode* op) {
+  const CallNode* orig = op;
   PrimExpr e = StmtExprMutator::VisitExpr_(op);
   op = e.as<CallNode>();
   ICHECK(op != nullptr) << "Expected type to be CallNode"
@@ -372,6 +449,14 @@ PrimExpr DataTypeRewriter::VisitExpr_(const CallNode* op) {
     return pow(op->args[0], op->args[1]);
   }
 
+  if (visitor_.narrow_below_target()) {
+    // The opaque calls, e.g. the extern ones, get their arguments in the original dtype
+    Array<PrimExpr> args;
+    for (size_t i = 0; i < op->args.size(); ++i) {
+      args.push_back(cast(orig->args[i].dtype(), op->args[i]));
+    }
+    return Call(op->dtype, op->op, args, op->span);
+  }
   return e;
 }
 
@@ -381,8 +466,16 @@ namespace transform {
 
 Pass NarrowDataType(int target_bits) {
   auto pass_func = [target_bits](PrimFunc f, IRModule m, PassContext ctx) {
+    auto cfg = ctx->GetConfig<NarrowDataTypeConfig>("tir.NarrowDataType");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<NarrowDataTypeConfig>();
+    }
+    int min_bits = cfg.value()->min_bits;
+    ICHECK(min_bits == 0 || (min_bits >= 8 && (min_bits & (min_bits - 1)) == 0))
+        << "The min_bits of NarrowDataType must be a power of two of at least 8, but get "
+        << min_bits;
     auto* n = f.CopyOnWrite();
-    n->body = DataTypeRewriter(target_bits)(std::move(n->body));
+    n->body = DataTypeRewriter(target_bits, min_bits)(std::move(n->body));
     return f;
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.NarrowDataType", {});
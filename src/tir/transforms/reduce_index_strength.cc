@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \brief Hoist the loop invariant part of the affine indices out of the loops,
+ *  and strength reduce the rest to an increment per iteration.
+ * \file reduce_index_strength.cc
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/arith/pattern.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ir_utils.h"
+
+namespace tvm {
+namespace tir {
+
+// Whether the statement is a scope the index registers of the enclosing loops
+// cannot reach: a kernel launch or the body of a parallel loop.
+inline bool IsOpaqueScope(const Stmt& stmt) {
+  if (const auto* op = stmt.as<AttrStmtNode>()) {
+    return op->attr_key == attr::thread_extent || op->attr_key == attr::virtual_thread;
+  }
+  if (const auto* op = stmt.as<ForNode>()) {
+    return op->kind == ForKind::kParallel || op->kind == ForKind::kThreadBinding;
+  }
+  return false;
+}
+
+// Collect the scalar indices of a loop body, and the initial values of the
+// index registers of the inner loops, with the vars defined in the body.
+class IndexCollector : public StmtExprVisitor {
+ public:
+  explicit IndexCollector(const std::unordered_set<const VarNode*>& registers)
+      : registers_(registers) {}
+
+  void VisitStmt(const Stmt& stmt) final {
+    if (IsOpaqueScope(stmt)) return;
+    StmtExprVisitor::VisitStmt(stmt);
+  }
+  void VisitStmt_(const ForNode* op) final {
+    defined.insert(op->loop_var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+  void VisitStmt_(const LetStmtNode* op) final {
+    defined.insert(op->var.get());
+    StmtExprVisitor::VisitStmt_(op);
+  }
+  void VisitExpr_(const LetNode* op) final {
+    defined.insert(op->var.get());
+    StmtExprVisitor::VisitExpr_(op);
+  }
+  void VisitExpr_(const LoadNode* op) final {
+    if (op->dtype.lanes() == 1) indices.push_back(op->index);
+    StmtExprVisitor::VisitExpr_(op);
+  }
+  void VisitStmt_(const StoreNode* op) final {
+    if (registers_.count(op->buffer_var.get())) {
+      indices.push_back(op->value);
+    } else if (op->value.dtype().lanes() == 1) {
+      indices.push_back(op->index);
+    }
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  std::vector<PrimExpr> indices;
+  std::unordered_set<const VarNode*> defined;
+
+ private:
+  const std::unordered_set<const VarNode*>& registers_;
+};
+
+// Replace the reduced indices with the load of their register.
+class IndexReplacer : public StmtExprMutator {
+ public:
+  IndexReplacer(const std::unordered_map<const PrimExprNode*, PrimExpr>& replace,
+                const std::unordered_set<const VarNode*>& registers)
+      : replace_(replace), registers_(registers) {}
+
+  Stmt VisitStmt(const Stmt& stmt) final {
+    if (IsOpaqueScope(stmt)) return stmt;
+    return StmtExprMutator::VisitStmt(stmt);
+  }
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    auto it = replace_.find(op->index.get());
+    if (it == replace_.end()) return StmtExprMutator::VisitExpr_(op);
+    return Load(op->dtype, op->buffer_var, it->second, op->predicate);
+  }
+  Stmt VisitStmt_(const StoreNode* op) final {
+    if (registers_.count(op->buffer_var.get())) {
+      auto it = replace_.find(op->value.get());
+      if (it != replace_.end()) {
+        return Store(op->buffer_var, it->second, op->index, op->predicate);
+      }
+      return StmtExprMutator::VisitStmt_(op);
+    }
+    auto it = replace_.find(op->index.get());
+    if (it == replace_.end()) return StmtExprMutator::VisitStmt_(op);
+    return Store(op->buffer_var, this->VisitExpr(op->value), it->second, op->predicate);
+  }
+
+ private:
+  const std::unordered_map<const PrimExprNode*, PrimExpr>& replace_;
+  const std::unordered_set<const VarNode*>& registers_;
+};
+
+class IndexStrengthReducer : public StmtExprMutator {
+ public:
+  Stmt VisitStmt_(const ForNode* op) final {
+    // Reduce the inner loops first, their initial values then reduce in this loop.
+    Stmt stmt = StmtExprMutator::VisitStmt_(op);
+    op = stmt.as<ForNode>();
+    if (op->kind != ForKind::kSerial && op->kind != ForKind::kUnrolled) return stmt;
+
+    IndexCollector collector(registers_);
+    collector(op->body);
+    Var loop_var = op->loop_var;
+    auto is_variant = [&](const VarNode* v) {
+      return v == loop_var.get() || collector.defined.count(v);
+    };
+
+    // The registers of this loop, one per distinct affine form.
+    struct Register {
+      Var buffer;
+      PrimExpr init;
+      PrimExpr stride;
+    };
+    std::vector<Register> regs;
+    std::unordered_map<const PrimExprNode*, PrimExpr> replace;
+    for (const PrimExpr& index : collector.indices) {
+      if (replace.count(index.get()) || !ExprUseVar(index, loop_var)) continue;
+      if (!index.dtype().is_int() || SideEffect(index) > CallEffectKind::kPure) continue;
+      Array<PrimExpr> coeffs = arith::DetectLinearEquation(index, {loop_var});
+      if (coeffs.empty()) continue;
+      PrimExpr stride = analyzer_.Simplify(coeffs[0]);
+      PrimExpr base = analyzer_.Simplify(coeffs[1]);
+      if (ExprUseVar(stride, is_variant) || ExprUseVar(base, is_variant)) continue;
+      // an index of the loop var alone is as cheap as its register.
+      if (is_const_int(base)) continue;
+      PrimExpr init = analyzer_.Simplify(base + op->min * stride);
+      const Register* reg = nullptr;
+      for (const Register& r : regs) {
+        if (r.init.dtype() == init.dtype() && deep_equal_(r.init, init) &&
+            deep_equal_(r.stride, stride)) {
+          reg = &r;
+          break;
+        }
+      }
+      if (reg == nullptr) {
+        Var buffer(loop_var->name_hint + ".idx", PointerType(PrimType(index.dtype())));
+        regs.push_back({buffer, init, stride});
+        registers_.insert(buffer.get());
+        reg = &regs.back();
+      }
+      replace[index.get()] =
+          Load(index.dtype(), reg->buffer, make_const(DataType::Int(32), 0), const_true());
+    }
+    if (regs.empty()) return stmt;
+
+    // Bump the registers at the end of each iteration.
+    std::vector<Stmt> body{IndexReplacer(replace, registers_)(op->body)};
+    for (const Register& r : regs) {
+      PrimExpr value = Load(r.init.dtype(), r.buffer, make_const(DataType::Int(32), 0),
+                            const_true());
+      body.push_back(Store(r.buffer, value + r.stride, make_const(DataType::Int(32), 0),
+                           const_true()));
+    }
+    stmt = For(op->loop_var, op->min, op->extent, op->kind, SeqStmt::Flatten(body),
+               op->thread_binding, op->annotations);
+    // The invariant part is computed once, before the loop.
+    for (auto it = regs.rbegin(); it != regs.rend(); ++it) {
+      stmt = SeqStmt({Store(it->buffer, it->init, make_const(DataType::Int(32), 0), const_true()),
+                      stmt});
+      stmt = Allocate(it->buffer, it->init.dtype(), {make_const(DataType::Int(32), 1)},
+                      const_true(), stmt);
+      stmt = AttrStmt(it->buffer, attr::storage_scope, StringImm("local"), stmt);
+    }
+    return stmt;
+  }
+
+ private:
+  // The index registers created so far.
+  std::unordered_set<const VarNode*> registers_;
+  arith::Analyzer analyzer_;
+  ExprDeepEqual deep_equal_;
+};
+
+namespace transform {
+
+Pass ReduceIndexStrength() {
+  auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = IndexStrengthReducer()(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.ReduceIndexStrength", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.ReduceIndexStrength").set_body_typed(ReduceIndexStrength);
+
+}  // namespace transform
+
+}  // namespace tir
+}  // namespace tvm
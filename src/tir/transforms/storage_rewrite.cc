@@ -32,6 +32,7 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/transform.h>
 
+#include <algorithm>
 #include <map>
 #include <unordered_map>
 #include <unordered_set>
@@ -45,6 +46,25 @@ namespace tir {
 using runtime::StorageRank;
 using runtime::StorageScope;
 
+struct StorageRewriteConfigNode : public tvm::AttrsNode<StorageRewriteConfigNode> {
+  bool pack_allocations;
+
+  TVM_DECLARE_ATTRS(StorageRewriteConfigNode, "tir.transform.StorageRewriteConfig") {
+    TVM_ATTR_FIELD(pack_allocations)
+        .describe("Pack the local and shared allocations of a scope into one buffer by liveness")
+        .set_default(false);
+  }
+};
+
+class StorageRewriteConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(StorageRewriteConfig, Attrs,
+                                            StorageRewriteConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(StorageRewriteConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.StorageRewrite", StorageRewriteConfig);
+
 // Find a linear pattern of storage access
 // Used for liveness analysis.
 // Composite scopes(loop/thread_launch/IfThen) is represented by two points:
@@ -343,8 +363,9 @@ class StoragePlanRewriter : public StmtExprMutator {
   using StmtEntry = LinearAccessPatternFinder::StmtEntry;
   using AllocEntry = LinearAccessPatternFinder::AllocEntry;
 
-  Stmt Rewrite(Stmt stmt, bool detect_inplace) {
+  Stmt Rewrite(Stmt stmt, bool detect_inplace, bool pack_allocations = false) {
     detect_inplace_ = detect_inplace;
+    pack_allocations_ = pack_allocations;
     // plan the rewrite
     LinearAccessPatternFinder finder;
     finder(stmt);
@@ -481,6 +502,13 @@ class StoragePlanRewriter : public StmtExprMutator {
     // This allows effective sharing among different types as long as their alignment
     // requirement fits into the max_simd_bits.
     uint64_t bits_offset{0};
+    // Whether this entry is placed by the liveness based packing.
+    bool packable{false};
+    // Whether this entry is already placed into a packed buffer.
+    bool packed{false};
+    // The first and last position in the linear sequence that this entry is alive.
+    size_t live_begin{0};
+    size_t live_end{0};
   };
 
   // Alllocate entry of node.
@@ -520,6 +548,9 @@ class StoragePlanRewriter : public StmtExprMutator {
     for (auto& kv : attach_map_) {
       // find the element with the most amount of bytes.
       std::vector<StorageEntry*>& vec = kv.second;
+      if (pack_allocations_) {
+        PackAllocations(vec);
+      }
       // try to find merge, for tagged memory
       for (size_t i = 0; i < vec.size(); ++i) {
         StorageEntry* e = vec[i];
@@ -537,7 +568,7 @@ class StoragePlanRewriter : public StmtExprMutator {
       for (size_t i = 0; i < vec.size(); ++i) {
         StorageEntry* e = vec[i];
         // already merged
-        if (e->bits_offset != 0) continue;
+        if (e->bits_offset != 0 || e->packed) continue;
         if (e->merged_children.size() != 0) {
           NewAllocTagMerged(e);
           continue;
@@ -645,6 +676,78 @@ class StoragePlanRewriter : public StmtExprMutator {
           << "Allocation exceed bound of memory tag " << e->scope.to_string();
     }
   }
+  // Pack the entries of one attach scope into one buffer per storage scope.
+  // The entries whose liveness does not overlap can share the same bytes,
+  // whatever their element types, as long as the offsets are aligned.
+  void PackAllocations(const std::vector<StorageEntry*>& vec) {
+    std::vector<std::vector<StorageEntry*>> groups;
+    for (StorageEntry* e : vec) {
+      if (!e->packable) continue;
+      bool found = false;
+      for (auto& group : groups) {
+        if (group[0]->scope == e->scope) {
+          group.push_back(e);
+          found = true;
+          break;
+        }
+      }
+      if (!found) groups.push_back({e});
+    }
+    for (auto& group : groups) {
+      if (group.size() < 2) continue;
+      // The widest element type decides the type and the alignment of the buffer,
+      // the offsets then stay divisible by the width of every element type.
+      DataType alloc_type = group[0]->allocs[0]->dtype;
+      for (StorageEntry* e : group) {
+        for (const AllocateNode* op : e->allocs) {
+          if (op->dtype.bits() * op->dtype.lanes() > alloc_type.bits() * alloc_type.lanes()) {
+            alloc_type = op->dtype;
+          }
+        }
+      }
+      uint64_t align = alloc_type.bits() * alloc_type.lanes();
+      // Place the largest entries first, each at the lowest aligned offset
+      // that does not overlap a live placed entry.
+      std::vector<StorageEntry*> order = group;
+      std::stable_sort(order.begin(), order.end(), [](StorageEntry* a, StorageEntry* b) {
+        return a->const_nbits > b->const_nbits;
+      });
+      std::vector<StorageEntry*> placed;
+      uint64_t total_bits = 0;
+      for (StorageEntry* e : order) {
+        std::vector<StorageEntry*> conflicts;
+        for (StorageEntry* p : placed) {
+          if (p->live_begin <= e->live_end && e->live_begin <= p->live_end) {
+            conflicts.push_back(p);
+          }
+        }
+        std::sort(conflicts.begin(), conflicts.end(), [](StorageEntry* a, StorageEntry* b) {
+          return a->bits_offset < b->bits_offset;
+        });
+        uint64_t offset = 0;
+        for (StorageEntry* p : conflicts) {
+          if (offset + e->const_nbits <= p->bits_offset) break;
+          uint64_t end = p->bits_offset + p->const_nbits;
+          if (end > offset) {
+            offset = (end + align - 1) / align * align;
+          }
+        }
+        e->bits_offset = offset;
+        total_bits = std::max(total_bits, offset + e->const_nbits);
+        placed.push_back(e);
+      }
+      StorageEntry* owner = order[0];
+      ICHECK_EQ(owner->bits_offset, 0U);
+      owner->alloc_var = owner->allocs[0]->buffer_var;
+      for (StorageEntry* e : group) {
+        e->alloc_var = owner->alloc_var;
+        e->packed = true;
+      }
+      PrimExpr alloc_size = make_const(DataType::Int(32), (total_bits + align - 1) / align);
+      owner->new_alloc = Allocate(owner->alloc_var, alloc_type, {alloc_size}, const_true(),
+                                  Evaluate(0));
+    }
+  }
   // Liveness analysis to find gen and kill point of each variable.
   void LivenessAnalysis(const std::vector<StmtEntry>& seq) {
     // find kill point, do a reverse linear scan.
@@ -704,6 +807,7 @@ class StoragePlanRewriter : public StmtExprMutator {
     for (size_t i = 0; i < seq.size(); ++i) {
       const StmtEntry& s = seq[i];
       auto it = event_map_.find(seq[i].stmt);
+      seq_index_ = i;
 
       // scope_pair_offset >= 0 means it is either
       // - leaf stmt(offset = 0)
@@ -747,6 +851,7 @@ class StoragePlanRewriter : public StmtExprMutator {
             dst_entry = FindAlloc(ae.alloc, thread_scope_, ae.storage_scope);
           }
           dst_entry->allocs.emplace_back(ae.alloc);
+          dst_entry->live_end = std::max(dst_entry->live_end, i);
           alloc_map_[var] = dst_entry;
         }
       }
@@ -791,6 +896,8 @@ class StoragePlanRewriter : public StmtExprMutator {
     entry->scope = scope;
     entry->elem_type = op->dtype.element_of();
     entry->const_nbits = const_nbits;
+    entry->live_begin = seq_index_;
+    entry->live_end = seq_index_;
     StorageEntry* e = entry.get();
     alloc_vec_.emplace_back(std::move(entry));
     return e;
@@ -807,6 +914,11 @@ class StoragePlanRewriter : public StmtExprMutator {
     // disable reuse of small arrays, they will be lowered to registers in LLVM
     // This rules only apply if we are using non special memory
     if (scope.tag.length() == 0) {
+      if (pack_allocations_ && IsPackable(op, scope, const_nbits)) {
+        StorageEntry* e = NewAlloc(op, attach_scope, scope, const_nbits);
+        e->packable = true;
+        return e;
+      }
       if (scope.rank >= StorageRank::kWarp || op->dtype.is_handle()) {
         return NewAlloc(op, attach_scope, scope, const_nbits);
       }
@@ -854,12 +966,27 @@ class StoragePlanRewriter : public StmtExprMutator {
     }
     return NewAlloc(op, attach_scope, scope, const_nbits);
   }
+  // Whether the allocation is placed by the liveness based packing.
+  static bool IsPackable(const AllocateNode* op, const StorageScope& scope, uint64_t const_nbits) {
+    if (scope.rank != StorageRank::kShared && scope.rank != StorageRank::kLocal) return false;
+    if (op->dtype.is_handle() || !is_one(op->condition)) return false;
+    // small arrays are lowered to registers
+    if (const_nbits <= 32) return false;
+    // the offsets are aligned to the widest element, which must be a power of two.
+    uint64_t elem_bits = op->dtype.bits() * op->dtype.lanes();
+    return (elem_bits & (elem_bits - 1)) == 0;
+  }
   // simulated free.
   void Free(const VarNode* var) {
     auto it = alloc_map_.find(var);
     ICHECK(it != alloc_map_.end());
     StorageEntry* e = it->second;
     ICHECK_NE(e->allocs.size(), 0U);
+    // the packed entries are placed after the planning, by their liveness.
+    if (e->packable) {
+      e->live_end = std::max(e->live_end, seq_index_);
+      return;
+    }
 
     // disable reuse of small arrays, they will be lowered to registers in LLVM
     // This rules only apply if we are using non special memory
@@ -880,6 +1007,10 @@ class StoragePlanRewriter : public StmtExprMutator {
   const Object* thread_scope_{nullptr};
   // whether enable inplace detection.
   bool detect_inplace_{false};
+  // whether pack the local and shared allocations by liveness.
+  bool pack_allocations_{false};
+  // The current position in the linear sequence.
+  size_t seq_index_{0};
   // Locations of free ops.
   std::unordered_map<const Object*, EventEntry> event_map_;
   // constant size free map.
@@ -1005,7 +1136,12 @@ namespace transform {
 Pass StorageRewrite() {
   auto pass_func = [](PrimFunc f, IRModule m, PassContext ctx) {
     auto* n = f.CopyOnWrite();
-    n->body = StoragePlanRewriter().Rewrite(std::move(n->body), true);
+    auto cfg = ctx->GetConfig<StorageRewriteConfig>("tir.StorageRewrite");
+    if (!cfg.defined()) {
+      cfg = AttrsWithDefaultValues<StorageRewriteConfig>();
+    }
+    n->body = StoragePlanRewriter().Rewrite(std::move(n->body), true,
+                                            cfg.value()->pack_allocations);
     return PointerValueTypeRewrite(std::move(f));
   };
   return CreatePrimFuncPass(pass_func, 0, "tir.StorageRewrite", {});
@@ -38,6 +38,28 @@
 namespace tvm {
 namespace tir {
 
+struct VectorizeLoopConfigNode : public tvm::AttrsNode<VectorizeLoopConfigNode> {
+  bool enable_predication;
+  bool scalable;
+
+  TVM_DECLARE_ATTRS(VectorizeLoopConfigNode, "tir.transform.VectorizeLoopConfig") {
+    TVM_ATTR_FIELD(enable_predication)
+        .describe("Vectorize the conditions on the lanes with predicated loads and stores")
+        .set_default(false);
+    TVM_ATTR_FIELD(scalable)
+        .describe("Leave the vectorized loops to the scalable vectors of the backend")
+        .set_default(false);
+  }
+};
+
+class VectorizeLoopConfig : public Attrs {
+ public:
+  TVM_DEFINE_NOTNULLABLE_OBJECT_REF_METHODS(VectorizeLoopConfig, Attrs, VectorizeLoopConfigNode);
+};
+
+TVM_REGISTER_NODE_TYPE(VectorizeLoopConfigNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.VectorizeLoop", VectorizeLoopConfig);
+
 inline PrimExpr BroadcastTo(PrimExpr e, int lanes) {
   if (e.dtype().lanes() == lanes) return e;
   if (const BroadcastNode* op = e.as<BroadcastNode>()) {
@@ -92,6 +114,25 @@ class VecAllocAccess : public StmtExprMutator {
   int var_lanes_;
 };
 
+// Whether the statement can run under a predicate on the lanes:
+// it only stores to memory and has no other side effect.
+bool CanPredicate(const Stmt& stmt) {
+  bool can_predicate = true;
+  PostOrderVisit(stmt, [&can_predicate](const ObjectRef& node) {
+    if (node->IsInstance<StmtNode>()) {
+      if (!node->IsInstance<StoreNode>() && !node->IsInstance<SeqStmtNode>() &&
+          !node->IsInstance<LetStmtNode>() && !node->IsInstance<IfThenElseNode>()) {
+        can_predicate = false;
+      }
+    } else if (const auto* call = node.as<CallNode>()) {
+      if (SideEffect(GetRef<PrimExpr>(call)) > CallEffectKind::kReadState) {
+        can_predicate = false;
+      }
+    }
+  });
+  return can_predicate;
+}
+
 // We use ExprFunctor directly instead of StmtExprMutator
 // This is because the transformation can change the dtype of the Expr
 // The existing ExprMutator transformation rules may not be well defined.
@@ -100,7 +141,8 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   using ExprFunctor::VisitExpr;
   using StmtMutator::operator();
 
-  Vectorizer(Var var, int var_lanes) : var_(var), var_lanes_(var_lanes) {
+  Vectorizer(Var var, int var_lanes, bool enable_predication = false)
+      : var_(var), var_lanes_(var_lanes), enable_predication_(enable_predication) {
     ramp_ = Ramp(0, 1, var_lanes);
   }
 
@@ -109,6 +151,8 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     Stmt ret = StmtMutator::VisitStmt(stmt);
     if (need_scalarize_) {
       need_scalarize_ = false;
+      // the scalarized lanes would lose the predicate, scalarize the condition as well.
+      if (predicate_.defined()) predicate_failed_ = true;
       return Scalarize(stmt);
     } else {
       return ret;
@@ -247,8 +291,17 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr MutateIfThenElseExpr_(const CallNode* op) {
     PrimExpr cond = this->VisitExpr(op->args[0]);
     if (cond.dtype().is_vector()) {
-      need_scalarize_ = true;
-      return GetRef<PrimExpr>(op);
+      if (!enable_predication_ || SideEffect(op->args[1]) > CallEffectKind::kReadState ||
+          SideEffect(op->args[2]) > CallEffectKind::kReadState) {
+        need_scalarize_ = true;
+        return GetRef<PrimExpr>(op);
+      }
+      // Select the lanes, each branch only loads the lanes it is selected on.
+      cond = StripLikely(cond);
+      PrimExpr t = VisitWithPredicate(cond, op->args[1]);
+      PrimExpr f = VisitWithPredicate(Not(cond), op->args[2]);
+      int lanes = cond.dtype().lanes();
+      return Select(cond, BroadcastTo(t, lanes), BroadcastTo(f, lanes));
     }
     PrimExpr t = this->VisitExpr(op->args[1]);
     PrimExpr f = this->VisitExpr(op->args[2]);
@@ -300,6 +353,11 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr VisitExpr_(const LoadNode* op) final {
     PrimExpr index = this->VisitExpr(op->index);
     PrimExpr pred = this->VisitExpr(op->predicate);
+    if (predicate_.defined()) {
+      int lanes = predicate_.dtype().lanes();
+      return Load(op->dtype.with_lanes(lanes), op->buffer_var, BroadcastTo(index, lanes),
+                  MergePredicate(pred, lanes));
+    }
     if (index.same_as(op->index) && pred.same_as(op->predicate)) {
       return GetRef<PrimExpr>(op);
     } else {
@@ -341,6 +399,16 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     PrimExpr value = this->VisitExpr(op->value);
     PrimExpr index = this->VisitExpr(op->index);
     PrimExpr pred = this->VisitExpr(op->predicate);
+    if (predicate_.defined()) {
+      int lanes = predicate_.dtype().lanes();
+      if (value.dtype().lanes() == 1 && index.dtype().lanes() == 1) {
+        // the same location for all the lanes, the predicate cannot tell which one stores.
+        need_scalarize_ = true;
+        return GetRef<Stmt>(op);
+      }
+      return Store(op->buffer_var, BroadcastTo(value, lanes), BroadcastTo(index, lanes),
+                   MergePredicate(pred, lanes));
+    }
     if (value.same_as(op->value) && index.same_as(op->index)) {
       return GetRef<Stmt>(op);
     } else {
@@ -374,7 +442,24 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
     ICHECK(!op->condition.dtype().is_vector());
     PrimExpr condition = this->VisitExpr(op->condition);
     if (condition.dtype().is_vector()) {
-      return Scalarize(GetRef<Stmt>(op));
+      if (!enable_predication_ || need_scalarize_ || !CanPredicate(op->then_case) ||
+          (op->else_case.defined() && !CanPredicate(op->else_case))) {
+        return Scalarize(GetRef<Stmt>(op));
+      }
+      // Run both the branches, each one on the lanes it is taken on.
+      condition = StripLikely(condition);
+      bool predicate_failed = predicate_failed_;
+      predicate_failed_ = false;
+      std::vector<Stmt> seq{VisitWithPredicate(condition, op->then_case)};
+      if (op->else_case.defined()) {
+        seq.push_back(VisitWithPredicate(Not(condition), op->else_case));
+      }
+      bool failed = predicate_failed_;
+      predicate_failed_ = predicate_failed;
+      if (failed) {
+        return Scalarize(GetRef<Stmt>(op));
+      }
+      return SeqStmt::Flatten(seq);
     }
     Stmt then_case = this->VisitStmt(op->then_case);
     Stmt else_case;
@@ -451,6 +536,30 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   }
 
  private:
+  // Visit the node with the predicate of the enclosing conditions and cond.
+  template <typename T>
+  T VisitWithPredicate(PrimExpr cond, const T& node) {
+    PrimExpr predicate = predicate_;
+    predicate_ = predicate_.defined() ? And(predicate_, cond) : cond;
+    T ret = this->VisitNode(node);
+    predicate_ = predicate;
+    return ret;
+  }
+  Stmt VisitNode(const Stmt& stmt) { return this->VisitStmt(stmt); }
+  PrimExpr VisitNode(const PrimExpr& expr) { return this->VisitExpr(expr); }
+  // The predicate of an access, merged with the one of the enclosing conditions.
+  PrimExpr MergePredicate(PrimExpr pred, int lanes) {
+    if (is_one(pred)) return predicate_;
+    return And(BroadcastTo(pred, lanes), predicate_);
+  }
+  // The predicate does not take a branch, so drop the branch hint.
+  static PrimExpr StripLikely(PrimExpr cond) {
+    if (const auto* call = cond.as<CallNode>()) {
+      if (call->op.same_as(builtin::likely())) return call->args[0];
+    }
+    return cond;
+  }
+
   // analyzer
   arith::Analyzer analyzer_;
   // deep equal
@@ -463,6 +572,12 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
   PrimExpr ramp_;
   // flag to mark requirment of scalarization.
   bool need_scalarize_{false};
+  // whether vectorize the conditions on the lanes by predication.
+  bool enable_predication_{false};
+  // The predicate on the lanes of the enclosing conditions, if any.
+  PrimExpr predicate_;
+  // flag to mark a scalarization under the predicate.
+  bool predicate_failed_{false};
   // Let binding
   std::unordered_map<Var, PrimExpr, ObjectPtrHash, ObjectPtrEqual> let_binding_;
   // vectorizable property
@@ -530,18 +645,34 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
 
 class LoopVectorizer : public StmtMutator {
  public:
+  explicit LoopVectorizer(bool enable_predication = false, bool scalable = false)
+      : enable_predication_(enable_predication), scalable_(scalable) {}
+
   Stmt VisitStmt_(const ForNode* op) final {
     if (op->kind == ForKind::kVectorized) {
       ICHECK(is_zero(op->min));
       auto* extent_as_int = op->extent.as<IntImmNode>();
-      if (!extent_as_int || extent_as_int->value < 1) {
+      if (scalable_ || !extent_as_int) {
+        // The lanes are not known here, the backend vectorizes the loop with
+        // the vector length of the device, the other backends run it serially.
+        Map<String, ObjectRef> annotations = op->annotations;
+        annotations.Set(attr::scalable_vectorize, Integer(1));
+        return For(op->loop_var, op->min, op->extent, ForKind::kSerial,
+                   this->VisitStmt(op->body), op->thread_binding, annotations);
+      }
+      if (extent_as_int->value < 1) {
         LOG(FATAL) << "Failed to vectorize loop with extent " << op->extent;
       }
-      return Vectorizer(op->loop_var, static_cast<int>(extent_as_int->value))(op->body);
+      return Vectorizer(op->loop_var, static_cast<int>(extent_as_int->value),
+                        enable_predication_)(op->body);
     } else {
       return StmtMutator::VisitStmt_(op);
     }
   }
+
+ private:
+  bool enable_predication_;
+  bool scalable_;
 };
 
 Stmt VectorizeLoop(Stmt stmt) { return LoopVectorizer()(std::move(stmt)); }
@@ -568,7 +699,12 @@ Pass VectorizeLoop(bool enable_vectorize) {
   auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
     auto* n = f.CopyOnWrite();
     if (enable_vectorize) {
-      n->body = LoopVectorizer()(std::move(n->body));
+      auto cfg = ctx->GetConfig<VectorizeLoopConfig>("tir.VectorizeLoop");
+      if (!cfg.defined()) {
+        cfg = AttrsWithDefaultValues<VectorizeLoopConfig>();
+      }
+      n->body = LoopVectorizer(cfg.value()->enable_predication, cfg.value()->scalable)(
+          std::move(n->body));
     } else {
       n->body = VectorizeSkipper()(std::move(n->body));
     }
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file cpu_access_rewrite.cc
+ * \brief Rewrite CPU accesses to VTA buffers to go through their CPU pointers.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "vta_config.h"
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+/*!
+ * \brief VTA buffers are opaque handles that do not correspond to CPU addresses,
+ *  every load and store goes through the pointer returned by VTABufferCPUPtr.
+ */
+class CPUAccessRewriter : public StmtExprMutator {
+ public:
+  explicit CPUAccessRewriter(PrimExpr command_handle) : command_handle_(command_handle) {}
+
+  Stmt Rewrite(Stmt stmt) {
+    stmt = this->VisitStmt(stmt);
+    // The remaining buffers are allocated outside of the function
+    for (const VarNode* buffer_var : order_) {
+      auto it = rw_info_.find(buffer_var);
+      if (it == rw_info_.end()) continue;
+      stmt = LetStmt(it->second, CPUPtr(GetRef<Var>(buffer_var)), stmt);
+      rw_info_.erase(it);
+    }
+    return stmt;
+  }
+
+  Stmt VisitStmt_(const AllocateNode* op) final {
+    Stmt ret = StmtExprMutator::VisitStmt_(op);
+    op = ret.as<AllocateNode>();
+    auto it = rw_info_.find(op->buffer_var.get());
+    if (it == rw_info_.end()) return ret;
+    Stmt body = LetStmt(it->second, CPUPtr(op->buffer_var), op->body);
+    rw_info_.erase(it);
+    return Allocate(op->buffer_var, op->dtype, op->extents, op->condition, body);
+  }
+
+  PrimExpr VisitExpr_(const LoadNode* op) final {
+    PrimExpr ret = StmtExprMutator::VisitExpr_(op);
+    op = ret.as<LoadNode>();
+    return Load(op->dtype, this->CPUVar(op->buffer_var), op->index, op->predicate);
+  }
+
+  Stmt VisitStmt_(const StoreNode* op) final {
+    Stmt ret = StmtExprMutator::VisitStmt_(op);
+    op = ret.as<StoreNode>();
+    return Store(this->CPUVar(op->buffer_var), op->value, op->index, op->predicate);
+  }
+
+ private:
+  PrimExpr CPUPtr(Var buffer_var) {
+    return Call(DataType::Handle(), builtin::call_extern(),
+                {StringImm("VTABufferCPUPtr"), command_handle_, buffer_var});
+  }
+
+  Var CPUVar(const Var& buffer_var) {
+    auto it = rw_info_.find(buffer_var.get());
+    if (it != rw_info_.end()) return it->second;
+    Var new_var(buffer_var->name_hint + "_ptr", DataType::Handle());
+    rw_info_[buffer_var.get()] = new_var;
+    order_.push_back(buffer_var.get());
+    return new_var;
+  }
+
+  PrimExpr command_handle_;
+  // CPU pointer of the buffers accessed below the current statement
+  std::unordered_map<const VarNode*, Var> rw_info_;
+  // The buffers in the order of their first access
+  std::vector<const VarNode*> order_;
+};
+
+}  // namespace vta
+
+namespace transform {
+
+Pass VTACPUAccessRewrite(Map<String, ObjectRef> config) {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    PrimExpr command_handle = vta::VTAConfig::FromMap(config).command_handle;
+    auto* n = f.CopyOnWrite();
+    n->body = vta::CPUAccessRewriter(command_handle).Rewrite(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.vta.CPUAccessRewrite", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.VTACPUAccessRewrite").set_body_typed(VTACPUAccessRewrite);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
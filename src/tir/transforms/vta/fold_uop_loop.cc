@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file fold_uop_loop.cc
+ * \brief Fold the loops around VTA GEMM micro-ops into micro-op loops.
+ */
+#include <tvm/arith/pattern.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <string>
+#include <vector>
+
+#include "vta_config.h"
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+// Rewrite the micro-ops of a loop body relative to the loop variable
+class UopOffsetRewriter : public StmtExprMutator {
+ public:
+  explicit UopOffsetRewriter(Var loop_var)
+      : loop_var_(loop_var),
+        uop_push_(Op::Get("tir.vta.uop_push")),
+        command_handle_(Op::Get("tir.vta.command_handle")) {}
+
+  PrimExpr VisitExpr_(const CallNode* op) final {
+    PrimExpr ret = StmtExprMutator::VisitExpr_(op);
+    op = ret.as<CallNode>();
+    if (op->op.same_as(uop_push_)) {
+      const size_t base_args = 2;
+      Array<PrimExpr> args(op->args.begin(), op->args.begin() + base_args);
+      for (size_t i = 0; i < 3; ++i) {
+        Array<PrimExpr> m = arith::DetectLinearEquation(op->args[i + base_args], {loop_var_});
+        if (m.empty()) {
+          fail_ = true;
+          return ret;
+        }
+        if (offsets_[i].defined()) {
+          if (!StructuralEqual()(m[0], offsets_[i])) {
+            fail_ = true;
+            return ret;
+          }
+        } else {
+          offsets_[i] = m[0];
+        }
+        args.push_back(m[1]);
+      }
+      args.insert(args.end(), op->args.begin() + base_args + 3, op->args.end());
+      return Call(DataType::Int(32), uop_push_, args);
+    }
+    ICHECK(op->op.same_as(command_handle_) || op->op.same_as(builtin::tvm_thread_context()))
+        << "unexpected op " << ret;
+    return ret;
+  }
+
+  /*! \return Whether every micro-op is linear in the loop variable with the same offsets. */
+  bool success() const {
+    return !fail_ && offsets_[0].defined() && offsets_[1].defined() && offsets_[2].defined();
+  }
+  /*! \brief The offsets of the destination, source and weight per loop iteration. */
+  const PrimExpr* offsets() const { return offsets_; }
+
+ private:
+  Var loop_var_;
+  Op uop_push_;
+  Op command_handle_;
+  PrimExpr offsets_[3];
+  bool fail_{false};
+};
+
+// Fold the outermost loop of body, return false if it cannot be folded
+static bool FoldOutermostLoop(Stmt* body, std::vector<Stmt>* begins, std::vector<Stmt>* ends) {
+  const ForNode* loop = body->as<ForNode>();
+  if (loop == nullptr) return true;
+  UopOffsetRewriter rewriter(loop->loop_var);
+  Stmt ret = rewriter(loop->body);
+  if (!rewriter.success()) return false;
+  bool uses_loop_var = false;
+  PostOrderVisit(ret, [&](const ObjectRef& node) {
+    if (node.same_as(loop->loop_var)) uses_loop_var = true;
+  });
+  if (uses_loop_var) return false;
+  const PrimExpr* offsets = rewriter.offsets();
+  begins->push_back(
+      Evaluate(CallVTA("VTAUopLoopBegin", loop->extent, offsets[0], offsets[1], offsets[2])));
+  ends->push_back(Evaluate(CallVTA("VTAUopLoopEnd")));
+  *body = ret;
+  return true;
+}
+
+class UopLoopFolder : public StmtMutator {
+ public:
+  explicit UopLoopFolder(std::string push_gemm_uop) : push_gemm_uop_(push_gemm_uop) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    const StringImmNode* value = op->value.as<StringImmNode>();
+    if (op->attr_key != "coproc_uop_scope" || value == nullptr ||
+        value->value != push_gemm_uop_) {
+      return StmtMutator::VisitStmt_(op);
+    }
+    // VTA micro-op kernels support two levels of loops
+    Stmt body = op->body;
+    std::vector<Stmt> begins, ends;
+    if (FoldOutermostLoop(&body, &begins, &ends)) {
+      FoldOutermostLoop(&body, &begins, &ends);
+    }
+    if (body.same_as(op->body)) return GetRef<Stmt>(op);
+    Array<Stmt> seq(begins.begin(), begins.end());
+    seq.push_back(body);
+    seq.insert(seq.end(), ends.rbegin(), ends.rend());
+    return AttrStmt(op->node, op->attr_key, op->value, SeqStmt(seq));
+  }
+
+ private:
+  std::string push_gemm_uop_;
+};
+
+}  // namespace vta
+
+namespace transform {
+
+Pass VTAFoldUopLoop(Map<String, ObjectRef> config) {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    std::string push_gemm_uop = vta::VTAConfig::FromMap(config).push_gemm_uop;
+    auto* n = f.CopyOnWrite();
+    n->body = vta::UopLoopFolder(push_gemm_uop)(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.vta.FoldUopLoop", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.VTAFoldUopLoop").set_body_typed(VTAFoldUopLoop);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
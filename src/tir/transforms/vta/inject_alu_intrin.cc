@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inject_alu_intrin.cc
+ * \brief Lower the alu pragmas into VTA ALU micro-ops.
+ */
+#include <tvm/arith/pattern.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <vector>
+
+#include "vta_config.h"
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+class ALUIntrinInjector : public StmtMutator {
+ public:
+  explicit ALUIntrinInjector(const VTAConfig& cfg) : cfg_(cfg) {}
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    Stmt ret = StmtMutator::VisitStmt_(op);
+    op = ret.as<AttrStmtNode>();
+    if (op == nullptr || !MatchPragma(op, "alu")) return ret;
+    return this->InjectALU(op);
+  }
+
+ private:
+  bool Equal(const PrimExpr& x, const PrimExpr& y) { return is_zero(analyzer_.Simplify(x - y)); }
+
+  // Merge the outer loops that iterate contiguously over both source and destination
+  void FlattenLoop(std::vector<PrimExpr>* src_coeff, std::vector<PrimExpr>* dst_coeff,
+                   std::vector<PrimExpr>* extents) {
+    std::vector<PrimExpr> rev_src_coeff = {src_coeff->back()};
+    std::vector<PrimExpr> rev_dst_coeff = {dst_coeff->back()};
+    std::vector<PrimExpr> rev_extents;
+    src_coeff->pop_back();
+    dst_coeff->pop_back();
+    ICHECK(!src_coeff->empty());
+    PrimExpr vsrc = src_coeff->back();
+    PrimExpr vdst = dst_coeff->back();
+    PrimExpr vext = extents->back();
+    src_coeff->pop_back();
+    dst_coeff->pop_back();
+    extents->pop_back();
+    while (!src_coeff->empty()) {
+      PrimExpr next_src = src_coeff->back();
+      PrimExpr next_dst = dst_coeff->back();
+      PrimExpr next_ext = extents->back();
+      src_coeff->pop_back();
+      dst_coeff->pop_back();
+      extents->pop_back();
+      if (Equal(next_src, vsrc * vext) && Equal(next_dst, vdst * vext)) {
+        vext = analyzer_.Simplify(vext * next_ext);
+      } else {
+        rev_src_coeff.push_back(vsrc);
+        rev_dst_coeff.push_back(vdst);
+        rev_extents.push_back(vext);
+        vsrc = next_src;
+        vdst = next_dst;
+        vext = next_ext;
+      }
+    }
+    rev_src_coeff.push_back(vsrc);
+    rev_dst_coeff.push_back(vdst);
+    rev_extents.push_back(vext);
+    src_coeff->assign(rev_src_coeff.rbegin(), rev_src_coeff.rend());
+    dst_coeff->assign(rev_dst_coeff.rbegin(), rev_dst_coeff.rend());
+    extents->assign(rev_extents.rbegin(), rev_extents.rend());
+  }
+
+  static std::vector<PrimExpr> LinearCoeff(const PrimExpr& index, const Array<Var>& indices) {
+    Array<PrimExpr> coeff = arith::DetectLinearEquation(index, indices);
+    ICHECK(!coeff.empty()) << "Cannot detect linear pattern of " << index;
+    std::vector<PrimExpr> ret;
+    for (const PrimExpr& c : coeff) ret.push_back(c);
+    return ret;
+  }
+
+  static const LoadNode* AsLoad(const PrimExpr& e, const Var& dst_var) {
+    const LoadNode* load = e.as<LoadNode>();
+    ICHECK(load != nullptr && load->buffer_var.same_as(dst_var))
+        << "ALU operands must be loads of the destination buffer, got " << e;
+    return load;
+  }
+
+  Stmt InjectALU(const AttrStmtNode* stmt) {
+    // Get to the innermost loop body, deriving loop variables and extents
+    Array<Var> indices;
+    std::vector<PrimExpr> extents;
+    Stmt loop_body = stmt->body;
+    while (const ForNode* loop = loop_body.as<ForNode>()) {
+      indices.push_back(loop->loop_var);
+      extents.push_back(loop->extent);
+      loop_body = loop->body;
+    }
+    // Get the src/dst arguments
+    const StoreNode* store = loop_body.as<StoreNode>();
+    ICHECK(store != nullptr) << "Expect a store in the alu pragma, got " << stmt->body;
+    Var dst_var = store->buffer_var;
+    // Derive opcode
+    int alu_opcode;
+    PrimExpr lhs, rhs;
+    const PrimExpr& value = store->value;
+    if (const AddNode* op = value.as<AddNode>()) {
+      alu_opcode = kAluOpcodeAdd;
+      lhs = op->a;
+      rhs = op->b;
+    } else if (value.as<SubNode>()) {
+      LOG(FATAL) << "The VTA ALU has no subtraction, add the negated operand instead";
+      return Stmt();
+    } else if (const MulNode* op = value.as<MulNode>()) {
+      alu_opcode = kAluOpcodeMul;
+      lhs = op->a;
+      rhs = op->b;
+    } else if (const MinNode* op = value.as<MinNode>()) {
+      alu_opcode = kAluOpcodeMin;
+      lhs = op->a;
+      rhs = op->b;
+    } else if (const MaxNode* op = value.as<MaxNode>()) {
+      alu_opcode = kAluOpcodeMax;
+      lhs = op->a;
+      rhs = op->b;
+    } else if (const CallNode* op = value.as<CallNode>()) {
+      alu_opcode = kAluOpcodeShr;
+      if (op->op.same_as(builtin::shift_left())) {
+        lhs = op->args[0];
+        rhs = analyzer_.Simplify(-op->args[1]);
+      } else if (op->op.same_as(builtin::shift_right())) {
+        lhs = op->args[0];
+        rhs = op->args[1];
+      } else {
+        LOG(FATAL) << "Function call not recognized " << value;
+      }
+    } else if (value.as<LoadNode>()) {
+      alu_opcode = kAluOpcodeShr;
+      lhs = value;
+      rhs = make_const(DataType::Int(32), 0);
+    } else {
+      LOG(FATAL) << "Expression not recognized " << value->GetTypeKey() << ", " << value << ", "
+                 << GetRef<Stmt>(stmt);
+      return Stmt();
+    }
+    // Derive array index coefficients
+    std::vector<PrimExpr> dst_coeff = LinearCoeff(store->index, indices);
+    std::vector<PrimExpr> src_coeff;
+    // Check if lhs/rhs is immediate
+    bool use_imm = false;
+    PrimExpr imm_val;
+    if (rhs.as<IntImmNode>()) {
+      src_coeff = LinearCoeff(AsLoad(lhs, dst_var)->index, indices);
+      use_imm = true;
+      imm_val = rhs;
+    }
+    if (lhs.as<IntImmNode>()) {
+      src_coeff = LinearCoeff(AsLoad(rhs, dst_var)->index, indices);
+      use_imm = true;
+      imm_val = lhs;
+    }
+    if (!imm_val.defined()) {
+      imm_val = 0;
+      std::vector<PrimExpr> src_lhs_coeff = LinearCoeff(AsLoad(lhs, dst_var)->index, indices);
+      std::vector<PrimExpr> src_rhs_coeff = LinearCoeff(AsLoad(rhs, dst_var)->index, indices);
+      // Determine which side has the same coefficients
+      bool lhs_equal = true, rhs_equal = true;
+      for (size_t i = 0; i < dst_coeff.size(); ++i) {
+        if (!StructuralEqual()(dst_coeff[i], src_lhs_coeff[i])) lhs_equal = false;
+        if (!StructuralEqual()(dst_coeff[i], src_rhs_coeff[i])) rhs_equal = false;
+      }
+      // Make sure at least one of the source is identical to the
+      // destination (in-place computation)
+      ICHECK(lhs_equal || rhs_equal);
+      // Assign the source coefficients
+      src_coeff = lhs_equal ? src_rhs_coeff : src_lhs_coeff;
+    }
+    // Ensure that we have the proper tensor dimensions in the
+    // innermost loop (pattern match)
+    int tile = cfg_.batch * cfg_.block_out;
+    auto dim = [](const std::vector<PrimExpr>& v, size_t i) { return v[v.size() - i]; };
+    ICHECK_GT(src_coeff.size(), 1U);
+    ICHECK_GT(dst_coeff.size(), 1U);
+    ICHECK_NE(extents.size(), 0U);
+    ICHECK(is_zero(analyzer_.Simplify(indexmod(dim(src_coeff, 1), tile))));
+    ICHECK(is_zero(analyzer_.Simplify(indexmod(dim(dst_coeff, 1), tile))));
+    ICHECK(is_one(dim(src_coeff, 2)));
+    ICHECK(is_one(dim(dst_coeff, 2)));
+    if (cfg_.batch > 1) {
+      ICHECK_GT(src_coeff.size(), 2U);
+      ICHECK_GT(dst_coeff.size(), 2U);
+      ICHECK_GT(extents.size(), 1U);
+      ICHECK(is_const_int(dim(src_coeff, 3), cfg_.block_out));
+      ICHECK(is_const_int(dim(dst_coeff, 3), cfg_.block_out));
+    }
+    // Apply tensorization of the loop coefficients
+    PrimExpr src_offset = src_coeff.back();
+    PrimExpr dst_offset = dst_coeff.back();
+    size_t tensor_dims = cfg_.batch == 1 ? 1 : 2;
+    src_coeff.resize(src_coeff.size() - tensor_dims - 1);
+    dst_coeff.resize(dst_coeff.size() - tensor_dims - 1);
+    extents.resize(extents.size() - tensor_dims);
+    src_coeff.push_back(src_offset);
+    dst_coeff.push_back(dst_offset);
+    for (PrimExpr& c : src_coeff) c = analyzer_.Simplify(floordiv(c, tile));
+    for (PrimExpr& c : dst_coeff) c = analyzer_.Simplify(floordiv(c, tile));
+    // Flatten the outer loops
+    if (!extents.empty()) {
+      FlattenLoop(&src_coeff, &dst_coeff, &extents);
+    }
+    // Insert ALU micro-ops
+    Array<Stmt> seq;
+    for (size_t i = 0; i < extents.size(); ++i) {
+      PrimExpr begin = CallVTA("VTAUopLoopBegin", extents[i], dst_coeff[i], src_coeff[i], 0);
+      seq.push_back(Evaluate(begin));
+    }
+    Array<PrimExpr> uop_args = {1, 0, dst_coeff.back(), src_coeff.back(), 0,
+                                alu_opcode, static_cast<int>(use_imm), imm_val};
+    seq.push_back(Evaluate(Call(DataType::Int(32), Op::Get("tir.vta.uop_push"), uop_args)));
+    for (size_t i = 0; i < extents.size(); ++i) {
+      seq.push_back(Evaluate(CallVTA("VTAUopLoopEnd")));
+    }
+    return SeqStmt::Flatten(seq);
+  }
+
+  VTAConfig cfg_;
+  arith::Analyzer analyzer_;
+};
+
+}  // namespace vta
+
+namespace transform {
+
+Pass VTAInjectALUIntrin(Map<String, ObjectRef> config) {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = vta::ALUIntrinInjector(vta::VTAConfig::FromMap(config))(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.vta.InjectALUIntrin", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.VTAInjectALUIntrin").set_body_typed(VTAInjectALUIntrin);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
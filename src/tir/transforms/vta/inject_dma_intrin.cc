@@ -0,0 +1,265 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inject_dma_intrin.cc
+ * \brief Lower the dma_copy pragmas into VTA 2D load and store calls.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/buffer.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/transform.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vta_config.h"
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+/*! \brief A 2D DMA transfer in units of elem_block elements. */
+struct DMAPattern {
+  PrimExpr x_size;
+  PrimExpr y_size;
+  PrimExpr x_stride;
+  PrimExpr offset;
+};
+
+class DMAIntrinInjector {
+ public:
+  explicit DMAIntrinInjector(const VTAConfig& cfg) : cfg_(cfg) {}
+
+  Stmt InjectCopy(Buffer src, Buffer dst, Array<PrimExpr> pad_before, Array<PrimExpr> pad_after,
+                  PrimExpr pad_value) {
+    // FIXME: pad_value is ignored...
+    if (dst->scope == "global") {
+      // Store
+      if (!pad_before.empty() || !pad_after.empty()) {
+        LOG(FATAL) << "Do not support copy into DRAM with pad";
+      }
+      if (src->scope != cfg_.acc_scope) {
+        LOG(FATAL) << "Do not support copy " << src->scope << "->dram";
+      }
+      CheckCompact(src);
+      DMAPattern p = Get2DPattern(dst, cfg_.out_width, cfg_.out_elem_bytes, src->scope, true);
+      PrimExpr call = CallVTA("VTAStoreBuffer2D", cfg_.command_handle,
+                              src.access_ptr(1, DataType::Int(32)), kMemIdOut, dst->data,
+                              p.offset, p.x_size, p.y_size, p.x_stride);
+      return CoprocScope(kQidStoreOut, call);
+    }
+    if (src->scope != "global") {
+      LOG(FATAL) << "Do not support copy " << src->scope << "->" << dst->scope;
+    }
+    int elem_width, elem_bytes, mem_type, task_qid;
+    if (dst->scope == cfg_.acc_scope) {
+      elem_width = cfg_.acc_width;
+      elem_bytes = cfg_.acc_elem_bytes;
+      mem_type = kMemIdAcc;
+      task_qid = kQidLoadOut;
+    } else if (dst->scope == cfg_.inp_scope) {
+      elem_width = cfg_.inp_width;
+      elem_bytes = cfg_.inp_elem_bytes;
+      mem_type = kMemIdInp;
+      task_qid = kQidLoadInp;
+    } else if (dst->scope == cfg_.wgt_scope) {
+      elem_width = cfg_.wgt_width;
+      elem_bytes = cfg_.wgt_elem_bytes;
+      mem_type = kMemIdWgt;
+      task_qid = kQidLoadWgt;
+    } else {
+      LOG(FATAL) << "Do not support copy dram->" << dst->scope;
+      return Stmt();
+    }
+    // collect pad statistics
+    PrimExpr x_pad_before = 0, y_pad_before = 0, x_pad_after = 0, y_pad_after = 0;
+    bool allow_fold = true;
+    if (!pad_before.empty()) {
+      ICHECK(!pad_after.empty());
+      size_t ndim = pad_before.size();
+      if (ndim <= 2 || ndim > 5) {
+        LOG(FATAL) << "Limitation of 2D pad load forbid ndim=" << ndim;
+      }
+      // With batch size N > 1 the outermost dimension is the batch
+      size_t y_dim = ndim == 5 ? 1 : 0;
+      y_pad_before = pad_before[y_dim];
+      x_pad_before = pad_before[y_dim + 1];
+      y_pad_after = pad_after[y_dim];
+      x_pad_after = pad_after[y_dim + 1];
+      for (size_t dim = y_dim + 2; dim < ndim; ++dim) {
+        if (!EqualConstInt(&analyzer_, pad_before[dim], 0) ||
+            !EqualConstInt(&analyzer_, pad_after[dim], 0)) {
+          LOG(FATAL) << "Do not support pad on the innermost block";
+        }
+      }
+      allow_fold = false;
+    }
+    CheckCompact(dst);
+    DMAPattern p = Get2DPattern(src, elem_width, elem_bytes, dst->scope, allow_fold);
+    if (src->dtype != DataType::Int(elem_width)) {
+      ICHECK(elem_width == cfg_.acc_width && src->dtype == DataType::Int(cfg_.inp_width));
+      mem_type = kMemIdAcc8Bit;
+    }
+    PrimExpr call =
+        CallVTA("VTALoadBuffer2D", cfg_.command_handle, src->data, p.offset, p.x_size, p.y_size,
+                p.x_stride, x_pad_before, y_pad_before, x_pad_after, y_pad_after,
+                dst.access_ptr(1, DataType::Int(32)), mem_type);
+    return CoprocScope(task_qid, call);
+  }
+
+ private:
+  Stmt CoprocScope(int task_qid, PrimExpr call) {
+    return AttrStmt(cfg_.vta_axis, attr::coproc_scope, cfg_.TaskQid(task_qid), Evaluate(call));
+  }
+
+  void CheckCompact(const Buffer& buf) {
+    size_t ndim = buf->shape.size();
+    PrimExpr size = make_const(buf->shape[0].dtype(), 1);
+    for (size_t i = ndim; i-- > 0;) {
+      if (!EqualConstInt(&analyzer_, size - buf->strides[i], 0)) {
+        LOG(FATAL) << "Cannot prove compact: shape=" << buf->shape << ", strides=" << buf->strides;
+      }
+      size = size * buf->shape[i];
+    }
+  }
+
+  // Merge the dimensions of the buffer that are contiguous in memory
+  void FoldBufferDim(const Buffer& buf, const std::string& scope, int elem_block,
+                     std::vector<PrimExpr>* shape, std::vector<PrimExpr>* strides) {
+    size_t ndim = buf->shape.size();
+    PrimExpr x_size = 1;
+    size_t base = 0;
+    for (size_t i = 1; i < ndim + 1; ++i) {
+      if (!EqualConstInt(&analyzer_, buf->strides[ndim - i] - x_size, 0)) {
+        LOG(FATAL) << "scope " << scope << " needs to have block=" << elem_block;
+      }
+      x_size = x_size * buf->shape[ndim - i];
+      if (EqualConstInt(&analyzer_, x_size - elem_block, 0)) {
+        base = i + 1;
+        break;
+      }
+    }
+    if (base == 0) {
+      LOG(FATAL) << "scope " << scope << " need to have block=" << elem_block
+                 << ", shape=" << buf->shape;
+    }
+    shape->assign({elem_block});
+    strides->assign({1});
+    if (base < ndim + 1 && !EqualConstInt(&analyzer_, buf->strides[ndim - base], elem_block)) {
+      shape->push_back(1);
+      strides->push_back(elem_block);
+    }
+    while (base < ndim + 1) {
+      x_size = 1;
+      PrimExpr x_stride = buf->strides[ndim - base];
+      size_t next_base = base;
+      if (!EqualConstInt(&analyzer_, indexmod(x_stride, elem_block), 0)) {
+        LOG(FATAL) << "scope " << scope << " need to have block=" << elem_block
+                   << ", shape=" << buf->shape << ", strides=" << buf->strides;
+      }
+      for (size_t i = base; i < ndim + 1; ++i) {
+        size_t k = ndim - i;
+        if (!EqualConstInt(&analyzer_, x_size * x_stride - buf->strides[k], 0)) break;
+        x_size = x_size * buf->shape[k];
+        next_base = i + 1;
+      }
+      shape->push_back(analyzer_.Simplify(x_size));
+      strides->push_back(x_stride);
+      ICHECK_NE(next_base, base);
+      base = next_base;
+    }
+    std::reverse(shape->begin(), shape->end());
+    std::reverse(strides->begin(), strides->end());
+  }
+
+  DMAPattern Get2DPattern(const Buffer& buf, int elem_width, int elem_bytes,
+                          const std::string& scope, bool allow_fold) {
+    int elem_block = elem_bytes * 8 / elem_width;
+    if (!EqualConstInt(&analyzer_, indexmod(buf->elem_offset, elem_block), 0)) {
+      LOG(FATAL) << "scope " << scope << " need to have block=" << elem_block;
+    }
+    std::vector<PrimExpr> shape, strides;
+    if (allow_fold) {
+      FoldBufferDim(buf, scope, elem_block, &shape, &strides);
+    } else {
+      for (const PrimExpr& e : buf->shape) shape.push_back(e);
+      for (const PrimExpr& e : buf->strides) strides.push_back(e);
+    }
+    auto raise_error = [&]() {
+      LOG(FATAL) << "Scope[" << scope << "]: cannot detect 2d pattern with elem_block="
+                 << elem_block << ": shape=" << buf->shape << ", strides=" << buf->strides;
+    };
+    auto dim = [](const std::vector<PrimExpr>& v, size_t i) { return v[v.size() - i]; };
+    auto is_const = [&](const PrimExpr& e, int64_t value) {
+      return EqualConstInt(&analyzer_, e, value);
+    };
+    PrimExpr offset = indexdiv(buf->elem_offset, elem_block);
+    size_t ndim = shape.size();
+    // Check if the inner-tensor is already flat
+    bool flat = is_const(dim(shape, 1), elem_block);
+    if (!is_const(dim(strides, 1), 1)) raise_error();
+    if (flat) {
+      if (ndim == 1) return {1, 1, 1, offset};
+      if (!is_const(dim(strides, 2) - elem_block, 0)) raise_error();
+      if (ndim == 2) return {dim(shape, 2), 1, dim(shape, 2), offset};
+      if (!is_const(indexmod(dim(strides, 3), elem_block), 0)) raise_error();
+      if (ndim == 3) {
+        return {dim(shape, 2), dim(shape, 3), indexdiv(dim(strides, 3), elem_block), offset};
+      }
+    } else {
+      if (!is_const(dim(strides, 2) - dim(shape, 1), 0)) raise_error();
+      if (!is_const(dim(shape, 1) * dim(shape, 2), elem_block)) raise_error();
+      if (ndim == 2) return {1, 1, 1, offset};
+      if (!is_const(dim(strides, 3), elem_block)) raise_error();
+      if (ndim == 3) return {dim(shape, 3), 1, dim(shape, 3), offset};
+      if (!is_const(indexmod(dim(strides, 4), elem_block), 0)) raise_error();
+      if (ndim == 4) {
+        return {dim(shape, 3), dim(shape, 4), indexdiv(dim(strides, 4), elem_block), offset};
+      }
+    }
+    raise_error();
+    return DMAPattern();
+  }
+
+  VTAConfig cfg_;
+  arith::Analyzer analyzer_;
+};
+
+}  // namespace vta
+
+namespace transform {
+
+Pass VTAInjectDMAIntrin(Map<String, ObjectRef> config) {
+  auto injector = std::make_shared<vta::DMAIntrinInjector>(vta::VTAConfig::FromMap(config));
+  TypedPackedFunc<Stmt(Buffer, Buffer, Array<PrimExpr>, Array<PrimExpr>, PrimExpr)> fcopy =
+      [injector](Buffer src, Buffer dst, Array<PrimExpr> pad_before, Array<PrimExpr> pad_after,
+                 PrimExpr pad_value) {
+        return injector->InjectCopy(src, dst, pad_before, pad_after, pad_value);
+      };
+  return InjectCopyIntrin("dma_copy", fcopy);
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.VTAInjectDMAIntrin").set_body_typed(VTAInjectDMAIntrin);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
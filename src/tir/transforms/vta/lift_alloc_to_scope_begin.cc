@@ -0,0 +1,127 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file lift_alloc_to_scope_begin.cc
+ * \brief Lift allocations to the beginning of the enclosing loop or virtual thread.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <utility>
+#include <vector>
+
+#include "vta_config.h"
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+class AllocLifter : public StmtMutator {
+ public:
+  Stmt Lift(Stmt stmt) {
+    lift_stmt_.emplace_back();
+    stmt = this->VisitStmt(stmt);
+    ICHECK_EQ(lift_stmt_.size(), 1U);
+    return MergeBlock(PopScope(), stmt);
+  }
+
+  Stmt VisitStmt_(const AllocateNode* op) final {
+    Stmt ret = StmtMutator::VisitStmt_(op);
+    lift_stmt_.back().push_back(ret);
+    return ret.as<AllocateNode>()->body;
+  }
+
+  Stmt VisitStmt_(const AttrStmtNode* op) final {
+    if (op->attr_key == attr::virtual_thread) {
+      lift_stmt_.emplace_back();
+    }
+    Stmt ret = StmtMutator::VisitStmt_(op);
+    op = ret.as<AttrStmtNode>();
+    if (op->attr_key == attr::storage_scope) {
+      lift_stmt_.back().push_back(ret);
+      return op->body;
+    }
+    if (op->attr_key == attr::virtual_thread) {
+      std::vector<Stmt> slist = PopScope();
+      slist.push_back(ret);
+      return MergeBlock(std::move(slist), op->body);
+    }
+    return ret;
+  }
+
+  Stmt VisitStmt_(const ForNode* op) final {
+    lift_stmt_.emplace_back();
+    Stmt ret = StmtMutator::VisitStmt_(op);
+    std::vector<Stmt> slist = PopScope();
+    slist.push_back(ret);
+    return MergeBlock(std::move(slist), ret.as<ForNode>()->body);
+  }
+
+ private:
+  std::vector<Stmt> PopScope() {
+    std::vector<Stmt> slist = std::move(lift_stmt_.back());
+    lift_stmt_.pop_back();
+    return slist;
+  }
+
+  // Wrap body in the statements, the first one innermost
+  static Stmt MergeBlock(std::vector<Stmt> slist, Stmt body) {
+    for (const Stmt& stmt : slist) {
+      if (const AllocateNode* op = stmt.as<AllocateNode>()) {
+        body = op->body.same_as(body)
+                   ? stmt
+                   : Allocate(op->buffer_var, op->dtype, op->extents, op->condition, body);
+      } else if (const AttrStmtNode* op = stmt.as<AttrStmtNode>()) {
+        body = op->body.same_as(body) ? stmt : AttrStmt(op->node, op->attr_key, op->value, body);
+      } else if (const ForNode* op = stmt.as<ForNode>()) {
+        body = op->body.same_as(body) ? stmt
+                                      : For(op->loop_var, op->min, op->extent, op->kind, body,
+                                            op->thread_binding, op->annotations);
+      } else {
+        LOG(FATAL) << "unexpected op " << stmt;
+      }
+    }
+    return body;
+  }
+
+  // Statements lifted to the beginning of each enclosing scope
+  std::vector<std::vector<Stmt>> lift_stmt_;
+};
+
+}  // namespace vta
+
+namespace transform {
+
+Pass VTALiftAllocToScopeBegin() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = vta::AllocLifter().Lift(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.vta.LiftAllocToScopeBegin", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.VTALiftAllocToScopeBegin")
+    .set_body_typed(VTALiftAllocToScopeBegin);
+
+}  // namespace transform
+}  // namespace tir
+}  // namespace tvm
@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file vta_config.h
+ * \brief Hardware parameters shared by the VTA lowering passes.
+ */
+#ifndef TVM_TIR_TRANSFORMS_VTA_VTA_CONFIG_H_
+#define TVM_TIR_TRANSFORMS_VTA_VTA_CONFIG_H_
+
+#include <tvm/arith/analyzer.h>
+#include <tvm/ir/op.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/stmt.h>
+
+#include <string>
+
+namespace tvm {
+namespace tir {
+namespace vta {
+
+/*! \brief Memory ids of the DMA instructions, see vta.environment.DevContext. */
+enum VTAMemId : int {
+  kMemIdUop = 0,
+  kMemIdWgt = 1,
+  kMemIdInp = 2,
+  kMemIdAcc = 3,
+  kMemIdOut = 4,
+  kMemIdAcc8Bit = 5,
+};
+
+/*! \brief ALU opcodes, see vta.environment.DevContext. */
+enum VTAAluOpcode : int {
+  kAluOpcodeMin = 0,
+  kAluOpcodeMax = 1,
+  kAluOpcodeAdd = 2,
+  kAluOpcodeShr = 3,
+  kAluOpcodeMul = 4,
+};
+
+/*! \brief Task queue ids (pipeline stages), see vta.environment.DevContext. */
+enum VTAQueueId : int {
+  kQidLoadInp = 1,
+  kQidLoadWgt = 1,
+  kQidLoadOut = 2,
+  kQidStoreOut = 3,
+  kQidCompute = 2,
+};
+
+/*!
+ * \brief The parts of vta.Environment the lowering passes depend on.
+ *
+ *  libtvm knows nothing about the VTA configuration, so the Python side hands
+ *  it over as a map when it creates the passes, see vta.transform.
+ */
+struct VTAConfig {
+  /*! \brief The thread axis of the coproc_scope attributes. */
+  IterVar vta_axis;
+  /*! \brief Expression of the command handle of the current thread. */
+  PrimExpr command_handle;
+  /*! \brief Global symbol of the GEMM micro-op kernels. */
+  std::string push_gemm_uop;
+  /*! \brief Run every task on the first queue, see DevContext.DEBUG_NO_SYNC. */
+  bool debug_no_sync{false};
+  int batch{1};
+  int block_out{1};
+  std::string inp_scope;
+  std::string wgt_scope;
+  std::string acc_scope;
+  int inp_width{8};
+  int wgt_width{8};
+  int acc_width{32};
+  int out_width{8};
+  int inp_elem_bytes{1};
+  int wgt_elem_bytes{1};
+  int acc_elem_bytes{1};
+  int out_elem_bytes{1};
+
+  /*! \brief Read the configuration produced by vta.transform. */
+  static VTAConfig FromMap(const Map<String, ObjectRef>& cfg) {
+    VTAConfig ret;
+    ret.vta_axis = Downcast<IterVar>(cfg.at("vta_axis"));
+    ret.command_handle = Downcast<PrimExpr>(cfg.at("command_handle"));
+    ret.push_gemm_uop = Downcast<String>(cfg.at("push_gemm_uop"));
+    ret.debug_no_sync = GetInt(cfg, "debug_no_sync") != 0;
+    ret.batch = GetInt(cfg, "BATCH");
+    ret.block_out = GetInt(cfg, "BLOCK_OUT");
+    ret.inp_scope = Downcast<String>(cfg.at("inp_scope"));
+    ret.wgt_scope = Downcast<String>(cfg.at("wgt_scope"));
+    ret.acc_scope = Downcast<String>(cfg.at("acc_scope"));
+    ret.inp_width = GetInt(cfg, "INP_WIDTH");
+    ret.wgt_width = GetInt(cfg, "WGT_WIDTH");
+    ret.acc_width = GetInt(cfg, "ACC_WIDTH");
+    ret.out_width = GetInt(cfg, "OUT_WIDTH");
+    ret.inp_elem_bytes = GetInt(cfg, "INP_ELEM_BYTES");
+    ret.wgt_elem_bytes = GetInt(cfg, "WGT_ELEM_BYTES");
+    ret.acc_elem_bytes = GetInt(cfg, "ACC_ELEM_BYTES");
+    ret.out_elem_bytes = GetInt(cfg, "OUT_ELEM_BYTES");
+    return ret;
+  }
+  /*! \brief Get the transformed queue index. */
+  int TaskQid(int qid) const { return debug_no_sync ? 1 : qid; }
+
+ private:
+  static int GetInt(const Map<String, ObjectRef>& cfg, const std::string& key) {
+    auto it = cfg.find(key);
+    ICHECK(it != cfg.end()) << "VTA config is missing " << key;
+    const IntImmNode* value = (*it).second.as<IntImmNode>();
+    ICHECK(value != nullptr) << "VTA config " << key << " is not an integer";
+    return static_cast<int>(value->value);
+  }
+};
+
+/*! \brief Whether the attribute is the pragma key, see vta.transform._match_pragma. */
+inline bool MatchPragma(const AttrStmtNode* op, const std::string& key) {
+  if (op->attr_key == attr::pragma_scope_prefix + key) return true;
+  if (op->attr_key != "pragma_scope") return false;
+  const StringImmNode* value = op->value.as<StringImmNode>();
+  return value != nullptr && value->value == key;
+}
+
+/*! \brief Whether the expression simplifies to the constant, see topi.utils.equal_const_int. */
+inline bool EqualConstInt(arith::Analyzer* analyzer, const PrimExpr& expr, int64_t value) {
+  const IntImmNode* imm = analyzer->Simplify(expr).as<IntImmNode>();
+  return imm != nullptr && imm->value == value;
+}
+
+/*! \brief Call a function of the VTA runtime. */
+template <typename... Args>
+inline PrimExpr CallVTA(const std::string& name, Args&&... args) {
+  Array<PrimExpr> call_args = {StringImm(name), PrimExpr(std::forward<Args>(args))...};
+  return Call(DataType::Int(32), builtin::call_extern(), call_args);
+}
+
+}  // namespace vta
+}  // namespace tir
+}  // namespace tvm
+#endif  // TVM_TIR_TRANSFORMS_VTA_VTA_CONFIG_H_
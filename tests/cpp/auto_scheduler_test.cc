@@ -171,6 +171,30 @@ TEST(ComputeDAG, AccessAnalyzer) {
   }
 }
 
+// Test that the states share their attach map until its relations change
+TEST(LoopState, AttachMapSharing) {
+  const auto& tensors = conv2d_nchw_bn_relu_func(1, 56, 56, 64, 64, 3, 1, 1);
+  const auto& dag = tvm::auto_scheduler::ComputeDAG(tensors);
+  int padding = 1, conv = 3;
+  State s0 = dag->init_state;
+
+  // Splitting a loop without attached stages keeps the map of the parent state
+  State s1 = s0;
+  s1.split(conv, s1->stages[conv]->iters[0], {tvm::Integer(1)});
+  ICHECK(s1->attach_map.same_as(s0->attach_map));
+
+  State s2 = s1;
+  s2.compute_at(padding, conv, s2->stages[conv]->iters[2]);
+  ICHECK(!s2->attach_map.same_as(s1->attach_map));
+  ICHECK_EQ(s1->attach_map->stage_to_attach_iter.count(padding), 0);
+
+  // Splitting the loop of an attached stage copies the map
+  State s3 = s2;
+  s3.split(conv, s3->stages[conv]->iters[2], {tvm::Integer(1)});
+  ICHECK(!s3->attach_map.same_as(s2->attach_map));
+  ICHECK_EQ(s2->attach_map->stage_to_attach_iter.at(padding).second, 2);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
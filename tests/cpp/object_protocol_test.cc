@@ -22,6 +22,8 @@
 #include <tvm/runtime/memory.h>
 #include <tvm/runtime/object.h>
 
+#include <thread>
+
 namespace tvm {
 namespace test {
 
@@ -59,10 +61,21 @@ class ObjAA : public ObjA {
   TVM_DECLARE_FINAL_OBJECT_INFO(ObjAA, ObjA);
 };
 
+class PooledObj : public Object {
+ public:
+  int64_t value[3];
+
+  static constexpr const bool _type_pooled_alloc = true;
+  static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "test.PooledObj";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PooledObj, Object);
+};
+
 TVM_REGISTER_OBJECT_TYPE(ObjBase);
 TVM_REGISTER_OBJECT_TYPE(ObjA);
 TVM_REGISTER_OBJECT_TYPE(ObjB);
 TVM_REGISTER_OBJECT_TYPE(ObjAA);
+TVM_REGISTER_OBJECT_TYPE(PooledObj);
 
 }  // namespace test
 }  // namespace tvm
@@ -96,6 +109,25 @@ TEST(ObjectHierachy, Basic) {
   ICHECK(refB.as<ObjB>() != nullptr);
 }
 
+TEST(ObjectPool, Reuse) {
+  using namespace tvm::runtime;
+  using namespace tvm::test;
+
+  ObjectPtr<PooledObj> first = make_object<PooledObj>();
+  ICHECK_EQ(first->type_index(), PooledObj::RuntimeTypeIndex());
+  const PooledObj* addr = first.get();
+  first.reset();
+  // The next object of the same size reuses the memory freed on the thread
+  ObjectPtr<PooledObj> second = make_object<PooledObj>();
+  ICHECK_EQ(second.get(), addr);
+
+  // Objects may be freed on another thread than the one that allocated them
+  std::thread other([&second]() { second.reset(); });
+  other.join();
+  ICHECK(second == nullptr);
+  ICHECK(make_object<PooledObj>() != nullptr);
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
@@ -308,6 +308,42 @@ TEST(TypedPackedFunc, RValue) {
   }
 }
 
+TEST(Registry, Symbol) {
+  using namespace tvm::runtime;
+  const Registry::Symbol* sym = Registry::Intern("test.registry.symbol");
+  ICHECK(Registry::Get(sym) == nullptr);
+  ICHECK_EQ(Registry::Intern("test.registry.symbol"), sym);
+
+  Registry::Register("test.registry.symbol").set_body_typed([](int x) { return x + 1; });
+  int y = (*Registry::Get(sym))(1);
+  ICHECK_EQ(y, 2);
+  ICHECK_EQ(Registry::Get(sym), Registry::Get("test.registry.symbol"));
+
+  // The symbol follows the function registered under the name.
+  Registry::Register("test.registry.symbol", true).set_body_typed([](int x) { return x + 2; });
+  y = (*Registry::Get(sym))(1);
+  ICHECK_EQ(y, 3);
+  ICHECK(Registry::Remove("test.registry.symbol"));
+  ICHECK(Registry::Get(sym) == nullptr);
+  ICHECK(Registry::Get("test.registry.symbol") == nullptr);
+  ICHECK(!Registry::Remove("test.registry.symbol"));
+}
+
+TEST(Registry, ManyNames) {
+  using namespace tvm::runtime;
+  // Enough names to grow the table of the registry.
+  for (int i = 0; i < 4096; ++i) {
+    Registry::Register("test.registry.many." + std::to_string(i)).set_body_typed([i]() {
+      return i;
+    });
+  }
+  for (int i = 0; i < 4096; ++i) {
+    int value = (*Registry::Get("test.registry.many." + std::to_string(i)))();
+    ICHECK_EQ(value, i);
+    ICHECK(Registry::Remove("test.registry.many." + std::to_string(i)));
+  }
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
@@ -139,6 +139,33 @@ TEST(Pattern, IntImm) {
   ICHECK(!(v * c).Match((tx + 1) * 3));
 }
 
+TEST(Pattern, KindFilter) {
+  using namespace tvm;
+  using namespace tvm::tir;
+  using namespace tvm::arith;
+  Var x("x"), y("y");
+  SizeVar n("n");
+  PVar<PrimExpr> px, py;
+  PVar<IntImm> c;
+  PVar<Var> v;
+  // The filter rejects the mismatched roots and operands.
+  ICHECK(PKindMayMatch<decltype(px + py)>(x + y));
+  ICHECK(!PKindMayMatch<decltype(px + py)>(x - y));
+  ICHECK(PKindMayMatch<decltype((px - py) + py)>((x - y) + y));
+  ICHECK(!PKindMayMatch<decltype((px - py) + py)>((x * y) + y));
+  ICHECK(!PKindMayMatch<decltype(px + c)>(x + y));
+  ICHECK(PKindMayMatch<decltype(px + 1)>(x + 1));
+  ICHECK(PKindMayMatch<decltype(v * c)>(n * 3));
+  ICHECK(!PKindMayMatch<decltype(v * c)>((x + 1) * 3));
+  ICHECK(PKindMayMatch<decltype(max(px, py) + min(px, py))>(max(x, y) + min(x, y)));
+  ICHECK(!PKindMayMatch<decltype(max(px, py) + min(px, py))>(max(x, y) + max(x, y)));
+  // It never rejects a pattern that matches.
+  PrimExpr e = floordiv(x, 4) * 4 + floormod(x, 4);
+  ICHECK(PKindMayMatch<decltype(floordiv(px, c) * c + floormod(px, c))>(e));
+  ICHECK((floordiv(px, c) * c + floormod(px, c)).Match(e));
+  ICHECK(PKindMayMatch<decltype(px)>(e));
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
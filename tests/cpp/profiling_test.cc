@@ -37,6 +37,50 @@ TEST(DefaultTimer, Basic) {
   int64_t elapsed = t->SyncAndGetElapsedNanos();
   CHECK_GT(elapsed, 9 * 1e6);
 }
+
+// A timer for a device type nothing else registers profiling hooks for.
+class FakeTimerNode : public TimerNode {
+ public:
+  void Start() final {}
+  void Stop() final {}
+  int64_t SyncAndGetElapsedNanos() final { return 0; }
+
+  static constexpr const char* _type_key = "test.FakeTimerNode";
+  TVM_DECLARE_FINAL_OBJECT_INFO(FakeTimerNode, TimerNode);
+};
+TVM_REGISTER_OBJECT_TYPE(FakeTimerNode);
+
+TEST(Profiler, DeviceCounters) {
+  using namespace tvm::runtime;
+  Device dev;
+  dev.device_type = kDLVPI;
+  dev.device_id = 0;
+
+  int64_t busy = 0;
+  Registry::Register("profiling.timer.vpi").set_body_typed([](Device dev) {
+    return Timer(make_object<FakeTimerNode>());
+  });
+  Registry::Register("profiling.counters.vpi").set_body_typed([&busy](Device dev) {
+    Map<String, ObjectRef> counters;
+    counters.Set("Busy", ObjectRef(make_object<profiling::CountNode>(busy)));
+    return counters;
+  });
+
+  profiling::Profiler prof;
+  prof.Start({dev});
+  busy += 5;
+  prof.StartCall("op", dev);
+  busy += 7;
+  prof.StopCall();
+  prof.Stop();
+  Registry::Remove("profiling.counters.vpi");
+
+  profiling::Report report = prof.Report(false, false);
+  Registry::Remove("profiling.timer.vpi");
+  ASSERT_EQ(report->calls.size(), 1U);
+  EXPECT_EQ(report->calls[0].at("Busy").as<profiling::CountNode>()->value, 7);
+  EXPECT_EQ(report->device_metrics.at("vpi0").at("Busy").as<profiling::CountNode>()->value, 12);
+}
 }  // namespace runtime
 }  // namespace tvm
 
@@ -19,10 +19,15 @@
 
 #include <gtest/gtest.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <atomic>
+#include <chrono>
+#include <cstdlib>
 #include <memory>
 #include <thread>
+#include <vector>
 
 constexpr size_t N = 128;
 
@@ -63,6 +68,160 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
     }
   }
 }
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  // The schedule is read when the thread pool of a thread is created
+  setenv("TVM_THREAD_POOL_SCHEDULE", "steal", 1);
+  std::thread t([]() {
+    for (size_t j = 0; j < 3; ++j) {
+      std::atomic<size_t> acc(0);
+      TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+      EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    }
+    // Every task runs exactly once, also when the first tasks are much slower
+    std::vector<std::atomic<int>> runs(4096);
+    for (auto& r : runs) r.store(0);
+    FTVMParallelLambda count_runs = [](int task_id, TVMParallelGroupEnv* penv,
+                                       void* cdata) -> int {
+      auto* runs = reinterpret_cast<std::vector<std::atomic<int>>*>(cdata);
+      if (task_id == 0) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      EXPECT_LT(static_cast<size_t>(task_id), runs->size());
+      (*runs)[task_id].fetch_add(1);
+      if (penv->num_task > 1) {
+        EXPECT_EQ(penv->sync_handle, nullptr);
+      }
+      return 0;
+    };
+    TVMBackendParallelLaunch(count_runs, &runs, 0);
+    int num_task = 0;
+    for (auto& r : runs) {
+      if (r.load() != 0) {
+        EXPECT_EQ(r.load(), 1);
+        ++num_task;
+      }
+    }
+    EXPECT_GT(num_task, 0);
+  });
+  t.join();
+  unsetenv("TVM_THREAD_POOL_SCHEDULE");
+}
+TEST(ThreadingBackend, TVMBackendParallelBarrierWorkStealing) {
+  // The launches with a barrier run on the static schedule of a work-stealing pool
+  setenv("TVM_THREAD_POOL_SCHEDULE", "steal", 1);
+  std::thread t([]() {
+    std::vector<std::atomic<int>> data(tvm::runtime::threading::MaxConcurrency());
+    FTVMParallelLambda check_barrier = [](int task_id, TVMParallelGroupEnv* penv,
+                                          void* cdata) -> int {
+      auto* data = reinterpret_cast<std::vector<std::atomic<int>>*>(cdata);
+      EXPECT_NE(penv->sync_handle, nullptr);
+      (*data)[task_id].store(1);
+      TVMBackendParallelBarrier(task_id, penv);
+      for (int i = 0; i < penv->num_task; ++i) EXPECT_EQ((*data)[i].load(), 1);
+      return 0;
+    };
+    for (size_t j = 0; j < 3; ++j) {
+      for (auto& d : data) d.store(0);
+      EXPECT_EQ(TVMBackendParallelLaunch(check_barrier, &data, TVM_PARALLEL_LAUNCH_SYNC), 0);
+    }
+  });
+  t.join();
+  unsetenv("TVM_THREAD_POOL_SCHEDULE");
+}
+TEST(ThreadingBackend, TVMBackendParallelLaunchMixedAffinity) {
+  // The thread pool of the new thread uses both clusters and weights their tasks
+  std::thread t([]() {
+    const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool");
+    ASSERT_NE(config, nullptr);
+    (*config)(static_cast<int>(tvm::runtime::threading::ThreadGroup::kMixed), 0);
+    for (size_t j = 0; j < 10; ++j) {
+      std::atomic<size_t> acc(0);
+      TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+      EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    }
+  });
+  t.join();
+}
+TEST(ThreadingBackend, TVMBackendParallelBarrier) {
+  // The barrier is read at the first barrier of the process, the spin count makes the tasks
+  // sleep on the futex of their rounds
+  setenv("TVM_THREAD_POOL_BARRIER", "dissemination", 1);
+  setenv("TVM_THREAD_POOL_SPIN_COUNT", "10", 1);
+  std::thread t([]() {
+    const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool");
+    ASSERT_NE(config, nullptr);
+    (*config)(0, 12);
+    std::vector<int> data(12);
+    FTVMParallelLambda check_round = [](int task_id, TVMParallelGroupEnv* penv,
+                                        void* cdata) -> int {
+      auto* data = reinterpret_cast<std::vector<int>*>(cdata);
+      for (int round = 0; round < 100; ++round) {
+        (*data)[task_id] = round;
+        TVMBackendParallelBarrier(task_id, penv);
+        for (int i = 0; i < penv->num_task; ++i) EXPECT_EQ((*data)[i], round);
+        TVMBackendParallelBarrier(task_id, penv);
+      }
+      return 0;
+    };
+    for (size_t j = 0; j < 3; ++j) {
+      TVMBackendParallelLaunch(check_round, &data, 0);
+    }
+  });
+  t.join();
+  unsetenv("TVM_THREAD_POOL_SPIN_COUNT");
+  unsetenv("TVM_THREAD_POOL_BARRIER");
+}
+TEST(ThreadingBackend, TVMBackendParallelLaunchNested) {
+  // The inner launches run on the thread of their task
+  std::atomic<size_t> acc(0);
+  FTVMParallelLambda outer = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) -> int {
+    auto* acc = reinterpret_cast<std::atomic<size_t>*>(cdata);
+    std::atomic<size_t> inner(0);
+    int ret = TVMBackendParallelLaunch(atomic_add_task_id, &inner, 0);
+    acc->fetch_add(inner.load(), std::memory_order_relaxed);
+    return ret;
+  };
+  EXPECT_EQ(TVMBackendParallelLaunch(outer, &acc, 2), 0);
+  // Each outer task, two of them unless the pool has a single worker, adds the whole sum
+  EXPECT_GT(acc.load(std::memory_order_relaxed), 0U);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed) % (N * (N - 1) / 2), 0U);
+}
+
+TEST(ThreadingBackend, ThreadPoolPartition) {
+  const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool_partition");
+  ASSERT_NE(config, nullptr);
+  (*config)(0, 2, 0);
+  std::vector<std::unique_ptr<std::thread>> ts;
+  for (size_t i = 0; i < 3; ++i) {
+    ts.emplace_back(new std::thread([]() {
+      tvm::runtime::threading::ThreadPoolPartitionScope scope(0);
+      for (size_t j = 0; j < 3; ++j) {
+        std::atomic<size_t> acc(0);
+        TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+        EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+      }
+    }));
+  }
+  for (auto& t : ts) {
+    t->join();
+  }
+}
+TEST(ThreadingBackend, NumaPartitions) {
+  int num_nodes = tvm::runtime::threading::NumNumaNodes();
+  ASSERT_GE(num_nodes, 1);
+  int node = tvm::runtime::threading::CurrentNumaNode();
+  EXPECT_GE(node, 0);
+  EXPECT_LT(node, num_nodes);
+  const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool_numa_partitions");
+  ASSERT_NE(config, nullptr);
+  int first_id = 100;
+  int num_partitions = (*config)(first_id);
+  EXPECT_EQ(num_partitions, num_nodes);
+  for (int i = 0; i < num_partitions; ++i) {
+    tvm::runtime::threading::ThreadPoolPartitionScope scope(first_id + i);
+    std::atomic<size_t> acc(0);
+    TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  }
+}
 
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
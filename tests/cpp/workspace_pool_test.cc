@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/c_backend_api.h>
+
+#include <cstdint>
+#include <vector>
+
+static void* AllocWorkspace(uint64_t nbytes) {
+  void* ptr = TVMBackendAllocWorkspace(kDLCPU, 0, nbytes, kDLUInt, 8);
+  EXPECT_NE(ptr, nullptr);
+  return ptr;
+}
+
+static void FreeWorkspace(void* ptr) { EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, ptr), 0); }
+
+TEST(WorkspacePool, ReuseSameSize) {
+  void* a = AllocWorkspace(100 << 10);
+  void* b = AllocWorkspace(3 << 10);
+  FreeWorkspace(b);
+  FreeWorkspace(a);
+  // The repeated allocations of a run get the blocks of the previous one
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(AllocWorkspace(100 << 10), a);
+    EXPECT_EQ(AllocWorkspace(3 << 10), b);
+    FreeWorkspace(b);
+    FreeWorkspace(a);
+  }
+  // Sizes that round to the same class reuse the block as well
+  EXPECT_EQ(AllocWorkspace(97 << 10), a);
+  FreeWorkspace(a);
+}
+
+TEST(WorkspacePool, FreeOutOfOrder) {
+  std::vector<void*> ptrs;
+  for (int i = 1; i <= 64; ++i) ptrs.push_back(AllocWorkspace(i * 1000));
+  for (size_t i = 0; i < ptrs.size(); i += 2) FreeWorkspace(ptrs[i]);
+  for (size_t i = 1; i < ptrs.size(); i += 2) FreeWorkspace(ptrs[i]);
+  for (int i = 64; i >= 1; --i) {
+    // The blocks are large enough to be written
+    auto* data = static_cast<uint8_t*>(AllocWorkspace(i * 1000));
+    data[0] = data[i * 1000 - 1] = 1;
+    ptrs[i - 1] = data;
+  }
+  for (void* ptr : ptrs) FreeWorkspace(ptr);
+}
+
+TEST(WorkspacePool, MissAfterLargerBlock) {
+  // A miss gives back the cached larger block, the new blocks are still usable
+  for (int i = 0; i < 4; ++i) {
+    size_t nbytes = i % 2 ? (4 << 10) : (1 << 20);
+    auto* data = static_cast<uint8_t*>(AllocWorkspace(nbytes));
+    data[0] = data[nbytes - 1] = 1;
+    FreeWorkspace(data);
+  }
+}
+
+TEST(WorkspacePool, FreeUnknownPointer) {
+  void* ptr = AllocWorkspace(1);
+  int other = 0;
+  EXPECT_ANY_THROW(TVMBackendFreeWorkspace(kDLCPU, 0, &other));
+  FreeWorkspace(ptr);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
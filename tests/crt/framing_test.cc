@@ -190,6 +190,28 @@ TEST_F(UnframerTest, PacketTooLong) {
   EXPECT_EQ(kPacket1.payload, write_stream_.BufferContents());
 };
 
+TEST_F(UnframerTest, PacketTrain) {
+  std::string wire = kPacket1.wire + kPacket2.wire;
+  size_t bytes_consumed;
+  // Write() returns once the second packet starts, before writing its payload.
+  EXPECT_EQ(kTvmErrorNoError, unframer_.Write(reinterpret_cast<const uint8_t*>(wire.data()),
+                                              wire.size(), &bytes_consumed));
+  EXPECT_EQ(kPacket1.wire.size() + 2, bytes_consumed);
+  EXPECT_TRUE(write_stream_.packet_done());
+  EXPECT_TRUE(write_stream_.is_valid());
+  EXPECT_EQ(kPacket1.payload, write_stream_.BufferContents());
+
+  write_stream_.Reset();
+  size_t bytes_remaining = wire.size() - bytes_consumed;
+  EXPECT_EQ(kTvmErrorNoError,
+            unframer_.Write(reinterpret_cast<const uint8_t*>(wire.data()) + bytes_consumed,
+                            bytes_remaining, &bytes_consumed));
+  EXPECT_EQ(bytes_remaining, bytes_consumed);
+  EXPECT_TRUE(write_stream_.packet_done());
+  EXPECT_TRUE(write_stream_.is_valid());
+  EXPECT_EQ(kPacket2.payload, write_stream_.BufferContents());
+}
+
 class UnframerTestParameterized : public UnframerTest,
                                   public ::testing::WithParamInterface<const TestPacket*> {};
 
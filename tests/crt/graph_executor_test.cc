@@ -0,0 +1,288 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tvm/runtime/crt/graph_executor.h>
+#include <tvm/runtime/crt/platform.h>
+
+extern "C" {
+#include <tvm/runtime/crt/internal/graph_executor/graph_executor.h>
+}
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+// The allocations of the platform below still live, and the size of the largest one.
+static std::map<void*, size_t> live_allocations;
+static size_t max_allocation = 0;
+
+// The platform of platform.cc, whose TVMSystemLibEntryPoint conflicts with module.h.
+extern "C" {
+void TVMPlatformAbort(tvm_crt_error_t error_code) {
+  ADD_FAILURE() << "TVMPlatformAbort(" << error_code << ")";
+  exit(2);
+}
+
+void TVMLogf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+}
+
+const TVMModule* TVMSystemLibEntryPoint(void) { return NULL; }
+
+tvm_crt_error_t TVMPlatformMemoryAllocate(size_t num_bytes, DLDevice dev, void** out_ptr) {
+  *out_ptr = malloc(num_bytes);
+  if (*out_ptr == NULL) return kTvmErrorPlatformNoMemory;
+  live_allocations[*out_ptr] = num_bytes;
+  max_allocation = std::max(max_allocation, num_bytes);
+  return kTvmErrorNoError;
+}
+
+tvm_crt_error_t TVMPlatformMemoryFree(void* ptr, DLDevice dev) {
+  if (ptr != NULL && live_allocations.erase(ptr) == 0) {
+    ADD_FAILURE() << "TVMPlatformMemoryFree(" << ptr << ") of memory it did not allocate";
+    return kTvmErrorPlatformStackAllocBadFree;
+  }
+  free(ptr);
+  return kTvmErrorNoError;
+}
+
+tvm_crt_error_t TVMPlatformTimerStart() { return kTvmErrorFunctionCallNotImplemented; }
+
+tvm_crt_error_t TVMPlatformTimerStop(double* elapsed_time_seconds) {
+  return kTvmErrorFunctionCallNotImplemented;
+}
+}
+
+/*! \brief A graph of two float32 inputs of 4 elements, with the given storage offsets. */
+static std::string ArenaGraph(const std::string& storage_offset) {
+  return "{\"nodes\": [{\"op\": \"null\", \"name\": \"a\", \"inputs\": []}, "
+         "{\"op\": \"null\", \"name\": \"b\", \"inputs\": []}], "
+         "\"arg_nodes\": [0, 1], \"heads\": [[0, 0, 0], [1, 0, 0]], "
+         "\"attrs\": {\"dltype\": [\"list_str\", [\"float32\", \"float32\"]], "
+         "\"storage_id\": [\"list_int\", [0, 1]], "
+         "\"storage_offset\": [\"list_int\", " +
+         storage_offset +
+         "], "
+         "\"shape\": [\"list_shape\", [[1, 4], [1, 4]]]}, "
+         "\"node_row_ptr\": [0, 1, 2]}";
+}
+
+static const DLDevice kDevice = {kDLCPU, 0};
+
+TEST(GraphExecutorCRT, ArenaPlacesStorages) {
+  alignas(64) static uint8_t arena[64];
+  std::string graph = ArenaGraph("[32, 0]");
+  TVMGraphExecutor* executor = NULL;
+  ASSERT_EQ(TVMGraphExecutor_CreateWithArena(graph.c_str(), NULL, &kDevice, arena, sizeof(arena),
+                                             &executor),
+            0);
+  ASSERT_EQ(executor->data_entry_count, 2U);
+  EXPECT_EQ(executor->data_entry[0].dl_tensor.data, arena + 32);
+  EXPECT_EQ(executor->data_entry[1].dl_tensor.data, arena);
+  EXPECT_EQ(executor->owns_arena, 0);
+
+  // The outputs are read from the arena
+  float data[4] = {1, 2, 3, 4};
+  memcpy(arena + 32, data, sizeof(data));
+  float output[4] = {0};
+  int64_t shape[2] = {1, 4};
+  DLTensor out = {output, kDevice, 2, {kDLFloat, 32, 1}, shape, NULL, 0};
+  ASSERT_EQ(TVMGraphExecutor_GetOutput(executor, 0, &out), 0);
+  EXPECT_EQ(memcmp(output, data, sizeof(data)), 0);
+  ASSERT_EQ(TVMGraphExecutor_Release(&executor), 0);
+}
+
+TEST(GraphExecutorCRT, ArenaAllocatedWhenNotGiven) {
+  std::string graph = ArenaGraph("[0, 16]");
+  TVMGraphExecutor* executor = NULL;
+  ASSERT_EQ(TVMGraphExecutor_CreateWithArena(graph.c_str(), NULL, &kDevice, NULL, 0, &executor),
+            0);
+  EXPECT_EQ(executor->owns_arena, 1);
+  EXPECT_EQ(executor->arena_size, 32U);
+  EXPECT_EQ(executor->data_entry[1].dl_tensor.data, executor->arena + 16);
+  ASSERT_EQ(TVMGraphExecutor_Release(&executor), 0);
+}
+
+TEST(GraphExecutorCRT, ArenaTooSmall) {
+  alignas(64) static uint8_t arena[64];
+  std::string graph = ArenaGraph("[0, 16]");
+  TVMGraphExecutor* executor = NULL;
+  EXPECT_NE(TVMGraphExecutor_CreateWithArena(graph.c_str(), NULL, &kDevice, arena, 24, &executor),
+            0);
+}
+
+TEST(GraphExecutorCRT, StorageOffsetCountMismatch) {
+  alignas(64) static uint8_t arena[64];
+  TVMGraphExecutor* executor = NULL;
+  for (const char* storage_offset : {"[0]", "[0, 16, 32]"}) {
+    std::string graph = ArenaGraph(storage_offset);
+    EXPECT_NE(TVMGraphExecutor_CreateWithArena(graph.c_str(), NULL, &kDevice, arena,
+                                               sizeof(arena), &executor),
+              0);
+  }
+}
+
+/*! \brief A graph of a float32 input "data" of 4 elements and a float32 param "w". */
+static std::string ParamGraph(int64_t param_elems) {
+  std::string shape = std::to_string(param_elems);
+  return "{\"nodes\": [{\"op\": \"null\", \"name\": \"data\", \"inputs\": []}, "
+         "{\"op\": \"null\", \"name\": \"w\", \"inputs\": []}], "
+         "\"arg_nodes\": [0, 1], \"heads\": [[0, 0, 0], [1, 0, 0]], "
+         "\"attrs\": {\"dltype\": [\"list_str\", [\"float32\", \"float32\"]], "
+         "\"storage_id\": [\"list_int\", [0, 1]], "
+         "\"shape\": [\"list_shape\", [[1, 4], [1, " +
+         shape + "]]]}, \"node_row_ptr\": [0, 1, 2]}";
+}
+
+template <typename T>
+static void Append(std::vector<char>* blob, T value) {
+  const char* bytes = reinterpret_cast<const char*>(&value);
+  blob->insert(blob->end(), bytes, bytes + sizeof(value));
+}
+
+/*!
+ * \brief The params blob of save_param_dict(params, alignment=8) holding "w", whose data is
+ *  aligned relative to the start of the blob.
+ * \param values The values of "w".
+ * \param data_offset Receives the offset of the data of "w" in the blob.
+ */
+static std::vector<char> ParamBlob(const std::vector<float>& values, size_t* data_offset) {
+  std::vector<char> blob;
+  Append<uint64_t>(&blob, kTVMNDArrayListMagic);
+  Append<uint64_t>(&blob, 0);
+  Append<uint64_t>(&blob, 1);
+  Append<uint64_t>(&blob, 1);
+  blob.push_back('w');
+  Append<uint64_t>(&blob, 1);
+  // The header of the array before its padding
+  size_t header_size = 2 * sizeof(uint64_t) + sizeof(DLDevice) + sizeof(int32_t) +
+                       sizeof(DLDataType) + 2 * sizeof(int64_t) + sizeof(int64_t);
+  uint64_t padding = (8 - (blob.size() + header_size) % 8) % 8;
+  Append<uint64_t>(&blob, kTVMNDArrayMagic);
+  Append<uint64_t>(&blob, padding);
+  Append<DLDevice>(&blob, DLDevice{kDLCPU, 0});
+  Append<int32_t>(&blob, 2);
+  Append<DLDataType>(&blob, DLDataType{kDLFloat, 32, 1});
+  Append<int64_t>(&blob, 1);
+  Append<int64_t>(&blob, static_cast<int64_t>(values.size()));
+  Append<int64_t>(&blob, static_cast<int64_t>(values.size() * sizeof(float)));
+  blob.insert(blob.end(), padding, 0);
+  *data_offset = blob.size();
+  for (float value : values) Append<float>(&blob, value);
+  return blob;
+}
+
+/*! \brief A copy of a blob placed at the given offset from an 8-byte boundary. */
+static char* PlaceBlob(const std::vector<char>& blob, size_t misalignment,
+                       std::vector<uint64_t>* storage) {
+  storage->assign(blob.size() / sizeof(uint64_t) + 2, 0);
+  char* placed = reinterpret_cast<char*>(storage->data()) + misalignment;
+  memcpy(placed, blob.data(), blob.size());
+  return placed;
+}
+
+static const int64_t kParamElems = 256;
+
+static std::vector<float> ParamValues() {
+  std::vector<float> values(kParamElems);
+  for (int64_t i = 0; i < kParamElems; ++i) values[i] = static_cast<float>(i) * 0.5f;
+  return values;
+}
+
+TEST(GraphExecutorCRT, LoadParamsInPlace) {
+  std::string graph = ParamGraph(kParamElems);
+  size_t data_offset;
+  std::vector<char> blob = ParamBlob(ParamValues(), &data_offset);
+  std::vector<uint64_t> storage;
+  char* placed = PlaceBlob(blob, 0, &storage);
+  size_t live_before = live_allocations.size();
+
+  TVMGraphExecutor* executor = NULL;
+  ASSERT_EQ(TVMGraphExecutor_Create(graph.c_str(), NULL, &kDevice, &executor), 0);
+  ASSERT_EQ(TVMGraphExecutor_LoadParamsInPlace(executor, placed, blob.size()), 0);
+  uint32_t eid = TVMGraphExecutor_GetEntryId(executor, executor->input_nodes[1], 0);
+  uint32_t sid = executor->attrs.storage_id[eid];
+  EXPECT_EQ(executor->data_entry[eid].dl_tensor.data, placed + data_offset);
+  EXPECT_EQ(executor->storage_pool[sid].is_param_in_place, 1);
+
+  float output[kParamElems];
+  int64_t shape[2] = {1, kParamElems};
+  DLTensor out = {output, kDevice, 2, {kDLFloat, 32, 1}, shape, NULL, 0};
+  ASSERT_EQ(TVMGraphExecutor_GetOutput(executor, 1, &out), 0);
+  EXPECT_EQ(memcmp(output, ParamValues().data(), sizeof(output)), 0);
+
+  // Release frees what the executor allocated, and not the blob
+  ASSERT_EQ(TVMGraphExecutor_Release(&executor), 0);
+  EXPECT_EQ(live_allocations.size(), live_before);
+}
+
+TEST(GraphExecutorCRT, LoadParamsInPlaceMisaligned) {
+  std::string graph = ParamGraph(kParamElems);
+  size_t data_offset;
+  std::vector<char> blob = ParamBlob(ParamValues(), &data_offset);
+  std::vector<uint64_t> storage;
+  char* placed = PlaceBlob(blob, 1, &storage);
+
+  TVMGraphExecutor* executor = NULL;
+  ASSERT_EQ(TVMGraphExecutor_Create(graph.c_str(), NULL, &kDevice, &executor), 0);
+  EXPECT_NE(TVMGraphExecutor_LoadParamsInPlace(executor, placed, blob.size()), 0);
+  ASSERT_EQ(TVMGraphExecutor_Release(&executor), 0);
+
+  EXPECT_NE(TVMGraphExecutor_CreateWithParamsInPlace(graph.c_str(), NULL, &kDevice, NULL, 0,
+                                                     placed, blob.size(), &executor),
+            0);
+}
+
+TEST(GraphExecutorCRT, CreateWithParamsInPlace) {
+  std::string graph = ParamGraph(kParamElems);
+  size_t data_offset;
+  std::vector<char> blob = ParamBlob(ParamValues(), &data_offset);
+  std::vector<uint64_t> storage;
+  char* placed = PlaceBlob(blob, 0, &storage);
+  size_t live_before = live_allocations.size();
+  max_allocation = 0;
+
+  TVMGraphExecutor* executor = NULL;
+  ASSERT_EQ(TVMGraphExecutor_CreateWithParamsInPlace(graph.c_str(), NULL, &kDevice, NULL, 0,
+                                                     placed, blob.size(), &executor),
+            0);
+  // Nothing as large as the param was allocated
+  EXPECT_LT(max_allocation, kParamElems * sizeof(float));
+  uint32_t eid = TVMGraphExecutor_GetEntryId(executor, executor->input_nodes[1], 0);
+  uint32_t sid = executor->attrs.storage_id[eid];
+  EXPECT_EQ(executor->storage_pool[sid].is_param_in_place, 1);
+  EXPECT_EQ(executor->data_entry[eid].dl_tensor.data, placed + data_offset);
+  EXPECT_EQ(executor->storage_pool[sid].array.dl_tensor.data, placed + data_offset);
+
+  ASSERT_EQ(TVMGraphExecutor_Release(&executor), 0);
+  EXPECT_EQ(live_allocations.size(), live_before);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -260,6 +260,26 @@ TEST_F(SessionTest, DoubleStart) {
   EXPECT_TRUE(bob_.sess.IsEstablished());
 }
 
+TEST_F(SessionTest, ReceiveWindow) {
+  alice_.sess.SetReceiveWindow(1024);
+  EXPECT_EQ(kTvmErrorNoError, alice_.sess.Initialize(alice_.initial_nonce));
+  alice_.WriteTo(&bob_);
+  EXPECT_EQ(kTvmErrorNoError, bob_.sess.Initialize(bob_.initial_nonce));
+  bob_.WriteTo(&alice_);
+  bob_.ClearBuffers();
+  alice_.ClearBuffers();
+
+  EXPECT_EQ(kTvmErrorNoError, alice_.sess.StartSession());
+  alice_.WriteTo(&bob_);
+  EXPECT_TRUE(bob_.sess.IsEstablished());
+  EXPECT_EQ(1024, bob_.sess.RemoteReceiveWindow());
+
+  // Bob advertises no window, the reply is the one of the sessions without it.
+  bob_.WriteTo(&alice_);
+  EXPECT_TRUE(alice_.sess.IsEstablished());
+  EXPECT_EQ(0, alice_.sess.RemoteReceiveWindow());
+}
+
 int main(int argc, char** argv) {
   testing::InitGoogleTest(&argc, argv);
   testing::FLAGS_gtest_death_test_style = "threadsafe";
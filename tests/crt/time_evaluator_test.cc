@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <gtest/gtest.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/crt/crt.h>
+#include <tvm/runtime/crt/module.h>
+#include <tvm/runtime/crt/platform.h>
+
+#include <cstring>
+#include <vector>
+
+// The number of calls of the timed function.
+static int num_calls = 0;
+
+// The seconds each timing of the platform timer below lasts.
+static double timer_seconds = 0.001;
+
+extern "C" {
+static int CountCalls(TVMValue* args, int* type_codes, int num_args, TVMValue* out_ret_value,
+                      int* out_ret_tcode, void* resource_handle) {
+  num_calls++;
+  return 0;
+}
+
+static const TVMBackendPackedCFunc kSystemLibFuncs[] = {CountCalls};
+static const TVMFuncRegistry kSystemLibRegistry = {"\x01" "count_calls\0", kSystemLibFuncs};
+static const TVMModule kSystemLib = {&kSystemLibRegistry};
+
+// The platform of platform.cc, whose TVMSystemLibEntryPoint conflicts with module.h.
+void TVMPlatformAbort(tvm_crt_error_t error_code) {
+  ADD_FAILURE() << "TVMPlatformAbort(" << error_code << ")";
+  exit(2);
+}
+
+void TVMLogf(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  vfprintf(stderr, fmt, args);
+  va_end(args);
+}
+
+const TVMModule* TVMSystemLibEntryPoint(void) { return &kSystemLib; }
+
+tvm_crt_error_t TVMPlatformMemoryAllocate(size_t num_bytes, DLDevice dev, void** out_ptr) {
+  // Round up empty allocations, so that they can be told apart from failures.
+  *out_ptr = malloc(num_bytes > 0 ? num_bytes : 1);
+  return *out_ptr == NULL ? kTvmErrorPlatformNoMemory : kTvmErrorNoError;
+}
+
+tvm_crt_error_t TVMPlatformMemoryFree(void* ptr, DLDevice dev) {
+  free(ptr);
+  return kTvmErrorNoError;
+}
+
+tvm_crt_error_t TVMPlatformTimerStart() { return kTvmErrorNoError; }
+
+tvm_crt_error_t TVMPlatformTimerStop(double* elapsed_time_seconds) {
+  *elapsed_time_seconds = timer_seconds;
+  return kTvmErrorNoError;
+}
+}
+
+class TimeEvaluatorTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() { ASSERT_EQ(TVMInitializeRuntime(), kTvmErrorNoError); }
+
+  void SetUp() override {
+    num_calls = 0;
+    timer_seconds = 0.001;
+  }
+
+  /*! \brief Time `count_calls` with the given options, max_repeat is left out when negative. */
+  std::vector<double> Evaluate(int number, int repeat, int max_repeat = -1) {
+    TVMFunctionHandle system_lib_create = NULL;
+    TVMFunctionHandle time_evaluator = NULL;
+    EXPECT_EQ(TVMFuncGetGlobal("runtime.SystemLib", &system_lib_create), 0);
+    EXPECT_EQ(TVMFuncGetGlobal("runtime.RPCTimeEvaluator", &time_evaluator), 0);
+    TVMValue ret_val;
+    int ret_type_code;
+    EXPECT_EQ(TVMFuncCall(system_lib_create, NULL, NULL, 0, &ret_val, &ret_type_code), 0);
+
+    TVMValue args[10];
+    int type_codes[10];
+    args[0].v_handle = ret_val.v_handle;
+    type_codes[0] = kTVMModuleHandle;
+    args[1].v_str = "count_calls";
+    type_codes[1] = kTVMStr;
+    int64_t int_args[] = {kDLCPU, 0, number, repeat, 0};
+    for (int i = 0; i < 5; i++) {
+      args[2 + i].v_int64 = int_args[i];
+      type_codes[2 + i] = kTVMArgInt;
+    }
+    args[7].v_str = "";
+    type_codes[7] = kTVMStr;
+    args[8].v_int64 = max_repeat;
+    type_codes[8] = kTVMArgInt;
+    args[9].v_float64 = 0.05;
+    type_codes[9] = kTVMArgFloat;
+    int num_args = max_repeat < 0 ? 8 : 10;
+    EXPECT_EQ(TVMFuncCall(time_evaluator, args, type_codes, num_args, &ret_val, &ret_type_code),
+              0);
+    EXPECT_EQ(ret_type_code, kTVMPackedFuncHandle);
+
+    TVMFunctionHandle evaluator = ret_val.v_handle;
+    EXPECT_EQ(TVMFuncCall(evaluator, NULL, NULL, 0, &ret_val, &ret_type_code), 0);
+    EXPECT_EQ(ret_type_code, kTVMBytes);
+    TVMByteArray* result = (TVMByteArray*)ret_val.v_handle;
+    std::vector<double> costs(result->size / sizeof(double));
+    memcpy(costs.data(), result->data, result->size);
+    EXPECT_EQ(TVMByteArrayFree(result), 0);
+    return costs;
+  }
+};
+
+TEST_F(TimeEvaluatorTest, Repeats) {
+  std::vector<double> costs = Evaluate(4, 3);
+  ASSERT_EQ(costs.size(), 3U);
+  for (double cost : costs) {
+    EXPECT_DOUBLE_EQ(cost, timer_seconds / 4);
+  }
+  // The warm-up call, then `number` calls each repeat.
+  EXPECT_EQ(num_calls, 1 + 3 * 4);
+}
+
+TEST_F(TimeEvaluatorTest, NoRepeats) {
+  for (int max_repeat : {-1, 0, 5}) {
+    EXPECT_TRUE(Evaluate(4, 0, max_repeat).empty());
+  }
+  EXPECT_TRUE(Evaluate(4, -1).empty());
+  EXPECT_EQ(num_calls, 0);
+}
+
+TEST_F(TimeEvaluatorTest, SteadyStateStopsEarly) {
+  // The costs do not drift, so the repeats stop at the first steady state.
+  std::vector<double> costs = Evaluate(2, 3, 10);
+  EXPECT_EQ(costs.size(), 3U);
+  EXPECT_EQ(num_calls, 1 + 3 * 2);
+}
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
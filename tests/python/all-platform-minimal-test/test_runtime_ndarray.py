@@ -39,6 +39,25 @@ def test_nd_create():
         dev.sync()
 
 
+@tvm.testing.uses_gpu
+def test_nd_slice():
+    for target, dev in tvm.testing.enabled_targets():
+        x = np.random.uniform(size=(4, 3, 5)).astype("float32")
+        y = tvm.nd.array(x, device=dev)
+        # A range of rows is compact, a range of the middle axis is strided
+        rows = y.slice(0, 1, 3)
+        channels = y.slice(1, 1, 2)
+        assert rows.shape == (2, 3, 5)
+        assert channels.shape == (4, 1, 5)
+        np.testing.assert_equal(rows.numpy(), x[1:3])
+        np.testing.assert_equal(channels.numpy(), x[:, 1:2])
+        np.testing.assert_equal(channels.slice(0, 3, 4).numpy(), x[3:4, 1:2])
+        # The views write to the memory of the array
+        channels.copyfrom(np.zeros((4, 1, 5), dtype="float32"))
+        x[:, 1:2] = 0
+        np.testing.assert_equal(y.numpy(), x)
+
+
 def test_fp16_conversion():
     n = 100
 
@@ -67,5 +86,6 @@ def test_dtype():
 
 if __name__ == "__main__":
     test_nd_create()
+    test_nd_slice()
     test_fp16_conversion()
     test_dtype()
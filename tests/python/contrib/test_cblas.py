@@ -227,7 +227,72 @@ def test_batch_matmul():
     verify_batch_matmul(1, 1, 16, 3, mkl, iterative=True)
 
 
+def verify_quantized_batch_matmul(batch_a, batch_b, m, l, n, transa=False, transb=False):
+    if not tvm.get_global_func("tvm.contrib.mkl.batch_matmul_u8s8s32", True):
+        pytest.skip("Quantized batch matmul is supported only for MKL. TVM GPU CI uses openblas")
+    batch = max(batch_a, batch_b)
+    ashape = (batch_a, l, n) if transa else (batch_a, n, l)
+    bshape = (batch_b, m, l) if transb else (batch_b, l, m)
+    A = te.placeholder(ashape, name="A", dtype="uint8")
+    B = te.placeholder(bshape, name="B", dtype="int8")
+    C = mkl.batch_matmul_u8s8s32(A, B, transa, transb, dtype="int32")
+    s = te.create_schedule(C.op)
+
+    def get_numpy(a, b, transa, transb):
+        if transa:
+            a = a.transpose(0, 2, 1)
+        if transb:
+            b = b.transpose(0, 2, 1)
+        return np.matmul(a, b)
+
+    if not tvm.testing.device_enabled("llvm"):
+        print("skip because llvm is not enabled...")
+        return
+    dev = tvm.cpu(0)
+    f = tvm.build(s, [A, B, C], "llvm")
+    a = tvm.nd.array(np.random.randint(low=0, high=50, size=ashape).astype(A.dtype), dev)
+    b = tvm.nd.array(np.random.randint(low=-50, high=50, size=bshape).astype(B.dtype), dev)
+    c = tvm.nd.array(np.zeros((batch, n, m), dtype=C.dtype), dev)
+    f(a, b, c)
+    tvm.testing.assert_allclose(
+        c.numpy(),
+        get_numpy(a.numpy().astype("int32"), b.numpy().astype("int32"), transa, transb),
+        rtol=1e-5,
+    )
+
+
+def test_quantized_batch_matmul():
+    verify_quantized_batch_matmul(16, 16, 235, 128, 64)
+    verify_quantized_batch_matmul(16, 16, 235, 128, 64, True, False)
+    verify_quantized_batch_matmul(16, 16, 235, 128, 64, False, True)
+    verify_quantized_batch_matmul(16, 1, 235, 128, 64, False, True)
+    verify_quantized_batch_matmul(1, 16, 16, 3, 4, True, True)
+
+
+def test_batch_matmul_broadcast():
+    # The batch of 1 of the weights is broadcast, through the stride of 0.
+    for lib in [cblas, mkl]:
+        if not tvm.get_global_func(lib.__name__ + ".batch_matmul", True):
+            print("skip because extern function is not available")
+            continue
+        A = te.placeholder((16, 64, 32), name="A")
+        B = te.placeholder((1, 48, 32), name="B")
+        C = lib.batch_matmul(A, B, False, True)
+        s = te.create_schedule(C.op)
+        dev = tvm.cpu(0)
+        f = tvm.build(s, [A, B, C], "llvm")
+        a = tvm.nd.array(np.random.uniform(size=(16, 64, 32)).astype(A.dtype), dev)
+        b = tvm.nd.array(np.random.uniform(size=(1, 48, 32)).astype(B.dtype), dev)
+        c = tvm.nd.array(np.zeros((16, 64, 48), dtype=C.dtype), dev)
+        f(a, b, c)
+        tvm.testing.assert_allclose(
+            c.numpy(), tvm.topi.testing.batch_matmul(a.numpy(), b.numpy()), rtol=1e-5
+        )
+
+
 if __name__ == "__main__":
     test_matmul_add()
     test_quantized_matmul_add()
     test_batch_matmul()
+    test_quantized_batch_matmul()
+    test_batch_matmul_broadcast()
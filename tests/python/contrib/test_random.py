@@ -96,6 +96,29 @@ def test_normal():
     verify()
 
 
+def test_seed():
+    if not tvm.get_global_func("tvm.contrib.random.seed", True):
+        print("skip because extern function is not available")
+        return
+    seed = tvm.get_global_func("tvm.contrib.random.seed")
+    uniform = tvm.get_global_func("tvm.contrib.random.uniform")
+    # Large enough to fill in parallel
+    value = tvm.nd.empty((512, 512), "float32", tvm.cpu())
+
+    seed(42)
+    uniform(0.0, 1.0, value)
+    first = value.numpy()
+    uniform(0.0, 1.0, value)
+    second = value.numpy()
+    assert not np.array_equal(first, second)
+
+    seed(42)
+    uniform(0.0, 1.0, value)
+    tvm.testing.assert_allclose(value.numpy(), first)
+    uniform(0.0, 1.0, value)
+    tvm.testing.assert_allclose(value.numpy(), second)
+
+
 @tvm.testing.uses_gpu
 def test_random_fill():
     def test_local(dev, dtype):
@@ -156,4 +179,5 @@ if __name__ == "__main__":
     test_randint()
     test_uniform()
     test_normal()
+    test_seed()
     test_random_fill()
@@ -91,6 +91,44 @@ def test_sort_np():
     tvm.testing.assert_allclose(c.numpy(), np_out, rtol=1e-5)
 
 
+def test_argsort_topk_large():
+    # large enough for the radix sort of the rows, sorted in parallel
+    dshape = (64, 1024)
+    data = te.placeholder(dshape, name="data", dtype="int32")
+    argsort_out = te.extern(
+        dshape,
+        [data],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.sort.argsort", ins[0], outs[0], 1, False
+        ),
+        dtype="int32",
+        name="argsort",
+    )
+    k = 10
+    topk_out = te.extern(
+        (dshape[0], k),
+        [data],
+        lambda ins, outs: tvm.tir.call_packed(
+            "tvm.contrib.sort.topk", ins[0], outs[0], k, 1, "indices", True
+        ),
+        dtype="int32",
+        name="topk",
+    )
+
+    dev = tvm.cpu(0)
+    s = te.create_schedule([argsort_out.op, topk_out.op])
+    f = tvm.build(s, [data, argsort_out, topk_out], "llvm")
+
+    # many equal values, ordered by index as by a stable sort
+    np_data = np.random.randint(-50, 50, size=dshape).astype("int32")
+    a = tvm.nd.array(np_data, dev)
+    b = tvm.nd.array(np.zeros(dshape, dtype="int32"), dev)
+    c = tvm.nd.array(np.zeros((dshape[0], k), dtype="int32"), dev)
+    f(a, b, c)
+    tvm.testing.assert_allclose(b.numpy(), np.argsort(-np_data, axis=1, kind="stable"))
+    tvm.testing.assert_allclose(c.numpy(), np.argsort(np_data, axis=1, kind="stable")[:, :k])
+
+
 def test_sort_by_key_gpu():
     size = 6
     keys = te.placeholder((size,), name="keys", dtype="int32")
@@ -126,4 +164,5 @@ def test_sort_by_key_gpu():
 if __name__ == "__main__":
     test_sort()
     test_sort_np()
+    test_argsort_topk_large()
     test_sort_by_key_gpu()
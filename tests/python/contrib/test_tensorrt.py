@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import os
 import numpy as np
 import time
 import pytest
@@ -1274,6 +1275,40 @@ def test_tensorrt_dynamic_batch_conv():
             assert_result_dict_holds(result_arr[i])
 
 
+def test_tensorrt_engine_cache():
+    if skip_codegen_test():
+        return
+    if skip_runtime_test():
+        return
+    batches_to_test = [2, 1, 3, 2, 4]
+    x_shape = (relay.Any(), 1, 8, 8)
+    x_data = np.random.uniform(-1, 1, [max(batches_to_test)] + list(x_shape)[1:]).astype("float32")
+    x = relay.var("x", shape=x_shape, dtype="float32")
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(x)))
+    mod, _ = tensorrt.partition_for_tensorrt(mod)
+    tmpdir = utils.tempdir()
+    env = {"TVM_TENSORRT_CACHE_DIR": tmpdir.temp_dir, "TVM_TENSORRT_MAX_BATCH_SIZE": "4"}
+    old_env = {key: os.environ.get(key) for key in env}
+    os.environ.update(env)
+    try:
+        # The second executor loads the engine the first one cached.
+        for _ in range(2):
+            with relay.build_config(opt_level=3):
+                relay_exec = relay.create_executor("vm", mod=mod, device=tvm.cpu(0), target="llvm")
+            for batch_size in batches_to_test:
+                res = relay_exec.evaluate()(x_data[:batch_size, ...])
+                tvm.testing.assert_allclose(res.numpy(), np.maximum(x_data[:batch_size, ...], 0))
+            # A single engine runs all the batch sizes up to the max.
+            plans = [name for name in tmpdir.listdir() if name.endswith(".plan")]
+            assert len(plans) == 1 and plans[0].endswith("_b4.plan")
+    finally:
+        for key, value in old_env.items():
+            if value is None:
+                os.environ.pop(key, None)
+            else:
+                os.environ[key] = value
+
+
 def test_maskrcnn_resnet50() -> None:
     """
     This function tests the working of pytorch maskrcnn with resnet50 as backbone with
@@ -96,6 +96,36 @@ def test_multi_kernel():
     check_device("aocl_sw_emu")
 
 
+def test_loop_pragmas():
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute(A.shape, lambda i: A[i] * 2.0, name="B")
+    s = te.create_schedule(B.op)
+    px, x = s[B].split(B.op.axis[0], nparts=1)
+    s[B].bind(px, te.thread_axis("pipeline"))
+    xo, xi = s[B].split(x, factor=4)
+    s[B].pragma(xo, "pipeline", 2)
+    s[B].pragma(xo, "ivdep")
+    s[B].pragma(xi, "unroll", 2)
+
+    def check_device(device, pragmas, host="llvm"):
+        if not tvm.testing.device_enabled(device):
+            return
+        fmul = tvm.build(s, [A, B], device, host, name="mymul")
+        code = fmul.imported_modules[0].get_source()
+        for pragma in pragmas:
+            assert pragma in code
+        dev = tvm.device(device, 0)
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+        b = tvm.nd.array(np.zeros(n, dtype=B.dtype), dev)
+        fmul(a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() * 2, rtol=1e-5)
+
+    check_device("sdaccel", ["#pragma HLS PIPELINE II=2", "#pragma HLS UNROLL factor=2"])
+    check_device("aocl_sw_emu", ["#pragma ii 2", "#pragma ivdep", "#pragma unroll 2"])
+
+
 if __name__ == "__main__":
     test_exp()
     test_multi_kernel()
+    test_loop_pragmas()
@@ -524,6 +524,65 @@ def test_warp_reduction2():
     check_target("rocm")
 
 
+@tvm.testing.requires_gpu
+def test_warp_reduction_multi_warp():
+    def fcombine(x, y):
+        lhs = tvm.tir.Select((x[1] >= y[1]), x[0], y[0])
+        rhs = tvm.tir.Select((x[1] >= y[1]), x[1], y[1])
+        return lhs, rhs
+
+    def fidentity(t0, t1):
+        return tvm.tir.const(-1, t0), tvm.te.min_value(t1)
+
+    argmax = te.comm_reducer(fcombine, fidentity, name="argmax")
+
+    # compute
+    m = 16
+    n = 1000
+    idx = te.placeholder((m, n), name="idx", dtype="int32")
+    val = te.placeholder((m, n), name="val", dtype="float32")
+    k = te.reduce_axis((0, n), "k")
+    T0, T1 = te.compute((m,), lambda i: argmax((idx[i, k], val[i, k]), axis=k), name="T")
+    k = te.reduce_axis((0, n), "k")
+    B = te.compute((m,), lambda i: te.sum(val[i, k], axis=k), name="B")
+
+    def check_target(device, nthdx, nthdy):
+        dev = tvm.device(device, 0)
+        if not tvm.testing.device_enabled(device):
+            print("skip because %s is not enabled.." % device)
+            return
+
+        # schedule
+        s = te.create_schedule([T0.op, B.op])
+        for op in [T0.op, B.op]:
+            ko, _ = s[op].split(s[op].op.reduce_axis[0], nparts=nthdx)
+            xo, xi = s[op].split(s[op].op.axis[0], factor=nthdy)
+            s[op].bind(ko, te.thread_axis((0, nthdx), "threadIdx.x"))
+            s[op].bind(xi, te.thread_axis((0, nthdy), "threadIdx.y"))
+            s[op].bind(xo, te.thread_axis("blockIdx.x"))
+
+        func = tvm.build(s, [idx, val, T0, T1, B], device, name="reduction")
+        if device == "cuda":
+            assert "__shfl_down_sync" in func.imported_modules[0].get_source()
+
+        # validation
+        np_idx = np.repeat(np.arange(n, dtype="int32").reshape(1, n), m, axis=0)
+        np_val = np.random.uniform(size=(m, n)).astype("float32")
+        nd_idx = tvm.nd.array(np_idx, dev)
+        nd_val = tvm.nd.array(np_val, dev)
+        nd_res0 = tvm.nd.array(np.zeros(m, dtype="int32"), dev)
+        nd_res1 = tvm.nd.array(np.zeros(m, dtype="float32"), dev)
+        nd_sum = tvm.nd.array(np.zeros(m, dtype="float32"), dev)
+        func(nd_idx, nd_val, nd_res0, nd_res1, nd_sum)
+        tvm.testing.assert_allclose(nd_res0.numpy(), np.argmax(np_val, axis=1))
+        tvm.testing.assert_allclose(nd_res1.numpy(), np.max(np_val, axis=1))
+        tvm.testing.assert_allclose(nd_sum.numpy(), np.sum(np_val, axis=1), rtol=1e-3, atol=1e-3)
+
+    check_target("cuda", 256, 2)
+    check_target("cuda", 96, 4)
+    check_target("rocm", 256, 2)
+
+
 if __name__ == "__main__":
     test_rfactor_elemwise_threads()
     test_rfactor_threads()
@@ -534,6 +593,7 @@ if __name__ == "__main__":
     test_rfactor_argmax()
     test_warp_reduction1()
     test_warp_reduction2()
+    test_warp_reduction_multi_warp()
     test_init()
     test_init_imm()
     test_rfactor_init()
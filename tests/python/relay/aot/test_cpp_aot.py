@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relay
+from tvm.contrib import aot_executor, graph_executor, utils
+from tvm.relay import testing
+
+
+def _run_graph(mod, params, inputs):
+    lib = relay.build(mod, target="llvm", params=params)
+    module = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+    module.set_input(**inputs)
+    module.run()
+    return [module.get_output(i).numpy() for i in range(module.get_num_outputs())]
+
+
+def _run_aot(module, inputs):
+    module.set_input(**inputs)
+    module.run()
+    return [module.get_output(i).numpy() for i in range(module.get_num_outputs())]
+
+
+@pytest.mark.parametrize("target", ["llvm --executor=aot", "c --executor=aot"])
+def test_conv_with_params(target):
+    data = relay.var("data", shape=(1, 3, 16, 16))
+    weight = relay.var("weight", shape=(8, 3, 3, 3))
+    conv = relay.nn.conv2d(data, weight, padding=(1, 1), channels=8, kernel_size=(3, 3))
+    out = relay.nn.relu(relay.add(conv, relay.const(1.0)))
+    mod = tvm.IRModule.from_expr(relay.Function([data, weight], out))
+    params = {"weight": np.random.uniform(-1, 1, (8, 3, 3, 3)).astype("float32")}
+    inputs = {"data": np.random.uniform(-1, 1, (1, 3, 16, 16)).astype("float32")}
+
+    lib = relay.build(mod, target=target, params=params)
+    if target.startswith("c "):
+        # The C host module is compiled by export_library.
+        path = utils.tempdir().relpath("lib.so")
+        lib.export_library(path)
+        lib = tvm.runtime.load_module(path)
+    module = aot_executor.AotModule(lib["default"](tvm.cpu()))
+    for res, ref in zip(_run_aot(module, inputs), _run_graph(mod, params, inputs)):
+        tvm.testing.assert_allclose(res, ref, rtol=1e-5, atol=1e-5)
+
+
+def test_tuple_outputs():
+    x = relay.var("x", shape=(10, 5))
+    y = relay.var("y", shape=(10, 5))
+    z = relay.add(x, y)
+    out = relay.Tuple([relay.exp(z), relay.multiply(z, x)])
+    mod = tvm.IRModule.from_expr(relay.Function([x, y], out))
+    inputs = {
+        "x": np.random.uniform(size=(10, 5)).astype("float32"),
+        "y": np.random.uniform(size=(10, 5)).astype("float32"),
+    }
+    lib = relay.build(mod, target="llvm --executor=aot")
+    module = aot_executor.AotModule(lib["default"](tvm.cpu()))
+    assert module.get_num_inputs() == 2
+    assert module.get_num_outputs() == 2
+    for res, ref in zip(_run_aot(module, inputs), _run_graph(mod, None, inputs)):
+        tvm.testing.assert_allclose(res, ref, rtol=1e-5)
+
+
+def test_export_and_reuse():
+    mod, params = testing.mlp.get_workload(batch_size=1)
+    inputs = {"data": np.random.uniform(size=(1, 1, 28, 28)).astype("float32")}
+    ref = _run_graph(mod, params, inputs)
+
+    with tvm.transform.PassContext(opt_level=3, config={"relay.backend.use_arena_planner": True}):
+        lib = relay.build(mod, target="llvm --executor=aot", params=params)
+    path = utils.tempdir().relpath("lib.so")
+    lib.export_library(path)
+    loaded = tvm.runtime.load_module(path)
+
+    # Every executor shares the params of the factory and owns its arena.
+    first = aot_executor.AotModule(loaded["default"](tvm.cpu()))
+    second = aot_executor.AotModule(loaded["default"](tvm.cpu()))
+    for module in [first, second, first]:
+        tvm.testing.assert_allclose(_run_aot(module, inputs)[0], ref[0], rtol=1e-5)
+
+    data = tvm.nd.array(inputs["data"])
+    first.set_input_zero_copy("data", data)
+    first.run()
+    tvm.testing.assert_allclose(first.get_output(0).numpy(), ref[0], rtol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -21,6 +21,7 @@ import tvm.testing
 from tvm import relay
 from tvm import autotvm
 from tvm import topi
+from tvm.contrib import graph_executor, utils
 from tvm.relay.testing import run_infer_type
 from tvm.relay.testing.temp_op_attr import TempOpAttr
 import tvm.testing
@@ -259,6 +260,86 @@ def test_compile_nhwc_pack():
     relay.build(mod, target="llvm")
 
 
+def test_compile_parallel_lowering():
+    x = relay.var("x", shape=(4, 16))
+    y = x
+    for i in range(8):
+        y = relay.nn.relu(relay.add(y, relay.const(float(i))))
+        y = relay.exp(relay.nn.softmax(y))
+    func = relay.Function([x], y)
+    x_np = np.random.uniform(size=(4, 16)).astype("float32")
+
+    def run(parallel):
+        relay.backend.compile_engine.get().clear()
+        config = {"relay.backend.parallel_lowering": parallel}
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            lib = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        module = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+        module.set_input("x", x_np)
+        module.run()
+        return lib.get_graph_json(), module.get_output(0).numpy()
+
+    graph, expected = run(False)
+    parallel_graph, result = run(True)
+    # The kernels keep their names.
+    assert graph == parallel_graph
+    tvm.testing.assert_allclose(result, expected)
+
+    engine = relay.backend.compile_engine.get()
+    engine.clear()
+    funcs = [relay.Function([x], relay.add(x, relay.const(float(i)))) for i in range(4)]
+    funcs = [relay.transform.InferType()(tvm.IRModule.from_expr(f))["main"] for f in funcs]
+    with tvm.transform.PassContext(config={"relay.backend.parallel_lowering": True}):
+        lowered = engine.lower_all(funcs + funcs[:1], "llvm")
+    assert len(lowered) == 5
+    assert lowered[0].same_as(lowered[4])
+    assert lowered[0].same_as(engine.lower(funcs[0], "llvm"))
+
+
+@tvm.testing.requires_llvm
+def test_compile_kernel_cache():
+    def get_func(num_layers):
+        x = relay.var("x", shape=(1, 8, 8, 8))
+        w = relay.const(np.random.uniform(size=(8, 8, 3, 3)).astype("float32"))
+        y = x
+        for _ in range(num_layers):
+            y = relay.nn.relu(relay.nn.conv2d(y, w, padding=(1, 1)))
+        return relay.Function([x], y)
+
+    x_np = np.random.uniform(size=(1, 8, 8, 8)).astype("float32")
+    cache_dir = utils.tempdir()
+
+    def build(func):
+        relay.backend.compile_engine.get().clear()
+        config = {"relay.backend.kernel_cache_dir": cache_dir.temp_dir}
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            lib = relay.build(tvm.IRModule.from_expr(func), "llvm")
+        module = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+        module.set_input("x", x_np)
+        module.run()
+        return lib, module.get_output(0).numpy()
+
+    def num_kernels():
+        return len([f for f in cache_dir.listdir() if f.endswith(".ll")])
+
+    func = get_func(2)
+    _, expected = build(func)
+    assert num_kernels() > 0
+    cached = num_kernels()
+    # The related model reuses the kernels of the first one.
+    _, result = build(func)
+    assert num_kernels() == cached
+    tvm.testing.assert_allclose(result, expected, rtol=1e-5)
+    lib, _ = build(get_func(3))
+    assert num_kernels() == cached
+    # The cached kernels are linked into the exported library.
+    path = cache_dir.relpath("deploy.so")
+    lib.export_library(path)
+    module = graph_executor.GraphModule(tvm.runtime.load_module(path)["default"](tvm.cpu()))
+    module.set_input("x", x_np)
+    module.run()
+
+
 if __name__ == "__main__":
     test_get_valid_implementations()
     test_select_implementation()
@@ -268,3 +349,5 @@ if __name__ == "__main__":
     test_compile_tuple_dup()
     test_compile_full()
     test_compile_nhwc_pack()
+    test_compile_parallel_lowering()
+    test_compile_kernel_cache()
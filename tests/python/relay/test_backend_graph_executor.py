@@ -18,6 +18,7 @@ import numpy as np
 
 import tvm
 import json
+import struct
 from tvm import relay
 from tvm.contrib import graph_executor
 from tvm.relay.op import add
@@ -158,6 +159,70 @@ def test_plan_memory():
     )
 
 
+def test_plan_memory_arena():
+    # the temporaries of the chain alternate between two slots of one arena.
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(1,))
+    z = relay.add(x, relay.exp(y))
+    for _ in range(5):
+        z = relay.sqrt(z)
+    func = relay.Function([x, y], z)
+    mod = tvm.IRModule.from_expr(func)
+    mod = relay.transform.InferType()(mod)
+    mod = relay.transform.FuseOps(0)(mod)
+    mod = relay.transform.InferType()(mod)
+    with tvm.transform.PassContext(config={"relay.backend.use_arena_planner": True}):
+        smap = relay.backend._backend.GraphPlanMemory(mod["main"])
+    storage_ids = set()
+    offsets = set()
+    for k, v in smap.items():
+        assert len(v) == 4
+        for sid, offset in zip(v[0], v[3]):
+            storage_ids.add(sid.value)
+            if offset.value >= 0:
+                offsets.add(offset.value)
+    # every tensor gets its own storage id, the offsets are 64 bytes aligned.
+    assert len(storage_ids) == 9
+    assert offsets == {0, 64}
+
+    with tvm.transform.PassContext(opt_level=0, config={"relay.backend.use_arena_planner": True}):
+        graph = relay.build(tvm.IRModule.from_expr(func), "llvm")
+    graph_json = json.loads(graph.get_graph_json())
+    assert "storage_offset" in graph_json["attrs"]
+    gmod = graph_executor.GraphModule(graph["default"](tvm.cpu(0)))
+    x_data = np.random.rand(10).astype("float32")
+    y_data = np.random.rand(1).astype("float32")
+    gmod.set_input(x=x_data, y=y_data)
+    gmod.run()
+    ref_res = x_data + np.exp(y_data)
+    for _ in range(5):
+        ref_res = np.sqrt(ref_res)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref_res, rtol=1e-5)
+
+
+def test_plan_memory_in_place():
+    # the elementwise chain overwrites the output of its first op.
+    x = relay.var("x", shape=(10,))
+    z = relay.nn.relu(x)
+    for _ in range(4):
+        z = relay.sqrt(z)
+    func = relay.Function([x], z)
+    with tvm.transform.PassContext(opt_level=0, config={"relay.backend.use_in_place_memory": True}):
+        graph = relay.build(tvm.IRModule.from_expr(func), "llvm")
+    graph_json = json.loads(graph.get_graph_json())
+    storage_ids = graph_json["attrs"]["storage_id"][1]
+    assert tuple(storage_ids) == (0, 1, 1, 1, 1, 1)
+
+    gmod = graph_executor.GraphModule(graph["default"](tvm.cpu(0)))
+    x_data = np.random.rand(10).astype("float32")
+    gmod.set_input(x=x_data)
+    gmod.run()
+    ref_res = x_data
+    for _ in range(4):
+        ref_res = np.sqrt(ref_res)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref_res, rtol=1e-5)
+
+
 def test_reshape_nop():
     # test that reshape can be turned into nop
     x = relay.var("x", shape=(10, 4))
@@ -287,9 +352,75 @@ def test_graph_executor_nested_tuples():
     tvm.testing.assert_allclose(out[1][1][1].numpy(), data[3])
 
 
+def test_graph_binary():
+    # the binary graph of the CRT graph executor holds the same graph as the json.
+    x = relay.var("x", shape=(10,))
+    y = relay.var("y", shape=(1,))
+    z = relay.sqrt(relay.add(x, relay.exp(y)))
+    func = relay.Function([x, y], z)
+    with tvm.transform.PassContext(opt_level=0, config={"relay.backend.use_arena_planner": True}):
+        graph = relay.build(tvm.IRModule.from_expr(func), "llvm")
+    graph_json = json.loads(graph.get_graph_json())
+    binary = graph.graph_binary
+
+    header = struct.unpack_from("<10I", binary, 0)
+    magic, version, flags, num_nodes, num_inputs, num_args, num_heads = header[:7]
+    num_entries, shape_stride, strings_size = header[7:]
+    assert (magic, version) == (0x474D5654, 1)
+    assert flags == 2  # the storage offsets of the arena planner, no device index
+    assert num_nodes == len(graph_json["nodes"])
+    assert num_args == len(graph_json["arg_nodes"])
+    assert num_entries == graph_json["node_row_ptr"][-1]
+    pos = 40
+    nodes = [struct.unpack_from("<7I", binary, pos + 28 * i) for i in range(num_nodes)]
+    pos += 28 * num_nodes
+    inputs = [struct.unpack_from("<3I", binary, pos + 12 * i) for i in range(num_inputs)]
+    pos += 12 * num_inputs
+    assert list(struct.unpack_from("<%dI" % num_args, binary, pos)) == graph_json["arg_nodes"]
+    pos += 4 * num_args
+    heads = [list(struct.unpack_from("<3I", binary, pos + 12 * i)) for i in range(num_heads)]
+    assert heads == graph_json["heads"]
+    pos += 12 * num_heads
+    node_row_ptr = struct.unpack_from("<%dI" % (num_nodes + 1), binary, pos)
+    assert list(node_row_ptr) == graph_json["node_row_ptr"]
+    pos += 4 * (num_nodes + 1)
+    storage_id = struct.unpack_from("<%dI" % num_entries, binary, pos)
+    assert list(storage_id) == graph_json["attrs"]["storage_id"][1]
+    pos += 4 * num_entries
+    ndim = struct.unpack_from("<%dI" % num_entries, binary, pos)
+    pos += 4 * num_entries
+    dtypes = [struct.unpack_from("<BBH", binary, pos + 4 * i) for i in range(num_entries)]
+    assert all(dtype == (2, 32, 1) for dtype in dtypes)  # float32
+    pos = (pos + 4 * num_entries + 7) // 8 * 8
+    shapes = struct.unpack_from("<%dq" % (num_entries * shape_stride), binary, pos)
+    for i, shape in enumerate(graph_json["attrs"]["shape"][1]):
+        assert ndim[i] == len(shape)
+        assert list(shapes[i * shape_stride : i * shape_stride + ndim[i]]) == shape
+    pos += 8 * num_entries * shape_stride
+    offsets = struct.unpack_from("<%dq" % num_entries, binary, pos)
+    assert list(offsets) == graph_json["attrs"]["storage_offset"][1]
+    pos += 8 * num_entries
+    assert len(binary) == pos + strings_size
+
+    def string(offset):
+        return binary[pos + offset : binary.index(b"\0", pos + offset)].decode()
+
+    for node, json_node in zip(nodes, graph_json["nodes"]):
+        op, name, func_name, inputs_begin, node_inputs = node[:5]
+        assert op == (0 if json_node["op"] == "null" else 1)
+        assert string(name) == json_node["name"]
+        if op:
+            assert string(func_name) == json_node["attrs"]["func_name"]
+        node_entries = [list(e) for e in inputs[inputs_begin : inputs_begin + node_inputs]]
+        assert node_entries == json_node["inputs"]
+
+
 if __name__ == "__main__":
     test_reshape_nop()
     test_plan_memory()
+    test_plan_memory_arena()
+    test_graph_binary()
+    test_plan_memory_in_place()
     test_with_params()
     test_add_op_scalar()
     test_add_op_tensor()
@@ -233,6 +233,19 @@ def test_tuple_passing():
     tvm.testing.assert_allclose(out.numpy(), np.array(11))
 
 
+def test_dynamic_shape_reuse():
+    # The two calls of f run the same primitive function, and shape function, on two shapes
+    x = relay.var("x", shape=(relay.Any(),), dtype="float32")
+    y = relay.var("y", shape=(relay.Any(),), dtype="float32")
+    f = relay.Var("f")
+    sb = ScopeBuilder()
+    sb.let(f, relay.Function([x], relay.concatenate([x, x], 0)))
+    sb.ret(f(f(y)))
+    func = relay.Function([y], sb.get())
+    data = np.arange(3).astype("float32")
+    check_eval(func, [data], np.tile(data, 4))
+
+
 if __name__ == "__main__":
     test_id()
     test_add_const()
@@ -247,3 +260,4 @@ if __name__ == "__main__":
     test_tuple_getitem()
     test_function_taking_adt_ref_tuple()
     test_tuple_passing()
+    test_dynamic_shape_reuse()
@@ -966,6 +966,25 @@ def test_func_attrs():
     assert_parses_as(func.astext(), func)
 
 
+
+def test_large_module():
+    # large enough for the functions to be parsed in parallel
+    x = relay.var("x", shape=(4,))
+    body = x
+    for i in range(200):
+        body = relay.add(body, relay.const(float(i)))
+    mod = tvm.IRModule()
+    for i in range(64):
+        mod["f%d" % i] = relay.Function([x], body)
+    mod["main"] = relay.Function(
+        [x], relay.Call(mod.get_global_var("f0"), [relay.Call(mod.get_global_var("f63"), [x])])
+    )
+    mod = relay.transform.InferType()(mod)
+    parsed = tvm.parser.parse(mod.astext())
+    assert len(parsed.functions) == 65
+    assert_graph_equal(parsed, mod)
+
+
 if __name__ == "__main__":
     import sys
 
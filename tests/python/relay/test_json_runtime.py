@@ -609,6 +609,65 @@ def test_constant():
     check_result(mod, ref_mod, {"data": i_data}, (1, 32, 14, 14), tol=1e-5)
 
 
+def test_fused_post_ops():
+    """Test the convs and dense fused with their bias, sum and relu post-ops."""
+    if not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True):
+        print("skip because DNNL codegen is not available")
+        return
+
+    dtype = "float32"
+    ishape = (1, 32, 14, 14)
+    wshape = (32, 32, 3, 3)
+    bshape = (32, 1, 1)
+
+    # A residual block, and a dense layer
+    data = relay.var("data", shape=ishape, dtype=dtype)
+    weight1 = relay.var("weight1", shape=wshape, dtype=dtype)
+    bias1 = relay.var("bias1", shape=bshape, dtype=dtype)
+    weight2 = relay.var("weight2", shape=wshape, dtype=dtype)
+    bias2 = relay.var("bias2", shape=bshape, dtype=dtype)
+    dense_weight = relay.var("dense_weight", shape=(16, 32 * 14 * 14), dtype=dtype)
+    dense_bias = relay.var("dense_bias", shape=(16,), dtype=dtype)
+
+    conv1 = relay.nn.conv2d(data, weight1, kernel_size=(3, 3), padding=(1, 1))
+    out = relay.nn.relu(relay.add(conv1, bias1))
+    conv2 = relay.nn.conv2d(out, weight2, kernel_size=(3, 3), padding=(1, 1))
+    out = relay.nn.relu(relay.add(relay.add(conv2, bias2), data))
+    out = relay.nn.batch_flatten(out)
+    out = relay.nn.relu(relay.add(relay.nn.dense(out, dense_weight), dense_bias))
+
+    func = relay.Function(relay.analysis.free_vars(out), out)
+    ref_mod, params = tvm.relay.testing.create_workload(func)
+    ref_mod["main"] = bind_params_by_name(ref_mod["main"], params)
+    ref_mod = transform.InferType()(ref_mod)
+
+    dnnl_patterns = get_pattern_table("dnnl")
+    composite_partition = tvm.transform.Sequential(
+        [
+            transform.MergeComposite(dnnl_patterns),
+            transform.AnnotateTarget("dnnl"),
+            transform.PartitionGraph(),
+        ]
+    )
+
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=["AlterOpLayout"]):
+        mod = composite_partition(ref_mod)
+
+    composites = set()
+
+    def _visit(expr):
+        if isinstance(expr, relay.Function) and "Composite" in expr.attrs:
+            composites.add(str(expr.attrs["Composite"]))
+
+    for gv in mod.get_global_vars():
+        relay.analysis.post_order_visit(mod[gv], _visit)
+    expected = {"dnnl.conv2d_bias_relu", "dnnl.conv2d_bias_sum_relu", "dnnl.dense_bias_relu"}
+    assert expected <= composites
+
+    i_data = np.random.uniform(0, 1, ishape).astype(dtype)
+    check_result(mod, ref_mod, {"data": i_data}, (1, 16), tol=1e-4)
+
+
 def test_partial_constant():
     """Test the subgraph with (const, var, const, var) arguments."""
     if not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True):
@@ -661,6 +720,52 @@ def test_partial_constant():
     check_result(mod, ref_mod, {"in_2": data2, "in_4": data4}, (10, 10), tol=1e-5)
 
 
+def test_rerun():
+    """Test the buffers bound in place by the runtime across runs, in place and moved."""
+    if not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True):
+        print("skip because DNNL codegen is not available")
+        return
+
+    dtype = "float32"
+    shape = (10, 10)
+    data0 = relay.var("data0", shape=shape, dtype=dtype)
+    data1 = relay.var("data1", shape=shape, dtype=dtype)
+    func = relay.Function([data0, data1], relay.add(data0, data1))
+    func = set_func_attr(func, "dnnl", "dnnl_0")
+    glb_var = relay.GlobalVar("dnnl_0")
+    mod = tvm.IRModule()
+    mod[glb_var] = func
+    data0 = relay.var("data0", shape=shape, dtype=dtype)
+    data1 = relay.var("data1", shape=shape, dtype=dtype)
+    mod["main"] = relay.Function([data0, data1], glb_var(data0, data1))
+    mod = transform.InferType()(mod)
+
+    inputs = [
+        {name: np.random.uniform(0, 1, shape).astype(dtype) for name in ["data0", "data1"]}
+        for _ in range(3)
+    ]
+
+    compile_engine.get().clear()
+    with tvm.transform.PassContext(opt_level=3):
+        json, lib, _ = relay.build(mod, target="llvm")
+    rt_mod = tvm.contrib.graph_executor.create(json, lib, tvm.cpu())
+    for map_inputs in inputs:
+        rt_mod.set_input(**map_inputs)
+        rt_mod.run()
+        ref = map_inputs["data0"] + map_inputs["data1"]
+        tvm.testing.assert_allclose(rt_mod.get_output(0).numpy(), ref, rtol=1e-5, atol=1e-5)
+
+    # The VM allocates the outputs of each run
+    compile_engine.get().clear()
+    with tvm.transform.PassContext(opt_level=3):
+        exe = relay.vm.compile(mod, target="llvm")
+    vm = runtime.vm.VirtualMachine(exe, tvm.cpu())
+    for map_inputs in inputs:
+        out = vm.run(**map_inputs)
+        ref = map_inputs["data0"] + map_inputs["data1"]
+        tvm.testing.assert_allclose(out.numpy(), ref, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     test_conv2d()
     test_add()
@@ -670,4 +775,6 @@ if __name__ == "__main__":
     test_multiple_ops()
     test_composite()
     test_constant()
+    test_fused_post_ops()
     test_partial_constant()
+    test_rerun()
@@ -32,13 +32,13 @@ def check_memory_plan(func, check_fn):
         data = np.random.rand(*sh).astype(param.dtype)
         args.append(tvm.nd.array(data))
 
-    # Compute without memory planning.
+    # Compute with memory planning.
     ex = relay.create_executor("vm", mod)
-    no_plan_result = ex.evaluate(mod["main"])(*args)
+    plan_result = ex.evaluate(mod["main"])(*args)
 
-    # Compute with memory planning.
-    with tvm.transform.PassContext(opt_level=1, disabled_pass=["MemoryPlan"]):
-        plan_result = ex.evaluate(mod["main"])(*args)
+    # Compute without memory planning.
+    with tvm.transform.PassContext(opt_level=1, disabled_pass=["CoalesceStorage"]):
+        no_plan_result = ex.evaluate(mod["main"])(*args)
 
     # Compute Python result.
     py_res = check_fn(*[arg.numpy() for arg in args])
@@ -114,7 +114,94 @@ def test_no_fuse():
     check_memory_plan(func, check_no_fuse)
 
 
+def count_alloc_storage(func):
+    count = [0]
+
+    def visit(expr):
+        if isinstance(expr, relay.Call) and expr.op == relay.op.get("memory.alloc_storage"):
+            count[0] += 1
+
+    relay.analysis.post_order_visit(func, visit)
+    return count[0]
+
+
+def optimize_for_vm(mod, disabled_pass=None):
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass or []):
+        opt_mod, _ = relay.vm.VMCompiler().optimize(mod, target="llvm")
+    return opt_mod
+
+
+def check_mlp(x, w1, w2, w3):
+    y = np.maximum(np.matmul(x, w1.T), 0)
+    y = np.maximum(np.matmul(y, w2.T), 0)
+    return np.matmul(y, w3.T)
+
+
+def test_coalesce_static():
+    x = relay.var("x", shape=(1, 16))
+    w1 = relay.var("w1", shape=(32, 16))
+    w2 = relay.var("w2", shape=(32, 32))
+    w3 = relay.var("w3", shape=(8, 32))
+    y = relay.nn.relu(relay.nn.dense(x, w1))
+    y = relay.nn.relu(relay.nn.dense(y, w2))
+    out = relay.nn.dense(y, w3)
+    func = relay.Function([x, w1, w2, w3], out)
+    mod = tvm.IRModule.from_expr(func)
+
+    planned = count_alloc_storage(optimize_for_vm(mod)["main"])
+    unplanned = count_alloc_storage(optimize_for_vm(mod, ["CoalesceStorage"])["main"])
+    assert unplanned == 3
+    assert planned == 1
+    check_memory_plan(func, check_mlp)
+
+
+def test_hoist_loop_storage():
+    mod = tvm.IRModule()
+    i = relay.var("i", shape=(), dtype="int32")
+    x = relay.var("x", shape=(1, 8))
+    w = relay.var("w", shape=(8, 8))
+    loop = relay.loops.while_loop(
+        lambda i, x, w: relay.less(i, relay.const(5, "int32")),
+        [i, x, w],
+        lambda i, x, w: [
+            relay.add(i, relay.const(1, "int32")),
+            relay.nn.dense(relay.nn.dense(x, w), w),
+            w,
+        ],
+    )
+    data = relay.var("data", shape=(1, 8))
+    weight = relay.var("weight", shape=(8, 8))
+    out = relay.TupleGetItem(loop(relay.const(0, "int32"), data, weight), 1)
+    mod["main"] = relay.Function([data, weight], out)
+
+    def loop_allocs(opt_mod):
+        count = 0
+        for gv in opt_mod.get_global_vars():
+            func = opt_mod[gv]
+            if gv.name_hint != "main" and not getattr(func.attrs, "Primitive", 0):
+                count += count_alloc_storage(func)
+        return count
+
+    # The intermediate of the body and the loop condition are no longer allocated per
+    # iteration, the loop carried values still are.
+    hoisted = loop_allocs(optimize_for_vm(mod))
+    assert hoisted < loop_allocs(optimize_for_vm(mod, ["CoalesceStorage"]))
+
+    x_np = np.random.uniform(-0.5, 0.5, size=(1, 8)).astype("float32")
+    w_np = np.random.uniform(-0.5, 0.5, size=(8, 8)).astype("float32")
+    ref = x_np
+    for _ in range(5):
+        ref = np.matmul(np.matmul(ref, w_np.T), w_np.T)
+    for disabled_pass in [[], ["CoalesceStorage"]]:
+        with tvm.transform.PassContext(opt_level=3, disabled_pass=disabled_pass):
+            res = relay.create_executor("vm", mod=mod).evaluate()(x_np, w_np)
+        np.testing.assert_allclose(res.numpy(), ref, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     test_tyck_alloc_tensor()
     test_add()
     test_add_sub()
+    test_no_fuse()
+    test_coalesce_static()
+    test_hoist_loop_storage()
@@ -402,6 +402,37 @@ def test_dense_conv2d_rewrite():
     relay.analysis.post_order_visit(qnn_mod["main"], _check_dense)
 
 
+def test_channel_power2_weight_scale():
+    data = relay.var("data", shape=(1, 8, 16, 16))
+    # the channels of the weight have very different ranges
+    ranges = (2.0 ** -np.arange(8)).reshape(8, 1, 1, 1)
+    weight = np.random.uniform(-1, 1, size=(8, 8, 3, 3)) * ranges
+    conv2d = relay.nn.conv2d(
+        data, relay.const(weight, "float32"), kernel_size=(3, 3), padding=(1, 1), channels=8
+    )
+    mod = tvm.IRModule.from_expr(relay.nn.relu(conv2d))
+
+    with tvm.transform.PassContext(opt_level=3):
+        with relay.quantize.qconfig(
+            global_scale=8.0, skip_conv_layers=None, weight_scale="channel_power2"
+        ):
+            qmod = relay.quantize.quantize(mod)
+
+    shifts = []
+
+    def _find_shifts(node):
+        if isinstance(node, Call) and node.op.name == "right_shift":
+            shift = node.args[1]
+            if isinstance(shift, relay.Constant) and shift.data.shape == (8, 1, 1):
+                shifts.append(shift.data.numpy().reshape(-1))
+
+    relay.analysis.post_order_visit(qmod["main"], _find_shifts)
+    # the accumulators of the channels are shifted to the scale of the largest one
+    assert len(shifts) == 1
+    assert shifts[0][0] == 0 and list(np.diff(shifts[0])) == [1] * 7
+    relay.build(qmod, "llvm")
+
+
 if __name__ == "__main__":
     test_mul_rewrite()
     test_batch_flatten_rewrite()
@@ -419,3 +450,4 @@ if __name__ == "__main__":
     test_unquantizable_suffix_partition()
     test_left_shift_negative()
     test_dense_conv2d_rewrite()
+    test_channel_power2_weight_scale()
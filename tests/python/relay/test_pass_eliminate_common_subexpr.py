@@ -15,6 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 """Test eliminate common subexpr pass"""
+import numpy as np
 import tvm
 from tvm import te
 
@@ -116,6 +117,24 @@ def test_tuple_get_time():
     assert tvm.ir.structural_equal(z, expected())
 
 
+def test_equal_constants():
+    # The two weights have the same data, so the two dense layers are merged
+    data = np.random.uniform(size=(8, 16)).astype("float32")
+    x = relay.var("x", shape=(1, 16))
+    y1 = relay.nn.dense(x, relay.const(data))
+    y2 = relay.nn.dense(x, relay.const(data.copy()))
+    y3 = relay.nn.dense(x, relay.const(data + 1))
+    f = relay.Function([x], relay.Tuple([y1, y2, y3]))
+    z = run_opt_pass(f, transform.EliminateCommonSubexpr())
+    dense = []
+    relay.analysis.post_order_visit(
+        z, lambda e: dense.append(e) if isinstance(e, relay.Call) else None
+    )
+    assert len(dense) == 2
+    assert z.body.fields[0].same_as(z.body.fields[1])
+
+
 if __name__ == "__main__":
     test_simple()
     test_callback()
+    test_equal_constants()
@@ -298,6 +298,32 @@ def test_fold_dropout():
     assert tvm.ir.structural_equal(run_infer_type(before_mod["main"]), after_mod["main"])
 
 
+def test_fold_shared_subgraphs():
+    c_data = np.array([1, 2, 3]).astype("float32")
+    t = relay.TensorType([3], "float32")
+
+    def before():
+        x = relay.var("x", t)
+        # Two structurally equal subgraphs, and a folded value used both
+        # inside and outside of a larger constant subgraph.
+        y1 = relay.negative(relay.add(relay.const(c_data), relay.const(c_data)))
+        y2 = relay.negative(relay.add(relay.const(c_data), relay.const(c_data)))
+        z = relay.multiply(y1, relay.const(2.0))
+        out = relay.Tuple([relay.add(x, y1), relay.add(x, y2), relay.add(x, z)])
+        return relay.Function([x], out)
+
+    def expected():
+        x = relay.var("x", t)
+        y = relay.const(-(c_data + c_data))
+        z = relay.const(-(c_data + c_data) * 2.0)
+        out = relay.Tuple([relay.add(x, y), relay.add(x, y), relay.add(x, z)])
+        return relay.Function([x], out)
+
+    zz = run_opt_pass(before(), transform.FoldConstant())
+    zexpected = run_opt_pass(expected(), transform.InferType())
+    assert tvm.ir.structural_equal(zz, zexpected)
+
+
 if __name__ == "__main__":
     test_fold_const()
     test_fold_let()
@@ -307,3 +333,4 @@ if __name__ == "__main__":
     test_fold_batch_norm()
     test_fold_ndarray_size()
     test_fold_dropout()
+    test_fold_shared_subgraphs()
@@ -623,6 +623,39 @@ def test_fuse_max():
     assert tvm.ir.structural_equal(zz, after)
 
 
+def test_fuse_cost_model():
+    """Test the cost model vetoing the fusion into a reduction."""
+
+    def before():
+        x = relay.var("x", shape=(10, 20))
+        y = relay.exp(x)
+        return relay.Function([x], relay.sum(y, axis=1))
+
+    def expected():
+        x = relay.var("p", shape=(10, 20))
+        f1 = relay.Function([x], relay.exp(x))
+        f1 = f1.with_attr("Primitive", tvm.tir.IntImm("int32", 1))
+        xx = relay.var("pp", shape=(10, 20))
+        f2 = relay.Function([xx], relay.sum(xx, axis=1))
+        f2 = f2.with_attr("Primitive", tvm.tir.IntImm("int32", 1))
+        x = relay.var("x", shape=(10, 20))
+        return relay.Function([x], relay.Call(f2, [relay.Call(f1, [x])]))
+
+    queries = []
+
+    def cost_model(producer, consumer, num_nodes):
+        queries.append((producer.op.name, consumer.op.name, num_nodes))
+        return consumer.op.name != "sum"
+
+    tvm.register_func("relay.test.fuse_cost_model", cost_model, override=True)
+    config = {"relay.FuseOps.cost_model": "relay.test.fuse_cost_model"}
+    with tvm.transform.PassContext(config=config):
+        zz = run_opt_pass(before(), transform.FuseOps(fuse_opt_level=2))
+    after = run_opt_pass(expected(), transform.InferType())
+    assert tvm.ir.structural_equal(zz, after)
+    assert set(queries) == {("exp", "sum", 2)}
+
+
 def test_fuse_take():
     """Test fusion case involving concat and take"""
 
@@ -800,6 +833,7 @@ if __name__ == "__main__":
     test_immutable()
     test_split()
     test_fuse_max()
+    test_fuse_cost_model()
     test_fuse_take()
     test_fuse_gather_nd()
     test_fuse_bcast_reduce_scalar()
@@ -0,0 +1,81 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relay
+from tvm.relay import transform
+from tvm.relay.testing import run_opt_pass
+from tvm.contrib import graph_executor
+
+
+def primitive_calls(func):
+    calls = []
+
+    def fvisit(e):
+        if isinstance(e, relay.Call) and isinstance(e.op, relay.Function):
+            calls.append(e)
+
+    relay.analysis.post_order_visit(func.body, fvisit)
+    return calls
+
+
+def parallel_branches():
+    x = relay.var("x", shape=(10, 20))
+    y = relay.var("y", shape=(20,))
+    return relay.Function([x, y], relay.Tuple([relay.exp(x), relay.sqrt(y)]))
+
+
+def test_pack_parallel_branches():
+    fused = run_opt_pass(parallel_branches(), transform.FuseOps(fuse_opt_level=2))
+    assert len(primitive_calls(fused)) == 2
+    packed = run_opt_pass(fused, transform.HorizontalFuseOps())
+    calls = primitive_calls(packed)
+    assert len(calls) == 1
+    assert isinstance(calls[0].op.body, relay.Tuple)
+    assert len(calls[0].args) == 2
+    for field in packed.body.fields:
+        assert isinstance(field, relay.TupleGetItem)
+
+
+def test_keep_dependent_calls():
+    x = relay.var("x", shape=(10, 20))
+    y = relay.exp(x)
+    z = relay.sqrt(relay.annotation.stop_fusion(y))
+    func = relay.Function([x], relay.Tuple([y, z]))
+    fused = run_opt_pass(func, transform.FuseOps(fuse_opt_level=2))
+    packed = run_opt_pass(fused, transform.HorizontalFuseOps())
+    assert len(primitive_calls(packed)) == 2
+
+
+def test_build_packed():
+    with tvm.transform.PassContext(opt_level=3, required_pass=["HorizontalFuseOps"]):
+        lib = relay.build(tvm.IRModule.from_expr(parallel_branches()), "llvm")
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    x_data = np.random.rand(10, 20).astype("float32")
+    y_data = np.random.rand(20).astype("float32")
+    gmod.set_input(x=x_data, y=y_data)
+    gmod.run()
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), np.exp(x_data), rtol=1e-5)
+    tvm.testing.assert_allclose(gmod.get_output(1).numpy(), np.sqrt(y_data), rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_pack_parallel_branches()
+    test_keep_dependent_calls()
+    test_build_packed()
@@ -836,7 +836,9 @@ def test_mixed_single_multiple_outputs():
 
 def test_dnnl_fuse():
     dnnl_patterns = get_pattern_table("dnnl")
-    conv2d_bias_relu_pat, conv2d_relu_pat = dnnl_patterns
+    patterns = {pattern[0]: pattern for pattern in dnnl_patterns}
+    conv2d_bias_relu_pat = patterns["dnnl.conv2d_bias_relu"]
+    conv2d_relu_pat = patterns["dnnl.conv2d_relu"]
 
     def get_blocks(prefix, data, in_channel, out_channel, include_bn=True, include_sigmoid=False):
         weight = relay.var(prefix + "weight")
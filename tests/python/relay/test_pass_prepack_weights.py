@@ -0,0 +1,114 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+import tvm
+from tvm import relay
+from tvm.contrib import graph_executor
+from tvm.relay import transform
+
+
+def run_opt_pass(expr, opt_pass):
+    assert isinstance(opt_pass, tvm.transform.Pass)
+
+    mod = tvm.IRModule.from_expr(expr)
+    mod = relay.transform.InferType()(mod)
+    mod = opt_pass(mod)
+    return mod["main"]
+
+
+def pack_nk(w, bn):
+    n, k = w.shape
+    return w.reshape(n // bn, bn, k).transpose(0, 2, 1)
+
+
+def test_prepack_layout_transform():
+    x_shape = (4, 32)
+    w_data = np.random.uniform(size=(16, 32)).astype("float32")
+
+    def before():
+        x = relay.var("x", shape=x_shape)
+        w = relay.const(np.ascontiguousarray(w_data.T))
+        w = relay.layout_transform(relay.transpose(w), "NK", "NK8n")
+        y = relay.nn.contrib_dense_pack(x, w)
+        return relay.Function([x], y)
+
+    def expected():
+        x = relay.var("x", shape=x_shape)
+        w = relay.const(pack_nk(w_data, 8))
+        y = relay.nn.contrib_dense_pack(x, w)
+        return relay.Function([x], y)
+
+    after = run_opt_pass(before(), transform.PrepackWeights())
+    assert tvm.ir.structural_equal(after, run_opt_pass(expected(), transform.InferType()))
+
+
+def test_prepack_skip_kernels_and_params():
+    x_shape = (4, 32)
+    w_shape = (16, 32)
+
+    def before():
+        x = relay.var("x", shape=x_shape)
+        w = relay.var("w", shape=w_shape)
+        c = relay.const(np.ones(x_shape, "float32"))
+        y = relay.nn.contrib_dense_pack(x, relay.layout_transform(w, "NK", "NK8n"))
+        z = relay.nn.dense(c, relay.const(np.ones(w_shape, "float32")))
+        return relay.Function([x, w], relay.Tuple([y, z]))
+
+    before_func = run_opt_pass(before(), transform.InferType())
+    after = run_opt_pass(before(), transform.PrepackWeights())
+    assert tvm.ir.structural_equal(after, before_func)
+
+
+def test_prepack_skip_arithmetic():
+    def before():
+        x = relay.var("x", shape=(4, 32))
+        c = relay.const(np.ones((1, 32), "float32"))
+        w = relay.broadcast_to(relay.exp(relay.add(c, c)), (16, 32))
+        return relay.Function([x], relay.nn.dense(x, relay.transpose(relay.transpose(w))))
+
+    before_func = run_opt_pass(before(), transform.InferType())
+    after = run_opt_pass(before(), transform.PrepackWeights())
+    assert tvm.ir.structural_equal(after, before_func)
+
+
+def test_prepack_in_build():
+    x_shape = (4, 32)
+    w_data = np.random.uniform(size=(16, 32)).astype("float32")
+    x_data = np.random.uniform(size=x_shape).astype("float32")
+    x = relay.var("x", shape=x_shape)
+    w = relay.var("w", shape=w_data.shape)
+    y = relay.nn.contrib_dense_pack(x, relay.layout_transform(w, "NK", "NK8n"))
+    mod = tvm.IRModule.from_expr(relay.Function([x, w], y))
+
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=["FoldConstant"]):
+        lib = relay.build(mod, "llvm", params={"w": w_data})
+    assert "layout_transform" not in lib.get_graph_json()
+    packed = [p.numpy() for p in lib.get_params().values() if p.shape == (2, 32, 8)]
+    assert len(packed) == 1
+    np.testing.assert_equal(packed[0], pack_nk(w_data, 8))
+
+    m = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+    m.set_input("x", x_data)
+    m.run()
+    np.testing.assert_allclose(m.get_output(0).numpy(), x_data @ w_data.T, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_prepack_layout_transform()
+    test_prepack_skip_kernels_and_params()
+    test_prepack_skip_arithmetic()
+    test_prepack_in_build()
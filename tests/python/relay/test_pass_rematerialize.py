@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relay
+from tvm.relay import transform
+from tvm.relay.testing import run_opt_pass
+
+
+def count_op(expr, op_name):
+    count = [0]
+    op = relay.op.get(op_name)
+
+    def visit(node):
+        if isinstance(node, relay.Call) and node.op == op:
+            count[0] += 1
+
+    relay.analysis.post_order_visit(expr, visit)
+    return count[0]
+
+
+def residual():
+    # The exp is alive across the large hidden tensor of the dense layers.
+    x = relay.var("x", shape=(1, 256), dtype="float32")
+    w1 = relay.var("w1", shape=(4096, 256), dtype="float32")
+    w2 = relay.var("w2", shape=(256, 4096), dtype="float32")
+    a = relay.exp(x)
+    h = relay.nn.dense(a, w1)
+    y = relay.nn.dense(h, w2)
+    return relay.Function([x, w1, w2], relay.add(y, a))
+
+
+def test_rematerialize_residual():
+    func = residual()
+    after = run_opt_pass(func, transform.Rematerialize(1))
+    assert count_op(after, "exp") == 2
+    # The recomputation is used by the add, after the dense layers.
+    assert isinstance(after.body.args[1], relay.Call) and after.body.args[1].op.name == "exp"
+    assert not after.body.args[1].same_as(after.body.args[0].args[0].args[0])
+
+    x = np.random.uniform(-1, 1, (1, 256)).astype("float32")
+    w1 = np.random.uniform(-1, 1, (4096, 256)).astype("float32")
+    w2 = np.random.uniform(-1, 1, (256, 4096)).astype("float32")
+    expected = relay.create_executor(mod=tvm.IRModule.from_expr(func)).evaluate()(x, w1, w2)
+    actual = relay.create_executor(mod=tvm.IRModule.from_expr(after)).evaluate()(x, w1, w2)
+    tvm.testing.assert_allclose(actual.numpy(), expected.numpy(), rtol=1e-5)
+
+
+def test_rematerialize_budget():
+    func = residual()
+    # No recomputation without a budget, nor when the graph meets it.
+    for budget in [0, 1 << 30]:
+        after = run_opt_pass(func, transform.Rematerialize(budget))
+        assert count_op(after, "exp") == 1
+    # The budget of the pass config.
+    with tvm.transform.PassContext(config={"relay.backend.memory_budget": 1}):
+        after = run_opt_pass(func, transform.Rematerialize())
+    assert count_op(after, "exp") == 2
+
+
+def test_rematerialize_keep_inputs_alive():
+    # Recomputing the exp at the add would keep the output of the first dense alive.
+    x = relay.var("x", shape=(1, 256), dtype="float32")
+    w1 = relay.var("w1", shape=(256, 256), dtype="float32")
+    w2 = relay.var("w2", shape=(4096, 256), dtype="float32")
+    w3 = relay.var("w3", shape=(256, 4096), dtype="float32")
+    a = relay.exp(relay.nn.dense(x, w1))
+    h = relay.nn.dense(a, w2)
+    y = relay.nn.dense(h, w3)
+    func = relay.Function([x, w1, w2, w3], relay.add(y, a))
+    after = run_opt_pass(func, transform.Rematerialize(1))
+    assert count_op(after, "exp") == 1
+
+
+if __name__ == "__main__":
+    test_rematerialize_residual()
+    test_rematerialize_budget()
+    test_rematerialize_keep_inputs_alive()
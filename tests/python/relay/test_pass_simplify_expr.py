@@ -284,6 +284,123 @@ def test_simplify_transpose():
         )
 
 
+def test_simplify_layout_transform():
+    def before1():
+        """
+        Compose layout_transform->layout_transform which split an axis by other factors.
+
+        Input:
+        NCHW -> NCHW16c -> NCHW4c -> op
+
+        Simplified:
+        NCHW -> NCHW4c -> op
+        """
+        x = relay.var("x", shape=(1, 64, 56, 56), dtype="float32")
+        y = relay.layout_transform(x, "NCHW", "NCHW16c")
+        y = relay.layout_transform(y, "NCHW16c", "NCHW4c")
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def expected1():
+        x = relay.var("x", shape=(1, 64, 56, 56), dtype="float32")
+        y = relay.layout_transform(x, "NCHW", "NCHW4c")
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def before2():
+        """
+        Do not cancel the layout_transforms of the rank, but not the factors, of the input.
+
+        Input:
+        NCHW4c -> NCHW8c -> NCHW16c -> op
+
+        Simplified:
+        NCHW4c -> NCHW16c -> op
+        """
+        x = relay.var("x", shape=(1, 16, 56, 56, 4), dtype="float32")
+        y = relay.layout_transform(x, "NCHW4c", "NCHW8c")
+        y = relay.layout_transform(y, "NCHW8c", "NCHW16c")
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def expected2():
+        x = relay.var("x", shape=(1, 16, 56, 56, 4), dtype="float32")
+        y = relay.layout_transform(x, "NCHW4c", "NCHW16c")
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def before3():
+        """
+        Remove layout_transform->reshape->layout_transform when the reshape keeps the shape.
+
+        Input:
+        NCHW -> NCHW16c -> reshape -> NCHW -> op
+
+        Simplified:
+        NCHW -> op
+        """
+        x = relay.var("x", shape=(1, 64, 56, 56), dtype="float32")
+        y = relay.layout_transform(x, "NCHW", "NCHW16c")
+        y = relay.reshape(y, newshape=(1, 4, 56, 56, 16))
+        y = relay.layout_transform(y, "NCHW16c", "NCHW")
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def expected3():
+        x = relay.var("x", shape=(1, 64, 56, 56), dtype="float32")
+        y = relay.nn.relu(x)
+        return relay.Function([x], y)
+
+    def before4():
+        """
+        Remove the unpacking and packing of the batch and channel axes by graph_pack.
+
+        Input:
+        NCHWnc -> transpose -> reshape -> NCHW -> reshape -> transpose -> NCHWnc -> op
+
+        Simplified:
+        NCHWnc -> op
+        """
+        x = relay.var("x", shape=(1, 4, 8, 8, 1, 16), dtype="int8")
+        y = relay.transpose(x, axes=(0, 4, 1, 5, 2, 3))
+        y = relay.reshape(y, newshape=(1, 64, 8, 8))
+        y = relay.reshape(y, newshape=(1, 1, 4, 16, 8, 8))
+        y = relay.transpose(y, axes=(0, 2, 4, 5, 1, 3))
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    def expected4():
+        x = relay.var("x", shape=(1, 4, 8, 8, 1, 16), dtype="int8")
+        y = relay.nn.relu(x)
+        return relay.Function([x], y)
+
+    def before5():
+        """
+        Keep a transpose of a layout_transform which is not a transpose.
+
+        Input:
+        NCHW4c -> NCHW8c -> transpose -> op
+        """
+        x = relay.var("x", shape=(1, 16, 56, 56, 4), dtype="float32")
+        y = relay.layout_transform(x, "NCHW4c", "NCHW8c")
+        y = relay.transpose(y, axes=(0, 2, 3, 1, 4))
+        y = relay.nn.relu(y)
+        return relay.Function([x], y)
+
+    for before, expected in [
+        [before1(), expected1()],
+        [before2(), expected2()],
+        [before3(), expected3()],
+        [before4(), expected4()],
+        [before5(), before5()],
+    ]:
+        after = run_opt_pass(before, transform.SimplifyExpr())
+        expected = run_opt_pass(expected, transform.InferType())
+        assert tvm.ir.structural_equal(after, expected), "\nafter: {} \nexpected: {}".format(
+            after, expected
+        )
+
+
 def test_simplify_full_elementwise():
     def validate(shape, value, dtype):
         def before_left(x, elem_op, full):
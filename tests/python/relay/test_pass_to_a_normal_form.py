@@ -198,6 +198,27 @@ def test_gradient_if():
     mod = relay.transform.ToANormalForm()(mod)
 
 
+def test_deep_graph():
+    # Deep graphs and the let chains they are turned into are converted without recursion.
+    depth = 100000
+    x = relay.var("x", shape=(1,))
+    one = relay.const(1.0)
+    y = x
+    for _ in range(depth):
+        y = relay.add(y, one)
+
+    def num_lets(e):
+        num = 0
+        while isinstance(e, relay.Let):
+            num += 1
+            e = e.body
+        return num
+
+    anf = transform.ToANormalFormExpr(y)
+    assert num_lets(anf) == depth + 1
+    assert num_lets(transform.ToANormalFormExpr(anf)) >= depth + 1
+
+
 if __name__ == "__main__":
     test_explicit_bound()
     test_order()
@@ -208,3 +229,4 @@ if __name__ == "__main__":
     test_nat_add()
     test_function()
     test_gradient_if()
+    test_deep_graph()
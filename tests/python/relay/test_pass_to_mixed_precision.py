@@ -0,0 +1,67 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import relay
+from tvm.relay import transform
+from tvm.relay.testing import run_opt_pass
+
+
+def test_conv2d_follow_ops():
+    x = relay.var("x", shape=(1, 3, 8, 8))
+    w = relay.var("w", shape=(4, 3, 3, 3))
+    b = relay.var("b", shape=(4,))
+    y = relay.nn.conv2d(x, w, padding=(1, 1))
+    y = relay.nn.relu(relay.nn.bias_add(y, b))
+    before = relay.Function([x, w, b], relay.sum(y))
+
+    def expected():
+        x = relay.var("x", shape=(1, 3, 8, 8))
+        w = relay.var("w", shape=(4, 3, 3, 3))
+        b = relay.var("b", shape=(4,))
+        y = relay.nn.conv2d(
+            relay.cast(x, "float16"), relay.cast(w, "float16"), padding=(1, 1), out_dtype="float32"
+        )
+        y = relay.nn.bias_add(relay.cast(y, "float16"), relay.cast(b, "float16"))
+        y = relay.cast(relay.nn.relu(y), "float32")
+        return relay.Function([x, w, b], relay.sum(y))
+
+    after = run_opt_pass(before, transform.ToMixedPrecision())
+    tvm.ir.assert_structural_equal(after, run_opt_pass(expected(), transform.InferType()))
+
+
+def test_cancel_casts():
+    x = relay.var("x", shape=(4, 8))
+    w = relay.var("w", shape=(16, 8))
+    y = relay.nn.dense(x, w)
+    # The cast of the dense result and its cast back to float32 cancel out.
+    before = relay.Function([x, w], relay.Tuple([relay.nn.softmax(y), relay.nn.softmax(y, 0)]))
+
+    def expected():
+        x = relay.var("x", shape=(4, 8))
+        w = relay.var("w", shape=(16, 8))
+        y = relay.nn.dense(
+            relay.cast(x, "bfloat16"), relay.cast(w, "bfloat16"), out_dtype="float32"
+        )
+        return relay.Function([x, w], relay.Tuple([relay.nn.softmax(y), relay.nn.softmax(y, 0)]))
+
+    after = run_opt_pass(before, transform.ToMixedPrecision("bfloat16"))
+    tvm.ir.assert_structural_equal(after, run_opt_pass(expected(), transform.InferType()))
+
+
+if __name__ == "__main__":
+    test_conv2d_follow_ops()
+    test_cancel_casts()
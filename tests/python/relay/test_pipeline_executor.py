@@ -0,0 +1,87 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relay
+from tvm.contrib import graph_executor, pipeline_executor
+
+
+def get_network():
+    x = relay.var("x", shape=(4, 16))
+    y = x
+    weights = []
+    for i in range(4):
+        w = relay.var("w%d" % i, shape=(16, 16))
+        weights.append(w)
+        y = relay.nn.relu(relay.nn.dense(y, w))
+    # The input is also used by the last stage.
+    out = relay.add(y, x)
+    mod = tvm.IRModule.from_expr(relay.Function([x] + weights, out))
+    params = {
+        "w%d" % i: np.random.uniform(-1, 1, size=(16, 16)).astype("float32") for i in range(4)
+    }
+    return mod, params
+
+
+def count_ops(mod, name):
+    ops = []
+
+    def fvisit(e):
+        if isinstance(e, relay.Call) and e.op == relay.op.get(name):
+            ops.append(e)
+
+    relay.analysis.post_order_visit(mod["main"], fvisit)
+    return len(ops)
+
+
+def test_partition_balanced():
+    mod, params = get_network()
+    mod = tvm.IRModule.from_expr(relay.build_module.bind_params_by_name(mod["main"], params))
+    stages = relay.transform.partition_pipeline(mod, 2)
+    assert len(stages) == 2
+    # The dense ops, with the same number of MACs, are split evenly.
+    assert [count_ops(stage, "nn.dense") for stage in stages] == [2, 2]
+    # The input of the function passes through the first stage.
+    assert [p.name_hint for p in stages[0]["main"].params] == ["x"]
+    assert len(stages[0]["main"].checked_type.ret_type.fields) == 2
+    assert [p.name_hint for p in stages[1]["main"].params] == ["x", "stage1_input1"]
+
+
+def test_pipeline_run():
+    mod, params = get_network()
+    batches = [{"x": np.random.uniform(size=(4, 16)).astype("float32")} for _ in range(5)]
+
+    lib = relay.build(mod, "llvm", params=params)
+    ref = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    expected = []
+    for batch in batches:
+        ref.run(**batch)
+        expected.append(ref.get_output(0).numpy())
+
+    libs = pipeline_executor.build(mod, ["llvm"] * 3, params=params)
+    pipeline = pipeline_executor.PipelineModule(libs, [tvm.cpu(0)] * 3)
+    outputs = pipeline.run(batches)
+    assert len(outputs) == len(batches)
+    for out, ref_out in zip(outputs, expected):
+        tvm.testing.assert_allclose(out[0].numpy(), ref_out, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    test_partition_balanced()
+    test_pipeline_run()
@@ -86,5 +86,29 @@ def test_bsr_sparse_dense():
     np.testing.assert_allclose(sparse_output, dense_output, atol=1e-5, rtol=1e-5)
 
 
+def test_bsr_sparse_dense_block_size_per_weight():
+    data = relay.var("data", shape=(1, 128), dtype="float32")
+    w0 = relay.var("weight0", shape=(256, 128), dtype="float32")
+    w1 = relay.var("weight1", shape=(64, 256), dtype="float32")
+    z = relay.nn.dense(relay.nn.relu(relay.nn.dense(data, w0)), w1)
+    func = relay.Function(relay.analysis.free_vars(z), z)
+
+    params = {
+        "weight0": tvm.nd.array(random_bsr_matrix(256, 128, 16, 1, 0.1).todense()),
+        "weight1": tvm.nd.array(random_bsr_matrix(64, 256, 4, 4, 0.1).todense()),
+    }
+    x_np = np.random.randn(1, 128).astype("float32")
+    dense_output = run_func(func, params, x_np)
+    block_sizes = {"weight0": (16, 1), "weight1": (4, 4)}
+    sparse_func, params = relay.data_dep_optimization.bsr_dense.convert(
+        func, params, block_sizes, 0.2
+    )
+    assert params["weight0.data"].shape[1:] == (16, 1)
+    assert params["weight1.data"].shape[1:] == (4, 4)
+    sparse_output = run_func(sparse_func, params, x_np)
+    np.testing.assert_allclose(sparse_output, dense_output, atol=1e-5, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_bsr_sparse_dense()
+    test_bsr_sparse_dense_block_size_per_weight()
@@ -416,6 +416,27 @@ def test_dynamic_function():
     assert mod["main"].params[0].checked_type == s_tt
 
 
+def test_incremental_infer():
+    tt = relay.TensorType((2,), "float32")
+    mod = tvm.IRModule()
+    f = relay.GlobalVar("f")
+    x = relay.var("x", tt)
+    mod[f] = relay.Function([x], relay.add(x, x), ret_type=tt)
+    y = relay.var("y", tt)
+    mod["main"] = relay.Function([y], f(y))
+    mod = transform.InferType()(mod)
+    main = mod["main"]
+    mod = transform.InferType()(mod)
+    # The functions which are unchanged are not checked again
+    assert mod["main"].same_as(main)
+    # but the callers of a function whose type has changed are.
+    it = relay.TensorType((2,), "int32")
+    z = relay.var("z", tt)
+    mod[f] = relay.Function([z], relay.cast(z, "int32"), ret_type=it)
+    mod = transform.InferType()(mod)
+    assert mod["main"].checked_type.ret_type == it
+
+
 if __name__ == "__main__":
     import sys
 
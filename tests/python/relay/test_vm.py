@@ -915,5 +915,133 @@ def test_get_output_multiple():
     np.testing.assert_allclose(outputs[1].numpy(), inp)
 
 
+
+def test_shape_buckets():
+    x = relay.var("x", shape=(1, relay.Any()), dtype="float32")
+    y = relay.var("y", shape=(1, relay.Any()), dtype="float32")
+    mod = IRModule.from_expr(relay.Function([x, y], relay.nn.relu(x + y)))
+    vm_exec = vm.compile(mod, target="llvm")
+    vm_obj = runtime.vm.VirtualMachine(vm_exec, tvm.cpu())
+    vm_obj.set_shape_buckets("main", [8, 4, 16])
+    for length in [3, 4, 9]:
+        a = np.random.uniform(-1, 1, size=(1, length)).astype("float32")
+        b = np.random.uniform(-1, 1, size=(1, length)).astype("float32")
+        out = vm_obj.run(a, b).numpy()
+        bucket = min(s for s in [4, 8, 16] if s >= length)
+        assert out.shape == (1, bucket)
+        np.testing.assert_allclose(out[:, :length], np.maximum(a + b, 0), rtol=1e-5)
+        np.testing.assert_equal(out[:, length:], 0)
+    # Beyond the largest bucket, and once the buckets are removed
+    a = np.ones((1, 17), dtype="float32")
+    assert vm_obj.run(a, a).numpy().shape == (1, 17)
+    vm_obj.set_shape_buckets("main", [], inputs=["x", 1])
+    a = np.ones((1, 3), dtype="float32")
+    assert vm_obj.run(a, a).numpy().shape == (1, 3)
+
+
+
+def test_memory_pool_limit():
+    x = relay.var("x", shape=(relay.Any(),), dtype="float32")
+    mod = IRModule.from_expr(relay.Function([x], relay.exp(x) + x))
+    vm_exec = vm.compile(mod, target="llvm")
+    dev = tvm.cpu()
+    vm_obj = runtime.vm.VirtualMachine(vm_exec, dev)
+    for length in [1000, 1100, 1000]:
+        a = np.random.uniform(size=(length,)).astype("float32")
+        np.testing.assert_allclose(vm_obj.run(a).numpy(), np.exp(a) + a, rtol=1e-5)
+    stats = runtime.profiling.memory_pool_stats(dev)
+    assert stats["Hits"] > 0
+    assert stats["Peak Bytes"] >= stats["Used Bytes"] >= stats["Cached Bytes"]
+    runtime.vm.set_memory_pool_limit(dev, 1)
+    stats = runtime.profiling.memory_pool_stats(dev)
+    assert stats["Limit Bytes"] == 1
+    assert stats["Cached Bytes"] == 0
+    a = np.random.uniform(size=(10,)).astype("float32")
+    np.testing.assert_allclose(vm_obj.run(a).numpy(), np.exp(a) + a, rtol=1e-5)
+    runtime.vm.set_memory_pool_limit(dev, 0)
+
+
+def test_ndarray_pool():
+    dev = tvm.cpu()
+    runtime.ndarray.set_pool(dev)
+    try:
+        hits = runtime.profiling.memory_pool_stats(dev)["Hits"]
+        # the temporaries reuse the buffers freed before them
+        for _ in range(3):
+            a = np.random.uniform(size=(1000,)).astype("float32")
+            np.testing.assert_equal(tvm.nd.array(a, dev).numpy(), a)
+        assert runtime.profiling.memory_pool_stats(dev)["Hits"] >= hits + 2
+        x = tvm.nd.empty((4, 4), "int8", dev)
+        assert x.shape == (4, 4)
+    finally:
+        runtime.ndarray.set_pool(dev, False)
+
+
+def test_invoke_concurrent():
+    import threading
+
+    x = relay.var("x", shape=(16,), dtype="float32")
+    w = relay.const(np.arange(16, dtype="float32"))
+    mod = IRModule.from_expr(relay.Function([x], relay.exp(x) * w))
+    vm_exec = vm.compile(mod, target="llvm")
+    vm_obj = runtime.vm.VirtualMachine(vm_exec, tvm.cpu())
+    inputs = [np.random.uniform(size=(16,)).astype("float32") for _ in range(8)]
+    results = [None] * len(inputs)
+
+    def run(i):
+        for _ in range(10):
+            results[i] = vm_obj.invoke_concurrent("main", inputs[i]).numpy()
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(inputs))]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    for a, res in zip(inputs, results):
+        np.testing.assert_allclose(res, np.exp(a) * np.arange(16), rtol=1e-5)
+
+
+def test_lazy_constants():
+    x = relay.var("x", shape=(16,), dtype="float32")
+    w0 = relay.const(np.arange(16, dtype="float32"))
+    w1 = relay.const(np.full((16,), 2, dtype="float32"))
+    mod = IRModule.from_expr(relay.Function([x], (x + w0) * w1))
+    vm_exec = vm.compile(mod, target="llvm")
+    code, lib = vm_exec.save()
+    a = np.random.uniform(size=(16,)).astype("float32")
+    expected = (a + np.arange(16)) * 2
+
+    lazy_exec = runtime.vm.Executable.load_exec(code, lib)
+    vm_obj = runtime.vm.VirtualMachine(lazy_exec, tvm.cpu())
+    np.testing.assert_allclose(vm_obj.run(a).numpy(), expected)
+
+    prefetch_exec = runtime.vm.Executable.load_exec(code, lib)
+    prefetch_exec.prefetch_constants()
+    vm_obj = runtime.vm.VirtualMachine(prefetch_exec, tvm.cpu())
+    np.testing.assert_allclose(vm_obj.run(a).numpy(), expected)
+
+    # Saving a deserialized executable keeps the constants that are not loaded yet
+    resaved_code, _ = runtime.vm.Executable.load_exec(code, lib).save()
+    assert bytes(resaved_code) == bytes(code)
+
+
+def test_vm_specialized_shapes():
+    x = relay.var("x", shape=(relay.Any(), 4), dtype="float32")
+    y = relay.reshape(relay.nn.relu(x), newshape=relay.shape_of(x))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.add(y, relay.const(1.0))))
+
+    specialized = relay.transform.SpecializeShapes([{"x": (8, 4)}])(mod)
+    assert isinstance(specialized["main"].body, relay.If)
+
+    target = "llvm"
+    dev = tvm.cpu()
+    exe = vm.compile(mod, target, specialized_shapes=[{"x": (8, 4)}, {"x": (2, 4)}])
+    vm_exec = runtime.vm.VirtualMachine(exe, dev)
+    for batch in [8, 2, 5]:
+        x_np = np.random.uniform(-1, 1, size=(batch, 4)).astype("float32")
+        res = vm_exec.run(x_np)
+        tvm.testing.assert_allclose(res.numpy(), np.maximum(x_np, 0) + 1.0)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
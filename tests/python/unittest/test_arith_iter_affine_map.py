@@ -643,6 +643,50 @@ def test_normalize_iter_map_to_expr():
     tvm.ir.assert_structural_equal(tvm.arith.normalize_iter_map_to_expr(res[1]), flm(x[0], 5))
 
 
+def test_padding():
+    x = tvm.tir.Var("x", "int32")
+    fld = tvm.tir.floordiv
+    flm = tvm.tir.floormod
+
+    # non-divisible splits only map with padding
+    res = tvm.arith.detect_iter_map([fld(x, 4), flm(x, 4)], var_dom([(x, 10)]))
+    assert len(res) == 0
+    res = tvm.arith.detect_iter_map(
+        [fld(x, 4), flm(x, 4)], var_dom([(x, 10)]), allow_padding=True
+    )
+    assert len(res) == 2
+    assert_iter_sum_pattern(res[0], 3, 0)
+    assert_iter_sum_pattern(res[1], 4, 0)
+    assert res[0].args[0].source.same_as(res[1].args[0].source)
+    tvm.testing.assert_prim_expr_equal(res[0].args[0].source.extent, 12)
+    tvm.ir.assert_structural_equal(tvm.arith.normalize_iter_map_to_expr(res[0]), fld(x, 4))
+    tvm.ir.assert_structural_equal(tvm.arith.normalize_iter_map_to_expr(res[1]), flm(x, 4))
+
+    # padded values are never reached, the mapping is not bijective
+    res = tvm.arith.detect_iter_map(
+        [fld(x, 4), flm(x, 4)], var_dom([(x, 10)]), require_bijective=True, allow_padding=True
+    )
+    assert len(res) == 0
+
+    # the inner splits rewritten before the padding move to the padded iterator
+    res = tvm.arith.detect_iter_map(
+        [flm(x, 2), fld(fld(x, 2), 3)], var_dom([(x, 10)]), allow_padding=True
+    )
+    assert len(res) == 2
+    assert_iter_sum_pattern(res[0], 2, 0)
+    assert_iter_sum_pattern(res[1], 2, 0)
+    assert res[0].args[0].source.same_as(res[1].args[0].source)
+
+    # the unpadded iterator overlaps the padded splits
+    res = tvm.arith.detect_iter_map([x, fld(x, 4)], var_dom([(x, 10)]), allow_padding=True)
+    assert len(res) == 0
+    # the divisions must agree on the padding
+    res = tvm.arith.detect_iter_map(
+        [fld(x, 4), flm(x, 3)], var_dom([(x, 10)]), allow_padding=True
+    )
+    assert len(res) == 0
+
+
 if __name__ == "__main__":
     test_split()
     test_trivial()
@@ -652,3 +696,4 @@ if __name__ == "__main__":
     test_normalize_iter_map_to_expr()
     test_subspace_division()
     test_complex()
+    test_padding()
@@ -0,0 +1,71 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te, tir
+
+
+def memoized():
+    return tvm.transform.PassContext(config={"arith.memoize_simplify": True})
+
+
+def test_memo_shared_across_analyzers():
+    x = te.var("x")
+    expr = (x * 4 + 8) // 4 - x
+    tvm.arith.clear_simplify_memo()
+    with memoized():
+        assert tvm.ir.structural_equal(tvm.arith.Analyzer().simplify(expr), tir.const(2))
+        size = tvm.arith.simplify_memo_size()
+        assert size > 0
+        # A new analyzer, e.g. of the next pass, reuses the result.
+        assert tvm.ir.structural_equal(tvm.arith.Analyzer().simplify(expr), tir.const(2))
+        assert tvm.arith.simplify_memo_size() == size
+    # Nothing is memoized without the config.
+    tvm.arith.Analyzer().simplify(expr + 1)
+    assert tvm.arith.simplify_memo_size() == size
+    tvm.arith.clear_simplify_memo()
+    assert tvm.arith.simplify_memo_size() == 0
+
+
+def test_memo_keyed_by_context():
+    x = te.var("x")
+    y = te.var("y")
+    expr = tir.floormod(x, 8)
+    tvm.arith.clear_simplify_memo()
+    with memoized():
+        assert not tvm.ir.structural_equal(tvm.arith.Analyzer().simplify(expr), x)
+        # The bound of x simplifies it.
+        ana = tvm.arith.Analyzer()
+        ana.bind(x, tvm.ir.Range(0, 8))
+        assert tvm.ir.structural_equal(ana.simplify(expr), x)
+        # So does a constraint, only for the expressions of its vars.
+        ana = tvm.arith.Analyzer()
+        with ana.constraint_scope(tir.all(x >= 0, x < 8)):
+            assert tvm.ir.structural_equal(ana.simplify(expr), x)
+        assert not tvm.ir.structural_equal(ana.simplify(expr), x)
+        # A binding reaches the expression through the bound var.
+        ana = tvm.arith.Analyzer()
+        ana.bind(y, x * 2)
+        assert tvm.ir.structural_equal(ana.simplify(tir.floormod(y, 2)), tir.const(0))
+        assert not tvm.ir.structural_equal(
+            tvm.arith.Analyzer().simplify(tir.floormod(y, 2)), tir.const(0)
+        )
+    tvm.arith.clear_simplify_memo()
+
+
+if __name__ == "__main__":
+    test_memo_shared_across_analyzers()
+    test_memo_keyed_by_context()
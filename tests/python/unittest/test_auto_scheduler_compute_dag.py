@@ -38,11 +38,47 @@ def test_apply_steps():
     tvm.lower(sch, tensors, simple_mode=True)
 
 
+def test_apply_steps_replay_cache():
+    def lower(dag, state):
+        sch, tensors = dag.apply_steps_from_state(state)
+        return str(tvm.lower(sch, tensors, simple_mode=True))
+
+    dag, s = get_tiled_matmul()
+    C = s.stages[-1].op
+    s.split(C, s[C].iters[8], [16])
+    prefix = auto_scheduler.loop_state.State(s.state_object, dag)
+    s.fuse(C, [s[C].iters[0], s[C].iters[1]])
+    s.parallel(C, s[C].iters[0])
+    prefix.unroll(C, prefix[C].iters[-1])
+
+    # The replays after the first resume from the schedule of the four steps both states
+    # start with, and must give what a new ComputeDAG replays from scratch.
+    first = lower(dag, s)
+    assert lower(dag, s) == first
+    assert lower(dag, prefix) == lower(auto_scheduler.ComputeDAG(dag.tensors), prefix)
+    assert lower(auto_scheduler.ComputeDAG(dag.tensors), s) == first
+
+
 def test_infer_bound():
     dag, s = get_tiled_matmul()
     s = dag.infer_bound_from_state(s)
 
 
+def test_infer_bound_cache():
+    dag, s = get_tiled_matmul()
+    first = dag.infer_bound_from_state(s)
+    # The same steps reuse the bounds inferred the first time.
+    second = dag.infer_bound_from_state(s)
+    assert str(first) == str(second)
+    # Other steps infer their own.
+    C = s.stages[-1].op
+    s.split(C, s[C].iters[8], [16])
+    third = dag.infer_bound_from_state(s)
+    assert str(third) != str(first)
+    assert third[C].iters[-1].range.extent == 16
+    assert third[C].iters[-2].range.extent == 32
+
+
 def test_estimate_flop():
     N = 512
     A, B, C = matmul_auto_scheduler_test(N, N, N)
@@ -146,7 +182,9 @@ def test_invalid_compute_dag():
 
 if __name__ == "__main__":
     test_apply_steps()
+    test_apply_steps_replay_cache()
     test_infer_bound()
+    test_infer_bound_cache()
     test_estimate_flop()
     test_stage_order()
     test_invalid_compute_dag()
@@ -22,7 +22,10 @@ import tempfile
 import numpy as np
 
 import tvm
+import tvm.testing
 from tvm import auto_scheduler
+from tvm.auto_scheduler import _ffi_api
+from tvm.auto_scheduler.feature import get_per_store_features_from_states
 
 from test_auto_scheduler_common import matmul_auto_scheduler_test
 
@@ -79,6 +82,39 @@ def test_xgb_model():
     model.load(tmpfile)
 
 
+def test_tree_ensemble_model():
+    task, inputs, results = get_sample_records(20)
+    states = [x.state for x in inputs]
+
+    model = auto_scheduler.TreeEnsembleModel()
+    assert model.num_trees == 0
+    assert len(model.predict(task, states)) == len(states)
+
+    # Two trees: a split on feature 0 and a leaf.
+    node_indices = [(0, 1, 2, 1), (-1, -1, -1, -1), (-1, -1, -1, -1), (-1, -1, -1, -1)]
+    node_values = [0.5, 1.0, 2.0, 0.25]
+    model.load_trees(node_indices, node_values, [0, 3], base_score=0.125)
+    assert model.num_trees == 2
+
+    expected = []
+    for feature in get_per_store_features_from_states(states, task):
+        expected.append(np.sum(np.where(feature[:, 0] < 0.5, 1.0, 2.0) + 0.375))
+    tvm.testing.assert_allclose(model.predict(task, states), expected, rtol=1e-5)
+
+
+def test_xgb_model_native_inference():
+    task, inputs, results = get_sample_records(50)
+    states = [x.state for x in inputs]
+
+    model = auto_scheduler.XGBModel(num_warmup_sample=-1, native_inference=True)
+    model.update(inputs, results)
+    # The native predictions of the search policies match the xgboost ones.
+    native = [x.value for x in _ffi_api.CostModelPredict(model, task, states)]
+    tvm.testing.assert_allclose(native, model.predict(task, states), rtol=1e-4, atol=1e-4)
+
+
 if __name__ == "__main__":
     test_random_model()
     test_xgb_model()
+    test_tree_ensemble_model()
+    test_xgb_model_native_inference()
@@ -200,7 +200,30 @@ def test_gpu_feature():
         assert fequal(fea_dicts[0]["is_gpu"], 1.0)
 
 
+def test_feature_cache():
+    dag = auto_scheduler.ComputeDAG(matmul_auto_scheduler_test(128, 128, 128))
+    s = dag.get_init_state()
+    C = s.stage_ops[2]
+    i, j, k = s[C].iters
+    io, ii = s.split(C, i, [16])
+    s.parallel(C, io)
+    other = dag.get_init_state()
+
+    target = tvm.target.Target("llvm")
+    task = auto_scheduler.SearchTask(compute_dag=dag, workload_key="test", target=target)
+    get_features = auto_scheduler.feature.get_per_store_features_from_states
+    # The states of the same steps reuse the features, the cached ones are those extracted.
+    cached = get_features([s, other, s], task)
+    assert (cached[0] == cached[2]).all()
+    assert cached[1].shape != cached[0].shape or not (cached[1] == cached[0]).all()
+    auto_scheduler.feature.clear_per_store_feature_cache(task)
+    extracted = get_features([s, other], task)
+    for i in range(2):
+        assert (cached[i] == extracted[i]).all()
+
+
 if __name__ == "__main__":
     test_cpu_matmul()
     test_cpu_fusion()
     test_gpu_feature()
+    test_feature_cache()
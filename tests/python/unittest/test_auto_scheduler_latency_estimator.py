@@ -0,0 +1,90 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+""" Test the latency estimates of the operators. """
+import tempfile
+
+import tvm
+import tvm.testing
+from tvm import auto_scheduler, te
+from tvm.auto_scheduler import latency_estimator
+
+from test_auto_scheduler_common import matmul_auto_scheduler_test
+
+
+def lower_matmul(n, parallel=False):
+    A, B, C = matmul_auto_scheduler_test(n, n, n)
+    s = te.create_schedule(C.op)
+    if parallel:
+        s[C].parallel(C.op.axis[0])
+    return tvm.lower(s, [A, B, C])["main"]
+
+
+def test_measured_record():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(64, 64, 64), target="llvm"
+    )
+    inp = auto_scheduler.MeasureInput(task, task.compute_dag.init_state)
+    slow = auto_scheduler.MeasureResult([0.4, 0.6], 0, "", 0.2, 1)
+    fast = auto_scheduler.MeasureResult([0.1, 0.2], 0, "", 0.2, 1)
+    failed = auto_scheduler.MeasureResult([0.01], 2, "", 0.2, 1)
+
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, [inp, inp, inp], [slow, fast, failed])
+        estimator = auto_scheduler.LatencyEstimator([fp.name])
+
+    func = latency_estimator.with_workload_key(lower_matmul(64), task.workload_key)
+    # The best successful record, of the same target kind.
+    tvm.testing.assert_allclose(estimator.estimate_latency(func, "llvm -mcpu=core-avx2"), 0.15)
+    # The functions without a record fall back to the analytic model.
+    analytic = latency_estimator.analytic_latency(func, "llvm")
+    assert estimator.estimate_latency(lower_matmul(64), "llvm") == analytic
+    assert estimator.estimate_latency(func, "cuda") != 0.15
+
+
+def test_added_record_and_cost_model():
+    estimator = auto_scheduler.LatencyEstimator()
+    func = latency_estimator.with_workload_key(lower_matmul(32), "matmul_32")
+    estimator.add_record("matmul_32", "llvm", 2e-3)
+    estimator.add_record("matmul_32", "llvm", 1e-3)
+    estimator.add_record("matmul_32", "llvm", 5e-3)
+    tvm.testing.assert_allclose(estimator.estimate_latency(func, "llvm"), 1e-3)
+
+    estimator.set_cost_model(lambda f, target: 42.0)
+    assert estimator.estimate_latency(lower_matmul(32), "llvm") == 42.0
+    tvm.testing.assert_allclose(estimator.estimate_latency(func, "llvm"), 1e-3)
+    estimator.set_cost_model(None)
+    assert estimator.estimate_latency(lower_matmul(32), "llvm") != 42.0
+
+
+def test_analytic_latency():
+    small = latency_estimator.analytic_latency(lower_matmul(32), "llvm")
+    large = latency_estimator.analytic_latency(lower_matmul(128), "llvm")
+    assert 0 < small < large
+    # The compute of the large matmul grows with the cube of its size.
+    assert large / small > 16
+
+    serial = latency_estimator.analytic_latency(lower_matmul(128), "llvm")
+    parallel = latency_estimator.analytic_latency(lower_matmul(128, parallel=True), "llvm")
+    # The parallel loop spreads over the cores of the host, when it has several.
+    assert parallel <= serial
+
+
+if __name__ == "__main__":
+    test_measured_record()
+    test_added_record_and_cost_model()
+    test_analytic_latency()
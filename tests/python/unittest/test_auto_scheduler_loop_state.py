@@ -89,6 +89,25 @@ def test_split_fuse_reorder_annotation():
     assert res.annotation == auto_scheduler.loop_state.State.ANNOTATION_TRANS_TABLE["vectorize"]
 
 
+def test_cthread_tensorize_annotation():
+    A, B, C = matmul_auto_scheduler_test(N=512, M=512, K=512)
+    dag = auto_scheduler.ComputeDAG([A, B, C])
+    s0 = dag.get_init_state()
+    i, j, k = s0[C].iters
+    i1, i2 = s0.split(C, i, [2])
+    ko, ki = s0.split(C, k, [16])
+
+    res = s0.bind(C, i1, "cthread")
+    assert res == s0[C].iters[0]
+    assert res.annotation == auto_scheduler.loop_state.State.ANNOTATION_TRANS_TABLE["cthread"]
+
+    # The tensorize pragma names a registered intrinsic, resolved only when building the schedule
+    s0.pragma(C, ki, "tensorize$gemm")
+    assert s0[C].iters[4].annotation == (
+        auto_scheduler.loop_state.State.ANNOTATION_TRANS_TABLE["tensorize"]
+    )
+
+
 def test_compute_at_root_inline():
     dag = auto_scheduler.ComputeDAG(
         conv2d_nchw_bn_relu_auto_scheduler_test(
@@ -516,6 +535,7 @@ def test_rfactor():
 
 if __name__ == "__main__":
     test_split_fuse_reorder_annotation()
+    test_cthread_tensorize_annotation()
     test_compute_at_root_inline()
     test_cache_read_write()
     test_follow_split_follow_fused_split()
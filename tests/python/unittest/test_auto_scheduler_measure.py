@@ -17,6 +17,7 @@
 
 """ Test measurement and log serialization. """
 import json
+import os
 
 import multiprocessing
 import numpy as np
@@ -27,7 +28,7 @@ import tempfile
 import tvm.testing
 import pickle
 from test_auto_scheduler_common import matmul_auto_scheduler_test
-from tvm.auto_scheduler import workload_registry
+from tvm.auto_scheduler import measure_record, workload_registry
 
 
 def record_common(dag, s):
@@ -203,6 +204,82 @@ def test_recover_measure_input():
         assert str(correct_inp.state) == str(inp.state)
 
 
+def test_record_store():
+    tasks = [
+        auto_scheduler.SearchTask(func=matmul_auto_scheduler_test, args=(n, n, n), target="llvm")
+        for n in (64, 128)
+    ]
+    inputs = [auto_scheduler.measure.MeasureInput(t, t.compute_dag.init_state) for t in tasks]
+    results = [
+        auto_scheduler.measure.MeasureResult([cost], error_no, "", 0.2, 1)
+        for cost, error_no in [(0.3, 0), (0.2, 0), (0.01, 2), (0.1, 0)]
+    ]
+    inputs = [inputs[0], inputs[0], inputs[0], inputs[1]]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "records.tvmrec")
+        store = auto_scheduler.RecordStore(path)
+        store.append(inputs[:2], results[:2])
+        # Another writer of the same store.
+        auto_scheduler.RecordStore(path).append(inputs[2:], results[2:])
+        store.reload()
+
+        # The best successful record of each workload, from the index.
+        inp, res = store.best_record(tasks[0].workload_key, "llvm")
+        assert inp.task.workload_key == tasks[0].workload_key
+        tvm.testing.assert_allclose(res.costs[0].value, 0.2)
+        inp, res = auto_scheduler.load_best_record(path, tasks[1].workload_key, tasks[1].target)
+        tvm.testing.assert_allclose(res.costs[0].value, 0.1)
+        assert store.best_record(tasks[0].workload_key, "cuda") == (None, None)
+        assert len(store.best_records()[0]) == 2
+        assert len(list(auto_scheduler.load_records(path))) == 4
+
+        # The index is rebuilt when it is missing.
+        os.remove(path + ".idx")
+        inp, res = auto_scheduler.RecordStore(path).best_record(tasks[0].workload_key, "llvm")
+        tvm.testing.assert_allclose(res.costs[0].value, 0.2)
+
+        # The conversion from and to the json log files keeps the records.
+        log_file = os.path.join(tmpdir, "records.json")
+        measure_record.convert_store_to_records(path, log_file)
+        assert not measure_record.is_record_store(log_file)
+        json_records = list(auto_scheduler.load_records(log_file))
+        assert len(json_records) == 4
+        copy_path = os.path.join(tmpdir, "copy.tvmrec")
+        measure_record.convert_records_to_store(log_file, copy_path)
+        for (inp, res), (copy_inp, copy_res) in zip(
+            json_records, auto_scheduler.load_records(copy_path)
+        ):
+            assert measure_record.dump_record_to_string(
+                inp, res
+            ) == measure_record.dump_record_to_string(copy_inp, copy_res)
+
+
+def test_record_store_torn_tail():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(64, 64, 64), target="llvm"
+    )
+    inp = auto_scheduler.measure.MeasureInput(task, task.compute_dag.init_state)
+    results = [auto_scheduler.measure.MeasureResult([cost], 0, "", 0.2, 1) for cost in (0.3, 0.2)]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = os.path.join(tmpdir, "records.tvmrec")
+        store = auto_scheduler.RecordStore(path)
+        store.append([inp], results[:1])
+        files = [path, path + ".idx"]
+        sizes = [os.path.getsize(f) for f in files]
+        # A writer killed while appending leaves the first bytes of a record and of its entry.
+        store.append([inp], results[1:])
+        for f, size in zip(files, sizes):
+            os.truncate(f, size + 6)
+
+        auto_scheduler.RecordStore(path).append([inp], results[1:])
+        records = list(auto_scheduler.load_records(path))
+        tvm.testing.assert_allclose([res.costs[0].value for _, res in records], [0.3, 0.2])
+        _, res = auto_scheduler.RecordStore(path).best_record(task.workload_key, "llvm")
+        tvm.testing.assert_allclose(res.costs[0].value, 0.2)
+
+
 def test_workload_dis_factor():
     calc = auto_scheduler.utils.calc_workload_dis_factor
     decode = auto_scheduler.utils.decode_workload_key
@@ -317,6 +394,30 @@ def test_measure_local_builder_rpc_runner():
         del measure_ctx
 
 
+@tvm.testing.requires_llvm
+def test_measure_pipelined_rpc_runner():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(128, 128, 128), target="llvm"
+    )
+    minps = [auto_scheduler.MeasureInput(task, task.compute_dag.init_state) for _ in range(4)]
+    local_builder = auto_scheduler.LocalBuilder(n_parallel=2)
+    measure_ctx = auto_scheduler.LocalRPCMeasureContext(n_parallel=2, timeout=60)
+    rpc_runner = measure_ctx.runner
+
+    # the builds do not wait for the runs, the results keep the order of the inputs
+    log_file = tempfile.NamedTemporaryFile().name
+    measurer = auto_scheduler.measure.ProgramMeasurer(
+        local_builder, rpc_runner, [auto_scheduler.RecordToFile(log_file)], 0, -1
+    )
+    policy = auto_scheduler.EmptyPolicy(task)
+    mress = auto_scheduler._ffi_api.ProgramMeasurerMeasure(measurer, task, policy, minps, 3)
+    assert len(mress) == len(minps)
+    assert all(res.error_no == 0 for res in mress)
+    assert len(list(auto_scheduler.load_records(log_file))) == len(minps)
+
+    del measure_ctx
+
+
 def measure_local_builder_rpc_runner_spawn():
     assert multiprocessing.get_start_method(False) == "spawn"
     test_measure_local_builder_rpc_runner()
@@ -330,6 +431,55 @@ def test_measure_local_builder_rpc_runner_spawn():
     p.join()
 
 
+@tvm.testing.requires_llvm
+def test_measure_cache():
+    task = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(64, 64, 64), target="llvm"
+    )
+    C = task.compute_dag.tensors[-1]
+    states = []
+    for factor in (4, 8, 16):
+        s = task.compute_dag.get_init_state()
+        s.split(C, s[C].iters[0], [factor])
+        states.append(s)
+    inputs = [auto_scheduler.measure.MeasureInput(task, s) for s in states]
+    results = [
+        auto_scheduler.measure.MeasureResult([0.123], 0, "", 0.2, 1),
+        auto_scheduler.measure.MeasureResult([1e10], 2, "", 0.2, 1),
+        auto_scheduler.measure.MeasureResult([1e10], 4, "", 0.2, 1),
+    ]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        cache_file = os.path.join(tmpdir, "cache.json")
+        auto_scheduler.save_records(cache_file, inputs, results)
+        log_file = os.path.join(tmpdir, "log.json")
+        measurer = auto_scheduler.measure.ProgramMeasurer(
+            auto_scheduler.LocalBuilder(),
+            auto_scheduler.LocalRunner(timeout=60),
+            [auto_scheduler.RecordToFile(log_file)],
+            0,
+            cache_file=cache_file,
+        )
+        policy = auto_scheduler.EmptyPolicy(task)
+        measure_inputs = inputs + [inputs[2]]
+        res = auto_scheduler._ffi_api.ProgramMeasurerMeasure(
+            measurer, task, policy, measure_inputs, -1
+        )
+
+        # The success and the build failure take their known results, the runtime error
+        # and its duplicate are measured once.
+        tvm.testing.assert_allclose(res[0].costs[0].value, 0.123)
+        assert res[1].error_no == 2
+        assert res[2].error_no == 0 and res[3].error_no == 0
+        assert res[3].costs[0].value == res[2].costs[0].value
+        assert len(list(auto_scheduler.load_records(log_file))) == 1
+
+        # The new result is kept in the cache of the measurer too.
+        res = auto_scheduler._ffi_api.ProgramMeasurerMeasure(measurer, task, policy, inputs[2:], -1)
+        assert res[0].error_no == 0
+        assert len(list(auto_scheduler.load_records(log_file))) == 1
+
+
 @tvm.testing.requires_llvm
 def test_measure_target_host():
     task = auto_scheduler.SearchTask(
@@ -420,10 +570,14 @@ if __name__ == "__main__":
     test_record_follow_split_follow_fused_split()
     test_record_pragma_storage_align_rfactor()
     test_recover_measure_input()
+    test_record_store()
+    test_record_store_torn_tail()
     test_workload_dis_factor()
     test_measure_local_builder_runner()
     test_dag_measure_local_builder_runner()
     test_measure_local_builder_rpc_runner()
+    test_measure_pipelined_rpc_runner()
+    test_measure_cache()
     test_measure_target_host()
     test_measure_special_inputs_map_by_name_local_runner()
     test_measure_special_inputs_map_by_name_rpc_runner()
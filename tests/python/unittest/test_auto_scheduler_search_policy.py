@@ -209,6 +209,37 @@ def test_sketch_search_policy_custom_sketch():
     )
 
 
+@tvm.testing.requires_llvm
+def test_sketch_search_policy_preload_similar_task():
+    small = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(64, 64, 64), target="llvm"
+    )
+    large = auto_scheduler.SearchTask(
+        func=matmul_auto_scheduler_test, args=(96, 96, 96), target="llvm"
+    )
+    states = auto_scheduler.SketchPolicy(small, verbose=0).sample_initial_population()[:4]
+    inputs = [auto_scheduler.MeasureInput(small, s) for s in states]
+    results = [
+        auto_scheduler.MeasureResult([0.1 * (i + 1)], 0, "", 0.1, 0) for i in range(len(inputs))
+    ]
+
+    with tempfile.NamedTemporaryFile() as fp:
+        auto_scheduler.save_records(fp.name, inputs, results)
+        policy = auto_scheduler.SketchPolicy(
+            large,
+            init_search_callbacks=[auto_scheduler.PreloadSimilarTaskStates(fp.name, 2)],
+            verbose=0,
+        )
+    measurer = auto_scheduler.measure.ProgramMeasurer(
+        auto_scheduler.LocalBuilder(), auto_scheduler.LocalRunner(), [], 0
+    )
+    inputs, results = policy.continue_search_one_round(2, measurer)
+
+    # The fastest record of the small matmul is adapted and measured first.
+    assert len(inputs[0].state.transform_steps) == len(states[0].transform_steps)
+    assert results[0].error_no == 0
+
+
 if __name__ == "__main__":
     test_workload_registry_empty_policy()
     test_sketch_search_policy_basic()
@@ -218,3 +249,4 @@ if __name__ == "__main__":
     test_sketch_search_policy_cuda_xgbmodel_rpc_runner()
     test_sketch_search_policy_zero_rank()
     test_sketch_search_policy_custom_sketch()
+    test_sketch_search_policy_preload_similar_task()
@@ -23,7 +23,7 @@ import tvm.testing
 
 import pytest
 
-from tvm import te, auto_scheduler
+from tvm import te, topi, auto_scheduler
 from tvm.auto_scheduler import _ffi_api
 from tvm.auto_scheduler.loop_state import Stage
 
@@ -310,6 +310,89 @@ def test_cpu_custom_sketch():
     assert sketches[1].stages[2].iters[4].range.extent == 512
 
 
+@auto_scheduler.register_workload
+def sparse_dense_bsr_auto_scheduler_test(M, N, K, BS_R, BS_C, num_blocks):
+    X = te.placeholder((M, K), name="X")
+    W_data = te.placeholder((num_blocks, BS_R, BS_C), name="W_data")
+    W_indices = te.placeholder((num_blocks,), name="W_indices", dtype="int32")
+    W_indptr = te.placeholder((N // BS_R + 1,), name="W_indptr", dtype="int32")
+    out = topi.nn.sparse_dense(X, W_data, W_indices, W_indptr)
+    return [X, W_data, W_indices, W_indptr, out]
+
+
+def test_cpu_sparse_dense_sketch():
+    sketches = generate_sketches(
+        sparse_dense_bsr_auto_scheduler_test,
+        (128, 256, 512, 16, 1, 1024),
+        "llvm",
+        init_search_callbacks=[auto_scheduler.sparse_tuning.sparse_dense_sketch_rule()],
+    )
+    """ 1 sketch tiling the blocks and the rows, computed at the output """
+    assert len(sketches) == 1
+    assert_compute_at_condition(sketches[0].stages[4], "iter")
+    assert_compute_at_condition(sketches[0].stages[5], "root")
+
+
+@auto_scheduler.register_workload
+def dense_int8_auto_scheduler_test(N, M, K, data_dtype, kernel_dtype, out_dtype):
+    A = te.placeholder((N, K), name="A", dtype=data_dtype)
+    B = te.placeholder((M, K), name="B", dtype=kernel_dtype)
+    k = te.reduce_axis((0, K), name="k")
+    C = te.compute(
+        (N, M),
+        lambda i, j: te.sum(A[i, k].astype(out_dtype) * B[j, k].astype(out_dtype), axis=k),
+        name="C",
+    )
+    return [A, B, C]
+
+
+def get_tensorized_iters(state, stage_id):
+    tensorize = auto_scheduler.loop_state.State.ANNOTATION_TRANS_TABLE["tensorize"]
+    return [it for it in state.stages[stage_id].iters if it.annotation == tensorize]
+
+
+def test_cpu_micro_kernel_sketch():
+    vnni = ("uint8", "int8", "int32")
+    sdot = ("int8", "int8", "int32")
+    for target, dtypes, lanes in [
+        ("llvm -mcpu=cascadelake", vnni, 16),
+        ("llvm -mtriple=aarch64-linux-gnu -mattr=+neon,+dotprod", sdot, 4),
+    ]:
+        sketches = generate_sketches(dense_int8_auto_scheduler_test, (64, 64, 64) + dtypes, target)
+        """ 1 micro-kernel sketch + the 3 multi-level tiling sketches """
+        assert len(sketches) == 4
+        tensorized = [get_tensorized_iters(s, 2) for s in sketches if get_tensorized_iters(s, 2)]
+        assert len(tensorized) == 1
+        assert len(tensorized[0]) == 1 and tensorized[0][0].range.extent == lanes
+
+    # Without the instructions, or with the wrong operand types, there is no micro-kernel
+    for target, dtypes in [("llvm", vnni), ("llvm -mcpu=cascadelake", sdot)]:
+        sketches = generate_sketches(dense_int8_auto_scheduler_test, (64, 64, 64) + dtypes, target)
+        assert len(sketches) == 3
+    # Nor when the block does not divide the axes
+    sketches = generate_sketches(
+        dense_int8_auto_scheduler_test, (64, 60, 64) + vnni, "llvm -mcpu=cascadelake"
+    )
+    assert len(sketches) == 3
+
+
+@tvm.testing.requires_llvm
+def test_cpu_micro_kernel_lower():
+    target = "llvm -mcpu=cascadelake"
+    task = auto_scheduler.SearchTask(
+        func=dense_int8_auto_scheduler_test,
+        args=(64, 64, 64, "uint8", "int8", "int32"),
+        target=target,
+        hardware_params=auto_scheduler.HardwareParams(num_cores=4, target=target),
+    )
+    policy = auto_scheduler.SketchPolicy(task, verbose=0)
+    states = [s for s in policy.sample_initial_population() if get_tensorized_iters(s, 2)]
+    assert states
+    sch, args = task.compute_dag.apply_steps_from_state(states[0])
+    # The block is computed by the VNNI instruction
+    assert "call_llvm_pure_intrin" in str(tvm.lower(sch, args, simple_mode=True))
+
+
 @tvm.testing.requires_cuda
 def test_cuda_matmul_sketch():
     sketches = generate_sketches(matmul_auto_scheduler_test, (512, 512, 512), "cuda")
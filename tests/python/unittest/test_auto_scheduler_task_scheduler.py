@@ -16,6 +16,7 @@
 # under the License.
 """ Test task scheduler """
 
+import os
 import tempfile
 
 import multiprocessing
@@ -139,7 +140,59 @@ def test_task_scheduler_gradient():
         del measure_ctx
 
 
+@tvm.testing.requires_llvm
+def test_cluster_task_scheduler():
+    def make_tasks(sizes):
+        return [
+            auto_scheduler.SearchTask(
+                func=matmul_auto_scheduler_test, args=(n, n, n), target="llvm"
+            )
+            for n in sizes
+        ]
+
+    # The 4x4 matmul is shared by the two models.
+    models = [(make_tasks([2, 4]), [1, 2]), (make_tasks([4, 8]), [3, 1])]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        store = os.path.join(tmpdir, "records.tvmrec")
+        measure_ctx = auto_scheduler.LocalRPCMeasureContext()
+        task_scheduler = auto_scheduler.ClusterTaskScheduler(
+            models,
+            model_weights=[1, 2],
+            record_store=store,
+            host="127.0.0.1",
+            port=measure_ctx.tracker.port,
+            strategy="round-robin",
+            callbacks=[],
+        )
+        assert len(task_scheduler.tasks) == 3
+        # The weight of a task is its weight in all models.
+        assert task_scheduler.objective_func([1, 0, 0]) == 1
+        assert task_scheduler.objective_func([0, 1, 0]) == 2 + 2 * 3
+        assert task_scheduler.objective_func([0, 0, 1]) == 2
+
+        tune_option = auto_scheduler.TuningOptions(num_measure_trials=3, num_measures_per_round=1)
+        task_scheduler.tune(tune_option, search_policy="sketch.random")
+
+        # The measurements are shared through the store.
+        counters = {t.workload_key: 0 for t in task_scheduler.tasks}
+        for inp, _ in auto_scheduler.load_records(store):
+            counters[inp.task.workload_key] += 1
+        assert all(ct == 1 for ct in counters.values())
+        latencies = task_scheduler.model_latencies()
+        assert len(latencies) == 2 and all(0 < x < 1e9 for x in latencies)
+
+        # Another scheduler restores the status from the store.
+        task_scheduler = auto_scheduler.ClusterTaskScheduler(
+            models, record_store=store, callbacks=[]
+        )
+        task_scheduler._restore_status(store, 1)
+        assert all(ct == 1 for ct in task_scheduler.task_cts)
+        del measure_ctx
+
+
 if __name__ == "__main__":
     test_task_scheduler_round_robin()
     test_task_scheduler_round_robin_spawn()
     test_task_scheduler_gradient()
+    test_cluster_task_scheduler()
@@ -130,7 +130,29 @@ def test_feature_shape():
             )
 
 
+def test_itervar_feature_batch():
+    def gemm_schedule(n, factor):
+        k = te.reduce_axis((0, n), "k")
+        A = te.placeholder((n, n), name="A")
+        B = te.placeholder((n, n), name="B")
+        C = te.compute(A.shape, lambda y, x: te.sum(A[y, k] * B[k, x], axis=k), name="C")
+        s = te.create_schedule(C.op)
+        y, x = s[C].op.axis
+        yo, yi = s[C].split(y, factor)
+        s[C].reorder(yo, x, yi)
+        return s, [A, B, C]
+
+    schedules = [gemm_schedule(n, factor) for n in (64, 128) for factor in (4, 8, 16)]
+    batch = feature.get_itervar_feature_flatten_batch(schedules, take_log=True)
+    assert len(batch) == len(schedules)
+    for (s, args), fea in zip(schedules, batch):
+        single = feature.get_itervar_feature_flatten(s, args, take_log=True)
+        np.testing.assert_allclose(fea, single, rtol=1e-6)
+    assert feature.get_itervar_feature_flatten_batch([]) == []
+
+
 if __name__ == "__main__":
     test_iter_feature_gemm()
     test_curve_feature_gemm()
     test_feature_shape()
+    test_itervar_feature_batch()
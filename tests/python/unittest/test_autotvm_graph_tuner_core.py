@@ -20,6 +20,7 @@
 # helps avoid topi arithmetic operator overloading issue:
 # https://github.com/apache/tvm/issues/3240.
 # TODO: restore the file name after this issue is resolved.
+import itertools
 import os
 import copy
 import numpy as np
@@ -31,7 +32,7 @@ from tvm import autotvm
 from tvm import relay
 from tvm.autotvm.task import ConfigEntity
 from tvm.autotvm.measure import MeasureResult, MeasureInput
-from tvm.autotvm.graph_tuner import DPTuner, PBQPTuner
+from tvm.autotvm.graph_tuner import DPTuner, PBQPTuner, LayoutPlanTuner
 
 
 def _create_args(dshape, kshape, strides, padding, dilation, layout, out_layout, dtype, out_dtype):
@@ -251,6 +252,12 @@ def test_DPTuner_run():
     )
     assert os.path.isfile(log_file), "No log file with name %s exists." % log_file
 
+    # The native solver finds the same plan
+    executor = DPTuner(mod, {"data": dshape}, records, target_ops, target, log_file=log_file)
+    executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
+    executor.run(use_native=True)
+    assert expected_out == [record[0].config for record in executor.get_optimal_records()]
+
 
 def test_PBQPTuner_run():
     target = "llvm"
@@ -301,15 +308,16 @@ def test_PBQPTuner_run():
         ms_output = MeasureResult(costs=(cost,), error_no=0, all_cost=-1, timestamp=-1)
         records.append((ms_input, ms_output))
 
-    executor = PBQPTuner(g, {"data": dshape}, records, target_ops, target)
-    executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
-    executor.run()
-    out = [record[0].config for record in executor.get_optimal_records()]
     expected_out = [records[3][0].config, records[1][0].config, records[2][0].config]
-    assert expected_out == out, "Output mismatch: expecting %s but got %s" % (
-        str(expected_out),
-        str(out),
-    )
+    for use_native in [True, False]:
+        executor = PBQPTuner(g, {"data": dshape}, records, target_ops, target)
+        executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
+        executor.run(use_native=use_native)
+        out = [record[0].config for record in executor.get_optimal_records()]
+        assert expected_out == out, "Output mismatch: expecting %s but got %s" % (
+            str(expected_out),
+            str(out),
+        )
 
 
 def test_many_sub_graphs():
@@ -473,6 +481,16 @@ def test_many_sub_graphs():
         str(out),
     )
 
+    executor = LayoutPlanTuner(net, {"data": dshape}, records, target_ops, target)
+    executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
+    executor.run()
+    out = [record[0].config for record in executor.get_optimal_records()]
+    expected_out = [records[3][0].config, records[1][0].config, records[2][0].config]
+    assert expected_out == out, "Output mismatch: expecting %s but got %s" % (
+        str(expected_out),
+        str(out),
+    )
+
 
 def test_tuple():
     target = "llvm"
@@ -585,6 +603,16 @@ def test_tuple():
         str(out),
     )
 
+    executor = LayoutPlanTuner(net, {"data": dshape}, records, target_ops, target)
+    executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
+    executor.run()
+    out = [record[0].config for record in executor.get_optimal_records()]
+    expected_out = [records[2][0].config, records[1][0].config]
+    assert expected_out == out, "Output mismatch: expecting %s but got %s" % (
+        str(expected_out),
+        str(out),
+    )
+
 
 def test_triangle_block():
     target = "llvm"
@@ -732,6 +760,53 @@ def test_triangle_block():
         str(out),
     )
 
+    executor = LayoutPlanTuner(net, {"data": dshape}, records, target_ops, target)
+    executor.benchmark_layout_transform(layout_records=ltf_records, infer_layout=True)
+    executor.run()
+    out = [record[0].config for record in executor.get_optimal_records()]
+    expected_out = [records[3][0].config, records[1][0].config, records[2][0].config]
+    assert expected_out == out, "Output mismatch: expecting %s but got %s" % (
+        str(expected_out),
+        str(out),
+    )
+
+
+def test_solve_layout_plan():
+    rng = np.random.RandomState(0)
+    num_candidates = [3, 2, 4, 3, 2]
+    edges = [(0, 1), (1, 2), (0, 2), (2, 3), (3, 4), (1, 4)]
+    node_costs = [rng.uniform(size=n) for n in num_candidates]
+    edge_costs = [rng.uniform(size=(num_candidates[u], num_candidates[v])) for u, v in edges]
+
+    def total(choices):
+        cost = sum(node_costs[i][c] for i, c in enumerate(choices))
+        for (u, v), matrix in zip(edges, edge_costs):
+            cost += matrix[choices[u]][choices[v]]
+        return cost
+
+    # The graph reduces to nodes of degree at most two, so that the plan is optimal
+    choices = relay.analysis.solve_layout_plan(node_costs, edges, edge_costs)
+    best = min(itertools.product(*[range(n) for n in num_candidates]), key=total)
+    assert np.isclose(total(choices), total(best))
+
+
+def test_solve_layout_plan_large_chain():
+    rng = np.random.RandomState(0)
+    num_nodes, num_candidates = 2000, 8
+    node_costs = [rng.uniform(size=num_candidates) for _ in range(num_nodes)]
+    edges = [(i, i + 1) for i in range(num_nodes - 1)]
+    edge_costs = [rng.uniform(size=(num_candidates, num_candidates)) for _ in edges]
+
+    # The exact plan of a chain by dynamic programming
+    best = node_costs[0]
+    for i, matrix in enumerate(edge_costs):
+        best = np.min(best[:, None] + matrix, axis=0) + node_costs[i + 1]
+
+    choices = relay.analysis.solve_layout_plan(node_costs, edges, edge_costs)
+    total = sum(node_costs[i][c] for i, c in enumerate(choices))
+    total += sum(matrix[choices[i], choices[i + 1]] for i, matrix in enumerate(edge_costs))
+    assert np.isclose(total, np.min(best))
+
 
 if __name__ == "__main__":
     test_graph_tuner_layout_transform()
@@ -740,3 +815,5 @@ if __name__ == "__main__":
     test_many_sub_graphs()
     test_tuple()
     test_triangle_block()
+    test_solve_layout_plan()
+    test_solve_layout_plan_large_chain()
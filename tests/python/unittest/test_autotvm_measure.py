@@ -17,15 +17,18 @@
 """Test builder and runner"""
 import logging
 import multiprocessing
+import os
+import tempfile
 import time
 
 import numpy as np
 
 import tvm
+import tvm.testing
 from tvm import te
 from test_autotvm_common import DummyRunner, bad_matmul, get_sample_task
 from tvm import autotvm
-from tvm.autotvm.measure.measure import MeasureErrorNo, MeasureResult
+from tvm.autotvm.measure.measure import MeasureErrorNo, MeasureInput, MeasureResult
 
 
 def test_task_tuner_without_measurement():
@@ -60,8 +63,71 @@ def test_task_tuner_without_measurement_spawn():
     p.join()
 
 
+@tvm.testing.requires_llvm
+def test_local_builder_cache():
+    task, target = get_sample_task()
+    inputs = [MeasureInput(target, task, task.config_space.get(i)) for i in (0, 1, 0)]
+
+    with tempfile.TemporaryDirectory() as cache_dir:
+        builder = autotvm.LocalBuilder(cache_dir=cache_dir)
+        builder.set_task(task)
+        results = builder.build(inputs)
+        assert all(res.error is None for res in results)
+        # The same config gives the same lowered IR, built once.
+        assert results[0].filename == results[2].filename
+        assert results[0].filename != results[1].filename
+        assert len(os.listdir(cache_dir)) == 2
+
+        # Another builder of the same cache takes the libraries built before.
+        builder = autotvm.LocalBuilder(cache_dir=cache_dir)
+        builder.set_task(task)
+        assert builder.build(inputs[:1])[0].filename == results[0].filename
+        assert len(os.listdir(cache_dir)) == 2
+
+
+def test_adaptive_repeat():
+    from tvm.autotvm.measure.measure_methods import AdaptiveRepeat, _run_adaptive_repeat
+
+    calls = []
+
+    def make_time_f(cost):
+        def _make(n_repeat):
+            def _time_f(*args):  # pylint: disable=unused-argument
+                calls.append(n_repeat)
+                return tvm.runtime.module.ProfileResult(cost, [cost] * n_repeat)
+
+            return _time_f
+
+        return _make
+
+    # Clearly slower than the reference: only the first repeat runs.
+    adaptive = AdaptiveRepeat(stop_cost=2.0, best_cost=1.0, max_repeat=10)
+    assert _run_adaptive_repeat(adaptive, [], 3, make_time_f(5.0)) == (5.0,)
+    assert calls == [1]
+    # A close contender of the best cost gets max_repeat repeats.
+    calls.clear()
+    assert len(_run_adaptive_repeat(adaptive, [], 3, make_time_f(1.05))) == 10
+    assert calls == [1, 9]
+    # The others get the usual repeats.
+    calls.clear()
+    assert len(_run_adaptive_repeat(adaptive, [], 3, make_time_f(1.5))) == 3
+    assert calls == [1, 2]
+
+    runner = autotvm.RPCRunner("key", "host", 9190, early_stop_ratio=3, max_repeat=10)
+    assert runner.get_adaptive_repeat() is None
+    runner.measured_costs = [1.0, 2.0, 4.0]
+    adaptive = runner.get_adaptive_repeat()
+    assert adaptive.best_cost == 1.0 and adaptive.max_repeat == 10
+    np.testing.assert_allclose(adaptive.stop_cost, 3 * np.percentile([1.0, 2.0, 4.0], 10))
+    runner = autotvm.RPCRunner("key", "host", 9190)
+    runner.measured_costs = [1.0]
+    assert runner.get_adaptive_repeat() is None
+
+
 if __name__ == "__main__":
     logging.basicConfig(level=logging.INFO)
 
     test_task_tuner_without_measurement()
     test_task_tuner_without_measurement_spawn()
+    test_local_builder_cache()
+    test_adaptive_repeat()
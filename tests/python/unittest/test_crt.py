@@ -224,6 +224,14 @@ def test_platform_timer():
         assert result.mean > 0
         assert len(result.results) == 3
 
+        # the repeats until the steady state also run on the device
+        time_eval_f = lib.time_evaluator(
+            "myexpf", sess.device, number=200, repeat=3, max_repeat=20, cv_threshold=0.5
+        )
+        result = time_eval_f(A_data, B_data)
+        assert result.mean > 0
+        assert len(result.results) == 3
+
 
 if __name__ == "__main__":
     test_graph_executor()
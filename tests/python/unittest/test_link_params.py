@@ -346,6 +346,49 @@ def test_c_link_params():
             np.testing.assert_allclose(unlinked_output.numpy(), linked_output.numpy())
 
 
+def test_c_link_params_raw():
+    temp_dir = utils.tempdir()
+    for dtype in LINKABLE_DTYPES:
+        mod, param_init = _make_mod_and_params(dtype)
+        rand_input = _make_random_tensor(dtype, INPUT_SHAPE)
+        target = "c --link-params --link-params-raw"
+        with tvm.transform.PassContext(opt_level=3, config={"tir.disable_vectorize": True}):
+            lib = tvm.relay.build(mod, target, params=param_init)
+            src = lib.lib.get_source()
+            param = lib.params["p0"].numpy()
+            # The raw bytes of the param, plus the terminating null of the literal.
+            param_def = f"static const uint8_t __tvm_param__p0[{param.nbytes + 1}]"
+            assert param_def in src, f'did not find parameter definition "{param_def}":\n{src}'
+
+            lib_path = temp_dir.relpath(f"test-{dtype}-raw-linked.so")
+            lib["remove_params"]().export_library(lib_path)
+            lib_mod = tvm.runtime.load_module(lib_path)
+            graph = json.loads(lib.graph_json)
+            for p in lib.params:
+                _verify_linked_param(dtype, lib, lib_mod, graph, p)
+
+            graph_rt = tvm.contrib.graph_executor.GraphModule(lib_mod["default"](tvm.cpu(0)))
+            graph_rt.set_input("rand_input", rand_input)
+            graph_rt.run()
+            linked_output = graph_rt.get_output(0).numpy()
+
+        with tvm.transform.PassContext(opt_level=3, config={"tir.disable_vectorize": True}):
+            lib = tvm.relay.build(mod, "c", params=param_init)
+            _, _, params = lib
+            lib_path = temp_dir.relpath(f"test-{dtype}-raw-unlinked.so")
+            lib.export_library(lib_path)
+            lib_mod = tvm.runtime.load_module(lib_path)
+            graph_rt = tvm.contrib.graph_executor.GraphModule(lib_mod["default"](tvm.cpu(0)))
+            graph_rt.set_input("rand_input", rand_input, **params)
+            graph_rt.run()
+            unlinked_output = graph_rt.get_output(0).numpy()
+
+        if "int" in dtype:
+            np.testing.assert_equal(unlinked_output, linked_output)
+        else:
+            np.testing.assert_allclose(unlinked_output, linked_output)
+
+
 @tvm.testing.requires_micro
 def test_crt_link_params():
     import tvm.micro
@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 import pytest
 from tvm import te
@@ -160,6 +161,25 @@ def test_dict():
     assert set(dir(x.__class__)) <= set(dir(x))
 
 
+def test_saveload_binary(tmp_path):
+    x = tvm.relay.var("x", shape=(4, 8), dtype="float32")
+    w = tvm.relay.const(np.random.uniform(size=(4, 8)).astype("float32"))
+    b = tvm.relay.const(np.arange(8, dtype="int64"))
+    func = tvm.relay.Function([x], tvm.relay.Tuple([x * w + w, b]))
+    mod = tvm.IRModule.from_expr(func)
+    blob = tvm.ir.save_binary(mod)
+    tvm.ir.assert_structural_equal(tvm.ir.load_binary(blob), mod)
+
+    path = tmp_path / "mod.bin"
+    path.write_bytes(blob)
+    loaded = tvm.ir.load_binary_file(str(path))
+    tvm.ir.assert_structural_equal(loaded, mod)
+    const = loaded["main"].body.fields[1]
+    np.testing.assert_equal(const.data.numpy(), b.data.numpy())
+    # The binary format agrees with the json one.
+    tvm.ir.assert_structural_equal(tvm.ir.load_json(tvm.ir.save_json(loaded)), mod)
+
+
 if __name__ == "__main__":
     test_string()
     test_env_func()
@@ -19,6 +19,8 @@ import tvm.testing
 from tvm import te, runtime
 import numpy as np
 import json
+import pytest
+import threading
 from tvm import rpc
 from tvm import relay
 from tvm.contrib import utils, graph_executor
@@ -139,6 +141,256 @@ def test_load_unexpected_params():
     rt_mod.load_params(runtime.save_param_dict(new_params))
 
 
+@tvm.testing.requires_llvm
+def test_run_parallel():
+    # Independent branches, joined at the end
+    x = relay.var("x", shape=(1, 16))
+    branches = [relay.exp(relay.add(x, relay.const(float(i)))) for i in range(4)]
+    out = relay.concatenate([relay.nn.relu(b) for b in branches], axis=1)
+    mod = tvm.IRModule.from_expr(relay.Function([x], out))
+    with tvm.transform.PassContext(opt_level=0):
+        lib = relay.build(mod, target="llvm")
+    a = np.random.uniform(size=(1, 16)).astype("float32")
+    ref = np.concatenate([np.maximum(np.exp(a + i), 0) for i in range(4)], axis=1)
+
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.set_num_workers(4)
+    for _ in range(3):
+        gmod.run(x=a)
+        tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+    gmod.run_async(x=a)
+    gmod.wait()
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+    gmod.set_num_workers(2, 1)
+    gmod.run(x=a)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+
+
+@tvm.testing.parametrize_targets("llvm", "cuda")
+def test_run_multi_stream(target, dev):
+    # Independent branches on their own streams, joined at the end
+    x = relay.var("x", shape=(1, 16))
+    branches = [relay.exp(relay.add(x, relay.const(float(i)))) for i in range(4)]
+    out = relay.concatenate([relay.nn.relu(b) for b in branches], axis=1)
+    mod = tvm.IRModule.from_expr(relay.Function([x], out))
+    with tvm.transform.PassContext(opt_level=0):
+        lib = relay.build(mod, target=target)
+    a = np.random.uniform(size=(1, 16)).astype("float32")
+    ref = np.concatenate([np.maximum(np.exp(a + i), 0) for i in range(4)], axis=1)
+
+    gmod = graph_executor.GraphModule(lib["default"](dev))
+    gmod.set_num_streams(3)
+    for _ in range(3):
+        gmod.run(x=a)
+        tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+    gmod.set_num_streams(1)
+    gmod.run(x=a)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+
+
+@tvm.testing.requires_llvm
+def test_create_shared():
+    x = relay.var("x", shape=(1, 16))
+    w = relay.var("w", shape=(8, 16))
+    mod = tvm.IRModule.from_expr(relay.Function([x, w], relay.nn.relu(relay.nn.dense(x, w))))
+    w_np = np.random.uniform(size=(8, 16)).astype("float32")
+    lib = relay.build(mod, target="llvm", params={"w": w_np})
+    dev = tvm.cpu(0)
+    instances = [graph_executor.GraphModule(lib["create_shared"](dev)) for _ in range(3)]
+    # The weights are shared between the instances
+    (param_name,) = lib.get_params().keys()
+    weights = [m.get_input(param_name) for m in instances]
+    assert len(set(w.handle.contents.data for w in weights)) == 1
+    inputs = [np.random.uniform(size=(1, 16)).astype("float32") for _ in instances]
+    for m, a in zip(instances, inputs):
+        m.set_input("x", a)
+    for m in instances:
+        m.run()
+    for m, a in zip(instances, inputs):
+        ref = np.maximum(a.dot(w_np.T), 0)
+        tvm.testing.assert_allclose(m.get_output(0).numpy(), ref, rtol=1e-5)
+
+
+@tvm.testing.requires_llvm
+def test_batching_executor():
+    from tvm.contrib import batching_executor
+
+    w_np = np.random.uniform(size=(8, 16)).astype("float32")
+    libs = {}
+    for batch_size in [1, 2, 4]:
+        x = relay.var("x", shape=(batch_size, 16))
+        w = relay.var("w", shape=(8, 16))
+        mod = tvm.IRModule.from_expr(relay.Function([x, w], relay.nn.relu(relay.nn.dense(x, w))))
+        libs[batch_size] = relay.build(mod, target="llvm", params={"w": w_np})
+    executor = batching_executor.BatchingExecutor(
+        libs, tvm.cpu(0), deadline_ms=50.0, num_instances=2
+    )
+    inputs = [np.random.uniform(size=(1, 16)).astype("float32") for _ in range(7)]
+    refs = [np.maximum(a.dot(w_np.T), 0) for a in inputs]
+
+    (out,) = executor.run(x=inputs[0])
+    tvm.testing.assert_allclose(out.numpy(), refs[0], rtol=1e-5)
+
+    # The requests are batched, padded into the nearest batch size and scattered back
+    done = threading.Semaphore(0)
+    results = {}
+
+    def callback(i):
+        def f(outputs, error):
+            results[i] = (outputs[0].numpy() if outputs else None, error)
+            done.release()
+
+        return f
+
+    for i, a in enumerate(inputs):
+        executor.submit(callback(i), x=a)
+    for _ in inputs:
+        done.acquire()
+    for i, ref in enumerate(refs):
+        out, error = results[i]
+        assert error == ""
+        tvm.testing.assert_allclose(out, ref, rtol=1e-5)
+
+    # A request of a wrong shape fails its batch
+    with pytest.raises(tvm.TVMError):
+        executor.run(x=np.zeros((1, 8), "float32"))
+
+
+@tvm.testing.requires_llvm
+def test_load_params_from_file():
+    x = relay.var("x", shape=(1, 16))
+    w = relay.var("w", shape=(8, 16))
+    b = relay.var("b", shape=(8,))
+    func = relay.Function([x, w, b], relay.nn.bias_add(relay.nn.dense(x, w), b))
+    mod = tvm.IRModule.from_expr(func)
+    params = {
+        "w": np.random.uniform(size=(8, 16)).astype("float32"),
+        "b": np.random.uniform(size=(8,)).astype("float32"),
+    }
+    lib = relay.build(mod, target="llvm", params=params)
+    param_bytes = runtime.save_param_dict(lib.get_params(), alignment=128)
+    loaded = runtime.load_param_dict(param_bytes)
+    for name, value in lib.get_params().items():
+        np.testing.assert_equal(loaded[name].numpy(), value.numpy())
+
+    temp = utils.tempdir()
+    path = temp.relpath("params.bin")
+    with open(path, "wb") as param_file:
+        param_file.write(param_bytes)
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.load_params_from_file(path)
+    a = np.random.uniform(size=(1, 16)).astype("float32")
+    gmod.run(x=a)
+    ref = a.dot(params["w"].T) + params["b"]
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), ref, rtol=1e-5)
+
+
+@tvm.testing.requires_llvm
+def test_set_inputs_get_outputs():
+    x = relay.var("x", shape=(1, 10))
+    y = relay.var("y", shape=(1, 10))
+    mod = tvm.IRModule.from_expr(relay.Function([x, y], relay.Tuple([x + y, x * y])))
+    lib = relay.build(mod, target="llvm")
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.set_input_staging(2)
+    a = np.random.uniform(size=(1, 10)).astype("float32")
+    b = np.random.uniform(size=(1, 10)).astype("float32")
+    gmod.set_inputs({"x": a, 1: tvm.nd.array(b)})
+    gmod.run()
+    add, mul = gmod.get_outputs()
+    tvm.testing.assert_allclose(add.numpy(), a + b)
+    tvm.testing.assert_allclose(mul.numpy(), a * b)
+    outs = gmod.get_outputs([tvm.nd.empty((1, 10)), tvm.nd.empty((1, 10))])
+    tvm.testing.assert_allclose(outs[1].numpy(), a * b)
+
+
+
+@tvm.testing.requires_llvm
+def test_capture_mode():
+    # Operators on the CPU are not captured, they keep running normally
+    x = relay.var("x", shape=(1, 16))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(relay.exp(x))))
+    lib = relay.build(mod, target="llvm")
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.set_num_workers(2)
+    gmod.set_capture_mode(True)
+    for _ in range(3):
+        a = np.random.uniform(size=(1, 16)).astype("float32")
+        gmod.run(x=a)
+        tvm.testing.assert_allclose(gmod.get_output(0).numpy(), np.exp(a), rtol=1e-5)
+    a = np.random.uniform(size=(1, 16)).astype("float32")
+    gmod.set_input("x", a)
+    gmod.capture()
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), np.exp(a), rtol=1e-5)
+    gmod.set_capture_mode(False)
+    gmod.run()
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), np.exp(a), rtol=1e-5)
+
+
+@tvm.testing.requires_llvm
+def test_profile_sampling():
+    x = relay.var("x", shape=(1, 16))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(relay.exp(x))))
+    with tvm.transform.PassContext(opt_level=0):
+        lib = relay.build(mod, target="llvm")
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.set_profile_sampling(3, capacity=2)
+    a = np.random.uniform(size=(1, 16)).astype("float32")
+    for _ in range(2):
+        gmod.run(x=a)
+    assert all(len(v) == 0 for v in gmod.get_profile_samples().values())
+    for _ in range(7):
+        gmod.run(x=a)
+        tvm.testing.assert_allclose(gmod.get_output(0).numpy(), np.exp(a), rtol=1e-5)
+    samples = gmod.get_profile_samples()
+    assert len(samples) == 2
+    for latencies in samples.values():
+        assert latencies.shape == (2,)
+        assert (latencies >= 0).all()
+    gmod.set_profile_sampling(0)
+    assert all(len(v) == 0 for v in gmod.get_profile_samples().values())
+
+
+@tvm.testing.requires_llvm
+def test_thread_pool_partition():
+    import threading
+
+    x = relay.var("x", shape=(64, 256))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(relay.exp(x))))
+    lib = relay.build(mod, target="llvm")
+    try:
+        tvm.get_global_func("runtime.config_threadpool_partition")(3, 2, 0)
+    except tvm.TVMError as err:
+        # The partitions are process-wide, an earlier run in the process created it
+        assert "already exists" in str(err)
+    errors = []
+
+    def run():
+        gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+        gmod.set_thread_pool_partition(3)
+        for _ in range(5):
+            a = np.random.uniform(size=(64, 256)).astype("float32")
+            gmod.run(x=a)
+            if not np.allclose(gmod.get_output(0).numpy(), np.exp(a), rtol=1e-5):
+                errors.append("wrong output")
+
+    threads = [threading.Thread(target=run) for _ in range(3)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert not errors
+
+
 if __name__ == "__main__":
     test_graph_simple()
     test_load_unexpected_params()
+    test_run_parallel()
+    test_run_multi_stream("llvm", tvm.cpu(0))
+    test_create_shared()
+    test_batching_executor()
+    test_load_params_from_file()
+    test_set_inputs_get_outputs()
+    test_capture_mode()
+    test_profile_sampling()
+    test_thread_pool_partition()
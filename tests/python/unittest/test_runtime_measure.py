@@ -56,5 +56,42 @@ def test_min_repeat_ms():
     assert ct > 10 + 2
 
 
+def test_steady_state():
+    calls = []
+
+    @tvm.register_func
+    def my_warming_up():
+        """the first calls are slow, as a board that has not reached its steady state"""
+        calls.append(1)
+        time.sleep(0.03 if len(calls) <= 6 else 0.01)
+
+    X = te.compute((), lambda: tvm.tir.call_packed("my_warming_up"))
+    s = te.create_schedule(X.op)
+    func = tvm.build(s, [X])
+
+    x = tvm.nd.empty((), dtype="int32")
+    ftimer = func.time_evaluator(
+        func.entry_name, tvm.cpu(), number=1, repeat=3, max_repeat=20, cv_threshold=0.2
+    )
+    res = ftimer(x)
+    assert len(res.results) == 3
+    assert res.mean < 0.02
+    assert len(calls) < 1 + 20
+
+
+def test_profile_result():
+    from tvm.runtime.module import ProfileResult, _reject_outliers
+
+    res = ProfileResult(mean=2.5, results=(1.0, 2.0, 3.0, 4.0))
+    assert res.median == 2.5
+    assert res.percentile(0) == 1.0
+    assert res.percentile(100) == 4.0
+    low, high = res.confidence_interval(0.95)
+    assert low < res.mean < high
+    assert _reject_outliers([1.0, 1.1, 0.9, 1.0, 10.0]) == [1.0, 1.1, 0.9, 1.0]
+
+
 if __name__ == "__main__":
     test_min_repeat_ms()
+    test_steady_state()
+    test_profile_result()
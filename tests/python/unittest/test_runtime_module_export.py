@@ -225,5 +225,32 @@ def test_mod_export():
     verify_multi_c_mod_export()
 
 
+@tvm.testing.requires_llvm
+def test_runtime_manifest():
+    import json
+    from tvm.contrib import runtime_pack
+
+    x = relay.var("x", shape=(4,), dtype="float32")
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.argsort(x)))
+    lib = relay.build(mod, "llvm")
+
+    temp = utils.tempdir()
+    path_manifest = temp.relpath("deploy_lib.so.manifest.json")
+    lib.export_library(temp.relpath("deploy_lib.so"), runtime_manifest=path_manifest)
+    with open(path_manifest) as f:
+        manifest = json.load(f)
+    assert not manifest["system_lib"]
+    assert "GraphExecutorFactory" in manifest["modules"]
+    assert "tvm.contrib.sort.argsort" in manifest["packed_funcs"]
+
+    source = runtime_pack.generate([manifest], "src/runtime")
+    assert "graph_executor/graph_executor.cc" in source
+    assert "contrib/sort/sort.cc" in source
+    assert "dso_library.cc" in source
+    assert "system_library.cc" not in source
+    assert "vm/vm.cc" not in source
+
+
 if __name__ == "__main__":
     test_mod_export()
+    test_runtime_manifest()
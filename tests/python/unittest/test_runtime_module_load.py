@@ -22,6 +22,7 @@ import os
 import sys
 import numpy as np
 import subprocess
+import pytest
 import tvm.testing
 
 runtime_py = """
@@ -217,7 +218,31 @@ def test_combine_module_llvm():
     check_llvm()
 
 
+@tvm.testing.requires_llvm
+@pytest.mark.skipif(sys.platform == "win32", reason="Memory loading is not supported on Windows")
+def test_load_module_from_bytes():
+    nn = 12
+    A = te.placeholder((nn,), name="A")
+    temp = utils.tempdir()
+    data = []
+    for i in range(2):
+        B = te.compute(A.shape, lambda *j: A(*j) + float(i + 1), name="B")
+        s = te.create_schedule(B.op)
+        path_dso = temp.relpath("myadd%d.so" % i)
+        tvm.build(s, [A, B], "llvm", name="myadd").export_library(path_dso)
+        with open(path_dso, "rb") as f:
+            data.append(f.read())
+    # Each load is a distinct copy, so the same function name resolves per version.
+    mods = [tvm.runtime.load_module_from_bytes(d) for d in data]
+    a = tvm.nd.array(np.random.uniform(size=nn).astype(A.dtype))
+    b = tvm.nd.array(np.zeros(nn, dtype=A.dtype))
+    for i, m in enumerate(mods):
+        m["myadd"](a, b)
+        np.testing.assert_equal(b.numpy(), a.numpy() + i + 1)
+
+
 if __name__ == "__main__":
     test_combine_module_llvm()
     test_device_module_dump()
     test_dso_module_load()
+    test_load_module_from_bytes()
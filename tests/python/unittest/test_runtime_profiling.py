@@ -49,6 +49,24 @@ def test_vm(target, dev):
             in_header = False
 
 
+@pytest.mark.skipif(not profiler_vm.enabled(), reason="VM Profiler not enabled")
+@tvm.testing.parametrize_targets
+def test_vm_call_metrics(target, dev):
+    mod, params = mlp.get_workload(1)
+
+    exe = relay.vm.compile(mod, target, params=params)
+    vm = profiler_vm.VirtualMachineProfiler(exe, dev)
+
+    data = np.random.rand(1, 1, 28, 28).astype("float32")
+    report = vm.profile(data, func_name="main")
+    rows = list(csv.DictReader(StringIO(report.csv())))
+    softmax = [row for row in rows if "fused_nn_softmax" in row["Name"]]
+    assert len(softmax) == 1
+    assert int(softmax[0]["Count"]) == 1
+    assert int(softmax[0]["Input Bytes"]) == 1 * 10 * 4
+    assert int(softmax[0]["Output Bytes"]) == 1 * 10 * 4
+
+
 @tvm.testing.parametrize_targets
 def test_graph_executor(target, dev):
     mod, params = mlp.get_workload(1)
@@ -61,3 +79,41 @@ def test_graph_executor(target, dev):
     assert "fused_nn_softmax" in str(report)
     assert "Total" in str(report)
     assert "Hash" in str(report)
+
+
+@tvm.testing.parametrize_targets
+def test_graph_executor_throughput_metrics(target, dev):
+    mod, params = mlp.get_workload(1)
+
+    exe = relay.build(mod, target, params=params)
+    gr = debug_executor.create(exe.get_graph_json(), exe.lib, dev)
+
+    data = np.random.rand(1, 1, 28, 28).astype("float32")
+    report = gr.profile(data=data)
+    rows = list(csv.DictReader(StringIO(report.csv())))
+    dense = [row for row in rows if "fused_nn_dense" in row["Name"]]
+    assert len(dense) > 0
+    # the first dense of the mlp is 784 x 128
+    assert max(int(row["FLOPs"]) for row in dense) == 2 * 784 * 128
+    assert all(int(row["Bytes Accessed"]) > 0 for row in rows)
+    assert "GFLOP/s" in rows[0]
+
+
+@pytest.mark.skipif(
+    tvm.get_global_func("runtime.profiling.metric_collector.perf_event", True) is None,
+    reason="Perf counters not enabled",
+)
+def test_perf_event_counters():
+    mod, params = mlp.get_workload(1)
+
+    exe = relay.build(mod, "llvm", params=params)
+    gr = debug_executor.create(exe.get_graph_json(), exe.lib, tvm.cpu())
+
+    data = np.random.rand(1, 1, 28, 28).astype("float32")
+    report = gr.profile(data=data)
+    rows = list(csv.DictReader(StringIO(report.csv())))
+    dense = [row for row in rows if "fused_nn_dense" in row["Name"]]
+    if "CPU Cycles" not in rows[0]:
+        pytest.skip("The perf counters cannot be opened")
+    assert all(int(row["CPU Instructions"]) > 0 for row in dense)
+    assert all(float(row["IPC"]) > 0 for row in dense)
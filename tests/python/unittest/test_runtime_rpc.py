@@ -138,6 +138,80 @@ def test_rpc_large_array():
     np.testing.assert_equal(b.numpy(), b_np)
 
 
+@tvm.testing.requires_rpc
+def test_rpc_copy_sizes():
+    # payloads on both sides of the size sent without buffering
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    dev = remote.cpu(0)
+    for nbytes in [1, (64 << 10) - 1, 64 << 10, (64 << 10) + 1, 5 << 20]:
+        x = np.random.randint(0, 255, size=nbytes).astype("uint8")
+        y = tvm.nd.array(x, dev)
+        np.testing.assert_equal(y.numpy(), x)
+        z = tvm.nd.empty(x.shape, "uint8", dev)
+        y.copyto(z)
+        np.testing.assert_equal(z.numpy(), x)
+
+
+@tvm.testing.requires_rpc
+def test_rpc_pipelined_requests():
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    dev = remote.cpu(0)
+    # copies to the remote do not wait for it, the reads see them in order
+    arrays = [np.random.uniform(size=(17, i + 1)).astype("float32") for i in range(64)]
+    remote_arrays = [tvm.nd.array(x, dev) for x in arrays]
+    for x, y in zip(arrays, remote_arrays):
+        np.testing.assert_equal(y.numpy(), x)
+    del remote_arrays
+
+    # an error does not break the requests after it
+    fexcept = remote.get_function("rpc.test.except")
+    with pytest.raises(tvm._ffi.base.TVMError):
+        fexcept("abc")
+    faddone = remote.get_function("rpc.test.addone")
+    assert faddone(10) == 11
+
+    # threads share the session with requests in flight at the same time
+    import threading
+
+    errors = []
+
+    def run(tid):
+        try:
+            x = np.full((64, 64), tid, dtype="float32")
+            for i in range(20):
+                assert faddone(tid * 100 + i) == tid * 100 + i + 1
+                np.testing.assert_equal(tvm.nd.array(x, dev).numpy(), x)
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    threads = [threading.Thread(target=run, args=(tid,)) for tid in range(4)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    assert not errors, errors
+
+
+@tvm.testing.requires_rpc
+def test_rpc_compression():
+    codecs = tvm.get_global_func("rpc.CompressionCodecs")()
+    if "lz4" not in codecs.split(","):
+        pytest.skip("RPC compression is not enabled")
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port, compress="lz4")
+    dev = remote.cpu(0)
+    # messages below, around and above the compression block size
+    for nbytes in [16, 4 << 10, (256 << 10) + 1, 3 << 20]:
+        zeros = np.zeros(nbytes, dtype="uint8")
+        noise = np.random.randint(0, 255, size=nbytes).astype("uint8")
+        for x in [zeros, noise]:
+            np.testing.assert_equal(tvm.nd.array(x, dev).numpy(), x)
+    faddone = remote.get_function("rpc.test.addone")
+    assert faddone(10) == 11
+
+
 @tvm.testing.requires_rpc
 def test_rpc_echo():
     def check(remote):
@@ -170,6 +244,11 @@ def test_rpc_echo():
         minrpc_exec = temp.relpath("minrpc")
         tvm.rpc.with_minrpc(cc.create_executable)(minrpc_exec, [])
         check(rpc.PopenSession(minrpc_exec))
+        check(rpc.PopenSession(minrpc_exec, shared_memory=True))
+        # payloads larger than the shared memory rings
+        remote = rpc.PopenSession(minrpc_exec, shared_memory=True)
+        x = np.random.randint(0, 255, size=9 << 20).astype("uint8")
+        np.testing.assert_equal(tvm.nd.array(x, remote.cpu(0)).numpy(), x)
         # minrpc on the remote
         server = rpc.Server()
         client = rpc.connect(
@@ -988,6 +988,88 @@ def test_unrolled_vectorization():
     tvm.testing.assert_allclose(c_np, N * np.ones((N, N)))
 
 
+@tvm.testing.requires_cuda
+def test_cuda_ptx_mma():
+    dev = tvm.cuda(0)
+    major, _ = nvcc.parse_compute_version(dev.compute_version)
+    if major < 8:
+        print("skip because gpu does not support mma.sync m16n8k16 and ldmatrix")
+        return
+
+    def ptx_mma(A, B, C):
+        ib = tvm.tir.ir_builder.create()
+        tx = te.thread_axis("threadIdx.x")
+        ib.scope_attr(tx, "thread_extent", 32)
+        A = ib.buffer_ptr(A)
+        B = ib.buffer_ptr(B)
+        C = ib.buffer_ptr(C)
+        a_smem = ib.allocate("float16", (16, 16), name="a_smem", scope="shared")
+        a_frag = ib.allocate("float16", 8, name="a_frag", scope="local")
+        b_frag = ib.allocate("float16", 4, name="b_frag", scope="local")
+        c_frag = ib.allocate("float32", 4, name="c_frag", scope="local")
+        # The fragments of the threads, in the layouts of the PTX ISA.
+        group, tid = tx // 4, tx % 4
+        for i in range(8):
+            a_smem[tx // 2, (tx % 2) * 8 + i] = A[tx // 2, (tx % 2) * 8 + i]
+        ib.emit(tvm.tir.call_intrin("int32", "tir.tvm_storage_sync", "shared"))
+        # The 4 8x8 matrices of A, each thread loads one row.
+        row = tx % 16
+        col = (tx // 16) * 8
+        ib.emit(
+            tvm.tir.call_intrin(
+                "handle",
+                "tir.ptx_ldmatrix",
+                False,
+                4,
+                ".b16",
+                a_frag.asobject(),
+                0,
+                a_smem.asobject(),
+                row * 16 + col,
+            )
+        )
+        for i in range(4):
+            b_frag[i] = B[tid * 2 + i % 2 + 8 * (i // 2), group]
+            c_frag[i] = tvm.tir.const(0, "float32")
+        ib.emit(
+            tvm.tir.call_intrin(
+                "handle",
+                "tir.ptx_mma",
+                "m16n8k16",
+                "row",
+                "col",
+                "fp16",
+                "fp16",
+                "fp32",
+                a_frag.asobject(),
+                0,
+                b_frag.asobject(),
+                0,
+                c_frag.asobject(),
+                0,
+                False,
+            )
+        )
+        for i in range(4):
+            C[group + 8 * (i // 2), tid * 2 + i % 2] = c_frag[i]
+        return ib.get()
+
+    A = te.placeholder((16, 16), "float16", name="A")
+    B = te.placeholder((16, 8), "float16", name="B")
+    C = te.extern((16, 8), [A, B], lambda ins, outs: ptx_mma(ins[0], ins[1], outs[0]))
+    s = te.create_schedule(C.op)
+    f = tvm.build(s, [A, B, C], "cuda")
+    assert "mma.sync.aligned.m16n8k16.row.col.f32.f16.f16.f32" in f.imported_modules[0].get_source()
+
+    a_np = np.random.uniform(size=(16, 16)).astype("float16")
+    b_np = np.random.uniform(size=(16, 8)).astype("float16")
+    a = tvm.nd.array(a_np, dev)
+    b = tvm.nd.array(b_np, dev)
+    c = tvm.nd.array(np.zeros((16, 8), dtype="float32"), dev)
+    f(a, b, c)
+    ref = np.dot(a_np.astype("float32"), b_np.astype("float32"))
+    tvm.testing.assert_allclose(c.numpy(), ref, rtol=1e-3)
+
 if __name__ == "__main__":
     test_cuda_vectorize_add()
     test_cuda_bf16_vectorize_add()
@@ -1014,3 +1096,4 @@ if __name__ == "__main__":
     test_vectorized_cooperative_fetching_x()
     test_vectorized_cooperative_fetching_xy()
     test_unrolled_vectorization()
+    test_cuda_ptx_mma()
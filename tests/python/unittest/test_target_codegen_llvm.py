@@ -17,7 +17,9 @@
 import collections
 import ctypes
 import json
+import os
 import sys
+import threading
 
 import tvm
 import tvm.testing
@@ -141,6 +143,25 @@ def test_llvm_persist_parallel():
 
     check_llvm()
 
+    # The barrier launch runs on the static schedule of a work-stealing thread pool, which
+    # reads the schedule when the new thread creates its pool
+    errors = []
+
+    def run():
+        try:
+            check_llvm()
+        except Exception as err:  # pylint: disable=broad-except
+            errors.append(err)
+
+    os.environ["TVM_THREAD_POOL_SCHEDULE"] = "steal"
+    try:
+        thread = threading.Thread(target=run)
+        thread.start()
+        thread.join()
+    finally:
+        del os.environ["TVM_THREAD_POOL_SCHEDULE"]
+    assert not errors, errors
+
 
 @tvm.testing.requires_llvm
 def test_llvm_flip_pipeline():
@@ -818,5 +839,52 @@ def test_llvm_gpu_lower_atomic():
         tvm.testing.assert_allclose(a.numpy(), ref, rtol=1e-5)
 
 
+@tvm.testing.requires_llvm
+def test_llvm_partitioned_codegen():
+    n = 16
+    A = te.placeholder((n,), name="A")
+    mod = tvm.IRModule()
+    for i in range(40):
+        B = te.compute((n,), lambda j: A[j] + float(i), name="B")
+        s = te.create_schedule(B.op)
+        mod.update(tvm.lower(s, [A, B], name="add_%d" % i))
+
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    # Two partitions of 20 functions, generated on two threads and linked.
+    with tvm.transform.PassContext(config={"target.llvm.num_threads": 2}):
+        f = tvm.build(mod, target="llvm")
+    for i in [0, 17, 39]:
+        b = tvm.nd.array(np.zeros(n, dtype=A.dtype), dev)
+        f["add_%d" % i](a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() + i)
+    # The linked module holds the functions of every partition.
+    ll = f.get_source("ll")
+    assert all("@add_%d(" % i in ll for i in range(40))
+
+
+@tvm.testing.requires_llvm
+def test_llvm_optimize_options():
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] * 2.0 + 1.0, name="B")
+    s = te.create_schedule(B.op)
+
+    def check(target):
+        f = tvm.build(s, [A, B], target)
+        dev = tvm.cpu(0)
+        a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+        b = tvm.nd.array(np.zeros(n, dtype=B.dtype), dev)
+        f(a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() * 2.0 + 1.0)
+        return f.get_source("ll")
+
+    # The loop vectorizer of LLVM vectorizes the scalar loop, unless disabled.
+    assert "x float>" in check("llvm")
+    assert "x float>" not in check("llvm -loop-vectorize=0 -slp-vectorize=0")
+    check("llvm -opt-level=0")
+    check("llvm -opt-level=2 -unroll-loops=0")
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
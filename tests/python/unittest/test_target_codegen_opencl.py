@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 from tvm import te
 import tvm.testing
@@ -120,6 +121,70 @@ def test_opencl_max():
     check_max(dev, 1, "float64")
 
 
+@tvm.testing.requires_opencl
+def test_opencl_texture():
+    n = 16
+    A = te.placeholder((n, 4), name="A", dtype="float32")
+    C = te.compute((n, 4), lambda i, j: A[i, j] * 2.0, name="C")
+    s = te.create_schedule(C.op)
+    s[C].bind(s[C].op.axis[0], te.thread_axis("threadIdx.x"))
+    s[C].vectorize(s[C].op.axis[1])
+    data = te.var("A", tvm.ir.PointerType(tvm.ir.PrimType("float32"), "global.texture"))
+    Ab = tvm.tir.decl_buffer(A.shape, A.dtype, "A", data=data)
+    fun = tvm.build(s, [A, C], target, binds={A: Ab})
+    source = fun.imported_modules[0].get_source()
+    assert "__read_only image2d_t A" in source
+    assert "read_imagef(A, __tvm_texture_sampler" in source
+
+
+@tvm.testing.requires_opencl
+def test_opencl_subgroup_reduce():
+    warp_size = 16
+    n = te.var("n")
+    A = te.placeholder((n, warp_size), name="A")
+    k = te.reduce_axis((0, warp_size), name="k")
+    B = te.compute((n,), lambda i: te.sum(A[i, k], axis=k), name="B")
+    s = te.create_schedule(B.op)
+    s[B].bind(B.op.reduce_axis[0], te.thread_axis("threadIdx.x"))
+    s[B].bind(B.op.axis[0], te.thread_axis("blockIdx.x"))
+    fun = tvm.build(s, [A, B], "opencl -thread_warp_size=%d" % warp_size)
+    source = fun.imported_modules[0].get_source()
+    assert "intel_sub_group_shuffle" in source
+    assert "intel_reqd_sub_group_size(%d)" % warp_size in source
+
+
+@tvm.testing.requires_gpu
+@tvm.testing.requires_opencl
+def test_opencl_stream():
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    bx, tx = s[B].split(B.op.axis[0], factor=64)
+    s[B].bind(bx, te.thread_axis("blockIdx.x"))
+    s[B].bind(tx, te.thread_axis("threadIdx.x"))
+    fun = tvm.build(s, [A, B], target)
+
+    dev = tvm.device(target, 0)
+    a_np = np.random.uniform(size=n).astype(A.dtype)
+    a = tvm.nd.array(a_np, dev)
+    b = tvm.nd.empty((n,), B.dtype, dev)
+    c = tvm.nd.empty((n,), B.dtype, dev)
+    stream = dev.create_raw_stream()
+    dev.set_raw_stream(stream)
+    fun(a, b)
+    dev.sync(stream)
+    # Back on the default queue, which reads the output of the stream.
+    dev.set_raw_stream(None)
+    fun(b, c)
+    dev.sync()
+    dev.free_raw_stream(stream)
+    tvm.testing.assert_allclose(c.numpy(), a_np + 2.0)
+
+
 if __name__ == "__main__":
     test_opencl_ternary_expression()
     test_opencl_inf_nan()
+    test_opencl_texture()
+    test_opencl_subgroup_reduce()
+    test_opencl_stream()
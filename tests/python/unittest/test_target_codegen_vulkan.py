@@ -90,6 +90,33 @@ def test_vulkan_copy():
         check_vulkan(dtype, int(peturb * (2 ** logN)))
 
 
+@tvm.testing.requires_vulkan
+def test_vulkan_async_upload():
+    # The uploads are not synchronized, they must still land in order and before the kernels
+    # reading them, with more of them in flight than there are staging buffers.
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=64)
+    s[B].bind(xo, bx)
+    s[B].bind(xi, tx)
+    fun = tvm.build(s, [A, B], "vulkan")
+    dev = tvm.vulkan(0)
+
+    a = tvm.nd.empty((n,), A.dtype, dev)
+    bs = [tvm.nd.empty((n,), B.dtype, dev) for _ in range(8)]
+    a_nps = [np.random.uniform(size=(n,)).astype(A.dtype) for _ in bs]
+    for _ in range(3):
+        a.copyfrom(np.random.uniform(size=(n,)).astype(A.dtype))
+    for a_np, b in zip(a_nps, bs):
+        a.copyfrom(a_np)
+        fun(a, b)
+    for a_np, b in zip(a_nps, bs):
+        tvm.testing.assert_allclose(b.numpy(), a_np + 1)
+    tvm.testing.assert_allclose(a.numpy(), a_nps[-1])
+
+
 @tvm.testing.requires_vulkan
 def test_vulkan_vectorize_add():
     num_thread = 8
@@ -357,12 +384,79 @@ def test_vulkan_while_if(target, dev):
     tvm.testing.assert_allclose(b.numpy(), [210])
 
 
+@tvm.testing.requires_vulkan
+def test_vulkan_cooperative_matrix():
+    target = tvm.target.Target(
+        "vulkan -supports_cooperative_matrix=1 -supports_float16=1 -supports_16bit_buffer=1 "
+        "-supports_storage_buffer_storage_class=1"
+    )
+    m = n = k = 16
+    A = te.placeholder((m, k), name="A", dtype="float16")
+    B = te.placeholder((k, n), name="B", dtype="float16")
+
+    def do_compute(ins, outs):
+        ib = tvm.tir.ir_builder.create()
+        ib.scope_attr(te.thread_axis("threadIdx.x"), "thread_extent", 32)
+        a = ib.allocate("float16", (m * k,), name="a", scope="wmma.matrix_a")
+        b = ib.allocate("float16", (k * n,), name="b", scope="wmma.matrix_b")
+        c = ib.allocate("float32", (m * n,), name="c", scope="wmma.accumulator")
+        a, b, c = a.asobject(), b.asobject(), c.asobject()
+        ib.emit(
+            tvm.tir.call_intrin(
+                "handle", "tir.tvm_fill_fragment", c, m, n, k, 0, tvm.tir.const(0, "float32")
+            )
+        )
+        for frag, buf in [(a, ins[0]), (b, ins[1])]:
+            ib.emit(
+                tvm.tir.call_intrin(
+                    "handle",
+                    "tir.tvm_load_matrix_sync",
+                    frag,
+                    m,
+                    n,
+                    k,
+                    0,
+                    buf.access_ptr("r"),
+                    16,
+                    "row_major",
+                )
+            )
+        ib.emit(tvm.tir.call_intrin("handle", "tir.tvm_mma_sync", c, 0, a, 0, b, 0, c, 0))
+        ib.emit(
+            tvm.tir.call_intrin(
+                "handle",
+                "tir.tvm_store_matrix_sync",
+                c,
+                m,
+                n,
+                k,
+                0,
+                outs[0].access_ptr("w"),
+                16,
+                "row_major",
+            )
+        )
+        return ib.get()
+
+    C = te.extern((m, n), [A, B], do_compute, dtype="float32", name="C")
+    s = te.create_schedule(C.op)
+    f = tvm.build(s, [A, B, C], target)
+
+    assembly = f.imported_modules[0].get_source()
+    assert "OpCapability CooperativeMatrixNV" in assembly
+    assert len(re.findall("OpCooperativeMatrixLoadNV", assembly)) == 2
+    assert len(re.findall("OpCooperativeMatrixMulAddNV", assembly)) == 1
+    assert len(re.findall("OpCooperativeMatrixStoreNV", assembly)) == 1
+
+
 if __name__ == "__main__":
     test_vector_comparison()
     test_vulkan_copy()
+    test_vulkan_async_upload()
     test_vulkan_vectorize_add()
     test_vulkan_stress()
     test_vulkan_constant_passing()
     test_vulkan_bool_load()
     test_vulkan_pushconstants()
     test_vulkan_unique()
+    test_vulkan_cooperative_matrix()
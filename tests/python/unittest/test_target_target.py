@@ -299,5 +299,17 @@ def test_check_and_update_host_consist_3():
     assert target.host == host
 
 
+def test_arm_isa_analyzer():
+    from tvm.target import arm_isa
+
+    assert "SMLAD" in arm_isa.IsaAnalyzer(tvm.target.target.micro("stm32f746xx"))
+    assert "SMLAD" in arm_isa.IsaAnalyzer(tvm.target.target.micro("nrf5340dk"))
+    assert "SMLAD" in arm_isa.IsaAnalyzer(Target("c -mcpu=cortex-m4+nofp"))
+    assert "SMLAD" in arm_isa.IsaAnalyzer(Target("c -march=armv8.1-m.main"))
+    assert "SMLAD" not in arm_isa.IsaAnalyzer(tvm.target.target.micro("host"))
+    assert "SMLAD" not in arm_isa.IsaAnalyzer(Target("c -mcpu=cortex-m0"))
+    assert "SMLAD" not in arm_isa.IsaAnalyzer(arm_cpu("rasp3b"))
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
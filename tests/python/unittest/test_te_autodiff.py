@@ -345,7 +345,32 @@ def test_reduction_init():
     check_grad(B, A0)
 
 
+def test_direct_adjoint():
+    np.random.seed(0)
+    X = te.placeholder((4, 8), name="X")
+    W = te.placeholder((6, 8), name="W")
+    k = te.reduce_axis((0, 8), name="k")
+    Y = te.compute((4, 6), lambda i, j: te.sum(X[i, k] * W[j, k], axis=k), name="Y")
+
+    # the adjoints of dense are the matmuls of the hand-written backward op
+    head = te.placeholder((4, 6), name="head")
+    dX, dW = te.gradient(Y, [X, W], head=head)
+    for grad, extent in [(dX, 6), (dW, 4)]:
+        body = grad.op.body[0]
+        assert isinstance(body, tvm.tir.Reduce)
+        assert [iv.dom.extent.value for iv in body.axis] == [extent]
+    check_grad(Y, [X, W])
+
+    # broadcast and slice
+    b = te.placeholder((6,), name="b")
+    Z = te.compute((4, 6), lambda i, j: te.exp(Y[i, j] + b[j]), name="Z")
+    check_grad(Z, [X, W, b], data_range=(-1, 1))
+    S = te.compute((3, 6), lambda i, j: W[i, j] * W[i, j], name="S")
+    check_grad(S, [W])
+
+
 if __name__ == "__main__":
     test_basic_operation()
     test_topi()
     test_stride_dilation()
+    test_direct_adjoint()
@@ -75,6 +75,24 @@ def test_bound3():
     assert bounds[A1.op.axis[1]].extent.value == 16
 
 
+def test_bound_shared_consumer():
+    # Both producers relax the loops of the consumer the same way, and share its domain.
+    m = 64
+    A = te.placeholder((m, m), name="A")
+    A1 = te.compute((m, m), lambda i, j: A[i, j], name="A1")
+    B1 = te.compute((m, m), lambda i, j: A[i, j] * 2, name="B1")
+    C = te.compute((m, m), lambda i, j: A1[i, j] + B1[j, i], name="C")
+    s = te.create_schedule(C.op)
+    xo, yo, xi, yi = s[C].tile(C.op.axis[0], C.op.axis[1], 8, 4)
+    s[A1].compute_at(s[C], yo)
+    s[B1].compute_at(s[C], yo)
+    bounds = tvm.te.schedule.InferBound(s)
+    assert bounds[A1.op.axis[0]].extent.value == 8
+    assert bounds[A1.op.axis[1]].extent.value == 4
+    assert bounds[B1.op.axis[0]].extent.value == 4
+    assert bounds[B1.op.axis[1]].extent.value == 8
+
+
 def test_bound_split_ext_less_than_factor():
     m = 8
     I = te.placeholder((m,), name="I")
@@ -482,6 +500,7 @@ if __name__ == "__main__":
     test_bound_blur()
     test_bound_conv1d()
     test_bound2()
+    test_bound_shared_consumer()
     test_gemm_bound()
     test_bound_warp()
     test_bound_tensor_compute_op()
@@ -181,6 +181,27 @@ def test_buffer_load_store():
     assert not consistent_equal(sy, sz)
 
 
+def test_hash_cache():
+    x = te.var("x")
+    y = te.var("y")
+    const = tvm.tir.const(1, "int32") + tvm.tir.const(2, "int32")
+    expr = x + y
+    let = tvm.tir.Let(x, y + const, expr * const)
+    key_map = tvm.runtime.convert({const: x})
+    nodes = [const, expr, let, key_map, tvm.runtime.convert([const, let, key_map])]
+    expected = [tvm.ir.structural_hash(n, m) for n in nodes for m in (False, True)]
+
+    with tvm.ir.StructuralHashCache():
+        # the closed subtrees and the roots hashed first are reused in the next ones
+        for _ in range(2):
+            hashes = [tvm.ir.structural_hash(n, m) for n in nodes for m in (False, True)]
+            assert hashes == expected
+        assert tvm.ir.structural_hash(nodes[-1]) == expected[-2]
+        # the equality first compares the memoized hashes
+        assert not tvm.ir.structural_equal(const, expr)
+        assert tvm.ir.structural_equal(let, tvm.tir.Let(x, y + const, expr * const))
+
+
 if __name__ == "__main__":
     test_exprs()
     test_prim_func()
@@ -189,3 +210,4 @@ if __name__ == "__main__":
     test_env_func()
     test_stmt()
     test_buffer_load_store()
+    test_hash_cache()
@@ -123,7 +123,48 @@ def test_coproc_sync3():
     assert __check_list(pop_st.value.args, [2, 3])
 
 
+def test_coproc_sync_elimination():
+    ib = tvm.tir.ir_builder.create()
+    cp = te.thread_axis((0, 1), "cop")
+    A = ib.allocate("float32", 128, name="A")
+
+    def call(name, *args):
+        return tvm.tir.call_intrin("int32", "tir.cop." + name, *args)
+
+    with ib.new_scope():
+        ib.scope_attr(cp, "coproc_scope", 1)
+        A[0] = 1.0
+    ib.emit(call("coproc_sync"))
+    # Context 1 issued nothing since the sync, the pair is redundant
+    ib.emit(call("coproc_dep_push", 1, 2))
+    ib.emit(call("coproc_dep_pop", 1, 2))
+    with ib.new_scope():
+        ib.scope_attr(cp, "coproc_scope", 2)
+        A[1] = 1.0
+    ib.emit(call("coproc_sync"))
+    # Nothing was issued since the last sync
+    ib.emit(call("coproc_sync"))
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([], stmt))
+    stmt = tvm.tir.transform.CoProcSync()(mod)["main"].body
+
+    def name(s):
+        if isinstance(s, tvm.tir.AttrStmt):
+            return "ctx%d" % s.value.value
+        return s.value.op.name[len("tir.cop.") :]
+
+    # The final sync of the planner follows the one of the body
+    assert isinstance(stmt, tvm.tir.AttrStmt)
+    slist = tvm.tir.stmt_list(stmt.body.body)
+    assert [name(s) for s in slist] == ["ctx1", "coproc_sync", "ctx2", "coproc_sync"]
+    # The inserted dependency from context 1 to 2 stays, its token balanced
+    assert name(tvm.tir.stmt_list(slist[0].body)[-1]) == "coproc_dep_push"
+    assert name(tvm.tir.stmt_list(slist[2].body)[0]) == "coproc_dep_pop"
+
+
 if __name__ == "__main__":
     test_coproc_sync()
     test_coproc_sync2()
     test_coproc_sync3()
+    test_coproc_sync_elimination()
@@ -0,0 +1,96 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import te
+
+
+def count_calls(stmt, op_name):
+    count = [0]
+    op = tvm.ir.Op.get(op_name)
+
+    def visit(node):
+        if isinstance(node, tvm.tir.Call) and node.op.same_as(op):
+            count[0] += 1
+
+    tvm.tir.stmt_functor.post_order_visit(stmt, visit)
+    return count[0]
+
+
+def test_inject_async_copy():
+    m = 16
+    tx = te.thread_axis("threadIdx.x")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tx, "thread_extent", 1)
+    B = ib.allocate("float32", m, name="B", scope="shared")
+    L = ib.allocate("float32", m, name="L", scope="local")
+    with ib.for_range(0, m) as j:
+        L[j] = A[j]
+    with ib.new_scope():
+        ib.scope_attr(te.var("j"), "pragma_async_copy", 1)
+        with ib.for_range(0, m) as j:
+            B[j] = A[j]
+    with ib.new_scope():
+        # Only the copies of global memory are asynchronous.
+        ib.scope_attr(te.var("j"), "pragma_async_copy", 1)
+        with ib.for_range(0, m) as j:
+            B[j] = L[j]
+    with ib.for_range(0, m) as j:
+        C[j] = B[j] + L[j]
+    mod = tvm.IRModule({"main": tvm.tir.PrimFunc([A.asobject(), C.asobject()], ib.get())})
+
+    stmt = tvm.tir.transform.InjectAsyncCopy()(mod)["main"].body
+    assert count_calls(stmt, "tir.tvm_async_copy") == 1
+    assert count_calls(stmt, "tir.tvm_async_commit_group") == 1
+    assert count_calls(stmt, "tir.tvm_async_wait_group") == 1
+    assert count_calls(stmt, "tir.tvm_storage_sync") == 1
+
+
+@tvm.testing.requires_cuda
+def test_async_copy_pipeline_cuda():
+    n = 1024
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    AA = s.cache_read(A, "shared", [B])
+    bx, xi = s[B].split(B.op.axis[0], nparts=4)
+    ko, tx = s[B].split(xi, factor=32)
+    s[B].bind(bx, te.thread_axis("blockIdx.x"))
+    s[B].bind(tx, te.thread_axis("threadIdx.x"))
+    s[AA].compute_at(s[B], ko)
+    s[AA].bind(s[AA].op.axis[0], te.thread_axis("threadIdx.x"))
+    s[AA].double_buffer(3)
+
+    config = {"tir.InjectDoubleBuffer": {"use_async_copy": True}}
+    with tvm.transform.PassContext(config=config):
+        f = tvm.build(s, [A, B], "cuda")
+    assert "__tvm_cp_async<4>" in f.imported_modules[0].get_source()
+
+    dev = tvm.cuda(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    b = tvm.nd.array(np.zeros(n, dtype=B.dtype), dev)
+    f(a, b)
+    tvm.testing.assert_allclose(b.numpy(), a.numpy() + 1.0)
+
+
+if __name__ == "__main__":
+    test_inject_async_copy()
+    test_async_copy_pipeline_cuda()
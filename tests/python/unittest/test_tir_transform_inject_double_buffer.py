@@ -61,5 +61,69 @@ def test_double_buffer():
     assert count[0] == 4
 
 
+def count_calls(stmt, op_name):
+    count = [0]
+    op = tvm.ir.Op.get(op_name)
+
+    def visit(node):
+        if isinstance(node, tvm.tir.Call) and node.op.same_as(op):
+            count[0] += 1
+
+    tvm.tir.stmt_functor.post_order_visit(stmt, visit)
+    return count[0]
+
+
+def multi_stage_module(num_stages):
+    n = 100
+    m = 4
+    tx = te.thread_axis("threadIdx.x")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    C = ib.pointer("float32", name="C")
+    ib.scope_attr(tx, "thread_extent", 1)
+    with ib.for_range(0, n) as i:
+        B = ib.allocate("float32", m, name="B", scope="shared")
+        with ib.new_scope():
+            ib.scope_attr(B.asobject(), "double_buffer_scope", num_stages)
+            with ib.for_range(0, m) as j:
+                B[j] = A[i * 4 + j]
+        with ib.for_range(0, m) as j:
+            C[j] = B[j] + 1
+    return tvm.IRModule({"db": tvm.tir.PrimFunc([A.asobject(), C.asobject()], ib.get())})
+
+
+def test_multi_stage_double_buffer():
+    mod = multi_stage_module(3)
+    with tvm.transform.PassContext(config={"tir.InjectDoubleBuffer": {"split_loop": 0}}):
+        mod = tvm.tir.transform.InjectDoubleBuffer()(mod)
+    stmt = mod["db"].body
+
+    alloc = stmt.body.body
+    assert isinstance(alloc, tvm.tir.Allocate)
+    assert alloc.extents[0].value == 3
+    # The prologue fetches the first two iterations, before the loop.
+    seq = alloc.body
+    assert isinstance(seq, tvm.tir.SeqStmt) and len(seq) == 3
+    assert isinstance(seq[1], tvm.tir.IfThenElse)
+    assert isinstance(seq[2], tvm.tir.For)
+    assert count_calls(stmt, "tir.tvm_async_copy") == 0
+
+
+def test_multi_stage_async_copy():
+    mod = multi_stage_module(3)
+    config = {"tir.InjectDoubleBuffer": {"split_loop": 0, "use_async_copy": True}}
+    with tvm.transform.PassContext(config=config):
+        mod = tvm.tir.transform.InjectDoubleBuffer()(mod)
+    stmt = mod["db"].body
+
+    # The two fetches of the prologue and the one of the loop, each committed as a group.
+    assert count_calls(stmt, "tir.tvm_async_copy") == 3
+    assert count_calls(stmt, "tir.tvm_async_commit_group") == 3
+    assert count_calls(stmt, "tir.tvm_async_wait_group") == 1
+    assert count_calls(stmt, "tir.tvm_storage_sync") == 1
+
+
 if __name__ == "__main__":
     test_double_buffer()
+    test_multi_stage_double_buffer()
+    test_multi_stage_async_copy()
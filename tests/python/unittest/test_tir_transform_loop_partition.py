@@ -538,6 +538,58 @@ def test_simple_rfactor():
     assert not tvm.ir.structural_equal(stmt1.body, stmt2.body)
 
 
+def count_unguarded_stores(stmt):
+    count = [0]
+
+    def visit(s, guarded):
+        if isinstance(s, tvm.tir.IfThenElse):
+            visit(s.then_case, True)
+            if s.else_case is not None:
+                visit(s.else_case, True)
+        elif isinstance(s, tvm.tir.Store):
+            count[0] += 0 if guarded else 1
+        elif isinstance(s, tvm.tir.SeqStmt):
+            for x in s:
+                visit(x, guarded)
+        elif hasattr(s, "body"):
+            visit(s.body, guarded)
+
+    visit(stmt, False)
+    return count[0]
+
+
+def test_multi_dim_padding():
+    n = 16
+    ib = tvm.tir.ir_builder.create()
+    data = ib.pointer("float32", name="data")
+    out = ib.pointer("float32", name="out")
+    with ib.for_range(0, n, "i") as i:
+        with ib.for_range(0, n, "j") as j:
+            with ib.if_scope(ib.likely(tvm.tir.all(i >= 1, i < n - 1, j >= 1, j < n - 1))):
+                out[i * n + j] = data[(i - 1) * (n - 2) + j - 1]
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([data, out], ib.get()))
+    num_stmts = len(collect_visit(mod["main"].body, lambda x: isinstance(x, tvm.tir.Stmt)))
+
+    def partition(budget):
+        config = {"partition_const_loop": True, "code_size_budget": budget}
+        with tvm.transform.PassContext(config={"tir.LoopPartition": config}):
+            return tvm.tir.transform.LoopPartition()(mod)["main"].body
+
+    # The conjuncts on i and on j partition both the loops,
+    # the interior of the window is free of the bounds check.
+    stmt = partition(0.0)
+    assert count_unguarded_stores(stmt) > 0
+
+    # No code growth allowed, the loops stay whole.
+    stmt = partition(1.0)
+    assert count_unguarded_stores(stmt) == 0
+
+    # The budget covers the interior, the edges keep their checks.
+    stmt = partition(4.0)
+    assert count_unguarded_stores(stmt) > 0
+    assert len(collect_visit(stmt, lambda x: isinstance(x, tvm.tir.Stmt))) <= 4 * num_stmts
+
+
 if __name__ == "__main__":
     test_basic()
     test_const_loop()
@@ -558,4 +610,5 @@ if __name__ == "__main__":
     test_conv_tiling()
     test_double_splitting_with_indivisible_factors()
     test_multilevel_splitting_with_indivisble_factors()
+    test_multi_dim_padding()
     test_simple_rfactor()
@@ -15,6 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 import tvm
+import tvm.testing
 from tvm import te
 import numpy
 
@@ -46,5 +47,54 @@ def test_makeapi():
     assert len(f.params) == 8
 
 
+def _count_asserts(stmt):
+    asserts = []
+    tvm.tir.stmt_functor.post_order_visit(
+        stmt, lambda n: asserts.append(n) if isinstance(n, tvm.tir.AssertStmt) else None
+    )
+    return len(asserts)
+
+
+def test_unchecked_entry():
+    A = te.placeholder((16,), name="A")
+    B = te.compute(A.shape, lambda i: A[i] + 1.0, name="B")
+    s = te.create_schedule(B.op)
+    mod = tvm.lower(s, [A, B], name="main")
+    mod = tvm.tir.transform.Apply(lambda f: f.with_attr("target", tvm.target.Target("llvm")))(mod)
+
+    f = tvm.tir.transform.MakePackedAPI(0)(mod)
+    assert len(f.functions) == 1
+    with tvm.transform.PassContext(config={"tir.unchecked_entry": True}):
+        f = tvm.tir.transform.MakePackedAPI(0)(mod)
+    assert len(f.functions) == 2
+    checked, unchecked = f["main"], f["main_unchecked"]
+    assert unchecked.attrs["global_symbol"] == "main_unchecked"
+    assert len(unchecked.params) == len(checked.params)
+    assert _count_asserts(checked.body) > 0
+    assert _count_asserts(unchecked.body) == 0
+
+
+@tvm.testing.requires_llvm
+def test_unchecked_entry_graph_executor():
+    from tvm import relay
+    from tvm.contrib import graph_executor
+
+    x = relay.var("x", shape=(4, 4), dtype="float32")
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.nn.relu(x + relay.const(1.0))))
+    with tvm.transform.PassContext(opt_level=3, config={"tir.unchecked_entry": True}):
+        lib = relay.build(mod, "llvm")
+    func_name = [n for n in lib.function_metadata.keys() if n.startswith("fused")][0]
+    assert lib.lib.get_function(func_name + "_unchecked", True) is not None
+
+    m = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+    for _ in range(3):
+        data = numpy.random.uniform(-1, 1, size=(4, 4)).astype("float32")
+        m.set_input("x", data)
+        m.run()
+        tvm.testing.assert_allclose(m.get_output(0).numpy(), numpy.maximum(data + 1, 0))
+
+
 if __name__ == "__main__":
     test_makeapi()
+    test_unchecked_entry()
+    test_unchecked_entry_graph_executor()
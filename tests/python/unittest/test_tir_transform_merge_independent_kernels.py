@@ -0,0 +1,97 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import te
+
+
+def _bind(s, tensor, factor):
+    bx, tx = s[tensor].split(tensor.op.axis[0], factor=factor)
+    s[tensor].bind(bx, te.thread_axis("blockIdx.x"))
+    s[tensor].bind(tx, te.thread_axis("threadIdx.x"))
+
+
+def _block_extents(mod):
+    extents = []
+
+    def fvisit(op):
+        if (
+            isinstance(op, tvm.tir.AttrStmt)
+            and op.attr_key == "thread_extent"
+            and op.node.thread_tag == "blockIdx.x"
+        ):
+            extents.append(op.value.value)
+
+    tvm.tir.stmt_functor.post_order_visit(mod["main"].body, fvisit)
+    return extents
+
+
+def test_merge_independent():
+    A = te.placeholder((1024,), name="A")
+    B = te.placeholder((512,), name="B")
+    C = te.compute(A.shape, lambda i: A[i] + 1, name="C")
+    D = te.compute(B.shape, lambda i: B[i] * 2, name="D")
+    s = te.create_schedule([C.op, D.op])
+    _bind(s, C, 64)
+    _bind(s, D, 64)
+    mod = tvm.lower(s, [A, B, C, D])
+    assert sorted(_block_extents(mod)) == [8, 16]
+    mod = tvm.tir.transform.MergeIndependentKernels()(mod)
+    assert _block_extents(mod) == [24]
+
+
+def test_keep_dependent():
+    A = te.placeholder((1024,), name="A")
+    C = te.compute(A.shape, lambda i: A[i] + 1, name="C")
+    D = te.compute(C.shape, lambda i: C[i] * 2, name="D")
+    s = te.create_schedule(D.op)
+    _bind(s, C, 64)
+    _bind(s, D, 64)
+    mod = tvm.lower(s, [A, D])
+    mod = tvm.tir.transform.MergeIndependentKernels()(mod)
+    assert _block_extents(mod) == [16, 16]
+
+
+@tvm.testing.requires_cuda
+def test_merged_kernels_run():
+    A = te.placeholder((1024,), name="A")
+    B = te.placeholder((512,), name="B")
+    C = te.compute(A.shape, lambda i: A[i] + 1, name="C")
+    D = te.compute(B.shape, lambda i: B[i] * 2, name="D")
+    s = te.create_schedule([C.op, D.op])
+    _bind(s, C, 64)
+    _bind(s, D, 64)
+    with tvm.transform.PassContext(config={"tir.merge_independent_kernels": True}):
+        f = tvm.build(s, [A, B, C, D], "cuda")
+    assert len(f.imported_modules[0].get_source().split("__global__")) == 2
+
+    dev = tvm.cuda(0)
+    a = tvm.nd.array(np.random.rand(1024).astype("float32"), dev)
+    b = tvm.nd.array(np.random.rand(512).astype("float32"), dev)
+    c = tvm.nd.empty((1024,), "float32", dev)
+    d = tvm.nd.empty((512,), "float32", dev)
+    f(a, b, c, d)
+    tvm.testing.assert_allclose(c.numpy(), a.numpy() + 1)
+    tvm.testing.assert_allclose(d.numpy(), b.numpy() * 2)
+
+
+if __name__ == "__main__":
+    test_merge_independent()
+    test_keep_dependent()
+    test_merged_kernels_run()
@@ -187,6 +187,36 @@ def test_slice():
     )
 
 
+def test_narrow_below_target():
+    def check(m, n, dtypes):
+        ib = tvm.tir.ir_builder.create()
+        Ab = tvm.tir.decl_buffer((m, n), name="A")
+        A = ib.buffer_ptr(Ab)
+        Bb = tvm.tir.decl_buffer((m, n), name="B")
+        B = ib.buffer_ptr(Bb)
+        with ib.for_range(0, m, name="i") as i:
+            with ib.for_range(0, n, name="j") as j:
+                B[i * n + j] = A[i * n + j] + 1
+                ib.emit(tvm.tir.call_extern("handle", "f", i * n + j))
+        stmt = ib.get()
+        with tvm.transform.PassContext(config={"tir.NarrowDataType": {"min_bits": 8}}):
+            stmt = lower_stmt([Ab, Bb], stmt, 32)
+        assert stmt.loop_var.dtype == dtypes[0]
+        assert stmt.body.loop_var.dtype == dtypes[1]
+        assert stmt.body.body[0].index.dtype == dtypes[2]
+        # The extern call gets its argument in the original dtype
+        assert stmt.body.body[1].value.args[1].dtype == "int32"
+
+    # The index fits into i8
+    check(4, 8, ("int8", "int8", "int8"))
+    # The index only fits into i16, as do the vars used in it
+    check(16, 16, ("int16", "int16", "int16"))
+    # The end of the inner loop does not fit into i8
+    check(1, 128, ("int8", "int16", "int16"))
+    # The index does not fit into i32, as without min_bits
+    check(2 ** 16, 2 ** 16, ("int32", "int32", "int32"))
+
+
 def test_relay_basic():
     engine = relay.backend.compile_engine.get()
 
@@ -263,5 +293,6 @@ if __name__ == "__main__":
     test_multilanes()
     test_reduce()
     test_slice()
+    test_narrow_below_target()
     test_relay_basic()
     test_relay_take()
@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import te
+
+
+def test_reduce_index_strength():
+    C = te.var("C")
+    HW = te.var("HW")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, 4, name="i") as i:
+        with ib.for_range(0, C, name="c") as c:
+            with ib.for_range(0, HW, name="hw") as hw:
+                B[(i * C + c) * HW + hw] = A[(i * C + c) * HW + hw] + A[hw]
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B, C, HW], stmt))
+    stmt = tvm.tir.transform.ReduceIndexStrength()(mod)["main"].body
+
+    stores = []
+    allocs = []
+
+    def visit(n):
+        if isinstance(n, tvm.tir.Store):
+            stores.append(n)
+        if isinstance(n, tvm.tir.Allocate):
+            allocs.append(n)
+
+    tvm.tir.stmt_functor.post_order_visit(stmt, visit)
+    # One register for the hw loop, and one for the c loop setting it up.
+    assert len(allocs) == 2
+    (store,) = [s for s in stores if s.buffer_var.name == "B"]
+    # The shared index is a register, the index of the loop var alone is left as is.
+    assert isinstance(store.index, tvm.tir.Load)
+    assert isinstance(store.value.a.index, tvm.tir.Load)
+    assert store.value.a.index.buffer_var.same_as(store.index.buffer_var)
+    assert isinstance(store.value.b.index, tvm.tir.Var)
+
+
+def test_no_reduction_of_variant_base():
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("int32", name="B")
+    with ib.for_range(0, 16, name="i") as i:
+        # The base reads memory, which the loop can change.
+        A[B[0] + i] = 1.0
+        B[0] = B[0] + 1
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B], stmt))
+    new_stmt = tvm.tir.transform.ReduceIndexStrength()(mod)["main"].body
+    tvm.ir.assert_structural_equal(new_stmt, stmt)
+
+
+@tvm.testing.requires_llvm
+def test_reduce_index_strength_build():
+    n, m = 6, 10
+    A = te.placeholder((n, m), name="A")
+    B = te.compute((n, m), lambda i, j: A[i, j] * 2.0 + A[i, 0], name="B")
+    s = te.create_schedule(B.op)
+
+    with tvm.transform.PassContext(config={"tir.reduce_index_strength": True}):
+        f = tvm.build(s, [A, B], "llvm")
+
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=(n, m)).astype(A.dtype), dev)
+    b = tvm.nd.array(np.zeros((n, m), dtype=B.dtype), dev)
+    f(a, b)
+    a_np = a.numpy()
+    tvm.testing.assert_allclose(b.numpy(), a_np * 2.0 + a_np[:, :1])
+
+
+if __name__ == "__main__":
+    test_reduce_index_strength()
+    test_no_reduction_of_variant_base()
+    test_reduce_index_strength_build()
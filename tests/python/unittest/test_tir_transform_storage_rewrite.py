@@ -640,6 +640,50 @@ def test_large_input():
     tvm.tir.stmt_functor.post_order_visit(stmt, verify)
 
 
+def test_pack_allocations():
+    ib = tvm.tir.ir_builder.create()
+    n = 64
+    out = ib.pointer("float16", name="out")
+    tx = te.thread_axis("threadIdx.x")
+    ib.scope_attr(tx, "thread_extent", 1)
+    A = ib.allocate("float32", n, name="A", scope="shared")
+    B = ib.allocate("int8", 2 * n, name="B", scope="shared")
+    C = ib.allocate("float16", n, name="C", scope="shared")
+    with ib.for_range(0, n, name="i") as i:
+        A[i] = i.astype("float32")
+    with ib.for_range(0, n, name="i") as i:
+        B[i * 2] = A[i].astype("int8")
+    with ib.for_range(0, n, name="i") as i:
+        C[i] = B[i * 2].astype("float16")
+    with ib.for_range(0, n, name="i") as i:
+        out[i] = C[i]
+    body = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([out.asobject()], body))
+    with tvm.transform.PassContext(config={"tir.StorageRewrite": {"pack_allocations": True}}):
+        body = tvm.tir.transform.StorageRewrite()(mod)["main"].body
+
+    allocs = []
+    stores = {}
+
+    def verify(n):
+        if isinstance(n, tvm.tir.Allocate):
+            allocs.append(n)
+        if isinstance(n, tvm.tir.Store) and not n.buffer_var.same_as(out.asobject()):
+            stores[n.value.dtype] = n
+
+    tvm.tir.stmt_functor.post_order_visit(body, verify)
+    # A and C are never alive together, so they share the bytes in front of B.
+    assert len(allocs) == 1
+    assert allocs[0].dtype == "float32"
+    assert allocs[0].extents[0].value == n + n // 2
+    for dtype in ["float32", "int8", "float16"]:
+        assert stores[dtype].buffer_var.same_as(allocs[0].buffer_var)
+    # B starts after the 2048 bits of A, C reuses the bytes of A.
+    assert "256" in str(stores["int8"].index)
+    assert "256" not in str(stores["float16"].index)
+
+
 if __name__ == "__main__":
     test_storage_share()
     test_alloc_seq()
@@ -658,3 +702,4 @@ if __name__ == "__main__":
     test_reuse_small_buffer()
     test_replace_dataflow()
     test_large_input()
+    test_pack_allocations()
@@ -14,7 +14,9 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
+import tvm.testing
 from tvm import te
 
 
@@ -205,6 +207,120 @@ def test_vectorize_while_fail():
         assert expected in error_msg
 
 
+def test_vectorize_with_predication():
+    n = te.var("n")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, 4, kind="vectorize") as i:
+        with ib.if_scope(tvm.tir.likely(i < n)):
+            A[i] = A[i] + 1
+        with ib.else_scope():
+            A[i] = tvm.tir.call_intrin("float32", "tir.if_then_else", i < 2, B[i], 0.0)
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B, n], stmt))
+    with tvm.transform.PassContext(config={"tir.VectorizeLoop": {"enable_predication": True}}):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+
+    assert isinstance(stmt, tvm.tir.SeqStmt)
+    then_case, else_case = stmt[0], stmt[1]
+    assert isinstance(then_case.index, tvm.tir.Ramp)
+    assert then_case.value.dtype == "float32x4"
+    assert then_case.predicate.dtype == "boolx4"
+    assert then_case.value.a.predicate.dtype == "boolx4"
+    assert isinstance(else_case.predicate, tvm.tir.Not)
+    assert isinstance(else_case.value, tvm.tir.Select)
+
+    # The side effects cannot be predicated, so the lanes are still scalarized.
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    with ib.for_range(0, 4, kind="vectorize") as i:
+        with ib.if_scope(i < n):
+            ib.emit(tvm.tir.call_extern("int32", "f", i))
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
+    with tvm.transform.PassContext(config={"tir.VectorizeLoop": {"enable_predication": True}}):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert isinstance(stmt, tvm.tir.For)
+
+
+@tvm.testing.requires_llvm
+def test_vectorize_tail_with_predication():
+    n = 7
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] * 2.0, name="B")
+    s = te.create_schedule(B.op)
+    _, xi = s[B].split(B.op.axis[0], factor=4)
+    s[B].vectorize(xi)
+
+    with tvm.transform.PassContext(config={"tir.VectorizeLoop": {"enable_predication": True}}):
+        mod = tvm.lower(s, [A, B])
+        f = tvm.build(s, [A, B], "llvm")
+
+    stores = []
+    tvm.tir.stmt_functor.post_order_visit(
+        mod["main"].body,
+        lambda x: stores.append(x) if isinstance(x, tvm.tir.Store) else None,
+    )
+    assert len(stores) == 1 and stores[0].value.dtype == "float32x4"
+    assert "llvm.masked.store" in f.get_source("ll")
+
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    b = tvm.nd.array(np.zeros(n, dtype=B.dtype), dev)
+    f(a, b)
+    tvm.testing.assert_allclose(b.numpy(), a.numpy() * 2.0)
+
+
+def test_vectorize_scalable():
+    n = te.var("n")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    with ib.for_range(0, n, kind="vectorize") as i:
+        A[i] = A[i] + 1
+    stmt = ib.get()
+
+    # The lanes of a symbolic extent are left to the backend.
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, n], stmt))
+    stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert isinstance(stmt, tvm.tir.For)
+    assert stmt.kind == tvm.tir.ForKind.SERIAL
+    assert "scalable_vectorize" in stmt.annotations
+
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    with ib.for_range(0, 16, kind="vectorize") as i:
+        A[i] = A[i] + 1
+    stmt = ib.get()
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A], stmt))
+    with tvm.transform.PassContext(config={"tir.VectorizeLoop": {"scalable": True}}):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert isinstance(stmt, tvm.tir.For)
+    assert "scalable_vectorize" in stmt.annotations
+    assert stmt.body.value.dtype == "float32"
+
+
+@tvm.testing.requires_llvm
+def test_vectorize_scalable_llvm():
+    n = te.var("n")
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] * 2.0, name="B")
+    s = te.create_schedule(B.op)
+    s[B].vectorize(B.op.axis[0])
+
+    with tvm.transform.PassContext(config={"tir.VectorizeLoop": {"scalable": True}}):
+        f = tvm.build(s, [A, B], "llvm")
+
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=37).astype(A.dtype), dev)
+    b = tvm.nd.array(np.zeros(37, dtype=B.dtype), dev)
+    f(a, b)
+    tvm.testing.assert_allclose(b.numpy(), a.numpy() * 2.0)
+
+
 if __name__ == "__main__":
     test_vectorize_vector()
     test_vectorize_with_if()
@@ -214,3 +330,7 @@ if __name__ == "__main__":
     test_vectorize_with_ge_cond()
     test_vectorize_let()
     test_vectorize_while_fail()
+    test_vectorize_with_predication()
+    test_vectorize_tail_with_predication()
+    test_vectorize_scalable()
+    test_vectorize_scalable_llvm()
@@ -0,0 +1,44 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+from tvm import te
+from tvm.tir.transform import _ffi_api
+
+
+def test_lift_alloc_to_loop_begin():
+    n = te.var("n")
+    i = te.var("i")
+    A = te.var("A", "handle")
+    B = te.var("B", "handle")
+    alloc = tvm.tir.Allocate(
+        B, "float32", [16], tvm.tir.const(1, "bool"), tvm.tir.Store(B, 1.0, 0)
+    )
+    body = tvm.tir.SeqStmt([tvm.tir.Store(A, 0.0, i), alloc])
+    loop = tvm.tir.For(i, 0, n, tvm.tir.ForKind.SERIAL, body)
+
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([n, A], loop))
+    stmt = _ffi_api.VTALiftAllocToScopeBegin()(mod)["main"].body
+
+    assert isinstance(stmt, tvm.tir.For)
+    assert isinstance(stmt.body, tvm.tir.Allocate)
+    assert stmt.body.buffer_var.same_as(B)
+    assert isinstance(stmt.body.body, tvm.tir.SeqStmt)
+    assert isinstance(stmt.body.body[1], tvm.tir.Store)
+
+
+if __name__ == "__main__":
+    test_lift_alloc_to_loop_begin()
@@ -16,12 +16,17 @@
 # under the License.
 
 """Defines AutoTVM components used with VTA."""
+import json
+import os
+import time
 
-from tvm.autotvm.measure import default_module_loader
+from tvm.error import TVMError
+from tvm.autotvm.measure import default_module_loader, LocalExecutor, MeasureErrorNo
+from tvm.autotvm.measure import MeasureResult, RPCRunner, request_remote
 from . import rpc_client
 
 
-def module_loader(bitstream=None):
+def module_loader(bitstream=None, force_program=True):
     """Construct a ModuleLoader implementation specialized for VTA.
 
     Parameters
@@ -29,6 +34,10 @@ def module_loader(bitstream=None):
     bitsream : Optional[str]
         Path to the bitstream to write prior to uploading code.
 
+    force_program : bool
+        Whether to program the bitstream for every measurement, or only when
+        the board holds a different one.
+
     Returns
     -------
     ModuleLoader :
@@ -46,7 +55,195 @@ def module_loader(bitstream=None):
         _build_result : tvm.autotvm.measure.measure_methods.BuildResult
             Artifact from the build phase, unused here.
         """
-        rpc_client.program_fpga(remote, bitstream)
+        rpc_client.program_fpga(remote, bitstream, force=force_program)
         rpc_client.reconfig_runtime(remote)
 
     return default_module_loader(reprogram_fpga)
+
+
+class BatchedRPCRunner(RPCRunner):
+    """Run VTA kernels on remote boards, many measurements per session.
+
+    Each batch of up to ``batch_size`` kernels is measured in a single RPC
+    session: the board is programmed only when it holds a different bitstream,
+    all the kernels are uploaded, then timed by one call to the RPC server.
+    Batches run in parallel on up to ``n_parallel`` boards.
+
+    Parameters
+    ----------
+    key, host, port, priority, timeout, n_parallel, number, repeat, min_repeat_ms,
+    cooldown_interval :
+        Same as for :py:class:`tvm.autotvm.RPCRunner`. The timeout applies to
+        each kernel, a batch may take ``timeout`` per kernel it holds.
+
+    bitstream : Optional[str]
+        Path to the bitstream to program, see :py:func:`vta.program_fpga`.
+
+    batch_size : int
+        Maximum number of kernels measured in one session.
+    """
+
+    def __init__(
+        self,
+        key,
+        host,
+        port,
+        priority=1,
+        timeout=10,
+        n_parallel=None,
+        number=4,
+        repeat=3,
+        min_repeat_ms=0,
+        cooldown_interval=0.1,
+        bitstream=None,
+        batch_size=16,
+    ):
+        super(BatchedRPCRunner, self).__init__(
+            key,
+            host,
+            port,
+            priority=priority,
+            timeout=timeout,
+            n_parallel=n_parallel,
+            number=number,
+            repeat=repeat,
+            min_repeat_ms=min_repeat_ms,
+            cooldown_interval=cooldown_interval,
+        )
+        self.bitstream = bitstream
+        self.batch_size = batch_size
+        self.executor = LocalExecutor(timeout=timeout * (batch_size + 1))
+
+    def run(self, measure_inputs, build_results):
+        results = list(build_results)
+        # Failed builds are already results
+        pending = [i for i, res in enumerate(build_results) if not isinstance(res, MeasureResult)]
+        batches = [
+            pending[i : i + self.batch_size] for i in range(0, len(pending), self.batch_size)
+        ]
+        remote_kwargs = dict(
+            device_key=self.key,
+            host=self.host,
+            port=self.port,
+            priority=self.priority,
+            timeout=self.timeout * (self.batch_size + 1),
+        )
+
+        for i in range(0, len(batches), self.n_parallel):
+            futures = []
+            for batch in batches[i : i + self.n_parallel]:
+                ret = self.executor.submit(
+                    run_batch_through_rpc,
+                    [measure_inputs[j] for j in batch],
+                    [build_results[j] for j in batch],
+                    self.number,
+                    self.repeat,
+                    self.min_repeat_ms,
+                    self.cooldown_interval,
+                    remote_kwargs,
+                    self.bitstream,
+                )
+                futures.append((batch, ret))
+
+            for batch, future in futures:
+                res = future.get()
+                if isinstance(res, Exception):  # executor error or timeout
+                    res = [
+                        MeasureResult(
+                            (str(res),), MeasureErrorNo.RUN_TIMEOUT, self.timeout, time.time()
+                        )
+                    ] * len(batch)
+                for j, batch_res in zip(batch, res):
+                    results[j] = batch_res
+
+        return results
+
+
+def run_batch_through_rpc(
+    measure_inputs,
+    build_results,
+    number,
+    repeat,
+    min_repeat_ms,
+    cooldown_interval,
+    remote_kwargs,
+    bitstream=None,
+):
+    """Measure a batch of built VTA kernels in one RPC session.
+
+    Parameters
+    ----------
+    measure_inputs : List[MeasureInput]
+        The raw measure inputs.
+
+    build_results : List[BuildResult]
+        The successful build results of the inputs.
+
+    number, repeat, min_repeat_ms, cooldown_interval :
+        Same as for :py:func:`tvm.autotvm.measure.measure_methods.run_through_rpc`.
+
+    remote_kwargs : dict
+        Keyword args to request_remote().
+
+    bitstream : Optional[str]
+        Path to the bitstream to program if the board holds another one.
+
+    Returns
+    -------
+    results : List[MeasureResult]
+        The result of each kernel.
+    """
+    tic = time.time()
+    remote = None
+    try:
+        remote = request_remote(**remote_kwargs)
+        rpc_client.program_fpga(remote, bitstream, force=False)
+        rpc_client.reconfig_runtime(remote)
+        kernels = []
+        for measure_inp, build_res in zip(measure_inputs, build_results):
+            remote.upload(build_res.filename)
+            kernels.append(
+                {
+                    "file": os.path.split(build_res.filename)[1],
+                    "args": [[list(shape), dtype] for shape, dtype in build_res.arg_info],
+                    # the index tensor of scatter op cannot be randomly initialized
+                    "random_fill": "scatter" not in measure_inp.task.name,
+                }
+            )
+        fmeasure = remote.get_function("tvm.contrib.vta.measure_batch")
+        outputs = json.loads(
+            fmeasure(
+                json.dumps(
+                    {
+                        "target": str(measure_inputs[0].target),
+                        "number": number,
+                        "repeat": repeat,
+                        "min_repeat_ms": min_repeat_ms,
+                        "kernels": kernels,
+                    }
+                )
+            )
+        )
+    except TVMError as exc:
+        outputs = [{"error": str(exc)[:1024]}] * len(build_results)
+    finally:
+        if remote is not None:
+            remote.remove("")
+
+    tstamp = time.time()
+    # The session cost is shared by the kernels of the batch
+    batch_cost = (tstamp - tic) / len(build_results)
+    results = []
+    for build_res, out in zip(build_results, outputs):
+        if "error" in out:
+            costs = (RuntimeError(out["error"]),)
+            errno = MeasureErrorNo.RUNTIME_DEVICE
+        else:
+            costs = out["costs"]
+            if len(costs) > 2:  # remove largest and smallest value to reduce variance
+                costs = sorted(costs)[1:-1]
+            costs = tuple(costs)
+            errno = MeasureErrorNo.NO_ERROR
+        results.append(MeasureResult(costs, errno, batch_cost + build_res.time_cost, tstamp))
+    time.sleep(cooldown_interval)
+    return results
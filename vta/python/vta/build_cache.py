@@ -0,0 +1,147 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""On-disk cache of the modules compiled by vta.build"""
+import hashlib
+import logging
+import os
+import shutil
+import tempfile
+
+import tvm
+
+from .environment import get_env
+
+logger = logging.getLogger("vta")
+
+_LIB_FILE = "lib.ll"
+_GRAPH_FILE = "graph.json"
+_PARAMS_FILE = "params.bin"
+
+
+class BuildCache(object):
+    """Persistent cache of compiled VTA modules.
+
+    An entry is keyed by the hash of the VTA environment (configuration and
+    bitstream), the structural hash of the input module, the build options
+    and the TVM version. The host code of VTA modules is kept as LLVM IR, so
+    that modules cross-compiled for the board are restored on any host.
+
+    Parameters
+    ----------
+    path : str
+        The cache directory, created if it does not exist.
+    """
+
+    def __init__(self, path):
+        self.path = os.path.abspath(os.path.expanduser(path))
+        os.makedirs(self.path, exist_ok=True)
+
+    def key(self, mod, *options, params=None):
+        """Compute the key of a build.
+
+        Parameters
+        ----------
+        mod : IRModule
+            The module to build.
+
+        options : list of object
+            Build options that change the result, such as the targets.
+
+        params : dict of str to NDArray, optional
+            The parameters bound into a relay module.
+
+        Returns
+        -------
+        key : str
+            The cache key.
+        """
+        pass_ctx = tvm.transform.PassContext.current()
+        lower_passes = pass_ctx.config.get("tir.add_lower_pass", [])
+        hasher = hashlib.sha256()
+        for item in [
+            tvm.__version__,
+            get_env().config_hash,
+            tvm.ir.structural_hash(mod),
+            pass_ctx.opt_level,
+            sorted(pass_ctx.required_pass),
+            sorted(pass_ctx.disabled_pass),
+            [(int(phase), fpass.info.name) for phase, fpass in lower_passes],
+        ] + [str(option) for option in options]:
+            hasher.update(str(item).encode("utf-8"))
+        if params:
+            hasher.update(tvm.runtime.save_param_dict(params))
+        return hasher.hexdigest()
+
+    def load(self, key):
+        """Load a cached build.
+
+        Parameters
+        ----------
+        key : str
+            The cache key.
+
+        Returns
+        -------
+        result : runtime.Module or GraphExecutorFactoryModule or None
+            The module, or None if the cache has no entry for the key.
+        """
+        entry = os.path.join(self.path, key)
+        if not os.path.isdir(entry):
+            return None
+        load_ll = tvm.get_global_func("runtime.module.loadfile_ll")
+        lib = load_ll(os.path.join(entry, _LIB_FILE), "ll")
+        graph_path = os.path.join(entry, _GRAPH_FILE)
+        if not os.path.exists(graph_path):
+            return lib
+        # pylint: disable=import-outside-toplevel
+        from tvm.relay.backend.executor_factory import GraphExecutorFactoryModule
+
+        with open(graph_path) as graph_file:
+            graph_json = graph_file.read()
+        with open(os.path.join(entry, _PARAMS_FILE), "rb") as params_file:
+            params = tvm.runtime.load_param_dict(params_file.read())
+        return GraphExecutorFactoryModule(None, None, graph_json, lib, "default", params, {})
+
+    def save(self, key, result):
+        """Save a build, unless its modules cannot be restored from the cache.
+
+        Parameters
+        ----------
+        key : str
+            The cache key.
+
+        result : runtime.Module or GraphExecutorFactoryModule
+            The result of tvm.build or relay.build.
+        """
+        graph_json = getattr(result, "graph_json", None)
+        lib = result.lib if graph_json is not None else result
+        if lib.type_key != "llvm" or lib.imported_modules:
+            logger.debug("Build of %s is not cached: its module is not plain LLVM", key)
+            return
+        entry = os.path.join(self.path, key)
+        tmp_dir = tempfile.mkdtemp(dir=self.path)
+        lib.save(os.path.join(tmp_dir, _LIB_FILE), "ll")
+        if graph_json is not None:
+            with open(os.path.join(tmp_dir, _GRAPH_FILE), "w") as graph_file:
+                graph_file.write(graph_json)
+            with open(os.path.join(tmp_dir, _PARAMS_FILE), "wb") as params_file:
+                params_file.write(tvm.runtime.save_param_dict(result.params))
+        try:
+            os.rename(tmp_dir, entry)
+        except OSError:
+            # Another process stored the same build first
+            shutil.rmtree(tmp_dir, ignore_errors=True)
@@ -16,8 +16,12 @@
 # under the License.
 # pylint: disable=unused-argument, invalid-name
 """VTA specific buildin for runtime."""
+import inspect
+import os
+
 import tvm
 from . import transform
+from .build_cache import BuildCache
 from .environment import get_env
 
 
@@ -59,7 +63,8 @@ def build_config(debug_flag=0, **kwargs):
     """
     env = get_env()
 
-    @tvm.tir.transform.prim_func_pass(opt_level=0)
+    # The flag is part of the pass name, which keys cached builds
+    @tvm.tir.transform.prim_func_pass(opt_level=0, name="tir.vta.AddDebug%d" % debug_flag)
     def add_debug(f, *_):
         debug = tvm.tir.call_extern("int32", "VTASetDebugMode", env.dev.command_handle, debug_flag)
 
@@ -107,12 +112,21 @@ def lower(*args, **kwargs):
     return tvm.lower(*args, **kwargs)
 
 
-def build(*args, **kwargs):
+def build(*args, cache_dir=None, **kwargs):
     """Thin wrapper of tvm.build
 
     This wrapper automatically applies VTA's build_config
     if there is no user specified build_config in context.
 
+    Relay modules and functions are built with relay.build instead.
+
+    Parameters
+    ----------
+    cache_dir : str, optional
+        Directory of a persistent build cache, see :py:class:`vta.build_cache.BuildCache`.
+        Defaults to the VTA_BUILD_CACHE environment variable, the cache is
+        not used if neither is set.
+
     See Also
     --------
     tvm.build : The original TVM's build function
@@ -120,8 +134,46 @@ def build(*args, **kwargs):
     pass_ctx = tvm.transform.PassContext.current()
     if not pass_ctx.config.get("tir.add_lower_pass"):
         with build_config():
-            return tvm.build(*args, **kwargs)
-    return tvm.build(*args, **kwargs)
+            return _build(cache_dir, *args, **kwargs)
+    return _build(cache_dir, *args, **kwargs)
+
+
+def _build(cache_dir, inputs, *args, **kwargs):
+    # pylint: disable=import-outside-toplevel
+    from tvm import relay
+
+    if isinstance(inputs, relay.Function):
+        inputs = tvm.IRModule.from_expr(inputs)
+    is_relay = isinstance(inputs, tvm.IRModule) and any(
+        isinstance(func, relay.Function) for func in inputs.functions.values()
+    )
+    fbuild = relay.build if is_relay else tvm.build
+    cache_dir = cache_dir or os.environ.get("VTA_BUILD_CACHE")
+    if not cache_dir:
+        return fbuild(inputs, *args, **kwargs)
+
+    signature = inspect.signature(fbuild)
+    bound = signature.bind(inputs, *args, **kwargs)
+    bound.apply_defaults()
+    options = dict(bound.arguments)
+    del options[next(iter(signature.parameters))]
+    if isinstance(inputs, (tvm.te.Schedule, tvm.tir.PrimFunc)):
+        # Schedules have no structural hash, key on the lowered module
+        build_args, binds = options.pop("args"), options.pop("binds")
+        inputs = tvm.lower(inputs, build_args, name=options["name"], binds=binds)
+    elif not isinstance(inputs, tvm.IRModule):
+        return fbuild(inputs, *args, **kwargs)
+    params = options.pop("params", None)
+
+    cache = BuildCache(cache_dir)
+    key = cache.key(inputs, fbuild.__module__, sorted(options.items()), params=params)
+    result = cache.load(key)
+    if result is None:
+        if params is not None:
+            options["params"] = params
+        result = fbuild(inputs, **options)
+        cache.save(key, result)
+    return result
 
 
 # Register key ops
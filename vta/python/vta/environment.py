@@ -21,6 +21,8 @@ from __future__ import absolute_import as _abs
 import os
 import json
 import copy
+import hashlib
+import threading
 import tvm
 from tvm import te
 from tvm.ir import register_intrin_lowering
@@ -116,9 +118,32 @@ class Environment(object):
       with vta.Environment(new_cfg):
           # env works on the new environment
           env = vta.get_env()
+
+    Environment scopes are local to the thread that enters them, so that
+    threads can compile for different configurations at the same time. The
+    threads outside of any scope, such as the workers compiling the programs
+    of task extraction, see the scopes of the thread that entered its
+    outermost scope last, and the default environment if there is none. An
+    environment bound to a device id with :py:meth:`bind` is the environment
+    of the modules running on that VTA device.
+
+    .. code-block:: python
+
+      small = vta.Environment(small_cfg).bind(0)
+      large = vta.Environment(large_cfg).bind(1)
+      with large:
+          lib = vta.build(mod, target=large.target, target_host=large.target_host)
+      m = graph_executor.GraphModule(lib["default"](remote.ext_dev(large.device_id)))
     """
 
+    # the default environment of threads outside of any scope
     current = None
+    # environments bound to VTA device ids
+    _devices = {}
+    _local = threading.local()
+    # scope stacks of the threads inside a scope, outermost entry last
+    _shared = []
+    _shared_lock = threading.Lock()
     # constants
     MAX_XFER = 1 << 22
     # debug flags
@@ -126,6 +151,11 @@ class Environment(object):
     DEBUG_DUMP_UOP = 1 << 2
     DEBUG_SKIP_READ_BARRIER = 1 << 3
     DEBUG_SKIP_WRITE_BARRIER = 1 << 4
+    DEBUG_TRACE = 1 << 7
+    DEBUG_SKIP_UOP_COMPRESS = 1 << 9
+    # optimization flags, passed like the debug flags
+    OPT_INSN_PEEPHOLE = 1 << 6
+    OPT_GRAPH_PREFETCH = 1 << 8
     # memory scopes
     inp_scope = "local.inp_buffer"
     wgt_scope = "local.wgt_buffer"
@@ -173,20 +203,80 @@ class Environment(object):
         self.mock_mode = False
         self._mock_env = None
         self._dev_ctx = None
-        self._last_env = None
+        self.device_id = None
+
+    @staticmethod
+    def _scopes():
+        if not hasattr(Environment._local, "scopes"):
+            Environment._local.scopes = []
+        return Environment._local.scopes
 
     def __enter__(self):
-        self._last_env = Environment.current
-        Environment.current = self
+        scopes = Environment._scopes()
+        with Environment._shared_lock:
+            if not scopes:
+                Environment._shared.append(scopes)
+            scopes.append(self)
         return self
 
     def __exit__(self, ptype, value, trace):
-        Environment.current = self._last_env
+        scopes = Environment._scopes()
+        with Environment._shared_lock:
+            scopes.pop()
+            if not scopes:
+                Environment._shared = [x for x in Environment._shared if x is not scopes]
+
+    @staticmethod
+    def _innermost():
+        scopes = Environment._scopes()
+        if scopes:
+            return scopes[-1]
+        with Environment._shared_lock:
+            if Environment._shared:
+                return Environment._shared[-1][-1]
+        return None
+
+    def bind(self, device_id):
+        """Bind the environment to a VTA device, see :py:func:`get_env`.
+
+        Parameters
+        ----------
+        device_id : int
+            The device id of the ext_dev running this configuration.
+
+        Returns
+        -------
+        env : Environment
+            The environment itself.
+        """
+        bound = Environment._devices.get(device_id)
+        if bound is not None and bound is not self:
+            bound.device_id = None
+        Environment._devices[device_id] = self
+        self.device_id = device_id
+        return self
+
+    def device(self, remote=None):
+        """The VTA device the environment is bound to.
+
+        Parameters
+        ----------
+        remote : RPCSession, optional
+            The session of the board, a local device is returned if unset.
+        """
+        device_id = 0 if self.device_id is None else self.device_id
+        return remote.ext_dev(device_id) if remote is not None else tvm.ext_dev(device_id)
 
     @property
     def cfg_dict(self):
         return self.pkg.cfg_dict
 
+    @property
+    def config_hash(self):
+        """Hash of the hardware configuration, modules compiled for equal hashes are identical"""
+        key = json.dumps(self.cfg_dict, sort_keys=True) + self.MODEL + str(self.mock_mode)
+        return hashlib.sha256(key.encode("utf-8")).hexdigest()
+
     @property
     def dev(self):
         """Developer context"""
@@ -244,15 +334,27 @@ class Environment(object):
         return tvm.target.arm_cpu(model=self.TARGET)
 
 
-def get_env():
+def get_env(device_id=None):
     """Get the current VTA Environment.
 
+    Parameters
+    ----------
+    device_id : int, optional
+        Get the environment bound to this device id instead.
+
     Returns
     -------
     env : Environment
-        The current environment.
+        The innermost environment scope of the calling thread if any, else
+        the innermost scope shared by the other threads, see
+        :py:class:`Environment`, else the default environment.
     """
-    return Environment.current
+    if device_id is not None:
+        if device_id not in Environment._devices:
+            raise ValueError("No VTA environment is bound to device %d" % device_id)
+        return Environment._devices[device_id]
+    scope = Environment._innermost()
+    return scope if scope is not None else Environment.current
 
 
 # The memory information for the compiler
@@ -292,6 +394,12 @@ def mem_info_acc_buffer():
     )
 
 
+# The GEMM intrinsic tensorized by the auto-scheduler sketches of VTA
+@tvm.register_func("auto_scheduler.tensor_intrin.vta_gemm")
+def auto_scheduler_gemm_intrin():
+    return get_env().gemm
+
+
 # TVM Op related registration
 @register_intrin_lowering("tir.vta.coproc_sync", "default")
 def coproc_sync(op):
@@ -22,9 +22,13 @@ from __future__ import absolute_import
 
 import logging
 import argparse
+import functools
+import hashlib
 import os
 import ctypes
 import json
+import shutil
+import tempfile
 import tvm
 from tvm import rpc
 from tvm.contrib import cc
@@ -34,6 +38,126 @@ from ..environment import get_env, pkg_config
 from ..libinfo import find_libvta
 
 
+class ContentCache(object):
+    """Files kept on the board across sessions, by the SHA-256 of their content.
+
+    The least recently used files are removed past the size limit. The sessions
+    share the cache directory, its files are only created by atomic renames.
+
+    Parameters
+    ----------
+    path : str
+        The cache directory.
+
+    max_bytes : int
+        The size limit of the cache.
+    """
+
+    def __init__(self, path, max_bytes):
+        self.path = path
+        self.max_bytes = max_bytes
+        os.makedirs(path, exist_ok=True)
+
+    def fetch(self, digest, dst):
+        """Place the cached file of a digest at dst.
+
+        Returns
+        -------
+        found : bool
+            Whether the cache holds the digest.
+        """
+        entry = os.path.join(self.path, digest)
+        try:
+            os.utime(entry)
+            if os.path.exists(dst):
+                os.remove(dst)
+            try:
+                os.link(entry, dst)
+            except OSError:
+                shutil.copyfile(entry, dst)
+        except FileNotFoundError:
+            # Not cached, or evicted by another session meanwhile
+            return False
+        return True
+
+    def store(self, src, digest):
+        """Add a copy of the file src under its digest."""
+        entry = os.path.join(self.path, digest)
+        if os.path.exists(entry):
+            os.utime(entry)
+            return
+        temp = "%s.%d.tmp" % (entry, os.getpid())
+        shutil.copyfile(src, temp)
+        os.replace(temp, entry)
+        self.evict()
+
+    def evict(self):
+        """Remove the least recently used files past the size limit."""
+        entries = []
+        for name in os.listdir(self.path):
+            if name.endswith(".tmp"):
+                continue
+            try:
+                stat = os.stat(os.path.join(self.path, name))
+            except FileNotFoundError:
+                continue
+            entries.append((stat.st_mtime, stat.st_size, name))
+        total = sum(size for _, size, _ in entries)
+        for _, size, name in sorted(entries):
+            if total <= self.max_bytes:
+                break
+            try:
+                os.remove(os.path.join(self.path, name))
+            except FileNotFoundError:
+                pass
+            total -= size
+
+
+# The state of the server process, inherited by the sessions it forks
+_SERVER = {"cache": None, "preload": False}
+_RUNTIME_DLL = []
+
+
+def _load_vta_dll():
+    """Load the VTA runtime once per process."""
+    dll_path = find_libvta("libvta")[0]
+    if not _RUNTIME_DLL:
+        logging.info("Loading VTA library: %s", dll_path)
+        _RUNTIME_DLL.append(ctypes.CDLL(dll_path, ctypes.RTLD_GLOBAL))
+    return _RUNTIME_DLL[0]
+
+
+def init_server(cache_dir=None, cache_bytes=1 << 30, preload=False):
+    """Initialize the server process before it serves any session.
+
+    Parameters
+    ----------
+    cache_dir : str, optional
+        The directory caching the uploaded files across sessions, no caching if unset.
+
+    cache_bytes : int
+        The size limit of the cache.
+
+    preload : bool
+        Whether to load the VTA runtime once in the server process, which the
+        sessions inherit instead of loading it again. The runtime can then only
+        be reconfigured by restarting the server.
+    """
+    if cache_dir:
+        _SERVER["cache"] = ContentCache(cache_dir, cache_bytes)
+    if preload:
+        _load_vta_dll()
+        _SERVER["preload"] = True
+
+
+def _server_init_callback(cache_dir, cache_bytes, preload):
+    # pylint: disable=import-outside-toplevel
+    # Run in the server process, registering the functions of the sessions
+    from vta.exec import rpc_server
+
+    rpc_server.init_server(cache_dir, cache_bytes, preload)
+
+
 @tvm.register_func("tvm.rpc.server.start", override=True)
 def server_start():
     """VTA RPC server extension."""
@@ -42,25 +166,61 @@ def server_start():
     proj_root = os.path.abspath(os.path.join(curr_path, "../../../../"))
     dll_path = find_libvta("libvta")[0]
     cfg_path = os.path.abspath(os.path.join(proj_root, "3rdparty/vta-hw/config/vta_config.json"))
-    runtime_dll = []
+    # Outlives the sessions, but not a reboot that also clears the FPGA
+    hash_path = os.path.join(tempfile.gettempdir(), "vta_bitstream.sha256")
+    cache = _SERVER["cache"]
+    workpath = tvm.get_global_func("tvm.rpc.server.workpath")
     _load_module = tvm.get_global_func("tvm.rpc.server.load_module")
+    _upload = tvm.get_global_func("tvm.rpc.server.upload")
 
-    def load_vta_dll():
-        """Try to load vta dll"""
-        if not runtime_dll:
-            runtime_dll.append(ctypes.CDLL(dll_path, ctypes.RTLD_GLOBAL))
-        logging.info("Loading VTA library: %s", dll_path)
-        return runtime_dll[0]
+    @tvm.register_func("tvm.rpc.server.upload", override=True)
+    def upload(file_name, blob):
+        path = workpath(file_name)
+        # The file may be a link to a cached one, which must not be overwritten
+        if os.path.exists(path):
+            os.remove(path)
+        _upload(file_name, blob)
+        if cache is not None:
+            cache.store(path, hashlib.sha256(blob).hexdigest())
+
+    @tvm.register_func("tvm.contrib.vta.cache_fetch", override=True)
+    def cache_fetch(digest, file_name):
+        """Place a cached file in the work directory instead of uploading it.
+
+        Parameters
+        ----------
+        digest : str
+            The SHA-256 hex digest of the file content.
+
+        file_name : str
+            The name of the file in the work directory.
+
+        Returns
+        -------
+        found : bool
+            Whether the file was cached, otherwise it has to be uploaded.
+        """
+        if cache is None:
+            return False
+        found = cache.fetch(digest, workpath(file_name))
+        logging.info("Cache %s for %s", "hit" if found else "miss", file_name)
+        return found
 
     @tvm.register_func("tvm.rpc.server.load_module", override=True)
     def load_module(file_name):
-        load_vta_dll()
+        _load_vta_dll()
         return _load_module(file_name)
 
-    @tvm.register_func("device_api.ext_dev")
-    def ext_dev_callback():
-        load_vta_dll()
-        return tvm.get_global_func("device_api.ext_dev")()
+    if not _RUNTIME_DLL:
+        # Loading the runtime registers its own device_api.ext_dev
+        @tvm.register_func("device_api.ext_dev")
+        def ext_dev_callback():
+            _load_vta_dll()
+            return tvm.get_global_func("device_api.ext_dev")()
+
+    def forget_bitstream():
+        if os.path.isfile(hash_path):
+            os.remove(hash_path)
 
     @tvm.register_func("tvm.contrib.vta.init", override=True)
     def program_fpga(file_name):
@@ -73,19 +233,73 @@ def server_start():
             xlnk.Xlnk().xlnk_reset()
         elif env.TARGET == "de10nano":
             # Load the de10nano program function.
-            load_vta_dll()
+            _load_vta_dll()
         elif env.TARGET == "de10pro":
             # Load the de10pro program function.
-            load_vta_dll()
+            _load_vta_dll()
         path = tvm.get_global_func("tvm.rpc.server.workpath")(file_name)
+        forget_bitstream()
         program_bitstream.bitstream_program(env.TARGET, path)
+        with open(hash_path, "w") as hash_file:
+            hash_file.write(program_bitstream.bitstream_hash(path))
         logging.info("Program FPGA with %s ", file_name)
 
+    @tvm.register_func("tvm.contrib.vta.bitstream_hash", override=True)
+    def bitstream_hash():
+        """Hash of the bitstream programmed by this server, empty if unknown"""
+        if not os.path.isfile(hash_path):
+            return ""
+        with open(hash_path, "r") as hash_file:
+            return hash_file.read().strip()
+
+    @tvm.register_func("tvm.contrib.vta.measure_batch", override=True)
+    def measure_batch(batch_json):
+        """Time several uploaded kernels in one call.
+
+        Parameters
+        ----------
+        batch_json : str
+            JSON object with the device "target", the time evaluator settings
+            "number", "repeat" and "min_repeat_ms", and the "kernels" to time.
+            Each kernel has the uploaded "file", the "args" as a list of
+            [shape, dtype] and whether to "random_fill" them.
+
+        Returns
+        -------
+        results : str
+            JSON list with, for each kernel, either its "costs" or an "error".
+        """
+        batch = json.loads(batch_json)
+        dev = tvm.device(batch["target"], 0)
+        random_fill = tvm.get_global_func("tvm.contrib.random.random_fill")
+        results = []
+        for kernel in batch["kernels"]:
+            try:
+                mod = load_module(kernel["file"])
+                time_f = mod.time_evaluator(
+                    mod.entry_name,
+                    dev,
+                    number=batch["number"],
+                    repeat=batch["repeat"],
+                    min_repeat_ms=batch["min_repeat_ms"],
+                )
+                args = [tvm.nd.empty(shape, dtype, dev) for shape, dtype in kernel["args"]]
+                if kernel["random_fill"]:
+                    for arg in args:
+                        random_fill(arg)
+                dev.sync()
+                results.append({"costs": list(time_f(*args).results)})
+            except tvm.TVMError as exc:
+                # The board may be left in a bad state, program it again next time
+                forget_bitstream()
+                results.append({"error": str(exc)[:1024]})
+        return json.dumps(results)
+
     @tvm.register_func("tvm.rpc.server.shutdown", override=True)
     def server_shutdown():
-        if runtime_dll:
-            runtime_dll[0].VTARuntimeShutdown()
-            runtime_dll.pop()
+        if _RUNTIME_DLL:
+            _RUNTIME_DLL[0].VTARuntimeShutdown()
+            _RUNTIME_DLL.pop()
 
     @tvm.register_func("tvm.contrib.vta.reconfig_runtime", override=True)
     def reconfig_runtime(cfg_json):
@@ -97,10 +311,6 @@ def server_start():
             JSON string used for configurations.
         """
         env = get_env()
-        if runtime_dll:
-            if env.TARGET == "de10nano":
-                print("Please reconfigure the runtime AFTER programming a bitstream.")
-            raise RuntimeError("Can only reconfig in the beginning of session...")
         cfg = json.loads(cfg_json)
         cfg["TARGET"] = env.TARGET
         pkg = pkg_config(cfg)
@@ -110,19 +320,39 @@ def server_start():
             if pkg.same_config(old_cfg):
                 logging.info("Skip reconfig_runtime due to same config.")
                 return
+        if _RUNTIME_DLL:
+            if env.TARGET == "de10nano":
+                print("Please reconfigure the runtime AFTER programming a bitstream.")
+            if _SERVER["preload"]:
+                raise RuntimeError("The runtime is preloaded, restart the server to reconfig...")
+            raise RuntimeError("Can only reconfig in the beginning of session...")
         cflags = ["-O2", "-std=c++14"]
         cflags += pkg.cflags
         ldflags = pkg.ldflags
         lib_name = dll_path
         source = pkg.lib_source
-        logging.info(
-            "Rebuild runtime:\n output=%s,\n cflags=%s,\n source=%s,\n ldflags=%s",
-            dll_path,
-            "\n\t".join(cflags),
-            "\n\t".join(source),
-            "\n\t".join(ldflags),
-        )
-        cc.create_shared(lib_name, source, cflags + ldflags)
+        # The runtimes built before are cached by configuration and sources
+        sha = hashlib.sha256("\n".join([pkg.cfg_json] + cflags + ldflags).encode())
+        for src in source:
+            with open(src, "rb") as src_file:
+                sha.update(src_file.read())
+        digest = "libvta-" + sha.hexdigest()
+        if cache is not None and cache.fetch(digest, lib_name):
+            logging.info("Reuse cached runtime %s", digest)
+        else:
+            logging.info(
+                "Rebuild runtime:\n output=%s,\n cflags=%s,\n source=%s,\n ldflags=%s",
+                dll_path,
+                "\n\t".join(cflags),
+                "\n\t".join(source),
+                "\n\t".join(ldflags),
+            )
+            if os.path.exists(lib_name):
+                # It may be a link to a cached runtime
+                os.remove(lib_name)
+            cc.create_shared(lib_name, source, cflags + ldflags)
+            if cache is not None:
+                cache.store(lib_name, digest)
         with open(cfg_path, "w") as outputfile:
             outputfile.write(pkg.cfg_json)
 
@@ -139,6 +369,20 @@ def main():
         "--key", type=str, default="", help="RPC key used to identify the connection type."
     )
     parser.add_argument("--tracker", type=str, default="", help="Report to RPC tracker")
+    parser.add_argument(
+        "--cache-dir",
+        type=str,
+        default=os.path.expanduser("~/.vta_cache/rpc_server"),
+        help="The directory caching the uploaded files across sessions, empty to disable",
+    )
+    parser.add_argument(
+        "--cache-size", type=int, default=1024, help="The size limit of the cache in MB"
+    )
+    parser.add_argument(
+        "--preload",
+        action="store_true",
+        help="Load the VTA runtime once in the server instead of in every session",
+    )
     args = parser.parse_args()
     logging.basicConfig(level=logging.INFO)
 
@@ -152,7 +396,14 @@ def main():
         tracker_addr = None
 
     server = rpc.Server(
-        args.host, args.port, args.port_end, key=args.key, tracker_addr=tracker_addr
+        args.host,
+        args.port,
+        args.port_end,
+        key=args.key,
+        tracker_addr=tracker_addr,
+        server_init_callback=functools.partial(
+            _server_init_callback, args.cache_dir, args.cache_size << 20, args.preload
+        ),
     )
     server.proc.join()
 
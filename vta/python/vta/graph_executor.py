@@ -0,0 +1,93 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Graph executor replaying recorded VTA instruction streams"""
+import tvm._ffi
+
+from tvm._ffi.base import string_types
+from tvm.contrib import graph_executor
+
+
+def create(graph_json_str, libmod, device):
+    """Create a runtime executor module given a graph and module.
+
+    Parameters
+    ----------
+    graph_json_str : str
+        The graph to be deployed in json format output by json graph.
+        The graph can contain operator(tvm_op) that points to the name
+        of PackedFunc in the libmod.
+
+    libmod : tvm.runtime.Module
+        The module of the corresponding function
+
+    device : Device or list of Device
+        The devices to deploy the module, including the VTA ext_dev
+
+    Returns
+    -------
+    graph_module : GraphModuleVTAGraph
+        VTA graph executor module that can be used to execute the graph.
+    """
+    assert isinstance(graph_json_str, string_types)
+    dev, num_rpc_dev, device_type_id = graph_executor.get_device(libmod, device)
+    if num_rpc_dev == len(dev):
+        fcreate = dev[0]._rpc_sess.get_function("tvm.graph_executor_vta.create")
+    else:
+        fcreate = tvm._ffi.get_global_func("tvm.graph_executor_vta.create")
+
+    return GraphModuleVTAGraph(fcreate(graph_json_str, libmod, *device_type_id))
+
+
+class GraphModuleVTAGraph(graph_executor.GraphModule):
+    """VTA graph executor module.
+
+    The first run records the VTA instruction streams of every operator,
+    later runs replay them without regenerating the instructions on the host.
+
+    :py:meth:`load_params` places the parameters on VTA in a device memory arena
+    kept for the lifetime of the module, loaded once and never flushed again.
+
+    Parameters
+    ----------
+    module : Module
+        The internal tvm module that holds the actual graph functions.
+    """
+
+    def __init__(self, module):
+        self._capture_vta_graph = module["capture_vta_graph"]
+        self._run_vta_graph = module["run_vta_graph"]
+        graph_executor.GraphModule.__init__(self, module)
+
+    def capture_vta_graph(self):
+        """Run the graph once and record its VTA instruction streams.
+
+        Calling it again discards the previous recording, for instance
+        after the model parameters were reloaded into new buffers.
+        """
+        self._capture_vta_graph()
+
+    def run(self, **input_dict):
+        """Run the graph, the first call records the VTA graph for later replay
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values to be feed to
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        self._run_vta_graph()
@@ -0,0 +1,171 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Graph executor pipelining frames across the CPU and VTA stages of a graph"""
+import tvm._ffi
+
+from tvm._ffi.base import string_types
+from tvm.contrib import graph_executor
+
+
+def create(graph_json_str, libmod, device, num_slots=3):
+    """Create a pipelined executor module given a graph and module.
+
+    The graph should come from a module built with
+    ``graph_pack(..., device_annot=True)``, so that its operators are annotated
+    with the CPU or VTA device they run on.
+
+    Parameters
+    ----------
+    graph_json_str : str
+        The graph to be deployed in json format output by json graph.
+
+    libmod : tvm.runtime.Module
+        The module of the corresponding function
+
+    device : Device or list of Device
+        The devices to deploy the module, including the VTA ext_dev
+
+    num_slots : int
+        Number of frames that can be in flight, including the frame whose
+        outputs are being read. Each slot holds its own intermediate buffers.
+
+    Returns
+    -------
+    pipeline_module : PipelineModule
+        Pipelined executor module that can be used to execute frames.
+    """
+    assert isinstance(graph_json_str, string_types)
+    dev, num_rpc_dev, device_type_id = graph_executor.get_device(libmod, device)
+    if num_rpc_dev == len(dev):
+        fcreate = dev[0]._rpc_sess.get_function("tvm.graph_executor_pipeline.create")
+    else:
+        fcreate = tvm._ffi.get_global_func("tvm.graph_executor_pipeline.create")
+
+    return PipelineModule(fcreate(graph_json_str, libmod, num_slots, *device_type_id))
+
+
+class PipelineModule(object):
+    """Pipelined executor module.
+
+    Consecutive operators on the same device form a stage, and every stage
+    runs on a thread of its own. While the VTA body of one frame executes,
+    the CPU head and tail of the neighbouring frames run concurrently.
+
+    Frames are submitted with :py:meth:`run` and come out in the same order
+    with :py:meth:`wait`.
+
+    .. code-block:: python
+
+        pipe = vta.pipeline_executor.create(graph, lib, [remote.cpu(), remote.ext_dev()])
+        pipe.load_params(params_bytes)
+        pipe.run(data=frames[0])
+        for frame in frames[1:]:
+            pipe.run(data=frame)
+            pipe.wait()
+            result = pipe.get_output(0).asnumpy()
+        pipe.wait()
+
+    Parameters
+    ----------
+    module : Module
+        The internal tvm module that holds the pipeline functions.
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._set_input = module["set_input"]
+        self._run = module["run"]
+        self._wait = module["wait"]
+        self._get_output = module["get_output"]
+        self._get_num_outputs = module["get_num_outputs"]
+        self._get_num_inputs = module["get_num_inputs"]
+        self._get_num_stages = module["get_num_stages"]
+        self._load_params = module["load_params"]
+
+    def set_input(self, key=None, value=None, **params):
+        """Set inputs of the next frame, waiting until a frame slot is free
+
+        Parameters
+        ----------
+        key : int or str
+           The input key
+
+        value : the input value.
+           The input value
+
+        params : dict of str to NDArray
+           Additional arguments
+        """
+        if key is not None:
+            self._set_input(key, tvm.nd.array(value))
+        for k, v in params.items():
+            self._set_input(k, tvm.nd.array(v))
+
+    def run(self, **input_dict):
+        """Submit the next frame
+
+        Parameters
+        ----------
+        input_dict: dict of str to NDArray
+            List of input values of the frame
+        """
+        if input_dict:
+            self.set_input(**input_dict)
+        self._run()
+
+    def wait(self):
+        """Wait for the oldest submitted frame, whose outputs become readable"""
+        self._wait()
+
+    def get_output(self, index, out=None):
+        """Get an output of the frame returned by the last wait
+
+        Parameters
+        ----------
+        index : int
+            The output index
+
+        out : NDArray
+            The output array container
+        """
+        if out:
+            self._get_output(index, out)
+            return out
+
+        return self._get_output(index)
+
+    def get_num_outputs(self):
+        """Get the number of outputs from the graph"""
+        return self._get_num_outputs()
+
+    def get_num_inputs(self):
+        """Get the number of inputs to the graph"""
+        return self._get_num_inputs()
+
+    def get_num_stages(self):
+        """Get the number of pipeline stages of the graph"""
+        return self._get_num_stages()
+
+    def load_params(self, params_bytes):
+        """Load parameters shared by all frames, after the frames in flight finish
+
+        Parameters
+        ----------
+        params_bytes : bytearray
+            The serialized parameter dict.
+        """
+        self._load_params(bytearray(params_bytes))
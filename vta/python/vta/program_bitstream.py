@@ -17,6 +17,7 @@
 """VTA specific bitstream program library."""
 import os
 import argparse
+import hashlib
 
 
 def main():
@@ -65,6 +66,15 @@ def intelfocl_bitstream_program(bitstream_path, mem_size=4 * 1024 * 1024 * 1024)
     program(bitstream_path, mem_size)
 
 
+def bitstream_hash(bitstream_path):
+    """Return the SHA-256 hex digest of a bitstream file"""
+    sha = hashlib.sha256()
+    with open(bitstream_path, "rb") as bitstream:
+        for chunk in iter(lambda: bitstream.read(1 << 20), b""):
+            sha.update(chunk)
+    return sha.hexdigest()
+
+
 def bitstream_program(target, bitstream, *args):
     """program bitstream to devices"""
 
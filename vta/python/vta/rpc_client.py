@@ -23,20 +23,23 @@ from .environment import get_env
 from .bitstream import download_bitstream, get_bitstream_path
 
 
-def reconfig_runtime(remote):
+def reconfig_runtime(remote, env=None):
     """Reconfigure remote runtime based on current hardware spec.
 
     Parameters
     ----------
     remote : RPCSession
         The TVM RPC session
+
+    env : Environment, optional
+        The hardware spec, defaults to the current environment.
     """
-    env = get_env()
+    env = env or get_env()
     freconfig = remote.get_function("tvm.contrib.vta.reconfig_runtime")
     freconfig(env.pkg.cfg_json)
 
 
-def program_fpga(remote, bitstream=None):
+def program_fpga(remote, bitstream=None, force=True, env=None):
     """Upload and program bistream
 
     Parameters
@@ -46,21 +49,68 @@ def program_fpga(remote, bitstream=None):
 
     bitstream : str, optional
         Path to a local bistream file. If unset, tries to download from cache server.
+
+    force : bool, optional
+        If False, a remote board already programmed with the same bitstream,
+        as recorded by its RPC server, is left as is.
+
+    env : Environment, optional
+        The environment of the bitstream, defaults to the current environment.
     """
-    env = get_env()
+    env = env or get_env()
 
     if bitstream:
         assert os.path.isfile(bitstream)
     else:
-        bitstream = get_bitstream_path()
-        if not os.path.isfile(bitstream):
-            if env.TARGET in ["de10nano", "de10pro"]:
-                return
-            download_bitstream()
+        with env:
+            bitstream = get_bitstream_path()
+            if not os.path.isfile(bitstream):
+                if env.TARGET in ["de10nano", "de10pro"]:
+                    return
+                download_bitstream()
 
     if isinstance(remote, rpc.LocalSession):
         program_bitstream.bitstream_program(env.TARGET, bitstream)
     else:
+        if not force and _programmed_hash(remote) == program_bitstream.bitstream_hash(bitstream):
+            return
         fprogram = remote.get_function("tvm.contrib.vta.init")
-        remote.upload(bitstream)
+        upload(remote, bitstream)
         fprogram(os.path.basename(bitstream))
+
+
+def upload(remote, path, target=None):
+    """Upload a file to the remote temp folder, unless the RPC server caches its content.
+
+    The RPC server keeps the uploaded files across sessions by content hash,
+    then places a cached file in the session instead of receiving it again.
+
+    Parameters
+    ----------
+    remote : RPCSession
+        The TVM RPC session
+
+    path : str
+        Path to the local file.
+
+    target : str, optional
+        The name of the file on the remote, defaults to the name of the local file.
+    """
+    target = target or os.path.basename(path)
+    try:
+        fetch = remote.get_function("tvm.contrib.vta.cache_fetch")
+    except AttributeError:
+        # Older RPC servers do not cache
+        fetch = None
+    if fetch is None or not fetch(program_bitstream.bitstream_hash(path), target):
+        remote.upload(path, target)
+
+
+def _programmed_hash(remote):
+    """Hash of the bitstream last programmed on the remote board, or None"""
+    try:
+        fhash = remote.get_function("tvm.contrib.vta.bitstream_hash")
+    except AttributeError:
+        # Older RPC servers do not record what they programmed
+        return None
+    return fhash() or None
@@ -22,6 +22,8 @@ from .graphpack import graph_pack
 from . import op
 from .vta_conv2d import conv2d_packed, schedule_conv2d_packed
 from .vta_conv2d_transpose import conv2d_transpose_packed, schedule_conv2d_transpose_packed
+from .vta_conv2d_transpose import conv2d_transpose_subpixel_packed
+from .vta_conv2d_transpose import schedule_conv2d_transpose_subpixel_packed
 from .vta_group_conv2d import group_conv2d_packed, schedule_group_conv2d_packed
 from .vta_dense import dense_packed, schedule_dense_packed
 from . import utils
@@ -19,8 +19,13 @@
 """Bit packing operators"""
 from __future__ import absolute_import as _abs
 
+import ctypes
+
+import numpy as np
+
 import tvm
 from tvm import te
+from tvm._ffi.base import _LIB, check_call
 from tvm.topi import utils
 
 from tvm.relay.op.op import register_compute, register_injective_schedule
@@ -76,6 +81,55 @@ def bitpack(data, bits, pack_type="int8", name="bitpack"):
     return te.compute(oshape, _bitpack, name=name, tag="bitpack")
 
 
+def bitpack_array(data, dtype, device=None):
+    """Create the array of narrow ints as the VTA DMA loads it
+
+    The elements of an int8 or narrower dtype are bit packed in row major order, at bit
+    (index % lanes) * bits of the byte index // lanes, as the bitpack compute packs them.
+    The runtime sizes the arrays of a dtype narrower than a byte one byte per element, so
+    the packed elements fill the first bits / 8 of the array and the rest is zero. The DMA
+    loads only the packed elements.
+
+    Parameters
+    ----------
+    data : numpy.ndarray
+        The integers, in the range of the dtype.
+    dtype : str
+        The dtype of the array, e.g. env.wgt_dtype.
+    device : Device, optional
+        The device of the array, the CPU by default.
+
+    Returns
+    -------
+    arr : tvm.nd.NDArray
+        The bit packed array.
+    """
+    device = device if device is not None else tvm.cpu(0)
+    bits = tvm.runtime.DataType(dtype).bits
+    if bits >= 8:
+        return tvm.nd.array(np.asarray(data).astype(dtype), device)
+    assert 8 % bits == 0, "Cannot bit pack int%d into bytes" % bits
+    lanes = 8 // bits
+    flat = np.asarray(data).astype("int64").reshape(-1)
+    low, high = -(1 << (bits - 1)), (1 << (bits - 1)) - 1
+    assert flat.size == 0 or (flat.min() >= low and flat.max() <= high), (
+        "The values are out of the range [%d, %d] of %s" % (low, high, dtype)
+    )
+    assert flat.size % lanes == 0, "Not a multiple of word size"
+    words = np.zeros(flat.size // lanes, "uint8")
+    for k in range(lanes):
+        words |= ((flat[k::lanes] & ((1 << bits) - 1)) << (k * bits)).astype("uint8")
+    storage = np.zeros(flat.size, "uint8")
+    storage[: words.size] = words
+    arr = tvm.nd.empty(np.asarray(data).shape, dtype, device)
+    check_call(
+        _LIB.TVMArrayCopyFromBytes(
+            arr.handle, storage.ctypes.data_as(ctypes.c_void_p), ctypes.c_size_t(storage.nbytes)
+        )
+    )
+    return arr
+
+
 @register_compute("bitpack", level=15)
 def compute_bitpack(attrs, inputs):
     lanes = attrs.lanes
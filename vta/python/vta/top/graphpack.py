@@ -17,10 +17,13 @@
 # pylint: disable=unused-argument
 """A Relay implementation of graph packing."""
 
+import numpy as np
+
 import tvm
 from tvm import relay
 from tvm.relay import op, transform
 from tvm.relay import ExprMutator
+from .bitpack import bitpack_array
 
 
 def run_opt_pass(expr, opt_pass):
@@ -37,28 +40,50 @@ def _to_shape(shape):
     return tuple(int(sh) for sh in shape)
 
 
+def _transpose_moves_data(shape, axes):
+    """Whether a transpose changes the memory order, as opposed to only the shape."""
+    moved = [axis for axis in axes if shape[axis] != 1]
+    return moved != sorted(moved)
+
+
 def _pack_batch_channel(data, dshape, bfactor, cfactor):
     """Pack the data channel dimension."""
     assert int(dshape[0]) % bfactor == 0
     assert int(dshape[1]) % cfactor == 0
-    data = op.reshape(
-        data,
-        newshape=(
-            int(dshape[0]) // bfactor,
-            bfactor,
-            int(dshape[1]) // cfactor,
-            cfactor,
-            int(dshape[2]),
-            int(dshape[3]),
-        ),
+    shape = (
+        int(dshape[0]) // bfactor,
+        bfactor,
+        int(dshape[1]) // cfactor,
+        cfactor,
+        int(dshape[2]),
+        int(dshape[3]),
     )
-    data = op.transpose(data, axes=(0, 2, 4, 5, 1, 3))
+    axes = (0, 2, 4, 5, 1, 3)
+    if not _transpose_moves_data(shape, axes):
+        # e.g. batch 1 with 1x1 spatial, a reshape only function that the
+        # graph executor runs as a no-op on shared storage
+        return op.reshape(data, newshape=tuple(shape[axis] for axis in axes))
+    data = op.reshape(data, newshape=shape)
+    data = op.transpose(data, axes=axes)
     return data
 
 
-def _unpack_batch_channel(data, old_shape):
+def _unpack_batch_channel(data, old_shape, bfactor=None, cfactor=None):
     """Unpack the data channel dimension."""
-    data = op.transpose(data, axes=(0, 4, 1, 5, 2, 3))
+    axes = (0, 4, 1, 5, 2, 3)
+    if bfactor is not None and cfactor is not None:
+        old_shape = _to_shape(old_shape)
+        packed = (
+            old_shape[0] // bfactor,
+            old_shape[1] // cfactor,
+            old_shape[2],
+            old_shape[3],
+            bfactor,
+            cfactor,
+        )
+        if not _transpose_moves_data(packed, axes):
+            return op.reshape(data, newshape=old_shape)
+    data = op.transpose(data, axes=axes)
     data = op.reshape(data, newshape=old_shape)
     return data
 
@@ -90,6 +115,34 @@ def _weight_shape_match(data, dshape, channels, cfactor_out, transpose=False):
     return data, dshape, channels
 
 
+def _pack_groups(data, dshape, groups, cfactor, dtype):
+    """Merge the groups of fewer input channels than cfactor, e.g. depthwise, so that each
+    merged group fills a channel block.
+
+    The kernel of a merged group is block diagonal: the output channels of each group have
+    zero weights for the input channels of the other groups.
+    """
+    in_channels = int(dshape[1])
+    if groups == 1 or in_channels % cfactor == 0:
+        return data, dshape, groups
+    num_merged = cfactor // in_channels
+    out_channels = int(dshape[0]) // groups
+    assert cfactor % in_channels == 0 and groups % num_merged == 0, (
+        "Cannot merge groups of %d input channels into blocks of %d" % (in_channels, cfactor)
+    )
+    assert (out_channels * num_merged) % cfactor == 0, (
+        "The merged groups of %d output channels must fill blocks of %d"
+        % (out_channels * num_merged, cfactor)
+    )
+    groups = groups // num_merged
+    k_h, k_w = int(dshape[2]), int(dshape[3])
+    data = op.reshape(data, newshape=(groups, num_merged, out_channels, 1, in_channels, k_h, k_w))
+    mask = np.eye(num_merged, dtype=dtype).reshape(1, num_merged, 1, num_merged, 1, 1, 1)
+    data = op.multiply(data, relay.const(mask, dtype))
+    dshape = (int(dshape[0]), cfactor, k_h, k_w)
+    return op.reshape(data, newshape=dshape), dshape, groups
+
+
 def _weight_shape_match_transpose(data, dshape, channels, cfactor_out):
     """Pad the weight if the shape[1] not divisible by cfactor_out."""
     assert len(dshape) == 4
@@ -147,6 +200,17 @@ def _pack_weight_conv2d_transpose(data, dshape, cfactor):
     return data
 
 
+def _bitpack_weight(data, weight_bits):
+    """Bit pack the packed weight into a constant of narrow ints, as VTA loads them."""
+    if weight_bits == 8:
+        return data
+    data = run_opt_pass(data, transform.FoldConstant())
+    assert isinstance(
+        data, relay.Constant
+    ), "Weights narrower than 8 bits must be constants, bind the params before graph_pack"
+    return relay.const(bitpack_array(data.data.numpy(), "int%d" % weight_bits))
+
+
 def _pack_const(data, dshape, dtype, bfactor, cfactor):
     """Pack a constant parameter."""
     dshape = _to_shape(dshape)
@@ -319,27 +383,26 @@ class ExprPack(ExprMutator):
                 self.start_pack = False
                 data = args[0]
                 data_shape = _get_tensor_shape(call.args[0])
-                return _unpack_batch_channel(data, data_shape)
+                return _unpack_batch_channel(data, data_shape, self.bfactor, self.cfactor)
         if self.start_pack:
             # Operator cases
             if call.op == self.conv2d and odtype == "int32":
                 self.number_of_conv2d += 1
                 assert 8 % self.weight_bits == 0
-                w_lanes = 8 // self.weight_bits
                 data_layout = "NCHW%dn%dc" % (self.bfactor, self.cfactor)
                 kernel_layout = "OIHW%do%di" % (self.cfactor, self.cfactor)
                 data, weight = args
                 data_shape = _to_shape(input_types[0].shape)
                 kernel_shape = _to_shape(input_types[1].shape)
                 channels = call.attrs.channels
+                weight, kernel_shape, groups = _pack_groups(
+                    weight, kernel_shape, call.attrs.groups, self.cfactor, input_types[1].dtype
+                )
                 weight, kernel_shape, channels = _weight_shape_match(
                     weight, kernel_shape, channels, self.cfactor
                 )
                 kernel = _pack_weight(weight, kernel_shape, self.cfactor)
-                # insert bit packing when necessary
-                if w_lanes != 1:
-                    assert 8 % w_lanes == 0
-                    kernel = op.bitpack(kernel, lanes=w_lanes)
+                kernel = _bitpack_weight(kernel, self.weight_bits)
 
                 conv2d = op.nn.conv2d(
                     data,
@@ -347,7 +410,7 @@ class ExprPack(ExprMutator):
                     strides=call.attrs.strides,
                     padding=call.attrs.padding,
                     dilation=call.attrs.dilation,
-                    groups=call.attrs.groups,
+                    groups=groups,
                     channels=channels,
                     kernel_size=call.attrs.kernel_size,
                     data_layout=data_layout,
@@ -359,7 +422,6 @@ class ExprPack(ExprMutator):
             if call.op == self.conv2d_transpose and odtype == "int32":
                 self.number_of_conv2d += 1
                 assert 8 % self.weight_bits == 0
-                w_lanes = 8 // self.weight_bits
                 if self.start_pack:
                     data_layout = "NCHW%dn%dc" % (self.bfactor, self.cfactor)
                     kernel_layout = "IOHW%di%do" % (self.cfactor, self.cfactor)
@@ -371,6 +433,7 @@ class ExprPack(ExprMutator):
                         weight, kernel_shape, channels, self.cfactor
                     )
                     kernel = _pack_weight_conv2d_transpose(weight, kernel_shape, self.cfactor)
+                    kernel = _bitpack_weight(kernel, self.weight_bits)
                     conv2d = op.nn.conv2d_transpose(
                         data,
                         kernel,
@@ -511,6 +574,320 @@ def get_subgraph(expr, start_name, stop_name, start_name_idx, stop_name_idx, cou
     return run_opt_pass(annotated, transform.ToGraphNormalForm())
 
 
+class OffloadCostModel(object):
+    """Analytical latency model used to place VTA regions automatically.
+
+    The estimates only need to rank the placements against each other, so
+    they count the dominant work of each operator: multiply-accumulates for
+    convolutions and element traffic for everything else.
+
+    Parameters
+    ----------
+    env : Environment, optional
+        The VTA environment, the current one by default.
+
+    vta_clock_hz : float
+        Clock frequency of the VTA core.
+
+    vta_op_overhead_s : float
+        Fixed host cost of launching and synchronizing one VTA convolution.
+
+    cpu_macs_per_s : float
+        Sustained int8 multiply-accumulate rate of the CPU.
+
+    cpu_bytes_per_s : float
+        Sustained memory bandwidth of the CPU for layout transforms and
+        elementwise operators.
+    """
+
+    def __init__(
+        self,
+        env=None,
+        vta_clock_hz=100e6,
+        vta_op_overhead_s=20e-6,
+        cpu_macs_per_s=2e9,
+        cpu_bytes_per_s=1e9,
+    ):
+        if env is None:
+            from ..environment import get_env  # pylint: disable=import-outside-toplevel
+
+            env = get_env()
+        self.gemm_lanes = env.BATCH * env.BLOCK_IN * env.BLOCK_OUT
+        self.alu_lanes = env.BATCH * env.BLOCK_OUT
+        self.vta_clock_hz = vta_clock_hz
+        self.vta_op_overhead_s = vta_op_overhead_s
+        self.cpu_macs_per_s = cpu_macs_per_s
+        self.cpu_bytes_per_s = cpu_bytes_per_s
+
+    def cpu_latency(self, call):
+        """Estimated latency of an operator on the CPU."""
+        macs = _conv_macs(call)
+        if macs:
+            return macs / self.cpu_macs_per_s
+        return 2 * _tensor_bytes(call) / self.cpu_bytes_per_s
+
+    def vta_latency(self, call):
+        """Estimated latency of an operator on VTA, in packed layout."""
+        macs = _conv_macs(call)
+        if macs:
+            return macs / self.gemm_lanes / self.vta_clock_hz + self.vta_op_overhead_s
+        # Elementwise operators fuse into the preceding convolution
+        return _tensor_elems(call) / self.alu_lanes / self.vta_clock_hz
+
+    def transfer_latency(self, expr):
+        """Estimated latency of packing or unpacking a tensor between the CPU and VTA layouts,
+        see _pack_batch_channel and _unpack_batch_channel."""
+        # reshape and transpose, each reads and writes the tensor
+        return 4 * _tensor_bytes(expr) / self.cpu_bytes_per_s
+
+
+def _tensor_elems(expr):
+    """Number of elements of a typed tensor expression."""
+    elems = 1
+    for dim in _get_tensor_shape(expr):
+        elems *= dim
+    return elems
+
+
+def _tensor_bytes(expr):
+    """Number of bytes of a typed tensor expression."""
+    if not isinstance(expr.checked_type, relay.ty.TensorType):
+        return 0
+    return _tensor_elems(expr) * tvm.DataType(expr.checked_type.dtype).bits // 8
+
+
+def _conv_macs(call):
+    """Multiply-accumulates of a convolution, 0 for other operators."""
+    if call.op.name == "nn.conv2d":
+        kernel = _to_shape(call.args[1].checked_type.shape)
+        return _tensor_elems(call) * kernel[1] * kernel[2] * kernel[3]
+    if call.op.name == "nn.conv2d_transpose":
+        kernel = _to_shape(call.args[1].checked_type.shape)
+        return _tensor_elems(call.args[0]) * kernel[1] * kernel[2] * kernel[3]
+    return 0
+
+
+# Operators ExprPack rewrites or that do not depend on the layout
+_PACKABLE_OPS = frozenset(
+    [
+        "nn.conv2d",
+        "nn.conv2d_transpose",
+        "add",
+        "multiply",
+        "nn.bias_add",
+        "cast",
+        "nn.pad",
+        "nn.upsampling",
+        "clip",
+        "right_shift",
+        "nn.relu",
+        "maximum",
+        "minimum",
+        "copy",
+        "annotation.stop_fusion",
+    ]
+)
+
+
+def _packable_tensor(expr, bfactor, cfactor):
+    """Whether a tensor can be converted to the packed batch and channel layout."""
+    shape = _get_tensor_shape(expr)
+    return len(shape) == 4 and shape[0] % bfactor == 0 and shape[1] % cfactor == 0
+
+
+def _packable_call(call, bfactor, cfactor):
+    """Whether ExprPack can run an operator in the packed layout."""
+    if not isinstance(call, relay.expr.Call) or not isinstance(call.op, tvm.ir.Op):
+        return False
+    if call.op.name not in _PACKABLE_OPS or _get_tensor_type(call) not in ("int8", "int32"):
+        return False
+    if not _packable_tensor(call, bfactor, cfactor):
+        return False
+    data = call.args[0]
+    if not _packable_tensor(data, bfactor, cfactor) or _get_tensor_type(data) == "float32":
+        return False
+    name = call.op.name
+    if name in ("nn.conv2d", "nn.conv2d_transpose"):
+        return _get_tensor_type(call) == "int32" and call.attrs.data_layout == "NCHW"
+    if name in ("add", "multiply"):
+        other = _get_tensor_shape(call.args[1])
+        return other == _get_tensor_shape(data) or len(other) == 3
+    if name == "nn.pad":
+        return len(call.attrs.pad_width) == 4
+    return True
+
+
+def select_regions(expr, bfactor, cfactor, cost_model=None, max_regions=None):
+    """Choose the regions to offload to VTA by estimated latency.
+
+    The operators are considered in A-normal form order. A region may only
+    begin or end where a single tensor is live, as everything inside it is in
+    the packed layout. Dynamic programming then picks the regions that
+    minimize the estimated latency, which includes packing and unpacking the
+    tensors that cross region boundaries.
+
+    Parameters
+    ----------
+    expr : relay.Function
+       The input program.
+
+    bfactor : int
+       The packing factor in batch
+
+    cfactor : int
+       The packing factor in channel
+
+    cost_model : OffloadCostModel, optional
+       The latency estimates, OffloadCostModel() by default.
+
+    max_regions : int, optional
+       Keep at most this many regions, the ones that save the most.
+
+    Returns
+    -------
+    regions : list of (int, int)
+        For each region, the index of the binding whose result is packed and
+        of the last binding computed in the packed layout.
+    """
+    cost_model = cost_model or OffloadCostModel()
+    _, lets = _let_bindings(expr)
+    num = len(lets)
+    if num == 0:
+        return []
+
+    # Binding i is a cut point when only its own result is used after it. The constants are
+    # packed along with the operators using them, they never cross a region boundary.
+    index = {let.var: i for i, let in enumerate(lets) if not _is_constant(let.value)}
+    last_use = [-1] * num
+    for i, let in enumerate(lets):
+        for var in relay.analysis.free_vars(let.value):
+            if var in index:
+                last_use[index[var]] = max(last_use[index[var]], i)
+    for var in relay.analysis.free_vars(lets[-1].body):
+        if var in index:
+            last_use[index[var]] = num
+    cut = []
+    live_until = -1
+    for i in range(num):
+        cut.append(live_until <= i)
+        live_until = max(live_until, last_use[i])
+
+    inf = float("inf")
+    # cost[state][i]: best latency of bindings 0..i, ending on the CPU (0) or VTA (1)
+    cost = [[inf] * num, [inf] * num]
+    back = [[None] * num, [None] * num]
+    cost[0][0] = _binding_cost(lets[0].value, cost_model.cpu_latency)
+    for i in range(1, num):
+        value = lets[i].value
+        prev = lets[i - 1].value
+        cpu = _binding_cost(value, cost_model.cpu_latency)
+        cost[0][i], back[0][i] = cost[0][i - 1] + cpu, 0
+        if cut[i - 1] and not _is_constant(prev):
+            leave = cost[1][i - 1] + cost_model.transfer_latency(prev) + cpu
+            if leave < cost[0][i]:
+                cost[0][i], back[0][i] = leave, 1
+        if _is_constant(value):
+            vta = 0
+        elif _packable_call(value, bfactor, cfactor):
+            vta = cost_model.vta_latency(value)
+        else:
+            continue
+        cost[1][i], back[1][i] = cost[1][i - 1] + vta, 1
+        if cut[i - 1] and not _is_constant(prev) and _packable_tensor(prev, bfactor, cfactor):
+            enter = cost[0][i - 1] + cost_model.transfer_latency(prev) + vta
+            if enter < cost[1][i]:
+                cost[1][i], back[1][i] = enter, 0
+
+    state = 0
+    last = lets[-1].value
+    if cut[-1] and not _is_constant(last):
+        if cost[1][-1] + cost_model.transfer_latency(last) < cost[0][-1]:
+            state = 1
+    regions = []
+    end = num - 1 if state == 1 else None
+    for i in range(num - 1, 0, -1):
+        prev_state = back[state][i]
+        if state == 1 and prev_state == 0:
+            regions.append((i - 1, end))
+        elif state == 0 and prev_state == 1:
+            end = i - 1
+        state = prev_state
+    regions.reverse()
+
+    if max_regions is not None and len(regions) > max_regions:
+        # Rank the regions by the latency they save over running on the CPU
+        def _saving(region):
+            start, stop = region
+            saving = -cost_model.transfer_latency(lets[start].value)
+            saving -= cost_model.transfer_latency(lets[stop].value)
+            for i in range(start + 1, stop + 1):
+                saving += _binding_cost(lets[i].value, cost_model.cpu_latency)
+                saving -= _binding_cost(lets[i].value, cost_model.vta_latency)
+            return saving
+
+        regions = sorted(sorted(regions, key=_saving, reverse=True)[:max_regions])
+    return regions
+
+
+def _binding_cost(value, latency):
+    """Latency of a binding, bindings other than operator calls are free."""
+    if isinstance(value, relay.expr.Call) and isinstance(value.op, tvm.ir.Op):
+        return latency(value)
+    return 0
+
+
+def _is_constant(value):
+    """Whether a binding is a constant, ToANormalForm binds them like the operator calls."""
+    return isinstance(value, relay.expr.Constant)
+
+
+def _let_bindings(expr):
+    """A typed function in A-normal form, and its let bindings in order."""
+    anf = run_opt_pass(expr, transform.InferType())
+    anf = run_opt_pass(anf, transform.ToANormalForm())
+    anf = run_opt_pass(anf, transform.InferType())
+    lets = []
+    body = anf.body
+    while isinstance(body, relay.expr.Let):
+        lets.append(body)
+        body = body.body
+    return anf, lets
+
+
+def get_subgraph_regions(expr, regions):
+    """Mark several regions for packing.
+
+    Parameters
+    ----------
+    expr : relay.Function
+       The input program.
+
+    regions : list of (int, int)
+       The regions as returned by select_regions, in order.
+
+    Returns
+    -------
+    expr : relay.Function
+        The program with bitpack_start and bitpack_end around each region.
+    """
+    bitpack_start = op.op.get("annotation.bitpack_start")
+    bitpack_end = op.op.get("annotation.bitpack_end")
+    func, lets = _let_bindings(expr)
+    starts = set(start for start, _ in regions)
+    ends = set(stop for _, stop in regions)
+    body = lets[-1].body if lets else func.body
+    # Rebuild the bindings from the innermost one, large models are too deep to recurse
+    for i in range(len(lets) - 1, -1, -1):
+        value = lets[i].value
+        if i in starts:
+            value = relay.expr.Call(bitpack_start, [value])
+        elif i in ends:
+            value = relay.expr.Call(bitpack_end, [value])
+        body = relay.expr.Let(lets[i].var, value, body)
+    annotated = relay.Function(func.params, body, func.ret_type, func.type_params, func.attrs)
+    return run_opt_pass(annotated, transform.ToGraphNormalForm())
+
+
 def graph_pack(
     expr,
     bfactor,
@@ -524,6 +901,9 @@ def graph_pack(
     device_annot=False,
     annot_start_name="nn.conv2d",
     annot_end_name="annotation.stop_fusion",
+    auto_regions=False,
+    cost_model=None,
+    max_regions=None,
 ):
     """Pack the graph into batch&channel packed format.
 
@@ -539,7 +919,8 @@ def graph_pack(
        The packing factor in channel
 
     weight_bits: int
-        The bit-width of the weights.
+        The bit-width of the weights. The weights narrower than 8 bits, e.g. quantized with
+        nbit_weight=4, are bit packed into constants of dtype int<weight_bits>.
 
     start_name: str, optional
        Start packing from certain known node when start_name_idx is None.
@@ -570,6 +951,16 @@ def graph_pack(
     annot_end_name: str, optional
         device annotation end node, after which we mark the nodes as 'cpu'
 
+    auto_regions: boolean, optional
+        Choose the packed regions with select_regions instead of start_name and stop_name.
+        Several disjoint regions may be chosen, but only one when device_annot is set.
+
+    cost_model: OffloadCostModel, optional
+        The latency estimates of auto_regions.
+
+    max_regions: int, optional
+        The maximum number of regions auto_regions may choose.
+
     Returns
     -------
     expr : Expr
@@ -582,7 +973,16 @@ def graph_pack(
         or (not (start_name_idx is None and stop_name_idx is None))
         or (start_name_idx < stop_name_idx)
     )
-    expr = get_subgraph(expr, start_name, stop_name, start_name_idx, stop_name_idx, count_meta)
+    if auto_regions:
+        if device_annot:
+            # The device annotation below marks a single contiguous region
+            max_regions = 1
+        regions = select_regions(expr, bfactor, cfactor, cost_model, max_regions)
+        if not regions:
+            return expr
+        expr = get_subgraph_regions(expr, regions)
+    else:
+        expr = get_subgraph(expr, start_name, stop_name, start_name_idx, stop_name_idx, count_meta)
     expr = run_opt_pass(expr, transform.InferType())
     packer = ExprPack(bfactor, cfactor, weight_bits)
     expr = packer.visit(expr)
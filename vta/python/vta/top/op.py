@@ -30,6 +30,8 @@ from tvm.relay.op.op import OpPattern, OpStrategy
 from .utils import is_packed_layout
 from .vta_conv2d import conv2d_packed, schedule_conv2d_packed
 from .vta_conv2d_transpose import conv2d_transpose_packed, schedule_conv2d_transpose_packed
+from .vta_conv2d_transpose import subpixel_applicable, conv2d_transpose_subpixel_packed
+from .vta_conv2d_transpose import schedule_conv2d_transpose_subpixel_packed
 from .vta_group_conv2d import group_conv2d_packed, schedule_group_conv2d_packed
 from .vta_dense import dense_packed, schedule_dense_packed
 from ..environment import get_env
@@ -210,8 +212,11 @@ def conv2d_strategy_vta(attrs, inputs, out_type, target):
     if is_packed_layout(layout):
         if groups == 1:
             assert ENV.LOG_INP_WIDTH == 3, "only support 8bit inp for now"
-            assert ENV.LOG_WGT_WIDTH == 3, "only support 8bit wgt for now"
-            assert kernel.dtype == "int8"
+            assert ENV.LOG_WGT_WIDTH <= 3, "only support 8bit or narrower wgt for now"
+            assert kernel.dtype == ENV.wgt_dtype, (
+                "expected kernel of %s, graph_pack bit packs weights narrower than 8 bits"
+                % ENV.wgt_dtype
+            )
 
             strategy.add_implementation(
                 _strategy.wrap_compute_conv2d(conv2d_packed, True),
@@ -240,6 +245,17 @@ def conv2d_transpose_strategy_vta(attrs, inputs, out_type, target):
 
     if is_packed_layout(layout):
         strategy = OpStrategy()
+        kernel_size = topi.utils.get_const_tuple(inputs[1].shape)[2:4]
+        strides = topi.utils.get_const_tuple(attrs.strides)
+        output_size = topi.utils.get_const_tuple(out_type.shape)[2:4]
+        if subpixel_applicable(kernel_size, strides, output_size):
+            # without the zeros of the dilated input
+            strategy.add_implementation(
+                _strategy.wrap_compute_conv2d_transpose(conv2d_transpose_subpixel_packed),
+                _strategy.wrap_topi_schedule(schedule_conv2d_transpose_subpixel_packed),
+                name="conv2d_transpose_subpixel_packed.vta",
+            )
+            return strategy
         strategy.add_implementation(
             _strategy.wrap_compute_conv2d_transpose(conv2d_transpose_packed),
             _strategy.wrap_topi_schedule(schedule_conv2d_transpose_packed),
@@ -256,6 +272,7 @@ def conv2d_transpose_strategy_vta(attrs, inputs, out_type, target):
 def dense_strategy_vta(attrs, inputs, out_type, target):
     """dense vta strategy"""
     if len(inputs[0].shape) == 4:  # this implies the layout is packed
+        assert inputs[1].dtype == ENV.wgt_dtype, "expected weight of %s" % ENV.wgt_dtype
         strategy = OpStrategy()
         strategy.add_implementation(
             _strategy.wrap_compute_dense(dense_packed),
@@ -60,6 +60,7 @@ def conv2d_packed(cfg, data, kernel, strides, padding, dilation, layout, out_dty
         ),
         name="res",
         tag="conv2d_dense",
+        attrs={"auto_scheduler_vta_gemm": "vta_gemm"},
     )
 
     cfg.add_flop(
@@ -203,3 +203,236 @@ def schedule_conv2d_transpose_packed(cfg, outs):
     s[output].pragma(x_co1, env.dma_copy)
 
     return s
+
+
+def subpixel_applicable(kernel_size, strides, output_size):
+    """Check if the sub-pixel conv2d_transpose computes the output shape
+
+    Each output row of a phase oh % stride has the same kernel / stride taps when the stride
+    divides the kernel, and the phases tile the output when the stride divides it.
+    """
+    return all(
+        k % s == 0 and o % s == 0 for k, s, o in zip(kernel_size, strides, output_size)
+    ) and tuple(strides) != (1, 1)
+
+
+@autotvm.register_topi_compute("conv2d_transpose_subpixel_packed.vta")
+def conv2d_transpose_subpixel_packed(
+    cfg, data, kernel, strides, padding, out_dtype, output_padding=(0, 0)
+):
+    """Packed conv2d_transpose compute, decomposed by stride phase (sub-pixel)
+
+    Computes conv2d_transpose_packed without inserting zeros: the output row oh only takes
+    the kernel rows congruent to bpad_top - oh modulo the stride, each from an input row
+    of the undilated data, so every phase is a stride 1 convolution with a sub kernel.
+    """
+    ishape = get_const_tuple(data.shape)
+    kshape = get_const_tuple(kernel.shape)
+    b, c_i, i_h, i_w, t_b, t_ci = ishape
+    c_o, _, k_h, k_w, t_co, t_ci = kshape
+    stride_h, stride_w = strides
+    opad_h, opad_w = output_padding
+    assert opad_h == 0 and opad_w == 0, "VTA does not support output padding for now"
+
+    # derive padding parameters
+    fpad_top, fpad_left, fpad_bottom, fpad_right = get_pad_tuple(padding, (k_h, k_w))
+    bpad_top = k_h - 1 - fpad_top
+    bpad_left = k_w - 1 - fpad_left
+    out_h = (i_h - 1) * stride_h - fpad_top - fpad_bottom + k_h
+    out_w = (i_w - 1) * stride_w - fpad_left - fpad_right + k_w
+    assert subpixel_applicable((k_h, k_w), strides, (out_h, out_w))
+    taps_h, taps_w = k_h // stride_h, k_w // stride_w
+
+    # the first input row of the taps of the output row oh, and the kernel row of a tap
+    def _in_row(o, t, stride, bpad):
+        return tvm.tir.indexdiv(o + stride - 1 - bpad, stride) + t
+
+    def _kernel_row(o, t, stride, bpad):
+        return stride - 1 - tvm.tir.indexmod(o + stride - 1 - bpad, stride) + stride * t
+
+    # padding stage, of the input rows out of the data
+    def _pads(out_size, in_size, taps, stride, bpad):
+        first = (stride - 1 - bpad) // stride
+        last = (out_size - 1 + stride - 1 - bpad) // stride + taps - 1
+        return max(0, -first), max(0, last - (in_size - 1))
+
+    pad_top, pad_bottom = _pads(out_h, i_h, taps_h, stride_h, bpad_top)
+    pad_left, pad_right = _pads(out_w, i_w, taps_w, stride_w, bpad_left)
+    if pad_top or pad_bottom or pad_left or pad_right:
+        data_pad = topi.nn.pad(
+            data, [0, 0, pad_top, pad_left, 0, 0], [0, 0, pad_bottom, pad_right, 0, 0]
+        )
+    else:
+        data_pad = data
+
+    # convolution transpose stage
+    oshape = (b, c_o, out_h, out_w, t_b, t_co)
+    d_c = te.reduce_axis((0, c_i), name="d_c")
+    d_h = te.reduce_axis((0, taps_h), name="d_h")
+    d_w = te.reduce_axis((0, taps_w), name="d_w")
+    d_ci = te.reduce_axis((0, t_ci), name="d_ci")
+
+    out = te.compute(
+        oshape,
+        lambda i_n, i_c, i_h, i_w, j_n, j_c: te.sum(
+            data_pad(
+                i_n,
+                d_c,
+                _in_row(i_h, d_h, stride_h, bpad_top) + pad_top,
+                _in_row(i_w, d_w, stride_w, bpad_left) + pad_left,
+                j_n,
+                d_ci,
+            ).astype(out_dtype)
+            * kernel[
+                i_c,
+                d_c,
+                _kernel_row(i_h, d_h, stride_h, bpad_top),
+                _kernel_row(i_w, d_w, stride_w, bpad_left),
+                j_c,
+                d_ci,
+            ].astype(out_dtype),
+            axis=[d_c, d_h, d_w, d_ci],
+        ),
+        tag="packed_conv2d_transpose_subpixel",
+        name="res",
+        attrs={"strides": strides},
+    )
+
+    cfg.add_flop(
+        2 * np.prod(topi.utils.get_const_tuple(oshape)) * taps_h * taps_w * ishape[1] * ishape[-1]
+    )
+
+    return out
+
+
+@autotvm.register_topi_schedule("conv2d_transpose_subpixel_packed.vta")
+def schedule_conv2d_transpose_subpixel_packed(cfg, outs):
+    """Schedule packed sub-pixel conv2d_transpose
+
+    The output rows and columns are split by stride phase, and the loops of the phases are
+    outside the GEMM loops, so that each phase runs the GEMMs of its sub kernel, with the
+    kernel rows of the phase fixed.
+    """
+    assert len(outs) == 1
+    output = outs[0]
+    const_ops = []
+    ewise_inputs = []
+    ewise_ops = []
+    conv2d_res = []
+    assert "int" in output.op.input_tensors[0].dtype
+
+    def _traverse(op):
+        if topi.tag.is_broadcast(op.tag):
+            if not op.same_as(output.op):
+                if not op.axis:
+                    const_ops.append(op)
+                else:
+                    ewise_ops.append(op)
+            for tensor in op.input_tensors:
+                if isinstance(tensor.op, tvm.te.PlaceholderOp):
+                    ewise_inputs.append((op, tensor))
+                else:
+                    _traverse(tensor.op)
+        else:
+            assert op.tag == "packed_conv2d_transpose_subpixel"
+            conv2d_res.append(op)
+
+    _traverse(output.op)
+    assert len(conv2d_res) == 1
+    conv2d_stage = conv2d_res[0].output(0)
+    stride_h, stride_w = [int(x) for x in conv2d_stage.op.attrs["strides"]]
+    s = te.create_schedule(output.op)
+
+    ##### space definition begin #####
+    b, c_o, x_i, x_j, _, _ = s[conv2d_stage].op.axis
+    c_i, _, _, _ = s[conv2d_stage].op.reduce_axis
+    cfg.define_split("tile_b", b, num_outputs=2)
+    # the rows and columns are tiled by whole phases
+    cfg.define_split("tile_h", topi.utils.get_const_int(x_i.dom.extent) // stride_h, num_outputs=2)
+    cfg.define_split("tile_w", topi.utils.get_const_int(x_j.dom.extent) // stride_w, num_outputs=2)
+    cfg.define_split("tile_ci", c_i, num_outputs=2)
+    cfg.define_split("tile_co", c_o, num_outputs=2)
+    cfg.define_knob("oc_nthread", [1, 2])
+    cfg.define_knob("h_nthread", [1, 2])
+    ###### space definition end ######
+
+    data, kernel = conv2d_stage.op.input_tensors
+    if isinstance(data.op, tvm.te.ComputeOp) and "pad" in data.op.tag:
+        temp = data.op.input_tensors[0]
+        pad_data = data
+        data = temp
+    else:
+        pad_data = None
+
+    env = get_env()
+
+    # setup pad
+    if pad_data is not None:
+        cdata = pad_data
+        s[pad_data].set_scope(env.inp_scope)
+    else:
+        cdata = s.cache_read(data, env.inp_scope, [conv2d_stage])
+    ckernel = s.cache_read(kernel, env.wgt_scope, [conv2d_stage])
+    s[conv2d_stage].set_scope(env.acc_scope)
+
+    # cache read input
+    cache_read_ewise = []
+    for consumer, tensor in ewise_inputs:
+        cache_read_ewise.append(s.cache_read(tensor, env.acc_scope, [consumer]))
+
+    # set ewise scope
+    for op in ewise_ops:
+        s[op].set_scope(env.acc_scope)
+        s[op].pragma(s[op].op.axis[0], env.alu)
+
+    for op in const_ops:
+        s[op].compute_inline()
+
+    # tile
+    x_bo, x_co, x_i, x_j, x_bi, x_ci = s[output].op.axis
+    x_i, x_ip = s[output].split(x_i, factor=stride_h)
+    x_j, x_jp = s[output].split(x_j, factor=stride_w)
+    x_co0, x_co1 = cfg["tile_co"].apply(s, output, x_co)
+    x_i0, x_i1 = cfg["tile_h"].apply(s, output, x_i)
+    x_j0, x_j1 = cfg["tile_w"].apply(s, output, x_j)
+    s[output].reorder(x_bo, x_i0, x_co0, x_j0, x_co1, x_i1, x_ip, x_j1, x_jp, x_bi, x_ci)
+    store_pt = x_j0
+
+    # set all compute scopes
+    s[conv2d_stage].compute_at(s[output], store_pt)
+    for op in ewise_ops:
+        s[op].compute_at(s[output], store_pt)
+
+    for tensor in cache_read_ewise:
+        s[tensor].compute_at(s[output], store_pt)
+        s[tensor].pragma(s[tensor].op.axis[0], env.dma_copy)
+
+    # virtual threading along output channel axes
+    if cfg["oc_nthread"].val > 1:
+        _, v_t = s[output].split(x_co0, factor=cfg["oc_nthread"].val)
+        s[output].reorder(v_t, x_bo)
+        s[output].bind(v_t, te.thread_axis("cthread"))
+
+    # virtual threading along spatial rows
+    if cfg["h_nthread"].val > 1:
+        _, v_t = s[output].split(x_i0, factor=cfg["h_nthread"].val)
+        s[output].reorder(v_t, x_bo)
+        s[output].bind(v_t, te.thread_axis("cthread"))
+
+    x_bo, x_co, x_i, x_j, x_bi, x_ci = s[conv2d_stage].op.axis
+    k_o, d_i, d_j, k_i = s[conv2d_stage].op.reduce_axis
+    x_i, x_ip = s[conv2d_stage].split(x_i, factor=stride_h)
+    x_j, x_jp = s[conv2d_stage].split(x_j, factor=stride_w)
+    s[conv2d_stage].reorder(x_bo, k_o, x_ip, x_jp, x_j, d_j, d_i, x_co, x_i, x_bi, x_ci, k_i)
+
+    k_o, _ = cfg["tile_ci"].apply(s, conv2d_stage, k_o)
+    s[cdata].compute_at(s[conv2d_stage], k_o)
+    s[ckernel].compute_at(s[conv2d_stage], k_o)
+
+    # Use VTA instructions
+    s[cdata].pragma(s[cdata].op.axis[0], env.dma_copy)
+    s[ckernel].pragma(s[ckernel].op.axis[0], env.dma_copy)
+    s[conv2d_stage].tensorize(x_bi, env.gemm)
+    s[output].pragma(x_co1, env.dma_copy)
+
+    return s
@@ -62,6 +62,7 @@ def dense_packed(cfg, data, weight, bias=None, out_dtype=None):
         ),
         name="res",
         tag="dense_pack",
+        attrs={"auto_scheduler_vta_gemm": "vta_gemm"},
     )
 
     cfg.add_flop(2 * np.prod(topi.utils.get_const_tuple(oshape)) * ishape[1] * ishape[3])
@@ -38,7 +38,7 @@ def group_conv2d_packed(cfg, data, kernel, strides, padding, dilation, group, ou
     assert len(data.shape) == 6
     assert len(kernel.shape) == 6
     assert data.dtype == "int8", data.dtype
-    assert kernel.dtype == "int8", kernel.dtype
+    assert kernel.dtype == get_env().wgt_dtype, kernel.dtype
     assert out_dtype == "int32", out_dtype
 
     oheight = topi.utils.get_const_int((pad_data.shape[2] - kernel.shape[2]) // strides[0] + 1)
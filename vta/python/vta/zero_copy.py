@@ -0,0 +1,75 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Zero-copy host access to VTA buffers
+
+Arrays allocated on ext_dev live in accelerator visible memory. The functions
+here map that memory into numpy, so the host can produce inputs in place and
+read outputs without going through an extra copy.
+"""
+import ctypes
+
+import numpy as np
+import tvm._ffi
+
+VTA_MEMCPY_H2D = 1
+VTA_MEMCPY_D2H = 2
+
+
+def cpu_view(arr):
+    """Get a numpy array sharing the memory of an ext_dev array.
+
+    Writes through the view must be followed by sync_for_device before
+    VTA reads the array, and device results must be fetched with
+    sync_for_cpu before they are read through the view.
+
+    Parameters
+    ----------
+    arr : tvm.nd.NDArray
+        The array allocated on ext_dev, on the local machine.
+
+    Returns
+    -------
+    view : numpy.ndarray
+        The array view on the CPU mapping of the buffer.
+    """
+    ptr = tvm._ffi.get_global_func("vta.runtime.ndarray_cpu_ptr")(arr)
+    dtype = np.dtype(arr.dtype)
+    nbytes = int(np.prod(arr.shape)) * dtype.itemsize
+    raw = (ctypes.c_uint8 * nbytes).from_address(ptr.value)
+    return np.frombuffer(raw, dtype=dtype).reshape(arr.shape)
+
+
+def sync_for_device(arr):
+    """Make CPU writes through cpu_view visible to VTA.
+
+    Parameters
+    ----------
+    arr : tvm.nd.NDArray
+        The array allocated on ext_dev.
+    """
+    tvm._ffi.get_global_func("vta.runtime.ndarray_sync")(arr, VTA_MEMCPY_H2D)
+
+
+def sync_for_cpu(arr):
+    """Wait for VTA and make its writes visible through cpu_view.
+
+    Parameters
+    ----------
+    arr : tvm.nd.NDArray
+        The array allocated on ext_dev.
+    """
+    tvm._ffi.get_global_func("vta.runtime.ndarray_sync")(arr, VTA_MEMCPY_D2H)
@@ -23,6 +23,8 @@
  */
 
 #include <dmlc/thread_local.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
 #include "../../src/runtime/workspace_pool.h"
@@ -33,7 +35,7 @@ namespace runtime {
 
 class VTADeviceAPI final : public DeviceAPI {
  public:
-  void SetDevice(Device dev) final {}
+  void SetDevice(Device dev) final { VTASetDevice(dev.device_id); }
 
   void GetAttr(Device dev, DeviceAttrKind kind, TVMRetValue* rv) final {
     if (kind == kExist) {
@@ -42,10 +44,10 @@ class VTADeviceAPI final : public DeviceAPI {
   }
 
   void* AllocDataSpace(Device dev, size_t size, size_t alignment, DLDataType type_hint) final {
-    return VTABufferAlloc(size);
+    return VTABufferPoolAlloc(size);
   }
 
-  void FreeDataSpace(Device dev, void* ptr) final { VTABufferFree(ptr); }
+  void FreeDataSpace(Device dev, void* ptr) final { VTABufferPoolFree(ptr); }
 
   void CopyDataFromTo(const void* from, size_t from_offset, void* to, size_t to_offset, size_t size,
                       Device dev_from, Device dev_to, DLDataType type_hint,
@@ -57,10 +59,47 @@ class VTADeviceAPI final : public DeviceAPI {
     if (dev_to.device_type != kDLCPU) {
       kind_mask |= 1;
     }
+    // The copy waits for the in-flight work of the current device
+    VTASetDevice(dev_from.device_type != kDLCPU ? dev_from.device_id : dev_to.device_id);
     VTABufferCopy(from, from_offset, to, to_offset, size, kind_mask);
   }
 
-  void StreamSync(Device dev, TVMStreamHandle stream) final {}
+  void StreamSync(Device dev, TVMStreamHandle stream) final {
+    VTAWait(VTADeviceCommandHandle(dev.device_id));
+  }
+
+  bool CaptureBegin(Device dev) final {
+    // The captured operators issue their commands to the current device
+    VTASetDevice(dev.device_id);
+    VTACaptureBegin(VTADeviceCommandHandle(dev.device_id));
+    return true;
+  }
+
+  void* CaptureEnd(Device dev) final {
+    return VTACaptureEnd(VTADeviceCommandHandle(dev.device_id));
+  }
+
+  bool CaptureAppend(Device dev, void* graph, void* other) final {
+    VTAGraphAppend(graph, other);
+    return true;
+  }
+
+  bool CaptureRebind(Device dev, void* graph, void* old_data, void* new_data) final {
+    return VTAGraphRebind(graph, old_data, new_data) == 0;
+  }
+
+  void CaptureReplay(Device dev, void* graph, TVMStreamHandle stream) final {
+    VTAGraphLaunch(VTADeviceCommandHandle(dev.device_id), graph, kReplayWaitCycles);
+  }
+
+  void CaptureFree(Device dev, void* graph) final { VTAGraphFree(graph); }
+
+  /*!
+   * \brief Get the CPU mapping of a data space, for zero-copy access from the host.
+   * \param data The data space returned by AllocDataSpace.
+   * \return The pointer that can be accessed by the CPU.
+   */
+  void* GetCPUPtr(void* data) { return VTABufferCPUPtr(VTATLSCommandHandle(), data); }
 
   void* AllocWorkspace(Device dev, size_t size, DLDataType type_hint) final;
 
@@ -70,6 +109,10 @@ class VTADeviceAPI final : public DeviceAPI {
     static VTADeviceAPI* inst = new VTADeviceAPI();
     return inst;
   }
+
+ private:
+  /*! \brief Poll budget of the replayed device runs. */
+  static constexpr uint32_t kReplayWaitCycles = 1U << 31;
 };
 
 struct VTAWorkspacePool : public WorkspacePool {
@@ -91,5 +134,61 @@ static TVM_ATTRIBUTE_UNUSED auto& __register_dev__ =
           DeviceAPI* ptr = VTADeviceAPI::Global();
           *rv = static_cast<void*>(ptr);
         });
+
+TVM_REGISTER_GLOBAL("vta.runtime.ndarray_cpu_ptr").set_body_typed([](NDArray arr) {
+  ICHECK_EQ(arr->device.device_type, kDLExtDev) << "Expect an ext_dev array";
+  return static_cast<void*>(static_cast<char*>(VTADeviceAPI::Global()->GetCPUPtr(arr->data)) +
+                            arr->byte_offset);
+});
+
+TVM_REGISTER_GLOBAL("vta.runtime.ndarray_sync").set_body_typed([](NDArray arr, int kind) {
+  ICHECK_EQ(arr->device.device_type, kDLExtDev) << "Expect an ext_dev array";
+  VTASetDevice(arr->device.device_id);
+  VTABufferSync(arr->data, arr->byte_offset, GetDataSize(*arr.operator->()), kind);
+});
+
+TVM_REGISTER_GLOBAL("profiling.counters.ext_dev").set_body_typed([](Device dev) {
+  VTAStageCounters counters;
+  VTAGetStageCounters(VTADeviceCommandHandle(dev.device_id), &counters);
+  auto count = [](uint64_t value) {
+    return ObjectRef(make_object<profiling::CountNode>(static_cast<int64_t>(value)));
+  };
+  Map<String, ObjectRef> metrics;
+  metrics.Set("VTA Load Bytes", count(counters.load_bytes));
+  metrics.Set("VTA Compute Load Bytes", count(counters.compute_load_bytes));
+  metrics.Set("VTA GEMM Uops", count(counters.gemm_uops));
+  metrics.Set("VTA ALU Uops", count(counters.alu_uops));
+  metrics.Set("VTA Store Bytes", count(counters.store_bytes));
+  metrics.Set("VTA Device Runs", count(counters.device_runs));
+  metrics.Set("VTA Busy (ns)", count(counters.device_busy_ns));
+  return metrics;
+});
+
+TVM_REGISTER_GLOBAL("vta.runtime.uop_kernel_cache_stats")
+    .set_body_typed([](Device dev, std::string key) {
+      uint64_t hits, misses;
+      VTAUopKernelCacheStats(VTADeviceCommandHandle(dev.device_id), &hits, &misses);
+      if (key == "hits") return static_cast<int64_t>(hits);
+      ICHECK_EQ(key, "misses") << "Unknown uop kernel cache statistic " << key;
+      return static_cast<int64_t>(misses);
+    });
+
+TVM_REGISTER_GLOBAL("vta.runtime.buffer_pool_stats").set_body_typed([](std::string key) {
+  uint64_t hits, misses, cached_buffers, cached_bytes;
+  VTABufferPoolStats(&hits, &misses, &cached_buffers, &cached_bytes);
+  if (key == "hits") return static_cast<int64_t>(hits);
+  if (key == "misses") return static_cast<int64_t>(misses);
+  if (key == "cached_buffers") return static_cast<int64_t>(cached_buffers);
+  ICHECK_EQ(key, "cached_bytes") << "Unknown buffer pool statistic " << key;
+  return static_cast<int64_t>(cached_bytes);
+});
+
+TVM_REGISTER_GLOBAL("vta.runtime.buffer_pool_release").set_body_typed([]() {
+  VTABufferPoolRelease();
+});
+
+TVM_REGISTER_GLOBAL("vta.runtime.trace_write").set_body_typed([](std::string path) {
+  VTATraceWrite(path.c_str());
+});
 }  // namespace runtime
 }  // namespace tvm
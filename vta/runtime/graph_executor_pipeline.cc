@@ -0,0 +1,330 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_executor_pipeline.cc
+ * \brief Graph executor that pipelines frames across its CPU and VTA stages.
+ */
+
+#include <dmlc/memory_io.h>
+#include <tvm/runtime/registry.h>
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../../src/runtime/graph_executor/graph_executor.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Graph executor of a single frame in the pipeline.
+ */
+class PipelineFrameExecutor : public GraphExecutor {
+ public:
+  /*!
+   * \brief Split the operators into stages of consecutive operators on the same device.
+   * \return The [begin, end) node ranges of the stages in execution order.
+   */
+  std::vector<std::pair<size_t, size_t>> Stages() const {
+    std::vector<std::pair<size_t, size_t>> stages;
+    int stage_device = -1;
+    for (size_t nid = 0; nid < op_execs_.size(); ++nid) {
+      if (nodes_[nid].op_type == "null") continue;
+      // Without device annotations every operator runs on the first device
+      int device_type = static_cast<int>(devices_[0].device_type);
+      if (!attrs_.device_index.empty()) {
+        device_type = attrs_.device_index[entry_id(nid, 0)];
+      }
+      bool on_vta = device_type == kDLExtDev;
+      if (stages.empty() || on_vta != (stage_device == kDLExtDev)) {
+        stages.emplace_back(nid, nid + 1);
+        stage_device = device_type;
+      } else {
+        stages.back().second = nid + 1;
+      }
+    }
+    return stages;
+  }
+  /*!
+   * \brief Run the operators of a stage.
+   * \param begin The first node of the stage.
+   * \param end The node after the stage.
+   */
+  void RunStage(size_t begin, size_t end) {
+    for (size_t nid = begin; nid < end; ++nid) {
+      if (op_execs_[nid]) op_execs_[nid]();
+    }
+  }
+};
+
+/*!
+ * \brief Graph executor that overlaps the stages of consecutive frames.
+ *
+ *  graph_pack with device annotations places the packed body of a network on
+ *  VTA and its head and tail on the CPU. Every stage of consecutive operators on
+ *  the same device runs on a thread of its own, so the CPU head and tail of one
+ *  frame run while the VTA body of another executes on the accelerator.
+ *
+ *  Each frame in flight uses its own executor, they share the parameters. The
+ *  frames go through every stage in the order they were submitted by run().
+ *  wait() waits for the oldest frame, whose outputs are then read with
+ *  get_output until the next wait().
+ */
+class GraphExecutorPipeline : public ModuleNode {
+ public:
+  const char* type_key() const final { return "GraphExecutorPipeline"; }
+
+  ~GraphExecutorPipeline() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+  }
+
+  /*!
+   * \brief Initialize the executors and start the stage threads.
+   * \param graph_json The execution graph.
+   * \param module The module containing the compiled functions.
+   * \param devs The devices of the graph.
+   * \param num_slots Number of frames in flight, including the frame being read.
+   */
+  void Init(const std::string& graph_json, tvm::runtime::Module module,
+            const std::vector<Device>& devs, int num_slots) {
+    ICHECK_GE(num_slots, 2) << "A pipeline needs at least two frame slots";
+    for (int i = 0; i < num_slots; ++i) {
+      auto exec = make_object<PipelineFrameExecutor>();
+      exec->Init(graph_json, module, devs);
+      slots_.push_back(exec);
+    }
+    stages_ = slots_[0]->Stages();
+    stage_done_.resize(stages_.size(), 0);
+    for (size_t s = 0; s < stages_.size(); ++s) {
+      workers_.emplace_back([this, s]() { this->StageLoop(s); });
+    }
+  }
+
+  /*!
+   * \brief Set an input of the next frame, waiting for its slot to be free.
+   * \param index The input index.
+   * \param data_in The input data.
+   */
+  void SetInput(int index, DLTensor* data_in) { this->NextSlot()->SetInput(index, data_in); }
+
+  /*! \brief Submit the next frame. */
+  void Run() {
+    this->NextSlot();
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ++submitted_;
+    }
+    cv_.notify_all();
+  }
+
+  /*! \brief Wait for the oldest submitted frame, whose outputs become readable. */
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (has_current_) {
+      // The previous frame is not read anymore, its slot can take a new frame
+      ++released_;
+      has_current_ = false;
+      cv_.notify_all();
+    }
+    ICHECK_LT(released_, submitted_) << "No frame was submitted to the pipeline";
+    cv_.wait(lock, [this]() { return !error_.empty() || this->FramesDone() > released_; });
+    CheckError();
+    has_current_ = true;
+  }
+
+  /*!
+   * \brief Get an output of the frame returned by the last wait().
+   * \param index The output index.
+   */
+  NDArray GetOutput(int index) { return this->CurrentSlot()->GetOutput(index); }
+
+  /*!
+   * \brief Copy an output of the frame returned by the last wait().
+   * \param index The output index.
+   * \param data_out The output data.
+   */
+  void CopyOutputTo(int index, DLTensor* data_out) {
+    this->CurrentSlot()->CopyOutputTo(index, data_out);
+  }
+
+  /*!
+   * \brief Load the parameters into every slot, sharing them.
+   * \param param_blob A binary blob of parameter.
+   */
+  void LoadParams(const std::string& param_blob) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this]() { return this->FramesDone() == submitted_; });
+    lock.unlock();
+    slots_[0]->LoadParams(param_blob);
+    for (size_t i = 1; i < slots_.size(); ++i) {
+      dmlc::MemoryStringStream strm(const_cast<std::string*>(&param_blob));
+      slots_[i]->ShareParams(*slots_[0], &strm);
+    }
+  }
+
+  /*!
+   * \brief GetFunction Get the function based on input.
+   * \param name The function which needs to be invoked.
+   * \param sptr_to_self Packed function pointer.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+ private:
+  // Number of frames that went through every stage
+  uint64_t FramesDone() const { return stages_.empty() ? submitted_ : stage_done_.back(); }
+
+  void CheckError() {
+    if (!error_.empty()) LOG(FATAL) << "Pipeline stage failed: " << error_;
+  }
+
+  // The slot of the next frame, once the frame that used it before is released
+  PipelineFrameExecutor* NextSlot() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this]() {
+      return !error_.empty() || submitted_ - released_ < slots_.size();
+    });
+    CheckError();
+    return slots_[submitted_ % slots_.size()].get();
+  }
+
+  PipelineFrameExecutor* CurrentSlot() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ICHECK(has_current_) << "Call wait before reading the outputs of the pipeline";
+    return slots_[released_ % slots_.size()].get();
+  }
+
+  // Run one stage of every frame in submission order
+  void StageLoop(size_t stage) {
+    while (true) {
+      uint64_t frame;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [this, stage]() {
+          uint64_t ready = stage == 0 ? submitted_ : stage_done_[stage - 1];
+          return shutdown_ || !error_.empty() || stage_done_[stage] < ready;
+        });
+        if (shutdown_ || !error_.empty()) return;
+        frame = stage_done_[stage];
+      }
+      try {
+        slots_[frame % slots_.size()]->RunStage(stages_[stage].first, stages_[stage].second);
+      } catch (const std::exception& err) {
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          error_ = err.what();
+        }
+        cv_.notify_all();
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mtx_);
+        ++stage_done_[stage];
+      }
+      cv_.notify_all();
+    }
+  }
+
+  /*! \brief The executor of each frame slot. */
+  std::vector<ObjectPtr<PipelineFrameExecutor>> slots_;
+  /*! \brief The [begin, end) node range of each stage. */
+  std::vector<std::pair<size_t, size_t>> stages_;
+  /*! \brief The thread running each stage. */
+  std::vector<std::thread> workers_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  /*! \brief Number of frames submitted, and that finished each stage. */
+  uint64_t submitted_{0};
+  std::vector<uint64_t> stage_done_;
+  /*! \brief Number of frames whose slot was handed back. */
+  uint64_t released_{0};
+  /*! \brief Whether the frame after the released ones is being read. */
+  bool has_current_{false};
+  /*! \brief Message of the first failed stage. */
+  std::string error_;
+  bool shutdown_{false};
+};
+
+PackedFunc GraphExecutorPipeline::GetFunction(const std::string& name,
+                                              const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "set_input") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int in_idx = -1;
+      if (String::CanConvertFrom(args[0])) {
+        in_idx = slots_[0]->GetInputIndex(args[0].operator String());
+      } else {
+        in_idx = args[0];
+      }
+      ICHECK_GE(in_idx, 0) << "Cannot find input " << args[0].operator String();
+      this->SetInput(in_idx, args[1]);
+    });
+  } else if (name == "run") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+  } else if (name == "wait") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Wait(); });
+  } else if (name == "get_output") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args.num_args == 2) {
+        this->CopyOutputTo(args[0], args[1]);
+      } else {
+        *rv = this->GetOutput(args[0]);
+      }
+    });
+  } else if (name == "get_num_outputs") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = slots_[0]->NumOutputs();
+    });
+  } else if (name == "get_num_inputs") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = slots_[0]->NumInputs();
+    });
+  } else if (name == "get_num_stages") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int>(stages_.size());
+    });
+  } else if (name == "load_params") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParams(args[0].operator std::string());
+    });
+  } else {
+    return PackedFunc();
+  }
+}
+
+TVM_REGISTER_GLOBAL("tvm.graph_executor_pipeline.create")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_GE(args.num_args, 5) << "The expected number of arguments for "
+                                     "graph_executor_pipeline.create is at least 5, but it has "
+                                  << args.num_args;
+      auto exec = make_object<GraphExecutorPipeline>();
+      exec->Init(args[0], args[1], GetAllDevice(args, 3), args[2]);
+      *rv = Module(exec);
+    });
+}  // namespace runtime
+}  // namespace tvm
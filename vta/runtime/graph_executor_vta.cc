@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file graph_executor_vta.cc
+ * \brief Graph executor that replays recorded VTA instruction streams.
+ */
+
+#include <tvm/runtime/registry.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../src/runtime/file_utils.h"
+#include "../../src/runtime/graph_executor/graph_executor.h"
+#include "runtime.h"
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Graph executor with VTA graph support.
+ *
+ *  The graphs are recorded and replayed by the capture mode of GraphExecutor,
+ *  through the capture hooks of the VTA device API. Operators whose work is fully
+ *  described by their VTA instructions are replayed from the recording, and
+ *  consecutive ones are merged so that they execute in as few VTADeviceRun calls
+ *  as possible. Operators that touch device buffers from the CPU keep running
+ *  through their packed function.
+ *
+ *  Recorded streams refer to the physical addresses of the buffers used while
+ *  recording. Inputs rebound through SetInputZeroCopy are patched before replay,
+ *  workspace buffers are assumed to be handed out identically on every run.
+ *
+ *  Parameters on VTA are loaded into a parameter arena that lives as long as the
+ *  executor. They are written and flushed once by load_params, and later runs do
+ *  no cache maintenance on them.
+ */
+class GraphExecutorVTA : public GraphExecutor {
+ public:
+  ~GraphExecutorVTA() {
+    this->ReleaseCapture();
+    if (arena_ != nullptr) VTAParamArenaRelease(arena_);
+  }
+
+  /*!
+   * \brief Load parameters, placing the ones on VTA in the parameter arena.
+   * \param param_blob A binary blob of parameter.
+   */
+  void LoadParamsToArena(const std::string& param_blob) {
+    Map<String, NDArray> params = ::tvm::runtime::LoadParams(param_blob);
+    std::vector<std::pair<uint32_t, NDArray>> vta_params;
+    size_t arena_bytes = 0;
+    for (auto& p : params) {
+      int in_idx = GetInputIndex(p.first);
+      if (in_idx < 0) continue;
+      uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+      // Arena buffers of a previous load are overwritten in place
+      if (arena_ != nullptr || data_entry_[eid]->device.device_type != kDLExtDev) {
+        data_entry_[eid].CopyFrom(p.second);
+        continue;
+      }
+      vta_params.emplace_back(eid, p.second);
+      arena_bytes += (GetDataSize(*data_entry_[eid].operator->()) + kArenaAlign - 1) /
+                     kArenaAlign * kArenaAlign;
+    }
+    if (vta_params.empty()) return;
+    // The recorded streams refer to the buffers the parameters leave
+    this->ReleaseCapture();
+    arena_ = VTAParamArenaCreate(arena_bytes);
+    for (auto& p : vta_params) {
+      const NDArray& entry = data_entry_[p.first];
+      void* data = VTAParamArenaAlloc(arena_, GetDataSize(*entry.operator->()));
+      ICHECK(data != nullptr) << "Parameter arena is full";
+      std::vector<int64_t> shape{entry->shape, entry->shape + entry->ndim};
+      std::unique_ptr<NDArray::Container> container{
+          new NDArray::Container(data, shape, entry->dtype, entry->device)};
+      container->SetDeleter(GraphExecutorVTA::ArenaNDArrayDeleter);
+      NDArray param(GetObjectPtr<Object>(container.release()));
+      param.CopyFrom(p.second);
+      data_entry_[p.first] = param;
+    }
+    // Give the storage only used by the moved parameters back to the pool
+    std::vector<bool> moved(data_entry_.size(), false);
+    for (auto& p : vta_params) moved[p.first] = true;
+    std::vector<bool> in_use(storage_pool_.size(), false);
+    for (size_t eid = 0; eid < attrs_.storage_id.size(); ++eid) {
+      if (!moved[eid]) in_use[attrs_.storage_id[eid]] = true;
+    }
+    for (size_t sid = 0; sid < storage_pool_.size(); ++sid) {
+      if (!in_use[sid]) storage_pool_[sid] = NDArray();
+    }
+    // The operators hold copies of the DLTensors of the entries
+    input_dltensors_.clear();
+    this->SetupOpExecs();
+  }
+
+  /*!
+   * \brief Run the graph, replaying the recorded VTA graphs.
+   */
+  void RunVTAGraph() {
+    capture_mode_ = true;
+    this->Run();
+  }
+
+  /*!
+   * \brief GetFunction Get the function based on input.
+   * \param name The function which needs to be invoked.
+   * \param sptr_to_self Packed function pointer.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self);
+
+ private:
+  /*! \brief Free an NDArray::Container over a parameter arena buffer. */
+  static void ArenaNDArrayDeleter(Object* container) {
+    NDArray::Container* ptr = static_cast<NDArray::Container*>(container);
+    VTABufferFree(ptr->dl_tensor.data);
+    delete ptr;
+  }
+
+  /*! \brief Alignment of the parameter arena buffers. */
+  static constexpr size_t kArenaAlign = 64;
+  /*! \brief The arena of the parameters on VTA, once they are loaded. */
+  VTAParamArenaHandle arena_{nullptr};
+};
+
+PackedFunc GraphExecutorVTA::GetFunction(const std::string& name,
+                                         const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "run_vta_graph") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->RunVTAGraph(); });
+  } else if (name == "capture_vta_graph") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Capture(); });
+  } else if (name == "load_params") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsToArena(args[0].operator std::string());
+    });
+  } else {
+    return GraphExecutor::GetFunction(name, sptr_to_self);
+  }
+}
+
+Module GraphExecutorVTACreate(const std::string& sym_json, const tvm::runtime::Module& m,
+                              const std::vector<Device>& devs,
+                              PackedFunc lookup_linked_param_func) {
+  auto exec = make_object<GraphExecutorVTA>();
+  exec->Init(sym_json, m, devs, lookup_linked_param_func);
+  return Module(exec);
+}
+
+TVM_REGISTER_GLOBAL("tvm.graph_executor_vta.create").set_body([](TVMArgs args, TVMRetValue* rv) {
+  ICHECK_GE(args.num_args, 4) << "The expected number of arguments for graph_executor.create is "
+                                 "at least 4, but it has "
+                              << args.num_args;
+  PackedFunc lookup_linked_param_func;
+  int dev_start_arg = 2;
+  if (args[2].type_code() == kTVMPackedFuncHandle) {
+    lookup_linked_param_func = args[2];
+    dev_start_arg++;
+  }
+
+  *rv = GraphExecutorVTACreate(args[0], args[1], GetAllDevice(args, dev_start_arg),
+                               lookup_linked_param_func);
+});
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,403 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file oclfpga_device.cc
+ * \brief VTA driver for Intel FPGAs programmed with the Intel FPGA SDK for OpenCL.
+ */
+
+#include "oclfpga_device.h"
+
+#include <dmlc/logging.h>
+#include <tvm/runtime/registry.h>
+#include <vta/hw_spec.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include "../runtime.h"
+
+#define VTA_OCL_CALL(func)                                         \
+  {                                                                \
+    cl_int e = (func);                                             \
+    CHECK(e == CL_SUCCESS) << #func << " failed with error " << e; \
+  }
+
+namespace vta {
+
+// Without coherent accesses the runtime flushes and invalidates the mirrors, otherwise the
+// mirrors are written through and read back on copies.
+static const bool kCoherent = VTA_COHERENT_ACCESSES;
+// Alignment of the allocations in device memory, the width of the memory interface
+static const size_t kMemAlignment = 64;
+// Polls of the kernel events spin before sleeping between polls
+static const uint32_t kSpinPolls = 1024;
+static const char* kKernelNames[] = {"vta_fetch", "vta_load", "vta_compute", "vta_store"};
+
+OCLFPGADevice* OCLFPGADevice::Global() {
+  static OCLFPGADevice* device = new OCLFPGADevice();
+  return device;
+}
+
+OCLFPGADevice::~OCLFPGADevice() {
+  std::lock_guard<std::mutex> launch_lock(launch_mtx_);
+  std::lock_guard<std::mutex> mem_lock(mem_mtx_);
+  this->Release();
+}
+
+void OCLFPGADevice::Program(const std::string& bitstream, size_t mem_size) {
+  std::lock_guard<std::mutex> launch_lock(launch_mtx_);
+  std::lock_guard<std::mutex> mem_lock(mem_mtx_);
+  CHECK(allocs_.empty()) << "Cannot program the FPGA while VTA buffers are allocated";
+  CHECK(mem_size > 0 && mem_size <= (static_cast<uint64_t>(1) << (sizeof(vta_phy_addr_t) * 8)))
+      << "The device memory of VTA must fit the physical addresses, got " << mem_size;
+  this->Release();
+
+  std::ifstream file(bitstream, std::ios::binary);
+  CHECK(file) << "Cannot open the bitstream " << bitstream;
+  std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+
+  // Take the first accelerator, preferring the platform of the Intel FPGA SDK
+  cl_uint num_platforms = 0;
+  VTA_OCL_CALL(clGetPlatformIDs(0, nullptr, &num_platforms));
+  std::vector<cl_platform_id> platforms(num_platforms);
+  VTA_OCL_CALL(clGetPlatformIDs(num_platforms, platforms.data(), nullptr));
+  std::stable_partition(platforms.begin(), platforms.end(), [](cl_platform_id platform) {
+    char name[256] = {0};
+    clGetPlatformInfo(platform, CL_PLATFORM_NAME, sizeof(name) - 1, name, nullptr);
+    return std::strstr(name, "FPGA") != nullptr;
+  });
+  for (cl_platform_id platform : platforms) {
+    if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_ACCELERATOR, 1, &device_, nullptr) == CL_SUCCESS) {
+      break;
+    }
+    device_ = nullptr;
+  }
+  CHECK(device_ != nullptr) << "Cannot find an OpenCL FPGA device";
+
+  cl_int err;
+  context_ = clCreateContext(nullptr, 1, &device_, nullptr, nullptr, &err);
+  VTA_OCL_CALL(err);
+  size_t binary_size = binary.size();
+  const unsigned char* binary_data = binary.data();
+  program_ = clCreateProgramWithBinary(context_, 1, &device_, &binary_size, &binary_data, nullptr,
+                                       &err);
+  VTA_OCL_CALL(err);
+  err = clBuildProgram(program_, 1, &device_, "", nullptr, nullptr);
+  if (err != CL_SUCCESS) {
+    size_t log_size = 0;
+    clGetProgramBuildInfo(program_, device_, CL_PROGRAM_BUILD_LOG, 0, nullptr, &log_size);
+    std::string log(log_size, '\0');
+    clGetProgramBuildInfo(program_, device_, CL_PROGRAM_BUILD_LOG, log_size, &log[0], nullptr);
+    LOG(FATAL) << "Cannot program the FPGA with " << bitstream << ": " << log;
+  }
+  dram_ = clCreateBuffer(context_, CL_MEM_READ_WRITE, mem_size, nullptr, &err);
+  VTA_OCL_CALL(err);
+  for (int i = 0; i < kNumModules; ++i) {
+    kernels_[i] = clCreateKernel(program_, kKernelNames[i], &err);
+    VTA_OCL_CALL(err);
+    queues_[i] = clCreateCommandQueue(context_, device_, 0, &err);
+    VTA_OCL_CALL(err);
+    cl_uint dram_arg = i == kFetch ? 2 : 0;
+    VTA_OCL_CALL(clSetKernelArg(kernels_[i], dram_arg, sizeof(cl_mem), &dram_));
+  }
+  transfer_queue_ = clCreateCommandQueue(context_, device_, 0, &err);
+  VTA_OCL_CALL(err);
+  free_[0] = mem_size;
+  LOG(INFO) << "Programmed the FPGA with " << bitstream << ", " << (mem_size >> 20)
+            << " MB of device memory";
+}
+
+void OCLFPGADevice::Release() {
+  for (LaunchEvents& launch : launches_) {
+    for (cl_event event : launch.events) clReleaseEvent(event);
+  }
+  launches_.clear();
+  if (last_write_ != nullptr) clReleaseEvent(last_write_);
+  last_write_ = nullptr;
+  free_.clear();
+  if (dram_ != nullptr) clReleaseMemObject(dram_);
+  dram_ = nullptr;
+  for (int i = 0; i < kNumModules; ++i) {
+    if (kernels_[i] != nullptr) clReleaseKernel(kernels_[i]);
+    if (queues_[i] != nullptr) clReleaseCommandQueue(queues_[i]);
+    kernels_[i] = nullptr;
+    queues_[i] = nullptr;
+  }
+  if (transfer_queue_ != nullptr) clReleaseCommandQueue(transfer_queue_);
+  transfer_queue_ = nullptr;
+  if (program_ != nullptr) clReleaseProgram(program_);
+  program_ = nullptr;
+  if (context_ != nullptr) clReleaseContext(context_);
+  context_ = nullptr;
+}
+
+void* OCLFPGADevice::MemAlloc(size_t size) {
+  std::lock_guard<std::mutex> lock(mem_mtx_);
+  CHECK(context_ != nullptr) << "Program the FPGA with vta.oclfpga.program first";
+  size_t bytes = (std::max<size_t>(size, 1) + kMemAlignment - 1) / kMemAlignment * kMemAlignment;
+  // First fit, the buffers of a model are mostly allocated once
+  auto it = std::find_if(free_.begin(), free_.end(),
+                         [bytes](const std::pair<const vta_phy_addr_t, size_t>& range) {
+                           return range.second >= bytes;
+                         });
+  if (it == free_.end()) {
+    LOG(WARNING) << "Out of VTA device memory allocating " << size << " bytes";
+    return nullptr;
+  }
+  vta_phy_addr_t phy_addr = it->first;
+  size_t remaining = it->second - bytes;
+  free_.erase(it);
+  if (remaining != 0) free_[static_cast<vta_phy_addr_t>(phy_addr + bytes)] = remaining;
+
+  cl_int err;
+  cl_mem host = clCreateBuffer(context_, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bytes,
+                               nullptr, &err);
+  void* data = nullptr;
+  if (err == CL_SUCCESS) {
+    data = clEnqueueMapBuffer(transfer_queue_, host, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0,
+                              bytes, 0, nullptr, nullptr, &err);
+    if (err != CL_SUCCESS) clReleaseMemObject(host);
+  }
+  if (err != CL_SUCCESS) {
+    LOG(WARNING) << "Cannot allocate " << bytes << " bytes of pinned host memory, error " << err;
+    this->FreeRange(phy_addr, bytes);
+    return nullptr;
+  }
+  allocs_[static_cast<const char*>(data)] = Allocation{phy_addr, bytes, host, nullptr};
+  return data;
+}
+
+void OCLFPGADevice::MemFree(void* buf) {
+  std::lock_guard<std::mutex> lock(mem_mtx_);
+  auto it = allocs_.find(static_cast<const char*>(buf));
+  CHECK(it != allocs_.end()) << "Cannot free " << buf << ", not allocated by VTAMemAlloc";
+  Allocation& alloc = it->second;
+  if (alloc.write != nullptr) {
+    clWaitForEvents(1, &alloc.write);
+    clReleaseEvent(alloc.write);
+  }
+  // The buffer is released once unmapped
+  clEnqueueUnmapMemObject(transfer_queue_, alloc.host, buf, 0, nullptr, nullptr);
+  clReleaseMemObject(alloc.host);
+  this->FreeRange(alloc.phy_addr, alloc.size);
+  allocs_.erase(it);
+}
+
+OCLFPGADevice::AllocMap::iterator OCLFPGADevice::Find(const void* buf) {
+  const char* ptr = static_cast<const char*>(buf);
+  auto it = allocs_.upper_bound(ptr);
+  if (it == allocs_.begin()) return allocs_.end();
+  --it;
+  return ptr < it->first + it->second.size ? it : allocs_.end();
+}
+
+void OCLFPGADevice::FreeRange(vta_phy_addr_t phy_addr, size_t size) {
+  auto next = free_.lower_bound(phy_addr);
+  if (next != free_.end() && phy_addr + static_cast<uint64_t>(size) == next->first) {
+    size += next->second;
+    next = free_.erase(next);
+  }
+  if (next != free_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + static_cast<uint64_t>(prev->second) == phy_addr) {
+      prev->second += size;
+      return;
+    }
+  }
+  free_[phy_addr] = size;
+}
+
+vta_phy_addr_t OCLFPGADevice::PhyAddr(const void* buf) {
+  std::lock_guard<std::mutex> lock(mem_mtx_);
+  auto it = this->Find(buf);
+  CHECK(it != allocs_.end()) << buf << " is not in a buffer allocated by VTAMemAlloc";
+  const char* ptr = static_cast<const char*>(buf);
+  return it->second.phy_addr + static_cast<vta_phy_addr_t>(ptr - it->first);
+}
+
+void OCLFPGADevice::Write(const void* vir_addr, vta_phy_addr_t phy_addr, size_t size) {
+  if (size == 0) return;
+  std::lock_guard<std::mutex> lock(mem_mtx_);
+  auto it = this->Find(vir_addr);
+  CHECK(it != allocs_.end()) << vir_addr << " is not in a buffer allocated by VTAMemAlloc";
+  Allocation* alloc = &it->second;
+  cl_event event;
+  VTA_OCL_CALL(clEnqueueWriteBuffer(transfer_queue_, dram_, CL_FALSE, phy_addr, size, vir_addr,
+                                    0, nullptr, &event));
+  VTA_OCL_CALL(clFlush(transfer_queue_));
+  if (alloc->write != nullptr) clReleaseEvent(alloc->write);
+  alloc->write = event;
+  clRetainEvent(event);
+  if (last_write_ != nullptr) clReleaseEvent(last_write_);
+  last_write_ = event;
+}
+
+void OCLFPGADevice::Read(void* vir_addr, vta_phy_addr_t phy_addr, size_t size) {
+  if (size == 0) return;
+  // The transfer queue is in order, so the read also waits for the writes of the range
+  VTA_OCL_CALL(clEnqueueReadBuffer(transfer_queue_, dram_, CL_TRUE, phy_addr, size, vir_addr, 0,
+                                   nullptr, nullptr));
+}
+
+void OCLFPGADevice::WaitWrite(const void* buf) {
+  cl_event event;
+  {
+    std::lock_guard<std::mutex> lock(mem_mtx_);
+    auto it = this->Find(buf);
+    if (it == allocs_.end() || it->second.write == nullptr) return;
+    event = it->second.write;
+    it->second.write = nullptr;
+  }
+  VTA_OCL_CALL(clWaitForEvents(1, &event));
+  clReleaseEvent(event);
+}
+
+int64_t OCLFPGADevice::Launch(vta_phy_addr_t insn_phy_addr, uint32_t insn_count) {
+  std::lock_guard<std::mutex> lock(launch_mtx_);
+  CHECK(context_ != nullptr) << "Program the FPGA with vta.oclfpga.program first";
+  cl_event write = nullptr;
+  {
+    std::lock_guard<std::mutex> mem_lock(mem_mtx_);
+    write = last_write_;
+    if (write != nullptr) clRetainEvent(write);
+  }
+  cl_uint insn_addr = insn_phy_addr;
+  cl_uint num_insns = insn_count;
+  cl_int err = clSetKernelArg(kernels_[kFetch], 0, sizeof(cl_uint), &insn_addr);
+  if (err == CL_SUCCESS) err = clSetKernelArg(kernels_[kFetch], 1, sizeof(cl_uint), &num_insns);
+  LaunchEvents launch{num_launches_ + 1, {}};
+  int num_enqueued = 0;
+  for (int i = 0; i < kNumModules && err == CL_SUCCESS; ++i) {
+    err = clEnqueueTask(queues_[i], kernels_[i], write != nullptr ? 1 : 0,
+                        write != nullptr ? &write : nullptr, &launch.events[i]);
+    if (err == CL_SUCCESS) {
+      ++num_enqueued;
+      err = clFlush(queues_[i]);
+    }
+  }
+  if (write != nullptr) clReleaseEvent(write);
+  if (err != CL_SUCCESS) {
+    // The kernels already enqueued wait on the others, the device must be reprogrammed
+    LOG(WARNING) << "Cannot launch the VTA kernels, error " << err;
+    for (int i = 0; i < num_enqueued; ++i) clReleaseEvent(launch.events[i]);
+    return -1;
+  }
+  num_launches_ = launch.id;
+  launches_.push_back(launch);
+  return launch.id;
+}
+
+int OCLFPGADevice::Sync(int64_t launch, uint32_t wait_cycles) {
+  std::vector<LaunchEvents> launches;
+  {
+    std::lock_guard<std::mutex> lock(launch_mtx_);
+    while (!launches_.empty() && launches_.front().id <= launch) {
+      launches.push_back(launches_.front());
+      launches_.pop_front();
+    }
+  }
+  int ret = 0;
+  uint32_t polls = 0;
+  for (LaunchEvents& entry : launches) {
+    for (cl_event event : entry.events) {
+      cl_int status = 1;
+      while (ret == 0) {
+        VTA_OCL_CALL(clGetEventInfo(event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status),
+                                    &status, nullptr));
+        if (status == CL_COMPLETE) break;
+        if (status < 0) {
+          LOG(WARNING) << "VTA launch " << entry.id << " failed with error " << status;
+          ret = 1;
+        } else if (++polls >= wait_cycles) {
+          ret = 1;
+        } else if (polls < kSpinPolls) {
+          std::this_thread::yield();
+        } else {
+          std::this_thread::sleep_for(std::chrono::microseconds(10));
+        }
+      }
+      clReleaseEvent(event);
+    }
+  }
+  return ret;
+}
+
+TVM_REGISTER_GLOBAL("vta.oclfpga.program")
+    .set_body_typed([](std::string bitstream, int64_t mem_size) {
+      OCLFPGADevice::Global()->Program(bitstream, static_cast<size_t>(mem_size));
+    });
+
+}  // namespace vta
+
+using vta::OCLFPGADevice;
+
+VTADeviceHandle VTADeviceAlloc() { return OCLFPGADevice::Global(); }
+
+void VTADeviceFree(VTADeviceHandle handle) {}
+
+int64_t VTADeviceLaunch(VTADeviceHandle handle, vta_phy_addr_t insn_phy_addr,
+                        uint32_t insn_count) {
+  return static_cast<OCLFPGADevice*>(handle)->Launch(insn_phy_addr, insn_count);
+}
+
+int VTADeviceSync(VTADeviceHandle handle, int64_t launch, uint32_t wait_cycles) {
+  return static_cast<OCLFPGADevice*>(handle)->Sync(launch, wait_cycles);
+}
+
+int VTADeviceRun(VTADeviceHandle handle, vta_phy_addr_t insn_phy_addr, uint32_t insn_count,
+                 uint32_t wait_cycles) {
+  int64_t launch = VTADeviceLaunch(handle, insn_phy_addr, insn_count);
+  if (launch < 0) return 1;
+  return VTADeviceSync(handle, launch, wait_cycles);
+}
+
+void* VTAMemAlloc(size_t size, int cached) { return OCLFPGADevice::Global()->MemAlloc(size); }
+
+void VTAMemFree(void* buf) { OCLFPGADevice::Global()->MemFree(buf); }
+
+vta_phy_addr_t VTAMemGetPhyAddr(void* buf) { return OCLFPGADevice::Global()->PhyAddr(buf); }
+
+void VTAMemCopyFromHost(void* dst, const void* src, size_t size) {
+  OCLFPGADevice* device = OCLFPGADevice::Global();
+  // A queued write may still read the mirror
+  device->WaitWrite(dst);
+  memcpy(dst, src, size);
+  if (vta::kCoherent) device->Write(dst, device->PhyAddr(dst), size);
+}
+
+void VTAMemCopyToHost(void* dst, const void* src, size_t size) {
+  OCLFPGADevice* device = OCLFPGADevice::Global();
+  if (vta::kCoherent) device->Read(const_cast<void*>(src), device->PhyAddr(src), size);
+  memcpy(dst, src, size);
+}
+
+void VTAFlushCache(void* vir_addr, vta_phy_addr_t phy_addr, int size) {
+  OCLFPGADevice::Global()->Write(vir_addr, phy_addr, size);
+}
+
+void VTAInvalidateCache(void* vir_addr, vta_phy_addr_t phy_addr, int size) {
+  OCLFPGADevice::Global()->Read(vir_addr, phy_addr, size);
+}
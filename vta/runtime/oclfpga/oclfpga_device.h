@@ -0,0 +1,174 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file oclfpga_device.h
+ * \brief VTA driver for Intel FPGAs programmed with the Intel FPGA SDK for OpenCL, such as
+ *  the Stratix 10 of the DE10-Pro attached over PCIe.
+ *
+ *  The bitstream holds a single work-item kernel per VTA module, each enqueued on its own
+ *  command queue so that the modules run at the same time:
+ *
+ *  - vta_fetch(uint insn_phy_addr, uint insn_count, global void* dram) reads an instruction
+ *    stream and dispatches the instructions to the other modules over channels.
+ *  - vta_load(global void* dram), vta_compute(global void* dram) and
+ *    vta_store(global void* dram) execute the instructions of their module, and return after
+ *    the FINISH instruction ending the stream.
+ *
+ *  The physical addresses of VTA are offsets into one buffer of device memory, of the size
+ *  given to vta.oclfpga.program. Each allocation is mirrored by a pinned host buffer that the
+ *  DMA engine reaches without a bounce copy. VTAFlushCache writes a range of the mirror to
+ *  the device memory and VTAInvalidateCache reads it back, on a transfer queue of their own.
+ *  Instruction streams are launched without waiting, behind the writes queued before them.
+ */
+
+#ifndef VTA_RUNTIME_OCLFPGA_OCLFPGA_DEVICE_H_
+#define VTA_RUNTIME_OCLFPGA_OCLFPGA_DEVICE_H_
+
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+#include <vta/driver.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace vta {
+
+/*! \brief An Intel FPGA programmed with a VTA bitstream, shared by the whole process. */
+class OCLFPGADevice {
+ public:
+  /*! \return The device of the process. */
+  static OCLFPGADevice* Global();
+
+  ~OCLFPGADevice();
+
+  /*!
+   * \brief Program the FPGA and allocate the device memory of VTA.
+   * \param bitstream The path of the aocx file.
+   * \param mem_size The size of the device memory in bytes.
+   */
+  void Program(const std::string& bitstream, size_t mem_size);
+  /*!
+   * \brief Allocate a buffer of device memory and its pinned host mirror.
+   * \param size The size of the buffer in bytes.
+   * \return The host mirror, nullptr if the device memory is exhausted.
+   */
+  void* MemAlloc(size_t size);
+  /*!
+   * \brief Free a buffer allocated by MemAlloc.
+   * \param buf The host mirror of the buffer.
+   */
+  void MemFree(void* buf);
+  /*!
+   * \brief Get the physical address of a location in a buffer.
+   * \param buf The location in the host mirror of the buffer.
+   */
+  vta_phy_addr_t PhyAddr(const void* buf);
+  /*!
+   * \brief Queue a write of a range of a host mirror to the device memory.
+   * \param vir_addr The range in the host mirror, it must not change until the write ends,
+   *  see WaitWrite.
+   * \param phy_addr The physical address of the range.
+   * \param size The size of the range in bytes.
+   */
+  void Write(const void* vir_addr, vta_phy_addr_t phy_addr, size_t size);
+  /*!
+   * \brief Read a range of the device memory into a host mirror.
+   * \param vir_addr The range in the host mirror.
+   * \param phy_addr The physical address of the range.
+   * \param size The size of the range in bytes.
+   */
+  void Read(void* vir_addr, vta_phy_addr_t phy_addr, size_t size);
+  /*!
+   * \brief Wait for the queued writes from the host mirror of a buffer.
+   * \param buf A location in the host mirror of the buffer.
+   */
+  void WaitWrite(const void* buf);
+  /*!
+   * \brief Launch an instruction stream after the queued writes.
+   * \param insn_phy_addr The physical address of the instruction stream.
+   * \param insn_count The number of instructions.
+   * \return The id of the launch, negative if the launch failed.
+   */
+  int64_t Launch(vta_phy_addr_t insn_phy_addr, uint32_t insn_count);
+  /*!
+   * \brief Wait for a launch and the earlier ones to finish.
+   * \param launch The id of the launch.
+   * \param wait_cycles The limit of polls of the kernel events.
+   * \return 0 if the launches finished, 1 if they timed out or failed.
+   */
+  int Sync(int64_t launch, uint32_t wait_cycles);
+
+ private:
+  /*! \brief The kernels, in enqueue order. */
+  enum Module { kFetch, kLoad, kCompute, kStore, kNumModules };
+
+  struct Allocation {
+    vta_phy_addr_t phy_addr;
+    size_t size;
+    // The pinned host buffer mapped to the mirror
+    cl_mem host;
+    // The last queued write from the mirror, or nullptr
+    cl_event write;
+  };
+
+  using AllocMap = std::map<const char*, Allocation>;
+
+  struct LaunchEvents {
+    int64_t id;
+    std::array<cl_event, kNumModules> events;
+  };
+
+  OCLFPGADevice() = default;
+  // Release the OpenCL objects, with both locks held
+  void Release();
+  // Get the allocation holding a location of a host mirror, with mem_mtx_ held
+  AllocMap::iterator Find(const void* buf);
+  // Return a range to the free list, merging it with its neighbors, with mem_mtx_ held
+  void FreeRange(vta_phy_addr_t phy_addr, size_t size);
+
+  cl_context context_{nullptr};
+  cl_device_id device_{nullptr};
+  cl_program program_{nullptr};
+  std::array<cl_kernel, kNumModules> kernels_{};
+  std::array<cl_command_queue, kNumModules> queues_{};
+  // The queue of the writes and reads between host mirrors and device memory
+  cl_command_queue transfer_queue_{nullptr};
+  // The device memory of VTA
+  cl_mem dram_{nullptr};
+  // Protects the allocations and the writes
+  std::mutex mem_mtx_;
+  // The allocations by host mirror, and the free ranges of device memory by physical address
+  AllocMap allocs_;
+  std::map<vta_phy_addr_t, size_t> free_;
+  // The last queued write, the transfer queue runs the writes in order
+  cl_event last_write_{nullptr};
+  // Protects the launches
+  std::mutex launch_mtx_;
+  std::deque<LaunchEvents> launches_;
+  int64_t num_launches_{0};
+};
+
+}  // namespace vta
+
+#endif  // VTA_RUNTIME_OCLFPGA_OCLFPGA_DEVICE_H_
@@ -27,6 +27,7 @@
 #include "runtime.h"
 
 #include <dmlc/logging.h>
+#include <inttypes.h>
 #include <malloc.h>
 #include <stdlib.h>
 #include <tvm/runtime/c_runtime_api.h>
@@ -34,12 +35,20 @@
 #include <vta/hw_spec.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <limits>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace vta {
@@ -116,14 +125,57 @@ class DeviceAllocStat {
     allocated_.erase(ptr);
   }
 
+  /*! \brief Statistics of the data buffer pool. */
+  struct PoolStats {
+    /*! \brief Allocations served from cached buffers. */
+    uint64_t hits{0};
+    /*! \brief Allocations that went to VTAMemAlloc. */
+    uint64_t misses{0};
+    /*! \brief Number of buffers held by the pool. */
+    uint64_t cached_buffers{0};
+    /*! \brief Total bytes held by the pool. */
+    uint64_t cached_bytes{0};
+  };
+
+  void RecordPoolAlloc(bool hit, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (hit) {
+      ++pool_stats_.hits;
+      --pool_stats_.cached_buffers;
+      pool_stats_.cached_bytes -= bytes;
+    } else {
+      ++pool_stats_.misses;
+    }
+  }
+
+  void RecordPoolCache(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++pool_stats_.cached_buffers;
+    pool_stats_.cached_bytes += bytes;
+  }
+
+  void RecordPoolRelease(size_t num_buffers, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pool_stats_.cached_buffers -= num_buffers;
+    pool_stats_.cached_bytes -= bytes;
+  }
+
+  PoolStats GetPoolStats() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return pool_stats_;
+  }
+
  private:
   std::set<const void*> allocated_;
+  PoolStats pool_stats_;
   std::mutex mtx_;
 };
 
 // here we use a global variable to memorize the allocation stats
 static std::shared_ptr<DeviceAllocStat> alloc_stat(new DeviceAllocStat());
 
+class ParamArena;
+
 /*!
  * \brief Data buffer represents data on CMA.
  */
@@ -134,6 +186,10 @@ struct DataBuffer {
   void* virt_addr() const { return data_; }
   /*! \return Physical address of the data. */
   vta_phy_addr_t phy_addr() const { return phy_addr_; }
+  /*! \return Size of the data in bytes. */
+  size_t size() const { return size_; }
+  /*! \return Whether the buffer lives in a parameter arena, written by the host only once. */
+  bool persistent() const { return arena_ != nullptr; }
   /*!
    * \brief Invalidate the cache of given location in data buffer.
    * \param offset The offset to the data.
@@ -180,6 +236,24 @@ struct DataBuffer {
     DataBuffer* buffer = new DataBuffer();
     buffer->data_ = data;
     buffer->phy_addr_ = VTAMemGetPhyAddr(data);
+    buffer->size_ = size;
+
+    alloc_stat->AddAlloc(buffer);
+    return buffer;
+  }
+  /*!
+   * \brief Create a buffer header over part of an arena allocation.
+   * \param base The allocation of the arena.
+   * \param offset The offset of the part in bytes.
+   * \param size The size of the part in bytes.
+   * \param arena The arena, referenced until the buffer is freed.
+   */
+  static DataBuffer* Slice(DataBuffer* base, size_t offset, size_t size, ParamArena* arena) {
+    DataBuffer* buffer = new DataBuffer();
+    buffer->data_ = static_cast<char*>(base->data_) + offset;
+    buffer->phy_addr_ = base->phy_addr_ + offset;
+    buffer->size_ = size;
+    buffer->arena_ = arena;
 
     alloc_stat->AddAlloc(buffer);
     return buffer;
@@ -188,11 +262,7 @@ struct DataBuffer {
    * \brief Free the data buffer.
    * \param buffer The buffer to be freed.
    */
-  static void Free(DataBuffer* buffer) {
-    alloc_stat->DelAlloc(buffer);
-    VTAMemFree(buffer->data_);
-    delete buffer;
-  }
+  static void Free(DataBuffer* buffer);
   /*!
    * \brief Create data buffer header from buffer ptr.
    * \param buffer The buffer pointer.
@@ -211,6 +281,10 @@ struct DataBuffer {
   void* data_;
   /*! \brief The physical address of the buffer, excluding header. */
   vta_phy_addr_t phy_addr_;
+  /*! \brief The size of the buffer in bytes. */
+  size_t size_;
+  /*! \brief The arena owning the memory, nullptr if the buffer owns it. */
+  ParamArena* arena_{nullptr};
 
   // a copy of global shared_ptr instance
   // to avoid the global instance is destructed before there are still some pending DataBuffers not
@@ -218,6 +292,217 @@ struct DataBuffer {
   std::shared_ptr<DeviceAllocStat> alloc_stat_;
 };
 
+/*!
+ * \brief Device memory holding the parameters of a model for its whole lifetime.
+ *
+ *  The arena is a single contiguous allocation carved into buffers, which are
+ *  written by the host when the parameters are loaded and only read by VTA
+ *  afterwards. Their cache lines are flushed by that copy, so the read barriers
+ *  of later runs skip them, and they never go through the buffer pool.
+ *
+ *  The memory goes back to the driver once the arena was released and all of
+ *  its buffers were freed.
+ */
+class ParamArena {
+ public:
+  /*!
+   * \brief Allocate the arena.
+   * \param size The capacity of the arena in bytes.
+   */
+  explicit ParamArena(size_t size) : base_(DataBuffer::Alloc(std::max<size_t>(size, kAlign))) {}
+  /*!
+   * \brief Allocate a buffer in the arena.
+   * \param size The size of the buffer.
+   * \return The buffer, nullptr if the arena is full.
+   */
+  DataBuffer* Alloc(size_t size) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t offset = (used_ + kAlign - 1) / kAlign * kAlign;
+    if (offset + size > base_->size()) return nullptr;
+    used_ = offset + size;
+    ++refs_;
+    return DataBuffer::Slice(base_, offset, size, this);
+  }
+  /*! \brief Drop a reference, held by the creator and by each live buffer. */
+  void Unref() {
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      last = --refs_ == 0;
+    }
+    if (last) delete this;
+  }
+
+ private:
+  ~ParamArena() { DataBuffer::Free(base_); }
+
+  /*! \brief Alignment of the buffers, a multiple of every VTA transfer size. */
+  static constexpr size_t kAlign = 64;
+  DataBuffer* base_;
+  size_t used_{0};
+  int refs_{1};
+  std::mutex mtx_;
+};
+
+inline void DataBuffer::Free(DataBuffer* buffer) {
+  alloc_stat->DelAlloc(buffer);
+  if (buffer->arena_ != nullptr) {
+    buffer->arena_->Unref();
+  } else {
+    VTAMemFree(buffer->data_);
+  }
+  delete buffer;
+}
+
+/*!
+ * \brief Pool of data buffers in front of VTAMemAlloc.
+ *
+ *  Requests are rounded up to size classes, four per power of two, and freed
+ *  buffers are kept per class for reuse, so that repeated allocations of a model
+ *  do not go to the contiguous memory allocator each time.
+ */
+class DataBufferPool {
+ public:
+  /*!
+   * \brief Allocate a buffer of at least the given size.
+   * \param size The size of the buffer.
+   */
+  DataBuffer* Alloc(size_t size) {
+    if (size > kMaxPooledBytes) return DataBuffer::Alloc(size);
+    size_t class_size = ClassSize(size);
+    DataBuffer* buffer = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      std::vector<DataBuffer*>& free_list = free_lists_[class_size];
+      if (!free_list.empty()) {
+        buffer = free_list.back();
+        free_list.pop_back();
+        cached_bytes_ -= class_size;
+      }
+    }
+    alloc_stat->RecordPoolAlloc(buffer != nullptr, class_size);
+    if (buffer == nullptr) return DataBuffer::Alloc(class_size);
+    alloc_stat->AddAlloc(buffer);
+    return buffer;
+  }
+  /*!
+   * \brief Return a buffer to the pool.
+   * \param buffer The buffer to be freed.
+   */
+  void Free(DataBuffer* buffer) {
+    size_t size = buffer->size();
+    if (buffer->persistent() || size > kMaxPooledBytes || size != ClassSize(size)) {
+      DataBuffer::Free(buffer);
+      return;
+    }
+    // Write back dirty lines, so that they cannot be evicted over data of the next owner
+    buffer->FlushCache(0, size);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (cached_bytes_ + size > kMaxCachedBytes) {
+        DataBuffer::Free(buffer);
+        return;
+      }
+      alloc_stat->DelAlloc(buffer);
+      free_lists_[size].push_back(buffer);
+      cached_bytes_ += size;
+    }
+    alloc_stat->RecordPoolCache(size);
+  }
+  /*! \brief Return all cached buffers to the driver. */
+  void Release() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t num_buffers = 0;
+    for (auto& kv : free_lists_) {
+      for (DataBuffer* buffer : kv.second) {
+        // Free expects a live buffer
+        alloc_stat->AddAlloc(buffer);
+        DataBuffer::Free(buffer);
+      }
+      num_buffers += kv.second.size();
+    }
+    free_lists_.clear();
+    alloc_stat->RecordPoolRelease(num_buffers, cached_bytes_);
+    cached_bytes_ = 0;
+  }
+
+  static DataBufferPool* Global() {
+    static DataBufferPool* inst = new DataBufferPool();
+    return inst;
+  }
+
+ private:
+  /*! \brief Round size up to its size class. */
+  static size_t ClassSize(size_t size) {
+    if (size <= kMinClassBytes) return kMinClassBytes;
+    size_t step = kMinClassBytes;
+    while (step * 2 <= size) step *= 2;
+    step /= 4;
+    return (size + step - 1) / step * step;
+  }
+
+  static constexpr size_t kMinClassBytes = 4096;
+  static constexpr size_t kMaxPooledBytes = static_cast<size_t>(VTA_BUFFER_POOL_MAX_BYTES);
+  static constexpr size_t kMaxCachedBytes = static_cast<size_t>(VTA_BUFFER_POOL_CACHE_BYTES);
+  std::unordered_map<size_t, std::vector<DataBuffer*>> free_lists_;
+  size_t cached_bytes_{0};
+  std::mutex mtx_;
+};
+
+/*!
+ * \brief Pending cache maintenance ranges of data buffers.
+ *
+ *  Ranges are accumulated between synchronizations and issued together, with
+ *  overlapping and adjacent ranges of the same buffer merged into one driver call.
+ */
+class CacheRangeBatch {
+ public:
+  /*!
+   * \brief Add a range to the batch.
+   * \param buffer The data buffer.
+   * \param offset The offset to the data in bytes.
+   * \param size The size of the range in bytes.
+   */
+  void Add(DataBuffer* buffer, size_t offset, size_t size) {
+    if (size == 0) return;
+    ranges_.push_back(Range{buffer, offset, offset + size});
+  }
+  /*! \return Whether there are pending ranges. */
+  bool empty() const { return ranges_.empty(); }
+  /*!
+   * \brief Merge the pending ranges and apply fop to each merged range.
+   * \param fop The function called as fop(buffer, offset, size).
+   */
+  template <typename FOp>
+  void Drain(FOp fop) {
+    if (ranges_.empty()) return;
+    std::sort(ranges_.begin(), ranges_.end(), [](const Range& a, const Range& b) {
+      return a.buffer != b.buffer ? a.buffer < b.buffer : a.begin < b.begin;
+    });
+    Range cur = ranges_[0];
+    for (size_t i = 1; i <= ranges_.size(); ++i) {
+      if (i != ranges_.size() && ranges_[i].buffer == cur.buffer && ranges_[i].begin <= cur.end) {
+        cur.end = std::max(cur.end, ranges_[i].end);
+        continue;
+      }
+      // Skip buffers that were freed after the barrier was issued
+      if (DataBuffer::FromHandle(cur.buffer) != nullptr) {
+        fop(cur.buffer, cur.begin, cur.end - cur.begin);
+      }
+      if (i != ranges_.size()) cur = ranges_[i];
+    }
+    ranges_.clear();
+  }
+
+ private:
+  struct Range {
+    DataBuffer* buffer;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<Range> ranges_;
+};
+
 /*!
  * \brief Micro op kernel.
  *  Contains functions to construct the kernel with prefix Push.
@@ -246,8 +531,6 @@ class UopKernel {
     if (static_cast<size_t>(nbytes) != signature_.size()) return false;
     return memcmp(signature, signature_.data(), nbytes) == 0;
   }
-  /*! \return Whether the kernel is cached in SRAM. */
-  bool cached() const { return sram_begin_ != sram_end_; }
   /*! \return The length of the micro op sequence. */
   size_t size() const { return seq_.size(); }
   /*! \return The micro-op data. */
@@ -322,9 +605,51 @@ class UopKernel {
       }
     }
   }
+  /*!
+   * \brief Fold repeated blocks of micro-ops into an innermost loop level.
+   *
+   *  Lowered ALU and GEMM bodies often unroll into runs whose indices advance
+   *  by the same deltas, e.g. one micro-op per element of a tile. When the
+   *  whole sequence is such a run of blocks, a single block is kept and the
+   *  hardware loop replays the others, which executes the same micro-ops in
+   *  the same order. Called once the kernel is recorded.
+   */
+  void Compress() {
+    if (loop_ptr_ != 0 || loop_.size() >= 2) return;
+    size_t n = seq_.size();
+    for (size_t len = 1; len * 2 <= n; ++len) {
+      if (n % len != 0) continue;
+      int64_t dst_delta = static_cast<int64_t>(seq_[len].dst_idx) - seq_[0].dst_idx;
+      int64_t src_delta = static_cast<int64_t>(seq_[len].src_idx) - seq_[0].src_idx;
+      int64_t wgt_delta = static_cast<int64_t>(seq_[len].wgt_idx) - seq_[0].wgt_idx;
+      // The factors are unsigned, and ALU instructions have no weight factor
+      if (dst_delta < 0 || src_delta < 0 || wgt_delta < 0) continue;
+      if (mode_ == 1 && wgt_delta != 0) continue;
+      bool strided = true;
+      for (size_t i = len; i < n && strided; ++i) {
+        strided = seq_[i].dst_idx == seq_[i - len].dst_idx + dst_delta &&
+                  seq_[i].src_idx == seq_[i - len].src_idx + src_delta &&
+                  seq_[i].wgt_idx == seq_[i - len].wgt_idx + wgt_delta;
+      }
+      if (!strided) continue;
+      LoopEntry le;
+      le.extent = static_cast<uint32_t>(n / len);
+      le.dst_factor = static_cast<uint32_t>(dst_delta);
+      le.src_factor = static_cast<uint32_t>(src_delta);
+      le.wgt_factor = static_cast<uint32_t>(wgt_delta);
+      if (!FitsLoop(le)) continue;
+      seq_.resize(len);
+      loop_.push_back(le);
+      return;
+    }
+  }
   /*! \brief Dump kernel micro ops to stdout. */
   void Dump() {
     uint32_t size = seq_.size();
+    for (const LoopEntry& le : loop_) {
+      printf("loop extent=%u, acc=%u, inp=%u, wgt=%u\n", le.extent, le.dst_factor,
+             le.src_factor, le.wgt_factor);
+    }
     printf("There are %u uops\n", size);
     for (uint32_t i = 0; i < size; ++i) {
       printf("[%04u]\t acc=%u, inp=%u, wgt=%u\n", i, seq_[i].dst_idx, seq_[i].src_idx,
@@ -342,6 +667,24 @@ class UopKernel {
   int16_t imm_val_{0};
 
  private:
+  // Whether a loop level fits the instruction fields it is encoded into
+  bool FitsLoop(const LoopEntry& le) const {
+    if (mode_ == 1) {
+      VTAAluInsn insn;
+      insn.iter_in = le.extent;
+      insn.dst_factor_in = le.dst_factor;
+      insn.src_factor_in = le.src_factor;
+      return insn.iter_in == le.extent && insn.dst_factor_in == le.dst_factor &&
+             insn.src_factor_in == le.src_factor;
+    }
+    VTAGemInsn insn;
+    insn.iter_in = le.extent;
+    insn.dst_factor_in = le.dst_factor;
+    insn.src_factor_in = le.src_factor;
+    insn.wgt_factor_in = le.wgt_factor;
+    return insn.iter_in == le.extent && insn.dst_factor_in == le.dst_factor &&
+           insn.src_factor_in == le.src_factor && insn.wgt_factor_in == le.wgt_factor;
+  }
   // Verify that we don't write to the same acc_mem index two cycles in a row
   void VerifyDep(uint32_t dst_index) {
     size_t step = std::min(static_cast<size_t>(2U), seq_.size());
@@ -353,9 +696,6 @@ class UopKernel {
   template <int, bool, bool>
   friend class UopQueue;
   friend class CommandQueue;
-  // SRAM location if begin != end
-  uint32_t sram_begin_{0};
-  uint32_t sram_end_{0};
   // The signature used for verification
   std::vector<char> signature_;
   // Internal sequence
@@ -373,8 +713,8 @@ template <class T>
 class BaseQueue {
  public:
   virtual ~BaseQueue() {
-    if (fpga_buff_ != nullptr) {
-      VTAMemFree(fpga_buff_);
+    for (void* buff : slot_buffs_) {
+      VTAMemFree(buff);
     }
   }
   /*! \return Content of DRAM buffer. */
@@ -387,14 +727,38 @@ class BaseQueue {
   /*! \return Whether there is pending information. */
   bool pending() const { return sram_begin_ != sram_end_; }
   /*! \brief Initialize the space of the buffer. */
-  void InitSpace(uint32_t elem_bytes, uint32_t max_bytes, bool coherent, bool always_cache) {
+  void InitSpace(uint32_t elem_bytes, uint32_t max_bytes, bool coherent, bool always_cache,
+                 uint32_t num_slots) {
     coherent_ = coherent;
     always_cache_ = always_cache;
     elem_bytes_ = elem_bytes;
-    // Allocate buffer ahead of time
-    fpga_buff_ = static_cast<char*>(VTAMemAlloc(max_bytes, coherent_ || always_cache_));
-    CHECK(fpga_buff_ != nullptr);
-    fpga_buff_phy_ = VTAMemGetPhyAddr(fpga_buff_);
+    max_bytes_ = max_bytes;
+    CHECK_GT(num_slots, 0U);
+    // Allocate one FPGA-readable buffer per staging slot ahead of time
+    for (uint32_t i = 0; i < num_slots; ++i) {
+      this->AddSlot();
+    }
+    this->SetSlot(0);
+  }
+  /*!
+   * \brief Allocate the FPGA-readable buffer of a new staging slot.
+   * \return The index of the new slot.
+   */
+  uint32_t AddSlot() {
+    void* buff = VTAMemAlloc(max_bytes_, coherent_ || always_cache_);
+    CHECK(buff != nullptr);
+    slot_buffs_.push_back(buff);
+    slot_phys_.push_back(VTAMemGetPhyAddr(buff));
+    return slot_buffs_.size() - 1;
+  }
+  /*!
+   * \brief Select the staging slot the following instructions are recorded into.
+   * \param slot The slot index.
+   */
+  void SetSlot(uint32_t slot) {
+    CHECK_LT(slot, slot_buffs_.size());
+    fpga_buff_ = slot_buffs_[slot];
+    fpga_buff_phy_ = slot_phys_[slot];
   }
   /*!
    * \brief Reset the pointer of the buffer.
@@ -415,76 +779,99 @@ class BaseQueue {
   bool always_cache_{false};
   // Element bytes
   uint32_t elem_bytes_{0};
+  // Size of the FPGA buffer of each slot
+  uint32_t max_bytes_{0};
   // Begin location of current SRAM read in FIFO mode
   uint32_t sram_begin_{0};
   // End location of current SRAM write in FIFO mode
   uint32_t sram_end_{0};
   // The buffer in DRAM
   std::vector<T, AlignmentAllocator<T, ALLOC_ALIGNMENT>> dram_buffer_;
-  // FPGA accessible buffer
+  // FPGA accessible buffer of the current slot
   void* fpga_buff_{NULL};
-  // Physical address of the FPGA buffer
+  // Physical address of the FPGA buffer of the current slot
   vta_phy_addr_t fpga_buff_phy_{0};
+  // FPGA accessible buffers of all staging slots
+  std::vector<void*> slot_buffs_;
+  // Physical addresses of all staging slots
+  std::vector<vta_phy_addr_t> slot_phys_;
 };
 
 /*!
  * \brief Micro op buffer that manages the micro op cache.
+ *
+ *  The uop SRAM keeps its contents across DeviceRun, so kernels stay resident
+ *  between synchronizations and are only reloaded after being evicted.
+ *  Eviction frees the least recently used kernels until a large enough gap
+ *  exists. Micro-ops loaded by the current stream are staged in the DRAM
+ *  buffer in load order.
+ *
+ *  Kernels are shared by all threads, the residency is tracked by each queue,
+ *  that is for each thread and device.
  */
 template <int kMaxBytes, bool kCoherent, bool kAlwaysCache>
 class UopQueue : public BaseQueue<VTAUop> {
  public:
-  void InitSpace() { BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache); }
+  void InitSpace(uint32_t num_slots) {
+    BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache, num_slots);
+  }
   // Push data to the queue
   template <typename FAutoSync>
-  void Push(UopKernel* kernel, FAutoSync fautosync) {
+  void Push(const UopKernel* kernel, FAutoSync fautosync) {
     // if the micro-op is cached in VTA SRAM, skip
-    if (kernel->cached()) return;
+    auto it = resident_.find(kernel);
+    if (it != resident_.end()) {
+      Residency& res = it->second;
+      res.lru_stamp = ++lru_clock_;
+      if (res.loaded_stream != stream_id_ && res.reused_stream != stream_id_) {
+        // The stream relies on a load issued by an earlier stream
+        res.reused_stream = stream_id_;
+        reused_.push_back(ResidentUse{kernel, res.sram_begin});
+      }
+      return;
+    }
     // check if we've exceeded the size of the allocated FPGA readable buffer
     size_t num_op = kernel->size();
     if (dram_buffer_.size() + num_op > kMaxElems) {
       fautosync();
-      CHECK(dram_buffer_.size() <= kMaxElems);
+      CHECK(dram_buffer_.size() + num_op <= kMaxElems);
     }
     // Cannot have a micro-op kernel larger than SRAM buffer
     CHECK(num_op <= kMaxNumUop);
-    uint32_t uop_begin = 0;
-    if (sram_end_ + num_op > kMaxNumUop) {
-      // Need to evict
-      cache_idx_ = 0;
-      sram_begin_ = 0;
-      sram_end_ = num_op;
-    } else {
-      uop_begin = sram_end_;
-      sram_end_ += num_op;
-    }
-    // Simple eviction policy
-    uint32_t evict_begin = cache_idx_;
-    for (; cache_idx_ < cache_.size(); ++cache_idx_) {
-      if (cache_[cache_idx_]->sram_begin_ >= sram_end_) break;
-      // Mark the kernel as "invalid"
-      cache_[cache_idx_]->sram_begin_ = 0;
-      cache_[cache_idx_]->sram_end_ = 0;
-    }
-    // Increase size of buffer
-    kernel->sram_begin_ = uop_begin;
-    kernel->sram_end_ = sram_end_;
-    CHECK(kernel->cached());
-    cache_.insert(cache_.begin() + cache_idx_, kernel);
-    cache_.erase(cache_.begin() + evict_begin, cache_.begin() + cache_idx_);
-    cache_idx_ = evict_begin + 1;
+    uint32_t uop_begin = this->Allocate(num_op);
+    Residency& res = resident_[kernel];
+    res.sram_begin = uop_begin;
+    res.sram_end = uop_begin + num_op;
+    res.lru_stamp = ++lru_clock_;
+    res.loaded_stream = stream_id_;
+    auto pos = std::upper_bound(cache_.begin(), cache_.end(), uop_begin,
+                                [this](uint32_t begin, const UopKernel* k) {
+                                  return begin < resident_.at(k).sram_begin;
+                                });
+    cache_.insert(pos, kernel);
+    // Stage the micro-ops for the load instruction
+    staged_offset_ = dram_buffer_.size();
+    dram_buffer_.insert(dram_buffer_.end(), kernel->data(), kernel->data() + num_op);
+    sram_begin_ = res.sram_begin;
+    sram_end_ = res.sram_end;
+  }
+  /*!
+   * \brief Get the SRAM location of a kernel pushed to this queue.
+   * \param kernel The kernel, resident since its last Push.
+   * \return The begin and end micro-op indices.
+   */
+  std::pair<uint32_t, uint32_t> Location(const UopKernel* kernel) const {
+    auto it = resident_.find(kernel);
+    CHECK(it != resident_.end()) << "The micro-op kernel is not resident";
+    return std::make_pair(it->second.sram_begin, it->second.sram_end);
   }
   // Flush micro op load instruction
   void FlushUopLoad(VTAMemInsn* insn) {
     if (sram_begin_ != sram_end_) {
-      // Derive offset in FPGA-readable buffer
-      int32_t offset = 0;
-      for (uint32_t i = 0; i < cache_idx_ - 1; ++i) {
-        offset += cache_[i]->size() * kElemBytes;
-      }
       insn->memory_type = VTA_MEM_ID_UOP;
       insn->sram_base = sram_begin_;
-      // Update cache idx to physical address map
-      insn->dram_base = (fpga_buff_phy_ + offset) / kElemBytes;
+      // Point to the staged micro-ops in FPGA-readable buffer
+      insn->dram_base = (fpga_buff_phy_ + staged_offset_ * kElemBytes) / kElemBytes;
       insn->y_size = 1;
       insn->x_size = (sram_end_ - sram_begin_);
       insn->x_stride = (sram_end_ - sram_begin_);
@@ -496,60 +883,114 @@ class UopQueue : public BaseQueue<VTAUop> {
       sram_begin_ = sram_end_;
     }
   }
-  /*! \brief clear cache and reset base queue buffer.*/
+  /*! \return Offset of the last staged kernel in the staging buffer, in elements. */
+  size_t staged_offset() const { return staged_offset_; }
+  /*! \return Number of micro-ops staged by the current stream. */
+  size_t staged_count() const { return dram_buffer_.size(); }
+  /*! \return The micro-ops staged by the current stream. */
+  const VTAUop* staged_data() const { return dram_buffer_.data(); }
+  /*! \return Number of kernels the current stream uses from SRAM without loading them. */
+  size_t reused_count() const { return reused_.size(); }
+  /*! \brief Reset the staging buffer, resident kernels remain valid. */
   void Reset() {
-    // unmark "cached" status
-    // as we cannot assume it is still in SRAM across DeviceRun
-    for (UopKernel* kernel : cache_) {
-      kernel->sram_begin_ = 0;
-      kernel->sram_end_ = 0;
+    BaseQueue<VTAUop>::Reset();
+    reused_.clear();
+    ++stream_id_;
+  }
+  /*!
+   * \brief Stage the kernels the current stream reuses from SRAM again,
+   *  for when another stream may have overwritten the SRAM in between.
+   * \param frecord Called as frecord(sram_base, dram_base, num_op) for each load to issue.
+   */
+  template <typename FRecord>
+  void RestageReused(FRecord frecord) {
+    // The used locations were all resident when the stream started, so they do not overlap
+    for (const ResidentUse& use : reused_) {
+      size_t num_op = use.kernel->size();
+      CHECK(dram_buffer_.size() + num_op <= kMaxElems);
+      size_t offset = dram_buffer_.size();
+      dram_buffer_.insert(dram_buffer_.end(), use.kernel->data(), use.kernel->data() + num_op);
+      frecord(use.sram_begin, (fpga_buff_phy_ + offset * kElemBytes) / kElemBytes, num_op);
     }
-
+  }
+  /*! \brief Forget all resident kernels, e.g. when SRAM contents are lost. */
+  void Invalidate() {
+    resident_.clear();
     cache_.clear();
-    cache_idx_ = 0;
-    BaseQueue<VTAUop>::Reset();
   }
   void AutoReadBarrier() { ReadBarrier(); }
   /*! \brief Writer barrier to make sure that data written by CPU is visible to VTA. */
   void ReadBarrier() {
     CHECK(fpga_buff_ != nullptr);
     CHECK(fpga_buff_phy_);
-    // Iterate over caches; allocate buffer in FPGA-readable memory
-    uint32_t buff_size = 0;
-    for (uint32_t i = 0; i < cache_.size(); ++i) {
-      buff_size += cache_[i]->size() * kElemBytes;
-    }
+    uint32_t buff_size = dram_buffer_.size() * kElemBytes;
     CHECK(buff_size <= kMaxBytes);
-
-    // merge all the cache entries and do CopyFromHost once
-    uint32_t total_size = 0;
-    for (uint32_t i = 0; i < cache_.size(); ++i) {
-      uint32_t ksize = cache_[i]->size() * kElemBytes;
-      total_size += ksize;
-    }
-
-    char* lbuf = (char*)memalign(ALLOC_ALIGNMENT, total_size);
-    uint32_t offset = 0;
-    for (uint32_t i = 0; i < cache_.size(); ++i) {
-      uint32_t ksize = cache_[i]->size() * kElemBytes;
-      memcpy(lbuf + offset, cache_[i]->data(), ksize);
-      offset += ksize;
-    }
-    VTAMemCopyFromHost(static_cast<char*>(fpga_buff_), lbuf, total_size);
-    free(lbuf);
-
+    if (buff_size == 0) return;
+    // Copy the staged micro-ops to FPGA buff
+    VTAMemCopyFromHost(fpga_buff_, dram_buffer_.data(), buff_size);
     // Flush if we're using a shared memory system
     // and if interface is non-coherent
     if (!coherent_ && always_cache_) {
-      VTAFlushCache(fpga_buff_, fpga_buff_phy_, offset);
+      VTAFlushCache(fpga_buff_, fpga_buff_phy_, buff_size);
     }
   }
 
  private:
-  // Cache pointer
-  uint32_t cache_idx_{0};
-  // Cached ring, sorted by sram_begin
-  std::vector<UopKernel*> cache_;
+  /*!
+   * \brief Find SRAM space for a kernel, evicting least recently used kernels if needed.
+   * \param num_op Number of micro-ops of the kernel.
+   * \return The SRAM begin index.
+   *
+   * \note Evicting a kernel used earlier in the current stream is safe:
+   *  uop loads and the GEMM/ALU instructions using them all execute in order
+   *  on the compute stage.
+   */
+  uint32_t Allocate(size_t num_op) {
+    while (true) {
+      // First fit over the gaps between resident kernels
+      uint32_t begin = 0;
+      for (const UopKernel* k : cache_) {
+        const Residency& res = resident_.at(k);
+        if (res.sram_begin - begin >= num_op) return begin;
+        begin = res.sram_end;
+      }
+      if (kMaxNumUop - begin >= num_op) return begin;
+      auto lru = std::min_element(cache_.begin(), cache_.end(),
+                                  [this](const UopKernel* a, const UopKernel* b) {
+                                    return resident_.at(a).lru_stamp < resident_.at(b).lru_stamp;
+                                  });
+      CHECK(lru != cache_.end());
+      resident_.erase(*lru);
+      cache_.erase(lru);
+    }
+  }
+  /*! \brief A kernel used by the current stream from an earlier load. */
+  struct ResidentUse {
+    const UopKernel* kernel;
+    uint32_t sram_begin;
+  };
+  /*! \brief The SRAM location of a resident kernel. */
+  struct Residency {
+    uint32_t sram_begin{0};
+    uint32_t sram_end{0};
+    // Last use, for least recently used eviction from SRAM
+    uint64_t lru_stamp{0};
+    // The stream that loaded the kernel into SRAM, and the last stream that reused that load
+    uint64_t loaded_stream{0};
+    uint64_t reused_stream{0};
+  };
+  // Offset of the pending load in the staging buffer, in elements
+  size_t staged_offset_{0};
+  // Identifies the stream being recorded, 0 is never used
+  uint64_t stream_id_{1};
+  // Kernels used by the current stream from earlier loads
+  std::vector<ResidentUse> reused_;
+  // Logical clock for least recently used eviction
+  uint64_t lru_clock_{0};
+  // SRAM locations of the resident kernels
+  std::unordered_map<const UopKernel*, Residency> resident_;
+  // Resident kernels, sorted by sram_begin
+  std::vector<const UopKernel*> cache_;
   // Constants
   static constexpr int kElemBytes = sizeof(VTAUop);
   static constexpr int kMaxNumUop = VTA_UOP_BUFF_DEPTH;
@@ -559,23 +1000,21 @@ class UopQueue : public BaseQueue<VTAUop> {
 // Internal kernel structure
 class UopKernelMap {
  public:
-  // Simple hash map
+  /*!
+   * \brief Get the kernel slot of a signature, keyed on all signature bytes.
+   * \param signature The pointer to signature.
+   * \param nbytes Number of bytes.
+   * \return The kernel slot, holding nullptr if the kernel is not recorded yet.
+   */
   UopKernel** Get(void* signature, int nbytes) {
-    uint32_t key = 0;
-    CHECK(nbytes == 0 || nbytes == sizeof(int));
-    if (nbytes == sizeof(int)) {
-      memcpy(&key, signature, sizeof(int));
-      key = key + 1;
-    }
-    CHECK_LT(key, 100);
-    if (kmap_.size() <= key) {
-      kmap_.resize(key + 1, nullptr);
-    }
-    return &(kmap_[key]);
+    CHECK_GE(nbytes, 0);
+    std::string key(static_cast<const char*>(signature), nbytes);
+    // references to unordered_map elements stay valid on rehash
+    return &kmap_[key];
   }
 
  private:
-  std::vector<UopKernel*> kmap_;
+  std::unordered_map<std::string, UopKernel*> kmap_;
 };
 
 enum PipelineStage : int { kNoneStage = 0, kLoadStage = 1, kComputeStage = 2, kStoreStage = 3 };
@@ -585,8 +1024,8 @@ template <int kMaxBytes, bool kCoherent, bool kAlwaysCache>
 class InsnQueue : public BaseQueue<VTAGenericInsn> {
  public:
   /*! \brief Initialize the space. */
-  void InitSpace() {
-    BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache);
+  void InitSpace(uint32_t num_slots) {
+    BaseQueue::InitSpace(kElemBytes, kMaxBytes, kCoherent, kAlwaysCache, num_slots);
     // Initialize the stage
     std::fill(pending_pop_prev_, pending_pop_prev_ + 4, 0);
     std::fill(pending_pop_next_, pending_pop_next_ + 4, 0);
@@ -709,6 +1148,86 @@ class InsnQueue : public BaseQueue<VTAGenericInsn> {
     DepPush(kLoadStage, kComputeStage);
     CommitPendingPop(kComputeStage);
   }
+  /*! \brief Insert a micro-op load at the start of the stream, where all queues are drained. */
+  void PrependUopLoad(uint32_t sram_base, uint32_t dram_base, uint32_t num_op) {
+    VTAGenericInsn generic;
+    VTAMemInsn* insn = reinterpret_cast<VTAMemInsn*>(&generic);
+    memset(&generic, 0, sizeof(generic));
+    insn->opcode = VTA_OPCODE_LOAD;
+    insn->memory_type = VTA_MEM_ID_UOP;
+    insn->sram_base = sram_base;
+    insn->dram_base = dram_base;
+    insn->y_size = 1;
+    insn->x_size = num_op;
+    insn->x_stride = num_op;
+    dram_buffer_.insert(dram_buffer_.begin(), generic);
+  }
+  /*!
+   * \brief Peephole optimization of the instruction stream.
+   *
+   *  Each stage executes its instructions in stream order and only synchronizes
+   *  with the others through dependence tokens, so the rewrites below preserve
+   *  the order of every stage relative to its token pushes and pops:
+   *  - no-ops that only push are folded into the previous instruction of their stage
+   *  - no-ops that only pop are folded into the next instruction of their stage
+   *  - loads continuing the previous load of their stage in both DRAM and SRAM are merged
+   *
+   *  Must be called before the FINISH instruction is added.
+   */
+  void Optimize() {
+    uint32_t insn_count = count();
+    if (insn_count == 0) return;
+    VTAMemInsn* mem_ptr = reinterpret_cast<VTAMemInsn*>(data());
+    std::vector<bool> removed(insn_count, false);
+    // Forward pass, using the previous live instruction of each stage
+    int prev[4] = {-1, -1, -1, -1};
+    for (uint32_t i = 0; i < insn_count; ++i) {
+      VTAMemInsn* insn = mem_ptr + i;
+      int stage = GetPipelineStageAll(insn);
+      if (IsNoop(insn) && !insn->pop_prev_dep && !insn->pop_next_dep) {
+        if (!insn->push_prev_dep && !insn->push_next_dep) {
+          removed[i] = true;
+          continue;
+        }
+        if (prev[stage] >= 0) {
+          VTAMemInsn* last = mem_ptr + prev[stage];
+          if (!(insn->push_prev_dep && last->push_prev_dep) &&
+              !(insn->push_next_dep && last->push_next_dep)) {
+            last->push_prev_dep |= insn->push_prev_dep;
+            last->push_next_dep |= insn->push_next_dep;
+            removed[i] = true;
+            continue;
+          }
+        }
+      } else if (prev[stage] >= 0 && MergeLoad(mem_ptr + prev[stage], insn)) {
+        removed[i] = true;
+        continue;
+      }
+      prev[stage] = i;
+    }
+    // Backward pass, using the next live instruction of each stage
+    int next[4] = {-1, -1, -1, -1};
+    for (uint32_t i = insn_count; i != 0; --i) {
+      if (removed[i - 1]) continue;
+      VTAMemInsn* insn = mem_ptr + i - 1;
+      int stage = GetPipelineStageAll(insn);
+      if (IsNoop(insn) && !insn->push_prev_dep && !insn->push_next_dep && next[stage] >= 0) {
+        VTAMemInsn* first = mem_ptr + next[stage];
+        if (!first->pop_prev_dep && !first->pop_next_dep) {
+          first->pop_prev_dep = insn->pop_prev_dep;
+          first->pop_next_dep = insn->pop_next_dep;
+          removed[i - 1] = true;
+          continue;
+        }
+      }
+      next[stage] = i - 1;
+    }
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < insn_count; ++i) {
+      if (!removed[i]) dram_buffer_[kept++] = dram_buffer_[i];
+    }
+    dram_buffer_.resize(kept);
+  }
   // Helper function: Get Opcode string
   const char* getOpcodeString(int opcode, bool use_imm) {
     // The string name
@@ -965,6 +1484,43 @@ class InsnQueue : public BaseQueue<VTAGenericInsn> {
     return GetMemPipelineStage(insn->memory_type);
   }
 
+  // Whether the instruction is a no-op that only carries dependence tokens
+  static bool IsNoop(const VTAMemInsn* insn) {
+    return (insn->opcode == VTA_OPCODE_LOAD || insn->opcode == VTA_OPCODE_STORE) &&
+           insn->x_size == 0;
+  }
+  // Merge load b into the previous load a of the same stage, return true on success
+  static bool MergeLoad(VTAMemInsn* a, const VTAMemInsn* b) {
+    if (a->opcode != VTA_OPCODE_LOAD || b->opcode != VTA_OPCODE_LOAD) return false;
+    if (IsNoop(a) || IsNoop(b) || a->memory_type != b->memory_type) return false;
+    // The tokens of a are pushed after b and those of b are popped before a
+    if (a->push_prev_dep || a->push_next_dep || b->pop_prev_dep || b->pop_next_dep) return false;
+    if (a->y_pad_0 || a->y_pad_1 || a->x_pad_0 || a->x_pad_1) return false;
+    if (b->y_pad_0 || b->y_pad_1 || b->x_pad_0 || b->x_pad_1) return false;
+    VTAMemInsn merged = *a;
+    if (a->y_size == 1 && b->y_size == 1 && a->x_size == a->x_stride &&
+        b->x_size == b->x_stride) {
+      // Contiguous rows become one longer row
+      if (b->dram_base != a->dram_base + a->x_size) return false;
+      if (b->sram_base != a->sram_base + a->x_size) return false;
+      uint32_t x_size = a->x_size + b->x_size;
+      merged.x_size = x_size;
+      merged.x_stride = x_size;
+      if (merged.x_size != x_size || merged.x_stride != x_size) return false;
+    } else {
+      // Rows with the same shape and stride become one taller block
+      if (a->x_size != b->x_size || a->x_stride != b->x_stride) return false;
+      if (b->dram_base != a->dram_base + a->y_size * a->x_stride) return false;
+      if (b->sram_base != a->sram_base + a->y_size * a->x_size) return false;
+      uint32_t y_size = a->y_size + b->y_size;
+      merged.y_size = y_size;
+      if (merged.y_size != y_size) return false;
+    }
+    merged.push_prev_dep = b->push_prev_dep;
+    merged.push_next_dep = b->push_next_dep;
+    *a = merged;
+    return true;
+  }
   // Push no-op
   void PushNoop(int stage, bool push_prev_dep, bool push_next_dep, bool pop_prev_dep,
                 bool pop_next_dep) {
@@ -995,76 +1551,774 @@ class InsnQueue : public BaseQueue<VTAGenericInsn> {
 };
 
 /*!
- * \brief The command queue object that handles the request.
+ * \brief Host side timeline of the runtime in the Chrome trace event format.
+ *
+ *  Command queues with VTA_DEBUG_TRACE set record the time spent recording
+ *  kernels, flushing caches, waiting on and running the device. The events
+ *  are written at runtime shutdown to the file named by VTA_TRACE_FILE, or
+ *  on demand with VTATraceWrite, and can be opened in chrome://tracing.
  */
-class CommandQueue {
+class Tracer {
  public:
-  CommandQueue() { this->InitSpace(); }
-  void InitSpace() {
-    uop_queue_.InitSpace();
-    insn_queue_.InitSpace();
-    device_ = VTADeviceAlloc();
-    CHECK(device_ != nullptr);
-  }
+  /*! \brief A duration of the calling thread, recorded when it goes out of scope. */
+  class Scope {
+   public:
+    Scope(bool enabled, const char* name, const char* cat)
+        : name_(enabled ? name : nullptr), cat_(cat), begin_(Tracer::Now()) {}
+    ~Scope() {
+      if (name_ != nullptr) Tracer::Global()->Complete(name_, cat_, begin_, Tracer::Now());
+    }
 
-  ~CommandQueue() { VTADeviceFree(device_); }
+   private:
+    const char* name_;
+    const char* cat_;
+    int64_t begin_;
+  };
 
-  uint32_t GetElemBytes(uint32_t memory_id) {
-    uint32_t elem_bytes = 0;
-    switch (memory_id) {
-      case VTA_MEM_ID_UOP:
-        elem_bytes = VTA_UOP_ELEM_BYTES;
-        break;
-      case VTA_MEM_ID_INP:
-        elem_bytes = VTA_INP_ELEM_BYTES;
-        break;
-      case VTA_MEM_ID_WGT:
-        elem_bytes = VTA_WGT_ELEM_BYTES;
-        break;
-      case VTA_MEM_ID_ACC:
-        elem_bytes = VTA_ACC_ELEM_BYTES;
-        break;
-      case VTA_MEM_ID_OUT:
-        elem_bytes = VTA_OUT_ELEM_BYTES;
-        break;
-      case VTA_MEM_ID_ACC_8BIT:
-        elem_bytes = VTA_ACC_ELEM_BYTES / 4;
-        break;
-      default:
-        LOG(FATAL) << "Memory id not recognized:" << memory_id;
-        break;
+  static Tracer* Global() {
+    // Leaked, events may be recorded by threads during static destruction
+    static Tracer* inst = new Tracer();
+    return inst;
+  }
+  /*! \return Microseconds since the start of the process timeline. */
+  static int64_t Now() {
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                 epoch)
+        .count();
+  }
+  /*!
+   * \brief Record a duration of the calling thread.
+   * \param name The event name, must be a string literal.
+   * \param cat The event category, must be a string literal.
+   * \param begin The begin timestamp.
+   * \param end The end timestamp.
+   * \param arg Value of the "count" argument of the event, omitted if negative.
+   */
+  void Complete(const char* name, const char* cat, int64_t begin, int64_t end,
+                int64_t arg = -1) {
+    this->Record(Event{name, cat, 'X', begin, end - begin, arg, ThreadIndex()});
+  }
+  /*!
+   * \brief Record an instant event of the calling thread.
+   * \param name The event name, must be a string literal.
+   * \param cat The event category, must be a string literal.
+   * \param arg Value of the "count" argument of the event, omitted if negative.
+   */
+  void Instant(const char* name, const char* cat, int64_t arg = -1) {
+    this->Record(Event{name, cat, 'i', Now(), 0, arg, ThreadIndex()});
+  }
+  /*!
+   * \brief Name the calling thread in the timeline.
+   * \param name The thread name.
+   */
+  void NameThread(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    thread_names_[ThreadIndex()] = name;
+  }
+  /*!
+   * \brief Write the recorded events as a JSON trace.
+   * \param path The file to write.
+   */
+  void Write(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    FILE* fp = fopen(path.c_str(), "w");
+    CHECK(fp != nullptr) << "Cannot open trace file " << path;
+    fprintf(fp, "{\"traceEvents\": [\n");
+    const char* sep = "";
+    for (const auto& kv : thread_names_) {
+      fprintf(fp,
+              "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %d, "
+              "\"args\": {\"name\": \"%s\"}}",
+              sep, kv.first, kv.second.c_str());
+      sep = ",\n";
     }
-    /*
-     * elements size should not larger than VTA_PAGE_BYTES.
-     *
-     */
-    CHECK_GE(VTA_PAGE_BYTES, elem_bytes);
-    return elem_bytes;
+    for (const Event& e : events_) {
+      fprintf(fp,
+              "%s{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\", \"pid\": 0, "
+              "\"tid\": %d, \"ts\": %" PRId64,
+              sep, e.name, e.cat, e.phase, e.tid, e.ts);
+      if (e.phase == 'X') fprintf(fp, ", \"dur\": %" PRId64, e.dur);
+      if (e.phase == 'i') fprintf(fp, ", \"s\": \"t\"");
+      if (e.arg >= 0) fprintf(fp, ", \"args\": {\"count\": %" PRId64 "}", e.arg);
+      fprintf(fp, "}");
+      sep = ",\n";
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
   }
-
-  void LoadBuffer2D(void* src_dram_addr, uint32_t src_elem_offset, uint32_t x_size, uint32_t y_size,
-                    uint32_t x_stride, uint32_t x_pad_before, uint32_t y_pad_before,
-                    uint32_t x_pad_after, uint32_t y_pad_after, uint32_t dst_sram_index,
-                    uint32_t dst_memory_type) {
-    VTAMemInsn* insn = insn_queue_.CreateMemInsn(dst_memory_type);
-    insn->opcode = VTA_OPCODE_LOAD;
-    insn->memory_type = dst_memory_type;
-    insn->sram_base = dst_sram_index;
-    DataBuffer* src = DataBuffer::FromHandle(src_dram_addr);
-    insn->dram_base = src->phy_addr() / GetElemBytes(dst_memory_type) + src_elem_offset;
-    insn->y_size = y_size;
-    insn->x_size = x_size;
-    insn->x_stride = x_stride;
-    insn->y_pad_0 = y_pad_before;
-    insn->y_pad_1 = y_pad_after;
-    insn->x_pad_0 = x_pad_before;
-    insn->x_pad_1 = x_pad_after;
-    this->CheckInsnOverFlow();
+  /*! \brief Write the events to VTA_TRACE_FILE if any were recorded. */
+  void WriteAtExit() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (events_.empty()) return;
+    }
+    const char* path = getenv("VTA_TRACE_FILE");
+    this->Write(path != nullptr ? path : "vta_trace.json");
   }
 
-  void StoreBuffer2D(uint32_t src_sram_index, uint32_t src_memory_type, void* dst_dram_addr,
-                     uint32_t dst_elem_offset, uint32_t x_size, uint32_t y_size,
-                     uint32_t x_stride) {
+ private:
+  struct Event {
+    const char* name;
+    const char* cat;
+    char phase;
+    int64_t ts;
+    int64_t dur;
+    int64_t arg;
+    int tid;
+  };
+  // Small sequential thread ids keep the timeline readable
+  static int ThreadIndex() {
+    static std::atomic<int> next{0};
+    static thread_local int index = next++;
+    return index;
+  }
+  void Record(const Event& e) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    events_.push_back(e);
+  }
+
+  std::mutex mtx_;
+  std::vector<Event> events_;
+  std::map<int, std::string> thread_names_;
+};
+
+/*!
+ * \brief Runs submitted instruction streams on the device in a background thread.
+ *
+ *  Streams are executed in submission order. Each submission is identified by
+ *  a monotonically increasing ticket, so waiting on a ticket also retires all
+ *  earlier submissions. With VTA_DEVICE_ASYNC, the thread launches the next
+ *  streams on the device before waiting for the previous one.
+ */
+class DeviceRunner {
+ public:
+  explicit DeviceRunner(VTADeviceHandle device) : device_(device) {
+    worker_ = std::thread([this]() { this->Loop(); });
+  }
+
+  ~DeviceRunner() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      shutdown_ = true;
+    }
+    task_cv_.notify_all();
+    worker_.join();
+  }
+  /*!
+   * \brief Enqueue an instruction stream for execution.
+   * \param insn_phy_addr The physical address of the instruction stream.
+   * \param insn_count The number of instructions.
+   * \param wait_cycles The limit of poll cycles.
+   * \param trace Whether to record the run in the timeline.
+   * \return The ticket of the submission.
+   */
+  uint64_t Submit(vta_phy_addr_t insn_phy_addr, uint32_t insn_count, uint32_t wait_cycles,
+                  bool trace = false) {
+    uint64_t ticket;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ticket = ++submitted_;
+      tasks_.push_back(Task{insn_phy_addr, insn_count, wait_cycles, trace});
+    }
+    if (trace) Tracer::Global()->Instant("VTADeviceRun submit", "device", insn_count);
+    task_cv_.notify_one();
+    return ticket;
+  }
+  /*!
+   * \brief Wait until the submission with the given ticket finishes.
+   *
+   *  Short waits spin, as waking a sleeping thread may take longer than the
+   *  run itself. Longer waits sleep, which frees the core for host work.
+   * \param ticket The ticket returned by Submit, 0 means nothing to wait for.
+   */
+  void Wait(uint64_t ticket) {
+    if (completed_.load(std::memory_order_acquire) < ticket) {
+      this->Spin(ticket);
+    }
+    std::unique_lock<std::mutex> lock(mtx_);
+    done_cv_.wait(lock, [this, ticket]() { return completed_ >= ticket; });
+    int timeout = timeout_;
+    timeout_ = 0;
+    lock.unlock();
+    CHECK_EQ(timeout, 0) << "VTADeviceRun timed out";
+  }
+  /*! \return Number of finished device runs. */
+  uint64_t completed() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return completed_;
+  }
+  /*! \return Total time spent in device runs, in nanoseconds. */
+  uint64_t busy_ns() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return busy_ns_;
+  }
+  /*! \brief Wait until all submissions finish. */
+  void WaitAll() {
+    uint64_t ticket;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      ticket = submitted_;
+    }
+    this->Wait(ticket);
+  }
+
+ private:
+  struct Task {
+    vta_phy_addr_t insn_phy_addr;
+    uint32_t insn_count;
+    uint32_t wait_cycles;
+    bool trace;
+  };
+
+  // Spin while the expected time until the ticket finishes is short
+  void Spin(uint64_t ticket) {
+    uint64_t expected_ns;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      // Nothing is known before the first run
+      if (avg_run_ns_ == 0) return;
+      expected_ns = (ticket - completed_) * avg_run_ns_;
+    }
+    if (expected_ns > kSpinNs) return;
+    // Give up at twice the expected time, the run may be slower than usual
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(2 * expected_ns);
+    while (completed_.load(std::memory_order_acquire) < ticket &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+  }
+
+  void Loop() {
+#if VTA_DEVICE_ASYNC
+    this->LaunchLoop();
+#else
+    while (true) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        task_cv_.wait(lock, [this]() { return shutdown_ || !tasks_.empty(); });
+        if (tasks_.empty()) return;
+        task = tasks_.front();
+        tasks_.pop_front();
+      }
+      this->NameThread(task);
+      int64_t trace_begin = Tracer::Now();
+      auto begin = std::chrono::steady_clock::now();
+      int timeout = VTADeviceRun(device_, task.insn_phy_addr, task.insn_count, task.wait_cycles);
+      this->Retire(task, begin, trace_begin, timeout);
+    }
+#endif
+  }
+
+#if VTA_DEVICE_ASYNC
+  // Keep up to kMaxLaunches streams launched on the device, and retire them in order
+  void LaunchLoop() {
+    struct Launch {
+      Task task;
+      int64_t id;
+      std::chrono::steady_clock::time_point begin;
+      int64_t trace_begin;
+    };
+    std::deque<Launch> launches;
+    while (true) {
+      Task task;
+      bool launch = false;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        task_cv_.wait(lock, [this, &launches]() {
+          return shutdown_ || !tasks_.empty() || !launches.empty();
+        });
+        if (tasks_.empty() && launches.empty()) return;
+        if (!tasks_.empty() && launches.size() < kMaxLaunches) {
+          task = tasks_.front();
+          tasks_.pop_front();
+          launch = true;
+        }
+      }
+      if (launch) {
+        this->NameThread(task);
+        Launch entry{task, 0, std::chrono::steady_clock::now(), Tracer::Now()};
+        entry.id = VTADeviceLaunch(device_, task.insn_phy_addr, task.insn_count);
+        if (entry.id >= 0) {
+          launches.push_back(entry);
+          continue;
+        }
+        // Retire the earlier launches first, the runs complete in order
+        for (const Launch& earlier : launches) {
+          int timeout = VTADeviceSync(device_, earlier.id, earlier.task.wait_cycles);
+          this->Retire(earlier.task, earlier.begin, earlier.trace_begin, timeout);
+        }
+        launches.clear();
+        this->Retire(task, entry.begin, entry.trace_begin, 1);
+        continue;
+      }
+      const Launch& oldest = launches.front();
+      int timeout = VTADeviceSync(device_, oldest.id, oldest.task.wait_cycles);
+      this->Retire(oldest.task, oldest.begin, oldest.trace_begin, timeout);
+      launches.pop_front();
+      // The next launch was queued behind the oldest one, it only starts running now
+      if (!launches.empty()) {
+        launches.front().begin = std::max(launches.front().begin, last_done_);
+        launches.front().trace_begin = std::max(launches.front().trace_begin, last_trace_done_);
+      }
+    }
+  }
+#endif
+
+  void NameThread(const Task& task) {
+    if (task.trace && !named_) {
+      Tracer::Global()->NameThread("VTA device runner");
+      named_ = true;
+    }
+  }
+
+  // Account a finished run that started at begin, and wake up the waiters
+  void Retire(const Task& task, std::chrono::steady_clock::time_point begin, int64_t trace_begin,
+              int timeout) {
+    last_done_ = std::chrono::steady_clock::now();
+    last_trace_done_ = Tracer::Now();
+    auto elapsed = last_done_ - begin;
+    if (task.trace) {
+      Tracer::Global()->Complete("VTADeviceRun", "device", trace_begin, last_trace_done_,
+                                 task.insn_count);
+    }
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (timeout != 0) timeout_ = timeout;
+      uint64_t run_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      busy_ns_ += run_ns;
+      avg_run_ns_ = avg_run_ns_ == 0 ? run_ns : (avg_run_ns_ * 7 + run_ns) / 8;
+      completed_.fetch_add(1, std::memory_order_release);
+    }
+    done_cv_.notify_all();
+  }
+
+  // Device handle
+  VTADeviceHandle device_;
+  // Protects all the states below
+  std::mutex mtx_;
+  std::condition_variable task_cv_;
+  std::condition_variable done_cv_;
+  // Pending instruction streams
+  std::deque<Task> tasks_;
+  static constexpr uint64_t kSpinNs = VTA_WAIT_SPIN_NS;
+  // Number of submitted and completed streams, completed_ is also polled without the lock
+  uint64_t submitted_{0};
+  std::atomic<uint64_t> completed_{0};
+  // Time spent in VTADeviceRun
+  uint64_t busy_ns_{0};
+  // Moving average of the device run time
+  uint64_t avg_run_ns_{0};
+  // Non-zero if a stream timed out since the last wait
+  int timeout_{0};
+  bool shutdown_{false};
+  // Whether the worker is named in the timeline, only used by the worker
+  bool named_{false};
+  // When the last run finished, only used by the worker
+  std::chrono::steady_clock::time_point last_done_;
+  int64_t last_trace_done_{0};
+#if VTA_DEVICE_ASYNC
+  static constexpr size_t kMaxLaunches = VTA_DEVICE_MAX_LAUNCHES;
+#endif
+  // The thread that executes the streams
+  std::thread worker_;
+};
+
+/*!
+ * \brief A VTA device shared by the command queues of all host threads.
+ *
+ *  Each thread records into its own command queue without locking. Finished
+ *  streams of all queues run in submission order on one DeviceRunner. A queue
+ *  leases the device while it submits the streams of one synchronization, so
+ *  that the streams CheckInsnOverFlow splits a layer into, which continue on
+ *  each other's SRAM contents, are not interleaved with other queues.
+ */
+class DeviceContext {
+ public:
+  DeviceContext() {
+    device_ = VTADeviceAlloc();
+    CHECK(device_ != nullptr);
+    runner_.reset(new DeviceRunner(device_));
+  }
+  ~DeviceContext() {
+    runner_.reset();
+    VTADeviceFree(device_);
+  }
+  /*! \return The runner executing the streams on the device. */
+  DeviceRunner* runner() const { return runner_.get(); }
+  /*!
+   * \brief Lease the device to a queue, waiting for the lease of another queue to end.
+   * \param owner The queue.
+   * \return Whether streams of another queue were submitted since the last lease of owner.
+   */
+  bool Acquire(const void* owner) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this, owner]() { return holder_ == nullptr || holder_ == owner; });
+    bool switched = last_owner_ != owner;
+    holder_ = owner;
+    last_owner_ = owner;
+    return switched;
+  }
+  /*!
+   * \brief End the lease of a queue.
+   * \param owner The queue.
+   */
+  void Release(const void* owner) {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      if (holder_ != owner) return;
+      holder_ = nullptr;
+    }
+    cv_.notify_all();
+  }
+  /*!
+   * \brief Get the shared context of a device, creating it on first use.
+   * \param device_id The device id.
+   */
+  static std::shared_ptr<DeviceContext> Get(int device_id) {
+    static std::mutex mtx;
+    static std::unordered_map<int, std::weak_ptr<DeviceContext>> contexts;
+    std::lock_guard<std::mutex> lock(mtx);
+    std::shared_ptr<DeviceContext> ctx = contexts[device_id].lock();
+    if (ctx == nullptr) {
+      ctx = std::make_shared<DeviceContext>();
+      contexts[device_id] = ctx;
+    }
+    return ctx;
+  }
+
+ private:
+  VTADeviceHandle device_{nullptr};
+  std::unique_ptr<DeviceRunner> runner_;
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  // The queue holding the lease, and the last queue that held it
+  const void* holder_{nullptr};
+  const void* last_owner_{nullptr};
+};
+
+/*!
+ * \brief A recorded sequence of instruction streams that can be replayed.
+ *
+ *  Each stream is kept without its trailing FINISH, so that consecutive
+ *  streams can be concatenated into a single device run: every stream
+ *  leaves the dependence queues drained before its FINISH. DRAM addresses
+ *  of data buffers and of the staged micro-ops are recorded as patches,
+ *  applied when the graph is uploaded.
+ *
+ *  With prefetch enabled, the load credits that open a stream are returned
+ *  before the barrier closing the previous stream rather than after it, so the
+ *  first input and weight loads of a kernel overlap the last stores of the
+ *  kernel before it.
+ */
+class CommandGraph {
+ public:
+  /*! \brief DRAM reference to a data buffer. */
+  struct BufferPatch {
+    uint32_t insn_index;
+    DataBuffer* buffer;
+    uint32_t elem_bytes;
+    uint32_t elem_offset;
+  };
+  /*! \brief DRAM reference to staged micro-ops. */
+  struct UopPatch {
+    uint32_t insn_index;
+    uint32_t uop_offset;
+  };
+  /*! \brief One recorded instruction stream. */
+  struct Stream {
+    std::vector<VTAGenericInsn> insns;
+    std::vector<VTAUop> uops;
+    std::vector<BufferPatch> buffer_patches;
+    std::vector<UopPatch> uop_patches;
+  };
+
+  ~CommandGraph() { this->FreeChunks(); }
+  /*! \return Whether the graph contains any stream. */
+  bool empty() const { return streams_.empty(); }
+  /*! \return Whether the device copy is out of date. */
+  bool dirty() const { return dirty_; }
+  /*! \brief Set whether loads of a stream may start during the stores of the previous one. */
+  void set_prefetch(bool prefetch) {
+    if (prefetch != prefetch_) dirty_ = true;
+    prefetch_ = prefetch;
+  }
+  /*! \brief Add a recorded stream. */
+  void AddStream(Stream&& stream) {
+    streams_.emplace_back(std::move(stream));
+    dirty_ = true;
+  }
+  /*! \brief Append the streams of another graph. */
+  void Append(CommandGraph* other) {
+    for (Stream& stream : other->streams_) {
+      this->AddStream(std::move(stream));
+    }
+    other->streams_.clear();
+  }
+  /*! \brief Redirect one data buffer to another. */
+  void Rebind(DataBuffer* old_buffer, DataBuffer* new_buffer) {
+    for (Stream& stream : streams_) {
+      for (BufferPatch& patch : stream.buffer_patches) {
+        if (patch.buffer == old_buffer) {
+          patch.buffer = new_buffer;
+          dirty_ = true;
+        }
+      }
+    }
+  }
+  /*!
+   * \brief Upload the graph into FPGA-readable memory if it changed.
+   *  The streams are packed into as few chunks as VTA_MAX_XFER allows.
+   */
+  void Upload() {
+    if (!dirty_) return;
+    this->FreeChunks();
+    Chunk chunk;
+    for (Stream& stream : streams_) {
+      size_t credits = prefetch_ ? LeadingCredits(stream.insns) : 0;
+      if (!chunk.insns.empty() &&
+          (chunk.insns.size() + stream.insns.size() + credits + 1) * sizeof(VTAGenericInsn) >
+              VTA_MAX_XFER) {
+        this->SealChunk(&chunk);
+      }
+      bool hoist = credits != 0 && !chunk.insns.empty() && IsBarrier(chunk.insns.back());
+      if (hoist) InsertCredits(&chunk.insns, credits);
+      uint32_t insn_base = chunk.insns.size();
+      uint32_t uop_base = chunk.uops.size();
+      chunk.insns.insert(chunk.insns.end(), stream.insns.begin(), stream.insns.end());
+      if (hoist) DropCredits(chunk.insns.data() + insn_base, credits);
+      chunk.uops.insert(chunk.uops.end(), stream.uops.begin(), stream.uops.end());
+      for (BufferPatch patch : stream.buffer_patches) {
+        patch.insn_index += insn_base;
+        chunk.buffer_patches.push_back(patch);
+      }
+      for (UopPatch patch : stream.uop_patches) {
+        patch.insn_index += insn_base;
+        patch.uop_offset += uop_base;
+        chunk.uop_patches.push_back(patch);
+      }
+    }
+    if (!chunk.insns.empty()) this->SealChunk(&chunk);
+    dirty_ = false;
+  }
+  /*!
+   * \brief Run the uploaded chunks.
+   * \param frun Callback taking the physical address and count of the instructions.
+   */
+  template <typename FRun>
+  void Launch(FRun frun) {
+    CHECK(!dirty_);
+    for (const SealedChunk& chunk : sealed_) {
+      frun(static_cast<const VTAGenericInsn*>(chunk.insn_buff), chunk.insn_phy, chunk.insn_count);
+    }
+  }
+
+ private:
+  struct Chunk {
+    std::vector<VTAGenericInsn> insns;
+    std::vector<VTAUop> uops;
+    std::vector<BufferPatch> buffer_patches;
+    std::vector<UopPatch> uop_patches;
+  };
+  struct SealedChunk {
+    void* insn_buff;
+    vta_phy_addr_t insn_phy;
+    uint32_t insn_count;
+    void* uop_buff;
+  };
+
+  static bool IsComputeStage(const VTAMemInsn* insn) {
+    if (insn->opcode == VTA_OPCODE_GEMM || insn->opcode == VTA_OPCODE_ALU) return true;
+    return insn->opcode == VTA_OPCODE_LOAD &&
+           (insn->memory_type == VTA_MEM_ID_UOP || insn->memory_type == VTA_MEM_ID_ACC ||
+            insn->memory_type == VTA_MEM_ID_ACC_8BIT);
+  }
+  static bool IsComputeNoop(const VTAMemInsn* insn) {
+    return insn->opcode == VTA_OPCODE_LOAD && insn->memory_type == VTA_MEM_ID_UOP &&
+           insn->x_size == 0;
+  }
+  // The compute no-op closing a stream, it waits for the last load and store
+  static bool IsBarrier(const VTAGenericInsn& insn) {
+    const VTAMemInsn* mem = reinterpret_cast<const VTAMemInsn*>(&insn);
+    return IsComputeNoop(mem) && mem->pop_prev_dep && mem->pop_next_dep && !mem->push_prev_dep &&
+           !mem->push_next_dep;
+  }
+  // Number of compute no-ops returning load credits before the first compute of a stream
+  static size_t LeadingCredits(const std::vector<VTAGenericInsn>& insns) {
+    size_t credits = 0;
+    for (const VTAGenericInsn& insn : insns) {
+      const VTAMemInsn* mem = reinterpret_cast<const VTAMemInsn*>(&insn);
+      if (!IsComputeStage(mem)) continue;
+      if (!IsComputeNoop(mem) || !mem->push_prev_dep || mem->push_next_dep || mem->pop_prev_dep ||
+          mem->pop_next_dep) {
+        break;
+      }
+      ++credits;
+    }
+    return credits;
+  }
+  /*!
+   * \brief Return load credits before the barrier closing the instructions.
+   *
+   *  The credits then only wait for the computation of the previous stream, which
+   *  is the last reader of the input and weight buffers: its stores do not touch
+   *  them. The next stream gives up as many of its leading credits with DropCredits.
+   */
+  static void InsertCredits(std::vector<VTAGenericInsn>* insns, size_t credits) {
+    VTAGenericInsn credit = insns->back();
+    VTAMemInsn* mem = reinterpret_cast<VTAMemInsn*>(&credit);
+    mem->pop_prev_dep = false;
+    mem->pop_next_dep = false;
+    mem->push_prev_dep = true;
+    insns->insert(insns->end() - 1, credits, credit);
+  }
+  // Clear the leading credits of a stream, the no-ops stay so that patch indices remain valid
+  static void DropCredits(VTAGenericInsn* insns, size_t credits) {
+    for (VTAGenericInsn* insn = insns; credits != 0; ++insn) {
+      VTAMemInsn* mem = reinterpret_cast<VTAMemInsn*>(insn);
+      if (!IsComputeStage(mem)) continue;
+      mem->push_prev_dep = false;
+      --credits;
+    }
+  }
+
+  // Finish a chunk with FINISH, apply the patches and copy it to FPGA-readable memory
+  void SealChunk(Chunk* chunk) {
+    SealedChunk sealed;
+    sealed.uop_buff = nullptr;
+    vta_phy_addr_t uop_phy = 0;
+    if (!chunk->uops.empty()) {
+      size_t uop_bytes = chunk->uops.size() * sizeof(VTAUop);
+      sealed.uop_buff = VTAMemAlloc(uop_bytes, kAlwaysCache);
+      CHECK(sealed.uop_buff != nullptr);
+      uop_phy = VTAMemGetPhyAddr(sealed.uop_buff);
+      VTAMemCopyFromHost(sealed.uop_buff, chunk->uops.data(), uop_bytes);
+      if (!kBufferCoherent && kAlwaysCache) {
+        VTAFlushCache(sealed.uop_buff, uop_phy, uop_bytes);
+      }
+    }
+    VTAGenericInsn finish;
+    memset(&finish, 0, sizeof(finish));
+    reinterpret_cast<VTAGemInsn*>(&finish)->opcode = VTA_OPCODE_FINISH;
+    chunk->insns.push_back(finish);
+    VTAMemInsn* mem = reinterpret_cast<VTAMemInsn*>(chunk->insns.data());
+    for (const BufferPatch& patch : chunk->buffer_patches) {
+      mem[patch.insn_index].dram_base =
+          patch.buffer->phy_addr() / patch.elem_bytes + patch.elem_offset;
+    }
+    for (const UopPatch& patch : chunk->uop_patches) {
+      mem[patch.insn_index].dram_base =
+          (uop_phy + patch.uop_offset * sizeof(VTAUop)) / sizeof(VTAUop);
+    }
+    size_t insn_bytes = chunk->insns.size() * sizeof(VTAGenericInsn);
+    sealed.insn_buff = VTAMemAlloc(insn_bytes, kAlwaysCache);
+    CHECK(sealed.insn_buff != nullptr);
+    sealed.insn_phy = VTAMemGetPhyAddr(sealed.insn_buff);
+    sealed.insn_count = chunk->insns.size();
+    VTAMemCopyFromHost(sealed.insn_buff, chunk->insns.data(), insn_bytes);
+    if (!kBufferCoherent && kAlwaysCache) {
+      VTAFlushCache(sealed.insn_buff, sealed.insn_phy, insn_bytes);
+    }
+    sealed_.push_back(sealed);
+    *chunk = Chunk();
+  }
+
+  void FreeChunks() {
+    for (const SealedChunk& chunk : sealed_) {
+      VTAMemFree(chunk.insn_buff);
+      if (chunk.uop_buff != nullptr) VTAMemFree(chunk.uop_buff);
+    }
+    sealed_.clear();
+  }
+
+  // Recorded streams
+  std::vector<Stream> streams_;
+  // Uploaded chunks
+  std::vector<SealedChunk> sealed_;
+  // Whether streams changed since the last upload
+  bool dirty_{true};
+  // Whether the leading load credits of a stream are returned before the previous barrier
+  bool prefetch_{false};
+};
+
+/*!
+ * \brief The command queue object that handles the request.
+ */
+class CommandQueue {
+ public:
+  explicit CommandQueue(int device_id) { this->InitSpace(device_id); }
+  void InitSpace(int device_id) {
+    uop_queue_.InitSpace(kNumSlots);
+    insn_queue_.InitSpace(kNumSlots);
+    ctx_ = DeviceContext::Get(device_id);
+    runner_ = ctx_->runner();
+  }
+
+  ~CommandQueue() {
+    // The slot buffers must outlive the streams that read them
+    runner_->Wait(last_ticket_);
+    ctx_->Release(this);
+    if (copy_wgt_ != nullptr) DataBuffer::Free(copy_wgt_);
+  }
+
+  uint32_t GetElemBytes(uint32_t memory_id) {
+    uint32_t elem_bytes = 0;
+    switch (memory_id) {
+      case VTA_MEM_ID_UOP:
+        elem_bytes = VTA_UOP_ELEM_BYTES;
+        break;
+      case VTA_MEM_ID_INP:
+        elem_bytes = VTA_INP_ELEM_BYTES;
+        break;
+      case VTA_MEM_ID_WGT:
+        elem_bytes = VTA_WGT_ELEM_BYTES;
+        break;
+      case VTA_MEM_ID_ACC:
+        elem_bytes = VTA_ACC_ELEM_BYTES;
+        break;
+      case VTA_MEM_ID_OUT:
+        elem_bytes = VTA_OUT_ELEM_BYTES;
+        break;
+      case VTA_MEM_ID_ACC_8BIT:
+        elem_bytes = VTA_ACC_ELEM_BYTES / 4;
+        break;
+      default:
+        LOG(FATAL) << "Memory id not recognized:" << memory_id;
+        break;
+    }
+    /*
+     * elements size should not larger than VTA_PAGE_BYTES.
+     *
+     */
+    CHECK_GE(VTA_PAGE_BYTES, elem_bytes);
+    return elem_bytes;
+  }
+
+  void LoadBuffer2D(void* src_dram_addr, uint32_t src_elem_offset, uint32_t x_size, uint32_t y_size,
+                    uint32_t x_stride, uint32_t x_pad_before, uint32_t y_pad_before,
+                    uint32_t x_pad_after, uint32_t y_pad_after, uint32_t dst_sram_index,
+                    uint32_t dst_memory_type) {
+    VTAMemInsn* insn = insn_queue_.CreateMemInsn(dst_memory_type);
+    insn->opcode = VTA_OPCODE_LOAD;
+    insn->memory_type = dst_memory_type;
+    insn->sram_base = dst_sram_index;
+    DataBuffer* src = DataBuffer::FromHandle(src_dram_addr);
+    insn->dram_base = src->phy_addr() / GetElemBytes(dst_memory_type) + src_elem_offset;
+    insn->y_size = y_size;
+    insn->x_size = x_size;
+    insn->x_stride = x_stride;
+    insn->y_pad_0 = y_pad_before;
+    insn->y_pad_1 = y_pad_after;
+    insn->x_pad_0 = x_pad_before;
+    insn->x_pad_1 = x_pad_after;
+    this->RecordBufferPatch(src, GetElemBytes(dst_memory_type), src_elem_offset);
+    this->CheckInsnOverFlow();
+  }
+
+  void StoreBuffer2D(uint32_t src_sram_index, uint32_t src_memory_type, void* dst_dram_addr,
+                     uint32_t dst_elem_offset, uint32_t x_size, uint32_t y_size,
+                     uint32_t x_stride) {
     VTAMemInsn* insn = insn_queue_.CreateStoreInsn();
     insn->opcode = VTA_OPCODE_STORE;
     insn->memory_type = src_memory_type;
@@ -1078,28 +2332,153 @@ class CommandQueue {
     insn->y_pad_1 = 0;
     insn->x_pad_0 = 0;
     insn->x_pad_1 = 0;
+    this->RecordBufferPatch(dst, GetElemBytes(src_memory_type), dst_elem_offset);
     this->CheckInsnOverFlow();
   }
 
+  /*!
+   * \brief Copy between two device buffers with VTA instructions.
+   *
+   *  The data is loaded into the input buffer, moved to the output buffer by
+   *  a GEMM against an identity weight, and stored, so neither the CPU nor its
+   *  caches touch it. The copy is submitted and ordered after the streams
+   *  already submitted to the device.
+   * \return Whether the copy was issued, false if it has to be done on the host.
+   */
+  bool CopyOnDevice(DataBuffer* from, size_t from_offset, DataBuffer* to, size_t to_offset,
+                    size_t size) {
+    constexpr size_t kElemBytes = VTA_INP_ELEM_BYTES;
+    // The GEMM only reproduces its input if the output has the same layout and width
+    if (VTA_INP_ELEM_BYTES != VTA_OUT_ELEM_BYTES || VTA_BLOCK_IN != VTA_BLOCK_OUT ||
+        VTA_INP_WIDTH != VTA_OUT_WIDTH) {
+      return false;
+    }
+    // A capture records the stream once and is being invalidated anyway
+    if (capturing_ || size == 0 || size % kElemBytes != 0) return false;
+    if ((from->phy_addr() + from_offset) % kElemBytes != 0) return false;
+    if ((to->phy_addr() + to_offset) % kElemBytes != 0) return false;
+    // Chunks would read data already overwritten by earlier chunks
+    if (from == to && from_offset < to_offset + size && to_offset < from_offset + size) {
+      return false;
+    }
+    if (copy_wgt_ == nullptr) {
+      copy_wgt_ = DataBuffer::Alloc(VTA_WGT_ELEM_BYTES);
+      int8_t* wgt = static_cast<int8_t*>(copy_wgt_->virt_addr());
+      memset(wgt, 0, VTA_WGT_ELEM_BYTES);
+      for (int i = 0; i < VTA_BLOCK_OUT; ++i) {
+        wgt[i * VTA_BLOCK_IN + i] = 1;
+      }
+      copy_wgt_->FlushCache(0, VTA_WGT_ELEM_BYTES);
+      copy_kernel_.reset(new UopKernel("vta.copy", 8));
+      copy_kernel_->Push(0, 0, 0, 0, 0, 0, 0, 0);
+    }
+    // A chunk is one GEMM whose outer loop runs over its elements
+    constexpr int kMaxLoopIter = (1 << VTA_LOOP_ITER_WIDTH) - 1;
+    uint32_t max_elems = std::min(std::min(VTA_INP_BUFF_DEPTH, VTA_ACC_BUFF_DEPTH),
+                                  std::min(VTA_OUT_BUFF_DEPTH, kMaxLoopIter));
+    // The host writes to the source are visible to the device when the copy is submitted,
+    // no dirty line of the destination is written back over it, and the host reads the
+    // destination again after the copy has run.
+    pending_flush_.Add(from, from_offset, size);
+    pending_flush_.Add(to, to_offset, size);
+    pending_invalidate_.Add(to, to_offset, size);
+    size_t total = size / kElemBytes;
+    size_t src_base = (from->phy_addr() + from_offset) / kElemBytes;
+    size_t dst_base = (to->phy_addr() + to_offset) / kElemBytes;
+    for (size_t done = 0; done < total;) {
+      uint32_t n = static_cast<uint32_t>(std::min<size_t>(total - done, max_elems));
+      // Earlier users of the SRAM are done before a chunk overwrites it
+      insn_queue_.DepPush(kStoreStage, kComputeStage);
+      insn_queue_.DepPush(kComputeStage, kLoadStage);
+      insn_queue_.DepPop(kComputeStage, kLoadStage);
+      VTAMemInsn* load = insn_queue_.CreateMemInsn(VTA_MEM_ID_INP);
+      this->InitCopyMemInsn(load, VTA_OPCODE_LOAD, VTA_MEM_ID_INP, src_base + done, n);
+      load = insn_queue_.CreateMemInsn(VTA_MEM_ID_WGT);
+      this->InitCopyMemInsn(load, VTA_OPCODE_LOAD, VTA_MEM_ID_WGT,
+                            copy_wgt_->phy_addr() / VTA_WGT_ELEM_BYTES, 1);
+      insn_queue_.DepPush(kLoadStage, kComputeStage);
+      insn_queue_.DepPop(kLoadStage, kComputeStage);
+      insn_queue_.DepPop(kStoreStage, kComputeStage);
+      uop_queue_.Push(copy_kernel_.get(), [this]() { this->AutoSync(); });
+      if (uop_queue_.pending()) {
+        VTAMemInsn* insn = insn_queue_.CreateMemInsn(VTA_MEM_ID_UOP);
+        insn->opcode = VTA_OPCODE_LOAD;
+        uop_queue_.FlushUopLoad(insn);
+      }
+      // Reset the accumulator, then add the input times the identity
+      std::pair<uint32_t, uint32_t> uop_range = uop_queue_.Location(copy_kernel_.get());
+      for (uint32_t reset : {1U, 0U}) {
+        VTAGemInsn* gemm = insn_queue_.CreateGemInsn();
+        gemm->opcode = VTA_OPCODE_GEMM;
+        gemm->reset_reg = reset;
+        gemm->uop_bgn = uop_range.first;
+        gemm->uop_end = uop_range.second;
+        gemm->iter_out = n;
+        gemm->iter_in = 1;
+        gemm->dst_factor_out = 1;
+        gemm->src_factor_out = 1;
+        gemm->wgt_factor_out = 0;
+        gemm->dst_factor_in = 0;
+        gemm->src_factor_in = 0;
+        gemm->wgt_factor_in = 0;
+      }
+      insn_queue_.DepPush(kComputeStage, kStoreStage);
+      insn_queue_.DepPop(kComputeStage, kStoreStage);
+      VTAMemInsn* store = insn_queue_.CreateStoreInsn();
+      this->InitCopyMemInsn(store, VTA_OPCODE_STORE, VTA_MEM_ID_OUT, dst_base + done, n);
+      done += n;
+      // Each chunk balances its tokens, so the stream may be split in between
+      this->CheckInsnOverFlow();
+    }
+    this->Submit(1 << 31);
+    return true;
+  }
+
   void DepPush(int from_qid, int to_qid) { insn_queue_.DepPush(from_qid, to_qid); }
 
   void DepPop(int from_qid, int to_qid) { insn_queue_.DepPop(from_qid, to_qid); }
 
+  // The flush is deferred to the next submission, which is the first point the device reads it.
+  // Parameter arena buffers were flushed when they were loaded.
   void ReadBarrier(void* buffer, uint32_t elem_bits, uint32_t start, uint32_t extent) {
-    if (!(debug_flag_ & VTA_DEBUG_SKIP_READ_BARRIER)) {
+    DataBuffer* data_buf = DataBuffer::FromHandle(buffer);
+    bool loaded = data_buf != nullptr && data_buf->persistent();
+    if (!(debug_flag_ & VTA_DEBUG_SKIP_READ_BARRIER) && !loaded) {
       uint32_t elem_bytes = (elem_bits + 8 - 1) / 8;
-      DataBuffer::FromHandle(buffer)->FlushCache(elem_bytes * start, elem_bytes * extent);
+      pending_flush_.Add(data_buf, elem_bytes * start, elem_bytes * extent);
     }
   }
 
+  // The invalidation is deferred until the pending instructions have run on the device
   void WriteBarrier(void* buffer, uint32_t elem_bits, uint32_t start, uint32_t extent) {
     if (!(debug_flag_ & VTA_DEBUG_SKIP_WRITE_BARRIER)) {
       uint32_t elem_bytes = (elem_bits + 8 - 1) / 8;
-      DataBuffer::FromHandle(buffer)->InvalidateCache(elem_bytes * start, elem_bytes * extent);
+      pending_invalidate_.Add(DataBuffer::FromHandle(buffer), elem_bytes * start,
+                              elem_bytes * extent);
+      if (insn_queue_.count() == 0) {
+        this->DrainInvalidate();
+      }
     }
   }
 
   void Synchronize(uint32_t wait_cycles) {
+    this->Submit(wait_cycles);
+    this->Wait();
+  }
+
+  /*!
+   * \brief Submit the recorded stream to the device.
+   * \param wait_cycles The poll budget of the device run.
+   * \param end_lease Whether the device may run streams of other queues afterwards.
+   */
+  void Submit(uint32_t wait_cycles, bool end_lease = true) {
+    Tracer::Scope trace_submit(this->tracing(), "Submit", "host");
+    {
+      Tracer::Scope trace_flush(this->tracing(), "FlushCache", "barrier");
+      pending_flush_.Drain([](DataBuffer* buffer, size_t offset, size_t size) {
+        buffer->FlushCache(offset, size);
+      });
+    }
     // Insert dependences to force serialization
     if (debug_flag_ & VTA_DEBUG_FORCE_SERIAL) {
       insn_queue_.RewriteForceSerial();
@@ -1110,16 +2489,46 @@ class CommandQueue {
       insn_queue_.DepPop(kStoreStage, kComputeStage);
       insn_queue_.DepPop(kLoadStage, kComputeStage);
       insn_queue_.CommitPendingPop(kComputeStage);
+      // Recorded patches refer to instruction indices, keep captured streams as issued
+      if ((debug_flag_ & VTA_OPT_INSN_PEEPHOLE) && !capturing_) {
+        insn_queue_.Optimize();
+      }
     }
     // NOTE: FINISH cannot contain pop
     VTAGemInsn* insn = insn_queue_.CreateGemInsn();
     insn->opcode = VTA_OPCODE_FINISH;
     CHECK(!insn_queue_.PendingPop());
     // Check if there are no instruction to execute at all
-    if (insn_queue_.count() == 0) return;
+    if (insn_queue_.count() == 0) {
+      if (end_lease) ctx_->Release(this);
+      return;
+    }
+    if (capturing_) {
+      // Keep the stream without FINISH, so that it can be concatenated on replay
+      capture_stream_.insns.assign(insn_queue_.data(),
+                                   insn_queue_.data() + insn_queue_.count() - 1);
+      capture_stream_.uops.assign(uop_queue_.staged_data(),
+                                  uop_queue_.staged_data() + uop_queue_.staged_count());
+      capture_graph_->AddStream(std::move(capture_stream_));
+      capture_stream_ = CommandGraph::Stream();
+    }
+    bool switched;
+    {
+      Tracer::Scope trace_acquire(this->tracing(), "Acquire device", "host");
+      switched = ctx_->Acquire(this);
+    }
+    if (switched) {
+      // Streams of other queues may have overwritten the micro-op SRAM
+      uop_queue_.RestageReused([this](uint32_t sram_base, uint32_t dram_base, uint32_t num_op) {
+        insn_queue_.PrependUopLoad(sram_base, dram_base, num_op);
+      });
+    }
     // Synchronization for the queues
-    uop_queue_.AutoReadBarrier();
-    insn_queue_.AutoReadBarrier();
+    {
+      Tracer::Scope trace_flush(this->tracing(), "Flush streams", "barrier");
+      uop_queue_.AutoReadBarrier();
+      insn_queue_.AutoReadBarrier();
+    }
     // Dump instructions if debug enabled
     if (debug_flag_ & VTA_DEBUG_DUMP_INSN) {
       insn_queue_.DumpInsn();
@@ -1130,12 +2539,76 @@ class CommandQueue {
 
     // Make sure that we don't exceed contiguous physical memory limits
     CHECK(insn_queue_.count() * sizeof(VTAGenericInsn) <= VTA_MAX_XFER);
-    int timeout =
-        VTADeviceRun(device_, insn_queue_.dram_phy_addr(), insn_queue_.count(), wait_cycles);
-    CHECK_EQ(timeout, 0);
-    // Reset buffers
+    this->CountStageWork(static_cast<const VTAGenericInsn*>(insn_queue_.data()),
+                         insn_queue_.count());
+    last_ticket_ = slot_ticket_[slot_] = runner_->Submit(
+        insn_queue_.dram_phy_addr(), insn_queue_.count(), wait_cycles, this->tracing());
+    if (end_lease) ctx_->Release(this);
+    // Reset buffers, the submitted stream lives in the FPGA buffers of the slot
     uop_queue_.Reset();
     insn_queue_.Reset();
+    this->NextSlot();
+  }
+
+  // Wait for the streams submitted by this queue
+  void Wait() {
+    {
+      Tracer::Scope trace_wait(this->tracing(), "Wait device", "host");
+      runner_->Wait(last_ticket_);
+    }
+    this->DrainInvalidate();
+  }
+
+  void CaptureBegin() {
+    CHECK(!capturing_) << "VTA capture is already in progress";
+    CHECK_EQ(insn_queue_.count(), 0U);
+    CHECK(!insn_queue_.PendingPop());
+    // The recorded streams must load every micro-op kernel they use
+    uop_queue_.Invalidate();
+    capturing_ = true;
+    capture_valid_ = true;
+    capture_graph_.reset(new CommandGraph());
+    capture_stream_ = CommandGraph::Stream();
+  }
+
+  CommandGraph* CaptureEnd() {
+    CHECK(capturing_) << "VTA capture is not in progress";
+    if (insn_queue_.count() != 0) {
+      this->Submit(1 << 31);
+    }
+    capturing_ = false;
+    std::unique_ptr<CommandGraph> graph = std::move(capture_graph_);
+    if (!capture_valid_ || graph->empty()) return nullptr;
+    return graph.release();
+  }
+
+  // Mark the capture as not replayable because the CPU touched a device buffer
+  void InvalidateCapture() {
+    if (capturing_) capture_valid_ = false;
+  }
+
+  void LaunchGraph(CommandGraph* graph, uint32_t wait_cycles) {
+    CHECK(!capturing_) << "Cannot launch a VTA graph while capturing";
+    CHECK(!insn_queue_.PendingPop());
+    if (insn_queue_.count() != 0) {
+      this->Submit(wait_cycles);
+    }
+    graph->set_prefetch((debug_flag_ & VTA_OPT_GRAPH_PREFETCH) != 0);
+    if (graph->dirty()) {
+      // A previous launch may still read from the old upload
+      this->Wait();
+      graph->Upload();
+    }
+    // The graph loads all micro-ops it uses, but its chunks are run back to back
+    ctx_->Acquire(this);
+    graph->Launch([this, wait_cycles](const VTAGenericInsn* insns, vta_phy_addr_t insn_phy,
+                                      uint32_t insn_count) {
+      this->CountStageWork(insns, insn_count);
+      last_ticket_ = runner_->Submit(insn_phy, insn_count, wait_cycles, this->tracing());
+    });
+    ctx_->Release(this);
+    // The graph overwrote the uop SRAM behind the residency cache
+    uop_queue_.Invalidate();
   }
 
   // Get record kernel
@@ -1145,57 +2618,222 @@ class CommandQueue {
   }
 
   // Set debug flag
-  void SetDebugFlag(int debug_flag) { debug_flag_ = debug_flag; }
+  void SetDebugFlag(int debug_flag) {
+    if ((debug_flag & VTA_DEBUG_TRACE) && !this->tracing()) {
+      Tracer::Global()->NameThread("host");
+    }
+    debug_flag_ = debug_flag;
+  }
 
   void PushGEMMOp(void** uop_handle, int (*finit)(void*), void* signature, int nbytes) {
-    UopKernelMap** uptr = reinterpret_cast<UopKernelMap**>(uop_handle);
-    if (uptr[0] == nullptr) {
-      uptr[0] = new UopKernelMap();
-    }
-    UopKernel** kptr = uptr[0]->Get(signature, nbytes);
-    if (kptr[0] == nullptr) {
-      record_kernel_ = new UopKernel(static_cast<char*>(signature), nbytes);
-      CHECK_EQ((*finit)(signature), 0);
-      kptr[0] = static_cast<UopKernel*>(record_kernel_);
-      if (debug_flag_ & VTA_DEBUG_DUMP_UOP) {
-        record_kernel_->Dump();
-      }
-      record_kernel_ = nullptr;
-    }
-    this->PushGEMMOp(static_cast<UopKernel*>(kptr[0]));
+    this->PushGEMMOp(this->GetKernel(uop_handle, finit, signature, nbytes));
     this->CheckInsnOverFlow();
   }
 
   void PushALUUop(void** uop_handle, int (*finit)(void*), void* signature, int nbytes) {
-    UopKernelMap** uptr = reinterpret_cast<UopKernelMap**>(uop_handle);
-    if (uptr[0] == nullptr) {
-      uptr[0] = new UopKernelMap();
-    }
-    UopKernel** kptr = uptr[0]->Get(signature, nbytes);
-    if (kptr[0] == nullptr) {
-      record_kernel_ = new UopKernel(static_cast<char*>(signature), nbytes);
-      CHECK_EQ((*finit)(signature), 0);
-      kptr[0] = static_cast<UopKernel*>(record_kernel_);
-      if (debug_flag_ & VTA_DEBUG_DUMP_UOP) {
-        record_kernel_->Dump();
-      }
-      record_kernel_ = nullptr;
-    }
-    this->PushALUUop(static_cast<UopKernel*>(kptr[0]));
+    this->PushALUUop(this->GetKernel(uop_handle, finit, signature, nbytes));
     this->CheckInsnOverFlow();
   }
 
+  void GetStageCounters(VTAStageCounters* counters) {
+    *counters = stage_counters_;
+    counters->device_runs = runner_->completed();
+    counters->device_busy_ns = runner_->busy_ns();
+  }
+
+  // Get the hit and miss counts of the uop kernel cache
+  void GetKernelCacheStats(uint64_t* hits, uint64_t* misses) const {
+    *hits = kernel_hits_;
+    *misses = kernel_misses_;
+  }
+
+  // Get the command queue of the calling thread for its current device
   static std::shared_ptr<CommandQueue>& ThreadLocal() {
-    static std::shared_ptr<CommandQueue> inst = std::make_shared<CommandQueue>();
+    // Cache the slot, lookups happen for every pushed micro-op
+    static thread_local int slot_device = -1;
+    static thread_local std::shared_ptr<CommandQueue>* slot = nullptr;
+    if (slot_device != current_device_id_) {
+      slot = &ForDevice(current_device_id_);
+      slot_device = current_device_id_;
+    }
+    if (*slot == nullptr) {
+      ForDevice(slot_device);
+    }
+    return *slot;
+  }
+
+  // Get the command queue of the calling thread for a device, creating it on first use
+  static std::shared_ptr<CommandQueue>& ForDevice(int device_id) {
+    // Drops the queues of the thread when it exits, with their staging buffers
+    static thread_local ThreadQueuesGuard guard;
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    // Entries are only erased by their own thread, references to them stay valid
+    std::shared_ptr<CommandQueue>& inst =
+        queues_[std::make_pair(std::this_thread::get_id(), device_id)];
     if (inst == nullptr) {
-      inst = std::make_shared<CommandQueue>();
+      inst = std::make_shared<CommandQueue>(device_id);
     }
     return inst;
   }
 
-  static void Shutdown() { ThreadLocal().reset(); }
+  // Set the device that the calling thread issues commands to
+  static void SetDevice(int device_id) {
+    CHECK_GE(device_id, 0);
+    current_device_id_ = device_id;
+  }
+
+  static void Shutdown() {
+    std::lock_guard<std::mutex> lock(queues_mutex_);
+    for (auto& kv : queues_) {
+      kv.second.reset();
+    }
+  }
 
  private:
+  // Erases the command queues of a thread when the thread exits
+  struct ThreadQueuesGuard {
+    ~ThreadQueuesGuard() {
+      std::vector<std::shared_ptr<CommandQueue>> exited;
+      {
+        std::lock_guard<std::mutex> lock(queues_mutex_);
+        std::thread::id tid = std::this_thread::get_id();
+        auto it = queues_.lower_bound(std::make_pair(tid, std::numeric_limits<int>::min()));
+        while (it != queues_.end() && it->first.first == tid) {
+          exited.push_back(std::move(it->second));
+          it = queues_.erase(it);
+        }
+      }
+      // Destroyed outside the lock, the queues wait for their streams to retire
+    }
+  };
+
+  // Move on to a slot whose previous stream has retired, so that it can be overwritten.
+  // Slots are added while all are in flight, so that streams split by CheckInsnOverFlow
+  // are queued back to back, and only a full ring waits for the oldest stream.
+  void NextSlot() {
+    uint64_t completed = runner_->completed();
+    uint32_t num_slots = slot_ticket_.size();
+    uint32_t next = num_slots;
+    for (uint32_t i = 1; i <= num_slots && next == num_slots; ++i) {
+      uint32_t slot = (slot_ + i) % num_slots;
+      if (slot != slot_ && slot_ticket_[slot] <= completed) next = slot;
+    }
+    if (next == num_slots && num_slots < kMaxSlots) {
+      next = uop_queue_.AddSlot();
+      CHECK_EQ(insn_queue_.AddSlot(), next);
+      slot_ticket_.push_back(0);
+    }
+    if (next == num_slots) {
+      next = (slot_ + 1) % num_slots;
+      for (uint32_t slot = 0; slot < num_slots; ++slot) {
+        if (slot != slot_ && slot_ticket_[slot] < slot_ticket_[next]) next = slot;
+      }
+      Tracer::Scope trace_wait(this->tracing(), "Wait slot", "host");
+      runner_->Wait(slot_ticket_[next]);
+    }
+    slot_ = next;
+    uop_queue_.SetSlot(slot_);
+    insn_queue_.SetSlot(slot_);
+  }
+
+  // Accumulate the work that an instruction stream issues to each stage
+  void CountStageWork(const VTAGenericInsn* insns, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+      const VTAMemInsn* mem = reinterpret_cast<const VTAMemInsn*>(insns + i);
+      if (mem->opcode == VTA_OPCODE_LOAD || mem->opcode == VTA_OPCODE_STORE) {
+        if (mem->x_size == 0) continue;
+        if (mem->opcode == VTA_OPCODE_STORE) {
+          stage_counters_.store_bytes +=
+              static_cast<uint64_t>(mem->y_size) * mem->x_size * VTA_OUT_ELEM_BYTES;
+          continue;
+        }
+        uint64_t bytes =
+            static_cast<uint64_t>(mem->y_size) * mem->x_size * GetElemBytes(mem->memory_type);
+        if (mem->memory_type == VTA_MEM_ID_INP || mem->memory_type == VTA_MEM_ID_WGT) {
+          stage_counters_.load_bytes += bytes;
+        } else {
+          stage_counters_.compute_load_bytes += bytes;
+        }
+      } else if (mem->opcode == VTA_OPCODE_GEMM || mem->opcode == VTA_OPCODE_ALU) {
+        const VTAGemInsn* gemm = reinterpret_cast<const VTAGemInsn*>(insns + i);
+        uint64_t uops = static_cast<uint64_t>(gemm->uop_end - gemm->uop_bgn) * gemm->iter_out *
+                        gemm->iter_in;
+        if (mem->opcode == VTA_OPCODE_GEMM) {
+          stage_counters_.gemm_uops += uops;
+        } else {
+          stage_counters_.alu_uops += uops;
+        }
+      }
+    }
+  }
+
+  void DrainInvalidate() {
+    Tracer::Scope trace_invalidate(this->tracing(), "InvalidateCache", "barrier");
+    pending_invalidate_.Drain([](DataBuffer* buffer, size_t offset, size_t size) {
+      buffer->InvalidateCache(offset, size);
+    });
+  }
+
+  // Fill a contiguous transfer of a device copy, SRAM index 0 is the start of every chunk
+  void InitCopyMemInsn(VTAMemInsn* insn, uint32_t opcode, uint32_t memory_type, size_t dram_base,
+                       uint32_t num_elems) {
+    insn->opcode = opcode;
+    insn->memory_type = memory_type;
+    insn->sram_base = 0;
+    insn->dram_base = dram_base;
+    insn->y_size = 1;
+    insn->x_size = num_elems;
+    insn->x_stride = num_elems;
+    insn->y_pad_0 = 0;
+    insn->y_pad_1 = 0;
+    insn->x_pad_0 = 0;
+    insn->x_pad_1 = 0;
+  }
+
+  // Whether the timeline of this queue is recorded
+  bool tracing() const { return (debug_flag_ & VTA_DEBUG_TRACE) != 0; }
+
+  // Look up the kernel of a call site, recording it through finit on first use
+  // The call sites are shared by all threads, their kernel maps are guarded by kernels_mutex_
+  UopKernel* GetKernel(void** uop_handle, int (*finit)(void*), void* signature, int nbytes) {
+    UopKernelMap** uptr = reinterpret_cast<UopKernelMap**>(uop_handle);
+    UopKernel** kptr;
+    {
+      std::lock_guard<std::mutex> lock(kernels_mutex_);
+      if (uptr[0] == nullptr) {
+        uptr[0] = new UopKernelMap();
+      }
+      kptr = uptr[0]->Get(signature, nbytes);
+      if (kptr[0] != nullptr) {
+        ++kernel_hits_;
+        return kptr[0];
+      }
+    }
+    ++kernel_misses_;
+    // Record without the lock, finit calls back into this queue
+    record_kernel_ = new UopKernel(static_cast<char*>(signature), nbytes);
+    {
+      Tracer::Scope trace_record(this->tracing(), "Record uop kernel", "host");
+      CHECK_EQ((*finit)(signature), 0);
+      if (!(debug_flag_ & VTA_DEBUG_SKIP_UOP_COMPRESS)) {
+        record_kernel_->Compress();
+      }
+    }
+    if (debug_flag_ & VTA_DEBUG_DUMP_UOP) {
+      record_kernel_->Dump();
+    }
+    UopKernel* kernel = record_kernel_;
+    record_kernel_ = nullptr;
+    std::lock_guard<std::mutex> lock(kernels_mutex_);
+    if (kptr[0] != nullptr) {
+      // Another thread recorded the same kernel meanwhile
+      delete kernel;
+    } else {
+      kptr[0] = kernel;
+    }
+    return kptr[0];
+  }
+
   // Push GEMM uop to the command buffer
   void PushGEMMOp(UopKernel* kernel) {
     uop_queue_.Push(kernel, [this]() { this->AutoSync(); });
@@ -1203,12 +2841,15 @@ class CommandQueue {
       VTAMemInsn* insn = insn_queue_.CreateMemInsn(VTA_MEM_ID_UOP);
       insn->opcode = VTA_OPCODE_LOAD;
       uop_queue_.FlushUopLoad(insn);
+      if (this->tracing()) Tracer::Global()->Instant("Uop load", "uop", insn->x_size);
+      this->RecordUopPatch();
     }
     VTAGemInsn* insn = insn_queue_.CreateGemInsn();
     insn->opcode = VTA_OPCODE_GEMM;
     insn->reset_reg = kernel->reset_out_;
-    insn->uop_bgn = kernel->sram_begin_;
-    insn->uop_end = kernel->sram_end_;
+    std::pair<uint32_t, uint32_t> uop_range = uop_queue_.Location(kernel);
+    insn->uop_bgn = uop_range.first;
+    insn->uop_end = uop_range.second;
     const std::vector<UopKernel::LoopEntry>& loop = kernel->loop();
     if (loop.size() > 0) {
       insn->iter_out = loop[0].extent;
@@ -1241,12 +2882,15 @@ class CommandQueue {
       VTAMemInsn* insn = insn_queue_.CreateMemInsn(VTA_MEM_ID_UOP);
       insn->opcode = VTA_OPCODE_LOAD;
       uop_queue_.FlushUopLoad(insn);
+      if (this->tracing()) Tracer::Global()->Instant("Uop load", "uop", insn->x_size);
+      this->RecordUopPatch();
     }
     VTAAluInsn* insn = insn_queue_.CreateAluInsn();
     insn->opcode = VTA_OPCODE_ALU;
     insn->reset_reg = kernel->reset_out_;
-    insn->uop_bgn = kernel->sram_begin_;
-    insn->uop_end = kernel->sram_end_;
+    std::pair<uint32_t, uint32_t> uop_range = uop_queue_.Location(kernel);
+    insn->uop_bgn = uop_range.first;
+    insn->uop_end = uop_range.second;
     insn->alu_opcode = kernel->opcode_;
     insn->use_imm = kernel->use_imm_;
     insn->imm = kernel->imm_val_;
@@ -1275,34 +2919,127 @@ class CommandQueue {
     }
   }
 
+  // Remember the DRAM reference of the last instruction when capturing
+  void RecordBufferPatch(DataBuffer* buffer, uint32_t elem_bytes, uint32_t elem_offset) {
+    if (!capturing_) return;
+    CommandGraph::BufferPatch patch;
+    patch.insn_index = insn_queue_.count() - 1;
+    patch.buffer = buffer;
+    patch.elem_bytes = elem_bytes;
+    patch.elem_offset = elem_offset;
+    capture_stream_.buffer_patches.push_back(patch);
+  }
+
+  // Remember the staged micro-ops referenced by the last uop load when capturing
+  void RecordUopPatch() {
+    if (!capturing_) return;
+    CommandGraph::UopPatch patch;
+    patch.insn_index = insn_queue_.count() - 1;
+    patch.uop_offset = uop_queue_.staged_offset();
+    capture_stream_.uop_patches.push_back(patch);
+  }
+
   void CheckInsnOverFlow() {
     // At each API call, we can at most commit:
     // at most: 2 NOP-COMPUTE-STAGE -> 2 NOP-MEMORY-STAGE -> 1 NOP-COMPUTE-STAGE -> 1 FINISH
-    if ((insn_queue_.count() + 6) * sizeof(VTAGenericInsn) > VTA_MAX_XFER) {
+    // Also keep room for reloading reused micro-op kernels at submission
+    if ((insn_queue_.count() + 6 + uop_queue_.reused_count()) * sizeof(VTAGenericInsn) >
+        VTA_MAX_XFER) {
       this->AutoSync();
     }
   }
-  // Auto sync when instruction overflow
-  void AutoSync() { this->Synchronize(1 << 31); }
+  // Auto sync when instruction overflow, the CPU does not need the results yet.
+  // The following streams continue on the SRAM contents, so the lease is kept.
+  void AutoSync() { this->Submit(1 << 31, false); }
 
   // Internal debug flag
   int debug_flag_{0};
   // The kernel we are currently recording
   UopKernel* record_kernel_{nullptr};
+  // Identity weight and micro-op of device copies, created on first use
+  DataBuffer* copy_wgt_{nullptr};
+  std::unique_ptr<UopKernel> copy_kernel_;
+  // Cache maintenance ranges waiting for the next submission or completion
+  CacheRangeBatch pending_flush_;
+  CacheRangeBatch pending_invalidate_;
+  // Work issued to the pipeline stages
+  VTAStageCounters stage_counters_{};
+  // Uop kernel cache statistics
+  uint64_t kernel_hits_{0};
+  uint64_t kernel_misses_{0};
+  // The device of the calling thread
+  static thread_local int current_device_id_;
+  // Command queues of all threads, keyed on thread and device id
+  static std::map<std::pair<std::thread::id, int>, std::shared_ptr<CommandQueue>> queues_;
+  static std::mutex queues_mutex_;
+  // Guards the kernel maps of the uop call sites
+  static std::mutex kernels_mutex_;
   // Micro op queue
   UopQueue<VTA_MAX_XFER, kBufferCoherent, kAlwaysCache> uop_queue_;
   // instruction queue
   InsnQueue<VTA_MAX_XFER, kBufferCoherent, kAlwaysCache> insn_queue_;
-  // Device handle
-  VTADeviceHandle device_{nullptr};
+  // The device shared with the queues of other threads
+  std::shared_ptr<DeviceContext> ctx_;
+  // Number of staging slots allocated up front, and the most the ring grows to
+  static constexpr uint32_t kNumSlots = VTA_CMD_QUEUE_SLOTS;
+  static constexpr uint32_t kMaxSlots = VTA_CMD_QUEUE_MAX_SLOTS;
+  static_assert(kMaxSlots >= kNumSlots, "VTA_CMD_QUEUE_MAX_SLOTS must cover VTA_CMD_QUEUE_SLOTS");
+  // The slot currently being recorded
+  uint32_t slot_{0};
+  // The last submission ticket of each slot
+  std::vector<uint64_t> slot_ticket_ = std::vector<uint64_t>(kNumSlots, 0);
+  // Background device execution, owned by ctx_
+  DeviceRunner* runner_{nullptr};
+  // Ticket of the last stream submitted by this queue
+  uint64_t last_ticket_{0};
+  // Whether submitted streams are being recorded
+  bool capturing_{false};
+  // Whether the recording can be replayed
+  bool capture_valid_{false};
+  // The graph being recorded
+  std::unique_ptr<CommandGraph> capture_graph_;
+  // Patches of the stream being recorded
+  CommandGraph::Stream capture_stream_;
 };
 
+thread_local int CommandQueue::current_device_id_ = 0;
+std::map<std::pair<std::thread::id, int>, std::shared_ptr<CommandQueue>> CommandQueue::queues_;
+std::mutex CommandQueue::queues_mutex_;
+std::mutex CommandQueue::kernels_mutex_;
+
 }  // namespace vta
 
 void* VTABufferAlloc(size_t size) { return vta::DataBuffer::Alloc(size); }
 
 void VTABufferFree(void* buffer) { vta::DataBuffer::Free(vta::DataBuffer::FromHandle(buffer)); }
 
+void* VTABufferPoolAlloc(size_t size) { return vta::DataBufferPool::Global()->Alloc(size); }
+
+void VTABufferPoolFree(void* buffer) {
+  vta::DataBufferPool::Global()->Free(vta::DataBuffer::FromHandle(buffer));
+}
+
+void VTABufferPoolRelease() { vta::DataBufferPool::Global()->Release(); }
+
+VTAParamArenaHandle VTAParamArenaCreate(size_t size) { return new vta::ParamArena(size); }
+
+void* VTAParamArenaAlloc(VTAParamArenaHandle arena, size_t size) {
+  return static_cast<vta::ParamArena*>(arena)->Alloc(size);
+}
+
+void VTAParamArenaRelease(VTAParamArenaHandle arena) {
+  static_cast<vta::ParamArena*>(arena)->Unref();
+}
+
+void VTABufferPoolStats(uint64_t* hits, uint64_t* misses, uint64_t* cached_buffers,
+                        uint64_t* cached_bytes) {
+  vta::DeviceAllocStat::PoolStats stats = vta::alloc_stat->GetPoolStats();
+  *hits = stats.hits;
+  *misses = stats.misses;
+  *cached_buffers = stats.cached_buffers;
+  *cached_bytes = stats.cached_bytes;
+}
+
 void VTABufferCopy(const void* from, size_t from_offset, void* to, size_t to_offset, size_t size,
                    int kind_mask) {
   vta::DataBuffer* from_buffer = nullptr;
@@ -1317,11 +3054,25 @@ void VTABufferCopy(const void* from, size_t from_offset, void* to, size_t to_off
     to = to_buffer->virt_addr();
   }
 
+  if (from_buffer && to_buffer) {
+    vta::CommandQueue* queue = vta::CommandQueue::ThreadLocal().get();
+    queue->InvalidateCapture();
+    // Ordered after the in-flight submissions by the device itself
+    if (queue->CopyOnDevice(from_buffer, from_offset, to_buffer, to_offset, size)) return;
+  }
+
+  if (from_buffer || to_buffer) {
+    // In-flight submissions may still read or write the device buffer
+    vta::CommandQueue::ThreadLocal()->Wait();
+    vta::CommandQueue::ThreadLocal()->InvalidateCapture();
+  }
+
   if (from_buffer) {
     // This is an FPGA to host mem transfer
     from_buffer->InvalidateCache(from_offset, size);
     from_buffer->MemCopyToHost(static_cast<char*>(to) + to_offset,
                                static_cast<const char*>(from) + from_offset, size);
+    if (to_buffer) to_buffer->FlushCache(to_offset, size);
   } else if (to_buffer) {
     // This is a host to FPGA mem transfer
     to_buffer->MemCopyFromHost(static_cast<char*>(to) + to_offset,
@@ -1330,9 +3081,34 @@ void VTABufferCopy(const void* from, size_t from_offset, void* to, size_t to_off
   }
 }
 
+void VTABufferSync(void* buffer, size_t offset, size_t size, int kind) {
+  vta::DataBuffer* data_buf = vta::DataBuffer::FromHandle(buffer);
+  CHECK(data_buf != nullptr) << "VTABufferSync expects a VTA data buffer";
+  // The CPU accesses the buffer directly, outside of any recorded graph
+  vta::CommandQueue::ThreadLocal()->InvalidateCapture();
+  if (kind == VTA_MEMCPY_H2D) {
+    data_buf->FlushCache(offset, size);
+  } else {
+    CHECK_EQ(kind, VTA_MEMCPY_D2H);
+    vta::CommandQueue::ThreadLocal()->Wait();
+    data_buf->InvalidateCache(offset, size);
+  }
+}
+
 VTACommandHandle VTATLSCommandHandle() { return vta::CommandQueue::ThreadLocal().get(); }
 
-void VTARuntimeShutdown() { vta::CommandQueue::Shutdown(); }
+void VTASetDevice(int device_id) { vta::CommandQueue::SetDevice(device_id); }
+
+VTACommandHandle VTADeviceCommandHandle(int device_id) {
+  return vta::CommandQueue::ForDevice(device_id).get();
+}
+
+void VTARuntimeShutdown() {
+  vta::CommandQueue::Shutdown();
+  vta::Tracer::Global()->WriteAtExit();
+}
+
+void VTATraceWrite(const char* path) { vta::Tracer::Global()->Write(path); }
 
 void VTASetDebugMode(VTACommandHandle cmd, int debug_flag) {
   static_cast<vta::CommandQueue*>(cmd)->SetDebugFlag(debug_flag);
@@ -1341,6 +3117,8 @@ void VTASetDebugMode(VTACommandHandle cmd, int debug_flag) {
 void* VTABufferCPUPtr(VTACommandHandle cmd, void* buffer) {
   auto data_buf = vta::DataBuffer::FromHandle(buffer);
   if (data_buf) {
+    // CPU work on device buffers is not part of a recorded graph
+    static_cast<vta::CommandQueue*>(cmd)->InvalidateCapture();
     return data_buf->virt_addr();
   } else {  // it is a raw ptr allocated by CPU
     return buffer;
@@ -1410,3 +3188,44 @@ int VTADepPop(VTACommandHandle cmd, int from_qid, int to_qid) {
 void VTASynchronize(VTACommandHandle cmd, uint32_t wait_cycles) {
   static_cast<vta::CommandQueue*>(cmd)->Synchronize(wait_cycles);
 }
+
+void VTASubmit(VTACommandHandle cmd, uint32_t wait_cycles) {
+  static_cast<vta::CommandQueue*>(cmd)->Submit(wait_cycles);
+}
+
+void VTAWait(VTACommandHandle cmd) { static_cast<vta::CommandQueue*>(cmd)->Wait(); }
+
+void VTACaptureBegin(VTACommandHandle cmd) { static_cast<vta::CommandQueue*>(cmd)->CaptureBegin(); }
+
+VTAGraphHandle VTACaptureEnd(VTACommandHandle cmd) {
+  return static_cast<vta::CommandQueue*>(cmd)->CaptureEnd();
+}
+
+void VTAGraphAppend(VTAGraphHandle graph, VTAGraphHandle other) {
+  static_cast<vta::CommandGraph*>(graph)->Append(static_cast<vta::CommandGraph*>(other));
+  delete static_cast<vta::CommandGraph*>(other);
+}
+
+int VTAGraphRebind(VTAGraphHandle graph, void* old_buffer, void* new_buffer) {
+  vta::DataBuffer* old_buf = vta::DataBuffer::FromHandle(old_buffer);
+  vta::DataBuffer* new_buf = vta::DataBuffer::FromHandle(new_buffer);
+  // A freed buffer may have been reallocated to an unrelated tensor
+  if (old_buf == nullptr || new_buf == nullptr) return -1;
+  static_cast<vta::CommandGraph*>(graph)->Rebind(old_buf, new_buf);
+  return 0;
+}
+
+void VTAGraphLaunch(VTACommandHandle cmd, VTAGraphHandle graph, uint32_t wait_cycles) {
+  static_cast<vta::CommandQueue*>(cmd)->LaunchGraph(static_cast<vta::CommandGraph*>(graph),
+                                                    wait_cycles);
+}
+
+void VTAGraphFree(VTAGraphHandle graph) { delete static_cast<vta::CommandGraph*>(graph); }
+
+void VTAUopKernelCacheStats(VTACommandHandle cmd, uint64_t* hits, uint64_t* misses) {
+  static_cast<vta::CommandQueue*>(cmd)->GetKernelCacheStats(hits, misses);
+}
+
+void VTAGetStageCounters(VTACommandHandle cmd, VTAStageCounters* counters) {
+  static_cast<vta::CommandQueue*>(cmd)->GetStageCounters(counters);
+}
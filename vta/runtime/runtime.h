@@ -41,9 +41,94 @@ extern "C" {
 #define VTA_DEBUG_SKIP_READ_BARRIER (1 << 3)
 #define VTA_DEBUG_SKIP_WRITE_BARRIER (1 << 4)
 #define VTA_DEBUG_FORCE_SERIAL (1 << 5)
+/*! \brief Not a debug flag: run the peephole optimizer over instruction streams. */
+#define VTA_OPT_INSN_PEEPHOLE (1 << 6)
+/*! \brief Record a host side timeline, see VTATraceWrite. */
+#define VTA_DEBUG_TRACE (1 << 7)
+/*! \brief Not a debug flag: start the loads of a replayed stream during the previous stores. */
+#define VTA_OPT_GRAPH_PREFETCH (1 << 8)
+/*! \brief Keep the recorded micro-ops of kernels as pushed, see UopKernel::Compress. */
+#define VTA_DEBUG_SKIP_UOP_COMPRESS (1 << 9)
 
 #define ALLOC_ALIGNMENT 64
 
+/*!
+ * \brief Number of instruction/uop staging slots used by the command queue.
+ *  With more than one slot, the host records the next instruction stream
+ *  while the accelerator executes the previous one.
+ */
+#ifndef VTA_CMD_QUEUE_SLOTS
+#define VTA_CMD_QUEUE_SLOTS 2
+#endif
+
+/*!
+ * \brief Maximum number of staging slots. When every slot holds a stream in flight,
+ *  for instance because a large layer overflowed VTA_MAX_XFER several times, new
+ *  slots are allocated up to this limit instead of waiting for the device.
+ */
+#ifndef VTA_CMD_QUEUE_MAX_SLOTS
+#define VTA_CMD_QUEUE_MAX_SLOTS 8
+#endif
+
+/*!
+ * \brief Largest request in bytes served by the data buffer pool,
+ *  larger buffers always go to the driver.
+ */
+#ifndef VTA_BUFFER_POOL_MAX_BYTES
+#define VTA_BUFFER_POOL_MAX_BYTES (64 << 20)
+#endif
+
+/*! \brief Maximum number of bytes the data buffer pool keeps for reuse. */
+#ifndef VTA_BUFFER_POOL_CACHE_BYTES
+#define VTA_BUFFER_POOL_CACHE_BYTES (256 << 20)
+#endif
+
+/*!
+ * \brief Longest expected device wait, in nanoseconds, for which a waiting host
+ *  thread spins instead of sleeping. The expected wait is learned from the
+ *  duration of previous device runs. Set to 0 to always sleep.
+ */
+#ifndef VTA_WAIT_SPIN_NS
+#define VTA_WAIT_SPIN_NS 50000
+#endif
+
+/*!
+ * \brief Whether the driver launches instruction streams without waiting for them,
+ *  see VTADeviceLaunch. The device runner then keeps up to VTA_DEVICE_MAX_LAUNCHES
+ *  streams queued on the device, which starts a stream as soon as the previous one
+ *  finishes instead of after a round trip to the host.
+ */
+#ifndef VTA_DEVICE_ASYNC
+#define VTA_DEVICE_ASYNC 0
+#endif
+
+/*! \brief Maximum number of streams launched on an asynchronous driver at a time. */
+#ifndef VTA_DEVICE_MAX_LAUNCHES
+#define VTA_DEVICE_MAX_LAUNCHES 2
+#endif
+
+#if VTA_DEVICE_ASYNC
+/*!
+ * \brief Launch an instruction stream without waiting for it to finish. Provided by the
+ *  drivers built with VTA_DEVICE_ASYNC, the launches run in order.
+ * \param device The device handle.
+ * \param insn_phy_addr The physical address of the instruction stream.
+ * \param insn_count The number of instructions.
+ * \return The id of the launch, negative if the launch failed.
+ */
+int64_t VTADeviceLaunch(VTADeviceHandle device, vta_phy_addr_t insn_phy_addr,
+                        uint32_t insn_count);
+
+/*!
+ * \brief Wait for a launch to finish, and with it every earlier launch.
+ * \param device The device handle.
+ * \param launch The id of the launch.
+ * \param wait_cycles The limit of poll cycles.
+ * \return 0 if the launch finished, non-zero if it timed out or failed.
+ */
+int VTADeviceSync(VTADeviceHandle device, int64_t launch, uint32_t wait_cycles);
+#endif
+
 /*!
  * \brief Allocate data buffer.
  * \param size Buffer size.
@@ -57,8 +142,70 @@ TVM_DLL void* VTABufferAlloc(size_t size);
  */
 TVM_DLL void VTABufferFree(void* buffer);
 
+/*!
+ * \brief Allocate data buffer from the buffer pool.
+ *  The size is rounded up to a size class and cached buffers are reused.
+ * \param size Buffer size.
+ * \return A pointer to the allocated buffer.
+ */
+TVM_DLL void* VTABufferPoolAlloc(size_t size);
+
+/*!
+ * \brief Return a data buffer allocated by VTABufferPoolAlloc to the pool.
+ * \param buffer The data buffer to be freed.
+ */
+TVM_DLL void VTABufferPoolFree(void* buffer);
+
+/*!
+ * \brief Free all buffers cached by the buffer pool.
+ */
+TVM_DLL void VTABufferPoolRelease();
+
+/*!
+ * \brief Get the statistics of the buffer pool.
+ * \param hits Number of allocations served from cached buffers.
+ * \param misses Number of allocations that went to the driver.
+ * \param cached_buffers Number of buffers currently cached.
+ * \param cached_bytes Number of bytes currently cached.
+ */
+TVM_DLL void VTABufferPoolStats(uint64_t* hits, uint64_t* misses, uint64_t* cached_buffers,
+                                uint64_t* cached_bytes);
+
+/*! \brief Handle of a parameter arena */
+typedef void* VTAParamArenaHandle;
+
+/*!
+ * \brief Allocate a parameter arena, one contiguous region of device memory
+ *  kept for the lifetime of a model.
+ * \param size The capacity of the arena in bytes.
+ * \return The arena handle.
+ */
+TVM_DLL VTAParamArenaHandle VTAParamArenaCreate(size_t size);
+
+/*!
+ * \brief Allocate a data buffer in a parameter arena.
+ *
+ *  The buffer is meant to be written once by the host, through VTABufferCopy,
+ *  and then only read by VTA. Read barriers on it do not flush the cache.
+ *  It is freed with VTABufferFree or VTABufferPoolFree.
+ * \param arena The arena handle.
+ * \param size Buffer size.
+ * \return A pointer to the allocated buffer, nullptr if the arena is full.
+ */
+TVM_DLL void* VTAParamArenaAlloc(VTAParamArenaHandle arena, size_t size);
+
+/*!
+ * \brief Release a parameter arena. Its memory is returned to the driver
+ *  once all of its buffers are freed as well.
+ * \param arena The arena handle.
+ */
+TVM_DLL void VTAParamArenaRelease(VTAParamArenaHandle arena);
+
 /*!
  * \brief Copy data buffer from one location to another.
+ *
+ *  Copies between two device buffers whose offsets and size are multiples of
+ *  the input element size run as VTA instructions and return without waiting.
  * \param from The source buffer base address.
  * \param from_offset The offset of the source buffer.
  * \param to The target buffer base address.
@@ -72,15 +219,49 @@ TVM_DLL void VTABufferCopy(const void* from, size_t from_offset, void* to, size_
 /*! \brief VTA command handle */
 typedef void* VTACommandHandle;
 
-/*! \brief Shutdown hook of VTA to cleanup resources */
+/*! \brief Handle of a recorded VTA instruction stream */
+typedef void* VTAGraphHandle;
+
+/*!
+ * \brief Shutdown hook of VTA to cleanup resources.
+ *
+ *  Writes the timeline recorded with VTA_DEBUG_TRACE, if any, to the file
+ *  named by the VTA_TRACE_FILE environment variable, vta_trace.json by default.
+ */
 TVM_DLL void VTARuntimeShutdown();
 
+/*!
+ * \brief Write the timeline recorded by queues with VTA_DEBUG_TRACE set.
+ *
+ *  The file uses the Chrome trace event format and can be opened in chrome://tracing.
+ * \param path The file to write.
+ */
+TVM_DLL void VTATraceWrite(const char* path);
+
 /*!
  * \brief Get thread local command handle.
- * \return A thread local command handle.
+ *
+ *  Every host thread records into its own command queue, the finished streams
+ *  of all threads are interleaved on the shared device.
+ * \return The command handle of the current device of the calling thread.
  */
 TVM_DLL VTACommandHandle VTATLSCommandHandle();
 
+/*!
+ * \brief Set the current device of the calling thread.
+ *  Each device has its own command queue and device handle from VTADeviceAlloc,
+ *  so several accelerators can be driven from one process.
+ * \param device_id The device id, the default device is 0.
+ */
+TVM_DLL void VTASetDevice(int device_id);
+
+/*!
+ * \brief Get the command handle of the calling thread for a device.
+ * \param device_id The device id.
+ * \return The command handle of the device.
+ */
+TVM_DLL VTACommandHandle VTADeviceCommandHandle(int device_id);
+
 /*!
  * \brief Get the buffer access pointer on CPU.
  * \param cmd The VTA command handle.
@@ -89,8 +270,22 @@ TVM_DLL VTACommandHandle VTATLSCommandHandle();
  */
 TVM_DLL void* VTABufferCPUPtr(VTACommandHandle cmd, void* buffer);
 
+/*!
+ * \brief Make CPU accesses through VTABufferCPUPtr coherent with the device.
+ *  With VTA_MEMCPY_H2D, CPU writes to the region are flushed so the device sees them.
+ *  With VTA_MEMCPY_D2H, in-flight device work is waited for and the region is
+ *  invalidated so the CPU sees the device writes.
+ * \param buffer The data buffer.
+ * \param offset The offset of the region in bytes.
+ * \param size The size of the region in bytes.
+ * \param kind VTA_MEMCPY_H2D or VTA_MEMCPY_D2H.
+ */
+TVM_DLL void VTABufferSync(void* buffer, size_t offset, size_t size, int kind);
+
 /*!
  * \brief Perform a write barrier to make a memory region visible to the CPU.
+ *  While instructions are pending, the cache invalidation is batched with other
+ *  barriers and applied once the device finishes, in VTASynchronize or VTAWait.
  * \param cmd The VTA command handle.
  * \param buffer The head buffer pointer.
  * \param elem_bits The size in bits of each element.
@@ -102,6 +297,7 @@ TVM_DLL void VTAWriteBarrier(VTACommandHandle cmd, void* buffer, uint32_t elem_b
 
 /*!
  * \brief Perform a read barrier to a memory region visible to VTA.
+ *  The cache flush is batched with other barriers and applied on the next submission.
  * \param cmd The VTA command handle.
  * \param buffer The head buffer pointer.
  * \param elem_bits The unit bits of each elements.
@@ -226,6 +422,43 @@ TVM_DLL int VTAPushGEMMOp(void** uop_handle, int (*finit)(void*), void* signatur
  */
 TVM_DLL int VTAPushALUOp(void** uop_handle, int (*finit)(void*), void* signature, int nbytes);
 
+/*!
+ * \brief Get the statistics of the uop kernel cache.
+ *  A miss means the kernel was recorded by calling its initialization function.
+ * \param cmd The VTA command handle.
+ * \param hits Number of kernel lookups served from the cache.
+ * \param misses Number of kernel lookups that recorded a new kernel.
+ */
+TVM_DLL void VTAUopKernelCacheStats(VTACommandHandle cmd, uint64_t* hits, uint64_t* misses);
+
+/*!
+ * \brief Work submitted to each VTA pipeline stage, accumulated since the command queue
+ *  was created. The counts are derived from the submitted instruction streams.
+ */
+typedef struct {
+  /*! \brief Bytes read from DRAM by the load stage (input and weight). */
+  uint64_t load_bytes;
+  /*! \brief Bytes read from DRAM by the compute stage (uop and accumulator). */
+  uint64_t compute_load_bytes;
+  /*! \brief Micro-ops executed by GEMM instructions, including loop iterations. */
+  uint64_t gemm_uops;
+  /*! \brief Micro-ops executed by ALU instructions, including loop iterations. */
+  uint64_t alu_uops;
+  /*! \brief Bytes written to DRAM by the store stage. */
+  uint64_t store_bytes;
+  /*! \brief Number of instruction streams run on the device. */
+  uint64_t device_runs;
+  /*! \brief Wall-clock time spent in VTADeviceRun, in nanoseconds. */
+  uint64_t device_busy_ns;
+} VTAStageCounters;
+
+/*!
+ * \brief Get the stage work counters of a command queue.
+ * \param cmd The VTA command handle.
+ * \param counters The counters to be filled.
+ */
+TVM_DLL void VTAGetStageCounters(VTACommandHandle cmd, VTAStageCounters* counters);
+
 /*!
  * \brief Push dependence token.
  * \param cmd The VTA command handle.
@@ -255,6 +488,71 @@ TVM_DLL int VTADepPop(VTACommandHandle cmd, int from_qid, int to_qid);
  */
 TVM_DLL void VTASynchronize(VTACommandHandle cmd, uint32_t wait_cycles);
 
+/*!
+ * \brief Submit the recorded instructions to VTA without waiting for completion.
+ *  The command handle switches to the next staging slot, so recording can
+ *  continue while the accelerator runs. Call VTAWait before the CPU accesses
+ *  any buffer written by the submitted instructions.
+ * \param cmd The VTA command handle.
+ * \param wait_cycles The limit of poll cycles.
+ */
+TVM_DLL void VTASubmit(VTACommandHandle cmd, uint32_t wait_cycles);
+
+/*!
+ * \brief Wait until all instructions submitted through the command handle finish.
+ * \param cmd The VTA command handle.
+ */
+TVM_DLL void VTAWait(VTACommandHandle cmd);
+
+/*!
+ * \brief Start recording the instruction streams submitted through the command handle.
+ *  The instructions still execute while being recorded.
+ * \param cmd The VTA command handle.
+ */
+TVM_DLL void VTACaptureBegin(VTACommandHandle cmd);
+
+/*!
+ * \brief Stop recording and return the recorded graph.
+ *  Recording is invalidated if the CPU accessed a VTA buffer in the meantime,
+ *  since that work would be lost on replay.
+ * \param cmd The VTA command handle.
+ * \return The recorded graph, or NULL if nothing replayable was recorded.
+ */
+TVM_DLL VTAGraphHandle VTACaptureEnd(VTACommandHandle cmd);
+
+/*!
+ * \brief Append the streams of one graph to another, the source graph is freed.
+ *  Graphs appended together are replayed with as few device runs as possible.
+ * \param graph The destination graph.
+ * \param other The graph to be appended and freed.
+ */
+TVM_DLL void VTAGraphAppend(VTAGraphHandle graph, VTAGraphHandle other);
+
+/*!
+ * \brief Redirect the DRAM accesses of a graph from one data buffer to another.
+ * \param graph The recorded graph.
+ * \param old_buffer The data buffer used while recording.
+ * \param new_buffer The data buffer to use on replay.
+ * \return 0 if the graph was redirected, -1 if a buffer is not a live VTA data buffer,
+ *  in which case the graph has to be recorded again.
+ */
+TVM_DLL int VTAGraphRebind(VTAGraphHandle graph, void* old_buffer, void* new_buffer);
+
+/*!
+ * \brief Submit a recorded graph without re-generating its instructions.
+ *  Like VTASubmit, call VTAWait before the CPU accesses the results.
+ * \param cmd The VTA command handle.
+ * \param graph The recorded graph.
+ * \param wait_cycles The limit of poll cycles.
+ */
+TVM_DLL void VTAGraphLaunch(VTACommandHandle cmd, VTAGraphHandle graph, uint32_t wait_cycles);
+
+/*!
+ * \brief Free a recorded graph.
+ * \param graph The recorded graph.
+ */
+TVM_DLL void VTAGraphFree(VTAGraphHandle graph);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,399 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file oclfpga_device_test.cc
+ * \brief Host-side tests of the oclfpga driver, against a mock of the OpenCL API defined
+ *  below in place of libOpenCL.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/registry.h>
+
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>
+
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "runtime.h"
+
+struct _cl_platform_id {};
+struct _cl_device_id {};
+struct _cl_context {};
+struct _cl_program {};
+struct _cl_command_queue {};
+
+struct _cl_mem {
+  std::vector<char> data;
+};
+
+struct _cl_kernel {
+  std::string name;
+  std::map<cl_uint, std::vector<char>> args;
+};
+
+struct _cl_event {
+  int refs;
+  cl_int status;
+};
+
+namespace {
+
+/*! \brief A kernel enqueued by clEnqueueTask. */
+struct MockTask {
+  std::string name;
+  // The arguments of the kernel when it was enqueued
+  std::map<cl_uint, std::vector<char>> args;
+  std::vector<cl_event> wait_list;
+  cl_event event;
+};
+
+/*! \brief The state of the mock, the OpenCL objects are never deleted so that they outlive
+ *  the driver's references. */
+struct MockCL {
+  _cl_platform_id platform;
+  _cl_device_id device;
+  _cl_context context;
+  _cl_program program;
+  std::deque<_cl_command_queue> queues;
+  std::deque<_cl_kernel> kernels;
+  std::deque<_cl_event> events;
+  // The device memory, the only buffer created without a host pointer
+  _cl_mem* dram{nullptr};
+  std::vector<MockTask> tasks;
+  // Status of the events of the next tasks
+  cl_int task_status{CL_COMPLETE};
+  // Index of the next task whose enqueue fails, -1 for none
+  int fail_task{-1};
+
+  cl_event NewEvent(cl_int status) {
+    events.push_back(_cl_event{1, status});
+    return &events.back();
+  }
+};
+
+MockCL* Mock() {
+  static MockCL* mock = new MockCL();
+  return mock;
+}
+
+}  // namespace
+
+extern "C" {
+
+cl_int clGetPlatformIDs(cl_uint num_entries, cl_platform_id* platforms, cl_uint* num_platforms) {
+  if (platforms != nullptr && num_entries > 0) platforms[0] = &Mock()->platform;
+  if (num_platforms != nullptr) *num_platforms = 1;
+  return CL_SUCCESS;
+}
+
+cl_int clGetPlatformInfo(cl_platform_id platform, cl_platform_info param_name,
+                         size_t param_value_size, void* param_value,
+                         size_t* param_value_size_ret) {
+  const char name[] = "Intel(R) FPGA SDK for OpenCL(TM)";
+  if (param_value != nullptr) {
+    strncpy(static_cast<char*>(param_value), name, param_value_size);
+  }
+  if (param_value_size_ret != nullptr) *param_value_size_ret = sizeof(name);
+  return CL_SUCCESS;
+}
+
+cl_int clGetDeviceIDs(cl_platform_id platform, cl_device_type device_type, cl_uint num_entries,
+                      cl_device_id* devices, cl_uint* num_devices) {
+  if (devices != nullptr && num_entries > 0) devices[0] = &Mock()->device;
+  if (num_devices != nullptr) *num_devices = 1;
+  return CL_SUCCESS;
+}
+
+cl_context clCreateContext(const cl_context_properties* properties, cl_uint num_devices,
+                           const cl_device_id* devices,
+                           void (*pfn_notify)(const char*, const void*, size_t, void*),
+                           void* user_data, cl_int* errcode_ret) {
+  *errcode_ret = CL_SUCCESS;
+  return &Mock()->context;
+}
+
+cl_program clCreateProgramWithBinary(cl_context context, cl_uint num_devices,
+                                     const cl_device_id* device_list, const size_t* lengths,
+                                     const unsigned char** binaries, cl_int* binary_status,
+                                     cl_int* errcode_ret) {
+  *errcode_ret = CL_SUCCESS;
+  return &Mock()->program;
+}
+
+cl_int clBuildProgram(cl_program program, cl_uint num_devices, const cl_device_id* device_list,
+                      const char* options, void (*pfn_notify)(cl_program, void*),
+                      void* user_data) {
+  return CL_SUCCESS;
+}
+
+cl_int clGetProgramBuildInfo(cl_program program, cl_device_id device,
+                             cl_program_build_info param_name, size_t param_value_size,
+                             void* param_value, size_t* param_value_size_ret) {
+  if (param_value_size_ret != nullptr) *param_value_size_ret = 0;
+  return CL_SUCCESS;
+}
+
+cl_kernel clCreateKernel(cl_program program, const char* kernel_name, cl_int* errcode_ret) {
+  Mock()->kernels.push_back(_cl_kernel{kernel_name, {}});
+  *errcode_ret = CL_SUCCESS;
+  return &Mock()->kernels.back();
+}
+
+cl_command_queue clCreateCommandQueue(cl_context context, cl_device_id device,
+                                      cl_command_queue_properties properties,
+                                      cl_int* errcode_ret) {
+  Mock()->queues.emplace_back();
+  *errcode_ret = CL_SUCCESS;
+  return &Mock()->queues.back();
+}
+
+cl_mem clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size, void* host_ptr,
+                      cl_int* errcode_ret) {
+  cl_mem mem = new _cl_mem{std::vector<char>(size, 0)};
+  if (!(flags & CL_MEM_ALLOC_HOST_PTR)) Mock()->dram = mem;
+  *errcode_ret = CL_SUCCESS;
+  return mem;
+}
+
+void* clEnqueueMapBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_map,
+                         cl_map_flags map_flags, size_t offset, size_t size,
+                         cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+                         cl_event* event, cl_int* errcode_ret) {
+  *errcode_ret = CL_SUCCESS;
+  return buffer->data.data() + offset;
+}
+
+cl_int clEnqueueUnmapMemObject(cl_command_queue command_queue, cl_mem memobj, void* mapped_ptr,
+                               cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+                               cl_event* event) {
+  return CL_SUCCESS;
+}
+
+cl_int clEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write,
+                            size_t offset, size_t size, const void* ptr,
+                            cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+                            cl_event* event) {
+  memcpy(buffer->data.data() + offset, ptr, size);
+  if (event != nullptr) *event = Mock()->NewEvent(CL_COMPLETE);
+  return CL_SUCCESS;
+}
+
+cl_int clEnqueueReadBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read,
+                           size_t offset, size_t size, void* ptr, cl_uint num_events_in_wait_list,
+                           const cl_event* event_wait_list, cl_event* event) {
+  memcpy(ptr, buffer->data.data() + offset, size);
+  if (event != nullptr) *event = Mock()->NewEvent(CL_COMPLETE);
+  return CL_SUCCESS;
+}
+
+cl_int clSetKernelArg(cl_kernel kernel, cl_uint arg_index, size_t arg_size,
+                      const void* arg_value) {
+  const char* value = static_cast<const char*>(arg_value);
+  kernel->args[arg_index] = std::vector<char>(value, value + arg_size);
+  return CL_SUCCESS;
+}
+
+cl_int clEnqueueTask(cl_command_queue command_queue, cl_kernel kernel,
+                     cl_uint num_events_in_wait_list, const cl_event* event_wait_list,
+                     cl_event* event) {
+  MockCL* mock = Mock();
+  if (static_cast<int>(mock->tasks.size()) == mock->fail_task) return CL_OUT_OF_RESOURCES;
+  MockTask task{kernel->name, kernel->args,
+                std::vector<cl_event>(event_wait_list, event_wait_list + num_events_in_wait_list),
+                mock->NewEvent(mock->task_status)};
+  mock->tasks.push_back(task);
+  *event = task.event;
+  return CL_SUCCESS;
+}
+
+cl_int clFlush(cl_command_queue command_queue) { return CL_SUCCESS; }
+
+cl_int clFinish(cl_command_queue command_queue) { return CL_SUCCESS; }
+
+cl_int clWaitForEvents(cl_uint num_events, const cl_event* event_list) { return CL_SUCCESS; }
+
+cl_int clGetEventInfo(cl_event event, cl_event_info param_name, size_t param_value_size,
+                      void* param_value, size_t* param_value_size_ret) {
+  *static_cast<cl_int*>(param_value) = event->status;
+  return CL_SUCCESS;
+}
+
+cl_int clRetainEvent(cl_event event) {
+  ++event->refs;
+  return CL_SUCCESS;
+}
+
+cl_int clReleaseEvent(cl_event event) {
+  EXPECT_GT(event->refs, 0) << "Event released more than retained";
+  --event->refs;
+  return CL_SUCCESS;
+}
+
+cl_int clReleaseMemObject(cl_mem memobj) {
+  if (memobj == Mock()->dram) Mock()->dram = nullptr;
+  delete memobj;
+  return CL_SUCCESS;
+}
+
+cl_int clReleaseKernel(cl_kernel kernel) { return CL_SUCCESS; }
+
+cl_int clReleaseProgram(cl_program program) { return CL_SUCCESS; }
+
+cl_int clReleaseCommandQueue(cl_command_queue command_queue) { return CL_SUCCESS; }
+
+cl_int clReleaseContext(cl_context context) { return CL_SUCCESS; }
+}
+
+namespace {
+
+const size_t kMemSize = 4096;
+
+class OCLFPGADeviceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    MockCL* mock = Mock();
+    mock->tasks.clear();
+    mock->task_status = CL_COMPLETE;
+    mock->fail_task = -1;
+    std::string bitstream = "oclfpga_device_test.aocx";
+    std::ofstream(bitstream, std::ios::binary) << "aocx";
+    // Reprogramming releases the objects of the previous test
+    const tvm::runtime::PackedFunc* program = tvm::runtime::Registry::Get("vta.oclfpga.program");
+    (*program)(bitstream, static_cast<int64_t>(kMemSize));
+    ASSERT_NE(mock->dram, nullptr);
+    device_ = VTADeviceAlloc();
+  }
+
+  void TearDown() override { VTADeviceFree(device_); }
+
+  // The device memory at a physical address
+  char* Dram(vta_phy_addr_t phy_addr) { return Mock()->dram->data.data() + phy_addr; }
+
+  VTADeviceHandle device_;
+};
+
+TEST_F(OCLFPGADeviceTest, MemAllocFirstFit) {
+  char* a = static_cast<char*>(VTAMemAlloc(100, 0));
+  char* b = static_cast<char*>(VTAMemAlloc(64, 0));
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  // The allocations are aligned to the memory interface
+  EXPECT_EQ(VTAMemGetPhyAddr(a), 0U);
+  EXPECT_EQ(VTAMemGetPhyAddr(b), 128U);
+  EXPECT_EQ(VTAMemGetPhyAddr(b + 10), 138U);
+  EXPECT_EQ(VTAMemAlloc(kMemSize, 0), nullptr);
+
+  // A freed range is reused, then merged with its neighbors
+  VTAMemFree(a);
+  char* c = static_cast<char*>(VTAMemAlloc(128, 0));
+  EXPECT_EQ(VTAMemGetPhyAddr(c), 0U);
+  VTAMemFree(c);
+  VTAMemFree(b);
+  void* all = VTAMemAlloc(kMemSize, 0);
+  ASSERT_NE(all, nullptr);
+  EXPECT_EQ(VTAMemGetPhyAddr(all), 0U);
+  VTAMemFree(all);
+
+  char local = 0;
+  EXPECT_ANY_THROW(VTAMemGetPhyAddr(&local));
+  EXPECT_ANY_THROW(VTAMemFree(&local));
+}
+
+TEST_F(OCLFPGADeviceTest, FlushAndInvalidate) {
+  char* buf = static_cast<char*>(VTAMemAlloc(256, 0));
+  vta_phy_addr_t phy_addr = VTAMemGetPhyAddr(buf);
+  for (int i = 0; i < 256; ++i) buf[i] = static_cast<char>(i);
+  VTAFlushCache(buf + 16, phy_addr + 16, 32);
+  EXPECT_EQ(memcmp(Dram(phy_addr + 16), buf + 16, 32), 0);
+  EXPECT_EQ(Dram(phy_addr)[0], 0);
+  EXPECT_EQ(Dram(phy_addr + 48)[0], 0);
+
+  memset(Dram(phy_addr), 7, 256);
+  VTAInvalidateCache(buf, phy_addr, 64);
+  EXPECT_EQ(buf[0], 7);
+  EXPECT_EQ(buf[63], 7);
+  EXPECT_EQ(buf[64], 64);
+  VTAMemFree(buf);
+}
+
+TEST_F(OCLFPGADeviceTest, LaunchAfterWrites) {
+  char* insns = static_cast<char*>(VTAMemAlloc(256, 0));
+  vta_phy_addr_t phy_addr = VTAMemGetPhyAddr(insns);
+  VTAFlushCache(insns, phy_addr, 256);
+  int64_t first = VTADeviceLaunch(device_, phy_addr, 16);
+  int64_t second = VTADeviceLaunch(device_, phy_addr + 128, 8);
+  EXPECT_GT(first, 0);
+  EXPECT_EQ(second, first + 1);
+
+  // Each launch enqueues the kernels of the modules in order, behind the write
+  const std::vector<MockTask>& tasks = Mock()->tasks;
+  const char* names[] = {"vta_fetch", "vta_load", "vta_compute", "vta_store"};
+  ASSERT_EQ(tasks.size(), 8U);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    EXPECT_EQ(tasks[i].name, names[i % 4]);
+    ASSERT_EQ(tasks[i].wait_list.size(), 1U);
+    EXPECT_EQ(tasks[i].wait_list[0]->status, CL_COMPLETE);
+  }
+  cl_uint insn_addr, insn_count;
+  memcpy(&insn_addr, tasks[4].args.at(0).data(), sizeof(insn_addr));
+  memcpy(&insn_count, tasks[4].args.at(1).data(), sizeof(insn_count));
+  EXPECT_EQ(insn_addr, phy_addr + 128);
+  EXPECT_EQ(insn_count, 8U);
+
+  // Waiting for the second launch waits for the first, and releases their events
+  EXPECT_EQ(VTADeviceSync(device_, second, 100), 0);
+  for (const MockTask& task : tasks) EXPECT_EQ(task.event->refs, 0);
+  EXPECT_EQ(VTADeviceRun(device_, phy_addr, 16, 100), 0);
+  VTAMemFree(insns);
+}
+
+TEST_F(OCLFPGADeviceTest, SyncTimeoutAndFailure) {
+  Mock()->task_status = CL_RUNNING;
+  int64_t launch = VTADeviceLaunch(device_, 0, 1);
+  EXPECT_EQ(VTADeviceSync(device_, launch, 10), 1);
+  Mock()->task_status = CL_OUT_OF_RESOURCES;
+  launch = VTADeviceLaunch(device_, 0, 1);
+  EXPECT_EQ(VTADeviceSync(device_, launch, 10), 1);
+  for (const MockTask& task : Mock()->tasks) EXPECT_EQ(task.event->refs, 0);
+}
+
+TEST_F(OCLFPGADeviceTest, LaunchFailure) {
+  Mock()->fail_task = 2;
+  EXPECT_LT(VTADeviceLaunch(device_, 0, 1), 0);
+  // The kernels enqueued before the failure are not waited for
+  for (const MockTask& task : Mock()->tasks) EXPECT_EQ(task.event->refs, 0);
+  Mock()->fail_task = -1;
+  int64_t launch = VTADeviceLaunch(device_, 0, 1);
+  EXPECT_GT(launch, 0);
+  EXPECT_EQ(VTADeviceSync(device_, launch, 10), 0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  testing::FLAGS_gtest_death_test_style = "threadsafe";
+  return RUN_ALL_TESTS();
+}
@@ -182,7 +182,7 @@ def run_conv2d(env, remote, wl, target, check_correctness=True, print_ir=False,
             env.INP_WIDTH + env.WGT_WIDTH - 2
         )
         a_np = np.random.randint(a_min, a_max, size=a_shape).astype(data.dtype)
-        w_np = np.random.randint(w_min, w_max, size=w_shape).astype(kernel.dtype)
+        w_np = np.random.randint(w_min, w_max, size=w_shape).astype("int8")
         b_np = np.random.randint(b_min, b_max, size=b_shape).astype(env.acc_dtype)
         r_np = tvm.topi.testing.conv2d_nchw_python(
             a_np.astype(env.acc_dtype),
@@ -232,7 +232,11 @@ def run_conv2d(env, remote, wl, target, check_correctness=True, print_ir=False,
 
     res_np = np.zeros(topi.utils.get_const_tuple(res.shape)).astype(res.dtype)
     data_arr = tvm.nd.array(data_np, dev)
-    kernel_arr = tvm.nd.array(kernel_np, dev)
+    if "vta" in target.keys:
+        # The weights narrower than 8 bits are bit packed as VTA loads them
+        kernel_arr = vta.top.bitpack.bitpack_array(kernel_np, kernel.dtype, dev)
+    else:
+        kernel_arr = tvm.nd.array(kernel_np, dev)
     bias_arr = tvm.nd.array(bias_np, dev)
     res_arr = tvm.nd.array(res_np, dev)
     time_f = f.time_evaluator("conv2d", dev, number=samples)
@@ -89,7 +89,7 @@ def _find_factors(n):
 
 
 def run_conv2d_transpose(
-    env, remote, wl, target, check_correctness=True, print_ir=False, samples=4
+    env, remote, wl, target, check_correctness=True, print_ir=False, samples=4, subpixel=False
 ):
 
     # Workload assertions
@@ -106,6 +106,9 @@ def run_conv2d_transpose(
         layout = "NCHW%dn%dc" % (env.BATCH, env.BLOCK_IN)
         fcompute = vta.top.conv2d_transpose_packed
         fschedule = vta.top.schedule_conv2d_transpose_packed
+        if subpixel:
+            fcompute = vta.top.conv2d_transpose_subpixel_packed
+            fschedule = vta.top.schedule_conv2d_transpose_subpixel_packed
 
     # Derive shapes depending upon packing
 
@@ -295,6 +298,8 @@ def test_conv2d_transpose(device):
             for _, wl in dcgan_wklds:
                 print(wl)
                 run_conv2d_transpose(env, remote, wl, target)
+                if device == "vta":
+                    run_conv2d_transpose(env, remote, wl, target, subpixel=True)
 
     vta.testing.run(_run)
 
@@ -105,7 +105,7 @@ def run_gemm(
         a_min, a_max = 0 - (1 << (env.INP_WIDTH - 1)), (1 << (env.INP_WIDTH - 1))
         w_min, w_max = 0 - (1 << (env.WGT_WIDTH - 1)), (1 << (env.WGT_WIDTH - 1))
         a_np = np.random.randint(a_min, a_max, size=a_shape).astype(data.dtype)
-        w_np = np.random.randint(w_min, w_max, size=w_shape).astype(kernel.dtype)
+        w_np = np.random.randint(w_min, w_max, size=w_shape).astype("int8")
 
         r_np = np.dot(a_np.astype(env.acc_dtype), w_np.T.astype(env.acc_dtype)).astype(
             env.acc_dtype
@@ -139,7 +139,11 @@ def run_gemm(
 
     res_np = np.zeros(topi.utils.get_const_tuple(res.shape)).astype(res.dtype)
     data_arr = tvm.nd.array(data_np, dev)
-    kernel_arr = tvm.nd.array(kernel_np, dev)
+    if "vta" in target.keys:
+        # The weights narrower than 8 bits are bit packed as VTA loads them
+        kernel_arr = vta.top.bitpack.bitpack_array(kernel_np, kernel.dtype, dev)
+    else:
+        kernel_arr = tvm.nd.array(kernel_np, dev)
     res_arr = tvm.nd.array(res_np, dev)
     time_f = f.time_evaluator("dense", dev, number=samples)
 
@@ -14,6 +14,12 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import threading
+
+import pytest
+import tvm
+from tvm import autotvm, relay
+from tvm.autotvm.task import relay_integration
 import vta
 
 
@@ -32,6 +38,68 @@ def test_env_scope():
     assert vta.get_env().TARGET == env.TARGET
 
 
+def test_env_config_hash():
+    env = vta.get_env()
+    assert env.config_hash == vta.Environment(env.cfg_dict).config_hash
+    assert env.mock.config_hash != env.config_hash
+    cfg = env.cfg_dict
+    cfg["TARGET"] = "xyz"
+    assert vta.Environment(cfg).config_hash != env.config_hash
+
+
+def test_env_bind():
+    env = vta.get_env()
+    cfg = env.cfg_dict
+    cfg["TARGET"] = "xyz"
+    other = vta.Environment(cfg).bind(1)
+    assert vta.get_env(1) is other
+    assert other.device().device_id == 1
+    assert vta.get_env().TARGET == env.TARGET
+    with pytest.raises(ValueError):
+        vta.get_env(2)
+    # threads outside of any scope see the scopes of the others
+    seen = []
+
+    def _worker():
+        seen.append(vta.get_env().TARGET)
+        with env:
+            seen.append(vta.get_env().TARGET)
+
+    with other:
+        worker = threading.Thread(target=_worker)
+        worker.start()
+        worker.join()
+        assert vta.get_env().TARGET == "xyz"
+    assert seen == ["xyz", env.TARGET]
+    assert vta.get_env().TARGET == env.TARGET
+
+
+def test_env_task_extraction(monkeypatch):
+    env = vta.get_env()
+    cfg = env.cfg_dict
+    cfg["TARGET"] = "xyz"
+    # the programs are compiled by a worker thread
+    seen = []
+    lower = relay_integration._lower
+
+    def _lower(*args):
+        seen.append(vta.get_env().TARGET)
+        lower(*args)
+
+    monkeypatch.setattr(relay_integration, "_lower", _lower)
+    data = relay.var("data", shape=(1, 8, 8, 8))
+    weight = relay.var("weight", shape=(8, 8, 3, 3))
+    mod = tvm.IRModule.from_expr(relay.Function([data, weight], relay.nn.conv2d(data, weight)))
+    with vta.Environment(cfg):
+        tasks = autotvm.task.extract_from_program(
+            mod, {}, target="llvm", ops=(relay.op.get("nn.conv2d"),)
+        )
+    assert seen == ["xyz"]
+    assert len(tasks) > 0
+
+
 if __name__ == "__main__":
     test_env()
     test_env_scope()
+    test_env_config_hash()
+    test_env_bind()
@@ -0,0 +1,64 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test the bit packing of narrow weights."""
+import ctypes
+
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import te
+from tvm._ffi.base import _LIB, check_call
+from vta.top.bitpack import bitpack, bitpack_array
+
+
+def _raw_bytes(arr):
+    size = int(np.prod(arr.shape))
+    raw = np.zeros(size, "int8")
+    check_call(
+        _LIB.TVMArrayCopyToBytes(
+            arr.handle, raw.ctypes.data_as(ctypes.c_void_p), ctypes.c_size_t(raw.nbytes)
+        )
+    )
+    return raw
+
+
+@tvm.testing.requires_llvm
+def test_bitpack_array():
+    for bits in [1, 2, 4]:
+        lanes = 8 // bits
+        low, high = -(1 << (bits - 1)), 1 << (bits - 1)
+        data_np = np.random.randint(low, high, size=(2, 3, 16, 16)).astype("int8")
+        arr = bitpack_array(data_np, "int%d" % bits)
+        assert arr.dtype == "int%d" % bits
+        assert arr.shape == data_np.shape
+        # The array holds the words of the bitpack compute, then zeros
+        data = te.placeholder(data_np.shape, dtype="int8", name="data")
+        packed = bitpack(data, bits, "int8")
+        f = tvm.build(te.create_schedule(packed.op), [data, packed], "llvm")
+        words = tvm.nd.empty(packed.shape, "int8")
+        f(tvm.nd.array(data_np), words)
+        raw = _raw_bytes(arr)
+        size = data_np.size // lanes
+        np.testing.assert_equal(raw[:size], words.numpy().reshape(-1))
+        np.testing.assert_equal(raw[size:], 0)
+    arr = bitpack_array(np.arange(-8, 8, dtype="int8"), "int8")
+    np.testing.assert_equal(arr.numpy(), np.arange(-8, 8))
+
+
+if __name__ == "__main__":
+    test_bitpack_array()
@@ -0,0 +1,142 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test the VTA graph executor replaying recorded instruction streams."""
+import numpy as np
+
+import tvm
+from tvm import relay
+from tvm.contrib import graph_executor, utils
+
+import vta
+import vta.testing
+from vta import graph_executor as vta_graph_executor
+from vta.top import graph_pack
+
+np.random.seed(0xDEADB)
+
+
+def _build(env, remote):
+    """Build a quantized network whose middle convolution runs on VTA."""
+    channels = env.BLOCK_OUT
+    dshape = (env.BATCH, 3, 8, 8)
+    data = relay.var("data", shape=dshape)
+    w0 = relay.var("w0", shape=(channels, 3, 3, 3))
+    w1 = relay.var("w1", shape=(channels, channels, 3, 3))
+    y = relay.nn.relu(relay.nn.conv2d(data, w0, padding=(1, 1), channels=channels))
+    y = relay.nn.max_pool2d(y, pool_size=(2, 2), strides=(2, 2))
+    y = relay.nn.relu(relay.nn.conv2d(y, w1, padding=(1, 1), channels=channels))
+    y = relay.nn.batch_flatten(relay.nn.global_avg_pool2d(y))
+    mod = tvm.IRModule.from_expr(relay.Function([data, w0, w1], y))
+    params = {
+        "w0": np.random.uniform(-1, 1, size=(channels, 3, 3, 3)).astype("float32"),
+        "w1": np.random.uniform(-1, 1, size=(channels, channels, 3, 3)).astype("float32"),
+    }
+
+    device_annot = env.TARGET in ["intelfocl", "sim"]
+    with tvm.transform.PassContext(opt_level=3):
+        with relay.quantize.qconfig(
+            global_scale=8.0, skip_conv_layers=[0], nbit_weight=env.WGT_WIDTH
+        ):
+            mod = relay.quantize.quantize(mod, params=params)
+        prog = graph_pack(
+            mod["main"],
+            env.BATCH,
+            env.BLOCK_OUT,
+            env.WGT_WIDTH,
+            start_name="nn.max_pool2d",
+            stop_name="nn.global_avg_pool2d",
+            device_annot=device_annot,
+        )
+    target = env.target
+    if device_annot:
+        target = {"cpu": env.target_vta_cpu, "ext_dev": env.target}
+    with vta.build_config(opt_level=3, disabled_pass={"AlterOpLayout"}):
+        lib = relay.build(prog, target=target, target_host=env.target_host)
+
+    temp = utils.tempdir()
+    lib.export_library(temp.relpath("graphlib.tar"))
+    remote.upload(temp.relpath("graphlib.tar"))
+    rlib = remote.load_module("graphlib.tar")
+    devs = [remote.ext_dev(0), remote.cpu(0)] if device_annot else [remote.ext_dev(0)]
+    params = {k: v.numpy() for k, v in lib.get_params().items()}
+    return lib.get_graph_json(), rlib, devs, dshape, params
+
+
+def _reference(graph_json, rlib, devs, params, data_np):
+    m = graph_executor.create(graph_json, rlib, devs)
+    m.set_input(**params)
+    m.set_input("data", data_np)
+    m.run()
+    return m.get_output(0).numpy()
+
+
+def test_capture_replay():
+    """Replay the recorded streams with new inputs, then record them again."""
+
+    def _run(env, remote):
+        graph_json, rlib, devs, dshape, params = _build(env, remote)
+        m = vta_graph_executor.create(graph_json, rlib, devs)
+        m.set_input(**params)
+        inputs = [np.random.uniform(-1, 1, size=dshape).astype("float32") for _ in range(3)]
+
+        m.set_input("data", inputs[0])
+        m.capture_vta_graph()
+        np.testing.assert_equal(
+            m.get_output(0).numpy(), _reference(graph_json, rlib, devs, params, inputs[0])
+        )
+        # The later runs replay the recording, with the inputs set in between
+        for data_np in inputs[1:] + inputs[:1]:
+            m.run(data=data_np)
+            np.testing.assert_equal(
+                m.get_output(0).numpy(), _reference(graph_json, rlib, devs, params, data_np)
+            )
+        # Recording again discards the previous recording
+        m.capture_vta_graph()
+        m.run(data=inputs[1])
+        np.testing.assert_equal(
+            m.get_output(0).numpy(), _reference(graph_json, rlib, devs, params, inputs[1])
+        )
+
+    vta.testing.run(_run)
+
+
+def test_load_params_arena():
+    """Load the parameters into the arena, then overwrite them in place."""
+
+    def _run(env, remote):
+        graph_json, rlib, devs, dshape, params = _build(env, remote)
+        m = vta_graph_executor.create(graph_json, rlib, devs)
+        data_np = np.random.uniform(-1, 1, size=dshape).astype("float32")
+        other = {
+            k: np.random.randint(-4, 4, size=v.shape).astype(v.dtype) if v.dtype == "int8" else v
+            for k, v in params.items()
+        }
+        for p in [params, other, params]:
+            m.load_params(tvm.runtime.save_param_dict(p))
+            # Run twice, the second run replays the streams recorded with the new parameters
+            for _ in range(2):
+                m.run(data=data_np)
+                np.testing.assert_equal(
+                    m.get_output(0).numpy(), _reference(graph_json, rlib, devs, p, data_np)
+                )
+
+    vta.testing.run(_run)
+
+
+if __name__ == "__main__":
+    test_capture_replay()
+    test_load_params_arena()
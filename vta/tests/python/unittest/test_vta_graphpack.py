@@ -0,0 +1,254 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test the graph packing helpers."""
+import numpy as np
+
+import tvm
+import tvm.testing
+from tvm import relay
+import vta
+from vta.top.graphpack import (
+    OffloadCostModel,
+    _conv_macs,
+    _let_bindings,
+    _pack_batch_channel,
+    _pack_groups,
+    _unpack_batch_channel,
+    graph_pack,
+    run_opt_pass,
+    select_regions,
+)
+
+
+@tvm.testing.requires_llvm
+def test_pack_groups():
+    # depthwise, and groups of 4 input and 8 output channels
+    for groups, in_channels, out_channels in [(32, 1, 1), (8, 4, 8)]:
+        cfactor = 16
+        dshape = (1, groups * in_channels, 6, 6)
+        wshape = (groups * out_channels, in_channels, 3, 3)
+        data_np = np.random.randint(-8, 8, size=dshape).astype("int32")
+        weight_np = np.random.randint(-8, 8, size=wshape).astype("int32")
+        weight, merged_shape, merged_groups = _pack_groups(
+            relay.const(weight_np), wshape, groups, cfactor, "int32"
+        )
+        assert merged_shape == (wshape[0], cfactor, 3, 3)
+        assert merged_groups == groups * in_channels // cfactor
+
+        def _run(weight, groups):
+            data = relay.var("data", shape=dshape, dtype="int32")
+            func = relay.Function(
+                [data], relay.nn.conv2d(data, weight, padding=(1, 1), groups=groups)
+            )
+            mod = tvm.IRModule.from_expr(func)
+            return relay.create_executor("graph", mod=mod).evaluate()(data_np).numpy()
+
+        ref = _run(relay.const(weight_np), groups)
+        tvm.testing.assert_allclose(_run(weight, merged_groups), ref)
+
+
+class _MacsCostModel(object):
+    """Convolutions run 10 times faster on VTA, the other operators are free there."""
+
+    def __init__(self, transfer=1.0):
+        self.transfer = transfer
+
+    def cpu_latency(self, call):
+        return float(_conv_macs(call) or 1)
+
+    def vta_latency(self, call):
+        return _conv_macs(call) / 10.0
+
+    def transfer_latency(self, expr):
+        return self.transfer
+
+
+def _conv_block(x, in_channels, out_channels):
+    """A quantized convolution, requantized to int8."""
+    weight = np.random.randint(-8, 8, size=(out_channels, in_channels, 3, 3)).astype("int8")
+    y = relay.nn.conv2d(
+        x,
+        relay.const(weight),
+        padding=(1, 1),
+        channels=out_channels,
+        kernel_size=(3, 3),
+        out_dtype="int32",
+    )
+    y = relay.right_shift(y, relay.const(8, "int32"))
+    y = relay.clip(y, -127, 127)
+    return relay.cast(y, "int8")
+
+
+def _quantized_net(pool_between=False):
+    """A float head, int8 convolutions on 16 channels, then a float tail."""
+    data = relay.var("data", shape=(1, 16, 8, 8), dtype="float32")
+    y = _conv_block(relay.cast(data, "int8"), 16, 16)
+    if pool_between:
+        y = relay.nn.max_pool2d(y, pool_size=(2, 2), strides=(2, 2))
+        y = _conv_block(y, 16, 32)
+    else:
+        y = _conv_block(y, 16, 16)
+    y = relay.nn.global_avg_pool2d(relay.cast(y, "float32"))
+    return relay.Function([data], y)
+
+
+def _region_ops(func, region):
+    """The operators bound at the start of a region, inside it and at its end."""
+    _, lets = _let_bindings(func)
+    start, stop = region
+    inside = [
+        let.value.op.name
+        for let in lets[start + 1 : stop + 1]
+        if isinstance(let.value, relay.expr.Call)
+    ]
+    return lets[start].value, inside, lets[stop].value
+
+
+def test_offload_cost_model():
+    env = vta.get_env()
+    data = relay.var("data", shape=(1, 16, 8, 8), dtype="int8")
+    func = relay.Function([data], _conv_block(data, 16, 16))
+    func = run_opt_pass(func, tvm.relay.transform.InferType())
+    cast = func.body
+    conv = cast.args[0].args[0].args[0]
+    assert conv.op.name == "nn.conv2d"
+    macs = 16 * 8 * 8 * 16 * 3 * 3
+    assert _conv_macs(conv) == macs
+    assert _conv_macs(cast) == 0
+
+    model = OffloadCostModel(
+        env, vta_clock_hz=1e8, vta_op_overhead_s=1e-5, cpu_macs_per_s=1e9, cpu_bytes_per_s=1e9
+    )
+    lanes = env.BATCH * env.BLOCK_IN * env.BLOCK_OUT
+    np.testing.assert_allclose(model.cpu_latency(conv), macs / 1e9)
+    np.testing.assert_allclose(model.vta_latency(conv), macs / lanes / 1e8 + 1e-5)
+    # The other operators are counted by the bytes they move, and fuse on VTA
+    elems = 16 * 8 * 8
+    np.testing.assert_allclose(model.cpu_latency(cast), 2 * elems / 1e9)
+    np.testing.assert_allclose(
+        model.vta_latency(cast), elems / (env.BATCH * env.BLOCK_OUT) / 1e8
+    )
+    np.testing.assert_allclose(model.transfer_latency(cast), 4 * elems / 1e9)
+
+
+def test_select_regions():
+    func = _quantized_net()
+    regions = select_regions(func, 1, 16, _MacsCostModel())
+    assert len(regions) == 1
+    start, inside, stop = _region_ops(func, regions[0])
+    # The float to int8 cast is packed, everything up to the last int8 cast runs on VTA
+    assert start.op.name == "cast" and start.args[0].checked_type.dtype == "float32"
+    assert inside.count("nn.conv2d") == 2
+    assert stop.op.name == "cast" and stop.checked_type.dtype == "int8"
+    assert "nn.global_avg_pool2d" not in inside
+
+    # Not worth offloading when the transfers cost more than the convolutions save
+    expensive = _MacsCostModel(transfer=1e9)
+    assert select_regions(func, 1, 16, expensive) == []
+    assert graph_pack(func, 1, 16, 8, auto_regions=True, cost_model=expensive) is func
+
+
+def test_select_regions_max_regions():
+    func = _quantized_net(pool_between=True)
+    regions = select_regions(func, 1, 16, _MacsCostModel())
+    # max_pool2d does not run in the packed layout, it splits the region
+    assert len(regions) == 2
+    assert regions[0][1] < regions[1][0]
+    for region in regions:
+        _, inside, _ = _region_ops(func, region)
+        assert inside.count("nn.conv2d") == 1 and "nn.max_pool2d" not in inside
+    # The first convolution does twice the multiply-accumulates of the second
+    assert select_regions(func, 1, 16, _MacsCostModel(), max_regions=1) == regions[:1]
+
+
+def test_graph_pack_auto_regions():
+    func = _quantized_net()
+    packed = graph_pack(func, 1, 16, 8, auto_regions=True, cost_model=_MacsCostModel())
+    packed = run_opt_pass(packed, tvm.relay.transform.InferType())
+    ref = run_opt_pass(func, tvm.relay.transform.InferType())
+    assert tvm.ir.structural_equal(packed.ret_type, ref.ret_type)
+    assert "NCHW1n16c" in packed.astext(show_meta_data=False)
+
+
+def _op_names(func):
+    """The operators a function calls, in post order."""
+    names = []
+
+    def _visit(expr):
+        if isinstance(expr, relay.expr.Call):
+            names.append(expr.op.name)
+
+    relay.analysis.post_order_visit(func, _visit)
+    return names
+
+
+def _evaluate(func, *args):
+    mod = tvm.IRModule.from_expr(func)
+    return relay.create_executor("graph", mod=mod).evaluate()(*args).numpy()
+
+
+@tvm.testing.requires_llvm
+def test_pack_batch_channel_reshape_only():
+    bfactor, cfactor = 1, 16
+    # batch 1 with 1x1 spatial only reshapes, 2x2 spatial moves the channels
+    for dshape, reshape_only in [((1, 32, 1, 1), True), ((1, 32, 2, 2), False)]:
+        data_np = np.random.randint(-8, 8, size=dshape).astype("int32")
+        data = relay.var("data", shape=dshape, dtype="int32")
+        packed = relay.Function([data], _pack_batch_channel(data, dshape, bfactor, cfactor))
+        packed = run_opt_pass(packed, tvm.relay.transform.InferType())
+        if reshape_only:
+            assert _op_names(packed) == ["reshape"]
+        else:
+            assert "transpose" in _op_names(packed)
+        ref = data_np.reshape(1, bfactor, 2, cfactor, dshape[2], dshape[3])
+        ref = ref.transpose(0, 2, 4, 5, 1, 3)
+        packed_np = _evaluate(packed, data_np)
+        np.testing.assert_equal(packed_np, ref)
+
+        pdata = relay.var("pdata", shape=ref.shape, dtype="int32")
+        unpacked = relay.Function([pdata], _unpack_batch_channel(pdata, dshape, bfactor, cfactor))
+        unpacked = run_opt_pass(unpacked, tvm.relay.transform.InferType())
+        if reshape_only:
+            assert _op_names(unpacked) == ["reshape"]
+        np.testing.assert_equal(_evaluate(unpacked, packed_np), data_np)
+
+
+@tvm.testing.requires_llvm
+def test_graph_pack_reshape_only():
+    dshape = (1, 32, 2, 2)
+    data = relay.var("data", shape=dshape, dtype="int32")
+    y = relay.nn.max_pool2d(data, pool_size=(2, 2), strides=(2, 2))
+    y = relay.clip(relay.nn.relu(y), 0, 7)
+    y = relay.nn.global_avg_pool2d(y)
+    func = relay.Function([data], y)
+    # The region between the 1x1 max_pool2d and global_avg_pool2d is packed
+    packed = graph_pack(func, 1, 16, 8)
+    names = _op_names(packed)
+    assert "transpose" not in names
+    assert names.count("reshape") == 2
+    data_np = np.random.randint(-8, 8, size=dshape).astype("int32")
+    np.testing.assert_equal(_evaluate(packed, data_np), _evaluate(func, data_np))
+
+
+if __name__ == "__main__":
+    test_pack_groups()
+    test_offload_cost_model()
+    test_select_regions()
+    test_select_regions_max_regions()
+    test_graph_pack_auto_regions()
+    test_pack_batch_channel_reshape_only()
+    test_graph_pack_reshape_only()
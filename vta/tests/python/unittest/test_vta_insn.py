@@ -15,14 +15,19 @@
 # specific language governing permissions and limitations
 # under the License.
 """Unit test VTA's instructions """
+import json
+import threading
+
 import tvm
 from tvm import te
 import numpy as np
 from tvm import topi
+from tvm import rpc
 from tvm.contrib import utils
 
 import vta
 import vta.testing
+import vta.zero_copy
 from vta.testing import simulator
 
 np.random.seed(0xDEADB)
@@ -207,8 +212,9 @@ def test_gemm():
         if not remote:
             return
 
-        def verify(s, name=None):
-            mod = vta.build(s, [x, w, y], "ext_dev", env.target_host)
+        def verify(s, name=None, debug_flag=0):
+            with vta.build_config(debug_flag=debug_flag):
+                mod = vta.build(s, [x, w, y], "ext_dev", env.target_host)
             temp = utils.tempdir()
             mod.save(temp.relpath("gemm.o"))
             remote.upload(temp.relpath("gemm.o"))
@@ -279,7 +285,7 @@ def test_gemm():
             s[y_gem].tensorize(s[y_gem].op.axis[2], env.gemm)
             verify(s, name="default")
 
-        def test_smt():
+        def test_smt(debug_flag=0):
             # test smt schedule
             s = te.create_schedule(y.op)
             s[x_buf].set_scope(env.inp_scope)
@@ -312,10 +318,12 @@ def test_gemm():
             s[w_buf].compute_at(s[y_gem], ko)
             s[w_buf].pragma(s[w_buf].op.axis[0], env.dma_copy)
             s[y].pragma(abo2, env.dma_copy)
-            verify(s, name="smt")
+            verify(s, name="smt", debug_flag=debug_flag)
 
         test_schedule1()
         test_smt()
+        # the peephole optimizer must not change the results
+        test_smt(env.OPT_INSN_PEEPHOLE)
 
     vta.testing.run(_run)
 
@@ -555,8 +563,349 @@ def test_runtime_array():
     vta.testing.run(_run)
 
 
+def test_runtime_array_multi_device():
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"]:
+            return
+        n = 10
+        x_np = np.random.randint(1, 10, size=(n, n, env.BATCH, env.BLOCK_OUT)).astype("int8")
+        x_nd = [tvm.nd.array(x_np * (i + 1), remote.ext_dev(i)) for i in range(2)]
+        for i, arr in enumerate(x_nd):
+            np.testing.assert_equal(x_np * (i + 1), arr.asnumpy())
+
+    vta.testing.run(_run)
+
+
+def test_runtime_array_copy():
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"]:
+            return
+        n = 300
+        dev = remote.ext_dev(0)
+        x_np = np.random.randint(-128, 128, size=(n, n, env.BATCH, env.BLOCK_OUT)).astype("int8")
+        x_nd = tvm.nd.array(x_np, dev)
+        y_nd = tvm.nd.empty(x_np.shape, device=dev, dtype=x_np.dtype)
+        # Large enough for several chunks of the on-device copy
+        x_nd.copyto(y_nd)
+        np.testing.assert_equal(x_np, y_nd.asnumpy())
+        # Odd sizes fall back to a host copy
+        z_np = np.random.randint(-128, 128, size=(7,)).astype("int8")
+        z_nd = tvm.nd.array(z_np, dev)
+        w_nd = tvm.nd.empty(z_np.shape, device=dev, dtype=z_np.dtype)
+        z_nd.copyto(w_nd)
+        np.testing.assert_equal(z_np, w_nd.asnumpy())
+
+    vta.testing.run(_run)
+
+
+def test_runtime_array_zero_copy():
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"] or not isinstance(remote, rpc.LocalSession):
+            return
+        n = 100
+        dev = remote.ext_dev(0)
+        x_np = np.random.randint(1, 10, size=(n, n, env.BATCH, env.BLOCK_OUT)).astype("int8")
+        x_nd = tvm.nd.empty(x_np.shape, device=dev, dtype=x_np.dtype)
+        view = vta.zero_copy.cpu_view(x_nd)
+        view[:] = x_np
+        vta.zero_copy.sync_for_device(x_nd)
+        np.testing.assert_equal(x_np, x_nd.asnumpy())
+
+        y_np = np.random.randint(1, 10, size=x_np.shape).astype("int8")
+        x_nd.copyfrom(y_np)
+        vta.zero_copy.sync_for_cpu(x_nd)
+        np.testing.assert_equal(y_np, view)
+
+    vta.testing.run(_run)
+
+
+def test_runtime_buffer_pool():
+    """Test reusing freed data buffers"""
+
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"] or not isinstance(remote, rpc.LocalSession):
+            return
+        stats = tvm.get_global_func("vta.runtime.buffer_pool_stats")
+        release = tvm.get_global_func("vta.runtime.buffer_pool_release")
+        # Start from an empty pool, the earlier tests may have left buffers in it
+        release()
+        assert stats("cached_buffers") == 0 and stats("cached_bytes") == 0
+        hits, misses = stats("hits"), stats("misses")
+
+        dev = remote.ext_dev(0)
+        x_np = np.random.randint(-128, 128, size=(10, 10, env.BATCH, env.BLOCK_OUT)).astype("int8")
+        x_nd = tvm.nd.array(x_np, dev)
+        del x_nd
+        assert stats("cached_buffers") == 1 and stats("cached_bytes") >= x_np.nbytes
+        # The buffer of the same size class comes back from the pool
+        y_nd = tvm.nd.array(x_np, dev)
+        assert stats("cached_buffers") == 0
+        assert stats("hits") - hits == 1 and stats("misses") - misses == 1
+        np.testing.assert_equal(x_np, y_nd.asnumpy())
+
+        del y_nd
+        assert stats("cached_buffers") == 1
+        release()
+        assert stats("cached_buffers") == 0 and stats("cached_bytes") == 0
+
+    vta.testing.run(_run)
+
+
+def test_multi_thread():
+    """Test kernels submitted from several host threads"""
+
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"] or not isinstance(remote, rpc.LocalSession):
+            return
+        m = 8
+        n = 10
+        a = te.placeholder((m, n, env.BATCH, env.BLOCK_OUT), name="a", dtype=env.acc_dtype)
+        a_buf = te.compute((m, n, env.BATCH, env.BLOCK_OUT), lambda *i: a(*i), "a_buf")
+        max_buf = te.compute(
+            (m, n, env.BATCH, env.BLOCK_OUT), lambda *i: tvm.te.max(a_buf(*i), 0), "max_buf"
+        )
+        res = te.compute(
+            (m, n, env.BATCH, env.BLOCK_OUT),
+            lambda *i: tvm.te.min(max_buf(*i), (1 << (env.INP_WIDTH - 1)) - 1).astype(
+                env.inp_dtype
+            ),
+            "res",
+        )
+        s = te.create_schedule(res.op)
+        s[a_buf].set_scope(env.acc_scope)
+        s[a_buf].pragma(a_buf.op.axis[0], env.dma_copy)
+        s[max_buf].set_scope(env.acc_scope)
+        s[max_buf].pragma(max_buf.op.axis[0], env.alu)
+        s[res].pragma(res.op.axis[0], env.dma_copy)
+        with vta.build_config():
+            f = vta.build(s, [a, res], "ext_dev", env.target_host)
+        dev = remote.ext_dev(0)
+        errors = []
+
+        def _worker(seed):
+            try:
+                rng = np.random.RandomState(seed)
+                for _ in range(4):
+                    a_np = rng.randint(-256, 256, size=(m, n, env.BATCH, env.BLOCK_OUT))
+                    a_np = a_np.astype(a.dtype)
+                    res_np = np.clip(a_np, 0, (1 << (env.INP_WIDTH - 1)) - 1).astype(res.dtype)
+                    a_nd = tvm.nd.array(a_np, dev)
+                    res_nd = tvm.nd.empty(res_np.shape, device=dev, dtype=res.dtype)
+                    f(a_nd, res_nd)
+                    np.testing.assert_equal(res_np, res_nd.asnumpy())
+            except Exception as err:  # pylint: disable=broad-except
+                errors.append(err)
+
+        threads = [threading.Thread(target=_worker, args=(i,)) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert not errors, errors
+
+    vta.testing.run(_run)
+
+
+def test_uop_kernel_cache():
+    """Test recording a micro-kernel once and reusing it"""
+
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"] or not isinstance(remote, rpc.LocalSession):
+            return
+        n = 4
+        x = te.placeholder((n, n, env.BATCH, env.BLOCK_OUT), name="x", dtype=env.acc_dtype)
+        x_buf = te.compute((n, n, env.BATCH, env.BLOCK_OUT), lambda *i: x(*i), "x_buf")
+        y_buf = te.compute((n, n, env.BATCH, env.BLOCK_OUT), lambda *i: x_buf(*i) + 1, "y_buf")
+        y = te.compute(
+            (n, n, env.BATCH, env.BLOCK_OUT), lambda *i: y_buf(*i).astype(env.inp_dtype), "y"
+        )
+        s = te.create_schedule(y.op)
+        s[x_buf].set_scope(env.acc_scope)
+        s[x_buf].pragma(x_buf.op.axis[0], env.dma_copy)
+        s[y_buf].set_scope(env.acc_scope)
+        s[y_buf].pragma(y_buf.op.axis[0], env.alu)
+        s[y].pragma(y.op.axis[0], env.dma_copy)
+        with vta.build_config():
+            f = vta.build(s, [x, y], "ext_dev", env.target_host)
+        dev = remote.ext_dev(0)
+        stats = tvm.get_global_func("vta.runtime.uop_kernel_cache_stats")
+        x_np = np.random.randint(-10, 10, size=(n, n, env.BATCH, env.BLOCK_OUT)).astype(x.dtype)
+        x_nd = tvm.nd.array(x_np, dev)
+        y_nd = tvm.nd.empty(x_np.shape, device=dev, dtype=y.dtype)
+        # The first run records the ALU kernel, the second one finds it in the cache
+        for expect_hits, expect_misses in [(0, 1), (1, 0)]:
+            hits, misses = stats(dev, "hits"), stats(dev, "misses")
+            f(x_nd, y_nd)
+            np.testing.assert_equal((x_np + 1).astype(y.dtype), y_nd.asnumpy())
+            assert stats(dev, "hits") - hits == expect_hits
+            assert stats(dev, "misses") - misses == expect_misses
+
+    vta.testing.run(_run)
+
+
+def test_trace():
+    """Test the runtime timeline"""
+
+    def _run(env, remote):
+        if env.TARGET not in ["sim", "tsim"] or not isinstance(remote, rpc.LocalSession):
+            return
+        n = 6
+        x = te.placeholder((n, n, env.BATCH, env.BLOCK_OUT), name="x", dtype=env.acc_dtype)
+        x_buf = te.compute((n, n, env.BATCH, env.BLOCK_OUT), lambda *i: x(*i), "x_buf")
+        y_buf = te.compute((n, n, env.BATCH, env.BLOCK_OUT), lambda *i: x_buf(*i) + 1, "y_buf")
+        y = te.compute(
+            (n, n, env.BATCH, env.BLOCK_OUT), lambda *i: y_buf(*i).astype(env.inp_dtype), "y"
+        )
+        s = te.create_schedule(y.op)
+        s[x_buf].set_scope(env.acc_scope)
+        s[x_buf].pragma(x_buf.op.axis[0], env.dma_copy)
+        s[y_buf].set_scope(env.acc_scope)
+        s[y_buf].pragma(y_buf.op.axis[0], env.alu)
+        s[y].pragma(y.op.axis[0], env.dma_copy)
+        with vta.build_config(debug_flag=env.DEBUG_TRACE):
+            f = vta.build(s, [x, y], "ext_dev", env.target_host)
+        dev = remote.ext_dev(0)
+        x_np = np.random.randint(-10, 10, size=(n, n, env.BATCH, env.BLOCK_OUT)).astype(x.dtype)
+        x_nd = tvm.nd.array(x_np, dev)
+        y_nd = tvm.nd.empty(x_np.shape, device=dev, dtype=y.dtype)
+        f(x_nd, y_nd)
+        np.testing.assert_equal((x_np + 1).astype(y.dtype), y_nd.asnumpy())
+
+        temp = utils.tempdir()
+        tvm.get_global_func("vta.runtime.trace_write")(temp.relpath("trace.json"))
+        with open(temp.relpath("trace.json")) as trace_file:
+            names = set(event["name"] for event in json.load(trace_file)["traceEvents"])
+        for name in ["VTADeviceRun", "Uop load", "Wait device", "Record uop kernel"]:
+            assert name in names, name
+
+    vta.testing.run(_run)
+
+
+def _build_gemm_smt(env, o, m, debug_flag=0):
+    """Build a GEMM followed by ALU ops on two virtual threads, whose micro-ops are unrolled."""
+    n = 1
+    x = te.placeholder((o, n, env.BATCH, env.BLOCK_IN), name="x", dtype=env.inp_dtype)
+    w = te.placeholder((m, n, env.BLOCK_OUT, env.BLOCK_IN), name="w", dtype=env.wgt_dtype)
+    x_buf = te.compute((o, n, env.BATCH, env.BLOCK_IN), lambda *i: x(*i), "x_buf")
+    w_buf = te.compute((m, n, env.BLOCK_OUT, env.BLOCK_IN), lambda *i: w(*i), "w_buf")
+    ko = te.reduce_axis((0, n), name="ko")
+    ki = te.reduce_axis((0, env.BLOCK_IN), name="ki")
+    y_gem = te.compute(
+        (o, m, env.BATCH, env.BLOCK_OUT),
+        lambda bo, co, bi, ci: te.sum(
+            x_buf[bo, ko, bi, ki].astype(env.acc_dtype)
+            * w_buf[co, ko, ci, ki].astype(env.acc_dtype),
+            axis=[ko, ki],
+        ),
+        name="y_gem",
+    )
+    y_shf = te.compute((o, m, env.BATCH, env.BLOCK_OUT), lambda *i: y_gem(*i) >> 8, name="y_shf")
+    y_max = te.compute(
+        (o, m, env.BATCH, env.BLOCK_OUT), lambda *i: tvm.te.max(y_shf(*i), 0), "y_max"
+    )
+    y = te.compute(
+        (o, m, env.BATCH, env.BLOCK_OUT), lambda *i: y_max(*i).astype(env.inp_dtype), name="y"
+    )
+    s = te.create_schedule(y.op)
+    s[x_buf].set_scope(env.inp_scope)
+    s[w_buf].set_scope(env.wgt_scope)
+    s[y_gem].set_scope(env.acc_scope)
+    s[y_shf].set_scope(env.acc_scope)
+    s[y_max].set_scope(env.acc_scope)
+    abo, _, _, _ = s[y].op.axis
+    abo1, abo2 = s[y].split(abo, nparts=2)
+    s[y].bind(abo1, te.thread_axis("cthread"))
+    for stage in [y_gem, y_shf, y_max]:
+        s[stage].compute_at(s[y], abo1)
+    s[y_gem].reorder(
+        ko, s[y_gem].op.axis[0], s[y_gem].op.axis[1], s[y_gem].op.axis[2], s[y_gem].op.axis[3], ki
+    )
+    s[y_gem].tensorize(s[y_gem].op.axis[2], env.gemm)
+    s[y_shf].pragma(s[y_shf].op.axis[0], env.alu)
+    s[y_max].pragma(s[y_max].op.axis[0], env.alu)
+    s[x_buf].compute_at(s[y_gem], ko)
+    s[x_buf].pragma(s[x_buf].op.axis[0], env.dma_copy)
+    s[w_buf].compute_at(s[y_gem], ko)
+    s[w_buf].pragma(s[w_buf].op.axis[0], env.dma_copy)
+    s[y].pragma(abo2, env.dma_copy)
+    with vta.build_config(debug_flag=debug_flag):
+        f = vta.build(s, [x, w, y], "ext_dev", env.target_host)
+
+    x_np = np.random.randint(-128, 128, size=(o, n, env.BATCH, env.BLOCK_IN)).astype(x.dtype)
+    w_np = np.random.randint(-128, 128, size=(m, n, env.BLOCK_OUT, env.BLOCK_IN)).astype(w.dtype)
+    y_np = np.einsum("bkij,ckoj->bcio", x_np.astype(env.acc_dtype), w_np.astype(env.acc_dtype))
+    y_np = np.maximum(np.right_shift(y_np, 8), 0).astype(y.dtype)
+    return f, x_np, w_np, y_np
+
+
+def _run_gemm_smt(f, x_np, w_np, y_np, dev):
+    """Run a module of _build_gemm_smt, return its simulator statistics."""
+    x_nd = tvm.nd.array(x_np, dev)
+    w_nd = tvm.nd.array(w_np, dev)
+    y_nd = tvm.nd.empty(y_np.shape, device=dev, dtype=y_np.dtype)
+    simulator.clear_stats()
+    f(x_nd, w_nd, y_nd)
+    np.testing.assert_equal(y_np, y_nd.asnumpy())
+    return simulator.stats()
+
+
+def test_uop_compress():
+    """Test that folding strided micro-ops into a loop keeps the results"""
+
+    def _run(env, remote):
+        if env.TARGET != "sim" or not isinstance(remote, rpc.LocalSession):
+            return
+        dev = remote.ext_dev(0)
+        f, x_np, w_np, y_np = _build_gemm_smt(env, 4, 4)
+        compressed = _run_gemm_smt(f, x_np, w_np, y_np, dev)
+        f_raw, _, _, _ = _build_gemm_smt(env, 4, 4, env.DEBUG_SKIP_UOP_COMPRESS)
+        raw = _run_gemm_smt(f_raw, x_np, w_np, y_np, dev)
+        # The hardware runs the same micro-ops from fewer loaded ones
+        assert compressed["gemm_counter"] == raw["gemm_counter"]
+        assert compressed["alu_counter"] == raw["alu_counter"]
+        assert compressed["uop_load_nbytes"] < raw["uop_load_nbytes"]
+
+    vta.testing.run(_run)
+
+
+def test_uop_residency():
+    """Test evicting micro-op kernels from a full uop buffer and loading them again"""
+
+    def _run(env, remote):
+        if env.TARGET != "sim" or not isinstance(remote, rpc.LocalSession):
+            return
+        dev = remote.ext_dev(0)
+        # Uncompressed kernels, so that few modules fill the uop buffer
+        modules = [_build_gemm_smt(env, 16, 32, env.DEBUG_SKIP_UOP_COMPRESS)]
+        kernel_nbytes = _run_gemm_smt(*modules[0], dev)["uop_load_nbytes"]
+        assert kernel_nbytes > 0
+        # The kernels stay resident across synchronizations
+        assert _run_gemm_smt(*modules[0], dev)["uop_load_nbytes"] == 0
+
+        num_modules = env.UOP_BUFF_SIZE // kernel_nbytes + 2
+        assert num_modules <= 32, "The kernels are too small to fill the uop buffer"
+        for _ in range(num_modules - 1):
+            modules.append(_build_gemm_smt(env, 16, 32, env.DEBUG_SKIP_UOP_COMPRESS))
+            assert _run_gemm_smt(*modules[-1], dev)["uop_load_nbytes"] > 0
+        # More kernels ran since each module's last run than the buffer holds, so they reload
+        for module in modules:
+            assert _run_gemm_smt(*module, dev)["uop_load_nbytes"] > 0
+        assert _run_gemm_smt(*modules[-1], dev)["uop_load_nbytes"] == 0
+
+    vta.testing.run(_run)
+
+
 if __name__ == "__main__":
     test_runtime_array()
+    test_runtime_array_multi_device()
+    test_runtime_array_copy()
+    test_runtime_array_zero_copy()
+    test_runtime_buffer_pool()
+    test_multi_thread()
+    test_uop_kernel_cache()
+    test_trace()
+    test_uop_compress()
+    test_uop_residency()
     test_save_load_out()
     test_padded_load()
     test_gemm()
@@ -0,0 +1,164 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test the graph executor pipelining frames across the CPU and VTA stages."""
+import numpy as np
+import pytest
+
+import tvm
+from tvm import relay
+from tvm.contrib import graph_executor, utils
+
+import vta
+import vta.testing
+from vta import pipeline_executor
+from vta.top import graph_pack
+
+np.random.seed(0xDEADB)
+
+
+def _build(env, remote):
+    """Build a quantized network whose middle convolution runs on VTA."""
+    channels = env.BLOCK_OUT
+    dshape = (env.BATCH, 3, 8, 8)
+    data = relay.var("data", shape=dshape)
+    w0 = relay.var("w0", shape=(channels, 3, 3, 3))
+    w1 = relay.var("w1", shape=(channels, channels, 3, 3))
+    y = relay.nn.relu(relay.nn.conv2d(data, w0, padding=(1, 1), channels=channels))
+    y = relay.nn.max_pool2d(y, pool_size=(2, 2), strides=(2, 2))
+    y = relay.nn.relu(relay.nn.conv2d(y, w1, padding=(1, 1), channels=channels))
+    y = relay.nn.batch_flatten(relay.nn.global_avg_pool2d(y))
+    mod = tvm.IRModule.from_expr(relay.Function([data, w0, w1], y))
+    params = {
+        "w0": np.random.uniform(-1, 1, size=(channels, 3, 3, 3)).astype("float32"),
+        "w1": np.random.uniform(-1, 1, size=(channels, channels, 3, 3)).astype("float32"),
+    }
+
+    device_annot = env.TARGET in ["intelfocl", "sim"]
+    with tvm.transform.PassContext(opt_level=3):
+        with relay.quantize.qconfig(
+            global_scale=8.0, skip_conv_layers=[0], nbit_weight=env.WGT_WIDTH
+        ):
+            mod = relay.quantize.quantize(mod, params=params)
+        prog = graph_pack(
+            mod["main"],
+            env.BATCH,
+            env.BLOCK_OUT,
+            env.WGT_WIDTH,
+            start_name="nn.max_pool2d",
+            stop_name="nn.global_avg_pool2d",
+            device_annot=device_annot,
+        )
+    target = env.target
+    if device_annot:
+        target = {"cpu": env.target_vta_cpu, "ext_dev": env.target}
+    with vta.build_config(opt_level=3, disabled_pass={"AlterOpLayout"}):
+        lib = relay.build(prog, target=target, target_host=env.target_host)
+
+    temp = utils.tempdir()
+    lib.export_library(temp.relpath("graphlib.tar"))
+    remote.upload(temp.relpath("graphlib.tar"))
+    rlib = remote.load_module("graphlib.tar")
+    devs = [remote.ext_dev(0), remote.cpu(0)] if device_annot else [remote.ext_dev(0)]
+    params = {k: v.numpy() for k, v in lib.get_params().items()}
+    return lib.get_graph_json(), rlib, devs, dshape, params, device_annot
+
+
+def _reference(graph_json, rlib, devs, params, data_np):
+    m = graph_executor.create(graph_json, rlib, devs)
+    m.set_input(**params)
+    m.set_input("data", data_np)
+    m.run()
+    return m.get_output(0).numpy()
+
+
+def test_pipeline_frames_in_order():
+    """Frames in flight come out in the order they were submitted."""
+
+    def _run(env, remote):
+        graph_json, rlib, devs, dshape, params, device_annot = _build(env, remote)
+        pipe = pipeline_executor.create(graph_json, rlib, devs, num_slots=3)
+        pipe.load_params(tvm.runtime.save_param_dict(params))
+        if device_annot:
+            # The CPU head, the VTA body and the CPU tail
+            assert pipe.get_num_stages() > 1
+        else:
+            assert pipe.get_num_stages() == 1
+        assert pipe.get_num_inputs() == 1
+        assert pipe.get_num_outputs() == 1
+
+        frames = [np.random.uniform(-1, 1, size=dshape).astype("float32") for _ in range(6)]
+        expected = [_reference(graph_json, rlib, devs, params, f) for f in frames]
+        # Keep two frames in flight, the third slot holds the frame being read
+        pipe.run(data=frames[0])
+        pipe.run(data=frames[1])
+        for i, frame in enumerate(frames[2:]):
+            pipe.wait()
+            np.testing.assert_equal(pipe.get_output(0).numpy(), expected[i])
+            pipe.run(data=frame)
+        for i in range(len(frames) - 2, len(frames)):
+            pipe.wait()
+            out = tvm.nd.empty(expected[i].shape, expected[i].dtype)
+            np.testing.assert_equal(pipe.get_output(0, out).numpy(), expected[i])
+
+    vta.testing.run(_run)
+
+
+def test_pipeline_load_params():
+    """Loading parameters waits for the frames in flight, then applies to the next ones."""
+
+    def _run(env, remote):
+        graph_json, rlib, devs, dshape, params, _ = _build(env, remote)
+        pipe = pipeline_executor.create(graph_json, rlib, devs)
+        data_np = np.random.uniform(-1, 1, size=dshape).astype("float32")
+        other = {
+            k: np.random.randint(-4, 4, size=v.shape).astype(v.dtype) if v.dtype == "int8" else v
+            for k, v in params.items()
+        }
+        for p in [params, other]:
+            pipe.run(data=data_np)
+            pipe.load_params(tvm.runtime.save_param_dict(p))
+            pipe.wait()
+            pipe.run(data=data_np)
+            pipe.wait()
+            np.testing.assert_equal(
+                pipe.get_output(0).numpy(), _reference(graph_json, rlib, devs, p, data_np)
+            )
+
+    vta.testing.run(_run)
+
+
+def test_pipeline_misuse():
+    """Waiting without a frame, or reading before waiting, fails cleanly."""
+
+    def _run(env, remote):
+        graph_json, rlib, devs, _, params, _ = _build(env, remote)
+        with pytest.raises(tvm.TVMError):
+            pipeline_executor.create(graph_json, rlib, devs, num_slots=1)
+        pipe = pipeline_executor.create(graph_json, rlib, devs)
+        pipe.load_params(tvm.runtime.save_param_dict(params))
+        with pytest.raises(tvm.TVMError):
+            pipe.wait()
+        with pytest.raises(tvm.TVMError):
+            pipe.get_output(0)
+
+    vta.testing.run(_run)
+
+
+if __name__ == "__main__":
+    test_pipeline_frames_in_order()
+    test_pipeline_load_params()
+    test_pipeline_misuse()
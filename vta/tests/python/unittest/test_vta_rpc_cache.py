@@ -0,0 +1,59 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Test the file cache of the VTA RPC server."""
+import os
+import time
+
+from tvm.contrib import utils
+from vta.exec.rpc_server import ContentCache
+
+
+def _write(path, data):
+    with open(path, "wb") as out:
+        out.write(data)
+
+
+def _read(path):
+    with open(path, "rb") as src:
+        return src.read()
+
+
+def test_content_cache():
+    temp = utils.tempdir()
+    cache = ContentCache(temp.relpath("cache"), max_bytes=8)
+    assert not cache.fetch("a", temp.relpath("miss"))
+
+    _write(temp.relpath("a"), b"aaaa")
+    _write(temp.relpath("b"), b"bbbb")
+    cache.store(temp.relpath("a"), "a")
+    cache.store(temp.relpath("b"), "b")
+    assert cache.fetch("a", temp.relpath("a.fetched"))
+    assert _read(temp.relpath("a.fetched")) == b"aaaa"
+
+    # The least recently used entry is evicted past the size limit
+    past = time.time() - 100
+    os.utime(os.path.join(cache.path, "b"), (past, past))
+    _write(temp.relpath("c"), b"cccc")
+    cache.store(temp.relpath("c"), "c")
+    assert not cache.fetch("b", temp.relpath("b.fetched"))
+    assert cache.fetch("a", temp.relpath("a.fetched"))
+    assert cache.fetch("c", temp.relpath("c.fetched"))
+    assert _read(temp.relpath("c.fetched")) == b"cccc"
+
+
+if __name__ == "__main__":
+    test_content_cache()
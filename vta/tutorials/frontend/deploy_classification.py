@@ -178,8 +178,12 @@ with autotvm.tophub.context(target):
     if target.device_name == "vta":
         # Perform quantization in Relay
         # Note: We set opt_level to 3 in order to fold batch norm
+        # The weights are quantized to the width VTA is configured for, and graph_pack
+        # bit packs the weights narrower than 8 bits
         with tvm.transform.PassContext(opt_level=3):
-            with relay.quantize.qconfig(global_scale=8.0, skip_conv_layers=[0]):
+            with relay.quantize.qconfig(
+                global_scale=8.0, skip_conv_layers=[0], nbit_weight=env.WGT_WIDTH
+            ):
                 mod = relay.quantize.quantize(mod, params=params)
             # Perform graph packing and constant folding for VTA target
             assert env.BLOCK_IN == env.BLOCK_OUT
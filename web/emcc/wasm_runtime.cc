@@ -54,6 +54,80 @@
 
 // --- Implementations of backend and wasm runtime API. ---
 
+#if TVM_WASM_THREADS
+#include <atomic>
+
+extern "C" {
+/*!
+ * \brief Run a task of a parallel launch, called by the workers of the frontend.
+ * \param flambda The parallel lambda.
+ * \param cdata The closure of the lambda.
+ * \param task_id The task to run.
+ * \param num_task The number of tasks of the launch.
+ * \param sync_handle The group of the launch, nullptr when the tasks never synchronize.
+ * \return The return value of the lambda.
+ */
+TVM_DLL int TVMWasmParallelRunTask(FTVMParallelLambda flambda, void* cdata, int task_id,
+                                   int num_task, void* sync_handle);
+
+// --- APIs to be implemented by the frontend. ---
+/*!
+ * \brief Run the tasks of a parallel launch on the worker pool of the frontend, the calling
+ *  thread running task 0, and wait for them.
+ * \param flambda The parallel lambda.
+ * \param cdata The closure of the lambda.
+ * \param num_task The number of tasks, 0 for the number of threads of the pool.
+ * \param sync_handle The group of the launch, passed to TVMWasmParallelRunTask.
+ * \return 0 if success, -1 if a task failed, 1 if the pool is not started or already busy.
+ */
+extern int TVMWasmParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task,
+                                 void* sync_handle);
+}  // extern "C"
+
+namespace {
+// The barrier of the tasks of a launch, on the stack of the launching thread, which is in the
+// shared memory.
+struct WasmParallelGroup {
+  std::atomic<int> arrived{0};
+  std::atomic<int> generation{0};
+};
+}  // namespace
+
+int TVMWasmParallelRunTask(FTVMParallelLambda flambda, void* cdata, int task_id, int num_task,
+                           void* sync_handle) {
+  TVMParallelGroupEnv env;
+  env.num_task = num_task;
+  env.sync_handle = sync_handle;
+  return flambda(task_id, &env, cdata);
+}
+
+int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
+  WasmParallelGroup group;
+  // The tasks always run at once on the workers, so they can always synchronize
+  num_task &= ~TVM_PARALLEL_LAUNCH_SYNC;
+  int ret = TVMWasmParallelLaunch(flambda, cdata, num_task, &group);
+  if (ret == 1) {
+    // Nested in a task, or no pool, run the launch as a single task.
+    ret = TVMWasmParallelRunTask(flambda, cdata, 0, 1, nullptr);
+  }
+  return ret;
+}
+
+int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
+  auto* group = static_cast<WasmParallelGroup*>(penv->sync_handle);
+  if (group == nullptr || penv->num_task == 1) return 0;
+  int generation = group->generation.load(std::memory_order_acquire);
+  if (group->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == penv->num_task) {
+    group->arrived.store(0, std::memory_order_relaxed);
+    group->generation.store(generation + 1, std::memory_order_release);
+  } else {
+    // The tasks run on the workers of the pool, one each, so they all arrive.
+    while (group->generation.load(std::memory_order_acquire) == generation) {
+    }
+  }
+  return 0;
+}
+#else
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
   TVMParallelGroupEnv env;
   env.num_task = 1;
@@ -62,6 +136,7 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
 }
 
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) { return 0; }
+#endif  // TVM_WASM_THREADS
 
 // --- Environment PackedFuncs for testing ---
 namespace tvm {
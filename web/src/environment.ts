@@ -22,6 +22,7 @@
 import { Pointer } from "./ctypes";
 import { LibraryProvider } from "./types";
 import { assert } from "./support";
+import { ThreadPool } from "./threadpool";
 import * as ctypes from "./ctypes";
 
 /**
@@ -82,6 +83,10 @@ export class Environment implements LibraryProvider {
    * Free table index that can be recycled.
    */
   packedCFuncTableFreeId: Array<number> = [];
+  /**
+   * The worker pool running the parallel launches of a runtime built with threads.
+   */
+  threadPool?: ThreadPool;
 
   private libProvider?: LibraryProvider;
 
@@ -134,9 +139,21 @@ export class Environment implements LibraryProvider {
       this.packedCFuncTableFreeId.push(resourceHandle);
     };
 
+    const wasmParallelLaunch = (
+      flambda: Pointer,
+      cdata: Pointer,
+      numTask: number,
+      syncHandle: Pointer
+    ): number => {
+      // Without a pool, the runtime runs the launch as a single task.
+      if (this.threadPool === undefined) return 1;
+      return this.threadPool.launch(flambda, cdata, numTask, syncHandle);
+    };
+
     const newEnv = {
       TVMWasmPackedCFunc: wasmPackedCFunc,
       TVMWasmPackedCFuncFinalizer: wasmPackedCFuncFinalizer,
+      TVMWasmParallelLaunch: wasmParallelLaunch,
       "__console_log": (msg: string): void => {
         this.logger(msg);
       }
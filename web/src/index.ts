@@ -24,6 +24,7 @@ export {
 } from "./runtime";
 export { Disposable, LibraryProvider } from "./types";
 export { RPCServer } from "./rpc_server";
+export { ThreadPool } from "./threadpool";
 export { wasmPath } from "./support";
 export { detectGPUDevice } from "./webgpu";
 export { assert } from "./support";
\ No newline at end of file
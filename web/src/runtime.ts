@@ -25,6 +25,7 @@ import { Disposable } from "./types";
 import { Memory, CachedCallStack } from "./memory";
 import { assert, StringToUint8Array } from "./support";
 import { Environment } from "./environment";
+import { ThreadPool } from "./threadpool";
 import { WebGPUContext } from "./webgpu";
 
 import * as compact from "./compact";
@@ -684,6 +685,7 @@ export class Instance implements Disposable {
   exports: Record<string, Function>;
   private lib: FFILibrary;
   private env: Environment;
+  private wasmModule: WebAssembly.Module;
 
   /**
    * Internal function(registered by the runtime)
@@ -723,6 +725,7 @@ export class Instance implements Disposable {
 
     env.start(wasmInstance);
     this.env = env;
+    this.wasmModule = wasmModule;
     this.lib = new FFILibrary(wasmInstance, env.imports);
     this.memory = this.lib.memory;
     this.exports = this.lib.exports;
@@ -730,8 +733,32 @@ export class Instance implements Disposable {
   }
 
   dispose(): void {
+    if (this.env.threadPool !== undefined) {
+      this.env.threadPool.dispose();
+      this.env.threadPool = undefined;
+    }
     this.lib.dispose();
   }
+
+  /**
+   * Start the worker threads running the parallel loops of the kernels.
+   *
+   * Needs a runtime built with WASM_THREADS=1, instantiated on a shared memory, and a browser
+   * that enables SharedArrayBuffer (a cross-origin isolated page).
+   *
+   * @param numWorkers The number of workers besides the calling thread, by default one less
+   *  than the number of logical processors.
+   */
+  async startThreadPool(numWorkers?: number): Promise<void> {
+    assert(this.env.threadPool === undefined, "The thread pool is already started");
+    if (numWorkers === undefined) {
+      numWorkers = Math.max((navigator.hardwareConcurrency || 1) - 1, 0);
+    }
+    const pool = new ThreadPool(this.memory.memory, this.exports);
+    await pool.start(this.wasmModule, numWorkers);
+    this.env.threadPool = pool;
+  }
+
   /**
    * Get system-wide library module in the wasm.
    * System lib is a global module that contains self register functions in startup.
@@ -0,0 +1,237 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * Worker thread pool running the parallel launches of a wasm runtime built with threads.
+ *
+ * Each worker instantiates the same wasm module on the shared memory of the main instance,
+ * with its own stack and thread local storage, then waits on a control block in the shared
+ * memory for the launches of TVMBackendParallelLaunch.
+ */
+import { Pointer } from "./ctypes";
+import { Disposable } from "./types";
+import { assert } from "./support";
+import * as ctypes from "./ctypes";
+
+/** The int32 words of the control block. */
+const kGeneration = 0;
+const kLambda = 1;
+const kClosure = 2;
+const kNumTask = 3;
+const kSyncHandle = 4;
+const kPending = 5;
+const kError = 6;
+const kExit = 7;
+const kNumWords = 8;
+
+/** TVMWasmParallelLaunch did not launch, the runtime runs the launch as a single task. */
+const kNotLaunched = 1;
+
+/** The default stack size of a worker. */
+const kDefaultStackSize = 1 << 20;
+
+/**
+ * The source of a worker. It posts "ready" once initialized, then serves the launches until
+ * the exit word of the control block is set. The launches nested in a task are not launched.
+ */
+const workerSource = `
+onmessage = (event) => {
+  const msg = event.data;
+  let exports = undefined;
+  const imports = {};
+  for (const item of WebAssembly.Module.imports(msg.module)) {
+    imports[item.module] = imports[item.module] || {};
+    if (item.kind == "memory") {
+      imports[item.module][item.name] = msg.memory;
+    } else if (item.name == "TVMWasmParallelLaunch") {
+      imports[item.module][item.name] = () => ${kNotLaunched};
+    } else {
+      imports[item.module][item.name] = () => 0;
+    }
+  }
+  exports = new WebAssembly.Instance(msg.module, imports).exports;
+  (exports._emscripten_stack_restore || exports.stackRestore)(msg.stackTop);
+  if (exports.__wasm_init_tls !== undefined) {
+    exports.__wasm_init_tls(msg.tlsBase);
+  }
+  const words = new Int32Array(msg.memory.buffer, msg.control, ${kNumWords});
+  let generation = Atomics.load(words, ${kGeneration});
+  postMessage("ready");
+  for (;;) {
+    Atomics.wait(words, ${kGeneration}, generation);
+    generation = Atomics.load(words, ${kGeneration});
+    if (Atomics.load(words, ${kExit}) != 0) break;
+    const numTask = Atomics.load(words, ${kNumTask});
+    if (msg.workerId < numTask) {
+      const ret = exports.TVMWasmParallelRunTask(
+        Atomics.load(words, ${kLambda}), Atomics.load(words, ${kClosure}), msg.workerId,
+        numTask, Atomics.load(words, ${kSyncHandle}));
+      if (ret != 0) Atomics.store(words, ${kError}, ret);
+    }
+    Atomics.sub(words, ${kPending}, 1);
+  }
+  close();
+};
+`;
+
+/** The run task function of the runtime. */
+type FTVMWasmParallelRunTask = (
+  flambda: Pointer, cdata: Pointer, taskId: number, numTask: number, syncHandle: Pointer
+) => number;
+
+/**
+ * Worker thread pool of an instance.
+ */
+export class ThreadPool implements Disposable {
+  private memory: WebAssembly.Memory;
+  private exports: Record<string, Function>;
+  private workers: Array<Worker> = [];
+  private control: Pointer = 0;
+  private words?: Int32Array;
+  private busy = false;
+
+  /**
+   * Constructor, use {@link start} to start the workers.
+   * @param memory The shared memory of the instance.
+   * @param exports The exports of the instance.
+   */
+  constructor(memory: WebAssembly.Memory, exports: Record<string, Function>) {
+    assert(
+      typeof SharedArrayBuffer !== "undefined" && memory.buffer instanceof SharedArrayBuffer,
+      "The thread pool needs a wasm runtime built with WASM_THREADS=1 and a shared memory"
+    );
+    assert(
+      exports.TVMWasmParallelRunTask instanceof Function,
+      "Cannot find TVMWasmParallelRunTask in exports, build the runtime with WASM_THREADS=1"
+    );
+    this.memory = memory;
+    this.exports = exports;
+  }
+
+  /**
+   * Start the workers.
+   * @param wasmModule The module of the instance.
+   * @param numWorkers The number of workers, besides the calling thread.
+   * @param stackSize The stack size of each worker.
+   */
+  async start(
+    wasmModule: WebAssembly.Module,
+    numWorkers: number,
+    stackSize: number = kDefaultStackSize
+  ): Promise<void> {
+    assert(this.workers.length == 0, "The thread pool is already started");
+    this.control = this.alloc(kNumWords * 4);
+    this.words = new Int32Array(this.memory.buffer, this.control, kNumWords);
+    this.words.fill(0);
+    const tlsSize = this.globalValue("__tls_size");
+    const tlsAlign = Math.max(this.globalValue("__tls_align"), 1);
+    const url = URL.createObjectURL(
+      new Blob([workerSource], { type: "text/javascript" })
+    );
+    const ready: Array<Promise<void>> = [];
+    for (let i = 0; i < numWorkers; ++i) {
+      const stackBase = this.alloc(stackSize);
+      const tlsBase = tlsSize == 0 ? 0 : this.alloc(tlsSize + tlsAlign);
+      const worker = new Worker(url);
+      this.workers.push(worker);
+      ready.push(
+        new Promise((resolve, reject) => {
+          worker.onmessage = (): void => resolve();
+          worker.onerror = (error: ErrorEvent): void => reject(error);
+        })
+      );
+      worker.postMessage({
+        module: wasmModule,
+        memory: this.memory,
+        control: this.control,
+        workerId: i + 1,
+        // The stack grows down, from an aligned top.
+        stackTop: (stackBase + stackSize) & ~15,
+        tlsBase: (tlsBase + tlsAlign - 1) & ~(tlsAlign - 1),
+      });
+    }
+    try {
+      await Promise.all(ready);
+    } finally {
+      URL.revokeObjectURL(url);
+    }
+  }
+
+  /** The number of threads of the pool, including the calling thread. */
+  numThreads(): number {
+    return this.workers.length + 1;
+  }
+
+  /**
+   * Run a parallel launch of the runtime, see TVMWasmParallelLaunch.
+   * @returns 0 if success, -1 if a task failed, 1 if the launch is not run by the pool.
+   */
+  launch(flambda: Pointer, cdata: Pointer, numTask: number, syncHandle: Pointer): number {
+    if (this.busy || this.words === undefined) {
+      return kNotLaunched;
+    }
+    const words = this.words;
+    // One task per thread, the tasks of a launch may wait on each other at the barrier.
+    numTask = numTask <= 0 ? this.numThreads() : Math.min(numTask, this.numThreads());
+    if (numTask == 1) {
+      return kNotLaunched;
+    }
+    this.busy = true;
+    Atomics.store(words, kLambda, flambda);
+    Atomics.store(words, kClosure, cdata);
+    Atomics.store(words, kNumTask, numTask);
+    Atomics.store(words, kSyncHandle, syncHandle);
+    Atomics.store(words, kError, 0);
+    // Every worker acknowledges the launch, so that none reads the next one midway.
+    Atomics.store(words, kPending, this.workers.length);
+    Atomics.add(words, kGeneration, 1);
+    Atomics.notify(words, kGeneration);
+    let ret = (this.exports.TVMWasmParallelRunTask as FTVMWasmParallelRunTask)(
+      flambda, cdata, 0, numTask, syncHandle
+    );
+    // The main thread of a browser cannot block, spin until the workers are done.
+    while (Atomics.load(words, kPending) != 0) {
+      // spin
+    }
+    if (ret == 0 && Atomics.load(words, kError) != 0) {
+      ret = -1;
+    }
+    this.busy = false;
+    return ret == 0 ? 0 : -1;
+  }
+
+  dispose(): void {
+    if (this.words !== undefined) {
+      Atomics.store(this.words, kExit, 1);
+      Atomics.add(this.words, kGeneration, 1);
+      Atomics.notify(this.words, kGeneration);
+      this.words = undefined;
+    }
+    // The workers exit once woken, their stacks are not freed as they may still be on them.
+    this.workers = [];
+  }
+
+  private alloc(size: number): Pointer {
+    return (this.exports.TVMWasmAllocSpace as ctypes.FTVMWasmAllocSpace)(size);
+  }
+
+  private globalValue(name: string): number {
+    const value = this.exports[name] as unknown;
+    return value instanceof WebAssembly.Global ? value.value : 0;
+  }
+}